@@ -74,6 +74,7 @@ limitations under the License.
 // The implementation below is at the top level instead of the
 // brain namespace because we are defining 'extern "C"' functions.
 using tensorflow::AllocationDescription;
+using tensorflow::CallableOptions;
 using tensorflow::DataType;
 using tensorflow::ExtendSessionGraphHelper;
 using tensorflow::Graph;
@@ -1702,15 +1703,16 @@ void TF_DeleteImportGraphDefResults(TF_ImportGraphDefResults* results) {
   delete results;
 }
 
-static void GraphImportGraphDefLocked(TF_Graph* graph, const GraphDef& def,
+static void GraphImportGraphDefLocked(TF_Graph* graph, GraphDef def,
                                       const TF_ImportGraphDefOptions* opts,
                                       TF_ImportGraphDefResults* tf_results,
                                       TF_Status* status)
     TF_EXCLUSIVE_LOCKS_REQUIRED(graph->mu) {
   const int last_node_id = graph->graph.num_node_ids();
   tensorflow::ImportGraphDefResults results;
-  status->status = tensorflow::ImportGraphDef(opts->opts, def, &graph->graph,
-                                              &graph->refiner, &results);
+  status->status =
+      tensorflow::ImportGraphDef(opts->opts, std::move(def), &graph->graph,
+                                 &graph->refiner, &results);
   if (!status->status.ok()) return;
 
   // Add new nodes to name_map
@@ -1764,7 +1766,7 @@ TF_ImportGraphDefResults* TF_GraphImportGraphDefWithResults(
   }
   auto results = new TF_ImportGraphDefResults();
   mutex_lock l(graph->mu);
-  GraphImportGraphDefLocked(graph, def, options, results, status);
+  GraphImportGraphDefLocked(graph, std::move(def), options, results, status);
   if (!status->status.ok()) {
     delete results;
     return nullptr;
@@ -1795,7 +1797,7 @@ void TF_GraphImportGraphDefWithReturnOutputs(
   }
   TF_ImportGraphDefResults results;
   mutex_lock l(graph->mu);
-  GraphImportGraphDefLocked(graph, def, options, &results, status);
+  GraphImportGraphDefLocked(graph, std::move(def), options, &results, status);
   DCHECK_EQ(results.return_tensors.size(), num_return_outputs);
   memcpy(return_outputs, results.return_tensors.data(),
          num_return_outputs * sizeof(TF_Output));
@@ -2228,8 +2230,15 @@ TF_Session* TF_LoadSessionFromSavedModel(
   // GraphDefs, return the Graph generated in LoadSavedModel().
   TF_ImportGraphDefOptions* import_opts = TF_NewImportGraphDefOptions();
   TF_ImportGraphDefResults results;
-  GraphImportGraphDefLocked(graph, bundle.meta_graph_def.graph_def(),
-                            import_opts, &results, status);
+  // The nodes are moved to the graph unless the MetaGraphDef is returned.
+  GraphDef graph_def;
+  if (meta_graph_def == nullptr) {
+    graph_def.Swap(bundle.meta_graph_def.mutable_graph_def());
+  } else {
+    graph_def = bundle.meta_graph_def.graph_def();
+  }
+  GraphImportGraphDefLocked(graph, std::move(graph_def), import_opts, &results,
+                            status);
   TF_DeleteImportGraphDefOptions(import_opts);
   if (!status->status.ok()) return nullptr;
 
@@ -2386,6 +2395,101 @@ void TF_SessionPRun(TF_Session* session, const char* handle,
                 output_values, target_names, nullptr, status);
 }
 
+void TF_SessionMakeCallable(TF_Session* session, const TF_Buffer* run_options,
+                            const TF_Output* inputs, int ninputs,
+                            const TF_Output* outputs, int noutputs,
+                            const TF_Operation* const* target_opers,
+                            int ntargets, int64_t* handle, TF_Status* status) {
+  *handle = 0;
+
+  if (session->extend_before_run &&
+      !ExtendSessionGraphHelper(session, status)) {
+    return;
+  }
+
+  CallableOptions callable_options;
+  if (run_options != nullptr &&
+      !callable_options.mutable_run_options()->ParseFromArray(
+          run_options->data, run_options->length)) {
+    status->status = InvalidArgument("Unparseable RunOptions proto");
+    return;
+  }
+  for (int i = 0; i < ninputs; ++i) {
+    callable_options.add_feed(OutputName(inputs[i]));
+  }
+  for (int i = 0; i < noutputs; ++i) {
+    callable_options.add_fetch(OutputName(outputs[i]));
+  }
+  for (int i = 0; i < ntargets; ++i) {
+    callable_options.add_target(target_opers[i]->node.name());
+  }
+
+  Session::CallableHandle new_handle;
+  status->status =
+      session->session->MakeCallable(callable_options, &new_handle);
+  if (status->status.ok()) {
+    *handle = new_handle;
+  }
+}
+
+void TF_SessionRunCallable(TF_Session* session, int64_t handle,
+                           TF_Tensor* const* input_values, int ninputs,
+                           TF_Tensor** output_values, int noutputs,
+                           TF_Buffer* run_metadata, TF_Status* status) {
+  TF_Run_Setup(noutputs, output_values, status);
+  if (run_metadata != nullptr && run_metadata->data != nullptr) {
+    status->status =
+        InvalidArgument("Passing non-empty run_metadata is invalid.");
+    return;
+  }
+
+  std::vector<Tensor> feed_tensors(ninputs);
+  for (int i = 0; i < ninputs; ++i) {
+    status->status = TF_TensorToTensor(input_values[i], &feed_tensors[i]);
+    if (!status->status.ok()) return;
+  }
+
+  std::vector<Tensor> fetch_tensors;
+  RunMetadata run_metadata_proto;
+  status->status = session->session->RunCallable(
+      handle, feed_tensors, &fetch_tensors, &run_metadata_proto);
+  if (!status->status.ok()) return;
+  if (static_cast<int>(fetch_tensors.size()) != noutputs) {
+    status->status = InvalidArgument("Expected ", noutputs,
+                                     " output tensors, but the callable has ",
+                                     fetch_tensors.size());
+    return;
+  }
+
+  if (run_metadata != nullptr) {
+    status->status = MessageToBuffer(run_metadata_proto, run_metadata);
+    if (!status->status.ok()) return;
+  }
+
+  for (int i = 0; i < noutputs; ++i) {
+    const Tensor& src = fetch_tensors[i];
+    if (!src.IsInitialized() || src.NumElements() == 0) {
+      output_values[i] =
+          EmptyTensor(static_cast<TF_DataType>(src.dtype()), src.shape());
+      continue;
+    }
+    output_values[i] = TF_TensorFromTensor(src, &status->status);
+    if (!status->status.ok()) {
+      for (int j = 0; j < i; ++j) {
+        TF_DeleteTensor(output_values[j]);
+        output_values[j] = nullptr;
+      }
+      output_values[i] = nullptr;
+      return;
+    }
+  }
+}
+
+void TF_SessionReleaseCallable(TF_Session* session, int64_t handle,
+                               TF_Status* status) {
+  status->status = session->session->ReleaseCallable(handle);
+}
+
 unsigned char TF_TryEvaluateConstant(TF_Graph* graph, TF_Output output,
                                      TF_Tensor** result, TF_Status* status) {
   *result = nullptr;
@@ -1314,6 +1314,60 @@ TF_CAPI_EXPORT extern void TF_SessionPRun(
 // Once called, no more calls to TF_SessionPRun should be made.
 TF_CAPI_EXPORT extern void TF_DeletePRunHandle(const char* handle);
 
+// Prepares the subgraph that computes `outputs` from `inputs` (and runs
+// `target_opers`) so that it can be run repeatedly with
+// TF_SessionRunCallable. Unlike TF_SessionRun, the feeds and fetches are
+// resolved only once, so running a callable skips the per-call name lookups.
+//
+// `run_options` may be NULL or a serialized RunOptions protocol buffer, which
+// then applies to every run of the callable.
+//
+// On success, *handle identifies the callable and must eventually be released
+// with TF_SessionReleaseCallable. Callables stay valid when the graph is
+// extended afterwards, but do not see the new operations.
+TF_CAPI_EXPORT extern void TF_SessionMakeCallable(
+    TF_Session*,
+    // RunOptions
+    const TF_Buffer* run_options,
+    // Input names
+    const TF_Output* inputs, int ninputs,
+    // Output names
+    const TF_Output* outputs, int noutputs,
+    // Target operations
+    const TF_Operation* const* target_opers, int ntargets,
+    // Output handle
+    int64_t* handle,
+    // Output status
+    TF_Status*);
+
+// Runs the callable identified by `handle`. `input_values` must hold one
+// tensor for each of the inputs given to TF_SessionMakeCallable, in the same
+// order, and `output_values` must have room for one tensor per output.
+//
+// The input and output arrays may be reused across calls. As with
+// TF_SessionRun, the caller keeps ownership of the input tensors, takes
+// ownership of the output tensors (which must eventually be deleted with
+// TF_DeleteTensor), and on failure output_values[] contains NULLs.
+//
+// `run_metadata` may be NULL or an empty buffer, into which the serialized
+// RunMetadata of this run is written.
+TF_CAPI_EXPORT extern void TF_SessionRunCallable(
+    TF_Session*, int64_t handle,
+    // Input tensors
+    TF_Tensor* const* input_values, int ninputs,
+    // Output tensors
+    TF_Tensor** output_values, int noutputs,
+    // RunMetadata
+    TF_Buffer* run_metadata,
+    // Output status
+    TF_Status*);
+
+// Releases the resources held by the callable identified by `handle`. Once
+// called, no more calls to TF_SessionRunCallable should be made with it.
+TF_CAPI_EXPORT extern void TF_SessionReleaseCallable(TF_Session*,
+                                                     int64_t handle,
+                                                     TF_Status*);
+
 // --------------------------------------------------------------------------
 // The deprecated session API.  Please switch to the above instead of
 // TF_ExtendGraph(). This deprecated API can be removed at any time without
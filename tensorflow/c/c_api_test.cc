@@ -1129,6 +1129,73 @@ TEST(CAPI, SessionPRun) {
   TF_DeleteStatus(s);
 }
 
+TEST(CAPI, SessionCallable) {
+  TF_Status* s = TF_NewStatus();
+  TF_Graph* graph = TF_NewGraph();
+
+  // Construct the graph: A + 2 + B
+  TF_Operation* a = Placeholder(graph, s, "A");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Operation* b = Placeholder(graph, s, "B");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Operation* two = ScalarConst(2, graph, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Operation* plus2 = Add(a, two, graph, s, "plus2");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_Operation* plusB = Add(plus2, b, graph, s, "plusB");
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  TF_SessionOptions* opts = TF_NewSessionOptions();
+  TF_Session* sess = TF_NewSession(graph, opts, s);
+  TF_DeleteSessionOptions(opts);
+
+  TF_Output feeds[] = {TF_Output{a, 0}, TF_Output{b, 0}};
+  TF_Output fetches[] = {TF_Output{plus2, 0}, TF_Output{plusB, 0}};
+  int64_t handle = -1;
+  TF_SessionMakeCallable(sess, nullptr, feeds, TF_ARRAYSIZE(feeds), fetches,
+                         TF_ARRAYSIZE(fetches), nullptr, 0, &handle, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+
+  // Run the callable several times, reusing the same input and output arrays.
+  TF_Tensor* feedValues[2];
+  TF_Tensor* fetchValues[2];
+  for (int i = 0; i < 3; ++i) {
+    feedValues[0] = Int32Tensor(i);
+    feedValues[1] = Int32Tensor(10 * i);
+    TF_SessionRunCallable(sess, handle, feedValues, 2, fetchValues, 2, nullptr,
+                          s);
+    ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+    EXPECT_EQ(i + 2, *(static_cast<int32*>(TF_TensorData(fetchValues[0]))));
+    EXPECT_EQ(11 * i + 2,
+              *(static_cast<int32*>(TF_TensorData(fetchValues[1]))));
+    for (int j = 0; j < 2; ++j) {
+      TF_DeleteTensor(feedValues[j]);
+      TF_DeleteTensor(fetchValues[j]);
+    }
+  }
+
+  // Feeding the wrong number of inputs fails and leaves no outputs.
+  feedValues[0] = Int32Tensor(1);
+  TF_SessionRunCallable(sess, handle, feedValues, 1, fetchValues, 2, nullptr,
+                        s);
+  EXPECT_NE(TF_OK, TF_GetCode(s));
+  EXPECT_EQ(nullptr, fetchValues[0]);
+  EXPECT_EQ(nullptr, fetchValues[1]);
+  TF_DeleteTensor(feedValues[0]);
+
+  // Clean up.
+  TF_SessionReleaseCallable(sess, handle, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteSession(sess, s);
+  ASSERT_EQ(TF_OK, TF_GetCode(s)) << TF_Message(s);
+  TF_DeleteGraph(graph);
+  TF_DeleteStatus(s);
+}
+
 TEST(CAPI, ShapeInferenceError) {
   // TF_FinishOperation should fail if the shape of the added operation cannot
   // be inferred.
@@ -18,6 +18,7 @@ limitations under the License.
 #include "include/dlpack/dlpack.h"  // from @dlpack
 #include "tensorflow/c/eager/c_api_internal.h"
 #include "tensorflow/c/tf_status_helper.h"
+#include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_reference.h"
 #include "tensorflow/core/platform/logging.h"
@@ -248,6 +249,20 @@ void TFE_CallDLManagedTensorDeleter(void* dlm_ptr) {
 
 void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
   const Tensor* tensor = GetTensorFromHandle(h, status);
+  if (tensor == nullptr) {
+    return nullptr;
+  }
+  // The kernels producing a GPU tensor may still be running on the device's
+  // streams, which the consumer does not know to wait for.
+  TensorHandle::VariantDevice device =
+      TensorHandleFromInterface(h->handle)->device();
+  if (!VariantDeviceIsCustom(device) && absl::get<Device*>(device) != nullptr &&
+      absl::get<Device*>(device)->device_type() == DEVICE_GPU) {
+    status->status = absl::get<Device*>(device)->Sync();
+    if (!status->status.ok()) {
+      return nullptr;
+    }
+  }
   TF_DataType data_type = static_cast<TF_DataType>(tensor->dtype());
   TensorReference tensor_ref(*tensor);  // This will call buf_->Ref()
 
@@ -286,7 +301,8 @@ void* TFE_HandleToDLPack(TFE_TensorHandle* h, TF_Status* status) {
   return static_cast<void*>(dlm_tensor);
 }
 
-TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status) {
+TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status,
+                                       TFE_Context* ctx) {
   DLManagedTensor* dlmt = static_cast<DLManagedTensor*>(dlm);
   DLTensor* dl_tensor = &dlmt->dl_tensor;
   absl::optional<std::string> device_name =
@@ -319,17 +335,9 @@ TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm, TF_Status* status) {
     return nullptr;
   }
 
-  TFE_ContextOptions* opts = TFE_NewContextOptions();
-  TFE_Context* ctx = TFE_NewContext(opts, status);
-  TFE_DeleteContextOptions(opts);
-
-  TFE_TensorHandle* handle = TFE_NewTensorHandleFromDeviceMemory(
+  return TFE_NewTensorHandleFromDeviceMemory(
       ctx, device_name.value().c_str(), dtype, dims, num_dims, data,
-      total_bytes, &DeallocatorWrapperFunc, &dlmt, status);
-
-  TFE_DeleteContext(ctx);
-
-  return handle;
+      total_bytes, &DeallocatorWrapperFunc, dlmt, status);
 }
 
 }  // namespace tensorflow
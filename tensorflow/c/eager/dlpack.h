@@ -24,13 +24,17 @@ namespace tensorflow {
 const char* const kDlTensorCapsuleName = "dltensor";
 
 // Converts eager tensor handle to DLPack (DLManagedTensor*), and return the
-// void* for further PyCapsule construction.
+// void* for further PyCapsule construction. The DLPack tensor borrows the
+// handle's buffer. For GPU tensors this waits for the device's streams, so
+// that consumers on other streams see the final data.
 TF_CAPI_EXPORT extern void* TFE_HandleToDLPack(TFE_TensorHandle* h,
                                                TF_Status* status);
 
-// Converts DLPack (DLManagedTensor*) to eager tensor handle.
+// Converts DLPack (DLManagedTensor*) to eager tensor handle in `ctx`, without
+// copying the data.
 TF_CAPI_EXPORT extern TFE_TensorHandle* TFE_HandleFromDLPack(void* dlm,
-                                                             TF_Status* status);
+                                                             TF_Status* status,
+                                                             TFE_Context* ctx);
 
 // Calls the destructor of DLManagedTensor, used in the destructor of PyCapsule.
 TF_CAPI_EXPORT extern void TFE_CallDLManagedTensorDeleter(void* dlm_ptr);
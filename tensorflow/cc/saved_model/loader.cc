@@ -16,20 +16,31 @@ limitations under the License.
 #include "tensorflow/cc/saved_model/loader.h"
 
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "tensorflow/cc/saved_model/constants.h"
 #include "tensorflow/cc/saved_model/reader.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/protobuf_internal.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
 #include "tensorflow/core/protobuf/saver.pb.h"
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_bundle/naming.h"
 
 namespace tensorflow {
@@ -65,13 +76,95 @@ uint64 GetLatencyMicroseconds(const uint64 start_microseconds) {
   return end_microseconds - start_microseconds;
 }
 
-Status LoadMetaGraphIntoSession(const MetaGraphDef& meta_graph_def,
+// Constants of at least TF_SAVED_MODEL_MMAP_CONSTANTS_MIN_BYTES are written to
+// the directory TF_SAVED_MODEL_MMAP_CONSTANTS_DIR, if set, and replaced in the
+// graph by ImmutableConst nodes that memory-map them.
+constexpr char kMmapConstantsDirEnvVar[] = "TF_SAVED_MODEL_MMAP_CONSTANTS_DIR";
+constexpr char kMmapConstantsMinBytesEnvVar[] =
+    "TF_SAVED_MODEL_MMAP_CONSTANTS_MIN_BYTES";
+constexpr int64 kDefaultMmapConstantsMinBytes = 1 << 20;  // 1MB
+
+// Writes the data of `tensor` to a file of `dir` named after its fingerprint,
+// unless an earlier load already did, and returns the name of the file.
+Status WriteConstantFile(const string& dir, const Tensor& tensor,
+                         string* filename) {
+  const StringPiece data = tensor.tensor_data();
+  *filename = io::JoinPath(
+      dir, strings::StrCat(strings::FpToString(Fingerprint64(data)), "_",
+                           data.size(), ".const"));
+  Env* env = Env::Default();
+  uint64 file_size;
+  if (env->GetFileSize(*filename, &file_size).ok() &&
+      file_size == data.size()) {
+    return Status::OK();
+  }
+  // Concurrent loads write their own temporary file, and the last rename
+  // wins; the files have the same contents.
+  const string tmp_filename = strings::StrCat(
+      *filename, ".tmp", strings::FpToString(random::New64()));
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_filename, data));
+  return env->RenameFile(tmp_filename, *filename);
+}
+
+// Replaces the large constants of `graph_def` by ImmutableConst nodes backed by
+// files of `dir`, so that they are memory-mapped rather than kept in the graph
+// and copied into it by the session.
+Status MemoryMapLargeConstants(const string& dir, int64 min_bytes,
+                               GraphDef* graph_def) {
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(dir));
+  int num_mapped = 0;
+  uint64 mapped_bytes = 0;
+  for (NodeDef& node : *graph_def->mutable_node()) {
+    if (node.op() != "Const") continue;
+    // ImmutableConst only has a CPU kernel.
+    DeviceNameUtils::ParsedName device;
+    if (!DeviceNameUtils::ParseFullName(node.device(), &device) ||
+        (device.has_type && device.type != DEVICE_CPU)) {
+      continue;
+    }
+    const auto value_it = node.attr().find("value");
+    if (value_it == node.attr().end()) continue;
+    const TensorProto& proto = value_it->second.tensor();
+    if (!DataTypeCanUseMemcpy(proto.dtype())) continue;
+    Tensor tensor;
+    if (!tensor.FromProto(proto)) {
+      return errors::InvalidArgument("Invalid value of constant ", node.name());
+    }
+    if (tensor.TotalBytes() == 0 || tensor.TotalBytes() < min_bytes) continue;
+
+    string filename;
+    TF_RETURN_IF_ERROR(WriteConstantFile(dir, tensor, &filename));
+    node.set_op("ImmutableConst");
+    auto* attr = node.mutable_attr();
+    attr->erase("value");
+    AttrValue shape;
+    tensor.shape().AsProto(shape.mutable_shape());
+    (*attr)["shape"] = shape;
+    (*attr)["memory_region_name"].set_s(filename);
+    ++num_mapped;
+    mapped_bytes += tensor.TotalBytes();
+  }
+  LOG(INFO) << "Memory-mapped " << num_mapped << " constants of "
+            << mapped_bytes << " bytes from " << dir;
+  return Status::OK();
+}
+
+// Creates a session for the graph of `meta_graph_def`. Unless
+// `keep_graph_def` is true, the GraphDef is moved into the session, which
+// avoids holding two copies of a large graph while the session is created.
+Status LoadMetaGraphIntoSession(MetaGraphDef* meta_graph_def,
+                                bool keep_graph_def,
                                 const SessionOptions& session_options,
                                 std::unique_ptr<Session>* session) {
   Session* session_p = nullptr;
   TF_RETURN_IF_ERROR(NewSession(session_options, &session_p));
   session->reset(session_p);
-  return (*session)->Create(meta_graph_def.graph_def());
+  if (!keep_graph_def) {
+    GraphDef graph_def;
+    graph_def.Swap(meta_graph_def->mutable_graph_def());
+    return (*session)->Create(std::move(graph_def));
+  }
+  return (*session)->Create(meta_graph_def->graph_def());
 }
 
 Tensor CreateStringTensor(const string& value) {
@@ -110,20 +203,19 @@ void AddAssetsTensorsToInputs(const StringPiece export_dir,
 // right after ReleaseCallable returns.
 //
 // However, the resource manager state remains.
-Status RunOnce(const RunOptions& run_options,
-               const std::vector<std::pair<string, Tensor>>& inputs,
-               const std::vector<string>& output_tensor_names,
-               const std::vector<string>& target_node_names,
-               std::vector<Tensor>* outputs, RunMetadata* run_metadata,
-               Session* session) {
+CallableOptions MakeCallableOptions(
+    const RunOptions& run_options,
+    const std::vector<std::pair<string, Tensor>>& inputs,
+    const std::vector<string>& output_tensor_names,
+    const std::vector<string>& target_node_names,
+    std::vector<Tensor>* feed_tensors) {
   CallableOptions callable_options;
-  std::vector<Tensor> feed_tensors;
   *callable_options.mutable_run_options() = run_options;
   for (const auto& input : inputs) {
     const string& name = input.first;
     const Tensor& tensor = input.second;
     callable_options.add_feed(name);
-    feed_tensors.push_back(tensor);
+    feed_tensors->push_back(tensor);
   }
   for (const string& output_tensor_name : output_tensor_names) {
     callable_options.add_fetch(output_tensor_name);
@@ -131,9 +223,14 @@ Status RunOnce(const RunOptions& run_options,
   for (const string& target_node_name : target_node_names) {
     callable_options.add_target(target_node_name);
   }
+  return callable_options;
+}
 
-  Session::CallableHandle callable_handle;
-  TF_RETURN_IF_ERROR(session->MakeCallable(callable_options, &callable_handle));
+// Runs the callable `callable_handle`, and releases it.
+Status RunAndReleaseCallable(Session::CallableHandle callable_handle,
+                             const std::vector<Tensor>& feed_tensors,
+                             std::vector<Tensor>* outputs,
+                             RunMetadata* run_metadata, Session* session) {
   const Status run_status = session->RunCallable(callable_handle, feed_tensors,
                                                  outputs, run_metadata);
   // Be sure to call ReleaseCallable() regardless of the outcome of
@@ -142,20 +239,58 @@ Status RunOnce(const RunOptions& run_options,
   return run_status;
 }
 
+Status RunOnce(const RunOptions& run_options,
+               const std::vector<std::pair<string, Tensor>>& inputs,
+               const std::vector<string>& output_tensor_names,
+               const std::vector<string>& target_node_names,
+               std::vector<Tensor>* outputs, RunMetadata* run_metadata,
+               Session* session) {
+  std::vector<Tensor> feed_tensors;
+  const CallableOptions callable_options =
+      MakeCallableOptions(run_options, inputs, output_tensor_names,
+                          target_node_names, &feed_tensors);
+  Session::CallableHandle callable_handle;
+  TF_RETURN_IF_ERROR(session->MakeCallable(callable_options, &callable_handle));
+  return RunAndReleaseCallable(callable_handle, feed_tensors, outputs,
+                               run_metadata, session);
+}
+
+// The callable of the initialization op, which is made while the variables
+// are restored: making it prunes and optimizes the init graph and creates its
+// executors, which does not depend on the variables.
+struct PreparedInitOp {
+  Status status;
+  Session::CallableHandle callable_handle;
+  std::vector<Tensor> feed_tensors;
+  uint64 prepare_walltime = 0;
+};
+
+void PrepareInitOp(const RunOptions& run_options, const string& export_dir,
+                   const std::vector<AssetFileDef>& asset_file_defs,
+                   Session* session, const string& init_op_name,
+                   PreparedInitOp* prepared) {
+  const uint64 start_microseconds = Env::Default()->NowMicros();
+  std::vector<std::pair<string, Tensor>> inputs;
+  AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
+  const CallableOptions callable_options = MakeCallableOptions(
+      run_options, inputs, {}, {init_op_name}, &prepared->feed_tensors);
+  prepared->status =
+      session->MakeCallable(callable_options, &prepared->callable_handle);
+  prepared->prepare_walltime = GetLatencyMicroseconds(start_microseconds);
+}
+
 // RunInitOp will return OK if the initialization op was run successfully.
-// An empty init_op_name indicates that there are no init ops to run.
-Status RunInitOp(const RunOptions& run_options, const string& export_dir,
-                 const MetaGraphDef& meta_graph_def,
-                 const std::vector<AssetFileDef>& asset_file_defs,
-                 Session* session, const string& init_op_name) {
-  if (!init_op_name.empty()) {
+// `prepared` holds the callable of the op, unless there are no init ops to
+// run, and is released.
+Status RunInitOp(const string& export_dir, Session* session,
+                 PreparedInitOp* prepared) {
+  if (prepared != nullptr) {
     LOG(INFO) << "Running initialization op on SavedModel bundle at path: "
               << export_dir;
-    std::vector<std::pair<string, Tensor>> inputs;
-    AddAssetsTensorsToInputs(export_dir, asset_file_defs, &inputs);
     RunMetadata run_metadata;
-    return RunOnce(run_options, inputs, {}, {init_op_name},
-                   nullptr /* outputs */, &run_metadata, session);
+    return RunAndReleaseCallable(prepared->callable_handle,
+                                 prepared->feed_tensors, nullptr /* outputs */,
+                                 &run_metadata, session);
   }
   return Status::OK();
 }
@@ -280,55 +415,115 @@ Status LoadSavedModelInternal(const SessionOptions& session_options,
                               const RunOptions& run_options,
                               const string& export_dir,
                               const std::unordered_set<string>& tags,
+                              bool keep_graph_def,
                               SavedModelBundle* const bundle) {
+  // Walltime of each stage, recorded only once the model is loaded.
+  std::vector<std::pair<const char*, uint64>> stage_walltimes;
   const uint64 read_start_microseconds = Env::Default()->NowMicros();
   TF_RETURN_IF_ERROR(ReadMetaGraphDefFromSavedModel(export_dir, tags,
                                                     &bundle->meta_graph_def));
-  TF_RETURN_IF_ERROR(
-      ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info));
-  TF_RETURN_IF_ERROR(LoadMetaGraphIntoSession(
-      bundle->meta_graph_def, session_options, &bundle->session));
+  const char* mmap_constants_dir = getenv(kMmapConstantsDirEnvVar);
+  if (mmap_constants_dir != nullptr && mmap_constants_dir[0] != '\0') {
+    int64 min_bytes;
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(kMmapConstantsMinBytesEnvVar,
+                                           kDefaultMmapConstantsMinBytes,
+                                           &min_bytes));
+    TF_RETURN_IF_ERROR(MemoryMapLargeConstants(
+        mmap_constants_dir, min_bytes,
+        bundle->meta_graph_def.mutable_graph_def()));
+  }
+  stage_walltimes.emplace_back("read_meta_graph",
+                               GetLatencyMicroseconds(read_start_microseconds));
+
+  // The debug info is read while the session is created.
+  Status debug_info_status;
+  std::unique_ptr<Thread> debug_info_thread(Env::Default()->StartThread(
+      ThreadOptions(), "saved_model_read_debug_info", [&]() {
+        debug_info_status =
+            ReadSavedModelDebugInfoIfPresent(export_dir, &bundle->debug_info);
+      }));
+  const uint64 create_start_microseconds = Env::Default()->NowMicros();
+  Status status =
+      LoadMetaGraphIntoSession(&bundle->meta_graph_def, keep_graph_def,
+                               session_options, &bundle->session);
+  stage_walltimes.emplace_back(
+      "create_session", GetLatencyMicroseconds(create_start_microseconds));
+  debug_info_thread.reset();
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(debug_info_status);
 
   std::vector<AssetFileDef> asset_file_defs;
   TF_RETURN_IF_ERROR(
       GetAssetFileDefs(bundle->meta_graph_def, &asset_file_defs));
+  string init_op_name;
   TF_RETURN_IF_ERROR(
-      RunRestore(run_options, export_dir,
-                 bundle->meta_graph_def.saver_def().restore_op_name(),
-                 bundle->meta_graph_def.saver_def().filename_tensor_name(),
-                 asset_file_defs, bundle->session.get()));
+      GetInitOp(export_dir, bundle->meta_graph_def, &init_op_name));
+
+  // The init graph is prepared while the variables are restored, which
+  // mostly waits for the reads of the variables.
+  std::unique_ptr<PreparedInitOp> prepared_init_op;
+  std::unique_ptr<Thread> prepare_init_op_thread;
+  if (!init_op_name.empty()) {
+    prepared_init_op.reset(new PreparedInitOp);
+    prepare_init_op_thread.reset(Env::Default()->StartThread(
+        ThreadOptions(), "saved_model_prepare_init_op", [&]() {
+          PrepareInitOp(run_options, export_dir, asset_file_defs,
+                        bundle->session.get(), init_op_name,
+                        prepared_init_op.get());
+        }));
+  }
+  const uint64 restore_start_microseconds = Env::Default()->NowMicros();
+  status = RunRestore(run_options, export_dir,
+                      bundle->meta_graph_def.saver_def().restore_op_name(),
+                      bundle->meta_graph_def.saver_def().filename_tensor_name(),
+                      asset_file_defs, bundle->session.get());
+  stage_walltimes.emplace_back(
+      "restore_variables", GetLatencyMicroseconds(restore_start_microseconds));
+  prepare_init_op_thread.reset();
+  if (prepared_init_op != nullptr) {
+    if (!status.ok()) {
+      if (prepared_init_op->status.ok()) {
+        bundle->session->ReleaseCallable(prepared_init_op->callable_handle)
+            .IgnoreError();
+      }
+      return status;
+    }
+    TF_RETURN_IF_ERROR(prepared_init_op->status);
+    stage_walltimes.emplace_back("prepare_init_graph",
+                                 prepared_init_op->prepare_walltime);
+  }
+  TF_RETURN_IF_ERROR(status);
   // Record walltime spent in restoring graph from disk, but postpone metric
   // increments until graph init finishes.
   const uint64 restore_graph_walltime =
       GetLatencyMicroseconds(read_start_microseconds);
 
   const uint64 graph_init_start_microseconds = Env::Default()->NowMicros();
-  string init_op_name;
-  TF_RETURN_IF_ERROR(
-      GetInitOp(export_dir, bundle->meta_graph_def, &init_op_name));
-  TF_RETURN_IF_ERROR(RunInitOp(run_options, export_dir, bundle->meta_graph_def,
-                               asset_file_defs, bundle->session.get(),
-                               init_op_name));
+  TF_RETURN_IF_ERROR(RunInitOp(export_dir, bundle->session.get(),
+                               prepared_init_op.get()));
   load_latency_by_stage->GetCell(export_dir, "restore_graph")
       ->Add(restore_graph_walltime);
   // Record wall time spent in init op.
   load_latency_by_stage->GetCell(export_dir, "init_graph")
       ->Add(GetLatencyMicroseconds(graph_init_start_microseconds));
+  for (const auto& stage_walltime : stage_walltimes) {
+    load_latency_by_stage->GetCell(export_dir, stage_walltime.first)
+        ->Add(stage_walltime.second);
+  }
   return Status::OK();
 }
 
-}  // namespace
-
-SavedModelBundleInterface::~SavedModelBundleInterface() {}
-
-Status LoadSavedModel(const SessionOptions& session_options,
-                      const RunOptions& run_options, const string& export_dir,
-                      const std::unordered_set<string>& tags,
-                      SavedModelBundle* const bundle) {
+Status LoadSavedModelAndRecordMetrics(const SessionOptions& session_options,
+                                      const RunOptions& run_options,
+                                      const string& export_dir,
+                                      const std::unordered_set<string>& tags,
+                                      bool keep_graph_def,
+                                      SavedModelBundle* const bundle) {
   // TODO(robson): Add tests for the counters.
   const uint64 start_microseconds = Env::Default()->NowMicros();
-  const Status status = LoadSavedModelInternal(session_options, run_options,
-                                               export_dir, tags, bundle);
+  const Status status =
+      LoadSavedModelInternal(session_options, run_options, export_dir, tags,
+                             keep_graph_def, bundle);
   auto log_and_count = [&](const string& status_str) {
     LOG(INFO) << "SavedModel load for tags { " << absl::StrJoin(tags, " ")
               << " }; Status: " << status_str << ": " << status << ". Took "
@@ -345,6 +540,19 @@ Status LoadSavedModel(const SessionOptions& session_options,
   return status;
 }
 
+}  // namespace
+
+SavedModelBundleInterface::~SavedModelBundleInterface() {}
+
+Status LoadSavedModel(const SessionOptions& session_options,
+                      const RunOptions& run_options, const string& export_dir,
+                      const std::unordered_set<string>& tags,
+                      SavedModelBundle* const bundle) {
+  return LoadSavedModelAndRecordMetrics(session_options, run_options,
+                                        export_dir, tags,
+                                        /*keep_graph_def=*/true, bundle);
+}
+
 namespace {
 // Session wrapper that prevents calls to Session::Create(), Session::Extend(),
 // and the deprecated partial-run methods.
@@ -469,10 +677,11 @@ Status LoadSavedModel(const SessionOptions& session_options,
   // not storing the rewritten subgraph for each signature.
   rewritten_options.config.mutable_experimental()
       ->set_disable_output_partition_graphs(true);
-  // TODO(mrry): Consider specializing the session creation to reduce peak
-  // RAM consumption by using `Session::Create(GraphDef&&)`.
-  TF_RETURN_IF_ERROR(LoadSavedModel(rewritten_options, run_options, export_dir,
-                                    tags, &legacy_bundle));
+  // The GraphDef is not exposed by the returned bundle, so it is moved into
+  // the session to reduce peak RAM consumption.
+  TF_RETURN_IF_ERROR(LoadSavedModelAndRecordMetrics(
+      rewritten_options, run_options, export_dir, tags,
+      /*keep_graph_def=*/false, &legacy_bundle));
   *bundle = SavedModelBundleLite(
       absl::make_unique<LiteSessionWrapper>(std::move(legacy_bundle.session)),
       std::move(*legacy_bundle.meta_graph_def.mutable_signature_def()));
@@ -177,6 +177,36 @@ TEST_F(LoaderTest, SessionCreationFailure) {
       << st.error_message();
 }
 
+TEST_F(LoaderTest, MemoryMappedConstants) {
+  const string constants_dir =
+      io::JoinPath(testing::TmpDir(), "memory_mapped_constants");
+  setenv("TF_SAVED_MODEL_MMAP_CONSTANTS_DIR", constants_dir.c_str(), 1);
+  setenv("TF_SAVED_MODEL_MMAP_CONSTANTS_MIN_BYTES", "1", 1);
+  SavedModelBundle bundle;
+  SessionOptions session_options;
+  RunOptions run_options;
+
+  const string export_dir =
+      io::JoinPath(testing::TensorFlowSrcRoot(), kTestDataSharded);
+  const Status status = LoadSavedModel(session_options, run_options, export_dir,
+                                       {kSavedModelTagServe}, &bundle);
+  unsetenv("TF_SAVED_MODEL_MMAP_CONSTANTS_DIR");
+  unsetenv("TF_SAVED_MODEL_MMAP_CONSTANTS_MIN_BYTES");
+  TF_ASSERT_OK(status);
+  CheckSavedModelBundle(export_dir, bundle);
+
+  int num_mapped = 0;
+  for (const NodeDef& node : bundle.meta_graph_def.graph_def().node()) {
+    if (node.op() == "ImmutableConst") ++num_mapped;
+    EXPECT_FALSE(node.op() == "Const" && node.attr().at("dtype").type() ==
+                                             DT_FLOAT);
+  }
+  EXPECT_GT(num_mapped, 0);
+  std::vector<string> files;
+  TF_ASSERT_OK(Env::Default()->GetChildren(constants_dir, &files));
+  EXPECT_FALSE(files.empty());
+}
+
 TEST_F(LoaderTest, PbtxtFormat) {
   SavedModelBundle bundle;
   SessionOptions session_options;
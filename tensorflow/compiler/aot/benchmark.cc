@@ -25,6 +25,7 @@ limitations under the License.
 #include <algorithm>
 #include <functional>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
@@ -81,6 +82,8 @@ void DumpStatsToStdout(const Stats& stats) {
       {"Best:", sorted_us.front()},
       {"Worst:", sorted_us.back()},
       {"Median:", sorted_us[count_us / 2]},
+      {"90th percentile:", sorted_us[count_us * 9 / 10]},
+      {"99th percentile:", sorted_us[count_us * 99 / 100]},
       {"Mean:", sum_us / count_us},
       {std::move(label_trimmed), sum_us_trimmed / count_us_trimmed},
       {std::move(label_best), sum_us_best / count_us_best},
@@ -103,20 +106,31 @@ void DumpStatsToStdout(const Stats& stats) {
   // Dump stats out.
   printf("Benchmark ran %zu iterations over %lld us\n", count_us,
          static_cast<long long>(stats.total_us));  // NOLINT
+  if (stats.num_instances > 1) {
+    printf("  %d concurrent instances\n", stats.num_instances);
+  }
+  if (stats.total_us > 0) {
+    printf("  Throughput: %.3f iterations/s\n",
+           count_us * 1e6 / stats.total_us);
+  }
   for (const auto& g : groups) {
     printf("  %-*s %*.3f us\n", max_label_size, g.first.c_str(), max_digits + 4,
            g.second);
   }
 }
 
-void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
+// Returns the maximum time to run a benchmark with `options`.
+static int64 MaxMicros(const Options& options) {
   // If neither max_seconds or max_iters is set, stop at kDefaultMicros.
-  const int64 max_us = (options.max_micros <= 0 && options.max_iters <= 0)
-                           ? Options::kDefaultMicros
-                           : options.max_micros;
-  // NOLINTNEXTLINE
-  printf("Running benchmark for %lld us\n", static_cast<long long>(max_us));
-  const int64 start_us = NowMicros();
+  return (options.max_micros <= 0 && options.max_iters <= 0)
+             ? Options::kDefaultMicros
+             : options.max_micros;
+}
+
+// Runs `fn` in a loop from `start_us` until the limits of `options` are hit.
+static void RunLoop(const Options& options, const BenchmarkFn& fn,
+                    int64 start_us, Stats* stats) {
+  const int64 max_us = MaxMicros(options);
   int64 iters = 0;
   while (true) {
     const int64 iter_start_us = NowMicros();
@@ -134,6 +148,37 @@ void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
   }
 }
 
+void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats) {
+  // NOLINTNEXTLINE
+  printf("Running benchmark for %lld us\n",
+         static_cast<long long>(MaxMicros(options)));
+  RunLoop(options, fn, NowMicros(), stats);
+}
+
+void BenchmarkConcurrent(const Options& options,
+                         const std::vector<BenchmarkFn>& fns, Stats* stats) {
+  // NOLINTNEXTLINE
+  printf("Running benchmark of %zu instances for %lld us\n", fns.size(),
+         static_cast<long long>(MaxMicros(options)));
+  std::vector<Stats> instance_stats(fns.size());
+  std::vector<std::thread> threads;
+  threads.reserve(fns.size());
+  const int64 start_us = NowMicros();
+  for (size_t i = 0; i < fns.size(); ++i) {
+    threads.emplace_back(
+        [&, i] { RunLoop(options, fns[i], start_us, &instance_stats[i]); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  stats->num_instances = fns.size();
+  for (const Stats& s : instance_stats) {
+    stats->per_iter_us.insert(stats->per_iter_us.end(), s.per_iter_us.begin(),
+                              s.per_iter_us.end());
+    stats->total_us = std::max(stats->total_us, s.total_us);
+  }
+}
+
 }  // namespace benchmark
 }  // namespace tfcompile
 }  // namespace tensorflow
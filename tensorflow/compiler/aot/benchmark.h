@@ -48,8 +48,9 @@ struct Options {
 struct Stats {
   std::vector<int64> per_iter_us;  // Per-iteration deltas in us.
   int64 total_us;                  // Total time in us.
+  int num_instances;               // Number of concurrently run functions.
 
-  Stats() : total_us(0) { per_iter_us.reserve(5000); }
+  Stats() : total_us(0), num_instances(1) { per_iter_us.reserve(5000); }
 };
 
 // DumpStatsToStdout printfs to stdout stats in a multi-line human-friendly
@@ -63,6 +64,14 @@ typedef std::function<void()> BenchmarkFn;
 // Use `options` to configure benchmarking options.
 void Benchmark(const Options& options, const BenchmarkFn& fn, Stats* stats);
 
+// BenchmarkConcurrent runs each function of `fns` in a loop on its own thread,
+// all at the same time, collecting the stats of every iteration in `stats`.
+// Each function is typically a different instance of the same generated class,
+// so that the stats show the throughput and latency of the instances competing
+// for shared resources. `options` applies to each function.
+void BenchmarkConcurrent(const Options& options,
+                         const std::vector<BenchmarkFn>& fns, Stats* stats);
+
 }  // namespace benchmark
 }  // namespace tfcompile
 }  // namespace tensorflow
@@ -40,6 +40,22 @@ TEST(Benchmark, Benchmark) {
   EXPECT_EQ(stats5.per_iter_us.size(), 5);
 }
 
+// Each instance runs max_iters iterations.
+TEST(Benchmark, BenchmarkConcurrent) {
+  AddComp add0;
+  AddComp add1;
+  AddComp add2;
+
+  Options options;
+  options.max_iters = 5;
+  Stats stats;
+  BenchmarkConcurrent(
+      options, {[&] { add0.Run(); }, [&] { add1.Run(); }, [&] { add2.Run(); }},
+      &stats);
+  EXPECT_EQ(stats.num_instances, 3);
+  EXPECT_EQ(stats.per_iter_us.size(), 15);
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tfcompile
@@ -707,6 +707,119 @@ class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
   return Status::OK();
 }
 
+Status GenerateBatchDispatcherHeader(const CodegenOpts& opts,
+                                     absl::string_view entry_point,
+                                     absl::Span<const int64> batch_sizes,
+                                     string* header) {
+  if (batch_sizes.empty()) {
+    return errors::InvalidArgument("No batch sizes to dispatch to");
+  }
+  string ns_start;
+  for (const string& n : opts.namespaces) {
+    ns_start += absl::StrCat("namespace ", n, " {\n");
+  }
+  ns_start += "\n";
+  string ns_end("\n");
+  for (int i = opts.namespaces.size() - 1; i >= 0; --i) {
+    const string& n = opts.namespaces[i];
+    ns_end += absl::StrCat("}  // end namespace ", n, "\n");
+  }
+
+  string cases;
+  for (int64 batch_size : batch_sizes) {
+    absl::StrAppend(&cases, "      case ", batch_size, ":\n        return ",
+                    BatchSpecializationName(opts.class_name, batch_size),
+                    "::StaticData();\n");
+  }
+
+  *header =
+      R"(// Generated by tfcompile, the TensorFlow graph compiler.  DO NOT EDIT!
+//
+// clang-format off
+
+#ifndef TFCOMPILE_GENERATED_{{ENTRY}}_H_  // NOLINT(build/header_guard)
+#define TFCOMPILE_GENERATED_{{ENTRY}}_H_  // NOLINT(build/header_guard)
+
+{{NS_START}}
+// {{CLASS}} runs the computation compiled for the smallest batch size that is
+// at least the batch size it is constructed with. The computation was compiled
+// for the batch sizes:
+//   {{BATCH_SIZES}}
+// Every arg and result with a batch dimension has batch_size() rows; callers
+// pad args with fewer rows, and ignore the extra result rows. Batch sizes
+// larger than kMaxBatchSize run the largest specialization, so callers must
+// split them. Usage example:
+//
+//   {{CLASS}} computation(/*batch_size=*/n);
+//   // ...set args using computation.arg_data(i)
+//   CHECK(computation.Run());
+//   // ...inspect results using computation.result_data(i)
+//
+// The typed arg and result methods are available on the {{CLASS}}_batch<N>
+// classes, which may also be used directly.
+class {{CLASS}} final : public tensorflow::XlaCompiledCpuFunction {
+ public:
+  // Number of compiled batch sizes, and the largest of them.
+  static constexpr size_t kNumBatchSizes = {{NUM_BATCH_SIZES}};
+  static constexpr ::tensorflow::int64 kMaxBatchSize = {{MAX_BATCH_SIZE}};
+
+  // Returns the smallest compiled batch size that is at least batch_size, or
+  // -1 if batch_size is larger than kMaxBatchSize.
+  static ::tensorflow::int64 CompiledBatchSize(::tensorflow::int64 batch_size) {
+    static constexpr ::tensorflow::int64 kBatchSizes[kNumBatchSizes] = {
+      {{BATCH_SIZES}}
+    };
+    for (::tensorflow::int64 compiled_batch_size : kBatchSizes) {
+      if (compiled_batch_size >= batch_size) return compiled_batch_size;
+    }
+    return -1;
+  }
+
+  // Returns static data of the specialization run for batch_size.
+  static const tensorflow::XlaCompiledCpuFunction::StaticData&
+  StaticDataForBatchSize(::tensorflow::int64 batch_size) {
+    switch (CompiledBatchSize(batch_size)) {
+{{CASES}}      default:
+        return {{CLASS}}_batch{{MAX_BATCH_SIZE}}::StaticData();
+    }
+  }
+
+  explicit {{CLASS}}(::tensorflow::int64 batch_size = kMaxBatchSize,
+                     AllocMode alloc_mode =
+                     AllocMode::ARGS_VARIABLES_RESULTS_PROFILES_AND_TEMPS)
+      : XlaCompiledCpuFunction(StaticDataForBatchSize(batch_size), alloc_mode),
+        batch_size_(CompiledBatchSize(batch_size) < 0
+                        ? kMaxBatchSize
+                        : CompiledBatchSize(batch_size)) {}
+
+  {{CLASS}}(const {{CLASS}}&) = delete;
+  {{CLASS}}& operator=(const {{CLASS}}&) = delete;
+
+  // The compiled batch size run by this instance.
+  ::tensorflow::int64 batch_size() const { return batch_size_; }
+
+ private:
+  const ::tensorflow::int64 batch_size_;
+};
+{{NS_END}}
+
+#endif  // TFCOMPILE_GENERATED_{{ENTRY}}_H_
+
+// clang-format on
+)";
+  const std::vector<std::pair<string, string>> rewrites = {
+      {"{{BATCH_SIZES}}", absl::StrJoin(batch_sizes, ", ")},
+      {"{{CASES}}", cases},
+      {"{{CLASS}}", opts.class_name},
+      {"{{ENTRY}}", string(entry_point)},
+      {"{{MAX_BATCH_SIZE}}", absl::StrCat(batch_sizes.back())},
+      {"{{NS_END}}\n", ns_end},
+      {"{{NS_START}}\n", ns_start},
+      {"{{NUM_BATCH_SIZES}}", absl::StrCat(batch_sizes.size())}};
+  absl::StrReplaceAll(rewrites, header);
+  return Status::OK();
+}
+
 static string CreateUniqueIdentifier(const CodegenOpts& opts,
                                      absl::string_view suffix) {
   string result = "__tfcompile";
@@ -721,45 +834,69 @@ static string CreateUniqueIdentifier(const CodegenOpts& opts,
 Status GenerateMetadata(const CodegenOpts& opts,
                         const CompileResult& compile_result,
                         MetadataResult* metadata_result) {
-  std::unique_ptr<xla::ProgramShapeProto> program_shape;
-
-  if (opts.gen_program_shape) {
-    program_shape =
-        absl::make_unique<xla::ProgramShapeProto>(compile_result.program_shape);
-
-    // The parameter names are currently meaningless, and redundant with the
-    // rest of our metadata, so clear them out to avoid confusion and save
-    // space.
-    program_shape->clear_parameter_names();
-  }
-
-  // When asked to serialize a null protobuf, CreateEmbeddedProtocolBuffer gives
-  // a shim that evaluates to nullptr, which is what we want.
-
-  ProtobufToEmbed program_shape_protobuf{
-      CreateUniqueIdentifier(opts, "ProgramShapeProto"),
-      "::xla::ProgramShapeProto", program_shape.get()};
-
-  ProtobufToEmbed hlo_profile_printer_data_protobuf{
-      CreateUniqueIdentifier(opts, "HloProfilePrinterData"),
-      "::xla::HloProfilePrinterData",
-      compile_result.aot->hlo_profile_printer_data()};
-
-  TF_ASSIGN_OR_RETURN(
-      EmbeddedProtocolBuffers embedded_protobufs,
-      CreateEmbeddedProtocolBuffers(
-          opts.target_triple,
-          {program_shape_protobuf, hlo_profile_printer_data_protobuf}));
-
-  metadata_result->program_shape_access_shim =
-      std::move(embedded_protobufs.cpp_shims[0].expression);
-  metadata_result->hlo_profile_printer_data_access_shim =
-      std::move(embedded_protobufs.cpp_shims[1].expression);
-  metadata_result->header_variable_decls.emplace_back(
-      std::move(embedded_protobufs.cpp_shims[0].variable_decl));
-  metadata_result->header_variable_decls.emplace_back(
-      std::move(embedded_protobufs.cpp_shims[1].variable_decl));
-  metadata_result->object_file_data =
+  std::vector<MetadataResult> metadata_results;
+  TF_RETURN_IF_ERROR(GenerateMetadata(absl::MakeConstSpan(&opts, 1),
+                                      absl::MakeConstSpan(&compile_result, 1),
+                                      &metadata_results));
+  *metadata_result = std::move(metadata_results[0]);
+  return Status::OK();
+}
+
+Status GenerateMetadata(absl::Span<const CodegenOpts> opts,
+                        absl::Span<const CompileResult> compile_results,
+                        std::vector<MetadataResult>* metadata_results) {
+  if (opts.empty() || opts.size() != compile_results.size()) {
+    return errors::InvalidArgument("Got ", opts.size(), " codegen options for ",
+                                   compile_results.size(), " compile results");
+  }
+  std::vector<std::unique_ptr<xla::ProgramShapeProto>> program_shapes(
+      opts.size());
+  std::vector<ProtobufToEmbed> protobufs_to_embed;
+  for (int i = 0; i < opts.size(); ++i) {
+    if (opts[i].gen_program_shape) {
+      program_shapes[i] = absl::make_unique<xla::ProgramShapeProto>(
+          compile_results[i].program_shape);
+
+      // The parameter names are currently meaningless, and redundant with the
+      // rest of our metadata, so clear them out to avoid confusion and save
+      // space.
+      program_shapes[i]->clear_parameter_names();
+    }
+
+    // When asked to serialize a null protobuf, CreateEmbeddedProtocolBuffer
+    // gives a shim that evaluates to nullptr, which is what we want.
+
+    protobufs_to_embed.push_back(
+        {CreateUniqueIdentifier(opts[i], "ProgramShapeProto"),
+         "::xla::ProgramShapeProto", program_shapes[i].get()});
+
+    protobufs_to_embed.push_back(
+        {CreateUniqueIdentifier(opts[i], "HloProfilePrinterData"),
+         "::xla::HloProfilePrinterData",
+         compile_results[i].aot->hlo_profile_printer_data()});
+  }
+
+  TF_ASSIGN_OR_RETURN(EmbeddedProtocolBuffers embedded_protobufs,
+                      CreateEmbeddedProtocolBuffers(opts.front().target_triple,
+                                                    protobufs_to_embed));
+
+  metadata_results->clear();
+  metadata_results->resize(opts.size());
+  for (int i = 0; i < opts.size(); ++i) {
+    MetadataResult* metadata_result = &(*metadata_results)[i];
+    auto& program_shape_shim = embedded_protobufs.cpp_shims[2 * i];
+    auto& hlo_profile_printer_data_shim =
+        embedded_protobufs.cpp_shims[2 * i + 1];
+    metadata_result->program_shape_access_shim =
+        std::move(program_shape_shim.expression);
+    metadata_result->hlo_profile_printer_data_access_shim =
+        std::move(hlo_profile_printer_data_shim.expression);
+    metadata_result->header_variable_decls.emplace_back(
+        std::move(program_shape_shim.variable_decl));
+    metadata_result->header_variable_decls.emplace_back(
+        std::move(hlo_profile_printer_data_shim.variable_decl));
+  }
+  metadata_results->front().object_file_data =
       std::move(embedded_protobufs.object_file_data);
   return Status::OK();
 }
@@ -20,6 +20,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/aot/compile.h"
 #include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
 
@@ -77,6 +78,14 @@ Status GenerateMetadata(const CodegenOpts& opts,
                         const CompileResult& compile_result,
                         MetadataResult* metadata_result);
 
+// Generates a single metadata object file for several compile results, such as
+// the batch size specializations of CompileGraphForBatchSizes, each with its
+// own codegen options. The object file is returned in the first of
+// `metadata_results`.
+Status GenerateMetadata(absl::Span<const CodegenOpts> opts,
+                        absl::Span<const CompileResult> compile_results,
+                        std::vector<MetadataResult>* metadata_results);
+
 // GenerateHeader uses the meta-information from compile_result to generate a
 // C++ header giving access to the function in the generated object file.  The
 // header includes API usage documentation.
@@ -87,6 +96,17 @@ Status GenerateHeader(const CodegenOpts& opts, const tf2xla::Config& config,
                       const CompileResult& compile_result,
                       const MetadataResult& metadata_result, string* header);
 
+// GenerateBatchDispatcherHeader generates a C++ header declaring class
+// opts.class_name, which runs the specialization for the smallest batch size
+// in `batch_sizes` that is at least the requested one. The specializations are
+// the classes generated by GenerateHeader, named by BatchSpecializationName,
+// whose headers must precede this one. `batch_sizes` must be in increasing
+// order.
+Status GenerateBatchDispatcherHeader(const CodegenOpts& opts,
+                                     absl::string_view entry_point,
+                                     absl::Span<const int64> batch_sizes,
+                                     string* header);
+
 // ParseCppClass parses `cpp_class` into its `class_name` and `namespaces`
 // components.  The syntax is [[<optional_namespace>::],...]<class_name>.  This
 // mirrors the C++ syntax for referring to a class, where multiple namespaces
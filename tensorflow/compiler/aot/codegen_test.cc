@@ -264,6 +264,56 @@ TEST(CodegenTest, Golden) {
   CompareWithGoldenFile("tensorflow/compiler/aot/codegen_test_h.golden", header,
                         true);
 }
+TEST(ParseBatchSizes, Simple) {
+  std::vector<int64> batch_sizes;
+  TF_EXPECT_OK(ParseBatchSizes("32,1,8,8,64", &batch_sizes));
+  EXPECT_EQ(batch_sizes, std::vector<int64>({1, 8, 32, 64}));
+
+  ExpectErrorContains(ParseBatchSizes("1,,8", &batch_sizes),
+                      "Invalid batch size");
+  ExpectErrorContains(ParseBatchSizes("0", &batch_sizes), "Invalid batch size");
+  ExpectErrorContains(ParseBatchSizes("a", &batch_sizes), "Invalid batch size");
+}
+
+TEST(SpecializeConfigForBatchSize, SetsLeadingDimension) {
+  tf2xla::Config config;
+  tf2xla::Feed* batched = config.add_feed();
+  batched->mutable_shape()->add_dim()->set_size(-1);
+  batched->mutable_shape()->add_dim()->set_size(3);
+  tf2xla::Feed* scalar = config.add_feed();
+  scalar->mutable_shape();
+  tf2xla::Fetch* fetch = config.add_fetch();
+  fetch->mutable_shape()->add_dim()->set_size(1);
+
+  tf2xla::Config specialized;
+  TF_EXPECT_OK(SpecializeConfigForBatchSize(config, 16, &specialized));
+  ASSERT_EQ(specialized.feed_size(), 2);
+  EXPECT_EQ(specialized.feed(0).shape().dim(0).size(), 16);
+  EXPECT_EQ(specialized.feed(0).shape().dim(1).size(), 3);
+  EXPECT_EQ(specialized.feed(1).shape().dim_size(), 0);
+  EXPECT_EQ(specialized.fetch(0).shape().dim(0).size(), 16);
+}
+
+TEST(GenerateBatchDispatcherHeader, DispatchesToSpecializations) {
+  CodegenOpts opts;
+  opts.class_name = "MyClass";
+  opts.namespaces = {"foo"};
+  string header;
+  TF_EXPECT_OK(
+      GenerateBatchDispatcherHeader(opts, "entry", {1, 8, 64}, &header));
+  EXPECT_TRUE(absl::StrContains(header, "class MyClass final"));
+  EXPECT_TRUE(absl::StrContains(header, "kMaxBatchSize = 64;"));
+  EXPECT_TRUE(absl::StrContains(
+      header, "case 8:\n        return MyClass_batch8::StaticData();"));
+  EXPECT_TRUE(
+      absl::StrContains(header, "return MyClass_batch64::StaticData();"));
+  EXPECT_TRUE(absl::StrContains(header, "namespace foo {"));
+  EXPECT_FALSE(absl::StrContains(header, "{{"));
+
+  ExpectErrorContains(GenerateBatchDispatcherHeader(opts, "entry", {}, &header),
+                      "No batch sizes");
+}
+
 }  // namespace
 }  // namespace tfcompile
 }  // namespace tensorflow
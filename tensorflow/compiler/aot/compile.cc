@@ -15,12 +15,18 @@ limitations under the License.
 
 #include "tensorflow/compiler/aot/compile.h"
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/base/call_once.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/span.h"
 #include "llvm-c/Target.h"
 #include "tensorflow/compiler/aot/codegen.h"
 #include "tensorflow/compiler/aot/flags.h"
@@ -48,80 +54,86 @@ namespace tfcompile {
 
 namespace {
 
-// Compiles the XLA computation into executable code.
+// Compiles the XLA computations into executable code, one CompileResult per
+// computation.
 Status CompileXla(xla::CompileOnlyClient* client,
-                  const xla::XlaComputation& computation,
+                  absl::Span<const xla::XlaComputation> computations,
                   const xla::cpu::CpuAotCompilationOptions& aot_opts,
-                  CompileResult* compile_result) {
-  // Retrieves arg and result layouts from the computation.
+                  std::vector<CompileResult>* compile_results) {
+  // Retrieves arg and result layouts from the computations.
   // TODO(toddw): Should we let the user choose the major/minor ordering?
-  xla::StatusOr<std::unique_ptr<xla::ProgramShape>> pshape_or =
-      client->GetComputationShape(computation);
-  if (!pshape_or.ok()) {
-    return errors::Unknown("Couldn't get XLA program shape: ",
-                           pshape_or.status().error_message());
-  }
-  compile_result->program_shape = pshape_or.ValueOrDie()->ToProto();
-  xla::ProgramShapeProto* pshape = &compile_result->program_shape;
-
+  compile_results->clear();
+  compile_results->resize(computations.size());
   // AotXlaComputationInstance::argument_layouts is a vector of Shape
-  // pointers. Accumulate the Shape objects themselves in a separate vector
-  // while building the vector of pointers.
-  std::vector<const xla::Shape*> arg_layout_ptrs(pshape->parameters_size());
-  std::vector<xla::Shape> arg_layouts(pshape->parameters_size());
-  for (int i = 0; i < pshape->parameters_size(); ++i) {
-    arg_layouts[i] = xla::Shape(*pshape->mutable_parameters(i));
-    arg_layout_ptrs[i] = &arg_layouts[i];
+  // pointers. Accumulate the Shape objects themselves in separate vectors
+  // while building the vectors of pointers.
+  std::vector<std::vector<xla::Shape>> arg_layouts(computations.size());
+  std::vector<xla::Shape> result_shapes(computations.size());
+  std::vector<xla::CompileOnlyClient::AotXlaComputationInstance> instances(
+      computations.size());
+  for (int c = 0; c < computations.size(); ++c) {
+    xla::StatusOr<std::unique_ptr<xla::ProgramShape>> pshape_or =
+        client->GetComputationShape(computations[c]);
+    if (!pshape_or.ok()) {
+      return errors::Unknown("Couldn't get XLA program shape: ",
+                             pshape_or.status().error_message());
+    }
+    (*compile_results)[c].program_shape = pshape_or.ValueOrDie()->ToProto();
+    xla::ProgramShapeProto* pshape = &(*compile_results)[c].program_shape;
+
+    std::vector<const xla::Shape*> arg_layout_ptrs(pshape->parameters_size());
+    arg_layouts[c].resize(pshape->parameters_size());
+    for (int i = 0; i < pshape->parameters_size(); ++i) {
+      arg_layouts[c][i] = xla::Shape(*pshape->mutable_parameters(i));
+      arg_layout_ptrs[i] = &arg_layouts[c][i];
+    }
+    instances[c].computation = &computations[c];
+    instances[c].argument_layouts = std::move(arg_layout_ptrs);
+    result_shapes[c] = xla::Shape(pshape->result());
+    instances[c].result_layout = &result_shapes[c];
   }
-  xla::CompileOnlyClient::AotXlaComputationInstance instance;
-  instance.computation = &computation;
-  instance.argument_layouts = std::move(arg_layout_ptrs);
-  xla::Shape result_shape(pshape->result());
-  instance.result_layout = &result_shape;
   xla::StatusOr<std::vector<std::unique_ptr<xla::AotCompilationResult>>>
-      aot_or = client->CompileAheadOfTime({instance}, aot_opts);
+      aot_or = client->CompileAheadOfTime(instances, aot_opts);
   if (!aot_or.ok()) {
     return errors::Unknown("XLA compilation failed: ",
                            aot_or.status().error_message());
   }
-  compile_result->aot =
-      xla::unique_ptr_static_cast<xla::cpu::CpuAotCompilationResult>(
-          std::move(aot_or.ValueOrDie().back()));
-  compile_result->entry_point = aot_opts.entry_point_name();
-  compile_result->pointer_size =
-      xla::CompileOnlyClient::PointerSizeForTriple(aot_opts.triple());
+  for (int c = 0; c < computations.size(); ++c) {
+    CompileResult& compile_result = (*compile_results)[c];
+    compile_result.aot =
+        xla::unique_ptr_static_cast<xla::cpu::CpuAotCompilationResult>(
+            std::move(aot_or.ValueOrDie()[c]));
+    compile_result.entry_point = aot_opts.entry_point_names().empty()
+                                     ? aot_opts.entry_point_name()
+                                     : aot_opts.entry_point_names()[c];
+    compile_result.pointer_size =
+        xla::CompileOnlyClient::PointerSizeForTriple(aot_opts.triple());
+  }
   return Status::OK();
 }
 
-}  // namespace
-
-Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
-                    const MainFlags& flags, CompileResult* compile_result) {
-  // Converts the graph into an XLA computation, and compiles the
-  // computation.
-  // TODO(toddw): Should we let the user pick the XLA cpu vs. gpu client?
-  se::Platform* cpu_platform =
-      se::MultiPlatformManager::PlatformWithName("Host").ValueOrDie();
-  xla::CompileOnlyClient* client =
-      xla::ClientLibrary::GetOrCreateCompileOnlyClient(cpu_platform)
-          .ValueOrDie();
-  xla::XlaComputation computation;
+// Converts the graph into an XLA computation, and writes its HloSnapshot if
+// requested by the flags.
+Status ConvertGraphToXla(GraphDef graph_def, const tf2xla::Config& config,
+                         const MainFlags& flags,
+                         xla::CompileOnlyClient* client,
+                         xla::XlaComputation* computation) {
   if (flags.mlir_components == "Bridge") {
     TF_RETURN_IF_ERROR(ConvertGraphDefToXlaViaMlir(
-        graph_def, config, &computation, flags.debug_info,
+        graph_def, config, computation, flags.debug_info,
         flags.debug_info_path_begin_marker));
   } else if (flags.mlir_components.empty() || flags.mlir_components == "None") {
     TF_RETURN_IF_ERROR(ConvertGraphDefToXla(std::move(graph_def), config,
-                                            client, &computation));
+                                            client, computation));
   } else {
     return errors::Unknown("Unknown mlir_components ", flags.mlir_components);
   }
   if (flags.quantize) {
-    TF_RETURN_IF_ERROR(mlir::xla_hlo::XlaQuantize(config, &computation));
+    TF_RETURN_IF_ERROR(mlir::xla_hlo::XlaQuantize(config, computation));
   }
   if (!flags.out_session_module.empty()) {
     TF_ASSIGN_OR_RETURN(std::unique_ptr<xla::HloSnapshot> module,
-                        computation.Snapshot());
+                        computation->Snapshot());
     // Serialize the HloSnapshot deterministically so that all the outputs of a
     // tf_library genrule are deterministic.
     const size_t size = module->ByteSizeLong();
@@ -132,12 +144,112 @@ Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
         WriteStringToFile(Env::Default(), flags.out_session_module,
                           absl::string_view(serialized.get(), size)));
   }
+  return Status::OK();
+}
+
+xla::CompileOnlyClient* GetCompileOnlyClient() {
+  // TODO(toddw): Should we let the user pick the XLA cpu vs. gpu client?
+  se::Platform* cpu_platform =
+      se::MultiPlatformManager::PlatformWithName("Host").ValueOrDie();
+  return xla::ClientLibrary::GetOrCreateCompileOnlyClient(cpu_platform)
+      .ValueOrDie();
+}
+
+}  // namespace
+
+Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
+                    const MainFlags& flags, CompileResult* compile_result) {
+  // Converts the graph into an XLA computation, and compiles the
+  // computation.
+  xla::CompileOnlyClient* client = GetCompileOnlyClient();
+  xla::XlaComputation computation;
+  TF_RETURN_IF_ERROR(ConvertGraphToXla(std::move(graph_def), config, flags,
+                                       client, &computation));
   xla::cpu::CpuAotCompilationOptions aot_opts(
       flags.target_triple, flags.target_cpu, flags.target_features,
       flags.entry_point,
       xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
 
-  return CompileXla(client, computation, aot_opts, compile_result);
+  std::vector<CompileResult> compile_results;
+  TF_RETURN_IF_ERROR(CompileXla(client, absl::MakeConstSpan(&computation, 1),
+                                aot_opts, &compile_results));
+  *compile_result = std::move(compile_results[0]);
+  return Status::OK();
+}
+
+Status ParseBatchSizes(absl::string_view batch_sizes,
+                       std::vector<int64>* result) {
+  result->clear();
+  for (absl::string_view part : absl::StrSplit(batch_sizes, ',')) {
+    int64 batch_size;
+    if (!absl::SimpleAtoi(part, &batch_size) || batch_size <= 0) {
+      return errors::InvalidArgument("Invalid batch size \"", part,
+                                     "\" in --batch_sizes=", batch_sizes);
+    }
+    result->push_back(batch_size);
+  }
+  absl::c_sort(*result);
+  result->erase(std::unique(result->begin(), result->end()), result->end());
+  return Status::OK();
+}
+
+string BatchSpecializationName(absl::string_view name, int64 batch_size) {
+  return absl::StrCat(name, "_batch", batch_size);
+}
+
+Status SpecializeConfigForBatchSize(const tf2xla::Config& config,
+                                    int64 batch_size,
+                                    tf2xla::Config* specialized) {
+  *specialized = config;
+  for (tf2xla::Feed& feed : *specialized->mutable_feed()) {
+    if (feed.shape().unknown_rank()) {
+      return errors::InvalidArgument("Feed ", feed.id().node_name(),
+                                     " has unknown rank and can't be batched");
+    }
+    if (feed.shape().dim_size() > 0) {
+      feed.mutable_shape()->mutable_dim(0)->set_size(batch_size);
+    }
+  }
+  for (tf2xla::Fetch& fetch : *specialized->mutable_fetch()) {
+    if (fetch.has_shape() && fetch.shape().dim_size() > 0) {
+      fetch.mutable_shape()->mutable_dim(0)->set_size(batch_size);
+    }
+  }
+  return Status::OK();
+}
+
+Status CompileGraphForBatchSizes(const GraphDef& graph_def,
+                                 const tf2xla::Config& config,
+                                 const MainFlags& flags,
+                                 absl::Span<const int64> batch_sizes,
+                                 std::vector<CompileResult>* compile_results) {
+  if (batch_sizes.empty()) {
+    return errors::InvalidArgument("No batch sizes to compile for");
+  }
+  xla::CompileOnlyClient* client = GetCompileOnlyClient();
+  std::vector<xla::XlaComputation> computations(batch_sizes.size());
+  std::vector<string> entry_points;
+  for (int i = 0; i < batch_sizes.size(); ++i) {
+    tf2xla::Config specialized_config;
+    TF_RETURN_IF_ERROR(SpecializeConfigForBatchSize(config, batch_sizes[i],
+                                                    &specialized_config));
+    // Only the session module of the first specialization is written.
+    MainFlags specialized_flags = flags;
+    if (i > 0) {
+      specialized_flags.out_session_module.clear();
+    }
+    TF_RETURN_IF_ERROR(ConvertGraphToXla(graph_def, specialized_config,
+                                         specialized_flags, client,
+                                         &computations[i]));
+    entry_points.push_back(
+        BatchSpecializationName(flags.entry_point, batch_sizes[i]));
+  }
+  xla::cpu::CpuAotCompilationOptions aot_opts(
+      flags.target_triple, flags.target_cpu, flags.target_features,
+      flags.entry_point,
+      xla::cpu::CpuAotCompilationOptions::RelocationModel::BigPic);
+  aot_opts.set_entry_point_names(std::move(entry_points));
+  return CompileXla(client, computations, aot_opts, compile_results);
 }
 
 static Status ReadProtoFile(const string& fname, protobuf::Message* proto) {
@@ -189,6 +301,72 @@ static std::string InterpolateErrorMessage(std::string message) {
   return message;
 }
 
+static Status GetCodegenOpts(const MainFlags& flags,
+                             CodegenOpts* codegen_opts) {
+  codegen_opts->gen_name_to_index = flags.gen_name_to_index;
+  codegen_opts->gen_program_shape = flags.gen_program_shape;
+  codegen_opts->target_triple = flags.target_triple;
+  if (flags.cpp_class.empty()) {
+    return errors::InvalidArgument("Must specify --cpp_class");
+  }
+  codegen_opts->gen_hlo_profile_printer_data =
+      xla::GetDebugOptionsFromFlags().xla_hlo_profile();
+  return ParseCppClass(flags.cpp_class, &codegen_opts->class_name,
+                       &codegen_opts->namespaces);
+}
+
+// Compiles one specialization per batch size in --batch_sizes into a single
+// object file, and generates a header with one class per specialization and a
+// class dispatching to them.
+static Status MainForBatchSizes(const GraphDef& graph_def,
+                                const tf2xla::Config& config,
+                                const MainFlags& flags) {
+  std::vector<int64> batch_sizes;
+  TF_RETURN_IF_ERROR(ParseBatchSizes(flags.batch_sizes, &batch_sizes));
+  std::vector<CompileResult> compile_results;
+  Status status = CompileGraphForBatchSizes(graph_def, config, flags,
+                                            batch_sizes, &compile_results);
+  if (!status.ok()) {
+    return Status(status.code(),
+                  InterpolateErrorMessage(status.error_message()));
+  }
+
+  // Write output files.
+  Env* env = Env::Default();
+  const std::vector<char>& obj = compile_results[0].aot->object_file_data();
+  TF_RETURN_IF_ERROR(
+      WriteStringToFile(env, flags.out_function_object,
+                        absl::string_view(obj.data(), obj.size())));
+  CodegenOpts codegen_opts;
+  TF_RETURN_IF_ERROR(GetCodegenOpts(flags, &codegen_opts));
+  std::vector<CodegenOpts> specialized_codegen_opts(batch_sizes.size(),
+                                                    codegen_opts);
+  for (int i = 0; i < batch_sizes.size(); ++i) {
+    specialized_codegen_opts[i].class_name =
+        BatchSpecializationName(codegen_opts.class_name, batch_sizes[i]);
+  }
+
+  std::vector<MetadataResult> metadata_results;
+  TF_RETURN_IF_ERROR(GenerateMetadata(specialized_codegen_opts,
+                                      compile_results, &metadata_results));
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, flags.out_metadata_object,
+                                       metadata_results[0].object_file_data));
+  string header;
+  for (int i = 0; i < batch_sizes.size(); ++i) {
+    string specialized_header;
+    TF_RETURN_IF_ERROR(GenerateHeader(specialized_codegen_opts[i], config,
+                                      compile_results[i], metadata_results[i],
+                                      &specialized_header));
+    absl::StrAppend(&header, specialized_header, "\n");
+  }
+  string dispatcher_header;
+  TF_RETURN_IF_ERROR(GenerateBatchDispatcherHeader(
+      codegen_opts, flags.entry_point, batch_sizes, &dispatcher_header));
+  absl::StrAppend(&header, dispatcher_header);
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, flags.out_header, header));
+  return Status::OK();
+}
+
 Status Main(const MainFlags& flags) {
   absl::call_once(targets_init, &InitializeTargets);
 
@@ -214,6 +392,9 @@ Status Main(const MainFlags& flags) {
   }
   GraphDef graph_def;
   TF_RETURN_IF_ERROR(ReadProtoFile(flags.graph, &graph_def));
+  if (!flags.batch_sizes.empty()) {
+    return MainForBatchSizes(graph_def, config, flags);
+  }
   CompileResult compile_result;
 
   Status status =
@@ -230,16 +411,7 @@ Status Main(const MainFlags& flags) {
       WriteStringToFile(env, flags.out_function_object,
                         absl::string_view(obj.data(), obj.size())));
   CodegenOpts codegen_opts;
-  codegen_opts.gen_name_to_index = flags.gen_name_to_index;
-  codegen_opts.gen_program_shape = flags.gen_program_shape;
-  codegen_opts.target_triple = flags.target_triple;
-  if (flags.cpp_class.empty()) {
-    return errors::InvalidArgument("Must specify --cpp_class");
-  }
-  codegen_opts.gen_hlo_profile_printer_data =
-      xla::GetDebugOptionsFromFlags().xla_hlo_profile();
-  TF_RETURN_IF_ERROR(ParseCppClass(flags.cpp_class, &codegen_opts.class_name,
-                                   &codegen_opts.namespaces));
+  TF_RETURN_IF_ERROR(GetCodegenOpts(flags, &codegen_opts));
 
   MetadataResult metadata_result;
   TF_RETURN_IF_ERROR(
@@ -18,7 +18,10 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/aot/flags.h"
 #include "tensorflow/compiler/tf2xla/tf2xla.pb.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_compiler.h"
@@ -45,6 +48,32 @@ struct CompileResult {
 Status CompileGraph(GraphDef graph_def, const tf2xla::Config& config,
                     const MainFlags& flags, CompileResult* compile_result);
 
+// Parses `batch_sizes`, a comma-separated list of positive batch sizes, into
+// `result` in increasing order without duplicates.
+Status ParseBatchSizes(absl::string_view batch_sizes,
+                       std::vector<int64>* result);
+
+// Returns the name of the specialization of the entry point or class `name`
+// for `batch_size`.
+string BatchSpecializationName(absl::string_view name, int64 batch_size);
+
+// Sets `specialized` to a copy of `config` in which the leading dimension of
+// every feed, and of every fetch that has a shape, is `batch_size`. Scalar
+// feeds and fetches are left as is.
+Status SpecializeConfigForBatchSize(const tf2xla::Config& config,
+                                    int64 batch_size,
+                                    tf2xla::Config* specialized);
+
+// CompileGraphForBatchSizes compiles one specialization of graph_def per batch
+// size, in the order of `batch_sizes`, with the entry point of each named by
+// BatchSpecializationName. All specializations are compiled into a single
+// object file, held by the first of `compile_results`.
+Status CompileGraphForBatchSizes(const GraphDef& graph_def,
+                                 const tf2xla::Config& config,
+                                 const MainFlags& flags,
+                                 absl::Span<const int64> batch_sizes,
+                                 std::vector<CompileResult>* compile_results);
+
 // The full compilation method, for reuse in a library setting.
 Status Main(const MainFlags& flags);
 
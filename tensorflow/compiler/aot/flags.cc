@@ -66,6 +66,13 @@ void AppendMainFlags(std::vector<Flag>* flag_list, MainFlags* flags) {
        "namespaces may precede the class name, separated by double-colons.  "
        "The class will be generated in the given namespace(s), or if no "
        "namespaces are given, within the global namespace."},
+      {"batch_sizes", &flags->batch_sizes,
+       "Comma-separated list of batch sizes, e.g. 1,8,32,64.  If set, the "
+       "graph is compiled once per batch size, with the leading dimension of "
+       "every feed set to that size, into a single object file.  The header "
+       "then contains one <cpp_class>_batch<N> class per batch size, and a "
+       "<cpp_class> class that dispatches a requested batch size to the "
+       "smallest compiled batch size that is at least as large."},
       {"out_function_object", &flags->out_function_object,
        "Output object file containing the generated function for the "
        "TensorFlow model."},
@@ -37,6 +37,7 @@ struct MainFlags {
   string target_features;
   string entry_point;
   string cpp_class;
+  string batch_sizes;
   string out_function_object;
   string out_metadata_object;
   string out_header;
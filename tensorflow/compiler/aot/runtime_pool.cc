@@ -0,0 +1,103 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/compiler/aot/runtime_pool.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace tensorflow {
+namespace tfcompile {
+
+struct RuntimePool::IntraOpPool {
+  explicit IntraOpPool(int num_threads)
+      : pool(num_threads), device(&pool, pool.NumThreads()) {}
+
+  Eigen::ThreadPool pool;
+  Eigen::ThreadPoolDevice device;
+};
+
+RuntimePool::RuntimePool(const Options& options)
+    : intra_op_pool_(
+          new IntraOpPool(std::max(options.num_intra_op_threads, 1))) {
+  const int num_inter_op_threads = std::max(options.num_inter_op_threads, 1);
+  inter_op_threads_.reserve(num_inter_op_threads);
+  for (int i = 0; i < num_inter_op_threads; ++i) {
+    inter_op_threads_.emplace_back([this] { WorkerLoop(); });
+  }
+}
+
+RuntimePool::~RuntimePool() {
+  Wait();
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    shutting_down_ = true;
+  }
+  task_available_.notify_all();
+  for (std::thread& thread : inter_op_threads_) {
+    thread.join();
+  }
+}
+
+void RuntimePool::Schedule(int priority, std::function<void()> fn) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    tasks_.push({priority, next_sequence_++, std::move(fn)});
+    ++num_pending_;
+  }
+  task_available_.notify_one();
+}
+
+void RuntimePool::Wait() {
+  std::unique_lock<std::mutex> lock(mu_);
+  all_done_.wait(lock, [this] { return num_pending_ == 0; });
+}
+
+const Eigen::ThreadPoolDevice* RuntimePool::intra_op_device() const {
+  return &intra_op_pool_->device;
+}
+
+void RuntimePool::WorkerLoop() {
+  while (true) {
+    std::function<void()> fn;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      task_available_.wait(
+          lock, [this] { return shutting_down_ || !tasks_.empty(); });
+      if (tasks_.empty()) {
+        return;
+      }
+      // top() is const, but the task is popped right away.
+      fn = std::move(const_cast<Task&>(tasks_.top()).fn);
+      tasks_.pop();
+    }
+    fn();
+    bool done;
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      done = --num_pending_ == 0;
+    }
+    if (done) {
+      all_done_.notify_all();
+    }
+  }
+}
+
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -0,0 +1,122 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A runtime for running many instances of classes generated by tfcompile
+// concurrently, on threads shared by all of them.
+//
+// Like the benchmark library, this is linked into AOT binaries and only depends
+// on the standard library and Eigen.
+#ifndef TENSORFLOW_COMPILER_AOT_RUNTIME_POOL_H_
+#define TENSORFLOW_COMPILER_AOT_RUNTIME_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <queue>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/core/platform/types.h"
+
+namespace Eigen {
+class ThreadPoolDevice;
+}  // namespace Eigen
+
+namespace tensorflow {
+namespace tfcompile {
+
+// RuntimePool owns two sets of threads:
+//
+// - Inter-op threads, each of which runs one scheduled function at a time,
+//   typically a call to Run() of a generated class. Pending functions are
+//   started highest priority first, and in scheduling order within a priority.
+// - An Eigen intra-op thread pool, which every instance should use through
+//   set_thread_pool(intra_op_device()) to parallelize its ops.
+//
+// Sharing one intra-op pool bounds the total number of threads regardless of
+// the number of instances. A generated class instance is not thread-safe, so
+// callers must not schedule two concurrent runs of the same instance.
+//
+// Example:
+//   RuntimePool pool(options);
+//   MyClass computation;
+//   computation.set_thread_pool(pool.intra_op_device());
+//   pool.Schedule(/*priority=*/1, [&] { computation.Run(); });
+//   pool.Wait();
+class RuntimePool {
+ public:
+  struct Options {
+    // Number of functions run concurrently.
+    int num_inter_op_threads = 1;
+
+    // Number of threads of the shared intra-op pool.
+    int num_intra_op_threads = 1;
+  };
+
+  explicit RuntimePool(const Options& options);
+
+  // Waits for all scheduled functions to complete.
+  ~RuntimePool();
+
+  RuntimePool(const RuntimePool&) = delete;
+  RuntimePool& operator=(const RuntimePool&) = delete;
+
+  // Schedules `fn` to run on an inter-op thread. Functions with a higher
+  // `priority` are started first.
+  void Schedule(int priority, std::function<void()> fn);
+
+  // Blocks until all functions scheduled so far have completed.
+  void Wait();
+
+  // The device to pass to set_thread_pool of generated classes.
+  const Eigen::ThreadPoolDevice* intra_op_device() const;
+
+  int num_inter_op_threads() const { return inter_op_threads_.size(); }
+
+ private:
+  struct Task {
+    int priority;
+    int64 sequence;
+    std::function<void()> fn;
+  };
+  struct TaskOrder {
+    bool operator()(const Task& a, const Task& b) const {
+      if (a.priority != b.priority) {
+        return a.priority < b.priority;
+      }
+      return a.sequence > b.sequence;
+    }
+  };
+
+  void WorkerLoop();
+
+  struct IntraOpPool;
+  std::unique_ptr<IntraOpPool> intra_op_pool_;
+
+  std::mutex mu_;
+  std::condition_variable task_available_;
+  std::condition_variable all_done_;
+  std::priority_queue<Task, std::vector<Task>, TaskOrder> tasks_;
+  int64 next_sequence_ = 0;
+  int64 num_pending_ = 0;  // Queued or running.
+  bool shutting_down_ = false;
+  std::vector<std::thread> inter_op_threads_;
+};
+
+}  // namespace tfcompile
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_AOT_RUNTIME_POOL_H_
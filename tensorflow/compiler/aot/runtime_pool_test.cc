@@ -0,0 +1,77 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include "tensorflow/compiler/aot/runtime_pool.h"
+
+#include <atomic>
+#include <future>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/core/platform/test.h"
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+
+namespace tensorflow {
+namespace tfcompile {
+namespace {
+
+TEST(RuntimePoolTest, RunsHigherPriorityFirst) {
+  RuntimePool::Options options;
+  options.num_inter_op_threads = 1;
+  RuntimePool pool(options);
+
+  // Block the only inter-op thread until everything else is queued.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  pool.Schedule(0, [released] { released.wait(); });
+
+  std::vector<int> order;
+  pool.Schedule(1, [&] { order.push_back(1); });
+  pool.Schedule(3, [&] { order.push_back(3); });
+  pool.Schedule(2, [&] { order.push_back(2); });
+  pool.Schedule(3, [&] { order.push_back(4); });
+  release.set_value();
+  pool.Wait();
+
+  EXPECT_EQ(order, std::vector<int>({3, 4, 2, 1}));
+}
+
+TEST(RuntimePoolTest, RunsConcurrentlyWithSharedIntraOpDevice) {
+  RuntimePool::Options options;
+  options.num_inter_op_threads = 4;
+  options.num_intra_op_threads = 2;
+  RuntimePool pool(options);
+  EXPECT_EQ(pool.num_inter_op_threads(), 4);
+  EXPECT_EQ(pool.intra_op_device()->numThreads(), 2);
+
+  std::atomic<int> sum(0);
+  for (int i = 0; i < 100; ++i) {
+    pool.Schedule(i % 3, [&] {
+      pool.intra_op_device()->parallelFor(
+          8, Eigen::TensorOpCost(1, 1, 1000),
+          [&](Eigen::Index first, Eigen::Index last) {
+            sum += static_cast<int>(last - first);
+          });
+    });
+  }
+  pool.Wait();
+
+  EXPECT_EQ(sum.load(), 800);
+}
+
+}  // namespace
+}  // namespace tfcompile
+}  // namespace tensorflow
@@ -388,6 +388,7 @@ def tf_library(
             deps = [
                 ":" + name,
                 "//tensorflow/compiler/aot:benchmark",
+                "//tensorflow/compiler/aot:runtime_pool",
                 "//tensorflow/compiler/xla:executable_run_options",
                 "//third_party/eigen3",
             ] + if_android([
@@ -78,6 +78,11 @@ struct MarkForCompilationPassFlags {
   // variable concurrency semantics.  This is unsound in general, but can be
   // used as a debugging aid.
   bool tf_xla_disable_resource_variable_safety_checks_for_debugging;
+
+  // If non-empty, the dynamic leading dimension of the inputs of clusters is
+  // padded up to these buckets, to bound the number of recompilations.  Either
+  // "pow2" for powers of two, or a comma-separated list of sizes.
+  string tf_xla_shape_buckets;
 };
 
 // Flags associated with the XLA bridge's xla_device module.
@@ -97,6 +102,20 @@ struct XlaOpsCommonFlags {
   // If true, _XlaCompile always refuses to compile the cluster, which means the
   // XLA clusters always run in the TF executor.  Defaults to false.
   bool tf_xla_always_defer_compilation;
+
+  // If non-empty, the tf2xla compilation results of XLA clusters are also
+  // cached in this directory, so that they can be reused by later processes.
+  // The directory may be on a shared file system.  Defaults to empty.
+  string tf_xla_persistent_cache_dir;
+
+  // If true, _XlaCompile compiles new signatures of lazily compiled clusters
+  // on background threads, and runs the clusters in the TF executor until the
+  // compilation completes.  Defaults to false.
+  bool tf_xla_async_compilation;
+
+  // Number of threads shared by the background compilations, which bounds how
+  // many clusters are compiled at the same time.  Defaults to 2.
+  int64 tf_xla_async_compilation_threads;
 };
 
 // Flags for the build_xla_ops pass.
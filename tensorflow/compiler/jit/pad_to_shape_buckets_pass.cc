@@ -0,0 +1,397 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/pad_to_shape_buckets_pass.h"
+
+#include <algorithm>
+#include <limits>
+#include <map>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "tensorflow/cc/framework/scope_internal.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/dump_graph.h"
+
+namespace tensorflow {
+namespace {
+
+// Elementwise ops with one input.
+const absl::flat_hash_set<string>& UnaryRowwiseOps() {
+  static const auto* ops = new absl::flat_hash_set<string>{
+      "Abs", "Cast", "Ceil", "Cos", "Elu", "Erf", "Exp", "Expm1", "Floor",
+      "Identity", "Inv", "IsFinite", "IsInf", "IsNan", "LeakyRelu", "Log",
+      "Log1p", "LogicalNot", "Neg", "OnesLike", "Reciprocal", "Relu", "Relu6",
+      "Round", "Rsqrt", "Selu", "Sigmoid", "Sign", "Sin", "Snapshot",
+      "Softplus", "Softsign", "Sqrt", "Square", "StopGradient", "Tan", "Tanh",
+      "ZerosLike"};
+  return *ops;
+}
+
+// Ops that normalize along the last dimension of an input of rank >= 2.
+const absl::flat_hash_set<string>& LastDimRowwiseOps() {
+  static const auto* ops =
+      new absl::flat_hash_set<string>{"LogSoftmax", "Softmax"};
+  return *ops;
+}
+
+// Elementwise ops with several inputs, which broadcast their inputs.
+const absl::flat_hash_set<string>& BroadcastingRowwiseOps() {
+  static const auto* ops = new absl::flat_hash_set<string>{
+      "Add", "AddV2", "BiasAdd", "Div", "DivNoNan", "Equal", "FloorDiv",
+      "FloorMod", "Greater", "GreaterEqual", "Less", "LessEqual", "LogicalAnd",
+      "LogicalOr", "Maximum", "Minimum", "Mul", "NotEqual", "Pow", "RealDiv",
+      "SelectV2", "SquaredDifference", "Sub", "TruncateDiv"};
+  return *ops;
+}
+
+const PartialTensorShape* OutputShape(const GraphShapeInfo& shapes,
+                                      const Node* n, int index) {
+  auto it = shapes.find(n->name());
+  if (it == shapes.end() || index >= it->second.size()) return nullptr;
+  return &it->second[index].shape;
+}
+
+// Returns true if `shape` has a known rank of at least 1 and an unknown
+// leading dimension.
+bool HasDynamicLeadingDim(const PartialTensorShape* shape) {
+  return shape != nullptr && !shape->unknown_rank() && shape->dims() >= 1 &&
+         shape->dim_size(0) < 0;
+}
+
+// Returns true if each row of the output of `n` only depends on the same row
+// of the inputs whose `batched_inputs` bit is set, and on the whole of the
+// other inputs.
+bool IsRowwise(const Node& n, const std::vector<bool>& batched_inputs,
+               const std::vector<const PartialTensorShape*>& input_shapes,
+               const PartialTensorShape* output_shape) {
+  if (n.num_outputs() != 1 || !HasDynamicLeadingDim(output_shape)) {
+    return false;
+  }
+  const string& op = n.type_string();
+  if (UnaryRowwiseOps().contains(op)) return true;
+  if (LastDimRowwiseOps().contains(op)) return output_shape->dims() >= 2;
+  if (op == "MatMul") {
+    bool transpose_a;
+    return !batched_inputs[1] &&
+           GetNodeAttr(n.attrs(), "transpose_a", &transpose_a).ok() &&
+           !transpose_a;
+  }
+  if (BroadcastingRowwiseOps().contains(op)) {
+    // Broadcasting aligns trailing dimensions, so the leading dimension of the
+    // output is the one of the batched inputs as long as they have the rank
+    // of the output, and the other inputs have a lower rank or broadcast
+    // along the leading dimension.
+    const int rank = output_shape->dims();
+    for (int i = 0; i < batched_inputs.size(); ++i) {
+      const PartialTensorShape* shape = input_shapes[i];
+      if (shape == nullptr || shape->unknown_rank()) return false;
+      if (batched_inputs[i]) {
+        if (shape->dims() != rank) return false;
+      } else if (shape->dims() >= rank &&
+                 !(shape->dims() == rank && shape->dim_size(0) == 1)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+// Finds the outputs of the cluster function `fbody` that have to be sliced
+// when the arguments `padded_args` are padded.  Returns false if padding
+// these arguments could change the unpadded rows of any output.
+bool FindBatchedOutputs(const FunctionBody& fbody,
+                        const std::vector<int>& padded_args,
+                        const GraphShapeInfo& shapes,
+                        std::vector<int>* batched_outputs) {
+  absl::flat_hash_set<const Node*> batched;
+  for (int arg : padded_args) {
+    batched.insert(fbody.arg_nodes[arg]);
+  }
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*fbody.graph, &order);
+  for (Node* n : order) {
+    if (n->IsArg() || !n->IsOp()) continue;
+    std::vector<bool> batched_inputs(n->num_inputs(), false);
+    std::vector<const PartialTensorShape*> input_shapes(n->num_inputs());
+    bool any_batched = false;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      batched_inputs[e->dst_input()] = batched.contains(e->src());
+      input_shapes[e->dst_input()] =
+          OutputShape(shapes, e->src(), e->src_output());
+      any_batched |= batched_inputs[e->dst_input()];
+    }
+    if (!any_batched) continue;
+
+    if (n->IsRetval()) {
+      int index;
+      if (!GetNodeAttr(n->attrs(), "index", &index).ok() ||
+          !HasDynamicLeadingDim(input_shapes[0])) {
+        return false;
+      }
+      batched_outputs->push_back(index);
+      continue;
+    }
+    if (!IsRowwise(*n, batched_inputs, input_shapes,
+                   OutputShape(shapes, n, 0))) {
+      VLOG(2) << "Not padding the arguments of "
+              << fbody.fdef.signature().name() << " because of "
+              << n->type_string() << " node " << n->name();
+      return false;
+    }
+    batched.insert(n);
+  }
+  std::sort(batched_outputs->begin(), batched_outputs->end());
+  return true;
+}
+
+// Returns the size of the leading dimension of `x`, as a scalar.
+Output LeadingDimSize(const Scope& device_scope, const Scope& host_scope,
+                      Output x) {
+  Output shape = ops::Shape(device_scope.WithOpName("shape"), x);
+  return ops::StridedSlice(host_scope.WithOpName("leading_dim"), shape, {0},
+                           {1}, {1}, ops::StridedSlice::ShrinkAxisMask(1));
+}
+
+// Rewrites the call to cluster `n` to pad the arguments `padded_args` up to
+// `buckets`, and slice the results `batched_outputs` back.
+Status PadAndSliceCluster(Graph* g, Node* n,
+                          const std::vector<int32>& buckets,
+                          const std::vector<int>& padded_args,
+                          const std::vector<int>& padded_ranks,
+                          const std::vector<int>& batched_outputs) {
+  string host_name;
+  TF_RETURN_IF_ERROR(DeviceNameUtils::DeviceNameToCpuDeviceName(
+      n->assigned_device_name(), &host_name));
+
+  Status status;
+  Scope root = NewInternalScope(g, &status, /*refiner=*/nullptr)
+                   .NewSubScope(absl::StrCat(n->name(), "/shape_buckets"));
+  Scope device_scope = root.WithAssignedDevice(n->assigned_device_name());
+  Scope host_scope = root.WithAssignedDevice(host_name);
+
+  std::vector<const Edge*> input_edges;
+  TF_RETURN_IF_ERROR(n->input_edges(&input_edges));
+  std::vector<Output> sizes;
+  for (int arg : padded_args) {
+    const Edge* e = input_edges[arg];
+    sizes.push_back(LeadingDimSize(device_scope, host_scope,
+                                   Output(e->src(), e->src_output())));
+  }
+
+  // Pad to the smallest bucket not below the leading dimension, with a
+  // sentinel for leading dimensions above all buckets, and only if the
+  // leading dimensions of all padded arguments are equal.
+  std::vector<int32> bucket_values = buckets;
+  const int32 kSentinel = std::numeric_limits<int32>::max();
+  bucket_values.push_back(kSentinel);
+  Output bucket_list = ops::Const(host_scope.WithOpName("buckets"),
+                                  gtl::ArraySlice<int32>(bucket_values));
+  Output size = sizes[0];
+  Output bucket_index = ops::LowerBound(
+      host_scope.WithOpName("bucket_index"),
+      ops::Reshape(host_scope, bucket_list, {1, -1}),
+      ops::Reshape(host_scope, size, {1, 1}));
+  Output bucket = ops::Squeeze(
+      host_scope.WithOpName("bucket"),
+      ops::Gather(host_scope, bucket_list, bucket_index));
+  Output all_sizes = ops::Stack(host_scope.WithOpName("sizes"), sizes);
+  Output sizes_equal =
+      ops::Equal(host_scope, ops::Min(host_scope, all_sizes, 0),
+                 ops::Max(host_scope, all_sizes, 0));
+  Output use_bucket = ops::LogicalAnd(
+      host_scope.WithOpName("use_bucket"), sizes_equal,
+      ops::NotEqual(host_scope, bucket, kSentinel));
+  Output padded_size = ops::SelectV2(host_scope.WithOpName("padded_size"),
+                                     use_bucket, bucket, size);
+  Output padding = ops::Sub(host_scope.WithOpName("padding"), padded_size,
+                            size);
+
+  Output zero = ops::Const(host_scope.WithOpName("zero"), 0);
+  for (int i = 0; i < padded_args.size(); ++i) {
+    const Edge* e = input_edges[padded_args[i]];
+    std::vector<Output> paddings(2 * padded_ranks[i], zero);
+    paddings[1] = padding;
+    Output paddings_matrix = ops::Reshape(
+        host_scope.WithOpName("paddings"),
+        ops::Stack(host_scope, paddings), {padded_ranks[i], 2});
+    Output padded = ops::Pad(device_scope.WithOpName("pad"),
+                             Output(e->src(), e->src_output()),
+                             paddings_matrix);
+    TF_RETURN_IF_ERROR(root.status());
+    TF_RETURN_IF_ERROR(g->UpdateEdge(padded.node(), 0, n, padded_args[i]));
+  }
+
+  for (int output : batched_outputs) {
+    std::vector<const Edge*> out_edges;
+    for (const Edge* e : n->out_edges()) {
+      if (!e->IsControlEdge() && e->src_output() == output) {
+        out_edges.push_back(e);
+      }
+    }
+    if (out_edges.empty()) continue;
+    Output result(n, output);
+    Output end = ops::Sub(host_scope.WithOpName("slice_end"),
+                          LeadingDimSize(device_scope, host_scope, result),
+                          padding);
+    Output sliced = ops::StridedSlice(
+        device_scope.WithOpName("slice"), result,
+        ops::Const(host_scope, {0}), ops::Stack(host_scope, {end}),
+        ops::Const(host_scope, {1}));
+    TF_RETURN_IF_ERROR(root.status());
+    for (const Edge* e : out_edges) {
+      TF_RETURN_IF_ERROR(
+          g->UpdateEdge(sliced.node(), 0, e->dst(), e->dst_input()));
+    }
+  }
+  TF_RETURN_IF_ERROR(status);
+  return root.status();
+}
+
+// Pads the dynamic leading dimension of the arguments of cluster `n` if
+// that can't change its results.  Sets `changed` to true if it does.
+Status MaybePadCluster(Graph* g, Node* n,
+                       const FunctionLibraryDefinition& flib_def,
+                       const GraphShapeInfo& shapes,
+                       const std::vector<int32>& buckets, bool* changed) {
+  int num_constant_args, num_resource_args;
+  TF_RETURN_IF_ERROR(
+      GetNodeAttr(n->attrs(), kXlaNumConstantArgsAttr, &num_constant_args));
+  TF_RETURN_IF_ERROR(
+      GetNodeAttr(n->attrs(), kXlaNumResourceArgsAttr, &num_resource_args));
+  const FunctionDef* fdef = flib_def.Find(n->type_string());
+  if (fdef == nullptr) return Status::OK();
+
+  std::vector<const Edge*> input_edges;
+  TF_RETURN_IF_ERROR(n->input_edges(&input_edges));
+  std::map<int, InferredShape> arg_shapes;
+  std::vector<int> padded_args;
+  std::vector<int> padded_ranks;
+  for (int i = 0; i < input_edges.size(); ++i) {
+    auto it = shapes.find(input_edges[i]->src()->name());
+    if (it != shapes.end() &&
+        input_edges[i]->src_output() < it->second.size()) {
+      arg_shapes[i] = it->second[input_edges[i]->src_output()];
+    }
+    if (i < num_constant_args || i >= n->num_inputs() - num_resource_args) {
+      continue;
+    }
+    const PartialTensorShape* shape = OutputShape(
+        shapes, input_edges[i]->src(), input_edges[i]->src_output());
+    if (shape == nullptr || shape->unknown_rank()) return Status::OK();
+    if (shape->dims() == 0 || shape->dim_size(0) >= 0) continue;
+    // All arguments with a dynamic leading dimension have to be padded
+    // together, and Pad only has kernels for all devices for floating point
+    // types.
+    if (!DataTypeIsFloating(n->input_type(i))) return Status::OK();
+    padded_args.push_back(i);
+    padded_ranks.push_back(shape->dims());
+  }
+  if (padded_args.empty()) return Status::OK();
+
+  std::unique_ptr<FunctionBody> fbody;
+  TF_RETURN_IF_ERROR(
+      FunctionDefToBodyHelper(*fdef, n->attrs(), &flib_def, &fbody));
+  GraphShapeInfo body_shapes;
+  TF_RETURN_IF_ERROR(
+      InferShapes(fbody->graph, arg_shapes, &flib_def, &body_shapes));
+  std::vector<int> batched_outputs;
+  if (!FindBatchedOutputs(*fbody, padded_args, body_shapes,
+                          &batched_outputs)) {
+    return Status::OK();
+  }
+
+  VLOG(2) << "Padding " << padded_args.size() << " arguments of cluster "
+          << n->name() << " to shape buckets";
+  TF_RETURN_IF_ERROR(PadAndSliceCluster(g, n, buckets, padded_args,
+                                        padded_ranks, batched_outputs));
+  *changed = true;
+  return Status::OK();
+}
+
+}  // namespace
+
+/*static*/ xla::StatusOr<std::vector<int32>>
+PadToShapeBucketsPass::ParseBuckets(const string& spec) {
+  std::vector<int32> buckets;
+  if (spec == "pow2") {
+    for (int shift = 0; shift <= 30; ++shift) {
+      buckets.push_back(1 << shift);
+    }
+    return buckets;
+  }
+  for (absl::string_view size : absl::StrSplit(spec, ',')) {
+    int32 bucket;
+    if (!absl::SimpleAtoi(size, &bucket) || bucket <= 0) {
+      return errors::InvalidArgument("Invalid shape bucket \"", size,
+                                     "\" in \"", spec, "\"");
+    }
+    buckets.push_back(bucket);
+  }
+  std::sort(buckets.begin(), buckets.end());
+  buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+  return buckets;
+}
+
+Status PadToShapeBucketsPass::Run(const GraphOptimizationPassOptions& options) {
+  const string& spec =
+      buckets_.has_value()
+          ? *buckets_
+          : GetMarkForCompilationPassFlags()->tf_xla_shape_buckets;
+  if (spec.empty()) return Status::OK();
+  TF_ASSIGN_OR_RETURN(std::vector<int32> buckets, ParseBuckets(spec));
+
+  Graph* graph = options.graph->get();
+  std::vector<Node*> clusters;
+  for (Node* n : graph->op_nodes()) {
+    if (IsXlaCompiledKernel(*n)) clusters.push_back(n);
+  }
+  if (clusters.empty()) return Status::OK();
+
+  GraphShapeInfo shapes;
+  TF_RETURN_IF_ERROR(
+      InferShapes(graph, /*arg_shapes=*/{}, options.flib_def, &shapes));
+  bool changed = false;
+  for (Node* n : clusters) {
+    TF_RETURN_IF_ERROR(MaybePadCluster(graph, n, *options.flib_def, shapes,
+                                       buckets, &changed));
+  }
+
+  if (changed) {
+    // We've added constants to the graph; hook them up to _SOURCE.
+    FixupSourceAndSinkEdges(graph);
+    if (GetMarkForCompilationPassFlags()->tf_xla_clustering_debug) {
+      DumpGraphToFile("pad_to_shape_buckets_pass", *graph, options.flib_def);
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,67 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_PAD_TO_SHAPE_BUCKETS_PASS_H_
+#define TENSORFLOW_COMPILER_JIT_PAD_TO_SHAPE_BUCKETS_PASS_H_
+
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "tensorflow/compiler/xla/statusor.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+
+// Bounds the number of signatures, and hence of compilations, of XLA clusters
+// whose inputs have a dynamic leading (batch) dimension, by padding that
+// dimension up to one of a fixed set of bucket sizes:
+//
+//   C(x, y) => slice(C(pad(x, b - n), pad(y, b - n)), n)
+//
+// where n is the leading dimension of x and y, and b is the smallest bucket
+// size not below n.  Each batched output of the cluster is sliced back to its
+// unpadded size, so the rewrite only costs the computation on the padding.
+//
+// This is only correct if each row of an output of the cluster only depends
+// on the same row of its inputs, so the pass only rewrites clusters made of
+// elementwise ops, and of ops like MatMul and Softmax that compute each row
+// separately.  If the leading dimensions of the inputs differ at run time,
+// e.g. because some of them are broadcast, the inputs are not padded.
+//
+// Runs on the encapsulated clusters, i.e. between EncapsulateSubgraphsPass
+// and BuildXlaOpsPass.
+class PadToShapeBucketsPass : public GraphOptimizationPass {
+ public:
+  // If `buckets` is not nullopt then it overrides the --tf_xla_shape_buckets
+  // flag.
+  explicit PadToShapeBucketsPass(
+      absl::optional<string> buckets = absl::nullopt)
+      : buckets_(std::move(buckets)) {}
+
+  Status Run(const GraphOptimizationPassOptions& options) override;
+
+  // Parses a bucket specification, which is either "pow2" for the powers of
+  // two, or a comma-separated list of positive sizes.  Returns the sizes in
+  // increasing order.
+  static xla::StatusOr<std::vector<int32>> ParseBuckets(const string& spec);
+
+ private:
+  absl::optional<string> buckets_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_PAD_TO_SHAPE_BUCKETS_PASS_H_
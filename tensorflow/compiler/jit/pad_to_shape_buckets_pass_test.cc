@@ -0,0 +1,152 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/pad_to_shape_buckets_pass.h"
+
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
+#include "tensorflow/compiler/jit/node_matchers.h"
+#include "tensorflow/compiler/jit/test_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+using ::tensorflow::testing::FindNodeByName;
+using ::tensorflow::testing::matchers::Inputs;
+using ::tensorflow::testing::matchers::Name;
+using ::tensorflow::testing::matchers::NodeWith;
+using ::tensorflow::testing::matchers::Op;
+using ::tensorflow::testing::matchers::Out;
+using ::testing::_;
+
+const char* kCpuDevice = "/job:localhost/replica:0/task:0/device:CPU:0";
+
+// Builds a graph that calls the single-input, single-output cluster function
+// `fdef` on a [?, 4] placeholder, runs PadToShapeBucketsPass on it with
+// `buckets`, and returns the result in `result`.
+Status PadToShapeBuckets(const FunctionDef& fdef, const string& buckets,
+                         std::unique_ptr<Graph>* result) {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  FunctionDefLibrary fdef_lib;
+  *fdef_lib.add_function() = fdef;
+  TF_RETURN_IF_ERROR(root.graph()->AddFunctionLibrary(fdef_lib));
+
+  Output x = ops::Placeholder(root.WithOpName("x"), DT_FLOAT,
+                              ops::Placeholder::Shape({-1, 4}));
+  NodeDef call_def;
+  call_def.set_name("C");
+  call_def.set_op(fdef.signature().name());
+  AddNodeAttr(kXlaCompiledKernelAttr, true, &call_def);
+  AddNodeAttr(kXlaNumConstantArgsAttr, 0, &call_def);
+  AddNodeAttr(kXlaNumResourceArgsAttr, 0, &call_def);
+  Status status;
+  Node* call = root.graph()->AddNode(call_def, &status);
+  TF_RETURN_IF_ERROR(status);
+  root.graph()->AddEdge(x.node(), 0, call, 0);
+  ops::Identity(root.WithOpName("out"), Output(call, 0));
+
+  auto graph = absl::make_unique<Graph>(OpRegistry::Global());
+  TF_RETURN_IF_ERROR(root.ToGraph(graph.get()));
+  for (Node* n : graph->nodes()) {
+    n->set_assigned_device_name(kCpuDevice);
+  }
+  FunctionLibraryDefinition flib_def(graph->op_registry(), fdef_lib);
+
+  GraphOptimizationPassWrapper wrapper;
+  GraphOptimizationPassOptions options =
+      wrapper.CreateGraphOptimizationPassOptions(&graph);
+  options.flib_def = &flib_def;
+  PadToShapeBucketsPass pass(buckets);
+  TF_RETURN_IF_ERROR(pass.Run(options));
+  *result = std::move(graph);
+  return Status::OK();
+}
+
+TEST(PadToShapeBucketsPassTest, PadsRowwiseCluster) {
+  FunctionDef fdef = FunctionDefHelper::Create(
+      "cluster_0", {"x: float"}, {"y: float"}, {},
+      {{{"relu"}, "Relu", {"x"}, {{"T", DT_FLOAT}}},
+       {{"tanh"}, "Tanh", {"relu:activations:0"}, {{"T", DT_FLOAT}}}},
+      {{"y", "tanh:y:0"}});
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(PadToShapeBuckets(fdef, "pow2", &graph));
+
+  Node* call = FindNodeByName(graph.get(), "C");
+  ASSERT_NE(call, nullptr);
+  EXPECT_THAT(call, NodeWith(Inputs(Out(NodeWith(
+                        Op("Pad"), Inputs(Out(NodeWith(Name("x"))), _))))));
+
+  Node* out = FindNodeByName(graph.get(), "out");
+  ASSERT_NE(out, nullptr);
+  EXPECT_THAT(out, NodeWith(Inputs(Out(NodeWith(
+                       Op("StridedSlice"),
+                       Inputs(Out(NodeWith(Name("C"))), _, _, _))))));
+}
+
+TEST(PadToShapeBucketsPassTest, DoesNotPadReduction) {
+  FunctionDef fdef = FunctionDefHelper::Create(
+      "cluster_0", {"x: float"}, {"y: float"}, {},
+      {FunctionDefHelper::Const("axis", 0),
+       {{"sum"},
+        "Sum",
+        {"x", "axis:output:0"},
+        {{"T", DT_FLOAT}, {"Tidx", DT_INT32}}}},
+      {{"y", "sum:output:0"}});
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(PadToShapeBuckets(fdef, "pow2", &graph));
+
+  Node* call = FindNodeByName(graph.get(), "C");
+  ASSERT_NE(call, nullptr);
+  EXPECT_THAT(call, NodeWith(Inputs(Out(NodeWith(Name("x"))))));
+}
+
+TEST(PadToShapeBucketsPassTest, DisabledByDefault) {
+  FunctionDef fdef = FunctionDefHelper::Create(
+      "cluster_0", {"x: float"}, {"y: float"}, {},
+      {{{"relu"}, "Relu", {"x"}, {{"T", DT_FLOAT}}}},
+      {{"y", "relu:activations:0"}});
+
+  std::unique_ptr<Graph> graph;
+  TF_ASSERT_OK(PadToShapeBuckets(fdef, "", &graph));
+
+  Node* call = FindNodeByName(graph.get(), "C");
+  ASSERT_NE(call, nullptr);
+  EXPECT_THAT(call, NodeWith(Inputs(Out(NodeWith(Name("x"))))));
+}
+
+TEST(PadToShapeBucketsPassTest, ParseBuckets) {
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<int32> buckets,
+                          PadToShapeBucketsPass::ParseBuckets("64,8,16,8"));
+  EXPECT_EQ(buckets, std::vector<int32>({8, 16, 64}));
+
+  TF_ASSERT_OK_AND_ASSIGN(buckets, PadToShapeBucketsPass::ParseBuckets("pow2"));
+  ASSERT_EQ(buckets.size(), 31);
+  EXPECT_EQ(buckets[0], 1);
+  EXPECT_EQ(buckets[30], 1 << 30);
+
+  EXPECT_FALSE(PadToShapeBucketsPass::ParseBuckets("8,x").ok());
+  EXPECT_FALSE(PadToShapeBucketsPass::ParseBuckets("0").ok());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -15,13 +15,16 @@ limitations under the License.
 
 #include "tensorflow/compiler/jit/xla_compilation_cache.h"
 
+#include <algorithm>
 #include <numeric>
 
 #include "absl/base/call_once.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/xla_activity.pb.h"
 #include "tensorflow/compiler/jit/xla_activity_listener.h"
+#include "tensorflow/compiler/jit/xla_persistent_cache.h"
 #include "tensorflow/compiler/mlir/tensorflow/utils/compile_mlir_util.h"
 #include "tensorflow/compiler/tf2xla/shape_util.h"
 #include "tensorflow/compiler/tf2xla/type_util.h"
@@ -40,6 +43,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/protobuf/graph_debug_info.pb.h"
@@ -55,6 +59,15 @@ XlaCompilationCache::XlaCompilationCache(xla::LocalClient* client,
     : client_(client), device_type_(std::move(device_type)) {}
 
 XlaCompilationCache::~XlaCompilationCache() {
+  // Background compilations refer to the cache entries, so cancel those that
+  // haven't started and wait for the others.
+  {
+    mutex_lock lock(async_compile_mu_);
+    async_compiles_cancelled_ = true;
+    while (num_pending_async_compiles_ > 0) {
+      async_compile_cv_.wait(lock);
+    }
+  }
   // Ensure any use of our programs have completed by waiting for all stream
   // executors to complete.
   for (auto* executor : client_->backend().stream_executors()) {
@@ -176,6 +189,75 @@ Status XlaCompilationCache::BuildExecutable(
   return Status::OK();
 }
 
+string XlaCompilationCache::PersistentCacheKey(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    absl::Span<const XlaCompiler::Argument> args,
+    const XlaCompiler::CompileOptions& compile_options) {
+  if (options.flib_def == nullptr) return "";
+  const FunctionDef* fdef = options.flib_def->Find(function.name());
+  if (fdef == nullptr) return "";
+
+  string key = absl::StrCat("version ", TF_VERSION_STRING, " ",
+                            tf_git_version(), " ", options.graph_def_version,
+                            "\n");
+  // The device description keeps entries of different device generations
+  // apart, as their lowering may differ.
+  absl::StrAppend(&key, "device ", device_type_.type_string(), " ",
+                  options.device_type.type_string(), " ",
+                  client_->platform()->Name());
+  const int device_ordinal = options.device_ordinal != -1
+                                 ? options.device_ordinal
+                                 : client_->default_device_ordinal();
+  auto executor = client_->backend().stream_executor(device_ordinal);
+  if (executor.ok()) {
+    const se::DeviceDescription& description =
+        executor.ValueOrDie()->GetDeviceDescription();
+    absl::StrAppend(&key, " ", description.name(), " ",
+                    description.platform_version(), " ",
+                    description.driver_version());
+  }
+  absl::StrAppend(&key, "\noptions ", options.allow_cpu_custom_calls,
+                  options.custom_fake_quant_op_calls,
+                  options.alias_passthrough_params,
+                  compile_options.use_tuple_arg,
+                  compile_options.return_updated_values_for_all_resources,
+                  compile_options.always_return_tuple,
+                  compile_options.is_entry_computation,
+                  compile_options.add_token_input_output,
+                  compile_options.alias_resource_update, "\n");
+
+  absl::StrAppend(&key, "function ",
+                  Canonicalize(function.name(), AttrSlice(&function.attr())),
+                  "\n");
+  for (const XlaCompiler::Argument& arg : args) {
+    absl::StrAppend(&key, "arg ", arg.HumanString(), "\n");
+    if (arg.kind == XlaCompiler::Argument::kConstant) {
+      TensorProto constant;
+      arg.constant_value.AsProtoTensorContent(&constant);
+      string serialized;
+      if (!SerializeToStringDeterministic(constant, &serialized)) return "";
+      absl::StrAppend(&key, serialized, "\n");
+    }
+  }
+
+  // The cluster and all functions it calls, in a deterministic order.
+  std::vector<string> names =
+      options.flib_def->ReachableDefinitions(*fdef).ListFunctionNames();
+  names.push_back(function.name());
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  for (const string& name : names) {
+    const FunctionDef* reachable = options.flib_def->Find(name);
+    string serialized;
+    if (reachable == nullptr ||
+        !SerializeToStringDeterministic(*reachable, &serialized)) {
+      return "";
+    }
+    absl::StrAppend(&key, "fdef ", serialized, "\n");
+  }
+  return key;
+}
+
 Status XlaCompilationCache::Compile(
     const XlaCompiler::Options& options, const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args,
@@ -187,15 +269,70 @@ Status XlaCompilationCache::Compile(
   if (compile_mode == CompileMode::kLazy) {
     compile_threshold = kDefaultCompilationThreshold;
   }
-  auto compile_fn = [&](XlaCompiler* compiler,
-                        XlaCompiler::CompilationResult* result) {
-    return compiler->CompileFunction(compile_options, function, args, result);
-  };
-  return CompileImpl(options, function, args, compile_fn,
+  CompileFn compile_fn;
+  if (compile_mode == CompileMode::kAsync) {
+    // The compilation may run after this call returns, so it works on copies
+    // of the arguments.
+    auto owned_args =
+        std::make_shared<const std::vector<XlaCompiler::Argument>>(
+            args.begin(), args.end());
+    compile_fn = [this, function, owned_args, compile_options](
+                     XlaCompiler* compiler,
+                     XlaCompiler::CompilationResult* result) {
+      return CompileFunction(compiler, function, *owned_args, compile_options,
+                             result);
+    };
+  } else {
+    compile_fn = [&](XlaCompiler* compiler,
+                     XlaCompiler::CompilationResult* result) {
+      return CompileFunction(compiler, function, args, compile_options,
+                             result);
+    };
+  }
+  return CompileImpl(options, function, args, std::move(compile_fn),
                      /*compile_threshold=*/compile_threshold,
+                     /*async=*/compile_mode == CompileMode::kAsync,
                      out_compilation_result, out_executable);
 }
 
+Status XlaCompilationCache::CompileFunction(
+    XlaCompiler* compiler, const NameAttrList& function,
+    absl::Span<const XlaCompiler::Argument> args,
+    const XlaCompiler::CompileOptions& compile_options,
+    XlaCompiler::CompilationResult* result) {
+  XlaPersistentCache* persistent_cache = XlaPersistentCache::Global();
+  string key;
+  if (persistent_cache != nullptr) {
+    key = PersistentCacheKey(compiler->options(), function, args,
+                             compile_options);
+  }
+  if (!key.empty()) {
+    Status status = persistent_cache->Lookup(key, result);
+    if (status.ok()) {
+      VLOG(1) << "Loaded " << function.name()
+              << " from the persistent compilation cache";
+      return Status::OK();
+    }
+    if (!errors::IsNotFound(status)) {
+      LOG(WARNING) << "Ignoring persistent compilation cache entry of "
+                   << function.name() << ": " << status;
+    }
+  }
+  TF_RETURN_IF_ERROR(
+      compiler->CompileFunction(compile_options, function, args, result));
+  if (!key.empty()) {
+    // A failure to persist the result only costs a later recompilation.
+    Status status = persistent_cache->Store(
+        key, Canonicalize(function.name(), AttrSlice(&function.attr())),
+        *result);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to persist the compilation of "
+                   << function.name() << ": " << status;
+    }
+  }
+  return Status::OK();
+}
+
 static bool ShouldBeMegamorphic(int64 compile_count, int64 execution_count) {
   const int64 kCompileThreshold = 10;
   const int64 kMinExecutionsPerCompile = 50;
@@ -253,6 +390,32 @@ static xla::StatusOr<std::unique_ptr<Graph>> CreateGraph(
   return graph;
 }
 
+// Results of compiling single ops with the MLIR bridge, shared by the caches of
+// all devices. Importing and legalizing an op only depends on its signature and
+// on the device type, which determines the shape representation, so devices of
+// the same type reuse each other's results and only build their own
+// executables.
+struct MlirSingleOpResults {
+  mutex mu;
+  absl::flat_hash_map<XlaCompilationCache::Signature,
+                      XlaCompiler::CompilationResult,
+                      XlaCompilationCache::Signature::Hash>
+      results TF_GUARDED_BY(mu);
+};
+
+static MlirSingleOpResults* GetMlirSingleOpResults() {
+  static MlirSingleOpResults* results = new MlirSingleOpResults;
+  return results;
+}
+
+// Returns whether `function` refers to other functions, whose definitions may
+// differ between function libraries even when their names match.
+static bool HasFunctionAttr(const NameAttrList& function) {
+  return absl::c_any_of(function.attr(), [](const auto& attr) {
+    return attr.second.has_func() || attr.second.list().func_size() > 0;
+  });
+}
+
 Status XlaCompilationCache::CompileSingleOp(
     const XlaCompiler::Options& options,
     absl::Span<const XlaCompiler::Argument> args, OpKernelContext* ctx,
@@ -295,14 +458,37 @@ Status XlaCompilationCache::CompileSingleOp(
     for (const XlaCompiler::Argument& arg : args) {
       arg_shapes.push_back(absl::get<TensorShape>(arg.shape));
     }
+
+    TF_ASSIGN_OR_RETURN(Signature signature, BuildSignature(name, args));
+    signature.name =
+        absl::StrCat(device_type_.type_string(), "/",
+                     compile_options.use_tuple_arg ? "tuple/" : "",
+                     signature.name);
+    const bool shareable = !HasFunctionAttr(name);
+    MlirSingleOpResults* shared = GetMlirSingleOpResults();
+    if (shareable) {
+      mutex_lock lock(shared->mu);
+      auto it = shared->results.find(signature);
+      if (it != shared->results.end()) {
+        VLOG(2) << "Reusing MLIR legalization of " << signature.HumanString();
+        *result = it->second;
+        return Status::OK();
+      }
+    }
+
     GraphDebugInfo debug_info;
-    return CompileGraphToXlaHlo(*graph, {arg_shapes.data(), arg_shapes.size()},
-                                compile_options.use_tuple_arg,
-                                *options.flib_def, debug_info,
-                                options.shape_representation_fn, result);
+    TF_RETURN_IF_ERROR(CompileGraphToXlaHlo(
+        *graph, {arg_shapes.data(), arg_shapes.size()},
+        compile_options.use_tuple_arg, *options.flib_def, debug_info,
+        options.shape_representation_fn, result));
+    if (shareable) {
+      mutex_lock lock(shared->mu);
+      shared->results.emplace(std::move(signature), *result);
+    }
+    return Status::OK();
   };
   return CompileImpl(options, name, args, compile_op,
-                     /*compile_threshold=*/absl::nullopt,
+                     /*compile_threshold=*/absl::nullopt, /*async=*/false,
                      out_compilation_result, out_executable);
 }
 
@@ -318,14 +504,22 @@ void LogOnceXlaCompiledFirstCluster() {
                  "once for the lifetime of the process.";
   });
 }
+
+// Returns the threads shared by the background compilations of all caches,
+// whose number bounds how many clusters compile at the same time.
+thread::ThreadPool* AsyncCompilationThreadPool() {
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "xla_async_compilation",
+      std::max<int64>(
+          1, GetXlaOpsCommonFlags().tf_xla_async_compilation_threads));
+  return pool;
+}
 }  // namespace
 
 Status XlaCompilationCache::CompileImpl(
     const XlaCompiler::Options& options, const NameAttrList& function,
     absl::Span<const XlaCompiler::Argument> args,
-    const std::function<Status(XlaCompiler* compiler,
-                               XlaCompiler::CompilationResult*)>& compile_fn,
-    absl::optional<int64> compile_threshold,
+    CompileFn compile_fn, absl::optional<int64> compile_threshold, bool async,
     const XlaCompiler::CompilationResult** out_compilation_result,
     xla::LocalExecutable** out_executable) {
   DCHECK_NE(out_executable, nullptr);
@@ -396,9 +590,16 @@ Status XlaCompilationCache::CompileImpl(
           << current_request_count << " and compile threshold "
           << compile_threshold.value_or(0);
   if (!entry->compiled) {
+    if (entry->compiling) {
+      VLOG(2) << "Still compiling signature: " << signature.HumanString();
+      *out_compilation_result = nullptr;
+      *out_executable = nullptr;
+      return Status::OK();
+    }
+
     XLA_SCOPED_LOGGING_TIMER("Compilation of XLA executable");
     const bool should_compile = [&] {
-      if (!compile_threshold.has_value()) {
+      if (!compile_threshold.has_value() && !async) {
         // Lazy compilation is disabled.
         return true;
       }
@@ -412,7 +613,7 @@ Status XlaCompilationCache::CompileImpl(
         return false;
       }
 
-      if (is_first_execution) {
+      if (is_first_execution || !compile_threshold.has_value()) {
         return true;
       }
 
@@ -435,52 +636,22 @@ Status XlaCompilationCache::CompileImpl(
       return Status::OK();
     }
 
-    tensorflow::Env* env = tensorflow::Env::Default();
-    const uint64 compile_start_us = env->NowMicros();
-    // Do the actual JIT compilation without holding the lock (it can take
-    // a long time.)
+    if (async) {
+      VLOG(2) << "Compiling asynchronously for signature: "
+              << signature.HumanString();
+      entry->compiling = true;
+      CompileAsync(entry, options, function, std::move(compile_fn));
+      *out_compilation_result = nullptr;
+      *out_executable = nullptr;
+      return Status::OK();
+    }
 
-    XlaCompiler compiler(options);
     entry->compiled = true;
-
-    entry->compilation_status =
-        compile_fn(&compiler, &entry->compilation_result);
-    TF_RETURN_IF_ERROR(entry->compilation_status);
     CHECK_EQ(entry->executable.get(), nullptr);
-    entry->compilation_status =
-        BuildExecutable(options, entry->compilation_result, &entry->executable);
-
-    const uint64 compile_end_us = env->NowMicros();
-    const uint64 compile_time_us = compile_end_us - compile_start_us;
-    metrics::UpdateXlaCompilationTime(compile_time_us);
-    {
-      mutex_lock lock(cluster_compile_stats_mu_);
-      auto it = cluster_compile_stats_.find(function.name());
-      it->second.compile_count++;
-      it->second.cumulative_compile_time_us += compile_time_us;
-      LogOnceXlaCompiledFirstCluster();
-      VLOG(1) << "compiled " << function.name() << " "
-              << it->second.compile_count
-              << " times, compile time: " << compile_time_us
-              << " us, cumulative: " << it->second.cumulative_compile_time_us
-              << " us ("
-              << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
-                                                               1.0e6)
-              << " / "
-              << tensorflow::strings::HumanReadableElapsedTime(
-                     it->second.cumulative_compile_time_us / 1.0e6)
-              << ")";
-
-      XlaJitCompilationActivity jit_compilation_activity;
-      jit_compilation_activity.set_cluster_name(function.name());
-      jit_compilation_activity.set_compile_count(it->second.compile_count);
-      jit_compilation_activity.set_compile_time_us(compile_time_us);
-      jit_compilation_activity.set_cumulative_compile_time_us(
-          it->second.cumulative_compile_time_us);
-
-      TF_RETURN_IF_ERROR(
-          BroadcastXlaActivity(std::move(jit_compilation_activity)));
-    }
+    TF_RETURN_IF_ERROR(CompileAndRecord(
+        options, function, compile_fn, /*async=*/false,
+        &entry->compilation_result, &entry->executable,
+        &entry->compilation_status));
   }
   TF_RETURN_IF_ERROR(entry->compilation_status);
   *out_compilation_result = &entry->compilation_result;
@@ -488,4 +659,117 @@ Status XlaCompilationCache::CompileImpl(
   return Status::OK();
 }
 
+Status XlaCompilationCache::CompileAndRecord(
+    const XlaCompiler::Options& options, const NameAttrList& function,
+    const CompileFn& compile_fn, bool async,
+    XlaCompiler::CompilationResult* result,
+    std::unique_ptr<xla::LocalExecutable>* executable,
+    Status* compilation_status) {
+  tensorflow::Env* env = tensorflow::Env::Default();
+  const uint64 compile_start_us = env->NowMicros();
+  // Do the actual JIT compilation without holding the lock (it can take
+  // a long time.)
+
+  XlaCompiler compiler(options);
+
+  *compilation_status = compile_fn(&compiler, result);
+  if (!compilation_status->ok()) return Status::OK();
+  *compilation_status = BuildExecutable(options, *result, executable);
+
+  const uint64 compile_end_us = env->NowMicros();
+  const uint64 compile_time_us = compile_end_us - compile_start_us;
+  metrics::UpdateXlaCompilationTime(compile_time_us);
+  {
+    mutex_lock lock(cluster_compile_stats_mu_);
+    auto it = cluster_compile_stats_.find(function.name());
+    it->second.compile_count++;
+    it->second.cumulative_compile_time_us += compile_time_us;
+    LogOnceXlaCompiledFirstCluster();
+    VLOG(1) << "compiled " << function.name() << " "
+            << it->second.compile_count
+            << " times, compile time: " << compile_time_us
+            << " us, cumulative: " << it->second.cumulative_compile_time_us
+            << " us ("
+            << tensorflow::strings::HumanReadableElapsedTime(compile_time_us /
+                                                             1.0e6)
+            << " / "
+            << tensorflow::strings::HumanReadableElapsedTime(
+                   it->second.cumulative_compile_time_us / 1.0e6)
+            << ")";
+
+    XlaJitCompilationActivity jit_compilation_activity;
+    jit_compilation_activity.set_cluster_name(function.name());
+    jit_compilation_activity.set_compile_count(it->second.compile_count);
+    jit_compilation_activity.set_compile_time_us(compile_time_us);
+    jit_compilation_activity.set_cumulative_compile_time_us(
+        it->second.cumulative_compile_time_us);
+    jit_compilation_activity.set_async(async);
+
+    TF_RETURN_IF_ERROR(
+        BroadcastXlaActivity(std::move(jit_compilation_activity)));
+  }
+  return Status::OK();
+}
+
+void XlaCompilationCache::CompileAsync(Entry* entry,
+                                       const XlaCompiler::Options& options,
+                                       const NameAttrList& function,
+                                       CompileFn compile_fn) {
+  {
+    mutex_lock lock(async_compile_mu_);
+    ++num_pending_async_compiles_;
+  }
+  // The compilation outlives the step that requested it, so it works on its
+  // own copy of the function library and doesn't use the step's allocator.
+  XlaCompiler::Options async_options = options;
+  std::shared_ptr<const FunctionLibraryDefinition> flib_def;
+  if (options.flib_def != nullptr) {
+    flib_def = std::make_shared<FunctionLibraryDefinition>(*options.flib_def);
+  }
+  async_options.flib_def = flib_def.get();
+  async_options.device_allocator = nullptr;
+
+  AsyncCompilationThreadPool()->Schedule([this, entry, async_options, flib_def,
+                                          function, compile_fn]() {
+    bool cancelled;
+    {
+      mutex_lock lock(async_compile_mu_);
+      cancelled = async_compiles_cancelled_;
+    }
+
+    XlaCompiler::CompilationResult result;
+    std::unique_ptr<xla::LocalExecutable> executable;
+    Status compilation_status;
+    if (cancelled) {
+      VLOG(2) << "Cancelled the compilation of " << function.name();
+    } else {
+      XLA_SCOPED_LOGGING_TIMER("Asynchronous compilation of XLA executable");
+      Status status =
+          CompileAndRecord(async_options, function, compile_fn,
+                           /*async=*/true, &result, &executable,
+                           &compilation_status);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to record the compilation of "
+                     << function.name() << ": " << status;
+      }
+    }
+
+    {
+      mutex_lock lock(entry->mu);
+      entry->compiling = false;
+      if (!cancelled) {
+        entry->compiled = true;
+        entry->compilation_status = compilation_status;
+        entry->compilation_result = std::move(result);
+        entry->executable = std::move(executable);
+      }
+    }
+
+    mutex_lock lock(async_compile_mu_);
+    if (--num_pending_async_compiles_ == 0) {
+      async_compile_cv_.notify_all();
+    }
+  });
+}
+
 }  // namespace tensorflow
@@ -50,6 +50,7 @@ class XlaCompilationCache : public ResourceBase {
   enum class CompileMode {
     kLazy,
     kStrict,
+    kAsync,
   };
 
   // Compiles a function into a XlaCompiler::CompilationResult that can be used
@@ -62,7 +63,10 @@ class XlaCompilationCache : public ResourceBase {
   // heuristics, the compilation cache may decide not to compile the cluster at
   // this time.  In this case it returns null into both `out_compilation_result`
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
-  // cache always attempts the compilation on a cache miss.
+  // cache always attempts the compilation on a cache miss.  If `compile_mode`
+  // is `kAsync` then the compilation cache starts the compilation on a
+  // background thread on a cache miss, and returns null results until it
+  // completes, so the caller is never blocked by a compilation.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -123,22 +127,57 @@ class XlaCompilationCache : public ResourceBase {
       absl::Span<const XlaCompiler::Argument> args);
 
  private:
-  // Common implementation of Compile and CompileSingleOp.
+  struct Entry;
+  using CompileFn = std::function<Status(XlaCompiler* compiler,
+                                         XlaCompiler::CompilationResult*)>;
+
+  // Common implementation of Compile and CompileSingleOp.  If `async` is
+  // true, `compile_fn` must not refer to any state of the caller, as it may
+  // run after CompileImpl returns.
   Status CompileImpl(
       const XlaCompiler::Options& options, const NameAttrList& function,
-      absl::Span<const XlaCompiler::Argument> args,
-      const std::function<Status(XlaCompiler* compiler,
-                                 XlaCompiler::CompilationResult*)>& compile_fn,
-      absl::optional<int64> compile_threshold,
+      absl::Span<const XlaCompiler::Argument> args, CompileFn compile_fn,
+      absl::optional<int64> compile_threshold, bool async,
       const XlaCompiler::CompilationResult** out_compilation_result,
       xla::LocalExecutable** out_executable);
 
+  // Compiles `function` into `result` and `executable` using `compile_fn`,
+  // and records the compilation in the statistics of the cluster.  The status
+  // of the compilation is returned in `compilation_status`; the returned
+  // status only reports failures to record the compilation.
+  Status CompileAndRecord(
+      const XlaCompiler::Options& options, const NameAttrList& function,
+      const CompileFn& compile_fn, bool async,
+      XlaCompiler::CompilationResult* result,
+      std::unique_ptr<xla::LocalExecutable>* executable,
+      Status* compilation_status);
+
+  // Schedules the compilation of `entry` on the background compilation
+  // threads.
+  void CompileAsync(Entry* entry, const XlaCompiler::Options& options,
+                    const NameAttrList& function, CompileFn compile_fn);
+
+  // Compiles `function` with `compiler`, through the persistent cache if it
+  // is enabled.
+  Status CompileFunction(XlaCompiler* compiler, const NameAttrList& function,
+                         absl::Span<const XlaCompiler::Argument> args,
+                         const XlaCompiler::CompileOptions& compile_options,
+                         XlaCompiler::CompilationResult* result);
+
   // Takes `result` which has been compiled from a Tensorflow subgraph to a
   // XLA computation already, and generates an XLA LocalExecutable `executable`.
   Status BuildExecutable(const XlaCompiler::Options& options,
                          const XlaCompiler::CompilationResult& result,
                          std::unique_ptr<xla::LocalExecutable>* executable);
 
+  // Builds the key of the compilation of `function` in the persistent cache,
+  // which encodes everything the compilation result depends on.  Returns an
+  // empty string if the compilation can't be persisted.
+  string PersistentCacheKey(const XlaCompiler::Options& options,
+                            const NameAttrList& function,
+                            absl::Span<const XlaCompiler::Argument> args,
+                            const XlaCompiler::CompileOptions& compile_options);
+
   xla::LocalClient* const client_;
   const DeviceType device_type_;
 
@@ -149,6 +188,9 @@ class XlaCompilationCache : public ResourceBase {
     // Have we tried compiling this entry?
     bool compiled = false;
 
+    // Is a background compilation of this entry in progress?
+    bool compiling = false;
+
     // The number of times a compilation with this signature has been requested.
     int64 request_count = 0;
 
@@ -163,6 +205,13 @@ class XlaCompilationCache : public ResourceBase {
     std::unique_ptr<xla::LocalExecutable> executable TF_GUARDED_BY(mu);
   };
 
+  // Tracks the background compilations of this cache, which the destructor
+  // cancels if they haven't started yet, and otherwise waits for.
+  mutex async_compile_mu_;
+  condition_variable async_compile_cv_;
+  int64 num_pending_async_compiles_ TF_GUARDED_BY(async_compile_mu_) = 0;
+  bool async_compiles_cancelled_ TF_GUARDED_BY(async_compile_mu_) = false;
+
   mutex compile_cache_mu_;
   absl::flat_hash_map<Signature, std::unique_ptr<Entry>, Signature::Hash> cache_
       TF_GUARDED_BY(compile_cache_mu_);
@@ -0,0 +1,198 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_persistent_cache.h"
+
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/compiler/xla/shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+Status ToTensorShape(const TensorShapeProto& proto, TensorShape* shape) {
+  TF_RETURN_IF_ERROR(TensorShape::IsValidShape(proto));
+  *shape = TensorShape(proto);
+  return Status::OK();
+}
+
+}  // namespace
+
+XlaPersistentCache::XlaPersistentCache(string directory, Env* env)
+    : directory_(std::move(directory)), env_(env) {}
+
+/*static*/ XlaPersistentCache* XlaPersistentCache::Global() {
+  static XlaPersistentCache* cache = []() -> XlaPersistentCache* {
+    const string& directory =
+        GetXlaOpsCommonFlags().tf_xla_persistent_cache_dir;
+    if (directory.empty()) return nullptr;
+    VLOG(1) << "Persisting XLA compilation results in " << directory;
+    return new XlaPersistentCache(directory);
+  }();
+  return cache;
+}
+
+/*static*/ string XlaPersistentCache::KeyFingerprint(const string& key) {
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+string XlaPersistentCache::FilePath(const string& key_fingerprint) const {
+  return io::JoinPath(directory_,
+                      absl::StrCat(key_fingerprint, ".xla_cache_entry"));
+}
+
+Status XlaPersistentCache::Lookup(const string& key,
+                                  XlaCompiler::CompilationResult* result) {
+  const string key_fingerprint = KeyFingerprint(key);
+  const string path = FilePath(key_fingerprint);
+  string serialized;
+  TF_RETURN_IF_ERROR(ReadFileToString(env_, path, &serialized));
+  XlaPersistentCacheEntry entry;
+  if (!entry.ParseFromString(serialized)) {
+    return errors::DataLoss("Can't parse XLA compilation cache entry ", path);
+  }
+  if (entry.key_fingerprint() != key_fingerprint) {
+    return errors::NotFound("XLA compilation cache entry ", path,
+                            " was stored under another key");
+  }
+  return DeserializeCompilationResult(entry, result);
+}
+
+Status XlaPersistentCache::Store(const string& key, const string& signature,
+                                 const XlaCompiler::CompilationResult& result) {
+  XlaPersistentCacheEntry entry;
+  TF_RETURN_IF_ERROR(SerializeCompilationResult(result, &entry));
+  entry.set_key_fingerprint(KeyFingerprint(key));
+  entry.set_signature(signature);
+  string serialized;
+  if (!entry.SerializeToString(&serialized)) {
+    return errors::Internal("Can't serialize XLA compilation cache entry for ",
+                            signature);
+  }
+
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  // Write to a file name unique to this writer first, so that other processes
+  // sharing the directory only ever read complete entries.
+  const string path = FilePath(entry.key_fingerprint());
+  const string tmp_path = absl::StrCat(path, ".tmp.", random::New64());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env_, tmp_path, serialized));
+  Status status = env_->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env_->DeleteFile(tmp_path).IgnoreError();
+  }
+  return status;
+}
+
+/*static*/ Status XlaPersistentCache::SerializeCompilationResult(
+    const XlaCompiler::CompilationResult& result,
+    XlaPersistentCacheEntry* entry) {
+  if (result.computation == nullptr) {
+    return errors::InvalidArgument(
+        "Compilation result without a computation can't be persisted");
+  }
+  for (int index : result.input_mapping) {
+    entry->add_input_mapping(index);
+  }
+  for (const xla::Shape& shape : result.xla_input_shapes) {
+    *entry->add_xla_input_shapes() = shape.ToProto();
+  }
+  *entry->mutable_xla_output_shape() = result.xla_output_shape.ToProto();
+  for (const XlaCompiler::OutputDescription& output : result.outputs) {
+    XlaPersistentCacheEntry::OutputDescription* output_proto =
+        entry->add_outputs();
+    output_proto->set_type(output.type);
+    output.shape.AsProto(output_proto->mutable_shape());
+    output_proto->set_is_constant(output.is_constant);
+    if (output.is_constant) {
+      output.constant_value.AsProtoTensorContent(
+          output_proto->mutable_constant_value());
+    }
+    output_proto->set_input_index(output.input_index);
+    output_proto->set_is_tensor_list(output.is_tensor_list);
+  }
+  *entry->mutable_host_compute_metadata() = result.host_compute_metadata;
+  for (const XlaCompiler::ResourceUpdate& update : result.resource_updates) {
+    XlaPersistentCacheEntry::ResourceUpdate* update_proto =
+        entry->add_resource_updates();
+    update_proto->set_input_index(update.input_index);
+    update_proto->set_type(update.type);
+    update.shape.AsProto(update_proto->mutable_shape());
+    update_proto->set_modified(update.modified);
+    for (const string& gradient : update.tensor_array_gradients_accessed) {
+      update_proto->add_tensor_array_gradients_accessed(gradient);
+    }
+  }
+  *entry->mutable_hlo_module() = result.computation->proto();
+  return Status::OK();
+}
+
+/*static*/ Status XlaPersistentCache::DeserializeCompilationResult(
+    const XlaPersistentCacheEntry& entry,
+    XlaCompiler::CompilationResult* result) {
+  result->input_mapping.assign(entry.input_mapping().begin(),
+                               entry.input_mapping().end());
+  result->xla_input_shapes.clear();
+  for (const xla::ShapeProto& shape : entry.xla_input_shapes()) {
+    result->xla_input_shapes.emplace_back(shape);
+  }
+  result->xla_output_shape = xla::Shape(entry.xla_output_shape());
+  result->outputs.clear();
+  for (const auto& output_proto : entry.outputs()) {
+    XlaCompiler::OutputDescription output;
+    output.type = output_proto.type();
+    TF_RETURN_IF_ERROR(ToTensorShape(output_proto.shape(), &output.shape));
+    output.is_constant = output_proto.is_constant();
+    if (output.is_constant &&
+        !output.constant_value.FromProto(output_proto.constant_value())) {
+      return errors::DataLoss(
+          "Invalid constant output in XLA compilation cache entry");
+    }
+    output.input_index = output_proto.input_index();
+    output.is_tensor_list = output_proto.is_tensor_list();
+    result->outputs.push_back(std::move(output));
+  }
+  result->host_compute_metadata = entry.host_compute_metadata();
+  result->resource_updates.clear();
+  for (const auto& update_proto : entry.resource_updates()) {
+    XlaCompiler::ResourceUpdate update;
+    update.input_index = update_proto.input_index();
+    update.type = update_proto.type();
+    TF_RETURN_IF_ERROR(ToTensorShape(update_proto.shape(), &update.shape));
+    update.modified = update_proto.modified();
+    update.tensor_array_gradients_accessed.insert(
+        update_proto.tensor_array_gradients_accessed().begin(),
+        update_proto.tensor_array_gradients_accessed().end());
+    result->resource_updates.push_back(std::move(update));
+  }
+  result->computation =
+      std::make_shared<xla::XlaComputation>(entry.hlo_module());
+  return Status::OK();
+}
+
+}  // namespace tensorflow
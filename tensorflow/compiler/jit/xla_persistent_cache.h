@@ -0,0 +1,83 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_PERSISTENT_CACHE_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_PERSISTENT_CACHE_H_
+
+#include "tensorflow/compiler/jit/xla_persistent_cache.pb.h"
+#include "tensorflow/compiler/tf2xla/xla_compiler.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// An on-disk cache of the tf2xla compilation results of XLA clusters, which
+// outlives the process and can be shared by several processes through a
+// shared file system.
+//
+// Entries are keyed by an arbitrary string, which the caller builds from
+// everything the compilation result depends on, and are stored in one file
+// per key, named after a fingerprint of the key.  Files are written under a
+// temporary name and renamed into place, so that concurrent readers never
+// see a partially written entry.
+//
+// Only the tf2xla part of a compilation is cached: the XLA backend still
+// compiles the cached HLO module when an entry is loaded, since the backends
+// can't serialize their executables.
+class XlaPersistentCache {
+ public:
+  explicit XlaPersistentCache(string directory, Env* env = Env::Default());
+
+  // Returns the cache in the directory named by --tf_xla_persistent_cache_dir,
+  // or nullptr if that flag is empty.
+  static XlaPersistentCache* Global();
+
+  // Loads the entry stored under `key` into `result`.  Returns a NotFound
+  // error if there is no such entry.
+  Status Lookup(const string& key, XlaCompiler::CompilationResult* result);
+
+  // Stores `result` under `key`, replacing any existing entry.  `signature`
+  // is recorded in the entry for debugging only.
+  Status Store(const string& key, const string& signature,
+               const XlaCompiler::CompilationResult& result);
+
+  // Converts a compilation result to and from its serialized form.
+  static Status SerializeCompilationResult(
+      const XlaCompiler::CompilationResult& result,
+      XlaPersistentCacheEntry* entry);
+  static Status DeserializeCompilationResult(
+      const XlaPersistentCacheEntry& entry,
+      XlaCompiler::CompilationResult* result);
+
+  const string& directory() const { return directory_; }
+
+ private:
+  // Returns the fingerprint of `key`, as a hex string.
+  static string KeyFingerprint(const string& key);
+
+  // Returns the path of the file of the entry with `key_fingerprint`.
+  string FilePath(const string& key_fingerprint) const;
+
+  const string directory_;
+  Env* const env_;  // Not owned
+
+  TF_DISALLOW_COPY_AND_ASSIGN(XlaPersistentCache);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_PERSISTENT_CACHE_H_
@@ -0,0 +1,112 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_persistent_cache.h"
+
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+#include "tensorflow/compiler/xla/client/xla_computation.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+XlaCompiler::CompilationResult MakeCompilationResult() {
+  const xla::Shape shape = xla::ShapeUtil::MakeShape(xla::F32, {2});
+  xla::XlaBuilder builder("persisted");
+  xla::Tuple(&builder, {xla::Add(xla::Parameter(&builder, 0, shape, "x"),
+                                 xla::Parameter(&builder, 1, shape, "y"))});
+  xla::XlaComputation computation = builder.Build().ValueOrDie();
+
+  XlaCompiler::CompilationResult result;
+  result.input_mapping = {0, 2};
+  result.xla_input_shapes = {shape, shape};
+  result.xla_output_shape = xla::ShapeUtil::MakeTupleShape({shape});
+  result.outputs.resize(2);
+  result.outputs[0].type = DT_FLOAT;
+  result.outputs[0].shape = TensorShape({2});
+  result.outputs[0].input_index = -1;
+  result.outputs[1].type = DT_INT32;
+  result.outputs[1].shape = TensorShape({3});
+  result.outputs[1].is_constant = true;
+  result.outputs[1].constant_value = test::AsTensor<int32>({1, 2, 3});
+  result.outputs[1].input_index = -1;
+  result.resource_updates.resize(1);
+  result.resource_updates[0].input_index = 1;
+  result.resource_updates[0].type = DT_FLOAT;
+  result.resource_updates[0].shape = TensorShape({2});
+  result.resource_updates[0].modified = true;
+  result.resource_updates[0].tensor_array_gradients_accessed = {"grad"};
+  result.computation =
+      std::make_shared<xla::XlaComputation>(std::move(computation));
+  return result;
+}
+
+TEST(XlaPersistentCacheTest, StoreAndLookup) {
+  XlaPersistentCache cache(io::JoinPath(testing::TmpDir(), "store_lookup"));
+  const XlaCompiler::CompilationResult result = MakeCompilationResult();
+  TF_ASSERT_OK(cache.Store("key", "signature", result));
+
+  XlaCompiler::CompilationResult loaded;
+  TF_ASSERT_OK(cache.Lookup("key", &loaded));
+  EXPECT_EQ(result.input_mapping, loaded.input_mapping);
+  ASSERT_EQ(2, loaded.xla_input_shapes.size());
+  EXPECT_TRUE(xla::ShapeUtil::Equal(result.xla_input_shapes[1],
+                                    loaded.xla_input_shapes[1]));
+  EXPECT_TRUE(
+      xla::ShapeUtil::Equal(result.xla_output_shape, loaded.xla_output_shape));
+  ASSERT_EQ(2, loaded.outputs.size());
+  EXPECT_EQ(DT_FLOAT, loaded.outputs[0].type);
+  EXPECT_EQ(TensorShape({2}), loaded.outputs[0].shape);
+  EXPECT_FALSE(loaded.outputs[0].is_constant);
+  EXPECT_TRUE(loaded.outputs[1].is_constant);
+  test::ExpectTensorEqual<int32>(result.outputs[1].constant_value,
+                                 loaded.outputs[1].constant_value);
+  ASSERT_EQ(1, loaded.resource_updates.size());
+  EXPECT_EQ(1, loaded.resource_updates[0].input_index);
+  EXPECT_TRUE(loaded.resource_updates[0].modified);
+  EXPECT_EQ(result.resource_updates[0].tensor_array_gradients_accessed,
+            loaded.resource_updates[0].tensor_array_gradients_accessed);
+  ASSERT_NE(nullptr, loaded.computation);
+  EXPECT_EQ(result.computation->proto().DebugString(),
+            loaded.computation->proto().DebugString());
+}
+
+TEST(XlaPersistentCacheTest, LookupOfMissingKeyIsNotFound) {
+  XlaPersistentCache cache(io::JoinPath(testing::TmpDir(), "missing"));
+  TF_ASSERT_OK(cache.Store("key", "signature", MakeCompilationResult()));
+
+  XlaCompiler::CompilationResult loaded;
+  EXPECT_TRUE(errors::IsNotFound(cache.Lookup("other key", &loaded)));
+}
+
+TEST(XlaPersistentCacheTest, StoreReplacesEntry) {
+  XlaPersistentCache cache(io::JoinPath(testing::TmpDir(), "replace"));
+  XlaCompiler::CompilationResult result = MakeCompilationResult();
+  TF_ASSERT_OK(cache.Store("key", "signature", result));
+  result.input_mapping = {1};
+  TF_ASSERT_OK(cache.Store("key", "signature", result));
+
+  XlaCompiler::CompilationResult loaded;
+  TF_ASSERT_OK(cache.Lookup("key", &loaded));
+  EXPECT_EQ(std::vector<int>({1}), loaded.input_mapping);
+}
+
+}  // namespace
+}  // namespace tensorflow
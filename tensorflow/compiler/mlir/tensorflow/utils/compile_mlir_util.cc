@@ -272,10 +272,12 @@ Status ConvertMLIRToXlaComputation(
   // LegalizeTFPass(allow_partial_conversion=true) can expose more graph pruning
   // and canonicalization opportunities that are necessary for the second
   // LegalizeTFPass(allow_partial_conversion=false) invocation.
-  tf2xla.addNestedPass<mlir::FuncOp>(mlir::xla_hlo::createLegalizeTFPass(true));
-  tf2xla.addNestedPass<mlir::FuncOp>(mlir::createCanonicalizerPass());
-  tf2xla.addNestedPass<mlir::FuncOp>(
-      mlir::xla_hlo::createLegalizeTFPass(false));
+  // The three passes share one nested pass manager, so that each function is
+  // legalized by a single task and the functions are legalized in parallel.
+  mlir::OpPassManager& legalize_pm = tf2xla.nest<mlir::FuncOp>();
+  legalize_pm.addPass(mlir::xla_hlo::createLegalizeTFPass(true));
+  legalize_pm.addPass(mlir::createCanonicalizerPass());
+  legalize_pm.addPass(mlir::xla_hlo::createLegalizeTFPass(false));
 
   if (VLOG_IS_ON(1)) {
     // Print the whole module after each pass which requires disabling
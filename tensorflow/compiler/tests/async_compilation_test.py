@@ -0,0 +1,102 @@
+# Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Tests for background compilation of lazily compiled XLA clusters."""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import os
+import time
+
+import numpy as np
+
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.client import session as session_lib
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import function
+from tensorflow.python.framework import ops
+from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
+from tensorflow.python.platform import test
+
+
+def RunMetadataLabels(run_metadata):
+  """Returns all labels in run_metadata."""
+  labels = []
+  for dev_stats in run_metadata.step_stats.dev_stats:
+    for node_stats in dev_stats.node_stats:
+      labels.append(node_stats.timeline_label)
+  return labels
+
+
+def InLabels(labels, substr):
+  """Returns true iff one of the labels contains substr."""
+  return any(substr in x for x in labels)
+
+
+class AsyncCompilationTest(test.TestCase):
+
+  def _RunAndTrace(self, sess, fetch, feed_dict):
+    run_metadata = config_pb2.RunMetadata()
+    result = sess.run(
+        fetch,
+        feed_dict=feed_dict,
+        run_metadata=run_metadata,
+        options=config_pb2.RunOptions(
+            trace_level=config_pb2.RunOptions.FULL_TRACE))
+    return result, RunMetadataLabels(run_metadata)
+
+  def testFallsBackUntilCompiled(self):
+
+    @function.Defun(compiled=True)
+    def CompiledFunction(x):
+      return math_ops.log(x)
+
+    with session_lib.Session() as sess:
+      x = array_ops.placeholder(dtypes.float32)
+      y = CompiledFunction(x)
+      inputs = [2., 10., 19., 77., 100.]
+
+      # The first run of a signature starts the compilation and runs the
+      # cluster in the TF executor.
+      result, labels = self._RunAndTrace(sess, y, {x: inputs})
+      self.assertAllClose(np.log(inputs), result)
+      self.assertTrue(InLabels(labels, "_XlaCompile"))
+      self.assertFalse(InLabels(labels, "_XlaRun"))
+
+      # Later runs switch to the XLA executable once it is compiled.
+      for _ in range(100):
+        result, labels = self._RunAndTrace(sess, y, {x: inputs})
+        self.assertAllClose(np.log(inputs), result)
+        if InLabels(labels, "_XlaRun"):
+          break
+        time.sleep(0.1)
+      self.assertTrue(InLabels(labels, "_XlaRun"))
+
+      # A new signature runs in the TF executor again until compiled.
+      result, labels = self._RunAndTrace(sess, y, {x: inputs[:2]})
+      self.assertAllClose(np.log(inputs[:2]), result)
+      self.assertFalse(InLabels(labels, "_XlaRun"))
+
+
+if __name__ == "__main__":
+  os.environ["TF_XLA_FLAGS"] = ("--tf_xla_enable_lazy_compilation=true "
+                                "--tf_xla_async_compilation=true " +
+                                os.environ.get("TF_XLA_FLAGS", ""))
+  # This test is using Tensorflow sessions which are not compatible with eager
+  # mode.
+  ops.disable_eager_execution()
+  test.main()
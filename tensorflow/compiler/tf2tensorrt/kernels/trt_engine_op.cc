@@ -36,13 +36,17 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/stream_executor/lib/statusor.h"
 
 #if GOOGLE_CUDA
@@ -136,6 +140,33 @@ class TRTEngineOp : public AsyncOpKernel {
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
+  // Returns the file that the engines built at runtime are persisted to, which
+  // is keyed by the segment fingerprint, the TensorRT version and the GPU
+  // architecture, or an empty string if the engines are not persisted.
+  string PersistentEngineCacheFilename(OpKernelContext* ctx);
+
+  // Adds the engines persisted by a previous process, if any, to the cache of
+  // cache_resource. Failures are logged and otherwise ignored: the engines are
+  // then rebuilt as needed.
+  void LoadPersistentEngines(OpKernelContext* ctx,
+                             TRTEngineCacheResource* cache_resource);
+
+  // Persists the engines in the cache of cache_resource, replacing the ones
+  // persisted before. Failures are logged and otherwise ignored.
+  void SavePersistentEngines(OpKernelContext* ctx,
+                             TRTEngineCacheResource* cache_resource);
+
+  // In adaptive profiles mode, replaces the engine of cache_resource with the
+  // one built in the background, if it is ready.
+  void MaybeInstallAdaptiveEngine(TRTEngineCacheResource* cache_resource);
+
+  // In adaptive profiles mode, builds in the background an engine with
+  // profiles for the most frequent of shape_counts, and hands it over to the
+  // AdaptiveProfilesContext of cache_resource.
+  void StartAdaptiveEngineBuild(OpKernelContext* ctx,
+                                TRTEngineCacheResource* cache_resource,
+                                InputShapeCounts shape_counts);
+
   std::vector<string> input_nodes_;
   std::vector<string> output_nodes_;
 
@@ -168,9 +199,24 @@ class TRTEngineOp : public AsyncOpKernel {
   // Whether to build TensorRT engines at runtime.
   bool allow_build_at_runtime_;
 
+  // Share of the executions that the profiles must cover in adaptive profiles
+  // mode, in which the profiles are created from the input shapes seen at
+  // runtime, and rebuilt in the background when their coverage drops. Only
+  // used when use_implicit_batch_=false; 0 disables the mode.
+  float adaptive_profiles_coverage_;
+
   // Maximum number of cached engines.
   int max_cached_engines_;
 
+  // Directory that the engines built at runtime are persisted to, so that
+  // other processes can load them instead of building them again. Set by the
+  // TF_TRT_ENGINE_CACHE_DIR environment variable; empty if disabled.
+  string engine_cache_dir_;
+
+  // Fingerprint of the segment and of the parameters its engines are built
+  // with.
+  uint64 segment_fingerprint_ = 0;
+
   int64 workspace_size_;
   mutex engine_mutex_;
   FunctionLibraryRuntime::Handle func_handle_;
@@ -282,6 +328,7 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   string calibration_data;
   OP_REQUIRES_OK(context,
                  context->GetAttr("calibration_data", &calibration_data));
+  const uint64 calibration_data_fingerprint = Fingerprint64(calibration_data);
   OP_REQUIRES_OK(context, context->GetAttr("segment_func", &func_));
   OP_REQUIRES(context, !func_.name().empty(),
               errors::InvalidArgument(
@@ -342,11 +389,42 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
             << ", thus setting _profile_generation_mode=false";
     profile_generation_mode_ = false;
   }
+  status = context->GetAttr("_adaptive_profiles_coverage",
+                            &adaptive_profiles_coverage_);
+  if (status.code() == tensorflow::error::NOT_FOUND) {
+    VLOG(2) << "Not found _adaptive_profiles_coverage in "
+            << context->device()->name()
+            << ", thus setting _adaptive_profiles_coverage=0";
+    adaptive_profiles_coverage_ = 0;
+  }
+  OP_REQUIRES(context,
+              adaptive_profiles_coverage_ >= 0 &&
+                  adaptive_profiles_coverage_ <= 1,
+              errors::InvalidArgument(
+                  "_adaptive_profiles_coverage must be in [0, 1], got ",
+                  adaptive_profiles_coverage_));
+  if (adaptive_profiles_coverage_ > 0) {
+    OP_REQUIRES(context, !profile_generation_mode_,
+                errors::InvalidArgument(
+                    "_adaptive_profiles_coverage can't be used together with "
+                    "profile_generation_mode_=true"));
+    OP_REQUIRES(
+        context,
+        !static_engine_ && allow_build_at_runtime_ &&
+            !(use_calibration_ && precision_mode_ == TrtPrecisionMode::INT8),
+        errors::InvalidArgument(
+            "_adaptive_profiles_coverage requires engines built at runtime "
+            "without INT8 calibration"));
+  }
   if (use_implicit_batch_) {
     OP_REQUIRES(context, !profile_generation_mode_,
                 errors::InvalidArgument(
                     "profile_generation_mode_=true is only supported if "
                     "use_implicit_batch=false"));
+    OP_REQUIRES(context, adaptive_profiles_coverage_ == 0,
+                errors::InvalidArgument(
+                    "_adaptive_profiles_coverage is only supported if "
+                    "use_implicit_batch=false"));
     if (input_partial_shapes_.empty()) {
       VLOG(1) << "Attribute input_shapes is not set. This happens probably "
               << "because you are using a model that is already converted "
@@ -369,6 +447,23 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
                 errors::InvalidArgument(
                     "Explicit batch mode does not support calibration"));
   }
+
+  OP_REQUIRES_OK(context, ReadStringFromEnvVar("TF_TRT_ENGINE_CACHE_DIR", "",
+                                               &engine_cache_dir_));
+  if (!engine_cache_dir_.empty() && !static_engine_) {
+    string fingerprint_input;
+    OP_REQUIRES(
+        context,
+        SerializeToStringDeterministic(segment_graph_def_, &fingerprint_input),
+        errors::Internal("Failed to serialize the segment of ", name()));
+    StrAppend(&fingerprint_input, ";", precision_string, ";",
+              calibration_data_fingerprint, ";", use_calibration_, ";",
+              use_implicit_batch_, ";", workspace_size_);
+    for (const PartialTensorShape& shape : input_partial_shapes_) {
+      StrAppend(&fingerprint_input, ";", shape.DebugString());
+    }
+    segment_fingerprint_ = Fingerprint64(fingerprint_input);
+  }
 }
 
 void TRTEngineOp::ExecuteNativeSegment(OpKernelContext* ctx,
@@ -570,6 +665,13 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
 
   OP_REQUIRES_OK_ASYNC(ctx, VerifyInputShapes(input_concrete_shapes), *helper);
 
+  if (adaptive_profiles_coverage_ > 0) {
+    MaybeInstallAdaptiveEngine(cache_res);
+  }
+  // Keeps the engine from being replaced in adaptive profiles mode while it is
+  // used.
+  tf_shared_lock engine_lock(cache_res->adaptive_profiles_.engine_mu);
+
   if (!use_implicit_batch_) {
     if (profile_generation_mode_) {
       // Collecting new shapes for profiles can be only done once. After the
@@ -584,6 +686,21 @@ void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
       VLOG(1) << "Native segment is used during collecting shapes for profiles";
       ExecuteNativeSegment(ctx, helper);
       return;
+    } else if (adaptive_profiles_coverage_ > 0) {
+      const bool covered =
+          cache_res->profiles_.GetProfileNumber(input_concrete_shapes) != -1;
+      InputShapeCounts shape_counts;
+      if (cache_res->adaptive_profiles_.RecordShapes(
+              input_concrete_shapes, covered, adaptive_profiles_coverage_,
+              &shape_counts)) {
+        StartAdaptiveEngineBuild(ctx, cache_res, std::move(shape_counts));
+      }
+      if (!covered) {
+        // The engine built in the background will cover these shapes if they
+        // are frequent enough.
+        ExecuteNativeSegment(ctx, helper);
+        return;
+      }
     } else if (cache_res->profiles_.GetNumProfiles() == 0) {
       // Create profiles out of collected shapes during profile generation.
       cache_res->profiles_.InitProfiles();
@@ -885,10 +1002,174 @@ Status TRTEngineOp::GetEngineCacheResource(OpKernelContext* ctx,
       std::string(kTfTrtContainerName), std::string(resource_name), cache_res,
       {[this, ctx](TRTEngineCacheResource** cr) -> Status {
         *cr = new TRTEngineCacheResource(ctx, this->max_cached_engines_);
+        LoadPersistentEngines(ctx, *cr);
         return Status::OK();
       }});
 }
 
+string TRTEngineOp::PersistentEngineCacheFilename(OpKernelContext* ctx) {
+  // Calibration and profile generation build their engines later, from the
+  // data they collect.
+  // Adaptive profiles are not persisted, so neither are their engines.
+  if (engine_cache_dir_.empty() || static_engine_ || calibration_mode_ ||
+      profile_generation_mode_ || adaptive_profiles_coverage_ > 0 ||
+      ctx->op_device_context() == nullptr) {
+    return "";
+  }
+  int cc_major = 0;
+  int cc_minor = 0;
+  if (!ctx->op_device_context()
+           ->stream()
+           ->parent()
+           ->GetDeviceDescription()
+           .cuda_compute_capability(&cc_major, &cc_minor)) {
+    return "";
+  }
+  return io::JoinPath(
+      engine_cache_dir_,
+      StrCat(absl::Hex(segment_fingerprint_, absl::kZeroPad16), "_trt",
+             GetLoadedTensorRTVersion(), "_sm", cc_major, cc_minor,
+             ".engines"));
+}
+
+void TRTEngineOp::LoadPersistentEngines(
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_resource) {
+  const string filename = PersistentEngineCacheFilename(ctx);
+  if (filename.empty() || !ctx->env()->FileExists(filename).ok()) return;
+  int num_loaded = 0;
+  Status status =
+      cache_resource->LoadSerializedEngines(ctx->env(), filename, &num_loaded);
+  if (!status.ok()) {
+    LOG(WARNING) << "Loading persisted TensorRT engines for " << name()
+                 << " from " << filename << " failed. They will be rebuilt "
+                 << "as needed. Reason: " << status;
+    return;
+  }
+  VLOG(1) << "Loaded " << num_loaded << " persisted TensorRT engines for "
+          << name() << " from " << filename;
+}
+
+void TRTEngineOp::SavePersistentEngines(
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_resource) {
+  const string filename = PersistentEngineCacheFilename(ctx);
+  if (filename.empty()) return;
+  Env* env = ctx->env();
+  // Write to a temporary file that is renamed once complete, so that other
+  // processes never load a partially written file.
+  string tmp_filename = filename;
+  int num_serialized = 0;
+  Status status = env->RecursivelyCreateDir(engine_cache_dir_);
+  if (status.ok() && !env->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    status = errors::Internal("Can't create a temporary file name for ",
+                              filename);
+  }
+  if (status.ok()) {
+    status = cache_resource->SerializeEngines(env, tmp_filename,
+                                              &num_serialized);
+  }
+  if (status.ok()) {
+    status = env->RenameFile(tmp_filename, filename);
+  }
+  if (!status.ok()) {
+    LOG(WARNING) << "Persisting the TensorRT engines of " << name() << " to "
+                 << filename << " failed. Reason: " << status;
+    if (tmp_filename != filename) env->DeleteFile(tmp_filename).IgnoreError();
+    return;
+  }
+  VLOG(1) << "Persisted " << num_serialized << " TensorRT engines of "
+          << name() << " to " << filename;
+}
+
+void TRTEngineOp::MaybeInstallAdaptiveEngine(
+    TRTEngineCacheResource* cache_resource) {
+  std::vector<TensorShape> engine_input_shapes;
+  std::unique_ptr<EngineContext> engine;
+  TrtShapeOptimizationProfile profiles;
+  AdaptiveProfilesContext& adaptive = cache_resource->adaptive_profiles_;
+  if (!adaptive.TakePendingEngine(&engine_input_shapes, &engine, &profiles)) {
+    return;
+  }
+  mutex_lock lock(adaptive.engine_mu);
+  cache_resource->cache_.clear();
+  cache_resource->cache_.emplace(engine_input_shapes, std::move(engine));
+  cache_resource->profiles_ = std::move(profiles);
+  VLOG(1) << "Installed a TensorRT engine with "
+          << cache_resource->profiles_.GetNumProfiles()
+          << " adaptive profiles for " << name();
+}
+
+void TRTEngineOp::StartAdaptiveEngineBuild(
+    OpKernelContext* ctx, TRTEngineCacheResource* cache_resource,
+    InputShapeCounts shape_counts) {
+  AdaptiveProfilesContext& adaptive = cache_resource->adaptive_profiles_;
+  const int platform_gpu_id =
+      ctx->device()->tensorflow_gpu_device_info()->gpu_id;
+  if (platform_gpu_id < 0 || cache_resource->allocator_ == nullptr) {
+    LOG(ERROR) << "Can't build adaptive profiles for " << name()
+               << " without a GPU device";
+    adaptive.SetPendingEngine({}, nullptr, TrtShapeOptimizationProfile());
+    return;
+  }
+  // The kernel may be destroyed while the engine is built, so the build only
+  // uses copies of its members.
+  cache_resource->Ref();
+  ctx->env()->SchedClosure([cache_resource, platform_gpu_id,
+                            shape_counts = std::move(shape_counts),
+                            coverage = adaptive_profiles_coverage_,
+                            segment_graph_def = segment_graph_def_,
+                            precision_mode = precision_mode_,
+                            workspace_size = workspace_size_,
+                            input_partial_shapes = input_partial_shapes_,
+                            name = name()]() {
+    core::ScopedUnref sc(cache_resource);
+    AdaptiveProfilesContext& adaptive = cache_resource->adaptive_profiles_;
+    auto err = cudaSetDevice(platform_gpu_id);
+    if (err != cudaSuccess) {
+      LOG(ERROR) << "Couldn't set cuda device to " << platform_gpu_id
+                 << " to build adaptive profiles for " << name;
+      adaptive.SetPendingEngine({}, nullptr, TrtShapeOptimizationProfile());
+      return;
+    }
+    TrtShapeOptimizationProfile profiles;
+    profiles.InitProfilesCoveringShapes(shape_counts, coverage);
+    // The cache key of the engine, which is not used to look it up in explicit
+    // batch mode.
+    const std::vector<TensorShape>* engine_input_shapes = nullptr;
+    int64 max_count = 0;
+    for (const auto& shapes_and_count : shape_counts) {
+      if (shapes_and_count.second > max_count) {
+        engine_input_shapes = &shapes_and_count.first;
+        max_count = shapes_and_count.second;
+      }
+    }
+    VLOG(1) << "Building a new TensorRT engine for " << name << " with "
+            << profiles.GetNumProfiles() << " adaptive profiles";
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
+    Status status = convert::ConvertGraphDefToEngine(
+        segment_graph_def, precision_mode,
+        (*engine_input_shapes)[0].dim_size(0), workspace_size,
+        input_partial_shapes, &cache_resource->GetLogger(),
+        cache_resource->allocator_.get(), /*calibrator=*/nullptr, &engine,
+        /*use_calibration=*/false, /*use_implicit_batch=*/false,
+        /*convert_successfully=*/nullptr, &profiles);
+    std::vector<TrtUniquePtrType<nvinfer1::IExecutionContext>> exec_context;
+    if (status.ok()) {
+      status = profiles.CreateExecutionContexts(engine.get(), exec_context);
+    }
+    if (!status.ok()) {
+      LOG(WARNING) << "Engine creation with adaptive profiles for " << name
+                   << " failed. The current engine will be kept. "
+                   << "Reason: " << status;
+      adaptive.SetPendingEngine({}, nullptr, TrtShapeOptimizationProfile());
+      return;
+    }
+    adaptive.SetPendingEngine(*engine_input_shapes,
+                              absl::make_unique<EngineContext>(
+                                  std::move(engine), std::move(exec_context)),
+                              std::move(profiles));
+  });
+}
+
 StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
@@ -1063,6 +1344,7 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     VLOG(1) << "Added new engine to cache of " << name()
             << ". Cache size: " << cache.size();
     engine_contexts = cache.at(input_concrete_shapes).get();
+    SavePersistentEngines(ctx, cache_res);
   }
   return std::pair<EngineContext*, int>(engine_contexts,
                                         use_implicit_batch_ ? 0 : profile_id);
@@ -21,6 +21,7 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/container/inlined_vector.h"
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/FixedPoint"
@@ -46,6 +47,8 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/public/version.h"
@@ -219,6 +222,38 @@ TEST_F(TRTEngineOpTestBase, AllowBuildAtRuntime) {
   EXPECT_EQ(ectx->cuda_engine, nullptr);
 }
 
+TEST_F(TRTEngineOpTestBase, PersistentEngineCache) {
+  const string cache_dir = io::JoinPath(testing::TmpDir(), "trt_engine_cache");
+  setenv("TF_TRT_ENGINE_CACHE_DIR", cache_dir.c_str(), 1 /* replace */);
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT);
+  unsetenv("TF_TRT_ENGINE_CACHE_DIR");
+
+  // Building an engine persists it.
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({2, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  std::vector<string> children;
+  TF_ASSERT_OK(Env::Default()->GetChildren(cache_dir, &children));
+  ASSERT_EQ(1, children.size());
+  EXPECT_TRUE(absl::EndsWith(children[0], ".engines"));
+
+  // A new engine cache loads the persisted engine instead of building one for
+  // the smaller batch size.
+  TF_ASSERT_OK(device_->resource_manager()->Delete<TRTEngineCacheResource>(
+      "TF-TRT", "myop"));
+  ResetInputs();
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({1, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+
+  TRTEngineCacheResource* cache_resource = nullptr;
+  TF_ASSERT_OK(
+      device_->resource_manager()->Lookup("TF-TRT", "myop", &cache_resource));
+  core::ScopedUnref sc(cache_resource);
+  auto cache = &cache_resource->cache_;
+  EXPECT_EQ(1, cache->size());
+  ASSERT_EQ(1, cache->count({TensorShape({2, 2})}));
+  EXPECT_NE(cache->at({TensorShape({2, 2})})->cuda_engine, nullptr);
+}
+
 #if IS_TRT_VERSION_GE(6, 0, 0, 0)
 TEST_F(TRTEngineOpTestBase, ExplicitBatch) {
   // Test inference in explicit batch mode with static input shapes. Static
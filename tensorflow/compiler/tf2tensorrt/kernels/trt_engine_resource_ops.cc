@@ -16,10 +16,8 @@ limitations under the License.
 #include <memory>
 #include <vector>
 
-#include "absl/memory/memory.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
-#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_logger.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_lru_cache.h"
 #include "tensorflow/core/framework/op.h"
@@ -27,8 +25,6 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
-#include "tensorflow/core/lib/io/record_reader.h"
-#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -39,7 +35,6 @@ limitations under the License.
 
 namespace tensorflow {
 namespace tensorrt {
-using ::nvinfer1::IRuntime;
 
 class CreateTRTResourceHandle : public OpKernel {
  public:
@@ -114,52 +109,9 @@ class InitializeTRTResource : public OpKernel {
                 errors::InvalidArgument("filename cannot be empty."));
 
     // Parse the serialized engines and add them to the cache.
-    std::unique_ptr<RandomAccessFile> file;
-    OP_REQUIRES_OK(ctx, ctx->env()->NewRandomAccessFile(filename, &file));
-    auto reader = absl::make_unique<io::RecordReader>(file.get());
-
-    uint64 offset = 0;
     int num_loaded_engine = 0;
-    do {
-      tstring record;
-      Status status = reader->ReadRecord(&offset, &record);
-      if (errors::IsOutOfRange(status)) break;
-
-      TRTEngineInstance engine_instance;
-      engine_instance.ParseFromString(record);
-      std::vector<TensorShape> engine_input_shapes;
-      for (const TensorShapeProto& shape : engine_instance.input_shapes()) {
-        engine_input_shapes.emplace_back(shape);
-      }
-
-      TrtUniquePtrType<IRuntime> infer(
-          nvinfer1::createInferRuntime(TRTEngineCacheResource::GetLogger()));
-      infer->setGpuAllocator(allocator);
-      TrtUniquePtrType<nvinfer1::ICudaEngine> engine(
-          infer->deserializeCudaEngine(
-              engine_instance.serialized_engine().c_str(),
-              engine_instance.serialized_engine().size(), nullptr));
-      auto raw_engine = engine.get();
-      std::vector<TrtUniquePtrType<nvinfer1::IExecutionContext>> ctx_vec;
-      if (num_loaded_engine == 0) {
-        // Restore profiles if there are any. Currently only 1 engine is allowed
-        // in dynamic mode therefore we call this only for the 0th engine.
-        // it is a no-op in implicit batch mode.
-        OP_REQUIRES_OK(ctx, resource->profiles_.RestoreProfiles(raw_engine));
-        OP_REQUIRES_OK(ctx, resource->profiles_.CreateExecutionContexts(
-                                raw_engine, ctx_vec));
-      } else {
-        // Multiple engines are only available in static mode. For each engine
-        // we have only a single execution context.
-        TrtUniquePtrType<nvinfer1::IExecutionContext> exec_ctx(
-            raw_engine->createExecutionContext());
-        ctx_vec.push_back(std::move(exec_ctx));
-      }
-      resource->cache_.emplace(engine_input_shapes,
-                               absl::make_unique<EngineContext>(
-                                   std::move(engine), std::move(ctx_vec)));
-      ++num_loaded_engine;
-    } while (1);
+    OP_REQUIRES_OK(ctx, resource->LoadSerializedEngines(ctx->env(), filename,
+                                                        &num_loaded_engine));
     VLOG(1) << "Loaded " << num_loaded_engine << " TRT engines for op "
             << handle.name() << " on device " << ctx->device()->name()
             << " from file " << filename;
@@ -200,32 +152,9 @@ class SerializeTRTResource : public OpKernel {
     if (resource->calib_ctx_) resource->calib_ctx_->TerminateCalibration();
 
     // Serialize the engines and write them to file.
-    std::unique_ptr<WritableFile> file;
-    OP_REQUIRES_OK(ctx, ctx->env()->NewWritableFile(filename, &file));
-    auto writer = absl::make_unique<io::RecordWriter>(file.get());
-
     int num_serialized_engines = 0;
-    for (const auto& pair : resource->cache_) {
-      // Ignore engines that failed to build.
-      const std::unique_ptr<EngineContext>& engine = pair.second;
-      if (!engine || !engine->cuda_engine) continue;
-
-      TRTEngineInstance engine_instance;
-      // Add input shapes.
-      const std::vector<TensorShape>& engine_input_shapes = pair.first;
-      for (const TensorShape& shape : engine_input_shapes) {
-        shape.AsProto(engine_instance.add_input_shapes());
-      }
-      // Add the serialized engine.
-      TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(
-          engine->cuda_engine->serialize());
-      engine_instance.set_serialized_engine(engine_data->data(),
-                                            engine_data->size());
-
-      OP_REQUIRES_OK(ctx,
-                     writer->WriteRecord(engine_instance.SerializeAsString()));
-      ++num_serialized_engines;
-    }
+    OP_REQUIRES_OK(ctx, resource->SerializeEngines(ctx->env(), filename,
+                                                   &num_serialized_engines));
     VLOG(1) << "Serialized " << num_serialized_engines << " TRT engines for op "
             << resource_name << " on device " << ctx->device()->name()
             << " to file " << filename;
@@ -17,10 +17,14 @@ limitations under the License.
 
 #include <sstream>
 
+#include "absl/memory/memory.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
+#include "tensorflow/compiler/tf2tensorrt/utils/trt_engine_instance.pb.h"  // NOLINT
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/io/record_reader.h"
+#include "tensorflow/core/lib/io/record_writer.h"
 #include "tensorflow/core/platform/mutex.h"
 
 #if GOOGLE_CUDA
@@ -50,6 +54,63 @@ string CalibrationContext::TerminateCalibration() {
   return calibration_table_;
 }
 
+constexpr int64 AdaptiveProfilesContext::kCheckPeriod;
+constexpr int64 AdaptiveProfilesContext::kMaxRecordedShapes;
+
+bool AdaptiveProfilesContext::RecordShapes(
+    const std::vector<TensorShape>& input_shapes, bool covered,
+    double coverage, InputShapeCounts* shape_counts) {
+  mutex_lock l(mu_);
+  auto it = shape_counts_.find(input_shapes);
+  if (it != shape_counts_.end()) {
+    ++it->second;
+  } else if (shape_counts_.size() < kMaxRecordedShapes) {
+    shape_counts_.emplace(input_shapes, 1);
+  }
+  ++executions_;
+  if (!covered) ++uncovered_executions_;
+  if (executions_ < kCheckPeriod) return false;
+
+  const bool rebuild = !building_ && !has_pending_engine_ &&
+                       uncovered_executions_ > (1 - coverage) * executions_;
+  VLOG(2) << uncovered_executions_ << " of the last " << executions_
+          << " executions were not covered by a profile"
+          << (rebuild ? ", building a new engine." : ".");
+  executions_ = 0;
+  uncovered_executions_ = 0;
+  if (!rebuild) return false;
+  building_ = true;
+  *shape_counts = shape_counts_;
+  return true;
+}
+
+void AdaptiveProfilesContext::SetPendingEngine(
+    std::vector<TensorShape> engine_input_shapes,
+    std::unique_ptr<EngineContext> engine,
+    TrtShapeOptimizationProfile profiles) {
+  mutex_lock l(mu_);
+  building_ = false;
+  if (engine == nullptr) return;
+  pending_input_shapes_ = std::move(engine_input_shapes);
+  pending_engine_ = std::move(engine);
+  pending_profiles_ = std::move(profiles);
+  has_pending_engine_ = true;
+}
+
+bool AdaptiveProfilesContext::TakePendingEngine(
+    std::vector<TensorShape>* engine_input_shapes,
+    std::unique_ptr<EngineContext>* engine,
+    TrtShapeOptimizationProfile* profiles) {
+  if (!has_pending_engine_) return false;
+  mutex_lock l(mu_);
+  if (pending_engine_ == nullptr) return false;
+  *engine_input_shapes = std::move(pending_input_shapes_);
+  *engine = std::move(pending_engine_);
+  *profiles = std::move(pending_profiles_);
+  has_pending_engine_ = false;
+  return true;
+}
+
 const absl::string_view kTfTrtContainerName = "TF-TRT";
 
 Logger& TRTEngineCacheResource::GetLogger() {
@@ -138,6 +199,103 @@ EngineContext* TRTEngineCacheResource::GetEngineContext(const int profile_id) {
   return cache_.begin()->second.get();
 }
 
+Status TRTEngineCacheResource::SerializeEngines(Env* env,
+                                                const string& filename,
+                                                int* num_serialized) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  auto writer = absl::make_unique<io::RecordWriter>(file.get());
+
+  *num_serialized = 0;
+  for (const auto& pair : cache_) {
+    // Ignore engines that failed to build.
+    const std::unique_ptr<EngineContext>& engine = pair.second;
+    if (!engine || !engine->cuda_engine) continue;
+
+    TRTEngineInstance engine_instance;
+    // Add input shapes.
+    const std::vector<TensorShape>& engine_input_shapes = pair.first;
+    for (const TensorShape& shape : engine_input_shapes) {
+      shape.AsProto(engine_instance.add_input_shapes());
+    }
+    // Add the serialized engine.
+    TrtUniquePtrType<nvinfer1::IHostMemory> engine_data(
+        engine->cuda_engine->serialize());
+    engine_instance.set_serialized_engine(engine_data->data(),
+                                          engine_data->size());
+
+    TF_RETURN_IF_ERROR(
+        writer->WriteRecord(engine_instance.SerializeAsString()));
+    ++*num_serialized;
+  }
+  TF_RETURN_IF_ERROR(writer->Close());
+  return file->Close();
+}
+
+Status TRTEngineCacheResource::LoadSerializedEngines(Env* env,
+                                                     const string& filename,
+                                                     int* num_loaded) {
+  if (allocator_ == nullptr) {
+    return errors::Internal(
+        "Not able to load TRT engines when GPU allocator is empty.");
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  auto reader = absl::make_unique<io::RecordReader>(file.get());
+
+  uint64 offset = 0;
+  *num_loaded = 0;
+  do {
+    tstring record;
+    Status status = reader->ReadRecord(&offset, &record);
+    if (errors::IsOutOfRange(status)) break;
+    TF_RETURN_IF_ERROR(status);
+
+    TRTEngineInstance engine_instance;
+    if (!engine_instance.ParseFromString(record)) {
+      return errors::DataLoss("Can't parse TRT engine at offset ", offset,
+                              " of ", filename);
+    }
+    std::vector<TensorShape> engine_input_shapes;
+    for (const TensorShapeProto& shape : engine_instance.input_shapes()) {
+      engine_input_shapes.emplace_back(shape);
+    }
+
+    TrtUniquePtrType<nvinfer1::IRuntime> infer(
+        nvinfer1::createInferRuntime(GetLogger()));
+    infer->setGpuAllocator(allocator_.get());
+    TrtUniquePtrType<nvinfer1::ICudaEngine> engine(
+        infer->deserializeCudaEngine(
+            engine_instance.serialized_engine().c_str(),
+            engine_instance.serialized_engine().size(), nullptr));
+    if (!engine) {
+      return errors::Internal("Can't deserialize TRT engine at offset ",
+                              offset, " of ", filename);
+    }
+    auto raw_engine = engine.get();
+    std::vector<TrtUniquePtrType<nvinfer1::IExecutionContext>> ctx_vec;
+    if (*num_loaded == 0) {
+      // Restore profiles if there are any. Currently only 1 engine is allowed
+      // in dynamic mode therefore we call this only for the 0th engine.
+      // it is a no-op in implicit batch mode.
+      TF_RETURN_IF_ERROR(profiles_.RestoreProfiles(raw_engine));
+      TF_RETURN_IF_ERROR(
+          profiles_.CreateExecutionContexts(raw_engine, ctx_vec));
+    } else {
+      // Multiple engines are only available in static mode. For each engine
+      // we have only a single execution context.
+      TrtUniquePtrType<nvinfer1::IExecutionContext> exec_ctx(
+          raw_engine->createExecutionContext());
+      ctx_vec.push_back(std::move(exec_ctx));
+    }
+    cache_.emplace(engine_input_shapes,
+                   absl::make_unique<EngineContext>(std::move(engine),
+                                                    std::move(ctx_vec)));
+    ++*num_loaded;
+  } while (1);
+  return Status::OK();
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
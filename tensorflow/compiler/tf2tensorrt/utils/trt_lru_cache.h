@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_LRU_CACHE_H_
 #define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_LRU_CACHE_H_
 
+#include <atomic>
 #include <list>
 #include <thread>
 #include <unordered_map>
@@ -27,6 +28,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
 
 #if GOOGLE_CUDA && GOOGLE_TENSORRT
 #include "third_party/tensorrt/NvInfer.h"
@@ -59,6 +61,11 @@ class LRUCache {
 
   size_t count(const key_type& key) const { return objects_.count(key); }
 
+  void clear() {
+    objects_.clear();
+    keys_.clear();
+  }
+
   value_type& at(const key_type& key) { return Touch(key); }
 
   const_iterator begin() const { return objects_.begin(); }
@@ -178,6 +185,53 @@ class CalibrationContext {
   std::string calibration_table_ TF_GUARDED_BY(mu_);
 };
 
+// Collects the input shapes seen by a TRTEngineOp in adaptive profiles mode,
+// and hands over the engines built in the background for the most frequent of
+// them.
+class AdaptiveProfilesContext {
+ public:
+  // Number of executions between two checks of the profile coverage.
+  static constexpr int64 kCheckPeriod = 1000;
+  // Maximum number of distinct input shapes that are counted.
+  static constexpr int64 kMaxRecordedShapes = 10000;
+
+  // Records an execution with input_shapes, "covered" telling whether the
+  // current engine has a profile for them. Returns true if a new engine should
+  // be built, that is if more than a (1 - coverage) share of the executions
+  // since the last check were not covered, and no build is in progress. In
+  // that case the counts of all the recorded input shapes are copied to
+  // "*shape_counts", and the caller must call SetPendingEngine() later.
+  bool RecordShapes(const std::vector<TensorShape>& input_shapes, bool covered,
+                    double coverage, InputShapeCounts* shape_counts);
+
+  // Hands over an engine built for the counts returned by RecordShapes(),
+  // keyed by "engine_input_shapes". A null "engine" means the build failed.
+  void SetPendingEngine(std::vector<TensorShape> engine_input_shapes,
+                        std::unique_ptr<EngineContext> engine,
+                        TrtShapeOptimizationProfile profiles);
+
+  // Moves the pending engine, if any, to the arguments and returns true.
+  bool TakePendingEngine(std::vector<TensorShape>* engine_input_shapes,
+                         std::unique_ptr<EngineContext>* engine,
+                         TrtShapeOptimizationProfile* profiles);
+
+  // Held shared while the engine of the cache is used, and exclusively while
+  // it is replaced.
+  mutex engine_mu;
+
+ private:
+  mutex mu_;
+  InputShapeCounts shape_counts_ TF_GUARDED_BY(mu_);
+  int64 executions_ TF_GUARDED_BY(mu_) = 0;
+  int64 uncovered_executions_ TF_GUARDED_BY(mu_) = 0;
+  bool building_ TF_GUARDED_BY(mu_) = false;
+
+  std::atomic<bool> has_pending_engine_{false};
+  std::vector<TensorShape> pending_input_shapes_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EngineContext> pending_engine_ TF_GUARDED_BY(mu_);
+  TrtShapeOptimizationProfile pending_profiles_ TF_GUARDED_BY(mu_);
+};
+
 ABSL_CONST_INIT extern const absl::string_view kTfTrtContainerName;
 
 class TRTEngineCacheResource : public ResourceBase {
@@ -205,6 +259,18 @@ class TRTEngineCacheResource : public ResourceBase {
   // Returns nullptr if no compatible EngineContexts is found in cache.
   EngineContext* GetEngineContext(const int profile_id);
 
+  // Writes the engines in the cache, except the ones that failed to build, to
+  // "filename" as TRTEngineInstance records, and sets "*num_serialized" to
+  // their number.
+  Status SerializeEngines(Env* env, const string& filename,
+                          int* num_serialized);
+
+  // Adds the engines written by SerializeEngines() to "filename" to the cache,
+  // and sets "*num_loaded" to their number. The engines must have been built
+  // with the same TensorRT version and for the same GPU architecture.
+  Status LoadSerializedEngines(Env* env, const string& filename,
+                               int* num_loaded);
+
   // Keep device allocator for TRT.
   std::unique_ptr<TRTBaseAllocator> allocator_;
 
@@ -221,6 +287,9 @@ class TRTEngineCacheResource : public ResourceBase {
   // generation and engine build. During runtime the list of profiles is used to
   // look up a matching profile for the input data.
   TrtShapeOptimizationProfile profiles_;
+
+  // Used in adaptive profiles mode only.
+  AdaptiveProfilesContext adaptive_profiles_;
 };
 
 #endif  // GOOGLE_TENSORRT
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <algorithm>
 #include <functional>
+#include <map>
+#include <utility>
 
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 
@@ -46,6 +48,61 @@ void TrtShapeOptimizationProfile::InitProfiles() {
   }
 }
 
+void TrtShapeOptimizationProfile::InitProfilesCoveringShapes(
+    const InputShapeCounts& shape_counts, double coverage) {
+  std::vector<std::pair<const std::vector<TensorShape>*, int64>> sorted_counts;
+  int64 total_count = 0;
+  for (const auto& shapes_and_count : shape_counts) {
+    sorted_counts.emplace_back(&shapes_and_count.first,
+                               shapes_and_count.second);
+    total_count += shapes_and_count.second;
+  }
+  // Most frequent first. Ties are broken by shape, so that the profiles do not
+  // depend on the iteration order of shape_counts.
+  std::sort(sorted_counts.begin(), sorted_counts.end(),
+            [](const std::pair<const std::vector<TensorShape>*, int64>& a,
+               const std::pair<const std::vector<TensorShape>*, int64>& b) {
+              if (a.second != b.second) return a.second > b.second;
+              return TensorShapeUtils::ShapeListString(*a.first) <
+                     TensorShapeUtils::ShapeListString(*b.first);
+            });
+
+  profiles_.clear();
+  // Index in profiles_ of the profile of each vector of input ranks.
+  std::map<std::vector<int>, int> profile_indices;
+  int64 covered_count = 0;
+  for (const auto& shapes_and_count : sorted_counts) {
+    if (covered_count >= coverage * total_count) break;
+    covered_count += shapes_and_count.second;
+
+    const std::vector<TensorShape>& shapes = *shapes_and_count.first;
+    std::vector<int> ranks;
+    std::vector<nvinfer1::Dims> dimvec;
+    for (const TensorShape& shape : shapes) {
+      ranks.push_back(shape.dims());
+      dimvec.push_back(TensorShapeToTrtDims(shape, false));
+    }
+    auto it = profile_indices.find(ranks);
+    if (it == profile_indices.end()) {
+      profile_indices.emplace(ranks, profiles_.size());
+      profiles_.push_back(OptimizationProfileConfig{dimvec, dimvec, dimvec});
+      continue;
+    }
+    OptimizationProfileConfig& profile = profiles_[it->second];
+    for (int i = 0; i < dimvec.size(); i++) {
+      for (int d = 0; d < dimvec[i].nbDims; d++) {
+        profile.min[i].d[d] = std::min(profile.min[i].d[d], dimvec[i].d[d]);
+        profile.max[i].d[d] = std::max(profile.max[i].d[d], dimvec[i].d[d]);
+      }
+    }
+  }
+  VLOG(1) << "Created " << profiles_.size() << " profiles covering "
+          << covered_count << " of " << total_count << " input shapes.";
+  for (const OptimizationProfileConfig& profile : profiles_) {
+    VLOG(1) << "Created profile " << profile.DebugString();
+  }
+}
+
 #if IS_TRT_VERSION_GE(6, 0, 0, 0)
 Status TrtShapeOptimizationProfile::AddProfiles(
     nvinfer1::IBuilder* builder, nvinfer1::IBuilderConfig* config,
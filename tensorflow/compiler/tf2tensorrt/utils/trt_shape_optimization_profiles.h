@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <list>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -105,6 +106,10 @@ struct OptimizationProfileConfig {
   }
 };
 
+// Number of times each vector of input shapes was seen.
+using InputShapeCounts = std::unordered_map<std::vector<TensorShape>, int64,
+                                            VectorTensorShapeHasher>;
+
 // Manages Optimization profiles during TRT Engine construction.
 //
 // An optimization profile describes a range of dimensions for each TRT network
@@ -148,6 +153,13 @@ class TrtShapeOptimizationProfile {
   // maps input_shapes_ to profiles_
   void InitProfiles();
 
+  // Creates profiles for the most frequent input vector shapes of
+  // shape_counts, which together account for at least a "coverage" share of
+  // the counts. Input vector shapes with the same ranks share a profile whose
+  // range includes all of them, and whose opt is the most frequent of them.
+  void InitProfilesCoveringShapes(const InputShapeCounts& shape_counts,
+                                  double coverage);
+
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
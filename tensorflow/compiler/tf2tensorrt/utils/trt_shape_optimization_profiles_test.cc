@@ -209,6 +209,43 @@ TEST_F(TrtShapeOptimizationProfileTest, Dynamic) {
     }
   }
 }
+
+TEST_F(TrtShapeOptimizationProfileTest, CoveringShapes) {
+  const std::vector<TensorShape> frequent =
+      DimVecToShapeVec({nvinfer1::Dims3(4, 4, 10), nvinfer1::Dims3(4, 4, 10)});
+  const std::vector<TensorShape> common =
+      DimVecToShapeVec({nvinfer1::Dims3(2, 8, 10), nvinfer1::Dims3(2, 8, 10)});
+  const std::vector<TensorShape> rare = DimVecToShapeVec(
+      {nvinfer1::Dims3(64, 64, 10), nvinfer1::Dims3(64, 64, 10)});
+  const InputShapeCounts shape_counts = {
+      {frequent, 80}, {common, 19}, {rare, 1}};
+
+  TrtShapeOptimizationProfile profile;
+  profile.InitProfilesCoveringShapes(shape_counts, /*coverage=*/0.99);
+
+  // The rare shapes are not needed for 99% coverage, and the others share a
+  // profile as they have the same ranks.
+  ASSERT_EQ(1, profile.GetNumProfiles());
+  EXPECT_EQ(0, profile.GetProfileNumber(frequent));
+  EXPECT_EQ(0, profile.GetProfileNumber(common));
+  EXPECT_EQ(0, profile.GetProfileNumber(
+                   DimVecToShapeVec({nvinfer1::Dims3(3, 6, 10),
+                                     nvinfer1::Dims3(3, 6, 10)})));
+  EXPECT_EQ(-1, profile.GetProfileNumber(rare));
+
+  nvinfer1::Dims3 dims(-1, -1, 10);
+  DefineNetwork(network_.get(), dims);
+  TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  for (int j = 0; j < 2; j++) {
+    nvinfer1::Dims opt = engine->getProfileDimensions(
+        j, 0, nvinfer1::OptProfileSelector::kOPT);
+    EXPECT_TRUE(DimsEqual(nvinfer1::Dims3(4, 4, 10), opt));
+  }
+}
 #endif
 
 }  // namespace tensorrt
@@ -535,6 +535,28 @@ static void AllocateFlags() {
           bool_setter_for(&DebugOptions::set_xla_gpu_deterministic_reductions),
           flag_values->xla_gpu_deterministic_reductions(),
           "Always run deterministic reductions on GPU"),
+      tensorflow::Flag(
+          "xla_hlo_pass_threads",
+          int32_setter_for(&DebugOptions::set_xla_hlo_pass_threads),
+          flag_values->xla_hlo_pass_threads(),
+          "Number of threads on which HLO passes that process each "
+          "computation independently run over the computations of a module. "
+          "Values below 2 run them serially."),
+      tensorflow::Flag(
+          "xla_cpu_parallel_codegen_split_count",
+          int32_setter_for(
+              &DebugOptions::set_xla_cpu_parallel_codegen_split_count),
+          flag_values->xla_cpu_parallel_codegen_split_count(),
+          "Number of parts into which XLA:CPU splits the LLVM IR of a module "
+          "to compile them in parallel. Values below 2 compile the module as "
+          "a whole."),
+      tensorflow::Flag(
+          "xla_hlo_profile_sampling_period",
+          int32_setter_for(&DebugOptions::set_xla_hlo_profile_sampling_period),
+          flag_values->xla_hlo_profile_sampling_period(),
+          "When xla_hlo_profile is enabled, profile only one in this many "
+          "executions of each executable. Values below 2 profile every "
+          "execution."),
   });
   ParseFlagsFromEnvAndDieIfUnknown("XLA_FLAGS", *flag_objects);
 }
@@ -613,16 +613,26 @@ StatusOr<Literal> LiteralBase::Broadcast(
 
   Literal result(result_shape);
 
+  const int64 primitive_size =
+      ShapeUtil::ByteSizeOfPrimitiveType(shape().element_type());
+  char* dest_data = static_cast<char*>(result.untyped_data());
+  const char* source_data = static_cast<const char*>(untyped_data());
+
+  // Broadcasting a scalar, the common case when folding constants, just
+  // replicates its bytes.
+  if (ShapeUtil::IsScalar(shape())) {
+    const int64 num_elements = ShapeUtil::ElementsIn(result_shape);
+    for (int64 i = 0; i < num_elements; ++i) {
+      memcpy(dest_data + primitive_size * i, source_data, primitive_size);
+    }
+    return std::move(result);
+  }
+
   // scratch_source_index is temporary storage space for the computed index into
   // the input literal.  We put it here to avoid allocating an std::vector in
   // every iteration of ShapeUtil::ForEachIndex.
   std::vector<int64> scratch_source_index(shape().dimensions_size());
 
-  char* dest_data = static_cast<char*>(result.untyped_data());
-  const char* source_data = static_cast<const char*>(untyped_data());
-  const int64 primitive_size =
-      ShapeUtil::ByteSizeOfPrimitiveType(shape().element_type());
-
   ShapeUtil::ForEachIndex(
       result_shape, [&](absl::Span<const int64> output_index) {
         for (int64 i = 0; i < dimensions.size(); ++i) {
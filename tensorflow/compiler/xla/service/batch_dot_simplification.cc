@@ -107,15 +107,14 @@ absl::string_view BatchDotSimplification::name() const {
   return "batch-dot-simplification";
 }
 
-StatusOr<bool> BatchDotSimplification::Run(HloModule* module) {
+StatusOr<bool> BatchDotSimplification::RunOnComputation(
+    HloComputation* computation) {
   bool changed = false;
   std::vector<HloInstruction*> dot_instrs;
-  for (HloComputation* computation : module->MakeNonfusionComputations()) {
-    absl::c_copy_if(computation->instructions(), std::back_inserter(dot_instrs),
-                    [](HloInstruction* instr) {
-                      return instr->opcode() == HloOpcode::kDot;
-                    });
-  }
+  absl::c_copy_if(computation->instructions(), std::back_inserter(dot_instrs),
+                  [](HloInstruction* instr) {
+                    return instr->opcode() == HloOpcode::kDot;
+                  });
   for (HloInstruction* dot_instr : dot_instrs) {
     TF_ASSIGN_OR_RETURN(bool elided_batch_dim_from_one,
                         ElideDegenerateBatchDimensionFromBatchDot(dot_instr));
@@ -62,6 +62,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/cpu_executable.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_instruction_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_layout_assignment.h"
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_options.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
@@ -113,6 +114,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
 #include "tensorflow/core/platform/dynamic_annotations.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -237,6 +240,9 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
     HloModule* module, bool /*is_aot_compile*/,
     LLVMTargetMachineFeatures* target_machine_features) {
   HloPassPipeline pipeline("HLO passes through layout assignment");
+  std::unique_ptr<tensorflow::thread::ThreadPool> thread_pool =
+      MaybeCreateHloPassThreadPool(module->config().debug_options());
+  pipeline.set_thread_pool(thread_pool.get());
   pipeline.AddInvariantChecker<HloVerifier>(/*layout_sensitive=*/false,
                                             /*allow_mixed_precision=*/false);
 
@@ -330,6 +336,7 @@ Status CpuCompiler::RunHloPassesThroughLayoutAssn(
       LayoutAssignment::InstructionCanChangeLayout, target_machine_features);
 
   pipeline.AddPass<CpuInstructionFusion>();
+  pipeline.AddPass<CpuMultiOutputFusion>();
 
   return pipeline.Run(module).status();
 }
@@ -682,8 +689,20 @@ StatusOr<std::unique_ptr<Executable>> CpuCompiler::RunBackend(
 
   TF_RETURN_IF_ERROR(VerifyLlvmModule(*llvm_module));
 
-  // JIT compile the LLVM IR module to in-memory machine code.
-  jit->AddModule(std::move(llvm_module));
+  // JIT compile the LLVM IR module to in-memory machine code, in parallel if
+  // requested.  Dumps and user hooks expect to see the whole module, so it is
+  // not split if any of them is enabled.
+  const int split_count =
+      module->config().debug_options().xla_cpu_parallel_codegen_split_count();
+  if (split_count > 1 && !DumpingEnabledForHloModule(*module) &&
+      !user_pre_optimization_hook_ && !user_post_optimization_hook_) {
+    tensorflow::thread::ThreadPool thread_pool(
+        tensorflow::Env::Default(), "xla_cpu_codegen", split_count);
+    TF_RETURN_IF_ERROR(jit->AddModuleInParallel(std::move(llvm_module),
+                                                split_count, &thread_pool));
+  } else {
+    jit->AddModule(std::move(llvm_module));
+  }
   cpu_executable.reset(new CpuExecutable(
       std::move(jit), std::move(assignment), std::move(module), function_name,
       std::move(hlo_profile_printer_data), std::move(hlo_profile_index_map)));
@@ -798,6 +817,310 @@ CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
     llvm_module.setPIELevel(pie_level);
   }
 
+  // With one entry point name per module, all modules are emitted into
+  // 'llvm_module' and compiled into a single object file at the end.
+  const bool single_object_file = !options.entry_point_names().empty();
+  if (single_object_file &&
+      options.entry_point_names().size() != modules.size()) {
+    return InvalidArgument(
+        "Got %d entry point names for a module group of %d modules.",
+        options.entry_point_names().size(), modules.size());
+  }
+
+  // Runs the LLVM verifier and the LLVM pipeline over 'llvm_module', with the
+  // dump hooks of 'module'.
+  auto compile_llvm_module =
+      [&](const HloModule& module) -> StatusOr<ObjectFileData> {
+    ModuleHook pre_optimization_ir_hook;
+    ModuleHook post_optimization_ir_hook;
+    std::tie(pre_optimization_ir_hook, post_optimization_ir_hook) =
+        GetIRModuleHooks(module, user_pre_optimization_hook_,
+                         user_post_optimization_hook_);
+
+    // Run the LLVM verifier over the unoptimized LLVM IR.  If it fails, run the
+    // pre-optimization IR dump hook before returning.
+    {
+      Status verify_status = VerifyLlvmModule(llvm_module);
+      if (!verify_status.ok() && pre_optimization_ir_hook) {
+        pre_optimization_ir_hook(llvm_module);
+      }
+      TF_RETURN_IF_ERROR(verify_status);
+    }
+
+    auto post_codegen_hook = [&](const llvm::object::ObjectFile& obj_file) {
+      if (!DumpingEnabledForHloModule(module)) {
+        return;
+      }
+      DumpToFileInDir(module, /*file_prefix=*/"", /*file_suffix=*/"o",
+                      absl::string_view(obj_file.getData().data(),
+                                        obj_file.getData().size()));
+    };
+
+    CompilerFunctor compiler_functor(
+        target_machine.get(), opt_level,
+        options::OptimizeForSizeRequested(module.config()),
+        module.config().debug_options().xla_llvm_disable_expensive_passes(),
+        llvm_ir::GetCpuFastMathFlags(module.config()),
+        pre_optimization_ir_hook, post_optimization_ir_hook, post_codegen_hook);
+    std::unique_ptr<llvm::MemoryBuffer> object_file =
+        compiler_functor(llvm_module);
+    return ObjectFileData(object_file->getBufferStart(),
+                          object_file->getBufferEnd());
+  };
+
+  std::vector<std::unique_ptr<AotCompilationResult>> results;
+  for (size_t i = 0; i < modules.size(); ++i) {
+    HloModule* module = modules[i].get();
+    VLOG(1) << "Compiling ahead-of-time: " << module->name();
+
+    TF_RETURN_IF_ERROR(
+        RunHloPasses(module, /*is_aot_compile=*/true, target_machine.get()));
+
+    TF_ASSIGN_OR_RETURN(HloSchedule schedule,
+                        ScheduleModule(module, BufferSizeBytesFunction()));
+
+    // Run buffer analysis on the HLO graph. This analysis figures out which
+    // temporary buffers are required to run the computation.
+    TF_ASSIGN_OR_RETURN(
+        std::unique_ptr<BufferAssignment> assignment,
+        BufferAssigner::Run(module,
+                            absl::make_unique<SequentialHloOrdering>(schedule),
+                            BufferSizeBytesFunction(), memory_alignment,
+                            /*allocate_buffers_for_constants=*/true));
+    // BufferAssignment::ToString() includes a header, so no need for us to
+    // print one ourselves.
+    if (DumpingEnabledForHloModule(*module)) {
+      DumpToFileInDirOrStdout(*module, "", "buffer_assignment",
+                              assignment->ToString());
+    }
+    DumpHloModuleIfEnabled(*module, *assignment, "after_optimizations");
+
+    std::unordered_map<const HloInstruction*, int64> instruction_to_profile_idx;
+    std::unordered_map<const HloComputation*, int64> computation_to_profile_idx;
+    std::unique_ptr<HloProfileIndexMap> hlo_profile_index_map;
+    std::unique_ptr<HloProfilePrinterData> hlo_profile_printer_data;
+
+    if (module->config().hlo_profiling_enabled()) {
+      TF_RETURN_IF_ERROR(CreateHloProfilingArtifacts(
+          *module, &instruction_to_profile_idx, &computation_to_profile_idx,
+          &hlo_profile_index_map, &hlo_profile_printer_data));
+    }
+
+    LLVMTargetMachineFeatures target_machine_features(target_machine.get());
+    IrEmitter ir_emitter(*module, *assignment, &llvm_module,
+                         std::move(instruction_to_profile_idx),
+                         std::move(computation_to_profile_idx),
+                         &target_machine_features,
+                         // TODO(b/66051036): Run full msan for AOT.
+                         /*emit_code_for_msan=*/false);
+
+    TF_RETURN_IF_ERROR(ir_emitter.EmitConstantGlobals());
+
+    HloComputation* computation = module->entry_computation();
+    for (auto embedded_computation :
+         computation->MakeEmbeddedComputationsList()) {
+      if (embedded_computation->IsFusionComputation()) {
+        continue;
+      }
+      TF_RETURN_IF_ERROR(
+          ir_emitter
+              .EmitComputation(
+                  embedded_computation, embedded_computation->name(),
+                  /*is_top_level_computation=*/false,
+                  schedule.sequence(embedded_computation).instructions())
+              .status());
+    }
+    const string& entry_point_name = single_object_file
+                                         ? options.entry_point_names()[i]
+                                         : options.entry_point_name();
+    TF_ASSIGN_OR_RETURN(llvm::Function * entry_function,
+                        ir_emitter.EmitComputation(
+                            computation, entry_point_name,
+                            /*is_top_level_computation=*/true,
+                            schedule.sequence(computation).instructions()));
+
+    CHECK(entry_function->getName() == entry_point_name);
+
+    ObjectFileData object_file_data;
+    if (!single_object_file) {
+      TF_ASSIGN_OR_RETURN(object_file_data, compile_llvm_module(*module));
+    }
+
+    std::vector<BufferInfo> buffer_infos =
+        CreateBufferInfosFromBufferAssignment(*assignment);
+
+    TF_ASSIGN_OR_RETURN(const BufferAllocation::Slice result_slice,
+                        assignment->GetUniqueTopLevelOutputSlice());
+
+    results.emplace_back(absl::make_unique<CpuAotCompilationResult>(
+        std::move(object_file_data), std::move(buffer_infos),
+        result_slice.index(), std::move(hlo_profile_printer_data)));
+  }
+
+  if (single_object_file) {
+    TF_ASSIGN_OR_RETURN(ObjectFileData object_file_data,
+                        compile_llvm_module(*modules[0]));
+    auto* first_result =
+        static_cast<CpuAotCompilationResult*>(results.front().get());
+    first_result->set_object_file_data(std::move(object_file_data));
+  }
+
+  VLOG(1) << "Compilation finished";
+  return std::move(cpu_executable);
+}
+
+StatusOr<std::vector<std::unique_ptr<AotCompilationResult>>>
+CpuCompiler::CompileAheadOfTime(std::unique_ptr<HloModuleGroup> module_group,
+                                const AotCompilationOptions& aot_options) {
+  TF_RET_CHECK(!module_group->empty());
+  std::vector<std::unique_ptr<HloModule>> modules =
+      module_group->ConsumeModules();
+
+  absl::call_once(llvm_command_line_options_initialized,
+                  &llvm_ir::InitializeLLVMCommandLineOptions,
+                  modules[0]->config());
+
+  // We can pass just one llvm::TargetOptions when we compile the LLVM module,
+  // so we bail if the configs have conflicting flags. At the moment, the only
+  // flags that need to be consistent are for fast-math.
+  for (const auto& fn_and_name :
+       {std::make_pair(&DebugOptions::xla_cpu_enable_fast_math,
+                       "xla_cpu_enable_fast_math"),
+        std::make_pair(&DebugOptions::xla_cpu_fast_math_honor_infs,
+                       "xla_cpu_fast_math_honor_infs"),
+        std::make_pair(&DebugOptions::xla_cpu_fast_math_honor_nans,
+                       "xla_cpu_fast_math_honor_nans")}) {
+    // This only works because each of the method pointers above returns a bool.
+    // Otherwise we'd have to do some template magic.
+    const auto& field_method_ptr = fn_and_name.first;
+    const auto& field_name = fn_and_name.second;
+    bool first_module_val =
+        (modules[0]->config().debug_options().*field_method_ptr)();
+    for (int64 i = 0; i < modules.size(); ++i) {
+      bool cur_module_val =
+          (modules[i]->config().debug_options().*field_method_ptr)();
+      if (first_module_val != cur_module_val) {
+        return InvalidArgument(
+            "All HLO module configs must have the same value for %s, but "
+            "module 0 and %d have different values (%d vs %d).",
+            field_name, i, first_module_val, cur_module_val);
+      }
+    }
+  }
+
+  if (aot_options.PlatformId() != se::host::kHostPlatformId) {
+    return InvalidArgument("Incompatible AOT compilation platform");
+  }
+  const CpuAotCompilationOptions& options =
+      static_cast<const CpuAotCompilationOptions&>(aot_options);
+  llvm::Triple triple(llvm::Triple::normalize(options.triple()));
+  std::string error;
+  const llvm::Target* target =
+      llvm::TargetRegistry::lookupTarget(triple.getTriple(), error);
+  if (target == nullptr) {
+    return InternalError("TargetRegistry::lookupTarget failed: %s", error);
+  }
+
+  llvm::Reloc::Model reloc_model = llvm::Reloc::Static;
+  llvm::PICLevel::Level pic_level = llvm::PICLevel::NotPIC;
+  llvm::PIELevel::Level pie_level = llvm::PIELevel::Default;
+  switch (options.relocation_model()) {
+    case CpuAotCompilationOptions::RelocationModel::Static:
+      reloc_model = llvm::Reloc::Static;
+      pic_level = llvm::PICLevel::NotPIC;
+      pie_level = llvm::PIELevel::Default;
+      break;
+    case CpuAotCompilationOptions::RelocationModel::SmallPic:
+      reloc_model = llvm::Reloc::PIC_;
+      pic_level = llvm::PICLevel::SmallPIC;
+      pie_level = llvm::PIELevel::Default;
+      break;
+    case CpuAotCompilationOptions::RelocationModel::BigPic:
+      reloc_model = llvm::Reloc::PIC_;
+      pic_level = llvm::PICLevel::BigPIC;
+      pie_level = llvm::PIELevel::Default;
+      break;
+    case CpuAotCompilationOptions::RelocationModel::SmallPie:
+      reloc_model = llvm::Reloc::PIC_;
+      pic_level = llvm::PICLevel::SmallPIC;
+      pie_level = llvm::PIELevel::Small;
+      break;
+    case CpuAotCompilationOptions::RelocationModel::BigPie:
+      reloc_model = llvm::Reloc::PIC_;
+      pic_level = llvm::PICLevel::BigPIC;
+      pie_level = llvm::PIELevel::Large;
+      break;
+  }
+  llvm::CodeGenOpt::Level opt_level = CodeGenOptLevel(modules[0]->config());
+  std::unique_ptr<llvm::TargetMachine> target_machine =
+      absl::WrapUnique(target->createTargetMachine(
+          triple.getTriple(), options.cpu_name(), options.features(),
+          CompilerTargetOptions(modules[0]->config()), reloc_model, llvm::None,
+          opt_level));
+
+  // Compile must be thread-safe so create a new LLVM context for the module.
+  llvm::LLVMContext llvm_context;
+  llvm::Module llvm_module("__compute_module", llvm_context);
+  llvm_module.setDataLayout(target_machine->createDataLayout());
+  llvm_module.setTargetTriple(triple.getTriple());
+  if (pic_level != llvm::PICLevel::NotPIC) {
+    llvm_module.setPICLevel(pic_level);
+  }
+  if (pie_level != llvm::PIELevel::Default) {
+    llvm_module.setPIELevel(pie_level);
+  }
+
+  // With one entry point name per module, all modules are emitted into
+  // 'llvm_module' and compiled into a single object file at the end.
+  const bool single_object_file = !options.entry_point_names().empty();
+  if (single_object_file &&
+      options.entry_point_names().size() != modules.size()) {
+    return InvalidArgument(
+        "Got %d entry point names for a module group of %d modules.",
+        options.entry_point_names().size(), modules.size());
+  }
+
+  // Runs the LLVM verifier and the LLVM pipeline over 'llvm_module', with the
+  // dump hooks of 'module'.
+  auto compile_llvm_module =
+      [&](const HloModule& module) -> StatusOr<ObjectFileData> {
+    ModuleHook pre_optimization_ir_hook;
+    ModuleHook post_optimization_ir_hook;
+    std::tie(pre_optimization_ir_hook, post_optimization_ir_hook) =
+        GetIRModuleHooks(module, user_pre_optimization_hook_,
+                         user_post_optimization_hook_);
+
+    // Run the LLVM verifier over the unoptimized LLVM IR.  If it fails, run the
+    // pre-optimization IR dump hook before returning.
+    {
+      Status verify_status = VerifyLlvmModule(llvm_module);
+      if (!verify_status.ok() && pre_optimization_ir_hook) {
+        pre_optimization_ir_hook(llvm_module);
+      }
+      TF_RETURN_IF_ERROR(verify_status);
+    }
+
+    auto post_codegen_hook = [&](const llvm::object::ObjectFile& obj_file) {
+      if (!DumpingEnabledForHloModule(module)) {
+        return;
+      }
+      DumpToFileInDir(module, /*file_prefix=*/"", /*file_suffix=*/"o",
+                      absl::string_view(obj_file.getData().data(),
+                                        obj_file.getData().size()));
+    };
+
+    CompilerFunctor compiler_functor(
+        target_machine.get(), opt_level,
+        options::OptimizeForSizeRequested(module.config()),
+        module.config().debug_options().xla_llvm_disable_expensive_passes(),
+        llvm_ir::GetCpuFastMathFlags(module.config()),
+        pre_optimization_ir_hook, post_optimization_ir_hook, post_codegen_hook);
+    std::unique_ptr<llvm::MemoryBuffer> object_file =
+        compiler_functor(llvm_module);
+    return ObjectFileData(object_file->getBufferStart(),
+                          object_file->getBufferEnd());
+  };
+
   std::vector<std::unique_ptr<AotCompilationResult>> results;
   for (size_t i = 0; i < modules.size(); ++i) {
     HloModule* module = modules[i].get();
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_COMPILER_H_
 
 #include <memory>
+#include <vector>
 
 #include "absl/types/span.h"
 #include "llvm/Target/TargetMachine.h"
@@ -70,12 +71,24 @@ class CpuAotCompilationOptions : public AotCompilationOptions {
   // The relocation model used for compilation.
   RelocationModel relocation_model() const { return relocation_model_; }
 
+  // If non-empty, the names of the entry points of the modules of the group,
+  // one per module, overriding entry_point_name. All modules are then emitted
+  // into a single object file, returned with the first result, so that they
+  // share runtime declarations and identical constants.
+  const std::vector<string>& entry_point_names() const {
+    return entry_point_names_;
+  }
+  void set_entry_point_names(std::vector<string> entry_point_names) {
+    entry_point_names_ = std::move(entry_point_names);
+  }
+
  private:
   const string triple_;
   const string cpu_name_;
   const string features_;
   const string entry_point_name_;
   const RelocationModel relocation_model_;
+  std::vector<string> entry_point_names_;
 };
 
 class CpuAotCompilationResult : public AotCompilationResult {
@@ -92,6 +105,9 @@ class CpuAotCompilationResult : public AotCompilationResult {
   }
 
   const ObjectFileData& object_file_data() const { return object_file_data_; }
+  void set_object_file_data(ObjectFileData object_file_data) {
+    object_file_data_ = std::move(object_file_data);
+  }
   const std::vector<cpu_function_runtime::BufferInfo>& buffer_infos() const {
     return buffer_infos_;
   }
@@ -99,7 +115,7 @@ class CpuAotCompilationResult : public AotCompilationResult {
 
  private:
   // Contains the compiled computation: an object file.
-  const ObjectFileData object_file_data_;
+  ObjectFileData object_file_data_;
 
   // A list of BufferInfo objects describing the buffers used by the XLA
   // computation.
@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
+#include "tensorflow/compiler/xla/service/hlo_opcode.h"
+#include "tensorflow/compiler/xla/service/llvm_ir/dynamic_update_slice_util.h"
+#include "tensorflow/compiler/xla/shape_util.h"
+
+namespace xla {
+namespace cpu {
+
+bool CpuMultiOutputFusion::ShapesCompatibleForFusion(HloInstruction* instr1,
+                                                     HloInstruction* instr2) {
+  // Both instructions must be emitted by the same loop nest, and the loop nest
+  // writes every output with the same index.
+  return ShapeUtil::EqualIgnoringElementType(GetLoopShape(*instr1),
+                                             GetLoopShape(*instr2));
+}
+
+bool CpuMultiOutputFusion::IsFusible(HloInstruction* instr) {
+  if (instr->opcode() == HloOpcode::kFusion) {
+    if (!instr->IsLoopFusion() ||
+        llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(instr)) {
+      return false;
+    }
+    return !instr->IsMultiOutputFusion() ||
+           IsLoopFusibleMultiOutputFusion(*instr);
+  }
+  return instr->IsElementwise() && instr->operand_count() > 0 &&
+         instr->shape().IsArray() &&
+         !ShapeUtil::IsEffectiveScalar(instr->shape()) &&
+         !instr->HasSideEffect();
+}
+
+int64 CpuMultiOutputFusion::GetProfit(HloInstruction* instr1,
+                                      HloInstruction* instr2) {
+  // The profit is the size of the operands that are read once instead of
+  // twice.
+  absl::flat_hash_set<HloInstruction*> instr1_operands(
+      instr1->operands().begin(), instr1->operands().end());
+  absl::flat_hash_set<HloInstruction*> shared_operands;
+  int64 profit = 0;
+  for (HloInstruction* operand : instr2->operands()) {
+    if (instr1_operands.contains(operand) &&
+        shared_operands.insert(operand).second && IsProfitableOperand(operand)) {
+      profit += ShapeUtil::ByteSizeOf(operand->shape(), sizeof(void*));
+    }
+  }
+  return profit >> 10;
+}
+
+bool CpuMultiOutputFusion::LegalToFuse(HloInstruction* instr1,
+                                       HloInstruction* instr2) {
+  // Unlike the base class, instr1 need not be a fusion already: Fuse() creates
+  // one for a pair of unfused elementwise instructions.
+  return LegalToFuseMainConstraints(instr1, instr2);
+}
+
+HloInstruction* CpuMultiOutputFusion::Fuse(HloInstruction* instr1,
+                                           HloInstruction* instr2) {
+  if (instr1->opcode() != HloOpcode::kFusion &&
+      instr2->opcode() != HloOpcode::kFusion) {
+    instr1 = CreateFusion(instr1, instr2);
+  }
+  return MultiOutputFusion::Fuse(instr1, instr2);
+}
+
+}  // namespace cpu
+}  // namespace xla
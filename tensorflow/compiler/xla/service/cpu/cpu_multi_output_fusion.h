@@ -0,0 +1,48 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
+
+#include "tensorflow/compiler/xla/service/hlo_instruction.h"
+#include "tensorflow/compiler/xla/service/multi_output_fusion.h"
+
+namespace xla {
+namespace cpu {
+
+// Fuses sibling loop fusions and elementwise instructions that read common
+// operands into multi-output loop fusions, so that the shared operands are
+// read once by a single loop nest. All outputs of a fusion have the same
+// dimensions and layout, which lets ParallelTaskAssigner partition the fused
+// loop like that of a single-output fusion.
+class CpuMultiOutputFusion : public MultiOutputFusion {
+ public:
+  CpuMultiOutputFusion() = default;
+
+  absl::string_view name() const override { return "cpu_multi_output_fusion"; }
+
+ protected:
+  bool ShapesCompatibleForFusion(HloInstruction* instr1,
+                                 HloInstruction* instr2) override;
+  bool IsFusible(HloInstruction* instr) override;
+  int64 GetProfit(HloInstruction* instr1, HloInstruction* instr2) override;
+  bool LegalToFuse(HloInstruction* instr1, HloInstruction* instr2) override;
+  HloInstruction* Fuse(HloInstruction* instr1, HloInstruction* instr2) override;
+};
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_CPU_MULTI_OUTPUT_FUSION_H_
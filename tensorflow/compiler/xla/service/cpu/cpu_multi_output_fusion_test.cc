@@ -0,0 +1,136 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/cpu_multi_output_fusion.h"
+
+#include "tensorflow/compiler/xla/service/hlo_matchers.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace op = xla::testing::opcode_matchers;
+
+namespace xla {
+namespace cpu {
+namespace {
+
+using CpuMultiOutputFusionTest = HloTestBase;
+
+TEST_F(CpuMultiOutputFusionTest, FusesSiblingElementwiseOps) {
+  const char* hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  p0 = f32[512,512] parameter(0)
+  p1 = f32[512,512] parameter(1)
+  add = f32[512,512] add(p0, p1)
+  mul = f32[512,512] multiply(p0, p1)
+  ROOT tuple = (f32[512,512], f32[512,512]) tuple(add, mul)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuMultiOutputFusion().Run(module.get()));
+  ASSERT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  EXPECT_TRUE(fusion->IsLoopFusion());
+  ASSERT_THAT(fusion->fused_expression_root(), op::Tuple());
+  EXPECT_THAT(fusion->fused_expression_root()->operands(),
+              ::testing::UnorderedElementsAre(op::Add(), op::Multiply()));
+}
+
+TEST_F(CpuMultiOutputFusionTest, FusesSiblingLoopFusions) {
+  const char* hlo_string = R"(
+HloModule module
+
+fused_computation_1 {
+  p0.1 = f32[512,512] parameter(0)
+  ROOT exp = f32[512,512] exponential(p0.1)
+}
+
+fused_computation_2 {
+  p0.2 = f32[512,512] parameter(0)
+  neg = f32[512,512] negate(p0.2)
+  ROOT log = f32[512,512] log(neg)
+}
+
+ENTRY entry {
+  p0 = f32[512,512] parameter(0)
+  fusion.1 = f32[512,512] fusion(p0), kind=kLoop, calls=fused_computation_1
+  fusion.2 = f32[512,512] fusion(p0), kind=kLoop, calls=fused_computation_2
+  ROOT tuple = (f32[512,512], f32[512,512]) tuple(fusion.1, fusion.2)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuMultiOutputFusion().Run(module.get()));
+  ASSERT_TRUE(changed);
+
+  const HloInstruction* root = module->entry_computation()->root_instruction();
+  ASSERT_THAT(root, op::Tuple(op::GetTupleElement(op::Fusion()),
+                              op::GetTupleElement(op::Fusion())));
+  const HloInstruction* fusion = root->operand(0)->operand(0);
+  EXPECT_EQ(fusion, root->operand(1)->operand(0));
+  ASSERT_THAT(fusion->fused_expression_root(), op::Tuple());
+  EXPECT_THAT(fusion->fused_expression_root()->operands(),
+              ::testing::UnorderedElementsAre(op::Exp(), op::Log()));
+}
+
+TEST_F(CpuMultiOutputFusionTest, DoesNotFuseDifferentLoopShapes) {
+  const char* hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  p0 = f32[512,512] parameter(0)
+  p1 = f32[512,512] parameter(1)
+  add = f32[512,512] add(p0, p1)
+  mul = f32[512,512]{0,1} multiply(p0, p1)
+  ROOT tuple = (f32[512,512], f32[512,512]{0,1}) tuple(add, mul)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuMultiOutputFusion().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(CpuMultiOutputFusionTest, DoesNotFuseSmallSharedOperands) {
+  const char* hlo_string = R"(
+HloModule module
+
+ENTRY entry {
+  p0 = f32[16] parameter(0)
+  p1 = f32[16] parameter(1)
+  add = f32[16] add(p0, p1)
+  mul = f32[16] multiply(p0, p1)
+  ROOT tuple = (f32[16], f32[16]) tuple(add, mul)
+}
+)";
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed,
+                          CpuMultiOutputFusion().Run(module.get()));
+  EXPECT_FALSE(changed);
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/ir_emission_utils.h"
 
+#include "absl/algorithm/container.h"
 #include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -112,5 +113,26 @@ bool PotentiallyImplementedAsEigenConvolution(
              kernel_shape.dimensions_size() - 1;
 }
 
+bool IsLoopFusibleMultiOutputFusion(const HloInstruction& instruction) {
+  if (!instruction.IsMultiOutputFusion() || !instruction.IsLoopFusion()) {
+    return false;
+  }
+  const Shape& first = instruction.shape().tuple_shapes(0);
+  return first.IsArray() &&
+         absl::c_all_of(instruction.shape().tuple_shapes(),
+                        [&first](const Shape& shape) {
+                          return shape.IsArray() &&
+                                 ShapeUtil::EqualIgnoringElementType(shape,
+                                                                     first);
+                        });
+}
+
+const Shape& GetLoopShape(const HloInstruction& instruction) {
+  if (instruction.IsMultiOutputFusion()) {
+    return instruction.shape().tuple_shapes(0);
+  }
+  return instruction.shape();
+}
+
 }  // namespace cpu
 }  // namespace xla
@@ -32,6 +32,15 @@ bool PotentiallyImplementedAsEigenConvolution(
 int64 GetMinimumAlignmentForArray(
     const Shape& shape, const TargetMachineFeatures& target_machine_features);
 
+// Returns true if 'instruction' is a multi-output loop fusion whose outputs all
+// have the same dimensions and layout, so that they can be emitted by a single
+// (possibly parallel) loop nest.
+bool IsLoopFusibleMultiOutputFusion(const HloInstruction& instruction);
+
+// Returns the shape of the loop nest emitted for 'instruction': the shape of
+// its first output if it is a multi-output fusion, and its own shape otherwise.
+const Shape& GetLoopShape(const HloInstruction& instruction);
+
 // Dynamic loop bounds are specified as an array of dimension index
 // [start, limit) pairs of ir values (one for each partitioned outer dimension).
 //
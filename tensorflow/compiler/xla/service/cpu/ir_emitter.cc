@@ -2465,8 +2465,8 @@ Status IrEmitter::HandleCall(HloInstruction* call) {
 
     HloInstruction* root = computation->root_instruction();
     TF_RETURN_IF_ERROR(EmitCallToParallelForkJoin(
-        call_args, root->shape(), root->outer_dimension_partitions(), &b_,
-        call_ir_function, computation->name()));
+        call_args, GetLoopShape(*root), root->outer_dimension_partitions(),
+        &b_, call_ir_function, computation->name()));
   } else {
     EmitGlobalCall(*computation, computation->name());
   }
@@ -3272,7 +3272,8 @@ Status IrEmitter::EmitTargetElementLoop(
   if (target_shape.IsTuple() && (target_op->opcode() == HloOpcode::kFusion ||
                                  target_op->opcode() == HloOpcode::kReduce)) {
     // For multiple outputs fusion, we need to emit each operand and the root.
-    TF_RET_CHECK(num_dynamic_loop_bounds_ == 0);
+    TF_RET_CHECK(num_dynamic_loop_bounds_ == 0 ||
+                 ShouldEmitParallelLoopFor(*target_op));
     std::vector<llvm_ir::IrArray> output_arrays;
     for (int64 i = 0; i < ShapeUtil::TupleElementCount(target_shape); ++i) {
       TF_ASSIGN_OR_RETURN(BufferAllocation::Slice slice,
@@ -3282,9 +3283,19 @@ Status IrEmitter::EmitTargetElementLoop(
       output_arrays.push_back(
           llvm_ir::IrArray(op_target_address, element_shape));
     }
-    TF_RETURN_IF_ERROR(
-        llvm_ir::LoopEmitter(element_generator, output_arrays, &b_)
-            .EmitLoop(IrName(target_op)));
+    if (ShouldEmitParallelLoopFor(*target_op)) {
+      // All outputs share the loop shape, so one set of dynamic loop bounds
+      // partitions every output array.
+      std::vector<std::pair<llvm::Value*, llvm::Value*>> dynamic_loop_bounds =
+          compute_function_->GetDynamicLoopBounds();
+      TF_RETURN_IF_ERROR(ParallelLoopEmitter(element_generator, output_arrays,
+                                             &dynamic_loop_bounds, &b_)
+                             .EmitLoop(IrName(target_op)));
+    } else {
+      TF_RETURN_IF_ERROR(
+          llvm_ir::LoopEmitter(element_generator, output_arrays, &b_)
+              .EmitLoop(IrName(target_op)));
+    }
 
     std::vector<llvm::Value*> tuple_operand_ptrs;
     for (int64 i = 0; i < output_arrays.size(); ++i) {
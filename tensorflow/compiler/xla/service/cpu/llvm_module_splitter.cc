@@ -0,0 +1,148 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/llvm_module_splitter.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
+#include "tensorflow/compiler/xla/util.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+// Calls `fn` on each function and global variable whose body or initializer
+// uses `value`, looking through constant expressions.
+template <typename Fn>
+void ForEachGlobalUser(const llvm::GlobalValue& value, Fn fn) {
+  std::vector<const llvm::User*> worklist(value.user_begin(), value.user_end());
+  while (!worklist.empty()) {
+    const llvm::User* user = worklist.back();
+    worklist.pop_back();
+    if (auto* instruction = llvm::dyn_cast<llvm::Instruction>(user)) {
+      fn(*instruction->getFunction());
+    } else if (auto* global = llvm::dyn_cast<llvm::GlobalValue>(user)) {
+      fn(*global);
+    } else {
+      worklist.insert(worklist.end(), user->user_begin(), user->user_end());
+    }
+  }
+}
+
+}  // namespace
+
+StatusOr<std::vector<std::string>> SplitModuleForParallelCodegen(
+    llvm::Module* module, int num_parts) {
+  if (!module->alias_empty() || !module->ifunc_empty() ||
+      !module->getComdatSymbolTable().empty()) {
+    return FailedPrecondition("Module %s has aliases or comdats",
+                              module->getModuleIdentifier());
+  }
+  for (const llvm::GlobalVariable& global : module->globals()) {
+    if (global.hasAppendingLinkage()) {
+      return FailedPrecondition("Module %s has appending global %s",
+                                module->getModuleIdentifier(),
+                                global.getName().str());
+    }
+  }
+
+  // Assign the functions to parts in order, cutting the sequence of
+  // functions every total_size / num_parts instructions.
+  int64 total_size = 0;
+  for (const llvm::Function& function : module->functions()) {
+    total_size += function.getInstructionCount();
+  }
+  absl::flat_hash_map<const llvm::GlobalValue*, int> part_of;
+  int64 size = 0;
+  int num_used_parts = 1;
+  for (const llvm::Function& function : module->functions()) {
+    if (function.isDeclaration()) {
+      continue;
+    }
+    int part = std::min<int64>(
+        size * num_parts / std::max<int64>(total_size, 1), num_parts - 1);
+    part_of[&function] = part;
+    num_used_parts = std::max(num_used_parts, part + 1);
+    size += function.getInstructionCount();
+  }
+  for (const llvm::GlobalVariable& global : module->globals()) {
+    if (!global.isDeclaration()) {
+      part_of[&global] = 0;
+    }
+  }
+  if (num_used_parts < 2) {
+    return FailedPrecondition("Module %s is too small to split",
+                              module->getModuleIdentifier());
+  }
+
+  // Check that no part refers to a later part, and find the local symbols
+  // that have to be made external.
+  std::vector<llvm::GlobalValue*> externalized;
+  for (const auto& value_and_part : part_of) {
+    const llvm::GlobalValue* value = value_and_part.first;
+    bool used_from_other_part = false;
+    bool used_from_earlier_part = false;
+    ForEachGlobalUser(*value, [&](const llvm::GlobalValue& user) {
+      auto it = part_of.find(&user);
+      int user_part = it == part_of.end() ? 0 : it->second;
+      used_from_other_part |= user_part != value_and_part.second;
+      used_from_earlier_part |= user_part < value_and_part.second;
+    });
+    if (used_from_earlier_part) {
+      return FailedPrecondition(
+          "%s is used before it is defined in module %s",
+          value->getName().str(), module->getModuleIdentifier());
+    }
+    if (used_from_other_part && value->hasLocalLinkage()) {
+      externalized.push_back(const_cast<llvm::GlobalValue*>(value));
+    }
+  }
+  for (llvm::GlobalValue* value : externalized) {
+    value->setLinkage(llvm::GlobalValue::ExternalLinkage);
+    if (!value->hasName()) {
+      value->setName("__xla_cpu_split_module_symbol");
+    }
+  }
+
+  std::vector<std::string> parts;
+  for (int part = 0; part < num_used_parts; ++part) {
+    llvm::ValueToValueMapTy value_map;
+    std::unique_ptr<llvm::Module> part_module = llvm::CloneModule(
+        *module, value_map, [&](const llvm::GlobalValue* value) {
+          auto it = part_of.find(value);
+          return it != part_of.end() && it->second == part;
+        });
+    part_module->setModuleIdentifier(
+        absl::StrCat(module->getModuleIdentifier(), ".", part));
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream ostream(bitcode);
+    llvm::WriteBitcodeToFile(*part_module, ostream);
+    parts.emplace_back(bitcode.begin(), bitcode.end());
+  }
+  return parts;
+}
+
+}  // namespace cpu
+}  // namespace xla
@@ -0,0 +1,48 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_CPU_LLVM_MODULE_SPLITTER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_CPU_LLVM_MODULE_SPLITTER_H_
+
+#include <string>
+#include <vector>
+
+#include "llvm/IR/Module.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+namespace cpu {
+
+// Splits the definitions in `module` into at most `num_parts` parts with
+// roughly the same number of instructions, so that the parts can be optimized
+// and compiled to machine code independently, and returns the bitcode of a
+// module for each part.  Each part declares the symbols it uses from the
+// other parts; the local symbols that are used from other parts are given
+// external linkage in `module`.
+//
+// Functions are assigned to parts in the order in which they appear in
+// `module`, and global variables to the first part.  So as long as functions
+// are only used by the functions that follow them, as is the case for the IR
+// emitted for an HLO module, the parts only refer to the symbols defined in
+// parts before them, and can be linked one after another.  Returns an error,
+// and leaves `module` unchanged, if that is not the case or if `module`
+// has aliases, comdats or appending globals.
+StatusOr<std::vector<std::string>> SplitModuleForParallelCodegen(
+    llvm::Module* module, int num_parts);
+
+}  // namespace cpu
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_CPU_LLVM_MODULE_SPLITTER_H_
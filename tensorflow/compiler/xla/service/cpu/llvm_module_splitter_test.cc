@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/cpu/llvm_module_splitter.h"
+
+#include <memory>
+
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "tensorflow/compiler/xla/test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace xla {
+namespace cpu {
+namespace {
+
+class LlvmModuleSplitterTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<llvm::Module> ParseModule(const char* ir) {
+    llvm::SMDiagnostic error;
+    std::unique_ptr<llvm::Module> module =
+        llvm::parseAssemblyString(ir, error, context_);
+    CHECK(module != nullptr) << error.getMessage().str();
+    return module;
+  }
+
+  std::unique_ptr<llvm::Module> ParseBitcode(const std::string& bitcode) {
+    return llvm::cantFail(llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(bitcode, "part"), context_));
+  }
+
+  llvm::LLVMContext context_;
+};
+
+TEST_F(LlvmModuleSplitterTest, SplitsFunctionsInOrder) {
+  std::unique_ptr<llvm::Module> module = ParseModule(R"(
+@constant = private constant float 1.0
+
+define internal void @f0(float* %out) {
+  %value = load float, float* @constant
+  store float %value, float* %out
+  ret void
+}
+
+define internal void @f1(float* %out) {
+  call void @f0(float* %out)
+  call void @f0(float* %out)
+  ret void
+}
+
+define void @entry(float* %out) {
+  call void @f1(float* %out)
+  call void @f1(float* %out)
+  ret void
+}
+)");
+
+  TF_ASSERT_OK_AND_ASSIGN(std::vector<std::string> parts,
+                          SplitModuleForParallelCodegen(module.get(), 3));
+  ASSERT_EQ(parts.size(), 3);
+  EXPECT_TRUE(module->getFunction("f0")->hasExternalLinkage());
+  EXPECT_TRUE(module->getFunction("f1")->hasExternalLinkage());
+
+  std::unique_ptr<llvm::Module> part0 = ParseBitcode(parts[0]);
+  EXPECT_FALSE(part0->getGlobalVariable("constant", true)->isDeclaration());
+  EXPECT_FALSE(part0->getFunction("f0")->isDeclaration());
+  EXPECT_EQ(part0->getFunction("f1"), nullptr);
+
+  std::unique_ptr<llvm::Module> part1 = ParseBitcode(parts[1]);
+  EXPECT_TRUE(part1->getFunction("f0")->isDeclaration());
+  EXPECT_FALSE(part1->getFunction("f1")->isDeclaration());
+
+  std::unique_ptr<llvm::Module> part2 = ParseBitcode(parts[2]);
+  EXPECT_TRUE(part2->getFunction("f1")->isDeclaration());
+  EXPECT_FALSE(part2->getFunction("entry")->isDeclaration());
+}
+
+TEST_F(LlvmModuleSplitterTest, RejectsUseBeforeDefinition) {
+  std::unique_ptr<llvm::Module> module = ParseModule(R"(
+define void @entry(float* %out) {
+  call void @f0(float* %out)
+  call void @f0(float* %out)
+  ret void
+}
+
+define internal void @f0(float* %out) {
+  store float 1.0, float* %out
+  store float 2.0, float* %out
+  ret void
+}
+)");
+
+  EXPECT_FALSE(SplitModuleForParallelCodegen(module.get(), 2).ok());
+  EXPECT_TRUE(module->getFunction("f0")->hasInternalLinkage());
+}
+
+TEST_F(LlvmModuleSplitterTest, DoesNotSplitIntoOnePart) {
+  std::unique_ptr<llvm::Module> module = ParseModule(R"(
+define void @entry(float* %out) {
+  store float 1.0, float* %out
+  ret void
+}
+)");
+
+  EXPECT_FALSE(SplitModuleForParallelCodegen(module.get(), 1).ok());
+}
+
+}  // namespace
+}  // namespace cpu
+}  // namespace xla
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/cpu/parallel_task_assignment.h"
 
+#include <algorithm>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "tensorflow/compiler/xla/service/cpu/dot_op_emitter.h"
@@ -27,6 +29,36 @@ limitations under the License.
 
 namespace xla {
 namespace cpu {
+namespace {
+
+// Throughput of a single core of a typical server CPU, and the memory
+// bandwidth available to a single core and to all cores of a socket. A memory
+// bound instruction stops scaling once the socket bandwidth is saturated.
+constexpr double kFlopsPerNanosecond = 4.0;
+constexpr double kTranscendentalsPerNanosecond = 0.25;
+constexpr double kBytesPerNanosecondPerCore = 10.0;
+constexpr double kBytesPerNanosecondPerSocket = 40.0;
+
+// Cost of forking and joining on the intra-op thread pool, and of each
+// additional task.
+constexpr double kForkJoinOverheadNs = 5000.0;
+constexpr double kTaskOverheadNs = 1000.0;
+
+// Returns the size of the output of 'instruction'. The outputs of a
+// multi-output fusion are summed rather than sizing the tuple index table.
+int64 GetOutputSize(const HloCostAnalysis::ShapeSizeFunction& shape_size,
+                    const HloInstruction& instruction) {
+  if (!instruction.shape().IsTuple()) {
+    return shape_size(instruction.shape());
+  }
+  int64 size = 0;
+  for (const Shape& tuple_shape : instruction.shape().tuple_shapes()) {
+    size += shape_size(tuple_shape);
+  }
+  return size;
+}
+
+}  // namespace
 
 class SimpleCostModel : public ParallelCostModel {
  public:
@@ -37,7 +69,7 @@ class SimpleCostModel : public ParallelCostModel {
 
   int64 GetParallelTaskCount(HloInstruction* instruction) override {
     // Simple cost model based on hlo size and typical L2 cache size.
-    const int64 instruction_cost = shape_size_(instruction->shape());
+    const int64 instruction_cost = GetOutputSize(shape_size_, *instruction);
     const int64 min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
     // Return target parallel task count in [1, max_parallelism_].
     return std::min(max_parallelism_,
@@ -49,6 +81,9 @@ class SimpleCostModel : public ParallelCostModel {
   const HloCostAnalysis::ShapeSizeFunction shape_size_;
 };
 
+// Estimates the run time of an instruction from HloCostAnalysis and picks the
+// task count that minimizes it. Instructions too small to amortize a fork-join
+// are not parallelized.
 class DefaultCostModel : public ParallelCostModel {
  public:
   DefaultCostModel(const int64 max_parallelism,
@@ -60,44 +95,43 @@ class DefaultCostModel : public ParallelCostModel {
   ~DefaultCostModel() override {}
 
   int64 GetParallelTaskCount(HloInstruction* instruction) override {
-    // Parameters for parallel task count computation.
-    int64 instruction_cost;
-    int64 min_cost_per_thread;
-    int64 max_parallelism;
-    // Calculate flops-to-bytes-ratio for 'instruction'.
-    const int64 bytes_accessed =
-        std::max(int64{1}, cost_analysis_->bytes_accessed(*instruction));
-    const float flops_to_bytes_ratio =
-        cost_analysis_->flop_count(*instruction) /
-        static_cast<float>(bytes_accessed);
-    // Check for I/O bound instructions.
-    if (flops_to_bytes_ratio <= 1.0) {
-      // Limit max parallelism for I/O bound instructions by assuming a
-      // sub-linear scaling function (fit based on empirical benchmark results).
-      // TODO(b/29630486) Develop system bandwidth model.
-      max_parallelism = std::min<int64>(
-          max_parallelism_,
-          std::ceil(std::sqrt(tensorflow::port::MaxParallelism())));
-      // Use shape size instruction cost and L2 cache size min per-thread cost.
-      instruction_cost = shape_size_(instruction->shape());
-      min_cost_per_thread = 256LL << 10;  // 256KB L2 Cache size.
-    } else {
-      // Use max parallelism for compute bound instructions.
-      max_parallelism = max_parallelism_;
-      // Calculate the instruction cost in cycles.
-      // TODO(b/29630486) Improve on this linear cost model.
-      // Consider making 'min_cost_per_thread' be a function of the target
-      // bandwidth limit for instructions with low arithmetic complexity.
-      instruction_cost =
-          1 * cost_analysis_->flop_count(*instruction) +
-          2 * cost_analysis_->transcendental_count(*instruction) +
-          10 * cost_analysis_->bytes_accessed(*instruction);
-      // Minimum per-thread cost is 100us of work on a 2GHz core.
-      min_cost_per_thread = 100000;
+    const double flops = cost_analysis_->flop_count(*instruction);
+    const double transcendentals =
+        cost_analysis_->transcendental_count(*instruction);
+    const double bytes =
+        std::max(cost_analysis_->bytes_accessed(*instruction),
+                 static_cast<float>(GetOutputSize(shape_size_, *instruction)));
+    const double compute_ns = flops / kFlopsPerNanosecond +
+                              transcendentals / kTranscendentalsPerNanosecond;
+
+    // Estimated run time of 'instruction' on 'task_count' threads: compute
+    // scales linearly, memory traffic scales until the memory bandwidth of the
+    // socket is saturated, and forking tasks has a fixed and a per-task cost.
+    auto estimated_ns = [&](int64 task_count) {
+      const double bandwidth =
+          std::min(task_count * kBytesPerNanosecondPerCore,
+                   kBytesPerNanosecondPerSocket);
+      double ns = std::max(compute_ns / task_count, bytes / bandwidth);
+      if (task_count > 1) {
+        ns += kForkJoinOverheadNs + task_count * kTaskOverheadNs;
+      }
+      return ns;
+    };
+
+    // Return the task count in [1, max_parallelism_] with the lowest estimated
+    // run time, preferring fewer tasks on ties.
+    int64 best_task_count = 1;
+    double best_ns = estimated_ns(1);
+    for (int64 task_count = 2; task_count <= max_parallelism_; ++task_count) {
+      const double ns = estimated_ns(task_count);
+      if (ns < best_ns) {
+        best_ns = ns;
+        best_task_count = task_count;
+      }
     }
-    // Return target parallel task count in [1, max_parallelism_].
-    return std::min(max_parallelism,
-                    std::max(int64{1}, instruction_cost / min_cost_per_thread));
+    VLOG(3) << "Estimated " << best_ns << "ns on " << best_task_count
+            << " tasks for " << instruction->name();
+    return best_task_count;
   }
 
  private:
@@ -135,7 +169,8 @@ int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
   // *) Internal threading (library calls to kConv, kDot, kFft, kCustomCall).
   // *) Emit custom loops (kSelectAndScatter).
   // *) Operations that are not thread safe (like infeed and rng).
-  // *) Tuple-shaped.
+  // *) Tuple-shaped, unless a multi-output loop fusion whose outputs can all
+  //    be emitted by one partitioned loop nest.
   // *) Operations that might be implemented as an in-place
   //    dynamic-update-slice, because we can't know how many output elements
   //    they will write (out-of-place will touch the whole output buffer, while
@@ -154,7 +189,8 @@ int64 ParallelTaskAssignment::GetTargetParallelTaskCount(
                                                 target_machine_features_)) ||
       (opcode == HloOpcode::kFusion && !instruction->IsLoopFusion()) ||
       llvm_ir::MayBeImplementedAsInPlaceDynamicUpdateSlice(instruction) ||
-      instruction->shape().IsTuple()) {
+      (instruction->shape().IsTuple() &&
+       !IsLoopFusibleMultiOutputFusion(*instruction))) {
     return 1;
   }
 
@@ -212,8 +248,9 @@ bool ParallelTaskAssigner::AssignParallelTasksHelper(
     // Get target parallel task count computed for 'instruction'.
     const int64 target_parallel_task_count = (*it).second;
     // Assign feasible dimension partitions (based on actual dimension sizes).
-    auto dim_partition_counts = ShapePartitionAssigner(instruction->shape())
-                                    .Run(target_parallel_task_count);
+    auto dim_partition_counts =
+        ShapePartitionAssigner(GetLoopShape(*instruction))
+            .Run(target_parallel_task_count);
     const int64 total_partition_count =
         ShapePartitionAssigner::GetTotalPartitionCount(dim_partition_counts);
     if (total_partition_count <= 1) {
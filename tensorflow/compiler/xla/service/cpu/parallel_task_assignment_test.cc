@@ -170,5 +170,65 @@ TEST_F(ParallelTaskAssignmentTest, InPlaceDynamicUpdateSliceNotParallelized) {
   EXPECT_FALSE(changed);
 }
 
+TEST_F(ParallelTaskAssignmentTest, LargeElementwiseOperationParallelized) {
+  const string hlo_string = R"(
+    HloModule TestTaskParallel_large_exp
+    ENTRY LargeExp {
+      p0 = f32[1024,1024]{1,0} parameter(0)
+      ROOT exp = f32[1024,1024]{1,0} exponential(p0)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+  const HloInstruction* root = m->entry_computation()->root_instruction();
+  ASSERT_EQ(root->opcode(), HloOpcode::kCall);
+  EXPECT_FALSE(root->to_apply()
+                   ->root_instruction()
+                   ->outer_dimension_partitions()
+                   .empty());
+}
+
+TEST_F(ParallelTaskAssignmentTest, SmallElementwiseOperationNotParallelized) {
+  // Too little work to amortize the cost of a fork-join.
+  const string hlo_string = R"(
+    HloModule TestTaskParallel_small_add
+    ENTRY SmallAdd {
+      p0 = f32[64,64]{1,0} parameter(0)
+      p1 = f32[64,64]{1,0} parameter(1)
+      ROOT add = f32[64,64]{1,0} add(p0, p1)
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_FALSE(changed);
+}
+
+TEST_F(ParallelTaskAssignmentTest, MultiOutputLoopFusionParallelized) {
+  const string hlo_string = R"(
+    HloModule TestTaskParallel_multi_output_fusion
+    fused_computation {
+      p0.1 = f32[1024,1024]{1,0} parameter(0)
+      exp = f32[1024,1024]{1,0} exponential(p0.1)
+      log = f32[1024,1024]{1,0} log(p0.1)
+      ROOT tuple = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0}) tuple(exp, log)
+    }
+    ENTRY MultiOutputFusion {
+      p0 = f32[1024,1024]{1,0} parameter(0)
+      ROOT fusion = (f32[1024,1024]{1,0}, f32[1024,1024]{1,0}) fusion(p0),
+        kind=kLoop, calls=fused_computation
+    }
+  )";
+
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<HloModule> m,
+                          ParseAndReturnVerifiedModule(hlo_string));
+  TF_ASSERT_OK_AND_ASSIGN(bool changed, RunParallelTaskAssigner(m.get()));
+  EXPECT_TRUE(changed);
+}
+
 }  // namespace
 }  // namespace xla
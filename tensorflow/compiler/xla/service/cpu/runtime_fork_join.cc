@@ -17,6 +17,10 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/compiler/xla/executable_run_options.h"
 #include "tensorflow/core/platform/blocking_counter.h"
@@ -31,9 +35,27 @@ using tensorflow::uint64;
 using ComputeFunctionType = void (*)(void*, const void*, const void**, void**,
                                      int64*, uint64*);
 
-// Dispatches 'num_partitions - 1' calls to 'function_ptr' in parallel.
-// Calls 'function_ptr' for first partition inline.
-// Uses blocking counter to synchronize threads after parallel calls complete.
+namespace {
+
+// State shared by the caller of ParallelForkJoin and the tasks it enqueues.
+// Tasks may outlive the call when every partition was claimed before they
+// started, so the state is reference counted.
+struct ForkJoinState {
+  explicit ForkJoinState(int32 num_partitions)
+      : partitions_done(num_partitions) {}
+
+  std::atomic<int32> next_partition{0};
+  tensorflow::BlockingCounter partitions_done;
+};
+
+}  // namespace
+
+// Calls 'function_ptr' once for each of the 'num_partitions' partitions.
+// The calling thread and up to 'num_partitions - 1' tasks on the intra-op
+// thread pool claim partitions dynamically from a shared counter, so threads
+// that start late or finish early do not leave work waiting behind them, and
+// partitions are never queued behind busy pool threads. The caller returns
+// once every partition has run, without waiting for tasks that found no work.
 //
 // The 'partitions' array has a total number of elements equal to
 // 'num_partitions * num_partitioned_dims * 2' (the '2' is necessary to specify
@@ -81,24 +103,29 @@ TF_ATTRIBUTE_NO_SANITIZE_MEMORY void __xla_cpu_runtime_ParallelForkJoin(
   // Compute partition stride in 'partitions' array.
   const int64 stride = 2 * num_partitioned_dims;
 
-  // Dispatch 'num_partitions - 1' compute functions to run in parallel.
-  tensorflow::BlockingCounter bc(num_partitions - 1);
-  for (int32 i = 1; i < num_partitions; ++i) {
-    const int64 offset = i * stride;
-    run_options->intra_op_thread_pool()->enqueueNoNotification(
-        [i, function, result_ptr, run_options_ptr, buffer_table, prof_counters,
-         partitions, offset, &bc]() {
-          function(result_ptr, run_options_ptr, nullptr, buffer_table,
-                   &partitions[offset], prof_counters);
-          bc.DecrementCount();
-          VLOG(3) << "ParallelForkJoin partition " << i << " done.";
-        });
+  // Run at most one task per pool thread, in addition to the caller.
+  const Eigen::ThreadPoolDevice* thread_pool =
+      run_options->intra_op_thread_pool();
+  const int32 num_tasks =
+      std::min(num_partitions, thread_pool->numThreads() + 1);
+
+  auto state = std::make_shared<ForkJoinState>(num_partitions);
+  auto run_partitions = [state, num_partitions, function, result_ptr,
+                         run_options_ptr, buffer_table, prof_counters,
+                         partitions, stride]() {
+    for (int32 i = state->next_partition.fetch_add(1); i < num_partitions;
+         i = state->next_partition.fetch_add(1)) {
+      function(result_ptr, run_options_ptr, nullptr, buffer_table,
+               &partitions[i * stride], prof_counters);
+      VLOG(3) << "ParallelForkJoin partition " << i << " done.";
+      state->partitions_done.DecrementCount();
+    }
+  };
+  for (int32 i = 1; i < num_tasks; ++i) {
+    thread_pool->enqueueNoNotification(run_partitions);
   }
 
-  // Call first compute function inline.
-  function(result_ptr, run_options_ptr, params, buffer_table, &partitions[0],
-           prof_counters);
-  VLOG(3) << "ParallelForkJoin partition 0 done.";
-  bc.Wait();
+  run_partitions();
+  state->partitions_done.Wait();
   VLOG(2) << "ParallelForkJoin EXIT";
 }
@@ -22,6 +22,7 @@ limitations under the License.
 #include <utility>
 
 #include "absl/memory/memory.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/ExecutionEngine/ExecutionEngine.h"
 #include "llvm/ExecutionEngine/JITSymbol.h"
 #include "llvm/ExecutionEngine/SectionMemoryManager.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Host.h"
 #include "tensorflow/compiler/xla/service/cpu/cpu_runtime.h"
+#include "tensorflow/compiler/xla/service/cpu/llvm_module_splitter.h"
 #include "tensorflow/compiler/xla/service/cpu/orc_jit_memory_mapper.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d.h"
 #include "tensorflow/compiler/xla/service/cpu/runtime_conv2d_mkl.h"
@@ -45,6 +47,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/cpu/windows_compatibility.h"
 #include "tensorflow/compiler/xla/service/custom_call_target_registry.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -89,11 +93,22 @@ SimpleOrcJIT::SimpleOrcJIT(
     LLVMCompiler::ModuleHook pre_optimization_hook,
     LLVMCompiler::ModuleHook post_optimization_hook,
     std::function<void(const llvm::object::ObjectFile&)> post_codegen_hook)
-    : target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
+    : target_options_(target_options),
+      opt_level_(opt_level),
+      optimize_for_size_(optimize_for_size),
+      disable_expensive_passes_(disable_expensive_passes),
+      fast_math_flags_(fast_math_flags),
+      pre_optimization_hook_(pre_optimization_hook),
+      post_optimization_hook_(post_optimization_hook),
+      post_codegen_hook_(post_codegen_hook),
+      target_machine_(InferTargetMachineForJIT(target_options, opt_level)),
       data_layout_(target_machine_->createDataLayout()),
       symbol_resolver_(llvm::orc::createLegacyLookupResolver(
           execution_session_,
           [this](llvm::StringRef name) -> llvm::JITSymbol {
+            if (auto symbol = this->FindCompiledSymbol(std::string(name))) {
+              return symbol;
+            }
             return this->ResolveRuntimeSymbol(std::string(name));
           },
           [](llvm::Error Err) {
@@ -179,6 +194,60 @@ SimpleOrcJIT::VModuleKeyT SimpleOrcJIT::AddModule(
   return key;
 }
 
+Status SimpleOrcJIT::AddModuleInParallel(
+    std::unique_ptr<llvm::Module> module, int num_parts,
+    tensorflow::thread::ThreadPool* thread_pool) {
+  StatusOr<std::vector<std::string>> parts =
+      SplitModuleForParallelCodegen(module.get(), num_parts);
+  if (!parts.ok()) {
+    VLOG(1) << "Compiling " << module->getModuleIdentifier()
+            << " as a single module: " << parts.status();
+    AddModule(std::move(module));
+    return Status::OK();
+  }
+  module.reset();
+
+  std::vector<StatusOr<std::unique_ptr<llvm::MemoryBuffer>>> objects(
+      parts.ValueOrDie().size());
+  tensorflow::BlockingCounter pending(objects.size());
+  for (int64 i = 0; i < objects.size(); ++i) {
+    thread_pool->Schedule([&, i] {
+      objects[i] = CompileBitcode(parts.ValueOrDie()[i]);
+      pending.DecrementCount();
+    });
+  }
+  pending.Wait();
+
+  // Add the parts in order, so that each part is linked against the parts
+  // before it.
+  for (auto& object : objects) {
+    TF_RETURN_IF_ERROR(object.status());
+    auto key = execution_session_.allocateVModule();
+    cantFail(object_layer_.addObject(key, std::move(object).ValueOrDie()));
+    module_keys_.push_back(key);
+  }
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<llvm::MemoryBuffer>> SimpleOrcJIT::CompileBitcode(
+    const std::string& bitcode) const {
+  llvm::LLVMContext context;
+  llvm::Expected<std::unique_ptr<llvm::Module>> module =
+      llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, "split_module"),
+                             context);
+  if (!module) {
+    return InternalError("Failed to parse split module: %s",
+                         llvm::toString(module.takeError()));
+  }
+  std::unique_ptr<llvm::TargetMachine> target_machine =
+      InferTargetMachineForJIT(target_options_, opt_level_);
+  CompilerFunctor compiler(target_machine.get(), opt_level_,
+                           optimize_for_size_, disable_expensive_passes_,
+                           fast_math_flags_, pre_optimization_hook_,
+                           post_optimization_hook_, post_codegen_hook_);
+  return compiler(**module);
+}
+
 void SimpleOrcJIT::RemoveModule(SimpleOrcJIT::VModuleKeyT key) {
   module_keys_.erase(std::remove(module_keys_.begin(), module_keys_.end(), key),
                      module_keys_.end());
@@ -29,7 +29,9 @@ limitations under the License.
 #include "llvm/IR/Module.h"
 #include "llvm/Target/TargetMachine.h"
 #include "tensorflow/compiler/xla/service/cpu/compiler_functor.h"
+#include "tensorflow/compiler/xla/status.h"
 #include "tensorflow/compiler/xla/types.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 namespace cpu {
@@ -39,9 +41,11 @@ namespace cpu {
 // This class wraps Orc's functionality into a single interface that only
 // exposes what we need for XLA.
 //
-// Supports JIT-ing multiple modules but without cross-module linking.
-// Implements eager compilation - the module is lowered to binary as soon as
-// it's added to the JIT.
+// Supports JIT-ing multiple modules.  Symbols that a module uses but does not
+// define are looked up in the other modules of the JIT, and then among the
+// XLA runtime functions and custom call targets.  Implements eager
+// compilation - the module is lowered to binary as soon as it's added to the
+// JIT.
 class SimpleOrcJIT {
  public:
   using ObjLayerT = llvm::orc::LegacyRTDyldObjectLinkingLayer;
@@ -73,6 +77,15 @@ class SimpleOrcJIT {
   // remove this module.
   VModuleKeyT AddModule(std::unique_ptr<llvm::Module> module);
 
+  // Like AddModule, but splits `module` into up to `num_parts` parts that are
+  // optimized and lowered to binary in parallel on `thread_pool`.  Falls back
+  // to AddModule if `module` can't be split, see
+  // SplitModuleForParallelCodegen.  The {pre,post}_optimization_hook and
+  // post_codegen_hook are invoked on each part, possibly concurrently.
+  Status AddModuleInParallel(std::unique_ptr<llvm::Module> module,
+                             int num_parts,
+                             tensorflow::thread::ThreadPool* thread_pool);
+
   // Remove a module from the JIT and free the memory associated with it.
   void RemoveModule(VModuleKeyT key);
 
@@ -96,6 +109,23 @@ class SimpleOrcJIT {
       const llvm::RuntimeDyld::LoadedObjectInfo& object_info);
   void NotifyObjectFreed(const llvm::object::ObjectFile& object);
 
+  // Optimizes and lowers the module with the given bitcode to binary, on a
+  // new LLVM context and target machine so that it can run concurrently with
+  // the JIT's own compilation.
+  StatusOr<std::unique_ptr<llvm::MemoryBuffer>> CompileBitcode(
+      const std::string& bitcode) const;
+
+  // The arguments of the constructor, for CompileBitcode.
+  const llvm::TargetOptions target_options_;
+  const llvm::CodeGenOpt::Level opt_level_;
+  const bool optimize_for_size_;
+  const bool disable_expensive_passes_;
+  const llvm::FastMathFlags fast_math_flags_;
+  const LLVMCompiler::ModuleHook pre_optimization_hook_;
+  const LLVMCompiler::ModuleHook post_optimization_hook_;
+  const std::function<void(const llvm::object::ObjectFile&)>
+      post_codegen_hook_;
+
   std::vector<VModuleKeyT> module_keys_;
   std::unique_ptr<llvm::TargetMachine> target_machine_;
   const llvm::DataLayout data_layout_;
@@ -130,9 +130,46 @@ struct ExecuteAsyncOnStreamWrapperState {
   std::shared_ptr<HloExecutionProfile> profile_ptr;
 };
 
+void AggregatedHloExecutionProfile::Add(const HloExecutionProfile& profile) {
+  const std::vector<int64>& counters = profile.profile_counters();
+  tensorflow::mutex_lock lock(mu_);
+  if (counters_.empty()) {
+    counters_.resize(counters.size());
+  }
+  CHECK_EQ(counters_.size(), counters.size());
+  for (int64 i = 0; i < counters.size(); ++i) {
+    counters_[i] += counters[i];
+  }
+  ++num_profiles_;
+}
+
+int64 AggregatedHloExecutionProfile::Get(HloExecutionProfile* profile) const {
+  tensorflow::mutex_lock lock(mu_);
+  std::vector<int64>* counters = profile->mutable_profile_counters();
+  if (!counters_.empty()) {
+    CHECK_EQ(counters->size(), counters_.size());
+    *counters = counters_;
+  }
+  return num_profiles_;
+}
+
+bool Executable::ShouldProfileNextExecution() {
+  if (!module_config().debug_options().xla_hlo_profile() ||
+      !hlo_profiling_enabled()) {
+    return false;
+  }
+  const int64 period =
+      module_config().debug_options().xla_hlo_profile_sampling_period();
+  if (period < 2) {
+    return true;
+  }
+  return hlo_profile_candidates_.fetch_add(1, std::memory_order_relaxed) %
+             period ==
+         0;
+}
+
 static ExecuteAsyncOnStreamWrapperState ExecuteWrapperBeforeExecution(
-    const Executable& executable,
-    const ServiceExecutableRunOptions* run_options) {
+    Executable* executable, const ServiceExecutableRunOptions* run_options) {
   ExecuteAsyncOnStreamWrapperState state;
   se::Stream* stream = run_options->stream();
   state.profile = run_options->run_options().execution_profile();
@@ -142,14 +179,13 @@ static ExecuteAsyncOnStreamWrapperState ExecuteWrapperBeforeExecution(
   }
 
   VLOG(1) << "enqueueing executable on stream...";
-  // If the profiling flag isn't enabled, we pass nullptr as the profile to
-  // indicate profiling is not requested.
+  // If the profiling flag isn't enabled, or this execution isn't sampled, we
+  // pass nullptr as the profile to indicate profiling is not requested.
   state.profile_ptr =
-      executable.module_config().debug_options().xla_hlo_profile() &&
-              executable.hlo_profiling_enabled()
+      executable->ShouldProfileNextExecution()
           ? std::make_shared<HloExecutionProfile>(
-                &executable.hlo_profile_printer_data(),
-                &executable.hlo_profile_index_map())
+                &executable->hlo_profile_printer_data(),
+                &executable->hlo_profile_index_map())
           : nullptr;
   return state;
 }
@@ -215,7 +251,10 @@ Status ExecuteWrapperAfterExecution(
     const se::DeviceDescription* device_description =
         &stream->parent()->GetDeviceDescription();
     std::shared_ptr<HloExecutionProfile> profile = state.profile_ptr;
-    stream->ThenDoHostCallback([profile, device_description]() {
+    std::shared_ptr<AggregatedHloExecutionProfile> aggregate =
+        executable->aggregated_hlo_profile();
+    stream->ThenDoHostCallback([profile, aggregate, device_description]() {
+      aggregate->Add(*profile);
       XLA_LOG_LINES(tensorflow::INFO, profile->ToString(*device_description));
     });
   }
@@ -226,7 +265,7 @@ Status ExecuteWrapperAfterExecution(
 StatusOr<ScopedShapedBuffer> Executable::ExecuteAsyncOnStreamWrapper(
     const ServiceExecutableRunOptions* run_options,
     absl::Span<const ShapedBuffer* const> arguments) {
-  auto state = ExecuteWrapperBeforeExecution(*this, run_options);
+  auto state = ExecuteWrapperBeforeExecution(this, run_options);
   StatusOr<ScopedShapedBuffer> return_value =
       ExecuteAsyncOnStream(run_options, arguments, state.profile_ptr.get());
   TF_RETURN_IF_ERROR(ExecuteWrapperAfterExecution(
@@ -237,7 +276,7 @@ StatusOr<ScopedShapedBuffer> Executable::ExecuteAsyncOnStreamWrapper(
 StatusOr<ExecutionOutput> Executable::ExecuteAsyncOnStreamWrapper(
     const ServiceExecutableRunOptions* run_options,
     std::vector<ExecutionInput> arguments) {
-  auto state = ExecuteWrapperBeforeExecution(*this, run_options);
+  auto state = ExecuteWrapperBeforeExecution(this, run_options);
   StatusOr<ExecutionOutput> return_value = ExecuteAsyncOnStream(
       run_options, std::move(arguments), state.profile_ptr.get());
   TF_RETURN_IF_ERROR(ExecuteWrapperAfterExecution(
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_XLA_SERVICE_EXECUTABLE_H_
 #define TENSORFLOW_COMPILER_XLA_SERVICE_EXECUTABLE_H_
 
+#include <atomic>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -42,6 +43,22 @@ limitations under the License.
 
 namespace xla {
 
+// Sums the counters of the HloExecutionProfiles collected by several
+// executions of the same executable. Thread-safe.
+class AggregatedHloExecutionProfile {
+ public:
+  void Add(const HloExecutionProfile& profile);
+
+  // Stores the summed counters into `profile`, which must have been created
+  // for the same executable, and returns the number of profiles added so far.
+  int64 Get(HloExecutionProfile* profile) const;
+
+ private:
+  mutable tensorflow::mutex mu_;
+  std::vector<int64> counters_ GUARDED_BY(mu_);
+  int64 num_profiles_ GUARDED_BY(mu_) = 0;
+};
+
 // TODO(b/150633678): Both the ExecutionInput and ExecutionOutput need to be
 // revisited, with the execute APIs taking data structure which can better model
 // shareable buffers.
@@ -316,6 +333,20 @@ class Executable {
     return hlo_profile_printer_data_ != nullptr;
   }
 
+  // Returns whether the upcoming execution should collect an
+  // HloExecutionProfile. Every call counts as one execution towards
+  // xla_hlo_profile_sampling_period, so only one in that many calls returns
+  // true when sampling is enabled.
+  bool ShouldProfileNextExecution();
+
+  // Returns the sum of the HLO profiles collected by the executions of this
+  // executable that were profiled. Shared so that profiles completing in
+  // stream callbacks can be added after the executable is gone.
+  std::shared_ptr<AggregatedHloExecutionProfile> aggregated_hlo_profile()
+      const {
+    return aggregated_hlo_profile_;
+  }
+
   HloModule& module() const { return *hlo_module_; }
   std::shared_ptr<HloModule> shared_module() const { return hlo_module_; }
 
@@ -357,6 +388,13 @@ class Executable {
 
   std::unique_ptr<HloProfilePrinterData> hlo_profile_printer_data_;
   std::unique_ptr<HloProfileIndexMap> hlo_profile_index_map_;
+
+ private:
+  // Number of executions considered for HLO profiling so far.
+  std::atomic<int64> hlo_profile_candidates_{0};
+
+  const std::shared_ptr<AggregatedHloExecutionProfile> aggregated_hlo_profile_ =
+      std::make_shared<AggregatedHloExecutionProfile>();
 };
 
 }  // namespace xla
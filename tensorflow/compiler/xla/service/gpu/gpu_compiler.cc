@@ -131,6 +131,9 @@ Status GpuCompiler::OptimizeHloModule(
     se::DeviceMemoryAllocator* device_allocator) {
   {
     HloPassPipeline pipeline("optimization");
+    std::unique_ptr<tensorflow::thread::ThreadPool> thread_pool =
+        MaybeCreateHloPassThreadPool(hlo_module->config().debug_options());
+    pipeline.set_thread_pool(thread_pool.get());
     pipeline.AddInvariantChecker<HloVerifier>(/*layout_sensitive=*/false,
                                               /*allow_mixed_precision=*/false);
 
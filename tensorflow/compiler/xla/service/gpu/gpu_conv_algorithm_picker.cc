@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/platform/logger.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/autotune_database.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/proto/proto_utils.h"
 
@@ -302,6 +303,23 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     autotune_cache_stats.cache_misses++;
   }
 
+  // Results tuned by an earlier process, on an identical device, are as good
+  // as our own.
+  tensorflow::AutotuneDatabase* database =
+      tensorflow::AutotuneDatabase::Global();
+  std::string database_device, database_key;
+  if (database != nullptr) {
+    database_device = tensorflow::AutotuneDeviceKey(stream_exec_);
+    database_key = absl::StrCat("XlaConv: ", std::get<1>(key));
+    tensorflow::AutotuneDatabaseEntry entry;
+    if (database->Lookup(database_device, database_key, &entry) &&
+        entry.result().has_conv()) {
+      tensorflow::mutex_lock lock(autotune_cache_lock);
+      autotune_cache.insert({key, entry.result()});
+      return entry.result();
+    }
+  }
+
   // Make sure any previous activity on this executor is done. We don't want to
   // interfere with programs that are still running on the GPU.
   if (!stream_exec_->SynchronizeAllActivity()) {
@@ -337,6 +355,13 @@ StatusOr<AutotuneResult> GpuConvAlgorithmPicker::PickBestAlgorithm(
     tensorflow::mutex_lock lock(autotune_cache_lock);
     CHECK(autotune_cache.insert({key, result_or.ValueOrDie()}).second);
   }
+  if (result_or.ok() && database != nullptr) {
+    tensorflow::AutotuneDatabaseEntry entry;
+    entry.set_device(database_device);
+    entry.set_key(database_key);
+    *entry.mutable_result() = result_or.ValueOrDie();
+    database->Insert(entry);
+  }
   return result_or;
 }
 
@@ -102,7 +102,9 @@ HloInstruction* HloComputation::AddInstruction(
 
 HloInstruction* HloComputation::AddInstructionInternal(
     std::unique_ptr<HloInstruction> instruction) {
-  if (parent() != nullptr) {
+  if (next_deferred_id_ >= 0) {
+    instruction->SetUniqueId(next_deferred_id_++);
+  } else if (parent() != nullptr) {
     instruction->UniquifyName(&parent()->instruction_name_uniquer());
     instruction->SetUniqueId(parent()->NewUniqueInstructionId());
   }
@@ -113,6 +115,30 @@ HloInstruction* HloComputation::AddInstructionInternal(
   return pinst;
 }
 
+void HloComputation::DeferInstructionUniquification(int64 first_id) {
+  CHECK_EQ(next_deferred_id_, -1);
+  CHECK_GE(first_id, 0);
+  first_deferred_id_ = first_id;
+  next_deferred_id_ = first_id;
+}
+
+void HloComputation::UniquifyDeferredInstructions() {
+  CHECK_GE(next_deferred_id_, 0);
+  CHECK(parent() != nullptr);
+  // Instructions are added at the end of instructions_, so this visits the
+  // surviving deferred instructions in the order in which they were added.
+  for (auto& instruction : instructions_) {
+    if (instruction->unique_id() < first_deferred_id_) {
+      continue;
+    }
+    instruction->ClearUniqueIdInternal();
+    instruction->UniquifyName(&parent()->instruction_name_uniquer());
+    instruction->SetUniqueId(parent()->NewUniqueInstructionId());
+  }
+  first_deferred_id_ = -1;
+  next_deferred_id_ = -1;
+}
+
 HloInstruction* HloComputation::AddParameter(
     std::unique_ptr<HloInstruction> instruction) {
   CHECK(instruction->opcode() == HloOpcode::kParameter);
@@ -475,6 +475,19 @@ class HloComputation {
   // HloInstructions in a pass.
   void Cleanup() { to_be_deleted_.clear(); }
 
+  // Makes AddInstruction stop using the parent module to name and number new
+  // instructions, so that instructions can be added to different computations
+  // of a module concurrently.  Until UniquifyDeferredInstructions is called,
+  // new instructions keep the names they were created with and get ids from
+  // `first_id` upwards, which must be greater than the id of any instruction
+  // in the module.
+  void DeferInstructionUniquification(int64 first_id);
+
+  // Gives the instructions added since DeferInstructionUniquification was
+  // called module-unique names and ids, in the order in which they were
+  // added, and resumes naming and numbering new instructions immediately.
+  void UniquifyDeferredInstructions();
+
  private:
   explicit HloComputation(
       const string& name, int parameter_count,
@@ -525,6 +538,12 @@ class HloComputation {
   // Module containing this computation.
   HloModule* parent_ = nullptr;
 
+  // If non-negative, the id given to the next instruction added, and the
+  // names and ids of new instructions are not uniquified in parent_.  See
+  // DeferInstructionUniquification.
+  int64 first_deferred_id_ = -1;
+  int64 next_deferred_id_ = -1;
+
   // Store instructions in std::list as they can be added and removed
   // arbitrarily and we want a stable iteration order. Keep a map from
   // instruction pointer to location in the list for fast lookup.
@@ -49,6 +49,9 @@ limitations under the License.
 #include "tensorflow/core/lib/core/bitmap.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/types.h"
@@ -168,8 +171,32 @@ StatusOr<Literal> Compare<complex128>(const Shape& shape,
   return std::move(result);
 }
 
+// Elementwise ops over fewer elements than this are not worth sharding.
+constexpr int64 kMinElementsForParallelEvaluation = 1 << 16;
+
+// Rough cost, in cycles, of evaluating one element through a std::function.
+constexpr int64 kElementwiseCostPerElement = 50;
+
+tensorflow::thread::ThreadPool* GetEvaluatorThreadPool() {
+  static tensorflow::thread::ThreadPool* pool =
+      new tensorflow::thread::ThreadPool(tensorflow::Env::Default(),
+                                         "hlo_evaluator",
+                                         tensorflow::port::MaxParallelism());
+  return pool;
+}
+
 }  // namespace
 
+/*static*/ void HloEvaluator::ParallelForLinearIndices(
+    int64 num_elements, const std::function<void(int64, int64)>& fn) {
+  if (num_elements < kMinElementsForParallelEvaluation) {
+    fn(0, num_elements);
+    return;
+  }
+  GetEvaluatorThreadPool()->ParallelFor(num_elements,
+                                        kElementwiseCostPerElement, fn);
+}
+
 // Note that unsupported types by the typed visitor does not necessarily imply
 // the non-typed HloEvaluator (parent evaluator) would not support them either
 // in the type-agnostic handler. For e.g., HandleGetTupleElement in the parent
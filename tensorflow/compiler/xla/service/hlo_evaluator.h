@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/types/span.h"
 #include "tensorflow/compiler/xla/array2d.h"
+#include "tensorflow/compiler/xla/layout_util.h"
 #include "tensorflow/compiler/xla/literal.h"
 #include "tensorflow/compiler/xla/service/dfs_hlo_visitor_with_default.h"
 #include "tensorflow/compiler/xla/service/dynamic_dimension_inference.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
 #include "tensorflow/compiler/xla/service/shape_inference.h"
+#include "tensorflow/compiler/xla/shape_util.h"
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/compiler/xla/xla_data.pb.h"
@@ -330,6 +332,17 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     TF_RET_CHECK(ShapeUtil::SameDimensions(shape, operand->shape()));
 
     Literal result(shape);
+    if (HasSameLinearOrder(operand_literal, result)) {
+      absl::Span<const NativeT> operand_data = operand_literal.data<NativeT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      ParallelForLinearIndices(
+          result_data.size(), [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              result_data[i] = unary_op(operand_data[i]);
+            }
+          });
+      return std::move(result);
+    }
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return unary_op(operand_literal.Get<NativeT>(multi_index));
@@ -337,6 +350,23 @@ class HloEvaluator : public DfsHloVisitorWithDefault {
     return std::move(result);
   }
 
+  // Returns true if the dense array `operand` stores its elements in the same
+  // linear order as `result`, in which case elementwise ops can run directly
+  // over the raw data instead of through multi-dimensional indices.
+  static bool HasSameLinearOrder(const LiteralBase& operand,
+                                 const LiteralBase& result) {
+    return LayoutUtil::IsDenseArray(operand.shape()) &&
+           LayoutUtil::IsDenseArray(result.shape()) &&
+           ShapeUtil::SameDimensions(operand.shape(), result.shape()) &&
+           LayoutUtil::Equal(operand.shape().layout(), result.shape().layout());
+  }
+
+  // Calls `fn(begin, end)` on disjoint shards covering the linear indices
+  // [0, num_elements). Large ranges are sharded across a thread pool shared by
+  // all evaluators, so `fn` must be thread-safe.
+  static void ParallelForLinearIndices(
+      int64 num_elements, const std::function<void(int64, int64)>& fn);
+
   // Map from a primitive type to its associated (templated) DfsHloVisitor.
   std::unique_ptr<DfsHloVisitor> typed_visitors_[PrimitiveType_ARRAYSIZE];
 
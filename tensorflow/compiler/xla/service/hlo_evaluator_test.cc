@@ -359,6 +359,28 @@ TEST_F(HloEvaluatorTest, DoesMultiply) {
   TestBinaryOp(HloOpcode::kMultiply, std::move(expected), std::move(lhs),
                std::move(rhs));
 }
+// Large enough for the evaluation to be sharded across threads.
+TEST_F(HloEvaluatorTest, DoesAddLarge) {
+  Array2D<int32> lhs_array(512, 256);
+  lhs_array.FillIota(0);
+  Array2D<int32> rhs_array(512, 256, 7);
+  Array2D<int32> expected_array(512, 256);
+  expected_array.FillIota(7);
+  TestBinaryOp(HloOpcode::kAdd,
+               LiteralUtil::CreateR2FromArray2D(expected_array),
+               LiteralUtil::CreateR2FromArray2D(lhs_array),
+               LiteralUtil::CreateR2FromArray2D(rhs_array));
+}
+// Operands whose layout differs from the result's can't be evaluated over their
+// raw data.
+TEST_F(HloEvaluatorTest, DoesAddWithMismatchedLayouts) {
+  auto lhs = LiteralUtil::CreateR2<int64>({{1, 0}, {-100, 4}})
+                 .Relayout(LayoutUtil::MakeLayout({0, 1}));
+  auto rhs = LiteralUtil::CreateR2<int64>({{2, 4}, {4, 4}});
+  auto expected = LiteralUtil::CreateR2<int64>({{3, 4}, {-96, 8}});
+  TestBinaryOp(HloOpcode::kAdd, std::move(expected), std::move(lhs),
+               std::move(rhs));
+}
 // Verifies that HloEvaluator evaluates a HLO instruction that performs
 // element-wise divide with 2 operands.
 TEST_F(HloEvaluatorTest, DoesDivideInt64) {
@@ -422,6 +444,12 @@ TEST_F(HloEvaluatorTest, DoesNegateR2) {
       {{0, std::numeric_limits<int>::min()}, {1, -4}});
   TestUnaryOp(HloOpcode::kNegate, std::move(expected), std::move(operand));
 }
+TEST_F(HloEvaluatorTest, DoesNegateR2WithMismatchedLayout) {
+  auto operand = LiteralUtil::CreateR2<int32>({{0, 1}, {-1, 4}})
+                     .Relayout(LayoutUtil::MakeLayout({0, 1}));
+  auto expected = LiteralUtil::CreateR2<int32>({{0, -1}, {1, -4}});
+  TestUnaryOp(HloOpcode::kNegate, std::move(expected), std::move(operand));
+}
 TEST_P(HloEvaluatorBf16Test, DoesCosR2) {
   auto operand = LiteralUtil::CreateR2<float>({{0, M_PI}, {-M_PI, 2 * M_PI}});
   auto expected = LiteralUtil::CreateR2<float>({{1, -1}, {-1, 1}});
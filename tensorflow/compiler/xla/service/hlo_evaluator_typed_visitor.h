@@ -2839,6 +2839,22 @@ class HloEvaluatorTypedVisitor : public DfsHloVisitorWithDefault {
 
     Literal result(shape);
 
+    if (HloEvaluator::HasSameLinearOrder(lhs_literal, result) &&
+        HloEvaluator::HasSameLinearOrder(rhs_literal, result)) {
+      absl::Span<const ReturnT> lhs_data = lhs_literal.data<ReturnT>();
+      absl::Span<const ReturnT> rhs_data = rhs_literal.data<ReturnT>();
+      absl::Span<ReturnT> result_data = result.data<ReturnT>();
+      HloEvaluator::ParallelForLinearIndices(
+          result_data.size(), [&](int64 begin, int64 end) {
+            for (int64 i = begin; i < end; ++i) {
+              result_data[i] = static_cast<ReturnT>(
+                  binary_op(static_cast<ElementwiseT>(lhs_data[i]),
+                            static_cast<ElementwiseT>(rhs_data[i])));
+            }
+          });
+      return std::move(result);
+    }
+
     TF_RETURN_IF_ERROR(
         result.Populate<ReturnT>([&](absl::Span<const int64> multi_index) {
           return ConvertBinaryFunction(binary_op)(
@@ -43,6 +43,9 @@ class HloPassInterface {
   virtual StatusOr<bool> RunOnModuleGroup(HloModuleGroup* module_group) = 0;
 
   virtual bool IsPassPipeline() { return false; }
+
+  // Returns true if this is an HloComputationPass.
+  virtual bool IsComputationPass() { return false; }
 };
 
 // Base class for passes which are module-scoped.
@@ -68,6 +71,33 @@ class HloModulePass : public HloPassInterface {
   virtual void UpdateLayout(Shape* shape) {}
 };
 
+// Base class for passes which run on each non-fusion computation of a module
+// independently.  HloPassPipeline can run such a pass on the computations of
+// a module in parallel, see HloPassPipeline::set_thread_pool, so
+// RunOnComputation may only read and modify the computation it is given and
+// the instructions in it.  In particular it must not add or remove
+// computations, or add instructions to any other computation, including the
+// fused computations of the fusion instructions in `computation`.
+class HloComputationPass : public HloModulePass {
+ public:
+  // Runs the pass on the given non-fusion computation.  Returns whether it
+  // modified the computation.
+  virtual StatusOr<bool> RunOnComputation(HloComputation* computation) = 0;
+
+  // Runs the pass on each non-fusion computation of the module in turn.
+  StatusOr<bool> Run(HloModule* module) override {
+    bool changed = false;
+    for (HloComputation* computation : module->MakeNonfusionComputations()) {
+      TF_ASSIGN_OR_RETURN(bool computation_changed,
+                          RunOnComputation(computation));
+      changed |= computation_changed;
+    }
+    return changed;
+  }
+
+  bool IsComputationPass() override { return true; }
+};
+
 // Base class for passes which are module-group scoped. These passes cannot run
 // on an HLO module.
 class HloModuleGroupPass : public HloPassInterface {
@@ -27,6 +27,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/status_macros.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/compiler/xla/util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace xla {
@@ -66,6 +68,11 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
                  /*before_pass_name=*/pass_name);
     if (!pass->IsPassPipeline()) {
       compilation_stats_->StartPass(pass_name);
+    } else if (thread_pool_ != nullptr) {
+      auto* pipeline = static_cast<HloPassPipeline*>(pass);
+      if (pipeline->thread_pool_ == nullptr) {
+        pipeline->set_thread_pool(thread_pool_);
+      }
     }
     TF_ASSIGN_OR_RETURN(bool pass_changed, RunHelper(pass, hlo));
     changed |= pass_changed;
@@ -81,6 +88,46 @@ StatusOr<bool> HloPassPipeline::RunPassesInternal(
   return changed;
 }
 
+StatusOr<bool> HloPassPipeline::RunInParallel(HloComputationPass* pass,
+                                              HloModule* module) {
+  std::vector<HloComputation*> computations =
+      module->MakeNonfusionComputations();
+  if (computations.size() < 2) {
+    return pass->Run(module);
+  }
+  VLOG(1) << "    Running " << pass->name() << " on " << computations.size()
+          << " computations in parallel";
+
+  // The computations only see their own instructions while the pass runs, so
+  // they can all number new instructions from the same id.
+  const int64 first_id = module->NewUniqueInstructionId();
+  for (HloComputation* computation : computations) {
+    computation->DeferInstructionUniquification(first_id);
+  }
+  std::vector<StatusOr<bool>> results(computations.size(), false);
+  tensorflow::BlockingCounter pending(computations.size());
+  for (int64 i = 0; i < computations.size(); ++i) {
+    thread_pool_->Schedule([&, i] {
+      results[i] = pass->RunOnComputation(computations[i]);
+      pending.DecrementCount();
+    });
+  }
+  pending.Wait();
+
+  // Merge the results in the order of the computations in the module, so
+  // that neither the new names and ids nor the returned error depend on the
+  // order in which the computations were processed.
+  bool changed = false;
+  for (HloComputation* computation : computations) {
+    computation->UniquifyDeferredInstructions();
+  }
+  for (const StatusOr<bool>& result : results) {
+    TF_RETURN_IF_ERROR(result.status());
+    changed |= result.ValueOrDie();
+  }
+  return changed;
+}
+
 std::vector<HloPassInterface*> HloPassPipeline::GetEnabledPasses(
     const DebugOptions& debug_options) {
   if (debug_options.xla_disable_all_hlo_passes()) {
@@ -166,4 +213,14 @@ StatusOr<bool> HloPassPipeline::RunOnModuleGroup(HloModuleGroup* module_group) {
       GetEnabledPasses(module_group->module(0).config().debug_options()));
 }
 
+std::unique_ptr<tensorflow::thread::ThreadPool> MaybeCreateHloPassThreadPool(
+    const DebugOptions& debug_options) {
+  if (debug_options.xla_hlo_pass_threads() < 2) {
+    return nullptr;
+  }
+  return absl::make_unique<tensorflow::thread::ThreadPool>(
+      tensorflow::Env::Default(), "xla_hlo_passes",
+      debug_options.xla_hlo_pass_threads());
+}
+
 }  // namespace xla
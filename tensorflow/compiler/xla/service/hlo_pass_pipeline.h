@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/compiler/xla/statusor.h"
 #include "tensorflow/compiler/xla/types.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 
@@ -70,6 +71,17 @@ class HloPassPipeline : public HloPassInterface {
     return *pass;
   }
 
+  // Makes the HloComputationPasses of this pipeline, and of the pipelines in
+  // it that have no thread pool of their own, run on the non-fusion
+  // computations of a module in parallel on `thread_pool`.  The names and ids
+  // of the instructions they add are assigned afterwards in the order of the
+  // computations in the module, so the result does not depend on the order
+  // in which the computations are processed.  `thread_pool` is not owned and
+  // must outlive the calls to Run.
+  void set_thread_pool(tensorflow::thread::ThreadPool* thread_pool) {
+    thread_pool_ = thread_pool;
+  }
+
   StatusOr<bool> Run(HloModule* module) override;
   StatusOr<bool> RunOnModuleGroup(HloModuleGroup* module_group) override;
 
@@ -103,8 +115,15 @@ class HloPassPipeline : public HloPassInterface {
   // Helpers which run the given passes on the given HLO construct. These
   // helpers enable templating of the core of the pipeline logic by providing
   // HloModule and HloModuleGroup specific methods with the same name.
-  static StatusOr<bool> RunHelper(HloPassInterface* pass, HloModule* module) {
-    TF_ASSIGN_OR_RETURN(bool changed, pass->Run(module));
+  StatusOr<bool> RunHelper(HloPassInterface* pass, HloModule* module) {
+    bool changed;
+    if (thread_pool_ != nullptr && pass->IsComputationPass()) {
+      TF_ASSIGN_OR_RETURN(
+          changed, RunInParallel(static_cast<HloComputationPass*>(pass),
+                                 module));
+    } else {
+      TF_ASSIGN_OR_RETURN(changed, pass->Run(module));
+    }
     module->Cleanup();
     return changed;
   }
@@ -115,10 +134,15 @@ class HloPassPipeline : public HloPassInterface {
     return changed;
   }
 
+  // Runs `pass` on the non-fusion computations of `module` in parallel on
+  // thread_pool_.
+  StatusOr<bool> RunInParallel(HloComputationPass* pass, HloModule* module);
+
   const string name_;
   std::vector<std::unique_ptr<HloPassInterface>> passes_;
   std::vector<std::unique_ptr<HloPassInterface>> invariant_checkers_;
   bool run_called_ = false;
+  tensorflow::thread::ThreadPool* thread_pool_ = nullptr;  // Not owned.
 
   CompilationStats* compilation_stats_;
   // Default stats instance for when one is not passed in the constructor.
@@ -126,6 +150,12 @@ class HloPassPipeline : public HloPassInterface {
   std::unique_ptr<CompilationStats> empty_compilation_stats_;
 };
 
+// Returns a thread pool of --xla_hlo_pass_threads threads for
+// HloPassPipeline::set_thread_pool, or nullptr if HloComputationPasses should
+// run serially.
+std::unique_ptr<tensorflow::thread::ThreadPool> MaybeCreateHloPassThreadPool(
+    const DebugOptions& debug_options);
+
 }  // namespace xla
 
 #endif  // TENSORFLOW_COMPILER_XLA_SERVICE_HLO_PASS_PIPELINE_H_
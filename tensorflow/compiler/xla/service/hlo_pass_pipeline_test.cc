@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/hlo_pass_pipeline.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "tensorflow/compiler/xla/service/hlo_computation.h"
 #include "tensorflow/compiler/xla/service/hlo_instruction.h"
 #include "tensorflow/compiler/xla/service/hlo_module.h"
@@ -22,6 +23,8 @@ limitations under the License.
 #include "tensorflow/compiler/xla/tests/hlo_test_base.h"
 #include "tensorflow/compiler/xla/util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace xla {
 namespace {
@@ -95,6 +98,19 @@ class BarBlowerUpper : public HloModulePass {
   }
 };
 
+// A computation pass which negates the root of each computation.
+class NegateRootComputationPass : public HloComputationPass {
+  absl::string_view name() const override { return "negate-root"; }
+
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override {
+    HloInstruction* root = computation->root_instruction();
+    HloInstruction* negate = computation->AddInstruction(
+        HloInstruction::CreateUnary(root->shape(), HloOpcode::kNegate, root));
+    computation->set_root_instruction(negate);
+    return true;
+  }
+};
+
 TEST_F(HloPassPipelineTest, ModulePassChanged) {
   // Test an HLO module pass which changes a module.
   const string module_str = R"(
@@ -255,5 +271,75 @@ ENTRY main {
       ::testing::HasSubstr("Module group pass cannot be run on a module"));
 }
 
+TEST_F(HloPassPipelineTest, ComputationPassInParallel) {
+  // Running a computation pass in parallel should name and number the new
+  // instructions as running it serially does.
+  const string module_str = R"(
+HloModule ComputationPassInParallel
+
+add {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT add = f32[] add(x, y)
+}
+
+mul {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT mul = f32[] multiply(x, y)
+}
+
+sub {
+  x = f32[] parameter(0)
+  y = f32[] parameter(1)
+  ROOT sub = f32[] subtract(x, y)
+}
+
+ENTRY main {
+  a = f32[] parameter(0)
+  b = f32[] parameter(1)
+  c0 = f32[] call(a, b), to_apply=add
+  c1 = f32[] call(a, b), to_apply=mul
+  c2 = f32[] call(a, b), to_apply=sub
+  t = f32[] add(c0, c1)
+  ROOT r = f32[] add(t, c2)
+}
+)";
+  auto run_pipeline = [&](tensorflow::thread::ThreadPool* thread_pool)
+      -> StatusOr<std::vector<std::pair<string, int>>> {
+    TF_ASSIGN_OR_RETURN(std::unique_ptr<VerifiedHloModule> module,
+                        ParseAndReturnVerifiedModule(module_str));
+    HloPassPipeline pipeline(TestName());
+    pipeline.set_thread_pool(thread_pool);
+    pipeline.AddPass<HloPassPipeline>("nested")
+        .AddPass<NegateRootComputationPass>();
+    TF_ASSIGN_OR_RETURN(bool changed, pipeline.Run(module.get()));
+    EXPECT_TRUE(changed);
+    std::vector<std::pair<string, int>> names_and_ids;
+    for (HloComputation* computation : module->computations()) {
+      EXPECT_EQ(computation->root_instruction()->opcode(),
+                HloOpcode::kNegate);
+      for (HloInstruction* instruction : computation->instructions()) {
+        names_and_ids.emplace_back(instruction->name(),
+                                   instruction->unique_id());
+      }
+    }
+    return names_and_ids;
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(auto serial, run_pipeline(nullptr));
+  tensorflow::thread::ThreadPool thread_pool(tensorflow::Env::Default(),
+                                             TestName(), 4);
+  TF_ASSERT_OK_AND_ASSIGN(auto parallel, run_pipeline(&thread_pool));
+  EXPECT_EQ(parallel.size(), serial.size());
+  for (int64 i = 0; i < serial.size(); ++i) {
+    EXPECT_EQ(parallel[i].first, serial[i].first);
+  }
+  absl::flat_hash_set<int> ids;
+  for (const auto& name_and_id : parallel) {
+    EXPECT_TRUE(ids.insert(name_and_id.second).second);
+  }
+}
+
 }  // namespace
 }  // namespace xla
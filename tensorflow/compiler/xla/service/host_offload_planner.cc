@@ -0,0 +1,169 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/host_offload_planner.h"
+
+#include <algorithm>
+
+#include "absl/algorithm/container.h"
+#include "tensorflow/compiler/xla/util.h"
+
+namespace xla {
+namespace {
+
+// Returns the time of the peak of `usage` and its value.
+std::pair<int64, int64> FindPeak(const std::vector<int64>& usage) {
+  auto it = std::max_element(usage.begin(), usage.end());
+  if (it == usage.end()) {
+    return {-1, 0};
+  }
+  return {it - usage.begin(), *it};
+}
+
+}  // namespace
+
+/*static*/ StatusOr<HostOffloadPlanner::Plan> HostOffloadPlanner::Run(
+    const HloLiveRange& hlo_live_range, const HloAliasAnalysis& alias_analysis,
+    const MemorySpaceAssignmentCostAnalysis& cost_analysis,
+    const Options& options) {
+  if (!options.size_fn) {
+    return InvalidArgument("HostOffloadPlanner requires a size function.");
+  }
+  const auto& instruction_schedule = hlo_live_range.instruction_schedule();
+  const int64 num_times = hlo_live_range.schedule_end_time() + 1;
+
+  // cumulative_elapsed[t] is the elapsed time of the instructions scheduled
+  // before logical time t.
+  std::vector<float> cumulative_elapsed(num_times + 1, 0.0);
+  for (const auto& instruction_and_time : instruction_schedule) {
+    if (instruction_and_time.second < num_times) {
+      cumulative_elapsed[instruction_and_time.second + 1] =
+          cost_analysis.cost_analysis().optimal_seconds(
+              *instruction_and_time.first);
+    }
+  }
+  for (int64 t = 1; t <= num_times; ++t) {
+    cumulative_elapsed[t] += cumulative_elapsed[t - 1];
+  }
+  // Elapsed time of the instructions at logical times [begin, end).
+  auto elapsed = [&](int64 begin, int64 end) {
+    return cumulative_elapsed[end] - cumulative_elapsed[begin];
+  };
+
+  std::vector<int64> usage(num_times, 0);
+  std::vector<Offload> candidates;
+  for (const HloBuffer& buffer : alias_analysis.buffers()) {
+    int64 start = num_times;
+    int64 end = -1;
+    int64 size = 0;
+    std::vector<int64> use_times;
+    for (const HloValue* value : buffer.values()) {
+      auto live_range = hlo_live_range.buffer_live_ranges().find(value);
+      if (live_range == hlo_live_range.buffer_live_ranges().end()) {
+        continue;
+      }
+      start = std::min(start, live_range->second.start);
+      end = std::max(end, live_range->second.end);
+      size = std::max(size, options.size_fn(*value));
+      use_times.push_back(live_range->second.start);
+      use_times.push_back(live_range->second.end);
+      for (const HloUse& use : value->uses()) {
+        auto use_time = instruction_schedule.find(use.instruction);
+        if (use_time != instruction_schedule.end()) {
+          use_times.push_back(use_time->second);
+        }
+      }
+    }
+    if (end < start || size == 0) {
+      continue;
+    }
+    for (int64 t = start; t <= end; ++t) {
+      usage[t] += size;
+    }
+
+    const Shape& shape = buffer.values().front()->shape();
+    if (!shape.IsArray() || size < options.min_size_in_bytes) {
+      continue;
+    }
+    const float copy_elapsed = options.min_async_copy_to_overlap_ratio *
+                               cost_analysis.GetAsyncCopyElapsed(shape);
+    absl::c_sort(use_times);
+    use_times.erase(std::unique(use_times.begin(), use_times.end()),
+                    use_times.end());
+    for (int64 i = 1; i < use_times.size(); ++i) {
+      const int64 gap_start = use_times[i - 1];
+      const int64 gap_end = use_times[i];
+      // Evict as early as possible and prefetch as late as possible, each with
+      // enough compute to hide the copy.
+      int64 eviction_end = gap_start + 1;
+      while (eviction_end < gap_end &&
+             elapsed(gap_start + 1, eviction_end + 1) < copy_elapsed) {
+        ++eviction_end;
+      }
+      int64 prefetch_start = gap_end - 1;
+      while (prefetch_start > eviction_end &&
+             elapsed(prefetch_start, gap_end) < copy_elapsed) {
+        --prefetch_start;
+      }
+      if (eviction_end + 1 < prefetch_start) {
+        candidates.push_back({&buffer, size, gap_start, eviction_end,
+                              prefetch_start, gap_end});
+      }
+    }
+  }
+
+  Plan plan;
+  plan.peak_bytes_before = FindPeak(usage).second;
+  while (true) {
+    const std::pair<int64, int64> peak = FindPeak(usage);
+    if (peak.second <= options.device_memory_budget_bytes) {
+      break;
+    }
+    auto best = candidates.end();
+    for (auto it = candidates.begin(); it != candidates.end(); ++it) {
+      if (it->eviction_end_time >= peak.first ||
+          it->prefetch_start_time <= peak.first) {
+        continue;
+      }
+      if (best == candidates.end() || it->size_in_bytes > best->size_in_bytes ||
+          (it->size_in_bytes == best->size_in_bytes &&
+           it->prefetch_start_time - it->eviction_end_time >
+               best->prefetch_start_time - best->eviction_end_time)) {
+        best = it;
+      }
+    }
+    if (best == candidates.end()) {
+      VLOG(2) << "No offload candidate for peak of " << peak.second
+              << " bytes at time " << peak.first;
+      break;
+    }
+    for (int64 t = best->eviction_end_time + 1; t < best->prefetch_start_time;
+         ++t) {
+      usage[t] -= best->size_in_bytes;
+    }
+    plan.offloads.push_back(*best);
+    candidates.erase(best);
+  }
+  plan.peak_bytes_after = FindPeak(usage).second;
+  absl::c_sort(plan.offloads, [](const Offload& a, const Offload& b) {
+    return a.eviction_start_time < b.eviction_start_time;
+  });
+  VLOG(1) << "Planned " << plan.offloads.size()
+          << " host offloads; peak device memory " << plan.peak_bytes_before
+          << " -> " << plan.peak_bytes_after << " bytes";
+  return plan;
+}
+
+}  // namespace xla
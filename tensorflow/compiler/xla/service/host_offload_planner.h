@@ -0,0 +1,95 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_XLA_SERVICE_HOST_OFFLOAD_PLANNER_H_
+#define TENSORFLOW_COMPILER_XLA_SERVICE_HOST_OFFLOAD_PLANNER_H_
+
+#include <vector>
+
+#include "tensorflow/compiler/xla/service/buffer_value.h"
+#include "tensorflow/compiler/xla/service/hlo_alias_analysis.h"
+#include "tensorflow/compiler/xla/service/hlo_buffer.h"
+#include "tensorflow/compiler/xla/service/hlo_live_range.h"
+#include "tensorflow/compiler/xla/service/memory_space_assignment.h"
+#include "tensorflow/compiler/xla/statusor.h"
+
+namespace xla {
+
+// Plans the eviction of device buffers to host memory during the intervals in
+// which they are not used, and their prefetch back before the next use. This is
+// the reverse of MemorySpaceAssignment's setup: device memory is the small and
+// fast memory, and host memory is the large one that buffers are evicted to.
+//
+// Using the module's flattened schedule (HloLiveRange) and the elapsed times of
+// MemorySpaceAssignmentCostAnalysis, where the async copy bandwidth is the
+// host<->device bandwidth, every gap between consecutive uses of a buffer
+// becomes a candidate if the eviction and the prefetch can each be overlapped
+// with enough compute. Candidates are then picked greedily, largest first,
+// among those that are off the device at the time of the current peak of
+// simulated device memory usage, until the peak fits the budget.
+class HostOffloadPlanner {
+ public:
+  struct Options {
+    // Device memory available to the buffers of the module.
+    int64 device_memory_budget_bytes = 0;
+
+    // Buffers smaller than this are never offloaded.
+    int64 min_size_in_bytes = 0;
+
+    // An eviction or a prefetch must overlap with at least this multiple of
+    // its copy time of compute.
+    float min_async_copy_to_overlap_ratio = 1.0;
+
+    // Size function for buffer values.
+    BufferValue::SizeFunction size_fn;
+  };
+
+  // One eviction of a buffer to host memory and the matching prefetch back to
+  // device memory, in logical times of the flattened schedule. The buffer is
+  // not in device memory strictly between eviction_end_time and
+  // prefetch_start_time.
+  struct Offload {
+    const HloBuffer* buffer;
+    int64 size_in_bytes;
+
+    // The eviction starts after the definition or use at eviction_start_time
+    // and is complete at eviction_end_time.
+    int64 eviction_start_time;
+    int64 eviction_end_time;
+
+    // The prefetch starts at prefetch_start_time and is complete before the
+    // use at prefetch_end_time.
+    int64 prefetch_start_time;
+    int64 prefetch_end_time;
+  };
+
+  struct Plan {
+    std::vector<Offload> offloads;
+
+    // Peak simulated device memory usage without and with the offloads.
+    int64 peak_bytes_before = 0;
+    int64 peak_bytes_after = 0;
+  };
+
+  static StatusOr<Plan> Run(
+      const HloLiveRange& hlo_live_range,
+      const HloAliasAnalysis& alias_analysis,
+      const MemorySpaceAssignmentCostAnalysis& cost_analysis,
+      const Options& options);
+};
+
+}  // namespace xla
+
+#endif  // TENSORFLOW_COMPILER_XLA_SERVICE_HOST_OFFLOAD_PLANNER_H_
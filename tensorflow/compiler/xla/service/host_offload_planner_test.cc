@@ -0,0 +1,125 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/xla/service/host_offload_planner.h"
+
+#include "tensorflow/compiler/xla/service/hlo_computation.h"
+#include "tensorflow/compiler/xla/service/hlo_cost_analysis.h"
+#include "tensorflow/compiler/xla/tests/hlo_test_base.h"
+
+namespace xla {
+namespace {
+
+constexpr int64 kPointerSize = 8;
+constexpr float kAsyncCopyBandwidth = 8192;
+constexpr float kAlternateMemBandwidth = 1000;
+constexpr float kBytesPerSecond = 100;
+constexpr float kFlopsPerSecond = 1000;
+constexpr float kTranscendentalsPerSecond = 10;
+
+int64 ShapeSize(const Shape& shape) {
+  return ShapeUtil::ByteSizeOf(shape, kPointerSize);
+}
+
+class HostOffloadPlannerTest : public HloTestBase {
+ protected:
+  HostOffloadPlanner::Plan Plan(HloModule* module, int64 budget) {
+    HloCostAnalysis hlo_cost_analysis(ShapeSize);
+    hlo_cost_analysis.set_flops_per_second(kFlopsPerSecond);
+    hlo_cost_analysis.set_bytes_per_second(kBytesPerSecond);
+    hlo_cost_analysis.set_transcendentals_per_second(kTranscendentalsPerSecond);
+    for (HloComputation* computation : module->MakeNonfusionComputations()) {
+      TF_CHECK_OK(computation->Accept(&hlo_cost_analysis));
+    }
+    alias_analysis_ = HloAliasAnalysis::Run(module).ValueOrDie();
+    hlo_live_range_ =
+        HloLiveRange::Run(module->schedule(), *alias_analysis_,
+                          module->entry_computation())
+            .ValueOrDie();
+    MemorySpaceAssignmentCostAnalysis cost_analysis(
+        hlo_cost_analysis, kAsyncCopyBandwidth, kAlternateMemBandwidth,
+        *hlo_live_range_);
+
+    HostOffloadPlanner::Options options;
+    options.device_memory_budget_bytes = budget;
+    options.size_fn = [](const BufferValue& buffer) {
+      return ShapeSize(buffer.shape());
+    };
+    return HostOffloadPlanner::Run(*hlo_live_range_, *alias_analysis_,
+                                   cost_analysis, options)
+        .ValueOrDie();
+  }
+
+  int64 TimeOf(HloModule* module, absl::string_view name) {
+    return hlo_live_range_->instruction_schedule().at(
+        module->entry_computation()->GetInstructionWithName(name));
+  }
+
+  std::unique_ptr<HloAliasAnalysis> alias_analysis_;
+  std::unique_ptr<HloLiveRange> hlo_live_range_;
+};
+
+// big1 is idle while big2 and m are live, which is the peak of the program.
+// Offloading it during that interval brings the peak down to two large
+// buffers.
+constexpr char kIdleBufferHlo[] = R"(
+HloModule module, is_scheduled=true
+
+ENTRY entry {
+  s = f32[] parameter(0)
+  p1 = f32[4] parameter(1)
+  big1 = f32[1024] broadcast(s), dimensions={}
+  a = f32[4] negate(p1)
+  b = f32[4] negate(a)
+  c = f32[4] negate(b)
+  big2 = f32[1024] broadcast(s), dimensions={}
+  m = f32[1024] multiply(big2, big2)
+  d = f32[4] negate(c)
+  e = f32[4] negate(d)
+  f = f32[4] negate(e)
+  sl = f32[4] slice(big1), slice={[0:4]}
+  ROOT t = (f32[1024], f32[4], f32[4]) tuple(m, sl, f)
+}
+)";
+
+TEST_F(HostOffloadPlannerTest, OffloadsIdleBufferAtPeak) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kIdleBufferHlo));
+  HostOffloadPlanner::Plan plan = Plan(module.get(), /*budget=*/9000);
+
+  EXPECT_GT(plan.peak_bytes_before, 3 * 4096);
+  EXPECT_LE(plan.peak_bytes_after, 9000);
+  ASSERT_EQ(plan.offloads.size(), 1);
+  const HostOffloadPlanner::Offload& offload = plan.offloads[0];
+  EXPECT_EQ(offload.buffer->values().front()->instruction()->name(), "big1");
+  EXPECT_EQ(offload.size_in_bytes, 4096);
+  EXPECT_EQ(offload.eviction_start_time, TimeOf(module.get(), "big1"));
+  EXPECT_EQ(offload.prefetch_end_time, TimeOf(module.get(), "sl"));
+  // Each copy needs two of the small negates to hide its 0.5s.
+  EXPECT_EQ(offload.eviction_end_time, TimeOf(module.get(), "b"));
+  EXPECT_EQ(offload.prefetch_start_time, TimeOf(module.get(), "e"));
+}
+
+TEST_F(HostOffloadPlannerTest, NoOffloadsWithinBudget) {
+  TF_ASSERT_OK_AND_ASSIGN(auto module,
+                          ParseAndReturnVerifiedModule(kIdleBufferHlo));
+  HostOffloadPlanner::Plan plan = Plan(module.get(), /*budget=*/1 << 20);
+
+  EXPECT_TRUE(plan.offloads.empty());
+  EXPECT_EQ(plan.peak_bytes_after, plan.peak_bytes_before);
+}
+
+}  // namespace
+}  // namespace xla
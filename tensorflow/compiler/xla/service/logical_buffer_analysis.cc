@@ -75,6 +75,18 @@ Status LogicalBufferAnalysis::Analyze() {
   return Status::OK();
 }
 
+Status LogicalBufferAnalysis::AddInstruction(HloInstruction* instruction) {
+  TF_RETURN_IF_ERROR(instruction->Visit(this));
+  if (instruction->opcode() == HloOpcode::kFusion) {
+    std::vector<HloInstruction*> fusion_instructions;
+    GatherFusionInstructions(instruction, &fusion_instructions);
+    for (auto* fusion : fusion_instructions) {
+      TF_RETURN_IF_ERROR(fusion->fused_expression_root()->Accept(this));
+    }
+  }
+  return Status::OK();
+}
+
 LogicalBuffer& LogicalBufferAnalysis::GetBuffer(LogicalBuffer::Id id) const {
   CHECK_GE(id, 0);
   CHECK_LT(id, logical_buffers_.size());
@@ -44,6 +44,11 @@ class LogicalBufferAnalysis : public DfsHloVisitorWithDefault {
   }
   LogicalBuffer::Id num_logical_buffers() const { return next_buffer_id_; }
 
+  // Creates the logical buffers defined by 'instruction', which was added to
+  // the module after the analysis was run, and by the instructions it fuses.
+  // Existing buffers keep their ids.
+  Status AddInstruction(HloInstruction* instruction);
+
  private:
   explicit LogicalBufferAnalysis(const HloModule* module) : module_(module) {}
   Status Analyze();
@@ -389,23 +389,19 @@ StatusOr<bool> TryReshapeMoveOnCandidates(
 
 }  // namespace
 
-StatusOr<bool> ReshapeMover::Run(HloModule* module) {
-  bool changed = false;
+StatusOr<bool> ReshapeMover::RunOnComputation(HloComputation* comp) {
   VLOG(2) << "Pre ReshapeMover HLO:";
-  XLA_VLOG_LINES(2, module->ToString());
-  for (auto* comp : module->MakeNonfusionComputations()) {
-    HloInstructionSet reshape_candidates;
-    for (HloInstruction* instruction : comp->instructions()) {
-      if (IsReshapeMoveCandidate(instruction)) {
-        reshape_candidates.insert(instruction);
-      }
+  XLA_VLOG_LINES(2, comp->ToString());
+  HloInstructionSet reshape_candidates;
+  for (HloInstruction* instruction : comp->instructions()) {
+    if (IsReshapeMoveCandidate(instruction)) {
+      reshape_candidates.insert(instruction);
     }
-    TF_ASSIGN_OR_RETURN(bool did_change,
-                        TryReshapeMoveOnCandidates(&reshape_candidates));
-    changed |= did_change;
   }
+  TF_ASSIGN_OR_RETURN(bool changed,
+                      TryReshapeMoveOnCandidates(&reshape_candidates));
   VLOG(2) << "Post ReshapeMover HLO:";
-  XLA_VLOG_LINES(2, module->ToString());
+  XLA_VLOG_LINES(2, comp->ToString());
   return changed;
 }
 
@@ -24,11 +24,11 @@ namespace xla {
 // This now only moves them outputward across elementwise ops all whose operands
 // are equivalent Reshapes or Transposes, but in future could potentially move
 // them inputward also.
-class ReshapeMover : public HloModulePass {
+class ReshapeMover : public HloComputationPass {
  public:
   absl::string_view name() const override { return "reshape-mover"; }
 
-  StatusOr<bool> Run(HloModule* module) override;
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override;
 };
 
 }  // namespace xla
@@ -192,7 +192,7 @@ TransposeFolding::TransposeFolding(
     : transposable_gemm_operands_(std::move(transposable_gemm_operands)),
       transposable_conv_operands_(std::move(transposable_conv_operands)) {}
 
-StatusOr<bool> TransposeFolding::Run(HloModule* module) {
+StatusOr<bool> TransposeFolding::RunOnComputation(HloComputation* comp) {
   // Modifying the graph while traversing is dangerous, so we find all folding
   // opportunities before actually folding them.
   std::vector<std::pair<HloInstruction*, OperandIndices>> foldable_dots;
@@ -217,9 +217,7 @@ StatusOr<bool> TransposeFolding::Run(HloModule* module) {
     return Status::OK();
   });
 
-  for (auto* comp : module->MakeNonfusionComputations()) {
-    TF_RETURN_IF_ERROR(comp->Accept(&visit_fn));
-  }
+  TF_RETURN_IF_ERROR(comp->Accept(&visit_fn));
 
   bool changed = false;
   for (InstructionOperandsPair& pair : foldable_dots) {
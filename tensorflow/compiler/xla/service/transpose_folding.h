@@ -23,7 +23,7 @@ namespace xla {
 
 // HLO pass that folds transpose operators into Dot operators, where the Dot
 // operator is implemented by a GEMM kernel that can transpose its inputs.
-class TransposeFolding : public HloModulePass {
+class TransposeFolding : public HloComputationPass {
  public:
   using OperandIndices = std::vector<int64>;
 
@@ -60,7 +60,7 @@ class TransposeFolding : public HloModulePass {
           AlwaysFoldTranspose);
   absl::string_view name() const override { return "transpose-folding"; }
 
-  StatusOr<bool> Run(HloModule* module) override;
+  StatusOr<bool> RunOnComputation(HloComputation* computation) override;
 
  private:
   TransposableGemmOperandsFn transposable_gemm_operands_;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/compiler/xla/service/tuple_points_to_analysis.h"
 
+#include <algorithm>
 #include <ostream>
 #include <utility>
 #include <vector>
@@ -175,6 +176,111 @@ Status TuplePointsToAnalysis::Analyze() {
   return Status::OK();
 }
 
+Status TuplePointsToAnalysis::UpdateInstructions(
+    absl::Span<HloInstruction* const> instructions) {
+  // The points-to set of an instruction only depends on those of its operands,
+  // so only the changed instructions and their transitive users are affected.
+  // New instructions get their buffers first so that the points-to sets of
+  // their users can refer to them.
+  absl::flat_hash_set<HloInstruction*> affected;
+  std::vector<HloInstruction*> new_fusions;
+  std::vector<HloInstruction*> worklist(instructions.begin(),
+                                        instructions.end());
+  while (!worklist.empty()) {
+    HloInstruction* instruction = worklist.back();
+    worklist.pop_back();
+    if (!affected.insert(instruction).second) {
+      continue;
+    }
+    if (!per_instruction_.contains(instruction->unique_id())) {
+      TF_RETURN_IF_ERROR(logical_buffer_analysis_->AddInstruction(instruction));
+      if (instruction->opcode() == HloOpcode::kFusion) {
+        new_fusions.push_back(instruction);
+      }
+    }
+    for (HloInstruction* user : instruction->users()) {
+      worklist.push_back(user);
+    }
+  }
+  logical_buffer_aliases_.resize(
+      logical_buffer_analysis_->num_logical_buffers());
+
+  // Reanalyze the affected instructions in post order, restricted to the
+  // affected set: operands outside of it are already up to date.
+  absl::flat_hash_set<HloInstruction*> visited;
+  std::vector<std::pair<HloInstruction*, bool>> stack;
+  for (HloInstruction* root : affected) {
+    stack.emplace_back(root, false);
+    while (!stack.empty()) {
+      HloInstruction* instruction = stack.back().first;
+      const bool operands_done = stack.back().second;
+      stack.pop_back();
+      if (operands_done) {
+        TF_RETURN_IF_ERROR(ReanalyzeInstruction(instruction));
+        continue;
+      }
+      if (!visited.insert(instruction).second) {
+        continue;
+      }
+      stack.emplace_back(instruction, true);
+      for (HloInstruction* operand : instruction->operands()) {
+        if (affected.contains(operand) && !visited.contains(operand)) {
+          stack.emplace_back(operand, false);
+        }
+      }
+    }
+  }
+
+  // The instructions fused into new fusion instructions are analyzed like in
+  // Analyze().
+  std::vector<HloInstruction*> fusion_instructions;
+  for (HloInstruction* fusion : new_fusions) {
+    GatherFusionInstructions(fusion, &fusion_instructions);
+  }
+  for (auto* instruction : fusion_instructions) {
+    TF_RETURN_IF_ERROR(instruction->fused_expression_root()->Accept(this));
+    TF_RETURN_IF_ERROR(
+        PopulateDefinedBuffersAndAliases(instruction->fused_instructions()));
+  }
+
+  XLA_VLOG_LINES(3, ToString());
+
+  return Status::OK();
+}
+
+Status TuplePointsToAnalysis::ReanalyzeInstruction(
+    HloInstruction* instruction) {
+  PerInstruction* pi = PerInst(instruction);
+  if (pi->points_to_set != nullptr) {
+    pi->points_to_set->ForEachElement(
+        [this, instruction](const ShapeIndex& index,
+                            const PointsToSet::BufferList& pointed_to_buffers) {
+          for (const LogicalBuffer* buffer : pointed_to_buffers) {
+            BufferAliasVector& aliases = logical_buffer_aliases_[buffer->id()];
+            aliases.erase(std::remove(aliases.begin(), aliases.end(),
+                                      BufferAlias(instruction, index)),
+                          aliases.end());
+          }
+        });
+    pi->points_to_set = nullptr;
+  }
+  TF_RETURN_IF_ERROR(instruction->Visit(this));
+
+  pi->instruction_defined_buffers.clear();
+  TF_RETURN_IF_ERROR(GatherBuffersDefinedByInstruction(
+      instruction, &pi->instruction_defined_buffers));
+  GetPointsToSet(instruction)
+      .ForEachElement([this, instruction](
+                          const ShapeIndex& index,
+                          const PointsToSet::BufferList& pointed_to_buffers) {
+        for (const LogicalBuffer* buffer : pointed_to_buffers) {
+          logical_buffer_aliases_[buffer->id()].emplace_back(instruction,
+                                                             index);
+        }
+      });
+  return Status::OK();
+}
+
 Status TuplePointsToAnalysis::PopulateDefinedBuffersAndAliases(const decltype(
     std::declval<HloComputation>().instructions())& instructions) {
   for (auto* instruction : instructions) {
@@ -187,6 +187,19 @@ class TuplePointsToAnalysis : public DfsHloVisitorWithDefault {
   static StatusOr<std::unique_ptr<TuplePointsToAnalysis>> Run(
       const HloModule* module);
 
+  // Updates the analysis after the module was mutated by adding the given
+  // instructions or by changing their operands, e.g. with
+  // HloInstruction::ReplaceOperandWith, or with ReplaceAllUsesWith in which
+  // case the changed instructions are the users. New instructions get new
+  // logical buffers, and only the points-to sets of the given instructions and
+  // of their transitive users are recomputed, which is much cheaper than
+  // rerunning the analysis after small mutations of a large module.
+  //
+  // New instructions must either be given or be transitive users of given
+  // instructions. Instructions which were analyzed must not have been removed
+  // from the module; rerun the analysis after dead code elimination.
+  Status UpdateInstructions(absl::Span<HloInstruction* const> instructions);
+
   // Return the points-to set of an instruction. This describes the potential
   // sources of each buffer in the instruction's output.
   const PointsToSet& GetPointsToSet(
@@ -278,6 +291,10 @@ class TuplePointsToAnalysis : public DfsHloVisitorWithDefault {
   // object and before calling GetPointsToSet.
   Status Analyze();
 
+  // Recomputes the points-to set, defined buffers and aliases of
+  // 'instruction', whose operands must be up to date.
+  Status ReanalyzeInstruction(HloInstruction* instruction);
+
   // Populates instruction-defined buffers and aliases for each instruction
   // in 'instructions'.
   Status PopulateDefinedBuffersAndAliases(const decltype(
@@ -301,6 +301,46 @@ TEST_F(TuplePointsToAnalysisTest, DuplicatedElement) {
       {constant, tuple});
 }
 
+TEST_F(TuplePointsToAnalysisTest, UpdateInstructionsAfterReplacingOperand) {
+  // Replace the first element of a tuple with a copy of it and incrementally
+  // update the analysis. The copy's buffer should flow through the tuple to
+  // the GetTupleElement, and the constant should no longer be aliased by the
+  // tuple.
+  auto builder = HloComputation::Builder(TestName());
+  auto constant1 = builder.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR0<float>(1.0)));
+  auto constant2 = builder.AddInstruction(
+      HloInstruction::CreateConstant(LiteralUtil::CreateR0<float>(2.0)));
+  auto tuple = builder.AddInstruction(
+      HloInstruction::CreateTuple({constant1, constant2}));
+  auto get_tuple_element = builder.AddInstruction(
+      HloInstruction::CreateGetTupleElement(constant1->shape(), tuple, 0));
+
+  BuildModuleAndRunAnalysis(builder.Build());
+  ExpectHasTopLevelBuffers(
+      points_to_analysis_->GetPointsToSet(get_tuple_element).element({}),
+      {constant1});
+
+  HloInstruction* copy =
+      module_->entry_computation()->AddInstruction(HloInstruction::CreateUnary(
+          constant1->shape(), HloOpcode::kCopy, constant1));
+  TF_ASSERT_OK(tuple->ReplaceOperandWith(0, copy));
+  TF_ASSERT_OK(points_to_analysis_->UpdateInstructions({copy}));
+
+  ExpectHasTopLevelBuffers(points_to_analysis_->GetPointsToSet(copy).element({}),
+                           {copy});
+  ExpectHasTopLevelBuffers(
+      points_to_analysis_->GetPointsToSet(tuple).element({0}), {copy});
+  ExpectHasTopLevelBuffers(
+      points_to_analysis_->GetPointsToSet(get_tuple_element).element({}),
+      {copy});
+  ExpectHasBufferAliases(constant1, {}, {{constant1, {}}});
+  ExpectHasBufferAliases(
+      copy, {}, {{copy, {}}, {tuple, {0}}, {get_tuple_element, {}}});
+  ExpectHasBufferAliases(constant2, {}, {{constant2, {}}, {tuple, {1}}});
+  ExpectHasBufferAliases(tuple, {}, {{tuple, {}}});
+}
+
 TEST_F(TuplePointsToAnalysisTest, TupleCopy) {
   // Create a copy (HloOpcode::kCopy) of a tuple. The points to sets should be
   // the same.
@@ -98,15 +98,38 @@ class XRTMemoryManager::DeviceContext {
     allocs_.clear();
   }
 
+  // Compacts the least recently used allocations which together hold at least
+  // 1/2^fraction_shift of the device memory used by this context, by swapping
+  // them out and back in. With fraction_shift=0 all the allocations are
+  // compacted.
   Status CompactAllocations(XRTMemoryManager* memory_manager,
-                            xla::Backend* backend) {
+                            xla::Backend* backend, int fraction_shift) {
     profiler::TraceMe trace_me("XRTMemoryManager::CompactAllocations",
                                /*level=*/2);
     auto timed = monitoring::MakeTimed(xrt_metrics::GetMemoryCompactCell());
-    VLOG(4) << "CompactAllocations started";
-    mutex_lock lock(lock_);
+    VLOG(4) << "CompactAllocations started: fraction_shift=" << fraction_shift;
+    // The swaps run outside of lock_, as swapping in allocates device memory,
+    // which might call back into TryFreeMemory(), and so that handles can be
+    // registered and looked up meanwhile. The references taken here keep the
+    // tuples alive even if their handles get released.
+    std::vector<RefPtr<XRTTupleAllocation>> tuples;
+    {
+      mutex_lock lock(lock_);
+      size_t total_size = 0;
+      for (auto& alloc : allocs_) {
+        total_size += alloc.tuple->GetDeviceMemorySize();
+      }
+      const size_t compact_size = total_size >> fraction_shift;
+      size_t size = 0;
+      for (auto it = allocs_.rbegin();
+           it != allocs_.rend() && (fraction_shift == 0 || size < compact_size);
+           ++it) {
+        tuples.push_back(it->tuple);
+        size += it->tuple->GetDeviceMemorySize();
+      }
+    }
     Status status;
-    std::vector<AllocList::iterator> swapped;
+    std::vector<XRTTupleAllocation*> swapped;
     // We are swapping out from the most recently used allocations. This is
     // desirable since the most recently used will be finding themselves at the
     // bottom of the allocation space. Since these are more likely to be pinned
@@ -116,27 +139,27 @@ class XRTMemoryManager::DeviceContext {
     // Also, by swapping out the pinned allocations first, those will also be
     // the first to be restored, and hence if we will ever find OOM on the way
     // out, we would more likely be swapping in not pinned ones.
-    for (auto it = allocs_.begin(); it != allocs_.end(); ++it) {
-      // We are compacting all the allocations, so we will temporarily swap out
+    for (auto it = tuples.rbegin(); it != tuples.rend(); ++it) {
+      // We are compacting the allocations, so we will temporarily swap out
       // even pinned allocations.
-      auto swap_result_or = it->tuple->SwapOut(backend, /*swap_pinned=*/true);
+      auto swap_result_or = (*it)->SwapOut(backend, /*swap_pinned=*/true);
       if (!swap_result_or.ok()) {
         status = swap_result_or.status();
         break;
       }
       if (swap_result_or.ValueOrDie()) {
-        swapped.push_back(it);
+        swapped.push_back(it->get());
       }
     }
     // At this point we have released all the device memory we could release.
     // Load back the tuple allocations we have swapped out above.
-    for (auto& it : swapped) {
-      auto swap_result_or = it->tuple->SwapIn(memory_manager, backend);
+    for (XRTTupleAllocation* tuple : swapped) {
+      auto swap_result_or = tuple->SwapIn(memory_manager, backend);
       if (!swap_result_or.ok()) {
         // If we failed to restored a pinned allocation, better to CHECK here
         // than wondering why XRTTupleAllocation calls fail with errors about
         // missing buffers.
-        CHECK(!it->tuple->IsPinned());  // Crash OK
+        CHECK(!tuple->IsPinned());  // Crash OK
         if (status.ok()) {
           status = swap_result_or.status();
         }
@@ -251,7 +274,8 @@ Status XRTMemoryManager::CompactAllocations(xla::Backend* backend,
   DeviceContext* device_context = GetDeviceContext(device_ordinal,
                                                    /*create_if_missing=*/false);
   return device_context != nullptr
-             ? device_context->CompactAllocations(this, backend)
+             ? device_context->CompactAllocations(this, backend,
+                                                  /*fraction_shift=*/0)
              : Status::OK();
 }
 
@@ -349,9 +373,14 @@ Status XRTMemoryManager::TryFreeMemoryStep(MemoryReclaimContext* mrctx,
     }
     mrctx->done_freeing = true;
   }
-  if (!mrctx->done_compacting) {
-    mrctx->done_compacting = true;
-    if (device_context->CompactAllocations(this, mrctx->backend).ok()) {
+  // Compact a growing share of the least recently used allocations, as
+  // compacting part of the device memory often makes room for the request
+  // without moving every allocation through host memory.
+  while (mrctx->compact_fraction_shift >= 0) {
+    const int fraction_shift = mrctx->compact_fraction_shift--;
+    if (device_context
+            ->CompactAllocations(this, mrctx->backend, fraction_shift)
+            .ok()) {
       return Status::OK();
     }
   }
@@ -139,7 +139,10 @@ class XRTMemoryManager : public ResourceBase {
     const size_t requested_free_size = 0;
     size_t free_size = 0;
     bool done_freeing = false;
-    bool done_compacting = false;
+    // The next compaction covers the least recently used allocations holding
+    // 1/2^compact_fraction_shift of the device memory, or all the allocations
+    // when zero. Compaction is done once the shift turns negative.
+    int compact_fraction_shift = 2;
   };
 
   DeviceContext* GetDeviceContext(int device_ordinal, bool create_if_missing);
@@ -189,6 +189,10 @@ CollectiveAdapter* MakeCollectiveAdapter(Tensor* output, int num_chunks,
       return new CollectiveAdapterImpl<Eigen::half>(output, num_chunks,
                                                     allocator, align_chunks);
       break;
+    case DT_BFLOAT16:
+      return new CollectiveAdapterImpl<bfloat16>(output, num_chunks, allocator,
+                                                 align_chunks);
+      break;
     case DT_FLOAT:
       return new CollectiveAdapterImpl<float>(output, num_chunks, allocator,
                                               align_chunks);
@@ -19,10 +19,13 @@ limitations under the License.
 
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/bits.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -32,9 +35,24 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 #include "tensorflow/core/protobuf/bfc_memory_map.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Returns a small per-thread index used to pick a chunk cache shard.
+int ThreadChunkCacheIndex() {
+  static std::atomic<int> next_index{0};
+  static thread_local int index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+}  // namespace
+
+constexpr int BFCAllocator::kNumCachedChunkIndexShards;
+
 BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
                            bool allow_growth, const string& name,
                            bool garbage_collection)
@@ -73,6 +91,45 @@ BFCAllocator::BFCAllocator(SubAllocator* sub_allocator, size_t total_memory,
       CHECK_NE(BinForSize(bin_size * 2), BinFromIndex(b));
     }
   }
+
+  int64 chunk_cache_max_bytes = 0;
+  Status s = ReadInt64FromEnvVar("TF_BFC_ALLOCATOR_CHUNK_CACHE_BYTES", 0,
+                                 &chunk_cache_max_bytes);
+  if (!s.ok()) {
+    LOG(ERROR) << "Invalid TF_BFC_ALLOCATOR_CHUNK_CACHE_BYTES: " << s;
+  } else if (chunk_cache_max_bytes > 0) {
+    // Keep at most 64 maximum-sized chunks per shard, and never let the
+    // combined capacity of all shards exceed 1/16 of the memory limit.
+    static constexpr size_t kMaxChunksPerShard = 64;
+    chunk_cache_max_bytes_ =
+        RoundedBytes(static_cast<size_t>(chunk_cache_max_bytes));
+    num_chunk_cache_shards_ = std::max(1, port::MaxParallelism());
+    chunk_cache_shard_capacity_ =
+        std::min(kMaxChunksPerShard * chunk_cache_max_bytes_,
+                 memory_limit_ / 16 / num_chunk_cache_shards_);
+    const size_t num_size_classes =
+        ChunkCacheSizeClass(chunk_cache_max_bytes_) + 1;
+    chunk_cache_shards_.reset(new ChunkCacheShard[num_chunk_cache_shards_]);
+    for (int i = 0; i < num_chunk_cache_shards_; ++i) {
+      mutex_lock l(chunk_cache_shards_[i].mu);
+      chunk_cache_shards_[i].free_chunks.resize(num_size_classes);
+    }
+    cached_chunk_index_.reset(
+        new CachedChunkIndexShard[kNumCachedChunkIndexShards]);
+    VLOG(1) << "Enabling chunk cache for " << Name() << " for allocations up to "
+            << strings::HumanReadableNumBytes(chunk_cache_max_bytes_);
+  }
+
+  if (sub_allocator_->SupportsCoalescing()) {
+    int64 trim_interval_secs = 0;
+    s = ReadInt64FromEnvVar("TF_BFC_ALLOCATOR_TRIM_INTERVAL_SECS", 10,
+                            &trim_interval_secs);
+    if (!s.ok()) {
+      LOG(ERROR) << "Invalid TF_BFC_ALLOCATOR_TRIM_INTERVAL_SECS: " << s;
+    } else if (trim_interval_secs > 0) {
+      trim_interval_us_ = trim_interval_secs * 1000000;
+    }
+  }
 }
 
 BFCAllocator::~BFCAllocator() {
@@ -155,7 +212,14 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   VLOG(1) << "Allocated memory at " << mem_addr << " to "
           << static_cast<void*>(static_cast<char*>(mem_addr) + bytes);
-  region_manager_.AddAllocationRegion(mem_addr, bytes);
+  AllocationRegion* extended_region = nullptr;
+  if (sub_allocator_->SupportsCoalescing()) {
+    sub_allocations_[mem_addr] = bytes;
+    extended_region =
+        region_manager_.AddOrExtendAllocationRegion(mem_addr, bytes);
+  } else {
+    region_manager_.AddAllocationRegion(mem_addr, bytes);
+  }
 
   // Create one large chunk for the whole memory space that will
   // be chunked later.
@@ -170,8 +234,22 @@ bool BFCAllocator::Extend(size_t alignment, size_t rounded_bytes) {
 
   region_manager_.set_handle(c->ptr, h);
 
-  // Insert the chunk into the right bin.
-  InsertFreeChunkIntoBin(h);
+  if (extended_region != nullptr) {
+    // Link the new chunk after the last chunk of the region it extends, and
+    // merge it with that chunk if it is free.
+    ChunkHandle prev = extended_region->get_handle(extended_region->ptr());
+    Chunk* prev_chunk = ChunkFromHandle(prev);
+    while (prev_chunk->next != kInvalidChunkHandle) {
+      prev = prev_chunk->next;
+      prev_chunk = ChunkFromHandle(prev);
+    }
+    c->prev = prev;
+    prev_chunk->next = h;
+    InsertFreeChunkIntoBin(TryToCoalesce(h, /*ignore_freed_at=*/false));
+  } else {
+    // Insert the chunk into the right bin.
+    InsertFreeChunkIntoBin(h);
+  }
 
   return true;
 }
@@ -217,6 +295,9 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
           if (allocation_attr.freed_by_func != nullptr) {
             freed_by_count = (*allocation_attr.freed_by_func)();
           }
+          // Cached chunks are not usable by this allocation; give them back
+          // to the bins before waiting for other deallocations.
+          FlushChunkCaches();
           return AllocateRawInternal(a, nb, v, freed_by_count);
         },
         kMaxMillisToWait, unused_alignment, num_bytes);
@@ -227,6 +308,29 @@ void* BFCAllocator::AllocateRawInternalWithRetry(
 void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
                                 const AllocationAttributes& allocation_attr) {
   VLOG(1) << "AllocateRaw " << Name() << "  " << num_bytes;
+  // Timestamped allocations need the freed-at ordering maintained by the
+  // bins, so they never go through the chunk cache.
+  const bool use_chunk_cache =
+      chunk_cache_max_bytes_ > 0 && num_bytes > 0 &&
+      num_bytes <= chunk_cache_max_bytes_ && timing_counter_ == nullptr &&
+      allocation_attr.freed_by_func == nullptr;
+  if (use_chunk_cache) {
+    const size_t rounded_bytes = RoundedBytes(num_bytes);
+    void* ptr = AllocateFromChunkCache(rounded_bytes, num_bytes);
+    if (ptr == nullptr) {
+      ptr = AllocateRawUncached(unused_alignment, num_bytes, allocation_attr);
+      if (ptr != nullptr) {
+        RegisterCachedChunk(ptr, rounded_bytes, num_bytes);
+      }
+    }
+    return ptr;
+  }
+  return AllocateRawUncached(unused_alignment, num_bytes, allocation_attr);
+}
+
+void* BFCAllocator::AllocateRawUncached(
+    size_t unused_alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
   if (allocation_attr.no_retry_on_failure) {
     // Return immediately upon the first failure if this is for allocating an
     // optional scratch space.
@@ -237,6 +341,10 @@ void* BFCAllocator::AllocateRaw(size_t unused_alignment, size_t num_bytes,
     }
     void* result = AllocateRawInternal(unused_alignment, num_bytes,
                                        dump_log_on_failure, freed_by_count);
+    if (result == nullptr && FlushChunkCaches()) {
+      result = AllocateRawInternal(unused_alignment, num_bytes,
+                                   dump_log_on_failure, freed_by_count);
+    }
     if (result == nullptr) {
       static std::atomic<int32> log_counter{0};
       int32 counter_value = log_counter.load(std::memory_order_relaxed);
@@ -355,6 +463,8 @@ void BFCAllocator::DeallocateRegions(
     // Deallocate the memory.
     sub_allocator_->Free(it->ptr(), it->memory_size());
     total_region_allocated_bytes_ -= it->memory_size();
+    sub_allocations_.erase(sub_allocations_.lower_bound(it->ptr()),
+                           sub_allocations_.lower_bound(it->end_ptr()));
     it = region_manager_.RemoveAllocationRegion(it);
   }
 }
@@ -463,6 +573,10 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
                             ",allocation_bytes=", chunk->size,
                             ",addr=", reinterpret_cast<uint64>(chunk_ptr),
                             ",tf_op=", pending_op_name, ",id=", pending_step_id,
+                            pending_shape == nullptr
+                                ? ""
+                                : absl::StrCat(",shape=",
+                                               pending_shape->DebugString()),
                             "#");
       },
       traceme_level);
@@ -487,6 +601,9 @@ void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
         // We found an existing chunk that fits us that wasn't in use, so remove
         // it from the free bin structure prior to using.
         RemoveFreeChunkIterFromBin(&b->free_chunks, citer);
+        if (chunk->next == kInvalidChunkHandle) {
+          ++num_tail_allocations_;
+        }
 
         // If we can break the size of the chunk into two reasonably large
         // pieces, do so.  In any case don't waste more than
@@ -585,10 +702,119 @@ void BFCAllocator::SplitChunk(BFCAllocator::ChunkHandle h, size_t num_bytes) {
 void BFCAllocator::DeallocateRaw(void* ptr) {
   VLOG(1) << "DeallocateRaw " << Name() << " "
           << (ptr ? RequestedSize(ptr) : 0);
-  DeallocateRawInternal(ptr);
+  if (ptr == nullptr || chunk_cache_max_bytes_ == 0 ||
+      !DeallocateToChunkCache(ptr)) {
+    DeallocateRawInternal(ptr);
+  }
   retry_helper_.NotifyDealloc();
 }
 
+BFCAllocator::ChunkCacheShard* BFCAllocator::CurrentChunkCacheShard() {
+  return &chunk_cache_shards_[ThreadChunkCacheIndex() %
+                              num_chunk_cache_shards_];
+}
+
+BFCAllocator::CachedChunkIndexShard* BFCAllocator::CachedChunkIndexShardFor(
+    const void* ptr) const {
+  // Chunks are at least kMinAllocationSize-aligned, so drop the low bits
+  // before hashing.
+  const uint64 key = reinterpret_cast<uintptr_t>(ptr) >> kMinAllocationBits;
+  return &cached_chunk_index_[(key * 0x9E3779B97F4A7C15ull) >> 58];
+}
+
+void* BFCAllocator::AllocateFromChunkCache(size_t rounded_bytes,
+                                           size_t num_bytes) {
+  const size_t size_class = ChunkCacheSizeClass(rounded_bytes);
+  ChunkCacheShard* shard = CurrentChunkCacheShard();
+  CachedChunk chunk;
+  {
+    mutex_lock l(shard->mu);
+    std::vector<CachedChunk>& free_chunks = shard->free_chunks[size_class];
+    if (free_chunks.empty()) {
+      chunk_cache_misses_.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    chunk = free_chunks.back();
+    free_chunks.pop_back();
+    shard->cached_bytes -= chunk.chunk_bytes;
+  }
+  chunk_cache_bytes_.fetch_sub(chunk.chunk_bytes, std::memory_order_relaxed);
+  chunk_cache_hits_.fetch_add(1, std::memory_order_relaxed);
+  CachedChunkIndexShard* index = CachedChunkIndexShardFor(chunk.ptr);
+  {
+    mutex_lock l(index->mu);
+    index->chunks[chunk.ptr].requested_size = num_bytes;
+  }
+  return chunk.ptr;
+}
+
+void BFCAllocator::RegisterCachedChunk(void* ptr, size_t rounded_bytes,
+                                       size_t num_bytes) {
+  const size_t chunk_bytes = AllocatedSize(ptr);
+  CachedChunkIndexShard* index = CachedChunkIndexShardFor(ptr);
+  mutex_lock l(index->mu);
+  index->chunks[ptr] = CachedChunkInfo{ChunkCacheSizeClass(rounded_bytes),
+                                       chunk_bytes, num_bytes};
+}
+
+bool BFCAllocator::DeallocateToChunkCache(void* ptr) {
+  CachedChunkIndexShard* index = CachedChunkIndexShardFor(ptr);
+  CachedChunkInfo info;
+  {
+    mutex_lock l(index->mu);
+    auto it = index->chunks.find(ptr);
+    if (it == index->chunks.end()) return false;
+    info = it->second;
+  }
+  ChunkCacheShard* shard = CurrentChunkCacheShard();
+  {
+    mutex_lock l(shard->mu);
+    if (shard->cached_bytes + info.chunk_bytes <= chunk_cache_shard_capacity_) {
+      shard->free_chunks[info.size_class].push_back(
+          CachedChunk{ptr, info.chunk_bytes});
+      shard->cached_bytes += info.chunk_bytes;
+      chunk_cache_bytes_.fetch_add(info.chunk_bytes,
+                                   std::memory_order_relaxed);
+      return true;
+    }
+  }
+  // The shard is full: hand the chunk back to the bins.
+  {
+    mutex_lock l(index->mu);
+    index->chunks.erase(ptr);
+  }
+  DeallocateRawInternal(ptr);
+  return true;
+}
+
+bool BFCAllocator::FlushChunkCaches() {
+  if (chunk_cache_max_bytes_ == 0) return false;
+  std::vector<CachedChunk> flushed;
+  for (int i = 0; i < num_chunk_cache_shards_; ++i) {
+    ChunkCacheShard* shard = &chunk_cache_shards_[i];
+    mutex_lock l(shard->mu);
+    for (std::vector<CachedChunk>& free_chunks : shard->free_chunks) {
+      flushed.insert(flushed.end(), free_chunks.begin(), free_chunks.end());
+      free_chunks.clear();
+    }
+    shard->cached_bytes = 0;
+  }
+  for (const CachedChunk& chunk : flushed) {
+    CachedChunkIndexShard* index = CachedChunkIndexShardFor(chunk.ptr);
+    {
+      mutex_lock l(index->mu);
+      index->chunks.erase(chunk.ptr);
+    }
+    chunk_cache_bytes_.fetch_sub(chunk.chunk_bytes, std::memory_order_relaxed);
+    DeallocateRawInternal(chunk.ptr);
+  }
+  if (!flushed.empty()) {
+    VLOG(2) << "Flushed " << flushed.size() << " cached chunks from "
+            << Name();
+  }
+  return !flushed.empty();
+}
+
 void BFCAllocator::DeallocateRawInternal(void* ptr) {
   if (ptr == nullptr) {
     VLOG(2) << "tried to deallocate nullptr";
@@ -613,11 +839,90 @@ void BFCAllocator::DeallocateRawInternal(void* ptr) {
     InsertFreeChunkIntoBin(TryToCoalesce(h, false));
   }
 
+  if (trim_interval_us_ > 0) {
+    MaybeTrimIdleMemory();
+  }
+
   if (VLOG_IS_ON(4)) {
     LOG(INFO) << "F: " << RenderOccupancy();
   }
 }
 
+void BFCAllocator::MaybeTrimIdleMemory() {
+  const uint64 now_us = Env::Default()->NowMicros();
+  if (now_us < next_trim_check_us_) return;
+  next_trim_check_us_ = now_us + trim_interval_us_;
+  if (num_tail_allocations_ != num_tail_allocations_at_check_) {
+    num_tail_allocations_at_check_ = num_tail_allocations_;
+    return;
+  }
+
+  std::vector<ChunkHandle> free_tail_chunks;
+  for (const AllocationRegion& region : region_manager_.regions()) {
+    ChunkHandle h = region_manager_.get_handle(region.ptr());
+    while (ChunkFromHandle(h)->next != kInvalidChunkHandle) {
+      h = ChunkFromHandle(h)->next;
+    }
+    if (!ChunkFromHandle(h)->in_use()) {
+      free_tail_chunks.push_back(h);
+    }
+  }
+  size_t trimmed_bytes = 0;
+  for (ChunkHandle h : free_tail_chunks) {
+    trimmed_bytes += TrimFreeTailChunk(h);
+  }
+  if (trimmed_bytes > 0) {
+    VLOG(1) << "Gave " << strings::HumanReadableNumBytes(trimmed_bytes)
+            << " of idle memory back from " << Name() << ", "
+            << strings::HumanReadableNumBytes(total_region_allocated_bytes_)
+            << " remain allocated";
+  }
+}
+
+size_t BFCAllocator::TrimFreeTailChunk(ChunkHandle h) {
+  Chunk* c = ChunkFromHandle(h);
+  DCHECK(!c->in_use());
+  DCHECK_EQ(c->next, kInvalidChunkHandle);
+  // Only the sub-allocations that start within the chunk can be freed, as the
+  // one before it is still partly in use.
+  void* const chunk_end = static_cast<char*>(c->ptr) + c->size;
+  const auto first = sub_allocations_.lower_bound(c->ptr);
+  const auto last = sub_allocations_.lower_bound(chunk_end);
+  if (first == last) return 0;
+  void* const ptr = first->first;
+  const size_t bytes = static_cast<char*>(chunk_end) - static_cast<char*>(ptr);
+
+  RemoveFreeChunkFromBin(h);
+  if (ptr == c->ptr) {
+    const ChunkHandle prev = c->prev;
+    DeleteChunk(h);
+    if (prev != kInvalidChunkHandle) {
+      ChunkFromHandle(prev)->next = kInvalidChunkHandle;
+    }
+  } else {
+    c->size -= bytes;
+    InsertFreeChunkIntoBin(h);
+  }
+
+  // Explicitly remove the const qualifier, as in DeallocateRegions().
+  auto regions =
+      const_cast<std::vector<AllocationRegion>*>(&region_manager_.regions());
+  for (auto region = regions->begin(); region != regions->end(); ++region) {
+    if (region->end_ptr() != chunk_end) continue;
+    if (region->ptr() == ptr) {
+      region_manager_.RemoveAllocationRegion(region);
+    } else {
+      region->shrink(bytes);
+    }
+    break;
+  }
+
+  sub_allocator_->Free(ptr, bytes);
+  total_region_allocated_bytes_ -= bytes;
+  sub_allocations_.erase(first, last);
+  return bytes;
+}
+
 // Merges h1 and h2 when Chunk(h1)->next is h2 and Chunk(h2)->prev is c1.
 // We merge Chunk(h2) into Chunk(h1).
 void BFCAllocator::Merge(BFCAllocator::ChunkHandle h1,
@@ -832,6 +1137,14 @@ bool BFCAllocator::TracksAllocationSizes() const { return true; }
 
 size_t BFCAllocator::RequestedSize(const void* ptr) const {
   CHECK(ptr);
+  if (chunk_cache_max_bytes_ > 0) {
+    // The bins only know the size requested when a cached chunk was first
+    // carved out; the cache tracks the size of its current use.
+    CachedChunkIndexShard* index = CachedChunkIndexShardFor(ptr);
+    mutex_lock l(index->mu);
+    auto it = index->chunks.find(ptr);
+    if (it != index->chunks.end()) return it->second.requested_size;
+  }
   mutex_lock l(lock_);
   BFCAllocator::ChunkHandle h = region_manager_.get_handle(ptr);
   CHECK(h != kInvalidChunkHandle)
@@ -1127,8 +1440,21 @@ double BFCAllocator::GetFragmentation() {
 }
 
 absl::optional<AllocatorStats> BFCAllocator::GetStats() {
-  mutex_lock l(lock_);
-  return stats_;
+  AllocatorStats stats;
+  {
+    mutex_lock l(lock_);
+    stats = stats_;
+  }
+  if (chunk_cache_max_bytes_ > 0) {
+    // Free chunks held by the cache are still "in use" from the point of view
+    // of the bins, but not from the point of view of our clients.
+    stats.bytes_in_use -= chunk_cache_bytes_.load(std::memory_order_relaxed);
+    stats.num_cache_hits = chunk_cache_hits_.load(std::memory_order_relaxed);
+    stats.num_cache_misses =
+        chunk_cache_misses_.load(std::memory_order_relaxed);
+    stats.num_allocs += stats.num_cache_hits;
+  }
+  return stats;
 }
 
 void BFCAllocator::ClearStats() {
@@ -1136,6 +1462,8 @@ void BFCAllocator::ClearStats() {
   stats_.num_allocs = 0;
   stats_.peak_bytes_in_use = stats_.bytes_in_use;
   stats_.largest_alloc_size = 0;
+  chunk_cache_hits_.store(0, std::memory_order_relaxed);
+  chunk_cache_misses_.store(0, std::memory_order_relaxed);
 }
 
 std::array<BFCAllocator::BinDebugInfo, BFCAllocator::kNumBins>
@@ -18,11 +18,14 @@ limitations under the License.
 
 #include <array>
 #include <deque>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/common_runtime/allocator_retry.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
@@ -46,6 +49,21 @@ class MemoryDump;
 // coalescing.  One assumption we make is that the process using this
 // allocator owns pretty much all of the memory, and that nearly
 // all requests to allocate memory go through this interface.
+//
+// If the TF_BFC_ALLOCATOR_CHUNK_CACHE_BYTES environment variable is set to a
+// positive value, allocations of at most that many bytes are served from a
+// cache of recently freed chunks that sits in front of the bins. The cache is
+// sharded by thread (with threads sharing shards once there are more threads
+// than cores), so that small allocations and frees do not take the
+// allocator-wide lock. Cached chunks are returned to the bins before an
+// allocation is allowed to fail.
+//
+// If the sub-allocator supports coalescing, memory that it returns right after
+// the end of a region extends that region, so that chunks can be merged across
+// Extend calls. The free memory at the end of such a region is given back to
+// the sub-allocator once nothing has been allocated from it for
+// TF_BFC_ALLOCATOR_TRIM_INTERVAL_SECS seconds (10 by default, 0 never gives
+// memory back). This is checked when memory is deallocated.
 class BFCAllocator : public Allocator {
  public:
   // Takes ownership of sub_allocator.
@@ -92,6 +110,10 @@ class BFCAllocator : public Allocator {
                             bool dump_log_on_failure,
                             uint64 freed_before_count);
 
+  // Allocates directly from the bins, bypassing the chunk cache.
+  void* AllocateRawUncached(size_t alignment, size_t num_bytes,
+                            const AllocationAttributes& allocation_attr);
+
   void* AllocateRawInternalWithRetry(
       size_t alignment, size_t num_bytes,
       const AllocationAttributes& allocation_attr);
@@ -273,6 +295,29 @@ class BFCAllocator : public Allocator {
       }
     }
 
+    // Adds the memory_size bytes after end_ptr() to the region.
+    void extend(size_t memory_size) {
+      DCHECK_EQ(0, memory_size % kMinAllocationSize);
+      const size_t old_n_handles = memory_size_ / kMinAllocationSize;
+      memory_size_ += memory_size;
+      end_ptr_ = static_cast<void*>(static_cast<char*>(ptr_) + memory_size_);
+      const size_t n_handles = memory_size_ / kMinAllocationSize;
+      std::unique_ptr<ChunkHandle[]> handles(new ChunkHandle[n_handles]);
+      for (size_t i = 0; i < n_handles; i++) {
+        handles[i] = i < old_n_handles ? handles_[i] : kInvalidChunkHandle;
+      }
+      handles_ = std::move(handles);
+    }
+
+    // Removes the last memory_size bytes from the region, which must not
+    // hold the start of a chunk anymore.
+    void shrink(size_t memory_size) {
+      DCHECK_EQ(0, memory_size % kMinAllocationSize);
+      DCHECK_LT(memory_size, memory_size_);
+      memory_size_ -= memory_size;
+      end_ptr_ = static_cast<void*>(static_cast<char*>(ptr_) + memory_size_);
+    }
+
     AllocationRegion() = default;
     AllocationRegion(AllocationRegion&& other) { Swap(&other); }
     AllocationRegion& operator=(AllocationRegion&& other) {
@@ -335,6 +380,20 @@ class BFCAllocator : public Allocator {
       regions_.insert(entry, AllocationRegion(ptr, memory_size));
     }
 
+    // Like AddAllocationRegion, but if ptr is the end of an existing region,
+    // extends that region instead and returns it.
+    AllocationRegion* AddOrExtendAllocationRegion(void* ptr,
+                                                  size_t memory_size) {
+      auto entry =
+          std::upper_bound(regions_.begin(), regions_.end(), ptr, &Comparator);
+      if (entry != regions_.begin() && std::prev(entry)->end_ptr() == ptr) {
+        std::prev(entry)->extend(memory_size);
+        return &*std::prev(entry);
+      }
+      regions_.insert(entry, AllocationRegion(ptr, memory_size));
+      return nullptr;
+    }
+
     std::vector<AllocationRegion>::iterator RemoveAllocationRegion(
         std::vector<AllocationRegion>::iterator it) {
       return regions_.erase(it);
@@ -397,6 +456,15 @@ class BFCAllocator : public Allocator {
   void DeallocateRegions(const absl::flat_hash_set<void*>& region_ptrs)
       TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Gives the free memory at the end of regions back to the sub-allocator, if
+  // it supports coalescing and nothing was allocated from the end of a region
+  // since the previous check, at least trim_interval_us_ ago.
+  void MaybeTrimIdleMemory() TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Frees the sub-allocations that lie entirely within the free chunk h at
+  // the end of its region. Returns the bytes freed.
+  size_t TrimFreeTailChunk(ChunkHandle h) TF_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns a pointer to an underlying allocated chunk of size
   // 'rounded_bytes'.
   void* FindChunkPtr(BinNum bin_num, size_t rounded_bytes, size_t num_bytes,
@@ -519,6 +587,16 @@ class BFCAllocator : public Allocator {
   bool garbage_collection_;
 
   std::unique_ptr<SubAllocator> sub_allocator_;
+  // The ranges returned by sub_allocator_->Alloc, by address, if it supports
+  // coalescing: memory can only be given back to it in whole ranges.
+  std::map<void*, size_t> sub_allocations_ TF_GUARDED_BY(lock_);
+  // How often the free ends of regions are checked for memory to trim, or 0.
+  int64 trim_interval_us_ = 0;
+  uint64 next_trim_check_us_ TF_GUARDED_BY(lock_) = 0;
+  // How many allocations were taken from the last chunk of a region, and how
+  // many there had been at the previous trim check.
+  int64 num_tail_allocations_ TF_GUARDED_BY(lock_) = 0;
+  int64 num_tail_allocations_at_check_ TF_GUARDED_BY(lock_) = -1;
   string name_;
   SharedCounter* timing_counter_ = nullptr;
   std::deque<ChunkHandle> timestamped_chunks_;
@@ -540,6 +618,61 @@ class BFCAllocator : public Allocator {
 
   // Stats.
   AllocatorStats stats_ TF_GUARDED_BY(lock_);
+
+  // Small-chunk cache; see the class comment. Chunks owned by the cache stay
+  // "in use" as far as the bins are concerned, and are tracked separately in
+  // `cached_chunk_index_` so that frees can be routed back to the cache
+  // without looking the chunk up under `lock_`.
+  struct CachedChunk {
+    void* ptr;
+    size_t chunk_bytes;
+  };
+  struct ChunkCacheShard {
+    mutex mu;
+    // Free cached chunks, indexed by size class.
+    std::vector<std::vector<CachedChunk>> free_chunks TF_GUARDED_BY(mu);
+    size_t cached_bytes TF_GUARDED_BY(mu) = 0;
+  };
+  struct CachedChunkInfo {
+    size_t size_class;
+    size_t chunk_bytes;
+    size_t requested_size;
+  };
+  struct CachedChunkIndexShard {
+    mutex mu;
+    absl::flat_hash_map<const void*, CachedChunkInfo> chunks TF_GUARDED_BY(mu);
+  };
+  static constexpr int kNumCachedChunkIndexShards = 64;
+
+  // Size classes are multiples of kMinAllocationSize.
+  static size_t ChunkCacheSizeClass(size_t rounded_bytes) {
+    return (rounded_bytes >> kMinAllocationBits) - 1;
+  }
+  ChunkCacheShard* CurrentChunkCacheShard();
+  CachedChunkIndexShard* CachedChunkIndexShardFor(const void* ptr) const;
+
+  // Returns a cached chunk of at least `rounded_bytes`, or nullptr on a miss.
+  void* AllocateFromChunkCache(size_t rounded_bytes, size_t num_bytes);
+  // Makes `ptr`, freshly allocated from the bins, owned by the cache.
+  void RegisterCachedChunk(void* ptr, size_t rounded_bytes, size_t num_bytes);
+  // Returns true if `ptr` is owned by the cache, in which case it has been
+  // freed into the calling thread's shard (or back to the bins if that shard
+  // is full).
+  bool DeallocateToChunkCache(void* ptr);
+  // Returns all free cached chunks to the bins. Returns true if any chunk was
+  // returned. Must not be called with `lock_` held.
+  bool FlushChunkCaches() TF_LOCKS_EXCLUDED(lock_);
+
+  // Largest allocation served by the cache; 0 if the cache is disabled.
+  size_t chunk_cache_max_bytes_ = 0;
+  // Maximum number of free bytes held by a single shard.
+  size_t chunk_cache_shard_capacity_ = 0;
+  int num_chunk_cache_shards_ = 0;
+  std::unique_ptr<ChunkCacheShard[]> chunk_cache_shards_;
+  std::unique_ptr<CachedChunkIndexShard[]> cached_chunk_index_;
+  std::atomic<int64> chunk_cache_bytes_{0};
+  std::atomic<int64> chunk_cache_hits_{0};
+  std::atomic<int64> chunk_cache_misses_{0};
 #ifdef TENSORFLOW_MEM_DEBUG
   int64 action_counter_ TF_GUARDED_BY(lock_);
 #define MEM_DEBUG_SIZE_HISTORY_SIZE 4096
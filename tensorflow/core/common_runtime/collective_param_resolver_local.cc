@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -57,6 +58,24 @@ void CollectiveParamResolverLocal::CompleteGroupAsync(
 }
 
 namespace {
+// Reductions of tensors up to this size use RecursiveDoublingReduce.  The
+// choice must be the same on all members of a group, so it depends only on
+// the shared collective parameters and this setting, which must agree
+// across tasks.
+int64 RecursiveDoublingMaxBytes() {
+  static const int64 max_bytes = [] {
+    int64 value;
+    Status s = ReadInt64FromEnvVar("TF_COLLECTIVE_RECURSIVE_DOUBLING_MAX_BYTES",
+                                   32 << 10, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      value = 32 << 10;
+    }
+    return value;
+  }();
+  return max_bytes;
+}
+
 const char* GetCollectiveName(const CollectiveParams* cp, bool nccl) {
   switch (cp->instance.type) {
     case BROADCAST_COLLECTIVE:
@@ -689,12 +708,37 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
   //
   // After enough testing, we may simplify this logic to use NCCL whenever
   // available.
+  if (cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.communication_dtype != DT_INVALID) {
+    // Only RingReduce casts to a lower precision communication_dtype.
+    cp->instance.impl_details.collective_name = "RingReduce";
+    VLOG(1) << "AssignCollectiveType "
+            << cp->instance.impl_details.collective_name;
+    return;
+  }
   CollectiveImplementationInterface* col_impl;
   bool use_nccl =
       (nccl_ || cp->instance.impl_details.communication_hint == "nccl") &&
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->instance.impl_details.communication_hint != "ring") {
+    const int64 tensor_bytes = cp->instance.shape.num_elements() *
+                               DataTypeSize(cp->instance.data_type);
+    if (tensor_bytes <= RecursiveDoublingMaxBytes()) {
+      // Small reductions are bound by the latency of each step, so use the
+      // one with the fewest steps.
+      cp->instance.impl_details.collective_name = "RecursiveDoublingReduce";
+    } else if (cp->group.num_tasks > 1 &&
+               cp->instance.same_num_devices_per_task &&
+               cp->group.group_size > cp->group.num_tasks) {
+      // A group that spans several tasks with several devices each reduces
+      // within each task first, so that only 1 / (devices per task) of the
+      // tensor leaves each device.
+      cp->instance.impl_details.collective_name = "HierarchicalRingReduce";
+    }
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -166,19 +166,14 @@ Status Member::SetAssignedDeviceName(const string& device_name) {
   return Status::OK();
 }
 
-Status Member::SetResourceDeviceName(const Node& node) {
+Status Member::SetResourceDeviceName(
+    const DeviceNameUtils::ParsedName& device_name) {
   if (DeviceNameUtils::HasSomeDetails(requested_device_name_)) {
     return errors::Internal(
         "Setting resource device name when there is a requested device set "
         "is unsupported");
   }
-
-  if (!DeviceNameUtils::ParseFullName(node.requested_device(),
-                                      &resource_device_name_)) {
-    return errors::InvalidArgument("Malformed device specification '",
-                                   node.requested_device(),
-                                   "' in node: ", node.DebugString());
-  }
+  resource_device_name_ = device_name;
 
   // Set requested device to resource device to maintain the invariant that
   // requested is a specialization of resource.
@@ -186,7 +181,8 @@ Status Member::SetResourceDeviceName(const Node& node) {
   return Status::OK();
 }
 
-Status Member::SetRequestedDeviceName(const Node& node) {
+Status Member::SetRequestedDeviceName(
+    const DeviceNameUtils::ParsedName& device_name) {
   if (DeviceNameUtils::HasSomeDetails(assigned_device_name_)) {
     return errors::Internal(
         "Setting requested device name when there is an assigned device set "
@@ -197,12 +193,7 @@ Status Member::SetRequestedDeviceName(const Node& node) {
         "Setting requested device name when there is a resource device set "
         "is unsupported");
   }
-  if (!DeviceNameUtils::ParseFullName(node.requested_device(),
-                                      &requested_device_name_)) {
-    return errors::InvalidArgument("Malformed device specification '",
-                                   node.requested_device(),
-                                   "' in node: ", node.DebugString());
-  }
+  requested_device_name_ = device_name;
   return Status::OK();
 }
 
@@ -343,6 +334,13 @@ int Member::FindRoot(const std::vector<Member>& tree, int node_id) {
 
 Status Member::MergeDeviceNames(const Member& other,
                                 bool allow_soft_placement) {
+  // Most members of large graphs carry no device constraints, and merging
+  // them cannot change this member.
+  if (!DeviceNameUtils::HasSomeDetails(other.assigned_device_name_) &&
+      !DeviceNameUtils::HasSomeDetails(other.resource_device_name_) &&
+      !DeviceNameUtils::HasSomeDetails(other.requested_device_name_)) {
+    return Status::OK();
+  }
   // Assuming the "requested is a specialization of assigned and resource
   // devices" invariant holds for this and `other`, it will hold after the
   // merges below.
@@ -383,6 +381,14 @@ bool Member::MergeSupportedDevices(
   // Generate intersection with priorities.
   // Each vector contains the same device types but with different priorities.
   // The priorities are taken from the corresponding source vector.
+  // Colocated nodes usually support the same device types with the same
+  // priorities, in which case the intersection is this member's types.
+  if (supported_device_types_ == other_devices) {
+    if (supported_device_types_.empty()) return false;
+    DeviceSet::SortPrioritizedDeviceTypeVector(&supported_device_types_);
+    return true;
+  }
+
   PrioritizedDeviceTypeVector target_intersection;
   PrioritizedDeviceTypeVector other_intersection;
 
@@ -1407,23 +1413,44 @@ Status ColocationGraph::InitializeMember(const Node& node, Member* member) {
     // If the NodeDef contains a device, then we interpret it as a
     // (partial) device specification.
     if (!node.requested_device().empty()) {
+      const DeviceNameUtils::ParsedName* requested_device_name;
+      TF_RETURN_IF_ERROR(ParseRequestedDevice(node, &requested_device_name));
       if (IsRefOrResourceGeneratorNode(node)) {
         // Treat requested device on resource generating nodes as assigned
         // device so that we don't override it.
-        TF_RETURN_IF_ERROR(member->SetResourceDeviceName(node));
+        TF_RETURN_IF_ERROR(
+            member->SetResourceDeviceName(*requested_device_name));
       } else {
         // The user has specified a device in the NodeDef, try to find a
         // valid device matching their specification in the set of
         // devices.
         // NOTE: The full name may specify a device that is not in
         // n.supported_device_types(), but we check that in AssignDevice().
-        TF_RETURN_IF_ERROR(member->SetRequestedDeviceName(node));
+        TF_RETURN_IF_ERROR(
+            member->SetRequestedDeviceName(*requested_device_name));
       }
     }
   }
   return Status::OK();
 }
 
+Status ColocationGraph::ParseRequestedDevice(
+    const Node& node, const DeviceNameUtils::ParsedName** device_name) {
+  auto it = parsed_requested_devices_.find(node.requested_device());
+  if (it == parsed_requested_devices_.end()) {
+    DeviceNameUtils::ParsedName parsed;
+    if (!DeviceNameUtils::ParseFullName(node.requested_device(), &parsed)) {
+      return errors::InvalidArgument("Malformed device specification '",
+                                     node.requested_device(),
+                                     "' in node: ", node.DebugString());
+    }
+    it = parsed_requested_devices_.emplace(node.requested_device(), parsed)
+             .first;
+  }
+  *device_name = &it->second;
+  return Status::OK();
+}
+
 // Returns a list of devices having type in supported_device_types.  The
 // returned list is sorted by preferred type (higher numeric type is preferred).
 /*static*/ std::vector<Device*> ColocationGraph::FilterSupportedDevices(
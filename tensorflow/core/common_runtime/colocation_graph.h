@@ -46,8 +46,9 @@ class Member {
   }
 
   Status SetAssignedDeviceName(const string& device_name);
-  Status SetResourceDeviceName(const Node& node);
-  Status SetRequestedDeviceName(const Node& node);
+  Status SetResourceDeviceName(const DeviceNameUtils::ParsedName& device_name);
+  Status SetRequestedDeviceName(
+      const DeviceNameUtils::ParsedName& device_name);
 
   Status FillPossibleDevices(PossibleDevices* possible_device) const;
 
@@ -351,6 +352,11 @@ class ColocationGraph {
 
   Status InitializeMember(const Node& node, Member* member);
 
+  // Parses the device requested by `node`. Large graphs tend to request a few
+  // distinct devices from many nodes, so parsed names are memoized.
+  Status ParseRequestedDevice(const Node& node,
+                              const DeviceNameUtils::ParsedName** device_name);
+
   // Returns the root node of the disjoint tree to which the node with the
   // given id is connected.
   // FindRoot should be called only for debugging or after the members have
@@ -373,6 +379,8 @@ class ColocationGraph {
   const Device* default_local_device_;
   const bool allow_soft_placement_;
   const bool log_device_placement_;
+  std::unordered_map<string, DeviceNameUtils::ParsedName>
+      parsed_requested_devices_;
 
   TF_DISALLOW_COPY_AND_ASSIGN(ColocationGraph);
 };
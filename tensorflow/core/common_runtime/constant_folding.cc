@@ -207,6 +207,43 @@ bool MaybeReplaceShapeOp(
   return true;
 }
 
+// Returns true if the outputs of n are known from shape_map to be larger than
+// both max_constant_size_in_bytes and the inputs of n. Such outputs could not
+// be replaced by constants, so evaluating n would only materialize them to
+// throw them away.
+bool OutputsTooLargeToFold(
+    const Node* n,
+    const std::unordered_map<string, std::vector<PartialTensorShape>>*
+        shape_map,
+    int64 max_constant_size_in_bytes) {
+  if (shape_map == nullptr || n->num_outputs() == 0) return false;
+  // Returns the size in bytes of output `index` of `node`, or -1 if unknown.
+  auto output_bytes = [shape_map](const Node* node, int index) -> int64 {
+    const auto it = shape_map->find(node->name());
+    if (it == shape_map->end() ||
+        index >= static_cast<int>(it->second.size()) ||
+        !it->second[index].IsFullyDefined()) {
+      return -1;
+    }
+    return it->second[index].num_elements() *
+           DataTypeSize(node->output_type(index));
+  };
+  int64 input_bytes = 0;
+  for (const Edge* in : n->in_edges()) {
+    if (in->IsControlEdge()) continue;
+    const int64 bytes = output_bytes(in->src(), in->src_output());
+    if (bytes < 0) return false;
+    input_bytes += bytes;
+  }
+  for (int i = 0; i < n->num_outputs(); ++i) {
+    const int64 bytes = output_bytes(n, i);
+    if (bytes <= max_constant_size_in_bytes || bytes <= input_bytes) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // Returns true if n can be evaluated as constant. shape_map maps from
 // nodes to the partially-known shapes of their outputs. consider if
 // non-null returns a bool indicating whether a given (non-Const,
@@ -219,6 +256,7 @@ bool IsConstantFoldable(
     const std::unordered_map<string, std::vector<PartialTensorShape>>*
         shape_map,
     const std::function<bool(const Node*)>& consider,
+    int64 max_constant_size_in_bytes,
     std::unordered_map<const Node*, std::vector<Tensor>>*
         shape_replacement_map) {
   if (n->IsConstant()) {
@@ -233,6 +271,11 @@ bool IsConstantFoldable(
   if (consider && !consider(n)) {
     return false;
   }
+  if (OutputsTooLargeToFold(n, shape_map, max_constant_size_in_bytes)) {
+    VLOG(2) << "Skip node [" << n->DebugString()
+            << "] for constant folding due to the size of its outputs";
+    return false;
+  }
   if (n->IsControlFlow() || n->IsSend() || n->IsRecv()) {
     return false;
   }
@@ -280,6 +323,7 @@ void ConsiderConstantFoldableNode(
     std::unordered_map<const Node*, std::vector<Tensor>>* shape_replacement_map,
     bool* internal_node_inserted) {
   if (IsConstantFoldable(n, opts.shape_map, opts.consider,
+                         opts.max_constant_size_in_bytes,
                          shape_replacement_map)) {
     // A node is constant provided all of its non-control incoming Tensors come
     // from constant nodes, or it's a shape Op with statically known inputs in
@@ -333,6 +333,43 @@ TEST_F(ConstantFoldingTest, TestNoReplaceLargeConstant) {
   EXPECT_TRUE(was_mutated);
 }
 
+TEST_F(ConstantFoldingTest, TestNoEvaluateKnownLargeOutput) {
+  Graph g(OpRegistry::Global());
+  {
+    Scope s = Scope::NewRootScope();
+    auto c = ops::Const<int>(s.WithOpName("c"), {1}, {1});
+    auto multiples = ops::Const<int>(s.WithOpName("multiples"), {1024}, {1});
+    auto tile = ops::Tile(s.WithOpName("tile"), c, multiples);
+    auto add = ops::Add(s.WithOpName("add"), c, c);
+    auto tile_send = ops::_Send(s.WithOpName("tile_send"), tile, "tile_send",
+                                "sender", 0, "receiver");
+    auto add_send = ops::_Send(s.WithOpName("add_send"), add, "add_send",
+                               "sender", 0, "receiver");
+    TF_ASSERT_OK(s.ToGraph(&g));
+  }
+  std::unordered_map<string, std::vector<PartialTensorShape>> map;
+  map["c"].push_back(PartialTensorShape({1}));
+  map["multiples"].push_back(PartialTensorShape({1}));
+  map["tile"].push_back(PartialTensorShape({1024}));
+  map["add"].push_back(PartialTensorShape({1}));
+  ConstantFoldingOptions opts;
+  opts.shape_map = &map;
+  opts.max_constant_size_in_bytes = 1024;
+  bool was_mutated;
+  TF_EXPECT_OK(
+      ConstantFold(opts, nullptr, Env::Default(), nullptr, &g, &was_mutated));
+  EXPECT_TRUE(was_mutated);
+
+  // The tile is known to be too large to fold, so only the add is folded.
+  std::unordered_map<string, Node*> index = g.BuildNodeNameIndex();
+  Node* tile_send = index.at("tile_send");
+  Node* add_send = index.at("add_send");
+  ASSERT_EQ(1, tile_send->num_inputs());
+  EXPECT_EQ("Tile", (*tile_send->in_nodes().begin())->type_string());
+  ASSERT_EQ(1, add_send->num_inputs());
+  ExpectNodeEqual<int>(*(add_send->in_nodes().begin()), {2}, {1});
+}
+
 TEST_F(ConstantFoldingTest, TestNoReplaceFunctionCall) {
   FunctionDefLibrary flib;
   *flib.add_function() = test::function::XTimesTwo();
@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "tensorflow/core/common_runtime/collective_executor_mgr.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/common_runtime/constant_folding.h"
@@ -60,6 +61,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/core/threadpool_options.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
@@ -69,6 +71,7 @@ limitations under the License.
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
@@ -76,6 +79,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -337,6 +341,15 @@ DirectSession::DirectSession(const SessionOptions& options,
       run_in_caller_thread_ = true;
     }
   }
+  if (thread_pool_size == 0 && !run_in_caller_thread_ &&
+      options_.config.experimental().use_numa_affinity() &&
+      port::NUMAEnabled() && port::NUMANumNodes() > 1) {
+    const int num_numa_nodes = port::NUMANumNodes();
+    for (int numa_node = 0; numa_node < num_numa_nodes; ++numa_node) {
+      numa_thread_pools_.emplace_back(NewNumaThreadPoolFromSessionOptions(
+          options_, numa_node, num_numa_nodes));
+    }
+  }
   // The default value of sync_on_finish will be flipped soon and this
   // environment variable will be removed as well.
   const Status status =
@@ -443,9 +456,7 @@ Status DirectSession::ExtendLocked(GraphDef graph) {
   } else {
     TF_RETURN_IF_ERROR(flib_def_->AddLibrary(graph.library()));
     std::unique_ptr<GraphExecutionState> state;
-    // TODO(mrry): Rewrite GraphExecutionState::Extend() to take `graph` by
-    // value and move `graph` in here.
-    TF_RETURN_IF_ERROR(execution_state_->Extend(graph, &state));
+    TF_RETURN_IF_ERROR(execution_state_->Extend(std::move(graph), &state));
     execution_state_.swap(state);
   }
   return Status::OK();
@@ -679,18 +690,41 @@ Status DirectSession::RunInternal(
 
   Status run_status;
 
+  // Partitions run on the inter-op pool of their device's NUMA node if the
+  // step would otherwise use the default session pool.
+  const bool use_numa_thread_pools = !numa_thread_pools_.empty() &&
+                                     handler_ptr == nullptr &&
+                                     pool == thread_pools_[0].first;
+
+  // Bounds the intra-op parallelism of every kernel of this step, so that
+  // co-located requests do not oversubscribe the intra-op pool.
+  const int intra_op_parallelism_limit =
+      run_options.experimental().intra_op_parallelism_limit();
+  if (intra_op_parallelism_limit < 0) {
+    return errors::InvalidArgument("Invalid intra_op_parallelism_limit: ",
+                                   intra_op_parallelism_limit);
+  }
+
   auto set_threadpool_args_for_item =
-      [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
-                                  Executor::Args* args) {
+      [this, &default_runner, &handler, use_numa_thread_pools,
+       intra_op_parallelism_limit](const PerPartitionExecutorsAndLib& item,
+                                   Executor::Args* args) {
         // TODO(azaks): support partial run.
         // TODO(azaks): if the device picks its own threadpool, we need to
         // assign
         //     less threads to the main compute pool by default.
         thread::ThreadPool* device_thread_pool =
             item.device->tensorflow_device_thread_pool();
+        const int numa_node = item.device->attributes().locality().numa_node();
         // TODO(crk): Investigate usage of RunHandlerPool when using device
         // specific thread pool(s).
-        if (!device_thread_pool) {
+        if (!device_thread_pool && use_numa_thread_pools && numa_node >= 0 &&
+            numa_node < numa_thread_pools_.size()) {
+          thread::ThreadPool* numa_pool = numa_thread_pools_[numa_node].get();
+          args->runner = [numa_pool](Executor::Args::Closure c) {
+            numa_pool->Schedule(std::move(c));
+          };
+        } else if (!device_thread_pool) {
           args->runner = default_runner;
         } else {
           args->runner = [device_thread_pool](Executor::Args::Closure c) {
@@ -701,6 +735,17 @@ Status DirectSession::RunInternal(
           args->user_intra_op_threadpool =
               handler->AsIntraThreadPoolInterface();
         }
+        if (intra_op_parallelism_limit > 0) {
+          args->runner = [runner = std::move(args->runner),
+                          intra_op_parallelism_limit](
+                             Executor::Args::Closure c) {
+            runner([intra_op_parallelism_limit, c = std::move(c)]() {
+              ScopedPerThreadMaxParallelism scope(std::min(
+                  intra_op_parallelism_limit, GetPerThreadMaxParallelism()));
+              c();
+            });
+          };
+        }
       };
 
   if (can_execute_synchronously) {
@@ -852,8 +897,12 @@ Status DirectSession::Run(const RunOptions& run_options,
 
   // Configure a call frame for the step, which we use to feed and
   // fetch values to and from the executors.
-  FunctionCallFrame call_frame(executors_and_keys->input_types,
-                               executors_and_keys->output_types);
+  std::unique_ptr<FunctionCallFrame> call_frame =
+      AcquireCallFrame(executors_and_keys);
+  auto release_call_frame =
+      gtl::MakeCleanup([executors_and_keys, &call_frame]() {
+        ReleaseCallFrame(executors_and_keys, std::move(call_frame));
+      });
   gtl::InlinedVector<Tensor, 4> feed_args(inputs.size());
   for (const auto& it : inputs) {
     if (it.second.dtype() == DT_RESOURCE) {
@@ -866,7 +915,7 @@ Status DirectSession::Run(const RunOptions& run_options,
       feed_args[executors_and_keys->input_name_to_index[it.first]] = it.second;
     }
   }
-  const Status s = call_frame.SetArgs(feed_args);
+  const Status s = call_frame->SetArgs(feed_args);
   if (errors::IsInternal(s)) {
     return errors::InvalidArgument(s.error_message());
   } else if (!s.ok()) {
@@ -879,14 +928,14 @@ Status DirectSession::Run(const RunOptions& run_options,
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
-  TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
+  TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, call_frame.get(),
                                  executors_and_keys, run_metadata,
                                  threadpool_options));
 
   // Receive outputs.
   if (outputs) {
     std::vector<Tensor> sorted_outputs;
-    const Status s = call_frame.ConsumeRetvals(
+    const Status s = call_frame->ConsumeRetvals(
         &sorted_outputs, /* allow_dead_tensors = */ false);
     if (errors::IsInternal(s)) {
       return errors::InvalidArgument(s.error_message());
@@ -926,6 +975,38 @@ Status DirectSession::Run(const RunOptions& run_options,
   return Status::OK();
 }
 
+/* static */
+std::unique_ptr<FunctionCallFrame> DirectSession::AcquireCallFrame(
+    ExecutorsAndKeys* executors_and_keys) {
+  {
+    mutex_lock l(executors_and_keys->call_frame_pool_mu);
+    auto& pool = executors_and_keys->call_frame_pool;
+    if (!pool.empty()) {
+      std::unique_ptr<FunctionCallFrame> call_frame = std::move(pool.back());
+      pool.pop_back();
+      return call_frame;
+    }
+  }
+  return absl::make_unique<FunctionCallFrame>(executors_and_keys->input_types,
+                                              executors_and_keys->output_types);
+}
+
+/* static */
+void DirectSession::ReleaseCallFrame(
+    ExecutorsAndKeys* executors_and_keys,
+    std::unique_ptr<FunctionCallFrame> call_frame) {
+  // Bounds the number of idle frames kept per signature; beyond this many
+  // concurrent callers, extra frames are simply freed.
+  static constexpr size_t kMaxPooledCallFrames = 64;
+  // Drop references to the fed and fetched tensors now, so that pooling the
+  // frame does not extend their lifetimes.
+  call_frame->Reset();
+  mutex_lock l(executors_and_keys->call_frame_pool_mu);
+  if (executors_and_keys->call_frame_pool.size() < kMaxPooledCallFrames) {
+    executors_and_keys->call_frame_pool.push_back(std::move(call_frame));
+  }
+}
+
 Status DirectSession::PRunSetup(const std::vector<string>& input_names,
                                 const std::vector<string>& output_names,
                                 const std::vector<string>& target_nodes,
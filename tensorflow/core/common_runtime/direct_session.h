@@ -34,6 +34,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/session_factory.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/session_state.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -176,6 +177,14 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64 collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // Call frames for Run() calls with these feeds and fetches. A frame is
+    // returned here when its call finishes and handed to a later call, so
+    // that repeated calls with the same signature do not allocate a new frame
+    // per step.
+    mutex call_frame_pool_mu;
+    std::vector<std::unique_ptr<FunctionCallFrame>> call_frame_pool
+        TF_GUARDED_BY(call_frame_pool_mu);
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -227,6 +236,15 @@ class DirectSession : public Session {
     ~PartialRunState();
   };
 
+  // Returns a call frame for a Run() call on `executors_and_keys`, reusing a
+  // pooled frame if one is available.
+  static std::unique_ptr<FunctionCallFrame> AcquireCallFrame(
+      ExecutorsAndKeys* executors_and_keys);
+
+  // Resets `call_frame` and returns it to the pool of `executors_and_keys`.
+  static void ReleaseCallFrame(ExecutorsAndKeys* executors_and_keys,
+                               std::unique_ptr<FunctionCallFrame> call_frame);
+
   struct RunStateArgs {
     explicit RunStateArgs(const DebugOptions& options)
         : debug_options(options) {}
@@ -350,6 +368,11 @@ class DirectSession : public Session {
   // is owned.
   std::vector<std::pair<thread::ThreadPool*, bool>> thread_pools_;
 
+  // If the session uses NUMA affinity and the default inter-op pool, one
+  // inter-op pool per NUMA node, indexed by node. Each partition is run on the
+  // pool of its device's NUMA node.
+  std::vector<std::unique_ptr<thread::ThreadPool>> numa_thread_pools_;
+
   Status init_error_;  // Set to an error if construction failed.
 
   // If true, blocks until device has finished all queued operations in a step.
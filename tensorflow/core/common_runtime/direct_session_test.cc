@@ -52,6 +52,7 @@ limitations under the License.
 #include "tensorflow/core/public/session.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA
 #include "third_party/gpus/cuda/include/cuda.h"
@@ -152,6 +153,30 @@ TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork) {
   EXPECT_FLOAT_EQ(5.0, mat(0, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, RunSimpleNetworkRepeatedly) {
+  Initialize({3, 2, -1, 0});
+  auto session = CreateSession();
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def_));
+
+  // Repeated calls with the same signature reuse a pooled call frame; check
+  // that no state leaks from one call into the next, including after a
+  // failed call.
+  for (int i = 0; i < 4; ++i) {
+    Tensor x_tensor(DT_FLOAT, TensorShape({2, 1}));
+    test::FillValues<float>(&x_tensor, {static_cast<float>(i), 1});
+    std::vector<Tensor> outputs;
+    TF_ASSERT_OK(session->Run({{x_, x_tensor}}, {y_ + ":0"}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    auto mat = outputs[0].matrix<float>();
+    EXPECT_FLOAT_EQ(3.0 * i + 2.0, mat(0, 0));
+
+    Tensor bad_tensor(DT_INT32, TensorShape({2, 1}));
+    EXPECT_FALSE(
+        session->Run({{x_, bad_tensor}}, {y_ + ":0"}, {}, &outputs).ok());
+  }
+}
+
 TEST_F(DirectSessionMinusAXTest, RunSimpleNetwork_Callable) {
   Initialize({3, 2, -1, 0});
   auto session = CreateSession();
@@ -1367,6 +1392,52 @@ class ThreadIDOp : public OpKernel {
 };
 REGISTER_KERNEL_BUILDER(Name("ThreadID").Device(DEVICE_CPU), ThreadIDOp);
 
+REGISTER_OP("MaxParallelismReader")
+    .Input("x: int64")
+    .Output("y: int64")
+    .SetIsStateful()
+    .Doc(R"doc(
+MaxParallelismReader returns the intra-op parallelism limit of its thread.
+
+x: int64
+y: int64
+)doc");
+
+class MaxParallelismReaderOp : public OpKernel {
+ public:
+  explicit MaxParallelismReaderOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+  void Compute(OpKernelContext* ctx) override {
+    Tensor* out_tensor = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output("y", TensorShape({}), &out_tensor));
+    out_tensor->scalar<int64>()() = GetPerThreadMaxParallelism();
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("MaxParallelismReader").Device(DEVICE_CPU),
+                        MaxParallelismReaderOp);
+
+TEST(DirectSessionTest, IntraOpParallelismLimit) {
+  Graph g(OpRegistry::Global());
+  Tensor vx(DT_INT64, TensorShape({}));
+  vx.scalar<int64>()() = 17;
+  Node* x = test::graph::Constant(&g, vx);
+  Node* y = test::graph::Unary(&g, "MaxParallelismReader", x);
+  GraphDef def;
+  g.ToGraphDef(&def);
+  auto sess = CreateSession();
+  TF_ASSERT_OK(sess->Create(def));
+  std::vector<Tensor> outputs;
+  RunOptions run_opts;
+  run_opts.mutable_experimental()->set_intra_op_parallelism_limit(2);
+  TF_ASSERT_OK(
+      sess->Run(run_opts, {}, {y->name() + ":0"}, {}, &outputs, nullptr));
+  EXPECT_EQ(2, outputs[0].scalar<int64>()());
+
+  run_opts.mutable_experimental()->set_intra_op_parallelism_limit(-1);
+  EXPECT_TRUE(errors::IsInvalidArgument(
+      sess->Run(run_opts, {}, {y->name() + ":0"}, {}, &outputs, nullptr)));
+}
+
 TEST(DirectSessionTest, SessionSyncRun) {
   Graph g(OpRegistry::Global());
   Tensor vx(DT_INT64, TensorShape({}));
@@ -1447,6 +1518,36 @@ TEST(DirectSessionTest, SessionSyncRun_DeepGraph) {
                   .ok());
 }
 
+TEST(DirectSessionTest, NumaAffinity) {
+  // With NUMA affinity, each CPU device is assigned to a NUMA node and its
+  // partition runs on that node's inter-op pool, if the host has several.
+  Graph g(OpRegistry::Global());
+  Tensor vx(DT_FLOAT, TensorShape({}));
+  vx.scalar<float>()() = 2.0f;
+  Node* x = test::graph::Constant(&g, vx);
+  x->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:0");
+  Node* y = test::graph::Unary(&g, "Neg", x);
+  y->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:1");
+  Node* z = test::graph::Add(&g, x, y);
+  z->set_assigned_device_name("/job:localhost/replica:0/task:0/cpu:0");
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  options.config.mutable_experimental()->set_use_numa_affinity(true);
+  std::unique_ptr<Session> sess(NewSession(options));
+  TF_ASSERT_OK(sess->Create(def));
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(sess->Run({}, {y->name() + ":0", z->name() + ":0"}, {},
+                           &outputs));
+    ASSERT_EQ(2, outputs.size());
+    EXPECT_EQ(-2.0f, outputs[0].scalar<float>()());
+    EXPECT_EQ(0.0f, outputs[1].scalar<float>()());
+  }
+}
+
 TEST(DirectSessionTest, SyncSession) {
   Graph g(OpRegistry::Global());
   Tensor vx(DT_INT64, TensorShape({}));
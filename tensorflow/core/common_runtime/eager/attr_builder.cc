@@ -266,18 +266,24 @@ inline tensorflow::Fprint128 CacheKeyHelper(StringPiece s, uint64 b) {
 }  // namespace
 
 tensorflow::Fprint128 AttrBuilder::CacheKey(const StringPiece device) {
-  if (!cached_cache_key_ || device != device_for_cached_cache_key_) {
-    cached_cache_key_ = BuildCacheKeyForDevice(device);
+  if (!device_fingerprint_ || device != device_for_cached_cache_key_) {
+    device_fingerprint_ = tensorflow::Fingerprint128(device);
     device_for_cached_cache_key_ = string(device);
+    cached_cache_key_ = absl::nullopt;
+  }
+  if (!cached_cache_key_) {
+    cached_cache_key_ = BuildCacheKey(*device_fingerprint_);
   }
 
   return *cached_cache_key_;
 }
 
-tensorflow::Fprint128 AttrBuilder::BuildCacheKeyForDevice(
-    const StringPiece device) const {
-  tensorflow::Fprint128 f = tensorflow::Fingerprint128(op_name());
-  f = tensorflow::FingerprintCat128(f, tensorflow::Fingerprint128(device));
+tensorflow::Fprint128 AttrBuilder::BuildCacheKey(
+    const tensorflow::Fprint128& device_fingerprint) const {
+  tensorflow::Fprint128 f = op_name_fingerprint_
+                                ? *op_name_fingerprint_
+                                : tensorflow::Fingerprint128(op_name());
+  f = tensorflow::FingerprintCat128(f, device_fingerprint);
   for (const auto& p : encoded_attrs_) {
     CombineUnordered(
         CacheKeyHelper(p.first, tensorflow::Fingerprint128(p.second)), &f);
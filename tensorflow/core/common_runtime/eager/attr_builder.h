@@ -89,13 +89,18 @@ class AttrBuilder {
   explicit AttrBuilder(const char* op) { Reset(op); }
 
   void Reset(const char* op) {
-    op_name_ = op;
+    // AttrBuilders are typically reused for many calls of the same op on the
+    // same device, so the fingerprints of the op and device names are kept
+    // across resets.
+    if (!op_name_fingerprint_ || op_name_ != op) {
+      op_name_ = op;
+      op_name_fingerprint_ = tensorflow::Fingerprint128(op_name_);
+    }
     num_inputs_ = 0;
     encoded_attrs_.clear();
     node_def_initialized_ = false;
     node_def_finalized_ = false;
     cached_cache_key_ = absl::nullopt;
-    device_for_cached_cache_key_.clear();
   }
 
   const string& op_name() const { return op_name_; }
@@ -143,7 +148,8 @@ class AttrBuilder {
   const NodeDef& BuildNodeDef();
 
  private:
-  tensorflow::Fprint128 BuildCacheKeyForDevice(const StringPiece device) const;
+  tensorflow::Fprint128 BuildCacheKey(
+      const tensorflow::Fprint128& device_fingerprint) const;
 
   // Initialize the node_def_ object.
   // REQUIRES: node_def_initialized_ = false
@@ -173,7 +179,10 @@ class AttrBuilder {
   bool node_def_finalized_;
 
   absl::optional<tensorflow::Fprint128> cached_cache_key_;
+  absl::optional<tensorflow::Fprint128> op_name_fingerprint_;
+  // The device of the last CacheKey() call and its fingerprint.
   string device_for_cached_cache_key_;
+  absl::optional<tensorflow::Fprint128> device_fingerprint_;
 };
 
 template <>
@@ -83,6 +83,27 @@ TEST(AttrTypeMap, CacheKey) {
   ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
 }
 
+TEST(AttrTypeMap, CacheKeyAfterReset) {
+  AttrBuilder a("MatMul");
+  a.Set("T", TF_FLOAT);
+  const tensorflow::Fprint128 cache_key = a.CacheKey("cpu:0");
+
+  // Reusing the builder for other ops and devices must not change the key
+  // that the same op, attributes and device get.
+  a.Reset("Add");
+  a.Set("T", TF_FLOAT);
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:0"));
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:1"));
+  a.Reset("MatMul");
+  a.Set("T", TF_FLOAT);
+  ASSERT_FALSE(cache_key == a.CacheKey("cpu:1"));
+  ASSERT_TRUE(cache_key == a.CacheKey("cpu:0"));
+
+  AttrBuilder b("MatMul");
+  b.Set("T", TF_FLOAT);
+  ASSERT_TRUE(cache_key == b.CacheKey("cpu:0"));
+}
+
 string ToString(const AttrValueMap& m) {
   std::vector<string> strs;
   for (const auto& e : m) {
@@ -116,5 +137,20 @@ TEST(AttrBuilder, FillAttrValueMapWithoutDefaults_UnknownOp) {
   ASSERT_EQ(false, m["transpose_b"].b()) << ToString(m);
 }
 
+// Measures building the kernel cache key of an op, the way the eager runtime
+// does with a reused EagerOperation for every call.
+void BM_CacheKeyAfterReset(int iters) {
+  AttrBuilder a;
+  const string device = "/job:localhost/replica:0/task:0/device:CPU:0";
+  while (iters-- > 0) {
+    a.Reset("MatMul");
+    a.Set("T", DT_FLOAT);
+    a.Set("transpose_a", false);
+    a.Set("transpose_b", true);
+    tensorflow::testing::DoNotOptimize(a.CacheKey(device));
+  }
+}
+BENCHMARK(BM_CacheKeyAfterReset);
+
 }  // namespace
 }  // namespace tensorflow
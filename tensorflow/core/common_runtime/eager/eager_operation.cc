@@ -28,28 +28,42 @@ Status EagerOperation::Reset(
   DCHECK(inputs_.empty());
   ClearInferenceState();
   bool is_function = false;
-  TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
-
-  // Don't update the device of direct function calls.
-  // Particularly, if the user did not explicitly request any device for this
-  // function, picking a device would result in this device being the default
-  // for nodes inside the function. This is undesirable for multi-device
-  // functions since the not-explicitly-placed nodes inside the body will all
-  // end up on this default device.
-  colocation_exempt_ = is_function;
-  if (!is_function) {
-    const auto& exempt_ops = InputColocationExemptionRegistry::Global()->Get();
-    colocation_exempt_ = exempt_ops.find(op) != exempt_ops.end();
-
-    TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def_));
-  } else if (!remote && !ctx_.FindFunctionByName(op)) {
-    return errors::NotFound(
-        "'", op,
-        "' is neither a type of a primitive operation nor a name "
-        "of a function registered in binary running on ",
-        port::Hostname(),
-        ". Make sure the operation or function is "
-        "registered in the binary running in this process.");
+  if (!last_primitive_op_.empty() && last_primitive_op_ == op) {
+    // The registry lookups below cannot change for a primitive op, so skip
+    // them when this operation is reused for the op it last ran.
+    attr_types_ = last_primitive_op_attr_types_;
+    op_def_ = last_primitive_op_def_;
+    colocation_exempt_ = last_primitive_op_colocation_exempt_;
+  } else {
+    last_primitive_op_.clear();
+    TF_RETURN_IF_ERROR(AttrTypeMapForOp(op, &attr_types_, &is_function));
+
+    // Don't update the device of direct function calls.
+    // Particularly, if the user did not explicitly request any device for
+    // this function, picking a device would result in this device being the
+    // default for nodes inside the function. This is undesirable for
+    // multi-device functions since the not-explicitly-placed nodes inside the
+    // body will all end up on this default device.
+    colocation_exempt_ = is_function;
+    if (!is_function) {
+      const auto& exempt_ops =
+          InputColocationExemptionRegistry::Global()->Get();
+      colocation_exempt_ = exempt_ops.find(op) != exempt_ops.end();
+
+      TF_RETURN_IF_ERROR(OpDefForOp(op, &op_def_));
+      last_primitive_op_ = op;
+      last_primitive_op_attr_types_ = attr_types_;
+      last_primitive_op_def_ = op_def_;
+      last_primitive_op_colocation_exempt_ = colocation_exempt_;
+    } else if (!remote && !ctx_.FindFunctionByName(op)) {
+      return errors::NotFound(
+          "'", op,
+          "' is neither a type of a primitive operation nor a name "
+          "of a function registered in binary running on ",
+          port::Hostname(),
+          ". Make sure the operation or function is "
+          "registered in the binary running in this process.");
+    }
   }
   attrs_.Reset(op);
   use_xla_ = false;
@@ -154,6 +154,14 @@ class EagerOperation {
   EagerExecutor* executor_;                              // Not owned.
   absl::optional<EagerRemoteFunctionParams> remote_func_params_;
 
+  // The primitive op this operation was last reset to, if any, and what
+  // Reset() looked up for it. EagerOperations are reused across calls (e.g.,
+  // by the Python fast path), and consecutive calls often run the same op.
+  string last_primitive_op_;
+  const AttrTypeMap* last_primitive_op_attr_types_ = nullptr;
+  const tensorflow::OpDef* last_primitive_op_def_ = nullptr;
+  bool last_primitive_op_colocation_exempt_ = false;
+
   // Inference information
   const tensorflow::OpDef* op_def_;  // op definition from protobuf
   int inference_arg_idx_;  // arg definition index for the next input to be
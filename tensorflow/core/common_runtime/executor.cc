@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -45,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/edgeset.h"
+#include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -71,6 +73,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/annotated_traceme.h"
 #include "tensorflow/core/profiler/lib/scoped_annotation.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 
 namespace tensorflow {
@@ -83,6 +86,68 @@ bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
 
+// Returns the number of work-stealing workers to use for a step run with
+// `args`. A positive `args.num_stealing_workers` takes precedence; otherwise
+// the TF_EXECUTOR_NUM_STEALING_WORKERS environment variable is consulted.
+// Zero (the default) disables work stealing.
+int NumStealingWorkers(const Executor::Args& args) {
+  if (args.num_stealing_workers > 0) return args.num_stealing_workers;
+  static const int env_num_workers = [] {
+    int64 num_workers;
+    Status s = ReadInt64FromEnvVar("TF_EXECUTOR_NUM_STEALING_WORKERS", 0,
+                                   &num_workers);
+    if (!s.ok()) {
+      LOG(ERROR) << "Invalid TF_EXECUTOR_NUM_STEALING_WORKERS: " << s;
+      return 0;
+    }
+    return static_cast<int>(std::max<int64>(num_workers, 0));
+  }();
+  return env_num_workers;
+}
+
+bool PlanStaticMemory(const LocalExecutorParams& params) {
+  if (params.plan_static_memory) return true;
+  static const bool env_plan_static_memory = [] {
+    bool plan_static_memory;
+    Status s = ReadBoolFromEnvVar("TF_EXECUTOR_PLAN_STATIC_MEMORY", false,
+                                  &plan_static_memory);
+    if (!s.ok()) {
+      LOG(ERROR) << "Invalid TF_EXECUTOR_PLAN_STATIC_MEMORY: " << s;
+      return false;
+    }
+    return plan_static_memory;
+  }();
+  return env_plan_static_memory;
+}
+
+bool RecordMetrics(const LocalExecutorParams& params) {
+  if (params.record_metrics) return true;
+  static const bool env_record_metrics = [] {
+    bool record_metrics;
+    Status s = ReadBoolFromEnvVar("TF_EXECUTOR_RECORD_METRICS", false,
+                                  &record_metrics);
+    if (!s.ok()) {
+      LOG(ERROR) << "Invalid TF_EXECUTOR_RECORD_METRICS: " << s;
+      return false;
+    }
+    return record_metrics;
+  }();
+  return env_record_metrics;
+}
+
+// Number of nodes dispatched to an inter-op runner by any executor of the
+// process and not started yet. Only maintained when metrics are recorded.
+std::atomic<int64> num_dispatched_nodes(0);
+
+// Identifies the work-stealing worker running on the current thread, if any.
+// `state` is the ExecutorState that owns the worker, and is compared against
+// `this` so that nested executors on the same thread do not share queues.
+struct CurrentWorker {
+  const void* state = nullptr;
+  int worker_id = -1;
+};
+thread_local CurrentWorker current_worker;
+
 // Helper routines for collecting step stats.
 namespace nodestats {
 inline int64 NowInNsec() { return EnvTime::NowNanos(); }
@@ -175,19 +240,50 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
+    // Initializes the per-node state. If `cost_model` is not null, nodes with
+    // measurements in it start from their measured cost instead of from the
+    // static `OpKernel::IsExpensive()` heuristic.
+    void Initialize(const GraphView& gview, const Graph& graph,
+                    const CostModel* cost_model) {
       is_expensive_ = absl::make_unique<std::atomic<bool>[]>(gview.num_nodes());
       cost_estimates_ =
           absl::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
+      sample_counters_ =
+          absl::make_unique<std::atomic_uint_fast32_t[]>(gview.num_nodes());
       for (int32 i = 0; i < gview.num_nodes(); ++i) {
         if (gview.node(i)) {
           is_expensive_[i] =
               gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
           cost_estimates_[i] = kInitialCostEstimateCycles;
+          sample_counters_[i] = 0;
+        }
+      }
+      if (cost_model == nullptr) return;
+      const double cycles_per_micro =
+          profile_utils::CpuUtils::GetCycleCounterFrequency() / 1e6;
+      if (cycles_per_micro <= 0) return;
+      for (const Node* n : graph.nodes()) {
+        const NodeItem* item = gview.node(n->id());
+        if (item == nullptr || item->kernel == nullptr ||
+            cost_model->TotalCount(n) <= 0) {
+          continue;
         }
+        const uint64 estimate = static_cast<uint64>(
+            cost_model->TimeEstimate(n).value() * cycles_per_micro);
+        cost_estimates_[n->id()] = estimate;
+        is_expensive_[n->id()] = estimate > kOpIsExpensiveThresholdCycles;
       }
     }
 
+    // Returns true if an execution of the given inexpensive node should be
+    // timed, so that a node whose cost has grown (or was underestimated by
+    // the static heuristic) can be promoted back to "expensive".
+    bool ShouldSample(const NodeItem& node) const {
+      return (sample_counters_[node.node_id].fetch_add(
+                  1, std::memory_order_relaxed) %
+              kSampleInterval) == 0;
+    }
+
     // Returns true iff the given node is considered "expensive". The
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
@@ -201,11 +297,12 @@ class ExecutorImpl : public Executor {
     // given node is expensive. The new cost estimate is a weighted average of
     // the old cost estimate and the latest cost.
     //
-    // NOTE: We currently only expect updates to the cost estimate when
-    // `is_expensive_[node.node_id]` is true (or at least, it *was* true, when
-    // we started to execute the kernel. As a result, we expect that a kernel
-    // can only ever transition from "expensive" to "inexpensive", but not vice
-    // versa.
+    // An expensive kernel becomes inexpensive once its estimate drops below
+    // `kOpIsExpensiveThresholdCycles`. Inexpensive kernels are only timed on
+    // sampled executions (see `ShouldSample()`), and become expensive again
+    // once their estimate exceeds the threshold by `kPromotionFactor`; the gap
+    // between the two thresholds keeps a node with a borderline cost from
+    // flipping between the two modes on every step.
     void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
       // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
       // updates may result in one or more updates being ignored.  This does not
@@ -218,6 +315,9 @@ class ExecutorImpl : public Executor {
       cost_estimate.store(new_estimate, std::memory_order_relaxed);
       if (new_estimate < kOpIsExpensiveThresholdCycles) {
         is_expensive_[node.node_id].store(false, std::memory_order_relaxed);
+      } else if (new_estimate >
+                 kPromotionFactor * kOpIsExpensiveThresholdCycles) {
+        is_expensive_[node.node_id].store(true, std::memory_order_relaxed);
       }
     }
 
@@ -228,9 +328,14 @@ class ExecutorImpl : public Executor {
     static const uint64 kInitialCostEstimateCycles = 100 * 1000 * 1000;
     static const uint64 kOpIsExpensiveThresholdCycles = 5000;
     static const uint64 kCostDecay = 10;
+    static const uint64 kPromotionFactor = 4;
+    // One in every `kSampleInterval` executions of an inexpensive node is
+    // timed.
+    static const uint32 kSampleInterval = 64;
 
     std::unique_ptr<std::atomic<bool>[]> is_expensive_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
+    std::unique_ptr<std::atomic_uint_fast32_t[]> sample_counters_;
   };
 
   struct ControlFlowInfo {
@@ -286,6 +391,10 @@ class ExecutorImpl : public Executor {
   std::vector<PendingCounts::Handle> pending_ids_;
   mutable KernelStats kernel_stats_;
 
+  // Per-node cells of the kernel time sampler, indexed by node id. Empty
+  // unless RecordMetrics(params_).
+  std::vector<monitoring::SamplerCell*> kernel_time_cells_;
+
   // Root nodes (with no in edges) that should form the initial ready queue
   std::vector<const NodeItem*> root_nodes_;
 
@@ -297,6 +406,10 @@ class ExecutorImpl : public Executor {
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // If not null, the buffer reuse plan for the outputs of the graph. Shared
+  // with the per-step arenas, which may outlive the executor.
+  std::shared_ptr<const StaticMemoryPlan> memory_plan_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
 
@@ -456,7 +569,20 @@ Status ExecutorImpl::Initialize(const Graph& graph) {
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
-  kernel_stats_.Initialize(gview_);
+  kernel_stats_.Initialize(gview_, graph, params_.cost_model);
+  if (RecordMetrics(params_)) {
+    kernel_time_cells_.resize(graph.num_node_ids(), nullptr);
+    for (const Node* n : graph.nodes()) {
+      kernel_time_cells_[n->id()] =
+          metrics::GetExecutorKernelTimeCell(n->type_string());
+    }
+  }
+  if (PlanStaticMemory(params_) &&
+      params_.device->device_type() == DEVICE_CPU) {
+    std::unique_ptr<StaticMemoryPlan> memory_plan;
+    TF_RETURN_IF_ERROR(StaticMemoryPlan::Build(graph, &memory_plan));
+    memory_plan_ = std::move(memory_plan);
+  }
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
@@ -930,6 +1056,20 @@ class ExecutorState {
     int front_index_;
   };
 
+  // A ready node waiting in a work-stealing queue, together with the time at
+  // which it became ready.
+  struct QueuedNode {
+    TaggedNode tagged_node;
+    int64 scheduled_nsec;
+  };
+
+  // The per-worker queue used when work stealing is enabled. The owning
+  // worker pushes and pops at the back; other workers steal from the front.
+  struct WorkerQueue {
+    mutex mu;
+    std::deque<QueuedNode> nodes TF_GUARDED_BY(mu);
+  };
+
   struct AsyncState;
 
   const bool vlog_;  // true if VLOG_IS_ON(1). Used to check vlog cheaply.
@@ -959,9 +1099,25 @@ class ExecutorState {
   CancellationManager* cancellation_manager_;
   // If not null, use this device to schedule intra-op operation
   std::unique_ptr<DeviceBase> user_device_;
+  // If not null, the arena holding the planned outputs of this step. Owns one
+  // reference.
+  StepMemoryArena* memory_arena_ = nullptr;
   Executor::Args::Runner runner_;
   bool sync_on_finish_;
   const bool run_all_kernels_inline_;
+  // True if the executor exports the /tensorflow/core/executor/* metrics.
+  const bool record_metrics_;
+
+  // State for the work-stealing scheduling mode. When `num_workers_` is zero,
+  // every expensive ready node is dispatched to `runner_` as its own closure.
+  // Otherwise, expensive ready nodes are pushed onto `worker_queues_`, and at
+  // most `num_workers_` long-lived closures drain those queues, stealing from
+  // each other when their own queue is empty.
+  const int num_workers_;
+  std::unique_ptr<WorkerQueue[]> worker_queues_;
+  std::atomic<int> num_active_workers_{0};
+  std::atomic<int64> num_queued_nodes_{0};
+  std::atomic<uint32> next_queue_{0};
 
   // Owned.
 
@@ -1055,6 +1211,24 @@ class ExecutorState {
   // This method will clear `*ready` before returning.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Runs Process(tagged_node, scheduled_nsec) in a closure passed to
+  // `runner_`, keeping track of the runner queue depth if metrics are recorded.
+  void DispatchToRunner(const TaggedNode& tagged_node, int64 scheduled_nsec);
+
+  // Work-stealing helpers, used only when `num_workers_ > 0`.
+  //
+  // Pushes `tagged_node` onto the queue of the calling worker, or onto a
+  // round-robin chosen queue when called from outside a worker.
+  void EnqueueReady(const TaggedNode& tagged_node, int64 scheduled_nsec);
+  // Starts new workers until either all queued nodes have a worker or
+  // `num_workers_` workers are active.
+  void MaybeStartWorkers();
+  // Pops a node from the back of queue `worker_id`, or steals one from the
+  // front of another queue. Returns false if all queues are empty.
+  bool PopOrSteal(int worker_id, QueuedNode* node);
+  // The body of a worker closure.
+  void RunWorker(int worker_id);
+
   // For debugging/logging only.
   inline void MaybeMarkCompleted(FrameState* frame, int64 iter,
                                  const int node_id);
@@ -1108,7 +1282,17 @@ ExecutorState::ExecutorState(const Executor::Args& args, ExecutorImpl* impl)
       runner_(args.runner),
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
+      record_metrics_(!impl->kernel_time_cells_.empty()),
+      num_workers_(args.run_all_kernels_inline ? 0 : NumStealingWorkers(args)),
       num_outstanding_ops_(0) {
+  if (num_workers_ > 0) {
+    worker_queues_.reset(new WorkerQueue[num_workers_]);
+  }
+  if (impl_->memory_plan_ != nullptr) {
+    memory_arena_ = new StepMemoryArena(
+        impl_->memory_plan_,
+        impl_->params_.device->GetAllocator(AllocatorAttributes()));
+  }
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = impl_->params_.device;
     user_device_ = RenamedDevice::NewRenamedDevice(
@@ -1137,6 +1321,9 @@ ExecutorState::~ExecutorState() {
   if (device_context_) {
     device_context_->Unref();
   }
+  if (memory_arena_ != nullptr) {
+    memory_arena_->Unref();
+  }
   delete slice_reader_cache_;
 }
 
@@ -1345,7 +1532,7 @@ Status ExecutorState::ProcessSync(const NodeItem& item,
     s = ProcessOutputs(item, &ctx, outputs, stats);
   } else {
     // In the common case, avoid creating any tracing objects.
-    if (is_expensive) {
+    if (is_expensive || impl_->kernel_stats_.ShouldSample(item)) {
       KernelTimer timer;
       device->Compute(op_kernel, &ctx);
       impl_->kernel_stats_.UpdateCostEstimate(item, timer.ElapsedCycles());
@@ -1528,6 +1715,11 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
       nodestats::SetScheduled(stats, scheduled_nsec);
       nodestats::SetAllStart(stats);
     }
+    if (record_metrics_ && scheduled_nsec > 0) {
+      const int64 delay_nsec = nodestats::NowInNsec() - scheduled_nsec;
+      metrics::RecordExecutorNodeQueueingDelay(
+          delay_nsec > 0 ? delay_nsec / EnvTime::kMicrosToNanos : 0);
+    }
 
     if (vlog_) {
       VLOG(1) << "Process node: " << id << " step " << params.step_id << " "
@@ -1573,13 +1765,23 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
       params.is_input_dead = is_input_dead;
       params.output_attr_array = item.output_attrs();
       params.forward_from_array = item.forward_from();
+      params.output_allocator_array =
+          memory_arena_ != nullptr ? memory_arena_->OutputAllocators(id)
+                                   : nullptr;
       params.outputs_required_array = item.outputs_required.get();
 
       if (item.kernel_is_async) {
         ProcessAsync(item, params, tagged_node, first_input, stats);
         launched_asynchronously = true;
       } else {
-        s = ProcessSync(item, &params, &outputs, stats);
+        if (record_metrics_) {
+          const uint64 start_nsec = nodestats::NowInNsec();
+          s = ProcessSync(item, &params, &outputs, stats);
+          impl_->kernel_time_cells_[id]->Add(
+              (nodestats::NowInNsec() - start_nsec) / EnvTime::kMicrosToNanos);
+        } else {
+          s = ProcessSync(item, &params, &outputs, stats);
+        }
       }
     }
 
@@ -1602,7 +1804,7 @@ void ExecutorState::Process(TaggedNode tagged_node, int64 scheduled_nsec) {
         PropagateOutputs(tagged_node, &item, &outputs, &ready);
       }
       outputs.clear();
-      if (stats) {
+      if (stats || record_metrics_) {
         scheduled_nsec = nodestats::NowInNsec();
       }
       // Postprocess.
@@ -2003,7 +2205,7 @@ void ExecutorState::ScheduleReady(TaggedNodeSeq* ready,
   if (ready->empty()) return;
 
   int64 scheduled_nsec = 0;
-  if (stats_collector_) {
+  if (stats_collector_ || record_metrics_) {
     scheduled_nsec = nodestats::NowInNsec();
   }
 
@@ -2023,12 +2225,39 @@ void ExecutorState::ScheduleReady(TaggedNodeSeq* ready,
         inline_ready->push_back(tagged_node);
       }
     }
+  } else if (num_workers_ > 0) {
+    const TaggedNode* curr_expensive_node = nullptr;
+    if (inline_ready == nullptr) {
+      for (auto& tagged_node : *ready) {
+        EnqueueReady(tagged_node, scheduled_nsec);
+      }
+    } else {
+      for (auto& tagged_node : *ready) {
+        const NodeItem& item = *tagged_node.node_item;
+        if (tagged_node.is_dead || !impl_->kernel_stats_.IsExpensive(item)) {
+          inline_ready->push_back(tagged_node);
+        } else {
+          if (curr_expensive_node) {
+            EnqueueReady(*curr_expensive_node, scheduled_nsec);
+          }
+          curr_expensive_node = &tagged_node;
+        }
+      }
+      if (curr_expensive_node) {
+        if (inline_ready->empty()) {
+          inline_ready->push_back(*curr_expensive_node);
+        } else {
+          EnqueueReady(*curr_expensive_node, scheduled_nsec);
+        }
+      }
+    }
+    MaybeStartWorkers();
   } else {
     const TaggedNode* curr_expensive_node = nullptr;
     if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
       for (auto& tagged_node : *ready) {
-        runner_([=]() { Process(tagged_node, scheduled_nsec); });
+        DispatchToRunner(tagged_node, scheduled_nsec);
       }
     } else {
       for (auto& tagged_node : *ready) {
@@ -2040,8 +2269,7 @@ void ExecutorState::ScheduleReady(TaggedNodeSeq* ready,
           if (curr_expensive_node) {
             // Dispatch to another thread since there is plenty of work to
             // do for this thread.
-            runner_(std::bind(&ExecutorState::Process, this,
-                              *curr_expensive_node, scheduled_nsec));
+            DispatchToRunner(*curr_expensive_node, scheduled_nsec);
           }
           curr_expensive_node = &tagged_node;
         }
@@ -2053,14 +2281,113 @@ void ExecutorState::ScheduleReady(TaggedNodeSeq* ready,
       } else {
         // There are inline nodes to run already. We dispatch this expensive
         // node to other thread.
-        runner_(std::bind(&ExecutorState::Process, this, *curr_expensive_node,
-                          scheduled_nsec));
+        DispatchToRunner(*curr_expensive_node, scheduled_nsec);
       }
     }
   }
   ready->clear();
 }
 
+void ExecutorState::DispatchToRunner(const TaggedNode& tagged_node,
+                                     int64 scheduled_nsec) {
+  if (!record_metrics_) {
+    runner_(std::bind(&ExecutorState::Process, this, tagged_node,
+                      scheduled_nsec));
+    return;
+  }
+  metrics::RecordExecutorRunnerQueueDepth(
+      num_dispatched_nodes.fetch_add(1, std::memory_order_relaxed) + 1);
+  runner_([this, tagged_node, scheduled_nsec]() {
+    num_dispatched_nodes.fetch_sub(1, std::memory_order_relaxed);
+    Process(tagged_node, scheduled_nsec);
+  });
+}
+
+void ExecutorState::EnqueueReady(const TaggedNode& tagged_node,
+                                 int64 scheduled_nsec) {
+  int queue_id;
+  if (current_worker.state == this) {
+    queue_id = current_worker.worker_id;
+  } else {
+    queue_id = next_queue_.fetch_add(1, std::memory_order_relaxed) %
+               static_cast<uint32>(num_workers_);
+  }
+  WorkerQueue& queue = worker_queues_[queue_id];
+  {
+    mutex_lock l(queue.mu);
+    queue.nodes.push_back(QueuedNode{tagged_node, scheduled_nsec});
+  }
+  num_queued_nodes_.fetch_add(1);
+}
+
+void ExecutorState::MaybeStartWorkers() {
+  int num_active = num_active_workers_.load();
+  while (num_active < num_workers_ && num_active < num_queued_nodes_.load()) {
+    if (!num_active_workers_.compare_exchange_weak(num_active,
+                                                   num_active + 1)) {
+      continue;
+    }
+    // Each active worker holds a reference on the step, so that the
+    // ExecutorState is not destroyed while the worker is still scanning the
+    // queues after its last node completes.
+    num_outstanding_ops_.fetch_add(1, std::memory_order_relaxed);
+    // Worker ids only select a home queue, so two workers may briefly share
+    // one when a worker retires and another starts concurrently.
+    const int worker_id = num_active;
+    runner_([this, worker_id]() { RunWorker(worker_id); });
+    ++num_active;
+  }
+}
+
+bool ExecutorState::PopOrSteal(int worker_id, QueuedNode* node) {
+  if (num_queued_nodes_.load() == 0) return false;
+  {
+    WorkerQueue& queue = worker_queues_[worker_id];
+    mutex_lock l(queue.mu);
+    if (!queue.nodes.empty()) {
+      *node = queue.nodes.back();
+      queue.nodes.pop_back();
+      num_queued_nodes_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  for (int i = 1; i < num_workers_; ++i) {
+    WorkerQueue& victim = worker_queues_[(worker_id + i) % num_workers_];
+    mutex_lock l(victim.mu);
+    if (!victim.nodes.empty()) {
+      *node = victim.nodes.front();
+      victim.nodes.pop_front();
+      num_queued_nodes_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ExecutorState::RunWorker(int worker_id) {
+  const CurrentWorker saved_worker = current_worker;
+  current_worker = CurrentWorker{this, worker_id};
+  QueuedNode node{TaggedNode(nullptr, nullptr, -1, false), 0};
+  while (true) {
+    while (PopOrSteal(worker_id, &node)) {
+      Process(node.tagged_node, node.scheduled_nsec);
+    }
+    num_active_workers_.fetch_sub(1);
+    // A node may have been enqueued after the last scan but before this
+    // worker retired. Re-check and, if so, try to resume as an active worker.
+    int num_active = num_active_workers_.load();
+    if (num_queued_nodes_.load() == 0 || num_active >= num_workers_ ||
+        !num_active_workers_.compare_exchange_strong(num_active,
+                                                     num_active + 1)) {
+      break;
+    }
+  }
+  current_worker = saved_worker;
+  if (num_outstanding_ops_.fetch_sub(1) == 1) {
+    ScheduleFinish();
+  }
+}
+
 inline void ExecutorState::MaybeMarkCompleted(FrameState* frame, int64 iter,
                                               const int node_id) {
   // TODO(misard) Replace with a finer-grain enabling flag once we
@@ -31,6 +31,7 @@ limitations under the License.
 
 namespace tensorflow {
 
+class CostModel;
 class StepStatsCollector;
 
 // Executor runs a graph computation.
@@ -107,6 +108,14 @@ class Executor {
     // If true, all kernels will be treated as "inexpensive", and hence executed
     // on the scheduling thread.
     bool run_all_kernels_inline = false;
+
+    // If positive, expensive ready nodes are placed on per-worker queues that
+    // are drained by at most this many closures dispatched to "runner", with
+    // idle workers stealing nodes from busy ones, instead of dispatching one
+    // closure per node. If zero, the TF_EXECUTOR_NUM_STEALING_WORKERS
+    // environment variable is used, and work stealing is disabled if that is
+    // also unset. Ignored if `run_all_kernels_inline` is true.
+    int num_stealing_workers = 0;
   };
   typedef std::function<void(const Status&)> DoneCallback;
   virtual void RunAsync(const Args& args, DoneCallback done) = 0;
@@ -139,6 +148,25 @@ struct LocalExecutorParams {
   // The library runtime support.
   FunctionLibraryRuntime* function_library = nullptr;
 
+  // If not null, measured kernel times from a previous execution of the same
+  // graph (e.g. as collected by a CostModelManager). They are used to seed the
+  // executor's per-node cost estimates, which decide whether a ready node is
+  // run inline or dispatched to another thread.
+  const CostModel* cost_model = nullptr;
+
+  // If true and the graph is free of control flow, outputs whose shapes are
+  // statically known are placed in a per-step arena according to a buffer
+  // reuse plan computed once for the executor. Only supported for CPU
+  // devices. Also enabled by the TF_EXECUTOR_PLAN_STATIC_MEMORY environment
+  // variable.
+  bool plan_static_memory = false;
+
+  // If true, the executor exports per-node queueing delays, the depth of the
+  // inter-op runner queue and per-op kernel times through the
+  // /tensorflow/core/executor/* monitoring samplers. Also enabled by the
+  // TF_EXECUTOR_RECORD_METRICS environment variable.
+  bool record_metrics = false;
+
   // create_kernel returns an instance of op kernel based on NodeDef.
   // delete_kernel is called for every kernel used by the executor
   // when the executor is deleted.
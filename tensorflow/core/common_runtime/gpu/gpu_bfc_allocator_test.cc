@@ -24,11 +24,15 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
 #include "tensorflow/core/framework/typed_allocator.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -233,6 +237,103 @@ TEST(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   a.DeallocateRaw(first_ptr);
 }
 
+TEST(GPUBFCAllocatorTest, ChunkCache) {
+  setenv("TF_BFC_ALLOCATOR_CHUNK_CACHE_BYTES", "4096", 1);
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  GPUBFCAllocator a(sub_allocator, 1 << 30, "GPU_0_bfc");
+  unsetenv("TF_BFC_ALLOCATOR_CHUNK_CACHE_BYTES");
+
+  void* first = a.AllocateRaw(1, 1000);
+  EXPECT_EQ(1000, a.RequestedSize(first));
+  a.DeallocateRaw(first);
+  // The freed chunk is held by the cache, but is not reported as in use.
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(0, stats->num_cache_hits);
+  EXPECT_EQ(1, stats->num_cache_misses);
+
+  // A same-sized request on the same thread reuses the cached chunk, and
+  // reports its new requested size.
+  void* second = a.AllocateRaw(1, 900);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(900, a.RequestedSize(second));
+  stats = a.GetStats();
+  EXPECT_EQ(1024, stats->bytes_in_use);
+  EXPECT_EQ(2, stats->num_allocs);
+  EXPECT_EQ(1, stats->num_cache_hits);
+
+  // Allocations above the threshold bypass the cache.
+  void* large = a.AllocateRaw(1, 8192);
+  EXPECT_EQ(1, a.GetStats()->num_cache_misses);
+  a.DeallocateRaw(large);
+  a.DeallocateRaw(second);
+  EXPECT_EQ(0, a.GetStats()->bytes_in_use);
+}
+
+TEST(GPUBFCAllocatorTest, ChunkCacheIsFlushedBeforeFailing) {
+  setenv("TF_BFC_ALLOCATOR_CHUNK_CACHE_BYTES", "4096", 1);
+  PlatformGpuId platform_gpu_id(0);
+  GPUMemAllocator* sub_allocator = new GPUMemAllocator(
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
+      platform_gpu_id, false /*use_unified_memory*/, {}, {});
+  // Configure a 1MiB byte limit.
+  GPUBFCAllocator a(sub_allocator, 1 << 20, "GPU_0_bfc");
+  unsetenv("TF_BFC_ALLOCATOR_CHUNK_CACHE_BYTES");
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 4096));
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  // The whole memory limit is only available once the cached chunks have
+  // been returned to the bins and coalesced.
+  void* all = a.AllocateRaw(1, 1 << 20);
+  EXPECT_NE(nullptr, all);
+  a.DeallocateRaw(all);
+}
+
+TEST(GPUBFCAllocatorTest, VirtualMemoryAllocator) {
+  PlatformGpuId platform_gpu_id(0);
+  se::StreamExecutor* stream_exec =
+      GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie();
+  std::unique_ptr<GpuVirtualMemAllocator> sub_allocator;
+  Status status = GpuVirtualMemAllocator::Create(
+      {}, {},
+      static_cast<se::gpu::GpuContext*>(
+          stream_exec->implementation()->GpuContextHack()),
+      platform_gpu_id, 1 << 30, &sub_allocator);
+  if (errors::IsUnimplemented(status)) {
+    LOG(INFO) << "Skipping test: " << status;
+    return;
+  }
+  TF_ASSERT_OK(status);
+  GpuVirtualMemAllocator* virtual_mem_allocator = sub_allocator.get();
+  GPUOptions options;
+  options.set_allow_growth(true);
+  GPUBFCAllocator a(sub_allocator.release(), 1 << 30, options, "GPU_0_bfc");
+
+  std::vector<void*> ptrs;
+  for (int i = 0; i < 8; ++i) {
+    ptrs.push_back(a.AllocateRaw(1, 1 << 20));
+    ASSERT_NE(nullptr, ptrs.back());
+  }
+  for (void* ptr : ptrs) {
+    a.DeallocateRaw(ptr);
+  }
+  // The memory of all the regions the allocator grew by is contiguous, so
+  // it coalesces into one chunk.
+  void* all = a.AllocateRaw(1, 8 << 20);
+  EXPECT_EQ(ptrs[0], all);
+  EXPECT_GE(virtual_mem_allocator->mapped_bytes(), 8 << 20);
+  a.DeallocateRaw(all);
+}
+
 TEST(GPUBFCAllocatorTest, AllocationsAndDeallocationsWithGrowth) {
   GPUOptions options;
   options.set_allow_growth(true);
@@ -413,6 +514,38 @@ static void BM_AllocationDelayed(int iters, int delay) {
 }
 BENCHMARK(BM_AllocationDelayed)->Arg(1)->Arg(10)->Arg(100)->Arg(1000);
 
+// Hands out consecutive ranges of one host buffer, like GpuVirtualMemAllocator
+// does with its device addresses, and takes back only the end of it.
+class ContiguousSubAllocator : public SubAllocator {
+ public:
+  explicit ContiguousSubAllocator(size_t size)
+      : SubAllocator({}, {}),
+        buffer_(static_cast<char*>(port::AlignedMalloc(size, 256))),
+        size_(size) {}
+  ~ContiguousSubAllocator() override { port::AlignedFree(buffer_); }
+
+  void* Alloc(size_t alignment, size_t num_bytes) override {
+    if (num_bytes > size_ - used_) return nullptr;
+    void* ptr = buffer_ + used_;
+    used_ += num_bytes;
+    return ptr;
+  }
+
+  void Free(void* ptr, size_t num_bytes) override {
+    EXPECT_EQ(buffer_ + used_, static_cast<char*>(ptr) + num_bytes);
+    used_ -= num_bytes;
+  }
+
+  bool SupportsCoalescing() const override { return true; }
+
+  size_t used() const { return used_; }
+
+ private:
+  char* const buffer_;
+  const size_t size_;
+  size_t used_ = 0;
+};
+
 }  // namespace
 
 class GPUBFCAllocatorPrivateMethodsTest : public ::testing::Test {
@@ -633,6 +766,61 @@ class GPUBFCAllocatorPrivateMethodsTest : public ::testing::Test {
     }
     EXPECT_EQ(1, num_chunks_in_bins);
   }
+
+  void TestCoalescingSubAllocator() {
+    GPUOptions options;
+    options.set_allow_growth(true);
+    ContiguousSubAllocator* sub_allocator = new ContiguousSubAllocator(1 << 24);
+    GPUBFCAllocator a(sub_allocator, 1 << 24, options, "GPU_0_bfc");
+    auto trim = [&a]() {
+      mutex_lock l(a.lock_);
+      a.next_trim_check_us_ = 0;
+      a.MaybeTrimIdleMemory();
+    };
+
+    // The first allocation fills the initial 1MiB region, the second one
+    // extends it by 2MiB.
+    void* first = a.AllocateRaw(1, 1 << 20);
+    void* second = a.AllocateRaw(1, 1 << 20);
+    EXPECT_EQ(static_cast<char*>(first) + (1 << 20), second);
+    {
+      mutex_lock l(a.lock_);
+      ASSERT_EQ(1, a.region_manager_.regions().size());
+      EXPECT_EQ(3 << 20, a.region_manager_.regions()[0].memory_size());
+    }
+    // Once both are freed, the whole region is one chunk.
+    a.DeallocateRaw(second);
+    a.DeallocateRaw(first);
+    void* all = a.AllocateRaw(1, 3 << 20);
+    EXPECT_EQ(first, all);
+    EXPECT_EQ(3 << 20, sub_allocator->used());
+    a.DeallocateRaw(all);
+
+    // The free end of the region is only given back once nothing has been
+    // allocated from it between two checks.
+    first = a.AllocateRaw(1, 1 << 20);
+    trim();
+    EXPECT_EQ(3 << 20, sub_allocator->used());
+    trim();
+    EXPECT_EQ(1 << 20, sub_allocator->used());
+    {
+      mutex_lock l(a.lock_);
+      ASSERT_EQ(1, a.region_manager_.regions().size());
+      EXPECT_EQ(1 << 20, a.region_manager_.regions()[0].memory_size());
+    }
+
+    // Freeing everything gives back the region, which can grow again later.
+    a.DeallocateRaw(first);
+    trim();
+    EXPECT_EQ(0, sub_allocator->used());
+    {
+      mutex_lock l(a.lock_);
+      EXPECT_EQ(0, a.region_manager_.regions().size());
+    }
+    first = a.AllocateRaw(1, 1 << 20);
+    EXPECT_NE(nullptr, first);
+    a.DeallocateRaw(first);
+  }
 };
 
 TEST_F(GPUBFCAllocatorPrivateMethodsTest, BinDebugInfo) { TestBinDebugInfo(); }
@@ -649,6 +837,10 @@ TEST_F(GPUBFCAllocatorPrivateMethodsTest, TestRegionDeallocation) {
   TestRegionDeallocation();
 }
 
+TEST_F(GPUBFCAllocatorPrivateMethodsTest, CoalescingSubAllocator) {
+  TestCoalescingSubAllocator();
+}
+
 }  // namespace tensorflow
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
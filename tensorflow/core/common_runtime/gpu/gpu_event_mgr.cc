@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/platform/stacktrace.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -27,6 +28,19 @@ namespace {
 //  - Is this the right number of threads?
 //  - Should EventMgrs be shared between GPUDevices on a multi-GPU machine?
 static const int kNumThreads = 2;
+
+// Whether EventMgrs use stream host callbacks (cuLaunchHostFunc on CUDA)
+// instead of their polling loop, which is off by default.
+bool UseHostCallbacks() {
+  bool use_host_callbacks;
+  Status status = ReadBoolFromEnvVar("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS",
+                                     false, &use_host_callbacks);
+  if (!status.ok()) {
+    LOG(ERROR) << status.error_message();
+    return false;
+  }
+  return use_host_callbacks;
+}
 }  // namespace
 
 namespace gpu_event_mgr {
@@ -94,13 +108,22 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      use_host_callbacks_(UseHostCallbacks()),
       threadpool_(Env::Default(), "GPU_Event_Manager", kNumThreads) {
   gpu_event_mgr::InitThreadpoolLabels(&threadpool_);
-  StartPollingLoop();
+  if (!use_host_callbacks_) {
+    StartPollingLoop();
+  }
 }
 
 EventMgr::~EventMgr() {
   StopPollingLoop();
+  {
+    mutex_lock l(mu_);
+    while (num_pending_host_callbacks_ > 0) {
+      host_callbacks_done_.wait(l);
+    }
+  }
 
   // Events are owned by this object.
   for (auto& e : free_events_) {
@@ -165,6 +188,25 @@ void EventMgr::PollLoop() {
   polling_stopped_->Notify();
 }
 
+void EventMgr::ThenExecuteOnHostCallback(se::Stream* stream,
+                                         std::function<void()> func) {
+  {
+    mutex_lock l(mu_);
+    ++num_pending_host_callbacks_;
+  }
+  stream->ThenDoHostCallback([this, func]() {
+    threadpool_.Schedule(func);
+    mutex_lock l(mu_);
+    if (--num_pending_host_callbacks_ == 0) {
+      host_callbacks_done_.notify_all();
+    }
+  });
+  if (!stream->ok()) {
+    // The callback may never run. As with failed events, fail hard.
+    LOG(FATAL) << "Failed to enqueue an EventMgr host callback";
+  }
+}
+
 void EventMgr::QueueInUse(se::Stream* stream, InUse in_use) {
   VLOG(2) << "QueueInUse  free_events_ " << free_events_.size()
           << " used_events_ " << used_events_.size();
@@ -68,6 +68,10 @@ class EventMgr {
   // func must be brief and non-blocking since it executes in the one
   // thread used for all such callbacks and also buffer deletions.
   inline void ThenExecute(se::Stream* stream, std::function<void()> func) {
+    if (use_host_callbacks_) {
+      ThenExecuteOnHostCallback(stream, std::move(func));
+      return;
+    }
     ToFreeVector to_free;
     {
       mutex_lock l(mu_);
@@ -83,6 +87,9 @@ class EventMgr {
   friend class EventMgrFactory;
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // Whether completions are signalled by stream host callbacks rather than
+  // found by polling events. See ThenExecuteOnHostCallback.
+  const bool use_host_callbacks_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
 
@@ -121,6 +128,15 @@ class EventMgr {
   void PollEvents(bool is_dedicated_poller, ToFreeVector* to_free)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Enqueues a host callback on `stream` that schedules func on the
+  // threadpool. The driver calls it as soon as the preceding work on the
+  // stream is done, so there is no polling thread and no polling delay.
+  // Host callbacks hold up the stream while they run, which is why they only
+  // hand func over to the threadpool.
+  void ThenExecuteOnHostCallback(se::Stream* stream,
+                                 std::function<void()> func)
+      TF_LOCKS_EXCLUDED(mu_);
+
   // An internal polling loop that runs at a low frequency to clear
   // straggler Events.
   void PollLoop();
@@ -135,6 +151,10 @@ class EventMgr {
   // A FIFO queue of InUse events and associated tensors.
   std::deque<InUse> used_events_ TF_GUARDED_BY(mu_);
 
+  // The number of host callbacks enqueued that have not run yet.
+  int64 num_pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
+  condition_variable host_callbacks_done_;
+
   bool stop_polling_ TF_GUARDED_BY(mu_);
   std::unique_ptr<Notification> polling_stopped_;
 
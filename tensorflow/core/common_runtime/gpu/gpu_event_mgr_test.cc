@@ -138,6 +138,38 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Sets TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS while in scope.
+class ScopedUseHostCallbacks {
+ public:
+  explicit ScopedUseHostCallbacks(bool use_host_callbacks) {
+    setenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS",
+           use_host_callbacks ? "true" : "false", 1);
+  }
+  ~ScopedUseHostCallbacks() { unsetenv("TF_GPU_EVENT_MGR_USE_HOST_CALLBACKS"); }
+};
+
+TEST(EventMgr, HostCallbacks) {
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  ScopedUseHostCallbacks use_host_callbacks(true);
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  TEST_EventMgrHelper th(&em);
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  const int kNumCallbacks = 100;
+  std::atomic<int> counter(0);
+  Notification note;
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [&counter, &note, kNumCallbacks]() {
+      if (++counter == kNumCallbacks) note.Notify();
+    });
+  }
+  note.WaitForNotification();
+  // Nothing was left for the polling loop, which does not run.
+  EXPECT_EQ(0, th.queue_size());
+  EXPECT_EQ(0, th.free_size());
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
@@ -467,6 +499,30 @@ BENCHMARK(BM_no_ops)->Arg(4);
 BENCHMARK(BM_no_ops)->Arg(8);
 BENCHMARK(BM_no_ops)->Arg(32);
 
+// Measures the time from enqueuing func on an idle stream to func running,
+// with the polling loop or with host callbacks.
+static void BM_then_execute_latency(int iters, int use_host_callbacks) {
+  testing::StopTiming();
+#ifdef PLATFORM_GOOGLE
+  BenchmarkUseRealTime();
+#else
+  testing::UseRealTime();
+#endif  // PLATFORM_GOOGLE
+  auto stream_exec = GPUMachineManager()->ExecutorForDevice(0).ValueOrDie();
+  std::unique_ptr<se::Stream> stream(new se::Stream(stream_exec));
+  CHECK(stream);
+  stream->Init();
+  ScopedUseHostCallbacks scoped_use_host_callbacks(use_host_callbacks);
+  TEST_EventMgr em(stream_exec, GPUOptions());
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    Notification note;
+    em.ThenExecute(stream.get(), [&note]() { note.Notify(); });
+    note.WaitForNotification();
+  }
+}
+BENCHMARK(BM_then_execute_latency)->Arg(0)->Arg(1);
+
 // Benchmark functions are defined at top level.  In order to provide a real,
 // persistent GPUDevice to the following function it also needs to be at top
 // level.  But then we can't clean it up without a cuda runtime error, so we
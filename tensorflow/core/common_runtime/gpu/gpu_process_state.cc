@@ -26,6 +26,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_utils.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_init.h"
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+#include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
+#endif
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/allocator.h"
@@ -47,6 +51,12 @@ bool useCudaMallocAllocator() {
          std::strcmp(debug_allocator_str, "cuda_malloc") == 0;
 }
 
+bool useVirtualMemoryAllocator() {
+  const char* debug_allocator_str = std::getenv("TF_GPU_ALLOCATOR");
+  return debug_allocator_str != nullptr &&
+         std::strcmp(debug_allocator_str, "virtual_memory") == 0;
+}
+
 bool useCudaMemoryGuardAllocator() {
   const char* debug_allocator_str = std::getenv("TF_GPU_ALLOCATOR");
   return debug_allocator_str != nullptr &&
@@ -105,12 +115,34 @@ Allocator* GPUProcessState::GetGPUAllocator(const GPUOptions& options,
     while (bus_id >= gpu_visitors_.size()) {
       gpu_visitors_.push_back({});
     }
-    GPUMemAllocator* sub_allocator = new GPUMemAllocator(
-        GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie(),
-        platform_gpu_id,
-        (options.per_process_gpu_memory_fraction() > 1.0 ||
-         options.experimental().use_unified_memory()),
-        gpu_visitors_[bus_id], {});
+    se::StreamExecutor* stream_exec =
+        GpuIdUtil::ExecutorForPlatformGpuId(platform_gpu_id).ValueOrDie();
+    const bool use_unified_memory =
+        options.per_process_gpu_memory_fraction() > 1.0 ||
+        options.experimental().use_unified_memory();
+    SubAllocator* sub_allocator = nullptr;
+    // If true, grows and shrinks GPU memory within one range of device
+    // addresses, so that the BFC allocator can coalesce across its regions.
+    if (useVirtualMemoryAllocator() && !use_unified_memory) {
+      std::unique_ptr<GpuVirtualMemAllocator> virtual_mem_allocator;
+      Status status = GpuVirtualMemAllocator::Create(
+          gpu_visitors_[bus_id], {},
+          static_cast<se::gpu::GpuContext*>(
+              stream_exec->implementation()->GpuContextHack()),
+          platform_gpu_id, total_bytes, &virtual_mem_allocator);
+      if (status.ok()) {
+        LOG(INFO) << "Using virtual memory allocator for GPU.";
+        sub_allocator = virtual_mem_allocator.release();
+      } else {
+        LOG(WARNING) << "Not using virtual memory allocator for GPU: "
+                     << status;
+      }
+    }
+    if (sub_allocator == nullptr) {
+      sub_allocator =
+          new GPUMemAllocator(stream_exec, platform_gpu_id, use_unified_memory,
+                              gpu_visitors_[bus_id], {});
+    }
     GPUBFCAllocator* gpu_bfc_allocator =
         new GPUBFCAllocator(sub_allocator, total_bytes, options,
                             strings::StrCat("GPU_", tf_gpu_id.value(), "_bfc"));
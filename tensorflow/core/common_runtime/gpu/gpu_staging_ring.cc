@@ -0,0 +1,227 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_ring.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <unordered_map>
+
+#include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// The chunk sizes the rings choose from. Each staging buffer holds the
+// largest one.
+constexpr int64 kChunkSizes[] = {1 << 20, 4 << 20, 16 << 20};
+constexpr int64 kMaxChunkSize = 16 << 20;
+
+// How many copies try each chunk size before a ring settles on one.
+constexpr int kCopiesPerChunkSize = 4;
+
+}  // namespace
+
+// static
+GpuStagingRing* GpuStagingRing::ForStream(se::Stream* stream,
+                                          Allocator* host_allocator) {
+  static mutex* mu = new mutex;
+  static auto* rings = new std::unordered_map<se::Stream*, GpuStagingRing*>;
+  mutex_lock l(*mu);
+  GpuStagingRing*& ring = (*rings)[stream];
+  if (ring == nullptr) {
+    ring = new GpuStagingRing(stream, host_allocator);
+  }
+  return ring;
+}
+
+// static
+bool GpuStagingRing::ShouldStage(int64 num_bytes) {
+  static const int64 min_bytes = [] {
+    int64 value;
+    Status status =
+        ReadInt64FromEnvVar("TF_GPU_STAGED_COPY_MIN_BYTES", 0, &value);
+    if (!status.ok()) {
+      LOG(ERROR) << status.error_message();
+      return int64{0};
+    }
+    return value;
+  }();
+  return min_bytes > 0 && num_bytes >= min_bytes;
+}
+
+GpuStagingRing::GpuStagingRing(se::Stream* stream, Allocator* host_allocator)
+    : stream_(stream), host_allocator_(host_allocator) {}
+
+GpuStagingRing::~GpuStagingRing() {
+  mutex_lock l(mu_);
+  for (Slot& slot : slots_) {
+    if (slot.busy) {
+      WaitForSlot(&slot).IgnoreError();
+    }
+    if (slot.buffer != nullptr) {
+      host_allocator_->DeallocateRaw(slot.buffer);
+    }
+  }
+}
+
+Status GpuStagingRing::InitSlotsLocked() {
+  for (Slot& slot : slots_) {
+    if (slot.buffer != nullptr) continue;
+    slot.event.reset(new se::Event(stream_->parent()));
+    if (!slot.event->Init()) {
+      return errors::Internal("Failed to create an event for a GPU staging "
+                              "buffer.");
+    }
+    slot.buffer = host_allocator_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                               kMaxChunkSize);
+    if (slot.buffer == nullptr) {
+      return errors::ResourceExhausted(
+          "Failed to allocate a GPU staging buffer of ", kMaxChunkSize,
+          " bytes from ", host_allocator_->Name());
+    }
+  }
+  return Status::OK();
+}
+
+Status GpuStagingRing::WaitForSlot(Slot* slot) {
+  if (!slot->busy) return Status::OK();
+  // A chunk takes a few hundred microseconds to copy, too short to sleep on.
+  while (true) {
+    switch (slot->event->PollForStatus()) {
+      case se::Event::Status::kComplete:
+        slot->busy = false;
+        return Status::OK();
+      case se::Event::Status::kPending:
+        std::this_thread::yield();
+        break;
+      default:
+        return errors::Internal("Failed to wait for a GPU staging buffer.");
+    }
+  }
+}
+
+int GpuStagingRing::ChooseChunkSizeLocked() {
+  if (tuned_chunk_size_index_ >= 0) return tuned_chunk_size_index_;
+  return num_trials_++ % kNumChunkSizes;
+}
+
+void GpuStagingRing::RecordCopyLocked(const char* direction,
+                                      int chunk_size_index, int64 num_bytes,
+                                      int64 duration_us) {
+  metrics::RecordGpuStagedCopy(direction, kChunkSizes[chunk_size_index],
+                               num_bytes, duration_us);
+  if (tuned_chunk_size_index_ >= 0) return;
+  ChunkSizeStats& stats = stats_[chunk_size_index];
+  ++stats.num_copies;
+  stats.num_bytes += num_bytes;
+  stats.duration_us += std::max<int64>(1, duration_us);
+  int fastest = 0;
+  for (int i = 0; i < kNumChunkSizes; ++i) {
+    if (stats_[i].num_copies < kCopiesPerChunkSize) return;
+    const double bandwidth =
+        static_cast<double>(stats_[i].num_bytes) / stats_[i].duration_us;
+    const double fastest_bandwidth =
+        static_cast<double>(stats_[fastest].num_bytes) /
+        stats_[fastest].duration_us;
+    if (bandwidth > fastest_bandwidth) fastest = i;
+  }
+  tuned_chunk_size_index_ = fastest;
+  VLOG(1) << "Copies through the staging ring of stream " << stream_
+          << " use chunks of " << kChunkSizes[fastest] << " bytes";
+}
+
+Status GpuStagingRing::CopyHostToDevice(const void* src,
+                                        se::DeviceMemoryBase* dst,
+                                        int64 num_bytes) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(InitSlotsLocked());
+  const int chunk_size_index = ChooseChunkSizeLocked();
+  const int64 chunk_size = kChunkSizes[chunk_size_index];
+  const uint64 start_us = Env::Default()->NowMicros();
+  int slot_index = 0;
+  for (int64 offset = 0; offset < num_bytes; offset += chunk_size) {
+    const int64 size = std::min(chunk_size, num_bytes - offset);
+    Slot& slot = slots_[slot_index];
+    slot_index = (slot_index + 1) % kNumSlots;
+    TF_RETURN_IF_ERROR(WaitForSlot(&slot));
+    memcpy(slot.buffer, static_cast<const char*>(src) + offset, size);
+    se::DeviceMemoryBase dst_chunk(static_cast<char*>(dst->opaque()) + offset,
+                                   size);
+    stream_->ThenMemcpy(&dst_chunk, slot.buffer, size);
+    stream_->ThenRecordEvent(slot.event.get());
+    slot.busy = true;
+  }
+  // While tuning, wait for the last chunk too, so that the time covers all
+  // of the copy. Otherwise the last chunk overlaps whatever the caller does
+  // next.
+  if (tuned_chunk_size_index_ < 0) {
+    for (Slot& slot : slots_) {
+      TF_RETURN_IF_ERROR(WaitForSlot(&slot));
+    }
+  }
+  if (!stream_->ok()) {
+    return errors::Internal("CPU->GPU staged memcpy failed.");
+  }
+  RecordCopyLocked("host_to_device", chunk_size_index, num_bytes,
+                   Env::Default()->NowMicros() - start_us);
+  return Status::OK();
+}
+
+Status GpuStagingRing::CopyDeviceToHost(const se::DeviceMemoryBase& src,
+                                        void* dst, int64 num_bytes) {
+  mutex_lock l(mu_);
+  TF_RETURN_IF_ERROR(InitSlotsLocked());
+  const int chunk_size_index = ChooseChunkSizeLocked();
+  const int64 chunk_size = kChunkSizes[chunk_size_index];
+  const int64 num_chunks = (num_bytes + chunk_size - 1) / chunk_size;
+  const uint64 start_us = Env::Default()->NowMicros();
+  // Enqueue the DMA of chunk i, then copy chunk i - 1 out of the other slot
+  // while it runs.
+  for (int64 i = 0; i <= num_chunks; ++i) {
+    if (i < num_chunks) {
+      const int64 offset = i * chunk_size;
+      const int64 size = std::min(chunk_size, num_bytes - offset);
+      Slot& slot = slots_[i % kNumSlots];
+      TF_RETURN_IF_ERROR(WaitForSlot(&slot));
+      se::DeviceMemoryBase src_chunk(
+          static_cast<char*>(const_cast<void*>(src.opaque())) + offset, size);
+      stream_->ThenMemcpy(slot.buffer, src_chunk, size);
+      stream_->ThenRecordEvent(slot.event.get());
+      slot.busy = true;
+    }
+    if (i > 0) {
+      const int64 offset = (i - 1) * chunk_size;
+      const int64 size = std::min(chunk_size, num_bytes - offset);
+      Slot& slot = slots_[(i - 1) % kNumSlots];
+      TF_RETURN_IF_ERROR(WaitForSlot(&slot));
+      if (!stream_->ok()) {
+        return errors::Internal("GPU->CPU staged memcpy failed.");
+      }
+      memcpy(static_cast<char*>(dst) + offset, slot.buffer, size);
+    }
+  }
+  RecordCopyLocked("device_to_host", chunk_size_index, num_bytes,
+                   Env::Default()->NowMicros() - start_us);
+  return Status::OK();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,118 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_RING_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_RING_H_
+
+#include <memory>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// Copies large buffers between pageable host memory and a GPU through two
+// pinned host buffers, one chunk at a time.
+//
+// A copy from or to pageable memory makes the driver stage it through pinned
+// memory of its own, synchronously and in small pieces. Here the host memcpy
+// of one chunk into (or out of) one staging buffer overlaps the DMA of the
+// previous chunk through the other one.
+//
+// The chunk size is tuned per ring: the first copies try each candidate size
+// in turn, and later copies use the one that reached the highest bandwidth.
+// The bytes and time of every copy are recorded per direction and chunk size
+// in /tensorflow/core/gpu/staged_copy/{bytes,usecs}.
+//
+// There is one ring per copy stream, which lives as long as the process, like
+// the streams of GPU devices. Copies through one ring run one at a time.
+// Thread-safe.
+class GpuStagingRing {
+ public:
+  // Returns the ring of `stream`, which allocates its buffers from
+  // `host_allocator` when first used. `host_allocator` must return memory
+  // pinned for `stream`, like GPUProcessState::GetGpuHostAllocator.
+  static GpuStagingRing* ForStream(se::Stream* stream,
+                                   Allocator* host_allocator);
+
+  // Returns whether to copy a buffer of `num_bytes` through a staging ring,
+  // which is when it holds at least TF_GPU_STAGED_COPY_MIN_BYTES bytes. Off
+  // by default, as it only pays off for pageable memory and costs an extra
+  // host memcpy for tensors that are already pinned.
+  static bool ShouldStage(int64 num_bytes);
+
+  ~GpuStagingRing();
+
+  // Enqueues a copy of `num_bytes` from `src` to `dst` on the stream, after
+  // the work already enqueued on it. Returns once `src` has been read, which
+  // may be before `dst` is written.
+  Status CopyHostToDevice(const void* src, se::DeviceMemoryBase* dst,
+                          int64 num_bytes);
+
+  // Copies `num_bytes` from `src` to `dst` on the stream, after the work
+  // already enqueued on it. Blocks until `dst` is written.
+  Status CopyDeviceToHost(const se::DeviceMemoryBase& src, void* dst,
+                          int64 num_bytes);
+
+ private:
+  // A staging buffer, and the event recorded after the last DMA that uses it.
+  struct Slot {
+    void* buffer = nullptr;
+    std::unique_ptr<se::Event> event;
+    bool busy = false;
+  };
+
+  // How a chunk size did in the copies that tried it.
+  struct ChunkSizeStats {
+    int64 num_copies = 0;
+    int64 num_bytes = 0;
+    int64 duration_us = 0;
+  };
+
+  static constexpr int kNumSlots = 2;
+  static constexpr int kNumChunkSizes = 3;
+
+  GpuStagingRing(se::Stream* stream, Allocator* host_allocator);
+
+  Status InitSlotsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Blocks until the last DMA through `slot` is done.
+  Status WaitForSlot(Slot* slot);
+
+  // Returns the index of the chunk size for the next copy, and records how
+  // long a copy took with it.
+  int ChooseChunkSizeLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void RecordCopyLocked(const char* direction, int chunk_size_index,
+                        int64 num_bytes, int64 duration_us)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  se::Stream* const stream_;
+  Allocator* const host_allocator_;
+
+  mutex mu_;
+  Slot slots_[kNumSlots] TF_GUARDED_BY(mu_);
+  ChunkSizeStats stats_[kNumChunkSizes] TF_GUARDED_BY(mu_);
+  int num_trials_ TF_GUARDED_BY(mu_) = 0;
+  // The index of the fastest chunk size, once all of them have been tried.
+  int tuned_chunk_size_index_ TF_GUARDED_BY(mu_) = -1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuStagingRing);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STAGING_RING_H_
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 
+#include <map>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -26,6 +27,59 @@ limitations under the License.
 
 namespace tensorflow {
 namespace gpu_stream_util {
+namespace {
+
+// The largest graph AssignStreamsByDependencies tracks the ancestors of every
+// node for, which takes 8MB.
+constexpr int kMaxNodesForDependencies = 8192;
+
+// Returns the stream `opts` puts all nodes of type `op` on, or -1.
+int OverrideStream(const AssignStreamsOpts& opts, const string& op) {
+  if (op == "_Send") return opts.send_stream;
+  if (op == "_Recv") return opts.recv_stream;
+  if (op == "Const") return opts.const_stream;
+  return opts.compute_stream;
+}
+
+// Fills in assignment->node_to_waits for the streams in
+// assignment->node_to_stream_id.
+void AddCrossStreamWaits(const Graph& graph, const std::vector<Node*>& order,
+                         int max_streams, StreamAssignment* assignment) {
+  std::vector<int> position(graph.num_node_ids());
+  for (int i = 0; i < order.size(); ++i) position[order[i]->id()] = i;
+  // waited[s][t] is the position of the latest node on stream t that the
+  // nodes on stream s already wait for. Work on one stream runs in order,
+  // so waiting for a node also waits for all earlier nodes on its stream.
+  std::vector<std::vector<int>> waited(max_streams,
+                                       std::vector<int>(max_streams, -1));
+  for (Node* n : order) {
+    if (!n->IsOp()) continue;
+    const int stream = assignment->node_to_stream_id[n->id()];
+    // The latest input on each other stream.
+    std::map<int, const Node*> latest_inputs;
+    for (const Edge* e : n->in_edges()) {
+      const Node* src = e->src();
+      if (!src->IsOp()) continue;
+      // Back edges of loops are synchronized by the executor's frames.
+      if (position[src->id()] >= position[n->id()]) continue;
+      const int src_stream = assignment->node_to_stream_id[src->id()];
+      if (src_stream == stream ||
+          position[src->id()] <= waited[stream][src_stream]) {
+        continue;
+      }
+      const Node*& latest = latest_inputs[src_stream];
+      if (latest == nullptr || position[latest->id()] < position[src->id()]) {
+        latest = src;
+      }
+    }
+    for (const auto& it : latest_inputs) {
+      assignment->node_to_waits[n->id()].push_back(it.second->id());
+      waited[stream][it.first] = position[it.second->id()];
+    }
+  }
+}
+
+}  // namespace
 
 Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
                      std::unordered_map<int, int>* node_to_stream_id) {
@@ -108,5 +162,80 @@ Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
   return Status::OK();
 }
 
+Status AssignStreamsByDependencies(const Graph* graph,
+                                   const AssignStreamsOpts& opts,
+                                   StreamAssignment* assignment) {
+  if (assignment == nullptr) {
+    return errors::InvalidArgument("Bad assignment argument supplied.");
+  }
+  assignment->node_to_stream_id.clear();
+  assignment->node_to_waits.clear();
+  if (graph != nullptr && graph->num_node_ids() > kMaxNodesForDependencies) {
+    VLOG(1) << "Assigning streams to " << graph->num_node_ids()
+            << " nodes without tracking dependencies";
+    TF_RETURN_IF_ERROR(
+        AssignStreams(graph, opts, &assignment->node_to_stream_id));
+    std::vector<Node*> order;
+    GetReversePostOrder(*graph, &order);
+    AddCrossStreamWaits(*graph, order, opts.max_streams, assignment);
+    return Status::OK();
+  }
+  // Checks the arguments like AssignStreams.
+  std::unordered_map<int, int> unused;
+  TF_RETURN_IF_ERROR(AssignStreams(graph, opts, &unused));
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order);
+  // ancestors[id] has bit i set if node i is an ancestor of node id.
+  const int num_words = (graph->num_node_ids() + 63) / 64;
+  std::vector<std::vector<uint64>> ancestors(graph->num_node_ids());
+  // The id of the last node on each stream so far, or -1.
+  std::vector<int> last_nodes(opts.max_streams, -1);
+  for (Node* n : order) {
+    std::vector<uint64>& n_ancestors = ancestors[n->id()];
+    n_ancestors.assign(num_words, 0);
+    for (const Edge* e : n->in_edges()) {
+      const int src = e->src()->id();
+      const std::vector<uint64>& src_ancestors = ancestors[src];
+      // Skip the back edges of loops.
+      if (src_ancestors.empty()) continue;
+      for (int w = 0; w < num_words; ++w) n_ancestors[w] |= src_ancestors[w];
+      n_ancestors[src / 64] |= uint64{1} << (src % 64);
+    }
+
+    int stream = OverrideStream(opts, n->type_string());
+    if (stream < 0) {
+      // A stream is free for n if its last node is an ancestor of n, so that
+      // n does not hold up work that could run concurrently with it. Unless
+      // some node had to go to a stream that was not free for it, all the
+      // earlier nodes on the stream are then ancestors of n too.
+      std::vector<bool> free(opts.max_streams);
+      for (int s = 0; s < opts.max_streams; ++s) {
+        const int last = last_nodes[s];
+        free[s] = last < 0 || ((n_ancestors[last / 64] >> (last % 64)) & 1);
+      }
+      int first_input_stream = -1;
+      for (const Edge* e : n->in_edges()) {
+        auto it = assignment->node_to_stream_id.find(e->src()->id());
+        if (it == assignment->node_to_stream_id.end()) continue;
+        const int input_stream = it->second;
+        if (first_input_stream < 0) first_input_stream = input_stream;
+        if (free[input_stream]) {
+          stream = input_stream;
+          break;
+        }
+      }
+      for (int s = 0; stream < 0 && s < opts.max_streams; ++s) {
+        if (free[s]) stream = s;
+      }
+      if (stream < 0) stream = std::max(first_input_stream, 0);
+    }
+    assignment->node_to_stream_id[n->id()] = stream;
+    last_nodes[stream] = n->id();
+  }
+  AddCrossStreamWaits(*graph, order, opts.max_streams, assignment);
+  return Status::OK();
+}
+
 }  // namespace gpu_stream_util
 }  // namespace tensorflow
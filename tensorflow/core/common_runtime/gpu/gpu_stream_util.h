@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
 
 #include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
@@ -39,6 +40,33 @@ struct AssignStreamsOpts {
 Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
                      std::unordered_map<int, int>* node_to_stream_id);
 
+// Streams for the nodes of a graph, and the cross-stream dependencies that
+// must be synchronized with events to run the nodes on them.
+struct StreamAssignment {
+  std::unordered_map<int, int> node_to_stream_id;
+  // The ids of the nodes on other streams that a node must wait for before
+  // it can be enqueued on its own stream. Only lists the latest node on each
+  // other stream, and only when the node's stream did not wait for that node
+  // or a later one on the same stream already.
+  std::unordered_map<int, std::vector<int>> node_to_waits;
+};
+
+// Like AssignStreams, but maps independent branches of the graph onto
+// different streams, like XLA's GPU stream assignment does for compiled code.
+//
+// Nodes are visited in topological order, and each goes to a stream holding
+// only nodes it depends on, so that nodes that could run concurrently don't
+// share a stream. Among those streams, the stream of one of its inputs is
+// preferred, to save a cross-stream wait. Once all `opts.max_streams` streams
+// hold a node that could run concurrently with it, a node goes to the stream
+// of its first input. The op type overrides of `opts` apply as before.
+//
+// Telling which nodes can run concurrently takes memory quadratic in the
+// number of nodes, so large graphs are assigned with AssignStreams instead.
+Status AssignStreamsByDependencies(const Graph* graph,
+                                   const AssignStreamsOpts& opts,
+                                   StreamAssignment* assignment);
+
 }  // namespace gpu_stream_util
 }  // namespace tensorflow
 
@@ -144,5 +144,99 @@ TEST_F(GpuStreamUtilTest, StreamOverrides) {
   }
 }
 
+// Returns the stream of each node of `g` by name.
+std::unordered_map<string, int> StreamsByName(
+    const Graph& g, const gpu_stream_util::StreamAssignment& assignment) {
+  std::unordered_map<string, int> streams;
+  for (const Node* n : g.op_nodes()) {
+    streams[n->name()] = assignment.node_to_stream_id.at(n->id());
+  }
+  return streams;
+}
+
+// Returns the names of the nodes that `name` waits for.
+std::vector<string> WaitsByName(
+    const Graph& g, const gpu_stream_util::StreamAssignment& assignment,
+    const string& name) {
+  std::vector<string> waits;
+  for (const Node* n : g.op_nodes()) {
+    if (n->name() != name) continue;
+    auto it = assignment.node_to_waits.find(n->id());
+    if (it == assignment.node_to_waits.end()) break;
+    for (int id : it->second) waits.push_back(g.FindNodeId(id)->name());
+  }
+  return waits;
+}
+
+TEST_F(GpuStreamUtilTest, DependenciesSplitIndependentBranches) {
+  auto root = Scope::NewRootScope().ExitOnError();
+  auto x = ops::Const(root.WithOpName("x"), 2.0f);
+  auto a = ops::Square(root.WithOpName("a"), x);
+  auto b = ops::Sqrt(root.WithOpName("b"), x);
+  ops::Add(root.WithOpName("c"), a, b);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&g));
+
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 4;
+  gpu_stream_util::StreamAssignment assignment;
+  TF_ASSERT_OK(
+      gpu_stream_util::AssignStreamsByDependencies(&g, opts, &assignment));
+  std::unordered_map<string, int> streams = StreamsByName(g, assignment);
+
+  // a and b can run concurrently, c joins them on one of their streams.
+  EXPECT_NE(streams["a"], streams["b"]);
+  const string joined = streams["c"] == streams["a"] ? "b" : "a";
+  const string other = joined == "a" ? "b" : "a";
+  EXPECT_EQ(streams["c"], streams[other]);
+  EXPECT_EQ(WaitsByName(g, assignment, "c"), std::vector<string>({joined}));
+  // The branch on x's stream doesn't wait for it, the other one does.
+  const string& new_branch = streams["a"] == streams["x"] ? "b" : "a";
+  EXPECT_EQ(WaitsByName(g, assignment, new_branch),
+            std::vector<string>({"x"}));
+  EXPECT_TRUE(WaitsByName(g, assignment, "x").empty());
+}
+
+TEST_F(GpuStreamUtilTest, DependenciesKeepChainsOnOneStream) {
+  auto root = Scope::NewRootScope().ExitOnError();
+  auto x = ops::Const(root.WithOpName("x"), 2.0f);
+  auto a = ops::Square(root.WithOpName("a"), x);
+  auto b = ops::Square(root.WithOpName("b"), a);
+  ops::Square(root.WithOpName("c"), b);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&g));
+
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.max_streams = 4;
+  gpu_stream_util::StreamAssignment assignment;
+  TF_ASSERT_OK(
+      gpu_stream_util::AssignStreamsByDependencies(&g, opts, &assignment));
+  std::unordered_map<string, int> streams = StreamsByName(g, assignment);
+  EXPECT_EQ(streams["x"], streams["a"]);
+  EXPECT_EQ(streams["a"], streams["b"]);
+  EXPECT_EQ(streams["b"], streams["c"]);
+  EXPECT_TRUE(assignment.node_to_waits.empty());
+}
+
+TEST_F(GpuStreamUtilTest, DependenciesWithOneStream) {
+  auto root = Scope::NewRootScope().ExitOnError();
+  auto x = ops::Const(root.WithOpName("x"), 2.0f);
+  auto a = ops::Square(root.WithOpName("a"), x);
+  auto b = ops::Sqrt(root.WithOpName("b"), x);
+  ops::Add(root.WithOpName("c"), a, b);
+  Graph g(OpRegistry::Global());
+  TF_ASSERT_OK(root.ToGraph(&g));
+
+  gpu_stream_util::AssignStreamsOpts opts;
+  gpu_stream_util::StreamAssignment assignment;
+  TF_ASSERT_OK(
+      gpu_stream_util::AssignStreamsByDependencies(&g, opts, &assignment));
+  EXPECT_EQ(6, assignment.node_to_stream_id.size());
+  for (const auto& it : assignment.node_to_stream_id) {
+    EXPECT_EQ(0, it.second);
+  }
+  EXPECT_TRUE(assignment.node_to_waits.empty());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_staging_ring.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.pb.h"
@@ -276,6 +277,28 @@ void GPUUtil::CopyGPUTensorToCPU(Device* gpu_device,
   send_device_to_host_stream->ThenWaitFor(send_stream);
 
   const int64 total_bytes = gpu_tensor->TotalBytes();
+  if (GpuStagingRing::ShouldStage(total_bytes)) {
+    // The staged copy blocks until the data is on the host, so run it once
+    // the sender's main stream is done rather than here.
+    GpuStagingRing* ring = GpuStagingRing::ForStream(
+        send_device_to_host_stream,
+        GPUProcessState::singleton()->GetGpuHostAllocator(0));
+    void* src_ptr = GetBase(gpu_tensor);
+    void* dst_ptr = GetBase(cpu_tensor);
+    TensorReference input_ref(*gpu_tensor);
+    dev_info->event_mgr->ThenExecute(
+        send_device_to_host_stream,
+        [ring, src_ptr, dst_ptr, total_bytes, done, input_ref]() {
+          Status s = ring->CopyDeviceToHost(
+              DeviceMemoryBase(src_ptr, total_bytes), dst_ptr, total_bytes);
+          if (!s.ok()) {
+            LOG(FATAL) << "GPU->CPU staged memcpy failed: " << s;
+          }
+          input_ref.Unref();
+          done(Status::OK());
+        });
+    return;
+  }
   if (total_bytes > 0) {
     void* src_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_src_ptr(src_ptr, total_bytes);
@@ -328,7 +351,18 @@ void GPUUtil::CopyCPUTensorToGPU(const Tensor* cpu_tensor,
     void* src_ptr = GetBase(cpu_tensor);
     void* dst_ptr = GetBase(gpu_tensor);
     DeviceMemoryBase gpu_dst_ptr(dst_ptr, total_bytes);
-    recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr, total_bytes);
+    if (GpuStagingRing::ShouldStage(total_bytes)) {
+      s = GpuStagingRing::ForStream(
+              recv_host_to_device_stream,
+              GPUProcessState::singleton()->GetGpuHostAllocator(0))
+              ->CopyHostToDevice(src_ptr, &gpu_dst_ptr, total_bytes);
+      if (!s.ok()) {
+        LOG(FATAL) << "CPU->GPU staged memcpy failed: " << s;
+      }
+    } else {
+      recv_host_to_device_stream->ThenMemcpy(&gpu_dst_ptr, src_ptr,
+                                             total_bytes);
+    }
   }
   // Use of cpu_tensor may outlive stack scope, so keep a ref.
   TensorReference input_ref(*cpu_tensor);
@@ -0,0 +1,180 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include "tensorflow/core/common_runtime/gpu/gpu_virtual_mem_allocator.h"
+
+#include <iterator>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+using se::gpu::GpuDriver;
+
+// static
+Status GpuVirtualMemAllocator::Create(
+    const std::vector<Visitor>& alloc_visitors,
+    const std::vector<Visitor>& free_visitors,
+    se::gpu::GpuContext* gpu_context, PlatformGpuId gpu_id,
+    size_t virtual_address_space_size,
+    std::unique_ptr<GpuVirtualMemAllocator>* allocator) {
+  auto page_size_or = GpuDriver::GetMinAllocationGranularity(gpu_context);
+  if (!page_size_or.ok()) {
+    return errors::Unimplemented(
+        "GPU virtual memory management is not available: ",
+        page_size_or.status().error_message());
+  }
+  const size_t page_size = page_size_or.ValueOrDie();
+  const size_t size = (virtual_address_space_size + page_size - 1) /
+                      page_size * page_size;
+  auto base_or = GpuDriver::ReserveVirtualMemory(gpu_context, size);
+  if (!base_or.ok()) {
+    return errors::ResourceExhausted(base_or.status().error_message());
+  }
+  VLOG(1) << "Reserved " << strings::HumanReadableNumBytes(size)
+          << " of device addresses for GPU " << gpu_id.value()
+          << ", mapped in pages of "
+          << strings::HumanReadableNumBytes(page_size);
+  allocator->reset(new GpuVirtualMemAllocator(alloc_visitors, free_visitors,
+                                              gpu_context, gpu_id,
+                                              base_or.ValueOrDie(), size,
+                                              page_size));
+  return Status::OK();
+}
+
+GpuVirtualMemAllocator::GpuVirtualMemAllocator(
+    const std::vector<Visitor>& alloc_visitors,
+    const std::vector<Visitor>& free_visitors,
+    se::gpu::GpuContext* gpu_context, PlatformGpuId gpu_id,
+    se::gpu::GpuDevicePtr base, size_t size, size_t page_size)
+    : SubAllocator(alloc_visitors, free_visitors),
+      gpu_context_(gpu_context),
+      gpu_id_(gpu_id),
+      base_(base),
+      size_(size),
+      page_size_(page_size),
+      pages_(size / page_size) {}
+
+GpuVirtualMemAllocator::~GpuVirtualMemAllocator() {
+  for (size_t page = 0; page < pages_.size(); ++page) {
+    if (pages_[page].bytes > 0) {
+      UnmapPage(page);
+    }
+  }
+  GpuDriver::FreeVirtualMemory(gpu_context_, base_, size_);
+}
+
+bool GpuVirtualMemAllocator::MapPages(size_t first_page, size_t last_page) {
+  std::vector<size_t> mapped;
+  for (size_t page = first_page; page <= last_page; ++page) {
+    if (pages_[page].bytes > 0) continue;
+    auto handle_or = GpuDriver::CreateMemoryHandle(gpu_context_, page_size_);
+    Status status = handle_or.status();
+    if (status.ok()) {
+      status = GpuDriver::MapMemory(gpu_context_, base_ + page * page_size_,
+                                    handle_or.ValueOrDie());
+      if (!status.ok()) {
+        GpuDriver::ReleaseMemoryHandle(gpu_context_, handle_or.ValueOrDie());
+      }
+    }
+    if (!status.ok()) {
+      VLOG(1) << "Failed to map device memory on GPU " << gpu_id_.value()
+              << ": " << status.error_message();
+      for (size_t mapped_page : mapped) {
+        UnmapPage(mapped_page);
+      }
+      return false;
+    }
+    pages_[page] = handle_or.ValueOrDie();
+    ++num_mapped_pages_;
+    mapped.push_back(page);
+  }
+  return true;
+}
+
+void GpuVirtualMemAllocator::UnmapPage(size_t page) {
+  GpuDriver::UnmapMemory(gpu_context_, base_ + page * page_size_, page_size_);
+  GpuDriver::ReleaseMemoryHandle(gpu_context_, pages_[page]);
+  pages_[page] = GpuDriver::GenericMemoryHandle();
+  --num_mapped_pages_;
+}
+
+void* GpuVirtualMemAllocator::Alloc(size_t alignment, size_t num_bytes) {
+  if (num_bytes == 0) return nullptr;
+  size_t offset = next_alloc_offset_;
+  if (alignment > 0 && (base_ + offset) % alignment != 0) {
+    offset += alignment - (base_ + offset) % alignment;
+  }
+  if (offset > size_ || num_bytes > size_ - offset) {
+    VLOG(1) << "Out of reserved device addresses on GPU " << gpu_id_.value()
+            << " for " << num_bytes << " bytes";
+    return nullptr;
+  }
+  if (!MapPages(offset / page_size_, (offset + num_bytes - 1) / page_size_)) {
+    return nullptr;
+  }
+  allocated_ranges_[offset] = num_bytes;
+  next_alloc_offset_ = offset + num_bytes;
+  void* ptr = reinterpret_cast<void*>(base_ + offset);
+  VisitAlloc(ptr, gpu_id_.value(), num_bytes);
+  return ptr;
+}
+
+void GpuVirtualMemAllocator::Free(void* ptr, size_t num_bytes) {
+  if (ptr == nullptr) return;
+  VisitFree(ptr, gpu_id_.value(), num_bytes);
+  const size_t offset = reinterpret_cast<se::gpu::GpuDevicePtr>(ptr) - base_;
+  const size_t end = offset + num_bytes;
+  DCHECK_LE(end, size_);
+  auto it = allocated_ranges_.lower_bound(offset);
+  DCHECK(it != allocated_ranges_.end() && it->first == offset)
+      << "Freeing " << ptr << ", which was not allocated";
+  while (it != allocated_ranges_.end() && it->first < end) {
+    DCHECK_LE(it->first + it->second, end)
+        << "Freeing part of an allocated range";
+    it = allocated_ranges_.erase(it);
+  }
+
+  // Keep the first and last pages if the neighbouring ranges still use them.
+  const size_t first_page = offset / page_size_;
+  const size_t last_page = (end - 1) / page_size_;
+  const bool keep_first =
+      it != allocated_ranges_.begin() &&
+      std::prev(it)->first + std::prev(it)->second > first_page * page_size_;
+  const bool keep_last = it != allocated_ranges_.end() &&
+                         it->first < (last_page + 1) * page_size_;
+  for (size_t page = first_page; page <= last_page; ++page) {
+    if ((page == first_page && keep_first) ||
+        (page == last_page && keep_last)) {
+      continue;
+    }
+    if (pages_[page].bytes > 0) UnmapPage(page);
+  }
+
+  next_alloc_offset_ =
+      allocated_ranges_.empty()
+          ? 0
+          : allocated_ranges_.rbegin()->first +
+                allocated_ranges_.rbegin()->second;
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
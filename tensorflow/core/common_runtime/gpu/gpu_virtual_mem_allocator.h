@@ -0,0 +1,110 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/gpu/gpu_id.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+
+namespace tensorflow {
+
+// Suballocator for GPU memory that hands out consecutive ranges of one
+// reserved range of device addresses, and maps physical memory at them page
+// by page as they are allocated.
+//
+// Since successive allocations are adjacent, BFCAllocator merges them into a
+// single region rather than one region per allocation, so that a chunk can
+// span memory that was added by different Extend calls. Physical pages are
+// unmapped, and their memory given back to the driver, as soon as no
+// allocated range touches them anymore.
+//
+// Memory is only readable and writable by the device it is allocated on.
+//
+// Thread-compatible: BFCAllocator calls it under its own lock.
+class GpuVirtualMemAllocator : public SubAllocator {
+ public:
+  // Reserves `virtual_address_space_size` bytes of device addresses in
+  // `gpu_context`, which bound the bytes that can be allocated at once.
+  // Fails if the driver does not support virtual memory management.
+  static Status Create(const std::vector<Visitor>& alloc_visitors,
+                       const std::vector<Visitor>& free_visitors,
+                       se::gpu::GpuContext* gpu_context, PlatformGpuId gpu_id,
+                       size_t virtual_address_space_size,
+                       std::unique_ptr<GpuVirtualMemAllocator>* allocator);
+
+  ~GpuVirtualMemAllocator() override;
+
+  // Returns the range after the previously allocated one, unless that is not
+  // aligned to `alignment`. Returns nullptr once the reserved addresses or
+  // the device memory run out.
+  void* Alloc(size_t alignment, size_t num_bytes) override;
+
+  // `ptr` and `num_bytes` must cover one or more whole allocated ranges.
+  void Free(void* ptr, size_t num_bytes) override;
+
+  bool SupportsCoalescing() const override { return true; }
+
+  // The bytes of physical memory mapped at the moment.
+  size_t mapped_bytes() const { return num_mapped_pages_ * page_size_; }
+
+ private:
+  GpuVirtualMemAllocator(const std::vector<Visitor>& alloc_visitors,
+                         const std::vector<Visitor>& free_visitors,
+                         se::gpu::GpuContext* gpu_context,
+                         PlatformGpuId gpu_id, se::gpu::GpuDevicePtr base,
+                         size_t size, size_t page_size);
+
+  // Maps physical memory at the pages in [first_page, last_page] that have
+  // none yet. Maps none of them on failure.
+  bool MapPages(size_t first_page, size_t last_page);
+  void UnmapPage(size_t page);
+
+  se::gpu::GpuContext* const gpu_context_;  // not owned
+  const PlatformGpuId gpu_id_;
+
+  // The reserved device addresses, and the granularity at which physical
+  // memory is mapped at them.
+  const se::gpu::GpuDevicePtr base_;
+  const size_t size_;
+  const size_t page_size_;
+
+  // The sizes of the allocated ranges, by their offset from `base_`.
+  std::map<size_t, size_t> allocated_ranges_;
+  // Where the next range starts: the end of the last allocated one.
+  size_t next_alloc_offset_ = 0;
+
+  // The physical memory mapped at each page of the reserved range. A handle
+  // with no bytes means that nothing is mapped.
+  std::vector<se::gpu::GpuDriver::GenericMemoryHandle> pages_;
+  size_t num_mapped_pages_ = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GpuVirtualMemAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_VIRTUAL_MEM_ALLOCATOR_H_
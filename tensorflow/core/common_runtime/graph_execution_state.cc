@@ -170,7 +170,7 @@ GraphExecutionState::~GraphExecutionState() {
 }
 
 Status GraphExecutionState::Extend(
-    const GraphDef& extension_def,
+    GraphDef extension_def,
     std::unique_ptr<GraphExecutionState>* out) const {
   if (session_options_->config.experimental().optimize_for_static_graph()) {
     return errors::FailedPrecondition(
@@ -206,7 +206,10 @@ Status GraphExecutionState::Extend(
 
   // 4. Merge the versions field.
   int old_node_size = gdef.node_size();
-  gdef.mutable_node()->MergeFrom(extension_def.node());
+  gdef.mutable_node()->Reserve(old_node_size + extension_def.node_size());
+  for (NodeDef& node : *extension_def.mutable_node()) {
+    gdef.add_node()->Swap(&node);
+  }
   TF_RETURN_IF_ERROR(
       AddDefaultAttrsToGraphDef(&gdef, *flib_def_, old_node_size));
   // Merge versions
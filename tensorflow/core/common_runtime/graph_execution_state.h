@@ -127,7 +127,10 @@ class GraphExecutionState {
   // NOTE(mrry): This method respects the placement of stateful nodes in
   // in *this, but currently does not transfer any other placement
   // or cost model information to the new graph.
-  Status Extend(const GraphDef& extension_def,
+  //
+  // The nodes of `extension_def` are moved into the new state, so callers
+  // that no longer need it should pass it with std::move().
+  Status Extend(GraphDef extension_def,
                 std::unique_ptr<GraphExecutionState>* out) const;
 
   // Builds a ClientGraph (a sub-graph of the full graph as induced by
@@ -0,0 +1,324 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_ring_reducer.h"
+
+#include <functional>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+// Phases of the algorithm, which tell apart the BufRendezvous keys of
+// transfers of the same chunk.
+enum Phase {
+  kIntraTaskReduceScatter = 0,
+  kInterTaskReduceScatter = 1,
+  kInterTaskAllGather = 2,
+  kIntraTaskAllGather = 3,
+};
+
+// Produces the BufRendezvous key of the transfer of chunk `chunk_idx` from
+// the device with index `src_dev_idx` in step `step` of `phase`.
+string HierarchicalRingBufKey(const string& exec_key, int phase, int step,
+                              int chunk_idx, int src_dev_idx) {
+  return strings::StrCat(exec_key, ":", phase, ":", step, ":", chunk_idx, ":",
+                         src_dev_idx);
+}
+}  // namespace
+
+HierarchicalRingReducer::HierarchicalRingReducer()
+    : col_ctx_(nullptr),
+      col_params_(nullptr),
+      num_tasks_(-1),
+      devices_per_task_(-1),
+      task_idx_(-1),
+      local_idx_(-1) {}
+
+Status HierarchicalRingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("HierarchicalRingReduce is not a reduction in ",
+                            col_params->name);
+  }
+  const int group_size = col_params->group.group_size;
+  const int num_tasks = col_params->group.num_tasks;
+  if (!col_params->instance.same_num_devices_per_task || num_tasks <= 0 ||
+      group_size % num_tasks != 0) {
+    return errors::Internal(
+        "HierarchicalRingReduce requires the same number of devices on each "
+        "of the ",
+        num_tasks, " tasks of ", col_params->name);
+  }
+  // Precondition: device_names must be sorted so that all devices in the
+  // same task are adjacent.
+  const int devices_per_task = group_size / num_tasks;
+  for (int di = 0; di < group_size; ++di) {
+    if (col_params->instance.task_names[di] !=
+        col_params->instance.task_names[di - di % devices_per_task]) {
+      return errors::Internal("Devices of ", col_params->name,
+                              " are not grouped by task: ",
+                              col_params->instance.device_names[di]);
+    }
+  }
+  return Status::OK();
+}
+
+Status HierarchicalRingReducer::InitializeCollectiveContext(
+    CollectiveContext* col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  num_tasks_ = col_params_->group.num_tasks;
+  devices_per_task_ = col_params_->group.group_size / num_tasks_;
+  task_idx_ = col_params_->default_rank / devices_per_task_;
+  local_idx_ = col_params_->default_rank % devices_per_task_;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+std::vector<int> HierarchicalRingReducer::ShardChunks(int shard_idx) const {
+  std::vector<int> chunks(num_tasks_);
+  for (int ti = 0; ti < num_tasks_; ++ti) {
+    chunks[ti] = shard_idx * num_tasks_ + ti;
+  }
+  return chunks;
+}
+
+void HierarchicalRingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  const int num_chunks = num_tasks_ * devices_per_task_;
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, num_chunks,
+                                  col_ctx_->device->GetAllocator(attr)));
+  chunks_.resize(num_chunks);
+  tmp_chunks_.resize(num_chunks);
+  for (int ci = 0; ci < num_chunks; ++ci) {
+    if (ca_->ChunkBytes(ci) > 0) {
+      chunks_[ci] = ca_->ChunkAlias(ci);
+      tmp_chunks_[ci] = ca_->TempChunk(ci);
+    }
+  }
+
+  Status s;
+  if (col_params_->final_op) {
+    Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+    if (col_params_->group.device_type != "CPU") {
+      group_size_tensor_ = ca_->Scalar(
+          col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+          AllocationAttributes());
+      Notification note;
+      col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+          &group_size_val, col_ctx_->device, &group_size_tensor_,
+          [&note, &s](const Status& copy_status) {
+            s.Update(copy_status);
+            note.Notify();
+          });
+      note.WaitForNotification();
+    } else {
+      group_size_tensor_ = group_size_val;
+    }
+  }
+  const DeviceBase::GpuDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_gpu_device_info();
+  if (s.ok() && gpu_info) {
+    // As in `RingReducer`, wait for the temp chunks allocated above to be
+    // valid before any peer writes into them.
+    profiler::TraceMe activity("WaitForQueuedEvents",
+                               profiler::TraceMeLevel::kInfo);
+    Notification note;
+    s = gpu_info->default_context->ThenExecute(
+        col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+    if (s.ok()) note.WaitForNotification();
+  }
+
+  if (s.ok()) s = RunPhases();
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  // Give up Refs on output tensor.
+  chunks_.clear();
+  tmp_chunks_.clear();
+  done(s);
+}
+
+Status HierarchicalRingReducer::RunPhases() {
+  const int t = task_idx_;
+  const int l = local_idx_;
+  const int num_local = devices_per_task_;
+  const int intra_next = DeviceIndex(t, (l + 1) % num_local);
+  const int intra_prev = DeviceIndex(t, (l + num_local - 1) % num_local);
+  const int inter_next = DeviceIndex((t + 1) % num_tasks_, l);
+  const int inter_prev = DeviceIndex((t + num_tasks_ - 1) % num_tasks_, l);
+
+  // After step s device l has reduced shard (l - s - 1) of its task, so it
+  // ends up with the task-wide sum of shard (l + 1).
+  for (int s = 0; s < num_local - 1; ++s) {
+    TF_RETURN_IF_ERROR(Exchange(
+        kIntraTaskReduceScatter, s, intra_next,
+        ShardChunks((l - s + num_local) % num_local), intra_prev,
+        ShardChunks((l - s - 1 + 2 * num_local) % num_local), /*reduce=*/true));
+  }
+
+  // The same ring schedule across tasks, one chunk of the shard per task.
+  const int shard = (l + 1) % num_local;
+  auto chunk = [this, shard](int k) {
+    return shard * num_tasks_ + (k % num_tasks_);
+  };
+  for (int s = 0; s < num_tasks_ - 1; ++s) {
+    TF_RETURN_IF_ERROR(Exchange(kInterTaskReduceScatter, s, inter_next,
+                                {chunk(t - s + num_tasks_)}, inter_prev,
+                                {chunk(t - s - 1 + 2 * num_tasks_)},
+                                /*reduce=*/true));
+  }
+  if (col_params_->final_op) {
+    TF_RETURN_IF_ERROR(Finalize(chunk(t + 1)));
+  }
+  for (int s = 0; s < num_tasks_ - 1; ++s) {
+    TF_RETURN_IF_ERROR(Exchange(kInterTaskAllGather, s, inter_next,
+                                {chunk(t + 1 - s + num_tasks_)}, inter_prev,
+                                {chunk(t - s + num_tasks_)},
+                                /*reduce=*/false));
+  }
+
+  for (int s = 0; s < num_local - 1; ++s) {
+    TF_RETURN_IF_ERROR(Exchange(
+        kIntraTaskAllGather, s, intra_next,
+        ShardChunks((l + 1 - s + num_local) % num_local), intra_prev,
+        ShardChunks((l - s + num_local) % num_local), /*reduce=*/false));
+  }
+  return Status::OK();
+}
+
+Status HierarchicalRingReducer::Exchange(int phase, int step,
+                                         int send_to_dev_idx,
+                                         const std::vector<int>& send_chunks,
+                                         int recv_from_dev_idx,
+                                         const std::vector<int>& recv_chunks,
+                                         bool reduce) {
+  std::vector<int> sends;
+  for (int ci : send_chunks) {
+    if (ca_->ChunkBytes(ci) > 0) sends.push_back(ci);
+  }
+  std::vector<int> recvs;
+  for (int ci : recv_chunks) {
+    if (ca_->ChunkBytes(ci) > 0) recvs.push_back(ci);
+  }
+  mutex mu;
+  Status status;
+  BlockingCounter pending(sends.size() + recvs.size());
+  auto transfer_done = [&mu, &status, &pending](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  const CollInstanceParams& instance = col_params_->instance;
+  for (int ci : sends) {
+    col_ctx_->col_exec->PostToPeer(
+        instance.device_names[send_to_dev_idx],
+        instance.task_names[send_to_dev_idx],
+        HierarchicalRingBufKey(col_ctx_->exec_key, phase, step, ci,
+                               col_params_->default_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &chunks_[ci],
+        col_ctx_->device_locality, transfer_done);
+  }
+  for (int ci : recvs) {
+    col_ctx_->col_exec->RecvFromPeer(
+        instance.device_names[recv_from_dev_idx],
+        instance.task_names[recv_from_dev_idx],
+        col_params_->task.is_local[recv_from_dev_idx],
+        HierarchicalRingBufKey(col_ctx_->exec_key, phase, step, ci,
+                               recv_from_dev_idx),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0),
+        reduce ? &tmp_chunks_[ci] : &chunks_[ci], col_ctx_->device_locality,
+        0 /*dev_to_dev_stream_index*/, transfer_done);
+  }
+  pending.Wait();
+  if (reduce) {
+    for (int ci : recvs) {
+      if (!status.ok()) break;
+      status = collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op.get(), &chunks_[ci], &tmp_chunks_[ci]);
+    }
+  }
+  if (!status.ok()) {
+    // Cancel the outstanding transfers of all other devices.
+    LOG(ERROR) << "Aborting HierarchicalRingReduce with " << status;
+    col_ctx_->col_exec->StartAbort(status);
+  }
+  return status;
+}
+
+Status HierarchicalRingReducer::Finalize(int chunk_idx) {
+  if (ca_->ChunkBytes(chunk_idx) == 0) return Status::OK();
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op.get(), &chunks_[chunk_idx], &group_size_tensor_);
+}
+
+REGISTER_COLLECTIVE(HierarchicalRingReduce, HierarchicalRingReducer);
+
+}  // namespace tensorflow
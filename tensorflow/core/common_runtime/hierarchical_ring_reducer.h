@@ -0,0 +1,102 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Two-level implementation of collective all-reduce for groups that span
+// several tasks with the same number of devices each.
+//
+// The tensor is split into one shard per device of a task, and each shard
+// into one chunk per task.  The algorithm runs in three phases:
+//  1. A ring reduce-scatter among the devices of each task, after which the
+//     device with local index l holds the task-wide sum of shard (l + 1) % L.
+//  2. A ring all-reduce of that shard among the devices with the same local
+//     index on all tasks.
+//  3. A ring all-gather of the shards among the devices of each task.
+// Only phase 2 crosses task boundaries, so each task sends over the network
+// about 2 * (T - 1) / T times the size of the tensor, split across its L
+// devices, in 2 * (T - 1) steps, instead of the 2 * (G - 1) steps of a flat
+// ring over all G = T * L devices.
+class HierarchicalRingReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalRingReducer();
+  ~HierarchicalRingReducer() override = default;
+
+  // Validates that the devices of `col_params` are grouped by task, with the
+  // same number of devices in each task.
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(CollectiveContext* col_ctx) override;
+
+  // No-op for hierarchical ring reduce.
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Begins execution of the hierarchical ring reduce algorithm.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Runs the three phases of the algorithm, blocking until they complete.
+  Status RunPhases();
+
+  // Sends the chunks `send_chunks` to the device at index `send_to_dev_idx`
+  // and receives the chunks `recv_chunks` from the device at index
+  // `recv_from_dev_idx`, blocking until all transfers complete.  If
+  // `reduce` is true, the received chunks are merged into the current
+  // values, otherwise they replace them.
+  Status Exchange(int phase, int step, int send_to_dev_idx,
+                  const std::vector<int>& send_chunks, int recv_from_dev_idx,
+                  const std::vector<int>& recv_chunks, bool reduce);
+
+  // Applies the final op of the reduction to chunk `chunk_idx`.
+  Status Finalize(int chunk_idx);
+
+  // Returns the index in device_names of the device with local index
+  // `local_idx` on the task with index `task_idx`.
+  int DeviceIndex(int task_idx, int local_idx) const {
+    return task_idx * devices_per_task_ + local_idx;
+  }
+
+  // Returns the chunk indices of shard `shard_idx`.
+  std::vector<int> ShardChunks(int shard_idx) const;
+
+  CollectiveContext* col_ctx_;          // Not owned
+  const CollectiveParams* col_params_;  // Not owned
+  int num_tasks_;
+  int devices_per_task_;
+  int task_idx_;
+  int local_idx_;
+  std::unique_ptr<CollectiveAdapter> ca_;
+  std::vector<Tensor> chunks_;
+  std::vector<Tensor> tmp_chunks_;
+  Tensor group_size_tensor_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_RING_REDUCER_H_
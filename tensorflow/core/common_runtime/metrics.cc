@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/lib/monitoring/sampler.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 
 namespace tensorflow {
 namespace metrics {
@@ -54,6 +55,26 @@ auto* graph_run_output_tensor_bytes = monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 14 (256MB)
     {monitoring::Buckets::Exponential(1, 4, 14)});
 
+auto* executor_node_queueing_delay_usecs = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/executor/node_queueing_delay_usecs",
+     "The time between a node becoming ready in the executor and the start "
+     "of its processing in microseconds."},
+    // Power of 2 with bucket count 20 (> 1 second)
+    {monitoring::Buckets::Exponential(1, 2, 20)});
+
+auto* executor_runner_queue_depth = monitoring::Sampler<0>::New(
+    {"/tensorflow/core/executor/runner_queue_depth",
+     "The number of nodes dispatched to the inter-op runner and not started "
+     "yet, sampled at each dispatch."},
+    // Power of 2 with bucket count 16 (32768 nodes)
+    {monitoring::Buckets::Exponential(1, 2, 16)});
+
+auto* executor_kernel_time_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/executor/kernel_time_usecs",
+     "The time spent in synchronous kernels in microseconds.", "op"},
+    // Power of 2 with bucket count 24 (> 16 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
 auto* graph_unused_outputs = monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
@@ -84,6 +105,58 @@ auto* tf_data_fingerprint_counter = monitoring::Counter<1>::New(
 auto* tf_data_optimization_counter = monitoring::Counter<1>::New(
     "/tensorflow/data/optimization", "tf.data optimization", "name");
 
+auto* tf_data_snapshot_bytes_counter = monitoring::Counter<1>::New(
+    "/tensorflow/data/snapshot/bytes",
+    "The number of bytes processed by each stage of tf.data snapshots.",
+    "stage");
+
+auto* tf_data_snapshot_usecs_counter = monitoring::Counter<1>::New(
+    "/tensorflow/data/snapshot/usecs",
+    "The time spent in each stage of tf.data snapshots in microseconds.",
+    "stage");
+
+auto* recv_tensor_raw_bytes_counter = monitoring::Counter<2>::New(
+    "/tensorflow/core/recv_tensor/compression/raw_bytes",
+    "The number of tensor content bytes offered for compression by senders "
+    "of RecvTensor responses.",
+    "edge", "codec");
+
+auto* recv_tensor_compressed_bytes_counter = monitoring::Counter<2>::New(
+    "/tensorflow/core/recv_tensor/compression/compressed_bytes",
+    "The number of tensor content bytes sent after compression in RecvTensor "
+    "responses.",
+    "edge", "codec");
+
+auto* recv_tensor_compression_usecs_counter = monitoring::Counter<2>::New(
+    "/tensorflow/core/recv_tensor/compression/usecs",
+    "The time spent compressing tensor contents of RecvTensor responses in "
+    "microseconds.",
+    "edge", "codec");
+
+auto* recv_tensor_decompressed_bytes_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/recv_tensor/decompression/bytes",
+    "The number of tensor content bytes decompressed by receivers of "
+    "RecvTensor responses.",
+    "codec");
+
+auto* recv_tensor_decompression_usecs_counter = monitoring::Counter<1>::New(
+    "/tensorflow/core/recv_tensor/decompression/usecs",
+    "The time spent decompressing tensor contents of RecvTensor responses in "
+    "microseconds.",
+    "codec");
+
+auto* gpu_staged_copy_bytes_counter = monitoring::Counter<2>::New(
+    "/tensorflow/core/gpu/staged_copy/bytes",
+    "The number of bytes copied between host memory and GPUs through pinned "
+    "staging buffers.",
+    "direction", "chunk_bytes");
+
+auto* gpu_staged_copy_usecs_counter = monitoring::Counter<2>::New(
+    "/tensorflow/core/gpu/staged_copy/usecs",
+    "The time spent copying between host memory and GPUs through pinned "
+    "staging buffers in microseconds.",
+    "direction", "chunk_bytes");
+
 auto* parse_dense_feature_counter = monitoring::Counter<0>::New(
     "/tensorflow/data/dense_feature",
     "The number of dense features parsed by ops for parsing tf.Example.");
@@ -158,6 +231,55 @@ void RecordTFDataOptimization(const string& name, int64 num_changes) {
   tf_data_optimization_counter->GetCell(name)->IncrementBy(num_changes);
 }
 
+void RecordTFDataSnapshotStage(const string& stage, int64 num_bytes,
+                               uint64 duration_us) {
+  tf_data_snapshot_bytes_counter->GetCell(stage)->IncrementBy(num_bytes);
+  tf_data_snapshot_usecs_counter->GetCell(stage)->IncrementBy(duration_us);
+}
+
+void RecordRecvTensorCompression(const string& edge, const string& codec,
+                                 int64 raw_bytes, int64 compressed_bytes,
+                                 uint64 duration_us) {
+  recv_tensor_raw_bytes_counter->GetCell(edge, codec)->IncrementBy(raw_bytes);
+  recv_tensor_compressed_bytes_counter->GetCell(edge, codec)->IncrementBy(
+      compressed_bytes);
+  recv_tensor_compression_usecs_counter->GetCell(edge, codec)->IncrementBy(
+      duration_us);
+}
+
+void RecordRecvTensorDecompression(const string& codec, int64 raw_bytes,
+                                   uint64 duration_us) {
+  recv_tensor_decompressed_bytes_counter->GetCell(codec)->IncrementBy(
+      raw_bytes);
+  recv_tensor_decompression_usecs_counter->GetCell(codec)->IncrementBy(
+      duration_us);
+}
+
+void RecordGpuStagedCopy(const string& direction, int64 chunk_bytes,
+                         int64 num_bytes, uint64 duration_us) {
+  const string chunk_bytes_label = strings::StrCat(chunk_bytes);
+  gpu_staged_copy_bytes_counter->GetCell(direction, chunk_bytes_label)
+      ->IncrementBy(num_bytes);
+  gpu_staged_copy_usecs_counter->GetCell(direction, chunk_bytes_label)
+      ->IncrementBy(duration_us);
+}
+
+void RecordExecutorNodeQueueingDelay(uint64 delay_usecs) {
+  static auto* executor_node_queueing_delay_usecs_cell =
+      executor_node_queueing_delay_usecs->GetCell();
+  executor_node_queueing_delay_usecs_cell->Add(delay_usecs);
+}
+
+void RecordExecutorRunnerQueueDepth(int64 depth) {
+  static auto* executor_runner_queue_depth_cell =
+      executor_runner_queue_depth->GetCell();
+  executor_runner_queue_depth_cell->Add(depth);
+}
+
+monitoring::SamplerCell* GetExecutorKernelTimeCell(const string& op_type) {
+  return executor_kernel_time_usecs->GetCell(op_type);
+}
+
 void RecordParseDenseFeature(int64 num_features) {
   static auto* parse_dense_feature_counter_cell =
       parse_dense_feature_counter->GetCell();
@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_COMMON_RUNTIME_METRICS_H_
 
 #include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -57,6 +58,37 @@ void RecordTFDataFingerprint(const string& name);
 // The `name` argument identifies the optimization (e.g. "noop_elimination").
 void RecordTFDataOptimization(const string& name, int64 num_changes);
 
+// Records that a stage of writing or reading a tf.data snapshot processed
+// `num_bytes` bytes in `duration_us` microseconds.
+//
+// The `stage` argument identifies the stage (e.g. "compress" or "read").
+void RecordTFDataSnapshotStage(const string& stage, int64 num_bytes,
+                               uint64 duration_us);
+
+// Records that the sender of a tensor compressed its `raw_bytes` contents to
+// `compressed_bytes` with `codec` in `duration_us` microseconds.  Contents that
+// did not compress well are sent uncompressed and recorded with
+// `compressed_bytes` equal to `raw_bytes`.
+//
+// The `edge` argument identifies the sending and receiving workers (e.g.
+// "/job:ps/replica:0/task:0->/job:worker/replica:0/task:1").
+void RecordRecvTensorCompression(const string& edge, const string& codec,
+                                 int64 raw_bytes, int64 compressed_bytes,
+                                 uint64 duration_us);
+
+// Records that the receiver of a tensor decompressed `raw_bytes` contents
+// compressed with `codec` in `duration_us` microseconds.
+void RecordRecvTensorDecompression(const string& codec, int64 raw_bytes,
+                                   uint64 duration_us);
+
+// Records that `num_bytes` were copied between host memory and a GPU through
+// pinned staging buffers, in chunks of `chunk_bytes`, in `duration_us`
+// microseconds.
+//
+// The `direction` argument is "host_to_device" or "device_to_host".
+void RecordGpuStagedCopy(const string& direction, int64 chunk_bytes,
+                         int64 num_bytes, uint64 duration_us);
+
 // Records parsing of dense tensor features.
 void RecordParseDenseFeature(int64 num_features);
 
@@ -75,6 +107,18 @@ void UpdateGraphExecTime(const uint64 running_time_usecs);
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
+// Records that a node waited `delay_usecs` microseconds between becoming ready
+// in the executor and the start of its processing.
+void RecordExecutorNodeQueueingDelay(uint64 delay_usecs);
+
+// Records the number of nodes that the executors of the process have
+// dispatched to their inter-op runners and that have not started yet.
+void RecordExecutorRunnerQueueDepth(int64 depth);
+
+// Returns a sampler cell recording the time spent in the synchronous kernels
+// of ops of type `op_type` in microseconds.
+monitoring::SamplerCell* GetExecutorKernelTimeCell(const string& op_type);
+
 // Updates the metrics stored about time spent building graphs.
 //
 // By "GraphBuild", we refer to building a client graph, which is a sub-graph of
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 
+#include <deque>
 #include <iterator>
 #include <utility>
 
@@ -44,9 +45,11 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 #include "tensorflow/core/util/reffed_status_callback.h"
 
@@ -605,51 +608,105 @@ Status GetGraphAndArgRets(
   return Status::OK();
 }
 
-}  // anonymous namespace
-
-Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
-    const string& function_name, AttrSlice attrs,
-    const FunctionLibraryRuntime::InstantiateOptions& options,
-    FunctionLibraryRuntime::Handle* handle) {
-  // Check if this function has already been instantiated.
-  const string& function_key = Canonicalize(function_name, attrs, options);
+// The graph of a multi-device function after optimization and placement, as
+// it is about to be partitioned.
+struct OptimizedFunctionGraph {
+  explicit OptimizedFunctionGraph(const FunctionLibraryDefinition& lib_def)
+      : lib_def(lib_def) {}
 
-  {
+  // The library the optimization passes left behind, and which `graph` uses.
+  FunctionLibraryDefinition lib_def;
+  std::unique_ptr<Graph> graph;
+  // Maps node names in `graph` to the control output names.
+  std::unordered_map<string, string> node_name_to_control_ret;
+  DataTypeVector ret_types;
+  int num_outputs = 0;
+};
+
+// A process-wide cache of optimized function graphs, so that the many
+// ProcessFunctionLibraryRuntimes of short-lived sessions and eager contexts
+// need not optimize and place the same functions over and over. Holds at most
+// TF_OPTIMIZED_FUNCTION_GRAPH_CACHE_SIZE graphs, evicting the oldest first,
+// and is disabled if that is 0, the default.
+class OptimizedFunctionGraphCache {
+ public:
+  // Returns nullptr if the cache is disabled.
+  static OptimizedFunctionGraphCache* Global() {
+    static OptimizedFunctionGraphCache* cache =
+        []() -> OptimizedFunctionGraphCache* {
+      int64 capacity;
+      TF_CHECK_OK(ReadInt64FromEnvVar("TF_OPTIMIZED_FUNCTION_GRAPH_CACHE_SIZE",
+                                      0, &capacity));
+      if (capacity <= 0) return nullptr;
+      return new OptimizedFunctionGraphCache(capacity);
+    }();
+    return cache;
+  }
+
+  std::shared_ptr<const OptimizedFunctionGraph> Find(const string& key) {
     mutex_lock l(mu_);
-    const auto& it = table_.find(function_key);
-    if (it != table_.end()) {
-      *handle = it->second;
-      ++mdevice_data_[*handle]->instantiation_counter_;
-      return Status::OK();
-    }
+    auto it = graphs_.find(key);
+    return it == graphs_.end() ? nullptr : it->second;
   }
 
-  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
-          << "\" on default device \"" << options.target << "\"";
-  if (VLOG_IS_ON(3)) {
-    int index = 0;
-    VLOG(3) << "Requested input devices:";
-    for (const string& device : options.input_devices) {
-      VLOG(3) << "    [input " << index++ << "] " << device;
-    }
-    index = 0;
-    VLOG(3) << "Requested output devices:";
-    for (const string& device : options.output_devices) {
-      VLOG(3) << "    [output " << index++ << "] " << device;
+  void Insert(const string& key,
+              std::shared_ptr<const OptimizedFunctionGraph> graph) {
+    mutex_lock l(mu_);
+    if (!graphs_.emplace(key, std::move(graph)).second) return;
+    insertion_order_.push_back(key);
+    if (insertion_order_.size() > capacity_) {
+      graphs_.erase(insertion_order_.front());
+      insertion_order_.pop_front();
     }
   }
 
-  const FunctionLibraryDefinition* lib_def =
-      options.lib_def == nullptr ? lib_def_ : options.lib_def;
-
-  const FunctionDef* fdef = lib_def->Find(function_name);
-  if (fdef == nullptr) {
-    return errors::InvalidArgument("Failed to find function \"", function_name,
-                                   "\" in function library: ", lib_def);
-  }
+ private:
+  explicit OptimizedFunctionGraphCache(int64 capacity)
+      : capacity_(capacity) {}
+
+  const size_t capacity_;
+  mutex mu_;
+  std::unordered_map<string, std::shared_ptr<const OptimizedFunctionGraph>>
+      graphs_ TF_GUARDED_BY(mu_);
+  std::deque<string> insertion_order_ TF_GUARDED_BY(mu_);
+};
+
+// Returns the key of the optimized graph of `function_name` in an
+// OptimizedFunctionGraphCache. Besides the canonicalized instantiation, it
+// covers everything the optimization and placement depend on: the contents
+// of the functions reachable from `fdef`, and the available devices.
+// Incarnations are left out, as they are only used by the partitioning, which
+// is not cached.
+string OptimizedFunctionGraphCacheKey(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    const FunctionDef& fdef, const FunctionLibraryDefinition& lib_def,
+    const DeviceSet& device_set) {
+  // The library is covered by its contents instead of by its address.
+  FunctionLibraryRuntime::InstantiateOptions key_options = options;
+  key_options.lib_def = nullptr;
+  string key = Canonicalize(function_name, attrs, key_options);
+  FunctionDefLibrary library = lib_def.ReachableDefinitions(fdef).ToProto();
+  *library.add_function() = fdef;
+  strings::StrAppend(&key, "#lib=", DeterministicProtoHash64(library),
+                     "#optimize_fn=",
+                     static_cast<bool>(options.optimize_graph_fn),
+                     "#devices=");
+  for (const Device* device : device_set.devices()) {
+    strings::StrAppend(&key, device->name(), ":", device->device_type(), ",");
+  }
+  return key;
+}
 
-  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
+}  // anonymous namespace
 
+Status ProcessFunctionLibraryRuntime::OptimizeMultiDeviceFunctionGraph(
+    const string& function_name, const string& function_key, AttrSlice attrs,
+    const FunctionDef& fdef, const FunctionLibraryDefinition* lib_def,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    std::unique_ptr<Graph>* graph_out,
+    std::unique_ptr<MultiDeviceFunctionData>* data_out,
+    std::unordered_map<string, string>* node_name_to_control_ret) {
   std::unique_ptr<Graph> graph;
   std::vector<Node*> arg_nodes, ret_nodes;
   std::vector<string> ret_node_names;
@@ -657,7 +714,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   std::vector<string> control_ret_node_names;
 
   TF_RETURN_IF_ERROR(GetGraphAndArgRets(
-      function_name, attrs, fdef, lib_def, &graph, &arg_nodes, &ret_nodes,
+      function_name, attrs, &fdef, lib_def, &graph, &arg_nodes, &ret_nodes,
       &ret_node_names, &ret_types, &control_ret_node_names));
 
   if (options.graph_collector != nullptr) {
@@ -690,10 +747,7 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
 
   auto data = absl::make_unique<MultiDeviceFunctionData>(
       function_name, function_key, ret_node_names.size(),
-      lib_def->ReachableDefinitions(*fdef), std::move(ret_types));
-
-  // Mapping from a function body node name to the control output name.
-  std::unordered_map<string, string> node_name_to_control_ret;
+      lib_def->ReachableDefinitions(fdef), std::move(ret_types));
 
   bool control_rets_updated = false;
   TF_RETURN_IF_ERROR(FunctionOptimizationPassRegistry::Global().Run(
@@ -704,11 +758,11 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     // Function graph pass may have resulted in different nodes/node names for
     // control rets.
     for (const auto& control_ret : control_ret_node_names) {
-      node_name_to_control_ret.emplace(control_ret, control_ret);
+      node_name_to_control_ret->emplace(control_ret, control_ret);
     }
   } else {
-    for (const auto& control_ret : fdef->control_ret()) {
-      node_name_to_control_ret.emplace(control_ret.second, control_ret.first);
+    for (const auto& control_ret : fdef.control_ret()) {
+      node_name_to_control_ret->emplace(control_ret.second, control_ret.first);
     }
   }
 
@@ -766,6 +820,93 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
     options.graph_collector->CollectOptimizedGraph(def);
   }
 
+  *graph_out = std::move(graph);
+  *data_out = std::move(data);
+  return Status::OK();
+}
+
+Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
+    const string& function_name, AttrSlice attrs,
+    const FunctionLibraryRuntime::InstantiateOptions& options,
+    FunctionLibraryRuntime::Handle* handle) {
+  // Check if this function has already been instantiated.
+  const string& function_key = Canonicalize(function_name, attrs, options);
+
+  {
+    mutex_lock l(mu_);
+    const auto& it = table_.find(function_key);
+    if (it != table_.end()) {
+      *handle = it->second;
+      ++mdevice_data_[*handle]->instantiation_counter_;
+      return Status::OK();
+    }
+  }
+
+  VLOG(1) << "Instantiating MultiDevice function \"" << function_name
+          << "\" on default device \"" << options.target << "\"";
+  if (VLOG_IS_ON(3)) {
+    int index = 0;
+    VLOG(3) << "Requested input devices:";
+    for (const string& device : options.input_devices) {
+      VLOG(3) << "    [input " << index++ << "] " << device;
+    }
+    index = 0;
+    VLOG(3) << "Requested output devices:";
+    for (const string& device : options.output_devices) {
+      VLOG(3) << "    [output " << index++ << "] " << device;
+    }
+  }
+
+  const FunctionLibraryDefinition* lib_def =
+      options.lib_def == nullptr ? lib_def_ : options.lib_def;
+
+  const FunctionDef* fdef = lib_def->Find(function_name);
+  if (fdef == nullptr) {
+    return errors::InvalidArgument("Failed to find function \"", function_name,
+                                   "\" in function library: ", lib_def);
+  }
+
+  TF_RETURN_IF_ERROR(ValidateMultiDeviceOptions(*fdef, options));
+
+  // Optimizing and placing the function graph dominates the instantiation
+  // cost. Reuse the result of an earlier, identical instantiation from any
+  // ProcessFunctionLibraryRuntime in this process if there was one.
+  OptimizedFunctionGraphCache* cache = OptimizedFunctionGraphCache::Global();
+  string cache_key;
+  std::shared_ptr<const OptimizedFunctionGraph> cached;
+  if (cache != nullptr && options.graph_collector == nullptr) {
+    cache_key = OptimizedFunctionGraphCacheKey(function_name, attrs, options,
+                                               *fdef, *lib_def, *device_set_);
+    cached = cache->Find(cache_key);
+  }
+
+  std::unique_ptr<Graph> graph;
+  std::unique_ptr<MultiDeviceFunctionData> data;
+  std::unordered_map<string, string> node_name_to_control_ret;
+  if (cached != nullptr) {
+    VLOG(1) << "Reusing the optimized graph of MultiDevice function \""
+            << function_name << "\"";
+    data = absl::make_unique<MultiDeviceFunctionData>(
+        function_name, function_key, cached->num_outputs,
+        FunctionLibraryDefinition(cached->lib_def), cached->ret_types);
+    graph = absl::make_unique<Graph>(data->lib_def_);
+    CopyGraph(*cached->graph, graph.get());
+    node_name_to_control_ret = cached->node_name_to_control_ret;
+  } else {
+    TF_RETURN_IF_ERROR(OptimizeMultiDeviceFunctionGraph(
+        function_name, function_key, attrs, *fdef, lib_def, options, &graph,
+        &data, &node_name_to_control_ret));
+    if (!cache_key.empty()) {
+      auto optimized = std::make_shared<OptimizedFunctionGraph>(data->lib_def_);
+      optimized->graph = absl::make_unique<Graph>(optimized->lib_def);
+      CopyGraph(*graph, optimized->graph.get());
+      optimized->node_name_to_control_ret = node_name_to_control_ret;
+      optimized->ret_types = data->ret_types_;
+      optimized->num_outputs = data->num_outputs_;
+      cache->Insert(cache_key, std::move(optimized));
+    }
+  }
+
   VLOG(4) << "Main function graph to be partitioned:";
   VLOG(4) << DebugString(graph->ToGraphDefDebug());
 
@@ -778,8 +919,13 @@ Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
                               pair.first, ")"),
               pair.second.get());
   }
-  optimization_options.graph = nullptr;
-  optimization_options.device_set = nullptr;
+  GraphOptimizationPassOptions optimization_options;
+  SessionOptions session_options;
+  session_options.env = env_;
+  session_options.config = options.config_proto;
+  optimization_options.session_options = &session_options;
+  optimization_options.flib_def = &data->lib_def_;
+  optimization_options.is_function_graph = true;
   optimization_options.partition_graphs = &subgraphs;
   // Normally POST_PARTITIONING passes are run by distributed workers.
   // Distributed workers are currently not supported in this code path, so we
@@ -981,6 +1127,52 @@ void ProcessFunctionLibraryRuntime::RunRemoteDevice(
   parent_->Run(opts, local_handle, GetLocalArgs(args), rets, std::move(done));
 }
 
+bool ProcessFunctionLibraryRuntime::RunSingleLocalComponent(
+    const FunctionLibraryRuntime::Options& opts,
+    const MultiDeviceFunctionData& data, gtl::ArraySlice<Tensor> args,
+    std::vector<Tensor>* rets,
+    FunctionLibraryRuntime::DoneCallback* done) const {
+  if (data.glue_.size() != 1 || data.is_cross_process_) return false;
+  const string& target = data.glue_.begin()->first;
+  const ComponentFunctionData& comp_data = data.glue_.begin()->second;
+  FunctionLibraryRuntime* flr = GetFLR(target);
+  if (flr == nullptr) return false;
+
+  VLOG(1) << "Running single-device function " << data.function_name_
+          << " on device " << target;
+  FunctionLibraryRuntime::Options comp_opts = opts;
+  comp_opts.args_alloc_attrs = comp_data.arg_alloc_attrs_;
+  comp_opts.rets_alloc_attrs = comp_data.ret_alloc_attrs_;
+  comp_opts.remote_execution = false;
+  comp_opts.create_rendezvous = false;
+  thread::ThreadPool* pool = flr->device()->tensorflow_device_thread_pool();
+  comp_opts.runner = (pool == nullptr) ? comp_opts.runner : flr->runner();
+
+  std::vector<Tensor>* comp_rets = new std::vector<Tensor>;
+  rets->resize(data.num_outputs_);
+  const MultiDeviceFunctionData* data_ptr = &data;
+  flr->Run(comp_opts, comp_data.handle_,
+           GetArgsForIndices(comp_data.arg_indices_, args), comp_rets,
+           [comp_rets, rets, comp_data, data_ptr,
+            done = std::move(*done)](const Status& status) {
+             Status s = status;
+             if (!s.ok()) {
+               VLOG(2) << "Component function execution failed: " << s;
+               s = Status(s.code(),
+                          strings::StrCat(errors::FormatFunctionForError(
+                                              data_ptr->function_name_),
+                                          " ", s.error_message()));
+             } else {
+               for (int i = 0; i < comp_rets->size(); ++i) {
+                 (*rets)[comp_data.ret_indices_[i]] = (*comp_rets)[i];
+               }
+             }
+             delete comp_rets;
+             done(s);
+           });
+  return true;
+}
+
 void ProcessFunctionLibraryRuntime::RunMultiDevice(
     const FunctionLibraryRuntime::Options& opts,
     FunctionLibraryRuntime::Handle handle, std::vector<Tensor>* rets,
@@ -1292,6 +1484,14 @@ void ProcessFunctionLibraryRuntime::Run(
     FunctionLibraryRuntime::Handle handle, gtl::ArraySlice<Tensor> args,
     std::vector<Tensor>* rets,
     FunctionLibraryRuntime::DoneCallback done) const {
+  if (!opts.rendezvous) {
+    const MultiDeviceFunctionData* data = IsMultiDevice(handle);
+    if (data != nullptr &&
+        RunSingleLocalComponent(opts, *data, args, rets, &done)) {
+      return;
+    }
+  }
+
   FunctionLibraryRuntime::Options new_opts = opts;
   Rendezvous* created_rendezvous = nullptr;
   if (!opts.rendezvous) {
@@ -1440,7 +1640,12 @@ void ProcessFunctionLibraryRuntime::Run(
   args.reserve(frame->num_args());
   for (size_t i = 0; i < frame->num_args(); ++i) {
     Tensor arg;
-    Status s = frame->GetArg(i, &arg);
+    Status s;
+    if (frame->CanConsumeArg(i)) {
+      frame->ConsumeArg(i, &arg);
+    } else {
+      s = frame->GetArg(i, &arg);
+    }
     args.push_back(std::move(arg));
     if (!s.ok()) {
       done(s);
@@ -286,6 +286,16 @@ class ProcessFunctionLibraryRuntime {
   MultiDeviceFunctionData* IsMultiDevice(
       FunctionLibraryRuntime::Handle handle) const;
 
+  // Runs the multi-device function `data` by calling its only component
+  // directly if it was placed entirely on one local device. Such a function
+  // needs neither a rendezvous nor the fan-out of RunMultiDevice(). Returns
+  // false, without consuming `done`, if `data` does not qualify.
+  bool RunSingleLocalComponent(
+      const FunctionLibraryRuntime::Options& opts,
+      const MultiDeviceFunctionData& data, gtl::ArraySlice<Tensor> args,
+      std::vector<Tensor>* rets,
+      FunctionLibraryRuntime::DoneCallback* done) const;
+
   void RunMultiDevice(
       const FunctionLibraryRuntime::Options& opts,
       FunctionLibraryRuntime::Handle handle, std::vector<Tensor>* rets,
@@ -346,6 +356,18 @@ class ProcessFunctionLibraryRuntime {
       const FunctionLibraryRuntime::InstantiateOptions& options,
       FunctionLibraryRuntime::Handle* handle);
 
+  // Builds the graph of a multi-device function, and runs the function
+  // optimization passes and the Placer on it. Returns the resulting graph,
+  // ready to be partitioned, along with the function data to complete.
+  Status OptimizeMultiDeviceFunctionGraph(
+      const string& function_name, const string& function_key,
+      AttrSlice attrs, const FunctionDef& fdef,
+      const FunctionLibraryDefinition* lib_def,
+      const FunctionLibraryRuntime::InstantiateOptions& options,
+      std::unique_ptr<Graph>* graph,
+      std::unique_ptr<MultiDeviceFunctionData>* data,
+      std::unordered_map<string, string>* node_name_to_control_ret);
+
   void InstantiateRemote(
       const string& function_name, AttrSlice attrs,
       const FunctionLibraryRuntime::InstantiateOptions& options,
@@ -21,6 +21,7 @@ limitations under the License.
 #include "absl/base/call_once.h"
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/common_runtime/slab_cpu_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -74,9 +75,15 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.error_message();
     }
+    // A NUMA-local SlabCPUAllocator replaces the per-node PoolAllocator when
+    // selected, unless visitors need a SubAllocator-based allocator.
+    const bool use_numa_slab_allocator =
+        numa_enabled_ && !alloc_visitors_defined && !use_bfc_allocator &&
+        UseSlabCPUAllocator();
     Allocator* allocator = nullptr;
     SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
+        ((numa_enabled_ && !use_numa_slab_allocator) ||
+         alloc_visitors_defined || use_bfc_allocator)
             ? new BasicCPUAllocator(
                   numa_enabled_ ? numa_node : port::kNUMANoAffinity,
                   cpu_alloc_visitors_, cpu_free_visitors_)
@@ -97,6 +104,12 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
                            "bfc_cpu_allocator_for_gpu" /*name*/);
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
+    } else if (use_numa_slab_allocator) {
+      SlabCPUAllocator::Options slab_options;
+      slab_options.numa_node = numa_node;
+      allocator = new SlabCPUAllocator(slab_options);
+      VLOG(2) << "Using SlabCPUAllocator for ProcessState CPU allocator "
+              << "numa_node=" << numa_node;
     } else if (sub_allocator) {
       DCHECK(sub_allocator);
       allocator =
@@ -23,6 +23,7 @@ limitations under the License.
 #include <string.h>
 
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
@@ -164,6 +165,20 @@ thread::ThreadPool* NewThreadPoolFromSessionOptions(
       /*allocator=*/nullptr);
 }
 
+thread::ThreadPool* NewNumaThreadPoolFromSessionOptions(
+    const SessionOptions& options, int numa_node, int num_numa_nodes) {
+  const int32 num_threads = std::max(
+      1, NumInterOpThreadsFromSessionOptions(options) / num_numa_nodes);
+  VLOG(1) << "Direct session inter op parallelism threads for NUMA node "
+          << numa_node << ": " << num_threads;
+  ThreadOptions thread_options;
+  thread_options.numa_node = numa_node;
+  return new thread::ThreadPool(
+      options.env, thread_options, strings::StrCat("Compute_numa", numa_node),
+      num_threads, !options.config.experimental().disable_thread_spinning(),
+      /*allocator=*/nullptr);
+}
+
 void SchedClosure(std::function<void()> closure) {
   if (!tracing::EventCollector::IsEnabled()) {
     return Env::Default()->SchedClosure(std::move(closure));
@@ -48,6 +48,12 @@ int32 NumInterOpThreadsFromSessionOptions(const SessionOptions& options);
 thread::ThreadPool* NewThreadPoolFromSessionOptions(
     const SessionOptions& options);
 
+// Creates a thread pool whose threads are bound to NUMA node `numa_node`, with
+// an even share (at least one) of the inter op threads for `num_numa_nodes`
+// nodes.
+thread::ThreadPool* NewNumaThreadPoolFromSessionOptions(
+    const SessionOptions& options, int numa_node, int num_numa_nodes);
+
 // Schedule "closure" in the default thread queue.
 void SchedClosure(std::function<void()> closure);
 
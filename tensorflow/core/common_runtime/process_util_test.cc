@@ -34,5 +34,18 @@ TEST(ProcessUtilTest, ThreadPool) {
   delete pool;
 }
 
+TEST(ProcessUtilTest, NumaThreadPool) {
+  SessionOptions opts;
+  opts.config.set_inter_op_parallelism_threads(10);
+
+  thread::ThreadPool* pool = NewNumaThreadPoolFromSessionOptions(opts, 0, 2);
+  EXPECT_EQ(5, pool->NumThreads());
+  delete pool;
+
+  pool = NewNumaThreadPoolFromSessionOptions(opts, 0, 16);
+  EXPECT_EQ(1, pool->NumThreads());
+  delete pool;
+}
+
 }  // anonymous namespace
 }  // namespace tensorflow
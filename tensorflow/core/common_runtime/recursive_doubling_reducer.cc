@@ -0,0 +1,245 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/recursive_doubling_reducer.h"
+
+#include <functional>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+namespace {
+// Produces the BufRendezvous key of the value sent by the device with rank
+// `src_rank` in step `step`.
+string RecursiveDoublingBufKey(const string& exec_key, int step, int src_rank) {
+  return strings::StrCat(exec_key, ":", step, ":", src_rank);
+}
+}  // namespace
+
+RecursiveDoublingReducer::RecursiveDoublingReducer()
+    : col_ctx_(nullptr), col_params_(nullptr) {}
+
+Status RecursiveDoublingReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  if (col_params->instance.type != REDUCTION_COLLECTIVE) {
+    return errors::Internal("RecursiveDoublingReduce is not a reduction in ",
+                            col_params->name);
+  }
+  return Status::OK();
+}
+
+Status RecursiveDoublingReducer::InitializeCollectiveContext(
+    CollectiveContext* col_ctx) {
+  DCHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = &col_ctx->col_params;
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void RecursiveDoublingReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Like `RingReducer`, this does not require non-overlapping collectives.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  // Start by copying input to output if they're not already the same, i.e. if
+  // we're not computing in-place on the input tensor.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    Notification note;
+    Status status;
+    profiler::TraceMe activity("MemCpyAsync", profiler::TraceMeLevel::kInfo);
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->op_device_context(), col_ctx_->device,
+        col_ctx_->device, col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/,
+        [&note, &status](const Status& s) {
+          status.Update(s);
+          note.Notify();
+        });
+    note.WaitForNotification();
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+  }
+
+  AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
+  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, 1 /*num_chunks*/,
+                                  col_ctx_->device->GetAllocator(attr)));
+  value_ = ca_->ChunkAlias(0);
+  tmp_value_ = ca_->TempChunk(0);
+
+  Status s;
+  if (col_params_->final_op) {
+    Tensor group_size_val = ca_->Scalar(col_params_->group.group_size);
+    if (col_params_->group.device_type != "CPU") {
+      group_size_tensor_ = ca_->Scalar(
+          col_ctx_->device->GetAllocator(col_ctx_->op_ctx->input_alloc_attr(0)),
+          AllocationAttributes());
+      Notification note;
+      col_ctx_->op_ctx->op_device_context()->CopyCPUTensorToDevice(
+          &group_size_val, col_ctx_->device, &group_size_tensor_,
+          [&note, &s](const Status& copy_status) {
+            s.Update(copy_status);
+            note.Notify();
+          });
+      note.WaitForNotification();
+    } else {
+      group_size_tensor_ = group_size_val;
+    }
+  }
+  const DeviceBase::GpuDeviceInfo* gpu_info =
+      col_ctx_->device->tensorflow_gpu_device_info();
+  if (s.ok() && gpu_info) {
+    // As in `RingReducer`, wait for the temp value allocated above to be
+    // valid before any peer writes into it.
+    profiler::TraceMe activity("WaitForQueuedEvents",
+                               profiler::TraceMeLevel::kInfo);
+    Notification note;
+    s = gpu_info->default_context->ThenExecute(
+        col_ctx_->device, gpu_info->stream, [&note]() { note.Notify(); });
+    if (s.ok()) note.WaitForNotification();
+  }
+
+  if (s.ok() && ca_->ChunkBytes(0) > 0) s = RunSteps();
+  if (s.ok()) {
+    // Recover the output from the adaptor.
+    ca_->ConsumeFinalValue(col_ctx_->output);
+  }
+  // Give up Refs on output tensor.
+  value_ = Tensor();
+  tmp_value_ = Tensor();
+  done(s);
+}
+
+int RecursiveDoublingReducer::GroupRank(int rank) const {
+  const int group_size = col_params_->group.group_size;
+  int num_doubling = 1;
+  while (num_doubling * 2 <= group_size) num_doubling *= 2;
+  const int num_extra = group_size - num_doubling;
+  return rank < num_extra ? 2 * rank + 1 : rank + num_extra;
+}
+
+Status RecursiveDoublingReducer::RunSteps() {
+  const int group_size = col_params_->group.group_size;
+  const int rank = col_params_->default_rank;
+  int num_doubling = 1;
+  int num_doubling_steps = 0;
+  while (num_doubling * 2 <= group_size) {
+    num_doubling *= 2;
+    ++num_doubling_steps;
+  }
+  const int num_extra = group_size - num_doubling;
+  const int final_step = num_doubling_steps + 1;
+
+  // Fold the first 2 * num_extra ranks in pairs onto their odd members.
+  if (rank < 2 * num_extra) {
+    if (rank % 2 == 0) {
+      TF_RETURN_IF_ERROR(Exchange(0, rank + 1, -1, /*reduce=*/false));
+      return Exchange(final_step, -1, rank + 1, /*reduce=*/false);
+    }
+    TF_RETURN_IF_ERROR(Exchange(0, -1, rank - 1, /*reduce=*/true));
+  }
+
+  const int doubling_rank = rank < 2 * num_extra ? rank / 2 : rank - num_extra;
+  for (int s = 0; s < num_doubling_steps; ++s) {
+    const int partner = GroupRank(doubling_rank ^ (1 << s));
+    TF_RETURN_IF_ERROR(Exchange(s + 1, partner, partner, /*reduce=*/true));
+  }
+  if (col_params_->final_op) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->final_op.get(), &value_, &group_size_tensor_));
+  }
+
+  if (rank < 2 * num_extra) {
+    return Exchange(final_step, rank - 1, -1, /*reduce=*/false);
+  }
+  return Status::OK();
+}
+
+Status RecursiveDoublingReducer::Exchange(int step, int send_to_rank,
+                                          int recv_from_rank, bool reduce) {
+  mutex mu;
+  Status status;
+  BlockingCounter pending((send_to_rank >= 0) + (recv_from_rank >= 0));
+  auto transfer_done = [&mu, &status, &pending](const Status& s) {
+    {
+      mutex_lock l(mu);
+      status.Update(s);
+    }
+    pending.DecrementCount();
+  };
+  const CollInstanceParams& instance = col_params_->instance;
+  if (send_to_rank >= 0) {
+    col_ctx_->col_exec->PostToPeer(
+        instance.device_names[send_to_rank], instance.task_names[send_to_rank],
+        RecursiveDoublingBufKey(col_ctx_->exec_key, step,
+                                col_params_->default_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0), &value_,
+        col_ctx_->device_locality, transfer_done);
+  }
+  if (recv_from_rank >= 0) {
+    col_ctx_->col_exec->RecvFromPeer(
+        instance.device_names[recv_from_rank],
+        instance.task_names[recv_from_rank],
+        col_params_->task.is_local[recv_from_rank],
+        RecursiveDoublingBufKey(col_ctx_->exec_key, step, recv_from_rank),
+        col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
+        col_ctx_->op_ctx->output_alloc_attr(0),
+        reduce ? &tmp_value_ : &value_, col_ctx_->device_locality,
+        0 /*dev_to_dev_stream_index*/, transfer_done);
+  }
+  pending.Wait();
+  if (status.ok() && reduce) {
+    // Merge ops are commutative, so both partners of a step compute the same
+    // value.
+    status = collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op.get(), &value_, &tmp_value_);
+  }
+  if (!status.ok()) {
+    // Cancel the outstanding transfers of all other devices.
+    LOG(ERROR) << "Aborting RecursiveDoublingReduce with " << status;
+    col_ctx_->col_exec->StartAbort(status);
+  }
+  return status;
+}
+
+REGISTER_COLLECTIVE(RecursiveDoublingReduce, RecursiveDoublingReducer);
+
+}  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_DOUBLING_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_DOUBLING_REDUCER_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Recursive-doubling implementation of collective all-reduce, for small
+// tensors whose reduction is bound by latency rather than bandwidth.
+//
+// In each of log2(P) steps every device exchanges its whole tensor with the
+// device whose rank differs in one bit, and merges the two.  P is the
+// largest power of two not above the group size G; when G is not a power of
+// two, each of the first G - P even ranks first hands its tensor to the next
+// odd rank, and gets the result back from it at the end.  So a reduction
+// takes at most log2(P) + 2 sequential steps instead of the 2 * (G - 1) of a
+// ring, at the cost of sending the whole tensor in each step.
+class RecursiveDoublingReducer : public CollectiveImplementationInterface {
+ public:
+  RecursiveDoublingReducer();
+  ~RecursiveDoublingReducer() override = default;
+
+  Status InitializeCollectiveParams(CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  Status InitializeCollectiveContext(CollectiveContext* col_ctx) override;
+
+  // No-op for recursive doubling reduce.
+  Status InitializeCollectiveGroupRuntimeDetails(
+      CollGroupRuntimeDetails*) override {
+    return Status::OK();
+  }
+
+  // Begins execution of the recursive doubling reduce algorithm.
+  // Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Runs all steps of the algorithm on the output tensor, blocking until
+  // they complete.
+  Status RunSteps();
+
+  // Sends the current value to the device with rank `send_to_rank` unless it
+  // is negative, and receives the value of the device with rank
+  // `recv_from_rank` unless it is negative, blocking until both complete.
+  // The received value is merged into the current one if `reduce` is true,
+  // and replaces it otherwise.
+  Status Exchange(int step, int send_to_rank, int recv_from_rank, bool reduce);
+
+  // Returns the rank in the group of the device with `rank` among the P
+  // devices that take part in the recursive doubling steps.
+  int GroupRank(int rank) const;
+
+  CollectiveContext* col_ctx_;          // Not owned
+  const CollectiveParams* col_params_;  // Not owned
+  std::unique_ptr<CollectiveAdapter> ca_;
+  Tensor value_;      // alias to the output tensor
+  Tensor tmp_value_;  // receives values that are merged into value_
+  Tensor group_size_tensor_;
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RECURSIVE_DOUBLING_REDUCER_H_
@@ -290,14 +290,20 @@ void RingAlg::StartAbort(const Status& s) {
   }
 }
 
+Status RingAlg::ConsumeFinalValue() {
+  // Recover the output from the adaptor.
+  ca_->ConsumeFinalValue(col_ctx_->output);
+  return Status::OK();
+}
+
 void RingAlg::Finish(bool ok) {
+  Status s;
   if (ok) {
-    // Recover the output from the adaptor.
-    ca_->ConsumeFinalValue(col_ctx_->output);
+    s = ConsumeFinalValue();
   }
-  Status s;
   {
     mutex_lock l(status_mu_);
+    status_.Update(s);
     s = status_;
   }
   rfv_.clear();  // Give up Refs on output tensor.
@@ -53,6 +53,10 @@ class RingAlg : public CollectiveImplementationInterface {
   void StartAbort(const Status& s);
   void Finish(bool ok);
 
+  // Called by Finish() on success to move the final value from ca_ to the
+  // output tensor.
+  virtual Status ConsumeFinalValue();
+
   // Current status of a RingField
   enum RingFieldAction {
     RF_INIT = 0,    // Just initialized for a pass
@@ -44,6 +44,19 @@ limitations under the License.
 
 namespace tensorflow {
 
+namespace {
+// Rounds `value` plus `residual` to T in `rounded`, and stores the rounding
+// error in `residual`.
+template <typename T>
+void RoundWithErrorFeedback(const Tensor& value, Tensor* residual,
+                            Tensor* rounded) {
+  auto r = residual->flat<float>();
+  r += value.flat<float>();
+  rounded->flat<T>() = r.template cast<T>();
+  r -= rounded->flat<T>().template cast<float>();
+}
+}  // namespace
+
 RingReducer::~RingReducer() { group_size_tensor_ready_.WaitForNotification(); }
 
 Status RingReducer::InitializeCollectiveParams(CollectiveParams* col_params) {
@@ -118,7 +131,17 @@ void RingReducer::Run(StatusCallback done) {
 // which cannot be blocked.
 void RingReducer::ContinueAfterInputCopy() {
   AllocatorAttributes attr = col_ctx_->op_ctx->output_alloc_attr(0);
-  ca_.reset(MakeCollectiveAdapter(col_ctx_->output, group_size_ * num_subdivs_,
+  Tensor* value = col_ctx_->output;
+  if (col_params_->instance.communication_dtype != DT_INVALID) {
+    Status s = CastToCommunicationDtype(col_ctx_->device->GetAllocator(attr));
+    if (!s.ok()) {
+      group_size_tensor_ready_.Notify();
+      done_(s);
+      return;
+    }
+    value = &communication_value_;
+  }
+  ca_.reset(MakeCollectiveAdapter(value, group_size_ * num_subdivs_,
                                   col_ctx_->device->GetAllocator(attr)));
 
   if (col_params_->final_op) {
@@ -162,6 +185,54 @@ void RingReducer::ContinueAfterInputCopy() {
   Finish(RunAsyncParts());
 }
 
+Status RingReducer::CastToCommunicationDtype(Allocator* allocator) {
+  const DataType dtype = col_params_->instance.communication_dtype;
+  if (col_ctx_->output->dtype() != DT_FLOAT ||
+      (dtype != DT_HALF && dtype != DT_BFLOAT16)) {
+    return errors::InvalidArgument(
+        "RingReducer can only reduce float in half or bfloat16, not ",
+        DataTypeString(col_ctx_->output->dtype()), " in ",
+        DataTypeString(dtype));
+  }
+  if (col_params_->group.device_type != "CPU") {
+    return errors::Unimplemented(
+        "RingReducer only reduces in a lower precision on the CPU");
+  }
+  CollErrorFeedback* feedback = col_params_->error_feedback.get();
+  if (feedback == nullptr) {
+    return errors::Internal("Missing error feedback state for ",
+                            col_params_->name);
+  }
+  communication_value_ = Tensor(allocator, dtype, col_ctx_->output->shape());
+  mutex_lock l(feedback->mu);
+  if (!feedback->residual.IsSameSize(*col_ctx_->output)) {
+    feedback->residual = Tensor(DT_FLOAT, col_ctx_->output->shape());
+    feedback->residual.flat<float>().setZero();
+  }
+  if (dtype == DT_HALF) {
+    RoundWithErrorFeedback<Eigen::half>(*col_ctx_->output, &feedback->residual,
+                                        &communication_value_);
+  } else {
+    RoundWithErrorFeedback<bfloat16>(*col_ctx_->output, &feedback->residual,
+                                     &communication_value_);
+  }
+  return Status::OK();
+}
+
+Status RingReducer::ConsumeFinalValue() {
+  if (col_params_->instance.communication_dtype == DT_INVALID) {
+    return RingAlg::ConsumeFinalValue();
+  }
+  ca_->ConsumeFinalValue(&communication_value_);
+  auto output = col_ctx_->output->flat<float>();
+  if (communication_value_.dtype() == DT_HALF) {
+    output = communication_value_.flat<Eigen::half>().template cast<float>();
+  } else {
+    output = communication_value_.flat<bfloat16>().template cast<float>();
+  }
+  return Status::OK();
+}
+
 void RingReducer::InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
                                 int field_idx) {
   RingAlg::InitRingField(rf, chunk_idx, subdiv_idx, field_idx);
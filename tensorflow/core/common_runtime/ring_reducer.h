@@ -44,11 +44,20 @@ class RingReducer : public RingAlg {
  protected:
   void InitRingField(RingField* rf, int chunk_idx, int subdiv_idx,
                      int field_idx) override;
+  Status ConsumeFinalValue() override;
 
  private:
   void ContinueAfterInputCopy();
   bool RunAsyncParts();
 
+  // Adds the rounding error of the previous reduction to the output, and
+  // casts it to instance.communication_dtype in communication_value_, keeping
+  // the new rounding error for the next reduction.
+  Status CastToCommunicationDtype(Allocator* allocator);
+
+  // Reduced value in instance.communication_dtype, if set.
+  Tensor communication_value_;
+
   Tensor group_size_tensor_;
   Notification group_size_tensor_ready_;
 
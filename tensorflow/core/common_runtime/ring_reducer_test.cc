@@ -423,6 +423,9 @@ class RingReducerTest : public ::testing::Test {
       col_params_.instance = parent->col_params_.instance;
       col_params_.task.is_local = parent_->col_params_.task.is_local;
       col_params_.subdiv_rank = parent_->col_params_.subdiv_rank;
+      if (col_params_.instance.communication_dtype != DT_INVALID) {
+        col_params_.error_feedback = absl::make_unique<CollErrorFeedback>();
+      }
 
       int num_subdivs = static_cast<int>(col_params_.subdiv_rank.size());
       int group_size = col_params_.group.group_size;
@@ -471,10 +474,10 @@ class RingReducerTest : public ::testing::Test {
     }
 
     void DoReduce() {
-      col_params_.merge_op =
-          GetAdd(col_params_.instance.data_type, device_type_, device_);
-      col_params_.final_op =
-          GetDiv(col_params_.instance.data_type, device_type_, device_);
+      DataType op_dtype = col_params_.instance.communication_dtype;
+      if (op_dtype == DT_INVALID) op_dtype = col_params_.instance.data_type;
+      col_params_.merge_op = GetAdd(op_dtype, device_type_, device_);
+      col_params_.final_op = GetDiv(op_dtype, device_type_, device_);
 
       // Prepare an OpKernelContext.
       OpKernelContext::Params op_params;
@@ -660,6 +663,42 @@ TEST_F(RingReducerTest, AutomaticSubdivUpperBound) {
   RunSubdivPermsTest(&cp, {{0, 1, 2, 3}, {0, 1, 2, 3}}, {0, 0});
 }
 
+#if !(GOOGLE_CUDA || TENSORFLOW_USE_ROCM)
+TEST_F(RingReducerTest, ReduceFloatInBfloat16) {
+  const int kNumDevices = 2;
+  const int kTensorLen = 8;
+  col_params_.instance.communication_dtype = DT_BFLOAT16;
+  Init(/*num_workers=*/1, kNumDevices, DT_FLOAT, DEVICE_CPU,
+       /*num_subdivs=*/1, /*fail_after=*/0);
+  for (int di = 0; di < kNumDevices; ++di) {
+    instances_[di]->InitTensor(DT_FLOAT, TensorShape({kTensorLen}),
+                               [di](Tensor* t) {
+                                 for (int i = 0; i < kTensorLen; ++i) {
+                                   t->flat<float>()(i) = (di + 1) * i;
+                                 }
+                               });
+  }
+  Reduce(/*fail_after=*/0);
+  // All values are exactly representable in bfloat16, so the reduction is
+  // exact and leaves no rounding error behind.
+  for (int di = 0; di < kNumDevices; ++di) {
+    TF_EXPECT_OK(instances_[di]->status_);
+    const Tensor& actual = instances_[di]->tensor();
+    ASSERT_EQ(actual.dtype(), DT_FLOAT);
+    for (int i = 0; i < kTensorLen; ++i) {
+      EXPECT_FLOAT_EQ(1.5f * i, actual.flat<float>()(i))
+          << "Mismatch at device " << di << " index " << i;
+    }
+    CollErrorFeedback* feedback =
+        instances_[di]->col_params_.error_feedback.get();
+    mutex_lock l(feedback->mu);
+    for (int i = 0; i < kTensorLen; ++i) {
+      EXPECT_EQ(0.0f, feedback->residual.flat<float>()(i));
+    }
+  }
+}
+#endif
+
 // TODO(b/113171733): change to use TEST_P.
 #define DEF_TEST(B, T, W, D, S, L, A)                                         \
   TEST_F(RingReducerTest,                                                     \
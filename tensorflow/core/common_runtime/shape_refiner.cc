@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/eval_const_tensor.h"
 #include "tensorflow/core/common_runtime/function.h"
+#include "tensorflow/core/framework/attr_value_util.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -30,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/public/session.h"
 
 namespace tensorflow {
@@ -648,6 +651,20 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
 
   auto* c = ec->get_context();
 
+  string cache_key;
+  const bool cacheable = GetShapeCacheKey(node, c, &cache_key);
+  if (cacheable) {
+    auto it = shape_cache_.find(cache_key);
+    if (it != shape_cache_.end()) {
+      for (int i = 0; i < c->num_outputs(); ++i) {
+        ShapeHandle output;
+        TF_RETURN_IF_ERROR(c->MakeShapeFromTensorShape(it->second[i], &output));
+        c->set_output(i, output);
+      }
+      return Status::OK();
+    }
+  }
+
   c->set_input_tensors(input_tensors);
   c->set_input_tensors_as_shapes(input_tensors_as_shapes);
 
@@ -689,6 +706,27 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
   };
   TF_RETURN_IF_ERROR(run_inference_lambda());
 
+  if (cacheable) {
+    // The outputs only depend on the key if no input value was requested.
+    bool cache_outputs = true;
+    for (int i = 0; i < c->num_inputs() && cache_outputs; ++i) {
+      cache_outputs = !c->requested_input_tensor(i) &&
+                      !c->requested_input_tensor_as_partial_shape(i);
+    }
+    std::vector<TensorShape> output_shapes(c->num_outputs());
+    for (int i = 0; i < c->num_outputs() && cache_outputs; ++i) {
+      ShapeHandle output = c->output(i);
+      cache_outputs = c->FullyDefined(output) &&
+                      c->output_handle_shapes_and_types(i) == nullptr;
+      for (int d = 0; d < c->Rank(output) && cache_outputs; ++d) {
+        output_shapes[i].AddDim(c->Value(c->Dim(output, d)));
+      }
+    }
+    if (cache_outputs) {
+      shape_cache_.emplace(std::move(cache_key), std::move(output_shapes));
+    }
+  }
+
   // We must run the shape function repeatedly, in case users write
   // shape functions where they only conditionally call input_tensor()
   // based on the values of another input tensor.
@@ -755,6 +793,31 @@ Status ShapeRefiner::RunShapeFn(const Node* node,
   return Status::OK();
 }
 
+bool ShapeRefiner::GetShapeCacheKey(const Node* node, InferenceContext* c,
+                                    string* key) {
+  if (c->num_inputs() == 0) return false;
+  // The attrs of a NodeDef are unordered, so their hashes are combined with
+  // an order-independent sum.
+  uint64 attrs_hash = 0;
+  for (const auto& attr : node->def().attr()) {
+    attrs_hash +=
+        Hash64Combine(Hash64(attr.first), FastAttrValueHash(attr.second));
+  }
+  *key = strings::StrCat(node->type_string(), ":", attrs_hash);
+  for (int i = 0; i < c->num_inputs(); ++i) {
+    ShapeHandle input = c->input(i);
+    if (!c->FullyDefined(input) ||
+        c->input_handle_shapes_and_types(i) != nullptr) {
+      return false;
+    }
+    strings::StrAppend(key, ";");
+    for (int d = 0; d < c->Rank(input); ++d) {
+      strings::StrAppend(key, c->Value(c->Dim(input, d)), ",");
+    }
+  }
+  return true;
+}
+
 bool ShapeRefiner::SameDefinedShape(InferenceContext* c, ShapeHandle s0,
                                     ShapeHandle s1) {
   if (s0.SameHandle(s1)) {
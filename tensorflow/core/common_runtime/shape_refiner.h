@@ -228,6 +228,13 @@ class ShapeRefiner {
   Status RunShapeFn(const Node* node, const OpRegistrationData* op_reg_data,
                     ExtendedInferenceContext* ec);
 
+  // Sets <*key> to the key of <node> in shape_cache_, which identifies its op,
+  // attrs and input shapes in <c>. Returns false if the output shapes of
+  // <node> cannot be cached, because it has an input whose shape is not fully
+  // defined or that carries handle data.
+  bool GetShapeCacheKey(const Node* node,
+                        shape_inference::InferenceContext* c, string* key);
+
   int32 graph_def_version_;
   const OpRegistryInterface* const ops_registry_;
 
@@ -250,6 +257,13 @@ class ShapeRefiner {
   static constexpr int64 kMaxTensorSize = 1024;
   std::unordered_map<string, Tensor> const_tensor_map_;
 
+  // Output shapes inferred for nodes whose input shapes are fully defined,
+  // keyed by GetShapeCacheKey(). Repeated layers and calls of the same
+  // function with the same input shapes reuse them instead of running their
+  // shape function again. Only fully defined output shapes that did not need
+  // the values of any input are stored.
+  std::unordered_map<string, std::vector<TensorShape>> shape_cache_;
+
   bool require_shape_inference_fns_ = true;
   bool disable_constant_propagation_ = false;
 
@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/version.h"
 
@@ -149,6 +150,55 @@ TEST_F(ShapeRefinerTest, MatMul) {
   EXPECT_SHAPE("[2,2]", m, mm, 0);
 }
 
+namespace {
+
+int num_counted_shape_fn_calls = 0;
+
+// An op that counts the calls of its shape function.
+REGISTER_OP("CountedIdentity")
+    .Input("a: float")
+    .Output("o: float")
+    .Attr("n: int = 0")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      ++num_counted_shape_fn_calls;
+      return shape_inference::UnchangedShape(c);
+    });
+
+}  // namespace
+
+TEST_F(ShapeRefinerTest, CachesShapesOfRepeatedNodes) {
+  Scope root = Scope::NewRootScope();
+  auto a = ops::Const(root, {{1.0f}, {2.0f}});
+  auto b = ops::Const(root, {{1.0f, 2.0f}});
+  auto c = ops::Placeholder(root, DT_FLOAT);
+  Node* counted[5];
+  const std::vector<std::pair<Output, int>> inputs_and_attrs = {
+      {a, 0}, {a, 0}, {b, 0}, {a, 1}, {c, 0}};
+  for (int i = 0; i < 5; ++i) {
+    TF_ASSERT_OK(NodeBuilder(strings::StrCat("counted", i), "CountedIdentity")
+                     .Input(inputs_and_attrs[i].first.node())
+                     .Attr("n", inputs_and_attrs[i].second)
+                     .Finalize(root.graph(), &counted[i]));
+  }
+
+  ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
+  TF_ASSERT_OK(m.AddNode(a.node()));
+  TF_ASSERT_OK(m.AddNode(b.node()));
+  TF_ASSERT_OK(m.AddNode(c.node()));
+  num_counted_shape_fn_calls = 0;
+  for (Node* node : counted) {
+    TF_ASSERT_OK(m.AddNode(node));
+  }
+  // Only the second node has the same op, attrs and input shapes as an
+  // earlier one, and the last one's input shape is unknown.
+  EXPECT_EQ(4, num_counted_shape_fn_calls);
+  const char* expected[] = {"[2,1]", "[2,1]", "[1,2]", "[2,1]", "?"};
+  for (int i = 0; i < 5; ++i) {
+    shape_inference::InferenceContext* ctx = m.GetContext(counted[i]);
+    EXPECT_EQ(expected[i], ctx->DebugString(ctx->output(0)));
+  }
+}
+
 TEST_F(ShapeRefinerTest, BadShapes) {
   ShapeRefiner m(TF_GRAPH_DEF_VERSION, OpRegistry::Global());
   Scope root = Scope::NewRootScope();
@@ -0,0 +1,353 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/slab_cpu_allocator.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include <algorithm>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/framework/allocator_registry.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+constexpr size_t SlabCPUAllocator::kSlabBytes;
+constexpr size_t SlabCPUAllocator::kMinBlockBytes;
+constexpr size_t SlabCPUAllocator::kMaxBlockBytes;
+
+bool UseSlabCPUAllocator() {
+  static const bool use_slab_allocator = [] {
+    bool use_slab = false;
+    Status status =
+        ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_SLAB", false, &use_slab);
+    if (!status.ok()) {
+      LOG(ERROR) << "UseSlabCPUAllocator: " << status.error_message();
+    }
+    return use_slab;
+  }();
+  return use_slab_allocator;
+}
+
+namespace {
+
+// Updates `max` to be at least `value`.
+void UpdateMax(std::atomic<int64>* max, int64 value) {
+  int64 current = max->load(std::memory_order_relaxed);
+  while (value > current &&
+         !max->compare_exchange_weak(current, value,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+SlabCPUAllocator::SlabCPUAllocator(const Options& options)
+    : options_(options),
+      name_(options.numa_node == port::kNUMANoAffinity
+                ? "slab_cpu"
+                : strings::StrCat("slab_cpu_numa_", options.numa_node)) {
+  for (size_t block_bytes = kMinBlockBytes; block_bytes <= kMaxBlockBytes;
+       block_bytes *= 2) {
+    size_classes_.emplace_back(new SizeClass);
+    size_classes_.back()->block_bytes = block_bytes;
+  }
+  if (options_.trim_interval_micros > 0) {
+    trim_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), strings::StrCat(name_, "_trim"),
+        [this]() { TrimLoop(); }));
+  }
+}
+
+SlabCPUAllocator::~SlabCPUAllocator() {
+  {
+    mutex_lock l(trim_mu_);
+    stop_trim_ = true;
+    trim_cv_.notify_all();
+  }
+  // Joins the trim thread.
+  trim_thread_.reset();
+
+  mutex_lock l(slabs_mu_);
+  for (auto& entry : slabs_) {
+    FreeSlabMemory(entry.second->base);
+  }
+  slabs_.clear();
+}
+
+/* static */
+int SlabCPUAllocator::SizeClassFor(size_t alignment, size_t num_bytes) {
+  // A block of a power-of-two size class is aligned to its size, because
+  // slabs are aligned to kSlabBytes.
+  const size_t bytes = std::max({num_bytes, alignment, kMinBlockBytes});
+  if (bytes > kMaxBlockBytes) return -1;
+  return Log2Ceiling64(bytes) - Log2Ceiling64(kMinBlockBytes);
+}
+
+void* SlabCPUAllocator::AllocateSlabMemory() {
+  void* ptr = port::NUMAMalloc(options_.numa_node, kSlabBytes, kSlabBytes);
+  if (ptr == nullptr) return nullptr;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (options_.use_huge_pages) {
+    // Best effort: failure only means the slab is backed by regular pages.
+    madvise(ptr, kSlabBytes, MADV_HUGEPAGE);
+  }
+#endif
+  return ptr;
+}
+
+void SlabCPUAllocator::FreeSlabMemory(void* ptr) {
+  port::NUMAFree(ptr, kSlabBytes);
+}
+
+bool SlabCPUAllocator::AddSlab(int size_class, SizeClass* sc) {
+  char* base = static_cast<char*>(AllocateSlabMemory());
+  if (base == nullptr) return false;
+  auto slab = absl::make_unique<Slab>();
+  slab->base = base;
+  slab->size_class = size_class;
+  slab->num_used = 0;
+  sc->slabs.push_back(slab.get());
+  {
+    mutex_lock l(slabs_mu_);
+    slabs_[reinterpret_cast<uintptr_t>(base)] = std::move(slab);
+  }
+  // Push blocks in reverse so that they are handed out in address order.
+  for (size_t offset = kSlabBytes; offset >= sc->block_bytes;) {
+    offset -= sc->block_bytes;
+    sc->free_blocks.push_back(base + offset);
+  }
+  const int64 reserved =
+      bytes_reserved_.fetch_add(kSlabBytes, std::memory_order_relaxed) +
+      kSlabBytes;
+  UpdateMax(&peak_bytes_reserved_, reserved);
+  return true;
+}
+
+SlabCPUAllocator::Slab* SlabCPUAllocator::FindSlab(const void* ptr) const {
+  const uintptr_t base = reinterpret_cast<uintptr_t>(ptr) &
+                         ~static_cast<uintptr_t>(kSlabBytes - 1);
+  tf_shared_lock l(slabs_mu_);
+  auto it = slabs_.find(base);
+  return it == slabs_.end() ? nullptr : it->second.get();
+}
+
+void SlabCPUAllocator::RecordAlloc(size_t bytes) {
+  num_allocs_.fetch_add(1, std::memory_order_relaxed);
+  const int64 in_use =
+      bytes_in_use_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  UpdateMax(&peak_bytes_in_use_, in_use);
+  UpdateMax(&largest_alloc_size_, bytes);
+}
+
+void SlabCPUAllocator::RecordFree(size_t bytes) {
+  bytes_in_use_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void* SlabCPUAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  const int size_class = SizeClassFor(alignment, num_bytes);
+  if (size_class < 0) {
+    void* ptr = port::NUMAMalloc(options_.numa_node, num_bytes,
+                                 static_cast<int>(alignment));
+    if (ptr == nullptr) return nullptr;
+    {
+      mutex_lock l(large_mu_);
+      large_allocs_[ptr] = num_bytes;
+    }
+    RecordAlloc(num_bytes);
+    const int64 reserved =
+        bytes_reserved_.fetch_add(num_bytes, std::memory_order_relaxed) +
+        num_bytes;
+    UpdateMax(&peak_bytes_reserved_, reserved);
+    return ptr;
+  }
+
+  SizeClass* sc = size_classes_[size_class].get();
+  void* ptr;
+  {
+    mutex_lock l(sc->mu);
+    if (sc->free_blocks.empty() && !AddSlab(size_class, sc)) {
+      LOG(WARNING) << Name() << " failed to allocate a new slab for "
+                   << num_bytes << " bytes";
+      return nullptr;
+    }
+    ptr = sc->free_blocks.back();
+    sc->free_blocks.pop_back();
+    // Mark the slab as used before dropping `sc->mu`, so that Trim() cannot
+    // release it.
+    ++FindSlab(ptr)->num_used;
+  }
+  RecordAlloc(sc->block_bytes);
+  return ptr;
+}
+
+void SlabCPUAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  Slab* slab = FindSlab(ptr);
+  if (slab == nullptr) {
+    size_t num_bytes;
+    {
+      mutex_lock l(large_mu_);
+      auto it = large_allocs_.find(ptr);
+      CHECK(it != large_allocs_.end())
+          << "Deallocating pointer not allocated by " << Name() << ": " << ptr;
+      num_bytes = it->second;
+      large_allocs_.erase(it);
+    }
+    port::NUMAFree(ptr, num_bytes);
+    RecordFree(num_bytes);
+    bytes_reserved_.fetch_sub(num_bytes, std::memory_order_relaxed);
+    return;
+  }
+  // The slab cannot be trimmed while `ptr` is live, so it is safe to use it
+  // after dropping `slabs_mu_`.
+  SizeClass* sc = size_classes_[slab->size_class].get();
+  {
+    mutex_lock l(sc->mu);
+    sc->free_blocks.push_back(ptr);
+    --slab->num_used;
+  }
+  RecordFree(sc->block_bytes);
+}
+
+size_t SlabCPUAllocator::AllocatedSizeSlow(const void* ptr) const {
+  Slab* slab = FindSlab(ptr);
+  if (slab != nullptr) {
+    return size_classes_[slab->size_class]->block_bytes;
+  }
+  mutex_lock l(large_mu_);
+  auto it = large_allocs_.find(ptr);
+  return it == large_allocs_.end() ? 0 : it->second;
+}
+
+size_t SlabCPUAllocator::Trim() {
+  size_t released = 0;
+  for (auto& sc_ptr : size_classes_) {
+    SizeClass* sc = sc_ptr.get();
+    mutex_lock l(sc->mu);
+    std::vector<Slab*> to_release;
+    int num_free_slabs = 0;
+    for (Slab* slab : sc->slabs) {
+      if (slab->num_used == 0 &&
+          ++num_free_slabs > options_.max_free_slabs_per_class) {
+        to_release.push_back(slab);
+      }
+    }
+    if (to_release.empty()) continue;
+
+    auto in_released_slab = [&to_release](const void* ptr) {
+      const uintptr_t base = reinterpret_cast<uintptr_t>(ptr) &
+                             ~static_cast<uintptr_t>(kSlabBytes - 1);
+      for (const Slab* slab : to_release) {
+        if (reinterpret_cast<uintptr_t>(slab->base) == base) return true;
+      }
+      return false;
+    };
+    sc->free_blocks.erase(std::remove_if(sc->free_blocks.begin(),
+                                         sc->free_blocks.end(),
+                                         in_released_slab),
+                          sc->free_blocks.end());
+    sc->slabs.erase(std::remove_if(sc->slabs.begin(), sc->slabs.end(),
+                                   [&to_release](const Slab* slab) {
+                                     return std::find(to_release.begin(),
+                                                      to_release.end(),
+                                                      slab) != to_release.end();
+                                   }),
+                    sc->slabs.end());
+    for (Slab* slab : to_release) {
+      char* base = slab->base;
+      {
+        mutex_lock sl(slabs_mu_);
+        slabs_.erase(reinterpret_cast<uintptr_t>(base));
+      }
+      FreeSlabMemory(base);
+      released += kSlabBytes;
+    }
+  }
+  bytes_reserved_.fetch_sub(released, std::memory_order_relaxed);
+  if (released > 0) {
+    VLOG(2) << Name() << " released " << released << " bytes of empty slabs";
+  }
+  return released;
+}
+
+void SlabCPUAllocator::TrimLoop() {
+  while (true) {
+    {
+      mutex_lock l(trim_mu_);
+      if (stop_trim_) return;
+      trim_cv_.wait_for(
+          l, std::chrono::microseconds(options_.trim_interval_micros));
+      if (stop_trim_) return;
+    }
+    Trim();
+  }
+}
+
+absl::optional<AllocatorStats> SlabCPUAllocator::GetStats() {
+  AllocatorStats stats;
+  stats.num_allocs = num_allocs_.load(std::memory_order_relaxed);
+  stats.bytes_in_use = bytes_in_use_.load(std::memory_order_relaxed);
+  stats.peak_bytes_in_use = peak_bytes_in_use_.load(std::memory_order_relaxed);
+  stats.largest_alloc_size =
+      largest_alloc_size_.load(std::memory_order_relaxed);
+  stats.bytes_reserved = bytes_reserved_.load(std::memory_order_relaxed);
+  stats.peak_bytes_reserved =
+      peak_bytes_reserved_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void SlabCPUAllocator::ClearStats() {
+  num_allocs_.store(0, std::memory_order_relaxed);
+  peak_bytes_in_use_.store(bytes_in_use_.load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+  largest_alloc_size_.store(0, std::memory_order_relaxed);
+  peak_bytes_reserved_.store(bytes_reserved_.load(std::memory_order_relaxed),
+                             std::memory_order_relaxed);
+}
+
+namespace {
+
+class SlabCPUAllocatorFactory : public AllocatorFactory {
+ public:
+  bool NumaEnabled() override { return UseSlabCPUAllocator(); }
+
+  Allocator* CreateAllocator() override {
+    return new SlabCPUAllocator(SlabCPUAllocator::Options());
+  }
+
+  SubAllocator* CreateSubAllocator(int numa_node) override {
+    // Sub-allocators hand out large regions to other allocators, so slabs
+    // would only add overhead.
+    return new BasicCPUAllocator(numa_node, {}, {});
+  }
+};
+
+// Takes precedence over the default CPU allocator (priority 100) only when
+// selected through TF_CPU_ALLOCATOR_USE_SLAB.
+REGISTER_MEM_ALLOCATOR("SlabCPUAllocator", (UseSlabCPUAllocator() ? 300 : 10),
+                       SlabCPUAllocatorFactory);
+
+}  // namespace
+
+}  // namespace tensorflow
@@ -0,0 +1,156 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Returns true if the TF_CPU_ALLOCATOR_USE_SLAB environment variable selects
+// SlabCPUAllocator as the default CPU allocator.
+bool UseSlabCPUAllocator();
+
+// A CPU allocator that carves small allocations out of large, aligned slabs
+// with one slab per power-of-two size class, instead of passing every request
+// to port::AlignedMalloc.
+//
+// Slabs are allocated on a given NUMA node and, where supported, advised to be
+// backed by transparent huge pages. Freed blocks are kept on per-class free
+// lists; a background thread periodically returns slabs that have no live
+// allocations to the system, keeping a few per class for reuse. Allocations
+// larger than the largest size class are forwarded to the system allocator.
+//
+// This class is thread-safe.
+class SlabCPUAllocator : public Allocator {
+ public:
+  struct Options {
+    // The NUMA node on which slabs are allocated.
+    int numa_node = port::kNUMANoAffinity;
+    // If true, advise the kernel to back slabs with huge pages.
+    bool use_huge_pages = true;
+    // Period of the background trim thread. If zero, no thread is started
+    // and slabs are only released by explicit calls to Trim().
+    int64 trim_interval_micros = 10 * 1000 * 1000;
+    // The number of empty slabs kept per size class by Trim().
+    int max_free_slabs_per_class = 2;
+  };
+
+  // The size of a slab, which is also its alignment.
+  static constexpr size_t kSlabBytes = 2 << 20;
+  // The smallest and largest size class.
+  static constexpr size_t kMinBlockBytes = Allocator::kAllocatorAlignment;
+  static constexpr size_t kMaxBlockBytes = 256 << 10;
+
+  explicit SlabCPUAllocator(const Options& options);
+  ~SlabCPUAllocator() override;
+
+  string Name() override { return name_; }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+
+  size_t AllocatedSizeSlow(const void* ptr) const override;
+
+  absl::optional<AllocatorStats> GetStats() override;
+  void ClearStats() override;
+
+  // Returns empty slabs, beyond `max_free_slabs_per_class` per size class, to
+  // the system. Returns the number of bytes released.
+  size_t Trim();
+
+ private:
+  struct Slab {
+    char* base;
+    int size_class;
+    // Number of blocks of this slab that are currently allocated.
+    int num_used;
+  };
+
+  struct SizeClass {
+    mutex mu;
+    size_t block_bytes = 0;
+    std::vector<void*> free_blocks TF_GUARDED_BY(mu);
+    std::vector<Slab*> slabs TF_GUARDED_BY(mu);
+  };
+
+  // Returns the index of the smallest size class holding `num_bytes` bytes
+  // at `alignment`, or -1 if the request is too large for any class.
+  static int SizeClassFor(size_t alignment, size_t num_bytes);
+
+  // Allocates a new slab for `size_class` and adds its blocks to the free
+  // list. Returns false if the system is out of memory.
+  bool AddSlab(int size_class, SizeClass* sc)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(sc->mu);
+
+  // Returns the slab containing `ptr`, or nullptr if `ptr` was not carved out
+  // of a slab.
+  Slab* FindSlab(const void* ptr) const;
+
+  void* AllocateSlabMemory();
+  void FreeSlabMemory(void* ptr);
+
+  void RecordAlloc(size_t bytes);
+  void RecordFree(size_t bytes);
+
+  void TrimLoop();
+
+  const Options options_;
+  const string name_;
+
+  std::vector<std::unique_ptr<SizeClass>> size_classes_;
+
+  mutable mutex slabs_mu_;
+  absl::flat_hash_map<uintptr_t, std::unique_ptr<Slab>> slabs_
+      TF_GUARDED_BY(slabs_mu_);
+
+  // Allocations too large for any size class, with their sizes.
+  mutable mutex large_mu_;
+  absl::flat_hash_map<const void*, size_t> large_allocs_
+      TF_GUARDED_BY(large_mu_);
+
+  // Stats. These are kept as atomics so that they do not add a shared lock to
+  // the allocation path.
+  std::atomic<int64> num_allocs_{0};
+  std::atomic<int64> bytes_in_use_{0};
+  std::atomic<int64> peak_bytes_in_use_{0};
+  std::atomic<int64> largest_alloc_size_{0};
+  std::atomic<int64> bytes_reserved_{0};
+  std::atomic<int64> peak_bytes_reserved_{0};
+
+  mutex trim_mu_;
+  condition_variable trim_cv_;
+  bool stop_trim_ TF_GUARDED_BY(trim_mu_) = false;
+  std::unique_ptr<Thread> trim_thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SlabCPUAllocator);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SLAB_CPU_ALLOCATOR_H_
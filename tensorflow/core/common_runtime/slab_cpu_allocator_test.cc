@@ -0,0 +1,141 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/slab_cpu_allocator.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+SlabCPUAllocator::Options TestOptions() {
+  SlabCPUAllocator::Options options;
+  options.trim_interval_micros = 0;
+  options.max_free_slabs_per_class = 0;
+  return options;
+}
+
+TEST(SlabCPUAllocatorTest, AllocateAndFree) {
+  SlabCPUAllocator a(TestOptions());
+  std::vector<void*> ptrs;
+  for (size_t size : {1, 7, 64, 100, 4096, 100000, 256 << 10, 1 << 20}) {
+    void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, size);
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) %
+                     Allocator::kAllocatorAlignment);
+    EXPECT_GE(a.AllocatedSizeSlow(p), size);
+    memset(p, 0xab, size);
+    ptrs.push_back(p);
+  }
+  for (void* p : ptrs) a.DeallocateRaw(p);
+  EXPECT_EQ(0, a.GetStats()->bytes_in_use);
+}
+
+TEST(SlabCPUAllocatorTest, LargeAlignment) {
+  SlabCPUAllocator a(TestOptions());
+  void* p = a.AllocateRaw(4096, 16);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 4096);
+  a.DeallocateRaw(p);
+}
+
+TEST(SlabCPUAllocatorTest, ReusesFreedBlocks) {
+  SlabCPUAllocator a(TestOptions());
+  void* p1 = a.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  a.DeallocateRaw(p1);
+  void* p2 = a.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  EXPECT_EQ(p1, p2);
+  a.DeallocateRaw(p2);
+}
+
+TEST(SlabCPUAllocatorTest, Stats) {
+  SlabCPUAllocator a(TestOptions());
+  void* p1 = a.AllocateRaw(Allocator::kAllocatorAlignment, 1000);
+  void* p2 = a.AllocateRaw(Allocator::kAllocatorAlignment, 1 << 20);
+  absl::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(2, stats->num_allocs);
+  EXPECT_EQ(1024 + (1 << 20), stats->bytes_in_use);
+  EXPECT_EQ(1 << 20, stats->largest_alloc_size);
+  EXPECT_EQ(SlabCPUAllocator::kSlabBytes + (1 << 20), stats->bytes_reserved);
+
+  a.DeallocateRaw(p2);
+  a.DeallocateRaw(p1);
+  stats = a.GetStats();
+  EXPECT_EQ(0, stats->bytes_in_use);
+  EXPECT_EQ(1024 + (1 << 20), stats->peak_bytes_in_use);
+  EXPECT_EQ(SlabCPUAllocator::kSlabBytes, stats->bytes_reserved);
+
+  a.ClearStats();
+  stats = a.GetStats();
+  EXPECT_EQ(0, stats->num_allocs);
+  EXPECT_EQ(0, stats->peak_bytes_in_use);
+}
+
+TEST(SlabCPUAllocatorTest, TrimReleasesEmptySlabs) {
+  SlabCPUAllocator a(TestOptions());
+  void* small = a.AllocateRaw(Allocator::kAllocatorAlignment, 64);
+  void* other = a.AllocateRaw(Allocator::kAllocatorAlignment, 8192);
+  a.DeallocateRaw(other);
+  EXPECT_EQ(2 * SlabCPUAllocator::kSlabBytes, a.GetStats()->bytes_reserved);
+
+  // Only the 8KB class slab is empty.
+  EXPECT_EQ(SlabCPUAllocator::kSlabBytes, a.Trim());
+  EXPECT_EQ(SlabCPUAllocator::kSlabBytes, a.GetStats()->bytes_reserved);
+  EXPECT_EQ(0, a.Trim());
+
+  a.DeallocateRaw(small);
+  EXPECT_EQ(SlabCPUAllocator::kSlabBytes, a.Trim());
+  EXPECT_EQ(0, a.GetStats()->bytes_reserved);
+
+  // The allocator still works after its slabs were released.
+  void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, 8192);
+  ASSERT_NE(p, nullptr);
+  a.DeallocateRaw(p);
+}
+
+TEST(SlabCPUAllocatorTest, ConcurrentAllocations) {
+  SlabCPUAllocator::Options options = TestOptions();
+  options.trim_interval_micros = 1000;
+  SlabCPUAllocator a(options);
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 1000; ++i) {
+          const size_t size = 1 + (i * 37 + t * 101) % 20000;
+          void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, size);
+          CHECK(p != nullptr);
+          memset(p, t, size);
+          ptrs.push_back(p);
+          if (i % 3 == 0) {
+            a.DeallocateRaw(ptrs.back());
+            ptrs.pop_back();
+          }
+        }
+        for (void* p : ptrs) a.DeallocateRaw(p);
+      });
+    }
+  }
+  EXPECT_EQ(0, a.GetStats()->bytes_in_use);
+  EXPECT_EQ(8000, a.GetStats()->num_allocs);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,299 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUpToAlignment(size_t bytes) {
+  constexpr size_t kAlignment = Allocator::kAllocatorAlignment;
+  return (bytes + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+// Returns the size in bytes of output `index` of the node with inference
+// context `c`, or 0 if it is not statically known.
+size_t StaticOutputBytes(shape_inference::InferenceContext* c, DataType dtype,
+                         int index) {
+  shape_inference::ShapeHandle shape = c->output(index);
+  if (!c->FullyDefined(shape)) return 0;
+  int64 num_elements = 1;
+  for (int d = 0; d < c->Rank(shape); ++d) {
+    num_elements *= c->Value(c->Dim(shape, d));
+  }
+  return num_elements * DataTypeSize(dtype);
+}
+
+}  // namespace
+
+/* static */
+Status StaticMemoryPlan::Build(const Graph& graph,
+                               std::unique_ptr<StaticMemoryPlan>* plan) {
+  plan->reset();
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsControlFlow()) {
+      VLOG(1) << "Not planning memory for a graph with control flow node "
+              << n->name();
+      return Status::OK();
+    }
+  }
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+  std::vector<int> position(graph.num_node_ids(), -1);
+  for (int i = 0; i < order.size(); ++i) {
+    position[order[i]->id()] = i;
+  }
+
+  ShapeRefiner refiner(graph.versions(), graph.op_registry());
+  refiner.set_require_shape_inference_fns(false);
+
+  std::unique_ptr<StaticMemoryPlan> result(new StaticMemoryPlan);
+  result->output_start_.assign(graph.num_node_ids(), -1);
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    Status s = refiner.AddNode(n);
+    if (!s.ok()) {
+      VLOG(2) << "Shape inference failed for " << n->name() << ": " << s;
+      continue;
+    }
+    // The outputs of these nodes are not allocated by their kernels.
+    if (n->IsConstant() || n->IsArg() || n->IsRecv()) continue;
+
+    const int num_outputs = n->num_outputs();
+    std::vector<int> last_use(num_outputs, position[n->id()]);
+    std::vector<bool> escapes(num_outputs, false);
+    for (const Edge* e : n->out_edges()) {
+      if (e->IsControlEdge()) continue;
+      const Node* dst = e->dst();
+      // Sent and returned tensors outlive the step, so there is no point in
+      // reserving arena bytes for them.
+      if (dst->IsSend() || dst->IsRetval()) {
+        escapes[e->src_output()] = true;
+      }
+      last_use[e->src_output()] =
+          std::max(last_use[e->src_output()], position[dst->id()]);
+    }
+
+    shape_inference::InferenceContext* c = refiner.GetContext(n);
+    const int output_start = result->output_buffer_.size();
+    bool any_planned = false;
+    for (int i = 0; i < num_outputs; ++i) {
+      const DataType dtype = n->output_type(i);
+      size_t bytes = 0;
+      if (!escapes[i] && !IsRefType(dtype) && DataTypeCanUseMemcpy(dtype)) {
+        bytes = StaticOutputBytes(c, dtype, i);
+      }
+      if (bytes == 0) {
+        result->output_buffer_.push_back(-1);
+        continue;
+      }
+      Buffer buffer;
+      buffer.node_id = n->id();
+      buffer.output = i;
+      buffer.offset = 0;
+      buffer.bytes = RoundUpToAlignment(bytes);
+      buffer.first_use = position[n->id()];
+      buffer.last_use = last_use[i];
+      result->output_buffer_.push_back(result->buffers_.size());
+      result->buffers_.push_back(std::move(buffer));
+      any_planned = true;
+    }
+    if (any_planned) {
+      result->output_start_[n->id()] = output_start;
+    } else {
+      result->output_buffer_.resize(output_start);
+    }
+  }
+
+  if (result->buffers_.empty()) return Status::OK();
+  result->AssignOffsets();
+  VLOG(1) << "Planned " << result->buffers_.size() << " outputs in an arena of "
+          << result->arena_bytes_ << " bytes";
+  *plan = std::move(result);
+  return Status::OK();
+}
+
+void StaticMemoryPlan::AssignOffsets() {
+  // Place the largest buffers first, each in the smallest gap that fits it
+  // among the already placed buffers with overlapping lifetimes.
+  std::vector<int> order(buffers_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [this](int a, int b) {
+    if (buffers_[a].bytes != buffers_[b].bytes) {
+      return buffers_[a].bytes > buffers_[b].bytes;
+    }
+    if (buffers_[a].first_use != buffers_[b].first_use) {
+      return buffers_[a].first_use < buffers_[b].first_use;
+    }
+    return a < b;
+  });
+
+  constexpr size_t kNoOffset = std::numeric_limits<size_t>::max();
+  std::vector<int> placed;
+  std::vector<const Buffer*> overlapping;
+  for (int index : order) {
+    Buffer& buffer = buffers_[index];
+    overlapping.clear();
+    for (int other_index : placed) {
+      const Buffer& other = buffers_[other_index];
+      if (other.first_use <= buffer.last_use &&
+          buffer.first_use <= other.last_use) {
+        overlapping.push_back(&other);
+      }
+    }
+    std::sort(overlapping.begin(), overlapping.end(),
+              [](const Buffer* a, const Buffer* b) {
+                return a->offset < b->offset;
+              });
+    size_t best_offset = kNoOffset;
+    size_t best_gap = kNoOffset;
+    size_t current = 0;
+    for (const Buffer* other : overlapping) {
+      if (other->offset >= current + buffer.bytes &&
+          other->offset - current < best_gap) {
+        best_gap = other->offset - current;
+        best_offset = current;
+      }
+      current = std::max(current, other->offset + other->bytes);
+    }
+    buffer.offset = best_offset == kNoOffset ? current : best_offset;
+    arena_bytes_ = std::max(arena_bytes_, buffer.offset + buffer.bytes);
+    placed.push_back(index);
+  }
+
+  // Record which buffers share arena bytes.
+  std::sort(order.begin(), order.end(), [this](int a, int b) {
+    return buffers_[a].offset < buffers_[b].offset;
+  });
+  for (int i = 0; i < order.size(); ++i) {
+    Buffer& buffer = buffers_[order[i]];
+    const size_t end = buffer.offset + buffer.bytes;
+    for (int j = i + 1; j < order.size() && buffers_[order[j]].offset < end;
+         ++j) {
+      buffer.conflicts.push_back(order[j]);
+      buffers_[order[j]].conflicts.push_back(order[i]);
+    }
+  }
+}
+
+// Hands out the arena region of one planned buffer.
+class StepMemoryArena::BufferAllocator : public Allocator {
+ public:
+  BufferAllocator(StepMemoryArena* arena, int buffer)
+      : arena_(arena), buffer_(buffer) {}
+
+  string Name() override { return arena_->allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return arena_->AllocateBuffer(buffer_, alignment, num_bytes);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    arena_->DeallocateBuffer(buffer_, ptr);
+  }
+
+ private:
+  StepMemoryArena* const arena_;
+  const int buffer_;
+};
+
+StepMemoryArena::StepMemoryArena(std::shared_ptr<const StaticMemoryPlan> plan,
+                                 Allocator* allocator)
+    : plan_(std::move(plan)), allocator_(allocator) {
+  AllocationAttributes allocation_attr;
+  allocation_attr.no_retry_on_failure = true;
+  base_ = static_cast<char*>(allocator_->AllocateRaw(
+      Allocator::kAllocatorAlignment, plan_->arena_bytes(), allocation_attr));
+  if (base_ == nullptr) {
+    VLOG(1) << "Failed to allocate a " << plan_->arena_bytes()
+            << " byte arena; all outputs use " << allocator_->Name();
+  }
+
+  buffer_allocators_.reserve(plan_->num_buffers());
+  for (int i = 0; i < plan_->num_buffers(); ++i) {
+    buffer_allocators_.emplace_back(new BufferAllocator(this, i));
+  }
+  output_allocators_.resize(plan_->num_outputs(), nullptr);
+  for (int i = 0; i < plan_->num_outputs(); ++i) {
+    const int buffer = plan_->output_buffer(i);
+    if (buffer >= 0) output_allocators_[i] = buffer_allocators_[buffer].get();
+  }
+  states_.resize(plan_->num_buffers(), BufferState::kUnused);
+}
+
+StepMemoryArena::~StepMemoryArena() {
+  if (base_ != nullptr) allocator_->DeallocateRaw(base_);
+}
+
+void* StepMemoryArena::AllocateBuffer(int buffer, size_t alignment,
+                                      size_t num_bytes) {
+  // Every allocation, including fallback ones, is released through a
+  // BufferAllocator owned by `this`.
+  Ref();
+  const StaticMemoryPlan::Buffer& planned = plan_->buffer(buffer);
+  {
+    mutex_lock l(mu_);
+    if (base_ != nullptr && num_bytes <= planned.bytes &&
+        alignment <= Allocator::kAllocatorAlignment &&
+        states_[buffer] == BufferState::kUnused &&
+        std::none_of(planned.conflicts.begin(), planned.conflicts.end(),
+                     [this](int other) {
+                       return states_[other] == BufferState::kLive;
+                     })) {
+      states_[buffer] = BufferState::kLive;
+      ++num_planned_allocations_;
+      return base_ + planned.offset;
+    }
+    ++num_fallback_allocations_;
+  }
+  void* ptr = allocator_->AllocateRaw(alignment, num_bytes);
+  if (ptr == nullptr) Unref();
+  return ptr;
+}
+
+void StepMemoryArena::DeallocateBuffer(int buffer, void* ptr) {
+  char* p = static_cast<char*>(ptr);
+  if (base_ != nullptr && p >= base_ && p < base_ + plan_->arena_bytes()) {
+    mutex_lock l(mu_);
+    states_[buffer] = BufferState::kReleased;
+  } else {
+    allocator_->DeallocateRaw(ptr);
+  }
+  Unref();
+}
+
+int64 StepMemoryArena::num_planned_allocations() const {
+  mutex_lock l(mu_);
+  return num_planned_allocations_;
+}
+
+int64 StepMemoryArena::num_fallback_allocations() const {
+  mutex_lock l(mu_);
+  return num_fallback_allocations_;
+}
+
+}  // namespace tensorflow
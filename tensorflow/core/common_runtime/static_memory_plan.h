@@ -0,0 +1,149 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A buffer-reuse plan for the outputs of a graph whose shapes are statically
+// known.
+//
+// Every node output whose shape is fully defined after shape inference, and
+// whose buffer does not leave the graph, is assigned an offset in a single
+// arena. Outputs whose lifetimes (from the producer to the last consumer, in
+// topological order) do not overlap may share arena bytes, in the same way as
+// TF Lite's ArenaPlanner assigns offsets for its interpreter.
+//
+// Lifetimes are only an estimate for a graph that runs in parallel, and kernels
+// may extend a buffer's lifetime by forwarding it. StepMemoryArena therefore
+// checks at run time that no buffer sharing bytes with a planned buffer is
+// still live before handing it out, and falls back to the device allocator
+// otherwise.
+class StaticMemoryPlan {
+ public:
+  struct Buffer {
+    int node_id;
+    int output;
+    // Offset into the arena, a multiple of Allocator::kAllocatorAlignment.
+    size_t offset;
+    size_t bytes;
+    // Topological positions of the producer and of the last consumer.
+    int first_use;
+    int last_use;
+    // Indices of the buffers whose arena bytes overlap with this one.
+    std::vector<int> conflicts;
+  };
+
+  // Builds a plan for the outputs of `graph`. Sets `*plan` to nullptr if none
+  // of the outputs can be planned, e.g. because the graph contains control
+  // flow, whose nodes may run more than once per step.
+  static Status Build(const Graph& graph,
+                      std::unique_ptr<StaticMemoryPlan>* plan);
+
+  size_t arena_bytes() const { return arena_bytes_; }
+  int num_buffers() const { return buffers_.size(); }
+  const Buffer& buffer(int index) const { return buffers_[index]; }
+
+  // Returns the index of the first entry, in an array of `num_outputs()`
+  // entries indexed by output, that belongs to the node with id `node_id`,
+  // or -1 if none of its outputs are planned.
+  int output_start(int node_id) const {
+    return static_cast<size_t>(node_id) < output_start_.size()
+               ? output_start_[node_id]
+               : -1;
+  }
+  int num_outputs() const { return output_buffer_.size(); }
+
+  // Returns the buffer index for the given entry, or -1 if it is not planned.
+  int output_buffer(int index) const { return output_buffer_[index]; }
+
+ private:
+  StaticMemoryPlan() = default;
+
+  // Assigns offsets to `buffers_` and computes their conflicts.
+  void AssignOffsets();
+
+  size_t arena_bytes_ = 0;
+  std::vector<Buffer> buffers_;
+  std::vector<int> output_start_;
+  std::vector<int> output_buffer_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlan);
+};
+
+// The memory for one step of a graph executed with a StaticMemoryPlan.
+//
+// The arena is allocated from `allocator` when the step starts. For each
+// planned output, OutputAllocators() provides an Allocator that returns the
+// planned region of the arena, or a buffer from `allocator` if the region is
+// still in use. Each allocation holds a reference on the arena, so that
+// tensors that outlive the step (e.g. fetched outputs) keep it alive.
+class StepMemoryArena : public core::RefCounted {
+ public:
+  StepMemoryArena(std::shared_ptr<const StaticMemoryPlan> plan,
+                  Allocator* allocator);
+  ~StepMemoryArena() override;
+
+  // Returns an array indexed by output number for the node with id `node_id`,
+  // to be used as `OpKernelContext::Params::output_allocator_array`, or
+  // nullptr if none of the node's outputs are planned.
+  Allocator* const* OutputAllocators(int node_id) const {
+    const int start = plan_->output_start(node_id);
+    return start < 0 ? nullptr : &output_allocators_[start];
+  }
+
+  // Returns the number of allocations that were placed in the arena, and that
+  // fell back to the underlying allocator.
+  int64 num_planned_allocations() const;
+  int64 num_fallback_allocations() const;
+
+ private:
+  class BufferAllocator;
+
+  enum class BufferState { kUnused, kLive, kReleased };
+
+  void* AllocateBuffer(int buffer, size_t alignment, size_t num_bytes);
+  void DeallocateBuffer(int buffer, void* ptr);
+
+  const std::shared_ptr<const StaticMemoryPlan> plan_;
+  Allocator* const allocator_;
+  char* base_ = nullptr;
+
+  std::vector<std::unique_ptr<BufferAllocator>> buffer_allocators_;
+  std::vector<Allocator*> output_allocators_;
+
+  mutable mutex mu_;
+  std::vector<BufferState> states_ TF_GUARDED_BY(mu_);
+  int64 num_planned_allocations_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_fallback_allocations_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StepMemoryArena);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLAN_H_
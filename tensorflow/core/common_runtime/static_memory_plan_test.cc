@@ -0,0 +1,138 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/static_memory_plan.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Builds a chain of `length` Neg nodes over a float constant of
+// `num_elements` elements, and returns the nodes of the chain.
+std::vector<Node*> BuildChain(Graph* g, int num_elements, int length) {
+  Tensor t(DT_FLOAT, TensorShape({num_elements}));
+  t.flat<float>().setZero();
+  Node* x = test::graph::Constant(g, t);
+  std::vector<Node*> chain;
+  for (int i = 0; i < length; ++i) {
+    x = test::graph::Unary(g, "Neg", x);
+    chain.push_back(x);
+  }
+  return chain;
+}
+
+TEST(StaticMemoryPlanTest, ReusesBuffersOfDisjointLifetimes) {
+  Graph g(OpRegistry::Global());
+  std::vector<Node*> chain = BuildChain(&g, 1024, 4);
+  std::unique_ptr<StaticMemoryPlan> plan;
+  TF_ASSERT_OK(StaticMemoryPlan::Build(g, &plan));
+  ASSERT_NE(plan, nullptr);
+
+  EXPECT_EQ(4, plan->num_buffers());
+  // Only two neighbouring outputs of the chain are live at a time.
+  EXPECT_EQ(2 * 1024 * sizeof(float), plan->arena_bytes());
+  for (Node* n : chain) {
+    const int start = plan->output_start(n->id());
+    ASSERT_GE(start, 0);
+    const int buffer = plan->output_buffer(start);
+    ASSERT_GE(buffer, 0);
+    EXPECT_EQ(n->id(), plan->buffer(buffer).node_id);
+    EXPECT_EQ(0, plan->buffer(buffer).offset % Allocator::kAllocatorAlignment);
+  }
+}
+
+TEST(StaticMemoryPlanTest, SkipsUnknownShapesAndSentOutputs) {
+  Graph g(OpRegistry::Global());
+  Node* recv = test::graph::Recv(&g, "a", "float", "/job:a/replica:0/task:0",
+                                 1, "/job:a/replica:0/task:0");
+  test::graph::Unary(&g, "Neg", recv);
+  std::vector<Node*> chain = BuildChain(&g, 16, 1);
+  test::graph::Send(&g, chain[0], "b", "/job:a/replica:0/task:0", 1,
+                    "/job:a/replica:0/task:0");
+  std::unique_ptr<StaticMemoryPlan> plan;
+  TF_ASSERT_OK(StaticMemoryPlan::Build(g, &plan));
+  EXPECT_EQ(nullptr, plan);
+}
+
+TEST(StaticMemoryPlanTest, SkipsGraphsWithControlFlow) {
+  Graph g(OpRegistry::Global());
+  std::vector<Node*> chain = BuildChain(&g, 16, 2);
+  test::graph::Enter(&g, chain[1], "frame");
+  std::unique_ptr<StaticMemoryPlan> plan;
+  TF_ASSERT_OK(StaticMemoryPlan::Build(g, &plan));
+  EXPECT_EQ(nullptr, plan);
+}
+
+TEST(StepMemoryArenaTest, AllocatesFromArena) {
+  Graph g(OpRegistry::Global());
+  std::vector<Node*> chain = BuildChain(&g, 1024, 4);
+  std::unique_ptr<StaticMemoryPlan> plan;
+  TF_ASSERT_OK(StaticMemoryPlan::Build(g, &plan));
+  std::shared_ptr<const StaticMemoryPlan> shared_plan(std::move(plan));
+
+  auto* arena = new StepMemoryArena(shared_plan, cpu_allocator());
+  auto allocator = [arena](Node* n) {
+    return arena->OutputAllocators(n->id())[0];
+  };
+  {
+    // chain[0] and chain[2] share arena bytes, so chain[2] falls back to the
+    // underlying allocator while chain[0] is live.
+    Tensor t0(allocator(chain[0]), DT_FLOAT, TensorShape({1024}));
+    Tensor t1(allocator(chain[1]), DT_FLOAT, TensorShape({1024}));
+    Tensor t2(allocator(chain[2]), DT_FLOAT, TensorShape({1024}));
+    t0.flat<float>().setConstant(0.0f);
+    t1.flat<float>().setConstant(1.0f);
+    t2.flat<float>().setConstant(2.0f);
+    EXPECT_NE(t0.tensor_data().data(), t2.tensor_data().data());
+    EXPECT_EQ(2, arena->num_planned_allocations());
+    EXPECT_EQ(1, arena->num_fallback_allocations());
+  }
+  {
+    // Once chain[0] and chain[1] are released, chain[3] reuses their bytes.
+    Tensor t3(allocator(chain[3]), DT_FLOAT, TensorShape({1024}));
+    EXPECT_EQ(3, arena->num_planned_allocations());
+    // Tensors may outlive the step that allocated them.
+    arena->Unref();
+    t3.flat<float>().setConstant(3.0f);
+  }
+}
+
+TEST(StepMemoryArenaTest, LargerThanPlannedFallsBack) {
+  Graph g(OpRegistry::Global());
+  std::vector<Node*> chain = BuildChain(&g, 16, 1);
+  std::unique_ptr<StaticMemoryPlan> plan;
+  TF_ASSERT_OK(StaticMemoryPlan::Build(g, &plan));
+  std::shared_ptr<const StaticMemoryPlan> shared_plan(std::move(plan));
+
+  auto* arena = new StepMemoryArena(shared_plan, cpu_allocator());
+  {
+    Tensor t(arena->OutputAllocators(chain[0]->id())[0], DT_FLOAT,
+             TensorShape({1024}));
+    EXPECT_TRUE(t.IsInitialized());
+    EXPECT_EQ(0, arena->num_planned_allocations());
+    EXPECT_EQ(1, arena->num_fallback_allocations());
+  }
+  arena->Unref();
+}
+
+}  // namespace
+}  // namespace tensorflow
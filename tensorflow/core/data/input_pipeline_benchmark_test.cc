@@ -0,0 +1,257 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// End-to-end benchmarks of standard tf.data input pipelines, run through the
+// standalone API so that only the tf.data runtime and its kernels are measured:
+//
+//   TFRecord -> repeat -> map(parse) -> map(square) -> batch -> prefetch
+//
+// Every benchmark iteration produces one batch. Besides time per batch and
+// elements per second, the label reports CPU time, CPU allocator allocations
+// and peak allocated bytes, each normalized per element.
+
+#include <ctime>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace data {
+namespace standalone {
+namespace {
+
+using test::function::GDef;
+using test::function::NDef;
+using FDH = FunctionDefHelper;
+
+constexpr int kNumRecords = 1024;
+constexpr int kFeatureSize = 64;
+constexpr int kWarmupBatches = 10;
+constexpr char kFeatureName[] = "x";
+
+// Parameters of the pipeline built by `PipelineGraph`.
+struct PipelineParams {
+  string filename;
+  int64 feature_size = kFeatureSize;
+  int64 batch_size = 32;
+  int32 num_parallel_calls = 1;
+  int64 prefetch_buffer_size = -1;  // Autotuned.
+};
+
+// Writes `kNumRecords` serialized `Example`s, each holding a single float
+// feature of `feature_size` values, to a TFRecord file and returns its name.
+string WriteRecords(int64 feature_size) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(),
+                   strings::StrCat("input_pipeline_benchmark_", feature_size,
+                                   ".tfrecord"));
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(Env::Default()->NewWritableFile(filename, &file));
+  io::RecordWriter writer(file.get());
+  Example example;
+  auto* values = (*example.mutable_features()->mutable_feature())[kFeatureName]
+                     .mutable_float_list();
+  for (int64 i = 0; i < feature_size; ++i) values->add_value(i);
+  const string serialized = example.SerializeAsString();
+  for (int i = 0; i < kNumRecords; ++i) {
+    TF_CHECK_OK(writer.WriteRecord(serialized));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  return filename;
+}
+
+// serialized: string -> the float feature of a serialized `Example`.
+FunctionDef ParseRecord(int64 feature_size) {
+  return FDH::Create(
+      "ParseRecord", {"serialized: string"}, {"x: float"}, {},
+      {{{"default"},
+        "Const",
+        {},
+        {{"dtype", DT_FLOAT}, {"value", Tensor(DT_FLOAT, TensorShape({0}))}}},
+       {{"parse"},
+        "ParseSingleExample",
+        {"serialized", "default:output:0"},
+        {{"num_sparse", 0},
+         {"sparse_keys", gtl::ArraySlice<string>({})},
+         {"dense_keys", gtl::ArraySlice<string>({kFeatureName})},
+         {"sparse_types", DataTypeSlice({})},
+         {"Tdense", DataTypeSlice({DT_FLOAT})},
+         {"dense_shapes",
+          gtl::ArraySlice<TensorShape>({TensorShape({feature_size})})}}}},
+      {{"x", "parse:dense_values:0"}});
+}
+
+// x: float -> x * x.
+FunctionDef SquareFloat() {
+  return FDH::Create("SquareFloat", {"x: float"}, {"y: float"}, {},
+                     {{{"square"}, "Square", {"x"}, {{"T", DT_FLOAT}}}},
+                     {{"y", "square:y:0"}});
+}
+
+NodeDef ScalarConst(const string& name, const Tensor& value) {
+  return NDef(name, "Const", {},
+              {{"dtype", value.dtype()}, {"value", value}});
+}
+
+NodeDef ParallelMap(const string& name, const string& input,
+                    const string& num_parallel_calls, const string& function,
+                    const PartialTensorShape& output_shape) {
+  return NDef(name, "ParallelMapDataset", {input, num_parallel_calls},
+              {{"f", FDH::FunctionRef(function)},
+               {"Targuments", DataTypeSlice({})},
+               {"output_types", DataTypeSlice({DT_FLOAT})},
+               {"output_shapes", gtl::ArraySlice<PartialTensorShape>(
+                                     {output_shape})},
+               {"use_inter_op_parallelism", true},
+               {"sloppy", false},
+               {"preserve_cardinality", true}});
+}
+
+GraphDef PipelineGraph(const PipelineParams& params) {
+  const PartialTensorShape element_shape({params.feature_size});
+  const PartialTensorShape batch_shape(
+      {params.batch_size, params.feature_size});
+  return GDef(
+      {ScalarConst("filenames", test::AsScalar<tstring>(params.filename)),
+       ScalarConst("compression_type", test::AsScalar<tstring>("")),
+       ScalarConst("record_buffer_size", test::AsScalar<int64>(256 << 10)),
+       ScalarConst("count", test::AsScalar<int64>(-1)),
+       ScalarConst("num_parallel_calls",
+                   test::AsScalar<int32>(params.num_parallel_calls)),
+       ScalarConst("batch_size", test::AsScalar<int64>(params.batch_size)),
+       ScalarConst("drop_remainder", test::AsScalar<bool>(true)),
+       ScalarConst("prefetch_buffer_size",
+                   test::AsScalar<int64>(params.prefetch_buffer_size)),
+       NDef("records", "TFRecordDataset",
+            {"filenames", "compression_type", "record_buffer_size"}),
+       NDef("repeat", "RepeatDataset", {"records", "count"},
+            {{"output_types", DataTypeSlice({DT_STRING})},
+             {"output_shapes",
+              gtl::ArraySlice<PartialTensorShape>({PartialTensorShape({})})}}),
+       ParallelMap("parse", "repeat", "num_parallel_calls", "ParseRecord",
+                   element_shape),
+       ParallelMap("square", "parse", "num_parallel_calls", "SquareFloat",
+                   element_shape),
+       NDef("batch", "BatchDatasetV2",
+            {"square", "batch_size", "drop_remainder"},
+            {{"parallel_copy", false},
+             {"output_types", DataTypeSlice({DT_FLOAT})},
+             {"output_shapes",
+              gtl::ArraySlice<PartialTensorShape>({batch_shape})}}),
+       NDef("prefetch", "PrefetchDataset", {"batch", "prefetch_buffer_size"},
+            {{"output_types", DataTypeSlice({DT_FLOAT})},
+             {"output_shapes",
+              gtl::ArraySlice<PartialTensorShape>({batch_shape})}}),
+       NDef("dataset", "_Retval", {"prefetch"},
+            {{"T", DT_VARIANT}, {"index", 0}})},
+      {ParseRecord(params.feature_size), SquareFloat()});
+}
+
+void RunPipeline(int iters, const PipelineParams& params) {
+  testing::StopTiming();
+  // Enabled before anything is allocated so that bytes in use stay balanced.
+  EnableCPUAllocatorStats(true);
+  std::unique_ptr<Dataset> dataset;
+  TF_CHECK_OK(Dataset::FromGraph({}, PipelineGraph(params), &dataset));
+  std::unique_ptr<Iterator> iterator;
+  TF_CHECK_OK(dataset->MakeIterator(&iterator));
+
+  std::vector<Tensor> outputs;
+  bool end_of_input = false;
+  for (int i = 0; i < kWarmupBatches; ++i) {
+    TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+    CHECK(!end_of_input);
+  }
+
+  Allocator* allocator = cpu_allocator();
+  allocator->ClearStats();
+  const std::clock_t cpu_start = std::clock();
+  testing::UseRealTime();
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+  }
+  testing::StopTiming();
+  const double cpu_usecs =
+      1e6 * (std::clock() - cpu_start) / static_cast<double>(CLOCKS_PER_SEC);
+  const absl::optional<AllocatorStats> stats = allocator->GetStats();
+
+  const int64 num_elements = static_cast<int64>(iters) * params.batch_size;
+  testing::ItemsProcessed(num_elements);
+  testing::BytesProcessed(num_elements * params.feature_size * sizeof(float));
+  testing::SetLabel(strings::Printf(
+      "cpu_usecs/elem=%.2f allocs/elem=%.2f peak_bytes=%lld",
+      cpu_usecs / num_elements,
+      static_cast<double>(stats->num_allocs) / num_elements,
+      static_cast<long long>(stats->peak_bytes_in_use)));
+  iterator.reset();
+  dataset.reset();
+}
+
+void BM_TFRecordParseMapBatchPrefetch(int iters, int batch_size,
+                                      int num_parallel_calls) {
+  static const string* filename = new string(WriteRecords(kFeatureSize));
+  PipelineParams params;
+  params.filename = *filename;
+  params.batch_size = batch_size;
+  params.num_parallel_calls = num_parallel_calls;
+  RunPipeline(iters, params);
+}
+BENCHMARK(BM_TFRecordParseMapBatchPrefetch)
+    ->ArgPair(1, 1)
+    ->ArgPair(32, 1)
+    ->ArgPair(32, 4)
+    ->ArgPair(32, -1)
+    ->ArgPair(256, 1)
+    ->ArgPair(256, 4)
+    ->ArgPair(256, -1);
+
+void BM_TFRecordParseMapBatchPrefetchFeatureSize(int iters, int feature_size) {
+  PipelineParams params;
+  params.filename = WriteRecords(feature_size);
+  params.feature_size = feature_size;
+  params.num_parallel_calls = -1;  // Autotuned.
+  RunPipeline(iters, params);
+}
+BENCHMARK(BM_TFRecordParseMapBatchPrefetchFeatureSize)
+    ->Arg(1)
+    ->Arg(64)
+    ->Arg(1024)
+    ->Arg(16384);
+
+}  // namespace
+}  // namespace standalone
+}  // namespace data
+}  // namespace tensorflow
@@ -23,7 +23,67 @@ namespace tensorflow {
 namespace data {
 namespace service_util {
 
+namespace {
+
+// Compression must shrink an element by at least 1/kMinCompressionSavings of
+// its size for the compressed bytes to be sent instead of the raw bytes.
+constexpr int64 kMinCompressionSavings = 8;
+
+// Writes the tensor bytes of `element` to `position`, and fills out the
+// per-component metadata of `out`. `non_memcpy_components` holds the
+// serialized protos of the components which cannot be memcopied.
+void WriteComponents(const std::vector<Tensor>& element,
+                     const std::vector<TensorProto>& non_memcpy_components,
+                     char* position, CompressedElement* out) {
+  int non_memcpy_component_index = 0;
+  for (auto& component : element) {
+    ComponentMetadata* metadata = out->mutable_component_metadata()->Add();
+    metadata->set_dtype(component.dtype());
+    component.shape().AsProto(metadata->mutable_tensor_shape());
+    if (DataTypeCanUseMemcpy(component.dtype())) {
+      const TensorBuffer* buffer = DMAHelper::buffer(&component);
+      memcpy(position, buffer->data(), buffer->size());
+      metadata->set_tensor_size_bytes(buffer->size());
+    } else {
+      const TensorProto& proto =
+          non_memcpy_components[non_memcpy_component_index++];
+      proto.SerializeToArray(position, proto.ByteSizeLong());
+      metadata->set_tensor_size_bytes(proto.ByteSizeLong());
+    }
+    position += metadata->tensor_size_bytes();
+  }
+}
+
+// Parses the serialized protos in `tensor_proto_strs` into the components of
+// `out` that cannot be memcopied.
+Status DeserializeComponents(const CompressedElement& compressed,
+                             const std::vector<tstring>& tensor_proto_strs,
+                             std::vector<Tensor>* out) {
+  const int num_components = compressed.component_metadata_size();
+  int tensor_proto_strs_index = 0;
+  for (int i = 0; i < num_components; ++i) {
+    if (DataTypeCanUseMemcpy(compressed.component_metadata(i).dtype())) {
+      continue;
+    }
+    TensorProto tp;
+    if (!tp.ParseFromString(tensor_proto_strs[tensor_proto_strs_index++])) {
+      return errors::Internal("Could not parse TensorProto");
+    }
+    if (!out->at(i).FromProto(tp)) {
+      return errors::Internal("Could not parse Tensor");
+    }
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
 Status Compress(const std::vector<Tensor>& element, CompressedElement* out) {
+  return Compress(element, /*compress=*/true, out);
+}
+
+Status Compress(const std::vector<Tensor>& element, bool compress,
+                CompressedElement* out) {
   tensorflow::profiler::TraceMe activity(
       "Compress", tensorflow::profiler::TraceMeLevel::kInfo);
 
@@ -43,34 +103,33 @@ Status Compress(const std::vector<Tensor>& element, CompressedElement* out) {
     }
   }
 
+  if (!compress) {
+    // Write the tensor data straight into the proto, which saves both the
+    // staging copy and the snappy pass.
+    out->mutable_data()->resize(total_size);
+    WriteComponents(element, non_memcpy_components,
+                    &(*out->mutable_data())[0], out);
+    out->set_uncompressed(true);
+    return Status::OK();
+  }
+
   // Step 2: Write the tensor data to a buffer, and compress that buffer.
   // We use tstring for access to resize_uninitialized.
   tstring uncompressed;
   uncompressed.resize_uninitialized(total_size);
-  // Position in `uncompressed` to write the next component.
-  char* position = uncompressed.mdata();
-  int non_memcpy_component_index = 0;
-  for (auto& component : element) {
-    ComponentMetadata* metadata = out->mutable_component_metadata()->Add();
-    metadata->set_dtype(component.dtype());
-    component.shape().AsProto(metadata->mutable_tensor_shape());
-    if (DataTypeCanUseMemcpy(component.dtype())) {
-      const TensorBuffer* buffer = DMAHelper::buffer(&component);
-      memcpy(position, buffer->data(), buffer->size());
-      metadata->set_tensor_size_bytes(buffer->size());
-    } else {
-      TensorProto& proto = non_memcpy_components[non_memcpy_component_index++];
-      proto.SerializeToArray(position, proto.ByteSizeLong());
-      metadata->set_tensor_size_bytes(proto.ByteSizeLong());
-    }
-    position += metadata->tensor_size_bytes();
-  }
-  DCHECK_EQ(position, uncompressed.mdata() + total_size);
+  WriteComponents(element, non_memcpy_components, uncompressed.mdata(), out);
 
   if (!port::Snappy_Compress(uncompressed.mdata(), total_size,
                              out->mutable_data())) {
     return errors::Internal("Failed to compress using snappy.");
   }
+  // Already-compressed data, e.g. encoded images, gains little from snappy.
+  // Sending it raw spares the client from decompressing it.
+  if (static_cast<int64>(out->data().size()) >
+      total_size - total_size / kMinCompressionSavings) {
+    out->set_data(uncompressed.data(), total_size);
+    out->set_uncompressed(true);
+  }
   return Status::OK();
 }
 
@@ -113,6 +172,20 @@ Status Uncompress(const CompressedElement& compressed,
 
   // Step 2: Uncompress into the iovec.
   const std::string& compressed_data = compressed.data();
+  if (compressed.uncompressed()) {
+    if (static_cast<int64>(compressed_data.size()) != total_size) {
+      return errors::Internal("Uncompressed size mismatch. The element has ",
+                              compressed_data.size(),
+                              " bytes whereas the tensor metadata suggests ",
+                              total_size);
+    }
+    const char* position = compressed_data.data();
+    for (const struct iovec& component : iov) {
+      memcpy(component.iov_base, position, component.iov_len);
+      position += component.iov_len;
+    }
+    return DeserializeComponents(compressed, tensor_proto_strs, out);
+  }
   size_t uncompressed_size;
   if (!port::Snappy_GetUncompressedLength(
           compressed_data.data(), compressed_data.size(), &uncompressed_size)) {
@@ -130,20 +203,7 @@ Status Uncompress(const CompressedElement& compressed,
   }
 
   // Step 3: Deserialize tensor proto strings to tensors.
-  int tensor_proto_strs_index = 0;
-  for (int i = 0; i < num_components; ++i) {
-    if (DataTypeCanUseMemcpy(compressed.component_metadata(i).dtype())) {
-      continue;
-    }
-    TensorProto tp;
-    if (!tp.ParseFromString(tensor_proto_strs[tensor_proto_strs_index++])) {
-      return errors::Internal("Could not parse TensorProto");
-    }
-    if (!out->at(i).FromProto(tp)) {
-      return errors::Internal("Could not parse Tensor");
-    }
-  }
-  return Status::OK();
+  return DeserializeComponents(compressed, tensor_proto_strs, out);
 }
 
 }  // namespace service_util
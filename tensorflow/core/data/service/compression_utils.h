@@ -29,6 +29,12 @@ namespace service_util {
 // out the per-component metadata for the `CompressedElement`.
 Status Compress(const std::vector<Tensor>& element, CompressedElement* out);
 
+// Like `Compress`, but if `compress` is false, the tensor bytes are written to
+// `out` without compression. Even if `compress` is true, the bytes are written
+// uncompressed when compression would barely reduce their size.
+Status Compress(const std::vector<Tensor>& element, bool compress,
+                CompressedElement* out);
+
 // Uncompresses a `CompressedElement` into a vector of tensor components.
 Status Uncompress(const CompressedElement& compressed,
                   std::vector<Tensor>* out);
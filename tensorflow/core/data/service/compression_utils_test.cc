@@ -16,6 +16,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -36,6 +38,17 @@ TEST_P(ParameterizedCompressionUtilsTest, RoundTrip) {
       ExpectEqual(element, round_trip_element, /*compare_order=*/true));
 }
 
+TEST_P(ParameterizedCompressionUtilsTest, RoundTripUncompressed) {
+  std::vector<Tensor> element = GetParam();
+  CompressedElement compressed;
+  TF_ASSERT_OK(Compress(element, /*compress=*/false, &compressed));
+  EXPECT_TRUE(compressed.uncompressed());
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(Uncompress(compressed, &round_trip_element));
+  TF_EXPECT_OK(
+      ExpectEqual(element, round_trip_element, /*compare_order=*/true));
+}
+
 std::vector<std::vector<Tensor>> TestCases() {
   return {
       CreateTensors<int64>(TensorShape{1}, {{1}}),             // int64
@@ -50,6 +63,31 @@ std::vector<std::vector<Tensor>> TestCases() {
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
+TEST(CompressionUtilsTest, CompressesCompressibleData) {
+  std::vector<Tensor> element = {Tensor(DT_INT64, TensorShape({1024}))};
+  element[0].flat<int64>().setZero();
+  CompressedElement compressed;
+  TF_ASSERT_OK(Compress(element, &compressed));
+  EXPECT_FALSE(compressed.uncompressed());
+  EXPECT_LT(compressed.data().size(), 1024 * sizeof(int64));
+}
+
+TEST(CompressionUtilsTest, SendsIncompressibleDataUncompressed) {
+  std::vector<Tensor> element = {Tensor(DT_INT64, TensorShape({1024}))};
+  random::PhiloxRandom philox(1);
+  random::SimplePhilox rng(&philox);
+  for (int i = 0; i < 1024; ++i) {
+    element[0].flat<int64>()(i) = rng.Rand64();
+  }
+  CompressedElement compressed;
+  TF_ASSERT_OK(Compress(element, &compressed));
+  EXPECT_TRUE(compressed.uncompressed());
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(Uncompress(compressed, &round_trip_element));
+  ASSERT_EQ(round_trip_element.size(), 1);
+  test::ExpectTensorEqual<int64>(element[0], round_trip_element[0]);
+}
+
 }  // namespace service_util
 }  // namespace data
 }  // namespace tensorflow
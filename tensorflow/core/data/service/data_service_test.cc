@@ -27,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_test_base.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/host_info.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -182,6 +183,44 @@ Status CheckWorkerOutput(const std::string& worker_address, int64 task_id,
   return Status::OK();
 }
 
+// Requests up to `max_elements` elements at a time from the task, until the
+// end of the sequence, and appends them to `elements`.
+Status GetAllElements(const std::string& worker_address, int64 task_id,
+                      int64 max_elements,
+                      std::vector<std::vector<Tensor>>* elements) {
+  auto worker_channel = grpc::CreateChannel(
+      worker_address, grpc::experimental::LocalCredentials(LOCAL_TCP));
+  std::unique_ptr<WorkerService::Stub> worker_stub =
+      WorkerService::NewStub(worker_channel);
+  while (true) {
+    grpc_impl::ClientContext ctx;
+    GetElementRequest req;
+    req.set_task_id(task_id);
+    req.set_max_elements(max_elements);
+    GetElementResponse resp;
+    grpc::Status s = worker_stub->GetElement(&ctx, req, &resp);
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get elements", s);
+    }
+    if (resp.end_of_sequence()) {
+      return Status::OK();
+    }
+    if (resp.additional_compressed_elements_size() >= max_elements) {
+      return errors::Internal("Received more than ", max_elements,
+                              " elements");
+    }
+    elements->emplace_back();
+    TF_RETURN_IF_ERROR(
+        service_util::Uncompress(resp.compressed_element(), &elements->back()));
+    for (const CompressedElement& compressed :
+         resp.additional_compressed_elements()) {
+      elements->emplace_back();
+      TF_RETURN_IF_ERROR(
+          service_util::Uncompress(compressed, &elements->back()));
+    }
+  }
+}
+
 }  // namespace
 
 TEST(DataService, IterateDatasetOneWorker) {
@@ -263,5 +302,66 @@ TEST(DataService, AddWorkerMidEpoch) {
   }
 }
 
+TEST(DataService, GetMultipleElementsPerRequest) {
+  TestCluster cluster(1);
+  TF_ASSERT_OK(cluster.Initialize());
+  test_util::GraphDefTestCase test_case;
+  TF_ASSERT_OK(test_util::map_test_case(&test_case));
+  auto master_channel = grpc::CreateChannel(
+      cluster.MasterAddress(), grpc::experimental::LocalCredentials(LOCAL_TCP));
+  std::unique_ptr<MasterService::Stub> master_stub =
+      MasterService::NewStub(master_channel);
+
+  int64 dataset_id;
+  TF_ASSERT_OK(
+      RegisterDataset(master_stub.get(), test_case.graph_def, &dataset_id));
+  int64 epoch_id;
+  TF_ASSERT_OK(BeginEpoch(master_stub.get(), dataset_id, &epoch_id));
+  std::vector<TaskInfo> tasks;
+  TF_ASSERT_OK(GetTasks(master_stub.get(), epoch_id, &tasks));
+  ASSERT_EQ(tasks.size(), 1);
+
+  // Elements arrive in order, however many are returned per request.
+  std::vector<std::vector<Tensor>> elements;
+  TF_ASSERT_OK(GetAllElements(tasks[0].worker_address(), tasks[0].id(),
+                              /*max_elements=*/2, &elements));
+  ASSERT_EQ(elements.size(), test_case.output.size());
+  for (size_t i = 0; i < elements.size(); ++i) {
+    TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(
+        elements[i], test_case.output[i], /*compare_order=*/true));
+  }
+}
+
+TEST(DataService, ReportsTasksOnConsumerHost) {
+  TestCluster cluster(2);
+  TF_ASSERT_OK(cluster.Initialize());
+  test_util::GraphDefTestCase test_case;
+  TF_ASSERT_OK(test_util::map_test_case(&test_case));
+  auto master_channel = grpc::CreateChannel(
+      cluster.MasterAddress(), grpc::experimental::LocalCredentials(LOCAL_TCP));
+  std::unique_ptr<MasterService::Stub> master_stub =
+      MasterService::NewStub(master_channel);
+
+  int64 dataset_id;
+  TF_ASSERT_OK(
+      RegisterDataset(master_stub.get(), test_case.graph_def, &dataset_id));
+  int64 epoch_id;
+  TF_ASSERT_OK(BeginEpoch(master_stub.get(), dataset_id, &epoch_id));
+
+  // All workers of the test cluster run on this host.
+  for (const std::string& host : {port::Hostname(), std::string("other")}) {
+    grpc_impl::ClientContext ctx;
+    GetTasksRequest req;
+    req.set_epoch_id(epoch_id);
+    req.set_consumer_host(host);
+    GetTasksResponse resp;
+    ASSERT_TRUE(master_stub->GetTasks(&ctx, req, &resp).ok());
+    ASSERT_EQ(resp.task_info_size(), 2);
+    for (const TaskInfo& task : resp.task_info()) {
+      EXPECT_EQ(task.same_host(), host == port::Hostname());
+    }
+  }
+}
+
 }  // namespace data
 }  // namespace tensorflow
@@ -57,6 +57,7 @@ Status DataServiceMasterImpl::RegisterWorker(
   int64 worker_id = next_worker_id_++;
   workers_.emplace_back();
   workers_.back().address = request->worker_address();
+  workers_.back().host = request->worker_host();
   workers_.back().id = worker_id;
   response->set_worker_id(worker_id);
 
@@ -69,6 +70,7 @@ Status DataServiceMasterImpl::RegisterWorker(
     task.id = task_id;
     task.dataset_id = epoch.dataset_id;
     task.worker_address = request->worker_address();
+    task.worker_host = request->worker_host();
     epoch.task_ids.push_back(task_id);
 
     TaskDef* task_def = response->add_tasks();
@@ -145,6 +147,7 @@ Status DataServiceMasterImpl::BeginEpoch(const BeginEpochRequest* request,
     task.id = task_id;
     task.dataset_id = request->dataset_id();
     task.worker_address = worker.address;
+    task.worker_host = worker.host;
     epoch.task_ids.push_back(task_id);
 
     std::unique_ptr<WorkerService::Stub> stub;
@@ -191,13 +194,23 @@ Status DataServiceMasterImpl::GetTasks(const GetTasksRequest* request,
                             "> not found.");
   }
   Epoch& epoch = it->second;
-  for (const auto& task_id : epoch.task_ids) {
-    auto task_iter = tasks_.find(task_id);
-    DCHECK(task_iter != tasks_.end());
-    Task& task = task_iter->second;
-    TaskInfo* task_info = response->mutable_task_info()->Add();
-    task_info->set_worker_address(task.worker_address);
-    task_info->set_id(task.id);
+  const std::string& consumer_host = request->consumer_host();
+  // List the tasks on the consumer's host first, then all others.
+  for (bool same_host : {true, false}) {
+    for (const auto& task_id : epoch.task_ids) {
+      auto task_iter = tasks_.find(task_id);
+      DCHECK(task_iter != tasks_.end());
+      Task& task = task_iter->second;
+      const bool on_consumer_host =
+          !consumer_host.empty() && task.worker_host == consumer_host;
+      if (on_consumer_host != same_host) {
+        continue;
+      }
+      TaskInfo* task_info = response->mutable_task_info()->Add();
+      task_info->set_worker_address(task.worker_address);
+      task_info->set_id(task.id);
+      task_info->set_same_host(same_host);
+    }
   }
   VLOG(3) << "Found " << response->task_info_size() << " tasks for epoch id "
           << request->epoch_id();
@@ -60,6 +60,8 @@ class DataServiceMasterImpl {
  private:
   typedef struct WorkerInfo {
     std::string address;
+    // The name of the worker's host, or empty if it is not known.
+    std::string host;
     int64 id;
     std::unique_ptr<WorkerService::Stub> stub;
 
@@ -84,6 +86,7 @@ class DataServiceMasterImpl {
     int64 id;
     int64 dataset_id;
     std::string worker_address;
+    std::string worker_host;
   } Task;
 
   // Registers a dataset with the given fingerprint, returning a new dataset id.
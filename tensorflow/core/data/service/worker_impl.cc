@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/worker_impl.h"
 
+#include <algorithm>
+#include <deque>
+
 #include "grpcpp/create_channel.h"
 #include "absl/memory/memory.h"
 #include "tensorflow/c/c_api_internal.h"
@@ -29,13 +32,21 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/host_info.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/public/session_options.h"
 
 namespace tensorflow {
 namespace data {
 
 const constexpr uint64 kHeartbeatIntervalMicros = 5ull * 1000 * 1000;
+// The number of elements each task prefetches ahead of its clients.
+const constexpr int64 kMaxBufferedElementsPerTask = 16;
+// The number of threads each task uses to produce and compress elements.
+const constexpr int kPrefetchThreadsPerTask = 4;
 
 namespace {
 auto* tf_data_service_created =
@@ -44,6 +55,148 @@ auto* tf_data_service_created =
                                     "has been created.");
 }  // namespace
 
+// Prefetches the elements of a task into a bounded buffer, so that producing
+// and compressing elements overlaps with serving them.
+//
+// The prefetch threads take turns getting the next element from the task's
+// iterator, and compress their elements in parallel. Elements are buffered,
+// and served, in the order in which the iterator produced them.
+class DataServiceWorkerImpl::Task {
+ public:
+  // TODO(aaudibert): Have standalone::Iterator own a reference to
+  // standalone::Dataset so that we don't need to store the dataset here.
+  Task(int64 id, bool compress, std::unique_ptr<standalone::Dataset> dataset,
+       std::unique_ptr<standalone::Iterator> iterator)
+      : id_(id),
+        compress_(compress),
+        dataset_(std::move(dataset)),
+        iterator_(std::move(iterator)) {
+    for (int i = 0; i < kPrefetchThreadsPerTask; ++i) {
+      threads_.emplace_back(Env::Default()->StartThread(
+          {}, "tf_data_service_prefetch", [this]() { PrefetchThread(); }));
+    }
+  }
+
+  ~Task() {
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+      cond_var_.notify_all();
+    }
+    // Joins the prefetch threads.
+    threads_.clear();
+  }
+
+  // Moves up to `max_elements` buffered elements into `response`, waiting
+  // until the next element has been produced. Stops early at an error or at
+  // the end of the sequence, which are reported by the next call.
+  Status GetElements(int64 max_elements, GetElementResponse* response) {
+    mutex_lock l(mu_);
+    while (!cancelled_ && (buffer_.empty() || !buffer_.front()->ready) &&
+           !(buffer_.empty() && end_of_sequence_)) {
+      cond_var_.wait(l);
+    }
+    if (cancelled_) {
+      return errors::Cancelled("Task ", id_, " was cancelled");
+    }
+    for (int64 i = 0; i < std::max<int64>(max_elements, 1); ++i) {
+      if (buffer_.empty()) {
+        if (i == 0) {
+          response->set_end_of_sequence(true);
+        }
+        break;
+      }
+      std::shared_ptr<Element> element = buffer_.front();
+      if (!element->ready ||
+          (i > 0 && (element->end_of_sequence || !element->status.ok()))) {
+        break;
+      }
+      buffer_.pop_front();
+      cond_var_.notify_all();
+      if (element->end_of_sequence) {
+        response->set_end_of_sequence(true);
+        break;
+      }
+      TF_RETURN_IF_ERROR(element->status);
+      CompressedElement* compressed_element =
+          i == 0 ? response->mutable_compressed_element()
+                 : response->add_additional_compressed_elements();
+      compressed_element->Swap(&element->compressed_element);
+    }
+    return Status::OK();
+  }
+
+ private:
+  struct Element {
+    // Whether the element has been produced and compressed.
+    bool ready = false;
+    Status status;
+    bool end_of_sequence = false;
+    CompressedElement compressed_element;
+  };
+
+  void PrefetchThread() {
+    while (true) {
+      std::shared_ptr<Element> element;
+      std::vector<Tensor> outputs;
+      bool end_of_sequence = false;
+      Status s;
+      {
+        // Holding `iterator_mu_` while the element is being produced keeps
+        // the elements in `buffer_` in iteration order.
+        mutex_lock il(iterator_mu_);
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ && !end_of_sequence_ &&
+                 buffer_.size() >= kMaxBufferedElementsPerTask) {
+            cond_var_.wait(l);
+          }
+          if (cancelled_ || end_of_sequence_) {
+            return;
+          }
+          element = std::make_shared<Element>();
+          buffer_.push_back(element);
+        }
+        s = iterator_->GetNext(&outputs, &end_of_sequence);
+        if (end_of_sequence) {
+          // Release iterator memory.
+          iterator_.reset();
+          mutex_lock l(mu_);
+          end_of_sequence_ = true;
+        }
+      }
+      if (s.ok() && !end_of_sequence) {
+        s = service_util::Compress(outputs, compress_,
+                                   &element->compressed_element);
+      }
+      mutex_lock l(mu_);
+      element->status = s;
+      element->end_of_sequence = end_of_sequence;
+      element->ready = true;
+      cond_var_.notify_all();
+    }
+  }
+
+  const int64 id_;
+  // Whether elements are compressed before they are sent to clients.
+  const bool compress_;
+  const std::unique_ptr<standalone::Dataset> dataset_;
+
+  mutex iterator_mu_;
+  std::unique_ptr<standalone::Iterator> iterator_ TF_GUARDED_BY(iterator_mu_);
+
+  mutex mu_;
+  // Notified when an element becomes ready, when an element is removed from
+  // `buffer_`, and on cancellation.
+  condition_variable cond_var_;
+  std::deque<std::shared_ptr<Element>> buffer_ TF_GUARDED_BY(mu_);
+  // Whether the iterator has reached the end of the sequence.
+  bool end_of_sequence_ TF_GUARDED_BY(mu_) = false;
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+
+  std::vector<std::unique_ptr<Thread>> threads_;
+};
+
 DataServiceWorkerImpl::DataServiceWorkerImpl(const std::string& master_address,
                                              const std::string& protocol)
     : master_address_(master_address), protocol_(protocol) {
@@ -77,6 +230,7 @@ Status DataServiceWorkerImpl::Register() EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   }
   RegisterWorkerRequest req;
   req.set_worker_address(worker_address_);
+  req.set_worker_host(port::Hostname());
   RegisterWorkerResponse resp;
 
   grpc::ClientContext ctx;
@@ -113,18 +267,16 @@ Status DataServiceWorkerImpl::ProcessTaskInternal(const TaskDef& task_def)
     return errors::AlreadyExists("A task with id ", task_def.task_id(),
                                  " already exists.");
   }
-  Task& task = tasks_[task_def.task_id()];
-  task.id = task_def.task_id();
-  task.dataset = std::move(dataset);
-  task.iterator = std::move(iterator);
+  tasks_[task_def.task_id()] = std::make_shared<Task>(
+      task_def.task_id(), !task_def.dataset().disable_compression(),
+      std::move(dataset), std::move(iterator));
   return Status::OK();
 }
 
 Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
                                          GetElementResponse* response) {
   VLOG(3) << "Received GetElement request for task " << request->task_id();
-  bool end_of_sequence = false;
-  std::vector<tensorflow::Tensor> outputs;
+  std::shared_ptr<Task> task;
   {
     mutex_lock l(mu_);
     auto it = tasks_.find(request->task_id());
@@ -132,25 +284,10 @@ Status DataServiceWorkerImpl::GetElement(const GetElementRequest* request,
       return errors::NotFound("DataServiceWorkerImpl::GetElement failed. ",
                               "Task id ", request->task_id(), " not found");
     }
-    std::unique_ptr<standalone::Iterator>& iter = it->second.iterator;
-    if (iter == nullptr) {
-      response->set_end_of_sequence(true);
-      return Status::OK();
-    }
-    TF_RETURN_IF_ERROR(iter->GetNext(&outputs, &end_of_sequence));
-    if (end_of_sequence) {
-      // Release iterator memory and leave a null entry as a tombstone.
-      iter.reset();
-    }
-  }
-
-  if (!end_of_sequence) {
-    TF_RETURN_IF_ERROR(service_util::Compress(
-        outputs, response->mutable_compressed_element()));
+    task = it->second;
   }
-  response->set_end_of_sequence(end_of_sequence);
-
-  return Status::OK();
+  // Tasks are served concurrently, without holding `mu_`.
+  return task->GetElements(request->max_elements(), response);
 }
 
 }  // namespace data
@@ -48,19 +48,14 @@ class DataServiceWorkerImpl {
                     GetElementResponse* response);
 
  private:
+  // Prefetches the elements of a task. Defined in worker_impl.cc.
+  class Task;
+
   // Registers the worker with the master.
   Status Register();
   // Creates an iterator to process a task.
   Status ProcessTaskInternal(const TaskDef& task);
 
-  typedef struct Task {
-    int64 id;
-    // TODO(aaudibert): Have standalone::Iterator own a reference to
-    // standalone::Dataset so that we don't need to store the dataset here.
-    std::unique_ptr<standalone::Dataset> dataset;
-    std::unique_ptr<standalone::Iterator> iterator;
-  } Task;
-
   const std::string master_address_;
   // Protocol for communicating with the master.
   const std::string protocol_;
@@ -70,7 +65,7 @@ class DataServiceWorkerImpl {
   mutex mu_;
   std::unique_ptr<MasterService::Stub> master_stub_ TF_GUARDED_BY(mu_);
   // Information about tasks, keyed by task ids.
-  absl::flat_hash_map<int64, Task> tasks_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<int64, std::shared_ptr<Task>> tasks_ TF_GUARDED_BY(mu_);
 
   TF_DISALLOW_COPY_AND_ASSIGN(DataServiceWorkerImpl);
 };
@@ -0,0 +1,131 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace eager {
+
+EnqueueBatcher::EnqueueBatcher(int64 max_items_per_request,
+                               int64 max_requests_in_flight, SendFn send)
+    : max_items_per_request_(max_items_per_request),
+      max_requests_in_flight_(std::max<int64>(1, max_requests_in_flight)),
+      send_(std::move(send)) {}
+
+EnqueueBatcher::~EnqueueBatcher() {
+  DCHECK(pending_ == nullptr);
+  DCHECK(to_send_.empty());
+}
+
+void EnqueueBatcher::Enqueue(const EnqueueRequest* request,
+                             EnqueueResponse* response, StatusCallback done) {
+  if (max_items_per_request_ <= 1) {
+    send_(request, response, std::move(done));
+    return;
+  }
+  bool send_now = false;
+  {
+    mutex_lock l(mu_);
+    if (pending_ == nullptr) {
+      pending_.reset(new Batch);
+      pending_->request.set_context_id(request->context_id());
+    }
+    DCHECK_EQ(pending_->request.context_id(), request->context_id());
+    for (const QueueItem& item : request->queue()) {
+      *pending_->request.add_queue() = item;
+    }
+    pending_->callers.push_back({request->queue_size(), response,
+                                 std::move(done)});
+    if (requests_in_flight_ < max_requests_in_flight_ ||
+        pending_->request.queue_size() >= max_items_per_request_) {
+      FlushLocked();
+      send_now = !sending_;
+      sending_ = true;
+    }
+  }
+  if (send_now) {
+    SendQueuedBatches();
+  }
+}
+
+void EnqueueBatcher::FlushLocked() {
+  to_send_.push_back(std::move(pending_));
+  ++requests_in_flight_;
+}
+
+void EnqueueBatcher::SendQueuedBatches() {
+  while (true) {
+    Batch* batch;
+    {
+      mutex_lock l(mu_);
+      if (to_send_.empty()) {
+        sending_ = false;
+        return;
+      }
+      batch = to_send_.front().release();
+      to_send_.pop_front();
+    }
+    VLOG(3) << "Sending " << batch->request.queue_size() << " queue items of "
+            << batch->callers.size() << " enqueue requests at once";
+    Ref();
+    send_(&batch->request, &batch->response, [this, batch](const Status& s) {
+      BatchDone(std::unique_ptr<Batch>(batch), s);
+      Unref();
+    });
+  }
+}
+
+void EnqueueBatcher::BatchDone(std::unique_ptr<Batch> batch,
+                               const Status& status) {
+  if (status.ok()) {
+    auto* queue_responses = batch->response.mutable_queue_response();
+    int index = 0;
+    for (const Caller& caller : batch->callers) {
+      for (int i = 0; i < caller.num_items && index < queue_responses->size();
+           ++i, ++index) {
+        caller.response->add_queue_response()->Swap(
+            queue_responses->Mutable(index));
+      }
+    }
+  }
+
+  // Complete the callers before sending the pending batch, so that callbacks
+  // run in order even if that batch fails right away.
+  for (Caller& caller : batch->callers) {
+    caller.done(status);
+  }
+
+  bool send_now = false;
+  {
+    mutex_lock l(mu_);
+    --requests_in_flight_;
+    if (pending_ != nullptr && requests_in_flight_ < max_requests_in_flight_) {
+      FlushLocked();
+      send_now = !sending_;
+      sending_ = true;
+    }
+  }
+  if (send_now) {
+    SendQueuedBatches();
+  }
+}
+
+}  // namespace eager
+}  // namespace tensorflow
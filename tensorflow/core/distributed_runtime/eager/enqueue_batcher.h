@@ -0,0 +1,111 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/eager_service.pb.h"
+
+namespace tensorflow {
+namespace eager {
+
+// Coalesces the EnqueueRequests sent to one remote eager context into fewer,
+// larger requests.
+//
+// Requests are sent right away while fewer than `max_requests_in_flight`
+// requests are waiting for their responses. Beyond that, the queue items of
+// new requests are appended to one pending request, which is sent as soon as
+// a response comes back or it holds `max_items_per_request` items. So an idle
+// client sees no extra latency, while a client that issues ops faster than the
+// remote worker answers them sends one request per round trip of responses
+// rather than one per op.
+//
+// Items are sent in the order they were enqueued, and each caller's response
+// holds the queue responses of just its own items. If a combined request
+// fails, all of its callers get the error, as the items after the failing one
+// were not run.
+//
+// Thread-safe.
+class EnqueueBatcher : public core::RefCounted {
+ public:
+  // Sends `request` and calls `done` once `response` is filled in. Must
+  // deliver responses in the order requests were sent, like
+  // EagerClient::StreamingEnqueueAsync.
+  typedef std::function<void(const EnqueueRequest* request,
+                             EnqueueResponse* response, StatusCallback done)>
+      SendFn;
+
+  // `max_items_per_request` <= 1 sends every request as is.
+  EnqueueBatcher(int64 max_items_per_request, int64 max_requests_in_flight,
+                 SendFn send);
+
+  ~EnqueueBatcher() override;
+
+  // Like EagerClient::StreamingEnqueueAsync: `done` is called once `response`
+  // has the responses to the items of `request`, which can be deleted as
+  // soon as Enqueue returns.
+  void Enqueue(const EnqueueRequest* request, EnqueueResponse* response,
+               StatusCallback done);
+
+ private:
+  // A caller whose items are part of a combined request.
+  struct Caller {
+    int num_items;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+
+  // A combined request and the callers whose items it holds, in order.
+  struct Batch {
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<Caller> callers;
+  };
+
+  // Moves `pending_` to the send queue and sends it, unless another thread
+  // is already sending, which then sends it in turn.
+  void FlushLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void SendQueuedBatches() TF_LOCKS_EXCLUDED(mu_);
+
+  // Splits the response of `batch` among its callers.
+  void BatchDone(std::unique_ptr<Batch> batch, const Status& status)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  const int64 max_items_per_request_;
+  const int64 max_requests_in_flight_;
+  const SendFn send_;
+
+  mutex mu_;
+  std::unique_ptr<Batch> pending_ TF_GUARDED_BY(mu_);
+  // Batches waiting to be sent, in order, and whether a thread is sending
+  // them. Sending outside of `mu_` lets `send_` call back into this.
+  std::deque<std::unique_ptr<Batch>> to_send_ TF_GUARDED_BY(mu_);
+  bool sending_ TF_GUARDED_BY(mu_) = false;
+  int64 requests_in_flight_ TF_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace eager
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_EAGER_ENQUEUE_BATCHER_H_
@@ -0,0 +1,181 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
+
+#include <vector>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace eager {
+namespace {
+
+// Records the requests it is asked to send, and answers them when told to,
+// with one queue response per item holding the item's op id.
+class FakeSender {
+ public:
+  EnqueueBatcher::SendFn AsSendFn() {
+    return [this](const EnqueueRequest* request, EnqueueResponse* response,
+                  StatusCallback done) {
+      requests_.push_back(*request);
+      pending_.push_back({response, std::move(done)});
+    };
+  }
+
+  // Answers the oldest request that has not been answered yet.
+  void Respond(const Status& status) {
+    ASSERT_LT(num_responded_, pending_.size());
+    EnqueueResponse* response = pending_[num_responded_].first;
+    // Answering may send more requests, so don't hold on to the vectors.
+    StatusCallback done = std::move(pending_[num_responded_].second);
+    for (const QueueItem& item : requests_[num_responded_].queue()) {
+      response->add_queue_response()->add_shape()->add_dim()->set_size(
+          item.operation().id());
+    }
+    ++num_responded_;
+    done(status);
+  }
+
+  const std::vector<EnqueueRequest>& requests() const { return requests_; }
+
+ private:
+  std::vector<EnqueueRequest> requests_;
+  std::vector<std::pair<EnqueueResponse*, StatusCallback>> pending_;
+  int num_responded_ = 0;
+};
+
+EnqueueRequest MakeRequest(std::initializer_list<int64> op_ids) {
+  EnqueueRequest request;
+  request.set_context_id(7);
+  for (int64 id : op_ids) {
+    request.add_queue()->mutable_operation()->set_id(id);
+  }
+  return request;
+}
+
+// The op ids that `response` holds queue responses for.
+std::vector<int64> ResponseIds(const EnqueueResponse& response) {
+  std::vector<int64> ids;
+  for (const QueueResponse& queue_response : response.queue_response()) {
+    ids.push_back(queue_response.shape(0).dim(0).size());
+  }
+  return ids;
+}
+
+TEST(EnqueueBatcherTest, CoalescesRequestsWhileOthersAreInFlight) {
+  FakeSender sender;
+  core::RefCountPtr<EnqueueBatcher> batcher(new EnqueueBatcher(
+      /*max_items_per_request=*/10, /*max_requests_in_flight=*/1,
+      sender.AsSendFn()));
+
+  std::vector<EnqueueResponse> responses(4);
+  std::vector<Status> statuses(4, errors::Unknown("not done"));
+  const std::vector<EnqueueRequest> requests = {
+      MakeRequest({1}), MakeRequest({2, 3}), MakeRequest({4}),
+      MakeRequest({5})};
+  for (int i = 0; i < 3; ++i) {
+    batcher->Enqueue(&requests[i], &responses[i],
+                     [&statuses, i](const Status& s) { statuses[i] = s; });
+  }
+  // The first request went out alone, the next two wait for its response.
+  ASSERT_EQ(sender.requests().size(), 1);
+  EXPECT_EQ(sender.requests()[0].queue_size(), 1);
+
+  sender.Respond(Status::OK());
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_EQ(ResponseIds(responses[0]), std::vector<int64>({1}));
+  ASSERT_EQ(sender.requests().size(), 2);
+  EXPECT_EQ(sender.requests()[1].context_id(), 7);
+  EXPECT_EQ(sender.requests()[1].queue_size(), 3);
+
+  batcher->Enqueue(&requests[3], &responses[3],
+                   [&statuses](const Status& s) { statuses[3] = s; });
+  sender.Respond(Status::OK());
+  TF_EXPECT_OK(statuses[1]);
+  TF_EXPECT_OK(statuses[2]);
+  EXPECT_EQ(ResponseIds(responses[1]), std::vector<int64>({2, 3}));
+  EXPECT_EQ(ResponseIds(responses[2]), std::vector<int64>({4}));
+  ASSERT_EQ(sender.requests().size(), 3);
+
+  sender.Respond(Status::OK());
+  TF_EXPECT_OK(statuses[3]);
+  EXPECT_EQ(ResponseIds(responses[3]), std::vector<int64>({5}));
+}
+
+TEST(EnqueueBatcherTest, SendsFullRequests) {
+  FakeSender sender;
+  core::RefCountPtr<EnqueueBatcher> batcher(new EnqueueBatcher(
+      /*max_items_per_request=*/2, /*max_requests_in_flight=*/1,
+      sender.AsSendFn()));
+
+  std::vector<EnqueueResponse> responses(3);
+  const std::vector<EnqueueRequest> requests = {
+      MakeRequest({1}), MakeRequest({2}), MakeRequest({3})};
+  for (int i = 0; i < 3; ++i) {
+    batcher->Enqueue(&requests[i], &responses[i], [](const Status& s) {});
+  }
+  // The second and third requests fill a request, so it is sent without
+  // waiting for the first response.
+  ASSERT_EQ(sender.requests().size(), 2);
+  EXPECT_EQ(sender.requests()[1].queue_size(), 2);
+  sender.Respond(Status::OK());
+  sender.Respond(Status::OK());
+  EXPECT_EQ(ResponseIds(responses[2]), std::vector<int64>({3}));
+}
+
+TEST(EnqueueBatcherTest, FailsAllCallersOfAFailedRequest) {
+  FakeSender sender;
+  core::RefCountPtr<EnqueueBatcher> batcher(new EnqueueBatcher(
+      /*max_items_per_request=*/10, /*max_requests_in_flight=*/1,
+      sender.AsSendFn()));
+
+  std::vector<EnqueueResponse> responses(3);
+  std::vector<Status> statuses(3);
+  const std::vector<EnqueueRequest> requests = {
+      MakeRequest({1}), MakeRequest({2}), MakeRequest({3})};
+  for (int i = 0; i < 3; ++i) {
+    batcher->Enqueue(&requests[i], &responses[i],
+                     [&statuses, i](const Status& s) { statuses[i] = s; });
+  }
+  sender.Respond(Status::OK());
+  sender.Respond(errors::InvalidArgument("bad op"));
+  TF_EXPECT_OK(statuses[0]);
+  EXPECT_TRUE(errors::IsInvalidArgument(statuses[1]));
+  EXPECT_TRUE(errors::IsInvalidArgument(statuses[2]));
+}
+
+TEST(EnqueueBatcherTest, PassesRequestsThroughWhenDisabled) {
+  FakeSender sender;
+  core::RefCountPtr<EnqueueBatcher> batcher(new EnqueueBatcher(
+      /*max_items_per_request=*/1, /*max_requests_in_flight=*/1,
+      sender.AsSendFn()));
+
+  std::vector<EnqueueResponse> responses(2);
+  const std::vector<EnqueueRequest> requests = {MakeRequest({1}),
+                                                MakeRequest({2})};
+  for (int i = 0; i < 2; ++i) {
+    batcher->Enqueue(&requests[i], &responses[i], [](const Status& s) {});
+  }
+  EXPECT_EQ(sender.requests().size(), 2);
+  sender.Respond(Status::OK());
+  sender.Respond(Status::OK());
+}
+
+}  // namespace
+}  // namespace eager
+}  // namespace tensorflow
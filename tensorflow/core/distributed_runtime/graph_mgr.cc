@@ -121,6 +121,33 @@ Status GraphMgr::DecorateAndPublishGraphForDebug(
 //
 // "executors" are filled with one executor per device if success and
 // the caller takes the ownership of returned executors.
+Status GraphMgr::ParseClientTerminatedKeys(const GraphDef& gdef, Item* item) {
+  for (const NodeDef& ndef : gdef.node()) {
+    if (ndef.op() != "_Recv" && ndef.op() != "_Send") continue;
+    bool client_terminated = false;
+    if (!TryGetNodeAttr(ndef, "client_terminated", &client_terminated) ||
+        !client_terminated) {
+      continue;
+    }
+    string tensor_name;
+    TF_RETURN_IF_ERROR(GetNodeAttr(ndef, "tensor_name", &tensor_name));
+    string send_device;
+    TF_RETURN_IF_ERROR(GetNodeAttr(ndef, "send_device", &send_device));
+    string recv_device;
+    TF_RETURN_IF_ERROR(GetNodeAttr(ndef, "recv_device", &recv_device));
+    int64 send_device_incarnation;
+    TF_RETURN_IF_ERROR(GetNodeAttr(ndef, "send_device_incarnation",
+                                   &send_device_incarnation));
+    const string key = Rendezvous::CreateKey(
+        send_device, static_cast<uint64>(send_device_incarnation), recv_device,
+        tensor_name, FrameAndIter(0, 0));
+    Rendezvous::ParsedKey parsed;
+    TF_RETURN_IF_ERROR(Rendezvous::ParseKey(key, &parsed));
+    item->client_terminated_keys.emplace(key, parsed);
+  }
+  return Status::OK();
+}
+
 Status GraphMgr::InitItem(
     const string& handle, const GraphDef& gdef, WorkerSession* session,
     const GraphOptions& graph_options, const DebugOptions& debug_options,
@@ -128,6 +155,7 @@ Status GraphMgr::InitItem(
     DistributedFunctionLibraryRuntime* cluster_flr, Item* item) {
   item->session = handle;
   item->collective_graph_key = collective_graph_key;
+  TF_RETURN_IF_ERROR(ParseClientTerminatedKeys(gdef, item));
   item->lib_def.reset(
       new FunctionLibraryDefinition(OpRegistry::Global(), gdef.library()));
 
@@ -368,10 +396,54 @@ Status GraphMgr::SendInputs(const int64 step_id, const NamedTensors& in) {
   return s;
 }
 
+Status GraphMgr::ParseKey(const Item* item, const string& key,
+                          Rendezvous::ParsedKey* scratch,
+                          const Rendezvous::ParsedKey** parsed) {
+  if (item != nullptr) {
+    auto it = item->client_terminated_keys.find(key);
+    if (it != item->client_terminated_keys.end()) {
+      *parsed = &it->second;
+      return Status::OK();
+    }
+  }
+  TF_RETURN_IF_ERROR(Rendezvous::ParseKey(key, scratch));
+  *parsed = scratch;
+  return Status::OK();
+}
+
 Status GraphMgr::RecvOutputs(const int64 step_id, NamedTensors* out) {
+  return RecvOutputs(/*handle=*/"", step_id, out);
+}
+
+Status GraphMgr::RecvOutputs(const string& handle, const int64 step_id,
+                             NamedTensors* out) {
+  Item* item = nullptr;
+  if (!handle.empty()) {
+    mutex_lock l(mu_);
+    auto iter = table_.find(handle);
+    if (iter != table_.end()) {
+      item = iter->second;
+      item->Ref();
+    }
+  }
   Rendezvous* rendezvous = worker_env_->rendezvous_mgr->Find(step_id);
-  Status s = RecvOutputsFromRendezvous(rendezvous, out, Rendezvous::Args());
+  Status s;
+  Rendezvous::ParsedKey scratch;
+  for (auto& p : *out) {
+    const Rendezvous::ParsedKey* parsed;
+    s = ParseKey(item, p.first, &scratch, &parsed);
+    if (!s.ok()) break;
+    bool is_dead = false;
+    s = rendezvous->Recv(*parsed, Rendezvous::Args(), &p.second, &is_dead);
+    if (!s.ok()) break;
+    if (is_dead) {
+      s = errors::InvalidArgument("The tensor returned for ", p.first,
+                                  " was not valid.");
+      break;
+    }
+  }
   rendezvous->Unref();
+  if (item != nullptr) item->Unref();
   if (!s.ok()) {
     // Failing to fetch the outputs should not be possible, so rewrite the error
     // status to an INTERNAL error.
@@ -461,16 +533,15 @@ void GraphMgr::ExecuteAsync(const string& handle, const int64 step_id,
   // Sends values specified by the caller.
   size_t input_size = 0;
   if (s.ok()) {
-    std::vector<string> keys;
-    std::vector<Tensor> tensors_to_send;
-    keys.reserve(in.size());
-    tensors_to_send.reserve(in.size());
-    for (auto& p : in) {
-      keys.push_back(p.first);
-      tensors_to_send.push_back(p.second);
+    Rendezvous::ParsedKey scratch;
+    for (const auto& p : in) {
+      const Rendezvous::ParsedKey* parsed;
+      s = ParseKey(item, p.first, &scratch, &parsed);
+      if (!s.ok()) break;
+      s = rendezvous->Send(*parsed, Rendezvous::Args(), p.second, false);
+      if (!s.ok()) break;
       input_size += p.second.AllocatedBytes();
     }
-    s = SendTensorsToRendezvous(rendezvous, nullptr, {}, keys, tensors_to_send);
   }
 
   if (!s.ok()) {
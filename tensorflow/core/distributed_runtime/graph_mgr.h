@@ -28,6 +28,7 @@ limitations under the License.
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/cost_graph.pb.h"
 #include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -96,6 +97,10 @@ class GraphMgr {
 
   Status SendInputs(const int64 step_id, const NamedTensors& in);
   Status RecvOutputs(const int64 step_id, NamedTensors* out);
+  // Same as above, but receives the outputs of the registered graph "handle"
+  // using the rendezvous keys parsed when it was registered.
+  Status RecvOutputs(const string& handle, const int64 step_id,
+                     NamedTensors* out);
   void RecvOutputsAsync(const int64 step_id, NamedTensors* out,
                         StatusCallback done);
 
@@ -142,6 +147,10 @@ class GraphMgr {
     GraphMgr* graph_mgr;
 
     int64 collective_graph_key;
+
+    // The rendezvous keys of the client-terminated Send and Recv nodes, i.e.
+    // the feeds and fetches of the graph, parsed once at registration.
+    std::unordered_map<string, Rendezvous::ParsedKey> client_terminated_keys;
   };
 
   const WorkerEnv* worker_env_;  // Not owned.
@@ -163,6 +172,17 @@ class GraphMgr {
   // mechanism to gc these graphs.
   std::unordered_map<string, Item*> table_;
 
+  // Fills in "item->client_terminated_keys" from the feeds and fetches of
+  // "gdef", which are the same in every step.
+  static Status ParseClientTerminatedKeys(const GraphDef& gdef, Item* item);
+
+  // Sets "*parsed" to the parsed form of rendezvous key "key", looking it up
+  // in the keys pre-parsed for "item" if possible, or else parsing it into
+  // "*scratch". "item" may be nullptr.
+  static Status ParseKey(const Item* item, const string& key,
+                         Rendezvous::ParsedKey* scratch,
+                         const Rendezvous::ParsedKey** parsed);
+
   void StartParallelExecutors(const string& handle, int64 step_id, Item* item,
                               Rendezvous* rendezvous,
                               CollectiveExecutor::Handle* ce_handle,
@@ -48,10 +48,12 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -60,6 +62,61 @@ limitations under the License.
 
 namespace tensorflow {
 
+// Maps the content of a RegisterGraphRequest sent to a worker to the handle
+// of the graph it registered, and counts the ReffedClientGraphs using it.
+// Reference counted, since a ReffedClientGraph can outlive its session.
+class MasterSession::RegisteredGraphCache : public core::RefCounted {
+ public:
+  // Returns the key identifying `req` when sent to `worker_name`.
+  static string Key(const string& worker_name,
+                    const RegisterGraphRequest& req) {
+    string serialized;
+    SerializeToStringDeterministic(req, &serialized);
+    const Fprint128 fingerprint = Fingerprint128(serialized);
+    return strings::StrCat(worker_name, ":", fingerprint.low64, ":",
+                           fingerprint.high64);
+  }
+
+  // Returns true and sets `*graph_handle` if a graph was registered under
+  // `key`, in which case the caller must eventually call Release(key).
+  bool Lookup(const string& key, string* graph_handle) {
+    mutex_lock l(mu_);
+    auto it = graphs_.find(key);
+    if (it == graphs_.end()) return false;
+    ++it->second.refcount;
+    *graph_handle = it->second.graph_handle;
+    return true;
+  }
+
+  // Records that `graph_handle` was registered under `key`. Returns false,
+  // without taking a reference, if another graph was registered under `key`
+  // in the meantime.
+  bool Insert(const string& key, const string& graph_handle) {
+    mutex_lock l(mu_);
+    return graphs_.insert({key, {graph_handle, 1}}).second;
+  }
+
+  // Drops a reference to the graph registered under `key`. Returns true if
+  // that was the last one, and the graph should be deregistered.
+  bool Release(const string& key) {
+    mutex_lock l(mu_);
+    auto it = graphs_.find(key);
+    DCHECK(it != graphs_.end());
+    if (it == graphs_.end() || --it->second.refcount > 0) return false;
+    graphs_.erase(it);
+    return true;
+  }
+
+ private:
+  struct Entry {
+    string graph_handle;
+    int refcount;
+  };
+
+  mutex mu_;
+  std::unordered_map<string, Entry> graphs_ TF_GUARDED_BY(mu_);
+};
+
 // MasterSession wraps ClientGraph in a reference counted object.
 // This way, MasterSession can clear up the cache mapping Run requests to
 // compiled graphs while the compiled graph is still being used.
@@ -72,7 +129,8 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
                     const SessionOptions& session_opts,
                     const StatsPublisherFactory& stats_publisher_factory,
                     bool is_partial, WorkerCacheInterface* worker_cache,
-                    bool should_deregister)
+                    bool should_deregister,
+                    RegisteredGraphCache* registered_graphs)
       : session_handle_(handle),
         bg_opts_(bopts),
         client_graph_before_register_(std::move(client_graph)),
@@ -82,7 +140,9 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
         worker_cache_(worker_cache),
         should_deregister_(should_deregister),
         collective_graph_key_(
-            client_graph_before_register_->collective_graph_key) {
+            client_graph_before_register_->collective_graph_key),
+        registered_graphs_(registered_graphs) {
+    registered_graphs_->Ref();
     VLOG(1) << "Created ReffedClientGraph for node with "
             << client_graph_before_register_->graph.num_node_ids();
 
@@ -103,9 +163,13 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
       DeregisterPartitions();
     } else {
       for (Part& part : partitions_) {
+        if (!part.cache_key.empty()) {
+          registered_graphs_->Release(part.cache_key);
+        }
         worker_cache_->ReleaseWorker(part.name, part.worker);
       }
     }
+    registered_graphs_->Unref();
   }
 
   const CallableOptions& callable_options() { return callable_opts_; }
@@ -246,6 +310,7 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
 
   const bool should_deregister_;
   const int64 collective_graph_key_;
+  RegisteredGraphCache* const registered_graphs_;  // Not owned.
   std::atomic<int64> execution_count_ = {0};
 
   // Graph partitioned into per-location subgraphs.
@@ -266,6 +331,10 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     // this partition on the worker.
     string graph_handle;
 
+    // If not empty, `graph_handle` is shared with other client graphs
+    // through the session's RegisteredGraphCache under this key.
+    string cache_key;
+
     Part() : feed_key(3), key_fetch(3) {}
   };
 
@@ -466,7 +535,6 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
   };
   const int num = partitions_.size();
   gtl::InlinedVector<Call, 4> calls(num);
-  BlockingCounter done(num);
   for (int i = 0; i < num; ++i) {
     const Part& part = partitions_[i];
     Call* c = &calls[i];
@@ -480,18 +548,43 @@ Status MasterSession::ReffedClientGraph::DoRegisterPartitions(
     *c->req.mutable_debug_options() =
         callable_opts_.run_options().debug_options();
     c->req.set_collective_graph_key(collective_graph_key_);
+  }
+
+  // Partitions identical to ones that another client graph of this session
+  // registered reuse their worker graphs.
+  std::vector<string> keys(num);
+  std::vector<int> to_register;
+  for (int i = 0; i < num; ++i) {
+    Part* part = &partitions_[i];
+    keys[i] = RegisteredGraphCache::Key(part->name, calls[i].req);
+    if (registered_graphs_->Lookup(keys[i], &part->graph_handle)) {
+      VLOG(2) << "Reusing graph " << part->graph_handle << " on "
+              << part->name;
+      part->cache_key = keys[i];
+    } else {
+      to_register.push_back(i);
+    }
+  }
+
+  BlockingCounter done(to_register.size());
+  for (int i : to_register) {
+    Call* c = &calls[i];
     VLOG(2) << "Register " << c->req.graph_def().DebugString();
     auto cb = [c, &done](const Status& s) {
       c->status = s;
       done.DecrementCount();
     };
-    part.worker->RegisterGraphAsync(&c->req, &c->resp, cb);
+    partitions_[i].worker->RegisterGraphAsync(&c->req, &c->resp, cb);
   }
   done.Wait();
-  for (int i = 0; i < num; ++i) {
+  for (int i : to_register) {
     Call* c = &calls[i];
     s.Update(c->status);
     partitions_[i].graph_handle = c->resp.graph_handle();
+    if (c->status.ok() &&
+        registered_graphs_->Insert(keys[i], c->resp.graph_handle())) {
+      partitions_[i].cache_key = keys[i];
+    }
   }
   return s;
 }
@@ -1097,6 +1190,13 @@ void MasterSession::ReffedClientGraph::DeregisterPartitions() {
     DeregisterGraphResponse resp;
   };
   for (Part& part : partitions_) {
+    // Graphs shared with other client graphs are deregistered along with the
+    // last of them.
+    if (!part.cache_key.empty() &&
+        !registered_graphs_->Release(part.cache_key)) {
+      worker_cache_->ReleaseWorker(part.name, part.worker);
+      continue;
+    }
     // The graph handle may be empty if we failed during partition registration.
     if (!part.graph_handle.empty()) {
       Call* c = new Call;
@@ -1240,7 +1340,8 @@ MasterSession::MasterSession(
       stats_publisher_factory_(std::move(stats_publisher_factory)),
       graph_version_(0),
       run_graphs_(5),
-      partial_run_graphs_(5) {
+      partial_run_graphs_(5),
+      registered_graphs_(new RegisteredGraphCache) {
   UpdateLastAccessTime();
   CHECK(devices_) << "device_set was null!";
 
@@ -1253,6 +1354,7 @@ MasterSession::MasterSession(
 MasterSession::~MasterSession() {
   for (const auto& iter : run_graphs_) iter.second->Unref();
   for (const auto& iter : partial_run_graphs_) iter.second->Unref();
+  registered_graphs_->Unref();
 }
 
 void MasterSession::UpdateLastAccessTime() {
@@ -1532,7 +1634,7 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
       auto entry = new ReffedClientGraph(
           handle_, opts, std::move(client_graph), session_opts_,
           stats_publisher_factory_, is_partial, worker_cache,
-          !should_delete_worker_sessions_);
+          !should_delete_worker_sessions_, registered_graphs_);
       iter = m->insert({hash, entry}).first;
       VLOG(1) << "Preparing to execute new graph";
     }
@@ -2001,7 +2103,8 @@ Status MasterSession::MakeCallable(const MakeCallableRequest& req,
     callable = new ReffedClientGraph(handle_, opts, std::move(client_graph),
                                      session_opts_, stats_publisher_factory_,
                                      false /* is_partial */, get_worker_cache(),
-                                     !should_delete_worker_sessions_);
+                                     !should_delete_worker_sessions_,
+                                     registered_graphs_);
   }
 
   Status s = BuildAndRegisterPartitions(callable);
@@ -157,6 +157,12 @@ class MasterSession : public core::RefCounted {
   int64 next_callable_handle_ TF_GUARDED_BY(mu_) = 0;
   RCGMap callables_ TF_GUARDED_BY(mu_);
 
+  // Partitions registered on workers by any ReffedClientGraph of this
+  // session, keyed by their content, so that client graphs that produce
+  // identical partitions share a single worker graph.
+  class RegisteredGraphCache;
+  RegisteredGraphCache* const registered_graphs_;
+
   struct PerStepState {
     bool collect_costs = false;
     bool collect_timeline = false;
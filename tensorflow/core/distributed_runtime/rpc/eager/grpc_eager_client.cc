@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
 #include "grpcpp/generic/generic_stub.h"
+#include "tensorflow/core/distributed_runtime/eager/enqueue_batcher.h"
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_service.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_client_cq_tag.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_state.h"
@@ -62,6 +63,31 @@ bool EnableStreaming() {
   return result;
 }
 
+// Enqueue requests to a remote context are coalesced into requests of up to
+// this many queue items while earlier requests wait for their responses (see
+// EnqueueBatcher). Setting it to 1 sends every request as is.
+int64 MaxEnqueueBatchItems() {
+  static const int64 max_items = [] {
+    int64 result;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_CLIENT_MAX_ENQUEUE_BATCH_ITEMS",
+                                    128, &result));
+    return result;
+  }();
+  return max_items;
+}
+
+// The number of enqueue requests to a remote context that are sent without
+// waiting for responses before new requests start being coalesced.
+int64 MaxEnqueueRequestsInFlight() {
+  static const int64 max_in_flight = [] {
+    int64 result;
+    TF_CHECK_OK(ReadInt64FromEnvVar(
+        "TF_EAGER_CLIENT_MAX_ENQUEUE_REQUESTS_IN_FLIGHT", 4, &result));
+    return result;
+  }();
+  return max_in_flight;
+}
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -151,6 +177,7 @@ class GrpcEagerClient : public EagerClient {
             << request->DebugString();
 
     mutex_lock l(mu_);
+    enqueue_batchers_.erase(request->context_id());
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
       it->second.CancelCall();
@@ -166,18 +193,8 @@ class GrpcEagerClient : public EagerClient {
                              StatusCallback done) override {
     StatusCallback done_wrapped = callback_wrapper(std::move(done));
     if (EnableStreaming()) {
-      tf_shared_lock l(mu_);
-      auto it = enqueue_dispatchers_.find(request->context_id());
-      if (it == enqueue_dispatchers_.end()) {
-        auto it_and_bool = enqueue_dispatchers_.emplace(
-            std::piecewise_construct,
-            std::forward_as_tuple(request->context_id()),
-            std::forward_as_tuple(
-                &stub_, cq_,
-                "/tensorflow.eager.EagerService/StreamingEnqueue"));
-        it = it_and_bool.first;
-      }
-      it->second.SendNextRequest(*request, response, std::move(done_wrapped));
+      GetEnqueueBatcher(request->context_id())
+          ->Enqueue(request, response, std::move(done_wrapped));
     } else {
       Notification n;
       Status status;
@@ -191,6 +208,61 @@ class GrpcEagerClient : public EagerClient {
   }
 
  private:
+  core::RefCountPtr<EnqueueBatcher> GetEnqueueBatcher(uint64 context_id) {
+    EnqueueBatcher* batcher = nullptr;
+    {
+      // Callbacks of earlier requests can enqueue new ones, and can run while
+      // this thread holds a shared lock, so only take an exclusive lock to
+      // create a batcher.
+      tf_shared_lock l(mu_);
+      auto it = enqueue_batchers_.find(context_id);
+      if (it != enqueue_batchers_.end()) {
+        batcher = it->second.get();
+        batcher->Ref();
+      }
+    }
+    if (batcher == nullptr) {
+      mutex_lock l(mu_);
+      auto& entry = enqueue_batchers_[context_id];
+      if (entry == nullptr) {
+        entry.reset(new EnqueueBatcher(
+            MaxEnqueueBatchItems(), MaxEnqueueRequestsInFlight(),
+            [this, context_id](const EnqueueRequest* request,
+                               EnqueueResponse* response, StatusCallback done) {
+              SendStreamingEnqueue(context_id, request, response,
+                                   std::move(done));
+            }));
+      }
+      batcher = entry.get();
+      batcher->Ref();
+    }
+    return core::RefCountPtr<EnqueueBatcher>(batcher);
+  }
+
+  // Sends `request` on the StreamingEnqueue call of context `context_id`.
+  void SendStreamingEnqueue(uint64 context_id, const EnqueueRequest* request,
+                            EnqueueResponse* response, StatusCallback done) {
+    {
+      mutex_lock l(mu_);
+      if (enqueue_dispatchers_.find(context_id) ==
+          enqueue_dispatchers_.end()) {
+        enqueue_dispatchers_.emplace(
+            std::piecewise_construct, std::forward_as_tuple(context_id),
+            std::forward_as_tuple(
+                &stub_, cq_,
+                "/tensorflow.eager.EagerService/StreamingEnqueue"));
+      }
+    }
+    tf_shared_lock l(mu_);
+    auto it = enqueue_dispatchers_.find(context_id);
+    if (it == enqueue_dispatchers_.end()) {
+      done(errors::Cancelled("Remote eager context ", context_id,
+                             " was closed"));
+      return;
+    }
+    it->second.SendNextRequest(*request, response, std::move(done));
+  }
+
   ::grpc::GenericStub stub_;
   const GrpcEagerClientThread* thread_;
 
@@ -200,6 +272,9 @@ class GrpcEagerClient : public EagerClient {
 
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
+  // Coalesces the requests sent to each streaming call.
+  std::unordered_map<uint64, core::RefCountPtr<EnqueueBatcher>>
+      enqueue_batchers_ TF_GUARDED_BY(mu_);
 
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
@@ -0,0 +1,214 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Microbenchmarks for the RPC path of the distributed runtime. Every benchmark
+// drives a GrpcSession against a cluster of grpc_testlib servers; the session
+// target is always task 0, whose worker is reached without RPCs.
+//
+//   BM_RecvTensor: cost of RecvTensor RPCs from task 1 into task 0, over a
+//     range of tensor sizes and numbers of concurrent transfers per step.
+//   BM_RecvTensorMultiWorker: RecvTensor fan-in from N-1 remote tasks.
+//   BM_SessionStep: overhead of a step that runs an empty partition on each of
+//     N tasks.
+//   BM_RunGraph: a single empty partition run on task 0 (arg 0) or on task 1
+//     (arg 1); the difference is the cost of one RunGraph RPC.
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/rpc/grpc_session.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_testlib.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+#include "tensorflow/core/public/session.h"
+
+namespace tensorflow {
+namespace {
+
+const int kWarmupSteps = 3;
+
+// Returns a cluster of `num_tasks` single-CPU tasks. Clusters are created on
+// first use and shared by all benchmarks that ask for the same size, since
+// starting the server processes dominates the cost of short benchmarks.
+const test::TestCluster* GetCluster(int num_tasks) {
+  static mutex* mu = new mutex;
+  static auto* clusters =
+      new std::map<int, std::unique_ptr<test::TestCluster>>;
+  mutex_lock l(*mu);
+  std::unique_ptr<test::TestCluster>& cluster = (*clusters)[num_tasks];
+  if (cluster == nullptr) {
+    SessionOptions options;
+    (*options.config.mutable_device_count())["CPU"] = 1;
+    (*options.config.mutable_device_count())["GPU"] = 0;
+    TF_CHECK_OK(
+        test::TestCluster::MakeTestCluster(options, num_tasks, &cluster));
+    CHECK_EQ(cluster->devices().size(), num_tasks);
+  }
+  return cluster.get();
+}
+
+SessionOptions Options(const test::TestCluster* cluster) {
+  SessionOptions options;
+  options.target = strings::StrCat("grpc://", cluster->targets()[0]);
+  // Keep the graph as built: no constant folding or other rewrites that would
+  // remove the cross-task edges under measurement.
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_opt_level(OptimizerOptions::L0);
+  options.config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_disable_meta_optimizer(true);
+  return options;
+}
+
+// Runs the "sink" target of `graph` on `cluster` for `iters` timed steps.
+void RunSteps(int iters, const test::TestCluster* cluster,
+              const GraphDef& graph) {
+  std::unique_ptr<Session> session(NewSession(Options(cluster)));
+  CHECK(session != nullptr);
+  TF_CHECK_OK(session->Create(graph));
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < kWarmupSteps; ++i) {
+    TF_CHECK_OK(session->Run({}, {}, {"sink"}, &outputs));
+  }
+  testing::UseRealTime();
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    TF_CHECK_OK(session->Run({}, {}, {"sink"}, &outputs));
+  }
+  testing::StopTiming();
+  TF_CHECK_OK(session->Close());
+}
+
+// Builds a graph in which task 0 receives `concurrency` float tensors of
+// `tensor_size` elements from each of the other tasks of `cluster` per step.
+GraphDef RecvTensorGraph(const test::TestCluster* cluster, int tensor_size,
+                         int concurrency) {
+  Graph graph(OpRegistry::Global());
+  Tensor value(DT_FLOAT, TensorShape({tensor_size}));
+  value.flat<float>().setZero();
+  std::vector<Node*> consumers;
+  for (int task = 1; task < cluster->devices().size(); ++task) {
+    for (int i = 0; i < concurrency; ++i) {
+      Node* producer = test::graph::Constant(&graph, value);
+      producer->set_requested_device(cluster->devices()[task].name());
+      Node* consumer = test::graph::Identity(&graph, producer);
+      consumer->set_requested_device(cluster->devices()[0].name());
+      consumers.push_back(consumer);
+    }
+  }
+  Node* sink = test::graph::NoOp(&graph, consumers);
+  sink->set_requested_device(cluster->devices()[0].name());
+  GraphDef def;
+  graph.ToGraphDef(&def);
+  for (NodeDef& node : *def.mutable_node()) {
+    if (node.name() == sink->name()) node.set_name("sink");
+  }
+  return def;
+}
+
+// Builds a graph with one NoOp on each of `tasks`, all feeding a sink on the
+// first of them.
+GraphDef NoOpGraph(const test::TestCluster* cluster,
+                   const std::vector<int>& tasks) {
+  Graph graph(OpRegistry::Global());
+  std::vector<Node*> ops;
+  for (int task : tasks) {
+    Node* op = test::graph::NoOp(&graph, {});
+    op->set_requested_device(cluster->devices()[task].name());
+    ops.push_back(op);
+  }
+  Node* sink = test::graph::NoOp(&graph, ops);
+  sink->set_requested_device(cluster->devices()[tasks[0]].name());
+  GraphDef def;
+  graph.ToGraphDef(&def);
+  for (NodeDef& node : *def.mutable_node()) {
+    if (node.name() == sink->name()) node.set_name("sink");
+  }
+  return def;
+}
+
+void RecvTensorHelper(int iters, int num_tasks, int tensor_size,
+                      int concurrency) {
+  testing::StopTiming();
+  const test::TestCluster* cluster = GetCluster(num_tasks);
+  const GraphDef graph = RecvTensorGraph(cluster, tensor_size, concurrency);
+  const int64 recvs_per_step = static_cast<int64>(num_tasks - 1) * concurrency;
+  testing::SetLabel(strings::StrCat(num_tasks, " tasks; ", recvs_per_step,
+                                    " RecvTensor/step; ",
+                                    tensor_size * sizeof(float), " bytes each"));
+  RunSteps(iters, cluster, graph);
+  testing::ItemsProcessed(iters * recvs_per_step);
+  testing::BytesProcessed(iters * recvs_per_step * tensor_size * sizeof(float));
+}
+
+void BM_RecvTensor(int iters, int tensor_size, int concurrency) {
+  RecvTensorHelper(iters, 2 /*num_tasks*/, tensor_size, concurrency);
+}
+BENCHMARK(BM_RecvTensor)
+    ->ArgPair(1, 1)
+    ->ArgPair(1, 16)
+    ->ArgPair(1, 64)
+    ->ArgPair(1024, 1)
+    ->ArgPair(1024, 16)
+    ->ArgPair(1024, 64)
+    ->ArgPair(256 << 10, 1)
+    ->ArgPair(256 << 10, 16)
+    ->ArgPair(4 << 20, 1)
+    ->ArgPair(4 << 20, 4);
+
+void BM_RecvTensorMultiWorker(int iters, int num_tasks, int tensor_size) {
+  RecvTensorHelper(iters, num_tasks, tensor_size, 1 /*concurrency*/);
+}
+BENCHMARK(BM_RecvTensorMultiWorker)
+    ->ArgPair(3, 1)
+    ->ArgPair(3, 256 << 10)
+    ->ArgPair(5, 1)
+    ->ArgPair(5, 256 << 10)
+    ->ArgPair(9, 1)
+    ->ArgPair(9, 256 << 10);
+
+void BM_SessionStep(int iters, int num_tasks) {
+  testing::StopTiming();
+  const test::TestCluster* cluster = GetCluster(num_tasks);
+  std::vector<int> tasks(num_tasks);
+  for (int i = 0; i < num_tasks; ++i) tasks[i] = i;
+  testing::SetLabel(strings::StrCat(num_tasks, " tasks"));
+  RunSteps(iters, cluster, NoOpGraph(cluster, tasks));
+}
+BENCHMARK(BM_SessionStep)->Arg(1)->Arg(2)->Arg(3)->Arg(5)->Arg(9);
+
+void BM_RunGraph(int iters, int remote) {
+  testing::StopTiming();
+  const test::TestCluster* cluster = GetCluster(2);
+  testing::SetLabel(remote ? "remote partition" : "local partition");
+  RunSteps(iters, cluster, NoOpGraph(cluster, {remote ? 1 : 0}));
+}
+BENCHMARK(BM_RunGraph)->Arg(0)->Arg(1);
+
+}  // namespace
+}  // namespace tensorflow
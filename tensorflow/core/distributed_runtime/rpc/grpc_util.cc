@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/lib/random/random.h"
 
 namespace tensorflow {
@@ -86,6 +87,58 @@ int64 ComputeBackoffMicroseconds(int current_retry_attempt, int64 min_delay,
   return ::grpc::Status::OK;
 }
 
+namespace {
+
+// A TensorBuffer that points into a received grpc::Slice and holds a
+// reference on it.
+class GrpcSliceTensorBuffer : public TensorBuffer {
+ public:
+  GrpcSliceTensorBuffer(::grpc::Slice slice, const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        slice_(std::move(slice)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("grpc_slice");
+  }
+  // The slice may be shared with gRPC, so the buffer must not be forwarded to
+  // kernels that write their outputs in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  ~GrpcSliceTensorBuffer() override = default;
+
+  const ::grpc::Slice slice_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(GrpcSliceTensorBuffer);
+};
+
+}  // namespace
+
+TensorBuffer* GrpcByteSource::ShareBytes(const char* data, size_t num_bytes) {
+  std::vector<::grpc::Slice> slices;
+  if (!buffer_->Dump(&slices).ok()) {
+    return nullptr;
+  }
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(data);
+  for (::grpc::Slice& s : slices) {
+    const uintptr_t slice_begin = reinterpret_cast<uintptr_t>(s.begin());
+    if (begin < slice_begin || begin + num_bytes > slice_begin + s.size()) {
+      continue;
+    }
+    if (s.size() > 2 * num_bytes) {
+      return nullptr;
+    }
+    return new GrpcSliceTensorBuffer(std::move(s), data, num_bytes);
+  }
+  // The stream reads from a copy of the buffer, e.g. after decompression.
+  return nullptr;
+}
+
 bool GrpcMaybeParseProto(::grpc::ByteBuffer* src, protobuf::Message* dst) {
   ::grpc::ProtoBufferReader reader(src);
   return dst->ParseFromZeroCopyStream(&reader);
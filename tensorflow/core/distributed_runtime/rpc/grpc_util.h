@@ -53,6 +53,11 @@ class GrpcByteSource : public TensorResponse::Source {
     return stream_;
   }
 
+  // Shares the bytes if they lie within a single slice of the buffer that is
+  // not much larger than them, so that the tensor does not pin unrelated
+  // data.
+  TensorBuffer* ShareBytes(const char* data, size_t num_bytes) override;
+
  private:
   void DeleteStream() {
     if (stream_) {
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_session.h"
@@ -55,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/platform/tracing.h"
 #include "tensorflow/core/protobuf/transport_options.pb.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
+#include "tensorflow/core/util/device_name_utils.h"
 
 namespace tensorflow {
 
@@ -144,6 +146,7 @@ class GrpcWorkerServiceThread {
     SETUP_FOR_REQUEST(CompleteInstance, 10, true);
     SETUP_FOR_REQUEST(GetStepSequence, 10, true);
     SETUP_FOR_REQUEST(RecvBuf, 500, true);
+    SETUP_FOR_REQUEST(RecvTensorBatch, 100, true);
     SETUP_FOR_REQUEST(RunGraph, 100, true);
     SETUP_FOR_REQUEST(CleanupGraph, 100, false);
     SETUP_FOR_REQUEST(MarkRecvFinished, 10, false);
@@ -283,6 +286,25 @@ class GrpcWorkerServiceThread {
     EnqueueRecvTensorRequestRaw();
   }
 
+  void RecvTensorBatchHandler(
+      WorkerCall<RecvTensorBatchRequest, RecvTensorBatchResponse>* call) {
+    Schedule([this, call]() {
+      CallOptions* call_opts = new CallOptions;
+      call->SetCancelCallback([call_opts]() { call_opts->StartCancel(); });
+      worker_->RecvTensorBatchAsync(
+          call_opts, &call->request, &call->response,
+          [call, call_opts](const Status& s) {
+            call->ClearCancelCallback();
+            delete call_opts;
+            if (!s.ok()) {
+              VLOG(1) << "Bad response from RecvTensorBatch:" << s;
+            }
+            call->SendResponse(ToGrpcStatus(s));
+          });
+    });
+    ENQUEUE_REQUEST(RecvTensorBatch, true);
+  }
+
   void RecvBufHandler(WorkerCall<RecvBufRequest, RecvBufResponse>* call) {
     Schedule([this, call]() {
       CallOptions* call_opts = new CallOptions;
@@ -416,6 +438,10 @@ class GrpcWorkerService : public AsyncServiceInterface {
   TF_DISALLOW_COPY_AND_ASSIGN(GrpcWorkerService);
 };
 
+// Bounds the compressed tensors kept to serve RecvTensor requests for the same
+// tensor from other receivers.
+constexpr int64 kCompressedTensorCacheBytes = 256 << 20;
+
 }  // namespace
 
 GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
@@ -427,6 +453,10 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
   if (config.rpc_options().cache_rpc_response()) {
     EnableResponseCache();
   }
+  if (RecvTensorCompressionEnabled()) {
+    compressed_tensor_cache_ =
+        absl::make_unique<CompressedTensorCache>(kCompressedTensorCacheBytes);
+  }
 }
 
 void GrpcWorker::EnableResponseCache() {
@@ -434,6 +464,41 @@ void GrpcWorker::EnableResponseCache() {
   response_cache_ = absl::make_unique<GrpcResponseCache>();
 }
 
+namespace {
+// Returns the sending and receiving workers of "rendezvous_key", which label
+// the compression metrics.
+string RecvTensorEdge(const string& rendezvous_key) {
+  Rendezvous::ParsedKey parsed;
+  string src_worker, dst_worker, device;
+  if (!Rendezvous::ParseKey(rendezvous_key, &parsed).ok() ||
+      !DeviceNameUtils::SplitDeviceName(parsed.src_device, &src_worker,
+                                        &device) ||
+      !DeviceNameUtils::SplitDeviceName(parsed.dst_device, &dst_worker,
+                                        &device)) {
+    return "unknown";
+  }
+  return strings::StrCat(src_worker, "->", dst_worker);
+}
+
+// Sets the tensor of "*response" to "tensor" with compressed contents if
+// "request" accepts them and they compress well, and returns whether it did.
+// "cache" is null if compression is disabled.
+bool MaybeCompressRecvTensorResponse(const RecvTensorRequest& request,
+                                     const Tensor& tensor, bool is_dead,
+                                     CompressedTensorCache* cache,
+                                     RecvTensorResponse* response) {
+  if (is_dead || !request.accept_compressed_content() || cache == nullptr) {
+    return false;
+  }
+  const TensorContentCodec codec =
+      cache->Compress(tensor, RecvTensorEdge(request.rendezvous_key()),
+                      response->mutable_tensor());
+  if (codec == TENSOR_CONTENT_RAW) return false;
+  response->set_content_codec(codec);
+  return true;
+}
+}  // namespace
+
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
 // buffers for a response object, to avoid extra protocol buffer serialization
 // overhead we generate our response directly into a ::grpc::ByteBuffer object
@@ -447,13 +512,15 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](const Tensor& tensor,
-                                                     bool is_dead,
-                                                     const Status& status) {
-    if (status.ok()) {
-      grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+  auto do_response = [this, request, response, done, cache_enabled](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
+    if (!status.ok()) {
+      done(status);
+      return;
     }
-    done(status);
+    done(EncodeRecvTensorResponse(*request, tensor, is_dead, cache_enabled,
+                                  response));
   };
 
   // If response cache is enabled and the response cache already contains the
@@ -487,34 +554,45 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
     return;
   }
 
+  // Request the tensor associated with the rendezvous key.
+  // Note that we log the cancellation here but do not abort the current step.
+  // gRPC can generate cancellations in response to transient network failures,
+  // and aborting the step eliminates the opportunity for client side retries.
+  // Repeated client failures will eventually cause the step to be aborted by
+  // the client.
+  opts->SetCancelCallback(
+      [step_id]() { LOG(WARNING) << "RecvTensor cancelled for " << step_id; });
+  RecvLocalTensorAsync(
+      request, [opts, rendezvous_done](const Tensor& tensor, bool is_dead,
+                                       const Status& status) {
+        opts->ClearCancelCallback();
+        rendezvous_done(tensor, is_dead, status);
+      });
+}
+
+void GrpcWorker::RecvLocalTensorAsync(
+    const RecvTensorRequest* request,
+    std::function<void(const Tensor&, bool, const Status&)> done) {
+  const int64 step_id = request->step_id();
   const string& key = request->rendezvous_key();
   TRACEPRINTF("RecvTensor: %lld %s", step_id, key.c_str());
   Rendezvous::ParsedKey parsed;
-  s = Rendezvous::ParseKey(key, &parsed);
+  Status s = Rendezvous::ParseKey(key, &parsed);
   Device* src_dev = nullptr;
   if (s.ok()) {
     s = PrepareRecvTensor(parsed, &src_dev);
   }
   if (!s.ok()) {
-    fail(s);
+    done(Tensor(), false, s);
     return;
   }
 
-  // Request the tensor associated with the rendezvous key.
-  // Note that we log the cancellation here but do not abort the current step.
-  // gRPC can generate cancellations in response to transient network failures,
-  // and aborting the step eliminates the opportunity for client side retries.
-  // Repeated client failures will eventually cause the step to be aborted by
-  // the client.
-  opts->SetCancelCallback(
-      [step_id]() { LOG(WARNING) << "RecvTensor cancelled for " << step_id; });
   env_->rendezvous_mgr->RecvLocalAsync(
       step_id, parsed,
-      [opts, rendezvous_done, src_dev, request](
-          const Status& status, const Rendezvous::Args& send_args,
-          const Rendezvous::Args& recv_args, const Tensor& val,
-          const bool is_dead) {
-        opts->ClearCancelCallback();
+      [done, src_dev, request](const Status& status,
+                               const Rendezvous::Args& send_args,
+                               const Rendezvous::Args& recv_args,
+                               const Tensor& val, const bool is_dead) {
         if (status.ok()) {
           // DMA can only be used for Tensors that do not fall into
           // the following three odd edge cases: 1) a zero-size
@@ -537,10 +615,10 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
                   << " gpu_info: " << src_dev->tensorflow_gpu_device_info();
               // "val" is on an accelerator device. Uses the device_context to
               // fill the copy on host.
-              StatusCallback copy_ready = [rendezvous_done, copy,
+              StatusCallback copy_ready = [done, copy,
                                            is_dead](const Status& s) {
                 // The value is now ready to be returned on the wire.
-                rendezvous_done(*copy, is_dead, s);
+                done(*copy, is_dead, s);
                 delete copy;
               };
 
@@ -551,10 +629,80 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
           }
         }
 
-        rendezvous_done(val, is_dead, status);
+        done(val, is_dead, status);
       });
 }
 
+void GrpcWorker::RecvTensorBatchAsync(CallOptions* opts,
+                                      const RecvTensorBatchRequest* request,
+                                      RecvTensorBatchResponse* response,
+                                      StatusCallback done) {
+  const int num_requests = request->requests_size();
+  VLOG(1) << "RecvTensorBatchAsync req: " << num_requests << " tensors";
+  if (num_requests == 0) {
+    done(Status::OK());
+    return;
+  }
+  for (int i = 0; i < num_requests; ++i) {
+    response->add_responses();
+  }
+
+  // As for RecvTensor, cancellation does not abort the step.
+  const int64 step_id = request->requests(0).step_id();
+  opts->SetCancelCallback([step_id]() {
+    LOG(WARNING) << "RecvTensorBatch cancelled for " << step_id;
+  });
+  struct BatchState {
+    mutex mu;
+    int pending TF_GUARDED_BY(mu);
+    Status status TF_GUARDED_BY(mu);
+  };
+  BatchState* state = new BatchState;
+  {
+    mutex_lock l(state->mu);
+    state->pending = num_requests;
+  }
+  auto finish_one = [opts, state, done](const Status& s) {
+    Status status;
+    {
+      mutex_lock l(state->mu);
+      state->status.Update(s);
+      if (--state->pending > 0) return;
+      status = state->status;
+    }
+    delete state;
+    opts->ClearCancelCallback();
+    done(status);
+  };
+
+  for (int i = 0; i < num_requests; ++i) {
+    const RecvTensorRequest* sub_request = &request->requests(i);
+    RecvTensorResponse* sub_response = response->mutable_responses(i);
+    Status s = recent_request_ids_.TrackUnique(sub_request->request_id(),
+                                               "RecvTensorBatch (GrpcWorker)",
+                                               *sub_request);
+    if (!s.ok()) {
+      finish_one(s);
+      continue;
+    }
+    RecvLocalTensorAsync(
+        sub_request, [this, sub_request, sub_response, finish_one](
+                         const Tensor& tensor, bool is_dead,
+                         const Status& status) {
+          if (status.ok()) {
+            sub_response->set_is_dead(is_dead);
+            sub_response->set_send_start_micros(env_->env->NowMicros());
+            if (!MaybeCompressRecvTensorResponse(
+                    *sub_request, tensor, is_dead,
+                    compressed_tensor_cache_.get(), sub_response)) {
+              tensor.AsProtoTensorContent(sub_response->mutable_tensor());
+            }
+          }
+          finish_one(status);
+        });
+  }
+}
+
 namespace {
 // If RecvBufRespExtra.tensor_content is a single large string, then gRPC
 // can stall on the recv side when the string buffer needs to be enlarged,
@@ -738,6 +886,22 @@ void GrpcWorker::CleanupGraphAsync(const CleanupGraphRequest* request,
 
 WorkerEnv* GrpcWorker::env() { return env_; }
 
+Status GrpcWorker::EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                            const Tensor& tensor, bool is_dead,
+                                            bool require_ack,
+                                            ::grpc::ByteBuffer* response) {
+  RecvTensorResponse proto;
+  if (MaybeCompressRecvTensorResponse(request, tensor, is_dead,
+                                      compressed_tensor_cache_.get(), &proto)) {
+    proto.set_require_ack(require_ack);
+    proto.set_send_start_micros(Env::Default()->NowMicros());
+    grpc::EncodeRecvTensorResponseToByteBuffer(proto, response);
+    return Status::OK();
+  }
+  grpc::EncodeTensorToByteBuffer(is_dead, tensor, require_ack, response);
+  return Status::OK();
+}
+
 void GrpcWorker::RemoveCacheEntryForId(int64 request_id) {
   if (response_cache_) {
     response_cache_->EraseRequestId(request_id);
@@ -21,6 +21,7 @@ limitations under the License.
 #include "grpcpp/server_builder.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_response_cache.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service_impl.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/worker.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -46,6 +47,12 @@ class GrpcWorker : public Worker {
                                    ::grpc::ByteBuffer* response,
                                    StatusCallback done);
 
+  // Receives all tensors of "request", and fails if any of them fails.
+  void RecvTensorBatchAsync(CallOptions* opts,
+                            const RecvTensorBatchRequest* request,
+                            RecvTensorBatchResponse* response,
+                            StatusCallback done) override;
+
   void LoggingAsync(const LoggingRequest* request, LoggingResponse* response,
                     StatusCallback done) override;
 
@@ -62,8 +69,26 @@ class GrpcWorker : public Worker {
 
   void RemoveCacheEntryForId(int64 request_id);
 
+ protected:
+  // Encodes the response to "request" for the received "tensor" into
+  // "*response".  Transports that move tensor contents outside of the RPC
+  // override this to interpret request.transport_options().
+  virtual Status EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                          const Tensor& tensor, bool is_dead,
+                                          bool require_ack,
+                                          ::grpc::ByteBuffer* response);
+
  private:
+  // Receives the tensor of "request" from the local rendezvous, copies it to
+  // host memory if it lives on a GPU, and calls "done" with it.
+  void RecvLocalTensorAsync(
+      const RecvTensorRequest* request,
+      std::function<void(const Tensor&, bool, const Status&)> done);
+
   std::unique_ptr<GrpcResponseCache> response_cache_;
+  // Shares the compression of a tensor among the RecvTensor responses that
+  // send it to several receivers.  Null unless compression is enabled.
+  std::unique_ptr<CompressedTensorCache> compressed_tensor_cache_;
   const int32 recv_buf_max_chunk_;
 };
 
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <unordered_map>
 #include <unordered_set>
 
 #include "tensorflow/core/common_runtime/device.h"
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/request_id.h"
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/distributed_runtime/worker_cache.h"
 #include "tensorflow/core/distributed_runtime/worker_interface.h"
 #include "tensorflow/core/framework/types.h"
@@ -32,15 +34,41 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
 namespace {
 
+class RpcRecvTensorCall;
+struct RecvTensorBatch;
+
+// Returns the time in microseconds for which RecvTensor calls of a step to the
+// same worker are held back to be sent together in one RecvTensorBatch RPC,
+// or 0 if every call is sent right away.  Set by the environment variable
+// TF_RECV_TENSOR_BATCH_WINDOW_MICROS.
+int64 RecvTensorBatchWindowMicros() {
+  static const int64 window_micros = []() {
+    int64 value;
+    Status s =
+        ReadInt64FromEnvVar("TF_RECV_TENSOR_BATCH_WINDOW_MICROS", 0, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return int64{0};
+    }
+    return value;
+  }();
+  return window_micros;
+}
+
+// A batch is sent before its window ends once it has this many calls.
+constexpr size_t kMaxRecvTensorBatchSize = 128;
+
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64 step_id,
+                      RecvTensorTransport* transport)
+      : BaseRemoteRendezvous(env, step_id), transport_(transport) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -50,18 +78,36 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  // Adds "call" to the pending batch of its source worker, and sends the
+  // batch once it is full or its window ends.
+  void EnqueueBatchedCall(RpcRecvTensorCall* call,
+                          std::function<void()> recv_done);
+  // Sends "batch" if it is still pending for "src_worker".
+  void FlushBatch(const string& src_worker, RecvTensorBatch* batch);
+  static void StartBatch(RecvTensorBatch* batch);
+  static void FinishBatch(RecvTensorBatch* batch, const Status& status);
+
+  RecvTensorTransport* const transport_;  // Not owned.
+
+  mutex batch_mu_;
+  std::unordered_map<string, RecvTensorBatch*> pending_batches_
+      TF_GUARDED_BY(batch_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRemoteRendezvous);
 };
 
 // Used only to retrieve tensors from remote processes.
 class RpcRecvTensorCall : public BaseRecvTensorCall {
  public:
-  RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
+  RpcRecvTensorCall()
+      : wi_(nullptr), transport_(nullptr), dst_device_(nullptr) {}
 
-  void Init(WorkerInterface* wi, int64 step_id, StringPiece key,
-            AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+  void Init(WorkerInterface* wi, RecvTensorTransport* transport, int64 step_id,
+            StringPiece key, AllocatorAttributes alloc_attrs,
+            Device* dst_device, const Rendezvous::Args& recv_args,
+            Rendezvous::DoneCallback done) {
     wi_ = wi;
+    transport_ = transport;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
     recv_args_ = recv_args;
@@ -69,6 +115,11 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_step_id(step_id);
     req_.set_rendezvous_key(key.data(), key.size());
     req_.set_request_id(GetUniqueRequestId());
+    // TensorResponse decompresses contents into host memory only.
+    if (RecvTensorCompressionEnabled() &&
+        (alloc_attrs.on_host() || dst_device->device_type() == DEVICE_CPU)) {
+      req_.set_accept_compressed_content(true);
+    }
   }
 
   void Reset() {
@@ -77,6 +128,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     DCHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
         << "Leaking WorkerInterface in RpcRecvTensorCall::Reset().";
 
+    transport_ = nullptr;
     alloc_attrs_ = AllocatorAttributes();
     dst_device_ = nullptr;
     // We don't clear opts_ and assume that Init will set up the state for
@@ -143,12 +195,22 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
       }
       recv_done();
     };
-    wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
+    if (transport_ == nullptr) {
+      wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
+      return;
+    }
+    transport_->PrepareRequest(src_worker_, dst_device_, alloc_attrs_, &req_);
+    wi_->RecvTensorAsync(
+        &opts_, &req_, &resp_, [this, cb = std::move(cb)](const Status& s) {
+          transport_->FinishResponse(s, src_worker_, req_, &resp_,
+                                     std::move(cb));
+        });
   }
 
   string src_worker_;
   string src_rel_device_;
-  WorkerInterface* wi_;  // Not owned.
+  WorkerInterface* wi_;             // Not owned.
+  RecvTensorTransport* transport_;  // Not owned.
   AllocatorAttributes alloc_attrs_;
   Device* dst_device_;
   CallOptions opts_;
@@ -163,6 +225,26 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRecvTensorCall);
 };
 
+// RecvTensor calls of one step to the same worker, sent in one RPC.
+struct RecvTensorBatch {
+  string src_worker;
+  std::vector<std::pair<RpcRecvTensorCall*, std::function<void()>>> calls;
+  CallOptions opts;
+  RecvTensorBatchRequest req;
+  RecvTensorBatchResponse resp;
+};
+
+// Workers that do not implement RecvTensorBatch, to which calls are sent
+// one by one.
+mutex* workers_without_batching_mu() {
+  static mutex* mu = new mutex;
+  return mu;
+}
+std::unordered_set<string>* workers_without_batching() {
+  static std::unordered_set<string>* workers = new std::unordered_set<string>;
+  return workers;
+}
+
 class RpcRecvTensorFreeList {
  public:
   RpcRecvTensorFreeList() {}
@@ -247,8 +329,8 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
-  call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+  call->Init(rwi, transport_, step_id_, parsed.FullKey(),
+             recv_args.alloc_attrs, dst_device, recv_args, std::move(done));
 
   // Record "call" in active_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
@@ -266,7 +348,7 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 
   // Start "call".
   Ref();
-  call->Start([this, call, worker_cache]() {
+  std::function<void()> recv_done = [this, call, worker_cache]() {
     // Removes "call" from active_. Prevent StartAbort().
     DeregisterCall(call);
     // If StartAbort was called prior to DeregisterCall, then the
@@ -279,17 +361,148 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     call->done()(s, Args(), call->recv_args(), call->tensor(), call->is_dead());
     get_call_freelist()->Release(call);
     Unref();
-  });
+  };
+  if (transport_ == nullptr && RecvTensorBatchWindowMicros() > 0) {
+    EnqueueBatchedCall(call, std::move(recv_done));
+  } else {
+    call->Start(std::move(recv_done));
+  }
+}
+
+void RpcRemoteRendezvous::EnqueueBatchedCall(RpcRecvTensorCall* call,
+                                             std::function<void()> recv_done) {
+  bool batching_supported;
+  {
+    mutex_lock l(*workers_without_batching_mu());
+    batching_supported =
+        workers_without_batching()->count(call->src_worker_) == 0;
+  }
+  if (!batching_supported) {
+    call->Start(std::move(recv_done));
+    return;
+  }
+  RecvTensorBatch* full = nullptr;
+  RecvTensorBatch* created = nullptr;
+  {
+    mutex_lock l(batch_mu_);
+    RecvTensorBatch*& batch = pending_batches_[call->src_worker_];
+    if (batch == nullptr) {
+      batch = new RecvTensorBatch;
+      batch->src_worker = call->src_worker_;
+      created = batch;
+    }
+    batch->calls.emplace_back(call, std::move(recv_done));
+    if (batch->calls.size() >= kMaxRecvTensorBatchSize) {
+      full = batch;
+      pending_batches_.erase(call->src_worker_);
+    }
+  }
+  if (created != nullptr && full == nullptr) {
+    Ref();
+    const string src_worker = created->src_worker;
+    env_->env->SchedClosureAfter(RecvTensorBatchWindowMicros(),
+                                 [this, src_worker, created]() {
+                                   FlushBatch(src_worker, created);
+                                   Unref();
+                                 });
+  }
+  if (full != nullptr) StartBatch(full);
+}
+
+void RpcRemoteRendezvous::FlushBatch(const string& src_worker,
+                                     RecvTensorBatch* batch) {
+  {
+    mutex_lock l(batch_mu_);
+    auto it = pending_batches_.find(src_worker);
+    // The batch may have been sent because it was full.  Flushing a newer
+    // batch at the same address early is harmless.
+    if (it == pending_batches_.end() || it->second != batch) return;
+    pending_batches_.erase(it);
+  }
+  StartBatch(batch);
+}
+
+/* static */
+void RpcRemoteRendezvous::StartBatch(RecvTensorBatch* batch) {
+  if (batch->calls.size() == 1) {
+    auto& entry = batch->calls[0];
+    entry.first->Start(std::move(entry.second));
+    delete batch;
+    return;
+  }
+  for (auto& entry : batch->calls) {
+    RpcRecvTensorCall* call = entry.first;
+    *batch->req.add_requests() = call->req_;
+    // Aborting any call of the step cancels the whole batch.
+    call->opts_.SetCancelCallback([batch]() { batch->opts.StartCancel(); });
+  }
+  VLOG(2) << "Sending " << batch->calls.size() << " RecvTensor calls to "
+          << batch->src_worker << " in one batch";
+  // All calls hold a reference on a worker interface of src_worker until
+  // they are done.
+  WorkerInterface* wi = batch->calls[0].first->wi_;
+  wi->RecvTensorBatchAsync(
+      &batch->opts, &batch->req, &batch->resp,
+      [batch](const Status& s) { FinishBatch(batch, s); });
+}
+
+/* static */
+void RpcRemoteRendezvous::FinishBatch(RecvTensorBatch* batch,
+                                      const Status& status) {
+  for (auto& entry : batch->calls) {
+    entry.first->opts_.ClearCancelCallback();
+  }
+  if (errors::IsUnimplemented(status)) {
+    // The worker predates RecvTensorBatch.
+    {
+      mutex_lock l(*workers_without_batching_mu());
+      workers_without_batching()->insert(batch->src_worker);
+    }
+    for (auto& entry : batch->calls) {
+      entry.first->Start(std::move(entry.second));
+    }
+    delete batch;
+    return;
+  }
+  Status s = status;
+  if (s.ok() && batch->resp.responses_size() !=
+                    static_cast<int>(batch->calls.size())) {
+    s = errors::Internal("RecvTensorBatch returned ",
+                         batch->resp.responses_size(), " tensors for ",
+                         batch->calls.size(), " requests");
+  }
+  for (size_t i = 0; i < batch->calls.size(); ++i) {
+    RpcRecvTensorCall* call = batch->calls[i].first;
+    Status call_status = s;
+    if (call_status.ok()) {
+      call->resp_.InitAlloc(call->dst_device_, call->alloc_attrs_);
+      call_status = call->resp_.InitFrom(batch->resp.mutable_responses(i));
+    }
+    if (!call_status.ok()) {
+      mutex_lock l(call->mu_);
+      call->status_.Update(call_status);
+    }
+  }
+  // Running a callback may release the last reference on the rendezvous.
+  std::vector<std::function<void()>> callbacks;
+  for (auto& entry : batch->calls) {
+    callbacks.push_back(std::move(entry.second));
+  }
+  delete batch;
+  for (auto& callback : callbacks) {
+    callback();
+  }
 }
 
 }  // namespace
 
-RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env,
+                                   RecvTensorTransport* transport)
+    : BaseRendezvousMgr(env), transport_(transport) {}
 
 BaseRemoteRendezvous* RpcRendezvousMgr::Create(int64 step_id,
                                                const WorkerEnv* worker_env) {
-  return new RpcRemoteRendezvous(worker_env, step_id);
+  return new RpcRemoteRendezvous(worker_env, step_id, transport_);
 }
 
 }  // end namespace tensorflow
@@ -22,7 +22,33 @@ limitations under the License.
 
 namespace tensorflow {
 
+class Device;
 class DeviceMgr;
+class RecvTensorRequest;
+class TensorResponse;
+
+// Lets a transport move the contents of received tensors outside of the
+// RecvTensor RPC, e.g. by RDMA, while the RPC carries the metadata.
+class RecvTensorTransport {
+ public:
+  virtual ~RecvTensorTransport() {}
+
+  // Sets request->transport_options() for a RecvTensor call to
+  // "src_worker" that receives into memory of "dst_device" with
+  // "alloc_attrs".
+  virtual void PrepareRequest(const string& src_worker, Device* dst_device,
+                              const AllocatorAttributes& alloc_attrs,
+                              RecvTensorRequest* request) = 0;
+
+  // Called once the RecvTensor call prepared by PrepareRequest() finished
+  // with "status".  On success, fills in the contents of response->tensor()
+  // if the sender left them out of the response.  Calls "done" with the
+  // status of the receive.
+  virtual void FinishResponse(const Status& status, const string& src_worker,
+                              const RecvTensorRequest& request,
+                              TensorResponse* response,
+                              StatusCallback done) = 0;
+};
 
 // RendezvousMgr keeps track of a set of local rendezvous instances.
 // All tensors sent by this worker are buffered in a RendezvousMgr
@@ -44,12 +70,18 @@ class DeviceMgr;
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
-  explicit RpcRendezvousMgr(const WorkerEnv* env);
+  // If "transport" is not null, it must outlive this RendezvousMgr, and is
+  // used by all remote receives.
+  explicit RpcRendezvousMgr(const WorkerEnv* env,
+                            RecvTensorTransport* transport = nullptr);
 
  protected:
   BaseRemoteRendezvous* Create(int64 step_id, const WorkerEnv* worker_env);
 
  private:
+  RecvTensorTransport* const transport_;  // Not owned.
+
+
   TF_DISALLOW_COPY_AND_ASSIGN(RpcRendezvousMgr);
 };
 
@@ -0,0 +1,465 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/rdma.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <poll.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The largest number of completions that the polling thread handles at once.
+constexpr int kPollBatchSize = 32;
+// How often the polling thread checks whether it should stop.
+constexpr int kPollTimeoutMs = 100;
+
+constexpr int kAccessFlags = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ;
+
+Status ErrnoError(const char* operation, int error) {
+  return errors::Unavailable(operation, " failed: ", strerror(error));
+}
+
+}  // namespace
+
+struct RdmaQueuePair::WorkRequest {
+  RdmaQueuePair* qp;
+  bool is_receive = false;
+  ibv_sge sge;
+  ibv_send_wr wr;
+  std::function<void(const Status&)> done;
+};
+
+/* static */
+Status RdmaAdapter::Create(Env* env, std::unique_ptr<RdmaAdapter>* adapter) {
+  string device_name;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar("TF_VERBS_DEVICE", "", &device_name));
+  int64 port_num;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_VERBS_PORT", 1, &port_num));
+  int64 gid_index;
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar("TF_VERBS_GID_INDEX", 0, &gid_index));
+
+  std::unique_ptr<RdmaAdapter> ret(new RdmaAdapter);
+  ret->port_num_ = static_cast<uint8>(port_num);
+  ret->gid_index_ = static_cast<int>(gid_index);
+  int num_devices = 0;
+  ibv_device** devices = ibv_get_device_list(&num_devices);
+  if (devices == nullptr) {
+    return ErrnoError("ibv_get_device_list", errno);
+  }
+  for (int i = 0; i < num_devices; ++i) {
+    if (device_name.empty() || device_name == ibv_get_device_name(devices[i])) {
+      device_name = ibv_get_device_name(devices[i]);
+      ret->context_ = ibv_open_device(devices[i]);
+      break;
+    }
+  }
+  ibv_free_device_list(devices);
+  if (ret->context_ == nullptr) {
+    return errors::NotFound("Cannot open RDMA device ",
+                            device_name.empty() ? "(any)" : device_name);
+  }
+
+  if (ibv_query_device(ret->context_, &ret->device_attr_) != 0) {
+    return ErrnoError("ibv_query_device", errno);
+  }
+  if (ibv_query_port(ret->context_, ret->port_num_, &ret->port_attr_) != 0) {
+    return ErrnoError("ibv_query_port", errno);
+  }
+  if (ret->port_attr_.state != IBV_PORT_ACTIVE) {
+    return errors::Unavailable("Port ", port_num, " of RDMA device ",
+                               device_name, " is not active");
+  }
+  if (ibv_query_gid(ret->context_, ret->port_num_, ret->gid_index_,
+                    &ret->gid_) != 0) {
+    return ErrnoError("ibv_query_gid", errno);
+  }
+  ret->pd_ = ibv_alloc_pd(ret->context_);
+  if (ret->pd_ == nullptr) {
+    return ErrnoError("ibv_alloc_pd", errno);
+  }
+  ret->channel_ = ibv_create_comp_channel(ret->context_);
+  if (ret->channel_ == nullptr) {
+    return ErrnoError("ibv_create_comp_channel", errno);
+  }
+  const int flags = fcntl(ret->channel_->fd, F_GETFL);
+  if (fcntl(ret->channel_->fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+    return ErrnoError("fcntl", errno);
+  }
+  ret->cq_ = ibv_create_cq(ret->context_,
+                           std::min(ret->device_attr_.max_cqe, 1 << 16),
+                           nullptr, ret->channel_, 0);
+  if (ret->cq_ == nullptr) {
+    return ErrnoError("ibv_create_cq", errno);
+  }
+  const int error = ibv_req_notify_cq(ret->cq_, 0);
+  if (error != 0) {
+    return ErrnoError("ibv_req_notify_cq", error);
+  }
+  RdmaAdapter* raw = ret.get();
+  ret->poller_.reset(env->StartThread(ThreadOptions(), "rdma_poll_cq",
+                                      [raw]() { raw->PollCompletions(); }));
+  LOG(INFO) << "Using port " << port_num << " of RDMA device " << device_name;
+  *adapter = std::move(ret);
+  return Status::OK();
+}
+
+RdmaAdapter::~RdmaAdapter() {
+  StopPolling();
+  for (const auto& region : regions_) {
+    ibv_dereg_mr(region.second);
+  }
+  if (cq_ != nullptr) ibv_destroy_cq(cq_);
+  if (channel_ != nullptr) ibv_destroy_comp_channel(channel_);
+  if (pd_ != nullptr) ibv_dealloc_pd(pd_);
+  if (context_ != nullptr) ibv_close_device(context_);
+}
+
+void RdmaAdapter::StopPolling() {
+  stop_ = true;
+  poller_.reset();
+}
+
+void RdmaAdapter::RegisterMemory(void* ptr, size_t size) {
+  ibv_mr* mr = ibv_reg_mr(pd_, ptr, size, kAccessFlags);
+  if (mr == nullptr) {
+    LOG(WARNING) << "Cannot register " << size << " bytes with the RDMA "
+                 << "device, which will be registered on each transfer: "
+                 << strerror(errno);
+    return;
+  }
+  mutex_lock l(mu_);
+  regions_[reinterpret_cast<uintptr_t>(ptr)] = mr;
+}
+
+void RdmaAdapter::DeregisterMemory(void* ptr) {
+  ibv_mr* mr = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto it = regions_.find(reinterpret_cast<uintptr_t>(ptr));
+    if (it == regions_.end()) return;
+    mr = it->second;
+    regions_.erase(it);
+  }
+  ibv_dereg_mr(mr);
+}
+
+ibv_mr* RdmaAdapter::FindMemoryRegion(const void* ptr, size_t size) {
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(ptr);
+  mutex_lock l(mu_);
+  auto it = regions_.upper_bound(begin);
+  if (it == regions_.begin()) return nullptr;
+  --it;
+  if (begin + size > it->first + it->second->length) return nullptr;
+  return it->second;
+}
+
+Status RdmaAdapter::RegisterTemporaryMemory(void* ptr, size_t size,
+                                            ibv_mr** mr) {
+  *mr = ibv_reg_mr(pd_, ptr, size, kAccessFlags);
+  if (*mr == nullptr) {
+    return ErrnoError("ibv_reg_mr", errno);
+  }
+  return Status::OK();
+}
+
+Status RdmaAdapter::CreateQueuePair(std::unique_ptr<RdmaQueuePair>* qp) {
+  ibv_qp_init_attr init_attr;
+  memset(&init_attr, 0, sizeof(init_attr));
+  init_attr.send_cq = cq_;
+  init_attr.recv_cq = cq_;
+  init_attr.qp_type = IBV_QPT_RC;
+  init_attr.cap.max_send_wr = RdmaQueuePair::kMaxSends;
+  init_attr.cap.max_recv_wr = RdmaQueuePair::kNumReceives;
+  init_attr.cap.max_send_sge = 1;
+  init_attr.cap.max_recv_sge = 1;
+  ibv_qp* raw_qp = ibv_create_qp(pd_, &init_attr);
+  if (raw_qp == nullptr) {
+    return ErrnoError("ibv_create_qp", errno);
+  }
+
+  ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_INIT;
+  attr.pkey_index = 0;
+  attr.port_num = port_num_;
+  attr.qp_access_flags = kAccessFlags;
+  const int error = ibv_modify_qp(
+      raw_qp, &attr,
+      IBV_QP_STATE | IBV_QP_PKEY_INDEX | IBV_QP_PORT | IBV_QP_ACCESS_FLAGS);
+  if (error != 0) {
+    ibv_destroy_qp(raw_qp);
+    return ErrnoError("ibv_modify_qp", error);
+  }
+
+  RdmaEndpoint endpoint;
+  endpoint.set_gid_subnet_prefix(gid_.global.subnet_prefix);
+  endpoint.set_gid_interface_id(gid_.global.interface_id);
+  endpoint.set_lid(port_attr_.lid);
+  endpoint.set_qp_num(raw_qp->qp_num);
+  endpoint.set_psn(random::New64() & 0xffffff);
+  endpoint.set_mtu(port_attr_.active_mtu);
+  std::unique_ptr<RdmaQueuePair> ret(
+      new RdmaQueuePair(this, raw_qp, endpoint));
+  TF_RETURN_IF_ERROR(ret->Init());
+  *qp = std::move(ret);
+  return Status::OK();
+}
+
+void RdmaAdapter::PollCompletions() {
+  ibv_wc wcs[kPollBatchSize];
+  while (!stop_) {
+    pollfd fd;
+    fd.fd = channel_->fd;
+    fd.events = POLLIN;
+    fd.revents = 0;
+    if (poll(&fd, 1, kPollTimeoutMs) <= 0) continue;
+    ibv_cq* cq;
+    void* context;
+    if (ibv_get_cq_event(channel_, &cq, &context) != 0) continue;
+    ibv_ack_cq_events(cq, 1);
+    // Rearm before draining, so that no completion goes unnoticed.
+    const int error = ibv_req_notify_cq(cq_, 0);
+    if (error != 0) {
+      LOG(ERROR) << "ibv_req_notify_cq failed: " << strerror(error);
+    }
+    int n;
+    while ((n = ibv_poll_cq(cq_, kPollBatchSize, wcs)) > 0) {
+      for (int i = 0; i < n; ++i) {
+        auto* request =
+            reinterpret_cast<RdmaQueuePair::WorkRequest*>(wcs[i].wr_id);
+        request->qp->OnCompletion(wcs[i], request);
+      }
+    }
+    if (n < 0) {
+      LOG(ERROR) << "ibv_poll_cq failed";
+    }
+  }
+}
+
+RdmaQueuePair::RdmaQueuePair(RdmaAdapter* adapter, ibv_qp* qp,
+                             const RdmaEndpoint& local_endpoint)
+    : adapter_(adapter), qp_(qp), local_endpoint_(local_endpoint) {}
+
+RdmaQueuePair::~RdmaQueuePair() { ibv_destroy_qp(qp_); }
+
+Status RdmaQueuePair::Init() {
+  for (int i = 0; i < kNumReceives; ++i) {
+    receives_.emplace_back(new WorkRequest);
+    receives_.back()->qp = this;
+    receives_.back()->is_receive = true;
+    TF_RETURN_IF_ERROR(PostReceive(receives_.back().get()));
+  }
+  return Status::OK();
+}
+
+void RdmaQueuePair::SetReceiveHandler(
+    std::function<void(const Status&, uint32)> handler) {
+  receive_handler_ = std::move(handler);
+}
+
+Status RdmaQueuePair::Connect(const RdmaEndpoint& remote) {
+  ibv_qp_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTR;
+  attr.path_mtu =
+      static_cast<ibv_mtu>(std::min(local_endpoint_.mtu(), remote.mtu()));
+  attr.dest_qp_num = remote.qp_num();
+  attr.rq_psn = remote.psn();
+  attr.max_dest_rd_atomic = adapter_->device_attr_.max_qp_rd_atom;
+  attr.min_rnr_timer = 12;
+  attr.ah_attr.is_global = 1;
+  attr.ah_attr.grh.dgid.global.subnet_prefix = remote.gid_subnet_prefix();
+  attr.ah_attr.grh.dgid.global.interface_id = remote.gid_interface_id();
+  attr.ah_attr.grh.sgid_index = adapter_->gid_index_;
+  attr.ah_attr.grh.hop_limit = 255;
+  attr.ah_attr.dlid = remote.lid();
+  attr.ah_attr.port_num = adapter_->port_num_;
+  int error = ibv_modify_qp(
+      qp_, &attr,
+      IBV_QP_STATE | IBV_QP_AV | IBV_QP_PATH_MTU | IBV_QP_DEST_QPN |
+          IBV_QP_RQ_PSN | IBV_QP_MAX_DEST_RD_ATOMIC | IBV_QP_MIN_RNR_TIMER);
+  if (error != 0) {
+    return ErrnoError("ibv_modify_qp to RTR", error);
+  }
+
+  memset(&attr, 0, sizeof(attr));
+  attr.qp_state = IBV_QPS_RTS;
+  attr.timeout = 14;
+  attr.retry_cnt = 7;
+  attr.rnr_retry = 7;  // Retry indefinitely while receives are reposted.
+  attr.sq_psn = local_endpoint_.psn();
+  attr.max_rd_atomic = adapter_->device_attr_.max_qp_rd_atom;
+  error = ibv_modify_qp(qp_, &attr,
+                        IBV_QP_STATE | IBV_QP_TIMEOUT | IBV_QP_RETRY_CNT |
+                            IBV_QP_RNR_RETRY | IBV_QP_SQ_PSN |
+                            IBV_QP_MAX_QP_RD_ATOMIC);
+  if (error != 0) {
+    return ErrnoError("ibv_modify_qp to RTS", error);
+  }
+  return Status::OK();
+}
+
+void RdmaQueuePair::Read(void* local, uint32 lkey, uint64 remote_addr,
+                         uint32 rkey, uint64 num_bytes,
+                         std::function<void(const Status&)> done) {
+  // Reads that are larger than one RDMA operation are split, and "done" is
+  // called once all parts arrived.
+  struct ReadState {
+    mutex mu;
+    int num_pending;
+    Status status;
+    std::function<void(const Status&)> done;
+  };
+  const uint64 max_bytes = adapter_->max_message_bytes();
+  const int num_parts =
+      std::max<uint64>(1, (num_bytes + max_bytes - 1) / max_bytes);
+  auto state = std::make_shared<ReadState>();
+  state->num_pending = num_parts;
+  state->done = std::move(done);
+  for (int i = 0; i < num_parts; ++i) {
+    const uint64 offset = i * max_bytes;
+    auto* request = new WorkRequest;
+    request->qp = this;
+    request->sge.addr = reinterpret_cast<uintptr_t>(local) + offset;
+    request->sge.length = std::min(max_bytes, num_bytes - offset);
+    request->sge.lkey = lkey;
+    memset(&request->wr, 0, sizeof(request->wr));
+    request->wr.wr_id = reinterpret_cast<uintptr_t>(request);
+    request->wr.opcode = IBV_WR_RDMA_READ;
+    request->wr.send_flags = IBV_SEND_SIGNALED;
+    request->wr.sg_list = &request->sge;
+    request->wr.num_sge = 1;
+    request->wr.wr.rdma.remote_addr = remote_addr + offset;
+    request->wr.wr.rdma.rkey = rkey;
+    request->done = [state](const Status& s) {
+      bool last;
+      {
+        mutex_lock l(state->mu);
+        state->status.Update(s);
+        last = --state->num_pending == 0;
+      }
+      if (last) state->done(state->status);
+    };
+    PostSend(request);
+  }
+}
+
+void RdmaQueuePair::SendImmediate(uint32 value,
+                                  std::function<void(const Status&)> done) {
+  auto* request = new WorkRequest;
+  request->qp = this;
+  memset(&request->wr, 0, sizeof(request->wr));
+  request->wr.wr_id = reinterpret_cast<uintptr_t>(request);
+  request->wr.opcode = IBV_WR_SEND_WITH_IMM;
+  request->wr.send_flags = IBV_SEND_SIGNALED;
+  request->wr.imm_data = htonl(value);
+  request->done = std::move(done);
+  PostSend(request);
+}
+
+Status RdmaQueuePair::PostReceive(WorkRequest* request) {
+  ibv_recv_wr wr;
+  memset(&wr, 0, sizeof(wr));
+  wr.wr_id = reinterpret_cast<uintptr_t>(request);
+  ibv_recv_wr* bad_wr;
+  const int error = ibv_post_recv(qp_, &wr, &bad_wr);
+  if (error != 0) {
+    return ErrnoError("ibv_post_recv", error);
+  }
+  return Status::OK();
+}
+
+void RdmaQueuePair::PostSend(WorkRequest* request) {
+  {
+    mutex_lock l(mu_);
+    if (num_sends_ >= kMaxSends) {
+      pending_sends_.push_back(request);
+      return;
+    }
+    ++num_sends_;
+  }
+  StartSend(request);
+}
+
+void RdmaQueuePair::StartSend(WorkRequest* request) {
+  ibv_send_wr* bad_wr;
+  const int error = ibv_post_send(qp_, &request->wr, &bad_wr);
+  if (error == 0) return;
+  request->done(ErrnoError("ibv_post_send", error));
+  delete request;
+  WorkRequest* next = nullptr;
+  {
+    mutex_lock l(mu_);
+    if (pending_sends_.empty()) {
+      --num_sends_;
+    } else {
+      next = pending_sends_.front();
+      pending_sends_.pop_front();
+    }
+  }
+  if (next != nullptr) StartSend(next);
+}
+
+void RdmaQueuePair::OnCompletion(const ibv_wc& wc, WorkRequest* request) {
+  Status s;
+  if (wc.status != IBV_WC_SUCCESS) {
+    s = errors::Unavailable("RDMA work request failed: ",
+                            ibv_wc_status_str(wc.status));
+  }
+  if (request->is_receive) {
+    if (s.ok()) {
+      if (receive_handler_ && (wc.wc_flags & IBV_WC_WITH_IMM)) {
+        receive_handler_(Status::OK(), ntohl(wc.imm_data));
+      }
+      s = PostReceive(request);
+      if (s.ok()) return;
+    }
+    bool first_failure;
+    {
+      mutex_lock l(mu_);
+      first_failure = !receive_failed_;
+      receive_failed_ = true;
+    }
+    if (first_failure && receive_handler_) receive_handler_(s, 0);
+    return;
+  }
+
+  request->done(s);
+  delete request;
+  WorkRequest* next = nullptr;
+  {
+    mutex_lock l(mu_);
+    if (pending_sends_.empty()) {
+      --num_sends_;
+    } else {
+      next = pending_sends_.front();
+      pending_sends_.pop_front();
+    }
+  }
+  if (next != nullptr) StartSend(next);
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,179 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_H_
+
+#include <infiniband/verbs.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class RdmaQueuePair;
+
+// An RDMA device opened through ibverbs, with one protection domain and one
+// completion queue that a background thread polls for all queue pairs.
+//
+// The device is chosen by the environment variables TF_VERBS_DEVICE (the
+// first device by default), TF_VERBS_PORT (1 by default) and
+// TF_VERBS_GID_INDEX (0 by default; RoCE v2 deployments usually need the
+// index of a RoCE v2 GID).
+//
+// RdmaAdapter is thread safe.
+class RdmaAdapter {
+ public:
+  static Status Create(Env* env, std::unique_ptr<RdmaAdapter>* adapter);
+  ~RdmaAdapter();
+
+  // Registers the memory [ptr, ptr + size) for local writes and remote
+  // reads.  Intended as a SubAllocator::Visitor of the allocators whose
+  // memory is sent or received.
+  void RegisterMemory(void* ptr, size_t size);
+
+  // Deregisters the memory registered by RegisterMemory(ptr, ...).
+  void DeregisterMemory(void* ptr);
+
+  // Returns the registered region that contains [ptr, ptr + size), or
+  // nullptr.
+  ibv_mr* FindMemoryRegion(const void* ptr, size_t size);
+
+  // Registers [ptr, ptr + size) for the duration of one transfer.  The
+  // caller releases "*mr" with ibv_dereg_mr().
+  Status RegisterTemporaryMemory(void* ptr, size_t size, ibv_mr** mr);
+
+  // Creates a queue pair that is ready to be connected.
+  Status CreateQueuePair(std::unique_ptr<RdmaQueuePair>* qp);
+
+  // The largest number of bytes of a single RDMA operation.
+  uint64 max_message_bytes() const { return port_attr_.max_msg_sz; }
+
+  // Stops dispatching completions.  Must be called before queue pairs with
+  // work requests in flight are destroyed.
+  void StopPolling();
+
+ private:
+  friend class RdmaQueuePair;
+
+  RdmaAdapter() {}
+
+  // Polls cq_ and dispatches completions until stop_ is set.
+  void PollCompletions();
+
+  ibv_context* context_ = nullptr;
+  ibv_pd* pd_ = nullptr;
+  ibv_comp_channel* channel_ = nullptr;
+  ibv_cq* cq_ = nullptr;
+  uint8 port_num_ = 1;
+  int gid_index_ = 0;
+  ibv_port_attr port_attr_;
+  ibv_device_attr device_attr_;
+  union ibv_gid gid_;
+
+  mutex mu_;
+  // Regions registered by RegisterMemory(), by start address.
+  std::map<uintptr_t, ibv_mr*> regions_ TF_GUARDED_BY(mu_);
+
+  std::atomic<bool> stop_{false};
+  std::unique_ptr<Thread> poller_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaAdapter);
+};
+
+// A reliable connected queue pair of an RdmaAdapter.
+//
+// Completion callbacks run on the adapter's polling thread, and must not
+// block.
+//
+// RdmaQueuePair is thread safe.
+class RdmaQueuePair {
+ public:
+  ~RdmaQueuePair();
+
+  // The endpoint to which the remote queue pair connects.
+  const RdmaEndpoint& local_endpoint() const { return local_endpoint_; }
+
+  // Connects this queue pair to the queue pair at "remote".
+  Status Connect(const RdmaEndpoint& remote);
+
+  // Calls "handler" with the immediate data of each message received by
+  // SendImmediate() on the remote queue pair.  If the queue pair fails, calls
+  // "handler" once with an error, and then no more.
+  //
+  // REQUIRES: Called before Connect().
+  void SetReceiveHandler(std::function<void(const Status&, uint32)> handler);
+
+  // Reads "num_bytes" at "remote_addr" of the remote memory region with
+  // "rkey" into "local", which lies within the local memory region with
+  // "lkey", and calls "done" once the bytes arrived.
+  void Read(void* local, uint32 lkey, uint64 remote_addr, uint32 rkey,
+            uint64 num_bytes, std::function<void(const Status&)> done);
+
+  // Sends "value" to the receive handler of the remote queue pair, and calls
+  // "done" once the remote queue pair acknowledged it.
+  void SendImmediate(uint32 value, std::function<void(const Status&)> done);
+
+ private:
+  friend class RdmaAdapter;
+
+  // A work request in flight, whose address is its wr_id.
+  struct WorkRequest;
+
+  // The number of receive requests that are kept posted.
+  static constexpr int kNumReceives = 64;
+  // The largest number of send requests in flight.
+  static constexpr int kMaxSends = 128;
+
+  RdmaQueuePair(RdmaAdapter* adapter, ibv_qp* qp,
+                const RdmaEndpoint& local_endpoint);
+
+  // Posts the receive requests.
+  Status Init();
+  Status PostReceive(WorkRequest* request);
+  // Posts "request", or queues it until fewer than kMaxSends are in flight.
+  void PostSend(WorkRequest* request);
+  void StartSend(WorkRequest* request);
+  void OnCompletion(const ibv_wc& wc, WorkRequest* request);
+
+  RdmaAdapter* const adapter_;  // Not owned.
+  ibv_qp* const qp_;
+  const RdmaEndpoint local_endpoint_;
+  std::function<void(const Status&, uint32)> receive_handler_;
+  std::vector<std::unique_ptr<WorkRequest>> receives_;
+
+  mutex mu_;
+  int num_sends_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<WorkRequest*> pending_sends_ TF_GUARDED_BY(mu_);
+  bool receive_failed_ TF_GUARDED_BY(mu_) = false;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaQueuePair);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_H_
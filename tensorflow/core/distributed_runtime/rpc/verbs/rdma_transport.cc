@@ -0,0 +1,372 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/rdma_transport.h"
+
+#include <utility>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Returns whether "request" was prepared by a receiver that uses
+// RdmaTransport, and if so, its options.
+bool GetRequestOptions(const RecvTensorRequest& request,
+                       RdmaRecvTensorRequestOptions* options) {
+  return request.has_transport_options() &&
+         request.transport_options().UnpackTo(options);
+}
+
+}  // namespace
+
+RdmaTransport::RdmaTransport(std::unique_ptr<RdmaAdapter> adapter)
+    : adapter_(std::move(adapter)) {
+  Status s = ReadInt64FromEnvVar("TF_VERBS_MIN_RDMA_BYTES", 64 << 10,
+                                 &min_rdma_bytes_);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    min_rdma_bytes_ = 64 << 10;
+  }
+}
+
+RdmaTransport::~RdmaTransport() {
+  // Completions must not be dispatched to queue pairs that are destroyed.
+  adapter_->StopPolling();
+  for (const auto& sender : all_senders_) {
+    ReleaseBuffers(sender.get(), -1);
+  }
+}
+
+void RdmaTransport::PrepareRequest(const string& src_worker,
+                                   Device* dst_device,
+                                   const AllocatorAttributes& alloc_attrs,
+                                   RecvTensorRequest* request) {
+  // Like TensorResponse, treat memory of CPU devices as host memory.
+  const bool on_host =
+      alloc_attrs.on_host() || dst_device->device_type() == DEVICE_CPU;
+  RdmaRecvTensorRequestOptions options;
+  {
+    mutex_lock l(mu_);
+    std::unique_ptr<Receiver>& receiver = receivers_[src_worker];
+    if (receiver == nullptr) receiver.reset(new Receiver);
+    switch (receiver->state) {
+      case Receiver::kIdle: {
+        if (receiver->qp == nullptr) {
+          Status s = adapter_->CreateQueuePair(&receiver->qp);
+          if (!s.ok()) {
+            LOG(WARNING) << "Cannot create RDMA queue pair for " << src_worker
+                         << ", which falls back to gRPC: " << s;
+            receiver->state = Receiver::kDisabled;
+            return;
+          }
+        }
+        receiver->state = Receiver::kConnecting;
+        *options.mutable_endpoint() = receiver->qp->local_endpoint();
+        break;
+      }
+      case Receiver::kConnected:
+        if (!on_host) return;
+        options.set_connection_id(receiver->connection_id);
+        break;
+      case Receiver::kConnecting:
+      case Receiver::kDisabled:
+        return;
+    }
+  }
+  request->mutable_transport_options()->PackFrom(options);
+}
+
+void RdmaTransport::FinishResponse(const Status& status,
+                                   const string& src_worker,
+                                   const RecvTensorRequest& request,
+                                   TensorResponse* response,
+                                   StatusCallback done) {
+  RdmaRecvTensorRequestOptions request_options;
+  if (!GetRequestOptions(request, &request_options)) {
+    done(status);
+    return;
+  }
+  const bool connecting = request_options.has_endpoint();
+  if (!status.ok()) {
+    if (connecting) {
+      // Connect with the same queue pair on the next request.
+      mutex_lock l(mu_);
+      receivers_[src_worker]->state = Receiver::kIdle;
+    }
+    done(status);
+    return;
+  }
+
+  RdmaRecvTensorResponseOptions options;
+  const RecvTensorResponse& meta = response->metadata();
+  const bool has_options = meta.has_transport_options() &&
+                           meta.transport_options().UnpackTo(&options);
+  if (connecting) {
+    Status s;
+    if (!has_options) {
+      s = errors::Unimplemented("The sender does not use RDMA");
+    } else {
+      mutex_lock l(mu_);
+      s = receivers_[src_worker]->qp->Connect(options.endpoint());
+    }
+    mutex_lock l(mu_);
+    Receiver* receiver = receivers_[src_worker].get();
+    if (s.ok()) {
+      VLOG(1) << "Connected RDMA queue pair to " << src_worker;
+      receiver->state = Receiver::kConnected;
+      receiver->connection_id = options.connection_id();
+    } else {
+      LOG(WARNING) << "Cannot connect RDMA queue pair to " << src_worker
+                   << ", which falls back to gRPC: " << s;
+      receiver->state = Receiver::kDisabled;
+    }
+  } else if (!has_options || options.connection_id() == 0) {
+    // The sender does not know the connection, e.g. because it restarted.
+    mutex_lock l(mu_);
+    Receiver* receiver = receivers_[src_worker].get();
+    if (receiver->state == Receiver::kConnected &&
+        receiver->connection_id == request_options.connection_id()) {
+      receiver->retired[receiver->connection_id] = std::move(receiver->qp);
+      receiver->state = Receiver::kIdle;
+    }
+  }
+  if (!has_options || options.num_bytes() == 0) {
+    done(status);
+    return;
+  }
+
+  // The response left out the tensor contents, for us to read.
+  const Tensor& tensor = response->tensor();
+  RdmaQueuePair* qp =
+      FindReceiverQueuePair(src_worker, request_options.connection_id());
+  if (qp == nullptr || static_cast<int64>(tensor.TotalBytes()) !=
+                           options.num_bytes()) {
+    done(errors::Internal("Unexpected RDMA buffer of ", options.num_bytes(),
+                          " bytes for ", request.rendezvous_key()));
+    return;
+  }
+  // TensorResponse allocated the tensor for this response only, so that we
+  // may fill it in.
+  char* data = const_cast<char*>(tensor.tensor_data().data());
+  ibv_mr* region = adapter_->FindMemoryRegion(data, tensor.TotalBytes());
+  ibv_mr* temporary_region = nullptr;
+  if (region == nullptr) {
+    Status s = adapter_->RegisterTemporaryMemory(data, tensor.TotalBytes(),
+                                                 &temporary_region);
+    if (!s.ok()) {
+      done(s);
+      return;
+    }
+    region = temporary_region;
+  }
+  const uint32 buffer_id = options.buffer_id();
+  qp->Read(data, region->lkey, options.remote_addr(), options.rkey(),
+           options.num_bytes(),
+           [qp, buffer_id, temporary_region,
+            done = std::move(done)](const Status& s) {
+             if (temporary_region != nullptr) ibv_dereg_mr(temporary_region);
+             // Let the sender release the tensor, even if the read failed.
+             qp->SendImmediate(buffer_id, [](const Status& s) {
+               if (!s.ok()) {
+                 LOG(WARNING) << "Cannot acknowledge RDMA read: " << s;
+               }
+             });
+             done(s);
+           });
+}
+
+RdmaQueuePair* RdmaTransport::FindReceiverQueuePair(const string& src_worker,
+                                                    int64 connection_id) {
+  mutex_lock l(mu_);
+  auto it = receivers_.find(src_worker);
+  if (it == receivers_.end()) return nullptr;
+  Receiver* receiver = it->second.get();
+  if (receiver->connection_id == connection_id && receiver->qp != nullptr) {
+    return receiver->qp.get();
+  }
+  auto retired = receiver->retired.find(connection_id);
+  return retired == receiver->retired.end() ? nullptr : retired->second.get();
+}
+
+Status RdmaTransport::EncodeResponse(const RecvTensorRequest& request,
+                                     const Tensor& tensor, bool is_dead,
+                                     bool require_ack,
+                                     ::grpc::ByteBuffer* response,
+                                     bool* handled) {
+  RdmaRecvTensorRequestOptions request_options;
+  *handled = GetRequestOptions(request, &request_options);
+  if (!*handled) return Status::OK();
+
+  RdmaRecvTensorResponseOptions options;
+  Sender* sender = nullptr;
+  if (request_options.has_endpoint()) {
+    Rendezvous::ParsedKey parsed;
+    string dst_worker, dst_device;
+    Status s = Rendezvous::ParseKey(request.rendezvous_key(), &parsed);
+    if (s.ok() && !DeviceNameUtils::SplitDeviceName(parsed.dst_device,
+                                                    &dst_worker, &dst_device)) {
+      s = errors::InvalidArgument("Invalid device ", parsed.dst_device);
+    }
+    if (s.ok()) {
+      s = Accept(dst_worker, request_options.endpoint(), &options);
+    }
+    if (!s.ok()) {
+      // Without transport options, the receiver falls back to gRPC.
+      LOG(WARNING) << "Cannot accept RDMA connection: " << s;
+      *handled = false;
+      return Status::OK();
+    }
+  } else {
+    mutex_lock l(mu_);
+    auto it = senders_.find(request_options.connection_id());
+    if (it != senders_.end()) {
+      sender = it->second;
+      options.set_connection_id(sender->connection_id);
+    }
+  }
+
+  RecvTensorResponse proto;
+  proto.set_is_dead(is_dead);
+  proto.set_send_start_micros(Env::Default()->NowMicros());
+  proto.set_require_ack(require_ack);
+  bool contents_left_out = false;
+  if (sender != nullptr && !is_dead && DataTypeCanUseMemcpy(tensor.dtype()) &&
+      static_cast<int64>(tensor.TotalBytes()) >= min_rdma_bytes_) {
+    Status s = AddBuffer(sender, tensor, &options);
+    if (s.ok()) {
+      contents_left_out = true;
+      proto.mutable_tensor()->set_dtype(tensor.dtype());
+      tensor.shape().AsProto(proto.mutable_tensor()->mutable_tensor_shape());
+    } else {
+      LOG(WARNING) << "Sending tensor over gRPC: " << s;
+    }
+  }
+  if (!contents_left_out) {
+    tensor.AsProtoTensorContent(proto.mutable_tensor());
+  }
+  proto.mutable_transport_options()->PackFrom(options);
+  return FromGrpcStatus(GrpcMaybeUnparseProto(proto, response));
+}
+
+Status RdmaTransport::Accept(const string& dst_worker,
+                             const RdmaEndpoint& endpoint,
+                             RdmaRecvTensorResponseOptions* options) {
+  Sender* replaced = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto it = connection_of_worker_.find(dst_worker);
+    if (it != connection_of_worker_.end()) {
+      Sender* sender = senders_[it->second];
+      if (sender->remote_qp_num == endpoint.qp_num()) {
+        // The receiver retried its connection request.
+        *options->mutable_endpoint() = sender->qp->local_endpoint();
+        options->set_connection_id(sender->connection_id);
+        return Status::OK();
+      }
+      // The receiver lost its earlier connection, e.g. because it restarted,
+      // and will not read its remaining buffers.
+      replaced = sender;
+      senders_.erase(it->second);
+      connection_of_worker_.erase(it);
+    }
+  }
+  if (replaced != nullptr) ReleaseBuffers(replaced, -1);
+
+  std::unique_ptr<Sender> sender(new Sender);
+  TF_RETURN_IF_ERROR(adapter_->CreateQueuePair(&sender->qp));
+  Sender* raw = sender.get();
+  sender->qp->SetReceiveHandler([raw](const Status& s, uint32 buffer_id) {
+    if (!s.ok()) {
+      LOG(WARNING) << "RDMA connection " << raw->connection_id
+                   << " failed: " << s;
+      ReleaseBuffers(raw, -1);
+      return;
+    }
+    ReleaseBuffers(raw, buffer_id);
+  });
+  TF_RETURN_IF_ERROR(sender->qp->Connect(endpoint));
+  sender->remote_qp_num = endpoint.qp_num();
+  *options->mutable_endpoint() = sender->qp->local_endpoint();
+
+  mutex_lock l(mu_);
+  sender->connection_id = next_connection_id_++;
+  options->set_connection_id(sender->connection_id);
+  senders_[sender->connection_id] = raw;
+  connection_of_worker_[dst_worker] = sender->connection_id;
+  all_senders_.push_back(std::move(sender));
+  VLOG(1) << "Accepted RDMA connection " << raw->connection_id << " from "
+          << dst_worker;
+  return Status::OK();
+}
+
+Status RdmaTransport::AddBuffer(Sender* sender, const Tensor& tensor,
+                                RdmaRecvTensorResponseOptions* options) {
+  char* data = const_cast<char*>(tensor.tensor_data().data());
+  const size_t num_bytes = tensor.TotalBytes();
+  ibv_mr* region = adapter_->FindMemoryRegion(data, num_bytes);
+  ibv_mr* temporary_region = nullptr;
+  if (region == nullptr) {
+    TF_RETURN_IF_ERROR(
+        adapter_->RegisterTemporaryMemory(data, num_bytes, &temporary_region));
+    region = temporary_region;
+  }
+  mutex_lock l(sender->mu);
+  const uint32 buffer_id = sender->next_buffer_id++;
+  Sender::Buffer& buffer = sender->buffers[buffer_id];
+  buffer.tensor = tensor;
+  buffer.temporary_region = temporary_region;
+  options->set_remote_addr(reinterpret_cast<uintptr_t>(data));
+  options->set_rkey(region->rkey);
+  options->set_num_bytes(num_bytes);
+  options->set_buffer_id(buffer_id);
+  return Status::OK();
+}
+
+/* static */
+void RdmaTransport::ReleaseBuffers(Sender* sender, int64 buffer_id) {
+  std::vector<Sender::Buffer> released;
+  {
+    mutex_lock l(sender->mu);
+    if (buffer_id < 0) {
+      for (auto& entry : sender->buffers) {
+        released.push_back(std::move(entry.second));
+      }
+      sender->buffers.clear();
+    } else {
+      auto it = sender->buffers.find(buffer_id);
+      if (it == sender->buffers.end()) return;
+      released.push_back(std::move(it->second));
+      sender->buffers.erase(it);
+    }
+  }
+  for (const Sender::Buffer& buffer : released) {
+    if (buffer.temporary_region != nullptr) {
+      ibv_dereg_mr(buffer.temporary_region);
+    }
+  }
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,141 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_TRANSPORT_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_TRANSPORT_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "grpcpp/support/byte_buffer.h"
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/rpc/verbs/rdma.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Moves the contents of large tensors between workers with RDMA reads, while
+// RecvTensor RPCs carry their metadata.
+//
+// On its first request to a sender, the receiver of a tensor asks the sender
+// to connect a queue pair to it, and the sender answers with its end of the
+// queue pair.  Later responses leave out the contents of tensors with at
+// least TF_VERBS_MIN_RDMA_BYTES bytes (64KB by default) of a type that can
+// be memcpy'd, and instead describe the sender's memory that holds them.
+// The receiver reads them straight into the tensor that TensorResponse
+// allocated from the receiving device's allocator, and then acknowledges
+// them, upon which the sender releases the tensor.  Memory that is
+// registered with the RDMA device in advance (see
+// RdmaAdapter::RegisterMemory()) avoids registering it on each transfer.
+//
+// Receives into host memory use RDMA, all others keep using gRPC.  Tensors
+// sent from GPUs are staged in host memory of GPUProcessState as for gRPC.
+// If the sender does not use this transport, the receiver falls back to
+// gRPC for all tensors of the sender.
+class RdmaTransport : public RecvTensorTransport {
+ public:
+  explicit RdmaTransport(std::unique_ptr<RdmaAdapter> adapter);
+  ~RdmaTransport() override;
+
+  RdmaAdapter* adapter() const { return adapter_.get(); }
+
+  // RecvTensorTransport implementation, for the receiving side.
+  void PrepareRequest(const string& src_worker, Device* dst_device,
+                      const AllocatorAttributes& alloc_attrs,
+                      RecvTensorRequest* request) override;
+  void FinishResponse(const Status& status, const string& src_worker,
+                      const RecvTensorRequest& request,
+                      TensorResponse* response, StatusCallback done) override;
+
+  // Encodes the response to "request" for "tensor" into "*response" on the
+  // sending side, if the request was prepared by a receiver that uses this
+  // transport.  Otherwise sets "*handled" to false, and leaves the encoding
+  // to the caller.
+  Status EncodeResponse(const RecvTensorRequest& request, const Tensor& tensor,
+                        bool is_dead, bool require_ack,
+                        ::grpc::ByteBuffer* response, bool* handled);
+
+ private:
+  // The queue pair of this worker over which it reads from a remote worker.
+  // Guarded by mu_.
+  struct Receiver {
+    enum State { kIdle, kConnecting, kConnected, kDisabled };
+    State state = kIdle;
+    std::unique_ptr<RdmaQueuePair> qp;
+    int64 connection_id = 0;
+    // Queue pairs that were replaced by reconnecting, by connection id, which
+    // may still have reads in flight.
+    std::unordered_map<int64, std::unique_ptr<RdmaQueuePair>> retired;
+  };
+
+  // A queue pair over which a remote worker reads tensors of this worker.
+  struct Sender {
+    std::unique_ptr<RdmaQueuePair> qp;
+    int64 connection_id = 0;
+    // The remote queue pair, to recognize retried connection requests.
+    uint32 remote_qp_num = 0;
+    mutex mu;
+    uint32 next_buffer_id TF_GUARDED_BY(mu) = 0;
+    // The tensors that the remote worker has yet to read, by buffer id.
+    struct Buffer {
+      Tensor tensor;
+      ibv_mr* temporary_region = nullptr;
+    };
+    std::unordered_map<uint32, Buffer> buffers TF_GUARDED_BY(mu);
+  };
+
+  // Returns the queue pair of the receiver for "src_worker" with
+  // "connection_id", or nullptr.
+  RdmaQueuePair* FindReceiverQueuePair(const string& src_worker,
+                                       int64 connection_id);
+
+  // Connects a new queue pair to the receiver at "endpoint" on worker
+  // "dst_worker", and describes it in "*options".
+  Status Accept(const string& dst_worker, const RdmaEndpoint& endpoint,
+                RdmaRecvTensorResponseOptions* options);
+
+  // Keeps "tensor" alive until the receiver of "sender" read it, and
+  // describes its memory in "*options".
+  Status AddBuffer(Sender* sender, const Tensor& tensor,
+                   RdmaRecvTensorResponseOptions* options);
+
+  // Releases the buffer "buffer_id" of "sender", or all of its buffers if
+  // "buffer_id" is negative.
+  static void ReleaseBuffers(Sender* sender, int64 buffer_id);
+
+  const std::unique_ptr<RdmaAdapter> adapter_;
+  int64 min_rdma_bytes_;
+
+  mutex mu_;
+  // Receivers by the name of the remote worker.
+  std::unordered_map<string, std::unique_ptr<Receiver>> receivers_
+      TF_GUARDED_BY(mu_);
+  // Senders by connection id.  A new connection of a receiving worker
+  // replaces its earlier one, but all senders stay alive in all_senders_.
+  std::unordered_map<int64, Sender*> senders_ TF_GUARDED_BY(mu_);
+  std::unordered_map<string, int64> connection_of_worker_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Sender>> all_senders_ TF_GUARDED_BY(mu_);
+  int64 next_connection_id_ TF_GUARDED_BY(mu_) = 1;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(RdmaTransport);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_VERBS_RDMA_TRANSPORT_H_
@@ -0,0 +1,149 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/verbs/verbs_server_lib.h"
+
+#include <utility>
+
+#include "tensorflow/core/common_runtime/process_state.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_worker_service.h"
+#include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
+#include "tensorflow/core/distributed_runtime/server_lib.h"
+#include "tensorflow/core/platform/logging.h"
+#if GOOGLE_CUDA
+#include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#endif  // GOOGLE_CUDA
+
+namespace tensorflow {
+
+namespace {
+
+// A GrpcWorker that answers RecvTensor requests of RdmaTransport receivers.
+class VerbsWorker : public GrpcWorker {
+ public:
+  VerbsWorker(WorkerEnv* env, const ConfigProto& config,
+              RdmaTransport* transport)
+      : GrpcWorker(env, config), transport_(transport) {}
+
+ protected:
+  Status EncodeRecvTensorResponse(const RecvTensorRequest& request,
+                                  const Tensor& tensor, bool is_dead,
+                                  bool require_ack,
+                                  ::grpc::ByteBuffer* response) override {
+    bool handled;
+    TF_RETURN_IF_ERROR(transport_->EncodeResponse(
+        request, tensor, is_dead, require_ack, response, &handled));
+    if (handled) return Status::OK();
+    return GrpcWorker::EncodeRecvTensorResponse(request, tensor, is_dead,
+                                                require_ack, response);
+  }
+
+ private:
+  RdmaTransport* const transport_;  // Not owned.
+};
+
+// Registers the memory of the host allocators with the RDMA device of
+// "adapter", so that tensors in it need no registration per transfer.
+//
+// The visitors must be added before the first host allocator is created, so
+// the first server of the process must be created before any session or
+// eager context.  Later servers register memory per transfer.
+void MaybeAddMemoryVisitors(RdmaAdapter* adapter) {
+  static mutex mu(LINKER_INITIALIZED);
+  static bool added = false;
+  mutex_lock l(mu);
+  if (added) return;
+  added = true;
+  SubAllocator::Visitor alloc_visitor = [adapter](void* ptr, int index,
+                                                  size_t num_bytes) {
+    adapter->RegisterMemory(ptr, num_bytes);
+  };
+  SubAllocator::Visitor free_visitor = [adapter](void* ptr, int index,
+                                                 size_t num_bytes) {
+    adapter->DeregisterMemory(ptr);
+  };
+  ProcessState::singleton()->AddCPUAllocVisitor(alloc_visitor);
+  ProcessState::singleton()->AddCPUFreeVisitor(free_visitor);
+#if GOOGLE_CUDA
+  // Tensors sent from or received for GPUs are staged in this memory.
+  GPUProcessState::singleton()->AddGpuHostAllocVisitor(0, alloc_visitor);
+  GPUProcessState::singleton()->AddGpuHostFreeVisitor(0, free_visitor);
+#endif  // GOOGLE_CUDA
+}
+
+}  // namespace
+
+VerbsServer::VerbsServer(const ServerDef& server_def, Env* env)
+    : GrpcServer(server_def, env) {}
+
+VerbsServer::~VerbsServer() {}
+
+Status VerbsServer::Init() {
+  std::unique_ptr<RdmaAdapter> adapter;
+  TF_RETURN_IF_ERROR(RdmaAdapter::Create(Env::Default(), &adapter));
+  transport_.reset(new RdmaTransport(std::move(adapter)));
+  MaybeAddMemoryVisitors(transport_->adapter());
+
+  RdmaTransport* transport = transport_.get();
+  GrpcServerOptions opts;
+  opts.rendezvous_mgr_func = [transport](const WorkerEnv* env) {
+    return new RpcRendezvousMgr(env, transport);
+  };
+  opts.worker_func = [transport](WorkerEnv* env, const ConfigProto& config) {
+    return std::unique_ptr<GrpcWorker>(
+        new VerbsWorker(env, config, transport));
+  };
+  return GrpcServer::Init(opts);
+}
+
+/* static */
+Status VerbsServer::Create(const ServerDef& server_def, Env* env,
+                           std::unique_ptr<ServerInterface>* out_server) {
+  std::unique_ptr<VerbsServer> ret(
+      new VerbsServer(server_def, env == nullptr ? Env::Default() : env));
+  Status s = ret->Init();
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+    return s;
+  }
+  *out_server = std::move(ret);
+  return Status::OK();
+}
+
+namespace {
+
+class VerbsServerFactory : public ServerFactory {
+ public:
+  bool AcceptsOptions(const ServerDef& server_def) override {
+    return server_def.protocol() == "grpc+verbs";
+  }
+
+  Status NewServer(const ServerDef& server_def,
+                   std::unique_ptr<ServerInterface>* out_server) override {
+    return VerbsServer::Create(server_def, Env::Default(), out_server);
+  }
+};
+
+// Registers a `ServerFactory` for `VerbsServer` instances.
+class VerbsServerRegistrar {
+ public:
+  VerbsServerRegistrar() {
+    ServerFactory::Register("VERBS_SERVER", new VerbsServerFactory());
+  }
+};
+static VerbsServerRegistrar registrar;
+
+}  // namespace
+}  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 
@@ -53,7 +54,9 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
 Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   Status s;
   meta_.Swap(response);
-  if (on_host_) {
+  if (meta_.content_codec() != TENSOR_CONTENT_RAW) {
+    s = DecompressContent();
+  } else if (on_host_) {
     if (!tensor_.FromProto(allocator_, meta_.tensor())) {
       s = errors::InvalidArgument("Cannot parse tensor from response");
     }
@@ -144,8 +147,36 @@ bool ReadNestedMessage(protobuf::io::CodedInputStream* input,
 
 }  // namespace
 
+// Tensor contents of at least this many bytes are shared with the source
+// when possible.  Matches the size above which the sender shares them with
+// the tensor (see EncodeTensorToByteBuffer in grpc_tensor_coding.cc).
+constexpr int kMinSharedContentBytes = 1024;
+
+TensorBuffer* TensorResponse::MaybeShareContent(
+    Source* source, protobuf::io::CodedInputStream* input, int num_bytes) {
+  // Tensors that are later copied to a GPU must use memory from allocator_,
+  // which may be pinned.
+  if (num_bytes < kMinSharedContentBytes || alloc_attrs_.gpu_compatible()) {
+    return nullptr;
+  }
+  const void* data;
+  int size;
+  if (!input->GetDirectBufferPointer(&data, &size) || size < num_bytes ||
+      reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    return nullptr;
+  }
+  TensorBuffer* buf =
+      source->ShareBytes(static_cast<const char*>(data), num_bytes);
+  if (buf != nullptr && !input->Skip(num_bytes)) {
+    buf->Unref();
+    return nullptr;
+  }
+  return buf;
+}
+
 bool TensorResponse::ParseTensorSubmessage(
-    protobuf::io::CodedInputStream* input, TensorProto* tensor_meta) {
+    Source* source, protobuf::io::CodedInputStream* input,
+    TensorProto* tensor_meta) {
   bool seen_tensor_content = false;
   while (true) {
     auto p = input->ReadTagWithCutoff(127);
@@ -196,12 +227,23 @@ bool TensorResponse::ParseTensorSubmessage(
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
         TensorShape shape(tensor_meta->tensor_shape());
-        Tensor t(allocator_, tensor_meta->dtype(), shape);
+        const DataType dtype = tensor_meta->dtype();
+        if (!DataTypeCanUseMemcpy(dtype) ||
+            static_cast<size_t>(num_bytes) !=
+                shape.num_elements() * DataTypeSize(dtype)) {
+          return false;
+        }
+        // Adopt the received bytes if they are suitably aligned and the
+        // source can keep them alive, and otherwise read them directly into
+        // a tensor from the receiving device's allocator.
+        TensorBuffer* shared = MaybeShareContent(source, input, num_bytes);
+        if (shared != nullptr) {
+          tensor_ = Tensor(dtype, shape, shared);
+          shared->Unref();
+          break;
+        }
+        Tensor t(allocator_, dtype, shape);
         StringPiece buf = t.tensor_data();
-        if (static_cast<size_t>(num_bytes) != buf.size()) return false;
-        // TODO(jeff,sanjay): Figure out a way to avoid this copy if
-        // the underlying ZeroCopyInputStream data is properly aligned
-        // and compatible with what allocator_ wants.
         if (!input->ReadRaw(const_cast<char*>(buf.data()), num_bytes))
           return false;
         tensor_ = std::move(t);
@@ -235,7 +277,7 @@ bool TensorResponse::ParseFast(Source* source) {
         std::pair<protobuf::io::CodedInputStream::Limit, int> p =
             input.IncrementRecursionDepthAndPushLimit(length);
         if (p.second < 0 ||
-            !ParseTensorSubmessage(&input, meta_.mutable_tensor())) {
+            !ParseTensorSubmessage(source, &input, meta_.mutable_tensor())) {
           return false;
         }
         if (!input.DecrementRecursionDepthAndPopLimit(p.first)) {
@@ -277,16 +319,27 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+// Compressed contents never parse on the fast path, since the sender only
+// compresses contents that shrink, and ParseTensorSubmessage() rejects
+// tensor_content of the wrong size.
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
   }
 
-  Tensor parsed(meta_.tensor().dtype());
-  if (!parsed.FromProto(allocator_, meta_.tensor())) {
-    return false;
+  if (meta_.content_codec() != TENSOR_CONTENT_RAW) {
+    Status s = DecompressContent();
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return false;
+    }
+  } else {
+    Tensor parsed(meta_.tensor().dtype());
+    if (!parsed.FromProto(allocator_, meta_.tensor())) {
+      return false;
+    }
+    tensor_ = std::move(parsed);
   }
-  tensor_ = std::move(parsed);
 
   // Reduce memory usage for big tensors.
   {
@@ -298,4 +351,17 @@ bool TensorResponse::ParseSlow(Source* source) {
   return true;
 }
 
+Status TensorResponse::DecompressContent() {
+  // Receivers only accept compressed contents for host memory.
+  const TensorProto& proto = meta_.tensor();
+  if (!on_host_ || !DataTypeCanUseMemcpy(proto.dtype()) ||
+      !TensorShape::IsValid(proto.tensor_shape())) {
+    return errors::InvalidArgument("Unexpected compressed tensor contents");
+  }
+  Tensor t(allocator_, proto.dtype(), TensorShape(proto.tensor_shape()));
+  TF_RETURN_IF_ERROR(DecompressTensorContent(meta_.content_codec(), proto, &t));
+  tensor_ = std::move(t);
+  return Status::OK();
+}
+
 }  // namespace tensorflow
@@ -27,6 +27,7 @@ namespace tensorflow {
 
 class Allocator;
 class DeviceBase;
+class TensorBuffer;
 class TensorProto;
 
 // TensorResponse can be used as the destination of an RPC that returns
@@ -64,6 +65,17 @@ class TensorResponse {
     // Ownership of the returned stream is retained by the Source and
     // should not be deleted by the caller.
     virtual ::tensorflow::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+    // Returns a buffer that shares the "num_bytes" bytes at "data", which
+    // lie within the data of the stream last returned by contents(), and
+    // keeps them alive for as long as the buffer is referenced.  The caller
+    // owns a reference on the result.
+    //
+    // Returns nullptr if the bytes cannot be shared, in which case ParseFrom
+    // copies them into a tensor allocated by the receiving device.
+    virtual TensorBuffer* ShareBytes(const char* data, size_t num_bytes) {
+      return nullptr;
+    }
   };
 
   // Parse the RecvTensorResponse encoded in the data yielded by
@@ -92,10 +104,16 @@ class TensorResponse {
   DeviceBase* device() const { return device_; }
 
  private:
-  bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
+  bool ParseTensorSubmessage(Source* source,
+                             protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
+  TensorBuffer* MaybeShareContent(Source* source,
+                                  protobuf::io::CodedInputStream* input,
+                                  int num_bytes);
   bool ParseFast(Source* source);
   bool ParseSlow(Source* source);
+  // Decodes the compressed contents of meta_.tensor() into tensor_.
+  Status DecompressContent();
 
   bool on_host_ = false;
   DeviceBase* device_ = nullptr;
@@ -15,10 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -72,6 +75,45 @@ class StringSource : public TensorResponse::Source {
   int block_size_;
 };
 
+// A source over "size" bytes at "data" that shares the requested bytes
+// without copying them.
+class SharingSource : public TensorResponse::Source {
+ public:
+  SharingSource(const char* data, int size) : data_(data), size_(size) {}
+
+  protobuf::io::ZeroCopyInputStream* contents() override {
+    stream_.reset(new protobuf::io::ArrayInputStream(data_, size_));
+    return stream_.get();
+  }
+
+  TensorBuffer* ShareBytes(const char* data, size_t num_bytes) override {
+    ++num_shared_;
+    return new SharedBuffer(data, num_bytes);
+  }
+
+  int num_shared() const { return num_shared_; }
+
+ private:
+  class SharedBuffer : public TensorBuffer {
+   public:
+    SharedBuffer(const char* data, size_t size)
+        : TensorBuffer(const_cast<char*>(data)), size_(size) {}
+    size_t size() const override { return size_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {}
+    bool OwnsMemory() const override { return false; }
+
+   private:
+    const size_t size_;
+  };
+
+  const char* const data_;
+  const int size_;
+  std::unique_ptr<protobuf::io::ArrayInputStream> stream_;
+  int num_shared_ = 0;
+};
+
 class TensorResponseTest : public ::testing::Test {
  public:
   void Validate(const Tensor& src, bool is_dead, bool use_tensor_content) {
@@ -156,6 +198,62 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, SharesAlignedContent) {
+  Tensor src(DT_FLOAT, TensorShape({16, 64}));
+  test::FillFn<float>(&src, [](int i) -> float { return i; });
+  RecvTensorResponse proto;
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  const size_t content_offset = encoded.find(string(src.tensor_data()));
+  ASSERT_NE(content_offset, string::npos);
+
+  DummyDevice cpu_device(Env::Default());
+  string storage(encoded.size() + EIGEN_MAX_ALIGN_BYTES, '\0');
+  for (int misalignment : {0, 1}) {
+    // Place the encoded response so that its tensor content starts
+    // "misalignment" bytes past an aligned address.
+    const uintptr_t content =
+        reinterpret_cast<uintptr_t>(storage.data()) + content_offset;
+    char* data = &storage[(EIGEN_MAX_ALIGN_BYTES -
+                           content % EIGEN_MAX_ALIGN_BYTES + misalignment) %
+                          EIGEN_MAX_ALIGN_BYTES];
+    memcpy(data, encoded.data(), encoded.size());
+
+    SharingSource source(data, encoded.size());
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    TF_ASSERT_OK(response.ParseFrom(&source));
+    test::ExpectTensorEqual<float>(src, response.tensor());
+    const bool shared = response.tensor().tensor_data().data() ==
+                        data + content_offset;
+    EXPECT_EQ(misalignment == 0, shared);
+    EXPECT_EQ(misalignment == 0 ? 1 : 0, source.num_shared());
+  }
+}
+
+TEST_F(TensorResponseTest, DecompressesContent) {
+  Tensor src(DT_FLOAT, TensorShape({64, 64}));
+  test::FillFn<float>(&src, [](int i) -> float { return i % 100; });
+  RecvTensorResponse proto;
+  proto.set_content_codec(
+      CompressTensorContent(src, "test", proto.mutable_tensor()));
+  ASSERT_NE(TENSOR_CONTENT_RAW, proto.content_codec());
+  string encoded;
+  proto.AppendToString(&encoded);
+
+  DummyDevice cpu_device(Env::Default());
+  StringSource source(&encoded, 1024);
+  TensorResponse response;
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  test::ExpectTensorEqual<float>(src, response.tensor());
+
+  response.InitAlloc(&cpu_device, AllocatorAttributes());
+  TF_ASSERT_OK(response.InitFrom(&proto));
+  test::ExpectTensorEqual<float>(src, response.tensor());
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -0,0 +1,260 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+
+#include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/snappy.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Smaller contents are not worth the latency of compressing them.
+constexpr size_t kMinCompressedBytes = 4096;
+
+// Regroups the bytes of the "size / element_size" elements at "input" into
+// planes at "output".
+void SplitBytePlanes(const char* input, size_t size, int element_size,
+                     char* output) {
+  const size_t num_elements = size / element_size;
+  for (int plane = 0; plane < element_size; ++plane) {
+    char* out = output + plane * num_elements;
+    const char* in = input + plane;
+    for (size_t i = 0; i < num_elements; ++i) {
+      out[i] = in[i * element_size];
+    }
+  }
+}
+
+// The inverse of SplitBytePlanes().
+void MergeBytePlanes(const char* input, size_t size, int element_size,
+                     char* output) {
+  const size_t num_elements = size / element_size;
+  for (int plane = 0; plane < element_size; ++plane) {
+    const char* in = input + plane * num_elements;
+    char* out = output + plane;
+    for (size_t i = 0; i < num_elements; ++i) {
+      out[i * element_size] = in[i];
+    }
+  }
+}
+
+TensorContentCodec CodecForType(DataType dtype) {
+  switch (dtype) {
+    case DT_HALF:
+    case DT_BFLOAT16:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+      return TENSOR_CONTENT_BYTE_PLANES_SNAPPY;
+    default:
+      return TENSOR_CONTENT_SNAPPY;
+  }
+}
+
+}  // namespace
+
+bool RecvTensorCompressionEnabled() {
+  static const bool enabled = []() {
+    bool value;
+    Status s = ReadBoolFromEnvVar("TF_RECV_TENSOR_COMPRESSION", false, &value);
+    if (!s.ok()) {
+      LOG(ERROR) << s;
+      return false;
+    }
+    return value;
+  }();
+  return enabled;
+}
+
+const char* TensorContentCodecName(TensorContentCodec codec) {
+  switch (codec) {
+    case TENSOR_CONTENT_RAW:
+      return "raw";
+    case TENSOR_CONTENT_SNAPPY:
+      return "snappy";
+    case TENSOR_CONTENT_BYTE_PLANES_SNAPPY:
+      return "byte_planes_snappy";
+    default:
+      return "unknown";
+  }
+}
+
+TensorContentCodec CompressTensorContent(const Tensor& tensor,
+                                         const string& edge,
+                                         TensorProto* proto) {
+  const DataType dtype = tensor.dtype();
+  if (!DataTypeCanUseMemcpy(dtype)) return TENSOR_CONTENT_RAW;
+  const StringPiece data = tensor.tensor_data();
+  if (data.size() < kMinCompressedBytes) return TENSOR_CONTENT_RAW;
+
+  const uint64 start_micros = Env::Default()->NowMicros();
+  const TensorContentCodec codec = CodecForType(dtype);
+  const char* input = data.data();
+  string planes;
+  if (codec == TENSOR_CONTENT_BYTE_PLANES_SNAPPY) {
+    planes.resize(data.size());
+    SplitBytePlanes(data.data(), data.size(), DataTypeSize(dtype),
+                    &planes[0]);
+    input = planes.data();
+  }
+  string compressed;
+  // Sending the contents uncompressed is cheaper unless they shrink by at
+  // least an eighth.
+  const bool worthwhile =
+      port::Snappy_Compress(input, data.size(), &compressed) &&
+      compressed.size() < data.size() - data.size() / 8;
+  metrics::RecordRecvTensorCompression(
+      edge, TensorContentCodecName(codec), data.size(),
+      worthwhile ? compressed.size() : data.size(),
+      Env::Default()->NowMicros() - start_micros);
+  if (!worthwhile) return TENSOR_CONTENT_RAW;
+
+  proto->Clear();
+  proto->set_dtype(dtype);
+  tensor.shape().AsProto(proto->mutable_tensor_shape());
+  proto->set_tensor_content(std::move(compressed));
+  return codec;
+}
+
+CompressedTensorCache::CompressedTensorCache(int64 capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+TensorContentCodec CompressedTensorCache::Compress(const Tensor& tensor,
+                                                   const string& edge,
+                                                   TensorProto* proto) {
+  const DataType dtype = tensor.dtype();
+  if (!DataTypeCanUseMemcpy(dtype) ||
+      tensor.tensor_data().size() < kMinCompressedBytes) {
+    return TENSOR_CONTENT_RAW;
+  }
+  TensorShapeProto shape;
+  tensor.shape().AsProto(&shape);
+  const Fprint128 header = Fingerprint128(
+      strings::StrCat(DataTypeString(dtype), shape.SerializeAsString()));
+  const Fprint128 contents = Fingerprint128(tensor.tensor_data());
+  const Fprint128 key = {FingerprintCat64(header.low64, contents.low64),
+                         FingerprintCat64(header.high64, contents.high64)};
+
+  std::shared_ptr<Entry> entry;
+  bool hit = false;
+  {
+    mutex_lock l(mu_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      hit = true;
+      entry = it->second;
+      while (!entry->ready) {
+        ready_cv_.wait(l);
+      }
+      ++num_hits_;
+      // The entry may have been evicted while this thread waited for it.
+      it = entries_.find(key);
+      if (it != entries_.end() && it->second == entry) {
+        lru_.splice(lru_.begin(), lru_, entry->lru_position);
+      }
+    } else {
+      entry = std::make_shared<Entry>();
+      entries_.emplace(key, entry);
+    }
+  }
+  // A ready entry is immutable, so it is read without the lock.
+  if (hit) {
+    if (entry->codec != TENSOR_CONTENT_RAW) *proto = entry->proto;
+    return entry->codec;
+  }
+
+  const TensorContentCodec codec =
+      CompressTensorContent(tensor, edge, &entry->proto);
+  if (codec != TENSOR_CONTENT_RAW) *proto = entry->proto;
+  {
+    mutex_lock l(mu_);
+    entry->codec = codec;
+    entry->bytes = sizeof(Entry) + entry->proto.SpaceUsedLong();
+    entry->ready = true;
+    lru_.push_front(key);
+    entry->lru_position = lru_.begin();
+    cached_bytes_ += entry->bytes;
+    EvictLocked();
+  }
+  ready_cv_.notify_all();
+  return codec;
+}
+
+int64 CompressedTensorCache::num_hits() const {
+  mutex_lock l(mu_);
+  return num_hits_;
+}
+
+int64 CompressedTensorCache::cached_bytes() const {
+  mutex_lock l(mu_);
+  return cached_bytes_;
+}
+
+void CompressedTensorCache::EvictLocked() {
+  while (cached_bytes_ > capacity_bytes_ && !lru_.empty()) {
+    auto it = entries_.find(lru_.back());
+    cached_bytes_ -= it->second->bytes;
+    entries_.erase(it);
+    lru_.pop_back();
+  }
+}
+
+Status DecompressTensorContent(TensorContentCodec codec,
+                               const TensorProto& proto, Tensor* tensor) {
+  if (codec != TENSOR_CONTENT_SNAPPY &&
+      codec != TENSOR_CONTENT_BYTE_PLANES_SNAPPY) {
+    return errors::Unimplemented("Unsupported tensor content codec ",
+                                 static_cast<int>(codec));
+  }
+  const uint64 start_micros = Env::Default()->NowMicros();
+  const string& content = proto.tensor_content();
+  StringPiece data = tensor->tensor_data();
+  size_t size;
+  if (!port::Snappy_GetUncompressedLength(content.data(), content.size(),
+                                          &size) ||
+      size != data.size()) {
+    return errors::DataLoss("Compressed tensor contents do not match ",
+                            tensor->DebugString());
+  }
+  char* output = const_cast<char*>(data.data());
+  if (codec == TENSOR_CONTENT_SNAPPY) {
+    if (!port::Snappy_Uncompress(content.data(), content.size(), output)) {
+      return errors::DataLoss("Corrupt compressed tensor contents");
+    }
+  } else {
+    string planes;
+    planes.resize(size);
+    if (!port::Snappy_Uncompress(content.data(), content.size(),
+                                 &planes[0])) {
+      return errors::DataLoss("Corrupt compressed tensor contents");
+    }
+    MergeBytePlanes(planes.data(), size, DataTypeSize(tensor->dtype()),
+                    output);
+  }
+  metrics::RecordRecvTensorDecompression(
+      TensorContentCodecName(codec), size,
+      Env::Default()->NowMicros() - start_micros);
+  return Status::OK();
+}
+
+}  // namespace tensorflow
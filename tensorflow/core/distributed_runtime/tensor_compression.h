@@ -0,0 +1,115 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
+#define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
+
+#include <list>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/worker.pb.h"
+
+namespace tensorflow {
+
+// Returns whether RecvTensor responses may carry compressed tensor contents,
+// as set by the environment variable TF_RECV_TENSOR_COMPRESSION.  Receivers
+// with it set ask for compression, and senders with it set compress for
+// receivers that ask, so that it takes effect between pairs of workers that
+// both enable it.
+bool RecvTensorCompressionEnabled();
+
+// Returns the name of "codec" for metrics and logging.
+const char* TensorContentCodecName(TensorContentCodec codec);
+
+// Compresses the contents of "tensor" into "*proto" and returns the codec,
+// chosen by the dtype.  Returns TENSOR_CONTENT_RAW and leaves "*proto"
+// untouched if the tensor is too small or does not compress well.
+//
+// "edge" labels the compression metrics (see
+// metrics::RecordRecvTensorCompression).
+TensorContentCodec CompressTensorContent(const Tensor& tensor,
+                                         const string& edge,
+                                         TensorProto* proto);
+
+// Runs CompressTensorContent() once per distinct tensor contents, so that a
+// tensor sent to many receivers, e.g. a variable that a parameter server
+// broadcasts to every worker, is compressed once rather than once per
+// receiver.  Requests for contents that are being compressed wait for that
+// compression instead of repeating it.
+//
+// Entries are keyed by a fingerprint of the dtype, shape and contents, so a
+// tensor that is updated in place is compressed again.  The least recently
+// used entries are evicted to keep their compressed bytes within the
+// capacity.
+//
+// This class is thread-safe.
+class CompressedTensorCache {
+ public:
+  explicit CompressedTensorCache(int64 capacity_bytes);
+
+  // Same as CompressTensorContent(tensor, edge, proto).  The compression
+  // metrics are only recorded when the contents are compressed.
+  TensorContentCodec Compress(const Tensor& tensor, const string& edge,
+                              TensorProto* proto);
+
+  // Returns the number of Compress() calls that reused a compression.
+  int64 num_hits() const;
+
+  // Returns the bytes held by the cached entries.
+  int64 cached_bytes() const;
+
+ private:
+  struct Entry {
+    bool ready = false;
+    TensorContentCodec codec = TENSOR_CONTENT_RAW;
+    TensorProto proto;
+    int64 bytes = 0;
+    // The position of the key in `lru_`, once the entry is ready.
+    std::list<Fprint128>::iterator lru_position;
+  };
+
+  // Evicts the least recently used entries until the cached bytes are within
+  // the capacity.
+  void EvictLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 capacity_bytes_;
+  mutable mutex mu_;
+  condition_variable ready_cv_;
+  absl::flat_hash_map<Fprint128, std::shared_ptr<Entry>, Fprint128Hasher>
+      entries_ TF_GUARDED_BY(mu_);
+  // The keys of the ready entries, most recently used first.
+  std::list<Fprint128> lru_ TF_GUARDED_BY(mu_);
+  int64 cached_bytes_ TF_GUARDED_BY(mu_) = 0;
+  int64 num_hits_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(CompressedTensorCache);
+};
+
+// Decodes the tensor_content of "proto", compressed with "codec", into
+// "*tensor", which must already have the dtype and shape of "proto".
+Status DecompressTensorContent(TensorContentCodec codec,
+                               const TensorProto& proto, Tensor* tensor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_TENSOR_COMPRESSION_H_
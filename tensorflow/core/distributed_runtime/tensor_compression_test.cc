@@ -0,0 +1,147 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/tensor_compression.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Compresses "tensor", expects "expected_codec", and checks that the contents
+// decompress to "tensor".
+void RoundTrip(const Tensor& tensor, TensorContentCodec expected_codec) {
+  TensorProto proto;
+  const TensorContentCodec codec =
+      CompressTensorContent(tensor, "test", &proto);
+  ASSERT_EQ(expected_codec, codec);
+  EXPECT_EQ(tensor.dtype(), proto.dtype());
+  EXPECT_EQ(tensor.shape(), TensorShape(proto.tensor_shape()));
+  EXPECT_LT(proto.tensor_content().size(), tensor.TotalBytes());
+
+  Tensor decoded(tensor.dtype(), tensor.shape());
+  TF_ASSERT_OK(DecompressTensorContent(codec, proto, &decoded));
+  EXPECT_EQ(tensor.tensor_data(), decoded.tensor_data());
+}
+
+TEST(TensorCompressionTest, FloatsUseBytePlanes) {
+  Tensor t(DT_FLOAT, TensorShape({64, 64}));
+  auto flat = t.flat<float>();
+  for (int i = 0; i < flat.size(); ++i) {
+    flat(i) = 1.0f + (i % 77) * 0.015625f;
+  }
+  RoundTrip(t, TENSOR_CONTENT_BYTE_PLANES_SNAPPY);
+}
+
+TEST(TensorCompressionTest, IntegersUseSnappy) {
+  Tensor t(DT_INT32, TensorShape({4096}));
+  auto flat = t.flat<int32>();
+  for (int i = 0; i < flat.size(); ++i) {
+    flat(i) = i % 16;
+  }
+  RoundTrip(t, TENSOR_CONTENT_SNAPPY);
+}
+
+TEST(TensorCompressionTest, SmallTensorsStayRaw) {
+  Tensor t(DT_FLOAT, TensorShape({16}));
+  t.flat<float>().setZero();
+  TensorProto proto;
+  EXPECT_EQ(TENSOR_CONTENT_RAW, CompressTensorContent(t, "test", &proto));
+  EXPECT_EQ(0, proto.ByteSizeLong());
+}
+
+TEST(TensorCompressionTest, IncompressibleTensorsStayRaw) {
+  Tensor t(DT_UINT8, TensorShape({8192}));
+  auto flat = t.flat<uint8>();
+  uint32 state = 12345;
+  for (int i = 0; i < flat.size(); ++i) {
+    state = state * 1103515245 + 12345;
+    flat(i) = static_cast<uint8>(state >> 24);
+  }
+  TensorProto proto;
+  EXPECT_EQ(TENSOR_CONTENT_RAW, CompressTensorContent(t, "test", &proto));
+}
+
+TEST(TensorCompressionTest, RejectsMismatchedContents) {
+  Tensor t(DT_INT32, TensorShape({4096}));
+  t.flat<int32>().setZero();
+  TensorProto proto;
+  ASSERT_EQ(TENSOR_CONTENT_SNAPPY, CompressTensorContent(t, "test", &proto));
+
+  Tensor too_small(DT_INT32, TensorShape({1024}));
+  EXPECT_TRUE(errors::IsDataLoss(
+      DecompressTensorContent(TENSOR_CONTENT_SNAPPY, proto, &too_small)));
+  EXPECT_TRUE(errors::IsUnimplemented(
+      DecompressTensorContent(TENSOR_CONTENT_RAW, proto, &t)));
+}
+
+TEST(TensorCompressionTest, CacheCompressesEachContentsOnce) {
+  CompressedTensorCache cache(1 << 20);
+  Tensor t(DT_INT32, TensorShape({4096}));
+  t.flat<int32>().setZero();
+  TensorProto expected;
+  ASSERT_EQ(TENSOR_CONTENT_SNAPPY, CompressTensorContent(t, "test", &expected));
+  for (int i = 0; i < 3; ++i) {
+    TensorProto proto;
+    EXPECT_EQ(TENSOR_CONTENT_SNAPPY, cache.Compress(t, "test", &proto));
+    EXPECT_EQ(expected.SerializeAsString(), proto.SerializeAsString());
+  }
+  EXPECT_EQ(2, cache.num_hits());
+
+  // Updated contents and another shape are compressed again.
+  t.flat<int32>()(0) = 1;
+  TensorProto proto;
+  EXPECT_EQ(TENSOR_CONTENT_SNAPPY, cache.Compress(t, "test", &proto));
+  Tensor reshaped(DT_INT32, TensorShape({64, 64}));
+  CHECK(reshaped.CopyFrom(t, reshaped.shape()));
+  EXPECT_EQ(TENSOR_CONTENT_SNAPPY, cache.Compress(reshaped, "test", &proto));
+  EXPECT_EQ(TensorShape({64, 64}), TensorShape(proto.tensor_shape()));
+  EXPECT_EQ(2, cache.num_hits());
+}
+
+TEST(TensorCompressionTest, CacheEvictsLeastRecentlyUsed) {
+  std::vector<Tensor> tensors;
+  for (int i = 0; i < 3; ++i) {
+    Tensor t(DT_INT32, TensorShape({4096}));
+    t.flat<int32>().setConstant(i);
+    tensors.push_back(t);
+  }
+  TensorProto proto;
+  CompressedTensorCache sizing_cache(1 << 20);
+  sizing_cache.Compress(tensors[0], "test", &proto);
+  const int64 entry_bytes = sizing_cache.cached_bytes();
+
+  // Room for two entries, but not three.
+  CompressedTensorCache cache(entry_bytes * 5 / 2);
+  cache.Compress(tensors[0], "test", &proto);
+  cache.Compress(tensors[1], "test", &proto);
+  cache.Compress(tensors[0], "test", &proto);
+  EXPECT_EQ(1, cache.num_hits());
+  cache.Compress(tensors[2], "test", &proto);
+  // tensors[1] was evicted, tensors[0] was not.
+  cache.Compress(tensors[0], "test", &proto);
+  EXPECT_EQ(2, cache.num_hits());
+  cache.Compress(tensors[1], "test", &proto);
+  EXPECT_EQ(2, cache.num_hits());
+}
+
+}  // namespace
+}  // namespace tensorflow
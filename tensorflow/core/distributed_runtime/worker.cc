@@ -221,11 +221,12 @@ void Worker::DoRunGraph(CallOptions* opts, RunGraphRequestWrapper* request,
   session->graph_mgr()->ExecuteAsync(
       request->graph_handle(), step_id, session.get(), request->exec_opts(),
       collector, response, cm, in,
-      [this, step_id, response, session, cm, out, token, collector,
-       profiler_session, opts, done](const Status& status) {
+      [this, step_id, graph_handle = request->graph_handle(), response,
+       session, cm, out, token, collector, profiler_session, opts,
+       done](const Status& status) {
         Status s = status;
         if (s.ok()) {
-          s = session->graph_mgr()->RecvOutputs(step_id, out);
+          s = session->graph_mgr()->RecvOutputs(graph_handle, step_id, out);
         }
 
         opts->ClearCancelCallback();
@@ -29,6 +29,7 @@ namespace tensorflow {
 
 thread_local const char* pending_op_name = nullptr;
 thread_local int64 pending_step_id = 0;
+thread_local const TensorShape* pending_shape = nullptr;
 
 string AllocatorStats::DebugString() const {
   return strings::Printf(
@@ -36,12 +37,16 @@ string AllocatorStats::DebugString() const {
       "InUse:        %20lld\n"
       "MaxInUse:     %20lld\n"
       "NumAllocs:    %20lld\n"
-      "MaxAllocSize: %20lld\n",
+      "MaxAllocSize: %20lld\n"
+      "CacheHits:    %20lld\n"
+      "CacheMisses:  %20lld\n",
       static_cast<long long>(this->bytes_limit ? *this->bytes_limit : 0),
       static_cast<long long>(this->bytes_in_use),
       static_cast<long long>(this->peak_bytes_in_use),
       static_cast<long long>(this->num_allocs),
-      static_cast<long long>(this->largest_alloc_size));
+      static_cast<long long>(this->largest_alloc_size),
+      static_cast<long long>(this->num_cache_hits),
+      static_cast<long long>(this->num_cache_misses));
 }
 
 constexpr size_t Allocator::kAllocatorAlignment;
@@ -32,6 +32,8 @@ limitations under the License.
 
 namespace tensorflow {
 
+class TensorShape;
+
 // Attributes for a single allocation call. Different calls to the same
 // allocator could potentially have different allocation attributes.
 struct AllocationAttributes {
@@ -66,27 +68,39 @@ struct AllocationAttributes {
 // will try to tag allocations with the requesting Op.
 extern thread_local const char* pending_op_name;
 extern thread_local int64 pending_step_id;
+// Shape of the tensor being allocated, or nullptr if unknown. Only valid while
+// the ScopedMemoryDebugAnnotation that set it is alive.
+extern thread_local const TensorShape* pending_shape;
 
-// Wrapper class of pending_op_name and pending_step_id for RAII.
+// Wrapper class of pending_op_name, pending_step_id and pending_shape for RAII.
 class ScopedMemoryDebugAnnotation {
  public:
   explicit ScopedMemoryDebugAnnotation(const char* op_name) {
     last_op_name_ = pending_op_name;
+    last_shape_ = pending_shape;
     pending_op_name = op_name;
+    pending_shape = nullptr;
   }
 
-  explicit ScopedMemoryDebugAnnotation(const char* op_name, int64 step_id) {
+  explicit ScopedMemoryDebugAnnotation(const char* op_name, int64 step_id,
+                                       const TensorShape* shape = nullptr) {
     last_op_name_ = pending_op_name;
+    last_shape_ = pending_shape;
     pending_op_name = op_name;
     pending_step_id = step_id;
+    pending_shape = shape;
   }
 
-  ~ScopedMemoryDebugAnnotation() { pending_op_name = last_op_name_; }
+  ~ScopedMemoryDebugAnnotation() {
+    pending_op_name = last_op_name_;
+    pending_shape = last_shape_;
+  }
 
  private:
-  // Stores the previous value of pending_op_name in case the annotations are
-  // nested.
+  // Stores the previous values of pending_op_name and pending_shape in case the
+  // annotations are nested.
   const char* last_op_name_ = nullptr;
+  const TensorShape* last_shape_ = nullptr;
 };
 
 // Runtime statistics collected by an allocator. Exactly the same as
@@ -109,13 +123,22 @@ struct AllocatorStats {
   // if such a limit is known.
   absl::optional<int64> bytes_reservable_limit;
 
+  // Stats for allocators that keep a cache of recently freed buffers in front
+  // of their main free lists. Allocations served from the cache are counted in
+  // `num_cache_hits`, and cache-eligible allocations that had to fall back to
+  // the main free lists in `num_cache_misses`.
+  int64 num_cache_hits;
+  int64 num_cache_misses;
+
   AllocatorStats()
       : num_allocs(0),
         bytes_in_use(0),
         peak_bytes_in_use(0),
         largest_alloc_size(0),
         bytes_reserved(0),
-        peak_bytes_reserved(0) {}
+        peak_bytes_reserved(0),
+        num_cache_hits(0),
+        num_cache_misses(0) {}
 
   std::string DebugString() const;
 };
@@ -383,6 +406,12 @@ class SubAllocator {
   virtual void* Alloc(size_t alignment, size_t num_bytes) = 0;
   virtual void Free(void* ptr, size_t num_bytes) = 0;
 
+  // Returns true if the memory returned by successive Alloc calls may be
+  // adjacent, so that the higher-level allocator can treat it as one range,
+  // and if Free accepts any range made of whole Alloc results, not just the
+  // result of one Alloc.
+  virtual bool SupportsCoalescing() const { return false; }
+
  protected:
   // Implementation of Alloc() method must call this on newly allocated
   // value.
@@ -73,6 +73,7 @@ CollInstanceParams& CollInstanceParams::operator=(
     same_num_devices_per_task = other.same_num_devices_per_task;
     num_devices_per_task = other.num_devices_per_task;
     gpu_ring_order = other.gpu_ring_order;
+    communication_dtype = other.communication_dtype;
     impl_details.subdiv_offsets.assign(
         other.impl_details.subdiv_offsets.begin(),
         other.impl_details.subdiv_offsets.end());
@@ -23,6 +23,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 
@@ -104,6 +105,10 @@ struct CollInstanceParams {
   // If passed in to GPUOptions in ConfigProto, defines a good ring order for
   // GPUs.  Assumes same GPU configuration at each worker.
   string gpu_ring_order = "";
+  // Reduction only: if not DT_INVALID, the float input is cast to this type
+  // (DT_HALF or DT_BFLOAT16) for transport and reduction, which halves the
+  // communication volume.
+  DataType communication_dtype = DT_INVALID;
   CollImplDetails impl_details;
   string ToString() const;
   CollInstanceParams& operator=(const struct CollInstanceParams& other);
@@ -116,6 +121,14 @@ struct CollTaskParams {
   string ToString() const;
 };
 
+// Error-feedback state of a reduction in a lower precision communication_dtype.
+// The rounding error of each input is carried over and added to the next input
+// of the same op, so that it is not lost over the course of training.
+struct CollErrorFeedback {
+  mutex mu;
+  Tensor residual TF_GUARDED_BY(mu);  // Same shape as the input, or empty.
+};
+
 // Unique to a single CollectiveOp node.
 struct CollectiveParams {
   CollGroupParams group;
@@ -130,6 +143,8 @@ struct CollectiveParams {
   std::vector<int> subdiv_rank;
   std::unique_ptr<OpKernel> merge_op;  // reduction only
   std::unique_ptr<OpKernel> final_op;  // reduction only
+  // Reduction with instance.communication_dtype only.
+  std::unique_ptr<CollErrorFeedback> error_feedback;
   string ToString() const;
 };
 
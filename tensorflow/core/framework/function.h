@@ -275,6 +275,19 @@ class CallFrameInterface {
   virtual size_t num_retvals() const = 0;
 
   virtual Status GetArg(int index, Tensor* val) const = 0;
+
+  // Returns true if the callee may take the argument at `index` with
+  // ConsumeArg() instead of copying it with GetArg(), which lets it update
+  // the argument in place, e.g. when appending to a TensorList.
+  virtual bool CanConsumeArg(int index) const { return false; }
+
+  // Moves the argument at `index` into `*val`. Only valid if
+  // CanConsumeArg(index) returned true, and at most once per argument.
+  virtual void ConsumeArg(int index, Tensor* val) {
+    LOG(ERROR) << "This CallFrameInterface does not support consuming "
+                  "arguments.";
+  }
+
   virtual Status SetRetval(int index, const Tensor& val) = 0;
 };
 
@@ -297,6 +310,10 @@ class FunctionCallFrame : public CallFrameInterface {
   // false it will fail if any of the retvals do not have a value.
   Status ConsumeRetvals(std::vector<Tensor>* rets, bool allow_dead_tensors);
 
+  // Clears all arguments and return values, so that the frame can be reused
+  // for another call with the same argument and return types.
+  void Reset();
+
   size_t num_args() const override { return arg_types_.size(); }
   size_t num_retvals() const override { return ret_types_.size(); }
 
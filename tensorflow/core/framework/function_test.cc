@@ -954,6 +954,28 @@ TEST(FunctionCallFrame, Float_Float_Float) {
   test::ExpectTensorEqual<float>(rets[0], v);
 }
 
+TEST(FunctionCallFrame, Reset) {
+  FunctionCallFrame frame({DT_FLOAT}, {DT_FLOAT});
+  auto a = test::AsTensor<float>({100});
+  TF_EXPECT_OK(frame.SetArgs({a}));
+  TF_EXPECT_OK(frame.SetRetval(0, a));
+
+  frame.Reset();
+  Tensor v;
+  TF_EXPECT_OK(frame.GetArg(0, &v));
+  EXPECT_FALSE(v.IsInitialized());
+  std::vector<Tensor> rets;
+  HasError(frame.GetRetvals(&rets), "does not have value");
+
+  // The frame can be used again after a reset.
+  auto b = test::AsTensor<float>({200});
+  TF_EXPECT_OK(frame.SetArgs({b}));
+  TF_EXPECT_OK(frame.SetRetval(0, b));
+  TF_EXPECT_OK(frame.ConsumeRetvals(&rets, /*allow_dead_tensors=*/false));
+  EXPECT_EQ(rets.size(), 1);
+  test::ExpectTensorEqual<float>(rets[0], b);
+}
+
 TEST(Canonicalize, Basic) {
   EXPECT_EQ(Canonicalize("MatMul", Attrs({{"T", DT_FLOAT},
                                           {"transpose_a", false},
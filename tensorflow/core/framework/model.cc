@@ -681,25 +681,38 @@ void Model::AddNode(Node::Factory factory, const string& name,
     sanitized_output_name = output_name.substr(0, output_name.rfind('['));
   }
   std::shared_ptr<Node> output;
-  mutex_lock l(mu_);
-  auto it = lookup_table_.find(sanitized_output_name);
-  if (it != lookup_table_.end()) {
-    output = it->second;
-  }
-  std::shared_ptr<Node> node = factory({id_counter_++, tokens.back(), output});
-  if (!output_) {
-    output_ = node;
-  }
-  if (output) {
-    VLOG(3) << "Adding " << node->long_name() << " as input for "
-            << output->long_name();
-    output->add_input(node);
-  } else {
-    VLOG(3) << "Adding " << node->long_name();
-  }
-  collect_resource_usage_ =
-      collect_resource_usage_ || node->has_tunable_parameters();
-  lookup_table_.insert(std::make_pair(name, node));
+  std::shared_ptr<Node> node;
+  TunedState::NodeState warm_start_state;
+  bool warm_start = false;
+  {
+    mutex_lock l(mu_);
+    auto it = lookup_table_.find(sanitized_output_name);
+    if (it != lookup_table_.end()) {
+      output = it->second;
+    }
+    node = factory({id_counter_++, tokens.back(), output});
+    if (!output_) {
+      output_ = node;
+    }
+    if (output) {
+      VLOG(3) << "Adding " << node->long_name() << " as input for "
+              << output->long_name();
+      output->add_input(node);
+    } else {
+      VLOG(3) << "Adding " << node->long_name();
+    }
+    collect_resource_usage_ =
+        collect_resource_usage_ || node->has_tunable_parameters();
+    lookup_table_.insert(std::make_pair(name, node));
+    auto* state = gtl::FindOrNull(warm_start_state_.nodes, name);
+    if (state) {
+      warm_start_state = *state;
+      warm_start = true;
+    }
+  }
+  if (warm_start) {
+    WarmStartNode(warm_start_state, node.get());
+  }
   *out_node = node.get();
 }
 
@@ -720,6 +733,9 @@ void Model::Optimize(AutotuneAlgorithm algorithm, int64 cpu_budget,
     case AutotuneAlgorithm::GRADIENT_DESCENT:
       OptimizeGradientDescent(cpu_budget, ram_budget);
       break;
+    case AutotuneAlgorithm::MEMORY_BUDGET:
+      OptimizeMemoryBudget(cpu_budget, ram_budget);
+      break;
   }
 }
 
@@ -807,6 +823,118 @@ std::map<string, std::shared_ptr<Parameter>> Model::CollectEssentialParallelism(
   return essential_parameters;
 }
 
+Model::TunedState Model::GetTunedState() {
+  TunedState state;
+  tf_shared_lock l(mu_);
+  for (const auto& pair : lookup_table_) {
+    const std::shared_ptr<Node>& node = pair.second;
+    TunedState::NodeState& node_state = state.nodes[pair.first];
+    node_state.processing_time = node->processing_time();
+    node_state.num_elements = node->num_elements();
+    for (const auto& parameter : node->tunable_parameters()) {
+      node_state.parameters[parameter.first] = parameter.second->value;
+    }
+  }
+  return state;
+}
+
+Model::BottleneckReport Model::GetBottleneckReport() {
+  BottleneckReport report;
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock l(mu_);
+    if (!output_) return report;
+    snapshot = output_->Snapshot(nullptr);
+  }
+  std::map<string, double> processing_times;
+  report.processing_time = snapshot->TotalProcessingTime(&processing_times);
+  report.output_time = OutputTime(snapshot, /*gradient=*/nullptr);
+  auto parameters = CollectTunableParameters(snapshot);
+
+  std::vector<std::shared_ptr<Node>> stack = {snapshot};
+  while (!stack.empty()) {
+    std::shared_ptr<Node> node = stack.back();
+    stack.pop_back();
+    BottleneckReport::NodeReport node_report;
+    node_report.name = node->long_name();
+    if (report.processing_time > 0) {
+      node_report.processing_time_fraction =
+          processing_times[node->long_name()] / report.processing_time;
+    }
+    std::vector<double> input_times(1, 0);
+    node_report.output_time = node->OutputTime(&input_times, nullptr);
+    const double buffer_capacity = node->BufferCapacity();
+    if (buffer_capacity > 0) {
+      node_report.buffer_utilization =
+          std::min(1.0, node->buffered_elements() / buffer_capacity);
+    }
+    auto* parameter = gtl::FindOrNull(parameters, node->long_name());
+    if (parameter) {
+      node_report.parameter_name = (*parameter)->name;
+      node_report.parameter_value = (*parameter)->value;
+      if ((*parameter)->value < (*parameter)->max) {
+        (*parameter)->value++;
+        const double output_time = OutputTime(snapshot, /*gradient=*/nullptr);
+        (*parameter)->value--;
+        if (output_time > 0) {
+          node_report.speedup_if_incremented = report.output_time / output_time;
+        }
+      }
+    }
+    report.nodes.push_back(std::move(node_report));
+    std::list<std::shared_ptr<Node>> inputs = node->inputs();
+    for (auto it = inputs.rbegin(); it != inputs.rend(); ++it) {
+      stack.push_back(*it);
+    }
+  }
+  return report;
+}
+
+void Model::WarmStart(TunedState state) {
+  std::vector<std::pair<std::shared_ptr<Node>, TunedState::NodeState>> nodes;
+  {
+    mutex_lock l(mu_);
+    for (const auto& pair : lookup_table_) {
+      auto* node_state = gtl::FindOrNull(state.nodes, pair.first);
+      if (node_state) {
+        nodes.emplace_back(pair.second, *node_state);
+      }
+    }
+    warm_start_state_ = std::move(state);
+  }
+  for (const auto& pair : nodes) {
+    WarmStartNode(pair.second, pair.first.get());
+  }
+}
+
+/* static */
+void Model::WarmStartNode(const TunedState::NodeState& state, Node* node) {
+  // The number of elements that the restored processing time is worth, so that
+  // the processing times observed in this run quickly take precedence.
+  constexpr int64 kMaxWarmStartElements = 100;
+
+  if (state.num_elements > 0) {
+    const int64 num_elements =
+        std::min(state.num_elements, kMaxWarmStartElements);
+    node->WarmStart(
+        static_cast<int64>(static_cast<double>(state.processing_time) *
+                           num_elements / state.num_elements),
+        num_elements);
+  }
+  for (const auto& pair : node->tunable_parameters()) {
+    auto* value = gtl::FindOrNull(state.parameters, pair.first);
+    if (!value) continue;
+    Parameter* parameter = pair.second.get();
+    parameter->value =
+        std::min(std::max(*value, parameter->min), parameter->max);
+    VLOG(2) << "Warm-starting tunable parameter " << node->long_name() << "."
+            << pair.first << " with " << parameter->value;
+    mutex_lock l(*parameter->state->mu);
+    parameter->state->value = parameter->value;
+    parameter->state->cond_var->notify_all();
+  }
+}
+
 void Model::OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget) {
   std::shared_ptr<Node> snapshot;
   {
@@ -951,6 +1079,98 @@ void Model::OptimizeHillClimb(int64 cpu_budget, int64 ram_budget) {
   }
 }
 
+void Model::OptimizeMemoryBudget(int64 cpu_budget, int64 ram_budget) {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock lock(mu_);
+    snapshot = output_->Snapshot(nullptr);
+  }
+  VLOG(2) << "Starting optimization of tunable parameters with MemoryBudget";
+  const double processing_time = TotalProcessingTime(snapshot);
+  auto parameters = CollectTunableParameters(snapshot);
+  // We add the number of model's buffered bytes because it is excluded from the
+  // memory budget, but it is included in the maximum number of buffered bytes.
+  const double budget = ram_budget + TotalBufferedBytes(snapshot);
+  // Buffer size parameter will only be incremented if the output latency
+  // improvement is greater than this constant.
+  constexpr double kBufferSizeMinDelta = 1.0L;
+
+  for (auto& pair : parameters) {
+    pair.second->value = pair.second->min;
+  }
+  double buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+  if (buffered_bytes > budget) {
+    VLOG(2) << "The minimum buffer sizes of the model exceed the memory "
+               "budget of "
+            << budget << " bytes.";
+  }
+  while (true) {
+    const double output_time = OutputTime(snapshot, /*gradient=*/nullptr);
+    if (output_time < processing_time / cpu_budget) {
+      break;
+    }
+    // The best increment that does not buffer more bytes, and the one with the
+    // largest output time decrease per additional buffered byte.
+    Parameter* best_free_parameter = nullptr;
+    double best_free_delta = 0;
+    Parameter* best_parameter = nullptr;
+    double best_delta_per_byte = 0;
+    double best_buffered_bytes = 0;
+    for (auto& pair : parameters) {
+      Parameter* parameter = pair.second.get();
+      if (parameter->value >= parameter->max) {
+        continue;
+      }
+      parameter->value++;
+      const double delta = output_time - OutputTime(snapshot, nullptr);
+      const double new_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+      parameter->value--;
+      if (delta <= 0 ||
+          (delta <= kBufferSizeMinDelta && parameter->name == kBufferSize)) {
+        continue;
+      }
+      const double added_bytes = new_buffered_bytes - buffered_bytes;
+      if (added_bytes <= 0) {
+        if (delta > best_free_delta) {
+          best_free_delta = delta;
+          best_free_parameter = parameter;
+        }
+      } else if (new_buffered_bytes <= budget &&
+                 delta / added_bytes > best_delta_per_byte) {
+        best_delta_per_byte = delta / added_bytes;
+        best_parameter = parameter;
+        best_buffered_bytes = new_buffered_bytes;
+      }
+    }
+    if (best_free_parameter) {
+      best_free_parameter->value++;
+    } else if (best_parameter) {
+      best_parameter->value++;
+      buffered_bytes = best_buffered_bytes;
+    } else {
+      // No parameter can be incremented within the memory budget, or the
+      // output time reached a local minimum.
+      break;
+    }
+  }
+  VLOG(2) << "Number of tunable parameters: " << parameters.size()
+          << ", maximum buffered bytes: " << buffered_bytes
+          << ", budget: " << budget;
+  UpdateStateValues(parameters);
+}
+
+void Model::UpdateStateValues(
+    const std::map<string, std::shared_ptr<Parameter>>& parameters) {
+  for (auto& pair : parameters) {
+    auto& parameter = pair.second;
+    VLOG(2) << "Setting tunable parameter " << pair.first << " to "
+            << parameter->value;
+    mutex_lock l(*parameter->state->mu);
+    parameter->state->value = parameter->value;
+    parameter->state->cond_var->notify_all();
+  }
+}
+
 double Model::OutputTime(std::shared_ptr<Node> node,
                          std::map<string, double>* gradient) {
   std::vector<double> input_times(1, 0);
@@ -43,6 +43,7 @@ constexpr char kBufferSize[] = "buffer_size";
 enum class AutotuneAlgorithm {
   HILL_CLIMB = 0,
   GRADIENT_DESCENT = 1,
+  MEMORY_BUDGET = 2,
 };
 
 // Represents thread-safe state that can be shared between an input pipeline and
@@ -243,6 +244,31 @@ class Node {
     autotune_ = autotune;
   }
 
+  // Returns the tunable parameters of this node, keyed by parameter name.
+  std::map<string, std::shared_ptr<Parameter>> tunable_parameters() const
+      TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    std::map<string, std::shared_ptr<Parameter>> result;
+    for (auto& pair : parameters_) {
+      if (pair.second->state->tunable) {
+        result.insert(pair);
+      }
+    }
+    return result;
+  }
+
+  // Sets the aggregate processing time and the number of elements to those of
+  // a node of a previous run of the same input pipeline, unless this node has
+  // already produced elements.
+  void WarmStart(int64 processing_time, int64 num_elements)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    if (num_elements_ == 0) {
+      processing_time_ = processing_time;
+      num_elements_ = num_elements;
+    }
+  }
+
   // Collects tunable parameters in the subtree rooted in this node.
   void CollectTunableParameters(
       std::map<string, std::shared_ptr<Parameter>>* parameters) const
@@ -373,6 +399,17 @@ class Node {
     return TotalProcessingTimeLocked(processing_times);
   }
 
+  // Returns the maximum number of elements buffered in this node, i.e. the
+  // value of its buffer size or parallelism parameter, or 0 if it has neither.
+  double BufferCapacity() const TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    auto* parameter = gtl::FindOrNull(parameters_, kBufferSize);
+    if (!parameter) {
+      parameter = gtl::FindOrNull(parameters_, kParallelism);
+    }
+    return parameter ? (*parameter)->value : 0;
+  }
+
  protected:
   // Returns the number of inputs.
   int64 num_inputs() const TF_SHARED_LOCKS_REQUIRED(mu_) {
@@ -563,6 +600,52 @@ class Model {
  public:
   using NodeHook = std::function<void(std::shared_ptr<Node>)>;
 
+  // The statistics and tuned parameter values of the nodes of a model, keyed
+  // by node name, which can be used to warm-start a model of the same input
+  // pipeline.
+  struct TunedState {
+    struct NodeState {
+      int64 processing_time = 0;
+      int64 num_elements = 0;
+      // Values of the tunable parameters, keyed by parameter name.
+      std::map<string, double> parameters;
+    };
+    std::map<string, NodeState> nodes;
+  };
+
+  // Where the time of the input pipeline goes, derived from the statistics the
+  // model collects for autotuning.
+  struct BottleneckReport {
+    struct NodeReport {
+      // Unique name of the node.
+      string name;
+      // Share of the per-element CPU time of the input pipeline spent in this
+      // node.
+      double processing_time_fraction = 0;
+      // Per-element output time of the subtree rooted in this node in
+      // nanoseconds.
+      double output_time = 0;
+      // Ratio of buffered elements to the buffer capacity of the node, or -1
+      // if the node has no buffer. A buffer that stays close to empty means
+      // that the consumer of the node stalls on its input; one that stays
+      // close to full means that the node stalls on its output.
+      double buffer_utilization = -1;
+      // Name and value of the tunable parameter of the node, if any.
+      string parameter_name;
+      double parameter_value = 0;
+      // Predicted ratio of the output time of the input pipeline to its output
+      // time if the tunable parameter were incremented by one. 1 if the node
+      // has no tunable parameter or the parameter is at its maximum.
+      double speedup_if_incremented = 1;
+    };
+    // Per-element output time of the input pipeline in nanoseconds.
+    double output_time = 0;
+    // Per-element CPU time of the input pipeline in nanoseconds.
+    double processing_time = 0;
+    // All nodes of the model, in pre-order starting from the output node.
+    std::vector<NodeReport> nodes;
+  };
+
   // Creates a new model.
   //
   // The `remove_node_hook` argument can be used to specify functionality that
@@ -595,6 +678,20 @@ class Model {
   // Records that a node has produced an element.
   void RecordElement(const string& name) TF_LOCKS_EXCLUDED(mu_);
 
+  // Returns the current state of the model.
+  TunedState GetTunedState() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the bottleneck report of the model. The predictions evaluate the
+  // tunable parameters like the optimization does, so this must not be called
+  // concurrently with `Optimize`.
+  BottleneckReport GetBottleneckReport() TF_LOCKS_EXCLUDED(mu_);
+
+  // Warm-starts the nodes of the model, including the ones added later on,
+  // from the state of a model of the same input pipeline. This makes the tuned
+  // parameter values take effect immediately, and lets the first optimization
+  // use the processing times observed by the previous model.
+  void WarmStart(TunedState state) TF_LOCKS_EXCLUDED(mu_);
+
   // Returns the number of elements that the input pipeline has produced.
   int64 NumElements(const string& name) TF_LOCKS_EXCLUDED(mu_);
 
@@ -640,6 +737,24 @@ class Model {
   // an element divided by CPU budget.
   void OptimizeGradientDescent(int64 cpu_budget, int64 ram_budget);
 
+  // This optimization algorithm starts by setting all tunable parameters to
+  // the minimum value. Like `OptimizeHillClimb`, it then repeatedly increments
+  // a parameter, but it only considers increments whose worst-case total buffer
+  // size stays within the memory budget, and among those it prefers the ones
+  // that do not buffer more bytes, followed by the ones with the largest output
+  // time decrease per additional byte. As the parameters are recomputed from
+  // their minimum values on every invocation, buffers shrink once the memory
+  // budget does.
+  void OptimizeMemoryBudget(int64 cpu_budget, int64 ram_budget);
+
+  // Sets the shared state of the given parameters to their values.
+  void UpdateStateValues(
+      const std::map<string, std::shared_ptr<Parameter>>& parameters);
+
+  // Applies `state` to `node`. Acquires the mutexes of the node's parameters,
+  // so it must not be called while holding `mu_`.
+  static void WarmStartNode(const TunedState::NodeState& state, Node* node);
+
   // Collects the output time and if `gradient` is not `nullptr`, the output
   // time gradient w.r.t. tunable parameters of the subtree rooted in the given
   // node and the last input time.
@@ -666,6 +781,7 @@ class Model {
   int64 id_counter_ TF_GUARDED_BY(mu_) = 1;
   std::shared_ptr<Node> output_ TF_GUARDED_BY(mu_);
   std::map<string, std::shared_ptr<Node>> lookup_table_ TF_GUARDED_BY(mu_);
+  TunedState warm_start_state_ TF_GUARDED_BY(mu_);
 
   // Indicates whether the modeling framework should collect resource usage
   // (e.g. CPU, memory). The logic for collecting this information assumes that
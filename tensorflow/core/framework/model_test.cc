@@ -727,6 +727,135 @@ TEST(UnknownGradientTest, Model) {
               (new_output_time - output_time) / kParameterStep,
               kComparisonPrecision);
 }
+
+// Returns the parallelism chosen by the `MEMORY_BUDGET` algorithm for a map
+// that produces 1000 byte elements, given `ram_budget`.
+double OptimizeMemoryBudget(int64 ram_budget) {
+  Model model(/*remove_node_hook=*/[](std::shared_ptr<Node> node) {});
+  auto state = std::make_shared<SharedState>(
+      kAutotune, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  Node* map = nullptr;
+  model.AddNode(
+      [state](Node::Args args) {
+        return MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {MakeParameter(kParallelism, state, /*min=*/1, /*max=*/16)});
+      },
+      "ParallelMap", /*output_name=*/"", &map);
+  Node* source = nullptr;
+  model.AddNode([](Node::Args args) { return MakeSourceNode(std::move(args)); },
+                "ParallelMap::Source", "ParallelMap", &source);
+  map->record_buffer_event(/*bytes_delta=*/1000, /*elements_delta=*/1);
+  for (int i = 0; i < 10; ++i) {
+    map->add_processing_time(10000);
+    map->record_element();
+    source->add_processing_time(10);
+    source->record_element();
+  }
+  model.Optimize(AutotuneAlgorithm::MEMORY_BUDGET, /*cpu_budget=*/16,
+                 ram_budget);
+  return state->value;
+}
+
+TEST(MemoryBudgetTest, Model) {
+  // The 1000 bytes that are already buffered do not count against the budget.
+  EXPECT_EQ(4, OptimizeMemoryBudget(/*ram_budget=*/3000));
+  EXPECT_EQ(1, OptimizeMemoryBudget(/*ram_budget=*/0));
+  EXPECT_EQ(16, OptimizeMemoryBudget(/*ram_budget=*/1000000));
+}
+
+TEST(WarmStartTest, Model) {
+  auto make_state = []() {
+    return std::make_shared<SharedState>(
+        kAutotune, std::make_shared<mutex>(),
+        std::make_shared<condition_variable>());
+  };
+  auto add_nodes = [](Model* model, std::shared_ptr<SharedState> state,
+                      Node** map) {
+    model->AddNode(
+        [state](Node::Args args) {
+          return MakeAsyncKnownRatioNode(
+              std::move(args), /*ratio=*/1,
+              {MakeParameter(kParallelism, state, /*min=*/1, /*max=*/16)});
+        },
+        "ParallelMap", /*output_name=*/"", map);
+    Node* source = nullptr;
+    model->AddNode(
+        [](Node::Args args) { return MakeSourceNode(std::move(args)); },
+        "ParallelMap::Source", "ParallelMap", &source);
+  };
+
+  Model model(/*remove_node_hook=*/[](std::shared_ptr<Node> node) {});
+  std::shared_ptr<SharedState> state = make_state();
+  Node* map = nullptr;
+  add_nodes(&model, state, &map);
+  for (int i = 0; i < 1000; ++i) {
+    map->add_processing_time(10);
+    map->record_element();
+  }
+  map->tunable_parameters()[kParallelism]->value = 4;
+  Model::TunedState tuned_state = model.GetTunedState();
+  ASSERT_EQ(2, tuned_state.nodes.size());
+  EXPECT_EQ(10000, tuned_state.nodes["ParallelMap"].processing_time);
+  EXPECT_EQ(1000, tuned_state.nodes["ParallelMap"].num_elements);
+  EXPECT_EQ(4, tuned_state.nodes["ParallelMap"].parameters[kParallelism]);
+
+  // Nodes that are added after the model is warm-started start with the
+  // tuned parameter values and the per-element processing time.
+  Model new_model(/*remove_node_hook=*/[](std::shared_ptr<Node> node) {});
+  new_model.WarmStart(tuned_state);
+  std::shared_ptr<SharedState> new_state = make_state();
+  Node* new_map = nullptr;
+  add_nodes(&new_model, new_state, &new_map);
+  EXPECT_EQ(4, new_state->value);
+  EXPECT_EQ(10, new_map->SelfProcessingTime());
+  EXPECT_LE(new_map->num_elements(), 100);
+}
+
+TEST(BottleneckReportTest, Model) {
+  Model model(/*remove_node_hook=*/[](std::shared_ptr<Node> node) {});
+  auto state = std::make_shared<SharedState>(
+      kAutotune, std::make_shared<mutex>(),
+      std::make_shared<condition_variable>());
+  Node* map = nullptr;
+  model.AddNode(
+      [state](Node::Args args) {
+        return MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {MakeParameter(kParallelism, state, /*min=*/1, /*max=*/16)});
+      },
+      "ParallelMap", /*output_name=*/"", &map);
+  Node* source = nullptr;
+  model.AddNode([](Node::Args args) { return MakeSourceNode(std::move(args)); },
+                "ParallelMap::Source", "ParallelMap", &source);
+  map->record_buffer_event(/*bytes_delta=*/1000, /*elements_delta=*/1);
+  for (int i = 0; i < 10; ++i) {
+    map->add_processing_time(9990);
+    map->record_element();
+    source->add_processing_time(10);
+    source->record_element();
+  }
+  map->tunable_parameters()[kParallelism]->value = 1;
+
+  Model::BottleneckReport report = model.GetBottleneckReport();
+  EXPECT_NEAR(10000, report.processing_time, kComparisonPrecision);
+  ASSERT_EQ(2, report.nodes.size());
+  const auto& map_report = report.nodes[0];
+  EXPECT_EQ(map->long_name(), map_report.name);
+  EXPECT_NEAR(0.999, map_report.processing_time_fraction, 1e-6);
+  EXPECT_EQ(1, map_report.buffer_utilization);
+  EXPECT_EQ(kParallelism, map_report.parameter_name);
+  EXPECT_EQ(1, map_report.parameter_value);
+  // The map is the bottleneck, so more parallelism speeds the pipeline up.
+  EXPECT_GT(map_report.speedup_if_incremented, 1);
+  const auto& source_report = report.nodes[1];
+  EXPECT_EQ(source->long_name(), source_report.name);
+  EXPECT_NEAR(0.001, source_report.processing_time_fraction, 1e-6);
+  EXPECT_EQ(-1, source_report.buffer_utilization);
+  EXPECT_EQ(1, source_report.speedup_if_incremented);
+}
+
 }  // namespace
 }  // namespace model
 }  // namespace data
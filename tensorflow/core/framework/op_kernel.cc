@@ -702,9 +702,15 @@ Status OpKernelContext::allocate_output(StringPiece name,
 Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
-  Allocator* a = get_allocator(attr);
-  auto op_annotation =
-      ScopedMemoryDebugAnnotation(op_kernel().name_view().data(), step_id());
+  return allocate_tensor(get_allocator(attr), type, shape, out_tensor,
+                         allocation_attr);
+}
+
+Status OpKernelContext::allocate_tensor(
+    Allocator* a, DataType type, const TensorShape& shape, Tensor* out_tensor,
+    const AllocationAttributes& allocation_attr) {
+  auto op_annotation = ScopedMemoryDebugAnnotation(
+      op_kernel().name_view().data(), step_id(), &shape);
   Tensor new_tensor(a, type, shape,
                     AllocationAttributes(allocation_attr.no_retry_on_failure,
                                          /* allocation_will_be_logged= */ true,
@@ -759,7 +765,15 @@ Status OpKernelContext::allocate_output(int index, const TensorShape& shape,
     }
   }
   auto output_tensor = MakeUnique<Tensor>();
-  Status s = allocate_tensor(type, shape, output_tensor.get(), attr);
+  Allocator* planned_allocator = nullptr;
+  if (TF_PREDICT_FALSE(params_->output_allocator_array != nullptr) &&
+      attr.value == 0 && attr.scope_id == 0 && !track_allocations()) {
+    planned_allocator = params_->output_allocator_array[index];
+  }
+  Status s = planned_allocator != nullptr
+                 ? allocate_tensor(planned_allocator, type, shape,
+                                   output_tensor.get(), AllocationAttributes())
+                 : allocate_tensor(type, shape, output_tensor.get(), attr);
   if (s.ok()) {
     outputs_[index] = TensorValue(output_tensor.release());
     *output = outputs_[index].tensor;
@@ -16,7 +16,14 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 
 namespace tensorflow {
 
@@ -87,10 +94,84 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Dirty row tracking, for delta checkpoints that only store the rows of the
+  // first dimension that changed since the previous checkpoint.
+  //
+  // Once StartTrackingDirtyRows() has been called, sparse updates mark the rows
+  // that they write, and any other update marks the whole variable.  Updates
+  // mark rows while holding mu(), so that a caller holding mu() exclusively
+  // can take the dirty rows together with a consistent copy of the tensor.
+  void StartTrackingDirtyRows() { tracks_dirty_rows_.store(true); }
+  bool tracks_dirty_rows() const { return tracks_dirty_rows_.load(); }
+
+  // Marks the rows in "indices", an int32 or int64 tensor on the host, as
+  // dirty.  Ignores indices outside of [0, num_rows).
+  void MarkRowsDirty(const Tensor& indices, int64 num_rows) {
+    if (!tracks_dirty_rows_.load()) return;
+    if (indices.dtype() == DT_INT32) {
+      MarkIndicesDirty<int32>(indices, num_rows);
+    } else if (indices.dtype() == DT_INT64) {
+      MarkIndicesDirty<int64>(indices, num_rows);
+    } else {
+      MarkAllRowsDirty();
+    }
+  }
+
+  void MarkAllRowsDirty() {
+    if (!tracks_dirty_rows_.load()) return;
+    mutex_lock l(dirty_mu_);
+    all_rows_dirty_ = true;
+    dirty_rows_.clear();
+  }
+
+  // Returns the rows marked dirty since tracking started, or since the last
+  // call, as sorted [start, limit) ranges, and clears them.  Sets "*all_rows"
+  // instead if the whole variable may have changed.
+  void TakeDirtyRows(bool* all_rows,
+                     std::vector<std::pair<int64, int64>>* ranges) {
+    ranges->clear();
+    mutex_lock l(dirty_mu_);
+    *all_rows = all_rows_dirty_;
+    if (!all_rows_dirty_) {
+      const int64 num_rows = dirty_rows_.size();
+      for (int64 row = 0; row < num_rows; ++row) {
+        if (!dirty_rows_[row]) continue;
+        if (!ranges->empty() && ranges->back().second == row) {
+          ranges->back().second = row + 1;
+        } else {
+          ranges->emplace_back(row, row + 1);
+        }
+      }
+    }
+    all_rows_dirty_ = false;
+    dirty_rows_.clear();
+  }
+
  private:
+  template <typename Index>
+  void MarkIndicesDirty(const Tensor& indices, int64 num_rows) {
+    const auto indices_flat = indices.flat<Index>();
+    mutex_lock l(dirty_mu_);
+    if (all_rows_dirty_) return;
+    for (int64 i = 0; i < indices_flat.size(); ++i) {
+      const int64 row = indices_flat(i);
+      if (row < 0 || row >= num_rows) continue;
+      if (static_cast<size_t>(row) >= dirty_rows_.size()) {
+        dirty_rows_.resize(num_rows);
+      }
+      dirty_rows_[row] = true;
+    }
+  }
+
   mutex mu_;
   Tensor tensor_;
 
+  std::atomic<bool> tracks_dirty_rows_{false};
+  mutex dirty_mu_;
+  bool all_rows_dirty_ TF_GUARDED_BY(dirty_mu_) = false;
+  // One bit per row of the first dimension.
+  std::vector<bool> dirty_rows_ TF_GUARDED_BY(dirty_mu_);
+
   ~Var() override {}
   TF_DISALLOW_COPY_AND_ASSIGN(Var);
 };
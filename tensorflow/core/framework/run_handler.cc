@@ -25,6 +25,7 @@ limitations under the License.
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/run_handler_util.h"
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -44,6 +45,14 @@ static constexpr int32 kMaxConcurrentHandlers = 128;
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+auto* queueing_delay_usecs = monitoring::Sampler<1>::New(
+    {"/tensorflow/core/run_handler/queueing_delay_usecs",
+     "Time between scheduling a closure on a RunHandler and the start of its "
+     "execution in microseconds, by request priority.",
+     "priority"},
+    // Power of 2 with bucket count 24 (> 8 seconds)
+    {monitoring::Buckets::Exponential(1, 2, 24)});
+
 }  // namespace
 
 namespace internal {
@@ -66,7 +75,7 @@ RunHandlerEnvironment::EnvThread* RunHandlerEnvironment::CreateThread(
 }
 
 RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(
-    std::function<void()> f) {
+    std::function<void()> f, monitoring::SamplerCell* queueing_delay_cell) {
   uint64 id = 0;
   if (tracing::EventCollector::IsEnabled()) {
     id = tracing::GetUniqueArg();
@@ -77,11 +86,16 @@ RunHandlerEnvironment::Task RunHandlerEnvironment::CreateTask(
           std::move(f),
           Context(ContextKind::kThread),
           id,
+          queueing_delay_cell,
+          queueing_delay_cell != nullptr ? env_->NowMicros() : 0,
       }),
   };
 }
 
 void RunHandlerEnvironment::ExecuteTask(const Task& t) {
+  if (t.f->queueing_delay_cell != nullptr) {
+    t.f->queueing_delay_cell->Add(env_->NowMicros() - t.f->create_time_us);
+  }
   WithContext wc(t.f->context);
   tracing::ScopedRegion region(tracing::EventCategory::kRunClosure,
                                t.f->trace_id);
@@ -131,6 +145,7 @@ ThreadWorkSource::ThreadWorkSource()
       blocking_inflight_(0),
       non_blocking_inflight_(0),
       traceme_id_(0),
+      queueing_delay_cell_(nullptr),
       version_(0),
       sub_thread_pool_waiter_(nullptr) {
   queue_waiters_.next = &queue_waiters_;
@@ -260,6 +275,14 @@ int64 ThreadWorkSource::GetTracemeId() {
 
 void ThreadWorkSource::SetTracemeId(int64 value) { traceme_id_ = value; }
 
+void ThreadWorkSource::SetQueueingDelayCell(monitoring::SamplerCell* cell) {
+  queueing_delay_cell_.store(cell, std::memory_order_relaxed);
+}
+
+monitoring::SamplerCell* ThreadWorkSource::GetQueueingDelayCell() {
+  return queueing_delay_cell_.load(std::memory_order_relaxed);
+}
+
 void ThreadWorkSource::SetWaiter(uint64 version, Waiter* waiter, mutex* mutex) {
   {
     tf_shared_lock lock(run_handler_waiter_mu_);
@@ -383,7 +406,7 @@ void RunHandlerThreadPool::StartOneThreadForTesting() {
 void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
                                           bool is_blocking,
                                           std::function<void()> fn) {
-  Task t = env_.CreateTask(std::move(fn));
+  Task t = env_.CreateTask(std::move(fn), tws->GetQueueingDelayCell());
   t = tws->EnqueueTask(std::move(t), is_blocking);
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
@@ -740,6 +763,20 @@ class RunHandler::Impl {
 
   int64 priority() { return options_.priority(); }
 
+  // Returns the deadline of the request in microseconds since the Unix epoch,
+  // or 0 if it has none.
+  int64 deadline_micros() { return options_.deadline_micros(); }
+
+  // Returns true if work of this request should be picked before work of
+  // `other`: higher priority first, then earlier deadline, where requests
+  // without a deadline come last. Ties keep arrival order.
+  bool Precedes(Impl* other) {
+    if (priority() != other->priority()) return priority() > other->priority();
+    if (deadline_micros() <= 0) return false;
+    return other->deadline_micros() <= 0 ||
+           deadline_micros() < other->deadline_micros();
+  }
+
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
    public:
@@ -861,12 +898,11 @@ class RunHandlerPool::Impl {
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
         if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+                                      handler_impl->Precedes(*it))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -922,6 +958,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<int64> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
  private:
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
@@ -1067,6 +1113,11 @@ void RunHandler::Impl::Reset(
     const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
   step_id_ = step_id;
+  if (options_.priority() != options.priority() ||
+      tws_.GetQueueingDelayCell() == nullptr) {
+    tws_.SetQueueingDelayCell(
+        queueing_delay_usecs->GetCell(strings::StrCat(options.priority())));
+  }
   options_ = options;
   tws_.SetTracemeId(step_id);
 }
@@ -1091,6 +1142,10 @@ std::vector<int64> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64> RunHandlerPool::GetActiveHandlerStepIdsForTesting() const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
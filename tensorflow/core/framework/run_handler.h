@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -72,6 +73,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids for active handlers, in the order of the active handler
+  // list.
+  std::vector<int64> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -81,8 +86,9 @@ class RunHandlerPool {
 
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
-// handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// handler specific queue, from which the work is stolen in a priority order:
+// by the priority of the request, then by its deadline, then by the time of
+// the Get() call.
 //
 // It can only be created via RunHandlerPool::Get().
 //
@@ -116,6 +122,10 @@ class RunHandlerEnvironment {
     std::function<void()> f;
     Context context;
     uint64 trace_id;
+    // If not null, receives the time between the creation of the task and the
+    // start of its execution.
+    monitoring::SamplerCell* queueing_delay_cell;
+    uint64 create_time_us;
   };
   Env* const env_;
   const ThreadOptions thread_options_;
@@ -131,7 +141,8 @@ class RunHandlerEnvironment {
 
   EnvThread* CreateThread(std::function<void()> f);
 
-  Task CreateTask(std::function<void()> f);
+  Task CreateTask(std::function<void()> f,
+                  monitoring::SamplerCell* queueing_delay_cell = nullptr);
 
   void ExecuteTask(const Task& t);
 };
@@ -173,6 +184,12 @@ class ThreadWorkSource {
 
   void SetTracemeId(int64 value);
 
+  // Sets the cell that records the queueing delay of the tasks of this work
+  // source. May be null.
+  void SetQueueingDelayCell(monitoring::SamplerCell* cell);
+
+  monitoring::SamplerCell* GetQueueingDelayCell();
+
   void SetWaiter(uint64 version, Waiter* waiter, mutex* mutex);
 
   int64 GetInflightTaskCount(bool is_blocking);
@@ -204,6 +221,7 @@ class ThreadWorkSource {
   mutex waiters_mu_;
   Waiter queue_waiters_ TF_GUARDED_BY(waiters_mu_);
   std::atomic<int64> traceme_id_;
+  std::atomic<monitoring::SamplerCell*> queueing_delay_cell_;
 
   mutex run_handler_waiter_mu_;
   uint64 version_ TF_GUARDED_BY(run_handler_waiter_mu_);
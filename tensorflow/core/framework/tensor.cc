@@ -140,6 +140,53 @@ class Buffer : public BufferBase {
   TF_DISALLOW_COPY_AND_ASSIGN(Buffer);
 };
 
+// Tensors of a simple type with at most this many bytes, allocated by the
+// default CPU allocator, keep their elements in the same allocation as their
+// buffer, like the host scalars of the `Tensor(T scalar_value)` constructors.
+// This saves an allocation for the small shape and index tensors that are
+// common in control-heavy graphs.
+constexpr int64 kMaxInlineBufferBytes = 64;
+
+// Ref-counted buffer of `n` bytes, stored right after the buffer itself.
+class InlineBuffer : public TensorBuffer {
+ public:
+  static InlineBuffer* New(size_t n) {
+    void* ptr = port::AlignedMalloc(DataOffset() + n, EIGEN_MAX_ALIGN_BYTES);
+    return new (ptr) InlineBuffer(static_cast<char*>(ptr) + DataOffset(), n);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("InlineTensorBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+
+  // Frees the single allocation when `core::RefCounted::Unref()` deletes
+  // this buffer.
+  static void operator delete(void* ptr) { port::AlignedFree(ptr); }
+  static void operator delete(void*, void*) {}
+
+ private:
+  // Offset of the elements from the start of the allocation, which keeps them
+  // aligned like those of the other buffers.
+  static constexpr size_t DataOffset() {
+    return (sizeof(InlineBuffer) + EIGEN_MAX_ALIGN_BYTES - 1) /
+           EIGEN_MAX_ALIGN_BYTES * EIGEN_MAX_ALIGN_BYTES;
+  }
+
+  InlineBuffer(void* data, size_t n) : TensorBuffer(data), size_(n) {}
+  ~InlineBuffer() override {}
+
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(InlineBuffer);
+};
+
 void LogUnexpectedSize(int64 actual, int64 expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -769,11 +816,31 @@ bool Tensor::RefCountIsOne() const {
                      LOG(FATAL) << "Unexpected type: " << TYPE_ENUM; \
                      , LOG(FATAL) << "Type not set";)
 
+static Allocator* get_default_cpu_allocator() {
+  static Allocator* default_cpu_allocator =
+      cpu_allocator(port::kNUMANoAffinity);
+  return default_cpu_allocator;
+}
+
+// Returns true if a tensor of `type` and `shape` allocated by `a` should be
+// backed by an InlineBuffer. Allocations that are logged keep going through
+// the allocator, so that they are all recorded.
+static bool CanUseInlineBuffer(Allocator* a, DataType type,
+                               const TensorShape& shape) {
+  const int64 num_elements = shape.num_elements();
+  return a == get_default_cpu_allocator() && DataTypeCanUseMemcpy(type) &&
+         num_elements > 0 && num_elements <= kMaxInlineBufferBytes &&
+         num_elements * DataTypeSize(type) <= kMaxInlineBufferBytes &&
+         !MemoryLoggingEnabled();
+}
+
 Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
+  if (CanUseInlineBuffer(a, type, shape_)) {
+    buf_ = InlineBuffer::New(shape_.num_elements() * DataTypeSize(type));
+  } else if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
@@ -805,11 +872,6 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
 // Note also that it would be better if all Tensor allocations required the user
 // to specify an allocator, for purposes of accounting, etc. However, the
 // default allocator is widely used throughout the codebase and in client code.
-static Allocator* get_default_cpu_allocator() {
-  static Allocator* default_cpu_allocator =
-      cpu_allocator(port::kNUMANoAffinity);
-  return default_cpu_allocator;
-}
 
 Tensor::Tensor(DataType type, const TensorShape& shape)
     : Tensor(get_default_cpu_allocator(), type, shape) {}
@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/framework/tensor.h"
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
@@ -874,6 +876,29 @@ TEST(Tensor_HostScalar, Basics) {
   }
 }
 
+TEST(Tensor, SmallTensorsUseInlineBuffer) {
+  auto allocator_name = [](const Tensor& t) {
+    TensorDescription description;
+    t.FillDescription(&description);
+    return description.allocation_description().allocator_name();
+  };
+  Tensor small(DT_INT32, TensorShape({4}));
+  EXPECT_EQ("InlineTensorBuffer", allocator_name(small));
+  EXPECT_TRUE(small.IsAligned());
+  small.flat<int32>().setValues({1, 2, 3, 4});
+  Tensor copy = small;
+  EXPECT_TRUE(copy.SharesBufferWith(small));
+  test::ExpectTensorEqual<int32>(small.Slice(1, 3),
+                                 test::AsTensor<int32>({2, 3}));
+
+  // Large tensors, and tensors that are not of a simple type, are allocated
+  // by the allocator.
+  EXPECT_NE("InlineTensorBuffer",
+            allocator_name(Tensor(DT_FLOAT, TensorShape({1024}))));
+  EXPECT_NE("InlineTensorBuffer",
+            allocator_name(Tensor(DT_STRING, TensorShape({2}))));
+}
+
 TEST(Tensor_Float, Reshape_And_Slice_Assignment) {
   // A test to experiment with a way to assign to a subset of a tensor
   Tensor t(DT_FLOAT, TensorShape({10, 4, 3, 2}));
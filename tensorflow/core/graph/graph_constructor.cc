@@ -282,6 +282,8 @@ class GraphConstructor {
   // possible. After calling this method, the result of get_node_def(i) is
   // undefined.
   virtual NodeDef consume_node_def(int i) = 0;
+  // Whether consume_node_def() moves the NodeDefs rather than copying them.
+  virtual bool moves_node_defs() const { return false; }
   // Returns the version information for the graph, or nullptr if none is
   // available.
   virtual const VersionDef* versions() const = 0;
@@ -330,6 +332,12 @@ class GraphConstructor {
   // only used when the original NodeDef's name is changed.
   std::vector<string> string_intern_table_;
 
+  // Storage for the keys of gdef_nodes_ and gdef_prefixes_ when importing
+  // NodeDefs that are moved, whose names are changed once they have been moved
+  // to the graph. Reserved for all nodes upfront, so that its strings are never
+  // moved.
+  std::vector<string> gdef_node_names_;
+
   // Prefixes already used in the GraphDef being imported.
   gtl::FlatSet<StringPiece, StringPieceHasher> gdef_prefixes_;
 
@@ -449,6 +457,7 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
     is_consumed_[i] = true;
     return std::move(*graph_def_.mutable_node(i));
   }
+  bool moves_node_defs() const override { return true; }
   const VersionDef* versions() const override { return &graph_def_.versions(); }
   const FunctionDefLibrary* library() const override {
     return &graph_def_.library();
@@ -642,6 +651,8 @@ Status GraphConstructor::ValidateInputMapAndControlDependencies() {
 }
 
 Status GraphConstructor::BuildNodeIndex() {
+  const bool copy_names = opts_.importing && moves_node_defs();
+  if (copy_names) gdef_node_names_.reserve(node_def_count());
   // Validate the node names and add them to gdef_nodes_ and gdef_prefixes_.
   for (int n = 0; n < node_def_count(); ++n) {
     const NodeDef& node_def = get_node_def(n);
@@ -650,9 +661,12 @@ Status GraphConstructor::BuildNodeIndex() {
           "Node '", node_def.name(),
           "': Node name contains invalid characters");
     }
-    if (!gdef_nodes_
-             .insert(std::make_pair(StringPiece(node_def.name()), NodeInfo(n)))
-             .second) {
+    StringPiece name = node_def.name();
+    if (copy_names) {
+      gdef_node_names_.push_back(node_def.name());
+      name = gdef_node_names_.back();
+    }
+    if (!gdef_nodes_.insert(std::make_pair(name, NodeInfo(n))).second) {
       return errors::InvalidArgument("Node '", node_def.name(),
                                      "' is not unique");
     }
@@ -681,7 +695,7 @@ Status GraphConstructor::BuildNodeIndex() {
       }
     }
     // Update gdef_prefixes_.
-    AddPrefixes(node_def.name(), &gdef_prefixes_);
+    AddPrefixes(name, &gdef_prefixes_);
   }
   return Status::OK();
 }
@@ -1399,13 +1413,18 @@ Status GraphConstructor::PopulateMissingUnusedInputMapKeys() {
     }
 
     // Check that key's index is in bounds. Get the number of outputs from the
-    // NodeDef, rather than the imported Node, since the Node may not exist if
+    // NodeDef if there is no imported Node, which happens if
     // opts_.skip_mapped_nodes is true.
-    const NodeDef& node_def = get_node_def(pair->second.gdef_index);
-    const OpDef* op_def;
-    TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
     int num_outputs;
-    TF_RETURN_IF_ERROR(NumOutputsForNode(node_def, *op_def, &num_outputs));
+    if (pair->second.node != nullptr) {
+      num_outputs = pair->second.node->num_outputs();
+    } else {
+      const NodeDef& node_def = get_node_def(pair->second.gdef_index);
+      const OpDef* op_def;
+      TF_RETURN_IF_ERROR(
+          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
+      TF_RETURN_IF_ERROR(NumOutputsForNode(node_def, *op_def, &num_outputs));
+    }
     if (key.second >= num_outputs) {
       // key's index out of bounds
       missing_unused_input_map_keys_->push_back(key);
@@ -1472,9 +1491,15 @@ Status ConvertNodeDefsToGraph(const GraphConstructorOptions& opts,
                                      /*missing_unused_input_map_keys=*/nullptr);
 }
 
-Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
-                      Graph* g, ShapeRefiner* refiner,
-                      ImportGraphDefResults* results) {
+namespace {
+
+// Validates the arguments of ImportGraphDef(), and prepares `refiner`, or
+// `default_refiner` if `refiner` is null, to import a GraphDef of `versions`.
+Status PrepareImportGraphDef(const ImportGraphDefOptions& opts,
+                             const VersionDef& versions, Graph* g,
+                             ImportGraphDefResults* results,
+                             ShapeRefiner* default_refiner,
+                             ShapeRefiner** refiner) {
   if (!opts.return_tensors.empty()) {
     if (results == nullptr) {
       return errors::InvalidArgument(
@@ -1504,20 +1529,20 @@ Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
     }
   }
 
-  ShapeRefiner default_refiner(gdef.versions().producer(), g->op_registry());
-  if (refiner == nullptr) {
-    refiner = &default_refiner;
+  if (*refiner == nullptr) {
+    *refiner = default_refiner;
   } else {
     // Log a warning if we are importing a GraphDef at an older
     // producer version after already having added non-source/sink
     // nodes to the graph in the past.
-    if (gdef.versions().producer() > 0 &&
-        gdef.versions().producer() < refiner->graph_def_version() &&
+    if (versions.producer() > 0 &&
+        versions.producer() < (*refiner)->graph_def_version() &&
         g->num_nodes() > 2) {
       LOG(WARNING) << "Importing a graph with a lower producer version "
-                   << gdef.versions().producer()
+                   << versions.producer()
                    << " into an existing graph with producer version "
-                   << refiner->graph_def_version() << ". Shape inference will "
+                   << (*refiner)->graph_def_version()
+                   << ". Shape inference will "
                    << "have run different parts of the graph with different "
                    << "producer versions.";
     }
@@ -1530,9 +1555,19 @@ Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
   // Note: to match Run() semantics, we should re-run shape inference
   // on the entire graph if the producer version has changed.  For now
   // we log the warning above.
-  refiner->set_graph_def_version(
-      std::min(refiner->graph_def_version(), gdef.versions().producer()));
+  (*refiner)->set_graph_def_version(
+      std::min((*refiner)->graph_def_version(), versions.producer()));
+  return Status::OK();
+}
 
+}  // namespace
+
+Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
+                      Graph* g, ShapeRefiner* refiner,
+                      ImportGraphDefResults* results) {
+  ShapeRefiner default_refiner(gdef.versions().producer(), g->op_registry());
+  TF_RETURN_IF_ERROR(PrepareImportGraphDef(opts, gdef.versions(), g, results,
+                                           &default_refiner, &refiner));
   if (results == nullptr) {
     return GraphConstructor::Construct(opts, gdef.node(), &gdef.versions(),
                                        &gdef.library(), g, refiner, nullptr,
@@ -1545,6 +1580,28 @@ Status ImportGraphDef(const ImportGraphDefOptions& opts, const GraphDef& gdef,
   }
 }
 
+Status ImportGraphDef(const ImportGraphDefOptions& opts, GraphDef&& gdef,
+                      Graph* g, ShapeRefiner* refiner,
+                      ImportGraphDefResults* results) {
+  if (opts.skip_mapped_nodes && results != nullptr) {
+    // The NodeDefs of skipped nodes are still needed once they are consumed,
+    // to check the unused input map keys.
+    return ImportGraphDef(opts, static_cast<const GraphDef&>(gdef), g, refiner,
+                          results);
+  }
+  ShapeRefiner default_refiner(gdef.versions().producer(), g->op_registry());
+  TF_RETURN_IF_ERROR(PrepareImportGraphDef(opts, gdef.versions(), g, results,
+                                           &default_refiner, &refiner));
+  if (results == nullptr) {
+    return GraphConstructor::Construct(opts, std::move(gdef), g, refiner,
+                                       nullptr, nullptr, nullptr);
+  } else {
+    return GraphConstructor::Construct(
+        opts, std::move(gdef), g, refiner, &results->return_tensors,
+        &results->return_nodes, &results->missing_unused_input_map_keys);
+  }
+}
+
 void CopyGraph(const Graph& src, Graph* dest) {
   for (Node* n : dest->nodes()) {
     CHECK(n->IsSource() || n->IsSink()) << "*dest must be empty";
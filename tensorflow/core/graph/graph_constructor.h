@@ -193,6 +193,14 @@ extern Status ImportGraphDef(const ImportGraphDefOptions& opts,
                              ShapeRefiner* refiner,
                              ImportGraphDefResults* results = nullptr);
 
+// Same as above, but moves the NodeDefs of `gdef` into the nodes of `*g`
+// rather than copying them, so that the graph of a large GraphDef, e.g. with
+// large constants, is imported without holding two copies of it. `gdef` is
+// left in an unspecified state, even on error.
+extern Status ImportGraphDef(const ImportGraphDefOptions& opts,
+                             GraphDef&& gdef, Graph* g, ShapeRefiner* refiner,
+                             ImportGraphDefResults* results = nullptr);
+
 // Make a copy of "src" into "*dest".
 //
 // REQUIRES: "*dest" is a freshly allocated graph without any nodes or edges
@@ -1696,6 +1696,40 @@ TEST_F(GraphConstructorTest, ImportGraphDef_ReturnTensors) {
   EXPECT_EQ(results.return_tensors[0].second, 0);
 }
 
+TEST_F(GraphConstructorTest, ImportGraphDef_MovedGraphDef) {
+  ShapeRefiner refiner(TF_GRAPH_DEF_VERSION, graph_.op_registry());
+  ExpectOK("node { name: 'input' op: 'TestInput' }", ImportGraphDefOptions(),
+           &refiner);
+
+  // The names of the moved NodeDefs change once they are in the graph.
+  ImportGraphDefOptions opts;
+  opts.prefix = "import";
+  opts.input_map[{"new_input", 1}] = {"input", 0};
+  opts.input_map[{"t1", 2}] = {"input", 1};
+  opts.return_tensors.push_back({"t1", 0});
+  opts.return_nodes.push_back("new_input");
+  GraphDef gdef;
+  CHECK(protobuf::TextFormat::ParseFromString(
+      "node { name: 'new_input' op: 'TestInput' }"
+      "node { name: 't1' op: 'TestMul' input: ['new_input:0', 'new_input:1'] }",
+      &gdef));
+  ImportGraphDefResults results;
+  TF_EXPECT_OK(
+      ImportGraphDef(opts, std::move(gdef), &graph_, &refiner, &results));
+
+  EXPECT_TRUE(HasNode("import/new_input"));
+  EXPECT_TRUE(HasNode("import/t1"));
+  EXPECT_TRUE(HasEdge("import/new_input", 0, "import/t1", 0));
+  EXPECT_TRUE(HasEdge("input", 0, "import/t1", 1));
+  ASSERT_EQ(1, results.return_tensors.size());
+  EXPECT_EQ("import/t1", results.return_tensors[0].first->name());
+  ASSERT_EQ(1, results.return_nodes.size());
+  EXPECT_EQ("import/new_input", results.return_nodes[0]->name());
+  // t1 has a single output, so its mapping is out of bounds.
+  ASSERT_EQ(1, results.missing_unused_input_map_keys.size());
+  EXPECT_EQ(SafeTensorId("t1", 2), results.missing_unused_input_map_keys[0]);
+}
+
 TEST_F(GraphConstructorTest, ImportGraphDef_ReturnTensorsErrors) {
   // Null results with non-empty opts.return_tensors
   ImportGraphDefOptions opts;
@@ -0,0 +1,162 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_op_level_cost_estimator.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Returns the key under which the costs of the op described by `op_info` are
+// measured: its type, its attributes, the types and shapes of its inputs and
+// the type of its device.
+string MeasurementKey(const OpInfo& op_info) {
+  string key = absl::StrCat(op_info.op(), "@", op_info.device().type(), "(");
+  for (const auto& input : op_info.inputs()) {
+    absl::StrAppend(&key, DataTypeString(input.dtype()),
+                    PartialTensorShape::DebugString(input.shape()), ",");
+  }
+  absl::StrAppend(&key, ")");
+  // Sort the attributes, and skip the internal ones, such as _class, that
+  // don't affect the computation.
+  std::map<string, string> attrs;
+  for (const auto& attr : op_info.attr()) {
+    if (absl::StartsWith(attr.first, "_")) continue;
+    attrs[attr.first] = SummarizeAttrValue(attr.second);
+  }
+  for (const auto& attr : attrs) {
+    absl::StrAppend(&key, attr.first, "=", attr.second, ";");
+  }
+  return key;
+}
+
+template <typename T>
+T Median(std::vector<T>* values) {
+  auto middle = values->begin() + values->size() / 2;
+  std::nth_element(values->begin(), middle, values->end());
+  return *middle;
+}
+
+}  // namespace
+
+MeasuredOpLevelCostEstimator::MeasuredOpLevelCostEstimator(
+    const OpPerformanceList& measurements) {
+  struct Samples {
+    std::vector<int64> execution_time;
+    std::vector<int64> compute_time;
+    std::vector<int64> memory_time;
+    std::vector<int64> temporary_memory;
+    std::vector<int64> persistent_memory;
+  };
+  std::unordered_map<string, Samples> samples;
+  for (const OpPerformance& perf : measurements.op_performance()) {
+    if (perf.compute_cost() <= 0) continue;
+    Samples& op_samples = samples[MeasurementKey(perf.op())];
+    op_samples.execution_time.push_back(perf.compute_cost());
+    op_samples.compute_time.push_back(perf.compute_time());
+    op_samples.memory_time.push_back(perf.memory_time());
+    op_samples.temporary_memory.push_back(perf.op_memory().temp_memory());
+    op_samples.persistent_memory.push_back(
+        perf.op_memory().persistent_memory());
+  }
+  for (auto& entry : samples) {
+    Samples& op_samples = entry.second;
+    MeasuredCosts& costs = measured_costs_[entry.first];
+    costs.execution_time =
+        Costs::NanoSeconds(Median(&op_samples.execution_time));
+    costs.compute_time = Costs::NanoSeconds(Median(&op_samples.compute_time));
+    costs.memory_time = Costs::NanoSeconds(Median(&op_samples.memory_time));
+    costs.temporary_memory = Median(&op_samples.temporary_memory);
+    costs.persistent_memory = Median(&op_samples.persistent_memory);
+  }
+}
+
+Costs MeasuredOpLevelCostEstimator::PredictCosts(
+    const OpContext& op_context) const {
+  auto it = measured_costs_.find(MeasurementKey(op_context.op_info));
+  if (it == measured_costs_.end()) {
+    return OpLevelCostEstimator::PredictCosts(op_context);
+  }
+  const MeasuredCosts& measured = it->second;
+  Costs costs = Costs::ZeroCosts();
+  costs.execution_time = measured.execution_time;
+  // The cost graph only has the split between compute and memory time for
+  // some ops; attribute everything to compute when it doesn't.
+  if (measured.compute_time.count() > 0 || measured.memory_time.count() > 0) {
+    costs.compute_time = measured.compute_time;
+    costs.memory_time = measured.memory_time;
+  } else {
+    costs.compute_time = measured.execution_time;
+  }
+  costs.temporary_memory = measured.temporary_memory;
+  costs.persistent_memory = measured.persistent_memory;
+  costs.num_ops_total = 1;
+  VLOG(1) << "Operation " << op_context.op_info.op() << " was measured to take "
+          << costs.execution_time.count() << " ns.";
+  return costs;
+}
+
+Status ReadOpPerformanceList(const string& path,
+                             OpPerformanceList* measurements) {
+  Env* env = Env::Default();
+  Status status = ReadBinaryProto(env, path, measurements);
+  if (!status.ok()) {
+    measurements->Clear();
+    status = ReadTextProto(env, path, measurements);
+  }
+  return status;
+}
+
+std::unique_ptr<OpLevelCostEstimator> CreateDefaultOpLevelCostEstimator() {
+  // The measurements are read once, and shared by all the estimators.
+  static const OpPerformanceList* measurements = []() {
+    string path;
+    Status status =
+        ReadStringFromEnvVar("TF_GRAPPLER_OP_PERFORMANCE_DATA", "", &path);
+    if (!status.ok() || path.empty()) return (OpPerformanceList*)nullptr;
+    auto* list = new OpPerformanceList;
+    status = ReadOpPerformanceList(path, list);
+    if (!status.ok()) {
+      LOG(ERROR) << "Failed to read op performance data from " << path << ": "
+                 << status;
+      delete list;
+      return (OpPerformanceList*)nullptr;
+    }
+    VLOG(1) << "Read " << list->op_performance_size()
+            << " op measurements from " << path;
+    return list;
+  }();
+  if (measurements == nullptr) {
+    return absl::make_unique<OpLevelCostEstimator>();
+  }
+  return absl::make_unique<MeasuredOpLevelCostEstimator>(*measurements);
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
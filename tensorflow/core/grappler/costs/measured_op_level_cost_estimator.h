@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_LEVEL_COST_ESTIMATOR_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_LEVEL_COST_ESTIMATOR_H_
+
+#include <memory>
+#include <unordered_map>
+
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Op level cost estimator that predicts the cost of an op from measurements
+// of the same op, with the same attributes and input shapes, on the same type
+// of device, and falls back to the analytical estimates of
+// OpLevelCostEstimator for ops that were not measured.
+//
+// The measurements are an OpPerformanceList, e.g. built from the cost graph
+// of a profiled step with CostGraphToOpPerformanceData().  When an op was
+// measured several times, the median of the measured times is used.
+class MeasuredOpLevelCostEstimator : public OpLevelCostEstimator {
+ public:
+  explicit MeasuredOpLevelCostEstimator(const OpPerformanceList& measurements);
+  ~MeasuredOpLevelCostEstimator() override {}
+
+  Costs PredictCosts(const OpContext& op_context) const override;
+
+  // Returns the number of distinct measured ops.
+  int num_measured_ops() const { return measured_costs_.size(); }
+
+ private:
+  struct MeasuredCosts {
+    Costs::NanoSeconds execution_time;
+    Costs::NanoSeconds compute_time;
+    Costs::NanoSeconds memory_time;
+    int64 temporary_memory;
+    int64 persistent_memory;
+  };
+
+  std::unordered_map<string, MeasuredCosts> measured_costs_;
+};
+
+// Reads an OpPerformanceList, in binary or text format, from `path`.
+Status ReadOpPerformanceList(const string& path,
+                             OpPerformanceList* measurements);
+
+// Returns the op level cost estimator used by default to simulate the
+// execution of graphs.  This is a MeasuredOpLevelCostEstimator if the
+// TF_GRAPPLER_OP_PERFORMANCE_DATA environment variable names a file with
+// measurements, and an OpLevelCostEstimator otherwise.
+std::unique_ptr<OpLevelCostEstimator> CreateDefaultOpLevelCostEstimator();
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_MEASURED_OP_LEVEL_COST_ESTIMATOR_H_
@@ -0,0 +1,96 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/measured_op_level_cost_estimator.h"
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Returns an OpInfo for a CPU MatMul of a m x l and a l x n matrix.
+OpInfo DescribeMatMul(int m, int n, int l) {
+  OpInfo op_info;
+  op_info.set_op("MatMul");
+  op_info.mutable_device()->set_type("CPU");
+  op_info.mutable_device()->set_num_cores(10);
+  op_info.mutable_device()->set_frequency(1000);
+  for (const auto& dims : {std::make_pair(m, l), std::make_pair(l, n)}) {
+    auto* input = op_info.add_inputs();
+    input->set_dtype(DT_FLOAT);
+    input->mutable_shape()->add_dim()->set_size(dims.first);
+    input->mutable_shape()->add_dim()->set_size(dims.second);
+  }
+  (*op_info.mutable_attr())["transpose_a"].set_b(false);
+  return op_info;
+}
+
+void AddMeasurement(const OpInfo& op_info, int64 compute_cost,
+                    OpPerformanceList* measurements) {
+  OpPerformance* perf = measurements->add_op_performance();
+  *perf->mutable_op() = op_info;
+  // Measurements only record the device type.
+  perf->mutable_op()->mutable_device()->clear_num_cores();
+  perf->mutable_op()->mutable_device()->clear_frequency();
+  (*perf->mutable_op()->mutable_attr())["_class"].set_s("loc:@x");
+  perf->set_compute_cost(compute_cost);
+  perf->mutable_op_memory()->set_temp_memory(64);
+}
+
+TEST(MeasuredOpLevelCostEstimatorTest, UsesMedianOfMeasurements) {
+  OpPerformanceList measurements;
+  AddMeasurement(DescribeMatMul(10, 10, 10), 300, &measurements);
+  AddMeasurement(DescribeMatMul(10, 10, 10), 100, &measurements);
+  AddMeasurement(DescribeMatMul(10, 10, 10), 200, &measurements);
+  MeasuredOpLevelCostEstimator estimator(measurements);
+  EXPECT_EQ(1, estimator.num_measured_ops());
+
+  OpContext op_context;
+  op_context.op_info = DescribeMatMul(10, 10, 10);
+  Costs costs = estimator.PredictCosts(op_context);
+  EXPECT_EQ(Costs::NanoSeconds(200), costs.execution_time);
+  EXPECT_EQ(Costs::NanoSeconds(200), costs.compute_time);
+  EXPECT_EQ(64, costs.temporary_memory);
+  EXPECT_FALSE(costs.inaccurate);
+}
+
+TEST(MeasuredOpLevelCostEstimatorTest, FallsBackToAnalyticalCosts) {
+  OpPerformanceList measurements;
+  AddMeasurement(DescribeMatMul(10, 10, 10), 200, &measurements);
+  MeasuredOpLevelCostEstimator estimator(measurements);
+  OpLevelCostEstimator analytical_estimator;
+
+  OpContext op_context;
+  op_context.op_info = DescribeMatMul(100, 10, 10);
+  EXPECT_EQ(analytical_estimator.PredictCosts(op_context).execution_time,
+            estimator.PredictCosts(op_context).execution_time);
+
+  op_context.op_info = DescribeMatMul(10, 10, 10);
+  (*op_context.op_info.mutable_attr())["transpose_a"].set_b(true);
+  EXPECT_EQ(analytical_estimator.PredictCosts(op_context).execution_time,
+            estimator.PredictCosts(op_context).execution_time);
+
+  op_context.op_info = DescribeMatMul(10, 10, 10);
+  op_context.op_info.mutable_device()->set_type("GPU");
+  EXPECT_EQ(analytical_estimator.PredictCosts(op_context).execution_time,
+            estimator.PredictCosts(op_context).execution_time);
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
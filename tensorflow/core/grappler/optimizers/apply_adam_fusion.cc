@@ -0,0 +1,208 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/apply_adam_fusion.h"
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kApplyAdam[] = "ResourceApplyAdam";
+constexpr char kApplyAdamMulti[] = "ResourceApplyAdamMulti";
+
+// Inputs of ResourceApplyAdam.
+constexpr int kVarInput = 0;
+constexpr int kMInput = 1;
+constexpr int kVInput = 2;
+constexpr int kFirstScalarInput = 3;  // beta1_power
+constexpr int kNumScalarInputs = 6;   // beta1_power, ..., epsilon
+constexpr int kGradInput = 9;
+constexpr int kNumInputs = 10;
+
+// Returns the key shared by the ResourceApplyAdam nodes that can be fused with
+// `node`, or an empty string if `node` cannot be fused.
+string FusionKey(const NodeDef& node) {
+  if (NumNonControlInputs(node) != kNumInputs) return "";
+  DataType dtype;
+  if (!TryGetNodeAttr(node, "T", &dtype)) return "";
+  bool use_locking = false;
+  TryGetNodeAttr(node, "use_locking", &use_locking);
+  bool use_nesterov = false;
+  TryGetNodeAttr(node, "use_nesterov", &use_nesterov);
+  string key = strings::StrCat(node.device(), ";", DataTypeString(dtype), ";",
+                               use_locking, ";", use_nesterov);
+  for (int i = kFirstScalarInput; i < kFirstScalarInput + kNumScalarInputs;
+       ++i) {
+    strings::StrAppend(&key, ";", node.input(i));
+  }
+  return key;
+}
+
+// Removes from `group` the nodes that depend on another node of `group`, given
+// the nodes of the graph in topological order.
+void RemoveDependentNodes(const std::vector<const NodeDef*>& topo_order,
+                          std::vector<const NodeDef*>* group) {
+  std::unordered_set<string> members;
+  for (const NodeDef* node : *group) members.insert(node->name());
+  // Nodes that depend on a member.
+  std::unordered_set<string> dependent;
+  for (const NodeDef* node : topo_order) {
+    for (const string& input : node->input()) {
+      const string input_node = NodeName(input);
+      if (members.count(input_node) || dependent.count(input_node)) {
+        dependent.insert(node->name());
+        break;
+      }
+    }
+  }
+  group->erase(std::remove_if(group->begin(), group->end(),
+                              [&](const NodeDef* node) {
+                                return dependent.count(node->name()) > 0;
+                              }),
+               group->end());
+}
+
+// Returns a ResourceApplyAdamMulti node that applies all of `group`.
+NodeDef MakeFusedNode(const std::vector<const NodeDef*>& group) {
+  const NodeDef& first = *group.front();
+  NodeDef fused;
+  fused.set_name(AddPrefixToNodeName(first.name(), "ApplyAdamFusion"));
+  fused.set_op(kApplyAdamMulti);
+  fused.set_device(first.device());
+  for (int input : {kVarInput, kMInput, kVInput}) {
+    for (const NodeDef* node : group) {
+      fused.add_input(node->input(input));
+    }
+  }
+  for (int i = kFirstScalarInput; i < kFirstScalarInput + kNumScalarInputs;
+       ++i) {
+    fused.add_input(first.input(i));
+  }
+  for (const NodeDef* node : group) {
+    fused.add_input(node->input(kGradInput));
+  }
+  std::set<string> control_inputs;
+  for (const NodeDef* node : group) {
+    for (int i = kNumInputs; i < node->input_size(); ++i) {
+      if (control_inputs.insert(node->input(i)).second) {
+        fused.add_input(node->input(i));
+      }
+    }
+  }
+
+  auto* attr = fused.mutable_attr();
+  (*attr)["N"].set_i(group.size());
+  (*attr)["T"] = first.attr().at("T");
+  bool use_locking = false;
+  TryGetNodeAttr(first, "use_locking", &use_locking);
+  (*attr)["use_locking"].set_b(use_locking);
+  bool use_nesterov = false;
+  TryGetNodeAttr(first, "use_nesterov", &use_nesterov);
+  (*attr)["use_nesterov"].set_b(use_nesterov);
+  return fused;
+}
+
+}  // namespace
+
+Status ApplyAdamFusion::Optimize(Cluster* cluster, const GrapplerItem& item,
+                                 GraphDef* optimized_graph) {
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+  // Ordered by key, so that the rewrite is deterministic.
+  std::map<string, std::vector<const NodeDef*>> groups;
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kApplyAdam || nodes_to_preserve.count(node.name())) {
+      continue;
+    }
+    const string key = FusionKey(node);
+    if (!key.empty()) groups[key].push_back(&node);
+  }
+  bool can_optimize = false;
+  for (const auto& group : groups) {
+    if (group.second.size() > 1) {
+      can_optimize = true;
+      break;
+    }
+  }
+  if (!can_optimize) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  std::vector<const NodeDef*> topo_order;
+  TF_RETURN_IF_ERROR(ComputeTopologicalOrder(item.graph, &topo_order));
+
+  *optimized_graph = item.graph;
+  // Name of each fused ResourceApplyAdam -> name of its ResourceApplyAdamMulti.
+  std::unordered_map<string, string> replaced_by;
+  for (auto& key_and_group : groups) {
+    std::vector<const NodeDef*>& group = key_and_group.second;
+    if (group.size() < 2) continue;
+    RemoveDependentNodes(topo_order, &group);
+    if (group.size() < 2) continue;
+    NodeDef fused = MakeFusedNode(group);
+    VLOG(2) << "Fusing " << group.size() << " " << kApplyAdam << " nodes into "
+            << fused.name();
+    for (const NodeDef* node : group) {
+      replaced_by[node->name()] = fused.name();
+    }
+    *optimized_graph->add_node() = std::move(fused);
+  }
+  if (replaced_by.empty()) {
+    return errors::Aborted("Nothing to do.");
+  }
+
+  // ResourceApplyAdam has no outputs, so the fused nodes only have control
+  // dependents.
+  for (NodeDef& node : *optimized_graph->mutable_node()) {
+    bool updated = false;
+    for (string& input : *node.mutable_input()) {
+      if (!IsControlInput(input)) continue;
+      auto it = replaced_by.find(NodeName(input));
+      if (it != replaced_by.end()) {
+        input = AsControlDependency(it->second);
+        updated = true;
+      }
+    }
+    if (updated) DedupControlInputs(&node);
+  }
+  std::set<string> nodes_to_delete;
+  for (const auto& replaced : replaced_by) {
+    nodes_to_delete.insert(replaced.first);
+  }
+  EraseNodesFromGraph(nodes_to_delete, optimized_graph);
+  return Status::OK();
+}
+
+void ApplyAdamFusion::Feedback(Cluster* cluster, const GrapplerItem& item,
+                               const GraphDef& optimized_graph, double result) {
+  // Takes no feedback.
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
@@ -0,0 +1,50 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_APPLY_ADAM_FUSION_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_APPLY_ADAM_FUSION_H_
+
+#include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
+#include "tensorflow/core/protobuf/rewriter_config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// ApplyAdamFusion replaces the ResourceApplyAdam nodes that share their scalar
+// inputs (beta1_power, beta2_power, lr, beta1, beta2 and epsilon), attributes
+// and device with a single ResourceApplyAdamMulti node, which updates all of
+// their variables in one kernel. Nodes that (transitively) depend on another
+// node of their group are left alone, so that fusing cannot create a cycle.
+class ApplyAdamFusion : public GraphOptimizer {
+ public:
+  ApplyAdamFusion() {}
+  explicit ApplyAdamFusion(RewriterConfig::Toggle opt_level) {}
+  ~ApplyAdamFusion() override {}
+
+  string name() const override { return "apply_adam_fusion"; };
+
+  bool UsesFunctionLibrary() const override { return false; }
+
+  Status Optimize(Cluster* cluster, const GrapplerItem& item,
+                  GraphDef* optimized_graph) override;
+
+  void Feedback(Cluster* cluster, const GrapplerItem& item,
+                const GraphDef& optimized_graph, double result) override;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_APPLY_ADAM_FUSION_H_
@@ -0,0 +1,189 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/apply_adam_fusion.h"
+
+#include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/utils/grappler_test.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+class ApplyAdamFusionTest : public GrapplerTest {
+ protected:
+  // Builds a graph that initializes `num_vars` variables "var<i>" and their
+  // slots, applies Adam to each of them with "apply<i>", and reads them back
+  // with "read<i>" after the NoOp "train". The last apply uses a different
+  // learning rate if `different_last_lr`.
+  void BuildAdamGraph(int num_vars, bool different_last_lr,
+                      GrapplerItem* item) {
+    Scope s = Scope::NewRootScope();
+    Output beta1_power = ops::Const(s.WithOpName("beta1_power"), 0.9f);
+    Output beta2_power = ops::Const(s.WithOpName("beta2_power"), 0.999f);
+    Output lr = ops::Const(s.WithOpName("lr"), 0.01f);
+    Output other_lr = ops::Const(s.WithOpName("other_lr"), 0.1f);
+    Output beta1 = ops::Const(s.WithOpName("beta1"), 0.9f);
+    Output beta2 = ops::Const(s.WithOpName("beta2"), 0.999f);
+    Output epsilon = ops::Const(s.WithOpName("epsilon"), 1e-7f);
+
+    std::vector<Output> vars;
+    std::vector<Operation> applies;
+    for (int i = 0; i < num_vars; ++i) {
+      const TensorShape shape({i + 2});
+      auto name = [i](const string& prefix) {
+        return strings::StrCat(prefix, i);
+      };
+      Output var = ops::VarHandleOp(s.WithOpName(name("var")), DT_FLOAT, shape);
+      Output m = ops::VarHandleOp(s.WithOpName(name("m")), DT_FLOAT, shape);
+      Output v = ops::VarHandleOp(s.WithOpName(name("v")), DT_FLOAT, shape);
+      Output init = ops::Const(s.WithOpName(name("init")), 1.0f + i, shape);
+      Output zeros = ops::Const(s.WithOpName(name("zeros")), 0.0f, shape);
+      auto assign_var =
+          ops::AssignVariableOp(s.WithOpName(name("assign_var")), var, init);
+      auto assign_m =
+          ops::AssignVariableOp(s.WithOpName(name("assign_m")), m, zeros);
+      auto assign_v =
+          ops::AssignVariableOp(s.WithOpName(name("assign_v")), v, zeros);
+      Output grad = ops::Const(s.WithOpName(name("grad")), 0.5f * i, shape);
+      auto apply = ops::ResourceApplyAdam(
+          s.WithOpName(name("apply"))
+              .WithControlDependencies({assign_var.operation,
+                                        assign_m.operation,
+                                        assign_v.operation}),
+          var, m, v, beta1_power, beta2_power,
+          different_last_lr && i == num_vars - 1 ? other_lr : lr, beta1, beta2,
+          epsilon, grad);
+      vars.push_back(var);
+      applies.push_back(apply.operation);
+    }
+    auto train =
+        ops::NoOp(s.WithOpName("train").WithControlDependencies(applies));
+    for (int i = 0; i < num_vars; ++i) {
+      const string read = strings::StrCat("read", i);
+      ops::ReadVariableOp(
+          s.WithOpName(read).WithControlDependencies({train.operation}),
+          vars[i], DT_FLOAT);
+      item->fetch.push_back(read);
+    }
+    TF_CHECK_OK(s.ToGraphDef(&item->graph));
+  }
+
+  const NodeDef* FindNode(const GraphDef& graph, const string& name) {
+    for (const NodeDef& node : graph.node()) {
+      if (node.name() == name) return &node;
+    }
+    return nullptr;
+  }
+
+  int CountOps(const GraphDef& graph, const string& op) {
+    int count = 0;
+    for (const NodeDef& node : graph.node()) {
+      if (node.op() == op) ++count;
+    }
+    return count;
+  }
+};
+
+TEST_F(ApplyAdamFusionTest, NothingToDoForSingleApply) {
+  GrapplerItem item;
+  BuildAdamGraph(/*num_vars=*/1, /*different_last_lr=*/false, &item);
+
+  ApplyAdamFusion optimizer;
+  GraphDef output;
+  EXPECT_EQ(optimizer.Optimize(nullptr, item, &output),
+            errors::Aborted("Nothing to do."));
+}
+
+TEST_F(ApplyAdamFusionTest, FusesAppliesWithSharedHyperparameters) {
+  GrapplerItem item;
+  BuildAdamGraph(/*num_vars=*/4, /*different_last_lr=*/true, &item);
+
+  ApplyAdamFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_EQ(CountOps(output, "ResourceApplyAdamMulti"), 1);
+  EXPECT_EQ(CountOps(output, "ResourceApplyAdam"), 1);
+  EXPECT_NE(FindNode(output, "apply3"), nullptr);
+
+  const NodeDef* fused = FindNode(output, "ApplyAdamFusion/apply0");
+  ASSERT_NE(fused, nullptr);
+  EXPECT_EQ(fused->attr().at("N").i(), 3);
+  EXPECT_EQ(fused->attr().at("T").type(), DT_FLOAT);
+  ASSERT_EQ(fused->input_size(), 3 * 3 + 6 + 3 + 9);
+  EXPECT_EQ(fused->input(0), "var0");
+  EXPECT_EQ(fused->input(2), "var2");
+  EXPECT_EQ(fused->input(3), "m0");
+  EXPECT_EQ(fused->input(6), "v0");
+  EXPECT_EQ(fused->input(9), "beta1_power");
+  EXPECT_EQ(fused->input(11), "lr");
+  EXPECT_EQ(fused->input(15), "grad0");
+  EXPECT_EQ(fused->input(17), "grad2");
+  EXPECT_EQ(fused->input(18)[0], '^');
+
+  const NodeDef* train = FindNode(output, "train");
+  ASSERT_NE(train, nullptr);
+  ASSERT_EQ(train->input_size(), 2);
+  EXPECT_EQ(train->input(0), "^ApplyAdamFusion/apply0");
+  EXPECT_EQ(train->input(1), "^apply3");
+
+  auto expected = EvaluateNodes(item.graph, item.fetch);
+  auto actual = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(expected.size(), 4);
+  ASSERT_EQ(actual.size(), 4);
+  for (int i = 0; i < 4; ++i) {
+    test::ExpectTensorNear<float>(expected[i], actual[i], 1e-6);
+  }
+}
+
+TEST_F(ApplyAdamFusionTest, DoesNotFuseDependentApplies) {
+  GrapplerItem item;
+  BuildAdamGraph(/*num_vars=*/3, /*different_last_lr=*/false, &item);
+  for (NodeDef& node : *item.graph.mutable_node()) {
+    if (node.name() == "apply1") node.add_input("^apply0");
+  }
+
+  ApplyAdamFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const NodeDef* fused = FindNode(output, "ApplyAdamFusion/apply0");
+  ASSERT_NE(fused, nullptr);
+  EXPECT_EQ(fused->attr().at("N").i(), 2);
+  EXPECT_EQ(fused->input(0), "var0");
+  EXPECT_EQ(fused->input(1), "var2");
+
+  const NodeDef* apply1 = FindNode(output, "apply1");
+  ASSERT_NE(apply1, nullptr);
+  EXPECT_EQ(apply1->input(apply1->input_size() - 1),
+            "^ApplyAdamFusion/apply0");
+
+  auto expected = EvaluateNodes(item.graph, item.fetch);
+  auto actual = EvaluateNodes(output, item.fetch);
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorNear<float>(expected[i], actual[i], 1e-6);
+  }
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
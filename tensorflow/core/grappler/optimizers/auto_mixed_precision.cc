@@ -37,6 +37,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/env_var.h"
 
@@ -52,6 +53,7 @@ const std::pair<int, int> kMinGPUArch = {0, 0};
 
 const char kSuffix[] = "AutoMixedPrecision";
 const char kCastToFp16[] = "CastToFp16";
+const char kCastToBf16[] = "CastToBf16";
 const char kCastToFp32[] = "CastToFp32";
 
 // Instances of this class represent unique type attribute identifiers within a
@@ -840,9 +842,11 @@ DataTypeSet AllowedDataTypes(const OpDef& op_def, const TypeAttrId& t_attr_id) {
   return AllowedDataTypes(*attr_def);
 }
 
-NodeDef BuildCastNode(const MutableGraphView::OutputPort& src, bool to_fp16,
-                      const string& device) {
-  const char* cast_string = to_fp16 ? kCastToFp16 : kCastToFp32;
+NodeDef BuildCastNode(const MutableGraphView::OutputPort& src, bool to_f16,
+                      DataType f16_type, const string& device) {
+  const char* cast_string =
+      !to_f16 ? kCastToFp32
+              : f16_type == DT_HALF ? kCastToFp16 : kCastToBf16;
   string name = strings::StrCat(src.node->name(), "-", src.port_id, "-",
                                 cast_string, "-", kSuffix);
   NodeDef node;
@@ -850,8 +854,8 @@ NodeDef BuildCastNode(const MutableGraphView::OutputPort& src, bool to_fp16,
   node.set_op("Cast");
   node.set_device(device);
   node.add_input(strings::StrCat(src.node->name(), ":", src.port_id));
-  (*node.mutable_attr())["SrcT"].set_type(to_fp16 ? DT_FLOAT : DT_HALF);
-  (*node.mutable_attr())["DstT"].set_type(to_fp16 ? DT_HALF : DT_FLOAT);
+  (*node.mutable_attr())["SrcT"].set_type(to_f16 ? DT_FLOAT : f16_type);
+  (*node.mutable_attr())["DstT"].set_type(to_f16 ? f16_type : DT_FLOAT);
   (*node.mutable_attr())["Truncate"].set_b(false);
   return node;
 }
@@ -941,7 +945,8 @@ class AutoMixedPrecisionImpl {
  public:
   AutoMixedPrecisionImpl(Cluster* cluster,
                          const std::unordered_set<string>& nodes_to_preserve,
-                         GraphDef* graph, string id)
+                         GraphDef* graph, string id,
+                         AutoMixedPrecisionMode mode)
       : virtual_placer_(cluster->GetDevices()),
         nodes_to_preserve_(nodes_to_preserve),
         graph_(graph),
@@ -949,7 +954,10 @@ class AutoMixedPrecisionImpl {
         id_(id),
         graph_view_(graph),
         cuda_version_(GetCudaVersion(*cluster)),
-        cudnn_version_(GetCudnnVersion(*cluster)) {}
+        cudnn_version_(GetCudnnVersion(*cluster)),
+        mode_(mode),
+        target_dtype_(mode_ == AutoMixedPrecisionMode::CUDA ? DT_HALF
+                                                            : DT_BFLOAT16) {}
 
   Status Optimize();
 
@@ -959,6 +967,7 @@ class AutoMixedPrecisionImpl {
   Status PrintDebugLogs(bool preop, size_t timestamp);
   void LogSkippedNode(const NodeDef& node) const;
   bool MustPreserve(const NodeDef& node) const;
+  bool IsOnDevice(const NodeDef& node, const string& device_type) const;
   bool IsOnGPU(const NodeDef& node) const;
   bool IsOnSuitableGPUArch(const NodeDef& node) const;
   bool ShouldProcess(const NodeDef& node) const;
@@ -1000,6 +1009,8 @@ class AutoMixedPrecisionImpl {
   MutableGraphView graph_view_;
   int cuda_version_;
   int cudnn_version_;
+  AutoMixedPrecisionMode mode_;
+  DataType target_dtype_;  // Either DT_HALF or DT_BFLOAT16.
   NodeTypeAttrMap node_type_map_;
   GraphTypeTopologyView graph_type_view_;
   bool force_all_fp16_;
@@ -1017,7 +1028,7 @@ bool AutoMixedPrecisionImpl::NodeHasFP16KernelForTypeAttr(
     string device_name = virtual_placer_.get_canonical_device_name(node);
     node_copy.set_device(device_name);
   }
-  if (!SetDataType(&node_copy, taid, DataType::DT_HALF)) {
+  if (!SetDataType(&node_copy, taid, target_dtype_)) {
     return false;
   }
   return IsKernelRegisteredForNode(node_copy).ok();
@@ -1079,8 +1090,9 @@ Status AutoMixedPrecisionImpl::PrintDebugLogs(bool preop, size_t timestamp) {
 void AutoMixedPrecisionImpl::LogSkippedNode(const NodeDef& node) const {
   VLOG(2) << "Skipping " << node.op() << " node " << node.name()
           << " because it "
-          << (MustPreserve(node)
-                  ? "must be preserved"
+          << (MustPreserve(node) ? "must be preserved"
+              : mode_ == AutoMixedPrecisionMode::CPU_BF16
+                  ? "is not on the CPU"
                   : "is not on the GPU, or the GPU arch is not suitable");
 }
 
@@ -1088,7 +1100,8 @@ bool AutoMixedPrecisionImpl::MustPreserve(const NodeDef& node) const {
   return nodes_to_preserve_.count(node.name());
 }
 
-bool AutoMixedPrecisionImpl::IsOnGPU(const NodeDef& node) const {
+bool AutoMixedPrecisionImpl::IsOnDevice(const NodeDef& node,
+                                        const string& device_type) const {
   string device_name;
   if (node.device().empty()) {
     device_name = virtual_placer_.get_canonical_device_name(node);
@@ -1099,12 +1112,16 @@ bool AutoMixedPrecisionImpl::IsOnGPU(const NodeDef& node) const {
   string not_used;
   if (DeviceNameUtils::SplitDeviceName(device_name, &not_used, &device) &&
       absl::StrContains(absl::AsciiStrToLower(device),
-                        absl::AsciiStrToLower(DEVICE_GPU))) {
+                        absl::AsciiStrToLower(device_type))) {
     return true;
   }
   return false;
 }
 
+bool AutoMixedPrecisionImpl::IsOnGPU(const NodeDef& node) const {
+  return IsOnDevice(node, DEVICE_GPU);
+}
+
 // Returns the GPU architecture (compute capability) as a (major, minor) pair.
 std::pair<int, int> GetDeviceGPUArch(
     const DeviceProperties& device_properties) {
@@ -1171,7 +1188,7 @@ bool AutoMixedPrecisionImpl::SupportsFloat16(
       OpRegistry::Global()->LookUpOpDef(node_type.node->op(), &op_def);
   if (!status.ok()) return false;
   return AllowedDataTypes(*op_def, node_type.type_attr)
-             .Contains(DataType::DT_HALF) &&
+             .Contains(target_dtype_) &&
          NodeHasFP16KernelForTypeAttr(*node_type.node, node_type.type_attr);
 }
 
@@ -1221,7 +1238,9 @@ Status AutoMixedPrecisionImpl::Optimize() {
   force_all_fp16_ = optimization_level == "UNSAFE_FORCE_ALL";
 
   fp16_whitelist_ =
-      AutoMixedPrecisionLists::WhiteList(cuda_version_, cudnn_version_);
+      mode_ == AutoMixedPrecisionMode::CPU_BF16
+          ? AutoMixedPrecisionLists::WhiteListCpu()
+          : AutoMixedPrecisionLists::WhiteList(cuda_version_, cudnn_version_);
   fp16_blacklist_ = AutoMixedPrecisionLists::BlackList();
   fp16_graylist_ = AutoMixedPrecisionLists::GrayList();
   fp16_clearlist_ = AutoMixedPrecisionLists::ClearList();
@@ -1233,8 +1252,12 @@ Status AutoMixedPrecisionImpl::Optimize() {
 
   VLOG(2) << "Identifying nodes that should be processed";
   for (const NodeDef& node : graph_->node()) {
-    if (!MustPreserve(node) && IsOnGPU(node) &&
-        (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node))) {
+    const bool is_suitable =
+        mode_ == AutoMixedPrecisionMode::CPU_BF16
+            ? IsOnDevice(node, DEVICE_CPU)
+            : IsOnGPU(node) &&
+                  (ShouldIgnorePerformance() || IsOnSuitableGPUArch(node));
+    if (!MustPreserve(node) && is_suitable) {
       should_process_nodes_.insert(&node);
     } else {
       LogSkippedNode(node);
@@ -1806,9 +1829,9 @@ void AutoMixedPrecisionImpl::MakeCastsWhiteIfAllOutputsWhite(
   }
 }
 
-// Changes all white-painted type attributes to DT_HALF, and inserts Cast nodes
-// at node outputs for all edges that connect white-painted <->
-// non-white-painted type attributes.
+// Changes all white-painted type attributes to DT_HALF (or DT_BFLOAT16 on the
+// CPU), and inserts Cast nodes at node outputs for all edges that connect
+// white-painted <-> non-white-painted type attributes.
 Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
     const absl::flat_hash_set<int>& white_set) {
   int num_nodes_changed = 0;
@@ -1829,8 +1852,9 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
       bool src_is_white = white_set.count(node_type_idx);
       if (src_is_white) {
         VLOG(1) << "Changing type " << type_attr.DebugString() << " of "
-                << node->op() << " node " << node->name() << " to DT_HALF";
-        if (!SetDataType(node, type_attr, DT_HALF)) {
+                << node->op() << " node " << node->name() << " to "
+                << DataTypeString(target_dtype_);
+        if (!SetDataType(node, type_attr, target_dtype_)) {
           return errors::Internal("Failed to set type attribute");
         }
         ++num_nodes_changed;
@@ -1857,11 +1881,13 @@ Status AutoMixedPrecisionImpl::ChangeTypeAttrsAndAddCasts(
             if (!added_cast_node) {
               bool to_fp16 = dst_is_white;
               VLOG(1) << "Inserting cast to "
-                      << (to_fp16 ? "DT_HALF" : "DT_FLOAT") << " at "
+                      << DataTypeString(to_fp16 ? target_dtype_ : DT_FLOAT)
+                      << " at "
                       << src.node->op() << " " << src.node->name() << ":"
                       << src.port_id;
               added_cast_node = graph_view_.AddNode(
-                  BuildCastNode(src, to_fp16, src.node->device()));
+                  BuildCastNode(src, to_fp16, target_dtype_,
+                                src.node->device()));
               if (to_fp16 && !IsConstant(*node) && !IsVariable(*node) &&
                   !NodeImplicitlyReadsNonResourceVariable(*node)) {
                 ++num_nonvar_casts_to_fp16;
@@ -1905,18 +1931,30 @@ Status AutoMixedPrecision::Optimize(Cluster* cluster, const GrapplerItem& item,
   // Start by copying input graph to output.
   *output = item.graph;
 
-  int num_gpus = ShouldIgnorePerformance() ? GetNumGPUs(*cluster)
-                                           : GetNumGPUs(*cluster, kMinGPUArch);
-  if (num_gpus < 1) {
-    // AutoMixedPrecision is currently only tuned for GPU.
-    LOG(WARNING) << "No (suitable) GPUs detected, skipping " << name()
-                 << " graph optimizer";
-    return Status::OK();
+  if (mode_ == AutoMixedPrecisionMode::CPU_BF16) {
+    // Without native bfloat16 instructions the conversions cost more than the
+    // bfloat16 kernels save.
+    if (!ShouldIgnorePerformance() &&
+        !port::TestCPUFeature(port::CPUFeature::AVX512_BF16)) {
+      VLOG(1) << "No native bfloat16 support on the CPU, skipping " << name()
+              << " graph optimizer";
+      return Status::OK();
+    }
+  } else {
+    int num_gpus = ShouldIgnorePerformance()
+                       ? GetNumGPUs(*cluster)
+                       : GetNumGPUs(*cluster, kMinGPUArch);
+    if (num_gpus < 1) {
+      // AutoMixedPrecision is currently only tuned for GPU.
+      LOG(WARNING) << "No (suitable) GPUs detected, skipping " << name()
+                   << " graph optimizer";
+      return Status::OK();
+    }
   }
 
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
-                                   item.id);
+                                   item.id, mode_);
   if (item.id == "tf_graph") {
     LOG(INFO) << "Running " << name() << " graph optimizer";
   } else {
@@ -22,16 +22,29 @@ limitations under the License.
 namespace tensorflow {
 namespace grappler {
 
-// Convert data types to float16 where appropriate to improve performance on
-// GPUs.
+enum class AutoMixedPrecisionMode {
+  // Converts to float16 for GPUs.
+  CUDA,
+  // Converts to bfloat16 for CPUs, which is only fast on CPUs with native
+  // bfloat16 support (AVX512_BF16).
+  CPU_BF16,
+};
+
+// Convert data types to float16 or bfloat16 where appropriate to improve
+// performance on GPUs or CPUs respectively.
 class AutoMixedPrecision : public GraphOptimizer {
  public:
   explicit AutoMixedPrecision(
-      RewriterConfig::Toggle opt_level = RewriterConfig::ON) {}
+      AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA)
+      : mode_(mode) {}
 
   ~AutoMixedPrecision() override {}
 
-  string name() const override { return "auto_mixed_precision"; };
+  string name() const override {
+    return mode_ == AutoMixedPrecisionMode::CPU_BF16
+               ? "auto_mixed_precision_cpu"
+               : "auto_mixed_precision";
+  };
 
   bool UsesFunctionLibrary() const override { return false; }
 
@@ -40,6 +53,9 @@ class AutoMixedPrecision : public GraphOptimizer {
 
   void Feedback(Cluster* cluster, const GrapplerItem& item,
                 const GraphDef& optimize_output, double result) override;
+
+ private:
+  const AutoMixedPrecisionMode mode_;
 };
 
 }  // end namespace grappler
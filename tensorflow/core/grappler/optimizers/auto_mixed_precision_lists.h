@@ -98,6 +98,34 @@ class AutoMixedPrecisionLists {
     return list;
   }
 
+  // Returns the set of ops that are always converted to bfloat16 when mixed
+  // precision targets the CPU. Only ops whose bfloat16 CPU kernels are at least
+  // as fast as their fp32 counterparts are listed; the gray and clear lists are
+  // shared with the GPU mode.
+  static gtl::FlatSet<string> WhiteListCpu() {
+    string to_add, to_remove;
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_WHITELIST_ADD", "", &to_add));
+    TF_CHECK_OK(ReadStringFromEnvVar(
+        "TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_WHITELIST_REMOVE", "",
+        &to_remove));
+
+    auto list = gtl::FlatSet<string>{
+        "BatchMatMul",
+        "BatchMatMulV2",
+        "Conv2D",
+        "Conv2DBackpropFilter",
+        "Conv2DBackpropInput",
+        "Conv3D",
+        "Conv3DBackpropFilterV2",
+        "Conv3DBackpropInputV2",
+        "Einsum",
+        "MatMul",
+    };
+    UpdateList(&list, to_add, to_remove);
+    return list;
+  }
+
   // Returns the set of ops that are considered numerically-safe (for execution
   // in fp16), but which may be made unsafe by an upstream blacklist op.
   static gtl::FlatSet<string> GrayList() {
@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -1308,6 +1309,14 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     }
   });
 
+  // The fingerprint of the evaluation: the op and its attributes, followed
+  // by the value of each input.
+  NodeDef op_and_attrs;
+  op_and_attrs.set_op(node.op());
+  *op_and_attrs.mutable_attr() = node.attr();
+  string evaluation;
+  SerializeToStringDeterministic(op_and_attrs, &evaluation);
+
   size_t total_inputs_size = 0;
   for (const auto& input : node.input()) {
     const TensorId input_tensor = ParseTensorName(input);
@@ -1327,11 +1336,38 @@ Status ConstantFolding::EvaluateOneFoldable(const NodeDef& node,
     CHECK(value->FromProto(raw_val));
     inputs.emplace_back(value);
     total_inputs_size += value->TotalBytes();
+    string serialized_value;
+    SerializeToStringDeterministic(raw_val, &serialized_value);
+    strings::StrAppend(&evaluation, serialized_value.size(), ":",
+                       serialized_value);
   }
 
-  TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
-  if (output_tensors.empty()) {
-    return Status(error::INVALID_ARGUMENT, "Expected at least one output.");
+  const Fprint128 fingerprint = Fingerprint128(evaluation);
+  auto folded = folded_tensors_.find(fingerprint);
+  if (folded != folded_tensors_.end()) {
+    for (const Tensor& tensor : folded->second) {
+      output_tensors.emplace_back(new Tensor(tensor));
+    }
+  } else {
+    TF_RETURN_IF_ERROR(EvaluateNode(node, inputs, &output_tensors));
+    if (output_tensors.empty()) {
+      return Status(error::INVALID_ARGUMENT, "Expected at least one output.");
+    }
+    // Dead outputs can't be memoized, and outputs that are too large to fold
+    // aren't worth keeping.
+    bool memoize = true;
+    for (const auto& output : output_tensors) {
+      if (output.tensor == nullptr ||
+          output.tensor->TotalBytes() > kMaxConstantSize) {
+        memoize = false;
+      }
+    }
+    if (memoize) {
+      std::vector<Tensor>& tensors = folded_tensors_[fingerprint];
+      for (const auto& output : output_tensors) {
+        tensors.push_back(*output.tensor);
+      }
+    }
   }
 
   outputs->resize(output_tensors.size());
@@ -3802,6 +3838,7 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
 
   has_fetch_ = !item.fetch.empty();
+  folded_tensors_.clear();
   GrapplerItem item_to_optimize = item;
   *optimized_graph = GraphDef();
   item_to_optimize.graph.Swap(optimized_graph);
@@ -3815,6 +3852,7 @@ Status ConstantFolding::Optimize(Cluster* cluster, const GrapplerItem& item,
     TF_RETURN_IF_ERROR(
         RunOptimizationPass(cluster, &item_to_optimize, optimized_graph));
   } while (graph_modified_ || optimized_graph->node_size() != node_count);
+  folded_tensors_.clear();
   *optimized_graph->mutable_library() = item.graph.library();
   *optimized_graph->mutable_versions() = item.graph.versions();
 
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 
 namespace tensorflow {
@@ -317,6 +318,11 @@ class ConstantFolding : public GraphOptimizer {
   absl::flat_hash_set<string> nodes_whitelist_;
   absl::flat_hash_set<string> feed_nodes_;
   absl::flat_hash_map<string, bool> maybe_foldable_nodes_;
+  // The outputs of the nodes folded so far, keyed by a fingerprint of their op,
+  // attributes and input values, so that identical subgraphs (e.g. the shape
+  // computations of repeated layers) are evaluated only once.
+  absl::flat_hash_map<Fprint128, std::vector<Tensor>, Fprint128Hasher>
+      folded_tensors_;
   bool has_fetch_;
   bool graph_modified_;
   bool graph_contains_assign_or_inplace_op_;
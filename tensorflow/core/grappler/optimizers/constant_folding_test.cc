@@ -253,6 +253,43 @@ TEST_F(ConstantFoldingTest, SimpleFolding) {
   test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, IdenticalSubgraphs) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // c1 and c2 compute the same value, so the second one is memoized; c3
+  // differs from them only in an input value.
+  Output a1 = ops::Const(s.WithOpName("a1"), {1.0f, 2.0f}, {2});
+  Output b1 = ops::Const(s.WithOpName("b1"), {3.0f, 4.0f}, {2});
+  Output c1 = ops::Mul(s.WithOpName("c1"), a1, b1);
+  Output a2 = ops::Const(s.WithOpName("a2"), {1.0f, 2.0f}, {2});
+  Output b2 = ops::Const(s.WithOpName("b2"), {3.0f, 4.0f}, {2});
+  Output c2 = ops::Mul(s.WithOpName("c2"), a2, b2);
+  Output b3 = ops::Const(s.WithOpName("b3"), {3.0f, 5.0f}, {2});
+  Output c3 = ops::Mul(s.WithOpName("c3"), a1, b3);
+
+  GrapplerItem item;
+  item.fetch = {"c1", "c2", "c3"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  Status status = optimizer.Optimize(/*cluster=*/nullptr, item, &output);
+  TF_EXPECT_OK(status);
+
+  EXPECT_EQ(3, output.node_size());
+  for (const NodeDef& node : output.node()) {
+    EXPECT_EQ("Const", node.op());
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  EXPECT_EQ(3, tensors_expected.size());
+  EXPECT_EQ(3, tensors.size());
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorEqual<float>(tensors_expected[i], tensors[i]);
+  }
+}
+
 TEST_F(ConstantFoldingTest, AddTree) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
 
@@ -21,6 +21,8 @@ limitations under the License.
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/mutable_graph_view.h"
@@ -38,6 +40,8 @@ namespace {
 constexpr char kShardDatasetOpName[] = "ShardDataset";
 constexpr char kShuffleDatasetOpName[] = "ShuffleDataset";
 constexpr char kShuffleDatasetV2OpName[] = "ShuffleDatasetV2";
+constexpr char kTFRecordDatasetOpName[] = "TFRecordDataset";
+constexpr char kShardedTFRecordDatasetOpName[] = "_ShardedTFRecordDataset";
 
 constexpr char kNumWorkersAttrName[] = "num_workers";
 constexpr char kIndexAttrName[] = "index";
@@ -188,6 +192,45 @@ Status AddShardNode(MutableGraphView* graph, const NodeDef& add_before,
   return Status::OK();
 }
 
+// Returns true if `node` is a TFRecordDataset that reads a constant list of
+// fewer uncompressed files than there are workers, so that sharding by file
+// would leave some workers without data.
+bool ShouldShardRecordRanges(const NodeDef& node, const MutableGraphView& graph,
+                             int64 num_workers) {
+  if (node.op() != kTFRecordDatasetOpName) return false;
+  const NodeDef* filenames_node = graph_utils::GetInputNode(node, graph, 0);
+  const NodeDef* compression_node = graph_utils::GetInputNode(node, graph, 1);
+  if (filenames_node == nullptr || compression_node == nullptr ||
+      !IsConstant(*filenames_node) || !IsConstant(*compression_node)) {
+    return false;
+  }
+  Tensor filenames;
+  Tensor compression_type;
+  if (!GetNodeAttr(*filenames_node, "value", &filenames).ok() ||
+      !GetNodeAttr(*compression_node, "value", &compression_type).ok()) {
+    return false;
+  }
+  return filenames.NumElements() < num_workers &&
+         compression_type.dtype() == DT_STRING &&
+         compression_type.NumElements() == 1 &&
+         compression_type.flat<tstring>()(0).empty();
+}
+
+// Replaces the TFRecordDataset `node` with a _ShardedTFRecordDataset that
+// reads the records that start in the `index`-th of `num_workers` byte ranges
+// of each file, so that each worker reads 1/num_workers of every file instead
+// of reading all of them and discarding most of the records.
+Status ShardRecordRanges(MutableGraphView* graph, const NodeDef& node,
+                         int64 num_workers, int64 index) {
+  NodeDef* num_shards_node =
+      graph_utils::AddScalarConstNode<int64>(num_workers, graph);
+  NodeDef* index_node = graph_utils::AddScalarConstNode<int64>(index, graph);
+  graph->GetNode(node.name())->set_op(kShardedTFRecordDatasetOpName);
+  TF_RETURN_IF_ERROR(
+      graph->AddRegularFanin(node.name(), {num_shards_node->name(), 0}));
+  return graph->AddRegularFanin(node.name(), {index_node->name(), 0});
+}
+
 Status AddShuffleNode(MutableGraphView* graph, const NodeDef& add_before,
                       const string& buffer_size_node, const string& seed_node,
                       const string& seed2_node, bool reshuffle_each_iteration) {
@@ -368,6 +411,9 @@ Status RecursivelyHandleOp(const NodeDef& node, int64 num_workers, int64 index,
   }
 
   if (IsDatasetNodeOfType(node, kReaderDatasetOps)) {
+    if (ShouldShardRecordRanges(node, *graph, num_workers)) {
+      return ShardRecordRanges(graph, node, num_workers, index);
+    }
     // We reached a reader dataset directly and we try to shard input 0.
     return ProcessDatasetSourceNode(graph, node, nodes_to_delete, num_workers,
                                     index);
@@ -0,0 +1,127 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_batch_prefetch_fusion.h"
+
+#include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+#include "tensorflow/core/lib/gtl/map_util.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kFusedOpName[] = "ParallelMapBatchPrefetchDataset";
+constexpr char kMapAndBatch[] = "MapAndBatchDataset";
+constexpr char kExperimentalMapAndBatch[] = "ExperimentalMapAndBatchDataset";
+constexpr char kPrefetch[] = "PrefetchDataset";
+
+bool IsMapAndBatch(const NodeDef& node) {
+  return node.op() == kMapAndBatch || node.op() == kExperimentalMapAndBatch;
+}
+
+// Returns true if `prefetch_node` uses slack, which the fused op does not
+// support.
+bool HasSlack(const NodeDef& prefetch_node) {
+  const AttrValue* slack_period =
+      gtl::FindOrNull(prefetch_node.attr(), "slack_period");
+  return slack_period != nullptr && slack_period->i() > 0;
+}
+
+NodeDef MakeMapBatchPrefetchNode(const NodeDef& map_and_batch_node,
+                                 const NodeDef& prefetch_node,
+                                 MutableGraphView* graph) {
+  NodeDef new_node;
+  new_node.set_op(kFusedOpName);
+  graph_utils::SetUniqueGraphNodeName(kFusedOpName, graph->graph(), &new_node);
+
+  // The fused op takes the inputs of MapAndBatchDataset, followed by the
+  // `buffer_size` of the prefetch.
+  for (const string& input : map_and_batch_node.input()) {
+    if (IsControlInput(input)) continue;
+    new_node.add_input(input);
+  }
+  new_node.add_input(prefetch_node.input(1));
+  for (const string& input : map_and_batch_node.input()) {
+    if (IsControlInput(input)) new_node.add_input(input);
+  }
+
+  for (auto key : {"f", "Targuments", "output_shapes", "output_types"}) {
+    graph_utils::CopyAttribute(key, map_and_batch_node, &new_node);
+  }
+  if (gtl::FindOrNull(map_and_batch_node.attr(), "preserve_cardinality")) {
+    graph_utils::CopyAttribute("preserve_cardinality", map_and_batch_node,
+                               &new_node);
+  }
+
+  return new_node;
+}
+
+}  // namespace
+
+Status MapBatchPrefetchFusion::OptimizeAndCollectStats(
+    Cluster* cluster, const GrapplerItem& item, GraphDef* output,
+    OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kPrefetch || HasSlack(node)) continue;
+
+    // Use a more descriptive variable name now that we know the node type.
+    const NodeDef& prefetch_node = node;
+    NodeDef* map_and_batch_node =
+        graph_utils::GetInputNode(prefetch_node, graph);
+    // The batches of the fused op can only be consumed by the prefetch.
+    if (map_and_batch_node == nullptr || !IsMapAndBatch(*map_and_batch_node) ||
+        graph.NumFanouts(*map_and_batch_node,
+                         /*include_controlled_nodes=*/true) != 1) {
+      continue;
+    }
+
+    auto* new_node = graph.AddNode(
+        MakeMapBatchPrefetchNode(*map_and_batch_node, prefetch_node, &graph));
+    TF_RETURN_IF_ERROR(
+        graph.UpdateFanouts(prefetch_node.name(), new_node->name()));
+
+    // Mark the `MapAndBatch` and `Prefetch` nodes for removal.
+    nodes_to_delete.insert(map_and_batch_node->name());
+    nodes_to_delete.insert(prefetch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return Status::OK();
+}
+
+void MapBatchPrefetchFusion::Feedback(Cluster* cluster,
+                                      const GrapplerItem& item,
+                                      const GraphDef& optimize_output,
+                                      double result) {
+  // no-op
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapBatchPrefetchFusion,
+                            "map_batch_prefetch_fusion");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,111 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/data/map_batch_prefetch_fusion.h"
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using test::function::NDef;
+
+std::vector<NodeDef> MapAndBatchPrefetchNodes(int64 slack_period) {
+  return {
+      NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT32}}),
+      NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT32}}),
+      NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT32}}),
+      NDef("range", "RangeDataset", {"start", "stop", "step"}, {}),
+      NDef("batch_size", "Const", {}, {{"value", 2}, {"dtype", DT_INT64}}),
+      NDef("num_parallel_calls", "Const", {},
+           {{"value", 2}, {"dtype", DT_INT64}}),
+      NDef("drop_remainder", "Const", {},
+           {{"value", false}, {"dtype", DT_BOOL}}),
+      graph_tests_utils::MakeMapAndBatchNode(
+          "map_and_batch", "range", "batch_size", "num_parallel_calls",
+          "drop_remainder"),
+      NDef("buffer_size", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+      NDef("prefetch", "PrefetchDataset", {"map_and_batch", "buffer_size"},
+           {{"output_shapes", gtl::ArraySlice<TensorShape>{}},
+            {"output_types", gtl::ArraySlice<DataType>{}},
+            {"slack_period", slack_period}}),
+  };
+}
+
+TEST(MapBatchPrefetchFusionTest, FuseMapAndBatchWithPrefetch) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(MapAndBatchPrefetchNodes(0),
+                                    {test::function::XTimesTwo()});
+
+  MapBatchPrefetchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map_and_batch", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("prefetch", output));
+  ASSERT_TRUE(graph_utils::ContainsNodeWithOp("ParallelMapBatchPrefetchDataset",
+                                              output));
+
+  const NodeDef& fused_node = output.node(graph_utils::FindGraphNodeWithOp(
+      "ParallelMapBatchPrefetchDataset", output));
+  ASSERT_EQ(fused_node.input_size(), 5);
+  EXPECT_EQ(fused_node.input(0), "range");
+  EXPECT_EQ(fused_node.input(1), "batch_size");
+  EXPECT_EQ(fused_node.input(2), "num_parallel_calls");
+  EXPECT_EQ(fused_node.input(3), "drop_remainder");
+  EXPECT_EQ(fused_node.input(4), "buffer_size");
+  EXPECT_EQ(fused_node.attr().at("f").func().name(), "XTimesTwo");
+}
+
+TEST(MapBatchPrefetchFusionTest, DoNotFuseWithSlack) {
+  GrapplerItem item;
+  item.graph = test::function::GDef(MapAndBatchPrefetchNodes(1),
+                                    {test::function::XTimesTwo()});
+
+  MapBatchPrefetchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map_and_batch", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("prefetch", output));
+  EXPECT_FALSE(graph_utils::ContainsNodeWithOp(
+      "ParallelMapBatchPrefetchDataset", output));
+}
+
+TEST(MapBatchPrefetchFusionTest, DoNotFuseSharedMapAndBatch) {
+  GrapplerItem item;
+  std::vector<NodeDef> nodes = MapAndBatchPrefetchNodes(0);
+  nodes.push_back(NDef("take_count", "Const", {},
+                       {{"value", 1}, {"dtype", DT_INT64}}));
+  nodes.push_back(NDef("take", "TakeDataset", {"map_and_batch", "take_count"},
+                       {}));
+  item.graph = test::function::GDef(nodes, {test::function::XTimesTwo()});
+
+  MapBatchPrefetchFusion optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map_and_batch", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("prefetch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -37,7 +37,7 @@ using ConfigMap =
     std::map<string, tensorflow::RewriterConfig_CustomGraphOptimizer>;
 
 // tf.data optimizations, in the order we want to perform them.
-constexpr std::array<const char*, 16> kTFDataOptimizations = {
+constexpr std::array<const char*, 17> kTFDataOptimizations = {
     "make_stateless",
     "noop_elimination",
     "shuffle_and_repeat_fusion",
@@ -53,7 +53,8 @@ constexpr std::array<const char*, 16> kTFDataOptimizations = {
     "make_sloppy",
     "parallel_batch",
     "slack",
-    "inject_prefetch"};
+    "inject_prefetch",
+    "map_batch_prefetch_fusion"};
 
 // Standard grappler optimizations, in the order we want to perform them.
 constexpr std::array<const char*, 5> kGrapplerOptimizations = {
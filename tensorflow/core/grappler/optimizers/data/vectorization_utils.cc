@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/data/function_utils.h"
 #include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
 #include "tensorflow/core/grappler/utils.h"
@@ -640,6 +641,16 @@ Status VectorizeMapDefun(const FunctionDef& outer_scope,
   return Vectorization(lib).Vectorize(outer_scope, map_defun_node, result);
 }
 
+namespace {
+
+// Lets the loop optimizer vectorize map loops with the same converters.
+const bool kMapDefunVectorizerRegistered = [] {
+  RegisterMapDefunVectorizer(VectorizeMapDefun);
+  return true;
+}();
+
+}  // namespace
+
 }  // namespace vectorization_utils
 }  // namespace grappler
 }  // namespace tensorflow
@@ -18,19 +18,27 @@ limitations under the License.
 #include <algorithm>
 #include <deque>
 #include <limits>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/graph_to_functiondef.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph_constructor.h"
 #include "tensorflow/core/grappler/graph_topology_view.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/mutable_graph_view.h"
@@ -38,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -714,8 +723,587 @@ Status CheckForDeadFanout(const MutableGraphView& view,
   return Status::OK();
 }
 
+MapDefunVectorizerFn* RegisteredMapDefunVectorizer() {
+  static MapDefunVectorizerFn vectorizer = nullptr;
+  return &vectorizer;
+}
+
+// A bound of the counters of a loop: either a constant, or a tensor computed
+// outside of the loop.
+struct LoopBound {
+  bool is_constant = false;
+  int64 value = 0;
+  string tensor;
+
+  bool operator==(const LoopBound& other) const {
+    return is_constant == other.is_constant &&
+           (is_constant ? value == other.value : tensor == other.tensor);
+  }
+};
+
+// A functional While loop that maps a computation over the elements of some
+// TensorLists and collects the results in other TensorLists, like the loops
+// created by tf.map_fn. Its iterations are independent of each other.
+struct MapLoop {
+  enum VarKind { kInvariant, kCounter, kAccumulator };
+
+  // How each loop variable evolves: counters start at 0 and are incremented
+  // by 1, invariants are passed through unchanged, and accumulators get the
+  // result of an iteration stored at the index of a counter.
+  std::vector<VarKind> var_kinds;
+  // The number of iterations, which is also the size of the accumulators.
+  LoopBound num_iterations;
+  // The part of the loop body computing the results of a single iteration,
+  // with an _Arg for each element read from a list, followed by an _Arg for
+  // each captured invariant, and a _Retval for each accumulator.
+  GraphDef iteration_body;
+  // The loop variables holding the lists read by the element _Args, the
+  // invariants read by the captured _Args, and the accumulators in _Retval
+  // order.
+  std::vector<int> element_vars;
+  std::vector<int> captured_vars;
+  std::vector<int> accumulator_vars;
+};
+
+// Returns the tensor forwarded to `tensor` through a chain of Identity nodes.
+string SkipIdentities(const NodeMap& node_map, string tensor) {
+  const NodeDef* node = node_map.GetNode(tensor);
+  while (node != nullptr && IsIdentity(*node) && node->input_size() > 0 &&
+         !IsControlInput(node->input(0))) {
+    tensor = node->input(0);
+    node = node_map.GetNode(tensor);
+  }
+  return tensor;
+}
+
+// Returns true if `node` is a scalar integer constant, and sets `value` to
+// its value.
+bool GetScalarIntConstant(const NodeDef& node, int64* value) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) return false;
+  Tensor tensor;
+  if (!tensor.FromProto(node.attr().at("value").tensor()) ||
+      !TensorShapeUtils::IsScalar(tensor.shape())) {
+    return false;
+  }
+  if (tensor.dtype() == DT_INT32) {
+    *value = tensor.scalar<int32>()();
+  } else if (tensor.dtype() == DT_INT64) {
+    *value = tensor.scalar<int64>()();
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns the index of the function argument that `tensor` forwards in a
+// function body, or -1 if it does not forward an argument.
+int ArgIndex(const NodeMap& node_map, const string& tensor) {
+  const NodeDef* node = node_map.GetNode(SkipIdentities(node_map, tensor));
+  if (node == nullptr || node->op() != "_Arg" ||
+      node->attr().count("index") == 0) {
+    return -1;
+  }
+  return node->attr().at("index").i();
+}
+
+// Returns the loop bound given by `tensor` outside of the loop.
+LoopBound OuterLoopBound(const NodeMap& node_map,
+                         const absl::flat_hash_set<string>& feed_nodes,
+                         const string& tensor) {
+  LoopBound bound;
+  const TensorId id = ParseTensorName(SkipIdentities(node_map, tensor));
+  bound.tensor = absl::StrCat(id.node(), ":", id.index());
+  const NodeDef* node = node_map.GetNode(bound.tensor);
+  bound.is_constant = node != nullptr && IsReallyConstant(*node, feed_nodes) &&
+                      GetScalarIntConstant(*node, &bound.value);
+  return bound;
+}
+
+// Checks whether `loop` is a map loop, and if so describes it in `map_loop`.
+// Returns an error explaining why otherwise.
+Status AnalyzeMapLoop(const NodeDef& loop, const NodeMap& node_map,
+                      const absl::flat_hash_set<string>& feed_nodes,
+                      const FunctionLibraryDefinition& flib,
+                      int graph_def_version, MapLoop* map_loop) {
+  DataTypeVector types;
+  NameAttrList cond_fn;
+  NameAttrList body_fn;
+  TF_RETURN_IF_ERROR(GetNodeAttr(loop, "T", &types));
+  TF_RETURN_IF_ERROR(GetNodeAttr(loop, "cond", &cond_fn));
+  TF_RETURN_IF_ERROR(GetNodeAttr(loop, "body", &body_fn));
+  const FunctionDef* cond_def = flib.Find(cond_fn.name());
+  const FunctionDef* body_def = flib.Find(body_fn.name());
+  if (cond_def == nullptr || body_def == nullptr) {
+    return errors::NotFound("Functions of the loop not found");
+  }
+  GrapplerFunctionItem cond;
+  GrapplerFunctionItem body;
+  TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(
+      *cond_def, AttrSlice(&cond_fn.attr()), flib, graph_def_version, &cond));
+  TF_RETURN_IF_ERROR(MakeGrapplerFunctionItem(
+      *body_def, AttrSlice(&body_fn.attr()), flib, graph_def_version, &body));
+  const int num_vars = types.size();
+  if (loop.input_size() < num_vars || cond.input_size() != num_vars ||
+      cond.output_size() != 1 || body.input_size() != num_vars ||
+      body.output_size() != num_vars) {
+    return errors::InvalidArgument("Functions do not match the loop");
+  }
+
+  // Classify the loop variables by how the body updates them.
+  const NodeMap body_map(&body.graph);
+  std::vector<MapLoop::VarKind>& var_kinds = map_loop->var_kinds;
+  var_kinds.assign(num_vars, MapLoop::kInvariant);
+  std::vector<const NodeDef*> set_items(num_vars, nullptr);
+  for (int i = 0; i < num_vars; ++i) {
+    const NodeDef* retval = body_map.GetNode(body.output(i).node_name);
+    if (retval == nullptr || retval->input_size() < 1) {
+      return errors::Internal("Missing output ", i, " of the loop body");
+    }
+    const NodeDef* update =
+        body_map.GetNode(SkipIdentities(body_map, retval->input(0)));
+    if (ArgIndex(body_map, retval->input(0)) == i) continue;
+
+    int64 value;
+    const auto is_constant = [&body_map, &value](const string& tensor) {
+      const NodeDef* node = body_map.GetNode(SkipIdentities(body_map, tensor));
+      return node != nullptr && GetScalarIntConstant(*node, &value);
+    };
+    const NodeDef* init = node_map.GetNode(SkipIdentities(node_map,
+                                                          loop.input(i)));
+    if (update != nullptr && IsAdd(*update) &&
+        ArgIndex(body_map, update->input(0)) == i &&
+        is_constant(update->input(1)) && value == 1 && init != nullptr &&
+        IsReallyConstant(*init, feed_nodes) &&
+        GetScalarIntConstant(*init, &value) && value == 0) {
+      var_kinds[i] = MapLoop::kCounter;
+    } else if (update != nullptr && update->op() == "TensorListSetItem" &&
+               ArgIndex(body_map, update->input(0)) == i) {
+      var_kinds[i] = MapLoop::kAccumulator;
+      set_items[i] = update;
+      map_loop->accumulator_vars.push_back(i);
+    } else {
+      return errors::Unimplemented("Loop variable ", i,
+                                   " is not a counter, an invariant or an "
+                                   "accumulator");
+    }
+  }
+  if (map_loop->accumulator_vars.empty()) {
+    return errors::Unimplemented("Loop does not accumulate results");
+  }
+
+  // Every accumulator must only be written at the index of a counter.
+  for (int i : map_loop->accumulator_vars) {
+    const int index_var = ArgIndex(body_map, set_items[i]->input(1));
+    if (index_var < 0 || var_kinds[index_var] != MapLoop::kCounter) {
+      return errors::Unimplemented("Accumulator ", i,
+                                   " is not indexed by a counter");
+    }
+    std::vector<string> forwards = {body.input(i).node_name};
+    while (!forwards.empty()) {
+      const string name = forwards.back();
+      forwards.pop_back();
+      for (const NodeDef* fanout : body_map.GetOutputs(name)) {
+        if (IsIdentity(*fanout)) {
+          forwards.push_back(fanout->name());
+        } else if (fanout != set_items[i]) {
+          return errors::Unimplemented("Accumulator ", i, " is read by ",
+                                       fanout->name());
+        }
+      }
+    }
+  }
+
+  // The loop must run until all counters reach the same bound.
+  const NodeMap cond_map(&cond.graph);
+  const NodeDef* cond_retval = cond_map.GetNode(cond.output(0).node_name);
+  if (cond_retval == nullptr || cond_retval->input_size() < 1) {
+    return errors::Internal("Missing output of the loop condition");
+  }
+  std::vector<LoopBound> bounds;
+  std::vector<string> conditions = {cond_retval->input(0)};
+  while (!conditions.empty()) {
+    const NodeDef* condition =
+        cond_map.GetNode(SkipIdentities(cond_map, conditions.back()));
+    conditions.pop_back();
+    if (condition != nullptr && IsLogicalAnd(*condition)) {
+      conditions.push_back(condition->input(0));
+      conditions.push_back(condition->input(1));
+      continue;
+    }
+    const int counter_var = condition != nullptr && IsLess(*condition)
+                                ? ArgIndex(cond_map, condition->input(0))
+                                : -1;
+    if (counter_var < 0 || var_kinds[counter_var] != MapLoop::kCounter) {
+      return errors::Unimplemented("Unsupported loop condition");
+    }
+    const int bound_var = ArgIndex(cond_map, condition->input(1));
+    const NodeDef* bound_node =
+        cond_map.GetNode(SkipIdentities(cond_map, condition->input(1)));
+    LoopBound bound;
+    if (bound_var >= 0 && var_kinds[bound_var] == MapLoop::kInvariant) {
+      bound = OuterLoopBound(node_map, feed_nodes, loop.input(bound_var));
+    } else if (bound_node != nullptr &&
+               GetScalarIntConstant(*bound_node, &bound.value)) {
+      bound.is_constant = true;
+    } else {
+      return errors::Unimplemented("Loop bound is not loop invariant");
+    }
+    if (!bounds.empty() && !(bound == bounds.front())) {
+      return errors::Unimplemented("Loop counters have different bounds");
+    }
+    bounds.push_back(bound);
+  }
+  map_loop->num_iterations = bounds.front();
+  DataType index_type = DT_INVALID;
+  for (int i = 0; i < num_vars; ++i) {
+    if (var_kinds[i] != MapLoop::kCounter) continue;
+    if (index_type != DT_INVALID && types[i] != index_type) {
+      return errors::Unimplemented("Loop counters have different types");
+    }
+    index_type = types[i];
+  }
+
+  // The accumulators must hold one element per iteration.
+  for (int i : map_loop->accumulator_vars) {
+    const NodeDef* reserve =
+        node_map.GetNode(SkipIdentities(node_map, loop.input(i)));
+    if (reserve == nullptr || reserve->op() != "TensorListReserve" ||
+        !(OuterLoopBound(node_map, feed_nodes, reserve->input(1)) ==
+          map_loop->num_iterations)) {
+      return errors::Unimplemented("Accumulator ", i,
+                                   " does not hold one result per iteration");
+    }
+  }
+
+  // Extract the computation of the results of an iteration, which must only
+  // depend on the elements of the lists at the current index and on loop
+  // invariants.
+  absl::flat_hash_set<string> visited;
+  std::vector<string> to_visit;
+  std::vector<const NodeDef*> elements;
+  std::vector<const NodeDef*> nodes;
+  std::set<int> captured_vars;
+  for (int i : map_loop->accumulator_vars) {
+    to_visit.push_back(NodeName(set_items[i]->input(2)));
+  }
+  while (!to_visit.empty()) {
+    const string name = to_visit.back();
+    to_visit.pop_back();
+    if (!visited.insert(name).second) continue;
+    const NodeDef* node = body_map.GetNode(name);
+    if (node == nullptr) {
+      return errors::Internal("Node ", name, " not found in the loop body");
+    }
+    if (node->op() == "_Arg") {
+      const int var = ArgIndex(body_map, name);
+      if (var < 0 || var_kinds[var] != MapLoop::kInvariant) {
+        return errors::Unimplemented("Iterations depend on loop variable ",
+                                     var);
+      }
+      captured_vars.insert(var);
+      continue;
+    }
+    if (node->op() == "TensorListGetItem") {
+      const int list_var = ArgIndex(body_map, node->input(0));
+      const int index_var = ArgIndex(body_map, node->input(1));
+      const NodeDef* list =
+          list_var >= 0
+              ? node_map.GetNode(SkipIdentities(node_map, loop.input(list_var)))
+              : nullptr;
+      if (list == nullptr || var_kinds[list_var] != MapLoop::kInvariant ||
+          list->op() != "TensorListFromTensor" || index_var < 0 ||
+          var_kinds[index_var] != MapLoop::kCounter) {
+        return errors::Unimplemented("Unsupported read from a list in ",
+                                     node->name());
+      }
+      elements.push_back(node);
+      map_loop->element_vars.push_back(list_var);
+      continue;
+    }
+    const OpDef* op_def;
+    TF_RETURN_IF_ERROR(flib.LookUpOpDef(node->op(), &op_def));
+    if (op_def->is_stateful()) {
+      return errors::Unimplemented("Stateful node ", node->name(),
+                                   " in the loop body");
+    }
+    nodes.push_back(node);
+    for (const string& input : node->input()) {
+      to_visit.push_back(NodeName(input));
+    }
+  }
+  if (elements.empty()) {
+    return errors::Unimplemented("Loop does not read the elements of a list");
+  }
+
+  GraphDef* iteration_body = &map_loop->iteration_body;
+  *iteration_body->mutable_versions() = body.graph.versions();
+  int arg_index = 0;
+  for (const NodeDef* element : elements) {
+    NodeDef* arg = iteration_body->add_node();
+    arg->set_name(element->name());
+    arg->set_op("_Arg");
+    (*arg->mutable_attr())["T"] = element->attr().at("element_dtype");
+    (*arg->mutable_attr())["index"].set_i(arg_index++);
+  }
+  for (int var : captured_vars) {
+    NodeDef* arg = iteration_body->add_node();
+    *arg = *body_map.GetNode(body.input(var).node_name);
+    (*arg->mutable_attr())["index"].set_i(arg_index++);
+    map_loop->captured_vars.push_back(var);
+  }
+  for (const NodeDef* node : nodes) {
+    *iteration_body->add_node() = *node;
+  }
+  int ret_index = 0;
+  for (int i : map_loop->accumulator_vars) {
+    NodeDef* retval = iteration_body->add_node();
+    retval->set_name(StrCat("accumulator_", i));
+    retval->set_op("_Retval");
+    retval->add_input(set_items[i]->input(2));
+    (*retval->mutable_attr())["T"] = set_items[i]->attr().at("element_dtype");
+    (*retval->mutable_attr())["index"].set_i(ret_index++);
+  }
+  return Status::OK();
+}
+
+// Returns a name based on `prefix` that no function of `flib` has.
+string UniqueFunctionName(const FunctionLibraryDefinition& flib,
+                          const string& prefix) {
+  string name = prefix;
+  for (int i = 1; flib.Find(name) != nullptr; ++i) {
+    name = StrCat(prefix, "_", i);
+  }
+  return name;
+}
+
+// Adds to `library` a function computing all the iterations of `map_loop` at
+// once, vectorized over the iteration dimension. Its arguments are the
+// elements read by the iterations stacked together, followed by the captured
+// invariants, and its results are the stacked results of the iterations.
+Status AddVectorizedLoopFunction(const NodeDef& loop, const MapLoop& map_loop,
+                                 FunctionDefLibrary* library,
+                                 string* function_name) {
+  const MapDefunVectorizerFn vectorizer = *RegisteredMapDefunVectorizer();
+  if (vectorizer == nullptr) {
+    return errors::Unavailable("No vectorizer is registered");
+  }
+  FunctionLibraryDefinition flib(OpRegistry::Global(), *library);
+  const string prefix = absl::StrReplaceAll(loop.name(), {{"/", "_"}});
+
+  // Wrap the computation of a single iteration into a MapDefun, and let the
+  // vectorizer lift its nodes out of it, as the MapVectorization optimizer of
+  // tf.data does. The scratch library keeps the intermediate functions.
+  FunctionDefLibrary scratch_library = *library;
+  FunctionDef* iteration_fn = scratch_library.add_function();
+  Graph iteration_graph(flib);
+  TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(
+      GraphConstructorOptions(), map_loop.iteration_body, &iteration_graph));
+  TF_RETURN_IF_ERROR(GraphToFunctionDef(
+      iteration_graph, UniqueFunctionName(flib, StrCat(prefix, "_iteration")),
+      iteration_fn));
+
+  FunctionDef* map_fn = scratch_library.add_function();
+  map_fn->mutable_signature()->set_name(
+      UniqueFunctionName(flib, StrCat(prefix, "_map")));
+  NodeDef* map_defun = map_fn->add_node_def();
+  map_defun->set_name("map_defun");
+  map_defun->set_op("MapDefun");
+  DataTypeVector argument_types;
+  DataTypeVector captured_types;
+  DataTypeVector output_types;
+  const OpDef& iteration_signature = iteration_fn->signature();
+  for (int i = 0; i < iteration_signature.input_arg_size(); ++i) {
+    const OpDef::ArgDef& arg = iteration_signature.input_arg(i);
+    *map_fn->mutable_signature()->add_input_arg() = arg;
+    map_defun->add_input(arg.name());
+    if (i < map_loop.element_vars.size()) {
+      argument_types.push_back(arg.type());
+    } else {
+      captured_types.push_back(arg.type());
+    }
+  }
+  for (int i = 0; i < iteration_signature.output_arg_size(); ++i) {
+    const OpDef::ArgDef& arg = iteration_signature.output_arg(i);
+    *map_fn->mutable_signature()->add_output_arg() = arg;
+    (*map_fn->mutable_ret())[arg.name()] = StrCat("map_defun:output:", i);
+    output_types.push_back(arg.type());
+  }
+  NameAttrList iteration_fn_attr;
+  iteration_fn_attr.set_name(iteration_signature.name());
+  AddNodeAttr("f", iteration_fn_attr, map_defun);
+  AddNodeAttr("Targuments", argument_types, map_defun);
+  AddNodeAttr("Tcaptured", captured_types, map_defun);
+  AddNodeAttr("output_types", output_types, map_defun);
+  AddNodeAttr("output_shapes",
+              std::vector<PartialTensorShape>(output_types.size()), map_defun);
+
+  FunctionDef* vectorized_fn;
+  TF_RETURN_IF_ERROR(vectorizer(*map_fn, map_fn->node_def(0), &scratch_library,
+                                &vectorized_fn));
+  for (const NodeDef& node : vectorized_fn->node_def()) {
+    if (node.op() == "MapDefun") {
+      return errors::Unimplemented("Loop body is only partially vectorizable");
+    }
+  }
+  *function_name = vectorized_fn->signature().name();
+  *library->add_function() = *vectorized_fn;
+  return Status::OK();
+}
+
+// Returns a tensor of type `dtype` and shape `shape` filled with `value`.
+Tensor IndexTensor(DataType dtype, const TensorShape& shape, int64 value) {
+  Tensor tensor(dtype, shape);
+  if (dtype == DT_INT32) {
+    tensor.flat<int32>().setConstant(value);
+  } else {
+    tensor.flat<int64>().setConstant(value);
+  }
+  return tensor;
+}
+
+NodeDef* AddConstNode(const string& name, const Tensor& value,
+                      const string& device, const string& control_input,
+                      GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op("Const");
+  node->set_device(device);
+  node->add_input(control_input);
+  AddNodeAttr("dtype", value.dtype(), node);
+  value.AsProtoTensorContent((*node->mutable_attr())["value"].mutable_tensor());
+  return node;
+}
+
+// Replaces `loop` with a call to `function_name`, which computes all its
+// iterations at once. The loop node becomes an IdentityN forwarding the final
+// values of the loop variables, so that its consumers do not change.
+Status ReplaceMapLoop(const MapLoop& map_loop, const string& function_name,
+                      const NodeMap& node_map, NodeDef* loop,
+                      GraphDef* optimized_graph) {
+  DataTypeVector types;
+  TF_RETURN_IF_ERROR(GetNodeAttr(*loop, "T", &types));
+  const int num_vars = types.size();
+  DataType index_type = DT_INVALID;
+  for (int i = 0; i < num_vars; ++i) {
+    if (map_loop.var_kinds[i] == MapLoop::kCounter) index_type = types[i];
+  }
+  const string prefix = StrCat(loop->name(), "/vectorized/");
+  const string& device = loop->device();
+  // Anchors the new constants in the frame of the loop.
+  const string anchor = AsControlDependency(NodeName(loop->input(0)));
+
+  // The counters end at the number of iterations, or 0 if it is negative.
+  const LoopBound& bound = map_loop.num_iterations;
+  string num_iterations = StrCat(prefix, "num_iterations");
+  if (bound.is_constant) {
+    AddConstNode(num_iterations,
+                 IndexTensor(index_type, {}, std::max<int64>(bound.value, 0)),
+                 device, anchor, optimized_graph);
+  } else {
+    AddConstNode(StrCat(prefix, "zero"), IndexTensor(index_type, {}, 0),
+                 device, anchor, optimized_graph);
+    NodeDef* maximum = optimized_graph->add_node();
+    maximum->set_name(num_iterations);
+    maximum->set_op("Maximum");
+    maximum->set_device(device);
+    maximum->add_input(bound.tensor);
+    maximum->add_input(StrCat(prefix, "zero"));
+    AddNodeAttr("T", index_type, maximum);
+  }
+
+  // Slice the lists the iterations read to the number of iterations.
+  AddConstNode(StrCat(prefix, "begin"), IndexTensor(index_type, {1}, 0),
+               device, anchor, optimized_graph);
+  AddConstNode(StrCat(prefix, "strides"), IndexTensor(index_type, {1}, 1),
+               device, anchor, optimized_graph);
+  AddConstNode(StrCat(prefix, "end_shape"), IndexTensor(DT_INT32, {1}, 1),
+               device, anchor, optimized_graph);
+  NodeDef* end = optimized_graph->add_node();
+  end->set_name(StrCat(prefix, "end"));
+  end->set_op("Reshape");
+  end->set_device(device);
+  end->add_input(num_iterations);
+  end->add_input(StrCat(prefix, "end_shape"));
+  AddNodeAttr("T", index_type, end);
+  AddNodeAttr("Tshape", DT_INT32, end);
+
+  NodeDef* iterations = optimized_graph->add_node();
+  iterations->set_name(StrCat(prefix, "iterations"));
+  iterations->set_op(function_name);
+  iterations->set_device(device);
+  absl::flat_hash_set<int> sliced_vars;
+  for (int var : map_loop.element_vars) {
+    const string elements = StrCat(prefix, "elements_", var);
+    iterations->add_input(elements);
+    if (!sliced_vars.insert(var).second) continue;
+    const NodeDef* list =
+        node_map.GetNode(SkipIdentities(node_map, loop->input(var)));
+    NodeDef* slice = optimized_graph->add_node();
+    slice->set_name(elements);
+    slice->set_op("StridedSlice");
+    slice->set_device(device);
+    slice->add_input(list->input(0));
+    slice->add_input(StrCat(prefix, "begin"));
+    slice->add_input(end->name());
+    slice->add_input(StrCat(prefix, "strides"));
+    (*slice->mutable_attr())["T"] = list->attr().at("element_dtype");
+    AddNodeAttr("Index", index_type, slice);
+    for (const char* mask : {"begin_mask", "end_mask", "ellipsis_mask",
+                             "new_axis_mask", "shrink_axis_mask"}) {
+      AddNodeAttr(mask, 0, slice);
+    }
+  }
+  for (int var : map_loop.captured_vars) {
+    iterations->add_input(loop->input(var));
+  }
+
+  // Rebuild the accumulators from the stacked results.
+  std::vector<string> outputs(num_vars);
+  for (int i = 0; i < num_vars; ++i) {
+    if (map_loop.var_kinds[i] == MapLoop::kInvariant) {
+      outputs[i] = loop->input(i);
+    } else if (map_loop.var_kinds[i] == MapLoop::kCounter) {
+      outputs[i] = num_iterations;
+    }
+  }
+  for (int k = 0; k < map_loop.accumulator_vars.size(); ++k) {
+    const int var = map_loop.accumulator_vars[k];
+    const NodeDef* reserve =
+        node_map.GetNode(SkipIdentities(node_map, loop->input(var)));
+    NodeDef* accumulator = optimized_graph->add_node();
+    accumulator->set_name(StrCat(prefix, "accumulator_", var));
+    accumulator->set_op("TensorListFromTensor");
+    accumulator->set_device(device);
+    accumulator->add_input(StrCat(iterations->name(), ":", k));
+    accumulator->add_input(reserve->input(0));
+    (*accumulator->mutable_attr())["element_dtype"] =
+        reserve->attr().at("element_dtype");
+    (*accumulator->mutable_attr())["shape_type"] =
+        reserve->attr().at("shape_type");
+    outputs[var] = accumulator->name();
+  }
+
+  for (int i = num_vars; i < loop->input_size(); ++i) {
+    iterations->add_input(loop->input(i));
+    outputs.push_back(loop->input(i));
+  }
+  const AttrValue type_attr = loop->attr().at("T");
+  loop->set_op("IdentityN");
+  loop->clear_input();
+  loop->clear_attr();
+  for (const string& output : outputs) {
+    loop->add_input(output);
+  }
+  (*loop->mutable_attr())["T"] = type_attr;
+  return Status::OK();
+}
+
 }  // namespace
 
+void RegisterMapDefunVectorizer(MapDefunVectorizerFn vectorizer) {
+  *RegisteredMapDefunVectorizer() = vectorizer;
+}
+
 LoopOptimizer::LoopOptimizer()
     : opt_level_(RewriterConfig::ON),
       cpu_device_(nullptr),
@@ -725,7 +1313,7 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
@@ -733,7 +1321,8 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
       !options_.enable_stack_push_removal &&
-      !options_.enable_dead_branch_removal) {
+      !options_.enable_dead_branch_removal &&
+      !options_.enable_loop_vectorization) {
     return errors::Aborted("Nothing to do.");
   }
   *optimized_graph = item.graph;
@@ -754,6 +1343,9 @@ Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     TF_RETURN_IF_ERROR(RemoveDeadBranches(item.NodesToPreserve(), node_map,
                                           feed_nodes, optimized_graph));
   }
+  if (options_.enable_loop_vectorization) {
+    TF_RETURN_IF_ERROR(VectorizeMapLoops(item, optimized_graph));
+  }
 
   return Status::OK();
 }
@@ -944,6 +1536,40 @@ Status LoopOptimizer::RemoveDeadBranches(
   return Status::OK();
 }
 
+Status LoopOptimizer::VectorizeMapLoops(const GrapplerItem& item,
+                                        GraphDef* optimized_graph) {
+  const FunctionLibraryDefinition flib(OpRegistry::Global(),
+                                       optimized_graph->library());
+  const NodeMap node_map(optimized_graph);
+  absl::flat_hash_set<string> feed_nodes;
+  for (const auto& feed : item.feed) {
+    feed_nodes.insert(NodeName(feed.first));
+  }
+  const int num_nodes = optimized_graph->node_size();
+  for (int i = 0; i < num_nodes; ++i) {
+    NodeDef* loop = optimized_graph->mutable_node(i);
+    if (!IsWhile(*loop)) continue;
+    MapLoop map_loop;
+    string function_name;
+    Status status =
+        AnalyzeMapLoop(*loop, node_map, feed_nodes, flib,
+                       optimized_graph->versions().producer(), &map_loop);
+    if (status.ok()) {
+      status = AddVectorizedLoopFunction(
+          *loop, map_loop, optimized_graph->mutable_library(), &function_name);
+    }
+    if (!status.ok()) {
+      VLOG(2) << "Not vectorizing loop " << loop->name() << ": " << status;
+      continue;
+    }
+    VLOG(1) << "Vectorizing loop " << loop->name() << " into "
+            << function_name;
+    TF_RETURN_IF_ERROR(ReplaceMapLoop(map_loop, function_name, node_map, loop,
+                                      optimized_graph));
+  }
+  return Status::OK();
+}
+
 void LoopOptimizer::Feedback(Cluster* cluster, const GrapplerItem& item,
                              const GraphDef& optimize_output, double result) {
   // Nothing to do for LoopOptimizer.
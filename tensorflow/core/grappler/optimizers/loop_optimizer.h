@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <unordered_set>
 
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/utils.h"
@@ -29,6 +30,15 @@ namespace grappler {
 
 constexpr char kLoopOptimizer[] = "LoopOptimizer";
 
+// Signature of vectorization_utils::VectorizeMapDefun, which the loop
+// optimizer uses to vectorize loops. The tf.data optimizers register it, as
+// depending on them here would create a dependency cycle.
+typedef Status (*MapDefunVectorizerFn)(const FunctionDef& outer_scope,
+                                       const NodeDef& map_defun_node,
+                                       FunctionDefLibrary* lib,
+                                       FunctionDef** result);
+void RegisterMapDefunVectorizer(MapDefunVectorizerFn vectorizer);
+
 class LoopOptimizer : public GraphOptimizer {
  public:
   LoopOptimizer();
@@ -40,7 +50,9 @@ class LoopOptimizer : public GraphOptimizer {
 
   string name() const override { return "loop_optimizer"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override {
+    return options_.enable_loop_vectorization;
+  }
 
   Status Optimize(Cluster* cluster, const GrapplerItem& item,
                   GraphDef* optimized_graph) override;
@@ -56,9 +68,12 @@ class LoopOptimizer : public GraphOptimizer {
     bool enable_loop_invariant_node_motion = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
+    bool enable_loop_vectorization = false;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_loop_vectorization =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
@@ -68,6 +83,12 @@ class LoopOptimizer : public GraphOptimizer {
                             const absl::flat_hash_set<string>& feed_nodes,
                             GraphDef* optimized_graph);
 
+  // Replaces functional While loops whose iterations are independent, like
+  // the ones tf.map_fn creates, with a vectorized computation over all
+  // iterations at once.
+  Status VectorizeMapLoops(const GrapplerItem& item,
+                           GraphDef* optimized_graph);
+
   RewriterConfig::Toggle opt_level_;
   DeviceBase* cpu_device_;
   LoopOptimizerOptions options_;
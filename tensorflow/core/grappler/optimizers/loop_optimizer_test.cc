@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -70,6 +71,78 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_stack_push_removal = true;
   }
 
+  void EnableOnlyLoopVectorization(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_loop_vectorization = true;
+  }
+
+  // Returns a graph mapping the body `body` over the 3 rows of a matrix with
+  // a functional While loop, as tf.map_fn does.
+  GraphDef MapLoopGraph(const FunctionDef& body) const {
+    using test::function::NDef;
+    using FDH = FunctionDefHelper;
+    const FunctionDef cond = FDH::Create(
+        "MapLoopCond",
+        {"i: int32", "n: int32", "elements: variant", "results: variant"},
+        {"less: bool"}, {},
+        {{{"less"}, "Less", {"i", "n"}, {{"T", DT_INT32}}}},
+        {{"less", "less:z:0"}});
+    const Tensor x = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2});
+    return test::function::GDef(
+        {NDef("x", "Const", {}, {{"dtype", DT_FLOAT}, {"value", x}}),
+         NDef("element_shape", "Const", {},
+              {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(-1)}}),
+         NDef("n", "Const", {},
+              {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(3)}}),
+         NDef("zero", "Const", {},
+              {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+         NDef("elements", "TensorListFromTensor", {"x", "element_shape"},
+              {{"element_dtype", DT_FLOAT}, {"shape_type", DT_INT32}}),
+         NDef("results", "TensorListReserve", {"element_shape", "n"},
+              {{"element_dtype", DT_FLOAT}, {"shape_type", DT_INT32}}),
+         NDef("while", "While", {"zero", "n", "elements", "results"},
+              {{"T", DataTypeSlice{DT_INT32, DT_INT32, DT_VARIANT,
+                                   DT_VARIANT}},
+               {"cond", FDH::FunctionRef("MapLoopCond", {})},
+               {"body", FDH::FunctionRef(body.signature().name(), {})}}),
+         NDef("stack", "TensorListStack", {"while:3", "element_shape"},
+              {{"element_dtype", DT_FLOAT}})},
+        {cond, body});
+  }
+
+  // Returns a loop body applying `op` to the elements of the matrix.
+  FunctionDef MapLoopBody(const string& name, const string& op,
+                          const string& op_output) const {
+    using FDH = FunctionDefHelper;
+    return FDH::Create(
+        name, {"i: int32", "n: int32", "elements: variant", "results: variant"},
+        {"next_i: int32", "next_n: int32", "next_elements: variant",
+         "next_results: variant"},
+        {},
+        {{{"one"},
+          "Const",
+          {},
+          {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}},
+         {{"add"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+         {{"element_shape"},
+          "Const",
+          {},
+          {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(-1)}}},
+         {{"element"},
+          "TensorListGetItem",
+          {"elements", "i", "element_shape:output:0"},
+          {{"element_dtype", DT_FLOAT}}},
+         {{"result"}, op, {"element:item:0"}, {{"T", DT_FLOAT}}},
+         {{"set_item"},
+          "TensorListSetItem",
+          {"results", "i", StrCat("result:", op_output, ":0")},
+          {{"element_dtype", DT_FLOAT}}}},
+        {{"next_i", "add:z:0"},
+         {"next_n", "n"},
+         {"next_elements", "elements"},
+         {"next_results", "set_item:output_handle:0"}});
+  }
+
  private:
   void DisableAllStages(LoopOptimizer* optimizer) {
     LoopOptimizer::LoopOptimizerOptions options;
@@ -1689,5 +1762,62 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, VectorizeMapLoop) {
+  GrapplerItem item;
+  item.graph = MapLoopGraph(MapLoopBody("MapLoopBody", "Exp", "y"));
+  item.fetch = {"stack"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopVectorization(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  const FunctionLibraryDefinition flib(OpRegistry::Global(), output.library());
+  bool found = false;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "while") {
+      EXPECT_EQ(node.op(), "IdentityN");
+      ASSERT_EQ(node.input_size(), 4);
+      EXPECT_EQ(node.input(0), "while/vectorized/num_iterations");
+      EXPECT_EQ(node.input(1), "n");
+      EXPECT_EQ(node.input(2), "elements");
+      EXPECT_EQ(node.input(3), "while/vectorized/accumulator_3");
+    } else if (node.name() == "while/vectorized/iterations") {
+      const FunctionDef* vectorized_fn = flib.Find(node.op());
+      ASSERT_NE(vectorized_fn, nullptr);
+      for (const NodeDef& fn_node : vectorized_fn->node_def()) {
+        EXPECT_NE(fn_node.op(), "MapDefun");
+      }
+      found = true;
+    }
+  }
+  EXPECT_TRUE(found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch);
+  auto tensors = EvaluateNodes(output, item.fetch);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(LoopOptimizerTest, DoNotVectorizeStatefulMapLoop) {
+  GrapplerItem item;
+  item.graph = MapLoopGraph(
+      MapLoopBody("StatefulMapLoopBody", "RandomShuffle", "output"));
+  item.fetch = {"stack"};
+
+  LoopOptimizer optimizer;
+  EnableOnlyLoopVectorization(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "while") {
+      EXPECT_EQ(node.op(), "While");
+    }
+  }
+  EXPECT_EQ(output.node_size(), item.graph.node_size());
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
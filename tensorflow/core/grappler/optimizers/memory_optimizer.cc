@@ -440,6 +440,17 @@ void RecomputeSubgraph(
   }
 }
 
+// Returns true if `node` is a node whose inputs we may want to recompute. This
+// matches node names that contain recomputation_targets_name_scope as a name
+// scope, meaning it either begins with or contains the name scope.  Defaults
+// to "gradients/" which will match any node names that begins with
+// "gradients/" or contains "/gradients/".
+bool IsRecomputationTarget(const string& recomputation_targets_name_scope,
+                           const NodeDef& node) {
+  return node.name().find(recomputation_targets_name_scope) == 0 ||
+         node.name().find("/" + recomputation_targets_name_scope) != -1;
+}
+
 void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                                 const string& recomputation_targets_name_scope,
                                 GraphDef* graph, const GrapplerItem& item) {
@@ -461,13 +472,7 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
   std::function<bool(const NodeDef&)> is_target =
       [&recomputation_targets_name_scope](const NodeDef& node) {
-        // Nodes whose inputs we may want to recompute. This matches node names
-        // that contain recomputation_targets_name_scope as a name scope,
-        // meaning it either begins with or contains the name scope.
-        // Defaults to "gradients/" which will match any node names that begins
-        // with "gradients/" or contains "/gradients/".
-        return node.name().find(recomputation_targets_name_scope) == 0 ||
-               node.name().find("/" + recomputation_targets_name_scope) != -1;
+        return IsRecomputationTarget(recomputation_targets_name_scope, node);
       };
 
   if (optimization_level == RewriterConfig::RECOMPUTATION_HEURISTICS ||
@@ -486,7 +491,8 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
                   node.attr().count(kRecomputeHint) > 0);
         },
         is_target);
-  } else if (optimization_level == RewriterConfig::MANUAL) {
+  } else if (optimization_level == RewriterConfig::MANUAL ||
+             optimization_level == RewriterConfig::COST_BASED_RECOMPUTATION) {
     recomputed_subgraphs = GetOpGroupsToRecompute(
         graph, node_map,
         [&feeds, &is_target](const NodeDef& node) {
@@ -510,6 +516,188 @@ void RecomputationRewritingPass(RewriterConfig::MemOptType optimization_level,
   }
 }
 
+// A tensor live at the peak memory usage of a device that may be recomputed
+// for the target nodes instead of being kept alive until they run.
+struct RecomputationCandidate {
+  const NodeDef* node;
+  std::unordered_set<NodeDef*> target_nodes;
+  int64 memory_saved;
+  Costs::NanoSeconds recomputation_time;
+};
+
+// Selects nodes to recompute with the costs of the simulated execution of the
+// graph, in the spirit of XLA's HloRematerialization: as long as the peak
+// memory usage of a GPU exceeds its memory, the outputs live at the peak that
+// only need to be kept alive for target nodes are recomputed for them, in
+// decreasing order of memory saved per nanosecond of recomputation.  Only
+// nodes whose inputs are live at the peak anyway are recomputed, so that the
+// recomputation does not extend the lifetime of other tensors through the
+// peak.  Returns true if the graph was changed.
+bool CostBasedRecomputationPass(Cluster* cluster,
+                                const string& recomputation_targets_name_scope,
+                                GrapplerItem* item,
+                                std::unordered_set<string>* skip_list) {
+  GraphMemory memory(*item);
+  Status s = memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.error_message();
+    return false;
+  }
+
+  std::unordered_map<string, Costs::NanoSeconds> execution_times;
+  {
+    VirtualCluster vcluster(cluster->GetDevices());
+    if (!vcluster.Provision().ok() || !vcluster.Initialize(*item).ok()) {
+      return false;
+    }
+    RunMetadata metadata;
+    s = vcluster.Run(item->graph, item->feed, item->fetch, &metadata);
+    if (!s.ok() && s.code() != error::RESOURCE_EXHAUSTED) {
+      return false;
+    }
+    for (const auto& dev_stats : metadata.step_stats().dev_stats()) {
+      for (const auto& node_stats : dev_stats.node_stats()) {
+        execution_times.emplace(
+            node_stats.node_name(),
+            Costs::NanoSeconds(node_stats.op_end_rel_nanos()));
+      }
+    }
+  }
+
+  // The candidates are looked up by pointer, and the topological numbering is
+  // used to add the recomputation triggers, so sort the graph first.
+  if (!TopologicalSort(&item->graph).ok()) {
+    return false;
+  }
+  NodeMap node_map(&item->graph);
+  std::unordered_map<const NodeDef*, int> topological_numbering;
+  for (int i = 0; i < item->graph.node_size(); ++i) {
+    topological_numbering[item->graph.mutable_node(i)] =
+        item->graph.node_size() - i - 1;
+  }
+  const std::unordered_set<string> nodes_to_preserve = item->NodesToPreserve();
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  auto is_target = [&recomputation_targets_name_scope](const NodeDef& node) {
+    return IsRecomputationTarget(recomputation_targets_name_scope, node);
+  };
+  auto can_recompute = [&](const NodeDef& node) {
+    return !is_target(node) && feeds.count(node.name()) == 0 &&
+           nodes_to_preserve.count(node.name()) == 0 &&
+           skip_list->count(node.name()) == 0 &&
+           NumNonControlInputs(node) > 0 && !IsPersistent(node) &&
+           !IsControlFlow(node) &&
+           !ModifiesFrameInfo(node) && IsFreeOfSideEffect(node);
+  };
+
+  std::vector<std::pair<const NodeDef*, std::unordered_set<NodeDef*>>>
+      to_recompute;
+  for (const auto& device : cluster->GetDevices()) {
+    const DeviceProperties& prop = device.second;
+    if (prop.type() != "GPU" || prop.memory_size() <= 0) {
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage =
+        memory.GetPeakMemoryUsage(device.first);
+    if (mem_usage.used_memory <= prop.memory_size()) {
+      continue;
+    }
+    const int64 required_savings = mem_usage.used_memory - prop.memory_size();
+
+    std::unordered_map<string, int64> live_memory;
+    for (const auto& live_tensor : mem_usage.live_tensors) {
+      live_memory[live_tensor.node] += live_tensor.memory_used;
+    }
+    std::vector<RecomputationCandidate> candidates;
+    for (const auto& live : live_memory) {
+      const NodeDef* node = node_map.GetNode(live.first);
+      // Don't bother with small tensors.
+      if (node == nullptr || live.second <= 1024 || !can_recompute(*node)) {
+        continue;
+      }
+      bool inputs_available = true;
+      for (const string& input_name : node->input()) {
+        const NodeDef* input = node_map.GetNode(input_name);
+        if (input == nullptr || is_target(*input) ||
+            (!IsControlInput(input_name) && !IsPersistent(*input) &&
+             live_memory.count(input->name()) == 0)) {
+          inputs_available = false;
+          break;
+        }
+      }
+      if (!inputs_available) {
+        continue;
+      }
+      RecomputationCandidate candidate;
+      candidate.node = node;
+      for (NodeDef* output : node_map.GetOutputs(node->name())) {
+        if (is_target(*output)) {
+          candidate.target_nodes.insert(output);
+        }
+      }
+      if (candidate.target_nodes.empty()) {
+        continue;
+      }
+      candidate.memory_saved = live.second;
+      auto it = execution_times.find(node->name());
+      candidate.recomputation_time =
+          it == execution_times.end() ? Costs::NanoSeconds(0) : it->second;
+      candidates.push_back(std::move(candidate));
+    }
+
+    // Prefer the candidates that save the most memory per unit of time, and
+    // break ties by name to make the result deterministic.
+    std::sort(candidates.begin(), candidates.end(),
+              [](const RecomputationCandidate& a,
+                 const RecomputationCandidate& b) {
+                const double a_benefit = static_cast<double>(a.memory_saved) /
+                                         (1 + a.recomputation_time.count());
+                const double b_benefit = static_cast<double>(b.memory_saved) /
+                                         (1 + b.recomputation_time.count());
+                if (a_benefit != b_benefit) return a_benefit > b_benefit;
+                return a.node->name() < b.node->name();
+              });
+    int64 savings = 0;
+    std::unordered_set<string> selected;
+    for (const RecomputationCandidate& candidate : candidates) {
+      if (savings >= required_savings) {
+        break;
+      }
+      // Recomputing a node from another recomputed node would keep the output
+      // of the latter alive, so recompute independent nodes only.
+      bool independent = true;
+      for (const string& input_name : candidate.node->input()) {
+        if (selected.count(NodeName(input_name)) > 0) independent = false;
+      }
+      for (const NodeDef* output :
+           node_map.GetOutputs(candidate.node->name())) {
+        if (selected.count(output->name()) > 0) independent = false;
+      }
+      if (!independent) {
+        continue;
+      }
+      VLOG(1) << "Recomputing " << candidate.node->name() << " to save "
+              << candidate.memory_saved << " bytes on " << device.first
+              << " at the cost of " << candidate.recomputation_time.count()
+              << " ns";
+      selected.insert(candidate.node->name());
+      savings += candidate.memory_saved;
+      to_recompute.emplace_back(candidate.node, candidate.target_nodes);
+    }
+  }
+
+  for (const auto& recomputation : to_recompute) {
+    skip_list->insert(recomputation.first->name());
+    skip_list->insert(AddPrefixToNodeName(recomputation.first->name(),
+                                          kRecomputedNodePrefix));
+    RecomputeSubgraph({recomputation.first}, recomputation.second, node_map,
+                      topological_numbering, &item->graph);
+  }
+  return !to_recompute.empty();
+}
+
 bool SchedulingPass(Cluster* cluster, std::unique_ptr<GraphMemory>* memory_ptr,
                     GrapplerItem* item) {
   // Look for AddN nodes (and equivalent) and record input names.
@@ -1384,7 +1572,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool run_recomputation_pass =
       (optimization_level_ == RewriterConfig::RECOMPUTATION_HEURISTICS ||
        optimization_level_ == RewriterConfig::HEURISTICS ||
-       optimization_level_ == RewriterConfig::MANUAL);
+       optimization_level_ == RewriterConfig::MANUAL ||
+       optimization_level_ == RewriterConfig::COST_BASED_RECOMPUTATION);
   if (!run_recomputation_pass && nodes_to_relax.empty() && item.fetch.empty()) {
     return errors::Aborted("Nothing to do.");
   }
@@ -1398,6 +1587,21 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                &optimized_item.graph, item);
   }
 
+  // Like SchedulingPass() and SwappingPass(), the cost-based recomputation
+  // relies on the fetches to simulate the execution of the graph.
+  if (optimization_level_ == RewriterConfig::COST_BASED_RECOMPUTATION &&
+      !item.fetch.empty() && cluster != nullptr) {
+    std::unordered_set<string> recomputed;
+    for (int i = 0; i < 25; ++i) {
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      if (!CostBasedRecomputationPass(cluster,
+                                      recomputation_targets_name_scope_,
+                                      &optimized_item, &recomputed)) {
+        break;
+      }
+    }
+  }
+
   std::unordered_set<string> skip_list;
   // Bound the number of rewrite passes to avoid long processing times on graphs
   // that simply won't fit in memory.
@@ -1424,7 +1628,8 @@ Status MemoryOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
       if ((optimization_level_ == RewriterConfig::DEFAULT_MEM_OPT ||
            optimization_level_ == RewriterConfig::SWAPPING_HEURISTICS ||
            optimization_level_ == RewriterConfig::HEURISTICS ||
-           optimization_level_ == RewriterConfig::MANUAL) &&
+           optimization_level_ == RewriterConfig::MANUAL ||
+           optimization_level_ == RewriterConfig::COST_BASED_RECOMPUTATION) &&
           cluster != nullptr) {
         if (SwappingPass(optimization_level_, cluster, &memory, &optimized_item,
                          &skip_list)) {
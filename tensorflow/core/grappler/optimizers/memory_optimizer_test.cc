@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -346,6 +347,62 @@ TEST_F(MemoryOptimizerTest, SwappingHeuristics) {
 #endif
 }
 
+TEST_F(MemoryOptimizerTest, CostBasedRecomputation) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
+                           {128, 128, 8}, DT_FLOAT);
+  Output a = ops::Square(s.WithOpName("a").WithDevice("/gpu:0"), v);
+  Output b = ops::Sqrt(s.WithOpName("b").WithDevice("/gpu:0"), a);
+  Output c = ops::Exp(s.WithOpName("c").WithDevice("/gpu:0"), b);
+  Output grad_c =
+      ops::Mul(s.WithOpName("gradients/c").WithDevice("/gpu:0"), c, c);
+  Output grad_b =
+      ops::Mul(s.WithOpName("gradients/b").WithDevice("/gpu:0"), grad_c, b);
+  Output grad_a =
+      ops::Mul(s.WithOpName("gradients/a").WithDevice("/gpu:0"), grad_b, a);
+
+  Output constant = ops::Const(s.WithOpName("constant"), 0.0f, {128, 128, 8});
+  Output init = ops::Assign(s.WithOpName("init"), v, constant);
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"gradients/a"};
+  item.init_ops = {init.name()};
+
+  // The 512KB activations don't fit in the 1MB of the GPU.
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+
+  MemoryOptimizer optimizer(RewriterConfig::COST_BASED_RECOMPUTATION);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(cluster.get(), item, &output));
+
+  NodeMap node_map(&output);
+  int num_recomputed = 0;
+  for (const auto& node : output.node()) {
+    if (!absl::StartsWith(node.name(), "Recomputed/")) continue;
+    ++num_recomputed;
+    // Recomputed nodes only feed gradients, and wait for a trigger.
+    for (const NodeDef* consumer : node_map.GetOutputs(node.name())) {
+      EXPECT_TRUE(absl::StartsWith(consumer->name(), "gradients/") ||
+                  absl::StartsWith(consumer->name(), "Recomputed/"))
+          << consumer->name();
+    }
+    EXPECT_TRUE(absl::StartsWith(node.input(node.input_size() - 1),
+                                 "^RecomputeTrigger/"));
+  }
+  EXPECT_GT(num_recomputed, 0);
+  // The forward pass is unchanged.
+  EXPECT_EQ("a", node_map.GetNode("b")->input(0));
+  EXPECT_EQ("b", node_map.GetNode("c")->input(0));
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  auto tensors_expected = EvaluateFetchNodes(item);
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  auto tensors = EvaluateFetchNodes(optimized);
+  test::ExpectTensorNear<float>(tensors_expected[0], tensors[0], 1e-6);
+#endif
+}
+
 TEST_F(MemoryOptimizerTest, UnswappableInputs) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope();
   Output v = ops::Variable(s.WithOpName("v").WithDevice("/gpu:0"),
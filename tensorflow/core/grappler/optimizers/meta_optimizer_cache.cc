@@ -0,0 +1,188 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+// Number of optimized graphs kept in memory by the process-wide cache.
+constexpr int64 kGlobalCacheCapacity = 32;
+
+// Appends `piece` to `key`, prefixed with its length so that different
+// sequences of pieces do not produce the same key.
+void AppendKeyPiece(const string& piece, string* key) {
+  absl::StrAppend(key, piece.size(), ":", piece);
+}
+
+void AppendKeyPiece(const protobuf::MessageLite& proto, string* key) {
+  string serialized;
+  SerializeToStringDeterministic(proto, &serialized);
+  AppendKeyPiece(serialized, key);
+}
+
+void AppendKeyPieces(const std::vector<string>& pieces, string* key) {
+  AppendKeyPiece(absl::StrCat(pieces.size()), key);
+  for (const string& piece : pieces) {
+    AppendKeyPiece(piece, key);
+  }
+}
+
+}  // namespace
+
+MetaOptimizerCache::MetaOptimizerCache(int64 capacity, Env* env)
+    : capacity_(capacity), env_(env) {}
+
+/*static*/ MetaOptimizerCache* MetaOptimizerCache::Global() {
+  static MetaOptimizerCache* cache =
+      new MetaOptimizerCache(kGlobalCacheCapacity);
+  return cache;
+}
+
+/*static*/ string MetaOptimizerCache::Key(const GrapplerItem& item,
+                                          const ConfigProto& cfg,
+                                          const Cluster* cluster) {
+  string key;
+  AppendKeyPiece(item.id, &key);
+  AppendKeyPiece(item.graph, &key);
+
+  std::vector<string> feeds;
+  for (const auto& feed : item.feed) {
+    TensorShapeProto shape;
+    feed.second.shape().AsProto(&shape);
+    feeds.push_back(absl::StrCat(feed.first, ":",
+                                 DataTypeString(feed.second.dtype()), ":",
+                                 shape.ShortDebugString()));
+  }
+  AppendKeyPieces(feeds, &key);
+  AppendKeyPieces(item.fetch, &key);
+  AppendKeyPieces(item.init_ops, &key);
+  AppendKeyPieces(item.keep_ops, &key);
+  AppendKeyPieces({item.save_op, item.restore_op, item.save_restore_loc_tensor},
+                  &key);
+  for (const QueueRunnerDef& queue_runner : item.queue_runners) {
+    AppendKeyPiece(queue_runner, &key);
+  }
+
+  const GrapplerItem::OptimizationOptions& options =
+      item.optimization_options();
+  AppendKeyPiece(
+      absl::StrCat(options.allow_non_differentiable_rewrites,
+                   options.allow_pruning_stateful_and_dataset_ops,
+                   options.optimize_function_library, options.is_eager_mode),
+      &key);
+
+  std::vector<string> devices(item.devices().begin(), item.devices().end());
+  std::sort(devices.begin(), devices.end());
+  AppendKeyPieces(devices, &key);
+  if (cluster != nullptr) {
+    std::vector<string> device_names = cluster->GetDeviceNames();
+    std::sort(device_names.begin(), device_names.end());
+    for (const string& name : device_names) {
+      AppendKeyPiece(name, &key);
+      AppendKeyPiece(cluster->GetDevices().at(name), &key);
+    }
+  }
+
+  // The cache options themselves do not change the result.
+  ConfigProto cfg_without_cache = cfg;
+  RewriterConfig* rewrite_cfg =
+      cfg_without_cache.mutable_graph_options()->mutable_rewrite_options();
+  rewrite_cfg->clear_meta_optimizer_cache();
+  rewrite_cfg->clear_meta_optimizer_cache_dir();
+  AppendKeyPiece(cfg_without_cache, &key);
+
+  const Fprint128 fingerprint = Fingerprint128(key);
+  return absl::StrCat(absl::Hex(fingerprint.high64, absl::kZeroPad16),
+                      absl::Hex(fingerprint.low64, absl::kZeroPad16));
+}
+
+bool MetaOptimizerCache::Lookup(const string& key, const string& directory,
+                                GraphDef* optimized_graph) {
+  {
+    mutex_lock l(mu_);
+    auto it = entry_by_key_.find(key);
+    if (it != entry_by_key_.end()) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      *optimized_graph = it->second->second;
+      return true;
+    }
+  }
+  if (directory.empty()) return false;
+
+  const string path = io::JoinPath(directory, absl::StrCat(key, ".graphdef"));
+  if (!env_->FileExists(path).ok()) return false;
+  Status status = ReadBinaryProto(env_, path, optimized_graph);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to read cached optimized graph " << path << ": "
+                 << status;
+    return false;
+  }
+  mutex_lock l(mu_);
+  if (!entry_by_key_.contains(key)) {
+    InsertInMemory(key, *optimized_graph);
+  }
+  return true;
+}
+
+Status MetaOptimizerCache::Insert(const string& key, const string& directory,
+                                  const GraphDef& optimized_graph) {
+  {
+    mutex_lock l(mu_);
+    if (!entry_by_key_.contains(key)) {
+      InsertInMemory(key, optimized_graph);
+    }
+  }
+  if (directory.empty()) return Status::OK();
+
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory));
+  // Write to a file name unique to this writer first, so that other processes
+  // sharing the directory only ever read complete graphs.
+  const string path = io::JoinPath(directory, absl::StrCat(key, ".graphdef"));
+  const string tmp_path = absl::StrCat(path, ".tmp.", random::New64());
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env_, tmp_path, optimized_graph));
+  Status status = env_->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    env_->DeleteFile(tmp_path).IgnoreError();
+  }
+  return status;
+}
+
+void MetaOptimizerCache::InsertInMemory(const string& key,
+                                        const GraphDef& optimized_graph) {
+  if (capacity_ <= 0) return;
+  if (entries_.size() >= capacity_) {
+    entry_by_key_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(key, optimized_graph);
+  entry_by_key_[key] = entries_.begin();
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
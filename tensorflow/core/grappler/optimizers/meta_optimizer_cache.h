@@ -0,0 +1,84 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
+
+#include <list>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Cache of the graphs produced by the meta optimizer, keyed by a fingerprint
+// of everything the result depends on: the graph and its function library,
+// the nodes to fetch, feed and keep, the optimization options, the devices
+// of the cluster and the config.  The most recently used results are kept in
+// memory, and all results can also be stored as files in a directory shared
+// between processes.  RunMetaOptimizer uses the process-wide cache when
+// RewriterConfig.meta_optimizer_cache is on.
+class MetaOptimizerCache {
+ public:
+  explicit MetaOptimizerCache(int64 capacity, Env* env = Env::Default());
+
+  // Returns the process-wide cache.
+  static MetaOptimizerCache* Global();
+
+  // Returns the key of the result of optimizing `item` with `cfg` on
+  // `cluster`, which may be null.
+  static string Key(const GrapplerItem& item, const ConfigProto& cfg,
+                    const Cluster* cluster);
+
+  // Looks up the graph cached under `key`, first in memory and then in
+  // `directory` unless it is empty.  Returns false if neither has it.
+  bool Lookup(const string& key, const string& directory,
+              GraphDef* optimized_graph);
+
+  // Caches `optimized_graph` under `key` in memory, and in `directory`
+  // unless it is empty.
+  Status Insert(const string& key, const string& directory,
+                const GraphDef& optimized_graph);
+
+ private:
+  // Adds `optimized_graph` as the most recently used entry, evicting the
+  // least recently used one if the cache is full.
+  void InsertInMemory(const string& key, const GraphDef& optimized_graph)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 capacity_;
+  Env* const env_;
+
+  mutex mu_;
+  // Cached entries, most recently used first.
+  std::list<std::pair<string, GraphDef>> entries_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<string, std::list<std::pair<string, GraphDef>>::iterator>
+      entry_by_key_ TF_GUARDED_BY(mu_);
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_META_OPTIMIZER_CACHE_H_
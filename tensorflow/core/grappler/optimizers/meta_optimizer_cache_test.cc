@@ -0,0 +1,107 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/meta_optimizer_cache.h"
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/inputs/trivial_test_graph_input_yielder.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+GrapplerItem TestItem() {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  CHECK(fake_input.NextItem(&item));
+  return item;
+}
+
+TEST(MetaOptimizerCacheTest, KeyDependsOnGraphAndConfig) {
+  GrapplerItem item = TestItem();
+  ConfigProto config;
+  const string key = MetaOptimizerCache::Key(item, config, nullptr);
+  EXPECT_EQ(key, MetaOptimizerCache::Key(item, config, nullptr));
+
+  // The cache options themselves do not change the result.
+  ConfigProto cache_config = config;
+  auto* rewrite_options =
+      cache_config.mutable_graph_options()->mutable_rewrite_options();
+  rewrite_options->set_meta_optimizer_cache(true);
+  rewrite_options->set_meta_optimizer_cache_dir("/tmp/cache");
+  EXPECT_EQ(key, MetaOptimizerCache::Key(item, cache_config, nullptr));
+
+  ConfigProto other_config = config;
+  other_config.mutable_graph_options()
+      ->mutable_rewrite_options()
+      ->set_constant_folding(RewriterConfig::OFF);
+  EXPECT_NE(key, MetaOptimizerCache::Key(item, other_config, nullptr));
+
+  GrapplerItem other_item = item;
+  other_item.fetch.push_back("x");
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_item, config, nullptr));
+
+  other_item = item;
+  other_item.graph.mutable_node(0)->set_device("/device:CPU:1");
+  EXPECT_NE(key, MetaOptimizerCache::Key(other_item, config, nullptr));
+}
+
+TEST(MetaOptimizerCacheTest, EvictsLeastRecentlyUsed) {
+  MetaOptimizerCache cache(/*capacity=*/2);
+  GraphDef graph;
+  graph.add_node()->set_name("a");
+  TF_ASSERT_OK(cache.Insert("a", "", graph));
+  graph.mutable_node(0)->set_name("b");
+  TF_ASSERT_OK(cache.Insert("b", "", graph));
+
+  GraphDef found;
+  ASSERT_TRUE(cache.Lookup("a", "", &found));
+  EXPECT_EQ("a", found.node(0).name());
+
+  graph.mutable_node(0)->set_name("c");
+  TF_ASSERT_OK(cache.Insert("c", "", graph));
+  EXPECT_TRUE(cache.Lookup("a", "", &found));
+  EXPECT_FALSE(cache.Lookup("b", "", &found));
+  EXPECT_TRUE(cache.Lookup("c", "", &found));
+}
+
+TEST(MetaOptimizerCacheTest, SharesResultsThroughDirectory) {
+  const string directory =
+      io::JoinPath(testing::TmpDir(), "meta_optimizer_cache");
+  TF_ASSERT_OK(Env::Default()->RecursivelyCreateDir(directory));
+
+  GraphDef graph;
+  graph.add_node()->set_name("optimized");
+  MetaOptimizerCache writer(/*capacity=*/1);
+  TF_ASSERT_OK(writer.Insert("key", directory, graph));
+
+  // A fresh cache, as in another process, finds the result on disk.
+  MetaOptimizerCache reader(/*capacity=*/1);
+  GraphDef found;
+  EXPECT_FALSE(reader.Lookup("key", "", &found));
+  ASSERT_TRUE(reader.Lookup("key", directory, &found));
+  EXPECT_EQ("optimized", found.node(0).name());
+  EXPECT_FALSE(reader.Lookup("other_key", directory, &found));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -596,6 +596,63 @@ TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryPruneFunctionBody) {
   test::ExpectTensorEqual<float>(tensors_expected[1], tensors[1]);
 }
 
+TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryInParallel) {
+  using test::function::NDef;
+
+  // MyFunc defines two Mul nodes inside function body and two corresponding
+  // function outputs.
+  FunctionDef my_func = FunctionDefHelper::Create(
+      "MyFunc", {"x:T", "y:T"}, {"z1:T", "z2:T"}, {"T: {float, double}"},
+      {{{"mul1"}, "Mul", {"x", "y"}, {{"T", "$T"}}},
+       {{"mul2"}, "Mul", {"x", "y"}, {{"T", "$T"}}}},
+      /*ret_def=*/
+      {{"z1", "mul1:z:0"}, {"z2", "mul2:z:0"}});
+  (*my_func.mutable_attr())["_noinline"].set_b(true);
+
+  // Each call is specialized into its own function, and the specialized
+  // functions are then optimized concurrently.
+  GrapplerItem item;
+  item.id = "tf_graph";
+  item.graph = test::function::GDef(
+      {NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("b", "Placeholder", {}, {{"dtype", DT_FLOAT}}, kDevice),
+       NDef("fn1", "MyFunc", {"a", "b"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("fn2", "MyFunc", {"a", "b"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("fn3", "MyFunc", {"a", "b"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_fn1", "Identity", {"fn1:0"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_fn2", "Identity", {"fn2:1"}, {{"T", DT_FLOAT}}, kDevice),
+       NDef("out_fn3", "Identity", {"fn3:0"}, {{"T", DT_FLOAT}}, kDevice)},
+      /*funcs=*/
+      {my_func});
+
+  const auto optimize = [&item](int parallelism, GraphDef* output) {
+    ConfigProto config_proto;
+    auto& rewriter_config =
+        *config_proto.mutable_graph_options()->mutable_rewrite_options();
+    rewriter_config.set_meta_optimizer_iterations(RewriterConfig::TWO);
+    rewriter_config.set_function_optimization(RewriterConfig::ON);
+    rewriter_config.add_optimizers("function");
+    rewriter_config.add_optimizers("pruning");
+    rewriter_config.set_min_graph_nodes(-1);
+    rewriter_config.set_function_optimization_parallelism(parallelism);
+    MetaOptimizer optimizer(nullptr, config_proto);
+    TF_EXPECT_OK(optimizer.Optimize(nullptr, item, output));
+  };
+
+  GraphDef serial_output;
+  optimize(1, &serial_output);
+  GraphDef parallel_output;
+  optimize(4, &parallel_output);
+
+  CompareGraphs(serial_output, parallel_output);
+  ASSERT_EQ(serial_output.library().function_size(),
+            parallel_output.library().function_size());
+  for (int i = 0; i < serial_output.library().function_size(); ++i) {
+    EXPECT_EQ(serial_output.library().function(i).DebugString(),
+              parallel_output.library().function(i).DebugString());
+  }
+}
+
 TEST_F(MetaOptimizerTest, OptimizeFunctionLibraryWithRestrictions) {
   using test::function::NDef;
   using FDH = FunctionDefHelper;
@@ -774,6 +831,34 @@ TEST_F(MetaOptimizerTest, OptimizerDoesNotTimeOut) {
   EXPECT_EQ(original_node_size + 2, output.node_size());
 }
 
+TEST_F(MetaOptimizerTest, ReusesCachedOptimizedGraph) {
+  TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
+  GrapplerItem item;
+  ASSERT_TRUE(fake_input.NextItem(&item));
+  GrapplerItem item_copy = item;
+
+  ConfigProto config;
+  RewriterConfig& rewriter_config =
+      *config.mutable_graph_options()->mutable_rewrite_options();
+  rewriter_config.add_optimizers("TestOptimizer");
+  rewriter_config.set_min_graph_nodes(-1);
+  rewriter_config.set_meta_optimizer_cache(true);
+
+  TestOptimizer::SetOptimized(false);
+  GraphDef output;
+  TF_EXPECT_OK(
+      RunMetaOptimizer(std::move(item), config, nullptr, nullptr, &output));
+  EXPECT_TRUE(TestOptimizer::IsOptimized());
+
+  // The second run of the same graph is served from the cache.
+  TestOptimizer::SetOptimized(false);
+  GraphDef cached_output;
+  TF_EXPECT_OK(RunMetaOptimizer(std::move(item_copy), config, nullptr, nullptr,
+                                &cached_output));
+  EXPECT_FALSE(TestOptimizer::IsOptimized());
+  CompareGraphs(output, cached_output);
+}
+
 TEST_F(MetaOptimizerTest, RunPostOptimizationVerifiersOnValidGraph) {
   TrivialTestGraphInputYielder fake_input(4, 1, 10, false, {"CPU:0"});
   GrapplerItem item;
@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
 #include "tensorflow/core/grappler/graph_view.h"
@@ -51,6 +54,18 @@ namespace grappler {
 //   (1) FusedBatchNorm + <Activation>
 //   (2) FusedBatchNorm + SideInput + <Activation>
 //
+// Attention on CPU -> _FusedAttention
+//   (1) BatchMatMul(query, key, adj_y) + [Mul|RealDiv by scalar] + Softmax
+//       + BatchMatMul(value)
+//
+// Layer normalization on CPU -> _FusedLayerNorm
+//   (1) The subgraph of tf.nn.moments + tf.nn.batch_normalization that
+//       normalizes over the last dimension, with a scale and an offset.
+//
+// Element-wise ops on CPU -> _FusedElementwise
+//   (1) A chain of two or more element-wise ops with the same shape, whose
+//       intermediate results have no other consumers.
+//
 // Both Conv2D and MatMul implemented as Tensor contraction (on CPU), so all the
 // patterns are "ContractionWith...".
 namespace {
@@ -58,12 +73,19 @@ namespace {
 constexpr char kFusedConv2D[] = "_FusedConv2D";
 constexpr char kFusedMatMul[] = "_FusedMatMul";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kFusedLayerNorm[] = "_FusedLayerNorm";
+constexpr char kFusedAttention[] = "_FusedAttention";
 
 constexpr char kDataFormat[] = "data_format";
 constexpr char kIsTraining[] = "is_training";
+constexpr char kCacheRhs[] = "_cache_rhs";
 
 constexpr int kMissingIndex = -1;
 
+// Maximum number of ops fused into a _FusedElementwise.
+constexpr int kMaxFusedElementwiseOps = 32;
+
 struct RemapperContext {
   explicit RemapperContext(GrapplerItem* item, Status* status)
       : nodes_to_preserve(item->NodesToPreserve()),
@@ -196,6 +218,53 @@ struct ContractionWithBiasAndAddActivation {
 };
 #endif  // INTEL_MKL
 
+// Layer normalization over the last dimension of `x`:
+//   mean = Mean(x, axes)
+//   variance = Mean(SquaredDifference(x, [StopGradient](mean)), axes)
+//   inv = Mul(Rsqrt(Add(variance, epsilon)), scale)
+//   output = Add(Mul(x, inv), Sub(offset, Mul(mean, inv)))
+struct FusedLayerNorm {
+  FusedLayerNorm() = default;
+
+  // The final Add, which is replaced by the fused op.
+  int output = kMissingIndex;
+  // All the other nodes of the subgraph, which are removed.
+  std::vector<int> fused_nodes;
+  string x;
+  string scale;
+  string offset;
+  float epsilon = 0.0;
+};
+
+// Attention over the last two dimensions:
+//   scores = BatchMatMul(query, key, adj_y=true)
+//   output = BatchMatMul(Softmax([Mul|RealDiv](scores, scale)), value)
+struct FusedAttention {
+  FusedAttention() = default;
+
+  // The final BatchMatMul, which is replaced by the fused op.
+  int output = kMissingIndex;
+  // All the other nodes of the pattern, which are removed.
+  std::vector<int> fused_nodes;
+  string query;
+  string key;
+  string value;
+  float scale = 1.0;
+};
+
+// Chain of element-wise ops that can be evaluated in a single pass.
+struct FusedElementwise {
+  FusedElementwise() = default;
+
+  // The fused ops in topological order; the last one is the root.
+  std::vector<int> ops;
+  // The inputs of the chain, which are scalars or have its shape.
+  std::vector<string> args;
+  // The operands of the ops, indexing `args` followed by the results of the
+  // ops, in the order of `ops`.
+  std::vector<int> operands;
+};
+
 bool IsInPreserveSet(const RemapperContext& ctx, const NodeDef* node) {
   return ctx.nodes_to_preserve.count(node->name()) > 0;
 }
@@ -351,6 +420,23 @@ inline bool HasAtMostOneDataFanoutAtPort0(
   return absl::c_count_if(node_view.GetRegularFanout(0), predicate) <= 1;
 }
 
+// Returns the number of inputs of the element-wise op `node` if the
+// _FusedElementwise kernel can compute it, and 0 otherwise.
+int FusedElementwiseArity(const NodeDef& node) {
+  static const auto* const arities = new absl::flat_hash_map<string, int>({
+      {"Add", 2},     {"AddV2", 2},   {"Sub", 2},     {"Mul", 2},
+      {"RealDiv", 2}, {"Maximum", 2}, {"Minimum", 2}, {"SquaredDifference", 2},
+      {"Abs", 1},     {"Erf", 1},     {"Exp", 1},     {"Log", 1},
+      {"Neg", 1},     {"Reciprocal", 1}, {"Relu", 1}, {"Rsqrt", 1},
+      {"Sigmoid", 1}, {"Sqrt", 1},    {"Square", 1},  {"Tanh", 1},
+  });
+  auto it = arities->find(node.op());
+  if (it == arities->end()) return 0;
+  const DataType dtype = GetDataTypeFromAttr(node, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return 0;
+  return node.input_size() == it->second ? it->second : 0;
+}
+
 bool FindContractionWithBias(const RemapperContext& ctx, int node_index,
                              ContractionWithBiasAdd* matched,
                              bool check_device_compatible = true) {
@@ -712,6 +798,374 @@ bool FindFusedBatchNorm(const RemapperContext& ctx, int node_index,
 
 // NOTE(ezhulenev): See `BatchnormSpatialPersistentEnabled` documentation in the
 // `tensorflow/stream_executor/cuda/cuda_dnn.cc` for details.
+bool FindFusedElementwise(const RemapperContext& ctx, int node_index,
+                          const std::vector<bool>& invalidated_nodes,
+                          const std::vector<bool>& nodes_to_delete,
+                          FusedElementwise* matched) {
+  const auto* root_view = ctx.graph_view.GetNode(node_index);
+  const auto* root_def = root_view->node();
+  if (FusedElementwiseArity(*root_def) == 0 || !NodeIsOnCpu(root_def) ||
+      HasControlFaninOrFanout(*root_view) ||
+      !ctx.graph_properties.HasOutputProperties(root_def->name())) {
+    return false;
+  }
+  const TensorShapeProto& shape =
+      ctx.graph_properties.GetOutputProperties(root_def->name())[0].shape();
+  if (Rank(shape) < 1) return false;
+
+  // Grow the chain from the root through the fanins that have no other
+  // consumers and the shape of the root.
+  const auto can_fuse = [&](const utils::MutableNodeView& node_view) {
+    const int index = node_view.node_index();
+    const NodeDef* node = node_view.node();
+    return !invalidated_nodes[index] && !nodes_to_delete[index] &&
+           FusedElementwiseArity(*node) > 0 &&
+           node->device() == root_def->device() &&
+           HaveSameDataType(node, root_def) &&
+           !HasControlFaninOrFanout(node_view) &&
+           node_view.NumRegularFanouts() == 1 && !IsInPreserveSet(ctx, node) &&
+           ctx.graph_properties.HasOutputProperties(node->name()) &&
+           ShapesSymbolicallyEqual(
+               ctx.graph_properties.GetOutputProperties(node->name())[0]
+                   .shape(),
+               shape);
+  };
+  absl::flat_hash_set<int> fused = {node_index};
+  std::vector<int> to_visit = {node_index};
+  while (!to_visit.empty()) {
+    const auto* node_view = ctx.graph_view.GetNode(to_visit.back());
+    to_visit.pop_back();
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      const auto* fanin_view = node_view->GetRegularFanin(i).node_view();
+      if (fused.size() < kMaxFusedElementwiseOps &&
+          !fused.contains(fanin_view->node_index()) && can_fuse(*fanin_view)) {
+        fused.insert(fanin_view->node_index());
+        to_visit.push_back(fanin_view->node_index());
+      }
+    }
+  }
+  if (fused.size() < 2) return false;
+
+  // Nodes are sorted topologically, so that the operands of an op come before
+  // it.
+  FusedElementwise pattern;
+  pattern.ops.assign(fused.begin(), fused.end());
+  std::sort(pattern.ops.begin(), pattern.ops.end());
+  absl::flat_hash_map<int, int> op_results;
+  absl::flat_hash_map<string, int> arg_indices;
+  std::vector<int> op_operands;
+  for (int op : pattern.ops) {
+    const auto* node_view = ctx.graph_view.GetNode(op);
+    const NodeDef* node = node_view->node();
+    const std::vector<OpInfo::TensorProperties>& input_props =
+        ctx.graph_properties.GetInputProperties(node->name());
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      const int fanin = node_view->GetRegularFanin(i).node_index();
+      auto fused_fanin = op_results.find(fanin);
+      if (fused_fanin != op_results.end()) {
+        op_operands.push_back(-1 - fused_fanin->second);
+        continue;
+      }
+      // Inputs of the chain are broadcast if they are scalars, and must have
+      // the shape of the chain otherwise.
+      if (i >= input_props.size() ||
+          (Rank(input_props[i].shape()) != 0 &&
+           !ShapesSymbolicallyEqual(input_props[i].shape(), shape))) {
+        return false;
+      }
+      const string arg = ParseTensorName(node->input(i)).ToString();
+      auto inserted = arg_indices.emplace(arg, pattern.args.size());
+      if (inserted.second) pattern.args.push_back(arg);
+      op_operands.push_back(inserted.first->second);
+    }
+    const int result = op_results.size();
+    op_results[op] = result;
+  }
+  // Results of the ops come after the arguments.
+  for (int operand : op_operands) {
+    pattern.operands.push_back(
+        operand >= 0 ? operand : pattern.args.size() - 1 - operand);
+  }
+
+  *matched = std::move(pattern);
+  return true;
+}
+
+// Reads the value of a Const node.
+bool GetConstTensor(const NodeDef& node, Tensor* tensor) {
+  if (!IsConstant(node) || node.attr().count("value") == 0) return false;
+  return tensor->FromProto(node.attr().at("value").tensor());
+}
+
+bool FindFusedLayerNorm(const RemapperContext& ctx, int node_index,
+                        const std::vector<bool>& invalidated_nodes,
+                        const std::vector<bool>& nodes_to_delete,
+                        FusedLayerNorm* matched) {
+  const auto* output_view = ctx.graph_view.GetNode(node_index);
+  const NodeDef* output_def = output_view->node();
+  if (!IsAdd(*output_def) || !NodeIsOnCpu(output_def) ||
+      !HasDataType(output_def, DT_FLOAT) ||
+      HasControlFaninOrFanout(*output_view) ||
+      output_view->NumRegularFanins() != 2) {
+    return false;
+  }
+
+  // Returns the regular fanin `i` of `node_view` if it is produced by output 0
+  // of a node for which `is_op` is true, and nullptr otherwise.
+  using NodeView = utils::MutableNodeView;
+  const auto fanin = [](const NodeView* node_view, int i,
+                        bool (*is_op)(const NodeDef&)) -> NodeView* {
+    if (node_view->NumRegularFanins() <= i) return nullptr;
+    const auto& fanin_view = node_view->GetRegularFanin(i);
+    if (fanin_view.index() != 0 || !is_op(*fanin_view.node_view()->node())) {
+      return nullptr;
+    }
+    return fanin_view.node_view();
+  };
+  // Returns the fanin of the binary op `node_view` for which `is_op` is true,
+  // and sets `other` to the index of its other fanin.
+  const auto either_fanin = [&](const NodeView* node_view,
+                                bool (*is_op)(const NodeDef&),
+                                int* other) -> NodeView* {
+    for (int i = 0; i < 2; ++i) {
+      NodeView* found = fanin(node_view, i, is_op);
+      if (found != nullptr) {
+        *other = 1 - i;
+        return found;
+      }
+    }
+    return nullptr;
+  };
+  const auto same_fanin = [](const NodeView* a, int i, const NodeView* b,
+                             int j) {
+    return a->GetRegularFanin(i).node_index() ==
+               b->GetRegularFanin(j).node_index() &&
+           a->GetRegularFanin(i).index() == b->GetRegularFanin(j).index();
+  };
+
+  // output = Add(Mul(x, inv), Sub(offset, Mul(mean, inv)))
+  int scaled_x_index;
+  NodeView* sub = either_fanin(output_view, IsSub, &scaled_x_index);
+  if (sub == nullptr) return false;
+  NodeView* scaled_x = fanin(output_view, scaled_x_index, IsMul);
+  NodeView* scaled_mean = fanin(sub, 1, IsMul);
+  if (scaled_x == nullptr || scaled_mean == nullptr) return false;
+  int inv_index;
+  NodeView* mean = either_fanin(scaled_mean, IsMean, &inv_index);
+  if (mean == nullptr) return false;
+  NodeView* inv = fanin(scaled_mean, inv_index, IsMul);
+  if (inv == nullptr) return false;
+  int x_index = -1;
+  for (int i = 0; i < 2; ++i) {
+    if (same_fanin(scaled_x, i, scaled_mean, inv_index)) x_index = 1 - i;
+  }
+  if (x_index < 0) return false;
+
+  // inv = Mul(Rsqrt(Add(variance, epsilon)), scale)
+  int scale_index;
+  NodeView* rsqrt = either_fanin(inv, IsRsqrt, &scale_index);
+  if (rsqrt == nullptr) return false;
+  NodeView* add_epsilon = fanin(rsqrt, 0, IsAdd);
+  if (add_epsilon == nullptr) return false;
+  int epsilon_index;
+  NodeView* variance = either_fanin(add_epsilon, IsMean, &epsilon_index);
+  if (variance == nullptr) return false;
+  Tensor epsilon;
+  if (!GetConstTensor(
+          *add_epsilon->GetRegularFanin(epsilon_index).node_view()->node(),
+          &epsilon) ||
+      epsilon.dtype() != DT_FLOAT || epsilon.NumElements() != 1) {
+    return false;
+  }
+
+  // variance = Mean(SquaredDifference(x, [StopGradient](mean)), axes)
+  NodeView* squared_difference = fanin(variance, 0, IsSquaredDifference);
+  if (squared_difference == nullptr ||
+      !same_fanin(squared_difference, 0, scaled_x, x_index) ||
+      !same_fanin(mean, 0, scaled_x, x_index)) {
+    return false;
+  }
+  NodeView* stop_gradient = fanin(squared_difference, 1, IsStopGradient);
+  NodeView* mean_input =
+      stop_gradient != nullptr ? fanin(stop_gradient, 0, IsMean)
+                               : fanin(squared_difference, 1, IsMean);
+  if (mean_input != mean) return false;
+
+  // Both means must keep the dimensions, and reduce only the last one.
+  const auto& x_props =
+      ctx.graph_properties.GetInputProperties(scaled_x->node()->name());
+  if (x_props.size() != 2) return false;
+  const TensorShapeProto& x_shape = x_props[x_index].shape();
+  const int rank = Rank(x_shape);
+  if (rank < 1 || !IsKnown(x_shape.dim(rank - 1))) return false;
+  const int64 depth = x_shape.dim(rank - 1).size();
+  for (const NodeView* reduction : {mean, variance}) {
+    const auto* keep_dims = reduction->GetAttr("keep_dims");
+    if (keep_dims == nullptr || !keep_dims->b()) return false;
+    Tensor axes;
+    if (reduction->NumRegularFanins() != 2 ||
+        !GetConstTensor(*reduction->GetRegularFanin(1).node_view()->node(),
+                        &axes) ||
+        axes.NumElements() != 1) {
+      return false;
+    }
+    const int64 axis = axes.dtype() == DT_INT32 ? axes.flat<int32>()(0)
+                                                : axes.flat<int64>()(0);
+    if (axis != -1 && axis != rank - 1) return false;
+  }
+
+  // The scale and the offset must be vectors over the last dimension.
+  const auto is_depth_vector = [&](const NodeView* node_view, int i) {
+    const auto& props =
+        ctx.graph_properties.GetInputProperties(node_view->node()->name());
+    return i < props.size() && Rank(props[i].shape()) == 1 &&
+           props[i].shape().dim(0).size() == depth;
+  };
+  if (!is_depth_vector(inv, scale_index) || !is_depth_vector(sub, 0)) {
+    return false;
+  }
+
+  // The intermediate results must not be used outside of the subgraph.
+  std::vector<int> fused_nodes = {
+      scaled_x->node_index(),    sub->node_index(),
+      scaled_mean->node_index(), inv->node_index(),
+      rsqrt->node_index(),       add_epsilon->node_index(),
+      variance->node_index(),    squared_difference->node_index(),
+      mean->node_index()};
+  if (stop_gradient != nullptr) {
+    fused_nodes.push_back(stop_gradient->node_index());
+  }
+  absl::flat_hash_set<int> fused(fused_nodes.begin(), fused_nodes.end());
+  fused.insert(node_index);
+  for (int index : fused_nodes) {
+    const auto* node_view = ctx.graph_view.GetNode(index);
+    const NodeDef* node = node_view->node();
+    if (invalidated_nodes[index] || nodes_to_delete[index] ||
+        node->device() != output_def->device() ||
+        !HaveSameDataType(node, output_def) ||
+        HasControlFaninOrFanout(*node_view) || IsInPreserveSet(ctx, node)) {
+      return false;
+    }
+    for (const auto& fanouts : node_view->GetRegularFanouts()) {
+      for (const auto& fanout : fanouts) {
+        if (!fused.contains(fanout.node_index())) return false;
+      }
+    }
+  }
+
+  matched->output = node_index;
+  matched->fused_nodes = std::move(fused_nodes);
+  matched->x = scaled_x->node()->input(x_index);
+  matched->scale = inv->node()->input(scale_index);
+  matched->offset = sub->node()->input(0);
+  matched->epsilon = epsilon.flat<float>()(0);
+  return true;
+}
+
+bool FindFusedAttention(const RemapperContext& ctx, int node_index,
+                        const std::vector<bool>& invalidated_nodes,
+                        const std::vector<bool>& nodes_to_delete,
+                        FusedAttention* matched) {
+  const auto* output_view = ctx.graph_view.GetNode(node_index);
+  const NodeDef* output_def = output_view->node();
+  const auto has_adjoints = [](const utils::MutableNodeView& node_view,
+                               bool adj_x, bool adj_y) {
+    const auto* adj_x_attr = node_view.GetAttr("adj_x");
+    const auto* adj_y_attr = node_view.GetAttr("adj_y");
+    return adj_x_attr != nullptr && adj_x_attr->b() == adj_x &&
+           adj_y_attr != nullptr && adj_y_attr->b() == adj_y;
+  };
+  if (!IsAnyBatchMatMul(*output_def) || !NodeIsOnCpu(output_def) ||
+      !HasDataType(output_def, DT_FLOAT) ||
+      HasControlFaninOrFanout(*output_view) ||
+      output_view->NumRegularFanins() != 2 ||
+      !has_adjoints(*output_view, false, false)) {
+    return false;
+  }
+
+  // Each intermediate node must be read only by the next node of the
+  // pattern, through output 0.
+  std::vector<int> fused_nodes;
+  const auto fused_fanin =
+      [&](const utils::MutableNodeView* node_view,
+          int i) -> const utils::MutableNodeView* {
+    const auto& fanin = node_view->GetRegularFanin(i);
+    const auto* fanin_view = fanin.node_view();
+    const NodeDef* fanin_def = fanin_view->node();
+    const int index = fanin_view->node_index();
+    if (fanin.index() != 0 || invalidated_nodes[index] ||
+        nodes_to_delete[index] || fanin_def->device() != output_def->device() ||
+        !HaveSameDataType(fanin_def, output_def) ||
+        HasControlFaninOrFanout(*fanin_view) ||
+        fanin_view->NumRegularFanouts() != 1 ||
+        IsInPreserveSet(ctx, fanin_def)) {
+      return nullptr;
+    }
+    fused_nodes.push_back(index);
+    return fanin_view;
+  };
+
+  const auto* softmax = fused_fanin(output_view, 0);
+  if (softmax == nullptr || !IsSoftmax(*softmax->node())) return false;
+  const auto* scores = fused_fanin(softmax, 0);
+  if (scores == nullptr) return false;
+
+  // The scores may be scaled by a scalar constant.
+  float scale = 1.0;
+  if (IsMul(*scores->node()) || IsRealDiv(*scores->node())) {
+    const bool is_div = IsRealDiv(*scores->node());
+    const auto* scale_op = scores;
+    if (scale_op->NumRegularFanins() != 2) return false;
+    Tensor scale_tensor;
+    int scores_index = -1;
+    for (int i = is_div ? 1 : 0; i < 2; ++i) {
+      if (GetConstTensor(*scale_op->GetRegularFanin(i).node_view()->node(),
+                         &scale_tensor) &&
+          scale_tensor.dtype() == DT_FLOAT && scale_tensor.dims() == 0) {
+        scores_index = 1 - i;
+        break;
+      }
+    }
+    if (scores_index < 0) return false;
+    scale = scale_tensor.scalar<float>()();
+    if (is_div) scale = 1.0f / scale;
+    scores = fused_fanin(scale_op, scores_index);
+    if (scores == nullptr) return false;
+  }
+  if (!IsAnyBatchMatMul(*scores->node()) ||
+      scores->NumRegularFanins() != 2 ||
+      !has_adjoints(*scores, false, true)) {
+    return false;
+  }
+
+  // The fused op does not broadcast, so the leading dimensions of query, key
+  // and value must be known to be equal.
+  const auto& scores_props =
+      ctx.graph_properties.GetInputProperties(scores->node()->name());
+  const auto& output_props =
+      ctx.graph_properties.GetInputProperties(output_def->name());
+  if (scores_props.size() != 2 || output_props.size() != 2) return false;
+  const TensorShapeProto& query_shape = scores_props[0].shape();
+  const int rank = Rank(query_shape);
+  if (rank < 2) return false;
+  for (const TensorShapeProto* shape :
+       {&scores_props[1].shape(), &output_props[1].shape()}) {
+    if (Rank(*shape) != rank) return false;
+    for (int i = 0; i < rank - 2; ++i) {
+      const int64 size = query_shape.dim(i).size();
+      if (size == -1 || shape->dim(i).size() != size) return false;
+    }
+  }
+
+  matched->output = node_index;
+  matched->fused_nodes = std::move(fused_nodes);
+  matched->query = scores->node()->input(0);
+  matched->key = scores->node()->input(1);
+  matched->value = output_def->input(1);
+  matched->scale = scale;
+  return true;
+}
+
 bool BatchnormSpatialPersistentEnabled() {
 #if CUDNN_VERSION >= 7402
   static bool is_enabled = [] {
@@ -1274,6 +1728,108 @@ Status AddFusedBatchNormExNode(RemapperContext* ctx,
   return Status::OK();
 }
 
+Status AddFusedElementwiseNode(RemapperContext* ctx,
+                               const FusedElementwise& matched,
+                               std::vector<bool>* invalidated_nodes,
+                               std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& root = graph->node(matched.ops.back());
+  VLOG(2) << "Fuse " << matched.ops.size()
+          << " element-wise ops into _FusedElementwise: root=" << root.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_op(kFusedElementwise);
+  fused_op.set_device(root.device());
+  for (const string& arg : matched.args) fused_op.add_input(arg);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(static_cast<int>(matched.args.size()), &(*attr)["num_args"]);
+  std::vector<string> fused_ops;
+  for (int op : matched.ops) fused_ops.push_back(graph->node(op).op());
+  SetAttrValue(fused_ops, &(*attr)["fused_ops"]);
+  SetAttrValue(matched.operands, &(*attr)["fused_operands"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.ops.back()] = true;
+  for (int i = 0; i + 1 < matched.ops.size(); ++i) {
+    (*nodes_to_delete)[matched.ops[i]] = true;
+  }
+
+  return Status::OK();
+}
+
+Status AddFusedLayerNormNode(RemapperContext* ctx,
+                             const FusedLayerNorm& matched,
+                             std::vector<bool>* invalidated_nodes,
+                             std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+  VLOG(2) << "Fuse layer normalization into _FusedLayerNorm: output="
+          << output.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(output.name());
+  fused_op.set_op(kFusedLayerNorm);
+  fused_op.set_device(output.device());
+  fused_op.add_input(matched.x);
+  fused_op.add_input(matched.scale);
+  fused_op.add_input(matched.offset);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = output.attr().at("T");
+  SetAttrValue(matched.epsilon, &(*attr)["epsilon"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  for (int node : matched.fused_nodes) (*nodes_to_delete)[node] = true;
+
+  return Status::OK();
+}
+
+Status AddFusedAttentionNode(RemapperContext* ctx,
+                             const FusedAttention& matched,
+                             std::vector<bool>* invalidated_nodes,
+                             std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& output = graph->node(matched.output);
+  VLOG(2) << "Fuse attention into _FusedAttention: output=" << output.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(output.name());
+  fused_op.set_op(kFusedAttention);
+  fused_op.set_device(output.device());
+  fused_op.add_input(matched.query);
+  fused_op.add_input(matched.key);
+  fused_op.add_input(matched.value);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = output.attr().at("T");
+  SetAttrValue(matched.scale, &(*attr)["scale"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.output] = true;
+  for (int node : matched.fused_nodes) (*nodes_to_delete)[node] = true;
+
+  return Status::OK();
+}
+
 Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
   const GraphDef* graph = ctx->graph_view.graph();
   const NodeDef& fused_node = graph->node(matched.fused_batch_norm);
@@ -1461,6 +2017,9 @@ Status AddBatchNormNodes(RemapperContext* ctx, const FusedBatchNorm& matched) {
 // shapes:
 //   (1) Splitting FusedBatchNorm into primitives.
 //   (2) Fusing side input and/or activation into FusedBatchNorm.
+//   (3) Fusing chains of element-wise ops.
+//   (4) Fusing layer normalization.
+//   (5) Fusing attention.
 bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
   // Candidate for a FusedBatchNorm splitting.
   const auto* node_view = ctx.graph_view.GetNode(node_index);
@@ -1506,7 +2065,65 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index) {
     return false;
   };
 
-  return is_batch_norm_candidate() || is_batch_norm_fusion_candidate();
+  // Candidate for an element-wise ops fusion.
+  const auto is_elementwise_fusion_candidate = [&]() -> bool {
+    if (FusedElementwiseArity(*node_def) == 0 || !NodeIsOnCpu(node_def)) {
+      return false;
+    }
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      const auto* fanin_view = node_view->GetRegularFanin(i).node_view();
+      if (FusedElementwiseArity(*fanin_view->node()) > 0 &&
+          fanin_view->NumRegularFanouts() == 1) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Candidate for a layer normalization fusion.
+  const auto is_layer_norm_fusion_candidate = [&]() -> bool {
+    if (!IsAdd(*node_def) || !NodeIsOnCpu(node_def)) return false;
+    for (int i = 0; i < node_view->NumRegularFanins(); ++i) {
+      if (IsSub(*node_view->GetRegularFanin(i).node_view()->node())) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Candidate for an attention fusion.
+  const auto is_attention_fusion_candidate = [&]() -> bool {
+    if (!IsAnyBatchMatMul(*node_def) || !NodeIsOnCpu(node_def)) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    return IsSoftmax(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
+  return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
+         is_elementwise_fusion_candidate() ||
+         is_layer_norm_fusion_candidate() || is_attention_fusion_candidate();
+}
+
+// Lets the CPU {MatMul,_FusedMatMul} kernels keep a transposed or float copy
+// of a constant RHS across steps instead of recomputing it on every call.
+void SetCacheRhsAttributes(RemapperContext* ctx) {
+  for (int i = 0; i < ctx->graph_view.NumNodes(); ++i) {
+    utils::MutableNodeView* node_view = ctx->graph_view.GetNode(i);
+    NodeDef* node = node_view->node();
+    if (!IsMatMul(*node) && node->op() != kFusedMatMul) continue;
+    if (!NodeIsOnCpu(node) || node_view->NumRegularFanins() < 2) continue;
+    if (!IsConstant(*node_view->GetRegularFanin(1).node_view()->node())) {
+      continue;
+    }
+
+    const auto& attr = node->attr();
+    const bool transpose_b =
+        attr.count("transpose_b") > 0 && attr.at("transpose_b").b();
+    const bool is_bfloat16 =
+        attr.count("T") > 0 && attr.at("T").type() == DT_BFLOAT16;
+    if (transpose_b || is_bfloat16) {
+      SetAttrValue(true, &(*node->mutable_attr())[kCacheRhs]);
+    }
+  }
 }
 
 }  // namespace
@@ -1651,6 +2268,38 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       TF_RETURN_IF_ERROR(AddBatchNormNodes(&ctx, fused_batch_norm));
       continue;
     }
+
+    // Remap BatchMatMul+Softmax+BatchMatMul on CPU into the _FusedAttention.
+    FusedAttention fused_attention;
+    if (allow_non_differentiable_rewrites &&
+        FindFusedAttention(ctx, i, invalidated_nodes, nodes_to_delete,
+                           &fused_attention)) {
+      TF_RETURN_IF_ERROR(AddFusedAttentionNode(
+          &ctx, fused_attention, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap layer normalization on CPU into the _FusedLayerNorm. This must
+    // come before the element-wise fusion, which would otherwise take the
+    // final ops of the subgraph.
+    FusedLayerNorm fused_layer_norm;
+    if (allow_non_differentiable_rewrites &&
+        FindFusedLayerNorm(ctx, i, invalidated_nodes, nodes_to_delete,
+                           &fused_layer_norm)) {
+      TF_RETURN_IF_ERROR(AddFusedLayerNormNode(
+          &ctx, fused_layer_norm, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
+
+    // Remap chains of element-wise ops on CPU into the _FusedElementwise.
+    FusedElementwise fused_elementwise;
+    if (allow_non_differentiable_rewrites &&
+        FindFusedElementwise(ctx, i, invalidated_nodes, nodes_to_delete,
+                             &fused_elementwise)) {
+      TF_RETURN_IF_ERROR(AddFusedElementwiseNode(
+          &ctx, fused_elementwise, &invalidated_nodes, &nodes_to_delete));
+      continue;
+    }
   }
 
   // Remove invalidated nodes.
@@ -1662,6 +2311,8 @@ Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   }
   TF_RETURN_IF_ERROR(mutation->Apply());
 
+  SetCacheRhsAttributes(&ctx);
+
   *optimized_graph = mutable_item.graph;
 
   return Status::OK();
@@ -449,6 +449,362 @@ TEST_F(RemapperTest, FuseMatMulWithBias) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(RemapperTest, CacheConstantTransposedMatMulRhs) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto lhs = Placeholder(s.WithOpName("lhs"), DT_FLOAT,
+                         ops::Placeholder::Shape({8, 32}));
+  auto rhs = Placeholder(s.WithOpName("rhs"), DT_FLOAT,
+                         ops::Placeholder::Shape({64, 32}));
+  auto weights = ops::Const(s.WithOpName("weights"),
+                            Input::Initializer(
+                                GenerateRandomTensor<DT_FLOAT>({64, 32})));
+  auto transpose_b = ops::MatMul::TransposeB(true);
+  auto const_matmul =
+      ops::MatMul(s.WithOpName("const_matmul"), lhs, weights, transpose_b);
+  auto matmul = ops::MatMul(s.WithOpName("matmul"), lhs, rhs, transpose_b);
+  auto fetch = ops::AddN(s.WithOpName("fetch"), {const_matmul, matmul});
+
+  auto lhs_t = GenerateRandomTensor<DT_FLOAT>({8, 32});
+  auto rhs_t = GenerateRandomTensor<DT_FLOAT>({64, 32});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"lhs", lhs_t}, {"rhs", rhs_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    if (node.name() == "const_matmul") {
+      ASSERT_EQ(node.attr().count("_cache_rhs"), 1);
+      EXPECT_TRUE(node.attr().at("_cache_rhs").b());
+      found++;
+    } else if (node.name() == "matmul") {
+      EXPECT_EQ(node.attr().count("_cache_rhs"), 0);
+      found++;
+    }
+  }
+  EXPECT_EQ(2, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, FuseElementwiseChain) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // The tanh approximation of GELU.
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 32}));
+  auto half = ops::Const(s.WithOpName("half"), 0.5f);
+  auto one = ops::Const(s.WithOpName("one"), 1.0f);
+  auto c1 = ops::Const(s.WithOpName("c1"), 0.044715f);
+  auto c2 = ops::Const(s.WithOpName("c2"), 0.7978846f);
+  auto x2 = ops::Mul(s.WithOpName("x2"), x, x);
+  auto x3 = ops::Mul(s.WithOpName("x3"), x2, x);
+  auto inner = ops::AddV2(s.WithOpName("inner"), x,
+                          ops::Mul(s.WithOpName("scaled_x3"), c1, x3));
+  auto tanh =
+      ops::Tanh(s.WithOpName("tanh"), ops::Mul(s.WithOpName("arg"), c2, inner));
+  auto gelu = ops::Mul(s.WithOpName("gelu"),
+                       ops::Mul(s.WithOpName("half_x"), half, x),
+                       ops::AddV2(s.WithOpName("one_plus"), one, tanh));
+  auto fetch = ops::Identity(s.WithOpName("fetch"), gelu);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 32});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "tanh");
+    EXPECT_NE(node.name(), "x2");
+    if (node.name() == "gelu") {
+      EXPECT_EQ(node.op(), "_FusedElementwise");
+      EXPECT_EQ(node.attr().at("num_args").i(), 5);
+      ASSERT_EQ(node.input_size(), 5);
+      EXPECT_EQ(node.attr().at("fused_ops").list().s_size(), 9);
+      EXPECT_EQ(node.attr().at("fused_ops").list().s(8), "Mul");
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(RemapperTest, DoesNotFuseElementwiseOpsWithOtherConsumers) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 32}));
+  auto exp = ops::Exp(s.WithOpName("exp"), x);
+  auto relu = ops::Relu(s.WithOpName("relu"), exp);
+  auto fetch0 = ops::Identity(s.WithOpName("fetch0"), relu);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), exp);
+
+  GrapplerItem item;
+  item.fetch = {"fetch0", "fetch1"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedElementwise");
+  }
+}
+
+TEST_F(RemapperTest, FuseAttention) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto shape = ops::Placeholder::Shape({2, 4, 8, 16});
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT, shape);
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT, shape);
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT, shape);
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto scaled = ops::Mul(s.WithOpName("scaled"), scores,
+                         ops::Const(s.WithOpName("scale"), 0.25f));
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), scaled);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  auto query_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 8, 16});
+  auto key_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 8, 16});
+  auto value_t = GenerateRandomTensor<DT_FLOAT>({2, 4, 8, 16});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"query", query_t}, {"key", key_t}, {"value", value_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "scores");
+    EXPECT_NE(node.name(), "softmax");
+    if (node.name() == "attention") {
+      EXPECT_EQ(node.op(), "_FusedAttention");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "query");
+      EXPECT_EQ(node.input(1), "key");
+      EXPECT_EQ(node.input(2), "value");
+      EXPECT_FLOAT_EQ(node.attr().at("scale").f(), 0.25f);
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+}
+
+TEST_F(RemapperTest, DoesNotFuseAttentionWithBroadcastKey) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto query = Placeholder(s.WithOpName("query"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 8, 16}));
+  auto key = Placeholder(s.WithOpName("key"), DT_FLOAT,
+                         ops::Placeholder::Shape({1, 8, 16}));
+  auto value = Placeholder(s.WithOpName("value"), DT_FLOAT,
+                           ops::Placeholder::Shape({2, 8, 16}));
+  auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                   ops::BatchMatMulV2::AdjY(true));
+  auto softmax = ops::Softmax(s.WithOpName("softmax"), scores);
+  auto attention =
+      ops::BatchMatMulV2(s.WithOpName("attention"), softmax, value);
+  auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedAttention");
+  }
+}
+
+TEST_F(RemapperTest, FuseLayerNorm) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // tf.nn.moments + tf.nn.batch_normalization over the last dimension.
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 16, 32}));
+  auto scale = Placeholder(s.WithOpName("scale"), DT_FLOAT,
+                           ops::Placeholder::Shape({32}));
+  auto offset = Placeholder(s.WithOpName("offset"), DT_FLOAT,
+                            ops::Placeholder::Shape({32}));
+  auto axes = ops::Const(s.WithOpName("axes"), {-1});
+  auto epsilon = ops::Const(s.WithOpName("epsilon"), 0.001f);
+  auto mean = ops::Mean(s.WithOpName("mean"), x, axes,
+                        ops::Mean::KeepDims(true));
+  auto variance = ops::Mean(
+      s.WithOpName("variance"),
+      ops::SquaredDifference(
+          s.WithOpName("squared_difference"), x,
+          ops::StopGradient(s.WithOpName("stop_gradient"), mean)),
+      axes, ops::Mean::KeepDims(true));
+  auto inv = ops::Mul(
+      s.WithOpName("inv"),
+      ops::Rsqrt(s.WithOpName("rsqrt"),
+                 ops::AddV2(s.WithOpName("add_epsilon"), variance, epsilon)),
+      scale);
+  auto layer_norm = ops::AddV2(
+      s.WithOpName("layer_norm"), ops::Mul(s.WithOpName("scaled_x"), x, inv),
+      ops::Sub(s.WithOpName("sub"), offset,
+               ops::Mul(s.WithOpName("scaled_mean"), mean, inv)));
+  auto fetch = ops::Identity(s.WithOpName("fetch"), layer_norm);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>({8, 16, 32});
+  auto scale_t = GenerateRandomTensor<DT_FLOAT>({32});
+  auto offset_t = GenerateRandomTensor<DT_FLOAT>({32});
+
+  GrapplerItem item;
+  item.fetch = {"fetch"};
+  item.feed = {{"x", x_t}, {"scale", scale_t}, {"offset", offset_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "mean");
+    EXPECT_NE(node.name(), "rsqrt");
+    EXPECT_NE(node.name(), "scaled_x");
+    if (node.name() == "layer_norm") {
+      EXPECT_EQ(node.op(), "_FusedLayerNorm");
+      ASSERT_EQ(node.input_size(), 3);
+      EXPECT_EQ(node.input(0), "x");
+      EXPECT_EQ(node.input(1), "scale");
+      EXPECT_EQ(node.input(2), "offset");
+      EXPECT_FLOAT_EQ(node.attr().at("epsilon").f(), 0.001f);
+      found++;
+    }
+  }
+  EXPECT_EQ(1, found);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-4);
+}
+
+TEST_F(RemapperTest, DoesNotFuseLayerNormWithFetchedMoments) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                       ops::Placeholder::Shape({8, 32}));
+  auto scale = Placeholder(s.WithOpName("scale"), DT_FLOAT,
+                           ops::Placeholder::Shape({32}));
+  auto offset = Placeholder(s.WithOpName("offset"), DT_FLOAT,
+                            ops::Placeholder::Shape({32}));
+  auto axes = ops::Const(s.WithOpName("axes"), {-1});
+  auto mean = ops::Mean(s.WithOpName("mean"), x, axes,
+                        ops::Mean::KeepDims(true));
+  auto variance = ops::Mean(
+      s.WithOpName("variance"),
+      ops::SquaredDifference(s.WithOpName("squared_difference"), x, mean),
+      axes, ops::Mean::KeepDims(true));
+  auto inv = ops::Mul(
+      s.WithOpName("inv"),
+      ops::Rsqrt(s.WithOpName("rsqrt"),
+                 ops::AddV2(s.WithOpName("add_epsilon"), variance,
+                            ops::Const(s.WithOpName("epsilon"), 0.001f))),
+      scale);
+  auto layer_norm = ops::AddV2(
+      s.WithOpName("layer_norm"), ops::Mul(s.WithOpName("scaled_x"), x, inv),
+      ops::Sub(s.WithOpName("sub"), offset,
+               ops::Mul(s.WithOpName("scaled_mean"), mean, inv)));
+  auto fetch0 = ops::Identity(s.WithOpName("fetch0"), layer_norm);
+  auto fetch1 = ops::Identity(s.WithOpName("fetch1"), variance);
+
+  GrapplerItem item;
+  item.fetch = {"fetch0", "fetch1"};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.op(), "_FusedLayerNorm");
+  }
+}
+
 TEST_F(RemapperTest, FuseConv2DWithBiasAndActivation) {
   using ::tensorflow::ops::Placeholder;
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 
 // Like TF_RETURN_IF_ERROR, but also logs a WARNING.
@@ -867,7 +868,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level), max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -1072,6 +1073,17 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
     // TODO(ezhulenev): Pass a GraphView when this optimizer will be migrated
     // from NodeMap.
     LOG_WARNING_AND_RETURN_IF_ERROR(frame_view.InferFromGraph(*graph));
+    // The position of each node in a topological order approximates when it
+    // becomes ready, which orders the nodes for bucketing.
+    absl::flat_hash_map<string, int> ready_order;
+    if (max_bucket_bytes_ > 0) {
+      std::vector<const NodeDef*> topo_order;
+      LOG_WARNING_AND_RETURN_IF_ERROR(
+          ComputeTopologicalOrder(*graph, &topo_order));
+      for (int i = 0; i < topo_order.size(); ++i) {
+        ready_order[topo_order[i]->name()] = i;
+      }
+    }
 
     for (auto& dt : occ) {
       VLOG(2) << "Processing device " << dt.first;
@@ -1100,12 +1112,21 @@ Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
+                                         &ready_order, &graph_properties,
                                          &op_name, invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
           if (t->nodes_.size() > 1) {
             std::vector<std::vector<NodeDef*>> loop_groups;
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
+            if (max_bucket_bytes_ > 0) {
+              std::vector<std::vector<NodeDef*>> buckets;
+              for (auto& lg : loop_groups) {
+                PartitionIntoBuckets(ready_order, graph_properties,
+                                     std::move(lg), &buckets);
+              }
+              loop_groups = std::move(buckets);
+            }
             for (auto& lg : loop_groups) {
               if (lg.size() > 1) {
                 bool applied = false;
@@ -1183,6 +1204,48 @@ Status ScopedAllocatorOptimizer::OrderNodeSet(
   return Status::OK();
 }
 
+void ScopedAllocatorOptimizer::PartitionIntoBuckets(
+    const absl::flat_hash_map<string, int>& ready_order,
+    const GraphProperties& graph_properties, std::vector<NodeDef*> nodes,
+    std::vector<std::vector<NodeDef*>>* buckets) const {
+  auto ready_position = [&ready_order](const NodeDef* n) {
+    auto it = ready_order.find(n->name());
+    return it == ready_order.end() ? -1 : it->second;
+  };
+  std::stable_sort(nodes.begin(), nodes.end(),
+                   [&ready_position](const NodeDef* a, const NodeDef* b) {
+                     return ready_position(a) < ready_position(b);
+                   });
+  int64 bucket_bytes = 0;
+  bool start_bucket = true;
+  for (NodeDef* n : nodes) {
+    // Nodes with unknown output shapes are rejected by the rewriter anyway,
+    // so they do not count towards the size of their bucket.
+    int64 bytes = 0;
+    const std::vector<OpInfo::TensorProperties>& props =
+        graph_properties.GetOutputProperties(n->name());
+    if (!props.empty()) {
+      const int64 num_elements =
+          PartialTensorShape(props[0].shape()).num_elements();
+      if (num_elements > 0) {
+        bytes = num_elements * DataTypeSize(props[0].dtype());
+      }
+    }
+    if (!start_bucket && bucket_bytes + bytes > max_bucket_bytes_) {
+      start_bucket = true;
+    }
+    if (start_bucket) {
+      buckets->emplace_back();
+      bucket_bytes = 0;
+      start_bucket = false;
+    }
+    buckets->back().push_back(n);
+    bucket_bytes += bytes;
+  }
+  VLOG(2) << "Partitioned " << nodes.size() << " nodes into buckets of at "
+          << "most " << max_bucket_bytes_ << " bytes";
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
 
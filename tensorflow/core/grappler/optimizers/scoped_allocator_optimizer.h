@@ -110,7 +110,15 @@ class ScopedAllocatorOptimizer : public GraphOptimizer {
 
   Status OrderNodeSet(std::vector<NodeDef*>* nodes) const;
 
+  // Splits `nodes` into consecutive buckets, in the order given by
+  // `ready_order`, whose outputs take at most max_bucket_bytes_ bytes.
+  void PartitionIntoBuckets(
+      const absl::flat_hash_map<string, int>& ready_order,
+      const GraphProperties& graph_properties, std::vector<NodeDef*> nodes,
+      std::vector<std::vector<NodeDef*>>* buckets) const;
+
   RewriterConfig::Toggle opt_level_;
+  int64 max_bucket_bytes_;
   std::unordered_set<string> nodes_to_preserve_;
   OpNameSet op_name_set_;
   absl::flat_hash_map<string, Rewriter*> rewriters_;
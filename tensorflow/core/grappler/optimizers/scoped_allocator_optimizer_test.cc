@@ -237,6 +237,32 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     TF_CHECK_OK(root_scope.ToGraphDef(graph_def));
   }
 
+  // Constructs a graph in which a chain of Neg ops n1, n2, n3 delays the
+  // inputs of Add ops s1, s2, s3, s4 by 0, 1, 2, 3 steps, so that the Abs ops
+  // on them, abs_d, abs_c, abs_b, abs_a, become ready in the reverse order of
+  // their names.
+  void BuildAbsGraphWithStaggeredInputs(GraphDef* graph_def) {
+    Scope s = Scope::NewRootScope();
+    s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+
+    Output a =
+        ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+    Output b =
+        ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+    Output n1 = ops::Neg(s.WithOpName("n1"), a);
+    Output n2 = ops::Neg(s.WithOpName("n2"), n1);
+    Output n3 = ops::Neg(s.WithOpName("n3"), n2);
+    Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+    Output s2 = ops::Add(s.WithOpName("s2"), n1, b);
+    Output s3 = ops::Add(s.WithOpName("s3"), n2, b);
+    Output s4 = ops::Add(s.WithOpName("s4"), n3, b);
+    ops::Abs(s.WithOpName("abs_d"), s1);
+    ops::Abs(s.WithOpName("abs_c"), s2);
+    ops::Abs(s.WithOpName("abs_b"), s3);
+    ops::Abs(s.WithOpName("abs_a"), s4);
+    TF_CHECK_OK(s.ToGraphDef(graph_def));
+  }
+
   void SetShapes(GraphDef* graph_def) {
     TensorShapeProto shape_proto;
     shape_proto.add_dim()->set_size(2);
@@ -314,6 +340,15 @@ class ScopedAllocatorOptimizerTest : public ::testing::Test {
     return control_input_node;
   }
 
+  // Returns the name of the _ScopedAllocatorConcat node that reads the output
+  // of `node_name`, or the empty string.
+  string ConcatOfInput(NodeMap* node_map, const string& node_name) {
+    for (const NodeDef* output : node_map->GetOutputs(node_name)) {
+      if (output->op() == "_ScopedAllocatorConcat") return output->name();
+    }
+    return "";
+  }
+
   int NumControlInputs(NodeMap* node_map, const string& node_name) {
     NodeDef* node = nullptr;
     GetNode(node_map, node_name, &node);
@@ -478,6 +513,32 @@ TEST_F(ScopedAllocatorOptimizerTest, InputDependencies) {
   EXPECT_EQ(scoped_allocator_node->input(0), "^c");
 }
 
+// Test that max_bucket_bytes splits ops into buckets in the order in which they
+// become ready.
+TEST_F(ScopedAllocatorOptimizerTest, Buckets) {
+  GrapplerItem item;
+  BuildAbsGraphWithStaggeredInputs(&item.graph);
+  SetShapes(&item.graph);
+
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  // Room for the outputs of two Abs ops.
+  opts.set_max_bucket_bytes(2 * 4 * sizeof(float));
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(/*cluster=*/nullptr, item, &optimized_graph));
+  NodeMap node_map(&optimized_graph);
+
+  const string first_bucket = ConcatOfInput(&node_map, "s1");
+  const string second_bucket = ConcatOfInput(&node_map, "s3");
+  EXPECT_NE(first_bucket, "");
+  EXPECT_NE(second_bucket, "");
+  EXPECT_NE(first_bucket, second_bucket);
+  EXPECT_EQ(first_bucket, ConcatOfInput(&node_map, "s2"));
+  EXPECT_EQ(second_bucket, ConcatOfInput(&node_map, "s4"));
+}
+
 // Test that graphs with input and output control edges are rewired correctly by
 // the optimizer.
 TEST_F(ScopedAllocatorOptimizerTest, ControlEdgeRewire) {
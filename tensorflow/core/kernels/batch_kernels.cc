@@ -32,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -146,6 +147,94 @@ Status Concat(OpKernelContext* context, const gtl::ArraySlice<Tensor> inputs,
   return Status::OK();
 }
 
+// Copies 'inputs', whose element type is T, into consecutive rows of one
+// newly allocated batch tensor, followed by 'padding_rows' copies of its first
+// row. If 'padded_length' is not negative, dimension 1 of inputs of rank 2 or
+// more is padded with default values (zeros, or empty strings) up to it.
+//
+// Each input is written straight into its slot of the batch, so unlike
+// padding the inputs and then calling Concat(), every element is copied
+// once. Inputs are copied in parallel.
+template <typename T>
+Status BatchInputs(OpKernelContext* context,
+                   const gtl::ArraySlice<Tensor> inputs, int64 padded_length,
+                   int64 padding_rows, Tensor* output) {
+  const Tensor& first = inputs[0];
+  const bool pad_sequences = padded_length >= 0 && first.dims() >= 2;
+  std::vector<int64> row_offsets;
+  row_offsets.reserve(inputs.size() + 1);
+  row_offsets.push_back(0);
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    const Tensor& input = inputs[i];
+    if (input.dims() != first.dims()) {
+      return errors::InvalidArgument(
+          "Ranks of all input tensors should match: shape[0] = ",
+          first.shape().DebugString(), " vs. shape[", i,
+          "] = ", input.shape().DebugString());
+    }
+    for (int j = pad_sequences ? 2 : 1; j < first.dims(); ++j) {
+      if (input.dim_size(j) != first.dim_size(j)) {
+        return errors::InvalidArgument(
+            "Dimensions of inputs should match: shape[0] = ",
+            first.shape().DebugString(), " vs. shape[", i,
+            "] = ", input.shape().DebugString());
+      }
+    }
+    row_offsets.push_back(row_offsets.back() + input.dim_size(0));
+  }
+  const int64 num_rows = row_offsets.back();
+
+  TensorShape output_shape(first.shape());
+  output_shape.set_dim(0, num_rows + padding_rows);
+  if (pad_sequences) {
+    output_shape.set_dim(1, padded_length);
+  }
+  TF_RETURN_IF_ERROR(
+      context->allocate_temp(DataTypeToEnum<T>::value, output_shape, output));
+  if (output->NumElements() == 0) {
+    return Status::OK();
+  }
+  const int64 output_row_size = output->NumElements() / output->dim_size(0);
+  T* output_data = output->flat<T>().data();
+
+  auto copy_inputs = [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      const Tensor& input = inputs[i];
+      const int64 rows = input.dim_size(0);
+      if (rows == 0) {
+        continue;
+      }
+      const int64 input_row_size = input.NumElements() / rows;
+      const T* input_data = input.flat<T>().data();
+      T* slot = output_data + row_offsets[i] * output_row_size;
+      if (input_row_size == output_row_size) {
+        std::copy(input_data, input_data + rows * input_row_size, slot);
+        continue;
+      }
+      for (int64 row = 0; row < rows; ++row) {
+        T* output_row = slot + row * output_row_size;
+        std::copy(input_data + row * input_row_size,
+                  input_data + (row + 1) * input_row_size, output_row);
+        std::fill(output_row + input_row_size, output_row + output_row_size,
+                  T());
+      }
+    }
+  };
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  const int64 cost_per_input =
+      std::max<int64>(1, num_rows / inputs.size()) * output_row_size;
+  Shard(worker_threads.num_threads, worker_threads.workers, inputs.size(),
+        cost_per_input, copy_inputs);
+
+  T* padding = output_data + num_rows * output_row_size;
+  for (int64 row = 0; row < padding_rows; ++row) {
+    std::copy(output_data, output_data + output_row_size,
+              padding + row * output_row_size);
+  }
+  return Status::OK();
+}
+
 // The Split*() functions split 'input' with element type T into 'sizes.size()'
 // tensors along the zeroth dimension, with the ith split having zeroth-
 // dimension size 'sizes[i]'. They allocate the output tensors using 'context',
@@ -263,6 +352,7 @@ class BatchResource : public ResourceBase {
   static Status Create(int32 num_batch_threads, int32 max_batch_size,
                        int32 batch_timeout_micros, int32 max_enqueued_batches,
                        const std::vector<int32>& allowed_batch_sizes,
+                       const std::vector<int32>& length_bucket_boundaries,
                        FunctionLibraryRuntime::Handle fhandle,
                        std::unique_ptr<BatchResource>* resource) {
     std::unique_ptr<BatchResource> new_resource(new BatchResource);
@@ -279,6 +369,7 @@ class BatchResource : public ResourceBase {
         batch_timeout_micros;
 
     new_resource->allowed_batch_sizes_ = allowed_batch_sizes;
+    new_resource->length_bucket_boundaries_ = length_bucket_boundaries;
 
     new_resource->fhandle_ = fhandle;
 
@@ -313,6 +404,11 @@ class BatchResource : public ResourceBase {
       }
       batch_components->inputs.push_back(tensor);
     }
+    string queue_name = batcher_queue_name;
+    if (!length_bucket_boundaries_.empty()) {
+      TF_RETURN_IF_ERROR(AssignLengthBucket(batch_components.get(),
+                                            &queue_name));
+    }
     RecordInputBatchSize(tensors[0].shape().dim_size(0), GetModelName(context));
     OpInputList captured_tensors;
     const auto captured_status =
@@ -327,14 +423,48 @@ class BatchResource : public ResourceBase {
     batch_components->done_callback = std::move(done_callback);
 
     BatcherQueue* batcher_queue;
-    TF_RETURN_IF_ERROR(
-        LookupOrCreateBatcherQueue(batcher_queue_name, &batcher_queue));
+    TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(queue_name, &batcher_queue));
     return batcher_queue->Schedule(&batch_components);
   }
 
  private:
   BatchResource() = default;
 
+  struct BatchTask;
+
+  // Routes 'task' to the length bucket of its sequence length, i.e. the size
+  // of dimension 1 of its inputs of rank 2 or more, by appending the bucket
+  // to 'queue_name'. Each bucket has its own queue, so sequences are only
+  // ever padded to the bound of their own bucket.
+  Status AssignLengthBucket(BatchTask* task, string* queue_name) const {
+    int64 length = -1;
+    for (const Tensor& input : task->inputs) {
+      if (input.dims() < 2) {
+        continue;
+      }
+      if (length >= 0 && input.dim_size(1) != length) {
+        return errors::InvalidArgument(
+            "With length_bucket_boundaries, batching input tensors of rank 2 "
+            "or more must have equal 1st-dimension size; got ",
+            length, " and ", input.dim_size(1));
+      }
+      length = input.dim_size(1);
+    }
+    if (length < 0) {
+      return errors::InvalidArgument(
+          "With length_bucket_boundaries, at least one batching input tensor "
+          "must have rank 2 or more");
+    }
+    const auto bound =
+        std::lower_bound(length_bucket_boundaries_.begin(),
+                         length_bucket_boundaries_.end(), length);
+    const int bucket = bound - length_bucket_boundaries_.begin();
+    task->padded_length =
+        bound != length_bucket_boundaries_.end() ? *bound : kPadToLongest;
+    strings::StrAppend(queue_name, "/length_bucket_", bucket);
+    return Status::OK();
+  }
+
   // One input to be batched. Corresponds to one invocation of the batch op.
   struct BatchTask : public serving::BatchTask {
     // A unique ID to identify this invocation of Batch.
@@ -350,8 +480,18 @@ class BatchResource : public ResourceBase {
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
     uint64 start_time;
+
+    // The length that the sequence inputs of this task are padded to, if it
+    // was assigned a length bucket (see AssignLengthBucket()).
+    int64 padded_length = kNoPadding;
   };
 
+  // Values of BatchTask::padded_length.
+  static constexpr int64 kNoPadding = -1;
+  // For tasks longer than the last bucket boundary, whose sequences are
+  // padded to the longest in their batch.
+  static constexpr int64 kPadToLongest = -2;
+
   using Batcher = serving::SharedBatchScheduler<BatchTask>;
   using BatcherQueue = serving::BatchScheduler<BatchTask>;
   using Batch = serving::Batch<BatchTask>;
@@ -402,44 +542,54 @@ class BatchResource : public ResourceBase {
     const int num_inputs = batch.task(0).inputs.size();
     concatenated_tensors->reserve(num_inputs);
 
+    // All tasks of a batch share a length bucket.
+    int64 padded_length = batch.task(0).padded_length;
+    if (padded_length == kPadToLongest) {
+      for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
+        for (const Tensor& input : batch.task(task_idx).inputs) {
+          if (input.dims() >= 2) {
+            padded_length = std::max(padded_length, input.dim_size(1));
+          }
+        }
+      }
+    }
+
     // Process each input one at a time (the typical case has just one).
     for (int i = 0; i < num_inputs; ++i) {
-      // Concatenate the tasks ith input tensors into a big output tensor.
+      const Tensor& first = batch.task(0).inputs.at(i);
+      const bool needs_sequence_padding = padded_length >= 0 &&
+                                          first.dims() >= 2 &&
+                                          first.dim_size(1) != padded_length;
+      // A lone task that needs no padding is its own batch.
+      if (batch.num_tasks() == 1 && padding_amount == 0 &&
+          !needs_sequence_padding) {
+        concatenated_tensors->push_back(first);
+        continue;
+      }
+
+      // Padding rows are copies of the first row of the first task's tensor.
+      if (padding_amount > 0 && first.shape().dim_size(0) == 0) {
+        return errors::InvalidArgument(
+            "Cannot use an empty tensor with zero rows as padding when "
+            "batching. (Input ",
+            i, " got shape ", first.shape().DebugString(), ".)");
+      }
+
       std::vector<Tensor> to_concatenate;
       to_concatenate.reserve(batch.num_tasks());
       for (int task_idx = 0; task_idx < batch.num_tasks(); ++task_idx) {
         to_concatenate.push_back(batch.task(task_idx).inputs.at(i));
       }
 
-      // Add padding as needed. Use the first row of the first task's tensor as
-      // the data for padding.
-      if (padding_amount > 0) {
-        const Tensor& padding_source = batch.task(0).inputs.at(i);
-        Tensor padding;
-        if (padding_source.shape().dim_size(0) == 0) {
-          return errors::InvalidArgument(
-              "Cannot use an empty tensor with zero rows as padding when "
-              "batching. (Input ",
-              i, " got shape ", padding_source.shape().DebugString(), ".)");
-        }
-        if (padding_source.shape().dim_size(0) == 1) {
-          padding = padding_source;
-        } else {
-          padding = padding_source.Slice(0, 1);
-        }
-        for (int i = 0; i < padding_amount; ++i) {
-          to_concatenate.push_back(padding);
-        }
-      }
-
-      const DataType type = to_concatenate[0].dtype();
+      const DataType type = first.dtype();
       Status concat_status;
       Tensor concatenated_tensor;
       switch (type) {
-#define CASE(type)                                                   \
-  case DataTypeToEnum<type>::value:                                  \
-    concat_status =                                                  \
-        Concat<type>(context, to_concatenate, &concatenated_tensor); \
+#define CASE(type)                                                      \
+  case DataTypeToEnum<type>::value:                                     \
+    concat_status = BatchInputs<type>(context, to_concatenate,          \
+                                      padded_length, padding_amount,    \
+                                      &concatenated_tensor);            \
     break;
         TF_CALL_ALL_TYPES(CASE);
 #undef CASE
@@ -462,26 +612,16 @@ class BatchResource : public ResourceBase {
                               batch->num_tasks());
     }
 
-    std::vector<int64> task_sizes_plus_optional_padding;
-    task_sizes_plus_optional_padding.reserve(batch->num_tasks());
-    for (int i = 0; i < batch->num_tasks(); ++i) {
-      task_sizes_plus_optional_padding.push_back(batch->task(i).size());
-    }
     const int padding_size =
         RoundToLowestAllowedBatchSize(batch->size()) - batch->size();
-    if (padding_size > 0) {
-      task_sizes_plus_optional_padding.push_back(padding_size);
-    }
-
-    // For each output tensor name, a divided-up tensor with one entry per task.
-    std::map<string, std::vector<Tensor>> split_tensors;
 
     DCHECK_EQ(batch->task(0).context->num_outputs(), combined_outputs.size());
     if (combined_outputs.size() != batch->task(0).context->num_outputs()) {
       return errors::Internal("Wrong number of batched output tensors");
     }
 
-    // Generate 'split_tensors' and populate the context outputs.
+    // Populate the context outputs with each task's rows of the batched
+    // outputs. (The rows of a possible final padding entry are ignored.)
     for (int i = 0; i < combined_outputs.size(); ++i) {
       const Tensor& output_tensor = combined_outputs[i];
       if (output_tensor.shape().dims() == 0) {
@@ -494,27 +634,25 @@ class BatchResource : public ResourceBase {
             "the 0th dimension sizes of the input tensors");
       }
 
-      std::vector<Tensor> split_tensor;
-      const Status split_status = tensor::Split(
-          output_tensor, task_sizes_plus_optional_padding, &split_tensor);
-      DCHECK(split_status.ok()) << split_status.ToString();
-      if (!split_status.ok()) {
-        return errors::Internal("Tensor split operation failed: ",
-                                split_status.ToString());
-      }
-      DCHECK_EQ(split_tensor.size(), task_sizes_plus_optional_padding.size());
-      if (split_tensor.size() != task_sizes_plus_optional_padding.size()) {
-        return errors::Internal(
-            "Tensor split operation did not work as expected; got ",
-            split_tensor.size(), " splits; expected ",
-            task_sizes_plus_optional_padding.size());
-      }
-
+      int64 offset = 0;
       for (int j = 0; j < batch->num_tasks(); ++j) {
         BatchTask& task = *(batch->mutable_task(j));
-        task.context->set_output(i, split_tensor.at(j));
-      }  // (Ignore a possible final split_tensors entry containing the
-         // padding.)
+        const int64 size = task.size();
+        // The slice aliases the batched output, which stays alive for as long
+        // as any task's output does. Tasks whose rows do not start at an
+        // aligned address get a copy, since kernels may assume alignment.
+        Tensor split_tensor = output_tensor.Slice(offset, offset + size);
+        if (!split_tensor.IsAligned()) {
+          if (!DataTypeCanUseMemcpy(split_tensor.dtype()) &&
+              split_tensor.dtype() != DT_VARIANT) {
+            return errors::Internal("Cannot copy batched output of type ",
+                                    DataTypeString(split_tensor.dtype()));
+          }
+          split_tensor = tensor::DeepCopy(split_tensor);
+        }
+        task.context->set_output(i, split_tensor);
+        offset += size;
+      }
     }
 
     return Status::OK();
@@ -748,6 +886,7 @@ class BatchResource : public ResourceBase {
       TF_GUARDED_BY(batcher_queues_mu_);
 
   std::vector<int32> allowed_batch_sizes_;
+  std::vector<int32> length_bucket_boundaries_;
   FunctionLibraryRuntime::Handle fhandle_;
 };
 
@@ -770,6 +909,17 @@ class BatchFunctionKernel : public AsyncOpKernel {
                    c->GetAttr("max_enqueued_batches", &max_enqueued_batches_));
     OP_REQUIRES_OK(c, c->GetAttr("allowed_batch_sizes", &allowed_batch_sizes_));
     OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
+    OP_REQUIRES_OK(c, c->GetAttr("length_bucket_boundaries",
+                                 &length_bucket_boundaries_));
+    for (size_t i = 0; i < length_bucket_boundaries_.size(); ++i) {
+      OP_REQUIRES(c,
+                  length_bucket_boundaries_[i] > 0 &&
+                      (i == 0 || length_bucket_boundaries_[i] >
+                                     length_bucket_boundaries_[i - 1]),
+                  errors::InvalidArgument(
+                      "length_bucket_boundaries entries must be positive and "
+                      "monotonically increasing"));
+    }
 
     auto lib = c->function_library();
     OP_REQUIRES(c, lib != nullptr, errors::Internal("No function library"));
@@ -785,10 +935,10 @@ class BatchFunctionKernel : public AsyncOpKernel {
     BatchResource* br;
     std::function<Status(BatchResource**)> creator = [this](BatchResource** r) {
       std::unique_ptr<BatchResource> new_resource;
-      TF_RETURN_IF_ERROR(
-          BatchResource::Create(num_batch_threads_, max_batch_size_,
-                                batch_timeout_micros_, max_enqueued_batches_,
-                                allowed_batch_sizes_, fhandle_, &new_resource));
+      TF_RETURN_IF_ERROR(BatchResource::Create(
+          num_batch_threads_, max_batch_size_, batch_timeout_micros_,
+          max_enqueued_batches_, allowed_batch_sizes_,
+          length_bucket_boundaries_, fhandle_, &new_resource));
       *r = new_resource.release();
       return Status::OK();
     };
@@ -834,6 +984,7 @@ class BatchFunctionKernel : public AsyncOpKernel {
   int32 batch_timeout_micros_;
   int32 max_enqueued_batches_;
   std::vector<int32> allowed_batch_sizes_;
+  std::vector<int32> length_bucket_boundaries_;
   FunctionLibraryRuntime::Handle fhandle_;
 };
 
@@ -867,7 +1018,8 @@ class BatchKernel : public AsyncOpKernel {
       std::unique_ptr<BatchResource> new_resource;
       TF_RETURN_IF_ERROR(BatchResource::Create(
           num_batch_threads_, max_batch_size_, batch_timeout_micros_,
-          max_enqueued_batches_, allowed_batch_sizes_, kInvalidHandle,
+          max_enqueued_batches_, allowed_batch_sizes_,
+          /*length_bucket_boundaries=*/{}, kInvalidHandle,
           &new_resource));
       *r = new_resource.release();
       return Status::OK();
@@ -18,11 +18,13 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <deque>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -160,6 +162,18 @@ class SharedBatchScheduler
     // See the class documentation above for guidelines on how to tune this
     // parameter.
     size_t max_enqueued_batches = 10;
+
+    // If positive, the queue tunes its batch timeout and batch size online to
+    // keep the 99th percentile latency of tasks, from being scheduled to the
+    // end of their batch's processing, within this many microseconds. It does
+    // so from the measured task arrival rate and a model of batch processing
+    // time as a function of batch size. An open batch is closed early when at
+    // the measured arrival rate it is not expected to gain another task before
+    // its deadline, since waiting would then add latency but no throughput.
+    //
+    // In this mode 'max_batch_size' and, if positive, 'batch_timeout_micros'
+    // are upper bounds on the tuned values.
+    int64 latency_target_micros = 0;
   };
   Status AddQueue(const QueueOptions& options,
                   std::function<void(std::unique_ptr<Batch<TaskType>>)>
@@ -208,6 +222,82 @@ class SharedBatchScheduler
 
 namespace internal {
 
+namespace latency_controller {
+// Weight of the previous estimate in each exponentially weighted update.
+constexpr double kDecay = 0.95;
+// The latencies of this many recent batches make up the percentile window.
+constexpr size_t kLatencyWindowSize = 128;
+// The percentile is not acted on until the window has this many batches.
+constexpr size_t kMinLatencySamples = 16;
+constexpr double kMaxSafetyFactor = 8.0;
+}  // namespace latency_controller
+
+// Tunes the timeout and batch size of a queue that has a latency target (see
+// QueueOptions::latency_target_micros). Not thread-safe.
+//
+// Batch processing time is modeled as linear in the batch size, fitted by
+// least squares over exponentially decayed samples. The timeout of an open
+// batch is whatever is left of the target after its predicted processing
+// time, and the batch size is capped where the predicted processing time
+// alone reaches the target. Both predictions are scaled by a safety factor,
+// which grows while the measured 99th percentile latency misses the target
+// (e.g. because batches wait for a free thread) and shrinks back towards 1
+// while there is room to spare.
+class LatencyTargetController {
+ public:
+  LatencyTargetController(int64 latency_target_micros,
+                          int64 max_timeout_micros, size_t max_batch_size)
+      : latency_target_micros_(latency_target_micros),
+        max_timeout_micros_(max_timeout_micros),
+        max_batch_size_(max_batch_size) {}
+
+  // Records that a task was scheduled at 'now_micros'.
+  void RecordArrival(uint64 now_micros);
+
+  // Records that a batch of 'size', whose first task was scheduled at
+  // 'start_micros', was processed from 'process_start_micros' to
+  // 'process_end_micros'.
+  void RecordBatch(size_t size, uint64 start_micros,
+                   uint64 process_start_micros, uint64 process_end_micros);
+
+  // Returns the predicted time to process a batch of 'size', or 0 before any
+  // batch has been processed.
+  double PredictProcessingMicros(size_t size) const;
+
+  // Returns how long the first task of an open batch of 'size' may wait.
+  int64 TimeoutMicros(size_t size) const;
+
+  // Returns the size at which an open batch is closed.
+  size_t MaxBatchSize() const;
+
+  // Returns whether an open batch of 'size', whose first task has waited
+  // 'waited_micros', should be closed.
+  bool ShouldCloseBatch(size_t size, int64 waited_micros) const;
+
+  double safety_factor() const { return safety_factor_; }
+
+ private:
+  const int64 latency_target_micros_;
+  const int64 max_timeout_micros_;
+  const size_t max_batch_size_;
+
+  // Inter-arrival time of tasks. Negative until two tasks have arrived.
+  double mean_interarrival_micros_ = -1;
+  uint64 last_arrival_micros_ = 0;
+  bool has_arrival_ = false;
+
+  // Decayed sums over (batch size, processing time) samples.
+  double sum_weight_ = 0;
+  double sum_size_ = 0;
+  double sum_micros_ = 0;
+  double sum_size_squared_ = 0;
+  double sum_size_micros_ = 0;
+
+  // Latencies of the first task of recently processed batches.
+  std::deque<int64> latencies_;
+  double safety_factor_ = 1.0;
+};
+
 // A task queue for SharedBatchScheduler. Accepts tasks and accumulates them
 // into batches, and dispenses those batches to be processed via a "pull"
 // interface. The queue's behavior is governed by maximum batch size, timeout
@@ -287,6 +377,11 @@ class Queue {
   // currently schedulable.
   bool IsOpenBatchSchedulable() const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Whether the queue has a latency target.
+  bool has_latency_target() const {
+    return options_.latency_target_micros > 0;
+  }
+
   const typename SharedBatchScheduler<TaskType>::QueueOptions options_;
 
   // The environment to use.
@@ -328,6 +423,18 @@ class Queue {
   // 'empty_notification_' is non-null it calls 'empty_notification_->Notify()'.
   Notification* empty_notification_ TF_GUARDED_BY(mu_) = nullptr;
 
+  // The following are only used if the queue has a latency target.
+  LatencyTargetController latency_controller_ TF_GUARDED_BY(mu_);
+
+  // The times at which the first task was added to each closed batch in
+  // 'batches_', front to back.
+  std::deque<uint64> closed_batch_start_times_micros_ TF_GUARDED_BY(mu_);
+
+  // The times at which the first task was added to each batch being
+  // processed.
+  std::unordered_map<const Batch<TaskType>*, uint64>
+      processing_batch_start_times_micros_ TF_GUARDED_BY(mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(Queue);
 };
 
@@ -410,6 +517,11 @@ Status SharedBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be non-negative; was ",
         options.max_enqueued_batches);
   }
+  if (options.latency_target_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_target_micros must be non-negative; was ",
+        options.latency_target_micros);
+  }
 
   auto schedulable_batch_callback = [this] {
     mutex_lock l(mu_);
@@ -504,6 +616,119 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
 
 namespace internal {
 
+inline void LatencyTargetController::RecordArrival(uint64 now_micros) {
+  using latency_controller::kDecay;
+  if (has_arrival_) {
+    const double interarrival_micros =
+        now_micros > last_arrival_micros_ ? now_micros - last_arrival_micros_
+                                          : 0;
+    mean_interarrival_micros_ =
+        mean_interarrival_micros_ < 0
+            ? interarrival_micros
+            : kDecay * mean_interarrival_micros_ +
+                  (1 - kDecay) * interarrival_micros;
+  }
+  has_arrival_ = true;
+  last_arrival_micros_ = std::max(last_arrival_micros_, now_micros);
+}
+
+inline void LatencyTargetController::RecordBatch(size_t size,
+                                                 uint64 start_micros,
+                                                 uint64 process_start_micros,
+                                                 uint64 process_end_micros) {
+  using latency_controller::kDecay;
+  using latency_controller::kLatencyWindowSize;
+  using latency_controller::kMaxSafetyFactor;
+  using latency_controller::kMinLatencySamples;
+  const double micros = process_end_micros - process_start_micros;
+  sum_weight_ = kDecay * sum_weight_ + 1;
+  sum_size_ = kDecay * sum_size_ + size;
+  sum_micros_ = kDecay * sum_micros_ + micros;
+  sum_size_squared_ = kDecay * sum_size_squared_ + double{1} * size * size;
+  sum_size_micros_ = kDecay * sum_size_micros_ + size * micros;
+
+  latencies_.push_back(process_end_micros - start_micros);
+  if (latencies_.size() > kLatencyWindowSize) {
+    latencies_.pop_front();
+  }
+  if (latencies_.size() < kMinLatencySamples) {
+    return;
+  }
+  std::vector<int64> latencies(latencies_.begin(), latencies_.end());
+  auto p99 = latencies.begin() + (latencies.size() * 99 + 99) / 100 - 1;
+  std::nth_element(latencies.begin(), p99, latencies.end());
+  if (*p99 > latency_target_micros_) {
+    safety_factor_ = std::min(safety_factor_ * 1.1, kMaxSafetyFactor);
+    // Let the window fill with batches formed under the new factor before
+    // acting on it again.
+    latencies_.clear();
+  } else if (*p99 < 0.8 * latency_target_micros_) {
+    safety_factor_ = std::max(safety_factor_ * 0.98, 1.0);
+  }
+}
+
+inline double LatencyTargetController::PredictProcessingMicros(
+    size_t size) const {
+  if (sum_weight_ == 0) {
+    return 0;
+  }
+  const double mean_size = sum_size_ / sum_weight_;
+  const double mean_micros = sum_micros_ / sum_weight_;
+  const double size_variance =
+      sum_size_squared_ / sum_weight_ - mean_size * mean_size;
+  if (size_variance < 0.25) {
+    // All recent batches had about the same size; assume processing time is
+    // proportional to it.
+    return mean_size > 0 ? mean_micros * size / mean_size : mean_micros;
+  }
+  const double slope = std::max(
+      (sum_size_micros_ / sum_weight_ - mean_size * mean_micros) /
+          size_variance,
+      0.0);
+  return std::max(mean_micros + slope * (size - mean_size), 0.0);
+}
+
+inline int64 LatencyTargetController::TimeoutMicros(size_t size) const {
+  int64 timeout_micros = std::max<int64>(
+      latency_target_micros_ - safety_factor_ * PredictProcessingMicros(size),
+      0);
+  if (max_timeout_micros_ > 0) {
+    timeout_micros = std::min(timeout_micros, max_timeout_micros_);
+  }
+  return timeout_micros;
+}
+
+inline size_t LatencyTargetController::MaxBatchSize() const {
+  // The predicted processing time does not decrease with the batch size, so
+  // binary search for the largest size that fits in the target.
+  size_t low = 1;
+  size_t high = max_batch_size_;
+  while (low < high) {
+    const size_t mid = low + (high - low + 1) / 2;
+    if (safety_factor_ * PredictProcessingMicros(mid) <=
+        latency_target_micros_) {
+      low = mid;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
+
+inline bool LatencyTargetController::ShouldCloseBatch(
+    size_t size, int64 waited_micros) const {
+  if (size >= MaxBatchSize()) {
+    return true;
+  }
+  const int64 timeout_micros = TimeoutMicros(size);
+  if (waited_micros >= timeout_micros) {
+    return true;
+  }
+  // Close the batch early if no other task is expected before its deadline.
+  return mean_interarrival_micros_ >= 0 &&
+         timeout_micros - waited_micros < mean_interarrival_micros_;
+}
+
 template <typename TaskType>
 Queue<TaskType>::Queue(
     const typename SharedBatchScheduler<TaskType>::QueueOptions& options,
@@ -512,7 +737,10 @@ Queue<TaskType>::Queue(
     : options_(options),
       env_(env),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      latency_controller_(options.latency_target_micros,
+                          options.batch_timeout_micros,
+                          options.max_batch_size) {
   // Create an initial, open batch.
   batches_.emplace_back(new Batch<TaskType>);
 }
@@ -550,8 +778,12 @@ Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
       }
       StartNewBatch();
     }
+    const uint64 now_micros = env_->NowMicros();
     if (batches_.back()->empty()) {
-      open_batch_start_time_micros_ = env_->NowMicros();
+      open_batch_start_time_micros_ = now_micros;
+    }
+    if (has_latency_target()) {
+      latency_controller_.RecordArrival(now_micros);
     }
     batches_.back()->AddTask(std::move(*task));
 
@@ -610,6 +842,11 @@ std::unique_ptr<Batch<TaskType>> Queue<TaskType>::ScheduleBatch() {
       ++num_batches_being_processed_;
       batch_to_schedule = std::move(batches_.front());
       batches_.pop_front();
+      if (has_latency_target()) {
+        processing_batch_start_times_micros_[batch_to_schedule.get()] =
+            closed_batch_start_times_micros_.front();
+        closed_batch_start_times_micros_.pop_front();
+      }
     } else {
       schedulable_batch_ = false;
     }
@@ -622,10 +859,21 @@ template <typename TaskType>
 void Queue<TaskType>::ProcessBatch(std::unique_ptr<Batch<TaskType>> batch) {
   profiler::TraceMe trace_me(
       [&batch] { return strings::StrCat("ProcessBatch:", batch->size()); });
+  const Batch<TaskType>* batch_key = batch.get();
+  const size_t batch_size = batch->size();
+  const uint64 process_start_micros =
+      has_latency_target() ? env_->NowMicros() : 0;
   process_batch_callback_(std::move(batch));
 
   {
     mutex_lock l(mu_);
+    if (has_latency_target()) {
+      auto it = processing_batch_start_times_micros_.find(batch_key);
+      DCHECK(it != processing_batch_start_times_micros_.end());
+      latency_controller_.RecordBatch(batch_size, it->second,
+                                      process_start_micros, env_->NowMicros());
+      processing_batch_start_times_micros_.erase(it);
+    }
     --num_batches_being_processed_;
     if (empty_notification_ != nullptr && IsEmptyInternal()) {
       empty_notification_->Notify();
@@ -663,6 +911,9 @@ bool Queue<TaskType>::IsEmptyInternal() const {
 
 template <typename TaskType>
 void Queue<TaskType>::StartNewBatch() {
+  if (has_latency_target()) {
+    closed_batch_start_times_micros_.push_back(open_batch_start_time_micros_);
+  }
   batches_.back()->Close();
   batches_.emplace_back(new Batch<TaskType>);
 }
@@ -673,6 +924,12 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
+  if (has_latency_target()) {
+    return closed_ || open_batch->size() >= options_.max_batch_size ||
+           latency_controller_.ShouldCloseBatch(
+               open_batch->size(),
+               env_->NowMicros() - open_batch_start_time_micros_);
+  }
   return closed_ || open_batch->size() >= options_.max_batch_size ||
          env_->NowMicros() >=
              open_batch_start_time_micros_ + options_.batch_timeout_micros;
@@ -254,6 +254,123 @@ TEST(SharedBatchSchedulerTest, ObeysTimeout) {
   stop_teardown.Notify();
 }
 
+TEST(SharedBatchSchedulerTest, LatencyTargetClosesBatchEarly) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification batch_processed;
+    auto callback =
+        [&batch_processed](std::unique_ptr<Batch<FakeTask>> batch) {
+          ASSERT_TRUE(batch->IsClosed());
+          EXPECT_EQ(2, batch->num_tasks());
+          batch_processed.Notify();
+        };
+
+    SharedBatchScheduler<FakeTask>::Options options;
+    options.num_batch_threads = 1;
+    options.env = &env;
+    std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+    SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    queue_options.latency_target_micros = 1000;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, callback, &queue));
+
+    // Tasks arrive every 100us. Nothing has been processed yet, so the whole
+    // target is available for batching, but the batch is closed once fewer
+    // than 100us are left before its deadline.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(100);
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(750);
+    Env::Default()->SleepForMicroseconds(10 * 1000 /* 10 milliseconds */);
+    EXPECT_FALSE(batch_processed.HasBeenNotified());
+    env.AdvanceByMicroseconds(100);
+    batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
+TEST(SharedBatchSchedulerTest, RejectsNegativeLatencyTarget) {
+  SharedBatchScheduler<FakeTask>::Options options;
+  options.num_batch_threads = 1;
+  std::shared_ptr<SharedBatchScheduler<FakeTask>> scheduler;
+  TF_ASSERT_OK(SharedBatchScheduler<FakeTask>::Create(options, &scheduler));
+  SharedBatchScheduler<FakeTask>::QueueOptions queue_options;
+  queue_options.latency_target_micros = -1;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_EQ(error::INVALID_ARGUMENT,
+            scheduler
+                ->AddQueue(queue_options,
+                           [](std::unique_ptr<Batch<FakeTask>> batch) {},
+                           &queue)
+                .code());
+}
+
+TEST(LatencyTargetControllerTest, FitsProcessingTime) {
+  internal::LatencyTargetController controller(
+      1000 /* latency_target_micros */, 0 /* max_timeout_micros */,
+      1000 /* max_batch_size */);
+  EXPECT_EQ(0, controller.PredictProcessingMicros(10));
+  EXPECT_EQ(1000, controller.TimeoutMicros(10));
+  EXPECT_EQ(1000, controller.MaxBatchSize());
+
+  // Processing takes 50us plus 5us per task.
+  for (int i = 0; i < 10; ++i) {
+    controller.RecordBatch(10, 0, 0, 100);
+    controller.RecordBatch(20, 0, 0, 150);
+  }
+  EXPECT_NEAR(200, controller.PredictProcessingMicros(30), 1);
+  EXPECT_NEAR(900, controller.TimeoutMicros(10), 1);
+  EXPECT_NEAR(190, controller.MaxBatchSize(), 1);
+  EXPECT_TRUE(controller.ShouldCloseBatch(200, 0));
+  EXPECT_FALSE(controller.ShouldCloseBatch(10, 800));
+  EXPECT_TRUE(controller.ShouldCloseBatch(10, 900));
+}
+
+TEST(LatencyTargetControllerTest, CapsTimeout) {
+  internal::LatencyTargetController controller(
+      1000 /* latency_target_micros */, 300 /* max_timeout_micros */,
+      1000 /* max_batch_size */);
+  EXPECT_EQ(300, controller.TimeoutMicros(1));
+}
+
+TEST(LatencyTargetControllerTest, ClosesBatchWhenNoArrivalIsExpected) {
+  internal::LatencyTargetController controller(
+      1000 /* latency_target_micros */, 0 /* max_timeout_micros */,
+      1000 /* max_batch_size */);
+  for (int i = 0; i < 5; ++i) {
+    controller.RecordArrival(i * 500);
+  }
+  EXPECT_FALSE(controller.ShouldCloseBatch(1, 400));
+  EXPECT_TRUE(controller.ShouldCloseBatch(1, 600));
+}
+
+TEST(LatencyTargetControllerTest, AdaptsSafetyFactorToMeasuredLatency) {
+  internal::LatencyTargetController controller(
+      1000 /* latency_target_micros */, 0 /* max_timeout_micros */,
+      1000 /* max_batch_size */);
+  // Batches take 100us to process but wait for a thread, so tasks see 2ms.
+  for (int i = 0; i < 16; ++i) {
+    controller.RecordBatch(10, 0, 1900, 2000);
+  }
+  const double raised_safety_factor = controller.safety_factor();
+  EXPECT_GT(raised_safety_factor, 1.0);
+  EXPECT_LT(controller.TimeoutMicros(10), 900);
+
+  // Once latencies are well within the target, the factor decays.
+  for (int i = 0; i < 32; ++i) {
+    controller.RecordBatch(10, 0, 0, 100);
+  }
+  EXPECT_LT(controller.safety_factor(), raised_safety_factor);
+}
+
 TEST(SharedBatchSchedulerTest, ObeysTimeoutWithRealClock) {
   Notification first_batch_processed, second_batch_processed;
   auto callback = [&first_batch_processed, &second_batch_processed](
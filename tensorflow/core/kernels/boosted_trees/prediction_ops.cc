@@ -50,6 +50,176 @@ static void ConvertVectorsToMatrices(
   }
 }
 
+// A tree ensemble compiled into flat, struct-of-arrays node tables, which
+// predicts a block of examples one tree at a time. Every leaf points to itself
+// as both children, so all the examples of a block take exactly as many steps
+// as the tree is deep, without branching on the node type. Interleaving the
+// examples of a block overlaps the feature and node lookups of each step.
+class FlatTreeEnsemble {
+ public:
+  // Compiles `ensemble`. Returns false if it has a node that cannot be
+  // compiled, in which case the ensemble proto has to be traversed instead.
+  bool Init(const boosted_trees::TreeEnsemble& ensemble,
+            const int32 logits_dimension) {
+    logits_dimension_ = logits_dimension;
+    for (int32 tree_id = 0; tree_id < ensemble.trees_size(); ++tree_id) {
+      const boosted_trees::Tree& tree = ensemble.trees(tree_id);
+      if (tree.nodes_size() == 0) return false;
+      const int32 root = feature_ids_.size();
+      const int32 limit = root + tree.nodes_size();
+      roots_.push_back(root);
+      for (int32 node_id = 0; node_id < tree.nodes_size(); ++node_id) {
+        if (!AddNode(tree.nodes(node_id), root, root + node_id,
+                     ensemble.tree_weights(tree_id))) {
+          return false;
+        }
+      }
+      for (int32 node = root; node < limit; ++node) {
+        if (left_ids_[node] < root || left_ids_[node] >= limit ||
+            right_ids_[node] < root || right_ids_[node] >= limit) {
+          return false;
+        }
+      }
+      depths_.push_back(TreeDepth(root, tree.nodes_size()));
+    }
+    return true;
+  }
+
+  // Sets the logits of examples [start, end).
+  void Predict(const std::vector<TTypes<int32>::ConstMatrix>& features,
+               const int32 start, const int32 end,
+               TTypes<float>::Matrix* logits) const {
+    int32 node_ids[kBlockSize];
+    for (int32 block_start = start; block_start < end;
+         block_start += kBlockSize) {
+      const int32 block_size =
+          std::min(static_cast<int32>(kBlockSize), end - block_start);
+      for (int32 i = block_start; i < block_start + block_size; ++i) {
+        for (int32 j = 0; j < logits_dimension_; ++j) {
+          (*logits)(i, j) = 0;
+        }
+      }
+      for (int32 tree_id = 0; tree_id < roots_.size(); ++tree_id) {
+        std::fill(node_ids, node_ids + block_size, roots_[tree_id]);
+        for (int32 depth = 0; depth < depths_[tree_id]; ++depth) {
+          for (int32 k = 0; k < block_size; ++k) {
+            const int32 node = node_ids[k];
+            const int32 value =
+                features[feature_ids_[node]](block_start + k,
+                                             dimension_ids_[node]);
+            const bool go_left = is_categorical_[node]
+                                     ? value == thresholds_[node]
+                                     : value <= thresholds_[node];
+            node_ids[k] = go_left ? left_ids_[node] : right_ids_[node];
+          }
+        }
+        for (int32 k = 0; k < block_size; ++k) {
+          const float* leaf_logits = &leaf_logits_[leaf_offsets_[node_ids[k]]];
+          for (int32 j = 0; j < logits_dimension_; ++j) {
+            (*logits)(block_start + k, j) += leaf_logits[j];
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  static constexpr int32 kBlockSize = 16;
+
+  // Appends `node`, whose index in the flat tables is `index` and whose tree
+  // starts at `root`. Leaf logits are stored premultiplied by the tree weight.
+  bool AddNode(const boosted_trees::Node& node, const int32 root,
+               const int32 index, const float tree_weight) {
+    int32 feature_id = 0;
+    int32 dimension_id = 0;
+    int32 threshold = 0;
+    bool is_categorical = false;
+    int32 left_id = index;
+    int32 right_id = index;
+    int32 leaf_offset = -1;
+    switch (node.node_case()) {
+      case boosted_trees::Node::kLeaf: {
+        const auto& leaf = node.leaf();
+        leaf_offset = leaf_logits_.size();
+        if (leaf.has_vector()) {
+          if (leaf.vector().value_size() != logits_dimension_) return false;
+          for (const float value : leaf.vector().value()) {
+            leaf_logits_.push_back(tree_weight * value);
+          }
+        } else {
+          if (logits_dimension_ != 1) return false;
+          leaf_logits_.push_back(tree_weight * leaf.scalar());
+        }
+        break;
+      }
+      case boosted_trees::Node::kBucketizedSplit: {
+        const auto& split = node.bucketized_split();
+        feature_id = split.feature_id();
+        dimension_id = split.dimension_id();
+        threshold = split.threshold();
+        left_id = root + split.left_id();
+        right_id = root + split.right_id();
+        break;
+      }
+      case boosted_trees::Node::kCategoricalSplit: {
+        const auto& split = node.categorical_split();
+        feature_id = split.feature_id();
+        dimension_id = split.dimension_id();
+        threshold = split.value();
+        is_categorical = true;
+        left_id = root + split.left_id();
+        right_id = root + split.right_id();
+        break;
+      }
+      default:
+        return false;
+    }
+    feature_ids_.push_back(feature_id);
+    dimension_ids_.push_back(dimension_id);
+    thresholds_.push_back(threshold);
+    is_categorical_.push_back(is_categorical);
+    left_ids_.push_back(left_id);
+    right_ids_.push_back(right_id);
+    leaf_offsets_.push_back(leaf_offset);
+    return true;
+  }
+
+  // Returns the number of splits on the longest path from `root` to a leaf,
+  // in a tree of `num_nodes` nodes.
+  int32 TreeDepth(const int32 root, const int32 num_nodes) const {
+    int32 max_depth = 0;
+    std::vector<std::pair<int32, int32>> stack = {{root, 0}};
+    while (!stack.empty()) {
+      const int32 node = stack.back().first;
+      const int32 depth = stack.back().second;
+      stack.pop_back();
+      if (leaf_offsets_[node] >= 0 || depth >= num_nodes) {
+        max_depth = std::max(max_depth, depth);
+        continue;
+      }
+      stack.emplace_back(left_ids_[node], depth + 1);
+      stack.emplace_back(right_ids_[node], depth + 1);
+    }
+    return max_depth;
+  }
+
+  int32 logits_dimension_;
+  // The index of the root of each tree in the node tables, and the depth of
+  // the tree.
+  std::vector<int32> roots_;
+  std::vector<int32> depths_;
+  // The node tables. Leaves have both children set to themselves, and an
+  // offset into `leaf_logits_`; splits have a leaf offset of -1.
+  std::vector<int32> feature_ids_;
+  std::vector<int32> dimension_ids_;
+  std::vector<int32> thresholds_;
+  std::vector<bool> is_categorical_;
+  std::vector<int32> left_ids_;
+  std::vector<int32> right_ids_;
+  std::vector<int32> leaf_offsets_;
+  std::vector<float> leaf_logits_;
+};
+
 // The Op used during training time to get the predictions so far with the
 // current ensemble being built.
 // Expect some logits are cached from the previous step and passed through
@@ -236,6 +406,30 @@ class BoostedTreesPredictOp : public OpKernel {
     }
 
     const int32 last_tree = resource->num_trees() - 1;
+    // 10 is the magic number. The actual number might depend on (the number of
+    // layers in the trees) and (cpu cycles spent on each layer), but this
+    // value would work for many cases. May be tuned later.
+    const int64 cost = (last_tree + 1) * 10;
+    thread::ThreadPool* const worker_threads =
+        context->device()->tensorflow_cpu_worker_threads()->workers;
+
+    // Compiling the ensemble takes a pass over all its nodes, which pays off
+    // once the batch visits about as many nodes.
+    int64 num_nodes = 0;
+    for (const auto& tree : resource->tree_ensemble().trees()) {
+      num_nodes += tree.nodes_size();
+    }
+    FlatTreeEnsemble flat_ensemble;
+    if (num_nodes <= static_cast<int64>(batch_size) * (last_tree + 1) &&
+        flat_ensemble.Init(resource->tree_ensemble(), logits_dimension_)) {
+      Shard(worker_threads->NumThreads(), worker_threads, batch_size,
+            /*cost_per_unit=*/cost, [&](int32 start, int32 end) {
+              flat_ensemble.Predict(bucketized_features, start, end,
+                                    &output_logits);
+            });
+      return;
+    }
+
     auto do_work = [&resource, &bucketized_features, &output_logits, last_tree,
                     this](int32 start, int32 end) {
       for (int32 i = start; i < end; ++i) {
@@ -267,12 +461,6 @@ class BoostedTreesPredictOp : public OpKernel {
         }
       }
     };
-    // 10 is the magic number. The actual number might depend on (the number of
-    // layers in the trees) and (cpu cycles spent on each layer), but this
-    // value would work for many cases. May be tuned later.
-    const int64 cost = (last_tree + 1) * 10;
-    thread::ThreadPool* const worker_threads =
-        context->device()->tensorflow_cpu_worker_threads()->workers;
     Shard(worker_threads->NumThreads(), worker_threads, batch_size,
           /*cost_per_unit=*/cost, do_work);
   }
@@ -169,6 +169,72 @@ class BoostedTreesMakeQuantileSummariesOp : public OpKernel {
     OP_REQUIRES_OK(
         context, context->output_list(kSummariesName, &summaries_output_list));
 
+    const auto get_weight = [&](const int64 j) {
+      return (weight_size > 1) ? example_weights(j) : example_weights(0);
+    };
+    const auto write_summary = [&](const int64 index,
+                                   const QuantileStream& stream) {
+      const auto summary_entry_list = stream.GetFinalSummary().GetEntryList();
+      Tensor* output_t;
+      OP_REQUIRES_OK(
+          context,
+          summaries_output_list.allocate(
+              index,
+              TensorShape({static_cast<int64>(summary_entry_list.size()), 4}),
+              &output_t));
+      auto output = output_t->matrix<float>();
+      for (auto row = 0; row < summary_entry_list.size(); row++) {
+        const auto& entry = summary_entry_list[row];
+        output(row, 0) = entry.value;
+        output(row, 1) = entry.weight;
+        output(row, 2) = entry.min_rank;
+        output(row, 3) = entry.max_rank;
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+
+    // With fewer features than threads, the examples of each feature are also
+    // split into shards, which are summarized in parallel with half of the
+    // error budget. Their summaries are then merged with the other half.
+    int64 num_shards = 1;
+    if (num_features_ < worker_threads.num_threads) {
+      num_shards = std::min(worker_threads.num_threads / num_features_,
+                            batch_size / kMinExamplesPerShard);
+    }
+    if (num_shards > 1) {
+      std::vector<std::vector<QuantileSummaryEntry>> shard_summaries(
+          num_features_ * num_shards);
+      auto do_shard_summary_gen = [&](const int64 begin, const int64 end) {
+        for (int64 unit = begin; unit < end; ++unit) {
+          const auto feature_values =
+              float_features_list[unit / num_shards].flat<float>();
+          const int64 shard = unit % num_shards;
+          const int64 shard_begin = batch_size * shard / num_shards;
+          const int64 shard_end = batch_size * (shard + 1) / num_shards;
+          QuantileStream stream(epsilon / 2, shard_end - shard_begin + 1);
+          for (int64 j = shard_begin; j < shard_end; j++) {
+            stream.PushEntry(feature_values(j), get_weight(j));
+          }
+          stream.Finalize();
+          shard_summaries[unit] = stream.GetFinalSummary().GetEntryList();
+        }
+      };
+      Shard(worker_threads.num_threads, worker_threads.workers,
+            num_features_ * num_shards, 500 * batch_size / num_shards,
+            do_shard_summary_gen);
+
+      for (int64 index = 0; index < num_features_; index++) {
+        QuantileStream stream(epsilon / 2, batch_size + 1);
+        for (int64 shard = 0; shard < num_shards; ++shard) {
+          stream.PushSummary(shard_summaries[index * num_shards + shard]);
+        }
+        stream.Finalize();
+        write_summary(index, stream);
+      }
+      return;
+    }
+
     auto do_quantile_summary_gen = [&](const int64 begin, const int64 end) {
       // Iterating features.
       for (int64 index = begin; index < end; index++) {
@@ -176,38 +242,22 @@ class BoostedTreesMakeQuantileSummariesOp : public OpKernel {
         QuantileStream stream(epsilon, batch_size + 1);
         // Run quantile summary generation.
         for (int64 j = 0; j < batch_size; j++) {
-          stream.PushEntry(feature_values(j), (weight_size > 1)
-                                                  ? example_weights(j)
-                                                  : example_weights(0));
+          stream.PushEntry(feature_values(j), get_weight(j));
         }
         stream.Finalize();
-        const auto summary_entry_list = stream.GetFinalSummary().GetEntryList();
-        Tensor* output_t;
-        OP_REQUIRES_OK(
-            context,
-            summaries_output_list.allocate(
-                index,
-                TensorShape({static_cast<int64>(summary_entry_list.size()), 4}),
-                &output_t));
-        auto output = output_t->matrix<float>();
-        for (auto row = 0; row < summary_entry_list.size(); row++) {
-          const auto& entry = summary_entry_list[row];
-          output(row, 0) = entry.value;
-          output(row, 1) = entry.weight;
-          output(row, 2) = entry.min_rank;
-          output(row, 3) = entry.max_rank;
-        }
+        write_summary(index, stream);
       }
     };
     // TODO(tanzheny): comment on the magic number.
     const int64 kCostPerUnit = 500 * batch_size;
-    const DeviceBase::CpuWorkerThreads& worker_threads =
-        *context->device()->tensorflow_cpu_worker_threads();
     Shard(worker_threads.num_threads, worker_threads.workers, num_features_,
           kCostPerUnit, do_quantile_summary_gen);
   }
 
  private:
+  // The fewest examples of a feature that are summarized on their own.
+  static constexpr int64 kMinExamplesPerShard = 1 << 16;
+
   int64 num_features_;
 };
 
@@ -58,6 +58,12 @@ class BoostedTreesEnsembleResource : public StampedResource {
 
   int32 num_trees() const;
 
+  // Returns the underlying ensemble proto, for ops that compile it into a
+  // faster representation for inference.
+  const boosted_trees::TreeEnsemble& tree_ensemble() const {
+    return *tree_ensemble_;
+  }
+
   // Find the next node to which the example (specified by index_in_batch)
   // traverses down from the current node indicated by tree_id and node_id.
   // Args:
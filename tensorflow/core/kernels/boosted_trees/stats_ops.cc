@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 
@@ -23,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/boosted_trees/boosted_trees.pb.h"
 #include "tensorflow/core/kernels/boosted_trees/tree_helper.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -104,78 +106,88 @@ class BoostedTreesCalculateBestGainsPerFeatureOp : public OpKernel {
     // CalculateWeightsAndGains. This op only supports single dimension logits.
     Eigen::MatrixXf identity;
     identity.setIdentity(1, 1);
-    // Get the best split info per node for each feature.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
+    // Get the best split info per node for each feature. Features are
+    // independent, so they are processed in parallel.
+    std::vector<FeatureSplits> feature_splits(num_features_);
+    auto do_calculate_best_gains = [&](int64 begin, int64 end) {
       std::vector<float> cum_grad;
       std::vector<float> cum_hess;
       cum_grad.reserve(num_buckets);
       cum_hess.reserve(num_buckets);
-
-      std::vector<int32> output_node_ids;
-      std::vector<float> output_gains;
-      std::vector<int32> output_thresholds;
-      std::vector<float> output_left_node_contribs;
-      std::vector<float> output_right_node_contribs;
-      for (int node_id = node_id_first; node_id < node_id_last; ++node_id) {
-        // Calculate gains.
-        cum_grad.clear();
-        cum_hess.clear();
-        float total_grad = 0.0;
-        float total_hess = 0.0;
-        for (int bucket = 0; bucket < num_buckets; ++bucket) {
-          // TODO(nponomareva): Consider multi-dimensional gradients/hessians.
-          total_grad += stats_summary[feature_idx](node_id, bucket, 0);
-          total_hess += stats_summary[feature_idx](node_id, bucket, 1);
-          cum_grad.push_back(total_grad);
-          cum_hess.push_back(total_hess);
-        }
-        // Check if node has enough of average hessian.
-        if (total_hess < min_node_weight) {
-          // Do not split the node because not enough avg hessian.
-          continue;
-        }
-        float best_gain = std::numeric_limits<float>::lowest();
-        float best_bucket = 0;
-        float best_contrib_for_left = 0.0;
-        float best_contrib_for_right = 0.0;
-        // Parent gain.
-        float parent_gain;
-        Eigen::VectorXf unused(1);
-        CalculateWeightsAndGains(total_grad * identity, total_hess * identity,
-                                 l1, l2, &unused, &parent_gain);
-
-        for (int bucket = 0; bucket < num_buckets; ++bucket) {
-          const float cum_grad_bucket = cum_grad[bucket];
-          const float cum_hess_bucket = cum_hess[bucket];
-          // Left child.
-          Eigen::VectorXf contrib_for_left(1);
-          float gain_for_left;
-          CalculateWeightsAndGains(cum_grad_bucket * identity,
-                                   cum_hess_bucket * identity, l1, l2,
-                                   &contrib_for_left, &gain_for_left);
-          // Right child.
-          // use contrib_for_right.
-          Eigen::VectorXf contrib_for_right(1);
-          float gain_for_right;
-          CalculateWeightsAndGains((total_grad - cum_grad_bucket) * identity,
-                                   (total_hess - cum_hess_bucket) * identity,
-                                   l1, l2, &contrib_for_right, &gain_for_right);
-
-          if (GainIsLarger(gain_for_left + gain_for_right, best_gain)) {
-            best_gain = gain_for_left + gain_for_right;
-            best_bucket = bucket;
-            best_contrib_for_left = contrib_for_left[0];
-            best_contrib_for_right = contrib_for_right[0];
+      for (int64 feature_idx = begin; feature_idx < end; ++feature_idx) {
+        FeatureSplits& splits = feature_splits[feature_idx];
+        for (int node_id = node_id_first; node_id < node_id_last; ++node_id) {
+          // Calculate gains.
+          cum_grad.clear();
+          cum_hess.clear();
+          float total_grad = 0.0;
+          float total_hess = 0.0;
+          for (int bucket = 0; bucket < num_buckets; ++bucket) {
+            // TODO(nponomareva): Consider multi-dimensional gradients/hessians.
+            total_grad += stats_summary[feature_idx](node_id, bucket, 0);
+            total_hess += stats_summary[feature_idx](node_id, bucket, 1);
+            cum_grad.push_back(total_grad);
+            cum_hess.push_back(total_hess);
+          }
+          // Check if node has enough of average hessian.
+          if (total_hess < min_node_weight) {
+            // Do not split the node because not enough avg hessian.
+            continue;
           }
-        }  // for bucket
-        output_node_ids.push_back(node_id);
-        // Remove the parent gain for the parent node.
-        output_gains.push_back(best_gain - parent_gain);
-        output_thresholds.push_back(best_bucket);
-        output_left_node_contribs.push_back(best_contrib_for_left);
-        output_right_node_contribs.push_back(best_contrib_for_right);
-      }  // for node_id
-      const int num_nodes = output_node_ids.size();
+          float best_gain = std::numeric_limits<float>::lowest();
+          float best_bucket = 0;
+          float best_contrib_for_left = 0.0;
+          float best_contrib_for_right = 0.0;
+          // Parent gain.
+          float parent_gain;
+          Eigen::VectorXf unused(1);
+          CalculateWeightsAndGains(total_grad * identity, total_hess * identity,
+                                   l1, l2, &unused, &parent_gain);
+
+          for (int bucket = 0; bucket < num_buckets; ++bucket) {
+            const float cum_grad_bucket = cum_grad[bucket];
+            const float cum_hess_bucket = cum_hess[bucket];
+            // Left child.
+            Eigen::VectorXf contrib_for_left(1);
+            float gain_for_left;
+            CalculateWeightsAndGains(cum_grad_bucket * identity,
+                                     cum_hess_bucket * identity, l1, l2,
+                                     &contrib_for_left, &gain_for_left);
+            // Right child.
+            // use contrib_for_right.
+            Eigen::VectorXf contrib_for_right(1);
+            float gain_for_right;
+            CalculateWeightsAndGains((total_grad - cum_grad_bucket) * identity,
+                                     (total_hess - cum_hess_bucket) * identity,
+                                     l1, l2, &contrib_for_right,
+                                     &gain_for_right);
+
+            if (GainIsLarger(gain_for_left + gain_for_right, best_gain)) {
+              best_gain = gain_for_left + gain_for_right;
+              best_bucket = bucket;
+              best_contrib_for_left = contrib_for_left[0];
+              best_contrib_for_right = contrib_for_right[0];
+            }
+          }  // for bucket
+          splits.node_ids.push_back(node_id);
+          // Remove the parent gain for the parent node.
+          splits.gains.push_back(best_gain - parent_gain);
+          splits.thresholds.push_back(best_bucket);
+          splits.left_node_contribs.push_back(best_contrib_for_left);
+          splits.right_node_contribs.push_back(best_contrib_for_right);
+        }  // for node_id
+      }  // for feature_idx
+    };
+    const int64 kCostPerUnit =
+        50 * std::max(node_id_last - node_id_first, 1) * num_buckets;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_features_,
+          kCostPerUnit, do_calculate_best_gains);
+
+    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
+      const FeatureSplits& splits = feature_splits[feature_idx];
+      const int num_nodes = splits.node_ids.size();
       // output_node_ids
       Tensor* output_node_ids_t;
       OP_REQUIRES_OK(context,
@@ -209,18 +221,27 @@ class BoostedTreesCalculateBestGainsPerFeatureOp : public OpKernel {
           output_right_node_contribs_t->matrix<float>();
       // Sets output tensors from vectors.
       for (int i = 0; i < num_nodes; ++i) {
-        output_node_ids_vec(i) = output_node_ids[i];
+        output_node_ids_vec(i) = splits.node_ids[i];
         // Adjust the gains to penalize by tree complexity.
-        output_gains_vec(i) = output_gains[i] - tree_complexity;
-        output_thresholds_vec(i) = output_thresholds[i];
-        output_left_node_contribs_matrix(i, 0) = output_left_node_contribs[i];
+        output_gains_vec(i) = splits.gains[i] - tree_complexity;
+        output_thresholds_vec(i) = splits.thresholds[i];
+        output_left_node_contribs_matrix(i, 0) = splits.left_node_contribs[i];
         // This op only supports 1-dimensional logits.
-        output_right_node_contribs_matrix(i, 0) = output_right_node_contribs[i];
+        output_right_node_contribs_matrix(i, 0) = splits.right_node_contribs[i];
       }
     }  // for f
   }
 
  private:
+  // The best split of each node for a single feature.
+  struct FeatureSplits {
+    std::vector<int32> node_ids;
+    std::vector<float> gains;
+    std::vector<int32> thresholds;
+    std::vector<float> left_node_contribs;
+    std::vector<float> right_node_contribs;
+  };
+
   int max_splits_;
   int num_features_;
 };
@@ -1277,16 +1298,25 @@ class BoostedTreesMakeStatsSummaryOp : public OpKernel {
     auto temp_stats_double = temp_stats_double_t.tensor<double, 4>();
     temp_stats_double.setZero();
 
-    // Partition by node, and then bucketize.
-    for (int feature_idx = 0; feature_idx < num_features_; ++feature_idx) {
-      const auto& features = bucketized_features_list[feature_idx].vec<int32>();
-      for (int i = 0; i < batch_size; ++i) {
-        const int32 node = node_ids(i);
-        const int32 bucket = features(i);
-        temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
-        temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+    // Partition by node, and then bucketize. Each feature has its own slice
+    // of the stats, so features are accumulated in parallel.
+    auto do_make_stats_summary = [&](int64 begin, int64 end) {
+      for (int64 feature_idx = begin; feature_idx < end; ++feature_idx) {
+        const auto& features =
+            bucketized_features_list[feature_idx].vec<int32>();
+        for (int i = 0; i < batch_size; ++i) {
+          const int32 node = node_ids(i);
+          const int32 bucket = features(i);
+          temp_stats_double(feature_idx, node, bucket, 0) += gradients(i, 0);
+          temp_stats_double(feature_idx, node, bucket, 1) += hessians(i, 0);
+        }
       }
-    }
+    };
+    const int64 kCostPerUnit = 10 * batch_size;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_features_,
+          kCostPerUnit, do_make_stats_summary);
 
     // Copy temp tensor over to output tensor.
     Tensor* output_stats_summary_t = nullptr;
@@ -1354,22 +1384,32 @@ class BoostedTreesAggregateStatsOp : public OpKernel {
     auto temp_stats_double = temp_stats_double_t.tensor<double, 4>();
     temp_stats_double.setZero();
 
-    for (int i = 0; i < batch_size; ++i) {
-      const int32 node = node_ids(i);
-      for (int feature_dim = 0; feature_dim < feature_dims; ++feature_dim) {
-        const int32 feature_value = feature(i, feature_dim);
-        const int32 bucket =
-            (feature_value == -1) ? num_buckets_ : feature_value;
-        for (int stat_dim = 0; stat_dim < logits_dims; ++stat_dim) {
-          temp_stats_double(node, feature_dim, bucket, stat_dim) +=
-              gradients(i, stat_dim);
-        }
-        for (int stat_dim = logits_dims; stat_dim < stats_dims; ++stat_dim) {
-          temp_stats_double(node, feature_dim, bucket, stat_dim) +=
-              hessians(i, stat_dim - logits_dims);
+    // Each feature dimension has its own slice of the stats, so feature
+    // dimensions are accumulated in parallel.
+    auto do_aggregate_stats = [&](int64 begin, int64 end) {
+      for (int64 feature_dim = begin; feature_dim < end; ++feature_dim) {
+        for (int i = 0; i < batch_size; ++i) {
+          const int32 node = node_ids(i);
+          const int32 feature_value = feature(i, feature_dim);
+          const int32 bucket =
+              (feature_value == -1) ? num_buckets_ : feature_value;
+          for (int stat_dim = 0; stat_dim < logits_dims; ++stat_dim) {
+            temp_stats_double(node, feature_dim, bucket, stat_dim) +=
+                gradients(i, stat_dim);
+          }
+          for (int stat_dim = logits_dims; stat_dim < stats_dims;
+               ++stat_dim) {
+            temp_stats_double(node, feature_dim, bucket, stat_dim) +=
+                hessians(i, stat_dim - logits_dims);
+          }
         }
       }
-    }
+    };
+    const int64 kCostPerUnit = 5 * batch_size * stats_dims;
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, feature_dims,
+          kCostPerUnit, do_aggregate_stats);
 
     // Copy temp tensor over to output tensor, downcasting to float.
     Tensor* output_stats_summary_t = nullptr;
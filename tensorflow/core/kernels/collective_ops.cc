@@ -176,10 +176,36 @@ class CollectiveReduceOpKernel : public CollectiveOpKernel {
     OP_REQUIRES_OK(
         c, c->GetAttr("communication_hint",
                       &col_params_.instance.impl_details.communication_hint));
+    string communication_dtype;
+    OP_REQUIRES_OK(c, c->GetAttr("communication_dtype", &communication_dtype));
+    if (!communication_dtype.empty()) {
+      DataType dtype = DT_INVALID;
+      if (communication_dtype == "float16") {
+        dtype = DT_HALF;
+      } else if (communication_dtype == "bfloat16") {
+        dtype = DT_BFLOAT16;
+      }
+      OP_REQUIRES(c, dtype != DT_INVALID,
+                  errors::InvalidArgument(
+                      "communication_dtype must be one of {\"\", \"float16\", "
+                      "\"bfloat16\"} but got ",
+                      communication_dtype));
+      OP_REQUIRES(c, col_params_.instance.data_type == DT_FLOAT,
+                  errors::InvalidArgument(
+                      "communication_dtype can only be set for float "
+                      "reductions, but T is ",
+                      DataTypeString(col_params_.instance.data_type)));
+      OP_REQUIRES(c, c->device_type() == DEVICE_CPU,
+                  errors::Unimplemented(
+                      "communication_dtype is only supported on the CPU"));
+      col_params_.instance.communication_dtype = dtype;
+      col_params_.error_feedback.reset(new CollErrorFeedback);
+    }
     VLOG(2) << "CollectiveReduce instance " << col_params_.instance.instance_key
             << " merge_op " << merge_op_name << " final_op " << final_op_name
             << " communication_hint "
-            << col_params_.instance.impl_details.communication_hint;
+            << col_params_.instance.impl_details.communication_hint
+            << " communication_dtype " << communication_dtype;
 
     const NodeDef& real_node = c->def();
     col_params_.name = strings::StrCat(real_node.name(), ": Reduce(",
@@ -192,7 +218,10 @@ class CollectiveReduceOpKernel : public CollectiveOpKernel {
     sub_node.add_input(real_node.input(0));
     sub_node.add_input(real_node.input(0));
     sub_node.set_device(real_node.device());
-    SetAttrValue(col_params_.instance.data_type,
+    // The values are reduced in communication_dtype, if set.
+    SetAttrValue(col_params_.instance.communication_dtype != DT_INVALID
+                     ? col_params_.instance.communication_dtype
+                     : col_params_.instance.data_type,
                  &(*sub_node.mutable_attr())["T"]);
     col_params_.merge_op = BuildOpKernel(c, merge_op_name, &sub_node);
     col_params_.final_op = BuildOpKernel(c, final_op_name, &sub_node);
@@ -47,8 +47,10 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/padding.h"
 #include "tensorflow/core/util/tensor_format.h"
 #include "tensorflow/core/util/use_cudnn.h"
@@ -224,12 +226,54 @@ class LaunchDeepConvOp {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int /*out_cols*/, int /*out_depth*/, int /*dilation_rows*/,
                   int /*dilation_cols*/, int /*stride_rows*/,
-                  int /*stride_cols*/, Tensor* /*output*/,
-                  TensorFormat /*data_format*/) {
+                  int /*stride_cols*/, const Padding& /*padding*/,
+                  Tensor* /*output*/, TensorFormat /*data_format*/) {
     return false;
   }
 };
 
+namespace {
+// Process-wide cache of whether DeepConv2D or the default implementation was
+// the faster one for a Conv2D shape on the CPU. Only used with
+// TF_USE_DEEP_CONV2D_AUTOTUNE.
+class DeepConvAutotuneCache {
+ public:
+  typedef std::vector<int64> Key;
+
+  static DeepConvAutotuneCache* Global() {
+    static DeepConvAutotuneCache* cache = new DeepConvAutotuneCache;
+    return cache;
+  }
+
+  bool Find(const Key& key, bool* use_deep_conv) const {
+    tf_shared_lock l(mu_);
+    auto it = use_deep_conv_.find(key);
+    if (it == use_deep_conv_.end()) return false;
+    *use_deep_conv = it->second;
+    return true;
+  }
+
+  void Insert(const Key& key, bool use_deep_conv) {
+    mutex_lock l(mu_);
+    use_deep_conv_[key] = use_deep_conv;
+  }
+
+ private:
+  mutable mutex mu_;
+  std::map<Key, bool> use_deep_conv_ GUARDED_BY(mu_);
+};
+
+// Runs `launch` once to warm up caches and once more to time it, and returns
+// the time of the second run in microseconds.
+template <typename Launch>
+uint64 TimeConvLaunch(const Launch& launch) {
+  launch();
+  const uint64 start_us = Env::Default()->NowMicros();
+  launch();
+  return Env::Default()->NowMicros() - start_us;
+}
+}  // namespace
+
 // Conditionally launches DeepConv operation based on convolution parameters.
 template <>
 class LaunchDeepConvOp<CPUDevice, float> {
@@ -240,13 +284,59 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int dilation_rows,
                   int dilation_cols, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
+                  const Padding& padding, Tensor* output,
+                  TensorFormat data_format) {
     if (data_format != FORMAT_NHWC || dilation_rows != 1 ||
-        dilation_cols != 1 ||
-        !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
-                          in_depth, out_depth, out_rows, out_cols)) {
+        dilation_cols != 1) {
+      return false;
+    }
+    if (UseDeepConv2DAutotune() &&
+        DeepConv2DSupportsShape(stride_rows, stride_cols, filter_rows,
+                                filter_cols)) {
+      const DeepConvAutotuneCache::Key key = {
+          batch,       input_rows, input_cols, in_depth,  filter_rows,
+          filter_cols, pad_rows,   pad_cols,   out_depth, padding};
+      bool use_deep_conv;
+      if (!DeepConvAutotuneCache::Global()->Find(key, &use_deep_conv)) {
+        // Both implementations write the complete result to `output`, so the
+        // timing runs also compute this step.
+        const uint64 deep_conv_us = TimeConvLaunch([&]() {
+          Launch(ctx, input, filter, batch, input_rows, input_cols, in_depth,
+                 filter_rows, filter_cols, pad_rows, pad_cols, out_rows,
+                 out_cols, out_depth, output);
+        });
+        const uint64 default_us = TimeConvLaunch([&]() {
+          LaunchConv2DOp<CPUDevice, float>()(
+              ctx, /*use_cudnn=*/false, /*cudnn_use_autotune=*/false, input,
+              filter, dilation_rows, dilation_cols, stride_rows, stride_cols,
+              padding, /*explicit_paddings=*/{}, output, data_format);
+        });
+        use_deep_conv = deep_conv_us < default_us;
+        VLOG(1) << "Conv2D autotune: DeepConv2D took " << deep_conv_us
+                << "us, the default implementation took " << default_us
+                << "us for input " << input.shape().DebugString()
+                << " and filter " << filter.shape().DebugString();
+        DeepConvAutotuneCache::Global()->Insert(key, use_deep_conv);
+        return true;
+      }
+      if (!use_deep_conv) return false;
+    } else if (!CanUseDeepConv2D(stride_rows, stride_cols, filter_rows,
+                                 filter_cols, in_depth, out_depth, out_rows,
+                                 out_cols)) {
       return false;
     }
+    Launch(ctx, input, filter, batch, input_rows, input_cols, in_depth,
+           filter_rows, filter_cols, pad_rows, pad_cols, out_rows, out_cols,
+           out_depth, output);
+    return true;
+  }
+
+ private:
+  static void Launch(OpKernelContext* ctx, const Tensor& input,
+                     const Tensor& filter, int batch, int input_rows,
+                     int input_cols, int in_depth, int filter_rows,
+                     int filter_cols, int pad_rows, int pad_cols, int out_rows,
+                     int out_cols, int out_depth, Tensor* output) {
 
     Conv2DArgs args;
     args.batch = batch;
@@ -267,7 +357,6 @@ class LaunchDeepConvOp<CPUDevice, float> {
 
     functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
                                             output_ptr);
-    return true;
   }
 };
 
@@ -577,7 +666,8 @@ class Conv2DOp : public BinaryOp<T> {
             dimensions.pad_cols_before, dimensions.out_rows,
             dimensions.out_cols, dimensions.out_depth, dimensions.dilation_rows,
             dimensions.dilation_cols, dimensions.stride_rows,
-            dimensions.stride_cols, output, params_.data_format)) {
+            dimensions.stride_cols, params_.padding, output,
+            params_.data_format)) {
       return;
     }
 
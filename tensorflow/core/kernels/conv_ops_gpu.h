@@ -139,6 +139,7 @@ class ConvParameters {
     return !(*this == other);
   }
   uint64 hash() const { return hash_code_; }
+  int device_id() const { return device_id_; }
 
   string ToString() const {
     // clang-format off
@@ -152,7 +153,7 @@ class ConvParameters {
         "(", str_util::Join(stride_, ", "), "), ",
         "(", str_util::Join(padding_, ", "), "), ",
         dtype_, ", ",
-        device_id_,
+        device_id_, ", ",
         group_count_);
     // clang-format on
   }
@@ -222,6 +223,12 @@ class ConvParameters {
   int group_count_;
 };
 
+// Persists the autotuning results for ConvParameters across processes; see
+// GetAutotuneDeviceOrdinal() in gpu_utils.h.
+inline int GetAutotuneDeviceOrdinal(const ConvParameters& params) {
+  return params.device_id();
+}
+
 typedef Eigen::GpuDevice GPUDevice;
 
 }  // namespace tensorflow
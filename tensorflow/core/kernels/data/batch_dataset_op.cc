@@ -198,6 +198,14 @@ class BatchDatasetOp::Dataset : public DatasetBase {
         // element is moved into the output batch.
         TensorShape first_element_shape(first_element.shape());
         batch_component_shape.AppendShape(first_element_shape);
+        if (num_batch_elements == 1) {
+          // A batch of one element can share the element's buffer.
+          Tensor batch_component;
+          if (batch_component.CopyFrom(first_element, batch_component_shape)) {
+            out_tensors->push_back(std::move(batch_component));
+            continue;
+          }
+        }
         out_tensors->emplace_back(ctx->allocator({}), first_element.dtype(),
                                   batch_component_shape);
         if (!out_tensors->back().IsInitialized()) {
@@ -0,0 +1,438 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/partial_tensor_shape.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/experimental/columnar_format.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+// Reads the projected `columns` of columnar files, in batches of up to
+// `batch_size` rows. A dense column produces one component of shape
+// [batch, element_shape...]; a ragged column produces two, its flat values and
+// its int64 row splits. Batches do not span files.
+//
+// Only the chunks of the projected columns are read, and the chunks of a row
+// group are decoded in parallel on the iterator's runner.
+class ColumnarDatasetOp : public DatasetOpKernel {
+ public:
+  explicit ColumnarDatasetOp(OpKernelConstruction* ctx)
+      : DatasetOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_types", &output_types_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("output_shapes", &output_shapes_));
+  }
+
+  void MakeDataset(OpKernelContext* ctx, DatasetBase** output) override {
+    const Tensor* filenames_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("filenames", &filenames_tensor));
+    OP_REQUIRES(
+        ctx, filenames_tensor->dims() <= 1,
+        errors::InvalidArgument("`filenames` must be a scalar or a vector."));
+    std::vector<string> filenames;
+    filenames.reserve(filenames_tensor->NumElements());
+    for (int i = 0; i < filenames_tensor->NumElements(); ++i) {
+      filenames.push_back(filenames_tensor->flat<tstring>()(i));
+    }
+
+    const Tensor* columns_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("columns", &columns_tensor));
+    OP_REQUIRES(
+        ctx, columns_tensor->dims() <= 1 && columns_tensor->NumElements() > 0,
+        errors::InvalidArgument("`columns` must be a non-empty vector."));
+    std::vector<string> columns;
+    columns.reserve(columns_tensor->NumElements());
+    for (int i = 0; i < columns_tensor->NumElements(); ++i) {
+      columns.push_back(columns_tensor->flat<tstring>()(i));
+    }
+
+    int64 batch_size;
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, "batch_size", &batch_size));
+    OP_REQUIRES(ctx, batch_size > 0,
+                errors::InvalidArgument("`batch_size` must be positive."));
+    OP_REQUIRES(ctx, output_types_.size() >= columns.size(),
+                errors::InvalidArgument(
+                    "Expected at least one output type per column, got ",
+                    output_types_.size(), " for ", columns.size(),
+                    " columns."));
+
+    *output = new Dataset(ctx, std::move(filenames), std::move(columns),
+                          batch_size, output_types_, output_shapes_);
+  }
+
+ private:
+  class Dataset : public DatasetBase {
+   public:
+    Dataset(OpKernelContext* ctx, std::vector<string> filenames,
+            std::vector<string> columns, int64 batch_size,
+            const DataTypeVector& output_types,
+            const std::vector<PartialTensorShape>& output_shapes)
+        : DatasetBase(DatasetContext(ctx)),
+          filenames_(std::move(filenames)),
+          columns_(std::move(columns)),
+          batch_size_(batch_size),
+          output_types_(output_types),
+          output_shapes_(output_shapes) {}
+
+    std::unique_ptr<IteratorBase> MakeIteratorInternal(
+        const string& prefix) const override {
+      return absl::make_unique<Iterator>(
+          Iterator::Params{this, strings::StrCat(prefix, "::Columnar")});
+    }
+
+    const DataTypeVector& output_dtypes() const override {
+      return output_types_;
+    }
+
+    const std::vector<PartialTensorShape>& output_shapes() const override {
+      return output_shapes_;
+    }
+
+    string DebugString() const override {
+      return "ColumnarDatasetOp::Dataset";
+    }
+
+    Status CheckExternalState() const override { return Status::OK(); }
+
+   protected:
+    Status AsGraphDefInternal(SerializationContext* ctx,
+                              DatasetGraphDefBuilder* b,
+                              Node** output) const override {
+      Node* filenames = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(filenames_, &filenames));
+      Node* columns = nullptr;
+      TF_RETURN_IF_ERROR(b->AddVector(columns_, &columns));
+      Node* batch_size = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(batch_size_, &batch_size));
+      TF_RETURN_IF_ERROR(
+          b->AddDataset(this, {filenames, columns, batch_size}, output));
+      return Status::OK();
+    }
+
+   private:
+    class Iterator : public DatasetIterator<Dataset> {
+     public:
+      explicit Iterator(const Params& params)
+          : DatasetIterator<Dataset>(params) {}
+
+      Status GetNextInternal(IteratorContext* ctx,
+                             std::vector<Tensor>* out_tensors,
+                             bool* end_of_sequence) override {
+        mutex_lock l(mu_);
+        std::vector<Piece> pieces;
+        int64 num_rows = 0;
+        while (num_rows < dataset()->batch_size_) {
+          if (!reader_) {
+            if (current_file_index_ == dataset()->filenames_.size()) break;
+            TF_RETURN_IF_ERROR(SetupReaderLocked(ctx->env()));
+            continue;
+          }
+          if (!row_group_ || row_in_group_ == row_group_rows_) {
+            if (next_row_group_ == reader_->num_row_groups()) {
+              ResetReaderLocked();
+              ++current_file_index_;
+              if (num_rows > 0) break;
+              continue;
+            }
+            TF_RETURN_IF_ERROR(LoadRowGroupLocked(ctx, next_row_group_));
+            continue;
+          }
+          const int64 take = std::min(dataset()->batch_size_ - num_rows,
+                                      row_group_rows_ - row_in_group_);
+          pieces.push_back({row_group_, row_in_group_, row_in_group_ + take});
+          row_in_group_ += take;
+          row_in_file_ += take;
+          num_rows += take;
+        }
+        if (num_rows == 0) {
+          *end_of_sequence = true;
+          return Status::OK();
+        }
+
+        Allocator* allocator = ctx->allocator({});
+        for (int c = 0; c < dataset()->columns_.size(); ++c) {
+          const ColumnarColumn& column = columns_[c];
+          if (column.ragged) {
+            int64 num_values = 0;
+            for (const Piece& piece : pieces) {
+              const ColumnChunk& chunk = (*piece.chunks)[c];
+              num_values += chunk.row_splits[piece.end] -
+                            chunk.row_splits[piece.begin];
+            }
+            Tensor row_splits(allocator, DT_INT64,
+                              TensorShape({num_rows + 1}));
+            auto splits = row_splits.vec<int64>();
+            splits(0) = 0;
+            int64 row = 0;
+            for (const Piece& piece : pieces) {
+              const ColumnChunk& chunk = (*piece.chunks)[c];
+              const int64 base =
+                  splits(row) - chunk.row_splits[piece.begin];
+              for (int64 r = piece.begin; r < piece.end; ++r) {
+                splits(++row) = base + chunk.row_splits[r + 1];
+              }
+            }
+            out_tensors->push_back(
+                GatherValues(allocator, c, pieces,
+                             TensorShape({num_values}),
+                             [](const ColumnChunk& chunk, int64 row) {
+                               return chunk.row_splits[row];
+                             }));
+            out_tensors->push_back(std::move(row_splits));
+          } else {
+            const int64 row_size = column.element_shape.num_elements();
+            TensorShape shape({num_rows});
+            shape.AppendShape(column.element_shape);
+            out_tensors->push_back(
+                GatherValues(allocator, c, pieces, shape,
+                             [row_size](const ColumnChunk& chunk, int64 row) {
+                               return row * row_size;
+                             }));
+          }
+        }
+        *end_of_sequence = false;
+        return Status::OK();
+      }
+
+     protected:
+      std::shared_ptr<model::Node> CreateNode(
+          IteratorContext* ctx, model::Node::Args args) const override {
+        return model::MakeSourceNode(std::move(args));
+      }
+
+      Status SaveInternal(SerializationContext* ctx,
+                          IteratorStateWriter* writer) override {
+        mutex_lock l(mu_);
+        TF_RETURN_IF_ERROR(writer->WriteScalar(full_name("current_file_index"),
+                                               current_file_index_));
+        if (reader_) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(full_name("row_in_file"), row_in_file_));
+        }
+        return Status::OK();
+      }
+
+      Status RestoreInternal(IteratorContext* ctx,
+                             IteratorStateReader* reader) override {
+        mutex_lock l(mu_);
+        ResetReaderLocked();
+        int64 current_file_index;
+        TF_RETURN_IF_ERROR(reader->ReadScalar(full_name("current_file_index"),
+                                              &current_file_index));
+        current_file_index_ = current_file_index;
+        if (!reader->Contains(full_name("row_in_file"))) {
+          return Status::OK();
+        }
+        int64 row_in_file;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name("row_in_file"), &row_in_file));
+        TF_RETURN_IF_ERROR(SetupReaderLocked(ctx->env()));
+        if (row_in_file < 0 || row_in_file > reader_->total_rows()) {
+          return errors::DataLoss("Invalid row ", row_in_file, " in ",
+                                  dataset()->filenames_[current_file_index_]);
+        }
+        int64 group_start = 0;
+        while (next_row_group_ < reader_->num_row_groups() &&
+               group_start + reader_->num_rows(next_row_group_) <=
+                   row_in_file) {
+          group_start += reader_->num_rows(next_row_group_);
+          ++next_row_group_;
+        }
+        row_in_file_ = row_in_file;
+        if (next_row_group_ < reader_->num_row_groups()) {
+          TF_RETURN_IF_ERROR(LoadRowGroupLocked(ctx, next_row_group_));
+          row_in_group_ = row_in_file - group_start;
+        }
+        return Status::OK();
+      }
+
+     private:
+      // Rows [begin, end) of a decoded row group.
+      struct Piece {
+        std::shared_ptr<const std::vector<ColumnChunk>> chunks;
+        int64 begin;
+        int64 end;
+      };
+
+      // Concatenates the values of column `c` in `pieces` into a tensor of
+      // `shape`. `value_offset` maps a row of a chunk to the index of its
+      // first value. A batch that is exactly one whole chunk reuses its
+      // buffer.
+      template <typename ValueOffset>
+      Tensor GatherValues(Allocator* allocator, int c,
+                          const std::vector<Piece>& pieces,
+                          const TensorShape& shape,
+                          const ValueOffset& value_offset) {
+        const DataType dtype = columns_[c].dtype;
+        if (pieces.size() == 1) {
+          const Piece& piece = pieces[0];
+          const ColumnChunk& chunk = (*piece.chunks)[c];
+          if (piece.begin == 0 && piece.end == chunk.num_rows()) {
+            return chunk.values;
+          }
+        }
+        Tensor result(allocator, dtype, shape);
+        int64 offset = 0;
+        for (const Piece& piece : pieces) {
+          const ColumnChunk& chunk = (*piece.chunks)[c];
+          const int64 begin = value_offset(chunk, piece.begin);
+          const int64 num_values = value_offset(chunk, piece.end) - begin;
+          if (dtype == DT_STRING) {
+            const auto src = chunk.values.flat<tstring>();
+            auto dst = result.flat<tstring>();
+            for (int64 i = 0; i < num_values; ++i) {
+              dst(offset + i) = src(begin + i);
+            }
+          } else {
+            const int64 value_size = DataTypeSize(dtype);
+            std::memcpy(
+                const_cast<char*>(result.tensor_data().data()) +
+                    offset * value_size,
+                chunk.values.tensor_data().data() + begin * value_size,
+                num_values * value_size);
+          }
+          offset += num_values;
+        }
+        return result;
+      }
+
+      // Opens the current file and checks that it has the projected columns
+      // with the expected types and shapes.
+      Status SetupReaderLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const string& filename = dataset()->filenames_[current_file_index_];
+        TF_RETURN_IF_ERROR(ColumnarReader::Open(env, filename, &reader_));
+        column_indices_.clear();
+        columns_.clear();
+        size_t output = 0;
+        for (const string& name : dataset()->columns_) {
+          const int index = reader_->FindColumn(name);
+          if (index < 0) {
+            ResetReaderLocked();
+            return errors::InvalidArgument("Column ", name, " not found in ",
+                                           filename);
+          }
+          const ColumnarColumn& column = reader_->schema()[index];
+          const size_t num_outputs = column.ragged ? 2 : 1;
+          if (output + num_outputs > dataset()->output_types_.size() ||
+              dataset()->output_types_[output] != column.dtype ||
+              (column.ragged &&
+               dataset()->output_types_[output + 1] != DT_INT64)) {
+            ResetReaderLocked();
+            return errors::InvalidArgument(
+                "Column ", name, " of ", filename, " is a ",
+                column.ragged ? "ragged " : "", DataTypeString(column.dtype),
+                " column, which does not match the output types ",
+                DataTypeVectorString(dataset()->output_types_));
+          }
+          column_indices_.push_back(index);
+          columns_.push_back(column);
+          output += num_outputs;
+        }
+        if (output != dataset()->output_types_.size()) {
+          ResetReaderLocked();
+          return errors::InvalidArgument(
+              "The columns of ", filename, " produce ", output,
+              " components, expected ", dataset()->output_types_.size());
+        }
+        next_row_group_ = 0;
+        row_in_file_ = 0;
+        return Status::OK();
+      }
+
+      void ResetReaderLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        reader_.reset();
+        row_group_.reset();
+        row_group_rows_ = 0;
+        row_in_group_ = 0;
+        next_row_group_ = 0;
+        row_in_file_ = 0;
+      }
+
+      // Reads and decodes the projected chunks of `row_group`, in parallel.
+      Status LoadRowGroupLocked(IteratorContext* ctx, int64 row_group)
+          TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+        const int num_columns = column_indices_.size();
+        auto chunks = std::make_shared<std::vector<ColumnChunk>>(num_columns);
+        std::vector<Status> statuses(num_columns);
+        Allocator* allocator = ctx->allocator({});
+        const ColumnarReader* reader = reader_.get();
+        auto read_chunk = [&, reader](int c) {
+          statuses[c] = reader->ReadColumnChunk(row_group, column_indices_[c],
+                                                allocator, &(*chunks)[c]);
+        };
+        if (num_columns == 1) {
+          read_chunk(0);
+        } else {
+          BlockingCounter counter(num_columns);
+          for (int c = 0; c < num_columns; ++c) {
+            (*ctx->runner())([&read_chunk, &counter, c]() {
+              read_chunk(c);
+              counter.DecrementCount();
+            });
+          }
+          counter.Wait();
+        }
+        for (const Status& s : statuses) {
+          TF_RETURN_IF_ERROR(s);
+        }
+        row_group_ = std::move(chunks);
+        row_group_rows_ = reader_->num_rows(row_group);
+        row_in_group_ = 0;
+        next_row_group_ = row_group + 1;
+        return Status::OK();
+      }
+
+      mutex mu_;
+      size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
+      std::unique_ptr<ColumnarReader> reader_ TF_GUARDED_BY(mu_);
+      // Index in the file schema and description of each projected column.
+      std::vector<int> column_indices_ TF_GUARDED_BY(mu_);
+      std::vector<ColumnarColumn> columns_ TF_GUARDED_BY(mu_);
+      // The decoded projected chunks of the current row group.
+      std::shared_ptr<const std::vector<ColumnChunk>> row_group_
+          TF_GUARDED_BY(mu_);
+      int64 row_group_rows_ TF_GUARDED_BY(mu_) = 0;
+      int64 row_in_group_ TF_GUARDED_BY(mu_) = 0;
+      int64 next_row_group_ TF_GUARDED_BY(mu_) = 0;
+      int64 row_in_file_ TF_GUARDED_BY(mu_) = 0;
+    };
+
+    const std::vector<string> filenames_;
+    const std::vector<string> columns_;
+    const int64 batch_size_;
+    const DataTypeVector output_types_;
+    const std::vector<PartialTensorShape> output_shapes_;
+  };
+
+  DataTypeVector output_types_;
+  std::vector<PartialTensorShape> output_shapes_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("ColumnarDataset").Device(DEVICE_CPU),
+                        ColumnarDatasetOp);
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,388 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_format.h"
+
+#include <cstring>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/coding.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+constexpr char kMagic[] = "TFCOLUMN";
+constexpr size_t kMagicSize = 8;
+// The footer size and the trailing magic.
+constexpr size_t kTrailerSize = 8 + kMagicSize;
+
+// Appends the masked crc32c of `data` to it.
+void AppendCrc(string* data) {
+  core::PutFixed32(data, crc32c::Mask(crc32c::Value(data->data(),
+                                                    data->size())));
+}
+
+// Checks and strips the masked crc32c at the end of `data`.
+Status CheckCrc(const string& filename, StringPiece* data) {
+  if (data->size() < sizeof(uint32)) {
+    return errors::DataLoss("Truncated columnar file ", filename);
+  }
+  const size_t size = data->size() - sizeof(uint32);
+  const uint32 expected =
+      crc32c::Unmask(core::DecodeFixed32(data->data() + size));
+  if (crc32c::Value(data->data(), size) != expected) {
+    return errors::DataLoss("Checksum mismatch in columnar file ", filename);
+  }
+  data->remove_suffix(sizeof(uint32));
+  return Status::OK();
+}
+
+bool GetLengthPrefixed(StringPiece* input, string* value) {
+  uint64 length;
+  if (!core::GetVarint64(input, &length) || length > input->size()) {
+    return false;
+  }
+  value->assign(input->data(), length);
+  input->remove_prefix(length);
+  return true;
+}
+
+}  // namespace
+
+bool IsSupportedColumnarType(DataType dtype) {
+  switch (dtype) {
+    case DT_BOOL:
+    case DT_INT32:
+    case DT_INT64:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+    case DT_STRING:
+      return true;
+    default:
+      return false;
+  }
+}
+
+ColumnarWriter::ColumnarWriter(WritableFile* file,
+                               std::vector<ColumnarColumn> schema)
+    : file_(file), schema_(std::move(schema)) {
+  if (!port::kLittleEndian) {
+    status_ = errors::Unimplemented(
+        "Columnar files can only be written on little-endian hosts");
+    return;
+  }
+  for (const ColumnarColumn& column : schema_) {
+    if (!IsSupportedColumnarType(column.dtype)) {
+      status_ = errors::InvalidArgument("Column ", column.name,
+                                        " has unsupported type ",
+                                        DataTypeString(column.dtype));
+      return;
+    }
+    if (column.ragged && column.element_shape.dims() != 0) {
+      status_ = errors::InvalidArgument("Ragged column ", column.name,
+                                        " must have scalar elements");
+      return;
+    }
+  }
+  status_ = Append(StringPiece(kMagic, kMagicSize));
+}
+
+Status ColumnarWriter::Append(StringPiece data) {
+  TF_RETURN_IF_ERROR(file_->Append(data));
+  offset_ += data.size();
+  return Status::OK();
+}
+
+Status ColumnarWriter::WriteRowGroup(const std::vector<ColumnChunk>& chunks) {
+  TF_RETURN_IF_ERROR(status_);
+  if (chunks.size() != schema_.size()) {
+    return errors::InvalidArgument("Expected ", schema_.size(),
+                                   " column chunks, got ", chunks.size());
+  }
+  const int64 num_rows = chunks.empty() ? 0 : chunks[0].num_rows();
+  std::vector<ChunkLocation> locations;
+  for (int i = 0; i < schema_.size(); ++i) {
+    const ColumnarColumn& column = schema_[i];
+    const ColumnChunk& chunk = chunks[i];
+    if (chunk.values.dtype() != column.dtype) {
+      return errors::InvalidArgument(
+          "Column ", column.name, " has type ", DataTypeString(column.dtype),
+          ", got ", DataTypeString(chunk.values.dtype()));
+    }
+    if (chunk.num_rows() != num_rows) {
+      return errors::InvalidArgument("Column ", column.name, " has ",
+                                     chunk.num_rows(), " rows, expected ",
+                                     num_rows);
+    }
+
+    string payload;
+    if (column.ragged) {
+      if (chunk.values.dims() != 1 || chunk.row_splits.empty() ||
+          chunk.row_splits.front() != 0 ||
+          chunk.row_splits.back() != chunk.values.NumElements()) {
+        return errors::InvalidArgument(
+            "Ragged column ", column.name,
+            " needs a vector of values and row splits that span it");
+      }
+      for (int64 row = 0; row < num_rows; ++row) {
+        const int64 length =
+            chunk.row_splits[row + 1] - chunk.row_splits[row];
+        if (length < 0) {
+          return errors::InvalidArgument("Row splits of column ", column.name,
+                                         " are not sorted");
+        }
+        core::PutVarint64(&payload, length);
+      }
+    } else {
+      TensorShape expected_shape({num_rows});
+      expected_shape.AppendShape(column.element_shape);
+      if (chunk.values.shape() != expected_shape || !chunk.row_splits.empty()) {
+        return errors::InvalidArgument(
+            "Column ", column.name, " expects values of shape ",
+            expected_shape.DebugString(), ", got ",
+            chunk.values.shape().DebugString());
+      }
+    }
+    if (column.dtype == DT_STRING) {
+      const auto values = chunk.values.flat<tstring>();
+      for (int64 j = 0; j < values.size(); ++j) {
+        core::PutVarint64(&payload, values(j).size());
+      }
+      for (int64 j = 0; j < values.size(); ++j) {
+        payload.append(values(j).data(), values(j).size());
+      }
+    } else {
+      const StringPiece data = chunk.values.tensor_data();
+      payload.append(data.data(), data.size());
+    }
+    AppendCrc(&payload);
+    locations.push_back({offset_, payload.size()});
+    TF_RETURN_IF_ERROR(Append(payload));
+  }
+  row_group_rows_.push_back(num_rows);
+  row_group_chunks_.push_back(std::move(locations));
+  return Status::OK();
+}
+
+Status ColumnarWriter::Finish() {
+  TF_RETURN_IF_ERROR(status_);
+  string footer;
+  core::PutVarint64(&footer, schema_.size());
+  for (const ColumnarColumn& column : schema_) {
+    core::PutVarint64(&footer, column.name.size());
+    footer.append(column.name);
+    core::PutVarint32(&footer, column.dtype);
+    core::PutVarint32(&footer, column.ragged);
+    core::PutVarint32(&footer, column.element_shape.dims());
+    for (int d = 0; d < column.element_shape.dims(); ++d) {
+      core::PutVarint64(&footer, column.element_shape.dim_size(d));
+    }
+  }
+  core::PutVarint64(&footer, row_group_rows_.size());
+  for (int64 g = 0; g < row_group_rows_.size(); ++g) {
+    core::PutVarint64(&footer, row_group_rows_[g]);
+    for (const ChunkLocation& location : row_group_chunks_[g]) {
+      core::PutVarint64(&footer, location.offset);
+      core::PutVarint64(&footer, location.size);
+    }
+  }
+  AppendCrc(&footer);
+  core::PutFixed64(&footer, footer.size());
+  footer.append(kMagic, kMagicSize);
+  status_ = Append(footer);
+  TF_RETURN_IF_ERROR(status_);
+  status_ = errors::FailedPrecondition("Columnar writer is finished");
+  return Status::OK();
+}
+
+Status ColumnarReader::Open(Env* env, const string& filename,
+                            std::unique_ptr<ColumnarReader>* reader) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Columnar files can only be read on little-endian hosts");
+  }
+  std::unique_ptr<ColumnarReader> result(new ColumnarReader);
+  result->filename_ = filename;
+  uint64 file_size;
+  TF_RETURN_IF_ERROR(env->GetFileSize(filename, &file_size));
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &result->file_));
+  if (file_size < kMagicSize + kTrailerSize) {
+    return errors::DataLoss(filename, " is too short to be a columnar file");
+  }
+
+  char trailer_scratch[kTrailerSize];
+  StringPiece trailer;
+  TF_RETURN_IF_ERROR(result->file_->Read(file_size - kTrailerSize,
+                                         kTrailerSize, &trailer,
+                                         trailer_scratch));
+  if (trailer.size() != kTrailerSize ||
+      trailer.substr(8) != StringPiece(kMagic, kMagicSize)) {
+    return errors::DataLoss(filename, " is not a columnar file");
+  }
+  const uint64 footer_size = core::DecodeFixed64(trailer.data());
+  const uint64 data_end = file_size - kTrailerSize;
+  if (footer_size > data_end - kMagicSize) {
+    return errors::DataLoss("Invalid footer size in columnar file ",
+                            filename);
+  }
+  string footer_scratch(footer_size, '\0');
+  StringPiece footer;
+  TF_RETURN_IF_ERROR(result->file_->Read(data_end - footer_size, footer_size,
+                                         &footer, &footer_scratch[0]));
+  if (footer.size() != footer_size) {
+    return errors::DataLoss("Truncated columnar file ", filename);
+  }
+  TF_RETURN_IF_ERROR(CheckCrc(filename, &footer));
+  const uint64 chunks_end = data_end - footer_size;
+
+  auto parse_error = [&filename]() {
+    return errors::DataLoss("Invalid footer in columnar file ", filename);
+  };
+  uint64 num_columns;
+  if (!core::GetVarint64(&footer, &num_columns) ||
+      num_columns > footer.size()) {
+    return parse_error();
+  }
+  result->schema_.resize(num_columns);
+  for (ColumnarColumn& column : result->schema_) {
+    uint32 dtype, ragged, dims;
+    if (!GetLengthPrefixed(&footer, &column.name) ||
+        !core::GetVarint32(&footer, &dtype) ||
+        !core::GetVarint32(&footer, &ragged) ||
+        !core::GetVarint32(&footer, &dims) ||
+        dims > TensorShape::MaxDimensions()) {
+      return parse_error();
+    }
+    column.dtype = static_cast<DataType>(dtype);
+    column.ragged = ragged != 0;
+    if (!IsSupportedColumnarType(column.dtype)) return parse_error();
+    std::vector<int64> dim_sizes(dims);
+    for (int64& dim_size : dim_sizes) {
+      uint64 value;
+      if (!core::GetVarint64(&footer, &value) ||
+          value > static_cast<uint64>(kint64max)) {
+        return parse_error();
+      }
+      dim_size = value;
+    }
+    TF_RETURN_IF_ERROR(
+        TensorShapeUtils::MakeShape(dim_sizes, &column.element_shape));
+  }
+  uint64 num_row_groups;
+  if (!core::GetVarint64(&footer, &num_row_groups) ||
+      num_row_groups > footer.size()) {
+    return parse_error();
+  }
+  for (uint64 g = 0; g < num_row_groups; ++g) {
+    uint64 num_rows;
+    if (!core::GetVarint64(&footer, &num_rows) ||
+        num_rows > static_cast<uint64>(kint64max)) {
+      return parse_error();
+    }
+    std::vector<ChunkLocation> locations(num_columns);
+    for (ChunkLocation& location : locations) {
+      if (!core::GetVarint64(&footer, &location.offset) ||
+          !core::GetVarint64(&footer, &location.size) ||
+          location.offset < kMagicSize || location.offset > chunks_end ||
+          location.size > chunks_end - location.offset) {
+        return parse_error();
+      }
+    }
+    result->row_group_rows_.push_back(num_rows);
+    result->row_group_chunks_.push_back(std::move(locations));
+    result->total_rows_ += num_rows;
+  }
+  if (!footer.empty()) return parse_error();
+  *reader = std::move(result);
+  return Status::OK();
+}
+
+int ColumnarReader::FindColumn(StringPiece name) const {
+  for (int i = 0; i < schema_.size(); ++i) {
+    if (schema_[i].name == name) return i;
+  }
+  return -1;
+}
+
+Status ColumnarReader::ReadColumnChunk(int64 row_group, int column,
+                                       Allocator* allocator,
+                                       ColumnChunk* chunk) const {
+  const ColumnarColumn& spec = schema_[column];
+  const ChunkLocation& location = row_group_chunks_[row_group][column];
+  const int64 num_rows = row_group_rows_[row_group];
+  string scratch(location.size, '\0');
+  StringPiece data;
+  TF_RETURN_IF_ERROR(
+      file_->Read(location.offset, location.size, &data, &scratch[0]));
+  if (data.size() != location.size) {
+    return errors::DataLoss("Truncated columnar file ", filename_);
+  }
+  TF_RETURN_IF_ERROR(CheckCrc(filename_, &data));
+  auto corrupt = [this, &spec]() {
+    return errors::DataLoss("Corrupt chunk of column ", spec.name,
+                            " in columnar file ", filename_);
+  };
+
+  TensorShape shape;
+  chunk->row_splits.clear();
+  if (spec.ragged) {
+    chunk->row_splits.reserve(num_rows + 1);
+    chunk->row_splits.push_back(0);
+    for (int64 row = 0; row < num_rows; ++row) {
+      uint64 length;
+      if (!core::GetVarint64(&data, &length) || length > data.size()) {
+        return corrupt();
+      }
+      chunk->row_splits.push_back(chunk->row_splits.back() + length);
+    }
+    shape.AddDim(chunk->row_splits.back());
+  } else {
+    shape.AddDim(num_rows);
+    shape.AppendShape(spec.element_shape);
+  }
+  chunk->values = Tensor(allocator, spec.dtype, shape);
+  const int64 num_values = shape.num_elements();
+
+  if (spec.dtype == DT_STRING) {
+    auto values = chunk->values.flat<tstring>();
+    std::vector<uint64> lengths(num_values);
+    for (int64 i = 0; i < num_values; ++i) {
+      if (!core::GetVarint64(&data, &lengths[i]) ||
+          lengths[i] > data.size()) {
+        return corrupt();
+      }
+    }
+    for (int64 i = 0; i < num_values; ++i) {
+      if (lengths[i] > data.size()) return corrupt();
+      values(i).assign(data.data(), lengths[i]);
+      data.remove_prefix(lengths[i]);
+    }
+  } else {
+    const size_t num_bytes = num_values * DataTypeSize(spec.dtype);
+    if (data.size() != num_bytes) return corrupt();
+    std::memcpy(const_cast<char*>(chunk->values.tensor_data().data()),
+                data.data(), num_bytes);
+    data.remove_prefix(num_bytes);
+  }
+  if (!data.empty()) return corrupt();
+  return Status::OK();
+}
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
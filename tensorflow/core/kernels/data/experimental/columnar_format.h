@@ -0,0 +1,144 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FORMAT_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FORMAT_H_
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+
+// A columnar file stores a table as a sequence of row groups. Each row group
+// stores every column in its own contiguous chunk, so that a reader can read
+// only the columns it needs, and decode them independently:
+//
+//   "TFCOLUMN"
+//   column chunks, row group after row group
+//   footer: schema, and the number of rows and chunk locations of each row
+//           group
+//   fixed64 footer size
+//   "TFCOLUMN"
+//
+// A dense column has a fixed element shape, and its chunk holds the values of
+// all its rows. A ragged column has scalar elements and a variable number of
+// them per row, and its chunk starts with the row lengths. Chunks and the
+// footer end with a masked crc32c of their contents.
+
+// Supported column types.
+bool IsSupportedColumnarType(DataType dtype);
+
+struct ColumnarColumn {
+  string name;
+  DataType dtype = DT_INVALID;
+  // Whether rows have a variable number of scalar elements.
+  bool ragged = false;
+  // Shape of the elements of each row of a dense column.
+  TensorShape element_shape;
+};
+
+// The decoded chunk of one column in one row group.
+struct ColumnChunk {
+  // [num_rows, element_shape...] for dense columns, [num_values] for ragged
+  // columns.
+  Tensor values;
+  // num_rows + 1 offsets into `values` for ragged columns, empty otherwise.
+  std::vector<int64> row_splits;
+
+  int64 num_rows() const {
+    return row_splits.empty() ? (values.dims() > 0 ? values.dim_size(0) : 0)
+                              : row_splits.size() - 1;
+  }
+};
+
+// Writes a columnar file. Not thread-safe.
+class ColumnarWriter {
+ public:
+  // `file` must outlive the writer.
+  ColumnarWriter(WritableFile* file, std::vector<ColumnarColumn> schema);
+
+  // Appends a row group with one chunk per column of the schema, all with the
+  // same number of rows.
+  Status WriteRowGroup(const std::vector<ColumnChunk>& chunks);
+
+  // Writes the footer. The file must be closed by the caller.
+  Status Finish();
+
+ private:
+  struct ChunkLocation {
+    uint64 offset;
+    uint64 size;
+  };
+
+  Status Append(StringPiece data);
+
+  WritableFile* const file_;  // Not owned.
+  const std::vector<ColumnarColumn> schema_;
+  uint64 offset_ = 0;
+  std::vector<int64> row_group_rows_;
+  std::vector<std::vector<ChunkLocation>> row_group_chunks_;
+  Status status_;
+};
+
+// Reads a columnar file. The reads of column chunks are thread-safe.
+class ColumnarReader {
+ public:
+  // Opens `filename` and reads its footer.
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<ColumnarReader>* reader);
+
+  const std::vector<ColumnarColumn>& schema() const { return schema_; }
+
+  // Returns the index of the column `name` in the schema, or -1.
+  int FindColumn(StringPiece name) const;
+
+  int64 num_row_groups() const { return row_group_rows_.size(); }
+  int64 num_rows(int64 row_group) const { return row_group_rows_[row_group]; }
+  int64 total_rows() const { return total_rows_; }
+
+  // Reads and decodes the chunk of `column` in `row_group`.
+  Status ReadColumnChunk(int64 row_group, int column, Allocator* allocator,
+                         ColumnChunk* chunk) const;
+
+ private:
+  struct ChunkLocation {
+    uint64 offset;
+    uint64 size;
+  };
+
+  ColumnarReader() = default;
+
+  string filename_;
+  std::unique_ptr<RandomAccessFile> file_;
+  std::vector<ColumnarColumn> schema_;
+  std::vector<int64> row_group_rows_;
+  std::vector<std::vector<ChunkLocation>> row_group_chunks_;
+  int64 total_rows_ = 0;
+};
+
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_EXPERIMENTAL_COLUMNAR_FORMAT_H_
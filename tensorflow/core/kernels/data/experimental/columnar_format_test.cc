@@ -0,0 +1,147 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/experimental/columnar_format.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace experimental {
+namespace {
+
+std::vector<ColumnarColumn> TestSchema() {
+  std::vector<ColumnarColumn> schema(3);
+  schema[0].name = "id";
+  schema[0].dtype = DT_INT64;
+  schema[1].name = "embedding";
+  schema[1].dtype = DT_FLOAT;
+  schema[1].element_shape = TensorShape({2});
+  schema[2].name = "tokens";
+  schema[2].dtype = DT_STRING;
+  schema[2].ragged = true;
+  return schema;
+}
+
+// Writes two row groups of 3 and 1 rows.
+Status WriteTestFile(const string& filename) {
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(Env::Default()->NewWritableFile(filename, &file));
+  ColumnarWriter writer(file.get(), TestSchema());
+
+  std::vector<ColumnChunk> first(3);
+  first[0].values = test::AsTensor<int64>({1, 2, 3});
+  first[1].values = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2});
+  first[2].values = test::AsTensor<tstring>({"a", "b", "c"});
+  first[2].row_splits = {0, 2, 2, 3};
+  TF_RETURN_IF_ERROR(writer.WriteRowGroup(first));
+
+  std::vector<ColumnChunk> second(3);
+  second[0].values = test::AsTensor<int64>({4});
+  second[1].values = test::AsTensor<float>({7, 8}, {1, 2});
+  second[2].values = test::AsTensor<tstring>({"dd"});
+  second[2].row_splits = {0, 1};
+  TF_RETURN_IF_ERROR(writer.WriteRowGroup(second));
+
+  TF_RETURN_IF_ERROR(writer.Finish());
+  return file->Close();
+}
+
+TEST(ColumnarFormatTest, RoundTrip) {
+  const string filename = io::JoinPath(testing::TmpDir(), "round_trip");
+  TF_ASSERT_OK(WriteTestFile(filename));
+
+  std::unique_ptr<ColumnarReader> reader;
+  TF_ASSERT_OK(ColumnarReader::Open(Env::Default(), filename, &reader));
+  ASSERT_EQ(reader->schema().size(), 3);
+  EXPECT_EQ(reader->schema()[1].name, "embedding");
+  EXPECT_EQ(reader->schema()[1].element_shape, TensorShape({2}));
+  EXPECT_TRUE(reader->schema()[2].ragged);
+  EXPECT_EQ(reader->num_row_groups(), 2);
+  EXPECT_EQ(reader->num_rows(0), 3);
+  EXPECT_EQ(reader->total_rows(), 4);
+
+  ColumnChunk chunk;
+  TF_ASSERT_OK(reader->ReadColumnChunk(0, 1, cpu_allocator(), &chunk));
+  test::ExpectTensorEqual<float>(
+      chunk.values, test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2}));
+  EXPECT_TRUE(chunk.row_splits.empty());
+
+  TF_ASSERT_OK(reader->ReadColumnChunk(0, 2, cpu_allocator(), &chunk));
+  test::ExpectTensorEqual<tstring>(chunk.values,
+                                   test::AsTensor<tstring>({"a", "b", "c"}));
+  EXPECT_EQ(chunk.row_splits, std::vector<int64>({0, 2, 2, 3}));
+
+  TF_ASSERT_OK(reader->ReadColumnChunk(1, 0, cpu_allocator(), &chunk));
+  test::ExpectTensorEqual<int64>(chunk.values, test::AsTensor<int64>({4}));
+}
+
+TEST(ColumnarFormatTest, FindColumn) {
+  const string filename = io::JoinPath(testing::TmpDir(), "find_column");
+  TF_ASSERT_OK(WriteTestFile(filename));
+  std::unique_ptr<ColumnarReader> reader;
+  TF_ASSERT_OK(ColumnarReader::Open(Env::Default(), filename, &reader));
+  EXPECT_EQ(reader->FindColumn("tokens"), 2);
+  EXPECT_EQ(reader->FindColumn("missing"), -1);
+}
+
+TEST(ColumnarFormatTest, RejectsMismatchedChunks) {
+  const string filename = io::JoinPath(testing::TmpDir(), "mismatched");
+  std::unique_ptr<WritableFile> file;
+  TF_ASSERT_OK(Env::Default()->NewWritableFile(filename, &file));
+  ColumnarWriter writer(file.get(), TestSchema());
+
+  std::vector<ColumnChunk> chunks(3);
+  chunks[0].values = test::AsTensor<int64>({1, 2});
+  chunks[1].values = test::AsTensor<float>({1, 2, 3, 4, 5, 6}, {3, 2});
+  chunks[2].values = test::AsTensor<tstring>({"a"});
+  chunks[2].row_splits = {0, 1, 1};
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.WriteRowGroup(chunks)));
+
+  chunks[1].values = test::AsTensor<float>({1, 2, 3, 4}, {2, 2});
+  chunks[2].row_splits = {0, 1, 2};
+  EXPECT_TRUE(errors::IsInvalidArgument(writer.WriteRowGroup(chunks)));
+}
+
+TEST(ColumnarFormatTest, DetectsCorruption) {
+  const string filename = io::JoinPath(testing::TmpDir(), "corrupt");
+  TF_ASSERT_OK(WriteTestFile(filename));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), filename, &contents));
+
+  // Flip a byte of the first chunk.
+  string corrupt = contents;
+  corrupt[8] ^= 1;
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename, corrupt));
+  std::unique_ptr<ColumnarReader> reader;
+  TF_ASSERT_OK(ColumnarReader::Open(Env::Default(), filename, &reader));
+  ColumnChunk chunk;
+  EXPECT_TRUE(errors::IsDataLoss(
+      reader->ReadColumnChunk(0, 0, cpu_allocator(), &chunk)));
+
+  // Truncate the file.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), filename,
+                                 contents.substr(0, contents.size() - 1)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      ColumnarReader::Open(Env::Default(), filename, &reader)));
+}
+
+}  // namespace
+}  // namespace experimental
+}  // namespace data
+}  // namespace tensorflow
@@ -48,6 +48,7 @@ namespace experimental {
 /* static */ constexpr const char* const
     MapAndBatchDatasetOp::kNumParallelCalls;
 /* static */ constexpr const char* const MapAndBatchDatasetOp::kDropRemainder;
+/* static */ constexpr const char* const MapAndBatchDatasetOp::kBufferSize;
 /* static */ constexpr const char* const MapAndBatchDatasetOp::kFunc;
 /* static */ constexpr const char* const MapAndBatchDatasetOp::kTarguments;
 /* static */ constexpr const char* const MapAndBatchDatasetOp::kOutputTypes;
@@ -60,6 +61,8 @@ namespace experimental {
 namespace {
 
 constexpr int64 kMaxBatchResults = 16;
+constexpr char kParallelMapBatchPrefetchDataset[] =
+    "ParallelMapBatchPrefetchDataset";
 constexpr char kParallelism[] = "parallelism";
 constexpr char kCallCounter[] = "call_counter";
 constexpr char kBatchResultsSize[] = "batch_results_size";
@@ -83,8 +86,8 @@ inline int64 CeilDiv(int64 x, int64 y) { return (x + y - 1) / y; }
 class MapAndBatchDatasetOp::Dataset : public DatasetBase {
  public:
   Dataset(OpKernelContext* ctx, const DatasetBase* input, int64 batch_size,
-          int64 num_parallel_calls, bool drop_remainder,
-          const DataTypeVector& output_types,
+          int64 num_parallel_calls, bool drop_remainder, bool fuse_prefetch,
+          int64 buffer_size, const DataTypeVector& output_types,
           const std::vector<PartialTensorShape>& output_shapes,
           std::unique_ptr<CapturedFunction> captured_func,
           bool preserve_cardinality)
@@ -93,6 +96,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
         batch_size_(batch_size),
         num_parallel_calls_(num_parallel_calls),
         drop_remainder_(drop_remainder),
+        fuse_prefetch_(fuse_prefetch),
+        buffer_size_(buffer_size),
         output_types_(output_types),
         output_shapes_(output_shapes),
         captured_func_(std::move(captured_func)),
@@ -150,6 +155,16 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
         b->AddScalar(num_parallel_calls_, &num_parallel_calls_node));
     Node* drop_remainder_node;
     TF_RETURN_IF_ERROR(b->AddScalar(drop_remainder_, &drop_remainder_node));
+    std::vector<std::pair<size_t, Node*>> inputs = {
+        std::make_pair(0, input_graph_node),
+        std::make_pair(2, batch_size_node),
+        std::make_pair(3, num_parallel_calls_node),
+        std::make_pair(4, drop_remainder_node)};
+    if (fuse_prefetch_) {
+      Node* buffer_size_node;
+      TF_RETURN_IF_ERROR(b->AddScalar(buffer_size_, &buffer_size_node));
+      inputs.emplace_back(5, buffer_size_node);
+    }
     std::vector<Node*> other_arguments;
     DataTypeVector other_arguments_types;
     TF_RETURN_IF_ERROR(captured_func_->AddToGraph(ctx, b, &other_arguments,
@@ -163,11 +178,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
 
     TF_RETURN_IF_ERROR(b->AddDataset(
         this,
-        {std::make_pair(0, input_graph_node),
-         std::make_pair(2, batch_size_node),
-         std::make_pair(3, num_parallel_calls_node),
-         std::make_pair(4, drop_remainder_node)},  // Single tensor inputs.
-        {std::make_pair(1, other_arguments)},      // Tensor list inputs.
+        inputs,                                // Single tensor inputs.
+        {std::make_pair(1, other_arguments)},  // Tensor list inputs.
         {std::make_pair(kFunc, f),
          std::make_pair(kTarguments, other_arguments_types_attr),
          std::make_pair(kPreserveCardinality,
@@ -196,6 +208,18 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
                       ? port::NumSchedulableCPUs()  // maximum parallelism
                       : params.dataset->num_parallel_calls_,
                   params.dataset->batch_size_));
+      // A fused prefetch keeps up to `buffer_size` more batches in the same
+      // buffer, so that they are computed ahead of the consumer without
+      // passing through a separate prefetching iterator. When autotuned, the
+      // buffer starts with one more batch and grows while the consumer waits.
+      const int64 buffer_size = params.dataset->buffer_size_;
+      if (buffer_size == model::kAutotune) {
+        max_batch_results_ += 1;
+        max_batch_results_limit_ = 2 * kMaxBatchResults;
+      } else {
+        max_batch_results_ += buffer_size;
+        max_batch_results_limit_ = kMaxBatchResults + buffer_size;
+      }
     }
 
     ~Iterator() override {
@@ -583,7 +607,7 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
           mutex_lock l(*mu_);
           while (!cancelled_ && busy()) {
             if (waiting_ > 0 && num_calls_ < num_parallel_calls_->value &&
-                max_batch_results_ < kMaxBatchResults) {
+                max_batch_results_ < max_batch_results_limit_) {
               // If there is a caller waiting for a batch and the number of
               // outstanding calls is not maxed out, it means we are out of
               // `batch_results_` slots. Instead of waiting for a slot to open
@@ -771,6 +795,8 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
     int64 waiting_ TF_GUARDED_BY(*mu_) = 0;
     // Identifies the maximum number of batch results to store.
     int64 max_batch_results_ TF_GUARDED_BY(*mu_);
+    // Bounds the growth of `max_batch_results_`.
+    int64 max_batch_results_limit_;
     std::unique_ptr<InstantiatedCapturedFunction> instantiated_captured_func_;
 
     // Method for deregistering the cancellation callback.
@@ -781,6 +807,9 @@ class MapAndBatchDatasetOp::Dataset : public DatasetBase {
   const int64 batch_size_;
   const int64 num_parallel_calls_;
   const bool drop_remainder_;
+  const bool fuse_prefetch_;
+  // Number of batches to prefetch, 0 unless `fuse_prefetch_` is set.
+  const int64 buffer_size_;
   const DataTypeVector output_types_;
   const std::vector<PartialTensorShape> output_shapes_;
   const std::unique_ptr<CapturedFunction> captured_func_;
@@ -796,6 +825,7 @@ MapAndBatchDatasetOp::MapAndBatchDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr(kOutputShapes, &output_shapes_));
   OP_REQUIRES_OK(ctx,
                  ctx->GetAttr(kPreserveCardinality, &preserve_cardinality_));
+  fuse_prefetch_ = ctx->def().op() == kParallelMapBatchPrefetchDataset;
 }
 
 void MapAndBatchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
@@ -816,6 +846,16 @@ void MapAndBatchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   OP_REQUIRES_OK(ctx,
                  ParseScalarArgument(ctx, kDropRemainder, &drop_remainder));
 
+  int64 buffer_size = 0;
+  if (fuse_prefetch_) {
+    OP_REQUIRES_OK(ctx, ParseScalarArgument(ctx, kBufferSize, &buffer_size));
+    OP_REQUIRES(ctx, buffer_size >= 0 || buffer_size == model::kAutotune,
+                errors::InvalidArgument("buffer_size must be >= 0 or set "
+                                        "buffer_size to be ",
+                                        model::kAutotune,
+                                        " for auto-tuning"));
+  }
+
   std::unique_ptr<CapturedFunction> captured_func;
   OP_REQUIRES_OK(ctx,
                  CapturedFunction::Create(ctx, func_metadata_, kOtherArguments,
@@ -826,8 +866,9 @@ void MapAndBatchDatasetOp::MakeDataset(OpKernelContext* ctx, DatasetBase* input,
   }
 
   *output = new Dataset(ctx, input, batch_size, num_parallel_calls,
-                        drop_remainder, output_types_, output_shapes_,
-                        std::move(captured_func), preserve_cardinality_);
+                        drop_remainder, fuse_prefetch_, buffer_size,
+                        output_types_, output_shapes_, std::move(captured_func),
+                        preserve_cardinality_);
 }
 
 namespace {
@@ -836,9 +877,13 @@ REGISTER_KERNEL_BUILDER(Name("MapAndBatchDataset").Device(DEVICE_CPU),
 REGISTER_KERNEL_BUILDER(
     Name("ExperimentalMapAndBatchDataset").Device(DEVICE_CPU),
     MapAndBatchDatasetOp);
+REGISTER_KERNEL_BUILDER(
+    Name("ParallelMapBatchPrefetchDataset").Device(DEVICE_CPU),
+    MapAndBatchDatasetOp);
 
 REGISTER_INPUT_COLOCATION_EXEMPTION("MapAndBatchDataset");
 REGISTER_INPUT_COLOCATION_EXEMPTION("ExperimentalMapAndBatchDataset");
+REGISTER_INPUT_COLOCATION_EXEMPTION("ParallelMapBatchPrefetchDataset");
 }  // namespace
 }  // namespace experimental
 }  // namespace data
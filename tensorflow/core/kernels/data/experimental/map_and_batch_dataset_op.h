@@ -23,7 +23,9 @@ namespace data {
 namespace experimental {
 
 // See documentation in ../../ops/experimental_dataset_ops.cc for a high-level
-// description of the following op.
+// description of the following op. The kernel also implements
+// ParallelMapBatchPrefetchDataset, which additionally takes a `buffer_size`
+// of batches to prefetch.
 
 class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
  public:
@@ -33,6 +35,7 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   static constexpr const char* const kBatchSize = "batch_size";
   static constexpr const char* const kNumParallelCalls = "num_parallel_calls";
   static constexpr const char* const kDropRemainder = "drop_remainder";
+  static constexpr const char* const kBufferSize = "buffer_size";
   static constexpr const char* const kFunc = "f";
   static constexpr const char* const kTarguments = "Targuments";
   static constexpr const char* const kOutputTypes = "output_types";
@@ -52,6 +55,8 @@ class MapAndBatchDatasetOp : public UnaryDatasetOpKernel {
   DataTypeVector output_types_;
   std::vector<PartialTensorShape> output_shapes_;
   bool preserve_cardinality_;
+  // Whether the op fuses a prefetch, and so takes a `buffer_size` input.
+  bool fuse_prefetch_;
 };
 
 }  // namespace experimental
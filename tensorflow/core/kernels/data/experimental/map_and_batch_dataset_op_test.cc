@@ -97,6 +97,41 @@ class MapAndBatchDatasetParams : public DatasetParams {
   bool preserve_cardinality_;
 };
 
+class ParallelMapBatchPrefetchDatasetParams : public MapAndBatchDatasetParams {
+ public:
+  template <typename T>
+  ParallelMapBatchPrefetchDatasetParams(
+      T input_dataset_params, int64 batch_size, int64 num_parallel_calls,
+      bool drop_remainder, int64 buffer_size,
+      FunctionDefHelper::AttrValueWrapper func,
+      std::vector<FunctionDef> func_lib, DataTypeVector output_dtypes,
+      std::vector<PartialTensorShape> output_shapes, string node_name)
+      : MapAndBatchDatasetParams(
+            std::move(input_dataset_params), /*other_arguments=*/{},
+            batch_size, num_parallel_calls, drop_remainder, std::move(func),
+            std::move(func_lib), /*type_arguments=*/{},
+            /*preserve_cardinality=*/false, std::move(output_dtypes),
+            std::move(output_shapes), std::move(node_name)),
+        buffer_size_(buffer_size) {}
+
+  std::vector<Tensor> GetInputTensors() const override {
+    std::vector<Tensor> inputs = MapAndBatchDatasetParams::GetInputTensors();
+    inputs.emplace_back(CreateTensor<int64>(TensorShape({}), {buffer_size_}));
+    return inputs;
+  }
+
+  Status GetInputNames(std::vector<string>* input_names) const override {
+    TF_RETURN_IF_ERROR(MapAndBatchDatasetParams::GetInputNames(input_names));
+    input_names->emplace_back(MapAndBatchDatasetOp::kBufferSize);
+    return Status::OK();
+  }
+
+  string dataset_type() const override { return "ParallelMapBatchPrefetch"; }
+
+ private:
+  int64 buffer_size_;
+};
+
 class MapAndBatchDatasetOpTest : public DatasetOpsTestBase {};
 
 FunctionDefHelper::AttrValueWrapper MapFunc(const string& func_name,
@@ -419,6 +454,60 @@ TEST_F(MapAndBatchDatasetOpTest, InvalidNumParallel) {
             tensorflow::error::INVALID_ARGUMENT);
 }
 
+TEST_F(MapAndBatchDatasetOpTest, ParallelMapBatchPrefetchGetNext) {
+  auto dataset_params = ParallelMapBatchPrefetchDatasetParams(
+      RangeDatasetParams(0, 10, 2),
+      /*batch_size=*/2,
+      /*num_parallel_calls=*/2,
+      /*drop_remainder=*/true,
+      /*buffer_size=*/2,
+      /*func=*/MapFunc("XTimesTwo", DT_INT64),
+      /*func_lib=*/{test::function::XTimesTwo()},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({2})},
+      /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(
+      CreateTensors<int64>(TensorShape({2}), {{0, 4}, {8, 12}}),
+      /*compare_order=*/true));
+}
+
+TEST_F(MapAndBatchDatasetOpTest, ParallelMapBatchPrefetchAutotuneGetNext) {
+  auto dataset_params = ParallelMapBatchPrefetchDatasetParams(
+      RangeDatasetParams(0, 10, 2),
+      /*batch_size=*/2,
+      /*num_parallel_calls=*/model::kAutotune,
+      /*drop_remainder=*/false,
+      /*buffer_size=*/model::kAutotune,
+      /*func=*/MapFunc("XTimesTwo", DT_INT64),
+      /*func_lib=*/{test::function::XTimesTwo()},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(CheckIteratorGetNext(
+      {CreateTensor<int64>(TensorShape({2}), {0, 4}),
+       CreateTensor<int64>(TensorShape({2}), {8, 12}),
+       CreateTensor<int64>(TensorShape({1}), {16})},
+      /*compare_order=*/true));
+}
+
+TEST_F(MapAndBatchDatasetOpTest, ParallelMapBatchPrefetchInvalidBufferSize) {
+  auto dataset_params = ParallelMapBatchPrefetchDatasetParams(
+      RangeDatasetParams(0, 10, 2),
+      /*batch_size=*/2,
+      /*num_parallel_calls=*/2,
+      /*drop_remainder=*/false,
+      /*buffer_size=*/-2,
+      /*func=*/MapFunc("XTimesTwo", DT_INT64),
+      /*func_lib=*/{test::function::XTimesTwo()},
+      /*output_dtypes=*/{DT_INT64},
+      /*output_shapes=*/{PartialTensorShape({-1})},
+      /*node_name=*/kNodeName);
+  EXPECT_EQ(Initialize(dataset_params).code(),
+            tensorflow::error::INVALID_ARGUMENT);
+}
+
 }  // namespace
 }  // namespace experimental
 }  // namespace data
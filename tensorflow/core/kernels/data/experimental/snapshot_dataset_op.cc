@@ -84,6 +84,7 @@ constexpr char kRunDir[] = "run_dir";
 constexpr char kVersionStr[] = "version";
 constexpr char kFilenames[] = "filenames";
 constexpr char kCurrentFilenames[] = "current_filenames";
+constexpr char kCurrentPositions[] = "current_positions";
 constexpr char kElementsProduced[] = "elements_produced";
 constexpr char kNextFileIndex[] = "next_file_index";
 constexpr char kNumFilesDone[] = "num_files_done";
@@ -537,6 +538,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
 
           for (auto i = 0; i < dataset()->num_reader_threads_; ++i) {
             curr_filenames_.push_back(GetNextFilename());
+            curr_positions_.push_back(0);
           }
           return Status::OK();
         }
@@ -648,6 +650,26 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
             TF_RETURN_IF_ERROR(writer->WriteScalar(
                 full_name(strings::StrCat(kCurrentFilenames, "[", i, "]")),
                 curr_filenames_[i]));
+            TF_RETURN_IF_ERROR(writer->WriteScalar(
+                full_name(strings::StrCat(kCurrentPositions, "[", i, "]")),
+                curr_positions_[i]));
+          }
+          // Elements that were read but not yet produced are saved, so that
+          // the reader threads can resume from `curr_positions_`.
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              full_name(strings::StrCat(kBuffer, kSizeSuffix)),
+              buffer_.size()));
+          for (size_t i = 0; i < buffer_.size(); ++i) {
+            const BufferElement& buffer_element = buffer_[i];
+            TF_RETURN_IF_ERROR(WriteStatus(writer, i, buffer_element.status));
+            TF_RETURN_IF_ERROR(writer->WriteScalar(
+                full_name(strings::StrCat(kBuffer, "[", i, "]", kSizeSuffix)),
+                buffer_element.value.size()));
+            for (size_t j = 0; j < buffer_element.value.size(); ++j) {
+              TF_RETURN_IF_ERROR(writer->WriteTensor(
+                  full_name(strings::StrCat(kBuffer, "[", i, "][", j, "]")),
+                  buffer_element.value[j]));
+            }
           }
           TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kElementsProduced),
                                                  elements_produced_));
@@ -668,8 +690,8 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           tstring hash_dir, run_id, run_dir;
           TF_RETURN_IF_ERROR(
               reader->ReadScalar(full_name(kHashDir), &hash_dir));
-          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kHashDir), &run_id));
-          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kHashDir), &run_dir));
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRunId), &run_id));
+          TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kRunDir), &run_dir));
           if (run_dir != run_dir_) {
             LOG(ERROR) << "Restoring read iterator from ckpt with old "
                        << "run_dir: " << run_dir
@@ -683,11 +705,41 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
               reader->ReadScalar(full_name(kVersionStr), &version_));
           curr_filenames_.clear();
           curr_filenames_.reserve(dataset()->num_reader_threads_);
+          curr_positions_.assign(dataset()->num_reader_threads_, 0);
           for (auto i = 0; i < dataset()->num_reader_threads_; ++i) {
             curr_filenames_.emplace_back();
             TF_RETURN_IF_ERROR(reader->ReadScalar(
                 full_name(strings::StrCat(kCurrentFilenames, "[", i, "]")),
                 &curr_filenames_.back()));
+            const string position_key =
+                full_name(strings::StrCat(kCurrentPositions, "[", i, "]"));
+            if (reader->Contains(position_key)) {
+              TF_RETURN_IF_ERROR(
+                  reader->ReadScalar(position_key, &curr_positions_[i]));
+            }
+          }
+          buffer_.clear();
+          if (reader->Contains(
+                  full_name(strings::StrCat(kBuffer, kSizeSuffix)))) {
+            int64 buffer_size;
+            TF_RETURN_IF_ERROR(reader->ReadScalar(
+                full_name(strings::StrCat(kBuffer, kSizeSuffix)),
+                &buffer_size));
+            for (int64 i = 0; i < buffer_size; ++i) {
+              BufferElement buffer_element;
+              TF_RETURN_IF_ERROR(ReadStatus(reader, i, &buffer_element.status));
+              int64 size;
+              TF_RETURN_IF_ERROR(reader->ReadScalar(
+                  full_name(strings::StrCat(kBuffer, "[", i, "]", kSizeSuffix)),
+                  &size));
+              buffer_element.value.resize(size);
+              for (int64 j = 0; j < size; ++j) {
+                TF_RETURN_IF_ERROR(reader->ReadTensor(
+                    full_name(strings::StrCat(kBuffer, "[", i, "][", j, "]")),
+                    &buffer_element.value[j]));
+              }
+              buffer_.push_back(std::move(buffer_element));
+            }
           }
           size_t filenames_size;
           {
@@ -730,13 +782,17 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         }
 
        private:
-        // Reads one file end to end.
-        Status ReadFile(const string& filename) {
+        // Reads one file to the end, starting at the record at `position`,
+        // on behalf of reader thread `i`.
+        Status ReadFile(int i, const string& filename, int64 position) {
           std::unique_ptr<RandomAccessFile> file;
           TF_RETURN_IF_ERROR(
               Env::Default()->NewRandomAccessFile(filename, &file));
           snapshot_util::Reader reader(file.get(), dataset()->compression_,
                                        version_, dataset()->output_dtypes());
+          if (position > 0) {
+            TF_RETURN_IF_ERROR(reader.SkipTo(position));
+          }
 
           while (true) {
             // Wait for a slot in the buffer.
@@ -762,8 +818,10 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
               BufferElement elem;
               elem.value = std::move(read_tensors);
               elem.status = Status::OK();
+              const int64 next_position = reader.Tell();
               mutex_lock l(mu_);
               buffer_.push_back(std::move(elem));
+              curr_positions_[i] = next_position;
               num_elements_read_++;
               cond_var_.notify_all();
             } else if (errors::IsOutOfRange(s)) {
@@ -795,15 +853,23 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
           });
           while (true) {
             string filename = "";
+            int64 position = 0;
             {
               mutex_lock l(mu_);
               filename = curr_filenames_[i];
               if (filename.empty()) {
+                // All files may have been read before the iterator was
+                // restored.
+                if (num_files_done_ >= filenames_.size()) {
+                  background_threads_finished_ = true;
+                  cond_var_.notify_all();
+                }
                 return;
               }
-              VLOG(2) << "Starting to read: " << filename;
+              position = curr_positions_[i];
+              VLOG(2) << "Starting to read: " << filename << " at " << position;
             }
-            Status s = ReadFile(filename);
+            Status s = ReadFile(i, filename, position);
             // If we get to the end of the file, it's a clean termination and
             // we are at the end of the file. If all files have been processed,
             // then we insert an end_of_sequence marker in the buffer and
@@ -818,6 +884,7 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
                 return;
               }
               curr_filenames_[i] = GetNextFilename();
+              curr_positions_[i] = 0;
             } else {
               LOG(ERROR) << "Encountered an error: " << s.ToString();
               BufferElement elem;
@@ -897,6 +964,9 @@ class SnapshotDatasetOp : public UnaryDatasetOpKernel {
         int64 num_elements_read_ TF_GUARDED_BY(mu_) = 0;
         // curr_filenames_ tracks which file is being read by each thread.
         std::vector<tstring> curr_filenames_ TF_GUARDED_BY(mu_);
+        // curr_positions_ tracks the position of the next record that each
+        // thread reads from its file.
+        std::vector<int64> curr_positions_ TF_GUARDED_BY(mu_);
       };
 
       class SnapshotWriterIterator : public DatasetIterator<Dataset> {
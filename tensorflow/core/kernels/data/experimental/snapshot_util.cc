@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/experimental/snapshot_util.h"
 
 #include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/common_runtime/metrics.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_outputbuffer.h"
 #include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/random.h"
@@ -36,6 +38,7 @@ namespace tensorflow {
 namespace data {
 namespace snapshot_util {
 
+/* static */ constexpr const size_t Writer::kWriteBufferSizeBytes;
 /* static */ constexpr const int64 Reader::kSnappyReaderInputBufferSizeBytes;
 /* static */ constexpr const int64 Reader::kSnappyReaderOutputBufferSizeBytes;
 
@@ -60,6 +63,9 @@ Writer::Writer(WritableFile* dest, const string& compression_type, int version,
     dest_is_owned_ = true;
   }
 #endif  // IS_SLIM_BUILD
+  // Small appends to a file are expensive on remote file systems, so records
+  // are gathered into large writes.
+  buffer_writes_ = !dest_is_owned_;
   simple_tensor_mask_.reserve(dtypes.size());
   for (const auto& dtype : dtypes) {
     if (DataTypeCanUseMemcpy(dtype)) {
@@ -94,6 +100,7 @@ Status Writer::WriteTensors(const std::vector<Tensor>& tensors) {
         "Version 1 is only compatible with snappy compression");
   }
 
+  const uint64 start_micros = EnvTime::NowMicros();
   std::vector<const TensorBuffer*> tensor_buffers;
   tensor_buffers.reserve(num_simple_);
   std::vector<TensorProto> tensor_protos;
@@ -120,8 +127,10 @@ Status Writer::WriteTensors(const std::vector<Tensor>& tensors) {
     total_size += size;
   }
 
-  std::vector<char> uncompressed(total_size);
-  char* position = uncompressed.data();
+  // We use tstring for access to resize_uninitialized.
+  tstring uncompressed;
+  uncompressed.resize_uninitialized(total_size);
+  char* position = uncompressed.mdata();
   int buffer_index = 0;
   int proto_index = 0;
   for (int i = 0; i < tensors.size(); ++i) {
@@ -143,6 +152,8 @@ Status Writer::WriteTensors(const std::vector<Tensor>& tensors) {
   if (!port::Snappy_Compress(uncompressed.data(), total_size, &output)) {
     return errors::Internal("Failed to compress using snappy.");
   }
+  metrics::RecordTFDataSnapshotStage("compress", total_size,
+                                     EnvTime::NowMicros() - start_micros);
 #if defined(PLATFORM_GOOGLE)
   absl::Cord metadata_serialized = metadata.SerializeAsCord();
 #else   // PLATFORM_GOOGLE
@@ -153,16 +164,19 @@ Status Writer::WriteTensors(const std::vector<Tensor>& tensors) {
   return Status::OK();
 }
 
-Status Writer::Sync() { return dest_->Sync(); }
+Status Writer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return dest_->Sync();
+}
 
 Status Writer::Close() {
+  Status s = Flush();
   if (dest_is_owned_) {
-    Status s = dest_->Close();
+    s.Update(dest_->Close());
     delete dest_;
     dest_ = nullptr;
-    return s;
   }
-  return Status::OK();
+  return s;
 }
 
 Writer::~Writer() {
@@ -177,12 +191,40 @@ Writer::~Writer() {
 Status Writer::WriteRecord(const StringPiece& data) {
   char header[kHeaderSize];
   core::EncodeFixed64(header, data.size());
-  TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
-  return dest_->Append(data);
+  if (!buffer_writes_ || data.size() >= kWriteBufferSizeBytes) {
+    // Large records are written directly, rather than copied to the buffer.
+    TF_RETURN_IF_ERROR(Flush());
+    TF_RETURN_IF_ERROR(Append(StringPiece(header, sizeof(header))));
+    return Append(data);
+  }
+  write_buffer_.append(header, sizeof(header));
+  write_buffer_.append(data.data(), data.size());
+  if (write_buffer_.size() >= kWriteBufferSizeBytes) {
+    return Flush();
+  }
+  return Status::OK();
+}
+
+Status Writer::Flush() {
+  if (write_buffer_.empty()) {
+    return Status::OK();
+  }
+  Status s = Append(write_buffer_);
+  write_buffer_.clear();
+  return s;
+}
+
+Status Writer::Append(StringPiece data) {
+  const uint64 start_micros = EnvTime::NowMicros();
+  TF_RETURN_IF_ERROR(dest_->Append(data));
+  metrics::RecordTFDataSnapshotStage("write", data.size(),
+                                     EnvTime::NowMicros() - start_micros);
+  return Status::OK();
 }
 
 #if defined(PLATFORM_GOOGLE)
 Status Writer::WriteRecord(const absl::Cord& data) {
+  TF_RETURN_IF_ERROR(Flush());
   char header[kHeaderSize];
   core::EncodeFixed64(header, data.size());
   TF_RETURN_IF_ERROR(dest_->Append(StringPiece(header, sizeof(header))));
@@ -298,6 +340,15 @@ Status Reader::ReadTensors(std::vector<Tensor>* read_tensors) {
   return Status::OK();
 }
 
+Status Reader::SkipTo(int64 position) {
+  const int64 current = input_stream_->Tell();
+  if (position < current) {
+    return errors::InvalidArgument("Cannot skip back to position ", position,
+                                   " from position ", current);
+  }
+  return input_stream_->SkipNBytes(position - current);
+}
+
 Status Reader::ReadTensorsV0(std::vector<Tensor>* read_tensors) {
   experimental::SnapshotRecord record;
 #if defined(PLATFORM_GOOGLE)
@@ -361,18 +412,25 @@ Status Reader::SnappyUncompress(
                             " whereas the tensor metadata suggests ",
                             total_size);
   }
+  const uint64 start_micros = EnvTime::NowMicros();
   if (!port::Snappy_UncompressToIOVec(compressed.data(), compressed.size(),
                                       iov.data(), num_tensors)) {
     return errors::Internal("Failed to perform snappy decompression.");
   }
+  metrics::RecordTFDataSnapshotStage("uncompress", total_size,
+                                     EnvTime::NowMicros() - start_micros);
   return Status::OK();
 }
 
 Status Reader::ReadRecord(tstring* record) {
+  const uint64 start_micros = EnvTime::NowMicros();
   tstring header;
   TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(kHeaderSize, &header));
   uint64 length = core::DecodeFixed64(header.data());
-  return input_stream_->ReadNBytes(length, record);
+  TF_RETURN_IF_ERROR(input_stream_->ReadNBytes(length, record));
+  metrics::RecordTFDataSnapshotStage("read", kHeaderSize + length,
+                                     EnvTime::NowMicros() - start_micros);
+  return Status::OK();
 }
 
 #if defined(PLATFORM_GOOGLE)
@@ -50,6 +50,9 @@ enum Mode { READER = 0, WRITER = 1, PASSTHROUGH = 2 };
 class Writer {
  public:
   static constexpr const size_t kHeaderSize = sizeof(uint64);
+  // Records are gathered into writes of about this many bytes, unless the
+  // destination is an output buffer that compresses its input.
+  static constexpr const size_t kWriteBufferSizeBytes = 4 << 20;  // 4 MiB
 
   static constexpr const char* const kClassName = "SnapshotWriter";
   static constexpr const char* const kWriteStringPiece = "WriteStringPiece";
@@ -70,12 +73,21 @@ class Writer {
  private:
   Status WriteRecord(const StringPiece& data);
 
+  // Writes the buffered records to `dest_`.
+  Status Flush();
+
+  // Appends `data` to `dest_`, and records the time it took.
+  Status Append(StringPiece data);
+
 #if defined(PLATFORM_GOOGLE)
   Status WriteRecord(const absl::Cord& data);
 #endif  // PLATFORM_GOOGLE
 
   WritableFile* dest_;
   bool dest_is_owned_ = false;
+  // Whether records are gathered in `write_buffer_` before they are written.
+  bool buffer_writes_ = false;
+  string write_buffer_;
   const string compression_type_;
   const int version_;
   std::vector<bool> simple_tensor_mask_;  // true for simple, false for complex.
@@ -105,6 +117,15 @@ class Reader {
 
   Status ReadTensors(std::vector<Tensor>* read_tensors);
 
+  // Returns the position of the next record, which can be passed to SkipTo()
+  // to resume reading the file from there.
+  int64 Tell() const { return input_stream_->Tell(); }
+
+  // Skips ahead to the record at `position`, a value returned by Tell() for
+  // the same file. Uncompressed and snappy files seek without reading the
+  // skipped records.
+  Status SkipTo(int64 position);
+
  private:
   Status ReadTensorsV0(std::vector<Tensor>* read_tensors);
 
@@ -19,8 +19,13 @@ limitations under the License.
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/kernels/data/serialization_utils.h"
+#include "tensorflow/core/kernels/data/stats_utils.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
@@ -32,6 +37,63 @@ constexpr int64 kOptimizationPeriodThresholdMs = 60 * EnvTime::kSecondsToMillis;
 // Default share of available RAM that can be used by model's internal buffers.
 constexpr double kRamBudgetShare = 0.5;
 
+constexpr char kTunedStateSize[] = "tuned_state_size";
+constexpr char kTunedState[] = "tuned_state";
+constexpr char kName[] = "name";
+constexpr char kProcessingTime[] = "processing_time";
+constexpr char kNumElements[] = "num_elements";
+constexpr char kNumParameters[] = "num_parameters";
+constexpr char kParameter[] = "parameter";
+constexpr char kValue[] = "value";
+
+// The tuned model states of the input pipelines of this process, keyed by
+// dataset fingerprint, so that iterators that are re-created (e.g. for every
+// epoch) start from the state of the previous iterator.
+class TunedStateCache {
+ public:
+  static TunedStateCache* Global() {
+    static TunedStateCache* cache = new TunedStateCache;
+    return cache;
+  }
+
+  bool Lookup(uint64 fingerprint, model::Model::TunedState* state) {
+    mutex_lock l(mu_);
+    auto it = states_.find(fingerprint);
+    if (it == states_.end()) return false;
+    *state = it->second;
+    return true;
+  }
+
+  void Insert(uint64 fingerprint, model::Model::TunedState state) {
+    // Bounds the memory used by processes that create many input pipelines.
+    constexpr size_t kMaxStates = 64;
+    mutex_lock l(mu_);
+    if (states_.size() >= kMaxStates && states_.count(fingerprint) == 0) {
+      states_.erase(states_.begin());
+    }
+    states_[fingerprint] = std::move(state);
+  }
+
+ private:
+  mutex mu_;
+  std::unordered_map<uint64, model::Model::TunedState> states_
+      TF_GUARDED_BY(mu_);
+};
+
+// Computes the fingerprint of the graph that defines `dataset`.
+Status DatasetFingerprint(OpKernelContext* ctx, const DatasetBase* dataset,
+                          uint64* fingerprint) {
+  SerializationContext::Params params;
+  std::vector<std::pair<string, Tensor>> input_list;
+  params.input_list = &input_list;
+  params.external_state_policy =
+      SerializationContext::ExternalStatePolicy::kIgnore;
+  GraphDef graph_def;
+  TF_RETURN_IF_ERROR(
+      AsGraphDef(ctx, dataset, SerializationContext(params), &graph_def));
+  return HashGraph(graph_def, fingerprint);
+}
+
 class ModelDatasetOp : public UnaryDatasetOpKernel {
  public:
   explicit ModelDatasetOp(OpKernelConstruction* ctx)
@@ -51,11 +113,25 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
                 errors::InvalidArgument("CPU budget must be positive but is ",
                                         cpu_budget_, "."));
     ram_budget_ = kRamBudgetShare * port::AvailableRam();
+    OP_REQUIRES_OK(ctx, ReadBoolFromEnvVar("TF_DATA_AUTOTUNE_WARM_START",
+                                           false, &warm_start_));
   }
 
   void MakeDataset(OpKernelContext* ctx, DatasetBase* input,
                    DatasetBase** output) override {
-    *output = new Dataset(ctx, input, algorithm_, cpu_budget_, ram_budget_);
+    bool warm_start = warm_start_;
+    uint64 fingerprint = 0;
+    if (warm_start) {
+      Status s = DatasetFingerprint(ctx, input, &fingerprint);
+      if (!s.ok()) {
+        VLOG(1) << "Not warm-starting autotuning of an input pipeline that "
+                   "cannot be fingerprinted: "
+                << s;
+        warm_start = false;
+      }
+    }
+    *output = new Dataset(ctx, input, algorithm_, cpu_budget_, ram_budget_,
+                          warm_start, fingerprint);
   }
 
  private:
@@ -63,12 +139,14 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
    public:
     Dataset(OpKernelContext* ctx, const DatasetBase* input,
             model::AutotuneAlgorithm algorithm, int64 cpu_budget,
-            int64 ram_budget)
+            int64 ram_budget, bool warm_start, uint64 fingerprint)
         : DatasetBase(DatasetContext(ctx)),
           input_(input),
           algorithm_(algorithm),
           cpu_budget_(cpu_budget),
-          ram_budget_(ram_budget) {
+          ram_budget_(ram_budget),
+          warm_start_(warm_start),
+          fingerprint_(fingerprint) {
       input_->Ref();
     }
 
@@ -117,6 +195,10 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
       }
 
       ~Iterator() override {
+        if (dataset()->warm_start_) {
+          TunedStateCache::Global()->Insert(dataset()->fingerprint_,
+                                            model_->GetTunedState());
+        }
         // Signal the optimize thread to terminate it. We will then join that
         // thread when we delete `this->optimize_thread_`.
         mutex_lock l(mu_);
@@ -125,6 +207,12 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
       }
 
       Status Initialize(IteratorContext* ctx) override {
+        model::Model::TunedState state;
+        if (dataset()->warm_start_ &&
+            TunedStateCache::Global()->Lookup(dataset()->fingerprint_,
+                                              &state)) {
+          model_->WarmStart(std::move(state));
+        }
         IteratorContext::Params params(ctx);
         params.model = model_;
         return dataset()->input_->MakeIterator(
@@ -155,17 +243,102 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
                           IteratorStateWriter* writer) override {
         mutex_lock l(mu_);
         TF_RETURN_IF_ERROR(SaveInput(ctx, writer, input_impl_));
+        if (dataset()->warm_start_) {
+          TF_RETURN_IF_ERROR(SaveTunedState(writer));
+        }
         return Status::OK();
       }
 
       Status RestoreInternal(IteratorContext* ctx,
                              IteratorStateReader* reader) override {
         mutex_lock l(mu_);
+        if (dataset()->warm_start_ &&
+            reader->Contains(full_name(kTunedStateSize))) {
+          TF_RETURN_IF_ERROR(RestoreTunedState(reader));
+        }
         TF_RETURN_IF_ERROR(RestoreInput(ctx, reader, input_impl_));
         return Status::OK();
       }
 
      private:
+      // Returns the checkpoint key of `name` for the node with index `index`.
+      string TunedStateKey(int64 index, const string& name) {
+        return full_name(strings::StrCat(kTunedState, "[", index, "].", name));
+      }
+
+      // Returns the checkpoint key of `name` for the parameter with index
+      // `parameter_index` of the node with index `index`.
+      string TunedParameterKey(int64 index, int64 parameter_index,
+                               const string& name) {
+        return TunedStateKey(index, strings::StrCat(kParameter, "[",
+                                                    parameter_index, "].",
+                                                    name));
+      }
+
+      Status SaveTunedState(IteratorStateWriter* writer) {
+        const model::Model::TunedState state = model_->GetTunedState();
+        const int64 size = state.nodes.size();
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kTunedStateSize), size));
+        int64 index = 0;
+        for (const auto& node : state.nodes) {
+          TF_RETURN_IF_ERROR(
+              writer->WriteScalar(TunedStateKey(index, kName), node.first));
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              TunedStateKey(index, kProcessingTime),
+              node.second.processing_time));
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              TunedStateKey(index, kNumElements), node.second.num_elements));
+          const int64 num_parameters = node.second.parameters.size();
+          TF_RETURN_IF_ERROR(writer->WriteScalar(
+              TunedStateKey(index, kNumParameters), num_parameters));
+          int64 parameter_index = 0;
+          for (const auto& parameter : node.second.parameters) {
+            TF_RETURN_IF_ERROR(writer->WriteScalar(
+                TunedParameterKey(index, parameter_index, kName),
+                parameter.first));
+            // Tuned parameter values are integral.
+            TF_RETURN_IF_ERROR(writer->WriteScalar(
+                TunedParameterKey(index, parameter_index, kValue),
+                static_cast<int64>(std::round(parameter.second))));
+            ++parameter_index;
+          }
+          ++index;
+        }
+        return Status::OK();
+      }
+
+      Status RestoreTunedState(IteratorStateReader* reader) {
+        model::Model::TunedState state;
+        int64 size;
+        TF_RETURN_IF_ERROR(
+            reader->ReadScalar(full_name(kTunedStateSize), &size));
+        for (int64 index = 0; index < size; ++index) {
+          tstring name;
+          TF_RETURN_IF_ERROR(
+              reader->ReadScalar(TunedStateKey(index, kName), &name));
+          model::Model::TunedState::NodeState& node = state.nodes[name];
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              TunedStateKey(index, kProcessingTime), &node.processing_time));
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              TunedStateKey(index, kNumElements), &node.num_elements));
+          int64 num_parameters;
+          TF_RETURN_IF_ERROR(reader->ReadScalar(
+              TunedStateKey(index, kNumParameters), &num_parameters));
+          for (int64 i = 0; i < num_parameters; ++i) {
+            tstring parameter_name;
+            int64 value;
+            TF_RETURN_IF_ERROR(reader->ReadScalar(
+                TunedParameterKey(index, i, kName), &parameter_name));
+            TF_RETURN_IF_ERROR(reader->ReadScalar(
+                TunedParameterKey(index, i, kValue), &value));
+            node.parameters[parameter_name] = value;
+          }
+        }
+        model_->WarmStart(std::move(state));
+        return Status::OK();
+      }
+
       Status EnsureOptimizeThreadStarted(IteratorContext* ctx)
           TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
         if (!optimize_thread_) {
@@ -180,6 +353,7 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
       void OptimizeThread(const std::shared_ptr<IteratorContext>& ctx) {
         int64 last_optimization_ms = 0;
         int64 optimization_period_ms = 10;
+        int64 num_reports = 0;
         int64 current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
         while (true) {
           {
@@ -195,8 +369,20 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
             }
             if (cancelled_) return;
           }
-          model_->Optimize(dataset()->algorithm_, dataset()->cpu_budget_,
-                           dataset()->ram_budget_);
+          const model::AutotuneAlgorithm algorithm = dataset()->algorithm_;
+          int64 ram_budget = dataset()->ram_budget_;
+          if (algorithm == model::AutotuneAlgorithm::MEMORY_BUDGET) {
+            // Track the memory available to the process, so that buffers
+            // shrink when other consumers of the host's memory grow.
+            ram_budget = std::min<int64>(
+                ram_budget, kRamBudgetShare * port::AvailableRam());
+          }
+          model_->Optimize(algorithm, dataset()->cpu_budget_, ram_budget);
+          ReportBottlenecks(ctx.get(), ++num_reports);
+          if (dataset()->warm_start_) {
+            TunedStateCache::Global()->Insert(dataset()->fingerprint_,
+                                              model_->GetTunedState());
+          }
           // Exponentially increase the period of running the optimization
           // until a threshold is reached.
           if (optimization_period_ms != kOptimizationPeriodThresholdMs) {
@@ -208,6 +394,52 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
         }
       }
 
+      // Exports the bottleneck report of the model to the stats aggregator and
+      // to the profiler, if either is collecting. Must be called from the
+      // optimize thread, since the report evaluates the tunable parameters.
+      void ReportBottlenecks(IteratorContext* ctx, int64 step) {
+        auto stats_aggregator = ctx->stats_aggregator();
+        if (!stats_aggregator &&
+            !profiler::TraceMe::Active(profiler::TraceMeLevel::kInfo)) {
+          return;
+        }
+        const model::Model::BottleneckReport report =
+            model_->GetBottleneckReport();
+        for (const auto& node : report.nodes) {
+          if (stats_aggregator) {
+            stats_aggregator->AddScalar(
+                stats_utils::ProcessingTimeFractionScalarName(node.name),
+                static_cast<float>(node.processing_time_fraction), step);
+            stats_aggregator->AddScalar(
+                stats_utils::OutputTimeScalarName(node.name),
+                static_cast<float>(node.output_time), step);
+            if (node.buffer_utilization >= 0) {
+              stats_aggregator->AddToHistogram(
+                  stats_utils::BufferUtilizationHistogramName(node.name),
+                  {node.buffer_utilization}, step);
+            }
+            if (!node.parameter_name.empty()) {
+              stats_aggregator->AddScalar(
+                  stats_utils::SpeedupIfIncrementedScalarName(node.name),
+                  static_cast<float>(node.speedup_if_incremented), step);
+            }
+          }
+          profiler::TraceMe trace_me(
+              [&] {
+                return strings::StrCat(
+                    "ModelBottleneckReport#node=", node.name,
+                    ",processing_time_fraction=", node.processing_time_fraction,
+                    ",output_time=", node.output_time,
+                    ",buffer_utilization=", node.buffer_utilization,
+                    ",parameter=", node.parameter_name,
+                    ",parameter_value=", node.parameter_value,
+                    ",speedup_if_incremented=", node.speedup_if_incremented,
+                    "#");
+              },
+              profiler::TraceMeLevel::kInfo);
+        }
+      }
+
       mutex mu_;
       condition_variable cond_var_;
       std::shared_ptr<model::Model> model_;
@@ -220,11 +452,16 @@ class ModelDatasetOp : public UnaryDatasetOpKernel {
     const model::AutotuneAlgorithm algorithm_;
     const int64 cpu_budget_;
     const int64 ram_budget_;
+    // Whether the model of the iterators is warm-started from the
+    // `TunedStateCache` entry for `fingerprint_` and from checkpoints.
+    const bool warm_start_;
+    const uint64 fingerprint_;
   };
 
   model::AutotuneAlgorithm algorithm_;
   int64 cpu_budget_;
   int64 ram_budget_;
+  bool warm_start_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ModelDataset").Device(DEVICE_CPU),
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/resource_op_kernel.h"
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/iterator_ops.h"
+#include "tensorflow/core/kernels/data/prefetch_autotuner.h"
 #include "tensorflow/core/kernels/data/unbounded_thread_pool.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/refcount.h"
@@ -148,7 +149,8 @@ class MultiDeviceIterator : public ResourceBase {
 
  private:
   // A private class that uses a background thread to keep a per device buffer
-  // full.
+  // full. If `max_buffer_size` is `model::kAutotune`, the size of the buffers
+  // starts at 1 and grows while consumers find their buffer empty.
   class MultiDeviceBuffer {
    public:
     MultiDeviceBuffer(size_t size, int64 max_buffer_size, int64 incarnation_id,
@@ -156,7 +158,7 @@ class MultiDeviceIterator : public ResourceBase {
                       MultiDeviceIterator* parent)
         : buffer_(size),
           size_(size),
-          max_buffer_size_(max_buffer_size),
+          auto_tuner_(max_buffer_size),
           incarnation_id_(incarnation_id),
           host_iterator_(std::move(host_iterator)),
           parent_(parent) {}
@@ -213,10 +215,12 @@ class MultiDeviceIterator : public ResourceBase {
 
         if (!buffer_[shard_num].data.empty()) {
           produced_output = true;
+          auto_tuner_.RecordConsumption(buffer_[shard_num].data.size());
           std::swap(elem, buffer_[shard_num].data.front());
           buffer_[shard_num].data.pop_front();
           // Wake up background thread if it is blocked on this element.
-          if (buffer_[shard_num].data.size() == max_buffer_size_ - 1) {
+          if (buffer_[shard_num].data.size() ==
+              auto_tuner_.buffer_limit() - 1) {
             buffer_[shard_num].cond_var.notify_all();
           }
         } else {
@@ -224,6 +228,7 @@ class MultiDeviceIterator : public ResourceBase {
             produced_output = true;
             elem.end_of_sequence = true;
           } else {
+            RecordEmpty();
             buffer_[shard_num].callbacks.push_back(std::move(callback));
             callback = nullptr;
           }
@@ -236,6 +241,23 @@ class MultiDeviceIterator : public ResourceBase {
     }
 
    private:
+    // Records that a consumer found its buffer empty, which lets the
+    // autotuner grow the buffers.
+    void RecordEmpty() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      const int64 buffer_limit = auto_tuner_.buffer_limit();
+      if (waiting_for_space_) {
+        // Another buffer is full while this one is empty, e.g. because the
+        // consumers are uneven: count it as filled so the limit grows.
+        auto_tuner_.RecordConsumption(buffer_limit);
+      }
+      auto_tuner_.RecordEmpty();
+      if (auto_tuner_.buffer_limit() != buffer_limit) {
+        for (int i = 0; i < size_; ++i) {
+          buffer_[i].cond_var.notify_all();
+        }
+      }
+    }
+
     void EnsureBackgroundThreadStarted(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (!background_thread_) {
@@ -296,10 +318,12 @@ class MultiDeviceIterator : public ResourceBase {
 
         {
           mutex_lock l(mu_);
-          while (!cancelled_ &&
-                 buffer_[shard_to_fetch].data.size() >= max_buffer_size_) {
+          while (!cancelled_ && buffer_[shard_to_fetch].data.size() >=
+                                    auto_tuner_.buffer_limit()) {
+            waiting_for_space_ = true;
             buffer_[shard_to_fetch].cond_var.wait(l);
           }
+          waiting_for_space_ = false;
 
           if (cancelled_) {
             background_thread_finished_ = true;
@@ -359,12 +383,15 @@ class MultiDeviceIterator : public ResourceBase {
     bool background_thread_started_ TF_GUARDED_BY(mu_) = false;
     bool end_of_iterator_ TF_GUARDED_BY(mu_) = false;
     bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    // Whether the background thread waits for space in a full buffer.
+    bool waiting_for_space_ TF_GUARDED_BY(mu_) = false;
     condition_variable shutdown_cond_var_ TF_GUARDED_BY(mu_);
 
     std::vector<HostBuffer> buffer_;
 
     const size_t size_;
-    const int64 max_buffer_size_;
+    // Limits the size of each buffer.
+    PrefetchAutotuner auto_tuner_ TF_GUARDED_BY(mu_);
     const int64 incarnation_id_;
     const std::unique_ptr<IteratorBase> host_iterator_;
     MultiDeviceIterator* const parent_;  // Not owned.
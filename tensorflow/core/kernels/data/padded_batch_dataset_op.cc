@@ -287,8 +287,15 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
                                   output_dtypes()[component_index],
                                   batch_component_shape);
         Tensor& batch_component = out_tensors->back();
-        TF_RETURN_IF_ERROR(batch_util::SetElementZero(
-            &batch_component, dataset()->padding_values_[component_index]));
+        const Tensor& padding = dataset()->padding_values_[component_index];
+        // Components of simple types are padded while each element is copied,
+        // so that every byte of the batch is only written once.
+        const bool pad_while_copying =
+            DataTypeCanUseMemcpy(batch_component.dtype());
+        if (!pad_while_copying) {
+          TF_RETURN_IF_ERROR(
+              batch_util::SetElementZero(&batch_component, padding));
+        }
 
         // Build the output tuple component by copying one slice
         // from each input element in the batch.
@@ -297,7 +304,13 @@ class PaddedBatchDatasetOp::Dataset : public DatasetBase {
           component_shape.AddDim(batch_component_shape.dim_size(i));
         }
         auto copy_element_fn = [component_index, &batch_elements,
-                                &batch_component, &component_shape](int index) {
+                                &batch_component, &component_shape, &padding,
+                                pad_while_copying](int index) {
+          if (pad_while_copying) {
+            return batch_util::CopyElementToPaddedSlice(
+                batch_elements[index][component_index], padding,
+                &batch_component, index);
+          }
           // Take the fast path if possible.
           if (batch_elements[index][component_index].shape() ==
               component_shape) {
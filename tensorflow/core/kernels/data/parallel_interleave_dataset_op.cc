@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/stringprintf.h"
 
 namespace tensorflow {
@@ -614,6 +615,58 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         }
         AdvanceToNextInCycle();
       }
+      // None of the elements in the cycle has a result available. Rather than
+      // waiting for a slow element, e.g. one reading a file from remote
+      // storage, swap it with a future element that has results ready.
+      return PromoteReadyFutureElement() && ConsumeHelper(result);
+    }
+
+    // Swaps a current element that is being processed but has no results
+    // available with the first future element that has results available.
+    // Returns whether an element was promoted.
+    //
+    // The swapped out element keeps being processed by its worker until its
+    // results buffer is full, and moves back into the cycle in turn.
+    bool PromoteReadyFutureElement() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      auto future_it = future_elements_.begin();
+      while (future_it != future_elements_.end() &&
+             (*future_it)->results.empty()) {
+        ++future_it;
+      }
+      if (future_it == future_elements_.end()) {
+        return false;
+      }
+      for (int64 i = 0; i < (last_valid_current_element_ + 1); ++i) {
+        int64 index = (cycle_index_ + i) % (last_valid_current_element_ + 1);
+        std::shared_ptr<Element>& straggler = current_elements_[index];
+        if (!straggler || !straggler->active || !straggler->initialized ||
+            !straggler->iterator || !straggler->results.empty()) {
+          continue;
+        }
+        VLOG(3) << "Swapping straggling element " << straggler->id
+                << " with future element " << (*future_it)->id;
+        DisableAutotune(ctx_.get(), straggler->iterator.get());
+        straggler->cycle_index = -1;
+        std::swap(straggler, *future_it);
+        std::shared_ptr<Element>& promoted = current_elements_[index];
+        promoted->cycle_index = index;
+        if (promoted->iterator) {
+          EnableAutotune(ctx_.get(), promoted->iterator.get());
+        }
+        if (!promoted->active) {
+          elements_to_process_.push_back(index);
+          current_workers_cond_var_.notify_one();
+        }
+        cycle_index_ = index;
+        block_index_ = 0;
+        num_stragglers_++;
+        if (ctx_->stats_aggregator()) {
+          ctx_->stats_aggregator()->AddScalar(
+              stats_utils::StragglerElementsScalarName(dataset()->node_name()),
+              static_cast<float>(num_stragglers_), num_elements());
+        }
+        return true;
+      }
       return false;
     }
 
@@ -908,8 +961,15 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       while (true) {
         auto result = std::make_shared<Result>();
         bool end_of_input = false;
+        const uint64 start_nanos = EnvTime::NowNanos();
         result->status = iterator->GetNext(ctx_.get(), &result->return_values,
                                            &end_of_input);
+        if (ctx_->stats_aggregator()) {
+          ctx_->stats_aggregator()->AddToHistogram(
+              stats_utils::ElementLatencyHistogramName(dataset()->node_name()),
+              {static_cast<double>(EnvTime::NowNanos() - start_nanos)},
+              num_elements());
+        }
         if (end_of_input) {
           mutex_lock l(*mu_);
           element->iterator.reset();
@@ -1462,6 +1522,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
 
     int64 element_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
+    // The number of times a straggling current element was swapped with a
+    // future element. Only used when `deterministic` is false.
+    int64 num_stragglers_ TF_GUARDED_BY(mu_) = 0;
+
     // Iterator context used in worker threads.
     std::unique_ptr<IteratorContext> ctx_;
 
@@ -25,12 +25,15 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/dataset_utils.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
 #include "tensorflow/core/kernels/data/random_seed_ops.h"
+#include "tensorflow/core/kernels/data/spilling_shuffle_buffer.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/random/random_distributions.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/stringprintf.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -55,6 +58,8 @@ namespace data {
 
 const int64 kLogIntervalMicros = 10 * 1000000;  // 10 seconds.
 const int64 kMaxEpochsInBuffer = 3;
+// A spilling shuffle buffer keeps up to this share of its elements in memory.
+const int64 kSpillMemoryFraction = 10;
 
 constexpr char kNumRandomSamples[] = "num_random_samples";
 constexpr char kDataProduced[] = "data_produced";
@@ -66,6 +71,7 @@ constexpr char kSlicesStart[] = "slices_start";
 constexpr char kSlicesEnd[] = "slices_end";
 constexpr char kBuffer[] = "buffer";
 constexpr char kSize[] = "size";
+constexpr char kSpilled[] = "spilled";
 constexpr char kSeedGenerator[] = "SeedGenerator";
 constexpr char kTFData[] = "tf_data";
 constexpr char kDSNumRandomSamples[] = "ds_num_random_samples";
@@ -95,6 +101,20 @@ class Seeds {
   int64 seed_;
   int64 seed2_;
 };
+
+// Returns the scratch directories for spilling shuffle buffers to local disk,
+// from the comma-separated TF_DATA_SHUFFLE_SPILL_DIRS environment variable.
+// Shuffle buffers are kept in memory if it is not set.
+std::vector<string> SpillDirectories() {
+  string directories;
+  Status s =
+      ReadStringFromEnvVar("TF_DATA_SHUFFLE_SPILL_DIRS", "", &directories);
+  if (!s.ok()) {
+    LOG(WARNING) << s;
+    return {};
+  }
+  return str_util::Split(directories, ",", str_util::SkipEmpty());
+}
 }  // namespace
 
 ShuffleDatasetOpBase::ShuffleDatasetOpBase(OpKernelConstruction* ctx)
@@ -165,8 +185,15 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           num_elements_(0),
           parent_generator_(seed, seed2),
           generator_(&parent_generator_) {
-      buffer_ = absl::make_unique<std::vector<Tensor>[]>(
-          params.dataset->buffer_size_);
+      std::vector<string> spill_directories = SpillDirectories();
+      if (spill_directories.empty()) {
+        buffer_ = absl::make_unique<std::vector<Tensor>[]>(
+            params.dataset->buffer_size_);
+      } else {
+        spill_buffer_ = absl::make_unique<SpillingShuffleBuffer>(
+            Env::Default(), std::move(spill_directories),
+            params.dataset->buffer_size_ / kSpillMemoryFraction);
+      }
       slices_.push_back(absl::make_unique<Slice>(0, 0));
     }
 
@@ -215,9 +242,14 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             VLOG(1) << "Starting to fill up shuffle buffer of size: "
                     << this->dataset()->buffer_size_;
           }
-          this->RecordBufferEnqueue(ctx, input_element);
-          buffer_[slices_.back()->end % this->dataset()->buffer_size_] =
-              std::move(input_element);
+          if (spill_buffer_) {
+            TF_RETURN_IF_ERROR(spill_buffer_->Add(
+                epoch_, std::move(input_element), Random()));
+          } else {
+            this->RecordBufferEnqueue(ctx, input_element);
+            buffer_[slices_.back()->end % this->dataset()->buffer_size_] =
+                std::move(input_element);
+          }
           num_elements_++;
           slices_.back()->end++;
         } else {
@@ -246,15 +278,20 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         DCHECK(!slices_.empty());
         // Choose an element to produce uniformly at random from the first
         // slice, and then remove the element from the slice.
-        int64 offset =
-            Random() % (slices_.front()->end - slices_.front()->start);
-        int64 index =
-            (slices_.front()->start + offset) % this->dataset()->buffer_size_;
-        *out_tensors = std::move(buffer_[index]);
-        this->RecordBufferDequeue(ctx, *out_tensors);
-        std::swap(
-            buffer_[index],
-            buffer_[slices_.front()->start % this->dataset()->buffer_size_]);
+        if (spill_buffer_) {
+          // The spilling buffer keeps track of the epoch of its elements.
+          TF_RETURN_IF_ERROR(spill_buffer_->Remove(Random(), out_tensors));
+        } else {
+          int64 offset =
+              Random() % (slices_.front()->end - slices_.front()->start);
+          int64 index = (slices_.front()->start + offset) %
+                        this->dataset()->buffer_size_;
+          *out_tensors = std::move(buffer_[index]);
+          this->RecordBufferDequeue(ctx, *out_tensors);
+          std::swap(
+              buffer_[index],
+              buffer_[slices_.front()->start % this->dataset()->buffer_size_]);
+        }
         slices_.front()->start++;
         num_elements_--;
       } else {
@@ -311,6 +348,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
         TF_RETURN_IF_ERROR(writer->WriteScalar(
             this->full_name(absl::StrJoin(std::make_tuple(kSlicesEnd, i), "_")),
             slices_[i]->end));
+        if (spill_buffer_) continue;
         for (size_t j = slices_[i]->start; j < slices_[i]->end; ++j) {
           size_t index = j % this->dataset()->buffer_size_;
           TF_RETURN_IF_ERROR(writer->WriteScalar(
@@ -325,6 +363,12 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
           }
         }
       }
+      if (spill_buffer_) {
+        TF_RETURN_IF_ERROR(writer->WriteScalar(this->full_name(kSpilled), ""));
+        TF_RETURN_IF_ERROR(spill_buffer_->Save(
+            [this](const string& key) { return this->full_name(key); },
+            writer));
+      }
       if (data_produced_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(this->full_name(kDataProduced), ""));
@@ -363,8 +407,23 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             reader->ReadScalar(this->full_name(kSlicesSize), &temp));
         slices_size = static_cast<size_t>(temp);
       }
-      buffer_ = absl::make_unique<std::vector<Tensor>[]>(
-          this->dataset()->buffer_size_);
+      // The buffered elements are restored in the mode they were saved in.
+      const bool spilled = reader->Contains(this->full_name(kSpilled));
+      if (spilled) {
+        if (!spill_buffer_) {
+          return errors::FailedPrecondition(
+              "The shuffle buffer was saved to a checkpoint while spilling to "
+              "disk. Set TF_DATA_SHUFFLE_SPILL_DIRS to restore it.");
+        }
+        TF_RETURN_IF_ERROR(spill_buffer_->Restore(
+            [this](const string& key) { return this->full_name(key); },
+            reader));
+        buffer_.reset();
+      } else {
+        spill_buffer_.reset();
+        buffer_ = absl::make_unique<std::vector<Tensor>[]>(
+            this->dataset()->buffer_size_);
+      }
       slices_.clear();
       for (size_t i = 0; i < slices_size; ++i) {
         int64 start;
@@ -377,6 +436,7 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
             this->full_name(absl::StrJoin(std::make_tuple(kSlicesEnd, i), "_")),
             &end));
         slices_.push_back(absl::make_unique<Slice>(start, end));
+        if (spilled) continue;
         for (size_t j = start; j < end; ++j) {
           size_t index = j % this->dataset()->buffer_size_;
           int64 list_size;
@@ -427,6 +487,9 @@ class ShuffleDatasetOpBase::ShuffleDatasetBase : public DatasetBase {
     }
 
     std::unique_ptr<std::vector<Tensor>[]> buffer_ TF_GUARDED_BY(mu_);
+    // Holds the buffered elements instead of `buffer_` if the buffer spills
+    // to local disk.
+    std::unique_ptr<SpillingShuffleBuffer> spill_buffer_ TF_GUARDED_BY(mu_);
     std::unique_ptr<IteratorBase> input_impl_ TF_GUARDED_BY(mu_);
     int64 epoch_ TF_GUARDED_BY(mu_);
     int64 num_elements_ TF_GUARDED_BY(mu_);
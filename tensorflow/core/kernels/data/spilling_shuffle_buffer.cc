@@ -0,0 +1,303 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/spilling_shuffle_buffer.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/random/random.h"
+#include "tensorflow/core/platform/coding.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/stringprintf.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kMemoryEpoch[] = "spill_memory_epoch";
+constexpr char kMemoryRun[] = "spill_memory_run";
+constexpr char kNumRuns[] = "spill_num_runs";
+constexpr char kRun[] = "spill_run";
+constexpr char kEpoch[] = "epoch";
+constexpr char kSize[] = "size";
+
+// Scratch files are written in chunks of this many bytes.
+constexpr size_t kWriteBufferBytes = 1 << 20;
+
+// Appends the encoding of `element` to `dst`: the number of components, and
+// the length and serialized `TensorProto` of each component.
+void EncodeElement(const std::vector<Tensor>& element, string* dst) {
+  core::PutVarint64(dst, element.size());
+  for (const Tensor& t : element) {
+    TensorProto proto;
+    t.AsProtoTensorContent(&proto);
+    core::PutVarint64(dst, proto.ByteSizeLong());
+    proto.AppendToString(dst);
+  }
+}
+
+Status SaveElement(const string& key, const std::vector<Tensor>& element,
+                   IteratorStateWriter* writer) {
+  TF_RETURN_IF_ERROR(writer->WriteScalar(strings::StrCat(key, "_", kSize),
+                                         static_cast<int64>(element.size())));
+  for (size_t i = 0; i < element.size(); ++i) {
+    TF_RETURN_IF_ERROR(
+        writer->WriteTensor(strings::StrCat(key, "_", i), element[i]));
+  }
+  return Status::OK();
+}
+
+Status RestoreElement(const string& key, IteratorStateReader* reader,
+                      std::vector<Tensor>* element) {
+  int64 size;
+  TF_RETURN_IF_ERROR(
+      reader->ReadScalar(strings::StrCat(key, "_", kSize), &size));
+  element->resize(size);
+  for (int64 i = 0; i < size; ++i) {
+    TF_RETURN_IF_ERROR(
+        reader->ReadTensor(strings::StrCat(key, "_", i), &(*element)[i]));
+  }
+  return Status::OK();
+}
+
+}  // namespace
+
+SpillingShuffleBuffer::SpillingShuffleBuffer(Env* env,
+                                             std::vector<string> directories,
+                                             int64 run_size)
+    : env_(env),
+      directories_(std::move(directories)),
+      run_size_(std::max<int64>(run_size, 1)),
+      file_prefix_(
+          strings::Printf("shuffle_%016llx",
+                          static_cast<unsigned long long>(random::New64()))) {
+  DCHECK(!directories_.empty());
+}
+
+SpillingShuffleBuffer::~SpillingShuffleBuffer() { DeleteRuns(); }
+
+Status SpillingShuffleBuffer::Add(int64 epoch, std::vector<Tensor> element,
+                                  uint64 random) {
+  if (!memory_run_.empty() && epoch != memory_epoch_) {
+    TF_RETURN_IF_ERROR(Spill());
+  }
+  memory_epoch_ = epoch;
+  memory_run_.push_back(std::move(element));
+  std::swap(memory_run_.back(), memory_run_[random % memory_run_.size()]);
+  ++size_;
+  if (static_cast<int64>(memory_run_.size()) >= run_size_) {
+    return Spill();
+  }
+  return Status::OK();
+}
+
+Status SpillingShuffleBuffer::Remove(uint64 random,
+                                     std::vector<Tensor>* element) {
+  DCHECK_GT(size_, 0);
+  const int64 epoch = runs_.empty() ? memory_epoch_ : runs_.front().epoch;
+  const bool from_memory = memory_epoch_ == epoch;
+  uint64 num_candidates = from_memory ? memory_run_.size() : 0;
+  for (const Run& run : runs_) {
+    if (run.epoch != epoch) break;
+    num_candidates += run.num_elements;
+  }
+  uint64 index = random % num_candidates;
+  if (from_memory) {
+    if (index < memory_run_.size()) {
+      std::swap(memory_run_[index], memory_run_.back());
+      *element = std::move(memory_run_.back());
+      memory_run_.pop_back();
+      --size_;
+      return Status::OK();
+    }
+    index -= memory_run_.size();
+  }
+  for (auto it = runs_.begin(); it != runs_.end(); ++it) {
+    if (index >= static_cast<uint64>(it->num_elements)) {
+      index -= it->num_elements;
+      continue;
+    }
+    TF_RETURN_IF_ERROR(ReadElement(*it, &it->offset, element));
+    --size_;
+    if (--it->num_elements == 0) {
+      it->region.reset();
+      Status s = env_->DeleteFile(it->filename);
+      if (!s.ok()) {
+        LOG(WARNING) << "Failed to delete shuffle scratch file "
+                     << it->filename << ": " << s;
+      }
+      runs_.erase(it);
+    }
+    return Status::OK();
+  }
+  return errors::Internal("Shuffle buffer of size ", size_,
+                          " has no element of epoch ", epoch);
+}
+
+Status SpillingShuffleBuffer::Save(
+    const std::function<string(const string&)>& key,
+    IteratorStateWriter* writer) {
+  TF_RETURN_IF_ERROR(writer->WriteScalar(key(kMemoryEpoch), memory_epoch_));
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(key(strings::StrCat(kMemoryRun, "_", kSize)),
+                          static_cast<int64>(memory_run_.size())));
+  for (size_t i = 0; i < memory_run_.size(); ++i) {
+    TF_RETURN_IF_ERROR(SaveElement(key(strings::StrCat(kMemoryRun, "_", i)),
+                                   memory_run_[i], writer));
+  }
+  TF_RETURN_IF_ERROR(
+      writer->WriteScalar(key(kNumRuns), static_cast<int64>(runs_.size())));
+  for (size_t r = 0; r < runs_.size(); ++r) {
+    const Run& run = runs_[r];
+    const string prefix = strings::StrCat(kRun, "_", r);
+    TF_RETURN_IF_ERROR(writer->WriteScalar(
+        key(strings::StrCat(prefix, "_", kEpoch)), run.epoch));
+    TF_RETURN_IF_ERROR(writer->WriteScalar(
+        key(strings::StrCat(prefix, "_", kSize)), run.num_elements));
+    uint64 offset = run.offset;
+    std::vector<Tensor> element;
+    for (int64 i = 0; i < run.num_elements; ++i) {
+      TF_RETURN_IF_ERROR(ReadElement(run, &offset, &element));
+      TF_RETURN_IF_ERROR(SaveElement(key(strings::StrCat(prefix, "_", i)),
+                                     element, writer));
+    }
+  }
+  return Status::OK();
+}
+
+Status SpillingShuffleBuffer::Restore(
+    const std::function<string(const string&)>& key,
+    IteratorStateReader* reader) {
+  DeleteRuns();
+  memory_run_.clear();
+  size_ = 0;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(key(kMemoryEpoch), &memory_epoch_));
+  int64 memory_run_size;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(
+      key(strings::StrCat(kMemoryRun, "_", kSize)), &memory_run_size));
+  memory_run_.resize(memory_run_size);
+  for (int64 i = 0; i < memory_run_size; ++i) {
+    TF_RETURN_IF_ERROR(RestoreElement(
+        key(strings::StrCat(kMemoryRun, "_", i)), reader, &memory_run_[i]));
+  }
+  size_ += memory_run_size;
+  int64 num_runs;
+  TF_RETURN_IF_ERROR(reader->ReadScalar(key(kNumRuns), &num_runs));
+  for (int64 r = 0; r < num_runs; ++r) {
+    const string prefix = strings::StrCat(kRun, "_", r);
+    int64 epoch;
+    TF_RETURN_IF_ERROR(
+        reader->ReadScalar(key(strings::StrCat(prefix, "_", kEpoch)), &epoch));
+    int64 num_elements;
+    TF_RETURN_IF_ERROR(reader->ReadScalar(
+        key(strings::StrCat(prefix, "_", kSize)), &num_elements));
+    std::vector<std::vector<Tensor>> elements(num_elements);
+    for (int64 i = 0; i < num_elements; ++i) {
+      TF_RETURN_IF_ERROR(RestoreElement(key(strings::StrCat(prefix, "_", i)),
+                                        reader, &elements[i]));
+    }
+    TF_RETURN_IF_ERROR(WriteRun(epoch, elements));
+    size_ += num_elements;
+  }
+  return Status::OK();
+}
+
+Status SpillingShuffleBuffer::Spill() {
+  TF_RETURN_IF_ERROR(WriteRun(memory_epoch_, memory_run_));
+  memory_run_.clear();
+  return Status::OK();
+}
+
+Status SpillingShuffleBuffer::WriteRun(
+    int64 epoch, const std::vector<std::vector<Tensor>>& elements) {
+  const string& directory = directories_[num_files_ % directories_.size()];
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory));
+  Run run;
+  run.epoch = epoch;
+  run.filename =
+      io::JoinPath(directory, strings::StrCat(file_prefix_, "_", num_files_));
+  ++num_files_;
+
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(run.filename, &file));
+  string buffer;
+  for (const std::vector<Tensor>& element : elements) {
+    EncodeElement(element, &buffer);
+    if (buffer.size() >= kWriteBufferBytes) {
+      TF_RETURN_IF_ERROR(file->Append(buffer));
+      buffer.clear();
+    }
+  }
+  TF_RETURN_IF_ERROR(file->Append(buffer));
+  TF_RETURN_IF_ERROR(file->Close());
+  Status s = env_->NewReadOnlyMemoryRegionFromFile(run.filename, &run.region);
+  if (!s.ok()) {
+    env_->DeleteFile(run.filename).IgnoreError();
+    return s;
+  }
+  run.num_elements = elements.size();
+  runs_.push_back(std::move(run));
+  return Status::OK();
+}
+
+Status SpillingShuffleBuffer::ReadElement(const Run& run, uint64* offset,
+                                          std::vector<Tensor>* element) const {
+  StringPiece input(static_cast<const char*>(run.region->data()) + *offset,
+                    run.region->length() - *offset);
+  const size_t input_size = input.size();
+  uint64 num_components;
+  if (!core::GetVarint64(&input, &num_components)) {
+    return errors::DataLoss("Corrupted shuffle scratch file ", run.filename);
+  }
+  element->clear();
+  element->reserve(num_components);
+  for (uint64 i = 0; i < num_components; ++i) {
+    uint64 length;
+    TensorProto proto;
+    if (!core::GetVarint64(&input, &length) || length > input.size() ||
+        !proto.ParseFromArray(input.data(), length)) {
+      return errors::DataLoss("Corrupted shuffle scratch file ", run.filename);
+    }
+    input.remove_prefix(length);
+    Tensor t;
+    if (!t.FromProto(cpu_allocator(), proto)) {
+      return errors::DataLoss("Invalid tensor in shuffle scratch file ",
+                              run.filename);
+    }
+    element->push_back(std::move(t));
+  }
+  *offset += input_size - input.size();
+  return Status::OK();
+}
+
+void SpillingShuffleBuffer::DeleteRuns() {
+  for (Run& run : runs_) {
+    run.region.reset();
+    Status s = env_->DeleteFile(run.filename);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to delete shuffle scratch file " << run.filename
+                   << ": " << s;
+    }
+  }
+  runs_.clear();
+}
+
+}  // namespace data
+}  // namespace tensorflow
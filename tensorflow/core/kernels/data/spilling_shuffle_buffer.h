@@ -0,0 +1,126 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_KERNELS_DATA_SPILLING_SHUFFLE_BUFFER_H_
+#define TENSORFLOW_CORE_KERNELS_DATA_SPILLING_SHUFFLE_BUFFER_H_
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace data {
+
+// A shuffle buffer that keeps most of its elements in local scratch files.
+//
+// Elements are added to an in-memory run of up to `run_size` elements, each at
+// a random position. Once the run is full, or an element of a later epoch is
+// added, the run is written to a new scratch file and read back through a
+// memory mapping. The scratch files are spread over `directories` in turn, so
+// that several local disks can serve the reads.
+//
+// Remove() chooses uniformly at random among the buffered elements of the
+// earliest epoch. An element of the in-memory run is removed directly, while a
+// spilled run yields the next element of its file. As every run is written in
+// random order, this samples the same distribution as a buffer that keeps all
+// elements in memory, but only the in-memory run and the file pages that are
+// being read take up RAM.
+//
+// SpillingShuffleBuffer is NOT thread safe.
+class SpillingShuffleBuffer {
+ public:
+  SpillingShuffleBuffer(Env* env, std::vector<string> directories,
+                        int64 run_size);
+  ~SpillingShuffleBuffer();
+
+  // Returns the number of buffered elements.
+  int64 size() const { return size_; }
+
+  // Returns the number of spilled runs, for testing.
+  int64 num_runs() const { return runs_.size(); }
+
+  // Adds `element`, which belongs to `epoch`. Epochs must not decrease from
+  // one call to the next. `random` is a uniformly distributed random number.
+  Status Add(int64 epoch, std::vector<Tensor> element, uint64 random);
+
+  // Removes an element of the earliest buffered epoch, chosen with the
+  // uniformly distributed random number `random`.
+  //
+  // REQUIRES: size() > 0
+  Status Remove(uint64 random, std::vector<Tensor>* element);
+
+  // Saves the buffered elements, under the keys returned by `key`.
+  Status Save(const std::function<string(const string&)>& key,
+              IteratorStateWriter* writer);
+
+  // Replaces the buffered elements with those saved by Save().
+  Status Restore(const std::function<string(const string&)>& key,
+                 IteratorStateReader* reader);
+
+ private:
+  // A run of elements in a scratch file.
+  struct Run {
+    int64 epoch;
+    string filename;
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    // The offset of the next element in `region`.
+    uint64 offset = 0;
+    int64 num_elements = 0;
+  };
+
+  // Writes the in-memory run to a scratch file.
+  Status Spill();
+
+  // Writes `elements` to a new scratch file and appends it to `runs_`.
+  Status WriteRun(int64 epoch,
+                  const std::vector<std::vector<Tensor>>& elements);
+
+  // Decodes the element of `run` at `*offset`, and advances `*offset` past it.
+  Status ReadElement(const Run& run, uint64* offset,
+                     std::vector<Tensor>* element) const;
+
+  // Deletes the scratch files of all runs.
+  void DeleteRuns();
+
+  Env* const env_;
+  const std::vector<string> directories_;
+  const int64 run_size_;
+  // The prefix of the names of this buffer's scratch files.
+  const string file_prefix_;
+  int64 num_files_ = 0;
+
+  int64 size_ = 0;
+  // The in-memory run holds elements of `memory_epoch_`, which is never earlier
+  // than the epoch of any spilled run.
+  int64 memory_epoch_ = 0;
+  std::vector<std::vector<Tensor>> memory_run_;
+  // Spilled runs, in the order in which they were written.
+  std::deque<Run> runs_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SpillingShuffleBuffer);
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_DATA_SPILLING_SHUFFLE_BUFFER_H_
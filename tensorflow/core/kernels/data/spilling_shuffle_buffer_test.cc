@@ -0,0 +1,183 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/kernels/data/spilling_shuffle_buffer.h"
+
+#include <algorithm>
+#include <random>
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/data/dataset_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+string ScratchDirectory(const string& name) {
+  return io::JoinPath(testing::TmpDir(), strings::StrCat("spill_", name));
+}
+
+int64 NumFiles(const string& directory) {
+  std::vector<string> children;
+  TF_CHECK_OK(Env::Default()->GetChildren(directory, &children));
+  return children.size();
+}
+
+std::vector<Tensor> MakeElement(int64 value) {
+  return {test::AsScalar<int64>(value)};
+}
+
+// Adds the elements [begin, end) of `epoch` to `buffer`.
+void AddRange(int64 begin, int64 end, int64 epoch, std::mt19937_64* rng,
+              SpillingShuffleBuffer* buffer) {
+  for (int64 i = begin; i < end; ++i) {
+    TF_ASSERT_OK(buffer->Add(epoch, MakeElement(i), (*rng)()));
+  }
+}
+
+// Removes `n` elements from `buffer` and returns their values.
+std::vector<int64> RemoveN(int64 n, std::mt19937_64* rng,
+                           SpillingShuffleBuffer* buffer) {
+  std::vector<int64> values;
+  for (int64 i = 0; i < n; ++i) {
+    std::vector<Tensor> element;
+    TF_CHECK_OK(buffer->Remove((*rng)(), &element));
+    CHECK_EQ(element.size(), 1);
+    values.push_back(element[0].scalar<int64>()());
+  }
+  return values;
+}
+
+std::vector<int64> Iota(int64 begin, int64 end) {
+  std::vector<int64> values;
+  for (int64 i = begin; i < end; ++i) values.push_back(i);
+  return values;
+}
+
+TEST(SpillingShuffleBufferTest, ProducesEveryElementOnce) {
+  const string directory = ScratchDirectory("every_element");
+  std::mt19937_64 rng(1);
+  {
+    SpillingShuffleBuffer buffer(Env::Default(), {directory}, 4);
+    AddRange(0, 22, 0, &rng, &buffer);
+    EXPECT_EQ(22, buffer.size());
+    EXPECT_EQ(5, buffer.num_runs());
+    EXPECT_EQ(5, NumFiles(directory));
+
+    std::vector<int64> values = RemoveN(22, &rng, &buffer);
+    EXPECT_EQ(0, buffer.size());
+    EXPECT_EQ(0, buffer.num_runs());
+    EXPECT_EQ(0, NumFiles(directory));
+    EXPECT_NE(Iota(0, 22), values);
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ(Iota(0, 22), values);
+  }
+}
+
+TEST(SpillingShuffleBufferTest, DeletesScratchFiles) {
+  const string directory = ScratchDirectory("delete");
+  std::mt19937_64 rng(2);
+  {
+    SpillingShuffleBuffer buffer(Env::Default(), {directory}, 2);
+    AddRange(0, 10, 0, &rng, &buffer);
+    EXPECT_EQ(5, NumFiles(directory));
+  }
+  EXPECT_EQ(0, NumFiles(directory));
+}
+
+TEST(SpillingShuffleBufferTest, SpreadsRunsOverDirectories) {
+  const string directory_a = ScratchDirectory("spread_a");
+  const string directory_b = ScratchDirectory("spread_b");
+  std::mt19937_64 rng(3);
+  SpillingShuffleBuffer buffer(Env::Default(), {directory_a, directory_b}, 3);
+  AddRange(0, 12, 0, &rng, &buffer);
+  EXPECT_EQ(2, NumFiles(directory_a));
+  EXPECT_EQ(2, NumFiles(directory_b));
+}
+
+TEST(SpillingShuffleBufferTest, ProducesEarliestEpochFirst) {
+  const string directory = ScratchDirectory("epochs");
+  std::mt19937_64 rng(4);
+  SpillingShuffleBuffer buffer(Env::Default(), {directory}, 4);
+  AddRange(0, 6, 0, &rng, &buffer);
+  AddRange(6, 13, 1, &rng, &buffer);
+  AddRange(13, 15, 2, &rng, &buffer);
+  // The partial runs of epochs 0 and 1 are spilled when the next epoch starts.
+  EXPECT_EQ(4, buffer.num_runs());
+
+  std::vector<int64> values = RemoveN(6, &rng, &buffer);
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(Iota(0, 6), values);
+  values = RemoveN(7, &rng, &buffer);
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(Iota(6, 13), values);
+  values = RemoveN(2, &rng, &buffer);
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(Iota(13, 15), values);
+}
+
+TEST(SpillingShuffleBufferTest, RoundTripsComponents) {
+  const string directory = ScratchDirectory("components");
+  SpillingShuffleBuffer buffer(Env::Default(), {directory}, 1);
+  std::vector<Tensor> element = {
+      test::AsTensor<tstring>({"a", "", "spilled"}, {3}),
+      test::AsTensor<float>({1.0f, 2.0f, 3.0f, 4.0f}, {2, 2}),
+      Tensor(DT_INT32, TensorShape({0}))};
+  TF_ASSERT_OK(buffer.Add(0, element, 0));
+  EXPECT_EQ(1, buffer.num_runs());
+
+  std::vector<Tensor> restored;
+  TF_ASSERT_OK(buffer.Remove(0, &restored));
+  ASSERT_EQ(element.size(), restored.size());
+  test::ExpectTensorEqual<tstring>(element[0], restored[0]);
+  test::ExpectTensorEqual<float>(element[1], restored[1]);
+  test::ExpectTensorEqual<int32>(element[2], restored[2]);
+}
+
+TEST(SpillingShuffleBufferTest, SaveAndRestore) {
+  const string directory = ScratchDirectory("save_restore");
+  auto key = [](const string& name) {
+    return strings::StrCat(kFullNameRandomHex, kPipe, "Iterator:", name);
+  };
+  std::mt19937_64 rng(5);
+  SpillingShuffleBuffer buffer(Env::Default(), {directory}, 4);
+  AddRange(0, 10, 0, &rng, &buffer);
+  AddRange(10, 15, 1, &rng, &buffer);
+  std::vector<int64> values = RemoveN(3, &rng, &buffer);
+
+  VariantTensorDataWriter writer;
+  TF_ASSERT_OK(buffer.Save(key, &writer));
+  std::vector<const VariantTensorData*> data;
+  writer.GetData(&data);
+  VariantTensorDataReader reader(data);
+  SpillingShuffleBuffer restored(Env::Default(), {directory}, 4);
+  TF_ASSERT_OK(restored.Restore(key, &reader));
+  EXPECT_EQ(buffer.size(), restored.size());
+  EXPECT_EQ(buffer.num_runs(), restored.num_runs());
+
+  // Both buffers produce the same elements in the same order.
+  std::mt19937_64 restored_rng = rng;
+  std::vector<int64> expected = RemoveN(12, &rng, &buffer);
+  EXPECT_EQ(expected, RemoveN(12, &restored_rng, &restored));
+  values.insert(values.end(), expected.begin(), expected.end());
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(Iota(0, 15), values);
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -32,6 +32,12 @@ ABSL_CONST_INIT const char kDroppedElements[] = "dropped_elements";
 ABSL_CONST_INIT const char kFeaturesCount[] = "features_count";
 ABSL_CONST_INIT const char kFeatureValuesCount[] = "feature_values_count";
 ABSL_CONST_INIT const char kExamplesCount[] = "examples_count";
+ABSL_CONST_INIT const char kElementLatency[] = "element_latency";
+ABSL_CONST_INIT const char kStragglerElements[] = "straggler_elements";
+ABSL_CONST_INIT const char kProcessingTimeFraction[] =
+    "processing_time_fraction";
+ABSL_CONST_INIT const char kOutputTime[] = "output_time";
+ABSL_CONST_INIT const char kSpeedupIfIncremented[] = "speedup_if_incremented";
 
 string ExecutionTimeHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kExecutionTime);
@@ -61,6 +67,26 @@ string DroppedElementsScalarName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kDroppedElements);
 }
 
+string ElementLatencyHistogramName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kElementLatency);
+}
+
+string StragglerElementsScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kStragglerElements);
+}
+
+string ProcessingTimeFractionScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kProcessingTimeFraction);
+}
+
+string OutputTimeScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kOutputTime);
+}
+
+string SpeedupIfIncrementedScalarName(const string& prefix) {
+  return strings::StrCat(prefix, kDelimiter, kSpeedupIfIncremented);
+}
+
 string FeatureHistogramName(const string& prefix) {
   return strings::StrCat(prefix, kDelimiter, kFeaturesCount);
 }
@@ -31,6 +31,11 @@ extern const char kDroppedElements[];
 extern const char kFeaturesCount[];
 extern const char kFeatureValuesCount[];
 extern const char kExamplesCount[];
+extern const char kElementLatency[];
+extern const char kStragglerElements[];
+extern const char kProcessingTimeFraction[];
+extern const char kOutputTime[];
+extern const char kSpeedupIfIncremented[];
 
 // Name for tf.data function execution time (in ns) histogram metrics.
 string ExecutionTimeHistogramName(const string& prefix);
@@ -55,6 +60,25 @@ string FilterdElementsScalarName(const string& prefix);
 // Name for dropped elements scalar mereics.
 string DroppedElementsScalarName(const string& prefix);
 
+// Name for the latency (in ns) of producing an element from an input element
+// histogram metrics.
+string ElementLatencyHistogramName(const string& prefix);
+
+// Name for straggling input elements scalar metrics.
+string StragglerElementsScalarName(const string& prefix);
+
+// Name for the share of the input pipeline CPU time spent in a node scalar
+// metrics.
+string ProcessingTimeFractionScalarName(const string& prefix);
+
+// Name for the per-element output time (in ns) of a subtree of the input
+// pipeline scalar metrics.
+string OutputTimeScalarName(const string& prefix);
+
+// Name for the predicted speedup of the input pipeline if the tunable parameter
+// of a node were incremented scalar metrics.
+string SpeedupIfIncrementedScalarName(const string& prefix);
+
 // Name for features count histogram metrics.
 string FeatureHistogramName(const string& prefix);
 
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
 #include "tensorflow/core/common_runtime/metrics.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/kernels/data/name_utils.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 namespace data {
@@ -35,11 +37,17 @@ namespace data {
 /* static */ constexpr const char* const TFRecordDatasetOp::kFileNames;
 /* static */ constexpr const char* const TFRecordDatasetOp::kCompressionType;
 /* static */ constexpr const char* const TFRecordDatasetOp::kBufferSize;
+/* static */ constexpr const char* const TFRecordDatasetOp::kNumShards;
+/* static */ constexpr const char* const TFRecordDatasetOp::kIndex;
 
+constexpr char kShardedTFRecordDataset[] = "_ShardedTFRecordDataset";
 constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kOffset[] = "offset";
 constexpr char kGcsFsPrefix[] = "gs://";
 constexpr int64 kCloudTpuBlockSize = 127LL << 20;  // 127MB.
+// The number of records of a memory-mapped file whose checksums are verified
+// together.
+constexpr int kMappedRecordBatchSize = 64;
 
 bool is_cloud_tpu_gcs_fs() {
 #if defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)
@@ -48,18 +56,67 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+// Returns true if uncompressed files should be memory-mapped and their records
+// returned without copying them, where the file system supports it.
+bool UseMemoryMappedRecords() {
+  bool use_mmap = false;
+  Status s =
+      ReadBoolFromEnvVar("TF_RECORD_DATASET_USE_MMAP", false, &use_mmap);
+  if (!s.ok()) {
+    LOG(ERROR) << s;
+  }
+  return use_mmap;
+}
+
+// A scalar string buffer that views a record of a memory-mapped file, and
+// keeps the mapping alive for as long as the tensor that uses it.
+class MappedRecordBuffer : public TensorBuffer {
+ public:
+  MappedRecordBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     StringPiece record)
+      : TensorBuffer(&record_), region_(std::move(region)) {
+    record_.assign_as_view(record.data(), record.size());
+  }
+
+  size_t size() const override { return sizeof(tstring); }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size());
+    proto->set_allocator_name("mmap");
+  }
+  // The record bytes belong to the mapping, so the buffer must not be
+  // forwarded to kernels that write their outputs in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  ~MappedRecordBuffer() override = default;
+
+  tstring record_;
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedRecordBuffer);
+};
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
+  // If `sharded`, only the records that start in the `index`-th of
+  // `num_shards` equal byte ranges of each file are read.
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
-                   const string& compression_type, int64 buffer_size)
+                   const string& compression_type, int64 buffer_size,
+                   bool use_mmap, bool sharded, int64 num_shards, int64 index)
       : DatasetBase(DatasetContext(ctx)),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
-            compression_type)) {
+            compression_type)),
+        sharded_(sharded),
+        num_shards_(num_shards),
+        index_(index) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
     }
+    use_mmap_ = use_mmap && !sharded_ &&
+                options_.compression_type == io::RecordReaderOptions::NONE;
   }
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -95,6 +152,15 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     TF_RETURN_IF_ERROR(b->AddScalar(compression_type_, &compression_type));
     Node* buffer_size = nullptr;
     TF_RETURN_IF_ERROR(b->AddScalar(options_.buffer_size, &buffer_size));
+    if (sharded_) {
+      Node* num_shards = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(num_shards_, &num_shards));
+      Node* index = nullptr;
+      TF_RETURN_IF_ERROR(b->AddScalar(index_, &index));
+      return b->AddDataset(
+          this, {filenames, compression_type, buffer_size, num_shards, index},
+          output);
+    }
     TF_RETURN_IF_ERROR(b->AddDataset(
         this, {filenames, compression_type, buffer_size}, output));
     return Status::OK();
@@ -113,11 +179,8 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
-          out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
-                                    TensorShape({}));
-          Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+        if (reader_ || mapped_reader_) {
+          Status s = ReadRecordLocked(ctx, out_tensors);
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -126,7 +189,6 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
             *end_of_sequence = false;
             return Status::OK();
           }
-          out_tensors->pop_back();
           if (!errors::IsOutOfRange(s)) {
             // In case of other errors e.g., DataLoss, we still move forward
             // the file index so that it works with ignore_errors.
@@ -164,7 +226,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(full_name(kCurrentFileIndex),
                                              current_file_index_));
 
-      if (reader_) {
+      if (mapped_reader_) {
+        TF_RETURN_IF_ERROR(
+            writer->WriteScalar(full_name(kOffset), mapped_offset_));
+      } else if (reader_) {
         TF_RETURN_IF_ERROR(
             writer->WriteScalar(full_name(kOffset), reader_->TellOffset()));
       }
@@ -183,12 +248,48 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64 offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(full_name(kOffset), &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        if (mapped_reader_) {
+          mapped_offset_ = offset;
+        } else {
+          TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        }
       }
       return Status::OK();
     }
 
    private:
+    // Reads the next record of the current file into a new element of
+    // `out_tensors`. The element is only added on success.
+    Status ReadRecordLocked(IteratorContext* ctx,
+                            std::vector<Tensor>* out_tensors)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (mapped_reader_) {
+        if (next_mapped_record_ == mapped_records_.size()) {
+          mapped_records_.clear();
+          next_mapped_record_ = 0;
+          uint64 offset = mapped_offset_;
+          TF_RETURN_IF_ERROR(mapped_reader_->ReadRecords(
+              &offset, kMappedRecordBatchSize, &mapped_records_));
+        }
+        const StringPiece record = mapped_records_[next_mapped_record_++];
+        mapped_offset_ += io::RecordReader::kHeaderSize + record.size() +
+                          io::RecordReader::kFooterSize;
+        auto* buffer = new MappedRecordBuffer(region_, record);
+        out_tensors->emplace_back(DT_STRING, TensorShape({}), buffer);
+        buffer->Unref();
+        return Status::OK();
+      }
+      if (reader_->TellOffset() >= shard_end_) {
+        return errors::OutOfRange("End of shard");
+      }
+      out_tensors->emplace_back(ctx->allocator({}), DT_STRING, TensorShape({}));
+      Status s = reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+      if (!s.ok()) {
+        out_tensors->pop_back();
+      }
+      return s;
+    }
+
     // Sets up reader streams to read from the file at `current_file_index_`.
     Status SetupStreamsLocked(Env* env) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       if (current_file_index_ >= dataset()->filenames_.size()) {
@@ -199,9 +300,40 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
       // Actually move on to next file.
       const string& next_filename = dataset()->filenames_[current_file_index_];
+      if (dataset()->use_mmap_) {
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        Status s = env->NewReadOnlyMemoryRegionFromFile(next_filename, &region);
+        if (s.ok()) {
+          region_ = std::move(region);
+          mapped_reader_ =
+              absl::make_unique<io::MemoryMappedRecordReader>(region_.get());
+          mapped_offset_ = 0;
+          return Status::OK();
+        }
+        // E.g. the file system does not support memory mapping, or the file
+        // is empty.
+        VLOG(2) << "Not memory-mapping " << next_filename << ": " << s;
+      }
       TF_RETURN_IF_ERROR(env->NewRandomAccessFile(next_filename, &file_));
       reader_ = absl::make_unique<io::SequentialRecordReader>(
           file_.get(), dataset()->options_);
+      shard_end_ = kuint64max;
+      if (dataset()->sharded_) {
+        // Read the records that start in this shard's byte range; the last
+        // of them may end in the next range.
+        uint64 file_size;
+        TF_RETURN_IF_ERROR(env->GetFileSize(next_filename, &file_size));
+        const uint64 num_shards = dataset()->num_shards_;
+        const uint64 index = dataset()->index_;
+        const uint64 begin = file_size / num_shards * index +
+                             file_size % num_shards * index / num_shards;
+        shard_end_ = file_size / num_shards * (index + 1) +
+                     file_size % num_shards * (index + 1) / num_shards;
+        uint64 offset;
+        TF_RETURN_IF_ERROR(io::FindRecordStart(file_.get(), file_size, begin,
+                                               shard_end_, &offset));
+        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+      }
       return Status::OK();
     }
 
@@ -209,6 +341,11 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      mapped_reader_.reset();
+      region_.reset();
+      mapped_offset_ = 0;
+      mapped_records_.clear();
+      next_mapped_record_ = 0;
     }
 
     mutex mu_;
@@ -218,15 +355,34 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+    // `reader_` stops before the first record at or after this offset.
+    uint64 shard_end_ TF_GUARDED_BY(mu_) = kuint64max;
+
+    // Used instead of `reader_` when the current file is memory-mapped. The
+    // tensors returned by GetNext() share ownership of `region_`.
+    std::shared_ptr<ReadOnlyMemoryRegion> region_ TF_GUARDED_BY(mu_);
+    std::unique_ptr<io::MemoryMappedRecordReader> mapped_reader_
+        TF_GUARDED_BY(mu_);
+    // The offset of the next record to return.
+    uint64 mapped_offset_ TF_GUARDED_BY(mu_) = 0;
+    // A batch of verified records, of which the first `next_mapped_record_`
+    // have already been returned.
+    std::vector<StringPiece> mapped_records_ TF_GUARDED_BY(mu_);
+    size_t next_mapped_record_ TF_GUARDED_BY(mu_) = 0;
   };
 
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
+  bool use_mmap_;
+  const bool sharded_;
+  const int64 num_shards_;
+  const int64 index_;
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
-    : DatasetOpKernel(ctx) {}
+    : DatasetOpKernel(ctx),
+      sharded_(ctx->def().op() == kShardedTFRecordDataset) {}
 
 void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
                                     DatasetBase** output) {
@@ -264,13 +420,33 @@ void TFRecordDatasetOp::MakeDataset(OpKernelContext* ctx,
     buffer_size = kCloudTpuBlockSize;
   }
 
-  *output =
-      new Dataset(ctx, std::move(filenames), compression_type, buffer_size);
+  int64 num_shards = 1;
+  int64 index = 0;
+  if (sharded_) {
+    OP_REQUIRES_OK(ctx,
+                   ParseScalarArgument<int64>(ctx, kNumShards, &num_shards));
+    OP_REQUIRES_OK(ctx, ParseScalarArgument<int64>(ctx, kIndex, &index));
+    OP_REQUIRES(
+        ctx, num_shards > 0 && index >= 0 && index < num_shards,
+        errors::InvalidArgument("`index` must be in [0, `num_shards`), got ",
+                                index, " and ", num_shards));
+    // The record boundaries of compressed files cannot be found from an
+    // arbitrary offset.
+    OP_REQUIRES(ctx, compression_type.empty(),
+                errors::InvalidArgument(
+                    "Sharding by record ranges requires uncompressed files"));
+  }
+
+  *output = new Dataset(ctx, std::move(filenames), compression_type,
+                        buffer_size, UseMemoryMappedRecords(), sharded_,
+                        num_shards, index);
 }
 
 namespace {
 REGISTER_KERNEL_BUILDER(Name("TFRecordDataset").Device(DEVICE_CPU),
                         TFRecordDatasetOp);
+REGISTER_KERNEL_BUILDER(Name("_ShardedTFRecordDataset").Device(DEVICE_CPU),
+                        TFRecordDatasetOp);
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
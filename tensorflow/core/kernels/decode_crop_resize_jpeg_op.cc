@@ -0,0 +1,263 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/image_ops.cc
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the largest libjpeg scale denominator at which the crop window still
+// has at least `target_height` x `target_width` pixels, so that the resize
+// only ever downsamples.
+int ChooseScaleDenominator(int crop_height, int crop_width, int target_height,
+                           int target_width) {
+  for (int ratio : {8, 4, 2}) {
+    if (crop_height / ratio >= target_height &&
+        crop_width / ratio >= target_width) {
+      return ratio;
+    }
+  }
+  return 1;
+}
+
+// The two input pixels an output pixel is interpolated from, and the weight
+// of the upper one.
+struct Interpolation {
+  int64 lower;
+  int64 upper;
+  float lerp;
+};
+
+// Computes the interpolation of `out_size` pixels with half-pixel centers from
+// the window [in_begin, in_begin + in_extent) of an axis of `in_size` pixels.
+// Indices are multiplied by `stride`.
+void ComputeInterpolation(int64 out_size, float in_begin, float in_extent,
+                          int64 in_size, int64 stride,
+                          std::vector<Interpolation>* interpolation) {
+  interpolation->resize(out_size);
+  const float scale = in_extent / out_size;
+  for (int64 i = 0; i < out_size; ++i) {
+    const float in = std::max(in_begin + (i + 0.5f) * scale - 0.5f, 0.0f);
+    const int64 lower = std::min(static_cast<int64>(in), in_size - 1);
+    Interpolation& entry = (*interpolation)[i];
+    entry.lower = lower * stride;
+    entry.upper = std::min(lower + 1, in_size - 1) * stride;
+    entry.lerp = in - lower;
+  }
+}
+
+// Decodes a crop window of a JPEG image and resizes it bilinearly, in one
+// kernel. The image is decoded with libjpeg's DCT-domain scaling at the
+// smallest scale that is still at least as large as the target size, and only
+// the MCU rows and columns that cover the crop window are decoded, so most
+// of the cost of decoding the full-size image is never paid.
+class DecodeCropResizeJpegOp : public OpKernel {
+ public:
+  explicit DecodeCropResizeJpegOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    int channels;
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels));
+    OP_REQUIRES(context, channels == 0 || channels == 1 || channels == 3,
+                errors::InvalidArgument(
+                    "channels must be 0, 1, or 3 for JPEG, got ", channels));
+    flags_.components = channels;
+    flags_.crop = true;
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("try_recover_truncated",
+                                    &flags_.try_recover_truncated_jpeg));
+    OP_REQUIRES_OK(context, context->GetAttr("acceptable_fraction",
+                                             &flags_.min_acceptable_fraction));
+
+    // The TensorFlow-chosen default for jpeg decoding is IFAST, sacrificing
+    // image quality for speed.
+    flags_.dct_method = JDCT_IFAST;
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    if (dct_method == "INTEGER_ACCURATE") {
+      flags_.dct_method = JDCT_ISLOW;
+    }
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(contents.shape()),
+                errors::InvalidArgument("contents must be scalar, got shape ",
+                                        contents.shape().DebugString()));
+    const StringPiece input = contents.scalar<tstring>()();
+    OP_REQUIRES(context, input.size() <= std::numeric_limits<int>::max(),
+                errors::InvalidArgument("JPEG contents are too large for int: ",
+                                        input.size()));
+
+    const Tensor& crop_window = context->input(1);
+    OP_REQUIRES(context,
+                crop_window.dims() == 1 && crop_window.dim_size(0) == 4,
+                errors::InvalidArgument(
+                    "crop_window must be a vector of four elements, got shape ",
+                    crop_window.shape().DebugString()));
+    const auto crop_window_vec = crop_window.vec<int32>();
+    const int crop_y = crop_window_vec(0);
+    const int crop_x = crop_window_vec(1);
+    const int crop_height = crop_window_vec(2);
+    const int crop_width = crop_window_vec(3);
+
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context, size.dims() == 1 && size.dim_size(0) == 2,
+                errors::InvalidArgument(
+                    "size must be a vector of two elements, got shape ",
+                    size.shape().DebugString()));
+    const int out_height = size.vec<int32>()(0);
+    const int out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("size must be positive, got ",
+                                        out_height, "x", out_width));
+
+    int image_width, image_height, image_components;
+    OP_REQUIRES(context,
+                jpeg::GetImageInfo(input.data(), input.size(), &image_width,
+                                   &image_height, &image_components),
+                errors::InvalidArgument("Invalid JPEG data, size ",
+                                        input.size()));
+    OP_REQUIRES(
+        context,
+        crop_height > 0 && crop_width > 0 && crop_y >= 0 && crop_x >= 0 &&
+            static_cast<int64>(crop_y) + crop_height <= image_height &&
+            static_cast<int64>(crop_x) + crop_width <= image_width,
+        errors::InvalidArgument("Invalid crop window: y=", crop_y, ", x=",
+                                crop_x, ", h=", crop_height, ", w=",
+                                crop_width, " for image of size ",
+                                image_height, "x", image_width));
+
+    // libjpeg scales an image of n pixels to ceil(n / ratio) pixels, and the
+    // crop window is given to the decoder in scaled pixels. Decode the
+    // smallest scaled window that covers the crop window; the resize below
+    // maps the exact crop window into it.
+    const int ratio = ChooseScaleDenominator(crop_height, crop_width,
+                                             out_height, out_width);
+    const int scaled_height = (image_height + ratio - 1) / ratio;
+    const int scaled_width = (image_width + ratio - 1) / ratio;
+    const int window_y = crop_y / ratio;
+    const int window_x = crop_x / ratio;
+    jpeg::UncompressFlags flags = flags_;
+    flags.ratio = ratio;
+    flags.crop_y = window_y;
+    flags.crop_x = window_x;
+    flags.crop_height =
+        std::min((crop_y + crop_height + ratio - 1) / ratio, scaled_height) -
+        window_y;
+    flags.crop_width =
+        std::min((crop_x + crop_width + ratio - 1) / ratio, scaled_width) -
+        window_x;
+
+    Tensor decoded;
+    OP_REQUIRES(
+        context,
+        jpeg::Uncompress(
+            input.data(), input.size(), flags, nullptr /* nwarn */,
+            [=, &decoded](int width, int height, int channels) -> uint8* {
+              Status status(context->allocate_temp(
+                  DT_UINT8, TensorShape({height, width, channels}),
+                  &decoded));
+              if (!status.ok()) {
+                VLOG(1) << status;
+                context->SetStatus(status);
+                return nullptr;
+              }
+              return decoded.flat<uint8>().data();
+            }),
+        errors::InvalidArgument("Invalid JPEG data or crop window, data size ",
+                                input.size()));
+
+    const int64 in_height = decoded.dim_size(0);
+    const int64 in_width = decoded.dim_size(1);
+    const int64 channels = decoded.dim_size(2);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0, TensorShape({out_height, out_width, channels}),
+                       &output));
+
+    std::vector<Interpolation> ys, xs;
+    ComputeInterpolation(out_height,
+                         static_cast<float>(crop_y) / ratio - window_y,
+                         static_cast<float>(crop_height) / ratio, in_height,
+                         in_width * channels, &ys);
+    ComputeInterpolation(out_width,
+                         static_cast<float>(crop_x) / ratio - window_x,
+                         static_cast<float>(crop_width) / ratio, in_width,
+                         channels, &xs);
+
+    const uint8* in_data = decoded.flat<uint8>().data();
+    float* out_data = output->flat<float>().data();
+    const int64 out_row_size = out_width * channels;
+    auto resize_rows = [&](int64 begin, int64 end) {
+      for (int64 y = begin; y < end; ++y) {
+        const uint8* top = in_data + ys[y].lower;
+        const uint8* bottom = in_data + ys[y].upper;
+        const float y_lerp = ys[y].lerp;
+        float* out_row = out_data + y * out_row_size;
+        for (int64 x = 0; x < out_width; ++x) {
+          const Interpolation& xi = xs[x];
+          for (int64 c = 0; c < channels; ++c) {
+            const float top_left = top[xi.lower + c];
+            const float top_right = top[xi.upper + c];
+            const float bottom_left = bottom[xi.lower + c];
+            const float bottom_right = bottom[xi.upper + c];
+            const float top_value =
+                top_left + (top_right - top_left) * xi.lerp;
+            const float bottom_value =
+                bottom_left + (bottom_right - bottom_left) * xi.lerp;
+            out_row[x * channels + c] =
+                top_value + (bottom_value - top_value) * y_lerp;
+          }
+        }
+      }
+    };
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, out_height,
+          out_row_size * 10, resize_rows);
+  }
+
+ private:
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("DecodeCropResizeJpeg").Device(DEVICE_CPU),
+                        DecodeCropResizeJpegOp);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,130 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/jpeg/jpeg_mem.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kWidth = 160;
+constexpr int kHeight = 128;
+
+// Encodes a kHeight x kWidth RGB image whose pixels are given by `pixel`.
+template <typename PixelFn>
+tstring EncodeTestImage(PixelFn pixel) {
+  std::vector<uint8> image(kWidth * kHeight * 3);
+  for (int y = 0; y < kHeight; ++y) {
+    for (int x = 0; x < kWidth; ++x) {
+      for (int c = 0; c < 3; ++c) {
+        image[(y * kWidth + x) * 3 + c] = pixel(y, x, c);
+      }
+    }
+  }
+  jpeg::CompressFlags flags;
+  flags.format = jpeg::FORMAT_RGB;
+  flags.quality = 100;
+  return jpeg::Compress(image.data(), kWidth, kHeight, flags);
+}
+
+class DecodeCropResizeJpegOpTest : public OpsTestBase {
+ protected:
+  void MakeOp() {
+    TF_ASSERT_OK(NodeDefBuilder("decode_crop_resize", "DecodeCropResizeJpeg")
+                     .Input(FakeInput(DT_STRING))
+                     .Input(FakeInput(DT_INT32))
+                     .Input(FakeInput(DT_INT32))
+                     .Attr("channels", 3)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+
+  Status Run(const tstring& contents, const std::vector<int32>& crop_window,
+             const std::vector<int32>& size) {
+    AddInputFromArray<tstring>(TensorShape({}), {contents});
+    AddInputFromArray<int32>(TensorShape({4}), crop_window);
+    AddInputFromArray<int32>(TensorShape({2}), size);
+    return RunOpKernel();
+  }
+};
+
+TEST_F(DecodeCropResizeJpegOpTest, MatchesDecodeAndCropAtCropSize) {
+  const tstring contents = EncodeTestImage(
+      [](int y, int x, int c) { return (y * 3 + x * 5 + c * 7) % 256; });
+  MakeOp();
+  TF_ASSERT_OK(Run(contents, {16, 24, 40, 56}, {40, 56}));
+
+  jpeg::UncompressFlags flags;
+  flags.components = 3;
+  flags.dct_method = JDCT_IFAST;
+  flags.crop = true;
+  flags.crop_y = 16;
+  flags.crop_x = 24;
+  flags.crop_height = 40;
+  flags.crop_width = 56;
+  int width, height, components;
+  std::unique_ptr<uint8[]> expected(
+      jpeg::Uncompress(contents.data(), contents.size(), flags, &width,
+                       &height, &components, nullptr));
+  ASSERT_NE(expected, nullptr);
+
+  const Tensor& output = *GetOutput(0);
+  ASSERT_EQ(output.shape(), TensorShape({40, 56, 3}));
+  const auto output_values = output.flat<float>();
+  for (int i = 0; i < output_values.size(); ++i) {
+    ASSERT_EQ(output_values(i), expected[i]) << i;
+  }
+}
+
+TEST_F(DecodeCropResizeJpegOpTest, DownscalesInTheDctDomain) {
+  // A smooth horizontal ramp, so that the value of an output pixel depends
+  // only on where its center falls in the crop window.
+  const tstring contents =
+      EncodeTestImage([](int y, int x, int c) { return x; });
+  MakeOp();
+  // The crop window is 96x128 and the output 12x16, so the image is decoded
+  // at 1/8 scale and not resized further.
+  TF_ASSERT_OK(Run(contents, {16, 16, 96, 128}, {12, 16}));
+
+  const Tensor& output = *GetOutput(0);
+  ASSERT_EQ(output.shape(), TensorShape({12, 16, 3}));
+  const auto values = output.tensor<float, 3>();
+  for (int y = 0; y < 12; ++y) {
+    for (int x = 0; x < 16; ++x) {
+      // Output pixel x covers input pixels [16 + 8x, 24 + 8x).
+      EXPECT_NEAR(values(y, x, 0), 16 + 8 * x + 3.5, 3) << y << " " << x;
+    }
+  }
+}
+
+TEST_F(DecodeCropResizeJpegOpTest, RejectsCropWindowOutsideImage) {
+  const tstring contents =
+      EncodeTestImage([](int y, int x, int c) { return 0; });
+  MakeOp();
+  const Status status = Run(contents, {100, 0, 64, 64}, {32, 32});
+  EXPECT_TRUE(errors::IsInvalidArgument(status)) << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -90,17 +90,27 @@ static bool ReadBoolFromEnvVar(const char* env_var_name, bool default_val) {
   return default_val;
 }
 
+// TODO(andydavis) Add support for multiple filter sizes and strides.
+bool DeepConv2DSupportsShape(int stride_rows, int stride_cols, int filter_rows,
+                             int filter_cols) {
+  return stride_rows == 1 && stride_cols == 1 && filter_rows == 3 &&
+         filter_cols == 3;
+}
+
+bool UseDeepConv2DAutotune() {
+  // NOTE: IF this environment variable name changes, update conv_ops_test.py.
+  return ReadBoolFromEnvVar("TF_USE_DEEP_CONV2D_AUTOTUNE", false);
+}
+
 // Returns true if convolution can be computed efficiently by DeepConv2D,
 // returns false otherwise.
 // TODO(andydavis) Add support for other filter sizes and strides.
-// TODO(andydavis) Add support for autotuning.
 bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
                       int out_rows, int out_cols) {
   // Check if convolution parameters are supported.
-  // TODO(andydavis) Add support for multiple filter sizes and strides.
-  if (stride_rows > 1 || stride_cols > 1 || filter_rows != 3 ||
-      filter_cols != 3) {
+  if (!DeepConv2DSupportsShape(stride_rows, stride_cols, filter_rows,
+                               filter_cols)) {
     return false;
   }
 
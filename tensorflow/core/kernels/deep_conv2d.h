@@ -101,6 +101,16 @@ bool CanUseDeepConv2D(int stride_rows, int stride_cols, int filter_rows,
                       int filter_cols, int in_depth, int out_depth,
                       int out_rows, int out_cols);
 
+// Returns true if the DeepConv2D implementation supports the convolution
+// parameters, regardless of its estimated cost or whether it is enabled.
+bool DeepConv2DSupportsShape(int stride_rows, int stride_cols, int filter_rows,
+                             int filter_cols);
+
+// Returns true if Conv2D on the CPU should time DeepConv2D against the default
+// implementation on the first use of each supported shape, and use the faster
+// one from then on, instead of relying on CanUseDeepConv2D.
+bool UseDeepConv2DAutotune();
+
 namespace functor {
 
 // Calls DeepConv2D implementation (see deep_conv2d.cc for details).
@@ -15,17 +15,24 @@ limitations under the License.
 
 // See docs in ../ops/data_flow_ops.cc.
 
+#include <algorithm>
+#include <numeric>
 #include <vector>
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/radix_sort.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+// Inputs with at least this many partition ids are partitioned in parallel.
+constexpr int64 kParallelDynamicPartitionMinSize = 1 << 16;
+
 // Shared code that is not dependent on the type of T.  We do this to reduce
 // code size by not duplicating all this for all T (float, double, int32, etc.)
 class DynamicPartitionOp_Shared : public OpKernel {
@@ -97,6 +104,11 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
 
     auto e_partitions = partitions->flat<int32>();
     const int64 N = e_partitions.dimension(0);
+    if (N >= kParallelDynamicPartitionMinSize &&
+        c->device()->tensorflow_cpu_worker_threads()->num_threads > 1) {
+      PartitionInParallel(c, *data, *partitions, &outputs);
+      return;
+    }
     gtl::InlinedVector<int, 32> output_index(num_partitions_);
 
     if (partitions->dims() == data->dims()) {
@@ -156,6 +168,53 @@ class DynamicPartitionOp : public DynamicPartitionOp_Shared {
       }
     }
   }
+
+ private:
+  // Radix sorts the row indices of data by partition id. Each row then knows
+  // its position in its output tensor, so the rows are copied in parallel.
+  void PartitionInParallel(OpKernelContext* c, const Tensor& data,
+                           const Tensor& partitions, OpOutputList* outputs) {
+    auto e_partitions = partitions.flat<int32>();
+    const int64 N = e_partitions.dimension(0);
+    std::vector<int32> keys(N);
+    for (int64 i = 0; i < N; i++) {
+      keys[i] = internal::SubtleMustCopy(e_partitions(i));
+      OP_REQUIRES(
+          c, FastBoundsCheck(keys[i], num_partitions_),
+          errors::InvalidArgument("indices[", i, "] is out of range"));
+    }
+    std::vector<int64> rows(N);
+    std::iota(rows.begin(), rows.end(), 0);
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *c->device()->tensorflow_cpu_worker_threads();
+    RadixSortPairs(worker_threads, N, keys.data(), rows.data());
+
+    std::vector<int64> partition_begin(num_partitions_);
+    std::vector<T*> out_base(num_partitions_);
+    for (int p = 0; p < num_partitions_; p++) {
+      partition_begin[p] =
+          std::lower_bound(keys.begin(), keys.end(), p) - keys.begin();
+      const int64 end =
+          std::upper_bound(keys.begin(), keys.end(), p) - keys.begin();
+      OP_REQUIRES(c, end - partition_begin[p] == (*outputs)[p]->dim_size(0),
+                  errors::InvalidArgument(
+                      "partitions have been asynchronously overwritten and "
+                      "no longer match the output sizes"));
+      out_base[p] = (*outputs)[p]->flat<T>().data();
+    }
+
+    const int64 slice_size = data.NumElements() / N;
+    const T* data_base = data.flat<T>().data();
+    Shard(worker_threads.num_threads, worker_threads.workers, N,
+          slice_size * sizeof(T), [&](int64 start, int64 limit) {
+            for (int64 j = start; j < limit; j++) {
+              const int32 p = keys[j];
+              const T* src = data_base + rows[j] * slice_size;
+              std::copy(src, src + slice_size,
+                        out_base[p] + (j - partition_begin[p]) * slice_size);
+            }
+          });
+  }
 };
 
 #define REGISTER_DYNAMIC_PARTITION(T)                                     \
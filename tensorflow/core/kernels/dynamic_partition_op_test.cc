@@ -146,6 +146,37 @@ TEST_F(DynamicPartitionOpTest, SomeOutputsEmpty) {
   }
 }
 
+TEST_F(DynamicPartitionOpTest, Large_TwoD) {
+  MakeOp();
+
+  // Enough rows to be partitioned in parallel. Row i holds {i, -i} and goes
+  // to partition (i * 7) % 4.
+  const int kRows = 1 << 17;
+  std::vector<float> data(2 * kRows);
+  std::vector<int32> partitions(kRows);
+  for (int i = 0; i < kRows; ++i) {
+    data[2 * i] = i;
+    data[2 * i + 1] = -i;
+    partitions[i] = (i * 7) % 4;
+  }
+  AddInputFromArray<float>(TensorShape({kRows, 2}), data);
+  AddInputFromArray<int32>(TensorShape({kRows}), partitions);
+  TF_ASSERT_OK(RunOpKernel());
+
+  for (int p = 0; p < 4; ++p) {
+    const Tensor& output = *GetOutput(p);
+    ASSERT_EQ(output.shape(), TensorShape({kRows / 4, 2}));
+    const auto rows = output.matrix<float>();
+    int row = 0;
+    for (int i = 0; i < kRows; ++i) {
+      if (partitions[i] != p) continue;
+      ASSERT_EQ(rows(row, 0), i) << p << " " << row;
+      ASSERT_EQ(rows(row, 1), -i) << p << " " << row;
+      ++row;
+    }
+  }
+}
+
 TEST_F(DynamicPartitionOpTest, Error_IndexOutOfRange) {
   MakeOp();
 
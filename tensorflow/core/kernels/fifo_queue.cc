@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/framework/node_def.pb.h"
@@ -107,6 +108,23 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     return;
   }
 
+  // Split the batch into elements before taking the lock, so that the
+  // allocations and copies do not block other users of the queue.
+  auto elements = std::make_shared<std::vector<std::vector<PersistentTensor>>>(
+      batch_size);
+  for (int64 index = 0; index < batch_size; ++index) {
+    (*elements)[index].resize(num_components());
+    for (int i = 0; i < num_components(); ++i) {
+      Status s = GetElementComponentFromBatch(tuple, index, i, ctx,
+                                              &(*elements)[index][i]);
+      if (!s.ok()) {
+        ctx->SetStatus(s);
+        callback();
+        return;
+      }
+    }
+  }
+
   CancellationManager* cm = ctx->cancellation_manager();
   CancellationToken token = cm->get_cancellation_token();
   bool already_cancelled;
@@ -117,7 +135,8 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
     if (!already_cancelled) {
       enqueue_attempts_.emplace_back(
           batch_size, callback, ctx, cm, token,
-          [tuple, this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          [elements, batch_size,
+           this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
             if (closed_) {
               attempt->context->SetStatus(
                   errors::Cancelled("FIFOQueue '", name_, "' is closed."));
@@ -126,14 +145,9 @@ void FIFOQueue::TryEnqueueMany(const Tuple& tuple, OpKernelContext* ctx,
             RunResult result = kNoProgress;
             while (queues_[0].size() < static_cast<size_t>(capacity_)) {
               result = kProgress;
-              const int64 index =
-                  tuple[0].dim_size(0) - attempt->elements_requested;
+              const int64 index = batch_size - attempt->elements_requested;
               for (int i = 0; i < num_components(); ++i) {
-                PersistentTensor element;
-                attempt->context->SetStatus(GetElementComponentFromBatch(
-                    tuple, index, i, attempt->context, &element));
-                if (!attempt->context->status().ok()) return kComplete;
-                queues_[i].push_back(element);
+                queues_[i].push_back((*elements)[index][i]);
               }
               --attempt->elements_requested;
               if (attempt->elements_requested == 0) {
@@ -252,41 +266,29 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
     already_cancelled = !cm->RegisterCallback(
         token, [this, cm, token]() { Cancel(kDequeue, cm, token); });
     if (!already_cancelled) {
+      auto dequeued = std::make_shared<std::vector<Tuple>>();
       // TODO(josh11b): This makes two copies of callback, avoid this if possible.
       dequeue_attempts_.emplace_back(
           num_elements, [callback]() { callback(Tuple()); }, ctx, cm, token,
-          [callback, allow_small_batch,
+          [callback, allow_small_batch, dequeued,
            this](Attempt* attempt) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
             int64 queue_size = queues_[0].size();
 
             if (closed_ && queue_size < attempt->elements_requested) {
               // If we don't have enough for a full dequeue, we have
-              // to reset the attempt tuple.
-              if (!attempt->tuple.empty()) {
-                // Restore already-dequeued elements to the front of the
-                // queue.
-                for (int64 i = attempt->tuple[0].dim_size(0) -
-                               attempt->elements_requested - 1;
-                     i >= 0; --i) {
-                  for (int j = 0; j < num_components(); ++j) {
-                    PersistentTensor element;
-                    Status s = GetElementComponentFromBatch(
-                        attempt->tuple, i, j, attempt->context, &element);
-                    if (!s.ok()) {
-                      attempt->context->SetStatus(
-                          errors::DataLoss("Failed to restore element from "
-                                           "partially-dequeued batch "
-                                           "to FIFOQueue: ",
-                                           s.error_message()));
-                    }
-                    queues_[j].push_front(element);
-                  }
+              // to restore the already-dequeued elements to the front of
+              // the queue.
+              for (auto it = dequeued->rbegin(); it != dequeued->rend();
+                   ++it) {
+                for (int j = 0; j < num_components(); ++j) {
+                  queues_[j].push_front(PersistentTensor((*it)[j]));
                 }
               }
-              if (allow_small_batch && !queues_[0].empty()) {
+              attempt->elements_requested += dequeued->size();
+              dequeued->clear();
+              queue_size = queues_[0].size();
+              if (allow_small_batch && queue_size > 0) {
                 // Request all remaining elements in the queue.
-                queue_size = queues_[0].size();
-                attempt->tuple.clear();
                 attempt->elements_requested = queue_size;
               } else {
                 if (allow_small_batch) {
@@ -306,39 +308,18 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
               }
             }
 
+            // Only take the elements off the queue here. They are copied
+            // into the batch by the done callback, outside of the lock.
             RunResult result = kNoProgress;
             for (; queue_size > 0; --queue_size) {
-              if (attempt->tuple.empty()) {
-                // Only allocate tuple when we have something to dequeue
-                // so we don't use excessive memory when there are many
-                // blocked dequeue attempts waiting.
-                attempt->tuple.reserve(num_components());
-                for (int i = 0; i < num_components(); ++i) {
-                  const TensorShape shape =
-                      ManyOutShape(i, attempt->elements_requested);
-                  Tensor element;
-                  attempt->context->SetStatus(attempt->context->allocate_temp(
-                      component_dtypes_[i], shape, &element));
-                  if (!attempt->context->status().ok()) return kComplete;
-                  attempt->tuple.emplace_back(element);
-                }
-              }
               result = kProgress;
-              Tuple tuple;
-              DequeueLocked(attempt->context, &tuple);
-              const int64 index =
-                  attempt->tuple[0].dim_size(0) - attempt->elements_requested;
-              for (int i = 0; i < num_components(); ++i) {
-                attempt->context->SetStatus(batch_util::CopyElementToSlice(
-                    std::move(tuple[i]), &attempt->tuple[i], index));
-                if (!attempt->context->status().ok()) return kComplete;
-              }
-              tuple.clear();
+              dequeued->emplace_back();
+              DequeueLocked(attempt->context, &dequeued->back());
               --attempt->elements_requested;
               if (attempt->elements_requested == 0) {
-                tuple = attempt->tuple;
-                attempt->done_callback = [callback, tuple]() {
-                  callback(tuple);
+                OpKernelContext* ctx = attempt->context;
+                attempt->done_callback = [callback, dequeued, ctx, this]() {
+                  callback(BatchDequeued(ctx, *dequeued));
                 };
                 return kComplete;
               }
@@ -355,6 +336,26 @@ void FIFOQueue::TryDequeueMany(int num_elements, OpKernelContext* ctx,
   }
 }
 
+FIFOQueue::Tuple FIFOQueue::BatchDequeued(OpKernelContext* ctx,
+                                           const std::vector<Tuple>& elements) {
+  Tuple batch;
+  batch.reserve(num_components());
+  for (int i = 0; i < num_components(); ++i) {
+    Tensor component;
+    Status s = ctx->allocate_temp(component_dtypes_[i],
+                                  ManyOutShape(i, elements.size()), &component);
+    for (int64 index = 0; s.ok() && index < elements.size(); ++index) {
+      s = batch_util::CopyElementToSlice(elements[index][i], &component, index);
+    }
+    if (!s.ok()) {
+      ctx->SetStatus(s);
+      return Tuple();
+    }
+    batch.push_back(std::move(component));
+  }
+  return batch;
+}
+
 Status FIFOQueue::MatchesNodeDef(const NodeDef& node_def) {
   if (!MatchesNodeDefOp(node_def, "FIFOQueue").ok() &&
       !MatchesNodeDefOp(node_def, "FIFOQueueV2").ok()) {
@@ -67,6 +67,10 @@ class FIFOQueue : public TypedQueue<std::deque<PersistentTensor> > {
                                              PersistentTensor* out_element);
 
  private:
+  // Stacks the dequeued `elements` into one batch per component. Returns an
+  // empty tuple and sets the status of `ctx` on failure.
+  Tuple BatchDequeued(OpKernelContext* ctx, const std::vector<Tuple>& elements);
+
   TF_DISALLOW_COPY_AND_ASSIGN(FIFOQueue);
 };
 
@@ -25,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/casts.h"
 #include "tensorflow/core/profiler/lib/traceme.h"
 
@@ -406,6 +407,80 @@ class WhileOp : public AsyncOpKernel {
     TensorVec args_;
     TensorVec rets_;
 
+    // Passes the loop variables to the body by moving them out of `args_`,
+    // so that the body holds the only reference to them and can update them
+    // in place, e.g. append to a TensorList without copying it in every
+    // iteration. Collects the results of the body in `rets_`.
+    class BodyFuncCallFrame : public CallFrameInterface {
+     public:
+      BodyFuncCallFrame(TensorVec* args, TensorVec* retvals)
+          : args_(args), retvals_(retvals), retval_set_(args->size()) {
+        arg_types_.reserve(args->size());
+        for (const Tensor& arg : *args) arg_types_.push_back(arg.dtype());
+        retvals_->clear();
+        retvals_->resize(args->size());
+      }
+
+      size_t num_args() const override { return args_->size(); }
+      size_t num_retvals() const override { return retvals_->size(); }
+
+      Status GetArg(int index, Tensor* val) const override {
+        if (index < 0 || index >= args_->size()) {
+          return errors::InvalidArgument("Argument ", index,
+                                         " is out of range.");
+        }
+        *val = (*args_)[index];
+        return Status::OK();
+      }
+
+      bool CanConsumeArg(int index) const override {
+        return index >= 0 && index < args_->size();
+      }
+
+      void ConsumeArg(int index, Tensor* val) override {
+        DCHECK(CanConsumeArg(index));
+        *val = std::move((*args_)[index]);
+      }
+
+      Status SetRetval(int index, const Tensor& val) override {
+        if (index < 0 || index >= retvals_->size()) {
+          return errors::InvalidArgument("While loop body returned ",
+                                         index + 1, " or more arguments. ",
+                                         "Expected: ", retvals_->size());
+        }
+        if (val.dtype() != arg_types_[index]) {
+          return errors::InvalidArgument(
+              "Expected type ", DataTypeString(arg_types_[index]),
+              " for return value ", index, " but got ",
+              DataTypeString(val.dtype()), ".");
+        }
+        if (retval_set_[index]) {
+          return errors::Internal("Retval[", index, "] has already been set.");
+        }
+        (*retvals_)[index] = val;
+        retval_set_[index] = true;
+        return Status::OK();
+      }
+
+      // Returns an error if the body did not set all of its return values.
+      Status CheckRetvals() const {
+        for (int i = 0; i < retval_set_.size(); ++i) {
+          if (!retval_set_[i]) {
+            return errors::Internal("While loop body did not set return value ",
+                                    i, ".");
+          }
+        }
+        return Status::OK();
+      }
+
+     private:
+      TensorVec* const args_;     // Not owned.
+      TensorVec* const retvals_;  // Not owned.
+      DataTypeVector arg_types_;
+      gtl::InlinedVector<bool, 4> retval_set_;
+    };
+    std::unique_ptr<BodyFuncCallFrame> body_frame_;
+
     void EvalCond() {
       profiler::TraceMe trace_me(
           [&] {
@@ -481,18 +556,18 @@ class WhileOp : public AsyncOpKernel {
                 ",function_step_id=", opts_.step_id, "#");
           },
           /*level=*/2);
+      body_frame_.reset(new BodyFuncCallFrame(&args_, &rets_));
       lib_->Run(
           // Evaluate the body.
-          opts_, body_handle_, args_, &rets_,
+          opts_, body_handle_, body_frame_.get(),
           // Done callback
           [this](const Status& s) {
             if (!s.ok()) {
               return Finish(s);
             }
-            if (args_.size() != rets_.size()) {
-              return Finish(errors::InvalidArgument(
-                  "While loop body returned ", rets_.size(),
-                  " arguments. Expected: ", args_.size()));
+            const Status retvals_status = body_frame_->CheckRetvals();
+            if (!retvals_status.ok()) {
+              return Finish(retvals_status);
             }
             args_.clear();
             using std::swap;
@@ -0,0 +1,181 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the kernel for the _FusedAttention op, which replaces the
+// BatchMatMul + Softmax + BatchMatMul attention pattern that grappler's
+// Remapper finds.  Each query row attends to the keys one tile at a time
+// with an online softmax: the running maximum and sum of the exponentials
+// are rescaled whenever a tile raises the maximum.  Only a tile of scores is
+// live at a time, instead of the full [..., query, key] score matrix.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Number of keys whose scores are computed at a time.
+constexpr int64 kKeyTileSize = 128;
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedAttentionOp : public OpKernel {
+ public:
+  explicit FusedAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    float scale;
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale));
+    scale_ = T(scale);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+    const int dims = query.dims();
+    OP_REQUIRES(context, dims >= 2,
+                errors::InvalidArgument("query must have rank at least 2, got ",
+                                        query.shape().DebugString()));
+    OP_REQUIRES(context, key.dims() == dims && value.dims() == dims,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank, got ",
+                    query.shape().DebugString(), ", ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+    TensorShape output_shape;
+    int64 batch_size = 1;
+    for (int i = 0; i < dims - 2; ++i) {
+      OP_REQUIRES(context,
+                  key.dim_size(i) == query.dim_size(i) &&
+                      value.dim_size(i) == query.dim_size(i),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions, got ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), " and ",
+                      value.shape().DebugString()));
+      output_shape.AddDim(query.dim_size(i));
+      batch_size *= query.dim_size(i);
+    }
+    const int64 num_queries = query.dim_size(dims - 2);
+    const int64 depth = query.dim_size(dims - 1);
+    const int64 num_keys = key.dim_size(dims - 2);
+    const int64 value_depth = value.dim_size(dims - 1);
+    OP_REQUIRES(context, key.dim_size(dims - 1) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same depth, got ",
+                    query.shape().DebugString(), " and ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(dims - 2) == num_keys,
+                errors::InvalidArgument(
+                    "key and value must have the same length, got ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+    output_shape.AddDim(num_queries);
+    output_shape.AddDim(value_depth);
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+    auto output_rows =
+        output->shaped<T, 3>({batch_size, num_queries, value_depth});
+    if (num_keys == 0) {
+      output_rows.setZero();
+      return;
+    }
+
+    const auto query_rows =
+        query.shaped<T, 3>({batch_size, num_queries, depth});
+    const auto key_rows = key.shaped<T, 3>({batch_size, num_keys, depth});
+    const auto value_rows =
+        value.shaped<T, 3>({batch_size, num_keys, value_depth});
+    const T scale = scale_;
+
+    using RowVector = Eigen::Matrix<T, 1, Eigen::Dynamic>;
+    using ColVector = Eigen::Matrix<T, Eigen::Dynamic, 1>;
+    using ConstRowMap = Eigen::Map<const RowVector>;
+    using ConstMatrixMap = Eigen::Map<const Eigen::Matrix<
+        T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>>;
+
+    auto attend = [&](int64 begin_row, int64 end_row) {
+      ColVector scores(std::min(kKeyTileSize, num_keys));
+      RowVector accumulator(value_depth);
+      for (int64 row = begin_row; row < end_row; ++row) {
+        const int64 b = row / num_queries;
+        const int64 q = row % num_queries;
+        ConstRowMap query_row(&query_rows(b, q, 0), depth);
+        T max_score = -std::numeric_limits<T>::infinity();
+        T sum = T(0);
+        accumulator.setZero();
+        for (int64 begin_key = 0; begin_key < num_keys;
+             begin_key += kKeyTileSize) {
+          const int64 tile = std::min(kKeyTileSize, num_keys - begin_key);
+          ConstMatrixMap keys(&key_rows(b, begin_key, 0), tile, depth);
+          ConstMatrixMap values(&value_rows(b, begin_key, 0), tile,
+                                value_depth);
+          auto tile_scores = scores.head(tile);
+          tile_scores.noalias() = scale * (keys * query_row.transpose());
+          const T new_max = std::max(max_score, tile_scores.maxCoeff());
+          const T correction = std::exp(max_score - new_max);
+          tile_scores = (tile_scores.array() - new_max).exp().matrix();
+          sum = sum * correction + tile_scores.sum();
+          accumulator *= correction;
+          accumulator.noalias() += tile_scores.transpose() * values;
+          max_score = new_max;
+        }
+        Eigen::Map<RowVector>(&output_rows(b, q, 0), value_depth) =
+            accumulator / sum;
+      }
+    };
+    const int64 cost_per_row = 4 * num_keys * (depth + value_depth);
+    static ShardCostModel* cost_model = new ShardCostModel;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          batch_size * num_queries, cost_per_row, cost_model, attend);
+  }
+
+ private:
+  T scale_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedAttentionOp);
+};
+
+#define REGISTER_KERNEL(T)                                                 \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedAttention").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedAttentionOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
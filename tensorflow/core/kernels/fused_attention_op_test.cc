@@ -0,0 +1,107 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class FusedAttentionOpTest : public OpsTestBase {
+ protected:
+  Status InitFusedAttention(float scale) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedAttention")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Attr("scale", scale)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedAttentionOpTest, MatchesSoftmaxOfScores) {
+  // More keys than fit in one tile, so that the softmax is rescaled.
+  const int batch = 2;
+  const int num_queries = 3;
+  const int num_keys = 300;
+  const int depth = 4;
+  const int value_depth = 2;
+  const float scale = 0.5f;
+  TF_ASSERT_OK(InitFusedAttention(scale));
+  std::vector<float> query(batch * num_queries * depth);
+  std::vector<float> key(batch * num_keys * depth);
+  std::vector<float> value(batch * num_keys * value_depth);
+  for (int i = 0; i < query.size(); ++i) query[i] = std::sin(i * 0.7f);
+  for (int i = 0; i < key.size(); ++i) key[i] = std::cos(i * 0.3f) * 3;
+  for (int i = 0; i < value.size(); ++i) value[i] = (i % 11) - 5.0f;
+  AddInputFromArray<float>(TensorShape({batch, num_queries, depth}), query);
+  AddInputFromArray<float>(TensorShape({batch, num_keys, depth}), key);
+  AddInputFromArray<float>(TensorShape({batch, num_keys, value_depth}),
+                           value);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT,
+                  TensorShape({batch, num_queries, value_depth}));
+  auto expected_rows = expected.tensor<float, 3>();
+  for (int b = 0; b < batch; ++b) {
+    for (int q = 0; q < num_queries; ++q) {
+      std::vector<double> scores(num_keys);
+      double max_score = -INFINITY;
+      for (int k = 0; k < num_keys; ++k) {
+        double score = 0;
+        for (int d = 0; d < depth; ++d) {
+          score += query[(b * num_queries + q) * depth + d] *
+                   key[(b * num_keys + k) * depth + d];
+        }
+        scores[k] = scale * score;
+        max_score = std::max(max_score, scores[k]);
+      }
+      double sum = 0;
+      for (double& score : scores) {
+        score = std::exp(score - max_score);
+        sum += score;
+      }
+      for (int d = 0; d < value_depth; ++d) {
+        double result = 0;
+        for (int k = 0; k < num_keys; ++k) {
+          result += scores[k] / sum *
+                    value[(b * num_keys + k) * value_depth + d];
+        }
+        expected_rows(b, q, d) = result;
+      }
+    }
+  }
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-4);
+}
+
+TEST_F(FusedAttentionOpTest, RejectsMismatchedBatch) {
+  TF_ASSERT_OK(InitFusedAttention(1.0f));
+  AddInputFromArray<float>(TensorShape({1, 1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({2, 1, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2, 1, 1}), {1, 2});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace tensorflow
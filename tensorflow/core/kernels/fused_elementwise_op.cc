@@ -0,0 +1,342 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the kernel for the _FusedElementwise op, which evaluates a chain
+// of element-wise ops, fused by grappler's Remapper, in a single pass over
+// memory.  The chain is evaluated one block of elements at a time, so that
+// the intermediate results of a block stay in cache, and each step of a
+// block is an Eigen expression that is vectorized for the target ISA.
+
+#define EIGEN_USE_THREADS
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Number of elements of a block.  The intermediate results of a block of a
+// chain of a few dozen float ops fit in L2 cache.
+constexpr int64 kBlockSize = 2048;
+
+enum class FusedOpType {
+  // Binary ops.
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kMaximum,
+  kMinimum,
+  kSquaredDifference,
+  // Unary ops.
+  kAbs,
+  kErf,
+  kExp,
+  kLog,
+  kNeg,
+  kReciprocal,
+  kRelu,
+  kRsqrt,
+  kSigmoid,
+  kSqrt,
+  kSquare,
+  kTanh,
+};
+
+struct FusedOpInfo {
+  const char* name;
+  FusedOpType op;
+  int arity;
+};
+
+// The ops that may be fused, by the name of the TensorFlow op they compute.
+constexpr FusedOpInfo kFusedOps[] = {
+    {"Add", FusedOpType::kAdd, 2},
+    {"AddV2", FusedOpType::kAdd, 2},
+    {"Sub", FusedOpType::kSub, 2},
+    {"Mul", FusedOpType::kMul, 2},
+    {"RealDiv", FusedOpType::kDiv, 2},
+    {"Maximum", FusedOpType::kMaximum, 2},
+    {"Minimum", FusedOpType::kMinimum, 2},
+    {"SquaredDifference", FusedOpType::kSquaredDifference, 2},
+    {"Abs", FusedOpType::kAbs, 1},
+    {"Erf", FusedOpType::kErf, 1},
+    {"Exp", FusedOpType::kExp, 1},
+    {"Log", FusedOpType::kLog, 1},
+    {"Neg", FusedOpType::kNeg, 1},
+    {"Reciprocal", FusedOpType::kReciprocal, 1},
+    {"Relu", FusedOpType::kRelu, 1},
+    {"Rsqrt", FusedOpType::kRsqrt, 1},
+    {"Sigmoid", FusedOpType::kSigmoid, 1},
+    {"Sqrt", FusedOpType::kSqrt, 1},
+    {"Square", FusedOpType::kSquare, 1},
+    {"Tanh", FusedOpType::kTanh, 1},
+};
+
+const FusedOpInfo* FindFusedOp(const string& name) {
+  for (const FusedOpInfo& info : kFusedOps) {
+    if (name == info.name) return &info;
+  }
+  return nullptr;
+}
+
+// A step of the fused chain: `op` applied to the values at `operands`, which
+// index the arguments followed by the results of the previous steps.
+struct FusedElementwiseStep {
+  FusedOpType op;
+  int operands[2];
+};
+
+// An operand of a step, restricted to the current block: either a vector of
+// the block size, or a scalar that is broadcast to it.
+template <typename T>
+struct BlockOperand {
+  const T* data;
+  bool is_scalar;
+};
+
+}  // namespace
+
+template <typename Device, typename T>
+class FusedElementwiseOp;
+
+template <typename T>
+class FusedElementwiseOp<CPUDevice, T> : public OpKernel {
+ public:
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+    std::vector<string> fused_ops;
+    OP_REQUIRES_OK(context, context->GetAttr("fused_ops", &fused_ops));
+    std::vector<int> fused_operands;
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("fused_operands", &fused_operands));
+
+    int next_operand = 0;
+    for (const string& fused_op : fused_ops) {
+      const FusedOpInfo* info = FindFusedOp(fused_op);
+      OP_REQUIRES(context, info != nullptr,
+                  errors::Unimplemented("Fusion of ", fused_op,
+                                        " is not supported"));
+      OP_REQUIRES(
+          context, next_operand + info->arity <= fused_operands.size(),
+          errors::InvalidArgument("Too few fused_operands for fused_ops"));
+      FusedElementwiseStep step;
+      step.op = info->op;
+      step.operands[1] = 0;
+      for (int i = 0; i < info->arity; ++i) {
+        const int operand = fused_operands[next_operand++];
+        OP_REQUIRES(context,
+                    operand >= 0 && operand < num_args + steps_.size(),
+                    errors::InvalidArgument(
+                        "Operand ", operand, " of fused op ", steps_.size(),
+                        " is neither an argument nor an earlier result"));
+        step.operands[i] = operand;
+      }
+      steps_.push_back(step);
+    }
+    OP_REQUIRES(context, next_operand == fused_operands.size(),
+                errors::InvalidArgument("Too many fused_operands for ",
+                                        "fused_ops"));
+    OP_REQUIRES(context, !steps_.empty(),
+                errors::InvalidArgument("There must be one fused op at least"));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const int num_args = context->num_inputs();
+
+    // Scalar arguments are broadcast, and all the other arguments must have
+    // the shape of the output.
+    TensorShape shape;
+    for (int i = 0; i < num_args; ++i) {
+      if (!TensorShapeUtils::IsScalar(context->input(i).shape())) {
+        shape = context->input(i).shape();
+        break;
+      }
+    }
+    std::vector<int> forwardable_inputs;
+    for (int i = 0; i < num_args; ++i) {
+      const Tensor& arg = context->input(i);
+      if (TensorShapeUtils::IsScalar(arg.shape())) continue;
+      OP_REQUIRES(context, arg.shape() == shape,
+                  errors::InvalidArgument(
+                      "Arguments of _FusedElementwise must be scalars or have "
+                      "the same shape, got ",
+                      shape.DebugString(), " and ", arg.shape().DebugString(),
+                      " for argument ", i));
+      forwardable_inputs.push_back(i);
+    }
+
+    // Each block of the output is written after all the arguments of the
+    // block are read, so the output may reuse the buffer of an argument.
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                forwardable_inputs, 0, shape, &output));
+    const int64 size = shape.num_elements();
+    if (size == 0) return;
+
+    // Scalars are broadcast in blocks of a non-scalar output only.
+    const bool broadcast_scalars = !TensorShapeUtils::IsScalar(shape);
+    std::vector<BlockOperand<T>> args(num_args);
+    for (int i = 0; i < num_args; ++i) {
+      const Tensor& arg = context->input(i);
+      args[i].data = arg.flat<T>().data();
+      args[i].is_scalar =
+          broadcast_scalars && TensorShapeUtils::IsScalar(arg.shape());
+    }
+    T* output_data = output->flat<T>().data();
+
+    auto evaluate_blocks = [&](int64 begin, int64 end) {
+      // Holds the results of all but the last step for one block.
+      std::vector<T> results((steps_.size() - 1) * kBlockSize);
+      std::vector<BlockOperand<T>> operands(num_args + steps_.size());
+      for (int64 block = begin; block < end; ++block) {
+        const int64 offset = block * kBlockSize;
+        const int64 block_size = std::min(kBlockSize, size - offset);
+        for (int i = 0; i < num_args; ++i) {
+          operands[i].data =
+              args[i].is_scalar ? args[i].data : args[i].data + offset;
+          operands[i].is_scalar = args[i].is_scalar;
+        }
+        for (int s = 0; s < steps_.size(); ++s) {
+          T* result = s + 1 == steps_.size() ? output_data + offset
+                                             : results.data() + s * kBlockSize;
+          EvaluateStep(steps_[s], operands, block_size, result);
+          operands[num_args + s] = {result, false};
+        }
+      }
+    };
+
+    const int64 num_blocks = (size + kBlockSize - 1) / kBlockSize;
+    const int64 cost_per_block = kBlockSize * steps_.size() * 10;
+    const auto& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, evaluate_blocks);
+  }
+
+ private:
+  using Vector = Eigen::TensorMap<Eigen::Tensor<T, 1, Eigen::RowMajor>>;
+  using ConstVector =
+      Eigen::TensorMap<Eigen::Tensor<const T, 1, Eigen::RowMajor>>;
+
+  template <typename Functor>
+  static void Unary(const BlockOperand<T>& x, int64 size, T* result) {
+    if (x.is_scalar) {
+      Vector(result, size).setConstant(Functor()(*x.data));
+    } else {
+      Vector(result, size) = ConstVector(x.data, size).unaryExpr(Functor());
+    }
+  }
+
+  template <typename Functor>
+  static void Binary(const BlockOperand<T>& x, const BlockOperand<T>& y,
+                     int64 size, T* result) {
+    Vector out(result, size);
+    if (x.is_scalar && y.is_scalar) {
+      out.setConstant(Functor()(*x.data, *y.data));
+    } else if (x.is_scalar) {
+      ConstVector y_vec(y.data, size);
+      out = y_vec.constant(*x.data).binaryExpr(y_vec, Functor());
+    } else if (y.is_scalar) {
+      ConstVector x_vec(x.data, size);
+      out = x_vec.binaryExpr(x_vec.constant(*y.data), Functor());
+    } else {
+      out = ConstVector(x.data, size)
+                .binaryExpr(ConstVector(y.data, size), Functor());
+    }
+  }
+
+  // Computes `step` for one block of `size` elements into `result`.
+  static void EvaluateStep(const FusedElementwiseStep& step,
+                           const std::vector<BlockOperand<T>>& operands,
+                           int64 size, T* result) {
+    const BlockOperand<T>& x = operands[step.operands[0]];
+    const BlockOperand<T>& y = operands[step.operands[1]];
+    switch (step.op) {
+      case FusedOpType::kAdd:
+        return Binary<typename functor::add<T>::func>(x, y, size, result);
+      case FusedOpType::kSub:
+        return Binary<typename functor::sub<T>::func>(x, y, size, result);
+      case FusedOpType::kMul:
+        return Binary<typename functor::mul<T>::func>(x, y, size, result);
+      case FusedOpType::kDiv:
+        return Binary<typename functor::div<T>::func>(x, y, size, result);
+      case FusedOpType::kMaximum:
+        return Binary<typename functor::maximum<T>::func>(x, y, size, result);
+      case FusedOpType::kMinimum:
+        return Binary<typename functor::minimum<T>::func>(x, y, size, result);
+      case FusedOpType::kSquaredDifference:
+        return Binary<typename functor::squared_difference<T>::func>(
+            x, y, size, result);
+      case FusedOpType::kAbs:
+        return Unary<typename functor::abs<T>::func>(x, size, result);
+      case FusedOpType::kErf:
+        return Unary<typename functor::erf<T>::func>(x, size, result);
+      case FusedOpType::kExp:
+        return Unary<typename functor::exp<T>::func>(x, size, result);
+      case FusedOpType::kLog:
+        return Unary<typename functor::log<T>::func>(x, size, result);
+      case FusedOpType::kNeg:
+        return Unary<typename functor::neg<T>::func>(x, size, result);
+      case FusedOpType::kReciprocal:
+        return Unary<typename functor::inverse<T>::func>(x, size, result);
+      case FusedOpType::kRelu: {
+        const T zero(0);
+        return Binary<typename functor::maximum<T>::func>(
+            x, BlockOperand<T>{&zero, true}, size, result);
+      }
+      case FusedOpType::kRsqrt:
+        return Unary<typename functor::rsqrt<T>::func>(x, size, result);
+      case FusedOpType::kSigmoid:
+        return Unary<typename functor::sigmoid<T>::func>(x, size, result);
+      case FusedOpType::kSqrt:
+        return Unary<typename functor::sqrt<T>::func>(x, size, result);
+      case FusedOpType::kSquare:
+        return Unary<typename functor::square<T>::func>(x, size, result);
+      case FusedOpType::kTanh:
+        return Unary<typename functor::tanh<T>::func>(x, size, result);
+    }
+  }
+
+  std::vector<FusedElementwiseStep> steps_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedElementwiseOp);
+};
+
+#define REGISTER_KERNEL(T)                                                   \
+  REGISTER_KERNEL_BUILDER(                                                   \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+TF_CALL_double(REGISTER_KERNEL);
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  Status InitFusedElementwise(int num_args,
+                              const std::vector<string>& fused_ops,
+                              const std::vector<int>& fused_operands) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedElementwise")
+                           .Input(FakeInput(num_args, DT_FLOAT))
+                           .Attr("fused_ops", fused_ops)
+                           .Attr("fused_operands", fused_operands)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, Gelu) {
+  // 0.5 * x * (1 + erf(x * 0.70710678)) on more than one block.
+  TF_ASSERT_OK(InitFusedElementwise(
+      4, {"Mul", "Erf", "AddV2", "Mul", "Mul"},
+      // args: x, 0.70710678, 1, 0.5.
+      {0, 1, 4, 2, 5, 0, 6, 3, 7}));
+  const int size = 5000;
+  std::vector<float> x(size);
+  for (int i = 0; i < size; ++i) x[i] = (i - size / 2) / 500.0f;
+  AddInputFromArray<float>(TensorShape({size}), x);
+  AddInputFromArray<float>(TensorShape({}), {0.70710678f});
+  AddInputFromArray<float>(TensorShape({}), {1.0f});
+  AddInputFromArray<float>(TensorShape({}), {0.5f});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({size}));
+  for (int i = 0; i < size; ++i) {
+    expected.flat<float>()(i) =
+        0.5f * x[i] * (1.0f + std::erf(x[i] * 0.70710678f));
+  }
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedElementwiseOpTest, BinaryAndUnaryOps) {
+  // relu(tanh(x - y)) * exp(y) / x.
+  TF_ASSERT_OK(InitFusedElementwise(
+      2, {"Sub", "Tanh", "Relu", "Exp", "Mul", "RealDiv"},
+      {0, 1, 2, 3, 1, 4, 5, 6, 0}));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2, 2}), {2, 1, 1, 0});
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(
+      &expected, {0, std::tanh(1.0f) * std::exp(1.0f) / 2,
+                  std::tanh(2.0f) * std::exp(1.0f) / 3, std::tanh(4.0f) / 4});
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-6);
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsMismatchedShapes) {
+  TF_ASSERT_OK(InitFusedElementwise(2, {"Add", "Relu"}, {0, 1, 2}));
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsInvalidOperands) {
+  EXPECT_FALSE(InitFusedElementwise(1, {"Exp", "Log"}, {0, 2}).ok());
+  EXPECT_FALSE(InitFusedElementwise(1, {"Exp", "Log"}, {0}).ok());
+  EXPECT_FALSE(InitFusedElementwise(1, {"MatMul"}, {0, 0}).ok());
+}
+
+}  // namespace tensorflow
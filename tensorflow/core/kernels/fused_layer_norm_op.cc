@@ -0,0 +1,124 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Implements the kernel for the _FusedLayerNorm op, which replaces the layer
+// normalization subgraph of tf.nn.moments and tf.nn.batch_normalization that
+// grappler's Remapper finds.  Each row is read once to compute its mean and
+// variance with Welford's algorithm, and once more to normalize it, instead
+// of once per op of the subgraph.
+
+#define EIGEN_USE_THREADS
+
+#include <cmath>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+template <typename Device, typename T>
+class FusedLayerNormOp : public OpKernel {
+ public:
+  explicit FusedLayerNormOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    float epsilon;
+    OP_REQUIRES_OK(context, context->GetAttr("epsilon", &epsilon));
+    epsilon_ = T(epsilon);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& x = context->input(0);
+    const Tensor& scale = context->input(1);
+    const Tensor& offset = context->input(2);
+    OP_REQUIRES(context, x.dims() >= 1,
+                errors::InvalidArgument("x must have rank at least 1, got ",
+                                        x.shape().DebugString()));
+    const int64 depth = x.dim_size(x.dims() - 1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(scale.shape()) &&
+                    scale.NumElements() == depth,
+                errors::InvalidArgument("scale must be a vector of size ",
+                                        depth, ", got ",
+                                        scale.shape().DebugString()));
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(offset.shape()) &&
+                    offset.NumElements() == depth,
+                errors::InvalidArgument("offset must be a vector of size ",
+                                        depth, ", got ",
+                                        offset.shape().DebugString()));
+
+    Tensor* y = nullptr;
+    OP_REQUIRES_OK(context, context->forward_input_or_allocate_output(
+                                {0}, 0, x.shape(), &y));
+    if (x.NumElements() == 0) return;
+
+    const auto x_rows = x.flat_inner_dims<T>();
+    const auto scale_vec = scale.vec<T>();
+    const auto offset_vec = offset.vec<T>();
+    auto y_rows = y->flat_inner_dims<T>();
+    const T epsilon = epsilon_;
+
+    // The rows are independent; `y` may alias `x`, which is safe because an
+    // element of a row is only written after the statistics of its row have
+    // been computed.
+    auto normalize_rows = [&](int64 begin_row, int64 end_row) {
+      for (int64 row = begin_row; row < end_row; ++row) {
+        const T* in = &x_rows(row, 0);
+        T* out = &y_rows(row, 0);
+        T mean(0);
+        T m2(0);
+        for (int64 i = 0; i < depth; ++i) {
+          const T delta = in[i] - mean;
+          mean += delta / static_cast<T>(i + 1);
+          m2 += delta * (in[i] - mean);
+        }
+        const T variance = m2 / static_cast<T>(depth);
+        const T inv = T(1) / std::sqrt(variance + epsilon);
+        for (int64 i = 0; i < depth; ++i) {
+          out[i] = (in[i] - mean) * inv * scale_vec(i) + offset_vec(i);
+        }
+      }
+    };
+    // The cost per element varies with how much of x is in cache, so the
+    // estimate is corrected by the measured runtime.
+    static ShardCostModel* cost_model = new ShardCostModel;
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          x_rows.dimension(0), 4 * depth, cost_model, normalize_rows);
+  }
+
+ private:
+  T epsilon_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(FusedLayerNormOp);
+};
+
+#define REGISTER_KERNEL(T)                                                 \
+  REGISTER_KERNEL_BUILDER(                                                 \
+      Name("_FusedLayerNorm").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedLayerNormOp<CPUDevice, T>);
+
+TF_CALL_float(REGISTER_KERNEL);
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,82 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cmath>
+#include <vector>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+
+class FusedLayerNormOpTest : public OpsTestBase {
+ protected:
+  Status InitFusedLayerNorm(float epsilon) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused", "_FusedLayerNorm")
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Input(FakeInput(DT_FLOAT))
+                           .Attr("epsilon", epsilon)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedLayerNormOpTest, NormalizesLastDimension) {
+  TF_ASSERT_OK(InitFusedLayerNorm(0.001f));
+  const int rows = 3;
+  const int depth = 4;
+  const std::vector<float> x = {1, 2, 3, 4, -1, 0, 1, 6, 5, 5, 5, 5.5};
+  const std::vector<float> scale = {1, 2, 0.5, -1};
+  const std::vector<float> offset = {0, 1, -1, 0.25};
+  AddInputFromArray<float>(TensorShape({rows, depth}), x);
+  AddInputFromArray<float>(TensorShape({depth}), scale);
+  AddInputFromArray<float>(TensorShape({depth}), offset);
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({rows, depth}));
+  for (int row = 0; row < rows; ++row) {
+    float mean = 0;
+    for (int i = 0; i < depth; ++i) mean += x[row * depth + i] / depth;
+    float variance = 0;
+    for (int i = 0; i < depth; ++i) {
+      const float d = x[row * depth + i] - mean;
+      variance += d * d / depth;
+    }
+    for (int i = 0; i < depth; ++i) {
+      expected.matrix<float>()(row, i) = (x[row * depth + i] - mean) /
+                                             std::sqrt(variance + 0.001f) *
+                                             scale[i] +
+                                         offset[i];
+    }
+  }
+  test::ExpectTensorNear<float>(expected, *GetOutput(0), 1e-5);
+}
+
+TEST_F(FusedLayerNormOpTest, RejectsMismatchedScale) {
+  TF_ASSERT_OK(InitFusedLayerNorm(0.001f));
+  AddInputFromArray<float>(TensorShape({1, 2}), {1, 2});
+  AddInputFromArray<float>(TensorShape({3}), {1, 1, 1});
+  AddInputFromArray<float>(TensorShape({2}), {0, 0});
+  EXPECT_FALSE(RunOpKernel().ok());
+}
+
+}  // namespace tensorflow
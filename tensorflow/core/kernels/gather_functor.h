@@ -33,6 +33,13 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+// Rows of a gather from a table of at least this many bytes per batch are
+// unlikely to be in cache, so the copies are bound by the latency of memory.
+// For those, the params row kGatherPrefetchDistance copies ahead is fetched,
+// rather than only the next one.
+constexpr int64 kGatherPrefetchMinTableBytes = 1 << 22;
+constexpr int64 kGatherPrefetchDistance = 8;
+
 // Helper method to copy using memcpy.
 template <typename T, typename Index, typename SliceIndex,
           SliceIndex static_slice_elems>
@@ -52,6 +59,10 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   }
   // Compute slice_bytes here so that static knowledge is available
   const size_t slice_bytes = slice_elems * sizeof(T);
+  const SliceIndex prefetch_distance =
+      static_cast<int64>(limit * slice_bytes) >= kGatherPrefetchMinTableBytes
+          ? kGatherPrefetchDistance
+          : 1;
   auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
   mutex mu;
   // Store the value of invalidate index for printing error information, it's a
@@ -69,8 +80,14 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
       SliceIndex b_next = batch_idx + 1;
       if ((batch_idx == batch_idx_end && i_next < indices_idx_end) ||
           (i_next < indices_size)) {
-        port::prefetch<port::PREFETCH_HINT_T0>(
-            &params(batch_idx, indices(i_next), 0));
+        const SliceIndex i_ahead = indices_idx + prefetch_distance;
+        if (i_ahead < indices_size) {
+          const Index index_ahead = indices(i_ahead);
+          if (FastBoundsCheck(index_ahead, limit)) {
+            port::prefetch<port::PREFETCH_HINT_T0>(
+                &params(batch_idx, index_ahead, 0));
+          }
+        }
         port::prefetch<port::PREFETCH_HINT_T0>(&out(batch_idx, i_next, 0));
         b_next = batch_idx;
       } else if (b_next <= batch_idx_end) {
@@ -22,7 +22,9 @@ limitations under the License.
 #include "google/protobuf/any.pb.h"
 #include "absl/algorithm/container.h"
 #include "absl/base/call_once.h"
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/platform/logger.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/autotuning.pb.h"
 #include "tensorflow/core/protobuf/conv_autotuning.pb.h"
 #include "tensorflow/core/util/env_var.h"
@@ -279,6 +281,82 @@ Status BestCudnnConvAlgorithm(absl::Span<const AutotuneResult> results,
   return Status::OK();
 }
 
+string AutotuneDeviceKeyForOrdinal(int device_ordinal) {
+  static mutex mu(LINKER_INITIALIZED);
+  static auto& device_keys TF_GUARDED_BY(mu) =
+      *new absl::flat_hash_map<int, string>();
+  mutex_lock lock(mu);
+  auto it = device_keys.find(device_ordinal);
+  if (it != device_keys.end()) return it->second;
+
+#if TENSORFLOW_USE_ROCM
+  auto platform_or =
+      se::MultiPlatformManager::PlatformWithId(se::rocm::kROCmPlatformId);
+#else
+  auto platform_or =
+      se::MultiPlatformManager::PlatformWithId(se::cuda::kCudaPlatformId);
+#endif
+  string device_key;
+  if (platform_or.ok()) {
+    auto stream_exec_or =
+        platform_or.ValueOrDie()->ExecutorForDevice(device_ordinal);
+    if (stream_exec_or.ok()) {
+      device_key = AutotuneDeviceKey(stream_exec_or.ValueOrDie());
+    }
+  }
+  device_keys[device_ordinal] = device_key;
+  return device_key;
+}
+
+bool AutotuneEntryFromConfig(const se::dnn::AlgorithmConfig& config,
+                             AutotuneDatabaseEntry* entry) {
+  if (!config.algorithm().has_value()) return false;
+  auto* conv = entry->mutable_result()->mutable_conv();
+  conv->set_algorithm(config.algorithm()->algo_id());
+  conv->set_tensor_ops_enabled(config.algorithm()->tensor_ops_enabled());
+  if (config.scratch_size().has_value()) {
+    entry->mutable_result()->set_scratch_bytes(*config.scratch_size());
+  }
+  if (config.algorithm_no_scratch().has_value()) {
+    auto* conv_no_scratch = entry->mutable_result_no_scratch()->mutable_conv();
+    conv_no_scratch->set_algorithm(config.algorithm_no_scratch()->algo_id());
+    conv_no_scratch->set_tensor_ops_enabled(
+        config.algorithm_no_scratch()->tensor_ops_enabled());
+  }
+  return true;
+}
+
+bool ConfigFromAutotuneEntry(const AutotuneDatabaseEntry& entry,
+                             se::dnn::AlgorithmConfig* config) {
+  if (!entry.result().has_conv()) return false;
+  se::dnn::AlgorithmConfig result;
+  result.set_algorithm({entry.result().conv().algorithm(),
+                        entry.result().conv().tensor_ops_enabled()});
+  if (entry.result().scratch_bytes() > 0) {
+    result.set_scratch_size(entry.result().scratch_bytes());
+  }
+  if (entry.result_no_scratch().has_conv()) {
+    result.set_algorithm_no_scratch(
+        {entry.result_no_scratch().conv().algorithm(),
+         entry.result_no_scratch().conv().tensor_ops_enabled()});
+  }
+  *config = result;
+  return true;
+}
+
+bool AutotuneEntryFromConfig(const se::blas::AlgorithmConfig& config,
+                             AutotuneDatabaseEntry* entry) {
+  entry->mutable_result()->mutable_gemm()->set_algorithm(config.algorithm());
+  return true;
+}
+
+bool ConfigFromAutotuneEntry(const AutotuneDatabaseEntry& entry,
+                             se::blas::AlgorithmConfig* config) {
+  if (!entry.result().has_gemm()) return false;
+  config->set_algorithm(entry.result().gemm().algorithm());
+  return true;
+}
+
 }  // namespace tensorflow
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -28,6 +28,8 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stream_executor.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+#include "tensorflow/core/util/autotune_database.h"
 
 namespace stream_executor {
 class RedzoneAllocator;
@@ -36,7 +38,6 @@ class RedzoneAllocator;
 namespace tensorflow {
 
 class NodeDef;
-class AutotuneResult;
 
 // Return whether the redzone check is disabled.
 //
@@ -66,6 +67,37 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
   return typed;
 }
 
+// Returns the AutotuneDeviceKey() of the GPU with the given ordinal, or an
+// empty string if there is no such GPU.
+string AutotuneDeviceKeyForOrdinal(int device_ordinal);
+
+// Hooks that let an AutoTuneMap keep its accepted configs in the global
+// AutotuneDatabase. GetAutotuneDeviceOrdinal() returns the GPU that `params`
+// are tuned for, and the other two convert configs to and from database
+// entries. These fallbacks opt out Parameters and Configs without overloads.
+template <typename Parameters>
+int GetAutotuneDeviceOrdinal(const Parameters& params) {
+  return -1;
+}
+template <typename Config>
+bool AutotuneEntryFromConfig(const Config& config,
+                             AutotuneDatabaseEntry* entry) {
+  return false;
+}
+template <typename Config>
+bool ConfigFromAutotuneEntry(const AutotuneDatabaseEntry& entry,
+                             Config* config) {
+  return false;
+}
+bool AutotuneEntryFromConfig(const se::dnn::AlgorithmConfig& config,
+                             AutotuneDatabaseEntry* entry);
+bool ConfigFromAutotuneEntry(const AutotuneDatabaseEntry& entry,
+                             se::dnn::AlgorithmConfig* config);
+bool AutotuneEntryFromConfig(const se::blas::AlgorithmConfig& config,
+                             AutotuneDatabaseEntry* entry);
+bool ConfigFromAutotuneEntry(const AutotuneDatabaseEntry& entry,
+                             se::blas::AlgorithmConfig* config);
+
 // A helper class that looks up the best autotuned config from parameters.
 // Due to the noisy nature of autotune, especially with multiple devices, it
 // only accepts a config if its margin exceeds a threshold.
@@ -76,12 +108,23 @@ inline se::DeviceMemory<T> AsDeviceMemory(const T* cuda_memory, uint64 size) {
 // back and forth randomly, the expected number of experiments before autotune
 // settles is O(threshold ^ 2). So we recommend that number of warmup runs
 // for any benchmarks.
+//
+// If TF_AUTOTUNE_DATABASE_FILE is set, accepted configs are also written to
+// the AutotuneDatabase, and configs found there are accepted right away, so
+// that later processes need not autotune again.
 template <typename Parameters, typename Config>
 class AutoTuneMap {
  public:
-  bool Find(const Parameters& params, Config* config) const {
+  bool Find(const Parameters& params, Config* config) {
     mutex_lock lock(mu_);
     auto iter = params_config_map_.find(params);
+    if (iter == params_config_map_.end() &&
+        LoadFromDatabase(params, config)) {
+      VLOG(1) << GetActionSummary("loads", params, *config);
+      params_config_map_.insert(std::make_pair(
+          params, ValueType{*config, min_score_threshold_, 1}));
+      return true;
+    }
     if (iter == params_config_map_.end() ||
         (iter->second.score < min_score_threshold_ &&
          iter->second.count <= max_autotune_count_)) {
@@ -121,6 +164,7 @@ class AutoTuneMap {
     }
     if (new_score >= min_score_threshold_) {
       VLOG(1) << GetActionSummary("accepts", params, config);
+      SaveToDatabase(params, config);
     } else if (autotune_global_count_ >= max_autotune_global_count_) {
       // The autotuning exceeds the max iteration threshold and we accept the
       // the winner if it exists in the map, otherwise we accept the current
@@ -133,12 +177,14 @@ class AutoTuneMap {
         }
         params_config_map_.insert(
             std::make_pair(params, ValueType{config, min_score_threshold_, 1}));
+        SaveToDatabase(params, config);
       } else {
         int promotes_times = min_score_threshold_ - winner->second.score;
         for (int i = 0; i < promotes_times; ++i) {
           VLOG(1) << GetActionSummary("promotes", params, config);
         }
         winner->second.score = min_score_threshold_;
+        SaveToDatabase(params, winner->second.config);
       }
       VLOG(1) << GetActionSummary("accepts", params, config);
     }
@@ -174,8 +220,39 @@ class AutoTuneMap {
     }
   };
 
+  // Returns the database and the device and key under which the config for
+  // `params` is stored in it, or nullptr if it is not persisted.
+  AutotuneDatabase* GetDatabaseKey(const Parameters& params, string* device,
+                                   string* key) const {
+    AutotuneDatabase* database = AutotuneDatabase::Global();
+    if (database == nullptr) return nullptr;
+    int device_ordinal = GetAutotuneDeviceOrdinal(params);
+    if (device_ordinal < 0) return nullptr;
+    *device = AutotuneDeviceKeyForOrdinal(device_ordinal);
+    if (device->empty()) return nullptr;
+    *key = strings::StrCat(name_, ": ", params.ToString());
+    return database;
+  }
+
+  bool LoadFromDatabase(const Parameters& params, Config* config) const {
+    string device, key;
+    AutotuneDatabase* database = GetDatabaseKey(params, &device, &key);
+    AutotuneDatabaseEntry entry;
+    return database != nullptr && database->Lookup(device, key, &entry) &&
+           ConfigFromAutotuneEntry(entry, config);
+  }
+
+  void SaveToDatabase(const Parameters& params, const Config& config) const {
+    AutotuneDatabaseEntry entry;
+    AutotuneDatabase* database =
+        GetDatabaseKey(params, entry.mutable_device(), entry.mutable_key());
+    if (database != nullptr && AutotuneEntryFromConfig(config, &entry)) {
+      database->Insert(entry);
+    }
+  }
+
   string GetActionSummary(StringPiece action, const Parameters& params,
-                          const Config& config) {
+                          const Config& config) const {
     return strings::Printf("autotune_map %s %s: %s -> (%s)", name_.c_str(),
                            string(action).c_str(), params.ToString().c_str(),
                            config.ToString().c_str());
@@ -0,0 +1,474 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/random/philox_random.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+
+////////////////////////////////////////////////////////////////////////////////
+// Kernel performance regression suite.                                       //
+//                                                                            //
+// A canonical set of shapes for the most frequently executed ops, each run   //
+// on CPU and (when built with GPU support) GPU. Benchmark names are stable,  //
+// and every result is written through TestReporter when                      //
+// TEST_REPORT_FILE_PREFIX is set, so runs can be compared against a stored   //
+// baseline. Items processed are FLOPs for contractions and convolutions and  //
+// output elements for everything else.                                       //
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+Tensor RandomTensor(DataType dtype, const TensorShape& shape) {
+  Tensor tensor(dtype, shape);
+  switch (dtype) {
+    case DT_FLOAT:
+      tensor.flat<float>().setRandom();
+      break;
+    case DT_BOOL:
+      for (int64 i = 0; i < tensor.NumElements(); ++i) {
+        tensor.flat<bool>()(i) = i % 3 == 0;
+      }
+      break;
+    default:
+      LOG(FATAL) << "Unsupported type " << DataTypeString(dtype);
+  }
+  return tensor;
+}
+
+Node* RandomFloat(Graph* g, const TensorShape& shape) {
+  return test::graph::Constant(g, RandomTensor(DT_FLOAT, shape));
+}
+
+Node* Int32Vector(Graph* g, const std::vector<int32>& values) {
+  Tensor tensor(DT_INT32, TensorShape({static_cast<int64>(values.size())}));
+  for (int i = 0; i < values.size(); ++i) tensor.flat<int32>()(i) = values[i];
+  return test::graph::Constant(g, tensor);
+}
+
+Node* Int32Matrix(Graph* g, int rows, const std::vector<int32>& values) {
+  Tensor tensor(DT_INT32, TensorShape({rows, static_cast<int64>(
+                                                 values.size() / rows)}));
+  for (int i = 0; i < values.size(); ++i) tensor.flat<int32>()(i) = values[i];
+  return test::graph::Constant(g, tensor);
+}
+
+std::vector<NodeBuilder::NodeOut> NodeOuts(const std::vector<Node*>& nodes) {
+  return std::vector<NodeBuilder::NodeOut>(nodes.begin(), nodes.end());
+}
+
+void RunCase(int iters, const string& device, Graph* g, int64 items_per_iter) {
+  testing::UseRealTime();
+  testing::ItemsProcessed(static_cast<int64>(iters) * items_per_iter);
+  test::Benchmark(device, g).Run(iters);
+}
+
+// Graph builders. Each returns a new graph with constant inputs feeding a
+// single node of the op under test.
+
+Graph* MatMulGraph(int m, int k, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Matmul(g, RandomFloat(g, {m, k}), RandomFloat(g, {k, n}), false,
+                      false);
+  return g;
+}
+
+Graph* BatchMatMulGraph(int batch, int m, int k, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::BatchMatmul(g, RandomFloat(g, {batch, m, k}),
+                           RandomFloat(g, {batch, k, n}), false, false);
+  return g;
+}
+
+Graph* FusedMatMulGraph(int m, int k, int n) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "_FusedMatMul")
+                  .Input(RandomFloat(g, {m, k}))
+                  .Input(RandomFloat(g, {k, n}))
+                  .Input(NodeOuts({RandomFloat(g, {n})}))
+                  .Attr("num_args", 1)
+                  .Attr("T", DT_FLOAT)
+                  .Attr("fused_ops", {"BiasAdd", "Relu"})
+                  .Finalize(g, &ret));
+  return g;
+}
+
+Graph* ConvGraph(const string& op, int batch, int size, int in_depth,
+                 int filter_size, int out_depth, int stride) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), op)
+          .Input(RandomFloat(g, {batch, size, size, in_depth}))
+          .Input(RandomFloat(g, {filter_size, filter_size, in_depth, out_depth}))
+          .Attr("T", DT_FLOAT)
+          .Attr("strides", {1, stride, stride, 1})
+          .Attr("padding", "SAME")
+          .Finalize(g, &ret));
+  return g;
+}
+
+Graph* Conv2DBackpropInputGraph(int batch, int size, int in_depth,
+                                int filter_size, int out_depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "Conv2DBackpropInput")
+          .Input(Int32Vector(g, {batch, size, size, in_depth}))
+          .Input(RandomFloat(g, {filter_size, filter_size, in_depth, out_depth}))
+          .Input(RandomFloat(g, {batch, size, size, out_depth}))
+          .Attr("T", DT_FLOAT)
+          .Attr("strides", {1, 1, 1, 1})
+          .Attr("padding", "SAME")
+          .Finalize(g, &ret));
+  return g;
+}
+
+Graph* Conv2DBackpropFilterGraph(int batch, int size, int in_depth,
+                                 int filter_size, int out_depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "Conv2DBackpropFilter")
+          .Input(RandomFloat(g, {batch, size, size, in_depth}))
+          .Input(Int32Vector(g, {filter_size, filter_size, in_depth, out_depth}))
+          .Input(RandomFloat(g, {batch, size, size, out_depth}))
+          .Attr("T", DT_FLOAT)
+          .Attr("strides", {1, 1, 1, 1})
+          .Attr("padding", "SAME")
+          .Finalize(g, &ret));
+  return g;
+}
+
+Graph* FusedConv2DGraph(int batch, int size, int in_depth, int filter_size,
+                        int out_depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(
+      NodeBuilder(g->NewName("n"), "_FusedConv2D")
+          .Input(RandomFloat(g, {batch, size, size, in_depth}))
+          .Input(RandomFloat(g, {filter_size, filter_size, in_depth, out_depth}))
+          .Input(NodeOuts({RandomFloat(g, {out_depth})}))
+          .Attr("num_args", 1)
+          .Attr("T", DT_FLOAT)
+          .Attr("strides", {1, 1, 1, 1})
+          .Attr("padding", "SAME")
+          .Attr("fused_ops", {"BiasAdd", "Relu"})
+          .Finalize(g, &ret));
+  return g;
+}
+
+Graph* BiasAddGraph(int batch, int size, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::BiasAdd(g, RandomFloat(g, {batch, size, size, depth}),
+                       RandomFloat(g, {depth}));
+  return g;
+}
+
+Graph* BiasAddGradGraph(int batch, int size, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, "BiasAddGrad",
+                     RandomFloat(g, {batch, size, size, depth}));
+  return g;
+}
+
+Graph* FusedBatchNormGraph(int batch, int size, int depth, bool is_training) {
+  Graph* g = new Graph(OpRegistry::Global());
+  const TensorShape stats_shape({is_training ? 0 : depth});
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "FusedBatchNormV3")
+                  .Input(RandomFloat(g, {batch, size, size, depth}))
+                  .Input(RandomFloat(g, {depth}))
+                  .Input(RandomFloat(g, {depth}))
+                  .Input(RandomFloat(g, stats_shape))
+                  .Input(RandomFloat(g, stats_shape))
+                  .Attr("T", DT_FLOAT)
+                  .Attr("U", DT_FLOAT)
+                  .Attr("is_training", is_training)
+                  .Finalize(g, &ret));
+  return g;
+}
+
+Graph* PoolGraph(const string& op, int batch, int size, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), op)
+                  .Input(RandomFloat(g, {batch, size, size, depth}))
+                  .Attr("T", DT_FLOAT)
+                  .Attr("ksize", {1, 3, 3, 1})
+                  .Attr("strides", {1, 2, 2, 1})
+                  .Attr("padding", "SAME")
+                  .Finalize(g, &ret));
+  return g;
+}
+
+Graph* UnaryGraph(const string& op, const TensorShape& shape) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Unary(g, op, RandomFloat(g, shape));
+  return g;
+}
+
+Graph* CastGraph(const TensorShape& shape, DataType dst) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Cast(g, RandomFloat(g, shape), dst);
+  return g;
+}
+
+Graph* BinaryGraph(const string& op, const TensorShape& lhs,
+                   const TensorShape& rhs) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Binary(g, op, RandomFloat(g, lhs), RandomFloat(g, rhs));
+  return g;
+}
+
+Graph* ReduceGraph(const string& op, const TensorShape& shape,
+                   const std::vector<int32>& axes) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Reduce(g, op, RandomFloat(g, shape), Int32Vector(g, axes),
+                      false);
+  return g;
+}
+
+Graph* ArgMaxGraph(int rows, int cols) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Multi(g, "ArgMax",
+                     {RandomFloat(g, {rows, cols}),
+                      test::graph::Constant(g, test::AsScalar<int32>(1))});
+  return g;
+}
+
+Graph* GatherGraph(int num_params, int depth, int num_indices) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor indices(DT_INT32, TensorShape({num_indices}));
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (int i = 0; i < num_indices; ++i) {
+    indices.flat<int32>()(i) = rnd.Uniform(num_params);
+  }
+  test::graph::Gather(g, RandomFloat(g, {num_params, depth}),
+                      test::graph::Constant(g, indices),
+                      test::graph::Constant(g, test::AsScalar<int32>(0)));
+  return g;
+}
+
+Graph* ConcatGraph(int num_inputs, int rows, int cols, int axis) {
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<Node*> inputs;
+  for (int i = 0; i < num_inputs; ++i) {
+    inputs.push_back(RandomFloat(g, {rows, cols}));
+  }
+  test::graph::ConcatV2(g, inputs,
+                        test::graph::Constant(g, test::AsScalar<int32>(axis)));
+  return g;
+}
+
+Graph* TransposeGraph(const TensorShape& shape,
+                      const std::vector<int32>& perm) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Multi(g, "Transpose",
+                     {RandomFloat(g, shape), Int32Vector(g, perm)});
+  return g;
+}
+
+Graph* SliceGraph(int rows, int cols) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Multi(g, "Slice",
+                     {RandomFloat(g, {rows, cols}), Int32Vector(g, {0, 1}),
+                      Int32Vector(g, {rows / 2, cols - 1})});
+  return g;
+}
+
+Graph* TileGraph(int rows, int cols, int multiple) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Multi(
+      g, "Tile",
+      {RandomFloat(g, {rows, cols}), Int32Vector(g, {multiple, multiple})});
+  return g;
+}
+
+Graph* PadGraph(int batch, int size, int depth) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Multi(g, "Pad",
+                     {RandomFloat(g, {batch, size, size, depth}),
+                      Int32Matrix(g, 4, {0, 0, 1, 1, 1, 1, 0, 0})});
+  return g;
+}
+
+Graph* SelectGraph(int rows, int cols) {
+  Graph* g = new Graph(OpRegistry::Global());
+  test::graph::Select(
+      g, test::graph::Constant(g, RandomTensor(DT_BOOL, {rows, cols})),
+      RandomFloat(g, {rows, cols}), RandomFloat(g, {rows, cols}));
+  return g;
+}
+
+Graph* AddNGraph(int num_inputs, int rows, int cols) {
+  Graph* g = new Graph(OpRegistry::Global());
+  std::vector<Node*> inputs;
+  for (int i = 0; i < num_inputs; ++i) {
+    inputs.push_back(RandomFloat(g, {rows, cols}));
+  }
+  Node* ret;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "AddN")
+                  .Input(NodeOuts(inputs))
+                  .Finalize(g, &ret));
+  return g;
+}
+
+int64 MatMulFlops(int64 m, int64 k, int64 n) { return 2 * m * k * n; }
+
+int64 ConvFlops(int64 batch, int64 size, int64 in_depth, int64 filter_size,
+                int64 out_depth, int64 stride) {
+  return 2 * batch * (size / stride) * (size / stride) * out_depth *
+         filter_size * filter_size * in_depth;
+}
+
+}  // namespace
+
+#define BM_SUITE_DEV(NAME, DEVICE, GRAPH, ITEMS)       \
+  static void BM_Suite_##NAME##_##DEVICE(int iters) { \
+    RunCase(iters, #DEVICE, GRAPH, ITEMS);            \
+  }                                                   \
+  BENCHMARK(BM_Suite_##NAME##_##DEVICE);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+#define BM_SUITE_GPU(NAME, GRAPH, ITEMS) BM_SUITE_DEV(NAME, gpu, GRAPH, ITEMS)
+#else
+#define BM_SUITE_GPU(NAME, GRAPH, ITEMS)
+#endif
+
+#define BM_SUITE(NAME, GRAPH, ITEMS)     \
+  BM_SUITE_DEV(NAME, cpu, GRAPH, ITEMS) \
+  BM_SUITE_GPU(NAME, GRAPH, ITEMS)
+
+// Ops that only have CPU kernels.
+#define BM_SUITE_CPU(NAME, GRAPH, ITEMS) BM_SUITE_DEV(NAME, cpu, GRAPH, ITEMS)
+
+// Contractions.
+BM_SUITE(MatMul_1x1024x1024, MatMulGraph(1, 1024, 1024),
+         MatMulFlops(1, 1024, 1024));
+BM_SUITE(MatMul_128x1024x1024, MatMulGraph(128, 1024, 1024),
+         MatMulFlops(128, 1024, 1024));
+BM_SUITE(MatMul_1024x1024x1024, MatMulGraph(1024, 1024, 1024),
+         MatMulFlops(1024, 1024, 1024));
+BM_SUITE(MatMul_4096x512x4096, MatMulGraph(4096, 512, 4096),
+         MatMulFlops(4096, 512, 4096));
+BM_SUITE(BatchMatMul_32x128x64x128, BatchMatMulGraph(32, 128, 64, 128),
+         32 * MatMulFlops(128, 64, 128));
+BM_SUITE_CPU(FusedMatMulBiasRelu_128x1024x1024,
+             FusedMatMulGraph(128, 1024, 1024), MatMulFlops(128, 1024, 1024));
+
+// Convolutions, NHWC with HWIO filters.
+BM_SUITE(Conv2D_32x56x56x64_3x3x64, ConvGraph("Conv2D", 32, 56, 64, 3, 64, 1),
+         ConvFlops(32, 56, 64, 3, 64, 1));
+BM_SUITE(Conv2D_32x28x28x128_3x3x128,
+         ConvGraph("Conv2D", 32, 28, 128, 3, 128, 1),
+         ConvFlops(32, 28, 128, 3, 128, 1));
+BM_SUITE(Conv2D_32x7x7x512_1x1x2048,
+         ConvGraph("Conv2D", 32, 7, 512, 1, 2048, 1),
+         ConvFlops(32, 7, 512, 1, 2048, 1));
+BM_SUITE(Conv2D_32x224x224x3_7x7x64_s2,
+         ConvGraph("Conv2D", 32, 224, 3, 7, 64, 2),
+         ConvFlops(32, 224, 3, 7, 64, 2));
+BM_SUITE(Conv2DBackpropInput_32x28x28x128_3x3x128,
+         Conv2DBackpropInputGraph(32, 28, 128, 3, 128),
+         ConvFlops(32, 28, 128, 3, 128, 1));
+BM_SUITE(Conv2DBackpropFilter_32x28x28x128_3x3x128,
+         Conv2DBackpropFilterGraph(32, 28, 128, 3, 128),
+         ConvFlops(32, 28, 128, 3, 128, 1));
+BM_SUITE(DepthwiseConv2d_32x56x56x64_3x3,
+         ConvGraph("DepthwiseConv2dNative", 32, 56, 64, 3, 1, 1),
+         2 * 32 * 56 * 56 * 64 * 3 * 3);
+BM_SUITE(FusedConv2DBiasRelu_32x56x56x64_3x3x64,
+         FusedConv2DGraph(32, 56, 64, 3, 64), ConvFlops(32, 56, 64, 3, 64, 1));
+
+// Bias, normalization and pooling.
+BM_SUITE(BiasAdd_32x56x56x64, BiasAddGraph(32, 56, 64), 32 * 56 * 56 * 64);
+BM_SUITE(BiasAddGrad_32x56x56x64, BiasAddGradGraph(32, 56, 64),
+         32 * 56 * 56 * 64);
+BM_SUITE(FusedBatchNormInference_32x56x56x64,
+         FusedBatchNormGraph(32, 56, 64, false), 32 * 56 * 56 * 64);
+BM_SUITE(FusedBatchNormTraining_32x56x56x64,
+         FusedBatchNormGraph(32, 56, 64, true), 32 * 56 * 56 * 64);
+BM_SUITE(MaxPool_32x112x112x64_3x3_s2, PoolGraph("MaxPool", 32, 112, 64),
+         32 * 56 * 56 * 64);
+BM_SUITE(AvgPool_32x112x112x64_3x3_s2, PoolGraph("AvgPool", 32, 112, 64),
+         32 * 56 * 56 * 64);
+
+// Element-wise unary ops on 1M elements.
+BM_SUITE(Relu_1M, UnaryGraph("Relu", {1024, 1024}), 1 << 20);
+BM_SUITE(Relu6_1M, UnaryGraph("Relu6", {1024, 1024}), 1 << 20);
+BM_SUITE(Sigmoid_1M, UnaryGraph("Sigmoid", {1024, 1024}), 1 << 20);
+BM_SUITE(Tanh_1M, UnaryGraph("Tanh", {1024, 1024}), 1 << 20);
+BM_SUITE(Exp_1M, UnaryGraph("Exp", {1024, 1024}), 1 << 20);
+BM_SUITE(Log_1M, UnaryGraph("Log", {1024, 1024}), 1 << 20);
+BM_SUITE(Rsqrt_1M, UnaryGraph("Rsqrt", {1024, 1024}), 1 << 20);
+BM_SUITE(Square_1M, UnaryGraph("Square", {1024, 1024}), 1 << 20);
+BM_SUITE(Softmax_1024x1024, UnaryGraph("Softmax", {1024, 1024}), 1 << 20);
+BM_SUITE(CastToHalf_1M, CastGraph({1024, 1024}, DT_HALF), 1 << 20);
+
+// Element-wise binary ops on 1M elements.
+BM_SUITE(Add_1M, BinaryGraph("Add", {1024, 1024}, {1024, 1024}), 1 << 20);
+BM_SUITE(AddRowBroadcast_1M, BinaryGraph("Add", {1024, 1024}, {1024}),
+         1 << 20);
+BM_SUITE(AddColumnBroadcast_1M, BinaryGraph("Add", {1024, 1024}, {1024, 1}),
+         1 << 20);
+BM_SUITE(Sub_1M, BinaryGraph("Sub", {1024, 1024}, {1024, 1024}), 1 << 20);
+BM_SUITE(Mul_1M, BinaryGraph("Mul", {1024, 1024}, {1024, 1024}), 1 << 20);
+BM_SUITE(RealDiv_1M, BinaryGraph("RealDiv", {1024, 1024}, {1024, 1024}),
+         1 << 20);
+BM_SUITE(Maximum_1M, BinaryGraph("Maximum", {1024, 1024}, {1024, 1024}),
+         1 << 20);
+BM_SUITE(SquaredDifference_1M,
+         BinaryGraph("SquaredDifference", {1024, 1024}, {1024, 1024}), 1 << 20);
+BM_SUITE(Select_1M, SelectGraph(1024, 1024), 1 << 20);
+BM_SUITE(AddN_4x1M, AddNGraph(4, 1024, 1024), 1 << 20);
+
+// Reductions.
+BM_SUITE(SumRows_1024x1024, ReduceGraph("Sum", {1024, 1024}, {1}), 1 << 20);
+BM_SUITE(SumColumns_1024x1024, ReduceGraph("Sum", {1024, 1024}, {0}), 1 << 20);
+BM_SUITE(SumAll_1024x1024, ReduceGraph("Sum", {1024, 1024}, {0, 1}), 1 << 20);
+BM_SUITE(SumSpatial_32x56x56x64, ReduceGraph("Sum", {32, 56, 56, 64}, {1, 2}),
+         32 * 56 * 56 * 64);
+BM_SUITE(MeanRows_1024x1024, ReduceGraph("Mean", {1024, 1024}, {1}), 1 << 20);
+BM_SUITE(MaxRows_1024x1024, ReduceGraph("Max", {1024, 1024}, {1}), 1 << 20);
+BM_SUITE(ArgMaxRows_1024x1024, ArgMaxGraph(1024, 1024), 1 << 20);
+BM_SUITE(L2Loss_1M, UnaryGraph("L2Loss", {1024, 1024}), 1 << 20);
+
+// Data movement.
+BM_SUITE(Gather_100000x128_32768, GatherGraph(100000, 128, 32768),
+         32768 * 128);
+BM_SUITE(ConcatRows_4x256x1024, ConcatGraph(4, 256, 1024, 0), 1 << 20);
+BM_SUITE(ConcatColumns_4x1024x256, ConcatGraph(4, 1024, 256, 1), 1 << 20);
+BM_SUITE(Transpose2D_1024x1024, TransposeGraph({1024, 1024}, {1, 0}), 1 << 20);
+BM_SUITE(TransposeNHWCToNCHW_32x56x56x64,
+         TransposeGraph({32, 56, 56, 64}, {0, 3, 1, 2}), 32 * 56 * 56 * 64);
+BM_SUITE(Slice_1024x1024, SliceGraph(1024, 1024), 512 * 1023);
+BM_SUITE(Tile_256x256_4x4, TileGraph(256, 256, 4), 1 << 20);
+BM_SUITE(Pad_32x56x56x64, PadGraph(32, 56, 64), 32 * 58 * 58 * 64);
+
+}  // namespace tensorflow
@@ -16,9 +16,11 @@ limitations under the License.
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -30,11 +32,26 @@ limitations under the License.
 namespace tensorflow {
 namespace lookup {
 
-// Lookup table that wraps an unordered_map, where the key and value data type
+namespace {
+
+template <typename T>
+inline uint64 HashScalar(const T& key) {
+  return static_cast<uint64>(key);
+}
+
+inline uint64 HashScalar(const tstring& key) { return Hash64(key); }
+
+}  // namespace
+
+// Lookup table that wraps a flat_hash_map, where the key and value data type
 // is specified. Each individual value must be a scalar. If vector values are
 // required, use MutableHashTableOfTensors.
 //
 // This table is mutable and thread safe - Insert can be called at any time.
+// The entries are striped over kNumShards open-addressing maps that each have
+// their own lock, so that concurrent lookups and inserts don't all contend on
+// one mutex. A Find, Insert or Remove is atomic within each shard but not
+// across shards; Import and Export lock all shards.
 //
 // Sample use case:
 //
@@ -50,8 +67,12 @@ class MutableHashTableOfScalars final : public LookupInterface {
   MutableHashTableOfScalars(OpKernelContext* ctx, OpKernel* kernel) {}
 
   size_t size() const override {
-    tf_shared_lock l(mu_);
-    return table_.size();
+    size_t size = 0;
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      size += shard.table.size();
+    }
+    return size;
   }
 
   Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
@@ -60,26 +81,40 @@ class MutableHashTableOfScalars final : public LookupInterface {
     const auto key_values = key.flat<K>();
     auto value_values = value->flat<V>();
 
-    tf_shared_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      value_values(i) = gtl::FindWithDefault(
-          table_, SubtleMustCopyIfIntegral(key_values(i)), default_val);
+    ShardedIndices indices(key_values);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (indices.empty(s)) continue;
+      const Shard& shard = shards_[s];
+      tf_shared_lock l(shard.mu);
+      for (const int64* i = indices.begin(s); i != indices.end(s); ++i) {
+        value_values(*i) = gtl::FindWithDefault(
+            shard.table, SubtleMustCopyIfIntegral(key_values(*i)), default_val);
+      }
     }
 
     return Status::OK();
   }
 
-  Status DoInsert(bool clear, const Tensor& keys, const Tensor& values) {
+  Status DoInsert(bool clear, const Tensor& keys, const Tensor& values)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
     const auto key_values = keys.flat<K>();
     const auto value_values = values.flat<V>();
 
-    mutex_lock l(mu_);
+    ShardedIndices indices(key_values);
     if (clear) {
-      table_.clear();
+      // Replace the whole contents at once, as seen by any other op.
+      for (Shard& shard : shards_) shard.mu.lock();
+      for (int s = 0; s < kNumShards; ++s) {
+        shards_[s].table.clear();
+        InsertIntoShard(indices, s, key_values, value_values);
+      }
+      for (Shard& shard : shards_) shard.mu.unlock();
+      return Status::OK();
     }
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      gtl::InsertOrUpdate(&table_, SubtleMustCopyIfIntegral(key_values(i)),
-                          SubtleMustCopyIfIntegral(value_values(i)));
+    for (int s = 0; s < kNumShards; ++s) {
+      if (indices.empty(s)) continue;
+      mutex_lock l(shards_[s].mu);
+      InsertIntoShard(indices, s, key_values, value_values);
     }
     return Status::OK();
   }
@@ -92,9 +127,14 @@ class MutableHashTableOfScalars final : public LookupInterface {
   Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
     const auto key_values = keys.flat<K>();
 
-    mutex_lock l(mu_);
-    for (int64 i = 0; i < key_values.size(); ++i) {
-      table_.erase(SubtleMustCopyIfIntegral(key_values(i)));
+    ShardedIndices indices(key_values);
+    for (int s = 0; s < kNumShards; ++s) {
+      if (indices.empty(s)) continue;
+      Shard& shard = shards_[s];
+      mutex_lock l(shard.mu);
+      for (const int64* i = indices.begin(s); i != indices.end(s); ++i) {
+        shard.table.erase(SubtleMustCopyIfIntegral(key_values(*i)));
+      }
     }
     return Status::OK();
   }
@@ -104,25 +144,33 @@ class MutableHashTableOfScalars final : public LookupInterface {
     return DoInsert(true, keys, values);
   }
 
-  Status ExportValues(OpKernelContext* ctx) override {
-    tf_shared_lock l(mu_);
-    int64 size = table_.size();
+  Status ExportValues(OpKernelContext* ctx) override
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    // Export a consistent snapshot of all shards.
+    for (const Shard& shard : shards_) shard.mu.lock_shared();
+    int64 size = 0;
+    for (const Shard& shard : shards_) size += shard.table.size();
 
     Tensor* keys;
     Tensor* values;
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("keys", TensorShape({size}), &keys));
-    TF_RETURN_IF_ERROR(
-        ctx->allocate_output("values", TensorShape({size}), &values));
-
-    auto keys_data = keys->flat<K>();
-    auto values_data = values->flat<V>();
-    int64 i = 0;
-    for (auto it = table_.begin(); it != table_.end(); ++it, ++i) {
-      keys_data(i) = it->first;
-      values_data(i) = it->second;
+    Status status = ctx->allocate_output("keys", TensorShape({size}), &keys);
+    if (status.ok()) {
+      status = ctx->allocate_output("values", TensorShape({size}), &values);
     }
-    return Status::OK();
+    if (status.ok()) {
+      auto keys_data = keys->flat<K>();
+      auto values_data = values->flat<V>();
+      int64 i = 0;
+      for (const Shard& shard : shards_) {
+        for (auto it = shard.table.begin(); it != shard.table.end();
+             ++it, ++i) {
+          keys_data(i) = it->first;
+          values_data(i) = it->second;
+        }
+      }
+    }
+    for (const Shard& shard : shards_) shard.mu.unlock_shared();
+    return status;
   }
 
   DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
@@ -135,21 +183,81 @@ class MutableHashTableOfScalars final : public LookupInterface {
 
   int64 MemoryUsed() const override {
     int64 ret = 0;
-    tf_shared_lock l(mu_);
-    for (unsigned i = 0; i < table_.bucket_count(); ++i) {
-      size_t bucket_size = table_.bucket_size(i);
-      if (bucket_size == 0) {
-        ret++;
-      } else {
-        ret += bucket_size;
-      }
+    for (const Shard& shard : shards_) {
+      tf_shared_lock l(shard.mu);
+      // Each slot holds an entry and one byte of control metadata.
+      ret += shard.table.capacity() *
+             (sizeof(typename decltype(shard.table)::value_type) + 1);
     }
     return sizeof(MutableHashTableOfScalars) + ret;
   }
 
  private:
-  mutable mutex mu_;
-  std::unordered_map<K, V> table_ TF_GUARDED_BY(mu_);
+  static constexpr int kNumShardBits = 4;
+  static constexpr int kNumShards = 1 << kNumShardBits;
+
+  // Aligned to keep the locks of different shards off the same cache line.
+  struct alignas(64) Shard {
+    mutable mutex mu;
+    absl::flat_hash_map<K, V> table TF_GUARDED_BY(mu);
+  };
+
+  // Returns the shard of `key`. The multiplication mixes all bits of the key
+  // hash, which is the integer key itself for integral keys, into the top
+  // bits.
+  static int ShardOf(const K& key) {
+    return (HashScalar(key) * 0x9E3779B97F4A7C15ull) >> (64 - kNumShardBits);
+  }
+
+  // The indices of a batch of keys grouped by their shard, in their original
+  // order within each shard, so that each shard is locked once per batch.
+  class ShardedIndices {
+   public:
+    explicit ShardedIndices(typename TTypes<K>::ConstFlat keys)
+        : indices_(keys.size()) {
+      std::vector<uint8> shards(keys.size());
+      int64 counts[kNumShards] = {};
+      for (int64 i = 0; i < keys.size(); ++i) {
+        shards[i] = ShardOf(SubtleMustCopyIfIntegral(keys(i)));
+        ++counts[shards[i]];
+      }
+      offsets_[0] = 0;
+      for (int s = 0; s < kNumShards; ++s) {
+        offsets_[s + 1] = offsets_[s] + counts[s];
+      }
+      int64 next[kNumShards];
+      std::copy(offsets_, offsets_ + kNumShards, next);
+      for (int64 i = 0; i < keys.size(); ++i) indices_[next[shards[i]]++] = i;
+    }
+
+    bool empty(int shard) const {
+      return offsets_[shard] == offsets_[shard + 1];
+    }
+    const int64* begin(int shard) const {
+      return indices_.data() + offsets_[shard];
+    }
+    const int64* end(int shard) const {
+      return indices_.data() + offsets_[shard + 1];
+    }
+
+   private:
+    std::vector<int64> indices_;
+    int64 offsets_[kNumShards + 1];
+  };
+
+  void InsertIntoShard(const ShardedIndices& indices, int s,
+                       typename TTypes<K>::ConstFlat key_values,
+                       typename TTypes<V>::ConstFlat value_values)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    Shard& shard = shards_[s];
+    for (const int64* i = indices.begin(s); i != indices.end(s); ++i) {
+      gtl::InsertOrUpdate(&shard.table,
+                          SubtleMustCopyIfIntegral(key_values(*i)),
+                          SubtleMustCopyIfIntegral(value_values(*i)));
+    }
+  }
+
+  Shard shards_[kNumShards];
 };
 
 // Lookup table that wraps an unordered_map. Behaves identical to
@@ -294,13 +402,6 @@ class MutableHashTableOfTensors final : public LookupInterface {
 
 namespace {
 
-template <typename T>
-inline uint64 HashScalar(const T& key) {
-  return static_cast<uint64>(key);
-}
-
-inline uint64 HashScalar(const tstring& key) { return Hash64(key); }
-
 // If the given shape is a scalar return {1} instead. Otherwise leave it alone.
 TensorShape MaybeVectorizeShape(const TensorShape& shape) {
   if (shape.dims() == 0) {
@@ -0,0 +1,399 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mapped_lookup_table.h"
+
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/kernels/lookup_table_op.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
+#include "tensorflow/core/platform/byte_order.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+constexpr char kMagic[8] = {'T', 'F', 'M', 'A', 'P', 'T', 'B', 'L'};
+constexpr uint32 kVersion = 1;
+
+struct FileHeader {
+  char magic[8];
+  uint32 version;
+  int32 key_dtype;
+  int32 value_dtype;
+  uint32 reserved;
+  uint64 num_entries;
+  uint64 num_slots;
+  uint64 num_strings;
+};
+static_assert(sizeof(FileHeader) == 48, "Unexpected FileHeader padding");
+
+using Slot = MappedLookupTableFile::Slot;
+static_assert(sizeof(Slot) == 24, "Unexpected Slot padding");
+
+bool IsSupportedKeyType(DataType dtype) {
+  return dtype == DT_INT64 || dtype == DT_STRING;
+}
+
+bool IsSupportedValueType(DataType dtype) {
+  return dtype == DT_INT32 || dtype == DT_INT64 || dtype == DT_FLOAT ||
+         dtype == DT_DOUBLE || dtype == DT_STRING;
+}
+
+// Zero marks empty slots, so it is never stored as the hash of a key.
+uint64 StoredHash(uint64 hash) { return hash == 0 ? 1 : hash; }
+
+uint64 KeyHash(int64 key) {
+  return StoredHash(
+      Fingerprint64(StringPiece(reinterpret_cast<char*>(&key), sizeof(key))));
+}
+
+uint64 KeyHash(StringPiece key) { return StoredHash(Fingerprint64(key)); }
+
+// Encodes scalars in the 8 bytes of a slot field.
+uint64 EncodeScalar(int32 v) { return static_cast<uint64>(int64{v}); }
+uint64 EncodeScalar(int64 v) { return static_cast<uint64>(v); }
+uint64 EncodeScalar(float v) {
+  uint32 bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+uint64 EncodeScalar(double v) {
+  uint64 bits;
+  std::memcpy(&bits, &v, sizeof(bits));
+  return bits;
+}
+
+// Collects the strings of a table into its string table.
+class StringTableBuilder {
+ public:
+  uint64 Add(StringPiece s) {
+    offsets_.push_back(bytes_.size() + s.size());
+    bytes_.append(s.data(), s.size());
+    return offsets_.size() - 2;
+  }
+
+  uint64 num_strings() const { return offsets_.size() - 1; }
+  const std::vector<uint64>& offsets() const { return offsets_; }
+  const string& bytes() const { return bytes_; }
+
+ private:
+  std::vector<uint64> offsets_ = {0};
+  string bytes_;
+};
+
+template <typename V>
+void EncodeValues(const Tensor& values, StringTableBuilder* strings,
+                  std::vector<uint64>* encoded) {
+  const auto flat = values.flat<V>();
+  for (int64 i = 0; i < flat.size(); ++i) {
+    encoded->push_back(EncodeScalar(flat(i)));
+  }
+}
+
+template <>
+void EncodeValues<tstring>(const Tensor& values, StringTableBuilder* strings,
+                           std::vector<uint64>* encoded) {
+  const auto flat = values.flat<tstring>();
+  for (int64 i = 0; i < flat.size(); ++i) {
+    encoded->push_back(strings->Add(flat(i)));
+  }
+}
+
+StringPiece AsBytes(const void* data, size_t size) {
+  return StringPiece(static_cast<const char*>(data), size);
+}
+
+}  // namespace
+
+Status MappedLookupTableFile::Open(
+    Env* env, const string& filename,
+    std::unique_ptr<MappedLookupTableFile>* file) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Mapped lookup tables are only supported on little-endian hosts");
+  }
+  std::unique_ptr<MappedLookupTableFile> result(new MappedLookupTableFile);
+  TF_RETURN_IF_ERROR(
+      env->NewReadOnlyMemoryRegionFromFile(filename, &result->region_));
+  const char* data = static_cast<const char*>(result->region_->data());
+  const uint64 length = result->region_->length();
+
+  FileHeader header;
+  if (length < sizeof(header)) {
+    return errors::DataLoss("Lookup table file ", filename,
+                            " is too short: ", length, " bytes");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return errors::DataLoss(filename, " is not a lookup table file");
+  }
+  if (header.version != kVersion) {
+    return errors::DataLoss("Lookup table file ", filename,
+                            " has unsupported version ", header.version);
+  }
+  result->key_dtype_ = static_cast<DataType>(header.key_dtype);
+  result->value_dtype_ = static_cast<DataType>(header.value_dtype);
+  if (!IsSupportedKeyType(result->key_dtype_) ||
+      !IsSupportedValueType(result->value_dtype_)) {
+    return errors::DataLoss("Lookup table file ", filename,
+                            " has unsupported key or value type");
+  }
+
+  // Check the section sizes against the file length one at a time, so that
+  // none of the products below can overflow.
+  const uint64 num_slots = header.num_slots;
+  uint64 remaining = length - sizeof(header);
+  if (num_slots == 0 || (num_slots & (num_slots - 1)) != 0 ||
+      header.num_entries > num_slots / 2 ||
+      num_slots > remaining / sizeof(Slot)) {
+    return errors::DataLoss("Lookup table file ", filename,
+                            " has an invalid number of slots");
+  }
+  remaining -= num_slots * sizeof(Slot);
+  if (header.num_strings >= remaining / sizeof(uint64)) {
+    return errors::DataLoss("Lookup table file ", filename,
+                            " has an invalid number of strings");
+  }
+  remaining -= (header.num_strings + 1) * sizeof(uint64);
+
+  result->num_entries_ = header.num_entries;
+  result->num_slots_ = num_slots;
+  result->num_strings_ = header.num_strings;
+  result->strings_size_ = remaining;
+  result->slots_ = reinterpret_cast<const Slot*>(data + sizeof(header));
+  result->offsets_ =
+      reinterpret_cast<const uint64*>(result->slots_ + num_slots);
+  result->strings_ =
+      reinterpret_cast<const char*>(result->offsets_ + header.num_strings + 1);
+  if (result->offsets_[header.num_strings] != remaining) {
+    return errors::DataLoss("Lookup table file ", filename,
+                            " has an invalid string table");
+  }
+  *file = std::move(result);
+  return Status::OK();
+}
+
+int64 MappedLookupTableFile::FindSlot(int64 key) const {
+  const uint64 hash = KeyHash(key);
+  const uint64 mask = num_slots_ - 1;
+  uint64 i = hash & mask;
+  // Bound the probes in case the file has no empty slot.
+  for (int64 probes = 0; probes < num_slots_; ++probes) {
+    const Slot& slot = slots_[i];
+    if (slot.hash == 0) return -1;
+    if (slot.hash == hash && static_cast<int64>(slot.key) == key) return i;
+    i = (i + 1) & mask;
+  }
+  return -1;
+}
+
+int64 MappedLookupTableFile::FindSlot(const tstring& key) const {
+  const uint64 hash = KeyHash(key);
+  const uint64 mask = num_slots_ - 1;
+  uint64 i = hash & mask;
+  for (int64 probes = 0; probes < num_slots_; ++probes) {
+    const Slot& slot = slots_[i];
+    if (slot.hash == 0) return -1;
+    StringPiece slot_key;
+    if (slot.hash == hash && GetString(slot.key, &slot_key) &&
+        slot_key == StringPiece(key)) {
+      return i;
+    }
+    i = (i + 1) & mask;
+  }
+  return -1;
+}
+
+bool MappedLookupTableFile::IsOccupied(int64 slot) const {
+  return slots_[slot].hash != 0;
+}
+
+bool MappedLookupTableFile::GetString(uint64 index, StringPiece* s) const {
+  if (index >= num_strings_) return false;
+  const uint64 begin = offsets_[index];
+  const uint64 end = offsets_[index + 1];
+  if (begin > end || end > strings_size_) return false;
+  *s = StringPiece(strings_ + begin, end - begin);
+  return true;
+}
+
+bool MappedLookupTableFile::GetKey(int64 slot, int64* key) const {
+  *key = static_cast<int64>(slots_[slot].key);
+  return true;
+}
+
+bool MappedLookupTableFile::GetKey(int64 slot, tstring* key) const {
+  StringPiece s;
+  if (!GetString(slots_[slot].key, &s)) return false;
+  key->assign(s.data(), s.size());
+  return true;
+}
+
+bool MappedLookupTableFile::GetValue(int64 slot, int32* value) const {
+  *value = static_cast<int32>(static_cast<int64>(slots_[slot].value));
+  return true;
+}
+
+bool MappedLookupTableFile::GetValue(int64 slot, int64* value) const {
+  *value = static_cast<int64>(slots_[slot].value);
+  return true;
+}
+
+bool MappedLookupTableFile::GetValue(int64 slot, float* value) const {
+  const uint32 bits = static_cast<uint32>(slots_[slot].value);
+  std::memcpy(value, &bits, sizeof(bits));
+  return true;
+}
+
+bool MappedLookupTableFile::GetValue(int64 slot, double* value) const {
+  std::memcpy(value, &slots_[slot].value, sizeof(*value));
+  return true;
+}
+
+bool MappedLookupTableFile::GetValue(int64 slot, tstring* value) const {
+  StringPiece s;
+  if (!GetString(slots_[slot].value, &s)) return false;
+  value->assign(s.data(), s.size());
+  return true;
+}
+
+Status WriteMappedLookupTable(Env* env, const string& filename,
+                              const Tensor& keys, const Tensor& values) {
+  if (!port::kLittleEndian) {
+    return errors::Unimplemented(
+        "Mapped lookup tables are only supported on little-endian hosts");
+  }
+  if (!IsSupportedKeyType(keys.dtype())) {
+    return errors::InvalidArgument("Unsupported key type ",
+                                   DataTypeString(keys.dtype()));
+  }
+  if (!IsSupportedValueType(values.dtype())) {
+    return errors::InvalidArgument("Unsupported value type ",
+                                   DataTypeString(values.dtype()));
+  }
+  if (keys.dims() != 1 || !keys.shape().IsSameSize(values.shape())) {
+    return errors::InvalidArgument(
+        "Keys and values must be vectors of the same size, got ",
+        keys.shape().DebugString(), " and ", values.shape().DebugString());
+  }
+  const int64 num_entries = keys.NumElements();
+
+  uint64 num_slots = 2;
+  while (num_slots < 2 * static_cast<uint64>(num_entries)) num_slots *= 2;
+  std::vector<Slot> slots(num_slots, Slot{0, 0, 0});
+  StringTableBuilder strings;
+  const uint64 mask = num_slots - 1;
+  auto insert = [&slots, mask](uint64 hash, uint64 key) {
+    uint64 i = hash & mask;
+    while (slots[i].hash != 0) i = (i + 1) & mask;
+    slots[i].hash = hash;
+    slots[i].key = key;
+    return i;
+  };
+
+  std::vector<uint64> key_slots;
+  key_slots.reserve(num_entries);
+  if (keys.dtype() == DT_INT64) {
+    const auto flat = keys.flat<int64>();
+    gtl::FlatSet<int64> seen(num_entries);
+    for (int64 i = 0; i < num_entries; ++i) {
+      if (!seen.insert(flat(i)).second) {
+        return errors::InvalidArgument("Duplicate key ", flat(i));
+      }
+      key_slots.push_back(insert(KeyHash(flat(i)), EncodeScalar(flat(i))));
+    }
+  } else {
+    const auto flat = keys.flat<tstring>();
+    gtl::FlatSet<StringPiece> seen(num_entries);
+    for (int64 i = 0; i < num_entries; ++i) {
+      if (!seen.insert(flat(i)).second) {
+        return errors::InvalidArgument("Duplicate key '", flat(i), "'");
+      }
+      key_slots.push_back(insert(KeyHash(flat(i)), strings.Add(flat(i))));
+    }
+  }
+
+  std::vector<uint64> encoded_values;
+  encoded_values.reserve(num_entries);
+  switch (values.dtype()) {
+#define HANDLE_TYPE(T)                                          \
+  case DataTypeToEnum<T>::value:                                \
+    EncodeValues<T>(values, &strings, &encoded_values);         \
+    break;
+    HANDLE_TYPE(int32);
+    HANDLE_TYPE(int64);
+    HANDLE_TYPE(float);
+    HANDLE_TYPE(double);
+    HANDLE_TYPE(tstring);
+#undef HANDLE_TYPE
+    default:
+      return errors::Internal("Unexpected value type");
+  }
+  for (int64 i = 0; i < num_entries; ++i) {
+    slots[key_slots[i]].value = encoded_values[i];
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.key_dtype = keys.dtype();
+  header.value_dtype = values.dtype();
+  header.reserved = 0;
+  header.num_entries = num_entries;
+  header.num_slots = num_slots;
+  header.num_strings = strings.num_strings();
+
+  std::unique_ptr<WritableFile> file;
+  TF_RETURN_IF_ERROR(env->NewWritableFile(filename, &file));
+  TF_RETURN_IF_ERROR(file->Append(AsBytes(&header, sizeof(header))));
+  TF_RETURN_IF_ERROR(
+      file->Append(AsBytes(slots.data(), slots.size() * sizeof(Slot))));
+  TF_RETURN_IF_ERROR(file->Append(AsBytes(
+      strings.offsets().data(), strings.offsets().size() * sizeof(uint64))));
+  TF_RETURN_IF_ERROR(file->Append(strings.bytes()));
+  return file->Close();
+}
+
+}  // namespace lookup
+
+// Register the MappedHashTable op with the currently supported key and value
+// types.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                         \
+  REGISTER_KERNEL_BUILDER(                                              \
+      Name("MappedHashTable")                                           \
+          .Device(DEVICE_CPU)                                           \
+          .TypeConstraint<key_dtype>("key_dtype")                       \
+          .TypeConstraint<value_dtype>("value_dtype"),                  \
+      LookupTableOp<lookup::MappedHashTable<key_dtype, value_dtype>,    \
+                    key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int64, double);
+REGISTER_KERNEL(int64, float);
+REGISTER_KERNEL(int64, int32);
+REGISTER_KERNEL(int64, int64);
+REGISTER_KERNEL(int64, tstring);
+REGISTER_KERNEL(tstring, double);
+REGISTER_KERNEL(tstring, float);
+REGISTER_KERNEL(tstring, int32);
+REGISTER_KERNEL(tstring, int64);
+REGISTER_KERNEL(tstring, tstring);
+
+#undef REGISTER_KERNEL
+
+}  // namespace tensorflow
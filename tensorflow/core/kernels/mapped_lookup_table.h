@@ -0,0 +1,215 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_MAPPED_LOOKUP_TABLE_H_
+#define TENSORFLOW_CORE_KERNELS_MAPPED_LOOKUP_TABLE_H_
+
+#include <memory>
+
+#include "tensorflow/core/framework/lookup_interface.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace lookup {
+
+// A read-only hash table stored in a file that is built offline, e.g. with
+// tensorflow/tools/lookup_table:build_mapped_lookup_table, and memory-mapped
+// at load time.
+//
+// The file holds an open addressing table with linear probing and a load
+// factor of at most 0.5, so it can be probed in place: opening it does not
+// read, parse or hash any entry, and its pages are loaded lazily and shared
+// by all the processes that map the same file.
+//
+// Layout, all integers little-endian:
+//   header:   magic, version, key and value dtypes, number of entries,
+//             number of slots (a power of two) and number of strings.
+//   slots:    num_slots x {uint64 hash, uint64 key, uint64 value}. A zero
+//             hash marks an empty slot. int32, int64, float and double keys
+//             and values are stored in place; strings are stored as an
+//             index into the string table.
+//   offsets:  (num_strings + 1) x uint64 offsets into the string bytes.
+//   strings:  the bytes of all the key and value strings.
+//
+// Hashes are Fingerprint64 values, so a file can be built on one machine and
+// used on any other.
+class MappedLookupTableFile {
+ public:
+  // Maps `filename` and validates its header and section sizes.
+  static Status Open(Env* env, const string& filename,
+                     std::unique_ptr<MappedLookupTableFile>* file);
+
+  DataType key_dtype() const { return key_dtype_; }
+  DataType value_dtype() const { return value_dtype_; }
+  int64 size() const { return num_entries_; }
+  int64 num_slots() const { return num_slots_; }
+
+  // Returns the slot that holds `key`, or -1 if the key is not in the table.
+  int64 FindSlot(int64 key) const;
+  int64 FindSlot(const tstring& key) const;
+
+  // Returns true if `slot` is not empty.
+  bool IsOccupied(int64 slot) const;
+
+  // Decode the key or value of an occupied slot. Return false if the string
+  // they refer to is out of the bounds of the file.
+  bool GetKey(int64 slot, int64* key) const;
+  bool GetKey(int64 slot, tstring* key) const;
+  bool GetValue(int64 slot, int32* value) const;
+  bool GetValue(int64 slot, int64* value) const;
+  bool GetValue(int64 slot, float* value) const;
+  bool GetValue(int64 slot, double* value) const;
+  bool GetValue(int64 slot, tstring* value) const;
+
+  struct Slot {
+    uint64 hash;
+    uint64 key;
+    uint64 value;
+  };
+
+ private:
+  MappedLookupTableFile() = default;
+
+  bool GetString(uint64 index, StringPiece* s) const;
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  DataType key_dtype_ = DT_INVALID;
+  DataType value_dtype_ = DT_INVALID;
+  int64 num_entries_ = 0;
+  int64 num_slots_ = 0;
+  uint64 num_strings_ = 0;
+  uint64 strings_size_ = 0;
+  const Slot* slots_ = nullptr;      // Points into region_.
+  const uint64* offsets_ = nullptr;  // Points into region_.
+  const char* strings_ = nullptr;    // Points into region_.
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedLookupTableFile);
+};
+
+// Writes the 1-D `keys` and `values` to `filename` in the format above.
+// Keys must be int64 or string and unique, values int32, int64, float, double
+// or string.
+Status WriteMappedLookupTable(Env* env, const string& filename,
+                              const Tensor& keys, const Tensor& values);
+
+// Lookup table backed by a MappedLookupTableFile, read from the `filename`
+// attr of the kernel that creates it. The table is immutable: Insert, Remove
+// and ImportValues fail.
+template <class K, class V>
+class MappedHashTable : public LookupInterface {
+ public:
+  MappedHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "filename", &filename_));
+    OP_REQUIRES_OK(ctx,
+                   MappedLookupTableFile::Open(ctx->env(), filename_, &file_));
+    OP_REQUIRES(ctx,
+                file_->key_dtype() == key_dtype() &&
+                    file_->value_dtype() == value_dtype(),
+                errors::InvalidArgument(
+                    "Lookup table file ", filename_, " maps ",
+                    DataTypeString(file_->key_dtype()), " to ",
+                    DataTypeString(file_->value_dtype()), ", expected ",
+                    DataTypeString(key_dtype()), " to ",
+                    DataTypeString(value_dtype())));
+  }
+
+  size_t size() const override { return file_->size(); }
+
+  Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+              const Tensor& default_value) override {
+    const V default_val = default_value.flat<V>()(0);
+    const auto key_values = key.flat<K>();
+    auto value_values = value->flat<V>();
+    for (int64 i = 0; i < key_values.size(); ++i) {
+      const int64 slot = file_->FindSlot(key_values(i));
+      if (slot < 0) {
+        value_values(i) = default_val;
+      } else if (!file_->GetValue(slot, &value_values(i))) {
+        return CorruptionError();
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Insert(OpKernelContext* ctx, const Tensor& keys,
+                const Tensor& values) override {
+    return errors::Unimplemented("Lookup table ", filename_,
+                                 " is read-only and does not support Insert");
+  }
+
+  Status Remove(OpKernelContext* ctx, const Tensor& keys) override {
+    return errors::Unimplemented("Lookup table ", filename_,
+                                 " is read-only and does not support Remove");
+  }
+
+  Status ExportValues(OpKernelContext* ctx) override {
+    const int64 size = file_->size();
+    Tensor* keys;
+    Tensor* values;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("keys", TensorShape({size}), &keys));
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output("values", TensorShape({size}), &values));
+    auto keys_data = keys->flat<K>();
+    auto values_data = values->flat<V>();
+    int64 i = 0;
+    for (int64 slot = 0; slot < file_->num_slots() && i < size; ++slot) {
+      if (!file_->IsOccupied(slot)) continue;
+      if (!file_->GetKey(slot, &keys_data(i)) ||
+          !file_->GetValue(slot, &values_data(i))) {
+        return CorruptionError();
+      }
+      ++i;
+    }
+    if (i != size) return CorruptionError();
+    return Status::OK();
+  }
+
+  Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                      const Tensor& values) override {
+    return errors::Unimplemented("Lookup table ", filename_,
+                                 " is read-only and does not support Import");
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return TensorShape(); }
+
+  TensorShape value_shape() const override { return TensorShape(); }
+
+  // The entries live in the page cache, not on the heap.
+  int64 MemoryUsed() const override { return sizeof(*this); }
+
+ private:
+  Status CorruptionError() const {
+    return errors::DataLoss("Lookup table file ", filename_, " is corrupt");
+  }
+
+  string filename_;
+  std::unique_ptr<MappedLookupTableFile> file_;
+};
+
+}  // namespace lookup
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_MAPPED_LOOKUP_TABLE_H_
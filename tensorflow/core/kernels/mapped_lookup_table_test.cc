@@ -0,0 +1,162 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/mapped_lookup_table.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace lookup {
+namespace {
+
+string TablePath(const string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(MappedLookupTableFileTest, StringToInt64) {
+  const string path = TablePath("string_to_int64.table");
+  const int64 n = 1000;
+  Tensor keys(DT_STRING, TensorShape({n}));
+  Tensor values(DT_INT64, TensorShape({n}));
+  for (int64 i = 0; i < n; ++i) {
+    keys.flat<tstring>()(i) = strings::StrCat("word", i);
+    values.flat<int64>()(i) = 2 * i;
+  }
+  TF_ASSERT_OK(WriteMappedLookupTable(Env::Default(), path, keys, values));
+
+  std::unique_ptr<MappedLookupTableFile> file;
+  TF_ASSERT_OK(MappedLookupTableFile::Open(Env::Default(), path, &file));
+  EXPECT_EQ(DT_STRING, file->key_dtype());
+  EXPECT_EQ(DT_INT64, file->value_dtype());
+  EXPECT_EQ(n, file->size());
+  EXPECT_GE(file->num_slots(), 2 * n);
+
+  for (int64 i = 0; i < n; ++i) {
+    const int64 slot = file->FindSlot(tstring(strings::StrCat("word", i)));
+    ASSERT_GE(slot, 0);
+    tstring key;
+    int64 value;
+    ASSERT_TRUE(file->GetKey(slot, &key));
+    ASSERT_TRUE(file->GetValue(slot, &value));
+    EXPECT_EQ(strings::StrCat("word", i), key);
+    EXPECT_EQ(2 * i, value);
+  }
+  EXPECT_EQ(-1, file->FindSlot(tstring("word1000")));
+  EXPECT_EQ(-1, file->FindSlot(tstring("")));
+
+  int64 occupied = 0;
+  for (int64 slot = 0; slot < file->num_slots(); ++slot) {
+    occupied += file->IsOccupied(slot);
+  }
+  EXPECT_EQ(n, occupied);
+}
+
+TEST(MappedLookupTableFileTest, Int64ToScalars) {
+  const string path = TablePath("int64_to_float.table");
+  Tensor keys = test::AsTensor<int64>({-3, 0, 7, int64{1} << 40});
+  Tensor values = test::AsTensor<float>({-1.5f, 0.0f, 2.25f, 1e30f});
+  TF_ASSERT_OK(WriteMappedLookupTable(Env::Default(), path, keys, values));
+
+  std::unique_ptr<MappedLookupTableFile> file;
+  TF_ASSERT_OK(MappedLookupTableFile::Open(Env::Default(), path, &file));
+  EXPECT_EQ(DT_INT64, file->key_dtype());
+  EXPECT_EQ(DT_FLOAT, file->value_dtype());
+  for (int i = 0; i < 4; ++i) {
+    const int64 slot = file->FindSlot(keys.flat<int64>()(i));
+    ASSERT_GE(slot, 0);
+    float value;
+    ASSERT_TRUE(file->GetValue(slot, &value));
+    EXPECT_EQ(values.flat<float>()(i), value);
+  }
+  EXPECT_EQ(-1, file->FindSlot(int64{1}));
+}
+
+TEST(MappedLookupTableFileTest, Int64ToString) {
+  const string path = TablePath("int64_to_string.table");
+  Tensor keys = test::AsTensor<int64>({0, 1, 2});
+  Tensor values = test::AsTensor<tstring>({"a", "", "ccc"});
+  TF_ASSERT_OK(WriteMappedLookupTable(Env::Default(), path, keys, values));
+
+  std::unique_ptr<MappedLookupTableFile> file;
+  TF_ASSERT_OK(MappedLookupTableFile::Open(Env::Default(), path, &file));
+  for (int i = 0; i < 3; ++i) {
+    const int64 slot = file->FindSlot(int64{i});
+    ASSERT_GE(slot, 0);
+    tstring value;
+    ASSERT_TRUE(file->GetValue(slot, &value));
+    EXPECT_EQ(values.flat<tstring>()(i), value);
+  }
+}
+
+TEST(MappedLookupTableFileTest, EmptyTable) {
+  const string path = TablePath("empty.table");
+  Tensor keys(DT_STRING, TensorShape({0}));
+  Tensor values(DT_INT64, TensorShape({0}));
+  TF_ASSERT_OK(WriteMappedLookupTable(Env::Default(), path, keys, values));
+
+  std::unique_ptr<MappedLookupTableFile> file;
+  TF_ASSERT_OK(MappedLookupTableFile::Open(Env::Default(), path, &file));
+  EXPECT_EQ(0, file->size());
+  EXPECT_EQ(-1, file->FindSlot(tstring("a")));
+}
+
+TEST(MappedLookupTableFileTest, RejectsDuplicateKeys) {
+  Tensor keys = test::AsTensor<tstring>({"a", "b", "a"});
+  Tensor values = test::AsTensor<int64>({0, 1, 2});
+  EXPECT_TRUE(errors::IsInvalidArgument(WriteMappedLookupTable(
+      Env::Default(), TablePath("duplicate.table"), keys, values)));
+}
+
+TEST(MappedLookupTableFileTest, RejectsUnsupportedTypes) {
+  Tensor keys = test::AsTensor<int32>({0, 1});
+  Tensor values = test::AsTensor<int64>({0, 1});
+  EXPECT_TRUE(errors::IsInvalidArgument(WriteMappedLookupTable(
+      Env::Default(), TablePath("int32_keys.table"), keys, values)));
+}
+
+TEST(MappedLookupTableFileTest, RejectsCorruptFiles) {
+  const string path = TablePath("corrupt.table");
+  Tensor keys = test::AsTensor<tstring>({"a", "b"});
+  Tensor values = test::AsTensor<int64>({0, 1});
+  TF_ASSERT_OK(WriteMappedLookupTable(Env::Default(), path, keys, values));
+  string contents;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), path, &contents));
+
+  // Bad magic.
+  string bad = contents;
+  bad[0] = 'X';
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, bad));
+  std::unique_ptr<MappedLookupTableFile> file;
+  EXPECT_TRUE(errors::IsDataLoss(
+      MappedLookupTableFile::Open(Env::Default(), path, &file)));
+
+  // Truncated.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path,
+                                 contents.substr(0, contents.size() - 1)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      MappedLookupTableFile::Open(Env::Default(), path, &file)));
+
+  // Too short for a header.
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), path, contents.substr(0, 8)));
+  EXPECT_TRUE(errors::IsDataLoss(
+      MappedLookupTableFile::Open(Env::Default(), path, &file)));
+}
+
+}  // namespace
+}  // namespace lookup
+}  // namespace tensorflow
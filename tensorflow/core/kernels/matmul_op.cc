@@ -449,6 +449,11 @@ class MatMulOp : public OpKernel {
     LaunchMatMul<Device, T, USE_CUBLAS>::GetBlasGemmAlgorithm(
         ctx, &algorithms_, &algorithms_set_already_);
     use_autotune_ = MatmulAutotuneEnable();
+
+    if (std::is_same<Device, CPUDevice>::value &&
+        ctx->HasAttr(kMatMulCacheRhsAttr)) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr(kMatMulCacheRhsAttr, &cache_rhs_));
+    }
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -501,21 +506,37 @@ class MatMulOp : public OpKernel {
                   errors::Internal("bfloat16 matmul is not supported by GPU"));
       Tensor a_float, b_float, out_float;
       OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, a.shape(), &a_float));
-      OP_REQUIRES_OK(ctx, ctx->allocate_temp(DT_FLOAT, b.shape(), &b_float));
       OP_REQUIRES_OK(ctx,
                      ctx->allocate_temp(DT_FLOAT, out->shape(), &out_float));
 
       // TODO: Avoid extra copy to make bfloat16 matmul efficient on CPU.
       BFloat16ToFloat(a.flat<bfloat16>().data(), a_float.flat<float>().data(),
                       a.NumElements());
-      BFloat16ToFloat(b.flat<bfloat16>().data(), b_float.flat<float>().data(),
-                      b.NumElements());
+      if (cache_rhs_) {
+        OP_REQUIRES_OK(ctx, rhs_cache_.Get<bfloat16, float>(
+                                ctx, b, transpose_b_, &b_float));
+        dim_pair[0].second = 0;
+      } else {
+        OP_REQUIRES_OK(ctx,
+                       ctx->allocate_temp(DT_FLOAT, b.shape(), &b_float));
+        BFloat16ToFloat(b.flat<bfloat16>().data(),
+                        b_float.flat<float>().data(), b.NumElements());
+      }
 
       LaunchMatMul<Device, float, USE_CUBLAS>::launch(
           ctx, a_float, b_float, dim_pair, &algorithms_, use_autotune_,
           &out_float);
       FloatToBFloat16(out_float.flat<float>().data(),
                       out->flat<bfloat16>().data(), out->NumElements());
+    } else if (cache_rhs_ && transpose_b_) {
+      // Contracting with a transposed RHS makes Eigen gather strided columns
+      // when packing it on every call, so contract with a transposed copy.
+      Tensor b_transposed;
+      OP_REQUIRES_OK(ctx,
+                     rhs_cache_.Get<T, T>(ctx, b, transpose_b_, &b_transposed));
+      dim_pair[0].second = 0;
+      LaunchMatMul<Device, T, USE_CUBLAS>::launch(
+          ctx, a, b_transposed, dim_pair, &algorithms_, use_autotune_, out);
     } else {
       LaunchMatMul<Device, T, USE_CUBLAS>::launch(
           ctx, a, b, dim_pair, &algorithms_, use_autotune_, out);
@@ -528,6 +549,8 @@ class MatMulOp : public OpKernel {
   bool use_autotune_;
   bool transpose_a_;
   bool transpose_b_;
+  bool cache_rhs_ = false;
+  MatMulRhsCache rhs_cache_;
 };
 
 namespace functor {
@@ -17,9 +17,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_MATMUL_OP_H_
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
+#include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_types.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/platform/mutex.h"
 
 #if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
 #include "tensorflow/core/kernels/eigen_contraction_kernel.h"
@@ -58,6 +60,51 @@ struct MatMulFunctor {
 
 }  // end namespace functor
 
+// Name of the optional boolean attribute that enables MatMulRhsCache in the
+// CPU MatMul and _FusedMatMul kernels. Grappler sets it for constant RHS.
+constexpr char kMatMulCacheRhsAttr[] = "_cache_rhs";
+
+// Keeps a copy of a MatMul RHS in the layout the CPU kernels contract with
+// fastest: not transposed, and in float for bfloat16 inputs. The copy is keyed
+// by the buffer of the RHS, so it must only be used for tensors whose contents
+// do not change while their buffer is alive, such as constants.
+class MatMulRhsCache {
+ public:
+  // Stores in `*rhs` the copy of `b` cast to `To` and, if `transpose_b`,
+  // transposed. The previous copy is reused if `b` shares its buffer and shape
+  // with the tensor it was made from.
+  template <typename From, typename To>
+  Status Get(OpKernelContext* ctx, const Tensor& b, bool transpose_b,
+             Tensor* rhs) {
+    mutex_lock l(mu_);
+    if (!source_.SharesBufferWith(b) || !source_.IsSameSize(b)) {
+      const TensorShape shape =
+          transpose_b ? TensorShape({b.dim_size(1), b.dim_size(0)})
+                      : b.shape();
+      Tensor copy;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_temp(DataTypeToEnum<To>::v(), shape, &copy));
+      const auto& d = ctx->eigen_device<Eigen::ThreadPoolDevice>();
+      auto in = b.matrix<From>().template cast<To>();
+      if (transpose_b) {
+        Eigen::array<int, 2> shuffle({1, 0});
+        copy.matrix<To>().device(d) = in.shuffle(shuffle);
+      } else {
+        copy.matrix<To>().device(d) = in;
+      }
+      source_ = b;
+      cached_ = copy;
+    }
+    *rhs = cached_;
+    return Status::OK();
+  }
+
+ private:
+  mutex mu_;
+  Tensor source_ GUARDED_BY(mu_);
+  Tensor cached_ GUARDED_BY(mu_);
+};
+
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 // Encapsulate all the shape information that is used in matmul operations.
 class MatmulParameters {
@@ -87,12 +134,13 @@ class MatmulParameters {
     return !(*this == other);
   }
   uint64 hash() const { return hash_code_; }
+  int device_id() const { return device_id_; }
 
   string ToString() const {
     // clang-format off
     return strings::StrCat(
         transa_, ", ", transb_, ", ",
-        m_, ", ", n_, ", ", k_,
+        m_, ", ", n_, ", ", k_, ", ",
         dtype_, ", ", device_id_);
     // clang-format on
   }
@@ -115,6 +163,12 @@ class MatmulParameters {
   uint64 hash_code_;
 };
 
+// Persists the autotuning results for MatmulParameters across processes; see
+// GetAutotuneDeviceOrdinal() in gpu_utils.h.
+inline int GetAutotuneDeviceOrdinal(const MatmulParameters& params) {
+  return params.device_id();
+}
+
 typedef Eigen::GpuDevice GPUDevice;
 
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -38,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/fill_functor.h"
 #include "tensorflow/core/kernels/fused_eigen_output_kernels.h"
+#include "tensorflow/core/kernels/matmul_op.h"
 #include "tensorflow/core/util/tensor_format.h"
 
 #if defined(TENSORFLOW_USE_CUSTOM_CONTRACTION_KERNEL)
@@ -122,6 +123,12 @@ class FusedMatMulOp : public OpKernel {
     OP_REQUIRES_OK(context, InitializeFusedComputation(
                                 context, "MatMul", patterns,
                                 &fused_computation_, &fused_computation_args_));
+
+    if (std::is_same<Device, CPUDevice>::value &&
+        context->HasAttr(kMatMulCacheRhsAttr)) {
+      OP_REQUIRES_OK(context,
+                     context->GetAttr(kMatMulCacheRhsAttr, &cache_rhs_));
+    }
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -169,6 +176,15 @@ class FusedMatMulOp : public OpKernel {
     }
 
     auto launch = LaunchFusedMatMulOp<Device, T>();
+    if (cache_rhs_ && transpose_b_) {
+      Tensor b_transposed;
+      OP_REQUIRES_OK(ctx,
+                     rhs_cache_.Get<T, T>(ctx, b, transpose_b_, &b_transposed));
+      dim_pair[0].second = 0;
+      launch(ctx, a, b_transposed, dim_pair, fused_computation_,
+             fused_computation_args_, out);
+      return;
+    }
     launch(ctx, a, b, dim_pair, fused_computation_, fused_computation_args_,
            out);
   }
@@ -176,6 +192,8 @@ class FusedMatMulOp : public OpKernel {
  private:
   bool transpose_a_;
   bool transpose_b_;
+  bool cache_rhs_ = false;
+  MatMulRhsCache rhs_cache_;
 
   FusedComputationType fused_computation_ = FusedComputationType::kUndefined;
   FusedComputationArgs fused_computation_args_;
@@ -16,7 +16,10 @@ limitations under the License.
 #include "absl/algorithm/container.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -338,6 +341,48 @@ using FusedBiasAddDataTypes = ::testing::Types<float>;
 INSTANTIATE_TYPED_TEST_SUITE_P(Test, FusedMatMulWithBiasOpTest,
                                FusedBiasAddDataTypes);
 
+class MatMulCacheRhsOpTest : public OpsTestBase {
+ protected:
+  void MakeOp(DataType type) {
+    TF_ASSERT_OK(NodeDefBuilder("matmul", "MatMul")
+                     .Input(FakeInput(type))
+                     .Input(FakeInput(type))
+                     .Attr("transpose_b", true)
+                     .Attr("_cache_rhs", true)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(MatMulCacheRhsOpTest, TransposedRhs) {
+  MakeOp(DT_FLOAT);
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 0, 1, 0, 1, 0});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {4, 2, 10, 5});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+
+  // A different RHS buffer must not hit the cached copy of the previous one.
+  inputs_.clear();
+  AddInputFromArray<float>(TensorShape({2, 3}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<float>(TensorShape({2, 3}), {0, 0, 1, 1, 0, 0});
+  TF_ASSERT_OK(RunOpKernel());
+  test::FillValues<float>(&expected, {3, 1, 6, 4});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(MatMulCacheRhsOpTest, Bfloat16Rhs) {
+  MakeOp(DT_BFLOAT16);
+  AddInputFromList<bfloat16>(TensorShape({1, 2}), {1, 2});
+  AddInputFromList<bfloat16>(TensorShape({2, 2}), {1, 1, 2, 0});
+  TF_ASSERT_OK(RunOpKernel());
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(DT_BFLOAT16, TensorShape({1, 2}));
+  test::FillValues<bfloat16>(&expected, {bfloat16(3), bfloat16(2)});
+  test::ExpectTensorEqual<bfloat16>(expected, *GetOutput(0));
+}
+
 //----------------------------------------------------------------------------//
 // Performance benchmarks are below.                                          //
 //----------------------------------------------------------------------------//
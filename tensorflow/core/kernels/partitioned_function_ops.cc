@@ -99,8 +99,8 @@ void PartitionedCallOp::ComputeAsync(OpKernelContext* ctx, DoneCallback done) {
   // via, e.g., virtual device annotations and a list of device names
   // supplied through an attribute.
   //
-  // TODO(akshayka): Add a fastpath for functions that execute on a single
-  // device.
+  // Functions placed entirely on a single local device are run by the
+  // ProcessFunctionLibraryRuntime without a rendezvous.
   FunctionLibraryRuntime::Handle handle;
   // If we are instantiating the function, we can efficiently extract the
   // inputs while instantiating. Else, we extract them separately below.
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/kernels/quantization_utils.h"
+#include "tensorflow/core/kernels/ruy_support.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
@@ -355,4 +356,52 @@ TEST_F(QuantizedMatMulTest, Medium_WithParams) {
   test::ExpectTensorNear<float>(expected_float, output_float, 15.0);
 }
 
+// Checks that the ruy and gemmlowp paths compute exactly the same accumulators
+// for all combinations of transposes and non-zero offsets.
+TEST_F(QuantizedMatMulTest, RuyMatchesGemmlowp) {
+  if (!ruy_support::IsSupportedAndEnabled()) {
+    LOG(INFO) << "Ruy has no optimized path on this CPU, skipping.";
+    return;
+  }
+  const int m = 5;
+  const int n = 7;
+  const int k = 9;
+  for (const bool transpose_a : {false, true}) {
+    for (const bool transpose_b : {false, true}) {
+      Tensor outputs[2];
+      for (const bool use_ruy : {false, true}) {
+        ruy_support::SetEnabled(use_ruy);
+        TF_ASSERT_OK(NodeDefBuilder("quantized_mat_mul_op", "QuantizedMatMul")
+                         .Input(FakeInput(DT_QUINT8))
+                         .Input(FakeInput(DT_QUINT8))
+                         .Input(FakeInput(DT_FLOAT))
+                         .Input(FakeInput(DT_FLOAT))
+                         .Input(FakeInput(DT_FLOAT))
+                         .Input(FakeInput(DT_FLOAT))
+                         .Attr("Toutput", DataTypeToEnum<qint32>::v())
+                         .Attr("transpose_a", transpose_a)
+                         .Attr("transpose_b", transpose_b)
+                         .Finalize(node_def()));
+        TF_ASSERT_OK(InitOp());
+        inputs_.clear();
+        const TensorShape a_shape =
+            transpose_a ? TensorShape({k, m}) : TensorShape({m, k});
+        const TensorShape b_shape =
+            transpose_b ? TensorShape({n, k}) : TensorShape({k, n});
+        AddInput<quint8>(a_shape, [](int i) { return quint8((i * 37) % 256); });
+        AddInput<quint8>(b_shape, [](int i) { return quint8((i * 91) % 256); });
+        // Ranges that give zero points of 64 and 200.
+        AddInputFromArray<float>(TensorShape({1}), {-64.0f});
+        AddInputFromArray<float>(TensorShape({1}), {191.0f});
+        AddInputFromArray<float>(TensorShape({1}), {-200.0f});
+        AddInputFromArray<float>(TensorShape({1}), {55.0f});
+        TF_ASSERT_OK(RunOpKernel());
+        outputs[use_ruy] = *GetOutput(0);
+      }
+      test::ExpectTensorEqual<qint32>(outputs[0], outputs[1]);
+    }
+  }
+  ruy_support::SetEnabled(true);
+}
+
 }  // namespace tensorflow
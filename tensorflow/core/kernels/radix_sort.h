@@ -0,0 +1,155 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_RADIX_SORT_H_
+#define TENSORFLOW_CORE_KERNELS_RADIX_SORT_H_
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+#include "tensorflow/core/framework/device_base.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace radix_sort_internal {
+
+constexpr int kDigitBits = 8;
+constexpr int kNumDigits = 1 << kDigitBits;
+
+// Each thread sorts blocks of at least this many elements.
+constexpr int64 kMinBlockSize = 1 << 14;
+
+// Rough cost per element of one pass, used for sharding.
+constexpr int64 kCostPerElement = 10;
+
+}  // namespace radix_sort_internal
+
+// Sorts keys[0, n) in ascending order and applies the same permutation to
+// payloads[0, n). The sort is stable, so with payloads 0, 1, ..., n - 1 it
+// computes the permutation that std::stable_sort would.
+//
+// This is an LSD radix sort with 8-bit digits. Keys are ranked relative to
+// the smallest key, so only the digits spanned by max(keys) - min(keys) are
+// sorted on: keys in [0, 2^16) take two passes whatever their type. Every
+// pass is split into one block per thread, which histogram and scatter their
+// elements independently.
+template <typename Key, typename Payload>
+void RadixSortPairs(const DeviceBase::CpuWorkerThreads& worker_threads,
+                    int64 n, Key* keys, Payload* payloads) {
+  static_assert(std::is_integral<Key>::value, "Keys must be integers");
+  using radix_sort_internal::kDigitBits;
+  using radix_sort_internal::kNumDigits;
+  using UKey = typename std::make_unsigned<Key>::type;
+  if (n <= 1) return;
+
+  const int64 num_blocks = std::max<int64>(
+      1, std::min<int64>(worker_threads.num_threads,
+                         n / radix_sort_internal::kMinBlockSize));
+  const int64 block_size = (n + num_blocks - 1) / num_blocks;
+  const int64 block_cost = block_size * radix_sort_internal::kCostPerElement;
+  // Calls fn(block, begin, end) for each block, in parallel.
+  auto for_each_block =
+      [&](const std::function<void(int64, int64, int64)>& fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          block_cost, [&](int64 start, int64 limit) {
+            for (int64 b = start; b < limit; ++b) {
+              fn(b, b * block_size, std::min(n, (b + 1) * block_size));
+            }
+          });
+  };
+
+  std::vector<Key> block_min(num_blocks, std::numeric_limits<Key>::max());
+  std::vector<Key> block_max(num_blocks, std::numeric_limits<Key>::min());
+  for_each_block([&](int64 b, int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      block_min[b] = std::min(block_min[b], keys[i]);
+      block_max[b] = std::max(block_max[b], keys[i]);
+    }
+  });
+  const UKey min_key =
+      static_cast<UKey>(*std::min_element(block_min.begin(), block_min.end()));
+  const UKey range =
+      static_cast<UKey>(*std::max_element(block_max.begin(), block_max.end())) -
+      min_key;
+
+  std::vector<Key> key_scratch(n);
+  std::vector<Payload> payload_scratch(n);
+  Key* keys_in = keys;
+  Key* keys_out = key_scratch.data();
+  Payload* payloads_in = payloads;
+  Payload* payloads_out = payload_scratch.data();
+  std::vector<std::array<int64, kNumDigits>> offsets(num_blocks);
+  for (int shift = 0; shift < std::numeric_limits<UKey>::digits &&
+                      (range >> shift) != 0;
+       shift += kDigitBits) {
+    const auto digit = [min_key, shift](Key key) {
+      return ((static_cast<UKey>(key) - min_key) >> shift) & (kNumDigits - 1);
+    };
+
+    for_each_block([&](int64 b, int64 begin, int64 end) {
+      std::array<int64, kNumDigits>& counts = offsets[b];
+      counts.fill(0);
+      for (int64 i = begin; i < end; ++i) {
+        ++counts[digit(keys_in[i])];
+      }
+    });
+
+    // Turn the counts into the position each block writes each digit to:
+    // all elements with smaller digits come first, then those with the same
+    // digit in earlier blocks.
+    int64 offset = 0;
+    bool single_digit = false;
+    for (int d = 0; d < kNumDigits; ++d) {
+      int64 digit_count = 0;
+      for (int64 b = 0; b < num_blocks; ++b) {
+        const int64 count = offsets[b][d];
+        offsets[b][d] = offset + digit_count;
+        digit_count += count;
+      }
+      single_digit |= digit_count == n;
+      offset += digit_count;
+    }
+    // Every key has the same digit, so this pass would not move anything.
+    if (single_digit) continue;
+
+    for_each_block([&](int64 b, int64 begin, int64 end) {
+      std::array<int64, kNumDigits>& block_offsets = offsets[b];
+      for (int64 i = begin; i < end; ++i) {
+        const int64 j = block_offsets[digit(keys_in[i])]++;
+        keys_out[j] = keys_in[i];
+        payloads_out[j] = payloads_in[i];
+      }
+    });
+    std::swap(keys_in, keys_out);
+    std::swap(payloads_in, payloads_out);
+  }
+
+  if (keys_in != keys) {
+    for_each_block([&](int64 b, int64 begin, int64 end) {
+      std::copy(keys_in + begin, keys_in + end, keys + begin);
+      std::copy(payloads_in + begin, payloads_in + end, payloads + begin);
+    });
+  }
+}
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_RADIX_SORT_H_
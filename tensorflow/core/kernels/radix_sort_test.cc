@@ -0,0 +1,111 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/radix_sort.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int kNumThreads = 4;
+
+// Checks RadixSortPairs against std::stable_sort on `keys`.
+template <typename Key>
+void ExpectSortsLikeStableSort(std::vector<Key> keys) {
+  thread::ThreadPool pool(Env::Default(), "radix_sort_test", kNumThreads);
+  DeviceBase::CpuWorkerThreads worker_threads;
+  worker_threads.num_threads = kNumThreads;
+  worker_threads.workers = &pool;
+
+  std::vector<int64> expected(keys.size());
+  std::iota(expected.begin(), expected.end(), 0);
+  std::stable_sort(expected.begin(), expected.end(),
+                   [&keys](int64 a, int64 b) { return keys[a] < keys[b]; });
+
+  std::vector<int64> payloads(keys.size());
+  std::iota(payloads.begin(), payloads.end(), 0);
+  std::vector<Key> sorted_keys = keys;
+  RadixSortPairs(worker_threads, keys.size(), sorted_keys.data(),
+                 payloads.data());
+  EXPECT_EQ(payloads, expected);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    ASSERT_EQ(sorted_keys[i], keys[expected[i]]) << i;
+  }
+}
+
+TEST(RadixSortTest, Empty) { ExpectSortsLikeStableSort<int32>({}); }
+
+TEST(RadixSortTest, SmallRangeInt32) {
+  std::mt19937 rng(1);
+  std::uniform_int_distribution<int32> dist(0, 100);
+  std::vector<int32> keys(200000);
+  for (auto& key : keys) key = dist(rng);
+  ExpectSortsLikeStableSort(keys);
+}
+
+TEST(RadixSortTest, NegativeInt32) {
+  std::mt19937 rng(2);
+  std::uniform_int_distribution<int32> dist(std::numeric_limits<int32>::min(),
+                                            std::numeric_limits<int32>::max());
+  std::vector<int32> keys(100000);
+  for (auto& key : keys) key = dist(rng);
+  keys[7] = std::numeric_limits<int32>::min();
+  keys[8] = std::numeric_limits<int32>::max();
+  ExpectSortsLikeStableSort(keys);
+}
+
+TEST(RadixSortTest, Int64) {
+  std::mt19937_64 rng(3);
+  std::vector<int64> keys(150000);
+  for (auto& key : keys) key = static_cast<int64>(rng()) >> (rng() % 64);
+  ExpectSortsLikeStableSort(keys);
+}
+
+TEST(RadixSortTest, SingleKey) {
+  ExpectSortsLikeStableSort(std::vector<int64>(50000, -5));
+}
+
+static void BM_RadixSortPairs(int iters, int n) {
+  testing::StopTiming();
+  thread::ThreadPool pool(Env::Default(), "radix_sort_bench", kNumThreads);
+  DeviceBase::CpuWorkerThreads worker_threads;
+  worker_threads.num_threads = kNumThreads;
+  worker_threads.workers = &pool;
+  std::mt19937_64 rng(4);
+  std::vector<int64> keys(n);
+  for (auto& key : keys) key = rng() % (n * 4);
+  std::vector<int64> sorted_keys(n), payloads(n);
+  testing::ItemsProcessed(static_cast<int64>(iters) * n);
+  for (int i = 0; i < iters; ++i) {
+    sorted_keys = keys;
+    std::iota(payloads.begin(), payloads.end(), 0);
+    testing::StartTiming();
+    RadixSortPairs(worker_threads, n, sorted_keys.data(), payloads.data());
+    testing::StopTiming();
+  }
+}
+BENCHMARK(BM_RadixSortPairs)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,152 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <algorithm>
+#include <string>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+using errors::InvalidArgument;
+
+namespace {
+
+// Each reducer provides the value of an empty row and a binary combiner.
+// The empty-row values match the UnsortedSegment{Sum,Max,Min} ops, so that
+// this op can replace them when reducing the rows of a RaggedTensor.
+template <typename T>
+struct SumReducer {
+  static T Identity() { return T(0); }
+  static T Combine(const T& a, const T& b) { return a + b; }
+};
+
+template <typename T>
+struct MaxReducer {
+  static T Identity() { return Eigen::NumTraits<T>::lowest(); }
+  static T Combine(const T& a, const T& b) { return a < b ? b : a; }
+};
+
+template <typename T>
+struct MinReducer {
+  static T Identity() { return Eigen::NumTraits<T>::highest(); }
+  static T Combine(const T& a, const T& b) { return b < a ? b : a; }
+};
+
+}  // namespace
+
+template <typename T, typename SPLITS_TYPE>
+class RaggedReduceRowsOp : public OpKernel {
+ public:
+  explicit RaggedReduceRowsOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("reduction", &reduction_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& values_in = context->input(0);
+    const Tensor& splits_in = context->input(1);
+
+    OP_REQUIRES(context, values_in.dims() >= 1,
+                InvalidArgument("values must have rank at least 1"));
+    OP_REQUIRES(context, splits_in.dims() == 1,
+                InvalidArgument("row_splits must be a vector"));
+    OP_REQUIRES(context, splits_in.NumElements() >= 1,
+                InvalidArgument("row_splits must be non-empty"));
+
+    const auto splits = splits_in.vec<SPLITS_TYPE>();
+    const int64 nrows = splits.size() - 1;
+    const int64 nvals = values_in.dim_size(0);
+    OP_REQUIRES(context, splits(0) == 0,
+                InvalidArgument("row_splits must start with 0"));
+    for (int64 row = 0; row < nrows; ++row) {
+      OP_REQUIRES(context, splits(row) <= splits(row + 1),
+                  InvalidArgument("row_splits must be sorted"));
+    }
+    OP_REQUIRES(context, splits(nrows) == nvals,
+                InvalidArgument("row_splits must end with values.shape[0]=",
+                                nvals, ", got ", splits(nrows)));
+
+    TensorShape output_shape = values_in.shape();
+    output_shape.set_dim(0, nrows);
+    Tensor* output_out = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output_out));
+    if (output_out->NumElements() == 0) return;
+
+    if (reduction_ == "sum") {
+      ReduceRows<SumReducer<T>>(context, values_in, splits, output_out);
+    } else if (reduction_ == "max") {
+      ReduceRows<MaxReducer<T>>(context, values_in, splits, output_out);
+    } else {
+      ReduceRows<MinReducer<T>>(context, values_in, splits, output_out);
+    }
+  }
+
+ private:
+  // Reduces each row of `values_in` directly from the row_splits, so no
+  // segment ids need to be materialized. Rows are independent, so they are
+  // sharded across the intra-op thread pool.
+  template <typename Reducer>
+  void ReduceRows(OpKernelContext* context, const Tensor& values_in,
+                  typename TTypes<SPLITS_TYPE>::ConstVec splits,
+                  Tensor* output_out) {
+    const int64 nrows = output_out->dim_size(0);
+    const int64 inner_size = output_out->NumElements() / nrows;
+    const auto values = values_in.shaped<T, 2>({values_in.dim_size(0),
+                                                inner_size});
+    auto output = output_out->shaped<T, 2>({nrows, inner_size});
+
+    auto reduce_rows = [&](int64 begin_row, int64 end_row) {
+      for (int64 row = begin_row; row < end_row; ++row) {
+        T* out = &output(row, 0);
+        std::fill(out, out + inner_size, Reducer::Identity());
+        for (SPLITS_TYPE i = splits(row); i < splits(row + 1); ++i) {
+          const T* in = &values(i, 0);
+          for (int64 j = 0; j < inner_size; ++j) {
+            out[j] = Reducer::Combine(out[j], in[j]);
+          }
+        }
+      }
+    };
+    // Average cost of one row.
+    const int64 cost_per_row =
+        std::max<int64>(1, values_in.NumElements() / nrows);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, nrows,
+          cost_per_row, reduce_rows);
+  }
+
+  string reduction_;
+};
+
+#define REGISTER_CPU_KERNEL(TYPE)                                \
+  REGISTER_KERNEL_BUILDER(Name("RaggedReduceRows")               \
+                              .Device(DEVICE_CPU)                \
+                              .TypeConstraint<TYPE>("T")         \
+                              .TypeConstraint<int32>("Tsplits"), \
+                          RaggedReduceRowsOp<TYPE, int32>);      \
+  REGISTER_KERNEL_BUILDER(Name("RaggedReduceRows")               \
+                              .Device(DEVICE_CPU)                \
+                              .TypeConstraint<TYPE>("T")         \
+                              .TypeConstraint<int64>("Tsplits"), \
+                          RaggedReduceRowsOp<TYPE, int64>);
+TF_CALL_REAL_NUMBER_TYPES(REGISTER_CPU_KERNEL);
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,96 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <limits>
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class RaggedReduceRowsOpTest : public ::tensorflow::OpsTestBase {
+ protected:
+  // Builds the tensorflow test graph for the RaggedReduceRows op.
+  template <typename T>
+  void BuildRaggedReduceRowsGraph(const string& reduction) {
+    const auto& dtype = DataTypeToEnum<T>::v();
+    TF_ASSERT_OK(NodeDefBuilder("tested_op", "RaggedReduceRows")
+                     .Input(FakeInput(dtype))     // values
+                     .Input(FakeInput(DT_INT64))  // row_splits
+                     .Attr("reduction", reduction)
+                     .Attr("T", dtype)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+  }
+};
+
+TEST_F(RaggedReduceRowsOpTest, Sum) {
+  BuildRaggedReduceRowsGraph<float>("sum");
+  // rt = [[1, 2, 3], [], [4], [5, 6]]
+  AddInputFromArray<float>(TensorShape({6}), {1, 2, 3, 4, 5, 6});
+  AddInputFromArray<int64>(TensorShape({5}), {0, 3, 3, 4, 6});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorNear<float>(*GetOutput(0),
+                                test::AsTensor<float>({6, 0, 4, 11}), 0.1);
+}
+
+TEST_F(RaggedReduceRowsOpTest, MaxWithInnerDimension) {
+  BuildRaggedReduceRowsGraph<int32>("max");
+  // rt = [[[1, 8], [3, 2]], [], [[5, 6]]]
+  AddInputFromArray<int32>(TensorShape({3, 2}), {1, 8, 3, 2, 5, 6});
+  AddInputFromArray<int64>(TensorShape({4}), {0, 2, 2, 3});
+  TF_ASSERT_OK(RunOpKernel());
+  const int32 lowest = std::numeric_limits<int32>::lowest();
+  test::ExpectTensorEqual<int32>(
+      *GetOutput(0),
+      test::AsTensor<int32>({3, 8, lowest, lowest, 5, 6}, TensorShape({3, 2})));
+}
+
+TEST_F(RaggedReduceRowsOpTest, Min) {
+  BuildRaggedReduceRowsGraph<int32>("min");
+  // rt = [[4, 2, 7], [9]]
+  AddInputFromArray<int32>(TensorShape({4}), {4, 2, 7, 9});
+  AddInputFromArray<int64>(TensorShape({3}), {0, 3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<int32>(*GetOutput(0), test::AsTensor<int32>({2, 9}));
+}
+
+TEST_F(RaggedReduceRowsOpTest, BadSplits) {
+  BuildRaggedReduceRowsGraph<float>("sum");
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  AddInputFromArray<int64>(TensorShape({3}), {0, 2, 1});
+  EXPECT_EQ("row_splits must be sorted", RunOpKernel().error_message());
+}
+
+TEST_F(RaggedReduceRowsOpTest, ShapeFn) {
+  ShapeInferenceTestOp op("RaggedReduceRows");
+  INFER_OK(op, "[?];[?]", "[?]");
+  INFER_OK(op, "[5,3];[4]", "[3,d0_1]");
+  INFER_OK(op, "[?,2,3];?", "[?,d0_1,d0_2]");
+  INFER_ERROR("Shape must be at least rank 1", op, "[];?");
+  INFER_ERROR("Shape must be rank 1", op, "?;[1,2]");
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -132,6 +133,69 @@ class ReductionHelper {
   gtl::InlinedVector<int64, 4> out_reshape_;   // Reshape output for reduction.
 };
 
+namespace functor {
+
+// Reduces each row of a row-major matrix into `out`. Eigen's tensor reducer
+// pays a setup cost per output coefficient that dominates when the rows are
+// short, as in the reductions of softmax and layer normalization, so short
+// rows of float and double are reduced on the CPU by the specializations
+// below. Run() returns false if the reduction is left to Eigen.
+template <typename Device, typename T, typename Reducer>
+struct InnerRowReducer {
+  static bool Run(OpKernelContext* ctx, typename TTypes<T>::ConstMatrix in,
+                  typename TTypes<T>::Vec out) {
+    return false;
+  }
+};
+
+// Rows longer than this are left to Eigen, which handles them well.
+constexpr int64 kMaxInnerRowReductionSize = 1024;
+
+template <typename T>
+using InnerRow = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+// Shards the rows of `in` over the intra-op thread pool and reduces each
+// row with `reduce_row`, which sees the row as a vectorizable Eigen array.
+template <typename T, typename RowReduction>
+void ReduceInnerRows(OpKernelContext* ctx, typename TTypes<T>::ConstMatrix in,
+                     typename TTypes<T>::Vec out, RowReduction reduce_row) {
+  const int64 num_rows = in.dimension(0);
+  const int64 row_size = in.dimension(1);
+  auto reduce_rows = [&](int64 begin_row, int64 end_row) {
+    for (int64 row = begin_row; row < end_row; ++row) {
+      out(row) = reduce_row(InnerRow<T>(&in(row, 0), row_size));
+    }
+  };
+  auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads->num_threads, worker_threads->workers, num_rows,
+        row_size, reduce_rows);
+}
+
+#define DEFINE_INNER_ROW_REDUCER(T, REDUCER, ROW_REDUCTION)                 \
+  template <>                                                              \
+  struct InnerRowReducer<CPUDevice, T, REDUCER<T>> {                       \
+    static bool Run(OpKernelContext* ctx, TTypes<T>::ConstMatrix in,       \
+                    TTypes<T>::Vec out) {                                  \
+      if (in.dimension(1) > kMaxInnerRowReductionSize) return false;       \
+      ReduceInnerRows<T>(ctx, in, out, [](const InnerRow<T>& row) {        \
+        return static_cast<T>(row.ROW_REDUCTION());                        \
+      });                                                                  \
+      return true;                                                         \
+    }                                                                      \
+  };
+#define DEFINE_INNER_ROW_REDUCERS(T)                                    \
+  DEFINE_INNER_ROW_REDUCER(T, Eigen::internal::SumReducer, sum)         \
+  DEFINE_INNER_ROW_REDUCER(T, Eigen::internal::MaxReducer, maxCoeff)    \
+  DEFINE_INNER_ROW_REDUCER(T, Eigen::internal::MinReducer, minCoeff)    \
+  DEFINE_INNER_ROW_REDUCER(T, MeanReducer, mean)                        \
+  DEFINE_INNER_ROW_REDUCER(T, EuclideanNormReducer, matrix().norm)
+DEFINE_INNER_ROW_REDUCERS(float)
+DEFINE_INNER_ROW_REDUCERS(double)
+#undef DEFINE_INNER_ROW_REDUCERS
+#undef DEFINE_INNER_ROW_REDUCER
+
+}  // namespace functor
+
 // For operations where the output is a reduction function along some
 // dimensions of the input.
 template <typename Device, class T, typename Tperm, typename Reducer>
@@ -174,6 +238,7 @@ class ReductionOp : public OpKernel {
 
     Tensor tmp_out;
     typedef functor::ReduceFunctor<Device, Reducer> Functor;
+    typedef functor::InnerRowReducer<Device, T, Reducer> RowReducer;
     Constants<Device> constants;
     const Device& d = ctx->eigen_device<Device>();
     Reducer reducer;
@@ -211,8 +276,11 @@ class ReductionOp : public OpKernel {
                         constants.kZero, reducer);
       } else if ((helper.ndims() == 2) && !helper.reduce_first_axis()) {
         // Can be viewed as a reduction of a matrix along 2nd dimension.
-        Functor::Reduce(ctx, helper.out<T, 1>(&tmp_out), helper.in<T, 2>(data),
-                        constants.kOne, reducer);
+        if (!RowReducer::Run(ctx, helper.in<T, 2>(data),
+                             helper.out<T, 1>(&tmp_out))) {
+          Functor::Reduce(ctx, helper.out<T, 1>(&tmp_out),
+                          helper.in<T, 2>(data), constants.kOne, reducer);
+        }
       } else if ((helper.ndims() == 3) && helper.reduce_first_axis()) {
         // Can be viewed as a reduction of a 3D tensor along 1st and 3rd
         // dimensions.
@@ -237,9 +305,13 @@ class ReductionOp : public OpKernel {
         const int64 unreduced = tmp_out.NumElements();
         const int64 reduced = shuffled.NumElements() / unreduced;
         const Tensor& const_shuffled = shuffled;
-        Functor::Reduce(ctx, tmp_out.flat<T>(),
-                        const_shuffled.shaped<T, 2>({unreduced, reduced}),
-                        constants.kOne, reducer);
+        if (!RowReducer::Run(
+                ctx, const_shuffled.shaped<T, 2>({unreduced, reduced}),
+                tmp_out.flat<T>())) {
+          Functor::Reduce(ctx, tmp_out.flat<T>(),
+                          const_shuffled.shaped<T, 2>({unreduced, reduced}),
+                          constants.kOne, reducer);
+        }
       }
     }
 
@@ -189,4 +189,27 @@ static void BM_Bool2DToScalarGPU(int iters, int num_x, int num_y) {
 }
 BENCHMARK(BM_Bool2DToScalarGPU)->RangePair(2048, 8192, 2048, 8192);
 
+// Reductions of many short rows, as in softmax and layer normalization.
+static void BM_Sum2DShortRowReduceCPU(int iters, int num_x, int num_y) {
+  DoRowReduce(iters, "cpu", "Sum", num_x, num_y);
+}
+BENCHMARK(BM_Sum2DShortRowReduceCPU)->RangePair(1024, 16384, 64, 512);
+
+static void BM_Max2DShortRowReduceCPU(int iters, int num_x, int num_y) {
+  DoRowReduce(iters, "cpu", "Max", num_x, num_y);
+}
+BENCHMARK(BM_Max2DShortRowReduceCPU)->RangePair(1024, 16384, 64, 512);
+
+static void BM_Mean2DShortRowReduceCPU(int iters, int num_x, int num_y) {
+  DoRowReduce(iters, "cpu", "Mean", num_x, num_y);
+}
+BENCHMARK(BM_Mean2DShortRowReduceCPU)->RangePair(1024, 16384, 64, 512);
+
+static void BM_EuclideanNorm2DShortRowReduceCPU(int iters, int num_x,
+                                                int num_y) {
+  DoRowReduce(iters, "cpu", "EuclideanNorm", num_x, num_y);
+}
+BENCHMARK(BM_EuclideanNorm2DShortRowReduceCPU)
+    ->RangePair(1024, 16384, 64, 512);
+
 }  // end namespace tensorflow
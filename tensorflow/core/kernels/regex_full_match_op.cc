@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <memory>
 #include <string>
 
 #include "re2/re2.h"
@@ -20,9 +21,33 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/ptr_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
+namespace {
+
+// Matches every string of `input` against `match`, in parallel. RE2 objects
+// are thread-safe once compiled.
+void FullMatch(OpKernelContext* ctx, const Tensor& input, const RE2& match,
+               Tensor* output) {
+  const auto input_flat = input.flat<tstring>();
+  auto output_flat = output->flat<bool>();
+  auto match_range = [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      output_flat(i) = RE2::FullMatch(input_flat(i), match);
+    }
+  };
+  // Matching a short string against a DFA takes a few hundred cycles.
+  const int64 kCostPerString = 500;
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *ctx->device()->tensorflow_cpu_worker_threads();
+  Shard(worker_threads.num_threads, worker_threads.workers, input_flat.size(),
+        kCostPerString, match_range);
+}
+
+}  // namespace
 
 class RegexFullMatchOp : public OpKernel {
  public:
@@ -31,7 +56,6 @@ class RegexFullMatchOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
-    const auto& input_flat = input_tensor->flat<tstring>();
 
     const Tensor* pattern_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("pattern", &pattern_tensor));
@@ -39,19 +63,36 @@ class RegexFullMatchOp : public OpKernel {
                 errors::InvalidArgument("Pattern must be scalar, but received ",
                                         pattern_tensor->shape().DebugString()));
     const string pattern = pattern_tensor->flat<tstring>()(0);
-    const RE2 match(pattern);
-    OP_REQUIRES(ctx, match.ok(),
-                errors::InvalidArgument("Invalid pattern: ", pattern,
-                                        ", error: ", match.error()));
+    std::shared_ptr<const RE2> match;
+    OP_REQUIRES_OK(ctx, GetRegex(pattern, &match));
 
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), match);
+    FullMatch(ctx, *input_tensor, *match, output_tensor);
+  }
+
+ private:
+  // Returns the compiled `pattern`. The pattern is nearly always the same
+  // from one step to the next, so the last one is kept to avoid compiling it
+  // again.
+  Status GetRegex(const string& pattern, std::shared_ptr<const RE2>* match)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    if (last_match_ == nullptr || last_match_->pattern() != pattern) {
+      auto compiled = std::make_shared<const RE2>(pattern);
+      if (!compiled->ok()) {
+        return errors::InvalidArgument("Invalid pattern: ", pattern,
+                                       ", error: ", compiled->error());
+      }
+      last_match_ = std::move(compiled);
     }
+    *match = last_match_;
+    return Status::OK();
   }
+
+  mutex mu_;
+  std::shared_ptr<const RE2> last_match_ TF_GUARDED_BY(mu_);
 };
 
 REGISTER_KERNEL_BUILDER(Name("RegexFullMatch").Device(DEVICE_CPU),
@@ -71,15 +112,11 @@ class StaticRegexFullMatchOp : public OpKernel {
   void Compute(OpKernelContext* ctx) override {
     const Tensor* input_tensor;
     OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
-    const auto& input_flat = input_tensor->flat<tstring>();
 
     Tensor* output_tensor = nullptr;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("output", input_tensor->shape(),
                                              &output_tensor));
-    auto output_flat = output_tensor->flat<bool>();
-    for (size_t i = 0; i < input_flat.size(); ++i) {
-      output_flat(i) = RE2::FullMatch(input_flat(i), *re_);
-    }
+    FullMatch(ctx, *input_tensor, *re_, output_tensor);
   }
 
  private:
@@ -58,6 +58,7 @@ limitations under the License.
 
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -426,6 +427,7 @@ class AssignVariableOp : public OpKernel {
       *variable->tensor() = value;
     }
     variable->is_initialized = true;
+    variable->MarkAllRowsDirty();
   }
 
  private:
@@ -479,6 +481,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
                     DataTypeString(variable->tensor()->dtype()), " got ",
                     DataTypeString(DT_VARIANT)));
     variable->is_initialized = true;
+    variable->MarkAllRowsDirty();
     *variable->tensor() = Tensor(DT_VARIANT, value.shape());
 
     if (input_alias) {
@@ -562,6 +565,7 @@ class AssignUpdateVariableOp : public OpKernel {
     functor::DenseUpdate<Device, T, Op> update_functor;
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
+    variable->MarkAllRowsDirty();
   }
 };
 
@@ -629,6 +633,15 @@ REGISTER_KERNEL_BUILDER(Name("VarIsInitializedOp")
                         IsResourceInitialized<Var>);
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+namespace {
+// Whether `tensor` views memory that it does not own, like a variable restored
+// from a memory-mapped checkpoint.
+bool IsReadOnlyView(const Tensor& tensor) {
+  const TensorBuffer* buf = DMAHelper::buffer(&tensor);
+  return buf != nullptr && !buf->OwnsMemory();
+}
+}  // namespace
+
 template <typename Device, typename T, typename Index>
 class ResourceGatherOp : public OpKernel {
  public:
@@ -639,7 +652,17 @@ class ResourceGatherOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    bool read_only_view;
+    {
+      tf_shared_lock ml(*v->mu());
+      read_only_view = IsReadOnlyView(*v->tensor());
+    }
+    // A read-only view, which is never updated in place, is gathered from
+    // directly: making it ready for sparse updates would copy all of it, when
+    // the gather reads only some rows of it.
+    if (!read_only_view) {
+      OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    }
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -805,7 +828,17 @@ class ResourceGatherNdOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    bool read_only_view;
+    {
+      tf_shared_lock ml(*v->mu());
+      read_only_view = IsReadOnlyView(*v->tensor());
+    }
+    // A read-only view, which is never updated in place, is gathered from
+    // directly: making it ready for sparse updates would copy all of it, when
+    // the gather reads only some rows of it.
+    if (!read_only_view) {
+      OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    }
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -940,6 +973,7 @@ class ResourceScatterUpdateOp : public OpKernel {
                         params->dim_size(0), ")"));
       }
     }
+    MarkSparselyUpdatedRows<Device>(c, {0}, indices, params->dim_size(0));
   }
 };
 
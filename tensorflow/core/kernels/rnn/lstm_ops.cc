@@ -41,32 +41,18 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+// Computes the gates and the outputs of an LSTM cell from `gates`, which holds
+// xh * w + b on input.
 template <typename T, GateLayout gate_layout>
-void LSTMBlockCellFpropWithEigen(
-    const LSTMBlockCell& cell, OpKernelContext* ctx, const CPUDevice& d,
-    const float forget_bias, const float cell_clip, bool use_peephole,
-    typename TTypes<T>::ConstMatrix x, typename TTypes<T>::ConstMatrix cs_prev,
-    typename TTypes<T>::ConstMatrix h_prev, typename TTypes<T>::ConstMatrix w,
-    typename TTypes<T>::ConstVec wci, typename TTypes<T>::ConstVec wcf,
-    typename TTypes<T>::ConstVec wco, typename TTypes<T>::ConstVec b,
-    typename TTypes<T>::Matrix xh, typename TTypes<T>::Matrix i,
-    typename TTypes<T>::Matrix cs, typename TTypes<T>::Matrix f,
-    typename TTypes<T>::Matrix o, typename TTypes<T>::Matrix ci,
-    typename TTypes<T>::Matrix co, typename TTypes<T>::Matrix gates,
-    typename TTypes<T>::Matrix h) {
-  // Concat xh = [x, h].
-  xh.slice(cell.xh_x_offsets(), cell.xh_x_extents()).device(d) = x;
-  xh.slice(cell.xh_h_offsets(), cell.xh_h_extents()).device(d) = h_prev;
-
-  // states1 = xh * w + b
-  typename TTypes<T>::ConstMatrix const_xh(xh.data(), xh.dimensions());
-  TensorBlasGemm<CPUDevice, T, false /* USE_CUBLAS */>::compute(
-      ctx, d, false, false, typename gemm_compute_type<T>::type(1.f), const_xh,
-      w, typename gemm_compute_type<T>::type(0.f), gates);
-  Eigen::array<Eigen::DenseIndex, 2> b_shape({1, b.dimensions()[0]});
-  Eigen::array<Eigen::DenseIndex, 2> broadcast_shape({cell.batch_size(), 1});
-  gates.device(d) += b.reshape(b_shape).broadcast(broadcast_shape);
-
+void LSTMBlockCellGatesWithEigen(
+    const LSTMBlockCell& cell, const CPUDevice& d, const float forget_bias,
+    const float cell_clip, bool use_peephole,
+    typename TTypes<T>::ConstMatrix cs_prev, typename TTypes<T>::ConstVec wci,
+    typename TTypes<T>::ConstVec wcf, typename TTypes<T>::ConstVec wco,
+    typename TTypes<T>::Matrix i, typename TTypes<T>::Matrix cs,
+    typename TTypes<T>::Matrix f, typename TTypes<T>::Matrix o,
+    typename TTypes<T>::Matrix ci, typename TTypes<T>::Matrix co,
+    typename TTypes<T>::Matrix gates, typename TTypes<T>::Matrix h) {
   Eigen::array<Eigen::DenseIndex, 2> p_shape({1, cell.cell_size()});
   Eigen::array<Eigen::DenseIndex, 2> p_broadcast_shape({cell.batch_size(), 1});
 
@@ -126,6 +112,37 @@ void LSTMBlockCellFpropWithEigen(
   h.device(d) = o * co;
 }
 
+template <typename T, GateLayout gate_layout>
+void LSTMBlockCellFpropWithEigen(
+    const LSTMBlockCell& cell, OpKernelContext* ctx, const CPUDevice& d,
+    const float forget_bias, const float cell_clip, bool use_peephole,
+    typename TTypes<T>::ConstMatrix x, typename TTypes<T>::ConstMatrix cs_prev,
+    typename TTypes<T>::ConstMatrix h_prev, typename TTypes<T>::ConstMatrix w,
+    typename TTypes<T>::ConstVec wci, typename TTypes<T>::ConstVec wcf,
+    typename TTypes<T>::ConstVec wco, typename TTypes<T>::ConstVec b,
+    typename TTypes<T>::Matrix xh, typename TTypes<T>::Matrix i,
+    typename TTypes<T>::Matrix cs, typename TTypes<T>::Matrix f,
+    typename TTypes<T>::Matrix o, typename TTypes<T>::Matrix ci,
+    typename TTypes<T>::Matrix co, typename TTypes<T>::Matrix gates,
+    typename TTypes<T>::Matrix h) {
+  // Concat xh = [x, h].
+  xh.slice(cell.xh_x_offsets(), cell.xh_x_extents()).device(d) = x;
+  xh.slice(cell.xh_h_offsets(), cell.xh_h_extents()).device(d) = h_prev;
+
+  // states1 = xh * w + b
+  typename TTypes<T>::ConstMatrix const_xh(xh.data(), xh.dimensions());
+  TensorBlasGemm<CPUDevice, T, false /* USE_CUBLAS */>::compute(
+      ctx, d, false, false, typename gemm_compute_type<T>::type(1.f), const_xh,
+      w, typename gemm_compute_type<T>::type(0.f), gates);
+  Eigen::array<Eigen::DenseIndex, 2> b_shape({1, b.dimensions()[0]});
+  Eigen::array<Eigen::DenseIndex, 2> broadcast_shape({cell.batch_size(), 1});
+  gates.device(d) += b.reshape(b_shape).broadcast(broadcast_shape);
+
+  LSTMBlockCellGatesWithEigen<T, gate_layout>(
+      cell, d, forget_bias, cell_clip, use_peephole, cs_prev, wci, wcf, wco, i,
+      cs, f, o, ci, co, gates, h);
+}
+
 template <typename Device, typename T, GateLayout gate_layout>
 void LSTMBlockCellBpropWithEigen(
     const LSTMBlockCell& cell, OpKernelContext* ctx, const Device& d,
@@ -955,12 +972,6 @@ class BlockLSTMOp : public OpKernel {
     Tensor* h_out;
     OP_REQUIRES_OK(ctx, ctx->allocate_output("h", batch_cell_shape, &h_out));
 
-    Tensor xh_tensor;
-    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
-                            DataTypeToEnum<T>::v(),
-                            TensorShape({batch_size, input_size + cell_size}),
-                            &xh_tensor));
-
     Tensor gates_tensor;
     OP_REQUIRES_OK(ctx,
                    ctx->allocate_temp(DataTypeToEnum<T>::v(),
@@ -970,35 +981,12 @@ class BlockLSTMOp : public OpKernel {
     const Device& device = ctx->eigen_device<Device>();
 
     const int64 seq_len_max = seq_len_max_tensor->scalar<int64>()();
-    SliceHelper<Device, T> slicer(ctx);
-    for (int64 t = 0; t < seq_len_max; ++t) {
-      const Tensor x_tensor = slicer.InputSlice(*x, t, "x");
-      const Tensor& cs_prev_tensor2 =
-          t == 0 ? *cs_prev_tensor
-                 : slicer.OutputSlice(cs_out, t - 1, "cs_prev");
-      const Tensor& h_prev_tensor2 =
-          t == 0 ? *h_prev_tensor : slicer.OutputSlice(h_out, t - 1, "h_prev");
-
-      Tensor i_tensor = slicer.OutputSlice(i_out, t, "i_out");
-      Tensor cs_tensor = slicer.OutputSlice(cs_out, t, "cs_out");
-      Tensor f_tensor = slicer.OutputSlice(f_out, t, "f_out");
-      Tensor o_tensor = slicer.OutputSlice(o_out, t, "o_out");
-      Tensor ci_tensor = slicer.OutputSlice(ci_out, t, "ci_out");
-      Tensor co_tensor = slicer.OutputSlice(co_out, t, "co_out");
-      Tensor h_tensor = slicer.OutputSlice(h_out, t, "h_out");
-
-      functor::LSTMBlockCellFprop<Device, T, USE_CUBLAS, gate_layout>(
-          batch_size, input_size, cell_size)(
-          ctx, device, forget_bias_, cell_clip_, use_peephole_,
-          x_tensor.matrix<T>(), cs_prev_tensor2.matrix<T>(),
-          h_prev_tensor2.matrix<T>(), w_tensor->matrix<T>(),
-          wci_tensor->vec<T>(), wcf_tensor->vec<T>(), wco_tensor->vec<T>(),
-          b_tensor->vec<T>(), xh_tensor.matrix<T>(), i_tensor.matrix<T>(),
-          cs_tensor.matrix<T>(), f_tensor.matrix<T>(), o_tensor.matrix<T>(),
-          ci_tensor.matrix<T>(), co_tensor.matrix<T>(),
-          gates_tensor.matrix<T>(), h_tensor.matrix<T>());
-      slicer.FinishTimeStep();
-    }
+    OutputTensors outputs = {i_out,  cs_out, f_out, o_out,
+                             ci_out, co_out, h_out};
+    ComputeTimeSteps(ctx, device, seq_len_max, *x, *cs_prev_tensor,
+                     *h_prev_tensor, *w_tensor, *wci_tensor, *wcf_tensor,
+                     *wco_tensor, *b_tensor, &gates_tensor, outputs);
+    if (!ctx->status().ok()) return;
 
     if (seq_len_max < timelen) {
       Tensor cs_tensor = cs_out->Slice(seq_len_max, timelen);
@@ -1012,6 +1000,143 @@ class BlockLSTMOp : public OpKernel {
   }
 
  private:
+  struct OutputTensors {
+    Tensor* i;
+    Tensor* cs;
+    Tensor* f;
+    Tensor* o;
+    Tensor* ci;
+    Tensor* co;
+    Tensor* h;
+  };
+
+  // Runs the cell over the first `seq_len_max` time steps, one fused
+  // LSTMBlockCellFprop per step.
+  template <typename D>
+  void ComputeTimeSteps(OpKernelContext* ctx, const D& device,
+                        const int64 seq_len_max, const Tensor& x,
+                        const Tensor& cs_prev, const Tensor& h_prev,
+                        const Tensor& w, const Tensor& wci, const Tensor& wcf,
+                        const Tensor& wco, const Tensor& b,
+                        Tensor* gates_tensor, const OutputTensors& out) {
+    const int64 batch_size = x.dim_size(1);
+    const int64 input_size = x.dim_size(2);
+    const int64 cell_size = cs_prev.dim_size(1);
+
+    Tensor xh_tensor;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                            DataTypeToEnum<T>::v(),
+                            TensorShape({batch_size, input_size + cell_size}),
+                            &xh_tensor));
+
+    SliceHelper<D, T> slicer(ctx);
+    for (int64 t = 0; t < seq_len_max; ++t) {
+      const Tensor x_tensor = slicer.InputSlice(x, t, "x");
+      const Tensor& cs_prev_tensor =
+          t == 0 ? cs_prev : slicer.OutputSlice(out.cs, t - 1, "cs_prev");
+      const Tensor& h_prev_tensor =
+          t == 0 ? h_prev : slicer.OutputSlice(out.h, t - 1, "h_prev");
+
+      Tensor i_tensor = slicer.OutputSlice(out.i, t, "i_out");
+      Tensor cs_tensor = slicer.OutputSlice(out.cs, t, "cs_out");
+      Tensor f_tensor = slicer.OutputSlice(out.f, t, "f_out");
+      Tensor o_tensor = slicer.OutputSlice(out.o, t, "o_out");
+      Tensor ci_tensor = slicer.OutputSlice(out.ci, t, "ci_out");
+      Tensor co_tensor = slicer.OutputSlice(out.co, t, "co_out");
+      Tensor h_tensor = slicer.OutputSlice(out.h, t, "h_out");
+
+      functor::LSTMBlockCellFprop<D, T, USE_CUBLAS, gate_layout>(
+          batch_size, input_size, cell_size)(
+          ctx, device, forget_bias_, cell_clip_, use_peephole_,
+          x_tensor.matrix<T>(), cs_prev_tensor.matrix<T>(),
+          h_prev_tensor.matrix<T>(), w.matrix<T>(), wci.vec<T>(),
+          wcf.vec<T>(), wco.vec<T>(), b.vec<T>(), xh_tensor.matrix<T>(),
+          i_tensor.matrix<T>(), cs_tensor.matrix<T>(), f_tensor.matrix<T>(),
+          o_tensor.matrix<T>(), ci_tensor.matrix<T>(), co_tensor.matrix<T>(),
+          gates_tensor->matrix<T>(), h_tensor.matrix<T>());
+      slicer.FinishTimeStep();
+    }
+  }
+
+  // On CPU the input half of xh * w does not depend on the recurrence, so it
+  // is computed for all time steps in a single large contraction up front.
+  // Each step then only multiplies h_prev by the recurrent rows of w, which
+  // avoids the per-step xh concat and bias broadcast as well.
+  void ComputeTimeSteps(OpKernelContext* ctx, const CPUDevice& device,
+                        const int64 seq_len_max, const Tensor& x,
+                        const Tensor& cs_prev, const Tensor& h_prev,
+                        const Tensor& w, const Tensor& wci, const Tensor& wcf,
+                        const Tensor& wco, const Tensor& b,
+                        Tensor* gates_tensor, const OutputTensors& out) {
+    if (seq_len_max <= 0) return;
+    const int64 batch_size = x.dim_size(1);
+    const int64 input_size = x.dim_size(2);
+    const int64 cell_size = cs_prev.dim_size(1);
+    const functor::LSTMBlockCell cell(batch_size, input_size, cell_size);
+
+    Tensor x_proj_tensor;
+    OP_REQUIRES_OK(ctx, ctx->allocate_temp(
+                            DataTypeToEnum<T>::v(),
+                            TensorShape({seq_len_max, batch_size,
+                                         cell_size * 4}),
+                            &x_proj_tensor));
+
+    // w is [input_size + cell_size, 4 * cell_size] in row-major order, so its
+    // input and recurrent rows are two contiguous blocks.
+    const T* w_data = w.flat<T>().data();
+    typename TTypes<T>::UnalignedConstMatrix w_x(w_data, input_size,
+                                                 cell_size * 4);
+    typename TTypes<T>::UnalignedConstMatrix w_h(
+        w_data + input_size * cell_size * 4, cell_size, cell_size * 4);
+    const Eigen::array<Eigen::IndexPair<Eigen::DenseIndex>, 1> contract_dims =
+        {Eigen::IndexPair<Eigen::DenseIndex>(1, 0)};
+
+    // x_proj = x[:seq_len_max] * w_x + b
+    {
+      const int64 rows = seq_len_max * batch_size;
+      const Tensor x_seq = x.Slice(0, seq_len_max);
+      auto x_flat = x_seq.shaped<T, 2>({rows, input_size});
+      auto x_proj = x_proj_tensor.shaped<T, 2>({rows, cell_size * 4});
+      Eigen::array<Eigen::DenseIndex, 2> b_shape({1, cell_size * 4});
+      Eigen::array<Eigen::DenseIndex, 2> broadcast_shape({rows, 1});
+      x_proj.device(device) = x_flat.contract(w_x, contract_dims);
+      x_proj.device(device) += b.vec<T>().reshape(b_shape).broadcast(
+          broadcast_shape);
+    }
+
+    typename TTypes<T>::Matrix gates = gates_tensor->matrix<T>();
+    SliceHelper<CPUDevice, T> slicer(ctx);
+    for (int64 t = 0; t < seq_len_max; ++t) {
+      const Tensor& cs_prev_tensor =
+          t == 0 ? cs_prev : slicer.OutputSlice(out.cs, t - 1, "cs_prev");
+      const Tensor& h_prev_tensor =
+          t == 0 ? h_prev : slicer.OutputSlice(out.h, t - 1, "h_prev");
+
+      Tensor i_tensor = slicer.OutputSlice(out.i, t, "i_out");
+      Tensor cs_tensor = slicer.OutputSlice(out.cs, t, "cs_out");
+      Tensor f_tensor = slicer.OutputSlice(out.f, t, "f_out");
+      Tensor o_tensor = slicer.OutputSlice(out.o, t, "o_out");
+      Tensor ci_tensor = slicer.OutputSlice(out.ci, t, "ci_out");
+      Tensor co_tensor = slicer.OutputSlice(out.co, t, "co_out");
+      Tensor h_tensor = slicer.OutputSlice(out.h, t, "h_out");
+
+      // gates = x_proj[t] + h_prev * w_h
+      Tensor x_proj_t = x_proj_tensor.Slice(t, t + 1);
+      gates.device(device) =
+          x_proj_t.unaligned_shaped<T, 2>({batch_size, cell_size * 4});
+      gates.device(device) +=
+          h_prev_tensor.matrix<T>().contract(w_h, contract_dims);
+
+      functor::LSTMBlockCellGatesWithEigen<T, gate_layout>(
+          cell, device, forget_bias_, cell_clip_, use_peephole_,
+          cs_prev_tensor.matrix<T>(), wci.vec<T>(), wcf.vec<T>(), wco.vec<T>(),
+          i_tensor.matrix<T>(), cs_tensor.matrix<T>(), f_tensor.matrix<T>(),
+          o_tensor.matrix<T>(), ci_tensor.matrix<T>(), co_tensor.matrix<T>(),
+          gates, h_tensor.matrix<T>());
+      slicer.FinishTimeStep();
+    }
+  }
+
   float forget_bias_;
   float cell_clip_;
   bool use_peephole_;
@@ -0,0 +1,122 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/ruy_support.h"
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/platform.h"
+
+// Mobile builds link the quantized kernels without ruy, and use the
+// gemmlowp/meta kernels on Arm instead.
+#if !defined(IS_MOBILE_PLATFORM) && !defined(TENSORFLOW_DISABLE_RUY)
+#define TENSORFLOW_USE_RUY (1)
+#endif
+
+#ifdef TENSORFLOW_USE_RUY
+#include "tensorflow/lite/experimental/ruy/ruy/ruy.h"
+#endif
+
+namespace tensorflow {
+namespace ruy_support {
+
+namespace {
+
+bool g_enabled = true;
+
+#ifdef TENSORFLOW_USE_RUY
+
+mutex& GetMutex() {
+  static mutex mu(LINKER_INITIALIZED);
+  return mu;
+}
+
+// Ruy contexts are not thread-safe, so all the calls share a single one under
+// GetMutex(), like the gemmlowp/meta kernels share their scratch buffer.
+ruy::Context* GetContext() EXCLUSIVE_LOCKS_REQUIRED(GetMutex()) {
+  static ruy::Context* context = new ruy::Context();
+  return context;
+}
+
+bool HasOptimizedPath() {
+  static const bool has_optimized_path = [] {
+    mutex_lock library_lock(GetMutex());
+    const ruy::Path path = GetContext()->GetPathToTake<ruy::kAllPaths>();
+    return path != ruy::Path::kReference && path != ruy::Path::kStandardCpp;
+  }();
+  return has_optimized_path;
+}
+
+template <typename Scalar>
+void MakeMatrix(const Scalar* data, int rows, int cols, int stride,
+                bool column_major, ruy::Matrix<Scalar>* matrix) {
+  ruy::MakeSimpleLayout(
+      rows, cols, column_major ? ruy::Order::kColMajor : ruy::Order::kRowMajor,
+      &matrix->layout);
+  matrix->layout.stride = stride;
+  matrix->data = data;
+}
+
+#endif  // TENSORFLOW_USE_RUY
+
+}  // namespace
+
+void SetEnabled(bool enabled) { g_enabled = enabled; }
+
+bool IsSupportedAndEnabled() {
+#ifdef TENSORFLOW_USE_RUY
+  return g_enabled && HasOptimizedPath();
+#else
+  return false;
+#endif
+}
+
+bool SupportsOffsets(int offset_a, int offset_b) {
+  return offset_a <= 0 && offset_a >= -255 && offset_b <= 0 &&
+         offset_b >= -255;
+}
+
+void QuantizedGemm(OpKernelContext* tf_context, bool transpose_a,
+                   bool transpose_b, const quint8* a_data, const quint8* b_data,
+                   qint32* c_data, int m, int n, int k, int offset_a,
+                   int offset_b, int lda, int ldb, int ldc) {
+#ifdef TENSORFLOW_USE_RUY
+  DCHECK(SupportsOffsets(offset_a, offset_b));
+  ruy::Matrix<std::uint8_t> lhs;
+  MakeMatrix(&(a_data->value), m, k, lda, transpose_a, &lhs);
+  lhs.zero_point = -offset_a;
+  ruy::Matrix<std::uint8_t> rhs;
+  MakeMatrix(&(b_data->value), k, n, ldb, transpose_b, &rhs);
+  rhs.zero_point = -offset_b;
+  ruy::Matrix<std::int32_t> dst;
+  ruy::MakeSimpleLayout(m, n, ruy::Order::kRowMajor, &dst.layout);
+  dst.layout.stride = ldc;
+  dst.data = &(c_data->value);
+  // With int32 destinations ruy returns the raw accumulators.
+  ruy::BasicSpec<std::int32_t, std::int32_t> spec;
+
+  mutex_lock library_lock(GetMutex());
+  ruy::Context* context = GetContext();
+  context->max_num_threads =
+      tf_context->device()->tensorflow_cpu_worker_threads()->num_threads;
+  ruy::Mul<ruy::kAllPaths>(lhs, rhs, spec, context, &dst);
+#else
+  LOG(FATAL) << "QuantizedGemm: Ruy not supported.";
+#endif
+}
+
+}  // namespace ruy_support
+}  // namespace tensorflow
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
+#include <algorithm>
 #include <numeric>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
@@ -234,51 +236,44 @@ void RestoreTensor(OpKernelContext* context,
 
 namespace {
 
-// Tensors larger than this threshold will be restored from a thread-pool.
-const int64 kLargeShapeThreshold = 16 << 20;  // 16M
+// The number of threads that read the tensors of a checkpoint in parallel.
+const int kNumRestoreThreads = 8;
 
-// A restore operation for a single tensor.  Small tensors may be restored
-// directly from the op thread to improve read locality.  Large tensors can be
-// restored from a thread pool: this requires creating a separate BundleReader
-// for each restore.
+// Restores are run in batches of at least this many bytes.  The first batch
+// is read from the op thread, and every other batch from a thread pool with a
+// separate BundleReader.
+const int64 kMinRestoreBatchBytes = 16 << 20;  // 16MB
+
+// A restore operation for a single tensor.
 struct RestoreOp {
   RestoreOp& operator=(const RestoreOp&) = delete;
 
-  bool should_run_in_pool(BundleReader* reader) const {
-    TensorShape restored_full_shape;
-
-    // Ignore status here; we'll catch the error later.
-    if (!reader->LookupTensorShape(tensor_name, &restored_full_shape).ok()) {
-      return false;
-    }
-
-    return restored_full_shape.num_elements() > kLargeShapeThreshold;
-  }
-
-  // Run this restore operation using a new BundleReader.
-  void run_with_new_reader() {
-    BundleReader reader(Env::Default(), reader_prefix);
-    if (!reader.status().ok()) {
-      status = reader.status();
-      return;
-    }
-
-    status = run(&reader);
-  }
-
   Status run(BundleReader* reader) {
-    TensorShape restored_full_shape;
-    TF_RETURN_IF_ERROR(
-        reader->LookupTensorShape(tensor_name, &restored_full_shape));
+    const TensorShape restored_full_shape(entry.shape());
 
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    if (shape_and_slice.empty() && let_reader_allocate) {
+      // Lets the reader back the output by its mapping of the data file.
+      Tensor restored;
+      TF_RETURN_IF_ERROR(
+          reader->LookupWithEntry(tensor_name, entry, &restored));
+      context->set_output(idx, MaybeShare(restored));
+    } else if (shape_and_slice.empty() && shared_tensors != nullptr) {
+      // Outputs the tensor of the store if it has an equal one.
+      Tensor restored;
+      TF_RETURN_IF_ERROR(context->allocate_temp(
+          dtype, restored_full_shape, &restored));
+      TF_RETURN_IF_ERROR(
+          reader->LookupWithEntry(tensor_name, entry, &restored));
+      context->set_output(idx, MaybeShare(restored));
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, restored_tensor));
+      TF_RETURN_IF_ERROR(
+          reader->LookupWithEntry(tensor_name, entry, restored_tensor));
     } else {
       // Lookup the slice.
       TensorShape parsed_full_shape;
@@ -298,33 +293,77 @@ struct RestoreOp {
       }
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, parsed_slice_shape, &restored_tensor));
-      TF_RETURN_IF_ERROR(
-          reader->LookupSlice(tensor_name, parsed_slice, restored_tensor));
+      TF_RETURN_IF_ERROR(reader->LookupSliceWithEntry(
+          tensor_name, entry, parsed_slice, restored_tensor));
     }
     return Status::OK();
   }
 
+  Tensor MaybeShare(const Tensor& restored) {
+    if (shared_tensors == nullptr) return restored;
+    return shared_tensors->Share(crc32c, restored);
+  }
+
   OpKernelContext* context;
   size_t idx;
   string tensor_name;
   string shape_and_slice;
-  string reader_prefix;
+  DataType dtype;
+
+  // The metadata of the tensor, looked up in key order before the restores
+  // run, so that they do not seek the metadata table again in the order of
+  // the data files.
+  BundleEntryProto entry;
+
+  // Location of the tensor in the data files.  Partitioned tensors, whose
+  // slices may be anywhere, are ordered after all others.
+  bool partitioned;
+  int32 shard_id;
+  int64 offset;
+  int64 size;
+
+  // Whether the full tensor is not partitioned and may be allocated by the
+  // reader, which then memory-maps it if possible.
+  bool let_reader_allocate;
+
+  // If not null, the full tensor is replaced by an equal tensor of the store,
+  // found through the checksum of its bundle entry.
+  SharedTensorStore* shared_tensors;
+  uint32 crc32c;
+};
 
-  ::tensorflow::Status status;
+// Restore operations that are run in order with the same BundleReader.
+struct RestoreBatch {
+  std::vector<RestoreOp*> ops;
+  Status status;
 };
 
+Status RunRestoreBatch(BundleReader* reader, const RestoreBatch& batch) {
+  for (RestoreOp* op : batch.ops) {
+    TF_RETURN_IF_ERROR(op->run(reader));
+  }
+  return Status::OK();
+}
+
 }  // namespace
 
 Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
                         const Tensor& tensor_names,
                         const Tensor& shape_and_slices,
-                        gtl::ArraySlice<DataType> dtypes) {
+                        gtl::ArraySlice<DataType> dtypes,
+                        const BundleReader::Options& reader_options,
+                        SharedTensorStore* shared_tensors) {
   const string& prefix_string = prefix.scalar<tstring>()();
+  if (shared_tensors != nullptr) {
+    // Drops the tensors of unloaded sessions before adding new ones.
+    shared_tensors->Sweep();
+  }
 
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-  // Sort lookup keys to improve locality when reading multiple tensors.
+  // Sort lookup keys to improve locality when reading the metadata of
+  // multiple tensors.
   std::vector<size_t> sorted_name_idx(tensor_names_flat.size());
   std::iota(sorted_name_idx.begin(), sorted_name_idx.end(), 0);
   std::sort(sorted_name_idx.begin(), sorted_name_idx.end(),
@@ -332,68 +371,100 @@ Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
               return tensor_names_flat(a) < tensor_names_flat(b);
             });
 
-  std::vector<std::unique_ptr<RestoreOp> > pool_restore_ops;
-  std::vector<std::unique_ptr<RestoreOp> > direct_restore_ops;
-
-  BundleReader default_reader(Env::Default(), prefix_string);
+  BundleReader default_reader(Env::Default(), prefix_string, reader_options);
   TF_RETURN_IF_ERROR(default_reader.status());
 
+  // Looks up the metadata of every tensor once, in key order, which reads
+  // each block of the metadata table at most once.
   std::vector<string> mismatched_errors;
+  std::vector<std::unique_ptr<RestoreOp> > restore_ops;
+  int64 total_bytes = 0;
   for (const size_t i : sorted_name_idx) {
-    TensorShape restored_full_shape;
-    DataType original_dtype;
     const string& tensor_name = tensor_names_flat(i);
-    TF_RETURN_IF_ERROR(default_reader.LookupDtypeAndShape(
-        tensor_name, &original_dtype, &restored_full_shape));
-    if (dtypes[i] != original_dtype) {
+    const string& shape_and_slice = shape_and_slices_flat(i);
+    BundleEntryProto entry;
+    TF_RETURN_IF_ERROR(default_reader.LookupEntry(tensor_name, &entry));
+    if (dtypes[i] != entry.dtype()) {
       string error_msg = strings::StrCat(
           "tensor_name = ", tensor_name, "; expected dtype ",
           DataTypeString(dtypes[i]), " does not equal original dtype ",
-          DataTypeString(original_dtype));
+          DataTypeString(entry.dtype()));
       mismatched_errors.emplace_back(error_msg);
+      continue;
     }
+    const bool partitioned = entry.slices_size() > 0;
+    int64 size = entry.size();
+    if (partitioned) {
+      size = TensorShape(entry.shape()).num_elements() *
+             DataTypeSize(entry.dtype());
+    }
+    const bool let_reader_allocate = reader_options.use_mmap && !partitioned;
+    restore_ops.emplace_back(new RestoreOp{
+        context, i, tensor_name, shape_and_slice, dtypes[i], entry,
+        partitioned, entry.shard_id(), entry.offset(), size,
+        let_reader_allocate, partitioned ? nullptr : shared_tensors,
+        entry.crc32c()});
+    total_bytes += size;
   }
   if (!mismatched_errors.empty()) {
     const string error_msg = absl::StrJoin(mismatched_errors, "\n");
     return errors::InvalidArgument(error_msg);
   }
 
-  for (auto i : sorted_name_idx) {
-    const string& tensor_name = tensor_names_flat(i);
-    const string& shape_and_slice = shape_and_slices_flat(i);
-    auto op =
-        new RestoreOp{context, i, tensor_name, shape_and_slice, prefix_string};
-    if (op->should_run_in_pool(&default_reader)) {
-      pool_restore_ops.emplace_back(op);
-    } else {
-      direct_restore_ops.emplace_back(op);
+  // Orders the restores by their location in the data files, so that each
+  // reader reads its part of a data file sequentially, and the reader's input
+  // buffer serves neighbouring small tensors with a single read.
+  std::sort(restore_ops.begin(), restore_ops.end(),
+            [](const std::unique_ptr<RestoreOp>& a,
+               const std::unique_ptr<RestoreOp>& b) {
+              return std::make_tuple(a->partitioned, a->shard_id, a->offset) <
+                     std::make_tuple(b->partitioned, b->shard_id, b->offset);
+            });
+
+  // Splits the restores into contiguous batches of similar sizes, one for
+  // each thread.
+  const int64 batch_bytes = std::max(
+      kMinRestoreBatchBytes, total_bytes / kNumRestoreThreads + 1);
+  std::vector<RestoreBatch> batches(1);
+  int64 bytes_in_batch = 0;
+  for (auto& op : restore_ops) {
+    if (bytes_in_batch >= batch_bytes) {
+      batches.emplace_back();
+      bytes_in_batch = 0;
     }
+    batches.back().ops.push_back(op.get());
+    bytes_in_batch += op->size;
   }
 
   {
-    // Schedule any threaded operations first, skipping thread pool creation if
-    // we don't have any expensive operations.
+    // Schedules the other batches first, skipping thread pool creation if
+    // the checkpoint is small enough to be read from the op thread.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!pool_restore_ops.empty()) {
-      reader_pool.reset(
-          new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
-      for (auto& op : pool_restore_ops) {
-        reader_pool->Schedule([&op]() { op->run_with_new_reader(); });
+    if (batches.size() > 1) {
+      reader_pool.reset(new thread::ThreadPool(
+          Env::Default(), "restore_tensors",
+          std::min<int>(kNumRestoreThreads, batches.size() - 1)));
+      for (size_t i = 1; i < batches.size(); ++i) {
+        RestoreBatch* batch = &batches[i];
+        reader_pool->Schedule([batch, &prefix_string, &reader_options]() {
+          BundleReader reader(Env::Default(), prefix_string, reader_options);
+          batch->status = reader.status();
+          if (batch->status.ok()) {
+            batch->status = RunRestoreBatch(&reader, *batch);
+          }
+        });
       }
     }
 
-    // Read small tensors from the op thread
-    for (auto& op : direct_restore_ops) {
-      TF_RETURN_IF_ERROR(op->run(&default_reader));
-    }
+    batches[0].status = RunRestoreBatch(&default_reader, batches[0]);
   }
 
-  // Check status of pool ops; this must come after the pool shuts down.
-  for (auto& op : pool_restore_ops) {
-    TF_RETURN_IF_ERROR(op->status);
+  // Check status of the batches; this must come after the pool shuts down.
+  for (const RestoreBatch& batch : batches) {
+    TF_RETURN_IF_ERROR(batch.status);
   }
 
-  for (auto i : sorted_name_idx) {
+  for (const size_t i : sorted_name_idx) {
     const string& tensor_name = tensor_names_flat(i);
     if (dtypes[i] != context->mutable_output(i)->dtype()) {
       return errors::InvalidArgument(
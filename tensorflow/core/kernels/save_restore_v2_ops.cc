@@ -20,7 +20,10 @@ limitations under the License.
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/save_restore_tensor.h"
@@ -29,6 +32,7 @@ limitations under the License.
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "tensorflow/core/util/tensor_slice_reader.h"
@@ -90,7 +94,19 @@ void ValidateInputs(bool is_save_op, OpKernelContext* context,
 // Saves a list of named tensors using the tensor bundle library.
 class SaveV2 : public OpKernel {
  public:
-  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {}
+  explicit SaveV2(OpKernelConstruction* context) : OpKernel(context) {
+    // Spreading large checkpoints over several data files lets them be
+    // written in parallel.
+    int64 num_data_files;
+    OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_CHECKPOINT_NUM_DATA_FILES",
+                                                1, &num_data_files));
+    writer_options_.num_data_files = num_data_files;
+    // Aligned tensors can be memory-mapped on restore.
+    int64 data_alignment;
+    OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_CHECKPOINT_DATA_ALIGNMENT",
+                                                1, &data_alignment));
+    writer_options_.data_alignment = data_alignment;
+  }
 
   void Compute(OpKernelContext* context) override {
     const Tensor& prefix = context->input(0);
@@ -105,7 +121,7 @@ class SaveV2 : public OpKernel {
     const auto& tensor_names_flat = tensor_names.flat<tstring>();
     const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
-    BundleWriter writer(Env::Default(), prefix_string);
+    BundleWriter writer(Env::Default(), prefix_string, writer_options_);
     OP_REQUIRES_OK(context, writer.status());
     VLOG(1) << "BundleWriter, prefix_string: " << prefix_string;
 
@@ -136,6 +152,9 @@ class SaveV2 : public OpKernel {
     }
     OP_REQUIRES_OK(context, writer.Finish());
   }
+
+ private:
+  BundleWriter::Options writer_options_;
 };
 REGISTER_KERNEL_BUILDER(Name("SaveV2").Device(DEVICE_CPU), SaveV2);
 
@@ -144,6 +163,30 @@ class RestoreV2 : public OpKernel {
  public:
   explicit RestoreV2(OpKernelConstruction* context) : OpKernel(context) {
     OP_REQUIRES_OK(context, context->GetAttr("dtypes", &dtypes_));
+    // Memory-mapping lets large read-only checkpoints, e.g. of a model being
+    // served, be restored without copying them.
+    OP_REQUIRES_OK(context,
+                   ReadBoolFromEnvVar("TF_CHECKPOINT_RESTORE_USE_MMAP", false,
+                                      &reader_options_.use_mmap));
+    // Lazy restores map the checkpoint without reading it, so that only the
+    // parts of the variables that are used are ever read, e.g. the rows of
+    // large embeddings gathered when serving.
+    bool lazy_restore;
+    OP_REQUIRES_OK(context, ReadBoolFromEnvVar("TF_CHECKPOINT_RESTORE_LAZY",
+                                               false, &lazy_restore));
+    if (lazy_restore) {
+      reader_options_.use_mmap = true;
+      reader_options_.verify_mapped_tensors = false;
+    }
+    // Sessions restored from the same checkpoint, e.g. several versions of a
+    // served model that share towers, then share the buffers of equal tensors.
+    bool share_tensors;
+    OP_REQUIRES_OK(context,
+                   ReadBoolFromEnvVar("TF_CHECKPOINT_RESTORE_SHARE_TENSORS",
+                                      false, &share_tensors));
+    if (share_tensors) {
+      shared_tensors_ = SharedTensorStore::Global();
+    }
   }
 
   void Compute(OpKernelContext* context) override {
@@ -180,13 +223,17 @@ class RestoreV2 : public OpKernel {
       return;
     }
     // If found, invokes the V2 reader.
-    OP_REQUIRES_OK(context, RestoreTensorsV2(context, prefix, tensor_names,
-                                             shape_and_slices, dtypes_));
+    OP_REQUIRES_OK(
+        context,
+        RestoreTensorsV2(context, prefix, tensor_names, shape_and_slices,
+                         dtypes_, reader_options_, shared_tensors_));
   }
 
  private:
   // Expected dtypes of the to-restore tensors.
   std::vector<DataType> dtypes_;
+  BundleReader::Options reader_options_;
+  SharedTensorStore* shared_tensors_ = nullptr;  // not owned
 };
 REGISTER_KERNEL_BUILDER(Name("RestoreV2").Device(DEVICE_CPU), RestoreV2);
 
@@ -239,4 +286,139 @@ class MergeV2Checkpoints : public OpKernel {
 REGISTER_KERNEL_BUILDER(Name("MergeV2Checkpoints").Device(DEVICE_CPU),
                         MergeV2Checkpoints);
 
+// Saves the rows of resource variables that changed since the previous delta
+// checkpoint, or all of a variable the first time that it is saved.
+class SaveDeltaV2 : public OpKernel {
+ public:
+  explicit SaveDeltaV2(OpKernelConstruction* context) : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& prefix = context->input(0);
+    const Tensor& tensor_names = context->input(1);
+    const Tensor& shape_and_slices = context->input(2);
+    ValidateInputs(true /* is save op */, context, prefix, tensor_names,
+                   shape_and_slices);
+    if (!context->status().ok()) return;
+
+    const int kFixedInputs = 3;  // Prefix, tensor names, shape_and_slices.
+    const int num_tensors = static_cast<int>(tensor_names.NumElements());
+    const string& prefix_string = prefix.scalar<tstring>()();
+    const auto& tensor_names_flat = tensor_names.flat<tstring>();
+    const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
+
+    BundleWriter writer(Env::Default(), prefix_string);
+    OP_REQUIRES_OK(context, writer.status());
+
+    // Variables whose dirty rows were taken.  If the delta cannot be written,
+    // their next delta stores them in full.
+    std::vector<core::RefCountPtr<Var>> taken;
+    Status s;
+    for (int i = 0; i < num_tensors && s.ok(); ++i) {
+      core::RefCountPtr<Var> var;
+      s = LookupResource(context, HandleFromInput(context, i + kFixedInputs),
+                         &var);
+      if (!s.ok()) break;
+      s = SaveVariable(tensor_names_flat(i), shape_and_slices_flat(i),
+                       var.get(), &writer);
+      taken.push_back(std::move(var));
+    }
+    if (s.ok()) s = writer.Finish();
+    if (!s.ok()) {
+      for (const auto& var : taken) var->MarkAllRowsDirty();
+    }
+    OP_REQUIRES_OK(context, s);
+  }
+
+ private:
+  static Status SaveVariable(const string& tensor_name,
+                             const string& shape_spec, Var* var,
+                             BundleWriter* writer) {
+    bool all_rows = true;
+    std::vector<std::pair<int64, int64>> ranges;
+    std::vector<Tensor> values;
+    TensorShape var_shape;
+    {
+      // Takes the dirty rows together with their values, so that rows updated
+      // from now on go to the next delta.
+      mutex_lock ml(*var->mu());
+      if (!var->is_initialized) {
+        return errors::FailedPrecondition(
+            "Attempting to save uninitialized variable ", tensor_name);
+      }
+      const Tensor& tensor = *var->tensor();
+      if (var->tracks_dirty_rows()) {
+        var->TakeDirtyRows(&all_rows, &ranges);
+      } else {
+        var->StartTrackingDirtyRows();
+      }
+      var_shape = tensor.shape();
+      if (all_rows) {
+        values.push_back(tensor::DeepCopy(tensor));
+      } else {
+        for (const auto& range : ranges) {
+          values.push_back(
+              tensor::DeepCopy(tensor.Slice(range.first, range.second)));
+        }
+      }
+    }
+
+    TensorShape shape = var_shape;
+    TensorSlice slice(var_shape.dims());
+    if (!shape_spec.empty()) {
+      TensorShape slice_shape;
+      TF_RETURN_IF_ERROR(checkpoint::ParseShapeAndSlice(shape_spec, &shape,
+                                                        &slice, &slice_shape));
+      if (!slice_shape.IsSameSize(var_shape)) {
+        return errors::InvalidArgument(
+            "Slice in shape_and_slice specification does not match the shape "
+            "of the variable to save: ",
+            shape_spec, ", variable: ", var_shape.DebugString());
+      }
+    }
+    if (all_rows) {
+      if (shape_spec.empty()) return writer->Add(tensor_name, values[0]);
+      return writer->AddSlice(tensor_name, shape, slice, values[0]);
+    }
+    // The rows are stored as slices of the full tensor.
+    const int64 first_row = slice.IsFullAt(0) ? 0 : slice.start(0);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+      TensorSlice rows = slice;
+      rows.set_start(0, first_row + ranges[i].first);
+      rows.set_length(0, ranges[i].second - ranges[i].first);
+      TF_RETURN_IF_ERROR(writer->AddSlice(tensor_name, shape, rows, values[i]));
+    }
+    return Status::OK();
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("SaveDeltaV2").Device(DEVICE_CPU), SaveDeltaV2);
+
+// Compacts a chain of checkpoints written by SaveV2 and SaveDeltaV2.
+class CompactDeltaCheckpoints : public OpKernel {
+ public:
+  explicit CompactDeltaCheckpoints(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& checkpoint_prefixes = context->input(0);
+    const Tensor& destination_prefix = context->input(1);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(checkpoint_prefixes.shape()),
+                errors::InvalidArgument(
+                    "Input checkpoint_prefixes should be an 1-D tensor, got ",
+                    checkpoint_prefixes.shape().DebugString(), " instead."));
+    OP_REQUIRES(context, TensorShapeUtils::IsScalar(destination_prefix.shape()),
+                errors::InvalidArgument(
+                    "Input destination_prefix should be a scalar tensor, got ",
+                    destination_prefix.shape().DebugString(), " instead."));
+
+    const gtl::ArraySlice<tstring> input_prefixes =
+        gtl::ArraySlice<tstring>(checkpoint_prefixes.flat<tstring>());
+    OP_REQUIRES_OK(
+        context, CompactBundles(Env::Default(), input_prefixes,
+                                destination_prefix.scalar<tstring>()()));
+  }
+};
+REGISTER_KERNEL_BUILDER(Name("CompactDeltaCheckpoints").Device(DEVICE_CPU),
+                        CompactDeltaCheckpoints);
+
 }  // namespace tensorflow
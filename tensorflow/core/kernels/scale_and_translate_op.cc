@@ -574,20 +574,53 @@ struct GatherSpans<CPUDevice, T> {
     const int64 intermediate_pix_per_batch =
         input_width * output_height * channels;
     const int64 output_pix_per_batch = output_width * output_height * channels;
-    float* intermediate_ptr = intermediate_buffer.data();
-
-    const T* image_ptr = images.data();
-    float* out_ptr = resized_images.data();
-    for (int b = 0; b < batch_size; ++b, image_ptr += input_pix_per_batch,
-             intermediate_ptr += intermediate_pix_per_batch,
-             out_ptr += output_pix_per_batch) {
-      GatherRows(row_span_size, row_starts.data(), row_weights.data(),
-                 image_ptr, input_height, input_width, output_height,
-                 input_width, channels, intermediate_ptr);
-      GatherColumns(col_span_size, col_starts.data(), col_weights.data(),
-                    intermediate_ptr, output_height, input_width, output_height,
-                    output_width, channels, out_ptr);
-    }
+    const int64 intermediate_row_size = input_width * channels;
+    const int64 output_row_size = output_width * channels;
+
+    // Both passes produce independent rows, so each pass is sharded across
+    // the device's threads by the rows [begin, end) of all the images, where
+    // row r is the row r % output_height of image r / output_height.
+    auto gather_rows = [&](int64 begin, int64 end) {
+      for (int64 b = begin / output_height; b * output_height < end; ++b) {
+        const int64 begin_y = std::max(begin - b * output_height, int64{0});
+        const int64 end_y = std::min(end - b * output_height, output_height);
+        GatherRows(row_span_size, row_starts.data() + begin_y,
+                   row_weights.data() + begin_y * row_span_size,
+                   images.data() + b * input_pix_per_batch, input_height,
+                   input_width, end_y - begin_y, input_width, channels,
+                   intermediate_buffer.data() +
+                       b * intermediate_pix_per_batch +
+                       begin_y * intermediate_row_size);
+      }
+    };
+    auto gather_columns = [&](int64 begin, int64 end) {
+      for (int64 b = begin / output_height; b * output_height < end; ++b) {
+        const int64 begin_y = std::max(begin - b * output_height, int64{0});
+        const int64 end_y = std::min(end - b * output_height, output_height);
+        GatherColumns(col_span_size, col_starts.data(), col_weights.data(),
+                      intermediate_buffer.data() +
+                          b * intermediate_pix_per_batch +
+                          begin_y * intermediate_row_size,
+                      end_y - begin_y, input_width, end_y - begin_y,
+                      output_width, channels,
+                      resized_images.data() + b * output_pix_per_batch +
+                          begin_y * output_row_size);
+      }
+    };
+    const Eigen::TensorOpCost rows_cost(
+        row_span_size * intermediate_row_size * sizeof(T),
+        intermediate_row_size * sizeof(float),
+        row_span_size * intermediate_row_size *
+            (Eigen::TensorOpCost::AddCost<float>() +
+             Eigen::TensorOpCost::MulCost<float>()));
+    const Eigen::TensorOpCost columns_cost(
+        col_span_size * output_row_size * sizeof(float),
+        output_row_size * sizeof(float),
+        col_span_size * output_row_size *
+            (Eigen::TensorOpCost::AddCost<float>() +
+             Eigen::TensorOpCost::MulCost<float>()));
+    d.parallelFor(batch_size * output_height, rows_cost, gather_rows);
+    d.parallelFor(batch_size * output_height, columns_cost, gather_columns);
   }
 };
 
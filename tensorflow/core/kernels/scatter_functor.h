@@ -16,7 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_SCATTER_FUNCTOR_H_
 
+#include <algorithm>
+#include <numeric>
 #include <type_traits>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -260,20 +263,77 @@ struct ScatterFunctorBase {
     return -1;
   }
 
+  // Applies the updates in the order of their indices, so that params is
+  // walked sequentially rather than at random. The sort is stable, so the
+  // updates to a duplicate index are still applied in their original order.
+  // A shard starts and ends at the first update to an index, so all the
+  // updates to one index are applied by one shard and no locks are needed.
+  Index SortedExecute(OpKernelContext* c, const Device& d,
+                      typename TTypes<T>::Matrix params,
+                      typename TTypes<T>::ConstMatrix updates,
+                      typename TTypes<Index>::ConstFlat indices) {
+    const Index N = static_cast<Index>(indices.size());
+    const Index limit = static_cast<Index>(params.dimension(0));
+    std::vector<Index> index_of(N);
+    for (Index i = 0; i < N; ++i) {
+      // Grab each index only once; see SerialExecute.
+      index_of[i] = ::tensorflow::internal::SubtleMustCopy(indices(i));
+      if (!FastBoundsCheck(index_of[i], limit)) {
+        // Leave params as the unsorted order would when it fails.
+        return SerialExecute(c, d, params, updates, indices);
+      }
+    }
+    std::vector<Index> order(N);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](Index a, Index b) {
+      return index_of[a] < index_of[b];
+    });
+    auto first_of_run = [&](int64 pos) {
+      while (pos > 0 && pos < N &&
+             index_of[order[pos]] == index_of[order[pos - 1]]) {
+        ++pos;
+      }
+      return pos;
+    };
+    auto SortedScatter = [&](int64 start, int64 end) {
+      const int64 run_end = first_of_run(end);
+      for (int64 pos = first_of_run(start); pos < run_end; ++pos) {
+        const Index i = order[pos];
+        scatter_op::internal::Assign<op>::Run(
+            params.template chip<0>(index_of[i]), updates.template chip<0>(i));
+      }
+    };
+    const float kMovingCost = 2.5f;
+    float shard_cost = kMovingCost * params.dimension(1);
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *(c->device()->tensorflow_cpu_worker_threads());
+    Shard(worker_threads.num_threads, worker_threads.workers, N, shard_cost,
+          SortedScatter);
+    return -1;
+  }
+
   Index operator()(OpKernelContext* c, const Device& d,
                    typename TTypes<T>::Matrix params,
                    typename TTypes<T>::ConstMatrix updates,
                    typename TTypes<Index>::ConstFlat indices) {
+    // indices and params sizes were validated in DoCompute().
+    const Index N = static_cast<Index>(indices.size());
+    const Index min_n_threshold = 1024;
+    // Rows of a large params are unlikely to be in cache, so random updates
+    // to them are bound by the latency of memory. Sorting the indices first
+    // makes the accesses sequential, which pays for the sort.
+    const int64 min_sorted_params_bytes = 1 << 24;
+    if (N >= min_n_threshold &&
+        static_cast<int64>(params.size() * sizeof(T)) >=
+            min_sorted_params_bytes) {
+      return SortedExecute(c, d, params, updates, indices);
+    }
 #ifdef PLATFORM_GOOGLE
     // The parallel version is significantly slower internally. Only call the
     // serial version for now.
-    // TODO(penporn): Avoid locking in parallelization (sort beforehand).
     return SerialExecute(c, d, params, updates, indices);
 #else
-    // indices and params sizes were validated in DoCompute().
-    const Index N = static_cast<Index>(indices.size());
     const Index limit = static_cast<Index>(params.dimension(0));
-    const Index min_n_threshold = 1024;
     const Index ser_par_ratio = 10000;
     // For parallelizing the updates, duplicate entries need to be handled
     // correctly. Multiple updates to the same index has to be serialized.
@@ -217,6 +217,30 @@ TEST_F(ScatterSubOpTest, StressIndexTest) {
   test::ExpectTensorEqual<int32>(expected, params_tensor);
 }
 
+TEST_F(ScatterSubOpTest, LargeParamsWithDuplicateIndices) {
+  MakeOp(DT_INT32_REF, DT_INT32);
+  // Large enough params to apply the updates in sorted order.
+  const int kRows = 1 << 22;
+  const int kNumUpdates = 100000;
+  std::vector<int32> values(kRows, 0);
+  std::vector<int32> indices(kNumUpdates);
+  std::vector<int32> updates(kNumUpdates);
+  std::vector<int32> expected_values(kRows, 0);
+  for (int i = 0; i < kNumUpdates; ++i) {
+    indices[i] = (kNumUpdates - i) % 1000 * 4099;
+    updates[i] = i;
+    expected_values[indices[i]] -= i;
+  }
+  AddInputFromArray<int32>(TensorShape({kRows}), values);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), indices);
+  AddInputFromArray<int32>(TensorShape({kNumUpdates}), updates);
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor params_tensor = *mutable_input(0).tensor;
+  Tensor expected(allocator(), DT_INT32, TensorShape({kRows}));
+  test::FillValues<int32>(&expected, expected_values);
+  test::ExpectTensorEqual<int32>(expected, params_tensor);
+}
+
 TEST_F(ScatterUpdateOpTest, Error_WrongDimsIndices) {
   MakeOp(DT_FLOAT_REF, DT_INT32);
 
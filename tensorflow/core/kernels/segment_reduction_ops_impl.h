@@ -23,6 +23,9 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
@@ -38,7 +41,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/segment_reduction_ops.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/util/util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
 #include "tensorflow/core/common_runtime/gpu/gpu_event_mgr.h"
@@ -503,60 +508,87 @@ class SparseSegmentReductionOpBase : public OpKernel {
                 errors::InvalidArgument("segment ids must be >= 0"));
     auto output_flat = output->flat_outer_dims<T>();
 
-    int64 start = 0, end = 1;
-    // Index from which the output is not initialized.
-    OutputRow uninitialized_index = 0;
-    OutputRow out_index = internal::SubtleMustCopy(segment_vec(start));
-
-    while (true) {
+    // Find the segments first, checking that their ids are increasing and in
+    // range, so that they can then be reduced in parallel.
+    std::vector<int64> segment_starts = {0};
+    std::vector<OutputRow> segment_rows = {
+        internal::SubtleMustCopy(segment_vec(0))};
+    for (int64 i = 1; i <= num_indices; ++i) {
       // We initialize next_index to 0 to avoid "warning: 'next_index' may be
       // used uninitialized in this function" in the Mac build (since the
       // compiler isn't smart enough to realize the code is safe).
       OutputRow next_index = 0;
-      if (end < num_indices) {
-        next_index = internal::SubtleMustCopy(segment_vec(end));
-        if (out_index == next_index) {
-          ++end;
-          continue;
-        }
+      const OutputRow out_index = segment_rows.back();
+      if (i < num_indices) {
+        next_index = internal::SubtleMustCopy(segment_vec(i));
+        if (out_index == next_index) continue;
         // We have a new segment here.  Verify that the segment ids are growing.
         OP_REQUIRES(context, out_index < next_index,
                     errors::InvalidArgument("segment ids are not increasing"));
       }
-
       OP_REQUIRES(
           context, FastBoundsCheck(out_index, output_rows),
           errors::InvalidArgument(
               "Segment id ", out_index, " out of range [0, ", output_rows,
               "), possibly because 'segment_ids' input is not sorted."));
+      segment_starts.push_back(i);
+      if (i < num_indices) segment_rows.push_back(next_index);
+    }
+    const int64 num_segments = segment_rows.size();
+
+    // Half and bfloat16 rows are summed in float, so that long segments do not
+    // lose precision.
+    const bool accumulate_in_float = std::is_same<T, Eigen::half>::value ||
+                                     std::is_same<T, bfloat16>::value;
+    mutex mu;
+    int64 bad_index = num_indices;  // Guarded by mu.
+    auto reduce_segments = [&](int64 begin, int64 end) {
+      std::vector<float> scratch(accumulate_in_float ? num_col : 0);
+      for (int64 s = begin; s < end; ++s) {
+        const OutputRow out_index = segment_rows[s];
+        // If there is a gap between two segments, we need to set that gap to
+        // the default value.
+        const OutputRow uninitialized_index =
+            s == 0 ? 0 : segment_rows[s - 1] + 1;
+        if (out_index > uninitialized_index) {
+          Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
+              out_index - uninitialized_index, num_col);
+          Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>,
+                           Eigen::Unaligned>
+              gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
+          gap_slice.setConstant(default_value_);
+        }
 
-      // If there is a gap between two indices, we need to set that gap to the
-      // default value.
-      if (out_index > uninitialized_index) {
-        Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
-            out_index - uninitialized_index, num_col);
-        Eigen::TensorMap<Eigen::Tensor<T, 2, Eigen::RowMajor>, Eigen::Unaligned>
-            gap_slice(&output_flat(uninitialized_index, 0), gap_slice_shape);
-        gap_slice.setConstant(default_value_);
+        const int64 start = segment_starts[s];
+        const int64 num = segment_starts[s + 1] - start;
+        auto out = output_flat.template chip<0>(out_index);
+        const int64 bad_offset =
+            accumulate_in_float
+                ? ReduceInFloat(input_flat, indices_vec, start, num,
+                                scratch.data(), out)
+                : Reduce(input_flat, indices_vec, start, num, out);
+        if (bad_offset >= 0) {
+          mutex_lock l(mu);
+          bad_index = std::min(bad_index, start + bad_offset);
+          return;
+        }
       }
-
-      auto out = output_flat.template chip<0>(out_index);
-      const int bad_offset =
-          Reduce(input_flat, indices_vec, start, end - start, out);
-      OP_REQUIRES(context, bad_offset < 0,
-                  errors::InvalidArgument(
-                      "Bad: indices[", start + bad_offset,
-                      "] == ", indices_vec(start + bad_offset),
-                      " out of range [0, ", input_flat.dimension(0), ")"));
-
-      start = end;
-      ++end;
-      uninitialized_index = out_index + 1;
-      out_index = next_index;
-      if (end > num_indices) break;
-    }
+    };
+    // Each segment reads its rows and writes one output row.
+    const int64 cost_per_segment =
+        (num_indices / num_segments + 1) * num_col *
+        (Eigen::TensorOpCost::AddCost<T>() + 2 * sizeof(T));
+    const DeviceBase::CpuWorkerThreads& worker_threads =
+        *context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_segments,
+          cost_per_segment, reduce_segments);
+    OP_REQUIRES(context, bad_index == num_indices,
+                errors::InvalidArgument(
+                    "Bad: indices[", bad_index, "] == ", indices_vec(bad_index),
+                    " out of range [0, ", input_flat.dimension(0), ")"));
 
     // Fill the gap at the end with the default value.
+    const OutputRow uninitialized_index = segment_rows.back() + 1;
     if (uninitialized_index < output_rows) {
       Eigen::DSizes<Eigen::DenseIndex, 2> gap_slice_shape(
           output_rows - uninitialized_index, num_col);
@@ -569,10 +601,14 @@ class SparseSegmentReductionOpBase : public OpKernel {
  private:
   typedef int32 Index;
 
-  int64 Reduce(const typename TTypes<T>::ConstMatrix& input_flat,
-               const typename TTypes<Index>::ConstVec& indices_vec, int64 start,
-               int64 num,
-               Eigen::TensorChippingOp<0, typename TTypes<T>::Matrix> out) {
+  // Reduces the `num` rows of `input_flat` listed from `indices_vec(start)`
+  // into `out`. Returns the offset of the first index that is out of bounds,
+  // or -1.
+  int64 Reduce(
+      const typename TTypes<T>::ConstMatrix& input_flat,
+      const typename TTypes<Index>::ConstVec& indices_vec, int64 start,
+      int64 num,
+      Eigen::TensorChippingOp<0, typename TTypes<T>::Matrix> out) const {
 #define INDEX(n, i)                               \
   const auto index##n = indices_vec(start + (i)); \
   if (!FastBoundsCheck(index##n, input_flat.dimension(0))) return (i);
@@ -696,6 +732,30 @@ class SparseSegmentReductionOpBase : public OpKernel {
 #undef INDEX
   }
 
+  // Same as Reduce, but sums the rows in `scratch`, a buffer of one row of
+  // floats.
+  int64 ReduceInFloat(
+      const typename TTypes<T>::ConstMatrix& input_flat,
+      const typename TTypes<Index>::ConstVec& indices_vec, int64 start,
+      int64 num, float* scratch,
+      Eigen::TensorChippingOp<0, typename TTypes<T>::Matrix> out) const {
+    typename TTypes<float>::Vec sum(scratch, input_flat.dimension(1));
+    sum.setZero();
+    for (int64 i = 0; i < num; ++i) {
+      const auto index = indices_vec(start + i);
+      if (!FastBoundsCheck(index, input_flat.dimension(0))) return i;
+      sum += input_flat.template chip<0>(index).template cast<float>();
+    }
+    if (is_mean_ && num > 1) {
+      sum = sum / static_cast<float>(num);
+    }
+    if (is_sqrtn_ && num > 1) {
+      sum = sum / std::sqrt(static_cast<float>(num));
+    }
+    out = sum.template cast<T>();
+    return -1;
+  }
+
   const bool is_mean_;
   const bool is_sqrtn_;
   const bool has_num_segments_;
@@ -166,4 +166,52 @@ static void BM_SparseSegmentMeanGrad_High(int iters, int size) {
 BENCHMARK(BM_SparseSegmentMeanGrad_Low)->Arg(1000)->Arg(100000);
 BENCHMARK(BM_SparseSegmentMeanGrad_High)->Arg(1000)->Arg(100000);
 
+// Embedding-style lookup: sums `bag_size` random rows of a table of dimension
+// 64 for each of 1024 segments.
+template <typename T>
+static void SparseSegmentSumHelper(int iters, int bag_size) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  const int kNumRows = 100000;
+  const int kDim = 64;
+  const int kNumSegments = 1024;
+  const int kNumIndices = kNumSegments * bag_size;
+  Tensor input(DataTypeToEnum<T>::v(), TensorShape({kNumRows, kDim}));
+  input.flat<T>().setConstant(T(0.5f));
+  Tensor indices(DT_INT32, TensorShape({kNumIndices}));
+  Tensor segments(DT_INT32, TensorShape({kNumIndices}));
+  auto indices_flat = indices.flat<int32>();
+  auto segments_flat = segments.flat<int32>();
+  for (int i = 0; i < kNumIndices; ++i) {
+    indices_flat(i) = (static_cast<int64>(i) * 7919) % kNumRows;
+    segments_flat(i) = i / bag_size;
+  }
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "SparseSegmentSum")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, indices))
+                  .Input(test::graph::Constant(g, segments))
+                  .Attr("T", DataTypeToEnum<T>::v())
+                  .Finalize(g, &node));
+
+  testing::UseRealTime();
+  testing::BytesProcessed(static_cast<int64>(iters) * kNumIndices * kDim *
+                          sizeof(T));
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
+static void BM_SparseSegmentSum_Float(int iters, int bag_size) {
+  return SparseSegmentSumHelper<float>(iters, bag_size);
+}
+
+static void BM_SparseSegmentSum_BFloat16(int iters, int bag_size) {
+  return SparseSegmentSumHelper<bfloat16>(iters, bag_size);
+}
+
+BENCHMARK(BM_SparseSegmentSum_Float)->Arg(1)->Arg(16)->Arg(256);
+BENCHMARK(BM_SparseSegmentSum_BFloat16)->Arg(1)->Arg(16)->Arg(256);
+
 }  // namespace tensorflow
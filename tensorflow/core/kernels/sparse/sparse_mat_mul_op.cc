@@ -19,8 +19,10 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
+#include <vector>
 
 #include "third_party/eigen3/Eigen/SparseCore"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
@@ -74,8 +76,10 @@ void SwapDimSizes(const int dim_a, const int dim_b, TensorShape* shape) {
 // the op's interface.
 //
 // If multiple threads are available, we parallelize across multiple batches
-// using Eigen ThreadPool. Within a single batch, we run in single threaded mode
-// because Eigen's Sparse-Sparse matmul doesn't support multithreading.
+// using Eigen ThreadPool. Within a single batch, Eigen's Sparse-Sparse matmul
+// runs single threaded; so when there are fewer batches than threads and
+// neither input is transposed, we instead parallelize each batch across its
+// output rows with a two-phase (symbolic, then numeric) Gustavson product.
 //
 // TODO(b/126472741): Due to the multiple batches of a 3D CSRSparseMatrix being
 // laid out in contiguous memory, this implementation allocates memory to store
@@ -181,29 +185,45 @@ class CSRSparseMatMulCPUOp : public OpKernel {
     const int64 matmul_cost_per_batch =
         num_output_rows * (avg_nnz_per_row_a * avg_nnz_per_row_b);
 
-    // Parallelize matrix multiplication across batches.
-    Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
-          matmul_cost_per_batch, [&](int64 batch_begin, int64 batch_end) {
-            for (int64 batch_idx = batch_begin; batch_idx < batch_end;
-                 ++batch_idx) {
-              // For each batch, map the CSRSparseMatrix as Eigen SparseMatrix
-              // without copying the underlying data.
-              auto a_ref = GetSparseMatrixRef(*input_matrix_a, rank, batch_idx,
-                                              transpose_a_, adjoint_a_);
-              auto b_ref = GetSparseMatrixRef(*input_matrix_b, rank, batch_idx,
-                                              transpose_b_, adjoint_b_);
-
-              // Matrix multiply while *not* pruning numerical zeros on the fly.
-              // Allocates output SparseMatrix and moves it to our list of
-              // output_matrices.
-              output_matrices[batch_idx] = a_ref * b_ref;
-
-              // For now, batch_ptr contains the number of nonzeros in each
-              // batch.
-              batch_ptr_vec(batch_idx + 1) =
-                  output_matrices[batch_idx].nonZeros();
-            }
-          });
+    const bool transposed =
+        transpose_a_ || adjoint_a_ || transpose_b_ || adjoint_b_;
+    if (!transposed && batch_size < worker_threads.num_threads) {
+      // Parallelize matrix multiplication across the rows of each batch.
+      const int64 matmul_cost_per_row =
+          1 + static_cast<int64>(avg_nnz_per_row_a * avg_nnz_per_row_b);
+      for (int batch_idx = 0; batch_idx < batch_size; ++batch_idx) {
+        RowParallelMatMul(worker_threads, *input_matrix_a, *input_matrix_b,
+                          rank, batch_idx, matmul_cost_per_row,
+                          &output_matrices[batch_idx]);
+        batch_ptr_vec(batch_idx + 1) = output_matrices[batch_idx].nonZeros();
+      }
+    } else {
+      // Parallelize matrix multiplication across batches.
+      Shard(worker_threads.num_threads, worker_threads.workers, batch_size,
+            matmul_cost_per_batch, [&](int64 batch_begin, int64 batch_end) {
+              for (int64 batch_idx = batch_begin; batch_idx < batch_end;
+                   ++batch_idx) {
+                // For each batch, map the CSRSparseMatrix as Eigen
+                // SparseMatrix without copying the underlying data.
+                auto a_ref = GetSparseMatrixRef(*input_matrix_a, rank,
+                                                batch_idx, transpose_a_,
+                                                adjoint_a_);
+                auto b_ref = GetSparseMatrixRef(*input_matrix_b, rank,
+                                                batch_idx, transpose_b_,
+                                                adjoint_b_);
+
+                // Matrix multiply while *not* pruning numerical zeros on the
+                // fly. Allocates output SparseMatrix and moves it to our list
+                // of output_matrices.
+                output_matrices[batch_idx] = a_ref * b_ref;
+
+                // For now, batch_ptr contains the number of nonzeros in each
+                // batch.
+                batch_ptr_vec(batch_idx + 1) =
+                    output_matrices[batch_idx].nonZeros();
+              }
+            });
+    }
 
     // Compute the cumulative sum to obtain the batch pointers.
     std::partial_sum(batch_ptr_vec.data(),
@@ -260,6 +280,86 @@ class CSRSparseMatMulCPUOp : public OpKernel {
   }
 
  private:
+  // Computes the product of the batch_index'th matrices of a and b into
+  // `output`, sharding the rows of a across the worker threads. A symbolic
+  // pass first counts the nonzeros of each output row, so that the numeric
+  // pass can write every row directly into its final position. As with
+  // Eigen's product, numerical zeros are not pruned.
+  void RowParallelMatMul(const DeviceBase::CpuWorkerThreads& worker_threads,
+                         const CSRSparseMatrix& a, const CSRSparseMatrix& b,
+                         const int rank, const int batch_index,
+                         const int64 cost_per_row, SparseMatrix* output) {
+    const int64 num_rows = a.dense_shape().vec<int64>()(rank == 2 ? 0 : 1);
+    const int64 num_cols = b.dense_shape().vec<int64>()(rank == 2 ? 1 : 2);
+    const int32* a_row_ptr = a.row_pointers_vec(batch_index).data();
+    const int32* a_col_ind = a.col_indices_vec(batch_index).data();
+    const T* a_values = a.values_vec<T>(batch_index).data();
+    const int32* b_row_ptr = b.row_pointers_vec(batch_index).data();
+    const int32* b_col_ind = b.col_indices_vec(batch_index).data();
+    const T* b_values = b.values_vec<T>(batch_index).data();
+
+    output->resize(num_rows, num_cols);
+    int32* row_ptr = output->outerIndexPtr();
+
+    // Symbolic phase: row_ptr[row + 1] is set to the number of distinct
+    // columns in the output row. `last_row[col]` is the last row in this
+    // shard that had a nonzero at col.
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          cost_per_row, [&](int64 row_begin, int64 row_end) {
+            std::vector<int64> last_row(num_cols, -1);
+            for (int64 row = row_begin; row < row_end; ++row) {
+              int32 row_nnz = 0;
+              for (int32 i = a_row_ptr[row]; i < a_row_ptr[row + 1]; ++i) {
+                const int32 k = a_col_ind[i];
+                for (int32 j = b_row_ptr[k]; j < b_row_ptr[k + 1]; ++j) {
+                  const int32 col = b_col_ind[j];
+                  if (last_row[col] != row) {
+                    last_row[col] = row;
+                    ++row_nnz;
+                  }
+                }
+              }
+              row_ptr[row + 1] = row_nnz;
+            }
+          });
+    row_ptr[0] = 0;
+    std::partial_sum(row_ptr, row_ptr + num_rows + 1, row_ptr);
+    output->resizeNonZeros(row_ptr[num_rows]);
+    int32* col_ind = output->innerIndexPtr();
+    T* values = output->valuePtr();
+
+    // Numeric phase: accumulate each output row in a dense buffer, then
+    // gather it in ascending column order.
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          2 * cost_per_row, [&](int64 row_begin, int64 row_end) {
+            std::vector<int64> last_row(num_cols, -1);
+            std::vector<T> accumulator(num_cols);
+            for (int64 row = row_begin; row < row_end; ++row) {
+              int32* row_col_ind = col_ind + row_ptr[row];
+              int32 row_nnz = 0;
+              for (int32 i = a_row_ptr[row]; i < a_row_ptr[row + 1]; ++i) {
+                const T a_value = a_values[i];
+                const int32 k = a_col_ind[i];
+                for (int32 j = b_row_ptr[k]; j < b_row_ptr[k + 1]; ++j) {
+                  const int32 col = b_col_ind[j];
+                  if (last_row[col] != row) {
+                    last_row[col] = row;
+                    accumulator[col] = a_value * b_values[j];
+                    row_col_ind[row_nnz++] = col;
+                  } else {
+                    accumulator[col] += a_value * b_values[j];
+                  }
+                }
+              }
+              std::sort(row_col_ind, row_col_ind + row_nnz);
+              T* row_values = values + row_ptr[row];
+              for (int32 i = 0; i < row_nnz; ++i) {
+                row_values[i] = accumulator[row_col_ind[i]];
+              }
+            }
+          });
+  }
+
   // Returns an Eigen::Ref expression of a SparseMatrix; which points to the
   // underlying memory of the given CSRSparseMatrix.
   Eigen::Ref<const SparseMatrix> GetSparseMatrixRef(
@@ -16,20 +16,94 @@ limitations under the License.
 #define EIGEN_USE_THREADS
 
 #include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/radix_sort.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Reorders the entries of a sparse tensor into row-major order by radix
+// sorting their linear indices into the dense shape, which fit in an int64
+// since the shape is valid. Sets `*reordered` to false, and outputs nothing,
+// if some index is out of bounds.
+template <typename T>
+Status ReorderByLinearIndex(OpKernelContext* context, const Tensor& input_ind,
+                            const Tensor& input_val,
+                            const TensorShape& input_shape, bool* reordered) {
+  const auto ix = input_ind.matrix<int64>();
+  const int64 nnz = ix.dimension(0);
+  const int dims = ix.dimension(1);
+  gtl::InlinedVector<int64, 8> strides(dims);
+  int64 stride = 1;
+  for (int d = dims - 1; d >= 0; --d) {
+    strides[d] = stride;
+    stride *= input_shape.dim_size(d);
+  }
+
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  std::vector<int64> keys(nnz);
+  std::atomic<bool> in_bounds(true);
+  Shard(worker_threads.num_threads, worker_threads.workers, nnz, 5 * dims,
+        [&](int64 start, int64 limit) {
+          for (int64 i = start; i < limit; ++i) {
+            int64 key = 0;
+            for (int d = 0; d < dims; ++d) {
+              const int64 index = ix(i, d);
+              if (index < 0 || index >= input_shape.dim_size(d)) {
+                in_bounds = false;
+                return;
+              }
+              key += index * strides[d];
+            }
+            keys[i] = key;
+          }
+        });
+  *reordered = in_bounds;
+  if (!*reordered) return Status::OK();
+
+  std::vector<int64> permutation(nnz);
+  std::iota(permutation.begin(), permutation.end(), 0);
+  RadixSortPairs(worker_threads, nnz, keys.data(), permutation.data());
+
+  Tensor* output_ind = nullptr;
+  Tensor* output_val = nullptr;
+  TF_RETURN_IF_ERROR(
+      context->allocate_output(0, input_ind.shape(), &output_ind));
+  TF_RETURN_IF_ERROR(
+      context->allocate_output(1, input_val.shape(), &output_val));
+  auto output_ix = output_ind->matrix<int64>();
+  const auto vals = input_val.vec<T>();
+  auto output_vals = output_val->vec<T>();
+  Shard(worker_threads.num_threads, worker_threads.workers, nnz, 2 * dims + 2,
+        [&](int64 start, int64 limit) {
+          for (int64 i = start; i < limit; ++i) {
+            const int64 j = permutation[i];
+            for (int d = 0; d < dims; ++d) {
+              output_ix(i, d) = ix(j, d);
+            }
+            output_vals(i) = vals(j);
+          }
+        });
+  return Status::OK();
+}
+
+}  // namespace
+
 template <typename T>
 class SparseReorderOp : public OpKernel {
  public:
@@ -69,6 +143,11 @@ class SparseReorderOp : public OpKernel {
       context->set_output(0, input_sp.indices());
       context->set_output(1, input_sp.values());
     } else {
+      bool reordered;
+      OP_REQUIRES_OK(context,
+                     ReorderByLinearIndex<T>(context, input_ind, input_val,
+                                             input_shape, &reordered));
+      if (reordered) return;
       // Deep-copy the input Tensors, then reorder in-place
       sparse::SparseTensor reordered_sp;
       OP_REQUIRES_OK(context,
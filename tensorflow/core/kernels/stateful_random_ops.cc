@@ -101,6 +101,7 @@ Status UpdateVariableAndFill(
     TF_RETURN_IF_ERROR(CheckPhiloxState(*var_tensor, alg_tag_skip));
     TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, StateElementType>(
         ctx, var_tensor, var->copy_on_read_mode.load()));
+    var->MarkAllRowsDirty();
 
     UpdateVariableAndFill_Philox_Arg arg;
     arg.output_size = output_size;
@@ -257,6 +258,7 @@ class RngSkipOp : public OpKernel {
       OP_REQUIRES_OK(ctx, CheckPhiloxState(*var_tensor));
       OP_REQUIRES_OK(ctx, PrepareToUpdateVariable<Device, StateElementType>(
                               ctx, var_tensor, var->copy_on_read_mode.load()));
+      var->MarkAllRowsDirty();
       RngSkip_Philox<Device>()(ctx->eigen_device<Device>(), delta, var_tensor);
     } else {
       OP_REQUIRES(ctx, false,
@@ -15,7 +15,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_STRING_UTIL_H_
 #define TENSORFLOW_CORE_KERNELS_STRING_UTIL_H_
 
+#include <cstring>
+
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/platform/tstring.h"
 
 namespace tensorflow {
 
@@ -31,6 +35,33 @@ enum class CharUnit { BYTE, UTF8_CHAR };
 // Whether or not the given byte is the trailing byte of a UTF-8/16/32 char.
 inline bool IsTrailByte(char x) { return static_cast<signed char>(x) < -0x40; }
 
+// Sets `output` to the strings in `pieces` joined by `separator`. Unlike
+// assigning the result of absl::StrJoin, this sizes `output` once and copies
+// the pieces straight into it, so it makes at most one allocation and none
+// for results that fit in the small string buffer.
+template <typename Container>
+void JoinInto(const Container& pieces, StringPiece separator,
+              tstring* output) {
+  size_t size = 0;
+  for (const auto& piece : pieces) size += StringPiece(piece).size();
+  if (!pieces.empty()) size += separator.size() * (pieces.size() - 1);
+  output->resize_uninitialized(size);
+  char* out = output->mdata();
+  bool first = true;
+  for (const auto& piece : pieces) {
+    if (!first && !separator.empty()) {
+      std::memcpy(out, separator.data(), separator.size());
+      out += separator.size();
+    }
+    first = false;
+    const StringPiece value(piece);
+    if (!value.empty()) {
+      std::memcpy(out, value.data(), value.size());
+      out += value.size();
+    }
+  }
+}
+
 // Sets `encoding` based on `str`.
 Status ParseUnicodeEncoding(const string& str, UnicodeEncoding* encoding);
 
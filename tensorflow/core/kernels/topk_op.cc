@@ -99,6 +99,90 @@ class TopK : public OpKernel {
 
 namespace functor {
 
+// Rows at least this many times longer than k are split into column blocks
+// when there are too few rows to keep the thread pool busy.
+constexpr int64 kMinTopKBlockSize = 1 << 15;
+
+// Computes the top k of each row in two passes: the top k of each of
+// `num_blocks` column blocks of a row are selected in parallel, and then the
+// top k of those num_blocks * k candidates give the top k of the row. Since
+// the candidates are ordered by value and then by index, this selects exactly
+// the same elements as a single pass over the row.
+template <typename T>
+Status TopKByColumnBlocks(OpKernelContext* context, bool sorted, int k,
+                          const typename TTypes<T, 2>::ConstTensor& input,
+                          const int64 num_rows, const int64 num_cols,
+                          const int64 num_blocks,
+                          typename TTypes<T, 2>::Tensor values,
+                          typename TTypes<int, 2>::Tensor indices) {
+  const auto make_stable_comp = [](const T* input_data) {
+    return [input_data](const int32 a, const int32 b) {
+      if (input_data[b] < input_data[a]) {
+        return true;
+      } else if (input_data[b] > input_data[a]) {
+        return false;
+      } else {
+        return a < b;
+      }
+    };
+  };
+  using StableComp =
+      decltype(make_stable_comp(static_cast<const T*>(nullptr)));
+
+  // Each block has at least k columns, so it contributes exactly k
+  // candidates.
+  const int64 block_size = (num_cols + num_blocks - 1) / num_blocks;
+  std::vector<int32> candidates(num_rows * num_blocks * k);
+  auto select_blocks = [&](int64 start, int64 limit) {
+    for (int64 i = start; i < limit; ++i) {
+      const int64 row = i / num_blocks;
+      const int32 begin = (i % num_blocks) * block_size;
+      const int32 end = std::min(begin + block_size, num_cols);
+      gtl::TopN<int32, StableComp> filter(k,
+                                          make_stable_comp(&input(row, 0)));
+      filter.reserve(end - begin);
+      for (int32 c = begin; c < end; ++c) {
+        filter.push(c);
+      }
+      std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                candidates.begin() + i * k);
+    }
+  };
+
+  auto merge_blocks = [&](int64 start, int64 limit) {
+    for (int64 row = start; row < limit; ++row) {
+      gtl::TopN<int32, StableComp> filter(k,
+                                          make_stable_comp(&input(row, 0)));
+      const auto row_begin = candidates.begin() + row * num_blocks * k;
+      for (auto it = row_begin; it != row_begin + num_blocks * k; ++it) {
+        filter.push(*it);
+      }
+      if (sorted) {
+        std::unique_ptr<std::vector<int32>> top_k(filter.Extract());
+        std::copy(top_k->begin(), top_k->end(), &indices(row, 0));
+      } else {
+        std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                  &indices(row, 0));
+      }
+      std::transform(
+          &indices(row, 0), &indices(row, k), &values(row, 0),
+          [row, &input](const int32 loc) { return input(row, loc); });
+    }
+  };
+
+  const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<int32>() +
+                          Eigen::TensorOpCost::AddCost<T>();
+  const double log_k = Eigen::numext::log2(static_cast<float>(k + 1));
+  auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+  Shard(worker_threads.num_threads, worker_threads.workers,
+        num_rows * num_blocks,
+        static_cast<int64>(4 * cmp_cost * block_size * log_k), select_blocks);
+  Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+        static_cast<int64>(4 * cmp_cost * num_blocks * k * log_k),
+        merge_blocks);
+  return Status::OK();
+}
+
 template <typename T>
 struct TopKFunctor<CPUDevice, T> {
   static EIGEN_ALWAYS_INLINE Status
@@ -136,6 +220,18 @@ struct TopKFunctor<CPUDevice, T> {
       return Status::OK();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    // Sharding over rows alone leaves most threads idle when there are only a
+    // few long rows, as in retrieval over millions of candidates.
+    const int64 num_blocks = std::min<int64>(
+        worker_threads.num_threads,
+        num_cols / std::max<int64>(kMinTopKBlockSize, 4 * k));
+    if (k < num_cols && num_rows < worker_threads.num_threads &&
+        num_blocks > 1) {
+      return TopKByColumnBlocks<T>(context, sorted, k, input, num_rows,
+                                   num_cols, num_blocks, values, indices);
+    }
+
     auto SortIndices = [&](int start_batch, int limit_batch) {
       for (int32 b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -221,7 +317,6 @@ struct TopKFunctor<CPUDevice, T> {
     const int64 final_cost = (total_cost >= static_cast<double>(kint64max))
                                  ? kint64max
                                  : static_cast<int64>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
@@ -15,10 +15,23 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/training_op_helpers.h"
 
+#include "tensorflow/core/platform/hash.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
 
+namespace {
+
+// Number of lock stripes returned by GetRowLockStripe.
+constexpr int kNumRowLockStripes = 1024;
+
+}  // namespace
+
+mutex* GetRowLockStripe(const void* base, int64 row) {
+  static mutex* stripes = new mutex[kNumRowLockStripes];
+  const uint64 hash = Hash64Combine(reinterpret_cast<uintptr_t>(base), row);
+  return &stripes[hash % kNumRowLockStripes];
+}
 
 void MaybeForwardRefInputToRefOutput(OpKernelContext* ctx, int input,
                                      int output) {
@@ -249,6 +249,7 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
     }
     TF_RETURN_IF_ERROR(PrepareToUpdateVariable<Device, T>(
         ctx, var->tensor(), var->copy_on_read_mode.load()));
+    var->MarkAllRowsDirty();
     *out = *var->tensor();
     return Status::OK();
   }
@@ -256,6 +257,52 @@ Status GetInputTensorFromVariable(OpKernelContext* ctx, int input,
   return Status::OK();
 }
 
+// Returns the mutex, out of a fixed pool of lock stripes shared by all
+// variables, that guards row "row" of the variable whose buffer starts at
+// "base". Sparse updates that hold the variable's lock shared can update each
+// row under its stripe, so that updates of different rows run concurrently.
+// At most one stripe may be held at a time.
+mutex* GetRowLockStripe(const void* base, int64 row);
+
+// Holds the lock stripe of row "row" of the variable whose buffer starts at
+// "base" for its lifetime, if "enabled".
+class MaybeRowLock {
+ public:
+  MaybeRowLock(bool enabled, const void* base, int64 row)
+      TF_NO_THREAD_SAFETY_ANALYSIS
+      : mu_(enabled ? GetRowLockStripe(base, row) : nullptr) {
+    if (mu_ != nullptr) mu_->lock();
+  }
+  ~MaybeRowLock() TF_NO_THREAD_SAFETY_ANALYSIS {
+    if (mu_ != nullptr) mu_->unlock();
+  }
+
+ private:
+  mutex* const mu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MaybeRowLock);
+};
+
+// Marks the rows "indices" of the resource variables at inputs "input_ids" as
+// dirty for delta checkpoints, once a sparse update of the variables, whose
+// first dimension has "num_rows" elements, succeeded.  Indices in device
+// memory cannot be inspected, so they mark the whole variables.
+template <typename Device>
+void MarkSparselyUpdatedRows(OpKernelContext* ctx,
+                             const std::vector<int>& input_ids,
+                             const Tensor& indices, int64 num_rows) {
+  for (int input : input_ids) {
+    if (ctx->input_dtype(input) != DT_RESOURCE) continue;
+    core::RefCountPtr<Var> var;
+    if (!LookupResource(ctx, HandleFromInput(ctx, input), &var).ok()) continue;
+    if (std::is_same<Device, Eigen::ThreadPoolDevice>::value) {
+      var->MarkRowsDirty(indices, num_rows);
+    } else {
+      var->MarkAllRowsDirty();
+    }
+  }
+}
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_KERNELS_TRAINING_OP_HELPERS_H_
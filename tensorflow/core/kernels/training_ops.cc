@@ -20,6 +20,8 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <numeric>
+#include <vector>
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -996,6 +998,8 @@ class SparseApplyAdadeltaOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0, 1, 2}, indices,
+                                       var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -1220,6 +1224,7 @@ class SparseApplyProximalGradientDescentOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0}, indices, var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -1575,19 +1580,25 @@ class SparseApplyAdagradOp : public OpKernel {
  public:
   explicit SparseApplyAdagradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    if (ctx->HasAttr("use_row_locking")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("use_row_locking", &use_row_locking_));
+    }
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // With row locking, the variables are only locked shared and each row is
+    // updated under its lock stripe instead.
+    const bool lock_variables = use_exclusive_lock_ && !use_row_locking_;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, lock_variables, sparse, {0, 1});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
-                            ctx, 0, use_exclusive_lock_, sparse, &var));
+                            ctx, 0, lock_variables, sparse, &var));
     Tensor accum;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
-                            ctx, 1, use_exclusive_lock_, sparse, &accum));
+                            ctx, 1, lock_variables, sparse, &accum));
     OP_REQUIRES(
         ctx, var.IsInitialized(),
         errors::FailedPrecondition(
@@ -1659,6 +1670,7 @@ class SparseApplyAdagradOp : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+            MaybeRowLock row_lock(use_row_locking_, var_flat.data(), index);
             auto a = accum_flat.template chip<0>(index);
             auto g = grad_flat.template chip<0>(i);
             auto v = var_flat.template chip<0>(index);
@@ -1690,6 +1702,7 @@ class SparseApplyAdagradOp : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+            MaybeRowLock row_lock(use_row_locking_, var_flat.data(), index);
             T& a = accum_flat(index);
             const T& g = grad_flat(i);
             if (update_slots_) {
@@ -1703,11 +1716,13 @@ class SparseApplyAdagradOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0, 1}, indices, var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
  private:
   bool use_exclusive_lock_;
+  bool use_row_locking_ = false;
   bool update_slots_;
 };
 
@@ -1742,19 +1757,25 @@ class SparseApplyAdagradV2Op : public OpKernel {
  public:
   explicit SparseApplyAdagradV2Op(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    if (ctx->HasAttr("use_row_locking")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("use_row_locking", &use_row_locking_));
+    }
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // With row locking, the variables are only locked shared and each row is
+    // updated under its lock stripe instead.
+    const bool lock_variables = use_exclusive_lock_ && !use_row_locking_;
     auto locks = MaybeLockVariableInputMutexesInOrder<CPUDevice, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1});
+        ctx, lock_variables, sparse, {0, 1});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
-                            ctx, 0, use_exclusive_lock_, sparse, &var));
+                            ctx, 0, lock_variables, sparse, &var));
     Tensor accum;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<CPUDevice, T>(
-                            ctx, 1, use_exclusive_lock_, sparse, &accum));
+                            ctx, 1, lock_variables, sparse, &accum));
     OP_REQUIRES(
         ctx, var.IsInitialized(),
         errors::FailedPrecondition(
@@ -1831,6 +1852,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+            MaybeRowLock row_lock(use_row_locking_, var_flat.data(), index);
             auto a = accum_flat.template chip<0>(index);
             auto g = grad_flat.template chip<0>(i);
             auto v = var_flat.template chip<0>(index);
@@ -1864,6 +1886,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
         const auto shard = [&](Tindex start_idx, Tindex end_idx) -> void {
           for (Tindex i = start_idx; i < end_idx; ++i) {
             const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+            MaybeRowLock row_lock(use_row_locking_, var_flat.data(), index);
             T& a = accum_flat(index);
             const T& g = grad_flat(i);
             if (update_slots_) {
@@ -1878,11 +1901,13 @@ class SparseApplyAdagradV2Op : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0, 1}, indices, var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
  private:
   bool use_exclusive_lock_;
+  bool use_row_locking_ = false;
   bool update_slots_;
 };
 
@@ -2061,6 +2086,7 @@ class SparseApplyProximalAdagradOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0, 1}, indices, var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2359,6 +2385,8 @@ class SparseApplyAdagradDAOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0, 1, 2}, indices,
+                                       var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -2579,21 +2607,27 @@ class SparseApplyFtrlOp : public OpKernel {
  public:
   explicit SparseApplyFtrlOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    if (ctx->HasAttr("use_row_locking")) {
+      OP_REQUIRES_OK(ctx, ctx->GetAttr("use_row_locking", &use_row_locking_));
+    }
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
     const bool sparse = true;
+    // With row locking, the variables are only locked shared and each row is
+    // updated under its lock stripe instead.
+    const bool lock_variables = use_exclusive_lock_ && !use_row_locking_;
     auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
-        ctx, use_exclusive_lock_, sparse, {0, 1, 2});
+        ctx, lock_variables, sparse, {0, 1, 2});
     Tensor var;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
-                            ctx, 0, use_exclusive_lock_, sparse, &var));
+                            ctx, 0, lock_variables, sparse, &var));
     Tensor accum;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
-                            ctx, 1, use_exclusive_lock_, sparse, &accum));
+                            ctx, 1, lock_variables, sparse, &accum));
     Tensor linear;
     OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
-                            ctx, 2, use_exclusive_lock_, sparse, &linear));
+                            ctx, 2, lock_variables, sparse, &linear));
     OP_REQUIRES(
         ctx, var.IsInitialized(),
         errors::FailedPrecondition(
@@ -2705,6 +2739,7 @@ class SparseApplyFtrlOp : public OpKernel {
                       errors::InvalidArgument(
                           strings::StrCat("Index ", index, " at offset ", i,
                                           " in indices is out of range")));
+          MaybeRowLock row_lock(use_row_locking_, var_flat.data(), index);
           auto accum = accum_flat.template chip<0>(index);
           auto linear = linear_flat.template chip<0>(index);
           auto grad = grad_flat.template chip<0>(i);
@@ -2767,6 +2802,7 @@ class SparseApplyFtrlOp : public OpKernel {
                       errors::InvalidArgument(
                           strings::StrCat("Index ", index, " at offset ", i,
                                           " in indices is out of range")));
+          MaybeRowLock row_lock(use_row_locking_, var_flat.data(), index);
           T& a = accum_flat(index);
           T& l = linear_flat(index);
           T& v = var_flat(index);
@@ -2791,11 +2827,13 @@ class SparseApplyFtrlOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<Device>(ctx, {0, 1, 2}, indices, var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
  private:
   bool use_exclusive_lock_;
+  bool use_row_locking_ = false;
 };
 
 #define REGISTER_KERNELS(T, Tindices)                                         \
@@ -3052,6 +3090,7 @@ class SparseApplyMomentumOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0, 1}, indices, var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -3271,6 +3310,7 @@ class SparseApplyKerasMomentumOp : public OpKernel {
             "indices", SliceDebugString(indices.shape(), bad_i), " = ",
             indices_flat(bad_i), " is not in [0, ", var.dim_size(0), ")"));
 
+    MarkSparselyUpdatedRows<Device>(ctx, {0, 1}, indices, var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -3620,6 +3660,225 @@ REGISTER_KERNELS(GPU, complex128);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+namespace {
+
+// Updates the variables of ResourceApplyAdamMulti one at a time, with one
+// ApplyAdam per variable.
+template <typename Device, typename T>
+struct ApplyAdamMultiImpl {
+  static void Run(OpKernelContext* ctx, std::vector<Tensor>* var,
+                  std::vector<Tensor>* m, std::vector<Tensor>* v,
+                  const Tensor& beta1_power, const Tensor& beta2_power,
+                  const Tensor& lr, const Tensor& beta1, const Tensor& beta2,
+                  const Tensor& epsilon, const OpInputList& grad,
+                  bool use_nesterov) {
+    const Device& device = ctx->template eigen_device<Device>();
+    for (int i = 0; i < var->size(); ++i) {
+      functor::ApplyAdam<Device, T>()(
+          device, (*var)[i].flat<T>(), (*m)[i].flat<T>(), (*v)[i].flat<T>(),
+          beta1_power.scalar<T>(), beta2_power.scalar<T>(), lr.scalar<T>(),
+          beta1.scalar<T>(), beta2.scalar<T>(), epsilon.scalar<T>(),
+          grad[i].flat<T>(), use_nesterov);
+    }
+  }
+};
+
+// On CPU, the variables are cut into chunks of at most kAdamMultiChunkSize
+// elements, and all the chunks are sharded across the intra-op threads at
+// once, so that many small variables are updated in parallel.
+constexpr int64 kAdamMultiChunkSize = 16384;
+
+template <typename T>
+struct ApplyAdamMultiImpl<CPUDevice, T> {
+  static void Run(OpKernelContext* ctx, std::vector<Tensor>* var,
+                  std::vector<Tensor>* m, std::vector<Tensor>* v,
+                  const Tensor& beta1_power, const Tensor& beta2_power,
+                  const Tensor& lr, const Tensor& beta1, const Tensor& beta2,
+                  const Tensor& epsilon, const OpInputList& grad,
+                  bool use_nesterov) {
+    struct Chunk {
+      int index;
+      int64 begin;
+      int64 size;
+    };
+    std::vector<Chunk> chunks;
+    for (int i = 0; i < var->size(); ++i) {
+      const int64 num_elements = (*var)[i].NumElements();
+      for (int64 begin = 0; begin < num_elements;
+           begin += kAdamMultiChunkSize) {
+        chunks.push_back(
+            {i, begin, std::min(kAdamMultiChunkSize, num_elements - begin)});
+      }
+    }
+    if (chunks.empty()) return;
+
+    const T alpha = lr.scalar<T>()() *
+                    Eigen::numext::sqrt(T(1) - beta2_power.scalar<T>()()) /
+                    (T(1) - beta1_power.scalar<T>()());
+    const T beta1_v = beta1.scalar<T>()();
+    const T beta2_v = beta2.scalar<T>()();
+    const T epsilon_v = epsilon.scalar<T>()();
+    auto shard = [&](int64 begin, int64 end) {
+      for (int64 c = begin; c < end; ++c) {
+        const Chunk& chunk = chunks[c];
+        auto var_c = typename TTypes<T>::UnalignedTensor(
+            (*var)[chunk.index].flat<T>().data() + chunk.begin, chunk.size);
+        auto m_c = typename TTypes<T>::UnalignedTensor(
+            (*m)[chunk.index].flat<T>().data() + chunk.begin, chunk.size);
+        auto v_c = typename TTypes<T>::UnalignedTensor(
+            (*v)[chunk.index].flat<T>().data() + chunk.begin, chunk.size);
+        auto g = typename TTypes<T>::UnalignedConstTensor(
+            grad[chunk.index].flat<T>().data() + chunk.begin, chunk.size);
+
+        m_c += (g - m_c) * (T(1) - beta1_v);
+        v_c += (g.square() - v_c) * (T(1) - beta2_v);
+        if (use_nesterov) {
+          var_c -= ((g * (T(1) - beta1_v) + beta1_v * m_c) * alpha) /
+                   (v_c.sqrt() + epsilon_v);
+        } else {
+          var_c -= (m_c * alpha) / (v_c.sqrt() + epsilon_v);
+        }
+      }
+    };
+
+    // Input data: var, v, m, grad.
+    // Output data: var, v, m.
+    const Eigen::TensorOpCost cost(
+        kAdamMultiChunkSize * sizeof(T) * 4,
+        kAdamMultiChunkSize * sizeof(T) * 3,
+        kAdamMultiChunkSize * (Eigen::TensorOpCost::AddCost<T>() * 10 +
+                               Eigen::TensorOpCost::MulCost<T>() * 6 +
+                               Eigen::TensorOpCost::DivCost<T>()));
+    ctx->eigen_device<CPUDevice>().parallelFor(chunks.size(), cost, shard);
+  }
+};
+
+}  // namespace
+
+// Applies Adam to a list of variables that share the scalar arguments, in a
+// single kernel. This saves the per-op overhead of one ResourceApplyAdam per
+// variable for models with many small variables.
+template <typename Device, typename T>
+class ApplyAdamMultiOp : public OpKernel {
+ public:
+  explicit ApplyAdamMultiOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("use_nesterov", &use_nesterov_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("N", &num_vars_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const bool sparse = false;
+    const int n = num_vars_;
+    std::vector<int> variable_inputs(3 * n);
+    std::iota(variable_inputs.begin(), variable_inputs.end(), 0);
+    auto locks = MaybeLockVariableInputMutexesInOrder<Device, T>(
+        ctx, use_exclusive_lock_, sparse, variable_inputs);
+
+    const Tensor& beta1_power = ctx->input(3 * n);
+    const Tensor& beta2_power = ctx->input(3 * n + 1);
+    const Tensor& lr = ctx->input(3 * n + 2);
+    const Tensor& beta1 = ctx->input(3 * n + 3);
+    const Tensor& beta2 = ctx->input(3 * n + 4);
+    const Tensor& epsilon = ctx->input(3 * n + 5);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1_power.shape()),
+                errors::InvalidArgument("beta1_power is not a scalar: ",
+                                        beta1_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2_power.shape()),
+                errors::InvalidArgument("beta2_power is not a scalar: ",
+                                        beta2_power.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(lr.shape()),
+                errors::InvalidArgument("lr is not a scalar : ",
+                                        lr.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta1.shape()),
+                errors::InvalidArgument("beta1 is not a scalar: ",
+                                        beta1.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(beta2.shape()),
+                errors::InvalidArgument("beta2 is not a scalar: ",
+                                        beta2.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(epsilon.shape()),
+                errors::InvalidArgument("epsilon is not a scalar: ",
+                                        epsilon.shape().DebugString()));
+
+    OpInputList grad;
+    OP_REQUIRES_OK(ctx, ctx->input_list("grad", &grad));
+    std::vector<Tensor> var(n);
+    std::vector<Tensor> m(n);
+    std::vector<Tensor> v(n);
+    for (int i = 0; i < n; ++i) {
+      OP_REQUIRES_OK(ctx, GetInputTensorFromVariable<Device, T>(
+                              ctx, i, use_exclusive_lock_, sparse, &var[i]));
+      OP_REQUIRES_OK(ctx,
+                     GetInputTensorFromVariable<Device, T>(
+                         ctx, n + i, use_exclusive_lock_, sparse, &m[i]));
+      OP_REQUIRES_OK(ctx,
+                     GetInputTensorFromVariable<Device, T>(
+                         ctx, 2 * n + i, use_exclusive_lock_, sparse, &v[i]));
+      OP_REQUIRES(ctx, var[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(i)));
+      OP_REQUIRES(ctx, m[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(n + i)));
+      OP_REQUIRES(ctx, v[i].IsInitialized(),
+                  errors::FailedPrecondition(
+                      "Attempting to use uninitialized variables: ",
+                      requested_input(2 * n + i)));
+      OP_REQUIRES(
+          ctx, var[i].shape().IsSameSize(m[i].shape()),
+          errors::InvalidArgument("var and m do not have the same shape",
+                                  var[i].shape().DebugString(), " ",
+                                  m[i].shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var[i].shape().IsSameSize(v[i].shape()),
+          errors::InvalidArgument("var and v do not have the same shape",
+                                  var[i].shape().DebugString(), " ",
+                                  v[i].shape().DebugString()));
+      OP_REQUIRES(
+          ctx, var[i].shape().IsSameSize(grad[i].shape()),
+          errors::InvalidArgument("var and grad do not have the same shape",
+                                  var[i].shape().DebugString(), " ",
+                                  grad[i].shape().DebugString()));
+    }
+
+    ApplyAdamMultiImpl<Device, T>::Run(ctx, &var, &m, &v, beta1_power,
+                                       beta2_power, lr, beta1, beta2, epsilon,
+                                       grad, use_nesterov_);
+  }
+
+ private:
+  bool use_exclusive_lock_;
+  bool use_nesterov_;
+  int num_vars_;
+};
+
+#define REGISTER_KERNELS(D, T)                                    \
+  REGISTER_KERNEL_BUILDER(Name("ResourceApplyAdamMulti")          \
+                              .HostMemory("var")                  \
+                              .HostMemory("m")                    \
+                              .HostMemory("v")                    \
+                              .Device(DEVICE_##D)                 \
+                              .TypeConstraint<T>("T"),            \
+                          ApplyAdamMultiOp<D##Device, T>);
+#define REGISTER_CPU_KERNELS(T) REGISTER_KERNELS(CPU, T);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+TF_CALL_complex64(REGISTER_CPU_KERNELS);
+TF_CALL_complex128(REGISTER_CPU_KERNELS);
+
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+REGISTER_KERNELS(GPU, Eigen::half);
+REGISTER_KERNELS(GPU, float);
+REGISTER_KERNELS(GPU, double);
+#endif
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
 template <typename Device, typename T>
 class ApplyAdamWithAmsgradOp : public OpKernel {
  public:
@@ -4269,6 +4528,8 @@ class SparseApplyRMSPropOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0, 1, 2}, indices,
+                                       var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
@@ -4411,6 +4672,8 @@ class SparseApplyCenteredRMSPropOp : public OpKernel {
       }
     }
 
+    MarkSparselyUpdatedRows<CPUDevice>(ctx, {0, 1, 2, 3}, indices,
+                                       var.dim_size(0));
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
 
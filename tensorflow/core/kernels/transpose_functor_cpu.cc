@@ -15,7 +15,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
 #include <complex>
+#include <type_traits>
 
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -65,12 +67,130 @@ void TransposeSimple(const CPUDevice& device, const Tensor& in,
   device.parallelFor(in.NumElements(), cost, std::move(transpose_fn));
 }
 
+// Bytes of one edge of the square tiles copied by TransposeBlocked, which are
+// at least 16 elements on each side. A tile is at most 4KB, so the input and
+// output lines of a tile stay in L1 while it is copied.
+constexpr int64 kTransposeTileEdgeBytes = 64;
+
+// Transposes `in` into `out` for any permutation of any rank.
+//
+// Input dimensions that stay adjacent in the output are merged first. Then, if
+// the innermost input dimension is also innermost in the output, each output
+// row is a contiguous copy. Otherwise the innermost input dimension and the
+// input dimension that becomes innermost in the output form a 2-D transpose,
+// which is copied in square tiles so that each tile reads and writes full
+// cache lines; every other dimension, in output order, indexes the tiles. Rows
+// and tiles are sharded across the threads of `device`.
+template <typename T>
+void TransposeBlocked(const CPUDevice& device, const Tensor& in,
+                      const gtl::ArraySlice<int32> perm, Tensor* out) {
+  const int64 num_elements = in.NumElements();
+  if (num_elements == 0) return;
+  internal::TransposePermsVec output_positions;
+  internal::TransposeDimsVec new_dims(in.dims());
+  internal::ReduceTransposeDimensions(in.shape(), perm, &output_positions,
+                                      &new_dims);
+  // ReduceTransposeDimensions returns the output position of each merged input
+  // dimension, i.e. the inverse of the merged permutation.
+  const int ndims = output_positions.size();
+  internal::TransposePermsVec new_perm(ndims);
+  for (int i = 0; i < ndims; ++i) new_perm[output_positions[i]] = i;
+  const T* src = reinterpret_cast<const T*>(in.tensor_data().data());
+  T* dst = reinterpret_cast<T*>(const_cast<char*>(out->tensor_data().data()));
+
+  gtl::InlinedVector<int64, 8> in_strides(ndims, 1);
+  gtl::InlinedVector<int64, 8> out_dims(ndims);
+  gtl::InlinedVector<int64, 8> out_strides(ndims, 1);
+  for (int i = ndims - 2; i >= 0; --i) {
+    in_strides[i] = in_strides[i + 1] * new_dims[i + 1];
+  }
+  for (int i = 0; i < ndims; ++i) out_dims[i] = new_dims[new_perm[i]];
+  for (int i = ndims - 2; i >= 0; --i) {
+    out_strides[i] = out_strides[i + 1] * out_dims[i + 1];
+  }
+
+  // Sets the input and output offsets of `index`, which enumerates the output
+  // dimensions [0, end_pos) other than `skip_pos` in row-major order.
+  auto batch_offsets = [&](int64 index, int end_pos, int skip_pos,
+                           int64* in_offset, int64* out_offset) {
+    *in_offset = 0;
+    *out_offset = 0;
+    for (int pos = end_pos - 1; pos >= 0; --pos) {
+      if (pos == skip_pos) continue;
+      const int64 i = index % out_dims[pos];
+      index /= out_dims[pos];
+      *in_offset += i * in_strides[new_perm[pos]];
+      *out_offset += i * out_strides[pos];
+    }
+  };
+
+  const int last = ndims - 1;
+  if (new_perm[last] == last) {
+    // Each output row is a contiguous run of the input.
+    const int64 row_size = new_dims[last];
+    auto copy_rows = [&](int64 begin, int64 end) {
+      for (int64 row = begin; row < end; ++row) {
+        int64 in_offset, out_offset;
+        batch_offsets(row, last, /*skip_pos=*/-1, &in_offset, &out_offset);
+        std::copy(src + in_offset, src + in_offset + row_size,
+                  dst + out_offset);
+      }
+    };
+    const Eigen::TensorOpCost cost(/*bytes_loaded=*/row_size * sizeof(T),
+                                   /*bytes_stored=*/row_size * sizeof(T),
+                                   /*compute_cycles=*/ndims);
+    device.parallelFor(num_elements / row_size, cost, copy_rows);
+    return;
+  }
+
+  // The input dimension that is innermost in the output, and the output
+  // position of the innermost input dimension.
+  const int b = new_perm[last];
+  const int a_pos = std::find(new_perm.begin(), new_perm.end(), last) -
+                    new_perm.begin();
+  const int64 dim_a = new_dims[last];
+  const int64 dim_b = new_dims[b];
+  const int64 in_stride_b = in_strides[b];
+  const int64 out_stride_a = out_strides[a_pos];
+  const int64 tile = std::max<int64>(kTransposeTileEdgeBytes / sizeof(T), 16);
+  const int64 tiles_a = (dim_a + tile - 1) / tile;
+  const int64 tiles_b = (dim_b + tile - 1) / tile;
+  const int64 num_batches = num_elements / (dim_a * dim_b);
+
+  auto copy_tiles = [&](int64 begin, int64 end) {
+    for (int64 unit = begin; unit < end; ++unit) {
+      const int64 a_begin = (unit % tiles_a) * tile;
+      const int64 b_begin = (unit / tiles_a % tiles_b) * tile;
+      const int64 a_end = std::min(a_begin + tile, dim_a);
+      const int64 b_end = std::min(b_begin + tile, dim_b);
+      int64 in_offset, out_offset;
+      batch_offsets(unit / (tiles_a * tiles_b), last, a_pos, &in_offset,
+                    &out_offset);
+      for (int64 i = a_begin; i < a_end; ++i) {
+        const T* s = src + in_offset + i;
+        T* d = dst + out_offset + i * out_stride_a;
+        for (int64 j = b_begin; j < b_end; ++j) {
+          d[j] = s[j * in_stride_b];
+        }
+      }
+    }
+  };
+  const Eigen::TensorOpCost cost(/*bytes_loaded=*/tile * tile * sizeof(T),
+                                 /*bytes_stored=*/tile * tile * sizeof(T),
+                                 /*compute_cycles=*/tile * tile + ndims);
+  device.parallelFor(num_batches * tiles_a * tiles_b, cost, copy_tiles);
+}
+
 }  // namespace
 
 template <typename T, bool conjugate>
 struct Transpose<CPUDevice, T, conjugate> {
   static void run(const CPUDevice& d, const Tensor& in,
                   const gtl::ArraySlice<int32> perm, Tensor* out) {
+    if (!conjugate && std::is_trivially_copyable<T>::value) {
+      TransposeBlocked<T>(d, in, perm, out);
+      return;
+    }
     switch (in.dims()) {
       case 2:
         internal::TransposeUsingEigen<CPUDevice, T, 2>(d, in, perm, conjugate,
@@ -13,9 +13,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#define EIGEN_USE_THREADS
+
+#include <vector>
+
+#include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/kernels/transpose_functor.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 
 namespace tensorflow {
@@ -130,4 +136,73 @@ TEST_F(TransposeUtilTest, NonSingletonDimensionAlignment) {
                                                      {0, 1, 2, 5, 4, 3}));
 }
 
+// Transposes `in` element by element, as the reference for DoTranspose.
+template <typename T>
+Tensor ReferenceTranspose(const Tensor& in, const std::vector<int32>& perm) {
+  TensorShape out_shape;
+  for (int32 d : perm) out_shape.AddDim(in.dim_size(d));
+  Tensor out(in.dtype(), out_shape);
+  const int ndims = in.dims();
+  auto in_flat = in.flat<T>();
+  auto out_flat = out.flat<T>();
+  std::vector<int64> out_index(ndims, 0);
+  for (int64 o = 0; o < out.NumElements(); ++o) {
+    int64 i = 0;
+    for (int d = 0; d < ndims; ++d) {
+      int64 stride = 1;
+      for (int k = perm[d] + 1; k < ndims; ++k) stride *= in.dim_size(k);
+      i += out_index[d] * stride;
+    }
+    out_flat(o) = in_flat(i);
+    for (int d = ndims - 1; d >= 0; --d) {
+      if (++out_index[d] < out_shape.dim_size(d)) break;
+      out_index[d] = 0;
+    }
+  }
+  return out;
+}
+
+template <typename T>
+void TestTranspose(const TensorShape& shape, const std::vector<int32>& perm) {
+  Tensor in(DataTypeToEnum<T>::v(), shape);
+  auto in_flat = in.flat<T>();
+  for (int64 i = 0; i < in.NumElements(); ++i) {
+    in_flat(i) = static_cast<T>(i % 101);
+  }
+  const Tensor expected = ReferenceTranspose<T>(in, perm);
+  Tensor out(in.dtype(), expected.shape());
+
+  Eigen::ThreadPool pool(4);
+  Eigen::ThreadPoolDevice device(&pool, pool.NumThreads());
+  TF_ASSERT_OK(DoTranspose(device, in, perm, &out));
+  test::ExpectTensorEqual<T>(expected, out);
+}
+
+template <typename T>
+class TransposeFunctorTest : public ::testing::Test {};
+
+typedef ::testing::Types<int8, int16, float, double, complex128> TransposeTypes;
+TYPED_TEST_SUITE(TransposeFunctorTest, TransposeTypes);
+
+TYPED_TEST(TransposeFunctorTest, MatchesReference) {
+  // Tiled 2-D transposes, with partial tiles.
+  TestTranspose<TypeParam>({67, 45}, {1, 0});
+  TestTranspose<TypeParam>({3, 130, 17}, {0, 2, 1});
+  // NHWC <-> NCHW.
+  TestTranspose<TypeParam>({2, 9, 11, 35}, {0, 3, 1, 2});
+  TestTranspose<TypeParam>({2, 35, 9, 11}, {0, 2, 3, 1});
+  // The innermost dimension stays innermost: contiguous rows.
+  TestTranspose<TypeParam>({5, 7, 33}, {1, 0, 2});
+  TestTranspose<TypeParam>({4, 6, 3, 10}, {2, 0, 1, 3});
+  // Attention-style reshapes and higher ranks.
+  TestTranspose<TypeParam>({2, 19, 4, 24}, {0, 2, 1, 3});
+  TestTranspose<TypeParam>({2, 3, 4, 5, 6, 7}, {5, 3, 1, 0, 4, 2});
+  TestTranspose<TypeParam>({6, 7, 8, 9}, {2, 0, 3, 1});
+  TestTranspose<TypeParam>({2, 2, 2, 2, 2, 2, 2, 2, 3},
+                           {8, 6, 4, 2, 0, 1, 3, 5, 7});
+  // Singleton and empty dimensions.
+  TestTranspose<TypeParam>({1, 40, 1, 20}, {3, 2, 1, 0});
+  TestTranspose<TypeParam>({0, 4, 3}, {2, 1, 0});
+}
+
 }  // namespace tensorflow
@@ -13,10 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <functional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/register_types.h"
@@ -24,11 +27,160 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 
+namespace {
+
+// Inputs with at least this many elements are deduplicated in parallel when
+// unique is run over single elements.
+constexpr int64 kParallelUniqueMinSize = 1 << 17;
+
+// Rough cost of hashing an element and looking it up in a hash table.
+constexpr int64 kUniqueCostPerElement = 100;
+
+// Computes the outputs of unique over the elements of `input` in parallel.
+// The input is split into one block per thread, and the elements of each
+// block are scattered by hash into one partition per thread, keeping them in
+// input order. Every value then lives in exactly one partition, which is
+// deduplicated on its own, and the unique values are numbered in order of
+// their first occurrence, as in the serial implementation.
+template <typename T, typename TIndex>
+void ParallelUniqueElements(OpKernelContext* context, const Tensor& input,
+                            int64 axis, bool compute_counts,
+                            typename TTypes<TIndex>::Vec idx_vec) {
+  const DeviceBase::CpuWorkerThreads& worker_threads =
+      *context->device()->tensorflow_cpu_worker_threads();
+  auto Tin = input.flat<T>();
+  const int64 N = Tin.size();
+  // Partition ids are stored in a byte per element.
+  const int num_partitions = std::min(worker_threads.num_threads, 256);
+  const int64 num_blocks = worker_threads.num_threads;
+  const int64 block_size = (N + num_blocks - 1) / num_blocks;
+  const int64 block_cost = block_size * kUniqueCostPerElement;
+  auto for_each_block = [&](int64 cost, std::function<void(int64, int64)> fn) {
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost, [&](int64 start, int64 limit) {
+            for (int64 b = start; b < limit; ++b) {
+              fn(b * block_size, std::min(N, (b + 1) * block_size));
+            }
+          });
+  };
+
+  // Assign each element to a partition and count the elements of each
+  // partition in each block.
+  std::vector<uint8> partition(N);
+  std::vector<int64> offsets(num_blocks * num_partitions, 0);
+  for_each_block(block_cost, [&](int64 begin, int64 end) {
+    int64* block_offsets = &offsets[begin / block_size * num_partitions];
+    for (int64 i = begin; i < end; ++i) {
+      const uint64 h = hash<T>{}(Tin(i)) * 0x9E3779B97F4A7C15ULL;
+      const uint8 p = ((h >> 32) * num_partitions) >> 32;
+      partition[i] = p;
+      ++block_offsets[p];
+    }
+  });
+
+  // Lay out the partitions one after another, with the elements of each
+  // partition ordered by block.
+  std::vector<int64> partition_begin(num_partitions + 1);
+  int64 offset = 0;
+  for (int p = 0; p < num_partitions; ++p) {
+    partition_begin[p] = offset;
+    for (int64 b = 0; b < num_blocks; ++b) {
+      const int64 count = offsets[b * num_partitions + p];
+      offsets[b * num_partitions + p] = offset;
+      offset += count;
+    }
+  }
+  partition_begin[num_partitions] = offset;
+
+  std::vector<int32> order(N);
+  for_each_block(block_size, [&](int64 begin, int64 end) {
+    int64* block_offsets = &offsets[begin / block_size * num_partitions];
+    for (int64 i = begin; i < end; ++i) {
+      order[block_offsets[partition[i]]++] = i;
+    }
+  });
+
+  // Deduplicate each partition, setting idx to the position of the first
+  // occurrence of each element.
+  struct Entry {
+    int32 first;
+    TIndex count;
+  };
+  std::vector<absl::flat_hash_map<T, Entry, hash<T>>> uniq(num_partitions);
+  Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+        block_cost, [&](int64 start, int64 limit) {
+          for (int64 p = start; p < limit; ++p) {
+            auto& map = uniq[p];
+            map.reserve(partition_begin[p + 1] - partition_begin[p]);
+            for (int64 j = partition_begin[p]; j < partition_begin[p + 1];
+                 ++j) {
+              const int32 i = order[j];
+              auto it = map.try_emplace(Tin(i), Entry{i, 0}).first;
+              ++it->second.count;
+              idx_vec(i) = it->second.first;
+            }
+          }
+        });
+
+  // Number the first occurrences in input order. `order` is reused to map
+  // the position of each first occurrence to its index in the output.
+  std::vector<int64> block_uniq_begin(num_blocks + 1, 0);
+  for_each_block(block_size, [&](int64 begin, int64 end) {
+    int64 count = 0;
+    for (int64 i = begin; i < end; ++i) {
+      count += idx_vec(i) == i;
+    }
+    block_uniq_begin[begin / block_size + 1] = count;
+  });
+  for (int64 b = 0; b < num_blocks; ++b) {
+    block_uniq_begin[b + 1] += block_uniq_begin[b];
+  }
+  const int64 uniq_size = block_uniq_begin[num_blocks];
+
+  TensorShape output_shape(input.shape());
+  output_shape.set_dim(axis, uniq_size);
+  Tensor* output = nullptr;
+  OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+  auto Tout = output->flat<T>();
+  for_each_block(block_size, [&](int64 begin, int64 end) {
+    int64 j = block_uniq_begin[begin / block_size];
+    for (int64 i = begin; i < end; ++i) {
+      if (idx_vec(i) == i) {
+        order[i] = j;
+        Tout(j++) = Tin(i);
+      }
+    }
+  });
+  for_each_block(block_size, [&](int64 begin, int64 end) {
+    for (int64 i = begin; i < end; ++i) {
+      idx_vec(i) = order[idx_vec(i)];
+    }
+  });
+
+  if (compute_counts) {
+    Tensor* count_output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(
+                                2, TensorShape({uniq_size}), &count_output));
+    auto count_output_vec = count_output->template vec<TIndex>();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_partitions,
+          block_size, [&](int64 start, int64 limit) {
+            for (int64 p = start; p < limit; ++p) {
+              for (const auto& it : uniq[p]) {
+                count_output_vec(order[it.second.first]) = it.second.count;
+              }
+            }
+          });
+  }
+}
+
+}  // namespace
+
 template <typename T, typename TIndex>
 class UniqueOp : public OpKernel {
  public:
@@ -98,6 +250,15 @@ class UniqueOp : public OpKernel {
                                 1, TensorShape({new_sizes[1]}), &idx));
     auto idx_vec = idx->template vec<TIndex>();
 
+    const int num_threads =
+        context->device()->tensorflow_cpu_worker_threads()->num_threads;
+    if (new_sizes[0] == 1 && new_sizes[2] == 1 &&
+        new_sizes[1] >= kParallelUniqueMinSize && num_threads > 1) {
+      ParallelUniqueElements<T, TIndex>(context, input, axis,
+                                        num_outputs() > 2, idx_vec);
+      return;
+    }
+
     int64 uniq_size;
     if (new_sizes[0] == 1 && new_sizes[2] == 1) {
       // Specialized and faster implementation when unique is run over single
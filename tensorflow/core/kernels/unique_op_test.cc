@@ -103,6 +103,25 @@ static void BM_Unique_INT32_Repeat(int iters, int dim, int max_int) {
   test::Benchmark("cpu", g).Run(iters);
 }
 
+static void BM_UniqueWithCounts_INT32(int iters, int dim, int max_int) {
+  testing::StopTiming();
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input(DT_INT32, TensorShape({dim}));
+  CHECK(input.FromProto(GetRandomInt32TensorProto(dim, max_int)));
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "UniqueWithCounts")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT32)
+                  .Finalize(g, &node));
+
+  testing::BytesProcessed(static_cast<int64>(iters) * dim * sizeof(int32));
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+}
+
 TensorProto GetRandomStringsTensorProto(int dim, int max_str_len) {
   TensorProto tensor_proto;
   tensor_proto.set_dtype(DT_STRING);
@@ -181,6 +200,13 @@ BENCHMARK(BM_Unique_INT32_Repeat)
     ->ArgPair(64 * 1024, 64 * 1024 * 1024)
     ->ArgPair(1024 * 1024, 64 * 1024 * 1024);
 
+BENCHMARK(BM_UniqueWithCounts_INT32)
+    ->ArgPair(64 * 1024, 1024 * 1024)
+    ->ArgPair(1024 * 1024, 1024 * 1024)
+    ->ArgPair(1024 * 1024, 64 * 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 1024 * 1024)
+    ->ArgPair(16 * 1024 * 1024, 64 * 1024 * 1024);
+
 BENCHMARK(BM_Unique_STRING)
     ->Arg(32)
     ->Arg(256)
@@ -188,7 +214,8 @@ BENCHMARK(BM_Unique_STRING)
     ->Arg(4 * 1024)
     ->Arg(16 * 1024)
     ->Arg(64 * 1024)
-    ->Arg(256 * 1024);
+    ->Arg(256 * 1024)
+    ->Arg(1024 * 1024);
 
 }  // namespace
 }  // namespace tensorflow
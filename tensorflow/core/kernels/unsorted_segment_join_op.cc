@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -134,6 +135,22 @@ class UnsortedSegmentJoinOp : public OpKernel {
         GetStrides<INDICES_TYPE>(input_shape, segment_id_shape);
     auto relative_offset_set =
         GetFlattenedRelativeOffsets<INDICES_TYPE>(small_stride, big_stride);
+    // Size every output first, so that each one is allocated once rather
+    // than grown by every append.
+    std::vector<size_t> output_sizes(output_flat.size(), 0);
+    for (auto start_offset = 0; start_offset < big_stride; start_offset++) {
+      for (auto i = 0; i < relative_offset_set.size(); i++) {
+        auto output_index = start_offset + flat_segment_id(i) * big_stride;
+        auto offset = start_offset + relative_offset_set[i];
+        if (output_sizes[output_index] != 0) {
+          output_sizes[output_index] += separator_.size();
+        }
+        output_sizes[output_index] += flat_input(offset).size();
+      }
+    }
+    for (int64 i = 0; i < output_flat.size(); ++i) {
+      output_flat(i).reserve(output_sizes[i]);
+    }
     for (auto start_offset = 0; start_offset < big_stride; start_offset++) {
       for (auto i = 0; i < relative_offset_set.size(); i++) {
         auto output_index = start_offset + flat_segment_id(i) * big_stride;
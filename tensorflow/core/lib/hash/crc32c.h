@@ -35,6 +35,12 @@ extern uint32 Extend(uint32 init_crc, const char* data, size_t n);
 // Return the crc32c of data[0,n-1]
 inline uint32 Value(const char* data, size_t n) { return Extend(0, data, n); }
 
+// Sets crcs[i] to Value(data[i], sizes[i]) for each i in [0, count). This is
+// faster than separate calls to Value() where the crc32c instruction is used,
+// because independent buffers are processed in an interleaved fashion.
+extern void ValueBatch(const char* const* data, const size_t* sizes,
+                       size_t count, uint32* crcs);
+
 #if defined(PLATFORM_GOOGLE)
 extern uint32 Extend(uint32 init_crc, const absl::Cord& cord);
 inline uint32 Value(const absl::Cord& cord) { return Extend(0, cord); }
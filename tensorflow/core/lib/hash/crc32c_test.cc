@@ -14,6 +14,10 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/lib/hash/crc32c.h"
+
+#include <string>
+#include <vector>
+
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -70,6 +74,27 @@ TEST(CRC, Mask) {
   ASSERT_EQ(crc, Unmask(Unmask(Mask(Mask(crc)))));
 }
 
+TEST(CRC, ValueBatch) {
+  std::vector<std::string> inputs;
+  for (int len : {0, 1, 7, 8, 9, 31, 64, 65, 1000, 4099, 2}) {
+    std::string input(len + 1, 0);
+    for (int i = 0; i < input.size(); ++i) input[i] = i * 7 + len;
+    inputs.push_back(input);
+  }
+  std::vector<const char*> data;
+  std::vector<size_t> sizes;
+  for (const std::string& input : inputs) {
+    // Use unaligned buffers.
+    data.push_back(input.data() + 1);
+    sizes.push_back(input.size() - 1);
+  }
+  std::vector<uint32> crcs(inputs.size());
+  ValueBatch(data.data(), sizes.data(), data.size(), crcs.data());
+  for (int i = 0; i < inputs.size(); ++i) {
+    EXPECT_EQ(Value(data[i], sizes[i]), crcs[i]) << "input " << i;
+  }
+}
+
 #if defined(PLATFORM_GOOGLE)
 TEST(CRC, ValuesWithCord) {
   ASSERT_NE(Value(absl::Cord("a")), Value(absl::Cord("foo")));
@@ -92,5 +117,23 @@ static void BM_CRC(int iters, int len) {
 }
 BENCHMARK(BM_CRC)->Range(1, 256 * 1024);
 
+static void BM_CRCBatch(int iters, int len) {
+  constexpr int kBatchSize = 64;
+  std::vector<std::string> inputs(kBatchSize, std::string(len, 'x'));
+  std::vector<const char*> data;
+  std::vector<size_t> sizes;
+  for (const std::string& input : inputs) {
+    data.push_back(input.data());
+    sizes.push_back(input.size());
+  }
+  std::vector<uint32> crcs(kBatchSize);
+  for (int i = 0; i < iters; i++) {
+    ValueBatch(data.data(), sizes.data(), kBatchSize, crcs.data());
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * kBatchSize * len);
+  VLOG(1) << crcs[0];
+}
+BENCHMARK(BM_CRCBatch)->Range(1, 256 * 1024);
+
 }  // namespace crc32c
 }  // namespace tensorflow
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <limits.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/coding.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/hash/crc32c.h"
@@ -202,5 +204,149 @@ SequentialRecordReader::SequentialRecordReader(
     RandomAccessFile* file, const RecordReaderOptions& options)
     : underlying_(file, options), offset_(0) {}
 
+Status FindRecordStart(RandomAccessFile* file, uint64 file_size, uint64 begin,
+                       uint64 end, uint64* offset) {
+  end = std::min(end, file_size);
+  if (begin == 0 || begin >= end) {
+    *offset = std::min(begin, end);
+    return Status::OK();
+  }
+
+  // The candidate offsets are scanned a block at a time; each block also
+  // holds the header of its last candidate.
+  constexpr uint64 kScanBlockSize = 64 << 10;
+  string block(kScanBlockSize + RecordReader::kHeaderSize, '\0');
+  string data;
+  for (uint64 block_begin = begin; block_begin < end;
+       block_begin += kScanBlockSize) {
+    const size_t n = std::min<uint64>(block.size(), file_size - block_begin);
+    StringPiece bytes;
+    Status s = file->Read(block_begin, n, &bytes, &block[0]);
+    if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+    const uint64 block_end = std::min(block_begin + kScanBlockSize, end);
+    for (uint64 candidate = block_begin; candidate < block_end; ++candidate) {
+      const size_t i = candidate - block_begin;
+      if (i + RecordReader::kHeaderSize > bytes.size()) break;
+      const char* header = bytes.data() + i;
+      if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+          crc32c::Value(header, sizeof(uint64))) {
+        continue;
+      }
+      const uint64 length = core::DecodeFixed64(header);
+      const uint64 remaining =
+          file_size - candidate - RecordReader::kHeaderSize;
+      if (length > remaining ||
+          remaining - length < RecordReader::kFooterSize) {
+        continue;
+      }
+      data.resize(length + RecordReader::kFooterSize);
+      StringPiece record;
+      s = file->Read(candidate + RecordReader::kHeaderSize, data.size(),
+                     &record, &data[0]);
+      if (!s.ok() && !errors::IsOutOfRange(s)) return s;
+      if (record.size() == data.size() &&
+          crc32c::Unmask(core::DecodeFixed32(record.data() + length)) ==
+              crc32c::Value(record.data(), length)) {
+        *offset = candidate;
+        return Status::OK();
+      }
+    }
+  }
+  *offset = end;
+  return Status::OK();
+}
+
+MemoryMappedRecordReader::MemoryMappedRecordReader(
+    ReadOnlyMemoryRegion* region)
+    : data_(static_cast<const char*>(region->data())),
+      size_(region->length()) {}
+
+Status MemoryMappedRecordReader::ReadHeader(uint64 offset,
+                                            StringPiece* record) const {
+  if (offset >= size_) {
+    return errors::OutOfRange("eof");
+  }
+  const uint64 available = size_ - offset;
+  if (available < RecordReader::kHeaderSize) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+
+  // Verify the header in place, with the same checks as
+  // RecordReader::ReadChecksummed().
+  const char* header = data_ + offset;
+  if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+      crc32c::Value(header, sizeof(uint64))) {
+    return errors::DataLoss("corrupted record at ", offset);
+  }
+  const uint64 length = core::DecodeFixed64(header);
+  const uint64 remaining = available - RecordReader::kHeaderSize;
+  if (length > remaining || remaining - length < RecordReader::kFooterSize) {
+    return errors::DataLoss("truncated record at ", offset);
+  }
+  *record = StringPiece(header + RecordReader::kHeaderSize, length);
+  return Status::OK();
+}
+
+/* static */
+uint32 MemoryMappedRecordReader::StoredChecksum(StringPiece record) {
+  return crc32c::Unmask(core::DecodeFixed32(record.data() + record.size()));
+}
+
+Status MemoryMappedRecordReader::ReadRecord(uint64* offset,
+                                            StringPiece* record) const {
+  StringPiece data;
+  TF_RETURN_IF_ERROR(ReadHeader(*offset, &data));
+  if (StoredChecksum(data) != crc32c::Value(data.data(), data.size())) {
+    return errors::DataLoss("corrupted record at ",
+                            *offset + RecordReader::kHeaderSize);
+  }
+  *record = data;
+  *offset += RecordReader::kHeaderSize + data.size() +
+             RecordReader::kFooterSize;
+  return Status::OK();
+}
+
+Status MemoryMappedRecordReader::ReadRecords(
+    uint64* offset, int max_records, std::vector<StringPiece>* records) const {
+  // Frame the records first, so that their data checksums can be computed in
+  // a single batch.
+  std::vector<const char*> data;
+  std::vector<size_t> sizes;
+  std::vector<uint64> offsets;
+  uint64 next_offset = *offset;
+  Status status;
+  while (static_cast<int>(offsets.size()) < max_records) {
+    StringPiece record;
+    status = ReadHeader(next_offset, &record);
+    if (!status.ok()) break;
+    data.push_back(record.data());
+    sizes.push_back(record.size());
+    offsets.push_back(next_offset);
+    next_offset += RecordReader::kHeaderSize + record.size() +
+                   RecordReader::kFooterSize;
+  }
+
+  std::vector<uint32> crcs(data.size());
+  crc32c::ValueBatch(data.data(), sizes.data(), data.size(), crcs.data());
+  size_t num_valid = 0;
+  for (; num_valid < data.size(); ++num_valid) {
+    const StringPiece record(data[num_valid], sizes[num_valid]);
+    if (StoredChecksum(record) != crcs[num_valid]) {
+      status = errors::DataLoss(
+          "corrupted record at ",
+          offsets[num_valid] + RecordReader::kHeaderSize);
+      break;
+    }
+    records->push_back(record);
+  }
+
+  if (num_valid == 0) {
+    return status.ok() ? errors::InvalidArgument("max_records must be > 0")
+                       : status;
+  }
+  *offset = num_valid < offsets.size() ? offsets[num_valid] : next_offset;
+  return Status::OK();
+}
+
 }  // namespace io
 }  // namespace tensorflow
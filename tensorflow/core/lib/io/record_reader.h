@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 #define TENSORFLOW_CORE_LIB_IO_RECORD_READER_H_
 
+#include <vector>
+
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/io/inputstream_interface.h"
@@ -29,6 +31,7 @@ limitations under the License.
 namespace tensorflow {
 
 class RandomAccessFile;
+class ReadOnlyMemoryRegion;
 
 namespace io {
 
@@ -152,6 +155,54 @@ class SequentialRecordReader {
   uint64 offset_ = 0;
 };
 
+// Sets *offset to the offset of the first record of the uncompressed TFRecord
+// file "*file", of size `file_size`, that starts in [begin, end), or to `end`
+// if no record starts there. Records are found by scanning for a header and
+// data whose checksums match. Offset 0 is always a record start.
+//
+// Readers that each read the records starting in one of a set of disjoint
+// ranges read every record of the file exactly once.
+Status FindRecordStart(RandomAccessFile* file, uint64 file_size, uint64 begin,
+                       uint64 end, uint64* offset);
+
+// Reads uncompressed TFRecord files from a memory-mapped region without
+// copying the records.
+//
+// The records returned by ReadRecord() point into "*region", which must
+// remain live while they are in use.
+//
+// Note: this class is not thread safe; external synchronization required.
+class MemoryMappedRecordReader {
+ public:
+  explicit MemoryMappedRecordReader(ReadOnlyMemoryRegion* region);
+
+  // Sets *record to the record at "*offset" and updates *offset to point to
+  // the offset of the next record. Returns OK on success, OUT_OF_RANGE for
+  // end of file, or something else for an error.
+  Status ReadRecord(uint64* offset, StringPiece* record) const;
+
+  // Appends up to `max_records` consecutive records, starting at "*offset",
+  // to *records and updates *offset to point past the last of them. The data
+  // checksums of the records are verified together, which is faster than
+  // verifying them one record at a time. Stops before the first record that
+  // fails to read; its error is returned only if no record was read before it.
+  Status ReadRecords(uint64* offset, int max_records,
+                     std::vector<StringPiece>* records) const;
+
+ private:
+  // Checks the header of the record at `offset` and sets *record to its data,
+  // without verifying the data checksum.
+  Status ReadHeader(uint64 offset, StringPiece* record) const;
+
+  // Returns the masked data checksum stored after `record`.
+  static uint32 StoredChecksum(StringPiece record);
+
+  const char* const data_;
+  const uint64 size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MemoryMappedRecordReader);
+};
+
 }  // namespace io
 }  // namespace tensorflow
 
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -196,6 +197,151 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+// A memory region over the bytes of a string.
+class StringMemoryRegion : public ReadOnlyMemoryRegion {
+ public:
+  explicit StringMemoryRegion(string data) : data_(std::move(data)) {}
+  const void* data() override { return data_.data(); }
+  uint64 length() override { return data_.size(); }
+
+ private:
+  const string data_;
+};
+
+TEST(RecordReaderWriterTest, TestMemoryMapped) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_mmap_test";
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    TF_EXPECT_OK(writer.WriteRecord("abc"));
+    TF_EXPECT_OK(writer.WriteRecord("defg"));
+    TF_CHECK_OK(writer.Close());
+  }
+
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_ASSERT_OK(env->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::MemoryMappedRecordReader reader(region.get());
+  const char* begin = static_cast<const char*>(region->data());
+  uint64 offset = 0;
+  StringPiece record;
+  TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("abc", record);
+  // Records are returned in place.
+  EXPECT_EQ(begin + io::RecordReader::kHeaderSize, record.data());
+  TF_ASSERT_OK(reader.ReadRecord(&offset, &record));
+  EXPECT_EQ("defg", record);
+  EXPECT_EQ(region->length(), offset);
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecord(&offset, &record)));
+
+  // Truncated and corrupted files fail as with RecordReader.
+  const string contents(begin, region->length());
+  StringMemoryRegion truncated(contents.substr(0, contents.size() - 1));
+  io::MemoryMappedRecordReader truncated_reader(&truncated);
+  offset = 0;
+  TF_ASSERT_OK(truncated_reader.ReadRecord(&offset, &record));
+  EXPECT_TRUE(
+      errors::IsDataLoss(truncated_reader.ReadRecord(&offset, &record)));
+
+  string corrupted_contents = contents;
+  corrupted_contents[io::RecordReader::kHeaderSize] ^= 1;
+  StringMemoryRegion corrupted(corrupted_contents);
+  io::MemoryMappedRecordReader corrupted_reader(&corrupted);
+  offset = 0;
+  EXPECT_TRUE(
+      errors::IsDataLoss(corrupted_reader.ReadRecord(&offset, &record)));
+  EXPECT_EQ(0, offset);
+}
+
+TEST(RecordReaderWriterTest, TestMemoryMappedBatch) {
+  string contents;
+  std::vector<string> records;
+  {
+    std::unique_ptr<WritableFile> file;
+    string fname = testing::TmpDir() + "/record_reader_writer_mmap_batch_test";
+    TF_CHECK_OK(Env::Default()->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 10; ++i) {
+      records.push_back(string(i * 5, 'a' + i));
+      TF_EXPECT_OK(writer.WriteRecord(records.back()));
+    }
+    TF_CHECK_OK(writer.Close());
+    TF_CHECK_OK(ReadFileToString(Env::Default(), fname, &contents));
+  }
+
+  StringMemoryRegion region(contents);
+  io::MemoryMappedRecordReader reader(&region);
+  uint64 offset = 0;
+  std::vector<StringPiece> read;
+  TF_ASSERT_OK(reader.ReadRecords(&offset, 4, &read));
+  TF_ASSERT_OK(reader.ReadRecords(&offset, 100, &read));
+  ASSERT_EQ(records.size(), read.size());
+  for (int i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(records[i], read[i]);
+  }
+  EXPECT_EQ(contents.size(), offset);
+  EXPECT_TRUE(errors::IsOutOfRange(reader.ReadRecords(&offset, 4, &read)));
+
+  // The records before a corrupted one are returned first.
+  uint64 corrupted_offset = 0;
+  for (int i = 0; i < 3; ++i) {
+    corrupted_offset += io::RecordReader::kHeaderSize + records[i].size() +
+                        io::RecordReader::kFooterSize;
+  }
+  string corrupted_contents = contents;
+  corrupted_contents[corrupted_offset + io::RecordReader::kHeaderSize] ^= 1;
+  StringMemoryRegion corrupted(corrupted_contents);
+  io::MemoryMappedRecordReader corrupted_reader(&corrupted);
+  offset = 0;
+  read.clear();
+  TF_ASSERT_OK(corrupted_reader.ReadRecords(&offset, 10, &read));
+  EXPECT_EQ(3, read.size());
+  EXPECT_EQ(corrupted_offset, offset);
+  EXPECT_TRUE(
+      errors::IsDataLoss(corrupted_reader.ReadRecords(&offset, 10, &read)));
+  EXPECT_EQ(corrupted_offset, offset);
+}
+
+TEST(RecordReaderWriterTest, TestFindRecordStart) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_find_start_test";
+  std::vector<string> records;
+  {
+    std::unique_ptr<WritableFile> file;
+    TF_CHECK_OK(env->NewWritableFile(fname, &file));
+    io::RecordWriter writer(file.get());
+    for (int i = 0; i < 50; ++i) {
+      records.push_back(string(i * 7 % 23, 'a' + i % 26));
+      TF_EXPECT_OK(writer.WriteRecord(records.back()));
+    }
+    TF_CHECK_OK(writer.Close());
+  }
+  const uint64 file_size = GetFileSize(fname);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(env->NewRandomAccessFile(fname, &file));
+
+  // Every record is read by exactly one of the readers of disjoint ranges.
+  for (int num_shards : {1, 2, 3, 7, 100}) {
+    std::vector<string> read;
+    for (int index = 0; index < num_shards; ++index) {
+      const uint64 begin = file_size * index / num_shards;
+      const uint64 end = file_size * (index + 1) / num_shards;
+      uint64 offset;
+      TF_ASSERT_OK(
+          io::FindRecordStart(file.get(), file_size, begin, end, &offset));
+      io::SequentialRecordReader reader(file.get());
+      TF_ASSERT_OK(reader.SeekOffset(offset));
+      tstring record;
+      while (reader.TellOffset() < end) {
+        TF_ASSERT_OK(reader.ReadRecord(&record));
+        read.push_back(record);
+      }
+    }
+    EXPECT_EQ(records, read) << num_shards;
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -219,4 +365,83 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+// Writes `num_records` records of `record_size` bytes to a file and returns
+// its name.
+static string WriteBenchmarkFile(int num_records, int record_size) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_benchmark";
+  std::unique_ptr<WritableFile> file;
+  TF_CHECK_OK(env->NewWritableFile(fname, &file));
+  io::RecordWriter writer(file.get());
+  const string record(record_size, 'x');
+  for (int i = 0; i < num_records; ++i) {
+    TF_CHECK_OK(writer.WriteRecord(record));
+  }
+  TF_CHECK_OK(writer.Close());
+  return fname;
+}
+
+static void BM_ReadRecord(int iters, int record_size) {
+  testing::StopTiming();
+  constexpr int kNumRecords = 256;
+  const string fname = WriteBenchmarkFile(kNumRecords, record_size);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_CHECK_OK(Env::Default()->NewRandomAccessFile(fname, &file));
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    io::RecordReader reader(file.get());
+    uint64 offset = 0;
+    tstring record;
+    for (int j = 0; j < kNumRecords; ++j) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    }
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * kNumRecords *
+                          record_size);
+}
+BENCHMARK(BM_ReadRecord)->Range(16, 1 << 20);
+
+static void BM_MemoryMappedReadRecord(int iters, int record_size) {
+  testing::StopTiming();
+  constexpr int kNumRecords = 256;
+  const string fname = WriteBenchmarkFile(kNumRecords, record_size);
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(Env::Default()->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::MemoryMappedRecordReader reader(region.get());
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    uint64 offset = 0;
+    StringPiece record;
+    for (int j = 0; j < kNumRecords; ++j) {
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+    }
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * kNumRecords *
+                          record_size);
+}
+BENCHMARK(BM_MemoryMappedReadRecord)->Range(16, 1 << 20);
+
+static void BM_MemoryMappedReadRecords(int iters, int record_size) {
+  testing::StopTiming();
+  constexpr int kNumRecords = 256;
+  constexpr int kBatchSize = 64;
+  const string fname = WriteBenchmarkFile(kNumRecords, record_size);
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  TF_CHECK_OK(Env::Default()->NewReadOnlyMemoryRegionFromFile(fname, &region));
+  io::MemoryMappedRecordReader reader(region.get());
+  std::vector<StringPiece> records;
+  records.reserve(kNumRecords);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    uint64 offset = 0;
+    records.clear();
+    for (int j = 0; j < kNumRecords; j += kBatchSize) {
+      TF_CHECK_OK(reader.ReadRecords(&offset, kBatchSize, &records));
+    }
+  }
+  testing::BytesProcessed(static_cast<int64>(iters) * kNumRecords *
+                          record_size);
+}
+BENCHMARK(BM_MemoryMappedReadRecords)->Range(16, 1 << 20);
+
 }  // namespace tensorflow
@@ -68,6 +68,27 @@ TEST(PhiloxRandomTest, SkipMatchTest) {
   }
 }
 
+// This test checks that generating a batch of samples is equivalent to
+// generating them one group at a time.
+TEST(PhiloxRandomTest, GenerateBatchMatchTest) {
+  constexpr int kBatch = 4;
+
+  uint64 test_seed = GetTestSeed();
+  PhiloxRandom gen1(test_seed);
+  PhiloxRandom gen2(test_seed);
+  for (int iteration = 0; iteration < 8; ++iteration) {
+    PhiloxRandom::ResultType batch[kBatch];
+    gen1.GenerateBatch<kBatch>(batch);
+    for (int b = 0; b < kBatch; ++b) {
+      PhiloxRandom::ResultType single = gen2();
+      for (int i = 0; i < PhiloxRandom::kResultElementCount; ++i) {
+        ASSERT_EQ(batch[b][i], single[i]);
+      }
+    }
+  }
+  EXPECT_EQ(gen1.counter()[0], gen2.counter()[0]);
+}
+
 }  // namespace
 }  // namespace random
 }  // namespace tensorflow
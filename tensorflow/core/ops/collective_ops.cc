@@ -31,6 +31,7 @@ REGISTER_OP("CollectiveReduce")
     .Attr("subdiv_offsets: list(int)")
     .Attr("wait_for: list(int) = []")
     .Attr("communication_hint: string = 'auto'")
+    .Attr("communication_dtype: string = ''")
     .SetIsStateful()
     .SetShapeFn(shape_inference::UnchangedShape);
 
@@ -971,6 +971,43 @@ REGISTER_OP("_FusedMatMul")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("args: num_args * T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 1")
+    .Attr("fused_ops: list(string) >= 1")
+    .Attr("fused_operands: list(int)")
+    .SetShapeFn([](InferenceContext* c) {
+      // Scalar arguments are broadcast, and all the others have the shape of
+      // the output.
+      ShapeHandle output = c->Scalar();
+      bool found_non_scalar = false;
+      for (int i = 0; i < c->num_inputs(); ++i) {
+        ShapeHandle arg = c->input(i);
+        if (c->RankKnown(arg) && c->Rank(arg) == 0) continue;
+        if (!found_non_scalar) {
+          output = arg;
+          found_non_scalar = true;
+        } else {
+          TF_RETURN_IF_ERROR(c->Merge(output, arg, &output));
+        }
+      }
+      c->set_output(0, output);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Evaluates a chain of element-wise ops in a single pass over memory.
+
+Op i of `fused_ops` is applied to the next 1 or 2 values of `fused_operands`,
+which index `args` followed by the results of the previous ops. The output is
+the result of the last op. Scalar `args` are broadcast, and all the other
+`args` must have the same shape.
+
+*NOTE*: Do not invoke this operator directly in Python. Grappler is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 // For operations where the output is a reduction function along some
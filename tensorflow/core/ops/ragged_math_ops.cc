@@ -23,6 +23,7 @@ using shape_inference::InferenceContext;
 using shape_inference::ShapeHandle;
 
 Status RaggedRangeShapeFn(InferenceContext* c);
+Status RaggedReduceRowsShapeFn(InferenceContext* c);
 
 //==============================================================================
 // Registered Ops
@@ -38,6 +39,15 @@ REGISTER_OP("RaggedRange")
     .Attr("Tsplits: {int32, int64} = DT_INT64")
     .SetShapeFn(RaggedRangeShapeFn);
 
+REGISTER_OP("RaggedReduceRows")
+    .Input("values: T")
+    .Input("row_splits: Tsplits")
+    .Output("output: T")
+    .Attr("reduction: {'sum', 'max', 'min'}")
+    .Attr("T: realnumbertypes")
+    .Attr("Tsplits: {int32, int64} = DT_INT64")
+    .SetShapeFn(RaggedReduceRowsShapeFn);
+
 //==============================================================================
 // Shape Functions
 //==============================================================================
@@ -78,4 +88,18 @@ Status RaggedRangeShapeFn(InferenceContext* c) {
   return Status::OK();
 }
 
+Status RaggedReduceRowsShapeFn(InferenceContext* c) {
+  // output.shape = [nrows] + values.shape[1:], where nrows = len(splits) - 1.
+  ShapeHandle values;
+  ShapeHandle row_splits;
+  TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &values));
+  TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &row_splits));
+  DimensionHandle nrows;
+  TF_RETURN_IF_ERROR(c->Subtract(c->Dim(row_splits, 0), 1, &nrows));
+  ShapeHandle output;
+  TF_RETURN_IF_ERROR(c->ReplaceDim(values, 0, nrows, &output));
+  c->set_output(0, output);
+  return Status::OK();
+}
+
 }  // namespace tensorflow
@@ -299,6 +299,7 @@ REGISTER_OP("ResourceSparseApplyAdagrad")
     .Attr("T: numbertype")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
+    .Attr("use_row_locking: bool = false")
     .Attr("update_slots: bool = true")
     .SetShapeFn(ApplyAdagradShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
@@ -368,6 +369,7 @@ REGISTER_OP("ResourceSparseApplyAdagradV2")
     .Attr("T: numbertype")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
+    .Attr("use_row_locking: bool = false")
     .Attr("update_slots: bool = true")
     .SetShapeFn(
         ApplyAdagradV2ShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
@@ -603,6 +605,7 @@ REGISTER_OP("ResourceSparseApplyFtrl")
     .Attr("T: numbertype")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
+    .Attr("use_row_locking: bool = false")
     .SetShapeFn(ApplyFtrlShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
 REGISTER_OP("ApplyFtrlV2")
@@ -665,6 +668,7 @@ REGISTER_OP("ResourceSparseApplyFtrlV2")
     .Attr("T: numbertype")
     .Attr("Tindices: {int32, int64}")
     .Attr("use_locking: bool = false")
+    .Attr("use_row_locking: bool = false")
     .SetShapeFn(ApplyFtrlShapeFn</*is_sparse=*/true, /*is_resource=*/true>);
 
 template <bool is_sparse, bool is_resource>
@@ -818,6 +822,44 @@ REGISTER_OP("ResourceApplyAdam")
     .Attr("use_nesterov: bool = false")
     .SetShapeFn(ApplyAdamShapeFn</*is_resource=*/true>);
 
+static Status ApplyAdamMultiShapeFn(InferenceContext* c) {
+  int n;
+  TF_RETURN_IF_ERROR(c->GetAttr("N", &n));
+  ShapeHandle unused;
+  for (int i = 3 * n; i < 3 * n + 6; ++i) {
+    // beta1_power, beta2_power, lr, beta1, beta2, epsilon
+    TF_RETURN_IF_ERROR(c->WithRank(c->input(i), 0, &unused));
+  }
+  for (int i = 0; i < n; ++i) {
+    ShapeHandle s = ShapeOrHandleShape</*is_resource=*/true>(c, i);  // var
+    TF_RETURN_IF_ERROR(c->Merge(
+        s, ShapeOrHandleShape</*is_resource=*/true>(c, n + i), &s));  // m
+    TF_RETURN_IF_ERROR(c->Merge(
+        s, ShapeOrHandleShape</*is_resource=*/true>(c, 2 * n + i), &s));  // v
+    TF_RETURN_IF_ERROR(
+        HandleGradAndIndicesInputs</*is_sparse=*/false, /*is_resource=*/true>(
+            c, 3 * n + 6 + i /* grad_idx */, &s));
+  }
+  return Status::OK();
+}
+
+REGISTER_OP("ResourceApplyAdamMulti")
+    .Input("var: N * resource")
+    .Input("m: N * resource")
+    .Input("v: N * resource")
+    .Input("beta1_power: T")
+    .Input("beta2_power: T")
+    .Input("lr: T")
+    .Input("beta1: T")
+    .Input("beta2: T")
+    .Input("epsilon: T")
+    .Input("grad: N * T")
+    .Attr("N: int >= 1")
+    .Attr("T: numbertype")
+    .Attr("use_locking: bool = false")
+    .Attr("use_nesterov: bool = false")
+    .SetShapeFn(ApplyAdamMultiShapeFn);
+
 template <bool is_resource>
 static Status ApplyAdamWithAmsgradShapeFn(InferenceContext* c) {
   ShapeHandle unused;
@@ -39,10 +39,12 @@ limitations under the License.
 #include "tensorflow/core/platform/numbers.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/retrying_utils.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/stringprintf.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 #ifdef _WIN32
 #ifdef DeleteFile
@@ -110,6 +112,16 @@ constexpr char kWriteRequestTimeout[] = "GCS_WRITE_REQUEST_TIMEOUT_SECS";
 // The environment variable to configure an additional header to send with
 // all requests to GCS (format HEADERNAME:HEADERCONTENT)
 constexpr char kAdditionalRequestHeader[] = "GCS_ADDITIONAL_REQUEST_HEADER";
+// The environment variable that turns on parallel composite uploads, by setting
+// the size (in MB) of the parts that writable files are uploaded in. A value of
+// 0 (the default) uploads each file in a single resumable upload.
+constexpr char kCompositeUploadPartSize[] = "GCS_COMPOSITE_UPLOAD_PART_SIZE_MB";
+constexpr size_t kDefaultCompositeUploadPartSize = 0;
+// The environment variable that overrides the maximum number of parts of a
+// composite upload that upload at once.
+constexpr char kCompositeUploadParallelism[] =
+    "GCS_COMPOSITE_UPLOAD_PARALLELISM";
+constexpr size_t kDefaultCompositeUploadParallelism = 8;
 // The environment variable to configure the throttle (format: <int64>)
 constexpr char kThrottleRate[] = "GCS_THROTTLE_TOKEN_RATE";
 // The environment variable to configure the token bucket size (format: <int64>)
@@ -678,6 +690,253 @@ class GcsWritableFile : public WritableFile {
   RetryConfig retry_config_;
 };
 
+/// \brief GCS-based implementation of a writeable file that uploads in parts.
+///
+/// Appended data is buffered in memory and uploaded every `part_size` bytes as
+/// a temporary object, with up to `parallelism` parts uploading at once.
+/// Sync() uploads what is left in the buffer as the last part, composes the
+/// parts into the object (after its content from the previous Sync(), if any)
+/// with the GCS compose API, and deletes them. Unlike GcsWritableFile, the
+/// content is never copied to a local file, but a part that cannot be uploaded
+/// fails the whole file, since it is not kept around to retry the upload.
+///
+/// A file that never grows beyond one part is uploaded directly to the
+/// object, without going through the compose API.
+class GcsCompositeWritableFile : public WritableFile {
+ public:
+  GcsCompositeWritableFile(const string& bucket, const string& object,
+                           const string& part_prefix, size_t part_size,
+                           size_t parallelism, GcsFileSystem* filesystem,
+                           GcsFileSystem::TimeoutConfig* timeouts,
+                           std::function<void()> file_cache_erase,
+                           RetryConfig retry_config)
+      : bucket_(bucket),
+        object_(object),
+        part_prefix_(part_prefix),
+        part_size_(part_size),
+        parallelism_(parallelism),
+        filesystem_(filesystem),
+        timeouts_(timeouts),
+        file_cache_erase_(std::move(file_cache_erase)),
+        retry_config_(retry_config) {}
+
+  ~GcsCompositeWritableFile() override {
+    Close().IgnoreError();
+    // Destroying upload_pool_ will block until the parts in flight finish.
+    upload_pool_.reset();
+    // Do not leave the parts of a failed upload behind.
+    DeleteParts(parts_.size());
+  }
+
+  Status Append(StringPiece data) override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    sync_needed_ = true;
+    position_ += data.size();
+    while (!data.empty()) {
+      const size_t n = std::min(data.size(), part_size_ - buffer_.size());
+      buffer_.append(data.data(), n);
+      data.remove_prefix(n);
+      if (buffer_.size() == part_size_) {
+        TF_RETURN_IF_ERROR(StartPartUpload());
+      }
+    }
+    return Status::OK();
+  }
+
+  Status Close() override {
+    if (!closed_) {
+      TF_RETURN_IF_ERROR(Sync());
+      closed_ = true;
+    }
+    return Status::OK();
+  }
+
+  Status Flush() override { return Sync(); }
+
+  Status Name(StringPiece* result) const override {
+    return errors::Unimplemented(
+        "GcsCompositeWritableFile does not support Name()");
+  }
+
+  Status Sync() override {
+    TF_RETURN_IF_ERROR(CheckWritable());
+    if (!sync_needed_) {
+      return Status::OK();
+    }
+    if (!composed_ && parts_.empty()) {
+      // Everything fits in one part: upload it as the object itself.
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [this]() { return UploadObject(object_, buffer_); }, retry_config_));
+      buffer_.clear();
+      composed_ = true;
+    } else {
+      if (!buffer_.empty()) {
+        TF_RETURN_IF_ERROR(StartPartUpload());
+      }
+      TF_RETURN_IF_ERROR(WaitForParts(0));
+      TF_RETURN_IF_ERROR(ComposeParts());
+    }
+    // Erase the file from the file cache on every successful write.
+    file_cache_erase_();
+    sync_needed_ = false;
+    return Status::OK();
+  }
+
+  Status Tell(int64* position) override {
+    *position = position_;
+    return Status::OK();
+  }
+
+ private:
+  /// The maximum number of source objects of one compose request.
+  static constexpr size_t kMaxComposeSources = 32;
+
+  Status CheckWritable() const {
+    if (closed_) {
+      return errors::FailedPrecondition("The file ", GetGcsPath(),
+                                        " is closed.");
+    }
+    return Status::OK();
+  }
+
+  /// Waits until at most `max_in_flight` parts are uploading, and returns the
+  /// error of any part that failed to upload.
+  Status WaitForParts(size_t max_in_flight) {
+    mutex_lock l(mu_);
+    while (parts_in_flight_ > max_in_flight) {
+      parts_done_.wait(l);
+    }
+    return upload_status_;
+  }
+
+  /// Uploads the buffered data as the next part, in the background.
+  Status StartPartUpload() {
+    TF_RETURN_IF_ERROR(WaitForParts(parallelism_ - 1));
+    if (!upload_pool_) {
+      upload_pool_.reset(new thread::ThreadPool(
+          Env::Default(), "gcs_composite_upload", parallelism_));
+    }
+    const string part = strings::StrCat(part_prefix_, "-", num_parts_++);
+    parts_.push_back(part);
+    auto data = std::make_shared<string>();
+    data->swap(buffer_);
+    {
+      mutex_lock l(mu_);
+      ++parts_in_flight_;
+    }
+    upload_pool_->Schedule([this, part, data]() {
+      const Status status = RetryingUtils::CallWithRetries(
+          [this, &part, &data]() { return UploadObject(part, *data); },
+          retry_config_);
+      mutex_lock l(mu_);
+      upload_status_.Update(status);
+      --parts_in_flight_;
+      parts_done_.notify_all();
+    });
+    return Status::OK();
+  }
+
+  /// Uploads `data` to the object `name` in a single request.
+  Status UploadObject(const string& name, const string& data) {
+    std::unique_ptr<HttpRequest> request;
+    TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+    request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket_,
+                                    "/o?uploadType=media&name=",
+                                    request->EscapeString(name)));
+    request->SetTimeouts(timeouts_->connect, timeouts_->idle, timeouts_->write);
+    request->SetPostFromBuffer(data.data(), data.size());
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading gs://",
+                                    bucket_, "/", name);
+    return Status::OK();
+  }
+
+  /// Composes the uploaded parts into the object, and deletes them.
+  Status ComposeParts() {
+    while (!parts_.empty()) {
+      Json::Value body;
+      Json::Value& sources = body["sourceObjects"];
+      if (composed_) {
+        sources.append(Json::Value());
+        sources[0]["name"] = object_;
+      }
+      size_t num_parts = 0;
+      while (num_parts < parts_.size() && sources.size() < kMaxComposeSources) {
+        Json::Value source;
+        source["name"] = parts_[num_parts++];
+        sources.append(source);
+      }
+      Json::FastWriter writer;
+      writer.omitEndingLineFeed();
+      const string body_str = writer.write(body);
+      TF_RETURN_IF_ERROR(RetryingUtils::CallWithRetries(
+          [this, &body_str]() {
+            std::unique_ptr<HttpRequest> request;
+            TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+            request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                            request->EscapeString(object_),
+                                            "/compose"));
+            request->AddHeader("Content-Type", "application/json");
+            request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                                 timeouts_->metadata);
+            request->SetPostFromBuffer(body_str.data(), body_str.size());
+            TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when composing ",
+                                            GetGcsPath());
+            return Status::OK();
+          },
+          retry_config_));
+      composed_ = true;
+      DeleteParts(num_parts);
+    }
+    return Status::OK();
+  }
+
+  /// Deletes the first `num_parts` parts, which are no longer needed.
+  void DeleteParts(size_t num_parts) {
+    for (size_t i = 0; i < num_parts; ++i) {
+      const string part = strings::StrCat("gs://", bucket_, "/", parts_[i]);
+      const Status status = filesystem_->DeleteFile(part);
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to delete the upload part " << part << ": "
+                     << status;
+      }
+    }
+    parts_.erase(parts_.begin(), parts_.begin() + num_parts);
+  }
+
+  string GetGcsPath() const {
+    return strings::StrCat("gs://", bucket_, "/", object_);
+  }
+
+  const string bucket_;
+  const string object_;
+  const string part_prefix_;
+  const size_t part_size_;
+  const size_t parallelism_;
+  GcsFileSystem* const filesystem_;  // Not owned.
+  GcsFileSystem::TimeoutConfig* timeouts_;
+  std::function<void()> file_cache_erase_;
+  RetryConfig retry_config_;
+
+  // The data appended since the last part was started.
+  string buffer_;
+  int64 position_ = 0;
+  bool sync_needed_ = true;
+  bool closed_ = false;
+  // Whether a Sync() has written the object, which then heads the sources of
+  // the next compose request.
+  bool composed_ = false;
+
+  // The names of the parts that have not been composed into the object yet.
+  std::vector<string> parts_;
+  int64 num_parts_ = 0;
+  std::unique_ptr<thread::ThreadPool> upload_pool_;
+
+  mutex mu_;
+  condition_variable parts_done_;
+  size_t parts_in_flight_ TF_GUARDED_BY(mu_) = 0;
+  Status upload_status_ TF_GUARDED_BY(mu_);
+};
+
 class GcsReadOnlyMemoryRegion : public ReadOnlyMemoryRegion {
  public:
   GcsReadOnlyMemoryRegion(std::unique_ptr<char[]> data, uint64 length)
@@ -743,12 +1002,18 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  max_readahead_blocks_ = kDefaultMaxReadaheadBlocks;
+  if (GetEnvVar(kMaxReadaheadBlocks, strings::safe_strtou64, &value)) {
+    max_readahead_blocks_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "max readahead blocks = " << max_readahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -859,6 +1124,16 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
     throttle_.SetConfig(config);
   }
 
+  size_t composite_upload_part_size = kDefaultCompositeUploadPartSize;
+  size_t composite_upload_parallelism = kDefaultCompositeUploadParallelism;
+  if (GetEnvVar(kCompositeUploadPartSize, strings::safe_strtou64, &value)) {
+    composite_upload_part_size = value * 1024 * 1024;
+  }
+  if (GetEnvVar(kCompositeUploadParallelism, strings::safe_strtou64, &value)) {
+    composite_upload_parallelism = value;
+  }
+  SetCompositeUpload(composite_upload_part_size, composite_upload_parallelism);
+
   GetEnvVar(kAllowedBucketLocations, SplitByCommaToLowercaseSet,
             &allowed_locations_);
 }
@@ -970,7 +1245,8 @@ std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
                                  bytes_transferred);
-      }));
+      },
+      Env::Default(), max_readahead_blocks_));
   return file_block_cache;
 }
 
@@ -1040,12 +1316,30 @@ Status GcsFileSystem::NewWritableFile(const string& fname,
                                       std::unique_ptr<WritableFile>* result) {
   string bucket, object;
   TF_RETURN_IF_ERROR(ParseGcsPath(fname, false, &bucket, &object));
+  if (composite_upload_part_size_ > 0) {
+    result->reset(new GcsCompositeWritableFile(
+        bucket, object,
+        strings::StrCat(object, ".part-", NewCompositeUploadId()),
+        composite_upload_part_size_, composite_upload_parallelism_, this,
+        &timeouts_, [this, fname]() { ClearFileCaches(fname); },
+        retry_config_));
+    return Status::OK();
+  }
   result->reset(new GcsWritableFile(bucket, object, this, &timeouts_,
                                     [this, fname]() { ClearFileCaches(fname); },
                                     retry_config_));
   return Status::OK();
 }
 
+void GcsFileSystem::SetCompositeUpload(size_t part_size, size_t parallelism) {
+  composite_upload_part_size_ = part_size;
+  composite_upload_parallelism_ = std::max<size_t>(parallelism, 1);
+}
+
+string GcsFileSystem::NewCompositeUploadId() {
+  return strings::StrCat(strings::Hex(random::New64()));
+}
+
 // Reads the file from GCS in chunks and stores it in a tmp file,
 // which is then passed to GcsWritableFile.
 Status GcsFileSystem::NewAppendableFile(const string& fname,
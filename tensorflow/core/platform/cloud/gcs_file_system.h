@@ -50,6 +50,10 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that overrides the maximum number of blocks fetched
+// in parallel ahead of a sequential reader. A value of 0 disables read-ahead.
+constexpr char kMaxReadaheadBlocks[] = "GCS_READ_CACHE_MAX_READAHEAD_BLOCKS";
+constexpr size_t kDefaultMaxReadaheadBlocks = 4;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -246,6 +250,21 @@ class GcsFileSystem : public FileSystem {
   /// The new auth provider will be used for all subsequent requests.
   void SetAuthProvider(std::unique_ptr<AuthProvider> auth_provider);
 
+  /// \brief Sets how files opened by NewWritableFile are uploaded.
+  ///
+  /// With a positive `part_size`, files are uploaded in parts of `part_size`
+  /// bytes, up to `parallelism` at once, and the parts are composed into the
+  /// object on Sync(). With a `part_size` of 0, each Sync() uploads the whole
+  /// file in a single resumable upload.
+  void SetCompositeUpload(size_t part_size, size_t parallelism);
+
+  size_t composite_upload_part_size() const {
+    return composite_upload_part_size_;
+  }
+  size_t composite_upload_parallelism() const {
+    return composite_upload_parallelism_;
+  }
+
   /// \brief Resets the block cache and re-instantiates it with the new values.
   ///
   /// This method can be used to clear the existing block cache and/or to
@@ -260,6 +279,10 @@ class GcsFileSystem : public FileSystem {
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
 
+  /// Returns an id that tells the parts of a composite upload apart from the
+  /// parts of other uploads to the same object.
+  virtual string NewCompositeUploadId();
+
   /// Loads file contents from GCS for a given filename, offset, and length.
   virtual Status LoadBufferFromGCS(const string& fname, size_t offset, size_t n,
                                    char* buffer, size_t* bytes_transferred);
@@ -343,6 +366,10 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The maximum number of blocks the block cache fetches ahead of a sequential
+  // reader.
+  size_t max_readahead_blocks_ = 0;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -363,6 +390,11 @@ class GcsFileSystem : public FileSystem {
 
   TimeoutConfig timeouts_;
 
+  // The size of the parts that writable files are uploaded in, or 0 to upload
+  // them in one piece, and the number of parts that upload at once.
+  size_t composite_upload_part_size_ = 0;
+  size_t composite_upload_parallelism_ = 1;
+
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
   /// The initial delay for exponential backoffs when retrying failed calls.
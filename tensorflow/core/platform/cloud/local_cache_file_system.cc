@@ -0,0 +1,438 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/local_cache_file_system.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+namespace {
+
+auto* local_cache_block_reads = monitoring::Counter<1>::New(
+    "/tensorflow/core/platform/cloud/local_cache_block_reads",
+    "The number of blocks read through LocalCacheFileSystem, by whether they "
+    "were found in the local cache.",
+    "result");
+
+constexpr char kStateFileName[] = "STATE";
+constexpr char kEvictLockFileName[] = "EVICT.lock";
+constexpr char kBlockSuffix[] = ".block";
+constexpr uint64 kStateMagic = 0x5446424c4f434b31;  // "TFBLOCK1"
+
+// Eviction deletes blocks until the cache is back under this fraction of its
+// budget, so that it does not run again on every insertion.
+constexpr double kEvictLowWatermark = 0.9;
+
+// The layout of the state file that all processes sharing a cache map.
+struct SharedState {
+  uint64 magic;
+  uint64 cached_bytes;
+  uint64 hits;
+  uint64 misses;
+};
+
+Status IOErrorFromErrno(const string& context) {
+  return errors::Internal(context, ": ", strerror(errno));
+}
+
+// Holds an exclusive flock() on `fd` while in scope.
+class ScopedFileLock {
+ public:
+  explicit ScopedFileLock(int fd) : fd_(fd) {
+    while (flock(fd_, LOCK_EX) != 0 && errno == EINTR) {
+    }
+  }
+  ~ScopedFileLock() { flock(fd_, LOCK_UN); }
+
+ private:
+  const int fd_;
+  TF_DISALLOW_COPY_AND_ASSIGN(ScopedFileLock);
+};
+
+class LocalCacheRandomAccessFile : public RandomAccessFile {
+ public:
+  LocalCacheRandomAccessFile(const string& filename, const string& key,
+                             uint64 file_size,
+                             std::unique_ptr<RandomAccessFile> base_file,
+                             LocalCacheFileSystem* file_system)
+      : filename_(filename),
+        key_(key),
+        file_size_(file_size),
+        base_file_(std::move(base_file)),
+        file_system_(file_system) {}
+
+  Status Name(StringPiece* result) const override {
+    return base_file_->Name(result);
+  }
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    *result = StringPiece();
+    if (n == 0) {
+      return Status::OK();
+    }
+    if (offset >= file_size_) {
+      return errors::OutOfRange("EOF reached, offset: ", offset,
+                                " file size: ", file_size_, " in ", filename_);
+    }
+    const size_t block_size = file_system_->block_size();
+    const uint64 end = std::min<uint64>(offset + n, file_size_);
+    size_t copied = 0;
+    for (uint64 pos = offset; pos < end;) {
+      const uint64 block_offset = pos / block_size * block_size;
+      const size_t block_length =
+          std::min<uint64>(block_size, file_size_ - block_offset);
+      const size_t offset_in_block = pos - block_offset;
+      const size_t bytes =
+          std::min<uint64>(block_length - offset_in_block, end - pos);
+      TF_RETURN_IF_ERROR(file_system_->ReadBlock(
+          key_, base_file_.get(), block_offset, block_length, offset_in_block,
+          bytes, scratch + copied));
+      copied += bytes;
+      pos += bytes;
+    }
+    *result = StringPiece(scratch, copied);
+    if (copied < n) {
+      return errors::OutOfRange("EOF reached, ", copied,
+                                " bytes were read out of ", n,
+                                " bytes requested.");
+    }
+    return Status::OK();
+  }
+
+ private:
+  const string filename_;
+  const string key_;
+  const uint64 file_size_;
+  const std::unique_ptr<RandomAccessFile> base_file_;
+  LocalCacheFileSystem* const file_system_;  // not owned
+};
+
+}  // namespace
+
+// static
+Status LocalCacheFileSystem::Create(
+    std::unique_ptr<FileSystem> base_file_system, const string& cache_dir,
+    size_t block_size, uint64 max_bytes,
+    std::unique_ptr<LocalCacheFileSystem>* result) {
+  if (block_size == 0) {
+    return errors::InvalidArgument("The block size of the cache must be > 0");
+  }
+  TF_RETURN_IF_ERROR(Env::Default()->RecursivelyCreateDir(cache_dir));
+  const string state_path = io::JoinPath(cache_dir, kStateFileName);
+  const int fd = open(state_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return IOErrorFromErrno(strings::StrCat("Could not open ", state_path));
+  }
+  void* state = MAP_FAILED;
+  {
+    // Size the state file under its lock, so that a process that opens it at
+    // the same time does not map it before it has room for the state.
+    ScopedFileLock lock(fd);
+    struct stat st;
+    const off_t state_size = sizeof(SharedState);
+    if (fstat(fd, &st) == 0 &&
+        (st.st_size >= state_size || ftruncate(fd, state_size) == 0)) {
+      state = mmap(nullptr, sizeof(SharedState), PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+    }
+    if (state != MAP_FAILED) {
+      auto* shared = static_cast<SharedState*>(state);
+      if (shared->magic != kStateMagic) {
+        memset(shared, 0, sizeof(SharedState));
+        shared->magic = kStateMagic;
+      }
+    }
+  }
+  if (state == MAP_FAILED) {
+    const Status status =
+        IOErrorFromErrno(strings::StrCat("Could not map ", state_path));
+    close(fd);
+    return status;
+  }
+  result->reset(new LocalCacheFileSystem(std::move(base_file_system),
+                                         cache_dir, block_size, max_bytes, fd,
+                                         state));
+  return Status::OK();
+}
+
+LocalCacheFileSystem::LocalCacheFileSystem(
+    std::unique_ptr<FileSystem> base_file_system, const string& cache_dir,
+    size_t block_size, uint64 max_bytes, int state_fd, void* state)
+    : base_file_system_(std::move(base_file_system)),
+      cache_dir_(cache_dir),
+      block_size_(block_size),
+      max_bytes_(max_bytes),
+      state_fd_(state_fd),
+      state_(state) {}
+
+LocalCacheFileSystem::~LocalCacheFileSystem() {
+  munmap(state_, sizeof(SharedState));
+  close(state_fd_);
+}
+
+Status LocalCacheFileSystem::NewRandomAccessFile(
+    const string& filename, std::unique_ptr<RandomAccessFile>* result) {
+  std::unique_ptr<RandomAccessFile> base_file;
+  TF_RETURN_IF_ERROR(
+      base_file_system_->NewRandomAccessFile(filename, &base_file));
+  FileStatistics stat;
+  if (!base_file_system_->Stat(filename, &stat).ok() || stat.length < 0) {
+    // Without the size and modification time of the file, its blocks could be
+    // served after it changed: read it directly.
+    *result = std::move(base_file);
+    return Status::OK();
+  }
+  const string key = strings::StrCat(filename, "\n", stat.length, "\n",
+                                     stat.mtime_nsec, "\n");
+  result->reset(new LocalCacheRandomAccessFile(filename, key, stat.length,
+                                               std::move(base_file), this));
+  return Status::OK();
+}
+
+LocalCacheFileSystem::CacheStats LocalCacheFileSystem::GetCacheStats() const {
+  mutex_lock l(state_mu_);
+  ScopedFileLock lock(state_fd_);
+  const auto* shared = static_cast<const SharedState*>(state_);
+  CacheStats stats;
+  stats.cached_bytes = shared->cached_bytes;
+  stats.hits = shared->hits;
+  stats.misses = shared->misses;
+  return stats;
+}
+
+Status LocalCacheFileSystem::ReadBlock(const string& key,
+                                       const RandomAccessFile* base_file,
+                                       uint64 block_offset, size_t block_length,
+                                       size_t offset_in_block, size_t n,
+                                       char* scratch) {
+  const string path = io::JoinPath(
+      cache_dir_, strings::StrCat(strings::Hex(Fingerprint64(strings::StrCat(
+                                      key, block_offset))),
+                                  kBlockSuffix));
+  if (ReadCachedBlock(path, block_length, offset_in_block, n, scratch)) {
+    RecordBlockRead(/*hit=*/true, 0);
+    return Status::OK();
+  }
+
+  // Only one thread of all the processes sharing the cache fetches a block.
+  // The others wait for the lock, and then find the block cached.
+  const string lock_path = strings::StrCat(path, ".lock");
+  const int lock_fd =
+      open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (lock_fd < 0) {
+    return IOErrorFromErrno(strings::StrCat("Could not open ", lock_path));
+  }
+  Status status;
+  bool hit = false;
+  {
+    ScopedFileLock lock(lock_fd);
+    hit = ReadCachedBlock(path, block_length, offset_in_block, n, scratch);
+    if (!hit) {
+      std::unique_ptr<char[]> buffer(new char[block_length]);
+      StringPiece data;
+      status = base_file->Read(block_offset, block_length, &data, buffer.get());
+      if (status.ok() || errors::IsOutOfRange(status)) {
+        if (data.size() == block_length) {
+          memcpy(scratch, data.data() + offset_in_block, n);
+          status = WriteCachedBlock(path, data);
+          if (!status.ok()) {
+            // Failing to cache the block does not fail the read.
+            LOG(WARNING) << "Could not cache a block in " << cache_dir_ << ": "
+                         << status;
+            status = Status::OK();
+          }
+        } else {
+          status = errors::DataLoss("Read ", data.size(), " bytes at offset ",
+                                    block_offset, " instead of ", block_length,
+                                    "; the file may have changed");
+        }
+      }
+    }
+    // Waiting threads already opened the lock file, so they still serialize on
+    // it; later ones find the block cached before they need a lock.
+    unlink(lock_path.c_str());
+  }
+  close(lock_fd);
+  TF_RETURN_IF_ERROR(status);
+  RecordBlockRead(hit, hit ? 0 : block_length);
+  if (!hit) {
+    MaybeEvict();
+  }
+  return Status::OK();
+}
+
+bool LocalCacheFileSystem::ReadCachedBlock(const string& path,
+                                           size_t block_length,
+                                           size_t offset_in_block, size_t n,
+                                           char* scratch) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  bool ok =
+      fstat(fd, &st) == 0 && st.st_size == static_cast<off_t>(block_length);
+  size_t read = 0;
+  while (ok && read < n) {
+    const ssize_t r =
+        pread(fd, scratch + read, n - read, offset_in_block + read);
+    if (r < 0 && errno == EINTR) continue;
+    ok = r > 0;
+    if (ok) read += r;
+  }
+  if (ok) {
+    // The modification time orders the blocks for eviction.
+    futimens(fd, nullptr);
+  }
+  close(fd);
+  return ok;
+}
+
+Status LocalCacheFileSystem::WriteCachedBlock(const string& path,
+                                              StringPiece data) {
+  // Write to a temporary file first, so that other processes only ever see
+  // complete blocks.
+  const string tmp_path =
+      strings::StrCat(path, ".tmp-", strings::Hex(random::New64()));
+  const int fd =
+      open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return IOErrorFromErrno(strings::StrCat("Could not create ", tmp_path));
+  }
+  size_t written = 0;
+  while (written < data.size()) {
+    const ssize_t w = write(fd, data.data() + written, data.size() - written);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) break;
+    written += w;
+  }
+  Status status;
+  if (written < data.size()) {
+    status = IOErrorFromErrno(strings::StrCat("Could not write ", tmp_path));
+  }
+  if (close(fd) != 0 && status.ok()) {
+    status = IOErrorFromErrno(strings::StrCat("Could not close ", tmp_path));
+  }
+  if (status.ok() && rename(tmp_path.c_str(), path.c_str()) != 0) {
+    status = IOErrorFromErrno(strings::StrCat("Could not rename ", tmp_path));
+  }
+  if (!status.ok()) {
+    unlink(tmp_path.c_str());
+  }
+  return status;
+}
+
+void LocalCacheFileSystem::RecordBlockRead(bool hit, uint64 added_bytes) {
+  local_cache_block_reads->GetCell(hit ? "hit" : "miss")->IncrementBy(1);
+  mutex_lock l(state_mu_);
+  ScopedFileLock lock(state_fd_);
+  auto* shared = static_cast<SharedState*>(state_);
+  if (hit) {
+    ++shared->hits;
+  } else {
+    ++shared->misses;
+  }
+  shared->cached_bytes += added_bytes;
+}
+
+void LocalCacheFileSystem::MaybeEvict() {
+  if (GetCacheStats().cached_bytes <= max_bytes_) {
+    return;
+  }
+  mutex_lock evict_lock(evict_mu_);
+  const string lock_path = io::JoinPath(cache_dir_, kEvictLockFileName);
+  const int lock_fd =
+      open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (lock_fd < 0) {
+    LOG(WARNING) << "Could not open " << lock_path << ": " << strerror(errno);
+    return;
+  }
+  if (flock(lock_fd, LOCK_EX | LOCK_NB) != 0) {
+    // Another process is evicting blocks already.
+    close(lock_fd);
+    return;
+  }
+
+  struct CachedBlock {
+    string path;
+    uint64 size;
+    struct timespec mtime;
+  };
+  std::vector<CachedBlock> blocks;
+  uint64 cached_bytes = 0;
+  std::vector<string> children;
+  const Status status = Env::Default()->GetChildren(cache_dir_, &children);
+  if (!status.ok()) {
+    LOG(WARNING) << "Could not list the blocks in " << cache_dir_ << ": "
+                 << status;
+    flock(lock_fd, LOCK_UN);
+    close(lock_fd);
+    return;
+  }
+  for (const string& child : children) {
+    if (!absl::EndsWith(child, kBlockSuffix)) continue;
+    const string path = io::JoinPath(cache_dir_, child);
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) continue;
+    blocks.push_back({path, static_cast<uint64>(st.st_size), st.st_mtim});
+    cached_bytes += st.st_size;
+  }
+  std::sort(blocks.begin(), blocks.end(),
+            [](const CachedBlock& a, const CachedBlock& b) {
+              return a.mtime.tv_sec != b.mtime.tv_sec
+                         ? a.mtime.tv_sec < b.mtime.tv_sec
+                         : a.mtime.tv_nsec < b.mtime.tv_nsec;
+            });
+  const uint64 target = max_bytes_ * kEvictLowWatermark;
+  for (const CachedBlock& block : blocks) {
+    if (cached_bytes <= target) break;
+    // Readers that opened the block before can still read it.
+    if (unlink(block.path.c_str()) == 0) {
+      cached_bytes -= block.size;
+    }
+  }
+  VLOG(1) << "Evicted blocks from " << cache_dir_ << " down to "
+          << cached_bytes << " bytes";
+  {
+    // Resynchronize with the blocks actually on disk, which also drops the
+    // blocks of processes that died before counting them.
+    mutex_lock l(state_mu_);
+    ScopedFileLock lock(state_fd_);
+    static_cast<SharedState*>(state_)->cached_bytes = cached_bytes;
+  }
+  flock(lock_fd, LOCK_UN);
+  close(lock_fd);
+}
+
+}  // namespace tensorflow
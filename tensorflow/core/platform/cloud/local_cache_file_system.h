@@ -0,0 +1,192 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PLATFORM_CLOUD_LOCAL_CACHE_FILE_SYSTEM_H_
+#define TENSORFLOW_CORE_PLATFORM_CLOUD_LOCAL_CACHE_FILE_SYSTEM_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+/// \brief A wrapper to cache the files of another file system on local disk.
+///
+/// Files read through the wrapper are cached in blocks of `block_size` bytes,
+/// each in its own file in `cache_dir`. A block file is named after the
+/// fingerprint of the file name, size and modification time and of the block
+/// offset, so a file that changes is never served from its old blocks.
+///
+/// All processes on a host that use the same `cache_dir` share the blocks: a
+/// lock file per block makes sure only one of them fetches it from the
+/// underlying file system, and a state file that they all map into memory
+/// counts the cached bytes and the block reads that hit the cache. Once the
+/// cached bytes exceed `max_bytes`, the least recently read blocks are deleted.
+///
+/// Only reads are cached. All other calls go straight to the underlying file
+/// system, so that it can be any remote file system (GCS, S3, HDFS...).
+class LocalCacheFileSystem : public FileSystem {
+ public:
+  /// The cached bytes and block reads of all the processes that share a cache
+  /// directory.
+  struct CacheStats {
+    uint64 cached_bytes = 0;
+    uint64 hits = 0;
+    uint64 misses = 0;
+  };
+
+  /// Creates `cache_dir` if needed, and maps its state file.
+  static Status Create(std::unique_ptr<FileSystem> base_file_system,
+                       const string& cache_dir, size_t block_size,
+                       uint64 max_bytes,
+                       std::unique_ptr<LocalCacheFileSystem>* result);
+
+  ~LocalCacheFileSystem() override;
+
+  Status NewRandomAccessFile(
+      const string& filename,
+      std::unique_ptr<RandomAccessFile>* result) override;
+
+  Status NewWritableFile(const string& fname,
+                         std::unique_ptr<WritableFile>* result) override {
+    return base_file_system_->NewWritableFile(fname, result);
+  }
+
+  Status NewAppendableFile(const string& fname,
+                           std::unique_ptr<WritableFile>* result) override {
+    return base_file_system_->NewAppendableFile(fname, result);
+  }
+
+  Status NewReadOnlyMemoryRegionFromFile(
+      const string& filename,
+      std::unique_ptr<ReadOnlyMemoryRegion>* result) override {
+    return base_file_system_->NewReadOnlyMemoryRegionFromFile(filename, result);
+  }
+
+  Status FileExists(const string& fname) override {
+    return base_file_system_->FileExists(fname);
+  }
+
+  Status GetChildren(const string& dir, std::vector<string>* result) override {
+    return base_file_system_->GetChildren(dir, result);
+  }
+
+  Status GetMatchingPaths(const string& pattern,
+                          std::vector<string>* result) override {
+    return base_file_system_->GetMatchingPaths(pattern, result);
+  }
+
+  Status Stat(const string& fname, FileStatistics* stat) override {
+    return base_file_system_->Stat(fname, stat);
+  }
+
+  Status DeleteFile(const string& fname) override {
+    return base_file_system_->DeleteFile(fname);
+  }
+
+  Status CreateDir(const string& dirname) override {
+    return base_file_system_->CreateDir(dirname);
+  }
+
+  Status DeleteDir(const string& dirname) override {
+    return base_file_system_->DeleteDir(dirname);
+  }
+
+  Status GetFileSize(const string& fname, uint64* file_size) override {
+    return base_file_system_->GetFileSize(fname, file_size);
+  }
+
+  Status RenameFile(const string& src, const string& target) override {
+    return base_file_system_->RenameFile(src, target);
+  }
+
+  Status IsDirectory(const string& dirname) override {
+    return base_file_system_->IsDirectory(dirname);
+  }
+
+  Status HasAtomicMove(const string& path, bool* has_atomic_move) override {
+    return base_file_system_->HasAtomicMove(path, has_atomic_move);
+  }
+
+  Status DeleteRecursively(const string& dirname, int64* undeleted_files,
+                           int64* undeleted_dirs) override {
+    return base_file_system_->DeleteRecursively(dirname, undeleted_files,
+                                                undeleted_dirs);
+  }
+
+  void FlushCaches() override { base_file_system_->FlushCaches(); }
+
+  FileSystem* underlying() const { return base_file_system_.get(); }
+
+  size_t block_size() const { return block_size_; }
+  uint64 max_bytes() const { return max_bytes_; }
+
+  CacheStats GetCacheStats() const TF_LOCKS_EXCLUDED(state_mu_);
+
+  /// \brief Copies `n` bytes at `offset_in_block` of the block of `key` into
+  /// `scratch`, reading the block from `base_file` if it is not cached.
+  ///
+  /// `key` identifies a version of a file; the block starts at `block_offset`
+  /// and is `block_length` bytes long.
+  Status ReadBlock(const string& key, const RandomAccessFile* base_file,
+                   uint64 block_offset, size_t block_length,
+                   size_t offset_in_block, size_t n, char* scratch);
+
+ private:
+  LocalCacheFileSystem(std::unique_ptr<FileSystem> base_file_system,
+                       const string& cache_dir, size_t block_size,
+                       uint64 max_bytes, int state_fd, void* state);
+
+  /// Copies [offset_in_block, offset_in_block + n) of the cached block at
+  /// `path` into `scratch`. Returns false if the block is not cached.
+  bool ReadCachedBlock(const string& path, size_t block_length,
+                       size_t offset_in_block, size_t n, char* scratch);
+
+  /// Writes `data` to the block file at `path`.
+  Status WriteCachedBlock(const string& path, StringPiece data);
+
+  /// Counts a block read, and `added_bytes` cached, in the shared state.
+  void RecordBlockRead(bool hit, uint64 added_bytes)
+      TF_LOCKS_EXCLUDED(state_mu_);
+
+  /// Deletes the least recently read blocks if the cache is over budget.
+  void MaybeEvict() TF_LOCKS_EXCLUDED(state_mu_);
+
+  std::unique_ptr<FileSystem> base_file_system_;
+  const string cache_dir_;
+  const size_t block_size_;
+  const uint64 max_bytes_;
+
+  /// Serializes the updates of the shared state by threads of this process;
+  /// a lock on `state_fd_` serializes them with other processes.
+  mutable mutex state_mu_;
+  const int state_fd_;
+  void* const state_;  // mapped from the state file
+
+  /// Held while deleting blocks, so that only one thread evicts at a time.
+  mutex evict_mu_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(LocalCacheFileSystem);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PLATFORM_CLOUD_LOCAL_CACHE_FILE_SYSTEM_H_
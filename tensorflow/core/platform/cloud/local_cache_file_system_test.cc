@@ -0,0 +1,198 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/platform/cloud/local_cache_file_system.h"
+
+#include <map>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/null_file_system.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// A file system that serves files from memory and counts the reads of them.
+class FakeFileSystem : public NullFileSystem {
+ public:
+  struct File {
+    string contents;
+    int64 mtime_nsec = 0;
+  };
+
+  class FakeRandomAccessFile : public RandomAccessFile {
+   public:
+    FakeRandomAccessFile(const string& contents, int* reads)
+        : contents_(contents), reads_(reads) {}
+
+    Status Read(uint64 offset, size_t n, StringPiece* result,
+                char* scratch) const override {
+      ++*reads_;
+      if (offset >= contents_.size()) {
+        *result = StringPiece();
+        return errors::OutOfRange("EOF");
+      }
+      const size_t bytes = std::min<size_t>(n, contents_.size() - offset);
+      memcpy(scratch, contents_.data() + offset, bytes);
+      *result = StringPiece(scratch, bytes);
+      return bytes < n ? errors::OutOfRange("EOF") : Status::OK();
+    }
+
+   private:
+    const string contents_;
+    int* const reads_;
+  };
+
+  Status NewRandomAccessFile(
+      const string& fname, std::unique_ptr<RandomAccessFile>* result) override {
+    auto it = files_.find(fname);
+    if (it == files_.end()) {
+      return errors::NotFound(fname);
+    }
+    result->reset(new FakeRandomAccessFile(it->second.contents, &reads_));
+    return Status::OK();
+  }
+
+  Status Stat(const string& fname, FileStatistics* stat) override {
+    auto it = files_.find(fname);
+    if (it == files_.end()) {
+      return errors::NotFound(fname);
+    }
+    *stat = FileStatistics(it->second.contents.size(), it->second.mtime_nsec,
+                           false);
+    return Status::OK();
+  }
+
+  std::map<string, File> files_;
+  int reads_ = 0;
+};
+
+string NewCacheDir(const string& name) {
+  const string dir = io::JoinPath(testing::TmpDir(), name);
+  int64 undeleted_files, undeleted_dirs;
+  Env::Default()
+      ->DeleteRecursively(dir, &undeleted_files, &undeleted_dirs)
+      .IgnoreError();
+  return dir;
+}
+
+Status ReadAll(FileSystem* fs, const string& fname, string* contents) {
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(fs->NewRandomAccessFile(fname, &file));
+  FileStatistics stat;
+  TF_RETURN_IF_ERROR(fs->Stat(fname, &stat));
+  contents->resize(stat.length);
+  StringPiece result;
+  TF_RETURN_IF_ERROR(file->Read(0, stat.length, &result, &(*contents)[0]));
+  *contents = string(result);
+  return Status::OK();
+}
+
+TEST(LocalCacheFileSystemTest, SharesBlocksBetweenInstances) {
+  const string cache_dir = NewCacheDir("shares_blocks");
+  const string contents = "0123456789abcdefghij";
+  std::unique_ptr<FakeFileSystem> base1(new FakeFileSystem);
+  base1->files_["remote://a"].contents = contents;
+  FakeFileSystem* fake1 = base1.get();
+  std::unique_ptr<FakeFileSystem> base2(new FakeFileSystem);
+  base2->files_["remote://a"].contents = contents;
+  FakeFileSystem* fake2 = base2.get();
+
+  // Two caches on the same directory stand for two processes on a host.
+  std::unique_ptr<LocalCacheFileSystem> fs1, fs2;
+  TF_ASSERT_OK(LocalCacheFileSystem::Create(std::move(base1), cache_dir, 8,
+                                            1024, &fs1));
+  TF_ASSERT_OK(LocalCacheFileSystem::Create(std::move(base2), cache_dir, 8,
+                                            1024, &fs2));
+
+  std::unique_ptr<RandomAccessFile> file;
+  TF_ASSERT_OK(fs1->NewRandomAccessFile("remote://a", &file));
+  char scratch[20];
+  StringPiece result;
+  TF_EXPECT_OK(file->Read(6, 4, &result, scratch));
+  EXPECT_EQ("6789", result);
+  EXPECT_EQ(2, fake1->reads_);
+  TF_EXPECT_OK(file->Read(6, 4, &result, scratch));
+  EXPECT_EQ("6789", result);
+  EXPECT_EQ(2, fake1->reads_);
+
+  TF_ASSERT_OK(fs2->NewRandomAccessFile("remote://a", &file));
+  EXPECT_EQ(errors::Code::OUT_OF_RANGE,
+            file->Read(0, 30, &result, scratch).code());
+  EXPECT_EQ(contents, result);
+  // Only the last block had not been cached by the first instance.
+  EXPECT_EQ(1, fake2->reads_);
+
+  const LocalCacheFileSystem::CacheStats stats = fs2->GetCacheStats();
+  EXPECT_EQ(20, stats.cached_bytes);
+  EXPECT_EQ(4, stats.hits);
+  EXPECT_EQ(3, stats.misses);
+}
+
+TEST(LocalCacheFileSystemTest, ChangedFileIsRead) {
+  const string cache_dir = NewCacheDir("changed_file");
+  std::unique_ptr<FakeFileSystem> base(new FakeFileSystem);
+  base->files_["remote://a"].contents = "01234567";
+  FakeFileSystem* fake = base.get();
+  std::unique_ptr<LocalCacheFileSystem> fs;
+  TF_ASSERT_OK(
+      LocalCacheFileSystem::Create(std::move(base), cache_dir, 8, 1024, &fs));
+
+  string contents;
+  TF_EXPECT_OK(ReadAll(fs.get(), "remote://a", &contents));
+  EXPECT_EQ("01234567", contents);
+  fake->files_["remote://a"] = {"abcdefgh", 1};
+  TF_EXPECT_OK(ReadAll(fs.get(), "remote://a", &contents));
+  EXPECT_EQ("abcdefgh", contents);
+  EXPECT_EQ(2, fake->reads_);
+}
+
+TEST(LocalCacheFileSystemTest, EvictsBlocksOverBudget) {
+  const string cache_dir = NewCacheDir("evicts_blocks");
+  std::unique_ptr<FakeFileSystem> base(new FakeFileSystem);
+  base->files_["remote://a"].contents = string(64, 'x');
+  FakeFileSystem* fake = base.get();
+  std::unique_ptr<LocalCacheFileSystem> fs;
+  TF_ASSERT_OK(
+      LocalCacheFileSystem::Create(std::move(base), cache_dir, 8, 32, &fs));
+
+  string contents;
+  TF_EXPECT_OK(ReadAll(fs.get(), "remote://a", &contents));
+  EXPECT_EQ(string(64, 'x'), contents);
+  EXPECT_EQ(8, fake->reads_);
+  EXPECT_LE(fs->GetCacheStats().cached_bytes, 32);
+
+  // The evicted blocks are read again.
+  TF_EXPECT_OK(ReadAll(fs.get(), "remote://a", &contents));
+  EXPECT_GT(fake->reads_, 8);
+}
+
+TEST(LocalCacheFileSystemTest, ForwardsOtherCalls) {
+  std::unique_ptr<FakeFileSystem> base(new FakeFileSystem);
+  base->files_["remote://a"].contents = "0123";
+  std::unique_ptr<LocalCacheFileSystem> fs;
+  TF_ASSERT_OK(LocalCacheFileSystem::Create(
+      std::move(base), NewCacheDir("forwards_calls"), 8, 1024, &fs));
+  FileStatistics stat;
+  TF_EXPECT_OK(fs->Stat("remote://a", &stat));
+  EXPECT_EQ(4, stat.length);
+  EXPECT_EQ(errors::Code::UNIMPLEMENTED,
+            fs->DeleteFile("remote://a").code());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <memory>
 #include "tensorflow/core/lib/gtl/cleanup.h"
@@ -36,6 +38,14 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
   auto entry = block_map_.find(key);
   if (entry != block_map_.end()) {
     if (BlockNotStale(entry->second)) {
+      if (entry->second->prefetched) {
+        // The reader caught up with a block fetched ahead of it. From now on
+        // it competes for space with the other blocks that have been read.
+        prefetch_list_.erase(entry->second->lru_iterator);
+        lru_list_.push_front(key);
+        entry->second->lru_iterator = lru_list_.begin();
+        entry->second->prefetched = false;
+      }
       if (cache_stats_ != nullptr) {
         cache_stats_->RecordCacheHitBlockSize(entry->second->data.size());
       }
@@ -58,10 +68,18 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
   return new_entry;
 }
 
-// Remove blocks from the cache until we do not exceed our maximum size.
+// Remove blocks from the cache until we do not exceed our maximum size. Blocks
+// fetched ahead of the reader are only evicted once no block that has been read
+// is left, since the reader is about to read them.
 void RamFileBlockCache::Trim() {
-  while (!lru_list_.empty() && cache_size_ > max_bytes_) {
-    RemoveBlock(block_map_.find(lru_list_.back()));
+  while (cache_size_ > max_bytes_) {
+    if (!lru_list_.empty()) {
+      RemoveBlock(block_map_.find(lru_list_.back()));
+    } else if (!prefetch_list_.empty()) {
+      RemoveBlock(block_map_.find(prefetch_list_.back()));
+    } else {
+      break;
+    }
   }
 }
 
@@ -99,8 +117,9 @@ Status RamFileBlockCache::UpdateLRU(const Key& key,
 Status RamFileBlockCache::MaybeFetch(const Key& key,
                                      const std::shared_ptr<Block>& block) {
   bool downloaded_block = false;
+  uint64 fetch_micros = 0;
   auto reconcile_state =
-      gtl::MakeCleanup([this, &downloaded_block, &key, &block] {
+      gtl::MakeCleanup([this, &downloaded_block, &fetch_micros, &key, &block] {
         // Perform this action in a cleanup callback to avoid locking mu_ after
         // locking block->mu.
         if (downloaded_block) {
@@ -116,6 +135,10 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
             block->lra_iterator = lra_list_.begin();
             block->timestamp = env_->NowSeconds();
           }
+          fetch_latency_micros_ =
+              fetch_latency_micros_ == 0
+                  ? fetch_micros
+                  : 0.8 * fetch_latency_micros_ + 0.2 * fetch_micros;
         }
       });
   // Loop until either block content is successfully fetched, or our request
@@ -132,8 +155,10 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
         block->data.clear();
         block->data.resize(block_size_, 0);
         size_t bytes_transferred;
+        fetch_micros = env_->NowMicros();
         status.Update(block_fetcher_(key.first, key.second, block_size_,
                                      block->data.data(), &bytes_transferred));
+        fetch_micros = env_->NowMicros() - fetch_micros;
         if (cache_stats_ != nullptr) {
           cache_stats_->RecordCacheMissBlockSize(bytes_transferred);
         }
@@ -165,6 +190,106 @@ Status RamFileBlockCache::MaybeFetch(const Key& key,
       "Control flow should never reach the end of RamFileBlockCache::Fetch.");
 }
 
+size_t RamFileBlockCache::ReadaheadWindow(const ReadaheadState& state) const {
+  if (fetch_latency_micros_ == 0 || state.block_interval_micros == 0) {
+    return 1;
+  }
+  // Blocks are fetched in parallel, so keeping the reader from waiting takes
+  // as many fetches in flight as blocks it reads during one fetch.
+  const double window =
+      1 + std::ceil(fetch_latency_micros_ / state.block_interval_micros);
+  return std::min<size_t>(max_readahead_blocks_, window);
+}
+
+void RamFileBlockCache::MaybeReadahead(const string& filename, size_t start,
+                                       size_t finish) {
+  if (max_readahead_blocks_ == 0) {
+    return;
+  }
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> prefetches;
+  {
+    mutex_lock lock(mu_);
+    const uint64 now = env_->NowMicros();
+    const size_t last_block = finish - block_size_;
+    ReadaheadState& state = readahead_states_[filename];
+    if (state.last_block_micros == 0 || start < state.last_block ||
+        start > state.last_block + block_size_) {
+      // This is the first read of the file, or the reader skipped blocks:
+      // wait for another sequential read before fetching ahead.
+      state = ReadaheadState();
+      state.last_block = last_block;
+      state.last_block_micros = now;
+      return;
+    }
+    if (last_block > state.last_block) {
+      const double interval =
+          static_cast<double>(now - state.last_block_micros) /
+          ((last_block - state.last_block) / block_size_);
+      state.block_interval_micros =
+          state.block_interval_micros == 0
+              ? interval
+              : 0.8 * state.block_interval_micros + 0.2 * interval;
+      state.last_block = last_block;
+      state.last_block_micros = now;
+    }
+    const size_t end = std::min(
+        state.file_end, finish + ReadaheadWindow(state) * block_size_);
+    for (size_t pos = std::max(finish, state.readahead_end); pos < end;
+         pos += block_size_) {
+      if ((prefetch_list_.size() + 1) * block_size_ > max_bytes_ / 2) {
+        break;
+      }
+      Key key = std::make_pair(filename, pos);
+      if (block_map_.find(key) == block_map_.end()) {
+        auto block = std::make_shared<Block>();
+        block->prefetched = true;
+        prefetch_list_.push_front(key);
+        lra_list_.push_front(key);
+        block->lru_iterator = prefetch_list_.begin();
+        block->lra_iterator = lra_list_.begin();
+        block->timestamp = env_->NowSeconds();
+        block_map_.emplace(std::make_pair(key, block));
+        prefetches.emplace_back(key, block);
+      }
+      state.readahead_end = pos + block_size_;
+    }
+  }
+  for (const auto& prefetch : prefetches) {
+    readahead_pool_->Schedule([this, prefetch] {
+      Prefetch(prefetch.first, prefetch.second);
+    });
+  }
+}
+
+void RamFileBlockCache::Prefetch(const Key& key,
+                                 const std::shared_ptr<Block>& block) {
+  Status status = MaybeFetch(key, block);
+  mutex_lock lock(mu_);
+  if (block->timestamp == 0) {
+    // The block was evicted from another thread.
+    return;
+  }
+  if (!status.ok()) {
+    VLOG(1) << "Failed to fetch " << key.first << "@" << key.second
+            << " ahead of the reader: " << status;
+    // Leave it to the reader to fetch the block again, and report the error.
+    auto entry = block_map_.find(key);
+    if (block->prefetched && entry != block_map_.end() &&
+        entry->second == block) {
+      RemoveBlock(entry);
+    }
+    return;
+  }
+  if (block->data.size() < block_size_) {
+    auto it = readahead_states_.find(key.first);
+    if (it != readahead_states_.end()) {
+      it->second.file_end =
+          std::min(it->second.file_end, key.second + block->data.size());
+    }
+  }
+  Trim();
+}
+
 Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
                                char* buffer, size_t* bytes_transferred) {
   *bytes_transferred = 0;
@@ -182,6 +307,7 @@ Status RamFileBlockCache::Read(const string& filename, size_t offset, size_t n,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  MaybeReadahead(filename, start, finish);
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
@@ -270,7 +396,9 @@ void RamFileBlockCache::Flush() {
   mutex_lock lock(mu_);
   block_map_.clear();
   lru_list_.clear();
+  prefetch_list_.clear();
   lra_list_.clear();
+  readahead_states_.clear();
   cache_size_ = 0;
 }
 
@@ -280,6 +408,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  readahead_states_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
@@ -293,7 +422,11 @@ void RamFileBlockCache::RemoveBlock(BlockMap::iterator entry) {
   // This signals that the block is removed, and should not be inadvertently
   // reinserted into the cache in UpdateLRU.
   entry->second->timestamp = 0;
-  lru_list_.erase(entry->second->lru_iterator);
+  if (entry->second->prefetched) {
+    prefetch_list_.erase(entry->second->lru_iterator);
+  } else {
+    lru_list_.erase(entry->second->lru_iterator);
+  }
   lra_list_.erase(entry->second->lra_iterator);
   cache_size_ -= entry->second->data.capacity();
   block_map_.erase(entry);
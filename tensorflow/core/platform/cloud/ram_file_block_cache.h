@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_PLATFORM_CLOUD_RAM_FILE_BLOCK_CACHE_H_
 
 #include <functional>
+#include <limits>
 #include <list>
 #include <map>
 #include <memory>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -38,6 +40,15 @@ namespace tensorflow {
 ///
 /// This class should be shared by read-only random access files on a remote
 /// filesystem (e.g. GCS).
+///
+/// If `max_readahead_blocks` is positive, the cache detects files that are
+/// being read sequentially and fetches up to that many blocks ahead of the
+/// reader in the background, in parallel. The number of blocks fetched ahead
+/// follows the measured fetch latency and the rate at which the reader
+/// consumes blocks, so that the next block is usually in the cache by the time
+/// it is needed. Blocks fetched ahead are kept in their own LRU list until they
+/// are read, may take up at most half of `max_bytes`, and are only evicted to
+/// make room once no block that has been read is left to evict.
 class RamFileBlockCache : public FileBlockCache {
  public:
   /// The callback executed when a block is not found in the cache, and needs to
@@ -51,21 +62,29 @@ class RamFileBlockCache : public FileBlockCache {
       BlockFetcher;
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
-                    BlockFetcher block_fetcher, Env* env = Env::Default())
+                    BlockFetcher block_fetcher, Env* env = Env::Default(),
+                    size_t max_readahead_blocks = 0)
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
         block_fetcher_(block_fetcher),
-        env_(env) {
+        env_(env),
+        max_readahead_blocks_(IsCacheEnabled() ? max_readahead_blocks : 0) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (max_readahead_blocks_ > 0) {
+      readahead_pool_.reset(new thread::ThreadPool(
+          env_, "TF_readahead_FBC", static_cast<int>(max_readahead_blocks_)));
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Destroying readahead_pool_ will block until all fetches ahead finish.
+    readahead_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -109,6 +128,7 @@ class RamFileBlockCache : public FileBlockCache {
   size_t block_size() const override { return block_size_; }
   size_t max_bytes() const override { return max_bytes_; }
   uint64 max_staleness() const override { return max_staleness_; }
+  size_t max_readahead_blocks() const { return max_readahead_blocks_; }
 
   /// The current size (in bytes) of the cache.
   size_t CacheSize() const override TF_LOCKS_EXCLUDED(mu_);
@@ -131,6 +151,8 @@ class RamFileBlockCache : public FileBlockCache {
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
   Env* const env_;  // not owned
+  /// The maximum number of blocks fetched ahead of a sequential reader.
+  const size_t max_readahead_blocks_;
 
   /// \brief The key type for the file block cache.
   ///
@@ -158,10 +180,11 @@ class RamFileBlockCache : public FileBlockCache {
   /// was cached, a coordination lock, and state & condition variables.
   ///
   /// Thread safety:
-  /// The iterator and timestamp fields should only be accessed while holding
-  /// the block-cache-wide mu_ instance variable. The state variable should only
-  /// be accessed while holding the Block's mu lock. The data vector should only
-  /// be accessed after state == FINISHED, and it should never be modified.
+  /// The iterator, timestamp and prefetched fields should only be accessed
+  /// while holding the block-cache-wide mu_ instance variable. The state
+  /// variable should only be accessed while holding the Block's mu lock. The
+  /// data vector should only be accessed after state == FINISHED, and it should
+  /// never be modified.
   ///
   /// In order to prevent deadlocks, never grab the block-cache-wide mu_ lock
   /// AFTER grabbing any block's mu lock. It is safe to grab mu without locking
@@ -169,12 +192,15 @@ class RamFileBlockCache : public FileBlockCache {
   struct Block {
     /// The block data.
     std::vector<char> data;
-    /// A list iterator pointing to the block's position in the LRU list.
+    /// A list iterator pointing to the block's position in the LRU list, or
+    /// in the prefetch list if `prefetched` is true.
     std::list<Key>::iterator lru_iterator;
     /// A list iterator pointing to the block's position in the LRA list.
     std::list<Key>::iterator lra_iterator;
     /// The timestamp (seconds since epoch) at which the block was cached.
     uint64 timestamp;
+    /// Whether the block was fetched ahead of the reader and not read since.
+    bool prefetched = false;
     /// Mutex to guard state variable
     mutex mu;
     /// The state of the block.
@@ -188,6 +214,24 @@ class RamFileBlockCache : public FileBlockCache {
   /// The block map is an ordered map from Key to Block.
   typedef std::map<Key, std::shared_ptr<Block>> BlockMap;
 
+  /// \brief The read-ahead state of a file.
+  ///
+  /// Tracks the last block a reader of the file has read, how long the reader
+  /// takes to move from one block to the next, and how far ahead of the reader
+  /// blocks have been requested.
+  struct ReadaheadState {
+    /// The offset of the last block read.
+    size_t last_block = 0;
+    /// The time (microseconds since epoch) the reader moved to `last_block`.
+    uint64 last_block_micros = 0;
+    /// A moving average of the time the reader spends on each block.
+    double block_interval_micros = 0;
+    /// The end of the blocks requested ahead of the reader.
+    size_t readahead_end = 0;
+    /// The end of the file, once a block fetched ahead came back partial.
+    size_t file_end = std::numeric_limits<size_t>::max();
+  };
+
   /// Prune the cache by removing files with expired blocks.
   void Prune() TF_LOCKS_EXCLUDED(mu_);
 
@@ -203,6 +247,19 @@ class RamFileBlockCache : public FileBlockCache {
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  /// Record that [start, finish) of `filename` is being read, and fetch blocks
+  /// after it in the background if the file is being read sequentially.
+  void MaybeReadahead(const string& filename, size_t start, size_t finish)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  /// The number of blocks to keep requested ahead of a sequential reader.
+  size_t ReadaheadWindow(const ReadaheadState& state) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Fetch the block at `key` ahead of the reader, on readahead_pool_.
+  void Prefetch(const Key& key, const std::shared_ptr<Block>& block)
+      TF_LOCKS_EXCLUDED(mu_);
+
   /// Update the LRU iterator for the block at `key`.
   Status UpdateLRU(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
@@ -218,6 +275,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// The cache pruning thread that removes files with expired blocks.
   std::unique_ptr<Thread> pruning_thread_;
 
+  /// The threads that fetch blocks ahead of sequential readers.
+  std::unique_ptr<thread::ThreadPool> readahead_pool_;
+
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
@@ -231,6 +291,11 @@ class RamFileBlockCache : public FileBlockCache {
   /// recently accessed block.
   std::list<Key> lru_list_ TF_GUARDED_BY(mu_);
 
+  /// The LRU list of blocks fetched ahead of the reader that have not been
+  /// read yet. The front of the list identifies the most recently fetched
+  /// block.
+  std::list<Key> prefetch_list_ TF_GUARDED_BY(mu_);
+
   /// The LRA (least recently added) list of block keys. The front of the list
   /// identifies the most recently added block.
   ///
@@ -241,6 +306,12 @@ class RamFileBlockCache : public FileBlockCache {
   /// The combined number of bytes in all of the cached blocks.
   size_t cache_size_ TF_GUARDED_BY(mu_) = 0;
 
+  /// A moving average of the time a block takes to fetch, in microseconds.
+  double fetch_latency_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  /// The read-ahead state of the files being read.
+  std::map<string, ReadaheadState> readahead_states_ TF_GUARDED_BY(mu_);
+
   // A filename->file_signature map.
   std::map<string, int64> file_signature_map_ TF_GUARDED_BY(mu_);
 };
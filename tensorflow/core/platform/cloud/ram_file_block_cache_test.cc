@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -566,5 +567,69 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, Readahead) {
+  const size_t block_size = 16;
+  mutex mu;
+  std::vector<size_t> requests;
+  Notification prefetched;
+  auto fetcher = [&mu, &requests, &prefetched, block_size](
+                     const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    EXPECT_EQ(n, block_size);
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    mutex_lock l(mu);
+    requests.push_back(offset);
+    if (offset == block_size && !prefetched.HasBeenNotified()) {
+      prefetched.Notify();
+    }
+    return Status::OK();
+  };
+  RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                          Env::Default(), 4);
+  EXPECT_EQ(cache.max_readahead_blocks(), 4);
+  std::vector<char> out;
+  // The first read of the file only fetches the block being read.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 0, 4, &out));
+  {
+    mutex_lock l(mu);
+    EXPECT_EQ(requests, std::vector<size_t>({0}));
+  }
+  // The second read is sequential, so the next block is fetched ahead of it.
+  TF_EXPECT_OK(ReadCache(&cache, "a", 4, 4, &out));
+  prefetched.WaitForNotification();
+  // The reader then finds the block in the cache instead of fetching it.
+  TF_EXPECT_OK(ReadCache(&cache, "a", block_size, 4, &out));
+  EXPECT_EQ(out, std::vector<char>(4, 'x'));
+  mutex_lock l(mu);
+  EXPECT_EQ(std::count(requests.begin(), requests.end(), block_size), 1);
+}
+
+TEST(RamFileBlockCacheTest, NoReadaheadForRandomReads) {
+  const size_t block_size = 16;
+  mutex mu;
+  std::vector<size_t> requests;
+  auto fetcher = [&mu, &requests](const string& filename, size_t offset,
+                                  size_t n, char* buffer,
+                                  size_t* bytes_transferred) {
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    mutex_lock l(mu);
+    requests.push_back(offset);
+    return Status::OK();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0, fetcher,
+                            Env::Default(), 4);
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "a", 0, 4, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 5 * block_size, 4, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "a", 2 * block_size, 4, &out));
+    // Destroying the cache waits for any fetches ahead of the reader.
+  }
+  EXPECT_EQ(requests,
+            std::vector<size_t>({0, 5 * block_size, 2 * block_size}));
+}
+
 }  // namespace
 }  // namespace tensorflow
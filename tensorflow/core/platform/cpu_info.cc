@@ -87,6 +87,9 @@ class CPUIDInfo {
         have_avx512ifma_(0),
         have_avx512_4vnniw_(0),
         have_avx512_4fmaps_(0),
+        have_avx512_bf16_(0),
+        have_amx_tile_(0),
+        have_amx_bf16_(0),
         have_bmi1_(0),
         have_bmi2_(0),
         have_cmov_(0),
@@ -202,6 +205,22 @@ class CPUIDInfo {
     cpuid->have_avx512ifma_ = have_avx512 && ((ebx >> 21) & 0x1);
     cpuid->have_avx512_4vnniw_ = have_avx512 && ((edx >> 2) & 0x1);
     cpuid->have_avx512_4fmaps_ = have_avx512 && ((edx >> 3) & 0x1);
+
+    // AMX support is reported in leaf 7 subleaf 0 as well. Using the tiles
+    // additionally requires the OS to enable the XTILECFG and XTILEDATA
+    // state components.
+    const uint64 xcr0_amx_mask = 0x60000;
+    const bool have_amx =
+        have_avx && ((GetXCR0EAX() & xcr0_amx_mask) == xcr0_amx_mask);
+    cpuid->have_amx_tile_ = have_amx && ((edx >> 24) & 0x1);
+    cpuid->have_amx_bf16_ = have_amx && ((edx >> 22) & 0x1);
+
+    // AVX512_BF16 is reported in leaf 7 subleaf 1, which only exists if
+    // subleaf 0 returned a maximum subleaf of at least 1 in eax.
+    if (eax >= 1) {
+      GETCPUID(eax, ebx, ecx, edx, 7, 1);
+      cpuid->have_avx512_bf16_ = have_avx512 && ((eax >> 5) & 0x1);
+    }
   }
 
   static bool TestFeature(CPUFeature feature) {
@@ -223,6 +242,9 @@ class CPUIDInfo {
       case AVX512IFMA:    return cpuid->have_avx512ifma_;
       case AVX512_4VNNIW: return cpuid->have_avx512_4vnniw_;
       case AVX512_4FMAPS: return cpuid->have_avx512_4fmaps_;
+      case AVX512_BF16:   return cpuid->have_avx512_bf16_;
+      case AMX_TILE:      return cpuid->have_amx_tile_;
+      case AMX_BF16:      return cpuid->have_amx_bf16_;
       case BMI1:          return cpuid->have_bmi1_;
       case BMI2:          return cpuid->have_bmi2_;
       case CMOV:          return cpuid->have_cmov_;
@@ -272,6 +294,9 @@ class CPUIDInfo {
   int have_avx512ifma_ : 1;
   int have_avx512_4vnniw_ : 1;
   int have_avx512_4fmaps_ : 1;
+  int have_avx512_bf16_ : 1;
+  int have_amx_tile_ : 1;
+  int have_amx_bf16_ : 1;
   int have_bmi1_ : 1;
   int have_bmi2_ : 1;
   int have_cmov_ : 1;
@@ -122,6 +122,11 @@ enum CPUFeature {
   AVX512IFMA = 35,     // Integer multiply-add
   AVX512_4VNNIW = 36,  // Integer neural network
   AVX512_4FMAPS = 37,  // Floating point neural network
+
+  // Cooper Lake / Sapphire Rapids
+  AVX512_BF16 = 38,  // Bfloat16 dot products and conversions
+  AMX_TILE = 39,     // Advanced matrix extensions tile architecture
+  AMX_BF16 = 40,     // Bfloat16 tile multiplications
 };
 
 // Checks whether the current processor supports one of the features above.
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/cord.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -90,6 +91,62 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadV) {
+  const string filename = io::JoinPath(BaseDir(), "read_v");
+  const string input = CreateTestFile(env_, filename, 100);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // The first three requests are adjacent, the last one runs past EOF.
+  const std::vector<std::pair<uint64, size_t>> ranges = {
+      {10, 5}, {15, 0}, {15, 20}, {50, 10}, {90, 20}};
+  std::vector<char> scratch(100);
+  std::vector<RandomAccessFile::ReadRequest> requests(ranges.size());
+  size_t scratch_offset = 0;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    requests[i].offset = ranges[i].first;
+    requests[i].n = ranges[i].second;
+    requests[i].scratch = scratch.data() + scratch_offset;
+    scratch_offset += ranges[i].second;
+  }
+  Notification done;
+  Status status;
+  f->ReadV(&requests, [&done, &status](const Status& s) {
+    status = s;
+    done.Notify();
+  });
+  done.WaitForNotification();
+
+  EXPECT_EQ(error::OUT_OF_RANGE, status.code());
+  for (size_t i = 0; i + 1 < ranges.size(); ++i) {
+    TF_EXPECT_OK(requests[i].status);
+    EXPECT_EQ(input.substr(ranges[i].first, ranges[i].second),
+              requests[i].result);
+  }
+  EXPECT_EQ(error::OUT_OF_RANGE, requests.back().status.code());
+  EXPECT_EQ(input.substr(90), requests.back().result);
+}
+
+TEST_F(DefaultEnvTest, ReadAsync) {
+  const string filename = io::JoinPath(BaseDir(), "read_async");
+  const string input = CreateTestFile(env_, filename, 10);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_EXPECT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  char scratch[4];
+  RandomAccessFile::ReadRequest request;
+  request.offset = 3;
+  request.n = 4;
+  request.scratch = scratch;
+  Notification done;
+  f->ReadAsync(&request, [&done](const Status& s) {
+    TF_EXPECT_OK(s);
+    done.Notify();
+  });
+  done.WaitForNotification();
+  EXPECT_EQ(input.substr(3, 4), request.result);
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
@@ -31,10 +31,12 @@ limitations under the License.
 
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/platform.h"
 #include "tensorflow/core/platform/scanner.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/platform/strcat.h"
+#include "tensorflow/core/platform/threadpool.h"
 
 namespace tensorflow {
 
@@ -436,4 +438,53 @@ string FileSystem::CreateURI(StringPiece scheme, StringPiece host,
   return strings::StrCat(scheme, "://", host, path);
 }
 
+// static
+void RandomAccessFile::ScheduleRead(std::function<void()> fn) {
+  // Reads mostly wait on storage, so use more threads than cores: enough that
+  // dozens of reads can be in flight at once.
+  static constexpr int kNumReadThreads = 64;
+  static thread::ThreadPool* pool = new thread::ThreadPool(
+      Env::Default(), "random_access_file_read", kNumReadThreads);
+  pool->Schedule(std::move(fn));
+}
+
+void RandomAccessFile::ReadAsync(ReadRequest* request,
+                                 ReadDoneCallback done) const {
+  ScheduleRead([this, request, done = std::move(done)]() {
+    request->status = Read(request->offset, request->n, &request->result,
+                           request->scratch);
+    done(request->status);
+  });
+}
+
+void RandomAccessFile::ReadV(std::vector<ReadRequest>* requests,
+                             ReadDoneCallback done) const {
+  if (requests->empty()) {
+    done(Status::OK());
+    return;
+  }
+  struct State {
+    mutex mu;
+    int64 num_pending;
+  };
+  auto* state = new State;
+  state->num_pending = requests->size();
+  for (ReadRequest& request : *requests) {
+    ReadAsync(&request, [requests, state, done](const Status&) {
+      {
+        mutex_lock l(state->mu);
+        if (--state->num_pending > 0) return;
+      }
+      delete state;
+      for (const ReadRequest& request : *requests) {
+        if (!request.status.ok()) {
+          done(request.status);
+          return;
+        }
+      }
+      done(Status::OK());
+    });
+  }
+}
+
 }  // namespace tensorflow
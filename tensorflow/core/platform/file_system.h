@@ -388,6 +388,50 @@ class RandomAccessFile {
   }
 #endif
 
+  /// \brief A read of up to `n` bytes starting at `offset`, for ReadAsync()
+  /// and ReadV().
+  struct ReadRequest {
+    uint64 offset = 0;
+    size_t n = 0;
+    /// Like the `scratch` of Read(): must hold `n` bytes, and stay live while
+    /// `result` is used.
+    char* scratch = nullptr;
+    /// Set like the `result` and return value of Read().
+    StringPiece result;
+    Status status;
+  };
+
+  typedef std::function<void(const Status&)> ReadDoneCallback;
+
+  /// \brief Reads `request` without blocking the caller, and calls `done`
+  /// with its status once it is set.
+  ///
+  /// `request` and the file must stay live until `done` is called, which may
+  /// happen on another thread, or before ReadAsync returns.
+  ///
+  /// The default implementation calls Read() on a thread pool shared by all
+  /// files, so that many reads can be in flight without a thread each.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(ReadRequest* request, ReadDoneCallback done) const;
+
+  /// \brief Reads all of `requests`, possibly concurrently, and calls `done`
+  /// once each of them has its result and status set.
+  ///
+  /// `done` gets the first non-OK status of `requests`, in order. `requests`
+  /// and the file must stay live until `done` is called.
+  ///
+  /// The default implementation calls ReadAsync() for each request.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadV(std::vector<ReadRequest>* requests,
+                     ReadDoneCallback done) const;
+
+ protected:
+  /// \brief Runs `fn` on the thread pool of the default ReadAsync(), for
+  /// implementations that block on reads of their own.
+  static void ScheduleRead(std::function<void()> fn);
+
  private:
   TF_DISALLOW_COPY_AND_ASSIGN(RandomAccessFile);
 };
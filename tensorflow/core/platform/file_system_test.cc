@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/platform/file_system.h"
 
+#include <string.h>
 #include <sys/stat.h>
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
 #include "tensorflow/core/platform/str_util.h"
@@ -301,4 +305,56 @@ TEST(TestFileSystemTest, RootDirectory) {
   EXPECT_EQ("./test", results[0]);
 }
 
+// A file that holds `contents`, and only implements Read().
+class StringRandomAccessFile : public RandomAccessFile {
+ public:
+  explicit StringRandomAccessFile(const string& contents)
+      : contents_(contents) {}
+
+  Status Read(uint64 offset, size_t n, StringPiece* result,
+              char* scratch) const override {
+    if (offset >= contents_.size()) {
+      *result = StringPiece();
+      return errors::OutOfRange("Read past the end");
+    }
+    const size_t available = std::min<size_t>(n, contents_.size() - offset);
+    memcpy(scratch, contents_.data() + offset, available);
+    *result = StringPiece(scratch, available);
+    if (available < n) {
+      return errors::OutOfRange("Read less bytes than requested");
+    }
+    return Status::OK();
+  }
+
+ private:
+  const string contents_;
+};
+
+TEST(RandomAccessFileTest, DefaultReadV) {
+  StringRandomAccessFile file("0123456789");
+  std::vector<char> scratch(3 * 4);
+  std::vector<RandomAccessFile::ReadRequest> requests(3);
+  const uint64 offsets[] = {6, 1, 8};
+  for (int i = 0; i < 3; ++i) {
+    requests[i].offset = offsets[i];
+    requests[i].n = 4;
+    requests[i].scratch = scratch.data() + 4 * i;
+  }
+  Notification done;
+  Status status;
+  file.ReadV(&requests, [&done, &status](const Status& s) {
+    status = s;
+    done.Notify();
+  });
+  done.WaitForNotification();
+
+  EXPECT_EQ(error::OUT_OF_RANGE, status.code());
+  TF_EXPECT_OK(requests[0].status);
+  EXPECT_EQ("6789", requests[0].result);
+  TF_EXPECT_OK(requests[1].status);
+  EXPECT_EQ("1234", requests[1].result);
+  EXPECT_EQ(error::OUT_OF_RANGE, requests[2].status.code());
+  EXPECT_EQ("89", requests[2].result);
+}
+
 }  // namespace tensorflow
@@ -17,6 +17,10 @@ limitations under the License.
 
 #include <errno.h>
 
+#include <limits>
+#include <utility>
+#include <vector>
+
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/error.h"
 #include "tensorflow/core/platform/file_system.h"
@@ -50,9 +54,13 @@ class LibHDFS {
   std::function<hdfsFS(hdfsBuilder*)> hdfsBuilderConnect;
   std::function<hdfsBuilder*()> hdfsNewBuilder;
   std::function<void(hdfsBuilder*, const char*)> hdfsBuilderSetNameNode;
+  std::function<int(hdfsBuilder*, const char*, const char*)>
+      hdfsBuilderConfSetStr;
   std::function<int(const char*, char**)> hdfsConfGetStr;
   std::function<int(hdfsFS, hdfsFile)> hdfsCloseFile;
   std::function<tSize(hdfsFS, hdfsFile, tOffset, void*, tSize)> hdfsPread;
+  // Only in libhdfs from Hadoop 3.3 on; empty if the library lacks it.
+  std::function<int(hdfsFS, hdfsFile, tOffset, void*, tSize)> hdfsPreadFully;
   std::function<tSize(hdfsFS, hdfsFile, const void*, tSize)> hdfsWrite;
   std::function<int(hdfsFS, hdfsFile)> hdfsHFlush;
   std::function<int(hdfsFS, hdfsFile)> hdfsHSync;
@@ -77,6 +85,7 @@ class LibHDFS {
       BIND_HDFS_FUNC(hdfsBuilderConnect);
       BIND_HDFS_FUNC(hdfsNewBuilder);
       BIND_HDFS_FUNC(hdfsBuilderSetNameNode);
+      BIND_HDFS_FUNC(hdfsBuilderConfSetStr);
       BIND_HDFS_FUNC(hdfsConfGetStr);
       BIND_HDFS_FUNC(hdfsCloseFile);
       BIND_HDFS_FUNC(hdfsPread);
@@ -93,6 +102,9 @@ class LibHDFS {
       BIND_HDFS_FUNC(hdfsGetPathInfo);
       BIND_HDFS_FUNC(hdfsRename);
 #undef BIND_HDFS_FUNC
+      if (!BindFunc(*handle, "hdfsPreadFully", &hdfsPreadFully).ok()) {
+        VLOG(1) << "libhdfs has no hdfsPreadFully, reads use hdfsPread";
+      }
       return Status::OK();
     };
 
@@ -154,6 +166,43 @@ Status SplitArchiveNameAndPath(StringPiece& path, string& nn) {
   return Status::OK();
 }
 
+// Sets the options of the HDFS client that the environment asks for on
+// `builder`. The returned strings hold the values, and must outlive the
+// builder, which does not copy them.
+//
+// HDFS_SHORT_CIRCUIT_DOMAIN_SOCKET_PATH turns on short-circuit local reads,
+// which read blocks of co-located datanodes straight from their files. It takes
+// the path of the datanodes' domain socket (dfs.domain.socket.path).
+//
+// HDFS_HEDGED_READ_THRESHOLD_MILLIS turns on hedged reads: a read that takes
+// longer than the threshold, like the p95 read latency of the cluster, is sent
+// to a second replica as well, and the first response wins.
+// HDFS_HEDGED_READ_THREADPOOL_SIZE overrides the number of threads for them.
+std::vector<string> ConfigureBuilder(hdfsBuilder* builder) {
+  std::vector<std::pair<const char*, string>> options;
+  const char* socket_path = getenv("HDFS_SHORT_CIRCUIT_DOMAIN_SOCKET_PATH");
+  if (socket_path != nullptr && socket_path[0] != '\0') {
+    options.emplace_back("dfs.client.read.shortcircuit", "true");
+    options.emplace_back("dfs.domain.socket.path", socket_path);
+  }
+  const char* hedged_threshold = getenv("HDFS_HEDGED_READ_THRESHOLD_MILLIS");
+  if (hedged_threshold != nullptr && hedged_threshold[0] != '\0') {
+    const char* pool_size = getenv("HDFS_HEDGED_READ_THREADPOOL_SIZE");
+    options.emplace_back("dfs.client.hedged.read.threshold.millis",
+                         hedged_threshold);
+    options.emplace_back("dfs.client.hedged.read.threadpool.size",
+                         pool_size != nullptr ? pool_size : "16");
+  }
+  std::vector<string> values;
+  values.reserve(options.size());
+  for (const auto& option : options) {
+    values.push_back(option.second);
+    libhdfs()->hdfsBuilderConfSetStr(builder, option.first,
+                                     values.back().c_str());
+  }
+  return values;
+}
+
 // We rely on HDFS connection caching here. The HDFS client calls
 // org.apache.hadoop.fs.FileSystem.get(), which caches the connection
 // internally.
@@ -165,6 +214,7 @@ Status HadoopFileSystem::Connect(StringPiece fname, hdfsFS* fs) {
   string nn(namenode);
 
   hdfsBuilder* builder = libhdfs()->hdfsNewBuilder();
+  const std::vector<string> option_values = ConfigureBuilder(builder);
   if (scheme == "file") {
     libhdfs()->hdfsBuilderSetNameNode(builder, nullptr);
   } else if (scheme == "viewfs") {
@@ -228,6 +278,18 @@ class HDFSRandomAccessFile : public RandomAccessFile {
     Status s;
     char* dst = scratch;
     bool eof_retried = false;
+    if (libhdfs()->hdfsPreadFully &&
+        n <= static_cast<size_t>(std::numeric_limits<int>::max() - 2)) {
+      // hdfsPreadFully reads into `scratch` directly rather than through a
+      // Java array, and does not return until all `n` bytes are read. It fails
+      // at the end of the file, where the loop below takes over.
+      mutex_lock lock(mu_);
+      if (libhdfs()->hdfsPreadFully(fs_, file_, static_cast<tOffset>(offset),
+                                    dst, static_cast<tSize>(n)) == 0) {
+        *result = StringPiece(scratch, n);
+        return Status::OK();
+      }
+    }
     while (n > 0 && s.ok()) {
       // We lock inside the loop rather than outside so we don't block other
       // concurrent readers.
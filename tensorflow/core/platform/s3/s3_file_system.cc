@@ -35,6 +35,7 @@ limitations under the License.
 #include <aws/s3/model/PutObjectRequest.h>
 #include <aws/s3/model/UploadPartCopyRequest.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 
@@ -52,6 +53,8 @@ static const char* kS3FileSystemAllocationTag = "S3FileSystemAllocation";
 static const size_t kS3ReadAppendableFileBufferSize = 1024 * 1024;
 static const int64 kS3TimeoutMsec = 300000;                       // 5 min
 static const uint64 kS3MultiPartCopyPartSize = 50 * 1024 * 1024;  // 50MB
+// S3 does not accept parts of multipart uploads smaller than 5MB.
+static const uint64 kS3MinMultiPartUploadPartSize = 5 * 1024 * 1024;
 static const int kS3GetChildrenMaxKeys = 100;
 static const int kExecutorPoolSize = 5;
 static const int kUploadRetries = 5;
@@ -378,6 +381,27 @@ S3FileSystem::S3FileSystem()
       multi_part_copy_part_size_ = part_size_num;
     }
   }
+
+  // Writable files are uploaded in parts of the same size as copies, unless
+  // overridden. Up to `executor_pool_size_` parts upload at once.
+  multi_part_upload_part_size_ = multi_part_copy_part_size_;
+  const char* upload_part_size_str = getenv("S3_MULTI_PART_UPLOAD_PART_SIZE");
+  if (upload_part_size_str) {
+    uint64 upload_part_size_num;
+    if (strings::safe_strtou64(upload_part_size_str, &upload_part_size_num)) {
+      multi_part_upload_part_size_ =
+          std::max(upload_part_size_num, kS3MinMultiPartUploadPartSize);
+    }
+  }
+  executor_pool_size_ = kExecutorPoolSize;
+  const char* pool_size_str = getenv("S3_TRANSFER_CONCURRENCY");
+  if (pool_size_str) {
+    int32 pool_size_num;
+    if (strings::safe_strto32(pool_size_str, &pool_size_num) &&
+        pool_size_num > 0) {
+      executor_pool_size_ = pool_size_num;
+    }
+  }
 }
 
 S3FileSystem::~S3FileSystem() {}
@@ -424,10 +448,10 @@ S3FileSystem::GetTransferManager() {
     Aws::Transfer::TransferManagerConfiguration config(
         this->GetExecutor().get());
     config.s3Client = s3_client;
-    config.bufferSize = this->multi_part_copy_part_size_;
-    // must be larger than pool size * multi_part_copy_part_size
+    config.bufferSize = this->multi_part_upload_part_size_;
+    // must be larger than pool size * multi_part_upload_part_size
     config.transferBufferMaxHeapSize =
-        (kExecutorPoolSize + 1) * this->multi_part_copy_part_size_;
+        (this->executor_pool_size_ + 1) * this->multi_part_upload_part_size_;
     this->transfer_manager_ = Aws::Transfer::TransferManager::Create(config);
   }
   return this->transfer_manager_;
@@ -438,7 +462,7 @@ S3FileSystem::GetExecutor() {
   if (this->executor_.get() == nullptr) {
     this->executor_ =
         Aws::MakeShared<Aws::Utils::Threading::PooledThreadExecutor>(
-            kExecutorTag, kExecutorPoolSize);
+            kExecutorTag, this->executor_pool_size_);
   }
   return this->executor_;
 }
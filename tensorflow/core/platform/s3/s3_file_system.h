@@ -134,6 +134,13 @@ class S3FileSystem : public FileSystem {
 
   // size to split objects during multipart copy
   uint64 multi_part_copy_part_size_;
+
+  // size to split writable files during multipart upload
+  uint64 multi_part_upload_part_size_;
+
+  // number of threads of the transfer manager, which bounds the number of
+  // parts of an upload in flight
+  int executor_pool_size_;
 };
 
 /// S3 implementation of a file system with retry on failures.
@@ -0,0 +1,235 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/xplane_to_critical_path.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/utils/tf_op_utils.h"
+#include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+// Dependency DAG of a GraphDef. Nodes are indexed in topological order.
+struct Dag {
+  std::vector<const NodeDef*> nodes;
+  std::vector<std::vector<int>> preds;
+  std::vector<std::vector<int>> succs;
+  absl::flat_hash_map<absl::string_view, int> index;
+};
+
+// Returns the name of the node producing the given input ("^node",
+// "node:1" or "node").
+absl::string_view InputNodeName(absl::string_view input) {
+  if (absl::ConsumePrefix(&input, "^")) return input;
+  size_t colon = input.rfind(':');
+  return colon == absl::string_view::npos ? input : input.substr(0, colon);
+}
+
+Dag BuildDag(const GraphDef& graph) {
+  int num_nodes = graph.node_size();
+  absl::flat_hash_map<absl::string_view, int> graph_index;
+  for (int i = 0; i < num_nodes; ++i) {
+    graph_index.emplace(graph.node(i).name(), i);
+  }
+  std::vector<std::vector<int>> graph_succs(num_nodes);
+  std::vector<int> pending(num_nodes, 0);
+  for (int i = 0; i < num_nodes; ++i) {
+    for (const auto& input : graph.node(i).input()) {
+      auto it = graph_index.find(InputNodeName(input));
+      if (it == graph_index.end()) continue;
+      // Back edges of while loops.
+      if (graph.node(it->second).op() == "NextIteration") continue;
+      graph_succs[it->second].push_back(i);
+      ++pending[i];
+    }
+  }
+  std::vector<int> order;
+  order.reserve(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) {
+    if (pending[i] == 0) order.push_back(i);
+  }
+  for (size_t head = 0; head < order.size(); ++head) {
+    for (int succ : graph_succs[order[head]]) {
+      if (--pending[succ] == 0) order.push_back(succ);
+    }
+  }
+  if (order.size() < num_nodes) {
+    LOG(WARNING) << "Dropping " << num_nodes - order.size()
+                 << " nodes on cycles from the critical path analysis.";
+  }
+  std::vector<int> dag_index(num_nodes, -1);
+  for (int i = 0; i < order.size(); ++i) dag_index[order[i]] = i;
+  Dag dag;
+  dag.nodes.reserve(order.size());
+  dag.preds.resize(order.size());
+  dag.succs.resize(order.size());
+  for (int i = 0; i < order.size(); ++i) {
+    const NodeDef& node = graph.node(order[i]);
+    dag.nodes.push_back(&node);
+    dag.index.emplace(node.name(), i);
+    for (int succ : graph_succs[order[i]]) {
+      if (dag_index[succ] < 0) continue;
+      dag.succs[i].push_back(dag_index[succ]);
+      dag.preds[dag_index[succ]].push_back(i);
+    }
+  }
+  return dag;
+}
+
+// Fills the earliest start time of every node and returns the length of the
+// critical path.
+uint64 ComputeEarliestStarts(const Dag& dag,
+                             const std::vector<uint64>& durations_ps,
+                             std::vector<uint64>* earliest_start_ps) {
+  uint64 critical_path_ps = 0;
+  earliest_start_ps->assign(dag.nodes.size(), 0);
+  for (int i = 0; i < dag.nodes.size(); ++i) {
+    uint64& start_ps = (*earliest_start_ps)[i];
+    for (int pred : dag.preds[i]) {
+      start_ps =
+          std::max(start_ps, (*earliest_start_ps)[pred] + durations_ps[pred]);
+    }
+    critical_path_ps = std::max(critical_path_ps, start_ps + durations_ps[i]);
+  }
+  return critical_path_ps;
+}
+
+// Fills the longest path from the start of every node to the end of the DAG.
+void ComputeTails(const Dag& dag, const std::vector<uint64>& durations_ps,
+                  std::vector<uint64>* tail_ps) {
+  tail_ps->assign(dag.nodes.size(), 0);
+  for (int i = dag.nodes.size() - 1; i >= 0; --i) {
+    uint64 succ_tail_ps = 0;
+    for (int succ : dag.succs[i]) {
+      succ_tail_ps = std::max(succ_tail_ps, (*tail_ps)[succ]);
+    }
+    (*tail_ps)[i] = durations_ps[i] + succ_tail_ps;
+  }
+}
+
+StepCriticalPath ConvertDurationsToStepCriticalPath(
+    const Dag& dag, int64 step_num, std::vector<uint64> durations_ps) {
+  StepCriticalPath result;
+  result.set_step_num(step_num);
+  std::vector<uint64> earliest_start_ps;
+  std::vector<uint64> tail_ps;
+  uint64 critical_path_ps =
+      ComputeEarliestStarts(dag, durations_ps, &earliest_start_ps);
+  ComputeTails(dag, durations_ps, &tail_ps);
+  result.set_critical_path_ps(critical_path_ps);
+
+  // Follow one critical path from a source to a sink.
+  int current = -1;
+  for (int i = 0; i < dag.nodes.size() && current < 0; ++i) {
+    if (dag.preds[i].empty() && tail_ps[i] == critical_path_ps) current = i;
+  }
+  while (current >= 0) {
+    if (durations_ps[current] > 0) {
+      result.add_critical_path(dag.nodes[current]->name());
+    }
+    int next = -1;
+    for (int succ : dag.succs[current]) {
+      if (tail_ps[succ] + durations_ps[current] == tail_ps[current]) {
+        next = succ;
+        break;
+      }
+    }
+    current = next;
+  }
+
+  std::vector<uint64> faster_durations_ps;
+  std::vector<uint64> scratch_ps;
+  for (int i = 0; i < dag.nodes.size(); ++i) {
+    if (durations_ps[i] == 0) continue;
+    CriticalPathOp* op = result.add_ops();
+    op->set_name(dag.nodes[i]->name());
+    op->set_type(dag.nodes[i]->op());
+    op->set_duration_ps(durations_ps[i]);
+    op->set_earliest_start_ps(earliest_start_ps[i]);
+    op->set_latest_start_ps(critical_path_ps - tail_ps[i]);
+    op->set_slack_ps(op->latest_start_ps() - op->earliest_start_ps());
+    op->set_on_critical_path(op->slack_ps() == 0);
+    if (op->on_critical_path()) {
+      // Another path may become critical, so rerun the forward pass.
+      uint64 saved_ps = durations_ps[i];
+      durations_ps[i] = saved_ps - saved_ps / 2;
+      op->set_critical_path_if_2x_faster_ps(
+          ComputeEarliestStarts(dag, durations_ps, &scratch_ps));
+      durations_ps[i] = saved_ps;
+    } else {
+      op->set_critical_path_if_2x_faster_ps(critical_path_ps);
+    }
+  }
+  std::stable_sort(result.mutable_ops()->begin(), result.mutable_ops()->end(),
+                   [](const CriticalPathOp& a, const CriticalPathOp& b) {
+                     if (a.critical_path_if_2x_faster_ps() !=
+                         b.critical_path_if_2x_faster_ps()) {
+                       return a.critical_path_if_2x_faster_ps() <
+                              b.critical_path_if_2x_faster_ps();
+                     }
+                     return a.duration_ps() > b.duration_ps();
+                   });
+  return result;
+}
+
+}  // namespace
+
+CriticalPathDb ConvertHostThreadsXPlaneToCriticalPathDb(
+    const XPlane& host_trace, const GraphDef& graph) {
+  Dag dag = BuildDag(graph);
+  absl::flat_hash_map<int64, TfOp> tf_ops =
+      CollectTfOpsFromHostThreadsXPlane(host_trace);
+  // Maps a step to the time each DAG node spent in it.
+  std::map<int64, std::vector<uint64>> step_durations_ps;
+  XPlaneVisitor plane = CreateTfXPlaneVisitor(&host_trace);
+  plane.ForEachLine([&](const XLineVisitor& line) {
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      auto tf_op = tf_ops.find(event.Id());
+      if (tf_op == tf_ops.end()) return;
+      auto node = dag.index.find(tf_op->second.name);
+      if (node == dag.index.end()) return;
+      int64 group_id = -1;
+      event.ForEachStat([&](const XStatVisitor& stat) {
+        if (stat.Type() == StatType::kGroupId) group_id = stat.IntValue();
+      });
+      if (group_id < 0) return;
+      std::vector<uint64>& durations_ps = step_durations_ps[group_id];
+      if (durations_ps.empty()) durations_ps.resize(dag.nodes.size(), 0);
+      // Ops in a while loop run once per iteration.
+      durations_ps[node->second] += event.DurationPs();
+    });
+  });
+  CriticalPathDb result;
+  for (auto& step_and_durations : step_durations_ps) {
+    *result.add_steps() = ConvertDurationsToStepCriticalPath(
+        dag, step_and_durations.first, std::move(step_and_durations.second));
+  }
+  return result;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
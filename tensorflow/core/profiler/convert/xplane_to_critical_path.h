@@ -0,0 +1,40 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
+
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/profiler/protobuf/critical_path.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Rebuilds the executor dependency DAG of `graph` (data and control edges,
+// ignoring NextIteration back edges) and, for every step in `host_trace`,
+// weights each node with the time its TF op events spent in that step. Returns
+// the critical path of each step, the slack of every executed op, and the
+// critical path length if that op ran 2x faster.
+// The DAG ignores scheduling limits (inter-op threads), so the critical path is
+// a lower bound of the step time.
+// NOTE: call GroupTfEvents before, the step of an op is its group id.
+CriticalPathDb ConvertHostThreadsXPlaneToCriticalPathDb(
+    const XPlane& host_trace, const GraphDef& graph);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_XPLANE_TO_CRITICAL_PATH_H_
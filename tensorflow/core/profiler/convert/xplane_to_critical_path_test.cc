@@ -0,0 +1,100 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/xplane_to_critical_path.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/utils/group_events.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+void AddNode(const string& name, const string& op,
+             const std::vector<string>& inputs, GraphDef* graph) {
+  NodeDef* node = graph->add_node();
+  node->set_name(name);
+  node->set_op(op);
+  for (const string& input : inputs) node->add_input(input);
+}
+
+// Diamond a -> {b, c} -> d, where b takes longer than c.
+TEST(ConvertXPlaneToCriticalPath, Diamond) {
+  GraphDef graph;
+  AddNode("a", "Const", {}, &graph);
+  AddNode("b", "MatMul", {"a"}, &graph);
+  AddNode("c", "Relu", {"a:0"}, &graph);
+  AddNode("d", "AddN", {"b", "c", "^a"}, &graph);
+
+  XSpace space;
+  XPlane* host_plane = space.add_planes();
+  XPlaneBuilder host_plane_builder(host_plane);
+  host_plane_builder.SetName(kHostThreads);
+  host_plane_builder.ReserveLines(2);
+
+  auto main_thread = host_plane_builder.GetOrCreateLine(0);
+  CreateXEvent(&host_plane_builder, &main_thread, HostEventType::kTraceContext,
+               0, 200, {{StatType::kStepNum, 123}});
+  CreateXEvent(&host_plane_builder, &main_thread, HostEventType::kFunctionRun,
+               10, 190, {{StatType::kStepId, 0}});
+
+  auto tf_executor_thread = host_plane_builder.GetOrCreateLine(1);
+  CreateXEvent(&host_plane_builder, &tf_executor_thread,
+               HostEventType::kExecutorStateProcess, 20, 180,
+               {{StatType::kStepId, 0}});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "a:Const", 20, 10,
+               {});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "b:MatMul", 30, 30,
+               {});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "c:Relu", 60, 20, {});
+  CreateXEvent(&host_plane_builder, &tf_executor_thread, "d:AddN", 80, 10, {});
+
+  GroupTfEvents(&space, /*event_group_name_map=*/nullptr);
+  CriticalPathDb db =
+      ConvertHostThreadsXPlaneToCriticalPathDb(*host_plane, graph);
+
+  ASSERT_EQ(db.steps_size(), 1);
+  const StepCriticalPath& step = db.steps(0);
+  EXPECT_EQ(step.critical_path_ps(), 50);
+  ASSERT_EQ(step.critical_path_size(), 3);
+  EXPECT_EQ(step.critical_path(0), "a");
+  EXPECT_EQ(step.critical_path(1), "b");
+  EXPECT_EQ(step.critical_path(2), "d");
+
+  ASSERT_EQ(step.ops_size(), 4);
+  // Halving b saves 10ps rather than 15ps, since a -> c -> d becomes critical.
+  absl::flat_hash_map<string, CriticalPathOp> ops;
+  for (const auto& op : step.ops()) ops[op.name()] = op;
+  EXPECT_EQ(ops["a"].critical_path_if_2x_faster_ps(), 45);
+  EXPECT_EQ(ops["b"].critical_path_if_2x_faster_ps(), 40);
+  EXPECT_EQ(ops["d"].critical_path_if_2x_faster_ps(), 45);
+  EXPECT_TRUE(ops["b"].on_critical_path());
+  EXPECT_FALSE(ops["c"].on_critical_path());
+  EXPECT_EQ(ops["c"].earliest_start_ps(), 10);
+  EXPECT_EQ(ops["c"].latest_start_ps(), 20);
+  EXPECT_EQ(ops["c"].slack_ps(), 10);
+  EXPECT_EQ(ops["c"].critical_path_if_2x_faster_ps(), 50);
+  // b is the best candidate for optimization.
+  EXPECT_EQ(step.ops(0).name(), "b");
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
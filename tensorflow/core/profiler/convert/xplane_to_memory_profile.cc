@@ -0,0 +1,187 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/xplane_to_memory_profile.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/utils/tf_xplane_visitor.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+constexpr absl::string_view kUnknownTfOp = "unknown";
+
+// Numeric TraceMe arguments are stored as int64, or uint64 if they overflow.
+uint64 GetUintValue(const XStatVisitor& stat) {
+  return stat.ValueCase() == XStat::kUint64Value
+             ? stat.UintValue()
+             : static_cast<uint64>(stat.IntValue());
+}
+
+bool ByAllocationBytesDesc(const MemoryActivity& a, const MemoryActivity& b) {
+  if (a.allocation_bytes() != b.allocation_bytes()) {
+    return a.allocation_bytes() > b.allocation_bytes();
+  }
+  return a.timestamp_ps() < b.timestamp_ps();
+}
+
+// Fills the peak and its breakdown from the timeline of `profile`.
+void ProcessTimeline(AllocatorMemoryProfile* profile) {
+  const auto& timeline = profile->timeline();
+  int peak_index = -1;
+  for (int i = 0; i < timeline.size(); ++i) {
+    if (peak_index < 0 ||
+        timeline[i].bytes_in_use() > timeline[peak_index].bytes_in_use()) {
+      peak_index = i;
+    }
+  }
+  if (peak_index < 0) return;
+  profile->set_peak_bytes_in_use(timeline[peak_index].bytes_in_use());
+  profile->set_peak_timestamp_ps(timeline[peak_index].timestamp_ps());
+
+  // Replay the timeline up to the peak to find the live allocations.
+  absl::flat_hash_map<uint64, const MemoryActivity*> active;
+  for (int i = 0; i <= peak_index; ++i) {
+    if (timeline[i].is_allocation()) {
+      active[timeline[i].address()] = &timeline[i];
+    } else {
+      active.erase(timeline[i].address());
+    }
+  }
+  std::map<std::string, OpMemoryBreakdown> breakdown;
+  for (const auto& address_and_activity : active) {
+    const MemoryActivity& activity = *address_and_activity.second;
+    *profile->add_active_allocations_at_peak() = activity;
+    std::string tf_op = activity.tf_op().empty() ? std::string(kUnknownTfOp)
+                                                 : activity.tf_op();
+    OpMemoryBreakdown& op = breakdown[tf_op];
+    op.set_tf_op(tf_op);
+    op.set_allocation_bytes(op.allocation_bytes() +
+                            activity.allocation_bytes());
+    op.set_num_allocations(op.num_allocations() + 1);
+  }
+  std::sort(profile->mutable_active_allocations_at_peak()->begin(),
+            profile->mutable_active_allocations_at_peak()->end(),
+            ByAllocationBytesDesc);
+  for (auto& tf_op_and_breakdown : breakdown) {
+    *profile->add_op_breakdown_at_peak() =
+        std::move(tf_op_and_breakdown.second);
+  }
+  std::stable_sort(profile->mutable_op_breakdown_at_peak()->begin(),
+                   profile->mutable_op_breakdown_at_peak()->end(),
+                   [](const OpMemoryBreakdown& a, const OpMemoryBreakdown& b) {
+                     return a.allocation_bytes() > b.allocation_bytes();
+                   });
+}
+
+}  // namespace
+
+MemoryProfile ConvertXPlaneToMemoryProfile(const XPlane& host_plane) {
+  std::map<std::string, AllocatorMemoryProfile> profiles;
+  XPlaneVisitor plane = CreateTfXPlaneVisitor(&host_plane);
+  plane.ForEachLine([&](const XLineVisitor& line) {
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      absl::optional<int64> event_type = event.Type();
+      if (!event_type.has_value() ||
+          (*event_type != HostEventType::kMemoryAllocation &&
+           *event_type != HostEventType::kMemoryDeallocation)) {
+        return;
+      }
+      MemoryActivity activity;
+      activity.set_timestamp_ps(event.TimestampPs());
+      activity.set_is_allocation(*event_type ==
+                                 HostEventType::kMemoryAllocation);
+      absl::string_view allocator_name;
+      event.ForEachStat([&](const XStatVisitor& stat) {
+        if (!stat.Type().has_value()) return;
+        switch (*stat.Type()) {
+          case StatType::kAllocatorName:
+            allocator_name = stat.StrValue();
+            break;
+          case StatType::kBytesAllocated:
+            activity.set_bytes_in_use(stat.IntValue());
+            break;
+          case StatType::kBytesReserved:
+            activity.set_bytes_reserved(stat.IntValue());
+            break;
+          case StatType::kRequestedBytes:
+            activity.set_requested_bytes(stat.IntValue());
+            break;
+          case StatType::kAllocationBytes:
+            activity.set_allocation_bytes(stat.IntValue());
+            break;
+          case StatType::kAddress:
+            activity.set_address(GetUintValue(stat));
+            break;
+          case StatType::kTfOp:
+            activity.set_tf_op(std::string(stat.StrValue()));
+            break;
+          case StatType::kStepId:
+            activity.set_step_id(stat.IntValue());
+            break;
+          case StatType::kTensorShapes:
+            activity.set_tensor_shape(std::string(stat.StrValue()));
+            break;
+          default:
+            break;
+        }
+      });
+      AllocatorMemoryProfile& profile =
+          profiles[std::string(allocator_name)];
+      *profile.add_timeline() = std::move(activity);
+    });
+  });
+
+  MemoryProfile result;
+  for (auto& name_and_profile : profiles) {
+    AllocatorMemoryProfile& profile = name_and_profile.second;
+    profile.set_allocator_name(name_and_profile.first);
+    auto* timeline = profile.mutable_timeline();
+    std::stable_sort(timeline->begin(), timeline->end(),
+                     [](const MemoryActivity& a, const MemoryActivity& b) {
+                       return a.timestamp_ps() < b.timestamp_ps();
+                     });
+    // Attribute deallocations to the op that made the allocation, since the
+    // op running at deallocation time is unrelated.
+    absl::flat_hash_map<uint64, const MemoryActivity*> allocations;
+    for (MemoryActivity& activity : *timeline) {
+      if (activity.is_allocation()) {
+        allocations[activity.address()] = &activity;
+        continue;
+      }
+      auto it = allocations.find(activity.address());
+      if (it == allocations.end()) continue;
+      activity.set_tf_op(it->second->tf_op());
+      activity.set_step_id(it->second->step_id());
+      activity.set_tensor_shape(it->second->tensor_shape());
+      allocations.erase(it);
+    }
+    ProcessTimeline(&profile);
+    *result.add_allocators() = std::move(profile);
+  }
+  return result;
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
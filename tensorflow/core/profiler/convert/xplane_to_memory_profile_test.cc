@@ -0,0 +1,95 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/xplane_to_memory_profile.h"
+
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/utils/xplane_builder.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+void AddMemoryEvent(XPlaneBuilder* plane, XLineBuilder* line,
+                    HostEventType type, int64 offset_ps, int64 bytes_in_use,
+                    int64 allocation_bytes, int64 address,
+                    absl::string_view tf_op, absl::string_view shape) {
+  auto event = CreateXEvent(plane, line, type, offset_ps, 1,
+                            {{StatType::kBytesAllocated, bytes_in_use},
+                             {StatType::kAllocationBytes, allocation_bytes},
+                             {StatType::kRequestedBytes, allocation_bytes},
+                             {StatType::kAddress, address}});
+  event.ParseAndAddStatValue(
+      *plane->GetOrCreateStatMetadata(GetStatTypeStr(StatType::kAllocatorName)),
+      "GPU_0_bfc");
+  event.ParseAndAddStatValue(
+      *plane->GetOrCreateStatMetadata(GetStatTypeStr(StatType::kTfOp)), tf_op);
+  event.ParseAndAddStatValue(
+      *plane->GetOrCreateStatMetadata(GetStatTypeStr(StatType::kTensorShapes)),
+      shape);
+}
+
+// conv1 allocates two buffers, relu one; the first conv1 buffer is freed
+// after the peak.
+TEST(ConvertXPlaneToMemoryProfile, PeakBreakdown) {
+  XSpace space;
+  XPlane* host_plane = space.add_planes();
+  XPlaneBuilder host_plane_builder(host_plane);
+  host_plane_builder.SetName(kHostThreads);
+  host_plane_builder.ReserveLines(1);
+  auto line = host_plane_builder.GetOrCreateLine(0);
+
+  AddMemoryEvent(&host_plane_builder, &line, HostEventType::kMemoryAllocation,
+                 10, 256, 256, 1000, "conv1", "[8,8]");
+  AddMemoryEvent(&host_plane_builder, &line, HostEventType::kMemoryAllocation,
+                 20, 768, 512, 2000, "conv1", "[8,16]");
+  AddMemoryEvent(&host_plane_builder, &line,
+                 HostEventType::kMemoryDeallocation, 30, 512, 256, 1000,
+                 "relu", "[4]");
+  AddMemoryEvent(&host_plane_builder, &line, HostEventType::kMemoryAllocation,
+                 40, 1536, 1024, 3000, "relu", "[16,16]");
+  AddMemoryEvent(&host_plane_builder, &line,
+                 HostEventType::kMemoryDeallocation, 50, 1024, 512, 2000,
+                 "", "");
+
+  MemoryProfile profile = ConvertXPlaneToMemoryProfile(*host_plane);
+  ASSERT_EQ(profile.allocators_size(), 1);
+  const AllocatorMemoryProfile& allocator = profile.allocators(0);
+  EXPECT_EQ(allocator.allocator_name(), "GPU_0_bfc");
+  ASSERT_EQ(allocator.timeline_size(), 5);
+  // Deallocations are attributed to the allocating op.
+  EXPECT_EQ(allocator.timeline(2).tf_op(), "conv1");
+  EXPECT_EQ(allocator.timeline(2).tensor_shape(), "[8,8]");
+  EXPECT_EQ(allocator.peak_bytes_in_use(), 1536);
+  EXPECT_EQ(allocator.peak_timestamp_ps(), 40);
+
+  ASSERT_EQ(allocator.active_allocations_at_peak_size(), 2);
+  EXPECT_EQ(allocator.active_allocations_at_peak(0).tf_op(), "relu");
+  EXPECT_EQ(allocator.active_allocations_at_peak(0).tensor_shape(), "[16,16]");
+  EXPECT_EQ(allocator.active_allocations_at_peak(1).tf_op(), "conv1");
+
+  ASSERT_EQ(allocator.op_breakdown_at_peak_size(), 2);
+  EXPECT_EQ(allocator.op_breakdown_at_peak(0).tf_op(), "relu");
+  EXPECT_EQ(allocator.op_breakdown_at_peak(0).allocation_bytes(), 1024);
+  EXPECT_EQ(allocator.op_breakdown_at_peak(1).tf_op(), "conv1");
+  EXPECT_EQ(allocator.op_breakdown_at_peak(1).allocation_bytes(), 512);
+  EXPECT_EQ(allocator.op_breakdown_at_peak(1).num_allocations(), 1);
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
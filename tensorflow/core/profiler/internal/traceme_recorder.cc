@@ -16,6 +16,8 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <unordered_set>
+
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 
@@ -90,7 +92,8 @@ class EventQueue {
 
   // Retrieve and remove all events in the queue at the time of invocation.
   // If Push is called while PopAll is active, the new event will not be
-  // removed from the queue.
+  // removed from the queue. The static names of the events are copied into
+  // their names.
   // PopAll is only called from ThreadLocalRecorder::Clear, which in turn is
   // only called while holding TraceMeRecorder::Mutex, so PopAll has a single
   // caller at a time.
@@ -101,6 +104,11 @@ class EventQueue {
     result.reserve(end - start_);
     while (start_ != end) {
       result.emplace_back(Pop());
+      TraceMeRecorder::Event& event = result.back();
+      if (event.static_name != nullptr) {
+        event.name = event.static_name;
+        event.static_name = nullptr;
+      }
     }
     return result;
   }
@@ -272,5 +280,13 @@ TraceMeRecorder::Events TraceMeRecorder::StopRecording() {
   return static_cast<uint64>(thread_id) << 32 | per_thread_activity_id++;
 }
 
+/*static*/ const char* TraceMeRecorder::InternName(absl::string_view name) {
+  static mutex* mu = new mutex;
+  // A node-based set, so that the interned names never move.
+  static auto* names = new std::unordered_set<string>;
+  mutex_lock lock(*mu);
+  return names->emplace(name).first->c_str();
+}
+
 }  // namespace profiler
 }  // namespace tensorflow
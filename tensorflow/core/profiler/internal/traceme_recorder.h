@@ -21,6 +21,7 @@ limitations under the License.
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -52,11 +53,15 @@ class TraceMeRecorder {
  public:
   // An Event is either the start of a TraceMe, the end of a TraceMe, or both.
   // Times are in ns since the Unix epoch.
+  // An event recorded with a static_name has an empty name until the events
+  // are collected, at which point static_name is copied into name. This keeps
+  // string copies off the recording thread for names that outlive the trace.
   struct Event {
     uint64 activity_id;
     string name;
     uint64 start_time;  // 0 = missing
     uint64 end_time;    // 0 = missing
+    const char* static_name = nullptr;
   };
   struct ThreadInfo {
     uint32 tid;
@@ -91,6 +96,10 @@ class TraceMeRecorder {
   // Returns an activity_id for TraceMe::ActivityStart.
   static uint64 NewActivityId();
 
+  // Returns a copy of `name` that is never freed, and the same copy for equal
+  // names, so that it can be recorded as an Event::static_name.
+  static const char* InternName(absl::string_view name);
+
  private:
   class ThreadLocalRecorder;
 
@@ -0,0 +1,94 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/traceme_recorder.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+TEST(TraceMeTest, StaticNames) {
+  const TraceMeStaticName interned =
+      TraceMe::InternName(string("interned_name"));
+  EXPECT_EQ(interned.name, TraceMe::InternName("interned_name").name);
+
+  TraceMeRecorder::Start(/*level=*/1);
+  { TraceMe trace(TraceMeStaticName("static_name")); }
+  { TraceMe trace(interned); }
+  TraceMe::ActivityEnd(TraceMe::ActivityStart(interned));
+  TraceMeRecorder::Events events = TraceMeRecorder::Stop();
+
+  ASSERT_EQ(events.size(), 1);
+  ASSERT_EQ(events[0].events.size(), 4);
+  EXPECT_EQ(events[0].events[0].name, "static_name");
+  EXPECT_EQ(events[0].events[1].name, "interned_name");
+  EXPECT_EQ(events[0].events[2].name, "interned_name");
+  EXPECT_EQ(events[0].events[3].name, "");
+  for (const auto& event : events[0].events) {
+    EXPECT_EQ(event.static_name, nullptr);
+  }
+}
+
+// The number of events recorded between two collections in the benchmarks,
+// which bounds the memory they use.
+constexpr int kEventsPerCollection = 1 << 16;
+
+template <typename RecordT>
+void RunTraceMeBenchmark(int iters, RecordT record) {
+  TraceMeRecorder::Start(/*level=*/1);
+  testing::StartTiming();
+  for (int i = 0; i < iters; ++i) {
+    record();
+    if (TF_PREDICT_FALSE((i + 1) % kEventsPerCollection == 0)) {
+      testing::StopTiming();
+      TraceMeRecorder::Stop();
+      TraceMeRecorder::Start(/*level=*/1);
+      testing::StartTiming();
+    }
+  }
+  testing::StopTiming();
+  TraceMeRecorder::Stop();
+}
+
+void BM_TraceMeDisabled(int iters) {
+  for (int i = 0; i < iters; ++i) {
+    TraceMe trace("disabled");
+  }
+}
+BENCHMARK(BM_TraceMeDisabled);
+
+void BM_TraceMeEnabled_String(int iters, int name_size) {
+  testing::StopTiming();
+  const string name(name_size, 'a');
+  RunTraceMeBenchmark(iters,
+                      [&name] { TraceMe trace(absl::string_view(name)); });
+}
+BENCHMARK(BM_TraceMeEnabled_String)->Arg(8)->Arg(32)->Arg(128);
+
+void BM_TraceMeEnabled_StaticName(int iters, int name_size) {
+  testing::StopTiming();
+  const TraceMeStaticName name = TraceMe::InternName(string(name_size, 'a'));
+  RunTraceMeBenchmark(iters, [name] { TraceMe trace(name); });
+}
+BENCHMARK(BM_TraceMeEnabled_StaticName)->Arg(8)->Arg(32)->Arg(128);
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -0,0 +1,205 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/lib/continuous_profiler.h"
+
+#include <utility>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env_time.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/platform.h"
+#include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/util/env_var.h"
+
+#if !defined(IS_MOBILE_PLATFORM)
+#include "tensorflow/core/profiler/convert/op_metrics_db_combiner.h"
+#include "tensorflow/core/profiler/convert/xplane_to_op_metrics_db.h"
+#include "tensorflow/core/profiler/utils/xplane_schema.h"
+#include "tensorflow/core/profiler/utils/xplane_utils.h"
+#endif
+
+namespace tensorflow {
+
+ContinuousProfiler::ContinuousProfiler(const Options& options)
+    : options_(options) {
+  thread_.reset(Env::Default()->StartThread(
+      ThreadOptions(), "continuous_profiler", [this] { Run(); }));
+}
+
+ContinuousProfiler::~ContinuousProfiler() {
+  {
+    mutex_lock l(mu_);
+    stopping_ = true;
+    cond_var_.notify_all();
+  }
+  thread_.reset();
+}
+
+/*static*/ ContinuousProfiler* ContinuousProfiler::Global() {
+  static ContinuousProfiler* profiler = []() -> ContinuousProfiler* {
+    Options options;
+    int64 slice_ms = 0;
+    int64 period_ms = options.period_ms;
+    int64 max_slices = options.max_slices;
+    int64 host_tracer_level = options.profiler_options.host_tracer_level;
+    Status s = ReadInt64FromEnvVar("TF_PROFILER_CONTINUOUS_SLICE_MS", 0,
+                                   &slice_ms);
+    if (s.ok()) {
+      s = ReadInt64FromEnvVar("TF_PROFILER_CONTINUOUS_PERIOD_MS", period_ms,
+                              &period_ms);
+    }
+    if (s.ok()) {
+      s = ReadInt64FromEnvVar("TF_PROFILER_CONTINUOUS_MAX_SLICES", max_slices,
+                              &max_slices);
+    }
+    if (s.ok()) {
+      s = ReadInt64FromEnvVar("TF_PROFILER_HOST_TRACER_LEVEL",
+                              host_tracer_level, &host_tracer_level);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "ContinuousProfiler: " << s.error_message();
+      return nullptr;
+    }
+    if (slice_ms <= 0 || period_ms <= 0 || max_slices <= 0) return nullptr;
+    options.slice_ms = slice_ms;
+    options.period_ms = period_ms;
+    options.max_slices = max_slices;
+    options.profiler_options.host_tracer_level = host_tracer_level;
+    LOG(INFO) << "Recording " << slice_ms << "ms of profile every "
+              << period_ms << "ms, keeping the last " << max_slices;
+    return new ContinuousProfiler(options);
+  }();
+  return profiler;
+}
+
+void ContinuousProfiler::Suspend() {
+  mutex_lock l(mu_);
+  ++suspend_count_;
+  cond_var_.notify_all();
+  while (recording_) {
+    cond_var_.wait(l);
+  }
+}
+
+void ContinuousProfiler::Resume() {
+  mutex_lock l(mu_);
+  DCHECK_GT(suspend_count_, 0);
+  --suspend_count_;
+  cond_var_.notify_all();
+}
+
+Status ContinuousProfiler::GetLatestSlice(profiler::XSpace* space) {
+  mutex_lock l(mu_);
+  if (slices_.empty()) {
+    return errors::NotFound("No profile has been recorded yet.");
+  }
+  *space = slices_.back();
+  return Status::OK();
+}
+
+void ContinuousProfiler::GetSlices(std::vector<profiler::XSpace>* spaces) {
+  mutex_lock l(mu_);
+  spaces->assign(slices_.begin(), slices_.end());
+}
+
+profiler::OpMetricsDb ContinuousProfiler::GetOpMetricsDb(uint64* num_slices) {
+  mutex_lock l(mu_);
+  if (num_slices != nullptr) *num_slices = num_slices_;
+  return op_metrics_db_;
+}
+
+void ContinuousProfiler::Run() {
+  const uint64 pause_ms =
+      options_.period_ms > options_.slice_ms
+          ? options_.period_ms - options_.slice_ms
+          : 0;
+  while (RecordSlice()) {
+    mutex_lock l(mu_);
+    const uint64 end_micros =
+        EnvTime::NowMicros() + pause_ms * EnvTime::kMillisToMicros;
+    for (uint64 now = EnvTime::NowMicros(); !stopping_ && now < end_micros;
+         now = EnvTime::NowMicros()) {
+      WaitForMilliseconds(&l, &cond_var_,
+                          (end_micros - now) / EnvTime::kMillisToMicros + 1);
+    }
+  }
+}
+
+bool ContinuousProfiler::RecordSlice() {
+  {
+    mutex_lock l(mu_);
+    while (!stopping_ && suspend_count_ > 0) {
+      cond_var_.wait(l);
+    }
+    if (stopping_) return false;
+    recording_ = true;
+  }
+
+  std::unique_ptr<ProfilerSession> session =
+      ProfilerSession::Create(options_.profiler_options);
+  // Another session is active: skip this slice rather than wait for it.
+  bool recorded = session->Status().ok();
+  if (recorded) {
+    mutex_lock l(mu_);
+    const uint64 end_micros =
+        EnvTime::NowMicros() + options_.slice_ms * EnvTime::kMillisToMicros;
+    for (uint64 now = EnvTime::NowMicros();
+         !stopping_ && suspend_count_ == 0 && now < end_micros;
+         now = EnvTime::NowMicros()) {
+      WaitForMilliseconds(&l, &cond_var_,
+                          (end_micros - now) / EnvTime::kMillisToMicros + 1);
+    }
+  }
+
+  profiler::XSpace space;
+  if (recorded) {
+    Status s = session->CollectData(&space);
+    if (!s.ok()) {
+      VLOG(1) << "ContinuousProfiler: " << s.error_message();
+      recorded = false;
+    }
+  }
+  session.reset();
+
+#if !defined(IS_MOBILE_PLATFORM)
+  profiler::OpMetricsDb slice_db;
+  if (recorded) {
+    const profiler::XPlane* host_plane =
+        profiler::FindPlaneWithName(space, profiler::kHostThreads);
+    if (host_plane != nullptr) {
+      slice_db = profiler::ConvertHostThreadsXPlaneToOpMetricsDb(*host_plane);
+    }
+  }
+#endif
+
+  mutex_lock l(mu_);
+  recording_ = false;
+  if (recorded) {
+#if !defined(IS_MOBILE_PLATFORM)
+    profiler::OpMetricsDbCombiner combiner(&op_metrics_db_);
+    combiner.Combine(slice_db);
+#endif
+    ++num_slices_;
+    slices_.push_back(std::move(space));
+    while (slices_.size() > options_.max_slices) {
+      slices_.pop_front();
+    }
+  }
+  cond_var_.notify_all();
+  return !stopping_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,106 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+#define TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/internal/profiler_interface.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+
+// A profiler meant to be left on in production. Every `period_ms` it runs a
+// ProfilerSession for `slice_ms`, keeps the last `max_slices` XSpaces and adds
+// the host op metrics of each slice to a database that covers all the slices
+// recorded since the profiler started. The overhead is roughly that of a
+// session scaled by slice_ms / period_ms.
+//
+// Only one ProfilerSession can be active at a time, so an explicit capture
+// should Suspend() the continuous profiler first.
+//
+// Thread-safety: ContinuousProfiler is thread-safe.
+class ContinuousProfiler {
+ public:
+  struct Options {
+    uint64 period_ms = 60000;
+    uint64 slice_ms = 1000;
+    size_t max_slices = 10;
+    profiler::ProfilerOptions profiler_options;
+  };
+
+  // Starts the profiler thread.
+  explicit ContinuousProfiler(const Options& options);
+
+  // Stops the profiler thread, waiting for the current slice to be recorded.
+  ~ContinuousProfiler();
+
+  // Returns the process-wide profiler, or nullptr unless
+  // TF_PROFILER_CONTINUOUS_SLICE_MS is set to a positive value. The period and
+  // the number of kept slices are read from TF_PROFILER_CONTINUOUS_PERIOD_MS
+  // and TF_PROFILER_CONTINUOUS_MAX_SLICES.
+  static ContinuousProfiler* Global();
+
+  // Waits for the slice being recorded, if any, and records no other slice
+  // until Resume() has been called as many times as Suspend().
+  void Suspend() TF_LOCKS_EXCLUDED(mu_);
+  void Resume() TF_LOCKS_EXCLUDED(mu_);
+
+  // Copies the most recent slice into `space`. Returns NotFound if no slice
+  // has been recorded yet.
+  Status GetLatestSlice(profiler::XSpace* space) TF_LOCKS_EXCLUDED(mu_);
+
+  // Copies the kept slices, oldest first.
+  void GetSlices(std::vector<profiler::XSpace>* spaces) TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the host op metrics of all the slices recorded so far, and the
+  // number of these slices.
+  profiler::OpMetricsDb GetOpMetricsDb(uint64* num_slices = nullptr)
+      TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  void Run();
+
+  // Records one slice, unless the profiler is suspended or another session
+  // is active. Returns false once the profiler is stopping.
+  bool RecordSlice() TF_LOCKS_EXCLUDED(mu_);
+
+  const Options options_;
+
+  mutex mu_;
+  condition_variable cond_var_;
+  bool stopping_ TF_GUARDED_BY(mu_) = false;
+  bool recording_ TF_GUARDED_BY(mu_) = false;
+  int suspend_count_ TF_GUARDED_BY(mu_) = 0;
+  std::deque<profiler::XSpace> slices_ TF_GUARDED_BY(mu_);
+  profiler::OpMetricsDb op_metrics_db_ TF_GUARDED_BY(mu_);
+  uint64 num_slices_ TF_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<Thread> thread_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ContinuousProfiler);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_LIB_CONTINUOUS_PROFILER_H_
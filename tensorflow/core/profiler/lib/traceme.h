@@ -49,6 +49,14 @@ inline int GetTFTraceMeLevel(bool is_expensive) {
   return is_expensive ? kInfo : kVerbose;
 }
 
+// The name of a TraceMe whose storage outlives the profiling session, such as
+// a string literal or a name returned by TraceMe::InternName(). TraceMe only
+// records the pointer, and the name is copied when the trace is collected.
+struct TraceMeStaticName {
+  constexpr explicit TraceMeStaticName(const char* name) : name(name) {}
+  const char* name;
+};
+
 // This class permits user-specified (CPU) tracing activities. A trace activity
 // is started when an object of this class is created and stopped when the
 // object is destroyed.
@@ -118,6 +126,19 @@ class TraceMe {
   explicit TraceMe(const char *raw, int level = 1)
       : TraceMe(absl::string_view(raw), level) {}
 
+  // Constructor that records a pointer to the activity name rather than a
+  // copy; the cheapest one when many small activities are traced.
+  // Usage: profiler::TraceMe trace(TraceMeStaticName("step"));
+  explicit TraceMe(TraceMeStaticName activity_name, int level = 1) {
+    DCHECK_GE(level, 1);
+#if !defined(IS_MOBILE_PLATFORM)
+    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
+      static_name_ = activity_name.name;
+      start_time_ = EnvTime::NowNanos();
+    }
+#endif
+  }
+
   // This overload only generates the activity name if tracing is enabled.
   // Useful for avoiding things like string concatenation when tracing is
   // disabled. The |name_generator| may be a lambda or functor that returns a
@@ -150,11 +171,20 @@ class TraceMe {
     //   start/stop session timestamp.
 #if !defined(IS_MOBILE_PLATFORM)
     if (TF_PREDICT_FALSE(start_time_ != kUntracedActivity)) {
-      if (TF_PREDICT_TRUE(TraceMeRecorder::Active())) {
-        TraceMeRecorder::Record({kCompleteActivity, std::move(no_init_.name),
-                                 start_time_, EnvTime::NowNanos()});
+      if (static_name_ != nullptr) {
+        if (TF_PREDICT_TRUE(TraceMeRecorder::Active())) {
+          TraceMeRecorder::Record({kCompleteActivity, /*name=*/string(),
+                                   start_time_, EnvTime::NowNanos(),
+                                   static_name_});
+        }
+        static_name_ = nullptr;
+      } else {
+        if (TF_PREDICT_TRUE(TraceMeRecorder::Active())) {
+          TraceMeRecorder::Record({kCompleteActivity, std::move(no_init_.name),
+                                   start_time_, EnvTime::NowNanos()});
+        }
+        no_init_.name.~string();
       }
-      no_init_.name.~string();
       start_time_ = kUntracedActivity;
     }
 #endif
@@ -179,6 +209,19 @@ class TraceMe {
     return kUntracedActivity;
   }
 
+  static uint64 ActivityStart(TraceMeStaticName name, int level = 1) {
+#if !defined(IS_MOBILE_PLATFORM)
+    if (TF_PREDICT_FALSE(TraceMeRecorder::Active(level))) {
+      uint64 activity_id = TraceMeRecorder::NewActivityId();
+      TraceMeRecorder::Record({activity_id, /*name=*/string(),
+                               /*start_time=*/EnvTime::NowNanos(),
+                               /*end_time=*/0, name.name});
+      return activity_id;
+    }
+#endif
+    return kUntracedActivity;
+  }
+
   // Record the end time of an activity started by ActivityStart().
   static void ActivityEnd(uint64 activity_id) {
 #if !defined(IS_MOBILE_PLATFORM)
@@ -192,6 +235,17 @@ class TraceMe {
 #endif
   }
 
+  // Returns a name for TraceMeStaticName that is never freed. Interning the
+  // names of long-lived objects (e.g. op kernels) once avoids copying them for
+  // every trace.
+  static TraceMeStaticName InternName(absl::string_view name) {
+#if !defined(IS_MOBILE_PLATFORM)
+    return TraceMeStaticName(TraceMeRecorder::InternName(name));
+#else
+    return TraceMeStaticName("");
+#endif
+  }
+
   static bool Active(int level = 1) {
 #if !defined(IS_MOBILE_PLATFORM)
     return TraceMeRecorder::Active(level);
@@ -217,6 +271,8 @@ class TraceMe {
   } no_init_;
 
   uint64 start_time_ = kUntracedActivity;
+  // Set instead of no_init_.name by the TraceMeStaticName constructor.
+  const char* static_name_ = nullptr;
 };
 
 // Whether OpKernel::TraceString will populate additional information for
@@ -15,17 +15,23 @@ limitations under the License.
 
 #include "tensorflow/core/profiler/rpc/profiler_service_impl.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "grpcpp/support/status.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/profiler/convert/xplane_to_profile_response.h"
 #include "tensorflow/core/profiler/internal/profiler_interface.h"
+#include "tensorflow/core/profiler/lib/continuous_profiler.h"
 #include "tensorflow/core/profiler/lib/profiler_session.h"
+#include "tensorflow/core/profiler/protobuf/op_metrics.pb.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/util/ptr_util.h"
 
@@ -42,16 +48,73 @@ Status CollectDataToResponse(const ProfileRequest& req,
   return Status::OK();
 }
 
+// Lists the ops that took the most self time in the slices recorded by the
+// continuous profiler.
+string FormatOpMetricsDb(const profiler::OpMetricsDb& db, uint64 num_slices) {
+  std::vector<const profiler::OpMetrics*> metrics;
+  uint64 total_self_time_ps = 0;
+  for (const profiler::OpMetrics& op : db.metrics_db()) {
+    metrics.push_back(&op);
+    total_self_time_ps += op.self_time_ps();
+  }
+  std::sort(metrics.begin(), metrics.end(),
+            [](const profiler::OpMetrics* a, const profiler::OpMetrics* b) {
+              return a->self_time_ps() > b->self_time_ps();
+            });
+  string data =
+      absl::StrCat("Op metrics of ", num_slices, " profile slices:\n");
+  for (const profiler::OpMetrics* op : metrics) {
+    const double self_time_percent =
+        total_self_time_ps > 0 ? 100.0 * op->self_time_ps() / total_self_time_ps
+                               : 0.0;
+    absl::StrAppend(&data, op->name(), " (", op->category(), "): ",
+                    op->occurrences(), " times, ", op->self_time_ps() / 1000000,
+                    "us self time (", absl::SixDigits(self_time_percent),
+                    "%)\n");
+  }
+  return data;
+}
+
 class ProfilerServiceImpl : public grpc::ProfilerService::Service {
  public:
   ::grpc::Status Monitor(::grpc::ServerContext* ctx, const MonitorRequest* req,
                          MonitorResponse* response) override {
-    return ::grpc::Status(::grpc::StatusCode::UNIMPLEMENTED, "unimplemented.");
+    ContinuousProfiler* continuous_profiler = ContinuousProfiler::Global();
+    if (continuous_profiler == nullptr) {
+      return ::grpc::Status(
+          ::grpc::StatusCode::UNIMPLEMENTED,
+          "Set TF_PROFILER_CONTINUOUS_SLICE_MS to enable monitoring.");
+    }
+    uint64 num_slices = 0;
+    const profiler::OpMetricsDb db =
+        continuous_profiler->GetOpMetricsDb(&num_slices);
+    response->set_data(FormatOpMetricsDb(db, num_slices));
+    return ::grpc::Status::OK;
   }
 
   ::grpc::Status Profile(::grpc::ServerContext* ctx, const ProfileRequest* req,
                          ProfileResponse* response) override {
     VLOG(1) << "Received a profile request: " << req->DebugString();
+    ContinuousProfiler* continuous_profiler = ContinuousProfiler::Global();
+    if (continuous_profiler != nullptr && req->duration_ms() == 0) {
+      // Return the latest slice of the continuous profiler.
+      profiler::XSpace xspace;
+      Status status = continuous_profiler->GetLatestSlice(&xspace);
+      if (status.ok()) {
+        status =
+            profiler::ConvertXSpaceToProfileResponse(xspace, *req, response);
+      }
+      if (!status.ok()) {
+        return ::grpc::Status(static_cast<::grpc::StatusCode>(status.code()),
+                              status.error_message());
+      }
+      return ::grpc::Status::OK;
+    }
+
+    if (continuous_profiler != nullptr) continuous_profiler->Suspend();
+    auto resume = gtl::MakeCleanup([continuous_profiler] {
+      if (continuous_profiler != nullptr) continuous_profiler->Resume();
+    });
     std::unique_ptr<ProfilerSession> profiler =
         ProfilerSession::Create(GetOptions(req->opts()));
     Status status = profiler->Status();
@@ -21,12 +21,19 @@ limitations under the License.
 #include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/events_writer.h"
 #include "tensorflow/core/util/ptr_util.h"
 
 namespace tensorflow {
 namespace {
 
+// Events are queued by the writing ops and written out by a background
+// thread, which flushes when the queue grows beyond max_queue events or when
+// flush_millis have passed since the last flush. Only if the queue grows to
+// kMaxPendingFactor times that size, because writing cannot keep up, do the
+// ops block until the background thread has drained it.
 class SummaryFileWriter : public SummaryWriterInterface {
  public:
   SummaryFileWriter(int max_queue, int flush_millis, Env* env)
@@ -44,27 +51,45 @@ class SummaryFileWriter : public SummaryWriterInterface {
       }
       TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(logdir));
     }
-    mutex_lock ml(mu_);
-    events_writer_ =
-        tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
-    TF_RETURN_WITH_CONTEXT_IF_ERROR(
-        events_writer_->InitWithSuffix(filename_suffix),
-        "Could not initialize events writer.");
-    last_flush_ = env_->NowMicros();
-    is_initialized_ = true;
+    {
+      mutex_lock ml(writer_mu_);
+      events_writer_ =
+          tensorflow::MakeUnique<EventsWriter>(io::JoinPath(logdir, "events"));
+      TF_RETURN_WITH_CONTEXT_IF_ERROR(
+          events_writer_->InitWithSuffix(filename_suffix),
+          "Could not initialize events writer.");
+    }
+    {
+      mutex_lock ml(mu_);
+      last_flush_ = env_->NowMicros();
+      is_initialized_ = true;
+    }
+    writer_thread_.reset(env_->StartThread(ThreadOptions(),
+                                           "summary_file_writer",
+                                           [this]() { WriterLoop(); }));
     return Status::OK();
   }
 
   Status Flush() override {
-    mutex_lock ml(mu_);
-    if (!is_initialized_) {
-      return errors::FailedPrecondition("Class was not properly initialized.");
+    {
+      mutex_lock ml(mu_);
+      if (!is_initialized_) {
+        return errors::FailedPrecondition(
+            "Class was not properly initialized.");
+      }
     }
     return InternalFlush();
   }
 
   ~SummaryFileWriter() override {
-    (void)Flush();  // Ignore errors.
+    {
+      mutex_lock ml(mu_);
+      shutdown_ = true;
+      queue_cond_.notify_all();
+      drained_cond_.notify_all();
+    }
+    writer_thread_.reset();  // Joins the background thread.
+    (void)Flush();           // Ignore errors.
   }
 
   Status WriteTensor(int64 global_step, Tensor t, const string& tag,
@@ -140,12 +165,18 @@ class SummaryFileWriter : public SummaryWriterInterface {
 
   Status WriteEvent(std::unique_ptr<Event> event) override {
     mutex_lock ml(mu_);
+    const size_t max_pending = kMaxPendingFactor * (max_queue_ + 1);
+    while (queue_.size() >= max_pending && !shutdown_) {
+      drained_cond_.wait(ml);
+    }
     queue_.emplace_back(std::move(event));
-    if (queue_.size() > max_queue_ ||
-        env_->NowMicros() - last_flush_ > 1000 * flush_millis_) {
-      return InternalFlush();
+    if (queue_.size() == 1 || queue_.size() > max_queue_) {
+      queue_cond_.notify_one();
     }
-    return Status::OK();
+    // Report the first error the background thread ran into, if any.
+    Status status = background_status_;
+    background_status_ = Status::OK();
+    return status;
   }
 
   string DebugString() const override { return "SummaryFileWriter"; }
@@ -155,26 +186,78 @@ class SummaryFileWriter : public SummaryWriterInterface {
     return static_cast<double>(env_->NowMicros()) / 1.0e6;
   }
 
-  Status InternalFlush() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
-    for (const std::unique_ptr<Event>& e : queue_) {
+  // Writes out and flushes all queued events. `writer_mu_` is held while the
+  // queue is taken, so that concurrent flushes write events in order.
+  Status InternalFlush() TF_LOCKS_EXCLUDED(mu_, writer_mu_) {
+    mutex_lock wl(writer_mu_);
+    std::vector<std::unique_ptr<Event>> events;
+    {
+      mutex_lock ml(mu_);
+      events.swap(queue_);
+      drained_cond_.notify_all();
+    }
+    for (const std::unique_ptr<Event>& e : events) {
       events_writer_->WriteEvent(*e);
     }
-    queue_.clear();
     TF_RETURN_WITH_CONTEXT_IF_ERROR(events_writer_->Flush(),
                                     "Could not flush events file.");
+    mutex_lock ml(mu_);
     last_flush_ = env_->NowMicros();
     return Status::OK();
   }
 
-  bool is_initialized_;
+  // Runs on `writer_thread_`, flushing the queue whenever it is due until the
+  // writer is destroyed.
+  void WriterLoop() {
+    while (true) {
+      {
+        mutex_lock ml(mu_);
+        while (!shutdown_ && !FlushDue()) {
+          if (queue_.empty()) {
+            queue_cond_.wait(ml);
+          } else {
+            const int64 wait_micros =
+                static_cast<int64>(last_flush_ + 1000 * flush_millis_) -
+                static_cast<int64>(env_->NowMicros());
+            WaitForMilliseconds(&ml, &queue_cond_, wait_micros / 1000 + 1);
+          }
+        }
+        if (shutdown_) return;
+      }
+      const Status status = InternalFlush();
+      if (!status.ok()) {
+        LOG(WARNING) << "Failed to write summaries: " << status;
+        mutex_lock ml(mu_);
+        if (background_status_.ok()) background_status_ = status;
+      }
+    }
+  }
+
+  bool FlushDue() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    if (queue_.empty()) return false;
+    return queue_.size() > max_queue_ ||
+           env_->NowMicros() - last_flush_ >= 1000 * flush_millis_;
+  }
+
+  static constexpr int kMaxPendingFactor = 4;
+
+  bool is_initialized_ TF_GUARDED_BY(mu_);
   const int max_queue_;
   const int flush_millis_;
-  uint64 last_flush_;
+  uint64 last_flush_ TF_GUARDED_BY(mu_);
   Env* env_;
   mutex mu_;
+  condition_variable queue_cond_;
+  condition_variable drained_cond_;
   std::vector<std::unique_ptr<Event>> queue_ TF_GUARDED_BY(mu_);
+  bool shutdown_ TF_GUARDED_BY(mu_) = false;
+  Status background_status_ TF_GUARDED_BY(mu_);
+  // Serializes writes to `events_writer_`, and is held for their duration.
+  // Acquired before `mu_`.
+  mutex writer_mu_ TF_ACQUIRED_BEFORE(mu_);
   // A pointer to allow deferred construction.
-  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(mu_);
+  std::unique_ptr<EventsWriter> events_writer_ TF_GUARDED_BY(writer_mu_);
+  std::unique_ptr<Thread> writer_thread_;
   std::vector<std::pair<string, SummaryMetadata>> registered_summaries_
       TF_GUARDED_BY(mu_);
 };
@@ -231,5 +231,50 @@ TEST_F(SummaryFileWriterTest, WallTime) {
       [](const Event& e) { EXPECT_EQ(e.wall_time(), 7.023); }));
 }
 
+TEST_F(SummaryFileWriterTest, WritesInBackground) {
+  const string test_name = "background_test";
+  SummaryWriterInterface* writer;
+  TF_CHECK_OK(CreateSummaryFileWriter(1, 1000000, testing::TmpDir(), test_name,
+                                      &env_, &writer));
+  core::ScopedUnref deleter(writer);
+  for (int step = 0; step < 3; ++step) {
+    std::unique_ptr<Event> e{new Event};
+    e->set_step(step);
+    TF_CHECK_OK(writer->WriteEvent(std::move(e)));
+  }
+
+  std::vector<string> files;
+  TF_CHECK_OK(env_.GetChildren(testing::TmpDir(), &files));
+  string path;
+  for (const string& f : files) {
+    if (absl::StrContains(f, test_name)) {
+      path = io::JoinPath(testing::TmpDir(), f);
+    }
+  }
+  ASSERT_FALSE(path.empty());
+
+  // The queue is over max_queue, so the events are written without a call to
+  // Flush().
+  std::vector<int64> steps;
+  for (int attempt = 0; attempt < 1000 && steps.size() < 2; ++attempt) {
+    Env::Default()->SleepForMicroseconds(10000);
+    std::unique_ptr<RandomAccessFile> read_file;
+    TF_CHECK_OK(env_.NewRandomAccessFile(path, &read_file));
+    io::RecordReader reader(read_file.get(), io::RecordReaderOptions());
+    tstring record;
+    uint64 offset = 0;
+    TF_CHECK_OK(reader.ReadRecord(&offset, &record));  // The file version.
+    steps.clear();
+    while (reader.ReadRecord(&offset, &record).ok()) {
+      Event e;
+      e.ParseFromString(record);
+      steps.push_back(e.step());
+    }
+  }
+  ASSERT_GE(steps.size(), 2);
+  EXPECT_EQ(steps[0], 0);
+  EXPECT_EQ(steps[1], 1);
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -0,0 +1,122 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_database.h"
+
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+std::string AutotuneDeviceKey(se::StreamExecutor* stream_exec) {
+  const se::DeviceDescription& desc = stream_exec->GetDeviceDescription();
+  int cc_major = 0, cc_minor = 0;
+  desc.cuda_compute_capability(&cc_major, &cc_minor);
+  std::string dnn_version = "none";
+  if (auto* dnn = stream_exec->AsDnn()) {
+    auto version_or = dnn->GetVersion();
+    if (version_or.ok()) {
+      const auto& version = version_or.ValueOrDie();
+      dnn_version = strings::StrCat(version.major_version(), ".",
+                                    version.minor_version(), ".",
+                                    version.patch());
+    }
+  }
+  return strings::StrCat(desc.name(), "; cc ", cc_major, ".", cc_minor,
+                         "; driver ", desc.driver_version(), "; dnn ",
+                         dnn_version);
+}
+
+AutotuneDatabase* AutotuneDatabase::Global() {
+  static AutotuneDatabase* database = []() -> AutotuneDatabase* {
+    string filename;
+    TF_CHECK_OK(
+        ReadStringFromEnvVar("TF_AUTOTUNE_DATABASE_FILE", "", &filename));
+    if (filename.empty()) return nullptr;
+    return new AutotuneDatabase(filename);
+  }();
+  return database;
+}
+
+AutotuneDatabase::AutotuneDatabase(const std::string& filename)
+    : filename_(filename) {
+  mutex_lock lock(mu_);
+  Status s = Load();
+  if (!s.ok()) {
+    LOG(WARNING) << "Could not load the autotune database " << filename_
+                 << ": " << s;
+  } else {
+    VLOG(1) << "Loaded " << entries_.size()
+            << " autotuning results from " << filename_;
+  }
+}
+
+bool AutotuneDatabase::Lookup(const std::string& device,
+                              const std::string& key,
+                              AutotuneDatabaseEntry* entry) const {
+  mutex_lock lock(mu_);
+  auto it = entries_.find(EntryKey(device, key));
+  if (it == entries_.end()) return false;
+  *entry = it->second;
+  return true;
+}
+
+void AutotuneDatabase::Insert(const AutotuneDatabaseEntry& entry) {
+  mutex_lock lock(mu_);
+  AutotuneDatabaseEntry& stored =
+      entries_[EntryKey(entry.device(), entry.key())];
+  if (stored.SerializeAsString() == entry.SerializeAsString()) return;
+  stored = entry;
+  Status s = Save();
+  if (!s.ok()) {
+    LOG(WARNING) << "Could not save the autotune database " << filename_
+                 << ": " << s;
+  }
+}
+
+Status AutotuneDatabase::Load() {
+  Env* env = Env::Default();
+  if (!env->FileExists(filename_).ok()) return Status::OK();
+  AutotuneDatabaseProto proto;
+  TF_RETURN_IF_ERROR(ReadBinaryProto(env, filename_, &proto));
+  for (const AutotuneDatabaseEntry& entry : proto.entries()) {
+    entries_.emplace(EntryKey(entry.device(), entry.key()), entry);
+  }
+  return Status::OK();
+}
+
+Status AutotuneDatabase::Save() {
+  // Another process may have added results since we last read the file. This
+  // is best effort: results written between Load() and RenameFile() are lost,
+  // and simply get autotuned again.
+  TF_RETURN_IF_ERROR(Load());
+  AutotuneDatabaseProto proto;
+  for (const auto& it : entries_) {
+    *proto.add_entries() = it.second;
+  }
+  Env* env = Env::Default();
+  std::string tmp_filename = filename_;
+  if (!env->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    return errors::Internal("Could not create a temporary file name for ",
+                            filename_);
+  }
+  TF_RETURN_IF_ERROR(WriteBinaryProto(env, tmp_filename, proto));
+  return env->RenameFile(tmp_filename, filename_);
+}
+
+}  // namespace tensorflow
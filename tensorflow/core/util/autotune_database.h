@@ -0,0 +1,83 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A file-backed store of GPU autotuning results, so that new processes can
+// skip autotuning the operations that an earlier process already tuned.
+
+#ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_DATABASE_H_
+#define TENSORFLOW_CORE_UTIL_AUTOTUNE_DATABASE_H_
+
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/status.h"
+#include "tensorflow/core/platform/stream_executor_no_cuda.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/autotuning.pb.h"
+
+namespace tensorflow {
+
+// Returns a string identifying the GPU model, compute capability, driver and
+// cuDNN version of `stream_exec`. Autotuning results are only reused on
+// devices with the same key.
+std::string AutotuneDeviceKey(se::StreamExecutor* stream_exec);
+
+// Autotuning results keyed by the device and the operation they were measured
+// for, and backed by an AutotuneDatabaseProto file that several processes may
+// share. Results are loaded on construction, and each new result is written
+// back immediately, merged with whatever other processes wrote in the
+// meantime. Thread-safe.
+class AutotuneDatabase {
+ public:
+  // Returns the database stored in the file named by the environment variable
+  // TF_AUTOTUNE_DATABASE_FILE, or nullptr if that variable is not set.
+  static AutotuneDatabase* Global();
+
+  // Loads the database from `filename`, which need not exist yet.
+  explicit AutotuneDatabase(const std::string& filename);
+
+  // Looks up the result for `key` on `device`. Returns false if there is none.
+  bool Lookup(const std::string& device, const std::string& key,
+              AutotuneDatabaseEntry* entry) const;
+
+  // Adds `entry`, replacing any previous result for the same device and key,
+  // and writes the database back to its file.
+  void Insert(const AutotuneDatabaseEntry& entry);
+
+ private:
+  using EntryKey = std::pair<std::string, std::string>;
+
+  // Merges the results stored in the file into `entries_`. Results already in
+  // `entries_` take precedence.
+  Status Load() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Atomically replaces the file with `entries_`, after merging in results
+  // that other processes added to it.
+  Status Save() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string filename_;
+  mutable mutex mu_;
+  absl::flat_hash_map<EntryKey, AutotuneDatabaseEntry> entries_
+      TF_GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(AutotuneDatabase);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_DATABASE_H_
@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_database.h"
+
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+AutotuneDatabaseEntry MakeEntry(const string& device, const string& key,
+                                int64 algorithm) {
+  AutotuneDatabaseEntry entry;
+  entry.set_device(device);
+  entry.set_key(key);
+  entry.mutable_result()->mutable_conv()->set_algorithm(algorithm);
+  return entry;
+}
+
+TEST(AutotuneDatabaseTest, MissingFileIsEmpty) {
+  AutotuneDatabase database(
+      io::JoinPath(testing::TmpDir(), "autotune_database_missing"));
+  AutotuneDatabaseEntry entry;
+  EXPECT_FALSE(database.Lookup("gpu", "conv", &entry));
+}
+
+TEST(AutotuneDatabaseTest, PersistsAcrossInstances) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "autotune_database_persists");
+  {
+    AutotuneDatabase database(filename);
+    database.Insert(MakeEntry("gpu", "conv", 3));
+  }
+  AutotuneDatabase database(filename);
+  AutotuneDatabaseEntry entry;
+  ASSERT_TRUE(database.Lookup("gpu", "conv", &entry));
+  EXPECT_EQ(3, entry.result().conv().algorithm());
+  // Results are only shared between identical devices.
+  EXPECT_FALSE(database.Lookup("other_gpu", "conv", &entry));
+}
+
+TEST(AutotuneDatabaseTest, MergesResultsOfOtherInstances) {
+  const string filename =
+      io::JoinPath(testing::TmpDir(), "autotune_database_merges");
+  AutotuneDatabase first(filename);
+  AutotuneDatabase second(filename);
+  first.Insert(MakeEntry("gpu", "conv", 1));
+  second.Insert(MakeEntry("gpu", "matmul", 2));
+
+  AutotuneDatabase merged(filename);
+  AutotuneDatabaseEntry entry;
+  ASSERT_TRUE(merged.Lookup("gpu", "conv", &entry));
+  EXPECT_EQ(1, entry.result().conv().algorithm());
+  ASSERT_TRUE(merged.Lookup("gpu", "matmul", &entry));
+  EXPECT_EQ(2, entry.result().conv().algorithm());
+}
+
+}  // namespace
+}  // namespace tensorflow
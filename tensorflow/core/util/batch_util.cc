@@ -15,9 +15,13 @@ limitations under the License.
 
 #include "tensorflow/core/util/batch_util.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
 
 #define TF_CALL_DATASET_TYPES(m) TF_CALL_ALL_TYPES(m) TF_CALL_QUANTIZED_TYPES(m)
 
@@ -329,6 +333,88 @@ Status CopyElementToLargerSlice(const Tensor& element, Tensor* parent,
   }
 }
 
+Status CopyElementToPaddedSlice(const Tensor& element, const Tensor& padding,
+                                Tensor* parent, int64 index) {
+  if (parent->dims() != element.dims() + 1) {
+    return errors::Internal(
+        "Mismatched ranks.  Element's rank is: ", element.dims(),
+        " but element is meant to be a slice in output Tensor having rank: ",
+        parent->dims(), " (should be: ", element.dims() + 1, ")");
+  }
+  if (!DataTypeCanUseMemcpy(element.dtype()) ||
+      padding.dtype() != element.dtype() || padding.NumElements() != 1) {
+    return errors::Unimplemented(
+        "CopyElementToPaddedSlice Unhandled data type: ", element.dtype());
+  }
+  const int rank = element.dims();
+  for (int d = 0; d < rank; ++d) {
+    if (element.dim_size(d) > parent->dim_size(d + 1)) {
+      TensorShape chip_shape = parent->shape();
+      chip_shape.RemoveDim(0);
+      return errors::Internal(
+          "CopyElementToPaddedSlice Cannot copy slice: element is larger "
+          "than a slice of parent. Shapes are: [element]: ",
+          element.shape().DebugString(),
+          ", [parent slice]: ", chip_shape.DebugString());
+    }
+  }
+  const int64 slice_values = parent->NumElements() / parent->dim_size(0);
+  if (slice_values == 0) {
+    return Status::OK();
+  }
+  const size_t value_bytes = DataTypeSize(element.dtype());
+  char* dest = const_cast<char*>(parent->tensor_data().data()) +
+               index * slice_values * value_bytes;
+  const char* src = element.tensor_data().data();
+  if (element.NumElements() == slice_values) {
+    memcpy(dest, src, slice_values * value_bytes);
+    return Status::OK();
+  }
+
+  // The padding value is written with memset if all of its bytes are equal,
+  // e.g. for zero padding.
+  const char* padding_value = padding.tensor_data().data();
+  const bool padding_is_byte =
+      std::all_of(padding_value, padding_value + value_bytes,
+                  [padding_value](char c) { return c == padding_value[0]; });
+  auto pad = [value_bytes, padding_value, padding_is_byte](char* p,
+                                                           int64 n) {
+    if (padding_is_byte) {
+      memset(p, padding_value[0], n * value_bytes);
+    } else {
+      for (int64 i = 0; i < n; ++i, p += value_bytes) {
+        memcpy(p, padding_value, value_bytes);
+      }
+    }
+  };
+
+  // Visit the rows (along the innermost dimension) of the slice in order.
+  // Rows that overlap `element` start with the next row of `element`.
+  const size_t row_bytes = element.dim_size(rank - 1) * value_bytes;
+  const int64 padded_row_values = parent->dim_size(rank);
+  const int64 row_padding = padded_row_values - element.dim_size(rank - 1);
+  gtl::InlinedVector<int64, 4> position(rank - 1, 0);
+  for (int64 row = 0; row < slice_values / padded_row_values; ++row) {
+    bool in_element = true;
+    for (int d = 0; d < rank - 1; ++d) {
+      in_element = in_element && position[d] < element.dim_size(d);
+    }
+    if (in_element) {
+      memcpy(dest, src, row_bytes);
+      src += row_bytes;
+      pad(dest + row_bytes, row_padding);
+    } else {
+      pad(dest, padded_row_values);
+    }
+    dest += padded_row_values * value_bytes;
+    for (int d = rank - 2; d >= 0; --d) {
+      if (++position[d] < parent->dim_size(d + 1)) break;
+      position[d] = 0;
+    }
+  }
+  return Status::OK();
+}
+
 Status SetElementZero(Tensor* element, const Tensor& padding) {
 #define HANDLE_TYPE(T)                                     \
   if (element->dtype() == DataTypeToEnum<T>::value) {      \
@@ -48,6 +48,16 @@ Status SetElementZero(Tensor* element, const Tensor& padding);
 Status CopyElementToLargerSlice(const Tensor& element, Tensor* parent,
                                 int index);
 
+// Copies `element` into the index^th slice of `parent` (in the 0th dimension),
+// and fills the remainder of the slice with the scalar stored in `padding`.
+// Each byte of the slice is written once, so `parent` does not need to be
+// initialized. The shape of `element` must not be larger along any axis than
+// a slice.
+//
+// REQUIRES: DataTypeCanUseMemcpy(element.dtype())
+Status CopyElementToPaddedSlice(const Tensor& element, const Tensor& padding,
+                                Tensor* parent, int64 index);
+
 }  // namespace batch_util
 }  // namespace tensorflow
 
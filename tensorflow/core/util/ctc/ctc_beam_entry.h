@@ -18,10 +18,11 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_CTC_CTC_BEAM_ENTRY_H_
 
 #include <algorithm>
-#include <memory>
+#include <new>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
+#include "tensorflow/core/lib/core/arena.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -111,26 +112,37 @@ struct BeamEntry {
 };
 
 // This class owns all instances of BeamEntry.  This is used to avoid recursive
-// destructor call during destruction.
+// destructor call during destruction.  A beam search creates many entries at
+// every step, so they are allocated from an arena rather than one at a time.
 template <class T, class CTCBeamState = EmptyBeamState>
 class BeamRoot {
  public:
-  BeamRoot(BeamEntry<T, CTCBeamState>* p, int l) {
+  BeamRoot(BeamEntry<T, CTCBeamState>* p, int l) : arena_(kArenaBlockSize) {
     root_entry_ = AddEntry(p, l);
   }
   BeamRoot(const BeamRoot&) = delete;
   BeamRoot& operator=(const BeamRoot&) = delete;
+  ~BeamRoot() {
+    for (BeamEntry<T, CTCBeamState>* entry : beam_entries_) {
+      entry->~BeamEntry();
+    }
+  }
 
   BeamEntry<T, CTCBeamState>* AddEntry(BeamEntry<T, CTCBeamState>* p, int l) {
-    auto* new_entry = new BeamEntry<T, CTCBeamState>(p, l, this);
-    beam_entries_.emplace_back(new_entry);
+    void* memory = arena_.AllocAligned(sizeof(BeamEntry<T, CTCBeamState>),
+                                       alignof(BeamEntry<T, CTCBeamState>));
+    auto* new_entry = new (memory) BeamEntry<T, CTCBeamState>(p, l, this);
+    beam_entries_.push_back(new_entry);
     return new_entry;
   }
   BeamEntry<T, CTCBeamState>* RootEntry() const { return root_entry_; }
 
  private:
+  static constexpr size_t kArenaBlockSize = 64 << 10;
+
+  core::Arena arena_;
   BeamEntry<T, CTCBeamState>* root_entry_ = nullptr;
-  std::vector<std::unique_ptr<BeamEntry<T, CTCBeamState>>> beam_entries_;
+  std::vector<BeamEntry<T, CTCBeamState>*> beam_entries_;
 };
 
 // BeamComparer is the default beam comparer provided in CTCBeamSearch.
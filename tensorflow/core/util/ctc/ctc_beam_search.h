@@ -21,6 +21,7 @@ limitations under the License.
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <numeric>
 #include <vector>
 
 #include "third_party/eigen3/Eigen/Core"
@@ -220,25 +221,21 @@ template <typename Vector>
 T CTCBeamSearchDecoder<T, CTCBeamState, CTCBeamComparer>::GetTopK(
     const int K, const Vector& input, std::vector<T>* top_k_logits,
     std::vector<int>* top_k_indices) {
-  // Find Top K choices, complexity nk in worst case. The array input is read
-  // just once.
+  // Find the top K choices with a partial selection, which is O(n + K log K)
+  // rather than O(nK). Ties go to the lower label.
   CHECK_EQ(this->num_classes_, input.size());
-  top_k_logits->clear();
-  top_k_indices->clear();
-  top_k_logits->resize(K, -INFINITY);
-  top_k_indices->resize(K, -1);
-  for (int j = 0; j < this->num_classes_ - 1; ++j) {
-    const T logit = input(j);
-    if (logit > (*top_k_logits)[K - 1]) {
-      int k = K - 1;
-      while (k > 0 && logit > (*top_k_logits)[k - 1]) {
-        (*top_k_logits)[k] = (*top_k_logits)[k - 1];
-        (*top_k_indices)[k] = (*top_k_indices)[k - 1];
-        k--;
-      }
-      (*top_k_logits)[k] = logit;
-      (*top_k_indices)[k] = j;
-    }
+  top_k_indices->resize(this->num_classes_ - 1);
+  std::iota(top_k_indices->begin(), top_k_indices->end(), 0);
+  auto greater = [&input](int a, int b) {
+    return input(a) > input(b) || (input(a) == input(b) && a < b);
+  };
+  std::nth_element(top_k_indices->begin(), top_k_indices->begin() + K - 1,
+                   top_k_indices->end(), greater);
+  std::sort(top_k_indices->begin(), top_k_indices->begin() + K, greater);
+  top_k_indices->resize(K);
+  top_k_logits->resize(K);
+  for (int k = 0; k < K; ++k) {
+    (*top_k_logits)[k] = input((*top_k_indices)[k]);
   }
   // Return max value which is in 0th index or blank character logit
   return std::max((*top_k_logits)[0], input(this->num_classes_ - 1));
@@ -264,11 +261,8 @@ void CTCBeamSearchDecoder<T, CTCBeamState, CTCBeamComparer>::Step(
     max_coeff = raw_input.maxCoeff();
   }
   // Get normalization term of softmax: log(sum(exp(logit[j]-max_coeff))).
-  T logsumexp = T(0.0);
-  for (int j = 0; j < raw_input.size(); ++j) {
-    logsumexp += Eigen::numext::exp(raw_input(j) - max_coeff);
-  }
-  logsumexp = Eigen::numext::log(logsumexp);
+  const T logsumexp =
+      Eigen::numext::log((raw_input.array() - max_coeff).exp().sum());
   // Final normalization offset to get correct log probabilities.
   T norm_offset = max_coeff + logsumexp;
 
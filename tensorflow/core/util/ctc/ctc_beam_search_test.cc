@@ -395,4 +395,20 @@ TEST(CtcBeamSearch, DoubleLabelSelection) {
   ctc_beam_search_label_selection<double>();
 }
 
+TEST(CtcBeamSearch, TopKBreaksTiesByLabel) {
+  const int num_classes = 6;
+  tensorflow::ctc::CTCBeamSearchDecoder<float>::DefaultBeamScorer
+      default_scorer;
+  tensorflow::ctc::CTCBeamSearchDecoder<float> decoder(num_classes, 2,
+                                                        &default_scorer);
+  Eigen::ArrayXf input(num_classes);
+  // The last class is the blank, which is never selected.
+  input << 0.5f, 2.0f, 1.0f, 2.0f, 1.0f, 3.0f;
+  std::vector<float> top_k_logits;
+  std::vector<int> top_k_indices;
+  EXPECT_EQ(3.0f, decoder.GetTopK(3, input, &top_k_logits, &top_k_indices));
+  EXPECT_EQ(std::vector<int>({1, 3, 2}), top_k_indices);
+  EXPECT_EQ(std::vector<float>({2.0f, 2.0f, 1.0f}), top_k_logits);
+}
+
 }  // namespace
@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <cstring>
+#include <limits>
 #include <vector>
 
 #include "absl/base/casts.h"
@@ -113,6 +115,79 @@ constexpr uint8 kVarintTag(uint32 tag) { return (tag << 3) | 0; }
 constexpr uint8 kDelimitedTag(uint32 tag) { return (tag << 3) | 2; }
 constexpr uint8 kFixed32Tag(uint32 tag) { return (tag << 3) | 5; }
 
+// The continuation bits of 8 consecutive varint bytes.
+constexpr uint64 kVarintContinuationBits = 0x8080808080808080ULL;
+
+// Returns the number of varints in the packed buffer [begin, end), i.e. the
+// number of its bytes without a continuation bit, counting 8 bytes at a time.
+int64 CountPackedVarints(const uint8* begin, const uint8* end) {
+  int64 count = 0;
+  const uint8* p = begin;
+  for (; end - p >= 8; p += 8) {
+    uint64 word;
+    std::memcpy(&word, p, sizeof(word));
+    // One bit per final byte, summed across the bytes by the multiplication.
+    const uint64 final_bytes = (~word & kVarintContinuationBits) >> 7;
+    count += (final_bytes * 0x0101010101010101ULL) >> 56;
+  }
+  for (; p < end; ++p) count += (*p & 0x80) == 0;
+  return count;
+}
+
+// Decodes the packed varints in [begin, end), storing the first `max_values`
+// of them in `out`. Runs of 8 single-byte varints, the common case for small
+// values, are decoded at once. Returns the number of varints, or -1 if they
+// are malformed.
+int64 DecodePackedVarints(const uint8* begin, const uint8* end,
+                          int64 max_values, int64* out) {
+  int64 i = 0;
+  const uint8* p = begin;
+  while (p < end) {
+    if (end - p >= 8 && max_values - i >= 8) {
+      uint64 word;
+      std::memcpy(&word, p, sizeof(word));
+      if ((word & kVarintContinuationBits) == 0) {
+        for (int k = 0; k < 8; ++k) out[i + k] = p[k];
+        i += 8;
+        p += 8;
+        continue;
+      }
+    }
+    uint64 value = 0;
+    uint8 byte;
+    int shift = 0;
+    do {
+      // Varints are at most 10 bytes long.
+      if (p == end || shift > 63) return -1;
+      byte = *p++;
+      value |= static_cast<uint64>(byte & 0x7f) << shift;
+      shift += 7;
+    } while (byte & 0x80);
+    if (i < max_values) out[i] = static_cast<int64>(value);
+    ++i;
+  }
+  return i;
+}
+
+// Returns the next `length` bytes of `stream` without consuming them, or
+// false if it holds fewer bytes. The stream must be backed by a flat array.
+bool PeekRaw(protobuf::io::CodedInputStream* stream, uint32 length,
+             const uint8** begin, const uint8** end) {
+  const void* ptr;
+  int size;
+  if (length == 0) {
+    *begin = *end = nullptr;
+    return true;
+  }
+  if (!stream->GetDirectBufferPointer(&ptr, &size) || size < 0 ||
+      static_cast<uint32>(size) < length) {
+    return false;
+  }
+  *begin = static_cast<const uint8*>(ptr);
+  *end = *begin + length;
+  return true;
+}
+
 namespace parsed {
 
 // ParseDataType has to be called first, then appropriate ParseZzzzList.
@@ -295,15 +370,24 @@ class Feature {
         if (!stream.ExpectTag(kDelimitedTag(1))) return false;  // packed tag
         uint32 packed_length;
         if (!stream.ReadVarint32(&packed_length)) return false;
-        auto packed_limit = stream.PushLimit(packed_length);
-
-        while (!stream.ExpectAtEnd()) {
-          protobuf_uint64 n;  // There is no API for int64
-          if (!stream.ReadVarint64(&n)) return false;
-          int64_list->push_back(static_cast<int64>(n));
+        const uint8* packed_begin;
+        const uint8* packed_end;
+        if (!PeekRaw(&stream, packed_length, &packed_begin, &packed_end)) {
+          return false;
         }
 
-        stream.PopLimit(packed_limit);
+        // Size the output once, then decode straight into it.
+        const int64 num_elements =
+            CountPackedVarints(packed_begin, packed_end);
+        const size_t initial_size = int64_list->size();
+        int64_list->resize(initial_size + num_elements);
+        // Less than num_elements in case of a LimitedArraySlice that is full.
+        const int64 num_to_store = int64_list->size() - initial_size;
+        if (DecodePackedVarints(packed_begin, packed_end, num_to_store,
+                                int64_list->data() + initial_size) < 0) {
+          return false;
+        }
+        if (!stream.Skip(packed_length)) return false;
       } else {  // non-packed
         while (!stream.ExpectAtEnd()) {
           if (!stream.ExpectTag(kVarintTag(1))) return false;
@@ -1948,18 +2032,16 @@ inline int ParseInt64Feature(protobuf::io::CodedInputStream* stream,
           !stream->ReadVarint32(&packed_length)) {
         return -1;
       }
-      auto packed_limit = stream->PushLimit(packed_length);
-      while (!stream->ExpectAtEnd()) {
-        protobuf_uint64 n;  // There is no API for int64
-        if (!stream->ReadVarint64(&n)) {
-          return -1;
-        }
-        if (out != nullptr) {
-          *out++ = n;
-        }
-        num_elements++;
+      const uint8* packed_begin;
+      const uint8* packed_end;
+      if (!PeekRaw(stream, packed_length, &packed_begin, &packed_end)) {
+        return -1;
       }
-      stream->PopLimit(packed_limit);
+      const int64 num_packed = DecodePackedVarints(
+          packed_begin, packed_end,
+          out != nullptr ? std::numeric_limits<int64>::max() : 0, out);
+      if (num_packed < 0 || !stream->Skip(packed_length)) return -1;
+      num_elements += num_packed;
     } else if (peek_tag == kVarintTag(1)) {
       while (!stream->ExpectAtEnd()) {
         protobuf_uint64 n;  // There is no API for int64
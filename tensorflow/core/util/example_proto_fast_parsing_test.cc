@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <limits>
 #include <utility>
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
@@ -213,6 +214,25 @@ TEST(FastParse, SingleInt64) {
   TestCorrectness(Serialize(example));
 }
 
+TEST(FastParse, PackedInt64OfAllWidths) {
+  Example example;
+  Int64List* int64_list =
+      (*example.mutable_features()->mutable_feature())["int64_list"]
+          .mutable_int64_list();
+  // Runs of single-byte varints interleaved with ones of every width.
+  for (int i = 0; i < 20; ++i) int64_list->add_value(i);
+  uint64 value = 1;
+  for (int width = 1; width <= 10; ++width) {
+    for (int i = 0; i < 9; ++i) int64_list->add_value(i);
+    int64_list->add_value(static_cast<int64>(value));
+    value = value * 128 + 1;
+  }
+  int64_list->add_value(-1);
+  int64_list->add_value(std::numeric_limits<int64>::min());
+  int64_list->add_value(std::numeric_limits<int64>::max());
+  TestCorrectness(Serialize(example));
+}
+
 static string ExampleWithSomeFeatures() {
   Example example;
 
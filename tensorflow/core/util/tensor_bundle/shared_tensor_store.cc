@@ -0,0 +1,100 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/shared_tensor_store.h"
+
+#include <algorithm>
+
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/hash/hash.h"
+
+namespace tensorflow {
+namespace {
+
+// The store is swept when it has grown by this many tensors since the last
+// sweep, besides doubling.
+const size_t kMinTensorsBetweenSweeps = 64;
+
+// Whether only the store uses the buffer of "tensor".
+bool IsUnused(const Tensor& tensor) {
+  const TensorBuffer* buf = DMAHelper::buffer(&tensor);
+  return buf == nullptr || buf->RefCountIsOne();
+}
+
+}  // namespace
+
+/* static */ SharedTensorStore* SharedTensorStore::Global() {
+  static SharedTensorStore* store = new SharedTensorStore;
+  return store;
+}
+
+Tensor SharedTensorStore::Share(uint64 fingerprint, const Tensor& tensor) {
+  const TensorBuffer* buf = DMAHelper::buffer(&tensor);
+  if (!DataTypeCanUseMemcpy(tensor.dtype()) || buf == nullptr ||
+      !buf->OwnsMemory()) {
+    return tensor;
+  }
+  const uint64 key = Hash64Combine(
+      fingerprint, Hash64Combine(tensor.dtype(), tensor.TotalBytes()));
+  const StringPiece data = tensor.tensor_data();
+  mutex_lock l(mu_);
+  auto range = tensors_.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    const Tensor& shared = it->second;
+    if (shared.dtype() == tensor.dtype() &&
+        shared.shape() == tensor.shape() && shared.tensor_data() == data) {
+      return shared;
+    }
+  }
+  tensors_.emplace(key, tensor);
+  bytes_ += tensor.TotalBytes();
+  if (tensors_.size() >=
+      std::max(2 * swept_size_, swept_size_ + kMinTensorsBetweenSweeps)) {
+    SweepLocked();
+  }
+  return tensor;
+}
+
+void SharedTensorStore::Sweep() {
+  mutex_lock l(mu_);
+  SweepLocked();
+}
+
+void SharedTensorStore::SweepLocked() {
+  // References to the tensors are only taken under mu_, so a tensor that is
+  // unused here stays unused.
+  for (auto it = tensors_.begin(); it != tensors_.end();) {
+    if (IsUnused(it->second)) {
+      bytes_ -= it->second.TotalBytes();
+      it = tensors_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  swept_size_ = tensors_.size();
+}
+
+size_t SharedTensorStore::size() const {
+  mutex_lock l(mu_);
+  return tensors_.size();
+}
+
+uint64 SharedTensorStore::bytes() const {
+  mutex_lock l(mu_);
+  return bytes_;
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// A process-wide store of restored tensors, through which the sessions that
+// restore the same checkpoint, or checkpoints with some equal tensors, share
+// one buffer for each of these tensors.
+//
+// The store keeps a reference to each of its tensors, so their buffers are
+// never updated in place: resource variables copy them on their first update
+// (see Tensor::RefCountIsOne()). Tensors that are only used by the store are
+// dropped by Sweep(), and every so often when tensors are added.
+
+#ifndef TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_SHARED_TENSOR_STORE_H_
+#define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_SHARED_TENSOR_STORE_H_
+
+#include <unordered_map>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class SharedTensorStore {
+ public:
+  SharedTensorStore() {}
+
+  // The store shared by all sessions of the process.
+  static SharedTensorStore* Global();
+
+  // Returns a tensor of the store equal to "tensor", or adds "tensor" to the
+  // store and returns it.  "fingerprint" is a hash of the contents of
+  // "tensor", e.g. the checksum of its bundle entry; tensors with the same
+  // fingerprint are compared byte by byte.  Tensors of dtypes that cannot be
+  // memcpy'd, and tensors that do not own their memory, are returned as is.
+  Tensor Share(uint64 fingerprint, const Tensor& tensor) TF_LOCKS_EXCLUDED(mu_);
+
+  // Drops the tensors that are not used outside of the store.
+  void Sweep() TF_LOCKS_EXCLUDED(mu_);
+
+  // The number of tensors in the store, and their total bytes.
+  size_t size() const TF_LOCKS_EXCLUDED(mu_);
+  uint64 bytes() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  void SweepLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  mutable mutex mu_;
+  std::unordered_multimap<uint64, Tensor> tensors_ TF_GUARDED_BY(mu_);
+  uint64 bytes_ TF_GUARDED_BY(mu_) = 0;
+  // The number of tensors after the last sweep.
+  size_t swept_size_ TF_GUARDED_BY(mu_) = 0;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SharedTensorStore);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_SHARED_TENSOR_STORE_H_
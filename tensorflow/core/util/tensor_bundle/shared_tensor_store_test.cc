@@ -0,0 +1,76 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/tensor_bundle/shared_tensor_store.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(SharedTensorStoreTest, SharesEqualTensors) {
+  SharedTensorStore store;
+  const Tensor a = test::AsTensor<float>({1, 2, 3});
+  const Tensor b = test::AsTensor<float>({1, 2, 3});
+  EXPECT_TRUE(store.Share(7, a).SharesBufferWith(a));
+  EXPECT_TRUE(store.Share(7, b).SharesBufferWith(a));
+  EXPECT_EQ(1, store.size());
+  EXPECT_EQ(3 * sizeof(float), store.bytes());
+}
+
+TEST(SharedTensorStoreTest, ComparesTensorsWithTheSameFingerprint) {
+  SharedTensorStore store;
+  const Tensor a = test::AsTensor<float>({1, 2, 3});
+  const Tensor b = test::AsTensor<float>({1, 2, 4});
+  const Tensor c = test::AsTensor<float>({1, 2, 3}, TensorShape({3, 1}));
+  const Tensor d = test::AsTensor<int32>({1, 2, 3});
+  store.Share(7, a);
+  EXPECT_TRUE(store.Share(7, b).SharesBufferWith(b));
+  EXPECT_TRUE(store.Share(7, c).SharesBufferWith(c));
+  EXPECT_TRUE(store.Share(7, d).SharesBufferWith(d));
+  // An equal tensor with another fingerprint is not looked for.
+  const Tensor e = test::AsTensor<float>({1, 2, 3});
+  EXPECT_TRUE(store.Share(8, e).SharesBufferWith(e));
+  EXPECT_EQ(5, store.size());
+}
+
+TEST(SharedTensorStoreTest, SkipsStrings) {
+  SharedTensorStore store;
+  const Tensor a = test::AsTensor<tstring>({"a"});
+  const Tensor b = test::AsTensor<tstring>({"a"});
+  store.Share(7, a);
+  EXPECT_TRUE(store.Share(7, b).SharesBufferWith(b));
+  EXPECT_EQ(0, store.size());
+}
+
+TEST(SharedTensorStoreTest, SweepDropsUnusedTensors) {
+  SharedTensorStore store;
+  Tensor a = test::AsTensor<float>({1, 2, 3});
+  const Tensor b = test::AsTensor<float>({4, 5, 6});
+  store.Share(7, a);
+  store.Share(8, b);
+  store.Sweep();
+  EXPECT_EQ(2, store.size());
+  a = Tensor();
+  store.Sweep();
+  EXPECT_EQ(1, store.size());
+  EXPECT_EQ(3 * sizeof(float), store.bytes());
+  const Tensor c = test::AsTensor<float>({1, 2, 3});
+  EXPECT_TRUE(store.Share(7, c).SharesBufferWith(c));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -18,9 +18,12 @@ limitations under the License.
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <memory>
+#include <set>
 #include <utility>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -41,6 +44,8 @@ limitations under the License.
 #include "tensorflow/core/lib/random/random.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/saved_tensor_slice_util.h"
 #include "tensorflow/core/util/tensor_bundle/byte_swap.h"
@@ -398,21 +403,113 @@ Status PadAlignment(FileOutputBuffer* out, int alignment, int64* size) {
   return status;
 }
 
+// Appends the data bytes of "val" to "out", and records their offset, size and
+// checksum in "entry".  "size" is the current size of the file and is updated
+// to the new size, including the padding for "alignment".
+Status AppendTensor(const Tensor& val, int alignment, FileOutputBuffer* out,
+                    int64* size, BundleEntryProto* entry) {
+  entry->set_offset(*size);
+  size_t data_bytes_written = 0;
+  uint32 crc32c = 0;
+  out->clear_crc32c();
+  Status status;
+  if (val.dtype() == DT_STRING) {
+    status = WriteStringTensor(val, out, &data_bytes_written, &crc32c);
+  } else if (val.dtype() == DT_VARIANT) {
+    status = WriteVariantTensor(val, out, &data_bytes_written, &crc32c);
+  } else {
+    status = WriteTensor(val, out, &data_bytes_written);
+    crc32c = out->crc32c();
+  }
+  if (!status.ok()) return status;
+  entry->set_size(data_bytes_written);
+  entry->set_crc32c(crc32c::Mask(crc32c));
+  *size += data_bytes_written;
+  return PadAlignment(out, alignment, size);
+}
+
+// A tensor buffer that views the data of a memory-mapped data file, and keeps
+// the mapping alive for as long as the tensors that use it.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("mmap");
+  }
+  // The mapping is read-only, so the buffer must not be forwarded to kernels
+  // that write their outputs in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  ~MappedTensorBuffer() override = default;
+
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(MappedTensorBuffer);
+};
+
 }  // namespace
 
+// One data file of a bundle being written.
+struct BundleWriter::DataFile {
+  int shard_id;
+  string path;  // The file being written, which may be a temporary file.
+  std::unique_ptr<FileOutputBuffer> out;
+  int64 size = 0;  // Number of bytes written into "out".
+  Status status;
+  // Number of bytes of the tensors added to this file, which may not have been
+  // written yet.  Only accessed by the thread calling Add().
+  int64 added_bytes = 0;
+
+  // Writes pending for the background thread, if there is more than one data
+  // file.  "size" and "status" are owned by the thread while it runs.
+  mutex mu;
+  condition_variable cond_var;
+  std::deque<std::pair<Tensor, BundleEntryProto*>> pending TF_GUARDED_BY(mu);
+  bool stopped TF_GUARDED_BY(mu) = false;
+  std::unique_ptr<Thread> thread;
+
+  void WriteLoop(int alignment) {
+    while (true) {
+      std::pair<Tensor, BundleEntryProto*> write;
+      {
+        mutex_lock l(mu);
+        while (pending.empty() && !stopped) {
+          cond_var.wait(l);
+        }
+        if (pending.empty()) return;
+        write = std::move(pending.front());
+        pending.pop_front();
+      }
+      if (status.ok()) {
+        status = AppendTensor(write.first, alignment, out.get(), &size,
+                              write.second);
+      }
+    }
+  }
+};
+
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
-    : env_(env),
-      options_(options),
-      prefix_(prefix),
-      out_(nullptr),
-      size_(0) {
+    : env_(env), options_(options), prefix_(prefix) {
   status_ = env_->HasAtomicMove(prefix_, &use_temp_file_);
   if (!status_.ok()) return;
+  if (options_.num_data_files < 1) {
+    status_ = errors::InvalidArgument("Invalid number of data files: ",
+                                      options_.num_data_files);
+    return;
+  }
 
-  data_path_ = DataFilename(prefix_, 0, 1);
   metadata_path_ = MetaFilename(prefix_);
   if (use_temp_file_) {
-    data_path_ = strings::StrCat(data_path_, ".tempstate", random::New64());
     metadata_path_ =
         strings::StrCat(metadata_path_, ".tempstate", random::New64());
   }
@@ -422,13 +519,46 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     return;
   }
 
-  std::unique_ptr<WritableFile> wrapper;
-  status_ = env_->NewWritableFile(data_path_, &wrapper);
-  if (!status_.ok()) return;
-  out_ = std::unique_ptr<FileOutputBuffer>(
-      new FileOutputBuffer(wrapper.release(), 8 << 20 /* 8MB write buffer */));
+  const int num_data_files = options_.num_data_files;
+  for (int i = 0; i < num_data_files; ++i) {
+    std::unique_ptr<DataFile> data_file(new DataFile);
+    data_file->shard_id = i;
+    data_file->path = DataFilename(prefix_, i, num_data_files);
+    if (use_temp_file_) {
+      data_file->path =
+          strings::StrCat(data_file->path, ".tempstate", random::New64());
+    }
+    std::unique_ptr<WritableFile> wrapper;
+    status_ = env_->NewWritableFile(data_file->path, &wrapper);
+    if (!status_.ok()) return;
+    data_file->out = std::unique_ptr<FileOutputBuffer>(new FileOutputBuffer(
+        wrapper.release(), 8 << 20 /* 8MB write buffer */));
+    VLOG(1) << "Writing to file " << data_file->path;
+    data_files_.push_back(std::move(data_file));
+  }
+  if (num_data_files > 1) {
+    for (auto& data_file : data_files_) {
+      DataFile* file = data_file.get();
+      const int alignment = options_.data_alignment;
+      file->thread.reset(env_->StartThread(
+          ThreadOptions(), "tf_bundle_writer",
+          [file, alignment]() { file->WriteLoop(alignment); }));
+    }
+  }
+}
 
-  VLOG(1) << "Writing to file " << data_path_;
+BundleWriter::~BundleWriter() { StopWriters(); }
+
+void BundleWriter::StopWriters() {
+  for (auto& data_file : data_files_) {
+    {
+      mutex_lock l(data_file->mu);
+      data_file->stopped = true;
+      data_file->cond_var.notify_all();
+    }
+    // Joins the thread.
+    data_file->thread.reset();
+  }
 }
 
 Status BundleWriter::Add(StringPiece key, const Tensor& val) {
@@ -443,28 +573,26 @@ Status BundleWriter::Add(StringPiece key, const Tensor& val) {
   BundleEntryProto* entry = &entries_[key_string];
   entry->set_dtype(val.dtype());
   val.shape().AsProto(entry->mutable_shape());
-  entry->set_shard_id(0);
-  entry->set_offset(size_);
 
   // Updates the data file.
-  size_t data_bytes_written = 0;
-  uint32 crc32c = 0;
-  out_->clear_crc32c();
-  if (val.dtype() == DT_STRING) {
-    status_ = WriteStringTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else if (val.dtype() == DT_VARIANT) {
-    status_ = WriteVariantTensor(val, out_.get(), &data_bytes_written, &crc32c);
-  } else {
-    status_ = WriteTensor(val, out_.get(), &data_bytes_written);
-    crc32c = out_->crc32c();
+  if (data_files_.size() == 1) {
+    DataFile* file = data_files_[0].get();
+    entry->set_shard_id(0);
+    status_ = AppendTensor(val, options_.data_alignment, file->out.get(),
+                           &file->size, entry);
+    return status_;
   }
-
-  if (status_.ok()) {
-    entry->set_size(data_bytes_written);
-    entry->set_crc32c(crc32c::Mask(crc32c));
-    size_ += data_bytes_written;
-    status_ = PadAlignment(out_.get(), options_.data_alignment, &size_);
+  // Inserting into "entries_" leaves "entry" in place, so the background
+  // thread may fill it out while other tensors are added.
+  DataFile* file = data_files_[0].get();
+  for (auto& data_file : data_files_) {
+    if (data_file->added_bytes < file->added_bytes) file = data_file.get();
   }
+  entry->set_shard_id(file->shard_id);
+  file->added_bytes += val.TotalBytes();
+  mutex_lock l(file->mu);
+  file->pending.emplace_back(val, entry);
+  file->cond_var.notify_all();
   return status_;
 }
 
@@ -512,18 +640,25 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
-  if (out_) {
-    status_.Update(out_->Close());
-    out_ = nullptr;
-    if (status_.ok()) {
-      if (use_temp_file_) {
-        status_ =
-            Env::Default()->RenameFile(data_path_, DataFilename(prefix_, 0, 1));
-      }
-    } else {
-      Env::Default()->DeleteFile(data_path_).IgnoreError();
+  StopWriters();
+  for (auto& data_file : data_files_) {
+    status_.Update(data_file->status);
+  }
+  for (auto& data_file : data_files_) {
+    if (!data_file->out) continue;
+    status_.Update(data_file->out->Close());
+    data_file->out = nullptr;
+  }
+  for (auto& data_file : data_files_) {
+    if (!status_.ok()) {
+      Env::Default()->DeleteFile(data_file->path).IgnoreError();
+    } else if (use_temp_file_) {
+      status_ = Env::Default()->RenameFile(
+          data_file->path,
+          DataFilename(prefix_, data_file->shard_id, data_files_.size()));
     }
   }
+  data_files_.clear();
   if (!status_.ok()) return status_;
   // Build key -> BundleEntryProto table.
   std::unique_ptr<WritableFile> file;
@@ -537,7 +672,7 @@ Status BundleWriter::Finish() {
     table::TableBuilder builder(options, file.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(1);
+    header.set_num_shards(options_.num_data_files);
     header.set_endianness(BundleHeaderProto::LITTLE);
     if (!port::kLittleEndian) header.set_endianness(BundleHeaderProto::BIG);
     VersionDef* version = header.mutable_version();
@@ -713,7 +848,9 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
     table::TableBuilder builder(TableBuilderOptions(), merged_metadata.get());
     // Header entry.
     BundleHeaderProto header;
-    header.set_num_shards(merge.num_shards);
+    // Data files without any entries, e.g. of a writer with more data files
+    // than tensors, are not renamed, so they are not counted either.
+    header.set_num_shards(merge.shard_ids.size());
     header.set_endianness(merge.endianness);
     *header.mutable_version() = merge.version;
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
@@ -734,10 +871,185 @@ Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
   return status;
 }
 
+namespace {
+
+// Returns the stored slices of the tensor described by "entry": a single full
+// slice for a tensor that is not partitioned.
+std::vector<TensorSlice> StoredSlices(const BundleEntryProto& entry) {
+  std::vector<TensorSlice> slices;
+  if (entry.slices().empty()) {
+    slices.emplace_back(entry.shape().dim_size());
+  }
+  for (const TensorSliceProto& slice : entry.slices()) {
+    slices.emplace_back(slice);
+  }
+  return slices;
+}
+
+// Whether the stored slices of "entry" cover all of the tensor.  The stored
+// slices of a tensor never overlap.
+Status StoresAllElements(const BundleEntryProto& entry, bool* all) {
+  const TensorShape shape(entry.shape());
+  int64 num_elements = 0;
+  for (const TensorSlice& slice : StoredSlices(entry)) {
+    TensorShape slice_shape;
+    TF_RETURN_IF_ERROR(slice.SliceTensorShape(shape, &slice_shape));
+    num_elements += slice_shape.num_elements();
+  }
+  *all = num_elements == shape.num_elements();
+  return Status::OK();
+}
+
+// Copies the elements of "src", holding slice "src_slice" of a tensor of
+// shape "full_shape", that "dst_slice" also contains into "dst".
+Status CopyIntersection(const TensorShape& full_shape,
+                        const TensorSlice& src_slice, const Tensor& src,
+                        const TensorSlice& dst_slice, Tensor* dst) {
+  switch (src.dtype()) {
+#define HANDLE_COPY(T)                                                  \
+  case DataTypeToEnum<T>::value:                                        \
+    if (!CopyDataFromTensorSliceToTensorSlice(                          \
+            full_shape, src_slice, dst_slice, src.flat<T>().data(),     \
+            dst->flat<T>().data())) {                                   \
+      return errors::Internal("Failed to copy slice ",                  \
+                              src_slice.DebugString(), " to ",          \
+                              dst_slice.DebugString());                 \
+    }                                                                   \
+    break;
+
+    HANDLE_COPY(float)
+    HANDLE_COPY(double)
+    HANDLE_COPY(int32)
+    HANDLE_COPY(uint8)
+    HANDLE_COPY(int16)
+    HANDLE_COPY(int8)
+    HANDLE_COPY(complex64)
+    HANDLE_COPY(complex128)
+    HANDLE_COPY(int64)
+    HANDLE_COPY(bool)
+    HANDLE_COPY(qint32)
+    HANDLE_COPY(quint8)
+    HANDLE_COPY(qint8)
+    HANDLE_COPY(bfloat16)
+    default:
+      return errors::Unimplemented("Cannot compact slices of dtype ",
+                                   DataTypeString(src.dtype()));
+#undef HANDLE_COPY
+  }
+  return Status::OK();
+}
+
+// Reads "slice" of the tensor keyed by "key", which "reader" stores in full
+// if "slice" is full.
+Status ReadSlice(BundleReader* reader, const string& key,
+                 const BundleEntryProto& entry, const TensorSlice& slice,
+                 Tensor* val) {
+  if (entry.slices().empty()) return reader->Lookup(key, val);
+  return reader->LookupSlice(key, slice, val);
+}
+
+}  // namespace
+
+Status CompactBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
+                      StringPiece compacted_prefix) {
+  if (prefixes.empty()) {
+    return errors::InvalidArgument("No bundles to compact");
+  }
+  std::vector<std::unique_ptr<BundleReader>> readers;
+  std::set<string> keys;
+  for (const tstring& prefix : prefixes) {
+    readers.emplace_back(new BundleReader(env, prefix));
+    BundleReader* reader = readers.back().get();
+    TF_RETURN_IF_ERROR(reader->status());
+    reader->Seek(kHeaderEntryKey);
+    for (reader->Next(); reader->Valid(); reader->Next()) {
+      // Skips the entries of the individual slices of partitioned tensors.
+      string name;
+      TensorSlice unused_slice;
+      const string key(reader->key());
+      if (checkpoint::DecodeTensorNameSlice(key, &name, &unused_slice).ok()) {
+        continue;
+      }
+      keys.insert(key);
+    }
+  }
+
+  BundleWriter writer(env, compacted_prefix);
+  TF_RETURN_IF_ERROR(writer.status());
+  const int num_bundles = readers.size();
+  for (const string& key : keys) {
+    std::vector<BundleEntryProto> entries(num_bundles);
+    std::vector<bool> found(num_bundles, false);
+    int base = -1;
+    for (int i = num_bundles - 1; i >= 0; --i) {
+      Status s = readers[i]->LookupEntry(key, &entries[i]);
+      if (errors::IsNotFound(s)) continue;
+      TF_RETURN_IF_ERROR(s);
+      found[i] = true;
+      bool all = false;
+      TF_RETURN_IF_ERROR(StoresAllElements(entries[i], &all));
+      if (all) {
+        base = i;
+        break;
+      }
+    }
+    if (base < 0) {
+      return errors::DataLoss("None of the bundles stores all of tensor ", key);
+    }
+
+    const BundleEntryProto& base_entry = entries[base];
+    const TensorShape full_shape(base_entry.shape());
+    for (int i = base + 1; i < num_bundles; ++i) {
+      if (!found[i]) continue;
+      if (entries[i].dtype() != base_entry.dtype() ||
+          !full_shape.IsSameSize(TensorShape(entries[i].shape()))) {
+        return errors::DataLoss("Bundle ", prefixes[i], " stores tensor ", key,
+                                " of dtype ",
+                                DataTypeString(entries[i].dtype()),
+                                " and shape ",
+                                TensorShape(entries[i].shape()).DebugString(),
+                                ", but ", prefixes[base], " stores it as ",
+                                DataTypeString(base_entry.dtype()), " ",
+                                full_shape.DebugString());
+      }
+    }
+
+    for (const TensorSlice& slice : StoredSlices(base_entry)) {
+      TensorShape slice_shape;
+      TF_RETURN_IF_ERROR(slice.SliceTensorShape(full_shape, &slice_shape));
+      Tensor val(base_entry.dtype(), slice_shape);
+      TF_RETURN_IF_ERROR(
+          ReadSlice(readers[base].get(), key, base_entry, slice, &val));
+      for (int i = base + 1; i < num_bundles; ++i) {
+        if (!found[i]) continue;
+        for (const TensorSlice& update_slice : StoredSlices(entries[i])) {
+          if (!update_slice.Overlaps(slice)) continue;
+          TensorShape update_shape;
+          TF_RETURN_IF_ERROR(
+              update_slice.SliceTensorShape(full_shape, &update_shape));
+          Tensor update(base_entry.dtype(), update_shape);
+          TF_RETURN_IF_ERROR(ReadSlice(readers[i].get(), key, entries[i],
+                                       update_slice, &update));
+          TF_RETURN_IF_ERROR(
+              CopyIntersection(full_shape, update_slice, update, slice, &val));
+        }
+      }
+      if (base_entry.slices().empty()) {
+        TF_RETURN_IF_ERROR(writer.Add(key, val));
+      } else {
+        TF_RETURN_IF_ERROR(writer.AddSlice(key, full_shape, slice, val));
+      }
+    }
+  }
+  return writer.Finish();
+}
+
 // Interface for reading a tensor bundle.
 
-BundleReader::BundleReader(Env* env, StringPiece prefix)
+BundleReader::BundleReader(Env* env, StringPiece prefix,
+                           const Options& options)
     : env_(env),
+      options_(options),
       prefix_(prefix),
       metadata_(nullptr),
       table_(nullptr),
@@ -835,10 +1147,58 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return Status::OK();
 }
 
+Status BundleReader::LookupEntry(StringPiece key, BundleEntryProto* entry) {
+  return GetBundleEntryProto(key, entry);
+}
+
+std::shared_ptr<ReadOnlyMemoryRegion> BundleReader::GetRegion(int32 shard_id) {
+  auto it = regions_.find(shard_id);
+  if (it != regions_.end()) return it->second;
+  const string filename = DataFilename(prefix_, shard_id, num_shards_);
+  std::unique_ptr<ReadOnlyMemoryRegion> region;
+  Status s = env_->NewReadOnlyMemoryRegionFromFile(filename, &region);
+  if (!s.ok()) {
+    VLOG(1) << "Reading " << filename << " without memory mapping: " << s;
+  }
+  return regions_[shard_id] = std::move(region);
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
+    if (options_.use_mmap && DataTypeCanUseMemcpy(entry.dtype()) &&
+        !need_to_swap_bytes_ && entry.size() > 0) {
+      std::shared_ptr<ReadOnlyMemoryRegion> region =
+          GetRegion(entry.shard_id());
+      if (region != nullptr &&
+          entry.offset() + entry.size() <= region->length()) {
+        const char* data =
+            static_cast<const char*>(region->data()) + entry.offset();
+        if (reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES == 0) {
+          const int64 expected_size =
+              stored_shape.num_elements() * DataTypeSize(entry.dtype());
+          if (entry.size() != expected_size) {
+            return errors::DataLoss("Invalid size in bundle entry: key ",
+                                    key(), "; stored size ", entry.size(),
+                                    "; expected size ", expected_size);
+          }
+          if (options_.verify_mapped_tensors) {
+            const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+            if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+              return errors::DataLoss(
+                  "Checksum does not match: stored ",
+                  strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+                  " vs. calculated on the restored bytes ", actual_crc32c);
+            }
+          }
+          auto* buf = new MappedTensorBuffer(region, data, entry.size());
+          *val = Tensor(entry.dtype(), stored_shape, buf);
+          buf->Unref();
+          return Status::OK();
+        }
+      }
+    }
     ret = new Tensor(entry.dtype(), stored_shape);
   }
 
@@ -934,7 +1294,13 @@ Status BundleReader::Lookup(StringPiece key, Tensor* val) {
   CHECK(val != nullptr);
   BundleEntryProto entry;
   TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  return LookupWithEntry(key, entry, val);
+}
 
+Status BundleReader::LookupWithEntry(StringPiece key,
+                                     const BundleEntryProto& entry,
+                                     Tensor* val) {
+  CHECK(val != nullptr);
   if (entry.slices().empty()) {
     return GetValue(entry, val);
   } else {
@@ -982,6 +1348,13 @@ Status BundleReader::LookupSlice(StringPiece full_tensor_key,
   return GetSliceValue(full_tensor_key, entry, slice_spec, val);
 }
 
+Status BundleReader::LookupSliceWithEntry(
+    StringPiece full_tensor_key, const BundleEntryProto& full_tensor_entry,
+    const TensorSlice& slice_spec, Tensor* val) {
+  CHECK(val != nullptr);
+  return GetSliceValue(full_tensor_key, full_tensor_entry, slice_spec, val);
+}
+
 Status BundleReader::GetSliceValue(StringPiece full_tensor_key,
                                    const BundleEntryProto& full_tensor_entry,
                                    const TensorSlice& slice_spec, Tensor* val) {
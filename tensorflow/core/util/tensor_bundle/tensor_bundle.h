@@ -62,6 +62,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_UTIL_TENSOR_BUNDLE_TENSOR_BUNDLE_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -112,12 +113,22 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // Number of data files.  Must be >= 1.  With more than one data file, each
+    // file is written, and checksummed, by its own thread, and every tensor
+    // goes to the file with the fewest bytes so far.  The bundle still has a
+    // single metadata file.
+    int num_data_files{1};
   };
   BundleWriter(Env* env, StringPiece prefix,
                const Options& options = Options());
+  ~BundleWriter();
 
   // Adds the tensor "val" under key "key".
   // Across calls "key" must be unique but can be added in any order.
+  //
+  // With more than one data file, "val" is written in the background, and
+  // its buffer must not be modified until Finish() returns.  Errors writing
+  // it are reported by Finish().
   Status Add(StringPiece key, const Tensor& val);
 
   // Partitioned variables support.
@@ -146,14 +157,17 @@ class BundleWriter {
   Status status() const { return status_; }
 
  private:
+  struct DataFile;
+
+  // Stops the threads writing the data files in the background.
+  void StopWriters();
+
   Env* const env_;  // Not owned.
   const Options options_;
   const string prefix_;
   string metadata_path_;
-  string data_path_;
   bool use_temp_file_;
-  std::unique_ptr<FileOutputBuffer> out_;
-  int64 size_;  // Number of bytes written into out_.
+  std::vector<std::unique_ptr<DataFile>> data_files_;
   std::map<string, BundleEntryProto> entries_;
   Status status_;
 
@@ -176,13 +190,43 @@ class BundleWriter {
 Status MergeBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
                     StringPiece merged_prefix);
 
+// Compacts a chain of bundles, e.g. a checkpoint followed by the delta
+// checkpoints that store the rows of its variables that changed since, into a
+// single bundle with the given "compacted_prefix".
+//
+// Every bundle in "prefixes" overrides the tensor elements that it stores in
+// the preceding bundles, where it stores a tensor either in full or as slices
+// of the full tensor.  The compacted bundle stores each tensor like the newest
+// bundle that stores all of its elements, in full or with the same slices,
+// updated with the slices stored by the bundles that follow.  Slices can only
+// be combined for the numeric dtypes that LookupSlice() can copy.
+//
+// The input bundles are left in place.
+Status CompactBundles(Env* env, gtl::ArraySlice<tstring> prefixes,
+                      StringPiece compacted_prefix);
+
 // On construction, silently attempts to read the metadata associated with
 // "prefix".  If caller intends to call any function afterwards, "status()"
 // must be checked.
 // All threads accessing the same BundleReader must synchronize.
 class BundleReader {
  public:
-  BundleReader(Env* const env, StringPiece prefix);
+  struct Options {
+    Options() {}
+    // Whether to memory-map the data files.  Tensors of a dtype that can be
+    // memcpy'd, whose data is aligned to EIGEN_MAX_ALIGN_BYTES in the file
+    // (see BundleWriter::Options::data_alignment), are then backed directly by
+    // the mapping when Lookup() allocates them, without copying.  Falls back to
+    // regular reads for file systems that do not support memory mapping.
+    bool use_mmap{false};
+    // Whether to verify the checksums of memory-mapped tensors in Lookup().
+    // Verifying reads every page of a tensor; without it the pages are only
+    // read when the tensor is, so that a large embedding of which few rows are
+    // used is restored at once and takes memory only for those rows.
+    bool verify_mapped_tensors{true};
+  };
+  BundleReader(Env* const env, StringPiece prefix,
+               const Options& options = Options());
   ~BundleReader();
 
   // Is ok() iff the reader construction is successful (completed the read of
@@ -199,6 +243,12 @@ class BundleReader {
   Status LookupDtypeAndShape(StringPiece key, DataType* dtype,
                              TensorShape* shape) TF_MUST_USE_RESULT;
 
+  // Looks up the metadata proto of the tensor keyed by "key", e.g. to order
+  // lookups by their location in the data files.  Clears "entry" if not found.
+  // REQUIRES: status().ok()
+  Status LookupEntry(StringPiece key,
+                     BundleEntryProto* entry) TF_MUST_USE_RESULT;
+
   // Looks up the shape of the tensor keyed by "key".
   // Clears "shape" if not found.
   // REQUIRES: status().ok()
@@ -211,6 +261,9 @@ class BundleReader {
   // Caller must make sure "val" has the same shape and dtype as the
   // corresponding contents, so that its buffer can be filled without needing
   // extra allocation.  These can be queried via "LookupDtypeAndShape()".
+  // For a tensor that is not partitioned, an empty "val" is instead replaced
+  // by a newly allocated tensor, which may be backed by a memory mapping (see
+  // Options::use_mmap).
   //
   // On error, "val" may contain nonsense data.  Returns a NotFound error if
   // tensor keyed by "key" does not exist in this bundle.
@@ -219,6 +272,19 @@ class BundleReader {
   // REQUIRES: status().ok()
   Status Lookup(StringPiece key, Tensor* val) TF_MUST_USE_RESULT;
 
+  // Like Lookup() and LookupSlice(), but reads the tensor keyed by "key" from
+  // its metadata proto "entry", as returned by LookupEntry(), without seeking
+  // for "key" again.  Callers that look up the entries of many tensors in key
+  // order can then read the tensors in any order, e.g. that of the data files,
+  // without a random seek in the metadata table for each of them.
+  // REQUIRES: status().ok()
+  Status LookupWithEntry(StringPiece key, const BundleEntryProto& entry,
+                         Tensor* val) TF_MUST_USE_RESULT;
+  Status LookupSliceWithEntry(StringPiece full_tensor_key,
+                              const BundleEntryProto& full_tensor_entry,
+                              const TensorSlice& slice_spec,
+                              Tensor* val) TF_MUST_USE_RESULT;
+
   // Looks up the tensor pointed to by the internal iterator.
   //
   // On error, "val" may contain nonsense data.
@@ -283,7 +349,12 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns the mapping of data file "shard_id", or nullptr if it cannot be
+  // memory-mapped.
+  std::shared_ptr<ReadOnlyMemoryRegion> GetRegion(int32 shard_id);
+
   Env* env_;  // Not owned.
+  const Options options_;
   const string prefix_;
 
   Status status_;
@@ -293,6 +364,9 @@ class BundleReader {
   table::Iterator* iter_;
   // Owned the InputBuffer objects and their underlying RandomAccessFile's.
   std::unordered_map<int32, io::InputBuffer*> data_;
+  // The mappings of the data files, with Options::use_mmap.  Holds nullptr for
+  // data files that cannot be mapped.
+  std::unordered_map<int32, std::shared_ptr<ReadOnlyMemoryRegion>> regions_;
 
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
@@ -18,6 +18,7 @@ limitations under the License.
 #include <random>
 #include <vector>
 
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -635,6 +636,41 @@ TEST(TensorBundleTest, PartitionedVariables) {
   }
 }
 
+TEST(TensorBundleTest, LookupWithEntry) {
+  const TensorShape kFullShape({2, 3});
+  {
+    BundleWriter writer(Env::Default(), Prefix("with_entry"));
+    TF_ASSERT_OK(writer.Add("bar", Constant<int32>(7, TensorShape({2}))));
+    TF_ASSERT_OK(writer.AddSlice("foo", kFullShape,
+                                 TensorSlice::ParseOrDie("0,1:-"),
+                                 Constant<float>(0., TensorShape({1, 3}))));
+    TF_ASSERT_OK(writer.AddSlice("foo", kFullShape,
+                                 TensorSlice::ParseOrDie("1,1:-"),
+                                 Constant<float>(1., TensorShape({1, 3}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  BundleReader reader(Env::Default(), Prefix("with_entry"));
+  TF_ASSERT_OK(reader.status());
+  BundleEntryProto bar_entry;
+  BundleEntryProto foo_entry;
+  TF_ASSERT_OK(reader.LookupEntry("bar", &bar_entry));
+  TF_ASSERT_OK(reader.LookupEntry("foo", &foo_entry));
+
+  // The tensors are read in the reverse order of their entries.
+  Tensor foo_row(DT_FLOAT, TensorShape({1, 3}));
+  TF_ASSERT_OK(reader.LookupSliceWithEntry(
+      "foo", foo_entry, TensorSlice::ParseOrDie("1,1:-"), &foo_row));
+  test::ExpectTensorEqual<float>(foo_row,
+                                 Constant<float>(1., TensorShape({1, 3})));
+  Tensor foo(DT_FLOAT, kFullShape);
+  TF_ASSERT_OK(reader.LookupWithEntry("foo", foo_entry, &foo));
+  test::ExpectTensorEqual<float>(
+      foo, test::AsTensor<float>({0, 0, 0, 1, 1, 1}, kFullShape));
+  Tensor bar(DT_INT32, TensorShape({2}));
+  TF_ASSERT_OK(reader.LookupWithEntry("bar", bar_entry, &bar));
+  test::ExpectTensorEqual<int32>(bar, Constant<int32>(7, TensorShape({2})));
+}
+
 TEST(TensorBundleTest, EquivalentSliceTest) {
   const TensorShape kFullShape({5, 10});
   const Tensor kExpected(Constant<float>(1., kFullShape));
@@ -882,6 +918,201 @@ TEST(TensorBundleTest, DirectoryStructure) {
                           "merged.data-00001-of-00002"});
 }
 
+TEST(TensorBundleTest, MultipleDataFiles) {
+  Env* env = Env::Default();
+  BundleWriter::Options options;
+  options.num_data_files = 3;
+  options.data_alignment = 8;
+  {
+    BundleWriter writer(env, Prefix("multi"), options);
+    for (int i = 0; i < 10; ++i) {
+      TF_EXPECT_OK(writer.Add(strings::StrCat("float", i),
+                              Constant<float>(i, TensorShape({i + 1}))));
+    }
+    TF_EXPECT_OK(writer.Add("strings", test::AsTensor<tstring>({"a", "bc"})));
+    TF_EXPECT_OK(writer.AddSlice("sliced", TensorShape({4}),
+                                 TensorSlice::ParseOrDie("0,2"),
+                                 Constant<int32>(7, TensorShape({2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  for (int i = 0; i < 3; ++i) {
+    TF_EXPECT_OK(env->FileExists(Prefix(
+        strings::StrCat("multi.data-0000", i, "-of-00003"))));
+  }
+
+  auto check = [](const string& prefix) {
+    BundleReader reader(Env::Default(), prefix);
+    TF_ASSERT_OK(reader.status());
+    for (int i = 0; i < 10; ++i) {
+      Expect<float>(&reader, strings::StrCat("float", i),
+                    Constant<float>(i, TensorShape({i + 1})));
+    }
+    Expect<tstring>(&reader, "strings", test::AsTensor<tstring>({"a", "bc"}));
+    Tensor slice(DT_INT32, TensorShape({2}));
+    TF_ASSERT_OK(
+        reader.LookupSlice("sliced", TensorSlice::ParseOrDie("0,2"), &slice));
+    test::ExpectTensorEqual<int32>(slice, Constant<int32>(7, TensorShape({2})));
+  };
+  check(Prefix("multi"));
+
+  // The data files keep their tensors when merged with another bundle.
+  {
+    BundleWriter writer(env, Prefix("multi_other"));
+    TF_EXPECT_OK(writer.Add("other", Constant_2x3<float>(1.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(env, {Prefix("multi"), Prefix("multi_other")},
+                            Prefix("multi_merged")));
+  check(Prefix("multi_merged"));
+  BundleReader reader(env, Prefix("multi_merged"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "other", Constant_2x3<float>(1.));
+}
+
+TEST(TensorBundleTest, MoreDataFilesThanTensors) {
+  Env* env = Env::Default();
+  BundleWriter::Options options;
+  options.num_data_files = 4;
+  {
+    BundleWriter writer(env, Prefix("sparse_files"), options);
+    TF_EXPECT_OK(writer.Add("only", Constant_2x3<float>(3.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(
+      MergeBundles(env, {Prefix("sparse_files")}, Prefix("sparse_merged")));
+  TF_EXPECT_OK(env->FileExists(Prefix("sparse_merged.data-00000-of-00001")));
+  BundleReader reader(env, Prefix("sparse_merged"));
+  TF_ASSERT_OK(reader.status());
+  Expect<float>(&reader, "only", Constant_2x3<float>(3.));
+}
+
+TEST(TensorBundleTest, MemoryMappedTensors) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options options;
+    options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(env, Prefix("mmap"), options);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.Add("int64", Constant<int64>(2, TensorShape({5}))));
+    TF_EXPECT_OK(writer.Add("strings", test::AsTensor<tstring>({"a", "bc"})));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  auto allocator_name = [](const Tensor& t) {
+    TensorDescription description;
+    t.FillDescription(&description);
+    return description.allocation_description().allocator_name();
+  };
+
+  BundleReader::Options options;
+  options.use_mmap = true;
+  Tensor float_val, int64_val, string_val;
+  {
+    BundleReader reader(env, Prefix("mmap"), options);
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.Lookup("float", &float_val));
+    TF_ASSERT_OK(reader.Lookup("int64", &int64_val));
+    TF_ASSERT_OK(reader.Lookup("strings", &string_val));
+    // Tensors allocated by the caller are filled by copying, as before.
+    Expect<float>(&reader, "float", Constant_2x3<float>(1.));
+  }
+  // The mapped tensors outlive the reader.
+  test::ExpectTensorEqual<float>(float_val, Constant_2x3<float>(1.));
+  test::ExpectTensorEqual<int64>(int64_val,
+                                 Constant<int64>(2, TensorShape({5})));
+  test::ExpectTensorEqual<tstring>(string_val,
+                                   test::AsTensor<tstring>({"a", "bc"}));
+  EXPECT_EQ("mmap", allocator_name(float_val));
+  EXPECT_EQ("mmap", allocator_name(int64_val));
+  EXPECT_NE("mmap", allocator_name(string_val));
+}
+
+TEST(TensorBundleTest, UnverifiedMemoryMappedTensors) {
+  Env* env = Env::Default();
+  {
+    BundleWriter::Options options;
+    options.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(env, Prefix("mmap_unverified"), options);
+    TF_EXPECT_OK(writer.Add("float", Constant_2x3<float>(1.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Corrupts the tensor, which is at the start of the data file.
+  const string datafile = DataFilename(Prefix("mmap_unverified"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(env, datafile, &data));
+  const float corrupted = 2.;
+  memcpy(&data[0], &corrupted, sizeof(corrupted));
+  TF_ASSERT_OK(WriteStringToFile(env, datafile, data));
+
+  BundleReader::Options options;
+  options.use_mmap = true;
+  Tensor val;
+  {
+    BundleReader reader(env, Prefix("mmap_unverified"), options);
+    TF_ASSERT_OK(reader.status());
+    EXPECT_TRUE(errors::IsDataLoss(reader.Lookup("float", &val)));
+  }
+  options.verify_mapped_tensors = false;
+  {
+    BundleReader reader(env, Prefix("mmap_unverified"), options);
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.Lookup("float", &val));
+  }
+  EXPECT_EQ(2., val.flat<float>()(0));
+  EXPECT_EQ(1., val.flat<float>()(1));
+}
+
+TEST(TensorBundleTest, CompactBundles) {
+  Env* env = Env::Default();
+  const TensorShape kFullShape({4, 2});
+  {
+    BundleWriter writer(env, Prefix("compact_base"));
+    TF_EXPECT_OK(writer.Add("bar", Constant<int32>(7, TensorShape({}))));
+    TF_EXPECT_OK(writer.Add("foo", Constant<float>(0., kFullShape)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Each delta stores the rows of "foo" that were updated since the previous
+  // checkpoint.
+  {
+    BundleWriter writer(env, Prefix("compact_delta1"));
+    TF_EXPECT_OK(writer.AddSlice("foo", kFullShape,
+                                 TensorSlice::ParseOrDie("1,1:-"),
+                                 Constant<float>(1., TensorShape({1, 2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  {
+    BundleWriter writer(env, Prefix("compact_delta2"));
+    TF_EXPECT_OK(writer.AddSlice("foo", kFullShape,
+                                 TensorSlice::ParseOrDie("1,2:-"),
+                                 Constant<float>(2., TensorShape({2, 2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(CompactBundles(env,
+                              {Prefix("compact_base"), Prefix("compact_delta1"),
+                               Prefix("compact_delta2")},
+                              Prefix("compacted")));
+
+  BundleReader reader(env, Prefix("compacted"));
+  TF_ASSERT_OK(reader.status());
+  Expect<int32>(&reader, "bar", Constant<int32>(7, TensorShape({})));
+  Expect<float>(&reader, "foo",
+                test::AsTensor<float>({0, 0, 2, 2, 2, 2, 0, 0}, kFullShape));
+  // The inputs are left in place.
+  TF_EXPECT_OK(env->FileExists(MetaFilename(Prefix("compact_delta1"))));
+}
+
+TEST(TensorBundleTest, CompactBundlesWithoutFullTensor) {
+  {
+    BundleWriter writer(Env::Default(), Prefix("compact_partial"));
+    TF_EXPECT_OK(writer.AddSlice("foo", TensorShape({4, 2}),
+                                 TensorSlice::ParseOrDie("1,1:-"),
+                                 Constant<float>(1., TensorShape({1, 2}))));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  EXPECT_FALSE(CompactBundles(Env::Default(), {Prefix("compact_partial")},
+                              Prefix("compacted_partial"))
+                   .ok());
+}
+
 TEST(TensorBundleTest, Error) {
   {  // Dup keys.
     BundleWriter writer(Env::Default(), Prefix("dup"));
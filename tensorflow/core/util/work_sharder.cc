@@ -15,7 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/util/work_sharder.h"
 
+#include <algorithm>
+
 #include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env_time.h"
 #include "tensorflow/core/platform/logging.h"
 
 namespace tensorflow {
@@ -51,6 +54,40 @@ void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
       max_parallelism);
 }
 
+constexpr int64 ShardCostModel::kScaleOne;
+
+int64 ShardCostModel::Adjust(int64 cost_per_unit) const {
+  const int64 scale = scale_.load(std::memory_order_relaxed);
+  return std::max(int64{1}, cost_per_unit * scale / kScaleOne);
+}
+
+void ShardCostModel::Record(int64 units, int64 cost_per_unit, int64 nanos) {
+  const int64 estimated_cost = units * std::max(int64{1}, cost_per_unit);
+  if (estimated_cost <= 0) return;
+  // Estimates are trusted to be within 64x of the truth, which keeps a
+  // single preempted shard from skewing the model too far.
+  const int64 sample =
+      std::min(64 * kScaleOne,
+               std::max(kScaleOne / 64, nanos * kScaleOne / estimated_cost));
+  // An exponential moving average, so that the model follows the inputs of a
+  // call site as they change. Concurrent updates may drop a sample.
+  const int64 scale = scale_.load(std::memory_order_relaxed);
+  scale_.store(scale + (sample - scale) / 8, std::memory_order_relaxed);
+}
+
+void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
+           int64 cost_per_unit, ShardCostModel* cost_model,
+           std::function<void(int64, int64)> work) {
+  CHECK(cost_model != nullptr);
+  Shard(max_parallelism, workers, total, cost_model->Adjust(cost_per_unit),
+        [cost_per_unit, cost_model, &work](int64 start, int64 limit) {
+          const uint64 start_nanos = EnvTime::NowNanos();
+          work(start, limit);
+          cost_model->Record(limit - start, cost_per_unit,
+                             EnvTime::NowNanos() - start_nanos);
+        });
+}
+
 // DEPRECATED: Prefer threadpool->ParallelFor with SchedulingStrategy, which
 // allows you to specify the strategy for choosing shard sizes, including using
 // a fixed shard size.
@@ -16,9 +16,11 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 #define TENSORFLOW_CORE_UTIL_WORK_SHARDER_H_
 
+#include <atomic>
 #include <functional>
 
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/types.h"
 
 namespace tensorflow {
@@ -59,6 +61,42 @@ namespace tensorflow {
 void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
            int64 cost_per_unit, std::function<void(int64, int64)> work);
 
+// Learns how far the "cost_per_unit" estimates of one Shard() call site are
+// from the time its work actually takes, so that later calls are sharded by
+// corrected estimates. A call site typically owns a function-local static
+// instance, which makes the model per kernel type:
+//
+//   static ShardCostModel* cost_model = new ShardCostModel;
+//   Shard(max_parallelism, workers, total, cost_per_unit, cost_model, work);
+//
+// Thread-safe.
+class ShardCostModel {
+ public:
+  ShardCostModel() {}
+
+  // Returns "cost_per_unit" corrected by the runtimes recorded so far.
+  int64 Adjust(int64 cost_per_unit) const;
+
+  // Records that "units" units of work estimated at "cost_per_unit" each
+  // took "nanos" nanoseconds.
+  void Record(int64 units, int64 cost_per_unit, int64 nanos);
+
+ private:
+  // Nanoseconds per unit of estimated cost, in units of 1/kScaleOne.
+  static constexpr int64 kScaleOne = 1024;
+  std::atomic<int64> scale_{kScaleOne};
+
+  TF_DISALLOW_COPY_AND_ASSIGN(ShardCostModel);
+};
+
+// Like Shard() above, but "cost_per_unit" is corrected by "cost_model", and
+// the runtime of each shard is recorded in it.
+//
+// REQUIRES: cost_model != nullptr
+void Shard(int max_parallelism, thread::ThreadPool* workers, int64 total,
+           int64 cost_per_unit, ShardCostModel* cost_model,
+           std::function<void(int64, int64)> work);
+
 // Each thread has an associated option to express the desired maximum
 // parallelism. Its default is a very large quantity.
 //
@@ -89,6 +89,30 @@ TEST(Shard, OverflowTest) {
   }
 }
 
+TEST(ShardCostModel, LearnsCorrection) {
+  ShardCostModel cost_model;
+  EXPECT_EQ(cost_model.Adjust(10), 10);
+  // The work takes 10x its estimate.
+  for (int i = 0; i < 100; ++i) cost_model.Record(100, 10, 10000);
+  EXPECT_NEAR(cost_model.Adjust(10), 100, 1);
+  // A single outlier is bounded, and moves the model only part of the way.
+  cost_model.Record(1, 10, 1LL << 40);
+  EXPECT_LT(cost_model.Adjust(10), 200);
+}
+
+TEST(Shard, WithCostModel) {
+  thread::ThreadPool threads(Env::Default(), "test", 16);
+  ShardCostModel cost_model;
+  for (auto total : {0, 1, 7, 1000, 9999}) {
+    std::atomic<int64> num_elements(0);
+    Shard(8, &threads, total, 100, &cost_model,
+          [&num_elements](int64 start, int64 limit) {
+            num_elements += limit - start;
+          });
+    EXPECT_EQ(num_elements.load(), total);
+  }
+}
+
 void BM_Sharding(int iters, int arg) {
   thread::ThreadPool threads(Env::Default(), "test", 16);
   const int64 total = 1LL << 30;
@@ -216,6 +216,19 @@ func tensorData(c *C.TF_Tensor) []byte {
 	return slice
 }
 
+// sliceBytes returns the memory of v, a slice of fixed-size numbers, without
+// copying it. The tensor encoding of such a slice is its memory, since the
+// encoding uses the native byte order.
+func sliceBytes(v reflect.Value) []byte {
+	length := v.Len() * int(v.Type().Elem().Size())
+	var slice []byte
+	header := (*reflect.SliceHeader)(unsafe.Pointer(&slice))
+	header.Data = v.Pointer()
+	header.Len = length
+	header.Cap = length
+	return slice
+}
+
 var types = []struct {
 	typ      reflect.Type
 	dataType C.TF_DataType
@@ -329,10 +342,15 @@ func encodeTensor(w *bytes.Buffer, v reflect.Value, shape []int64) error {
 			}
 		}
 
-		// Optimisation: if only one dimension is left we can use binary.Write() directly for this slice
+		// Optimisation: if only one dimension is left we can copy the memory
+		// of a slice, or use binary.Write() directly for an array
 		if len(shape) == 1 && v.Len() > 0 {
 			switch v.Index(0).Kind() {
 			case reflect.Int8, reflect.Int16, reflect.Int32, reflect.Int64, reflect.Uint8, reflect.Uint16, reflect.Uint32, reflect.Uint64, reflect.Float32, reflect.Float64, reflect.Complex64, reflect.Complex128:
+				if v.Kind() == reflect.Slice {
+					_, err := w.Write(sliceBytes(v))
+					return err
+				}
 				return binary.Write(w, nativeEndian, v.Interface())
 			}
 		}
@@ -370,11 +388,13 @@ func decodeTensor(r *bytes.Reader, shape []int64, typ reflect.Type, ptr reflect.
 		val := reflect.Indirect(ptr)
 		val.Set(reflect.MakeSlice(typ, int(shape[0]), int(shape[0])))
 
-		// Optimization: if only one dimension is left we can use binary.Read() directly for this slice
+		// Optimization: if only one dimension is left we can copy directly
+		// into the memory of this slice
 		if len(shape) == 1 && val.Len() > 0 {
 			switch val.Index(0).Kind() {
 			case reflect.Int8, reflect.Int16, reflect.Int32, reflect.Int64, reflect.Uint8, reflect.Uint16, reflect.Uint32, reflect.Uint64, reflect.Float32, reflect.Float64, reflect.Complex64, reflect.Complex128:
-				return binary.Read(r, nativeEndian, val.Interface())
+				_, err := io.ReadFull(r, sliceBytes(val))
+				return err
 			}
 		}
 
@@ -266,6 +266,52 @@ public final class Tensor<T> implements AutoCloseable {
     return t;
   }
 
+  /**
+   * Create a Tensor of any type that shares the memory of the given direct buffer.
+   *
+   * <p>Unlike {@link #create(Class, long[], ByteBuffer)}, the tensor data is not copied: the tensor
+   * uses the {@code data.remaining()} bytes of {@code data} starting from its current position,
+   * encoded as per the specification of the TensorFlow <a
+   * href="https://www.tensorflow.org/code/tensorflow/c/c_api.h">C API</a> in native byte order.
+   * The position of {@code data} is not changed. The buffer must not be modified while the tensor
+   * is in use; TensorFlow keeps it reachable for as long as it uses the memory, which may be after
+   * the tensor is closed. If the memory is not aligned as TensorFlow requires, the data is copied
+   * instead.
+   *
+   * @param <T> the tensor element type
+   * @param type the tensor element type, represented as a class object.
+   * @param shape the tensor shape.
+   * @param data a direct buffer containing the tensor data.
+   * @throws IllegalArgumentException If the tensor datatype is {@link String}, if the buffer is not
+   *     direct, or if the tensor shape is not compatible with the buffer
+   */
+  public static <T> Tensor<T> wrap(Class<T> type, long[] shape, ByteBuffer data) {
+    DataType dtype = DataType.fromClass(type);
+    if (dtype == DataType.STRING) {
+      throw new IllegalArgumentException("cannot wrap a ByteBuffer in a String Tensor");
+    }
+    if (!data.isDirect()) {
+      throw new IllegalArgumentException("cannot wrap a ByteBuffer that is not direct");
+    }
+    int elemBytes = elemByteSize(dtype);
+    if (data.remaining() % elemBytes != 0) {
+      throw new IllegalArgumentException(
+          String.format(
+              "ByteBuffer with %d bytes is not compatible with a %s Tensor (%d bytes/element)",
+              data.remaining(), dtype.toString(), elemBytes));
+    }
+    if (data.remaining() / elemBytes != numElements(shape)) {
+      throw incompatibleBuffer(data.remaining() / elemBytes, shape);
+    }
+    Tensor<T> t = new Tensor<T>(dtype);
+    t.shapeCopy = Arrays.copyOf(shape, shape.length);
+    long nativeHandle =
+        allocateForDirectBuffer(
+            t.dtype.c(), t.shapeCopy, data, data.position(), data.remaining());
+    t.nativeRef = new NativeReference(nativeHandle);
+    return t;
+  }
+
   /**
    * Returns this Tensor object with the type {@code Tensor<U>}. This method is useful when given a
    * value of type {@code Tensor<?>}.
@@ -806,6 +852,9 @@ public final class Tensor<T> implements AutoCloseable {
 
   private static native long allocate(int dtype, long[] shape, long byteSize);
 
+  private static native long allocateForDirectBuffer(
+      int dtype, long[] shape, ByteBuffer data, long offset, long byteSize);
+
   private static native long allocateScalarBytes(byte[] value);
 
   private static native long allocateNonScalarBytes(long[] shape, Object[] value);
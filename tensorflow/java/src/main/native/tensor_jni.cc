@@ -20,6 +20,7 @@ limitations under the License.
 #include <string.h>
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "tensorflow/c/c_api.h"
 #include "tensorflow/java/src/main/native/exception_jni.h"
@@ -65,6 +66,36 @@ size_t elemByteSize(TF_DataType dtype) {
   }
 }
 
+// Keeps the direct java.nio.ByteBuffer of a TF_Tensor reachable until
+// TensorFlow releases the tensor's memory, which may outlive the Java Tensor.
+struct DirectBufferRef {
+  JavaVM* vm;
+  jobject buffer;
+};
+
+void releaseDirectBuffer(void* data, size_t len, void* arg) {
+  DirectBufferRef* ref = static_cast<DirectBufferRef*>(arg);
+  // The memory may be released on a thread of the TensorFlow runtime.
+  JNIEnv* env = nullptr;
+  bool attached = false;
+  if (ref->vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) ==
+      JNI_EDETACHED) {
+#ifdef __ANDROID__
+    JNIEnv** env_arg = &env;
+#else
+    void** env_arg = reinterpret_cast<void**>(&env);
+#endif
+    if (ref->vm->AttachCurrentThread(env_arg, nullptr) != JNI_OK) {
+      delete ref;
+      return;
+    }
+    attached = true;
+  }
+  env->DeleteGlobalRef(ref->buffer);
+  if (attached) ref->vm->DetachCurrentThread();
+  delete ref;
+}
+
 // Write a Java scalar object (java.lang.Integer etc.) to a TF_Tensor.
 void writeScalar(JNIEnv* env, jobject src, TF_DataType dtype, void* dst,
                  size_t dst_size) {
@@ -362,6 +393,38 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv* env,
   return reinterpret_cast<jlong>(t);
 }
 
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateForDirectBuffer(
+    JNIEnv* env, jclass clazz, jint dtype, jlongArray shape, jobject buffer,
+    jlong offset, jlong sizeInBytes) {
+  char* data = static_cast<char*>(env->GetDirectBufferAddress(buffer));
+  if (data == nullptr) {
+    throwException(env, kIllegalArgumentException,
+                   "the ByteBuffer of the Tensor must be direct");
+    return 0;
+  }
+  const int num_dims = static_cast<int>(env->GetArrayLength(shape));
+  std::vector<int64_t> dims(num_dims);
+  if (num_dims > 0) {
+    env->GetLongArrayRegion(shape, 0, num_dims,
+                            reinterpret_cast<jlong*>(dims.data()));
+  }
+  DirectBufferRef* ref = new DirectBufferRef;
+  env->GetJavaVM(&ref->vm);
+  ref->buffer = env->NewGlobalRef(buffer);
+  // TF_NewTensor copies the data instead if it is not aligned as TensorFlow
+  // requires.
+  TF_Tensor* t = TF_NewTensor(static_cast<TF_DataType>(dtype), dims.data(),
+                              num_dims, data + offset,
+                              static_cast<size_t>(sizeInBytes),
+                              releaseDirectBuffer, ref);
+  if (t == nullptr) {
+    throwException(env, kNullPointerException,
+                   "unable to allocate memory for the Tensor");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(t);
+}
+
 JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateScalarBytes(
     JNIEnv* env, jclass clazz, jbyteArray value) {
   // TF_STRING tensors are encoded with a table of 8-byte offsets followed by
@@ -31,6 +31,14 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocate(JNIEnv *, jclass,
                                                             jint, jlongArray,
                                                             jlong);
 
+/*
+ * Class:     org_tensorflow_Tensor
+ * Method:    allocateForDirectBuffer
+ * Signature: (I[JLjava/nio/ByteBuffer;JJ)J
+ */
+JNIEXPORT jlong JNICALL Java_org_tensorflow_Tensor_allocateForDirectBuffer(
+    JNIEnv *, jclass, jint, jlongArray, jobject, jlong, jlong);
+
 /*
  * Class:     org_tensorflow_Tensor
  * Method:    allocateScalarBytes
@@ -164,6 +164,32 @@ public class TensorTest {
     }
   }
 
+  @Test
+  public void wrapDirectBuffer() {
+    float[] floats = {1f, 2f, 3f, 4f, 5f, 6f};
+    ByteBuffer buf = ByteBuffer.allocateDirect(4 * floats.length).order(ByteOrder.nativeOrder());
+    buf.asFloatBuffer().put(floats);
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {2, 3}, buf)) {
+      float[][] actual = new float[2][3];
+      t.copyTo(actual);
+      assertArrayEquals(new float[] {1f, 2f, 3f}, actual[0], EPSILON_F);
+      assertArrayEquals(new float[] {4f, 5f, 6f}, actual[1], EPSILON_F);
+    }
+    assertEquals(0, buf.position());
+
+    try (Tensor<Float> t = Tensor.wrap(Float.class, new long[] {4}, buf)) {
+      fail("should have failed on incompatible buffer");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+    try (Tensor<Float> t =
+        Tensor.wrap(Float.class, new long[] {6}, ByteBuffer.allocate(4 * floats.length))) {
+      fail("should have failed on a buffer that is not direct");
+    } catch (IllegalArgumentException e) {
+      // expected
+    }
+  }
+
   @Test
   public void writeTo() {
     int[] ints = {1, 2, 3};
@@ -238,8 +238,9 @@ TfLiteStatus ArenaPlanner::ReleaseNonPersistentMemory() {
 TfLiteStatus ArenaPlanner::AcquireNonPersistentMemory() {
   // First commit arena_ to allocate underlying buffer.
   TF_LITE_ENSURE_STATUS(arena_.Commit(context_));
-  // Resolve allocations for all tensors not on the persistent arena.
-  for (int i = 0; i < static_cast<int>(graph_info_->num_tensors()); ++i) {
+  // Resolve allocations for all tensors not on the persistent arena. Tensors
+  // added after the allocations were planned are not part of the plan.
+  for (int i = 0; i < static_cast<int>(allocs_.size()); ++i) {
     TfLiteTensor& tensor = *graph_info_->tensor(i);
     if (tensor.allocation_type == kTfLiteArenaRw) {
       TF_LITE_ENSURE_STATUS(ResolveTensorAllocation(i));
@@ -299,10 +300,41 @@ std::vector<int32_t> ArenaPlanner::CreateTensorAllocationVector(int first_node,
   return tensor_order;
 }
 
+const OfflineMemoryPlan* ArenaPlanner::GetUsableOfflinePlan(int first_node,
+                                                            int last_node) {
+  const OfflineMemoryPlan* plan = graph_info_->offline_memory_plan();
+  // Offline offsets are only valid for the lifetimes of a full pass over the
+  // graph, so they are not used when tensors are allocated incrementally.
+  if (plan == nullptr || preserve_intermediates_ || first_node != 0 ||
+      last_node + 1 < static_cast<int>(graph_info_->num_nodes()) ||
+      plan->offsets.size() > graph_info_->num_tensors() ||
+      plan->bytes.size() != plan->offsets.size()) {
+    return nullptr;
+  }
+  // The plan is used for all tensors or none of them.
+  for (size_t i = 0; i < plan->offsets.size(); ++i) {
+    if (plan->offsets[i] < 0) continue;
+    const TfLiteTensor& tensor = *graph_info_->tensor(i);
+    if (tensor.allocation_type != kTfLiteArenaRw ||
+        tensor.bytes > plan->bytes[i] ||
+        plan->offsets[i] % tensor_alignment_ != 0) {
+      return nullptr;
+    }
+  }
+  return plan;
+}
+
 TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
   // Indices of tensors in order their allocation offsets will be calculated.
   const std::vector<int32_t> tensor_order =
       CreateTensorAllocationVector(first_node, last_node);
+  const OfflineMemoryPlan* offline_plan =
+      GetUsableOfflinePlan(first_node, last_node);
+  auto is_offline_planned = [offline_plan](int tensor_index) {
+    return offline_plan != nullptr &&
+           tensor_index < static_cast<int>(offline_plan->offsets.size()) &&
+           offline_plan->offsets[tensor_index] >= 0;
+  };
 
   // Deallocate if the tensor was already allocated.
   for (const auto& tensor_index : tensor_order) {
@@ -313,14 +345,36 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(int first_node, int last_node) {
     }
   }
 
+  // Place the offline-planned tensors first, so that the others fill the gaps
+  // around them.
+  if (offline_plan != nullptr) {
+    for (const auto& tensor_index : tensor_order) {
+      if (!is_offline_planned(tensor_index)) continue;
+      TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
+      TF_LITE_ENSURE_STATUS(arena_.AllocateAt(
+          context_, tensor_alignment_, offline_plan->offsets[tensor_index],
+          tensor.bytes, tensor_index, alloc_node_[tensor_index],
+          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+    }
+  }
+
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : tensor_order) {
     TfLiteTensor& tensor = *graph_info_->tensor(tensor_index);
-    if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+    if (tensor.allocation_type == kTfLiteArenaRw &&
+        !is_offline_planned(tensor_index)) {
+      // Extend the usage interval to whole groups of concurrent nodes, so that
+      // no two tensors used by nodes which may run at the same time overlap.
+      const int32_t usage_first_node =
+          graph_info_->concurrent_nodes(alloc_node_[tensor_index]).first;
+      int32_t usage_last_node = dealloc_node_[tensor_index];
+      if (usage_last_node != kNodeNotAssigned) {
+        usage_last_node = graph_info_->concurrent_nodes(usage_last_node).second;
+      }
+      TF_LITE_ENSURE_STATUS(arena_.Allocate(context_, tensor_alignment_,
+                                            tensor.bytes, tensor_index,
+                                            usage_first_node, usage_last_node,
+                                            &allocs_[tensor_index]));
     }
     if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
       TF_LITE_ENSURE_STATUS(persistent_arena_.Allocate(
@@ -45,6 +45,11 @@ struct AllocationInfo;
 // execution. Since dynamic tensors don't have sizes until after the
 // corresponding operation is executed, this class supports incremental
 // planning.
+//
+// If the graph provides an offline memory plan that matches its tensors, and
+// all of them are allocated at once, the offline-planned tensors are placed at
+// their offsets without searching for a gap. Only the remaining tensors, such
+// as the temporary ones, are placed by the greedy algorithm.
 class ArenaPlanner : public MemoryPlanner {
  public:
   // Ownership of 'context' is not taken and it must remain util the
@@ -84,6 +89,11 @@ class ArenaPlanner : public MemoryPlanner {
   std::vector<int32_t> CreateTensorAllocationVector(int first_node,
                                                     int last_node);
 
+  // Returns the offline memory plan of the graph if it can be used to allocate
+  // the tensors of the nodes in the interval [first_node, last_node], nullptr
+  // otherwise.
+  const OfflineMemoryPlan* GetUsableOfflinePlan(int first_node, int last_node);
+
   // Traverse the allocation queue and reserve space in the appropriate arena
   // for all tensors affected by ops in the interval [first_node, last_node].
   TfLiteStatus CalculateAllocations(int first_node, int last_node);
@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <cstdarg>
 #include <cstdint>
+#include <utility>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -109,6 +110,31 @@ class TestGraph {
     variables_ = variables;
   }
 
+  // Sets, for each node, the range of nodes that may run concurrently with it.
+  void SetConcurrentNodes(
+      const std::vector<std::pair<size_t, size_t>>& concurrent_nodes) {
+    concurrent_nodes_ = concurrent_nodes;
+  }
+
+  std::pair<size_t, size_t> concurrent_nodes(size_t index) {
+    if (index < concurrent_nodes_.size()) return concurrent_nodes_[index];
+    return {index, index};
+  }
+
+  // Sets the offline memory plan, made for the current sizes of the tensors.
+  void SetOfflineMemoryPlan(const std::vector<int32_t>& offsets) {
+    offline_memory_plan_.offsets = offsets;
+    offline_memory_plan_.bytes.clear();
+    for (const TfLiteTensor& tensor : tensors_) {
+      offline_memory_plan_.bytes.push_back(tensor.bytes);
+    }
+  }
+
+  const OfflineMemoryPlan* offline_memory_plan() {
+    if (offline_memory_plan_.offsets.empty()) return nullptr;
+    return &offline_memory_plan_;
+  }
+
   void Swap(TestGraph* other) {
     std::swap(nodes_, other->nodes_);
     std::swap(tensors_, other->tensors_);
@@ -123,6 +149,8 @@ class TestGraph {
   std::vector<int> inputs_;
   std::vector<int> outputs_;
   std::vector<int> variables_;
+  std::vector<std::pair<size_t, size_t>> concurrent_nodes_;
+  OfflineMemoryPlan offline_memory_plan_;
 };
 
 // The GraphInfo for a TestGraph.
@@ -144,6 +172,12 @@ class TestGraphInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return graph_->variables();
   }
+  std::pair<size_t, size_t> concurrent_nodes(size_t index) const override {
+    return graph_->concurrent_nodes(index);
+  }
+  const OfflineMemoryPlan* offline_memory_plan() const override {
+    return graph_->offline_memory_plan();
+  }
 
  private:
   TestGraph* graph_;
@@ -237,7 +271,7 @@ TEST_F(ArenaPlannerTest, GraphWithNoOps) {
   TestGraph graph({0, 10}, {}, {5, 11});
   SetGraph(&graph);
   Execute(0, 10);
-  EXPECT_EQ(GetOffset(0), 0);
+  EXPECT_NE(GetOffset(0), 100);
   EXPECT_EQ(GetOffset(10), GetOffsetAfter(0));
   // The outputs are never allocated because they are not connected to any
   // inputs.
@@ -324,6 +358,63 @@ TEST_F(ArenaPlannerTest, SimpleGraphWithTemporary) {
   EXPECT_EQ(GetOffset(1), 0);
 }
 
+TEST_F(ArenaPlannerTest, SimpleGraphWithConcurrentNodes) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {3}},    // First op, with temporary
+                      {{0}, {2}, {4}},    // Second op, with temporary
+                      {{1, 2}, {5}, {}}   // Third op
+                  },
+                  {5});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // The temporaries are used by different nodes, so they may share memory.
+  EXPECT_EQ(GetOffset(4), 0);
+  EXPECT_EQ(GetOffset(3), 0);
+
+  // Unless these nodes run concurrently.
+  graph.SetConcurrentNodes({{0, 1}, {0, 1}, {2, 2}});
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_EQ(GetOffset(4), 0);
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(4));
+}
+
+TEST_F(ArenaPlannerTest, SimpleGraphWithOfflineMemoryPlan) {
+  TestGraph graph({0},
+                  {
+                      /* in, out, tmp */
+                      {{0}, {1}, {3}},  // First op, with temporary
+                      {{1}, {2}, {}}    // Second op
+                  },
+                  {2});
+  graph.SetOfflineMemoryPlan({100, 0, 52, -1});
+  SetGraph(&graph);
+  Execute(0, 10);
+
+  // The planned tensors are at their offsets, and the temporary is placed in
+  // the first gap around them.
+  EXPECT_EQ(GetOffset(0), 100);
+  EXPECT_EQ(GetOffset(1), 0);
+  EXPECT_EQ(GetOffset(2), 52);
+  EXPECT_EQ(GetOffset(3), GetOffsetAfter(1));
+
+  // The plan is not used for tensors larger than the plan expects.
+  (*graph.tensors())[1].bytes *= 2;
+  SetGraph(&graph);
+  Execute(0, 10);
+  EXPECT_NE(GetOffset(0), 100);
+
+  // Nor when tensors are allocated incrementally.
+  graph.SetOfflineMemoryPlan({100, 0, 52, -1});
+  SetGraph(&graph);
+  Execute(0, 0);
+  Execute(1, 1);
+  EXPECT_NE(GetOffset(0), 100);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphWithResetAllocationsAfter) {
   TestGraph graph({0, 1},
                   {
@@ -0,0 +1,108 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
+
+namespace tflite {
+namespace {
+
+// The kTfLiteCpuBackendContext of the worker thread this runs on, if any.
+thread_local ExternalCpuBackendContext* current_cpu_backend_context = nullptr;
+
+}  // namespace
+
+InterOpThreadPool::InterOpThreadPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    cpu_backend_contexts_.emplace_back(new ExternalCpuBackendContext());
+    threads_.emplace_back(&InterOpThreadPool::WorkerLoop, this,
+                          cpu_backend_contexts_.back().get());
+  }
+}
+
+InterOpThreadPool::~InterOpThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_available_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void InterOpThreadPool::ParallelFor(int n,
+                                    const std::function<void(int)>& fn) {
+  if (threads_.empty() || n <= 1) {
+    for (int i = 0; i < n; ++i) fn(i);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    fn_ = &fn;
+    num_calls_ = n;
+    next_call_ = 0;
+    num_busy_workers_ = threads_.size();
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunCalls();
+
+  // Wait for all workers, not only for all calls, as a worker may still be
+  // about to claim a call of this ParallelFor().
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return num_busy_workers_ == 0; });
+  fn_ = nullptr;
+}
+
+void InterOpThreadPool::SetMaxNumThreadsPerOp(int num_threads) {
+  for (auto& context : cpu_backend_contexts_) {
+    if (context->internal_backend_context()) {
+      context->internal_backend_context()->SetMaxNumThreads(num_threads);
+    }
+  }
+}
+
+TfLiteExternalContext* InterOpThreadPool::GetCurrentCpuBackendContext() {
+  return current_cpu_backend_context;
+}
+
+void InterOpThreadPool::WorkerLoop(
+    ExternalCpuBackendContext* cpu_backend_context) {
+  current_cpu_backend_context = cpu_backend_context;
+  int64_t last_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this, last_generation] {
+        return shutdown_ || generation_ != last_generation;
+      });
+      if (shutdown_) return;
+      last_generation = generation_;
+    }
+    RunCalls();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--num_busy_workers_ == 0) work_done_.notify_one();
+    }
+  }
+}
+
+void InterOpThreadPool::RunCalls() {
+  for (int i = next_call_++; i < num_calls_; i = next_call_++) {
+    (*fn_)(i);
+  }
+}
+
+}  // namespace tflite
@@ -0,0 +1,89 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
+#define TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
+
+#include <atomic>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>   // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
+
+namespace tflite {
+
+// A fixed set of threads on which the interpreter runs nodes that don't depend
+// on each other concurrently (see Interpreter::SetNumInterOpThreads()).
+//
+// Each worker thread owns a kTfLiteCpuBackendContext, which kernels running
+// on it get instead of the interpreter's, so that kernels running at the same
+// time never share a ruy or gemmlowp context.
+class InterOpThreadPool {
+ public:
+  // Creates a pool that runs work on `num_threads` threads, counting the one
+  // calling ParallelFor(), i.e. `num_threads - 1` threads are started.
+  explicit InterOpThreadPool(int num_threads);
+  ~InterOpThreadPool();
+
+  int num_threads() const { return threads_.size() + 1; }
+
+  // Calls `fn(i)` for each i in [0, n) on the threads of the pool, including
+  // the calling one, and returns when all calls have returned. Must not be
+  // called concurrently, nor from `fn`.
+  void ParallelFor(int n, const std::function<void(int)>& fn);
+
+  // Sets the maximum number of threads that each op running on a worker
+  // thread may use.
+  void SetMaxNumThreadsPerOp(int num_threads);
+
+  // Returns the kTfLiteCpuBackendContext of the calling thread if it is a
+  // worker thread of a pool, or nullptr otherwise.
+  static TfLiteExternalContext* GetCurrentCpuBackendContext();
+
+ private:
+  void WorkerLoop(ExternalCpuBackendContext* cpu_backend_context);
+
+  // Claims and runs calls of the current ParallelFor() until none is left.
+  void RunCalls();
+
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>> cpu_backend_contexts_;
+  std::vector<std::thread> threads_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable work_done_;
+  // Incremented by each ParallelFor(), so that workers know there is work.
+  int64_t generation_ = 0;
+  // Number of workers that haven't finished the current ParallelFor().
+  int num_busy_workers_ = 0;
+  bool shutdown_ = false;
+
+  // The current ParallelFor(). Only written while no worker is busy.
+  const std::function<void(int)>* fn_ = nullptr;
+  int num_calls_ = 0;
+  std::atomic<int> next_call_{0};
+
+  InterOpThreadPool(const InterOpThreadPool&) = delete;
+  InterOpThreadPool& operator=(const InterOpThreadPool&) = delete;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_CORE_INTER_OP_THREAD_POOL_H_
@@ -16,11 +16,13 @@ limitations under the License.
 #include "tensorflow/lite/core/subgraph.h"
 
 #include <algorithm>
+#include <numeric>
 
 #include "tensorflow/lite/arena_planner.h"
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/context_util.h"
 #include "tensorflow/lite/core/api/tensor_utils.h"
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -174,6 +176,12 @@ class InterpreterInfo : public GraphInfo {
   const std::vector<int>& variables() const override {
     return subgraph_->variables();
   }
+  std::pair<size_t, size_t> concurrent_nodes(size_t index) const override {
+    return subgraph_->concurrent_nodes(index);
+  }
+  const OfflineMemoryPlan* offline_memory_plan() const override {
+    return subgraph_->offline_memory_plan();
+  }
 
  public:
   Subgraph* subgraph_;
@@ -209,6 +217,7 @@ Subgraph::Subgraph(ErrorReporter* error_reporter,
 }
 
 Subgraph::~Subgraph() {
+  ClearPreparedShapeCache();
   for (int node_index = 0; node_index < nodes_and_registration_.size();
        ++node_index) {
     CleanupNode(node_index);
@@ -366,6 +375,9 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
       node_subsets.size());
 
   execution_plan_.clear();
+  concurrent_nodes_.clear();
+  offline_memory_plan_.reset();
+  ClearPreparedShapeCache();
 
   for (auto& node_subset : node_subsets) {
     // Subsets claimed by the delegate should have a "macro" op created, the
@@ -409,6 +421,13 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext) {
+    // Kernels running on a worker of the inter-op thread pool use the worker's
+    // own context.
+    TfLiteExternalContext* worker_context =
+        InterOpThreadPool::GetCurrentCpuBackendContext();
+    if (worker_context != nullptr) return worker_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -629,11 +648,27 @@ TfLiteStatus Subgraph::AllocateTensors() {
 
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
-  if (memory_planner_) {
-    TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
-  }
+  TF_LITE_ENSURE_STATUS(ScheduleConcurrentNodes());
+
+  // If the graph was prepared for the current input shapes before, restore
+  // that state instead of preparing the nodes again.
+  bool restored = false;
+  TF_LITE_ENSURE_STATUS(SwitchPreparedShapeState(&restored));
+  if (!restored) {
+    if (memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->ResetAllocations());
+    }
 
-  TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
+    if (PrepareOpsAndTensors() != kTfLiteOk) {
+      ClearPreparedShapeCache();
+      return kTfLiteError;
+    }
+    if (CanCachePreparedShapes()) {
+      prepared_input_shapes_ = GetInputShapes();
+    } else {
+      ClearPreparedShapeCache();
+    }
+  }
 
   state_ = kStateInvokable;
 
@@ -725,6 +760,9 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
   // Copying of registration is required to support unresolved custom ops.
   node_and_reg.second = *registration;
   execution_plan_.push_back(new_node_index);
+  concurrent_nodes_.clear();
+  offline_memory_plan_.reset();
+  ClearPreparedShapeCache();
   return kTfLiteOk;
 }
 
@@ -759,6 +797,7 @@ TfLiteStatus Subgraph::ResizeInputTensor(int tensor_index,
     TF_LITE_ENSURE_STATUS(UndoAllDelegates());
   }
   state_ = kStateUninvokable;
+  offline_memory_plan_.reset();
   return ResizeTensorImpl(tensor, ConvertVectorToTfLiteIntArray(dims));
 }
 
@@ -865,7 +904,8 @@ TfLiteStatus Subgraph::Invoke() {
     applied_nnapi_delegate_ = true;
   }
 
-  // Invocations are always done in node order.
+  // Invocations are always done in node order, except that nodes which may
+  // run concurrently are run on `inter_op_thread_pool_` when possible.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
   // called.
@@ -876,6 +916,14 @@ TfLiteStatus Subgraph::Invoke() {
       TF_LITE_ENSURE(&context_, next_execution_plan_index_to_prepare_ >=
                                     execution_plan_index);
     }
+    const int last_concurrent_index =
+        concurrent_nodes(execution_plan_index).second;
+    if (CanInvokeConcurrently(execution_plan_index, last_concurrent_index)) {
+      TF_LITE_ENSURE_STATUS(
+          InvokeConcurrently(execution_plan_index, last_concurrent_index));
+      execution_plan_index = last_concurrent_index;
+      continue;
+    }
     int node_index = execution_plan_[execution_plan_index];
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
@@ -1030,6 +1078,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadOnly(
     return kTfLiteError;
   }
 
+  ClearPreparedShapeCache();
   TF_LITE_ENSURE(&context_,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
 
@@ -1086,6 +1135,7 @@ TfLiteStatus Subgraph::SetTensorParametersReadWrite(
         "SetTensorParametersReadWrite is disallowed when graph is immutable.");
     return kTfLiteError;
   }
+  ClearPreparedShapeCache();
   TF_LITE_ENSURE(&context_,
                  tensor_index < context_.tensors_size && tensor_index >= 0);
   size_t required_bytes = 0;
@@ -1129,9 +1179,220 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  concurrent_nodes_.clear();
+  offline_memory_plan_.reset();
+  ClearPreparedShapeCache();
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::SetOfflineMemoryPlan(std::vector<int32_t> offsets) {
+  TF_LITE_ENSURE_EQ(&context_, offsets.size(), tensors_.size());
+  offline_memory_plan_.reset(new OfflineMemoryPlan);
+  offline_memory_plan_->offsets = std::move(offsets);
+  offline_memory_plan_->bytes.reserve(tensors_.size());
+  for (const TfLiteTensor& tensor : tensors_) {
+    offline_memory_plan_->bytes.push_back(tensor.bytes);
+  }
   return kTfLiteOk;
 }
 
+void Subgraph::SetPreparedShapeCacheSize(int cache_size) {
+  prepared_shape_cache_size_ = cache_size;
+  if (cache_size == 0) {
+    ClearPreparedShapeCache();
+    return;
+  }
+  while (prepared_shape_cache_.size() > cache_size) {
+    FreePreparedShapeState(prepared_shape_cache_.back().get(),
+                           /*free_kernel_data=*/true);
+    prepared_shape_cache_.pop_back();
+  }
+}
+
+std::vector<std::vector<int>> Subgraph::GetInputShapes() const {
+  std::vector<std::vector<int>> shapes;
+  shapes.reserve(inputs_.size());
+  for (int tensor_index : inputs_) {
+    const TfLiteIntArray* dims = tensors_[tensor_index].dims;
+    shapes.emplace_back(dims->data, dims->data + dims->size);
+  }
+  return shapes;
+}
+
+bool Subgraph::CanCachePreparedShapes() const {
+  if (prepared_shape_cache_size_ == 0 || !delegates_applied_.empty() ||
+      !pre_delegation_execution_plan_.empty() || has_dynamic_tensors_) {
+    return false;
+  }
+  for (const auto& node_and_reg : nodes_and_registration_) {
+    // Control flow kernels prepare other subgraphs, whose state is not cached.
+    if (node_and_reg.first.delegate != nullptr ||
+        node_and_reg.second.builtin_code == BuiltinOperator_IF ||
+        node_and_reg.second.builtin_code == BuiltinOperator_WHILE) {
+      return false;
+    }
+  }
+  // Only the data of arena tensors can be cached and restored.
+  for (const TfLiteTensor& tensor : tensors_) {
+    if (tensor.allocation_type == kTfLiteDynamic) return false;
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::SwitchPreparedShapeState(bool* restored) {
+  *restored = false;
+  if (prepared_input_shapes_.empty()) return kTfLiteOk;
+  std::vector<std::vector<int>> input_shapes = GetInputShapes();
+  if (input_shapes == prepared_input_shapes_) return kTfLiteOk;
+
+  auto cached = prepared_shape_cache_.begin();
+  while (cached != prepared_shape_cache_.end() &&
+         (*cached)->input_shapes != input_shapes) {
+    ++cached;
+  }
+  std::unique_ptr<PreparedShapeState> restored_state;
+  if (cached != prepared_shape_cache_.end()) {
+    restored_state = std::move(*cached);
+    prepared_shape_cache_.erase(cached);
+  }
+  prepared_shape_cache_.push_front(SavePreparedShapeState());
+
+  if (restored_state) {
+    TF_LITE_ENSURE_STATUS(RestorePreparedShapeState(restored_state.get()));
+    prepared_input_shapes_ = std::move(input_shapes);
+    *restored = true;
+    return kTfLiteOk;
+  }
+
+  // The nodes need kernel data to be prepared for the new shapes. Reuse that
+  // of the least recently used state if the cache is full, so that the graph
+  // doesn't keep growing.
+  if (prepared_shape_cache_.size() > prepared_shape_cache_size_) {
+    FreePreparedShapeState(prepared_shape_cache_.back().get(),
+                           /*free_kernel_data=*/false);
+    prepared_shape_cache_.pop_back();
+  } else {
+    for (auto& node_and_reg : nodes_and_registration_) {
+      TfLiteNode& node = node_and_reg.first;
+      const TfLiteRegistration& registration = node_and_reg.second;
+      if (registration.builtin_code == BuiltinOperator_CUSTOM) {
+        node.user_data =
+            OpInit(registration, static_cast<const char*>(
+                                     node.custom_initial_data),
+                   node.custom_initial_data_size);
+      } else {
+        node.user_data = OpInit(
+            registration, static_cast<const char*>(node.builtin_data), 0);
+      }
+      node.temporaries = TfLiteIntArrayCreate(0);
+    }
+  }
+  prepared_input_shapes_.clear();
+  return kTfLiteOk;
+}
+
+std::unique_ptr<Subgraph::PreparedShapeState>
+Subgraph::SavePreparedShapeState() {
+  std::unique_ptr<PreparedShapeState> state(new PreparedShapeState);
+  state->input_shapes = std::move(prepared_input_shapes_);
+  // The non-persistent arena is allocated again when the state is restored.
+  ReleaseNonPersistentMemory();
+  state->tensor_dims.reserve(tensors_.size());
+  state->tensor_bytes.reserve(tensors_.size());
+  state->tensor_allocation_types.reserve(tensors_.size());
+  state->tensor_data.reserve(tensors_.size());
+  // The inputs have already been resized to the shapes of the next state, and
+  // get the shapes of this state back when it is restored.
+  std::vector<bool> is_input(tensors_.size(), false);
+  for (int tensor_index : inputs_) is_input[tensor_index] = true;
+  for (int i = 0; i < tensors_.size(); ++i) {
+    const TfLiteTensor& tensor = tensors_[i];
+    state->tensor_dims.push_back(is_input[i] ? nullptr
+                                             : TfLiteIntArrayCopy(tensor.dims));
+    state->tensor_bytes.push_back(tensor.bytes);
+    state->tensor_allocation_types.push_back(tensor.allocation_type);
+    state->tensor_data.push_back(tensor.data.raw);
+  }
+  state->node_user_data.reserve(nodes_and_registration_.size());
+  state->node_temporaries.reserve(nodes_and_registration_.size());
+  for (auto& node_and_reg : nodes_and_registration_) {
+    TfLiteNode& node = node_and_reg.first;
+    state->node_user_data.push_back(node.user_data);
+    state->node_temporaries.push_back(node.temporaries);
+    node.user_data = nullptr;
+    node.temporaries = nullptr;
+  }
+  state->memory_planner = std::move(memory_planner_);
+  return state;
+}
+
+TfLiteStatus Subgraph::RestorePreparedShapeState(PreparedShapeState* state) {
+  for (int i = 0; i < tensors_.size(); ++i) {
+    TfLiteTensor& tensor = tensors_[i];
+    if (i >= state->tensor_dims.size()) {
+      // The tensor was added while preparing for other shapes, and is not used
+      // by the restored state.
+      if (tensor.allocation_type == kTfLiteArenaRw ||
+          tensor.allocation_type == kTfLiteArenaRwPersistent) {
+        tensor.data.raw = nullptr;
+      }
+      continue;
+    }
+    if (state->tensor_dims[i] != nullptr) {
+      TfLiteIntArrayFree(tensor.dims);
+      tensor.dims = state->tensor_dims[i];
+      state->tensor_dims[i] = nullptr;
+      tensor.bytes = state->tensor_bytes[i];
+    }
+    tensor.allocation_type = state->tensor_allocation_types[i];
+    if (tensor.allocation_type == kTfLiteArenaRwPersistent) {
+      tensor.data.raw = state->tensor_data[i];
+    }
+  }
+  for (int i = 0; i < nodes_and_registration_.size(); ++i) {
+    TfLiteNode& node = nodes_and_registration_[i].first;
+    node.user_data = state->node_user_data[i];
+    node.temporaries = state->node_temporaries[i];
+  }
+  state->node_user_data.clear();
+  state->node_temporaries.clear();
+  memory_planner_ = std::move(state->memory_planner);
+  TF_LITE_ENSURE_STATUS(memory_planner_->AcquireNonPersistentMemory());
+  next_execution_plan_index_to_prepare_ = execution_plan_.size();
+  next_execution_plan_index_to_plan_allocation_ = execution_plan_.size();
+  has_dynamic_tensors_ = false;
+  return kTfLiteOk;
+}
+
+void Subgraph::FreePreparedShapeState(PreparedShapeState* state,
+                                      bool free_kernel_data) {
+  for (TfLiteIntArray* dims : state->tensor_dims) {
+    if (dims) TfLiteIntArrayFree(dims);
+  }
+  state->tensor_dims.clear();
+  for (int i = 0; i < state->node_user_data.size(); ++i) {
+    TfLiteNode& node = nodes_and_registration_[i].first;
+    if (free_kernel_data) {
+      OpFree(nodes_and_registration_[i].second, state->node_user_data[i]);
+      TfLiteIntArrayFree(state->node_temporaries[i]);
+    } else {
+      node.user_data = state->node_user_data[i];
+      node.temporaries = state->node_temporaries[i];
+    }
+  }
+  state->node_user_data.clear();
+  state->node_temporaries.clear();
+  state->memory_planner.reset();
+}
+
+void Subgraph::ClearPreparedShapeCache() {
+  for (auto& state : prepared_shape_cache_) {
+    FreePreparedShapeState(state.get(), /*free_kernel_data=*/true);
+  }
+  prepared_shape_cache_.clear();
+  prepared_input_shapes_.clear();
+}
+
 TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
                                         TfLiteIntArray* new_size) {
   // Note that in theory we could resize kTfLiteArenaRwPersistent tensors too.
@@ -1169,6 +1430,173 @@ TfLiteStatus Subgraph::ResizeTensorImpl(TfLiteTensor* tensor,
   return kTfLiteOk;
 }
 
+void Subgraph::SetInterOpThreadPool(InterOpThreadPool* pool) {
+  if (pool == inter_op_thread_pool_) return;
+  inter_op_thread_pool_ = pool;
+  state_ = kStateUninvokable;
+  ClearPreparedShapeCache();
+}
+
+bool Subgraph::MayRunConcurrently(
+    const TfLiteNode& node, const TfLiteRegistration& registration) const {
+  if (node.delegate != nullptr ||
+      registration.builtin_code == BuiltinOperator_CUSTOM ||
+      registration.builtin_code == BuiltinOperator_DELEGATE ||
+      registration.builtin_code == BuiltinOperator_IF ||
+      registration.builtin_code == BuiltinOperator_WHILE) {
+    return false;
+  }
+  for (const TfLiteIntArray* tensors : {node.inputs, node.outputs}) {
+    for (int i = 0; i < tensors->size; ++i) {
+      const int tensor_index = tensors->data[i];
+      if (tensor_index != kTfLiteOptionalTensor &&
+          tensors_[tensor_index].is_variable) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::ScheduleConcurrentNodes() {
+  concurrent_nodes_.clear();
+  if (inter_op_thread_pool_ == nullptr) return kTfLiteOk;
+
+  // The level of a node is one more than the highest level of the nodes that
+  // produce its inputs, so nodes with the same level don't depend on each
+  // other. Nodes that may not run concurrently get a level of their own, above
+  // the levels of all nodes before them in the execution plan, and below those
+  // of all nodes after them.
+  std::vector<int> tensor_levels(tensors_.size(), -1);
+  std::vector<int> node_levels(execution_plan_.size());
+  int max_level = -1;
+  int exclusive_level = -1;
+  for (int i = 0; i < execution_plan_.size(); ++i) {
+    const int node_index = execution_plan_[i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    const TfLiteRegistration& registration =
+        nodes_and_registration_[node_index].second;
+    int level = exclusive_level + 1;
+    if (MayRunConcurrently(node, registration)) {
+      for (int j = 0; j < node.inputs->size; ++j) {
+        const int tensor_index = node.inputs->data[j];
+        if (tensor_index != kTfLiteOptionalTensor) {
+          level = std::max(level, tensor_levels[tensor_index] + 1);
+        }
+      }
+    } else {
+      level = max_level + 1;
+      exclusive_level = level;
+    }
+    for (int j = 0; j < node.outputs->size; ++j) {
+      const int tensor_index = node.outputs->data[j];
+      if (tensor_index != kTfLiteOptionalTensor) {
+        tensor_levels[tensor_index] = level;
+      }
+    }
+    node_levels[i] = level;
+    max_level = std::max(max_level, level);
+  }
+
+  // Sorting by level keeps dependencies in order, and makes the nodes of each
+  // level adjacent.
+  std::vector<int> order(execution_plan_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&node_levels](int a, int b) {
+    return node_levels[a] < node_levels[b];
+  });
+  std::vector<int> new_plan;
+  new_plan.reserve(execution_plan_.size());
+  for (int i : order) {
+    new_plan.push_back(execution_plan_[i]);
+  }
+  if (new_plan != execution_plan_) {
+    execution_plan_ = std::move(new_plan);
+    offline_memory_plan_.reset();
+    if (memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
+  }
+
+  concurrent_nodes_.resize(order.size());
+  int first = 0;
+  for (int i = 1; i <= order.size(); ++i) {
+    if (i == order.size() ||
+        node_levels[order[i]] != node_levels[order[first]]) {
+      std::fill(concurrent_nodes_.begin() + first,
+                concurrent_nodes_.begin() + i, std::make_pair(first, i - 1));
+      first = i;
+    }
+  }
+  return kTfLiteOk;
+}
+
+bool Subgraph::CanInvokeConcurrently(int first_execution_plan_index,
+                                     int last_execution_plan_index) const {
+  // Nodes run concurrently only once all of them have been prepared, and only
+  // if none of them may resize its outputs.
+  if (first_execution_plan_index >= last_execution_plan_index ||
+      concurrent_nodes(first_execution_plan_index).first !=
+          first_execution_plan_index ||
+      last_execution_plan_index >= next_execution_plan_index_to_prepare_ ||
+      profiler_) {
+    return false;
+  }
+  for (int i = first_execution_plan_index; i <= last_execution_plan_index;
+       ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    if (HasDynamicTensor(context_, node.outputs)) return false;
+  }
+  return true;
+}
+
+TfLiteStatus Subgraph::InvokeConcurrently(int first_execution_plan_index,
+                                          int last_execution_plan_index) {
+  // Several nodes may read the same input, so stale delegate data is copied
+  // before any of them runs.
+  for (int i = first_execution_plan_index; i <= last_execution_plan_index;
+       ++i) {
+    const TfLiteNode& node = nodes_and_registration_[execution_plan_[i]].first;
+    for (int j = 0; j < node.inputs->size; ++j) {
+      int tensor_index = node.inputs->data[j];
+      if (tensor_index == kTfLiteOptionalTensor) {
+        continue;
+      }
+      TfLiteTensor* tensor = &tensors_[tensor_index];
+      if (tensor->delegate && tensor->delegate != node.delegate &&
+          tensor->data_is_stale) {
+        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+      }
+    }
+  }
+
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+
+  EnsureTensorsVectorCapacity();
+  const int num_nodes =
+      last_execution_plan_index - first_execution_plan_index + 1;
+  std::vector<TfLiteStatus> statuses(num_nodes, kTfLiteOk);
+  inter_op_thread_pool_->ParallelFor(num_nodes, [&](int i) {
+    const int node_index = execution_plan_[first_execution_plan_index + i];
+    statuses[i] = OpInvoke(nodes_and_registration_[node_index].second,
+                           &nodes_and_registration_[node_index].first);
+  });
+
+  for (int i = 0; i < num_nodes; ++i) {
+    if (statuses[i] == kTfLiteError) {
+      const int node_index = execution_plan_[first_execution_plan_index + i];
+      return ReportOpError(&context_, nodes_and_registration_[node_index].first,
+                           nodes_and_registration_[node_index].second,
+                           node_index, "failed to invoke");
+    }
+  }
+  return kTfLiteOk;
+}
+
 void Subgraph::UseNNAPI(bool enable) {
   // Note that there is no way to disable the delegate once it modified the
   // graph.
@@ -1215,6 +1643,8 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Return early if there is nothing to reset to.
   if (pre_delegation_execution_plan_.empty()) return kTfLiteOk;
 
+  ClearPreparedShapeCache();
+
   // First free all delegate nodes.
   for (int execution_plan_index = 0;
        execution_plan_index < execution_plan_.size(); ++execution_plan_index) {
@@ -1229,6 +1659,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  concurrent_nodes_.clear();
 
   // Delegate nodes are appended to nodes_and_registration_. Therefore,
   // cleanup nodes_and_registration_ to only contain nodes from
@@ -1273,6 +1704,8 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegate(TfLiteDelegate* delegate) {
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(),
                                        "ModifyGraphWithDelegate");
 
+  ClearPreparedShapeCache();
+
   // Restore delegation state if applicable.
   TF_LITE_ENSURE_STATUS(RedoAllDelegates());
 
@@ -16,7 +16,9 @@ limitations under the License.
 #define TENSORFLOW_LITE_CORE_SUBGRAPH_H_
 
 #include <cstdlib>
+#include <list>
 #include <map>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -26,6 +28,7 @@ limitations under the License.
 #include "tensorflow/lite/core/macros.h"
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/util.h"
 
@@ -35,6 +38,8 @@ limitations under the License.
 
 namespace tflite {
 
+class InterOpThreadPool;
+
 namespace impl {
 
 // Forward declare since NNAPIDelegate uses Interpreter.
@@ -245,6 +250,45 @@ class Subgraph {
 
   void UseNNAPI(bool enable);
 
+  // Sets the pool on which nodes that don't depend on each other are run
+  // concurrently, or nullptr to run nodes one at a time. The pool is not
+  // owned. AllocateTensors() needs to be called before next invocation.
+  // WARNING: This is an experimental API and subject to change.
+  void SetInterOpThreadPool(InterOpThreadPool* pool);
+
+  // Returns the range [first, last] of the execution plan indices of the
+  // nodes that may run concurrently with the one at `execution_plan_index`.
+  std::pair<int, int> concurrent_nodes(int execution_plan_index) const {
+    if (execution_plan_index < static_cast<int>(concurrent_nodes_.size())) {
+      return concurrent_nodes_[execution_plan_index];
+    }
+    return {execution_plan_index, execution_plan_index};
+  }
+
+  // Sets how many prepared states for other input shapes are kept. With a
+  // non-zero size, AllocateTensors() after ResizeInputTensor() to shapes that
+  // were prepared before restores the tensor shapes, arena plan and kernel
+  // data of that state instead of preparing all nodes again. Each kept state
+  // holds its own persistent arena and kernel data. Graphs with delegates,
+  // control flow or dynamic tensors are never cached. 0, the default,
+  // disables the cache.
+  // WARNING: This is an experimental API and subject to change.
+  void SetPreparedShapeCacheSize(int cache_size);
+
+  // Sets the arena offsets of the tensors of this subgraph computed by an
+  // offline memory planner, with -1 for tensors left to the online planner.
+  // The current sizes of the tensors are recorded along with the offsets, and
+  // the plan is dropped once the execution plan or the shape of an input
+  // changes.
+  // WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetOfflineMemoryPlan(std::vector<int32_t> offsets);
+
+  // Returns the offline memory plan, or nullptr if there is none or it may not
+  // match the current execution plan.
+  const OfflineMemoryPlan* offline_memory_plan() const {
+    return concurrent_nodes_.empty() ? offline_memory_plan_.get() : nullptr;
+  }
+
   // Return the subgraph specific context.
   TfLiteContext* context() { return &context_; }
 
@@ -409,6 +453,72 @@ class Subgraph {
   TfLiteStatus PrepareOpsStartingAt(int first_execution_plan_index,
                                     int* last_execution_plan_index_prepared);
 
+  // The prepared state of the graph for one set of input shapes, which is
+  // kept while the graph is prepared for other shapes.
+  struct PreparedShapeState {
+    // The shapes of the inputs the state was prepared for.
+    std::vector<std::vector<int>> input_shapes;
+    // The dims, owned by the state, size, allocation type and data of each
+    // tensor. Only the data of persistent arena tensors is used.
+    std::vector<TfLiteIntArray*> tensor_dims;
+    std::vector<size_t> tensor_bytes;
+    std::vector<TfLiteAllocationType> tensor_allocation_types;
+    std::vector<char*> tensor_data;
+    // The user data and temporaries, owned by the state, of each node.
+    std::vector<void*> node_user_data;
+    std::vector<TfLiteIntArray*> node_temporaries;
+    // The planner holding the arenas of the state.
+    std::unique_ptr<MemoryPlanner> memory_planner;
+  };
+
+  // Returns the shapes of the inputs of the graph.
+  std::vector<std::vector<int>> GetInputShapes() const;
+
+  // Returns true if the prepared states of the graph may be cached.
+  bool CanCachePreparedShapes() const;
+
+  // Called by AllocateTensors() before preparing the nodes. Moves the current
+  // prepared state to the cache, and then either restores the state cached
+  // for the current input shapes, setting `restored` to true, or provides the
+  // nodes with kernel data to be prepared with.
+  TfLiteStatus SwitchPreparedShapeState(bool* restored);
+
+  // Moves the current prepared state of the graph out of the nodes, tensors
+  // and memory planner.
+  std::unique_ptr<PreparedShapeState> SavePreparedShapeState();
+
+  // Makes `state` the current prepared state of the graph.
+  TfLiteStatus RestorePreparedShapeState(PreparedShapeState* state);
+
+  // Releases the data of `state`. The kernel data is released if
+  // `free_kernel_data` is true, and otherwise moved back into the nodes.
+  void FreePreparedShapeState(PreparedShapeState* state, bool free_kernel_data);
+
+  // Releases all cached prepared states.
+  void ClearPreparedShapeCache();
+
+  // Reorders the execution plan so that the nodes which may run concurrently
+  // are adjacent, and fills `concurrent_nodes_`. Nodes are grouped by their
+  // depth in the graph, except for those that may not run concurrently with
+  // any other node, which form groups of their own.
+  TfLiteStatus ScheduleConcurrentNodes();
+
+  // Returns true if the node may run concurrently with other nodes, i.e. it is
+  // a builtin op that is not delegated, doesn't invoke other subgraphs and
+  // doesn't touch variable tensors.
+  bool MayRunConcurrently(const TfLiteNode& node,
+                          const TfLiteRegistration& registration) const;
+
+  // Returns true if the nodes at execution plan indices [first, last] can be
+  // invoked concurrently now.
+  bool CanInvokeConcurrently(int first_execution_plan_index,
+                             int last_execution_plan_index) const;
+
+  // Invokes the nodes at execution plan indices [first, last] concurrently on
+  // `inter_op_thread_pool_`.
+  TfLiteStatus InvokeConcurrently(int first_execution_plan_index,
+                                  int last_execution_plan_index);
+
   // Tensors needed by the interpreter. Use `AddTensors` to add more blank
   // tensor entries. Note, `tensors_.data()` needs to be synchronized to the
   // `context_` whenever this std::vector is reallocated. Currently this
@@ -627,6 +737,25 @@ class Subgraph {
   // subset of the node indices.
   std::vector<int> execution_plan_;
 
+  // The pool that runs nodes concurrently, or nullptr. Not owned.
+  InterOpThreadPool* inter_op_thread_pool_ = nullptr;
+
+  // For each execution plan index, the range of execution plan indices of the
+  // nodes that may run concurrently with it. Empty if nodes run one at a time.
+  std::vector<std::pair<int, int>> concurrent_nodes_;
+
+  // The layout of the arena computed by an offline memory planner, or nullptr.
+  std::unique_ptr<OfflineMemoryPlan> offline_memory_plan_;
+
+  // The maximum number of cached prepared states, and the states themselves,
+  // the most recently used first.
+  int prepared_shape_cache_size_ = 0;
+  std::list<std::unique_ptr<PreparedShapeState>> prepared_shape_cache_;
+
+  // The input shapes of the current prepared state, or empty if it may not be
+  // cached.
+  std::vector<std::vector<int>> prepared_input_shapes_;
+
   // This is a copy of the first execution_plan_ before any delegates were
   // applied. It is empty if no delegates were applied to this Subgraph.
   std::vector<int> pre_delegation_execution_plan_;
@@ -17,6 +17,7 @@ limitations under the License.
 #include "flatbuffers/flexbuffers.h"  // from @flatbuffers
 #include "tensorflow/core/common_runtime/eager/context.h"
 #include "tensorflow/core/common_runtime/eager/execute.h"
+#include "tensorflow/core/common_runtime/eager/kernel_and_device.h"
 #include "tensorflow/core/common_runtime/eager/tensor_handle.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -108,7 +109,8 @@ class OpInputs {
 };
 
 // A list of outputs of a given node of the TensorFlow/Eager graph, along with
-// the actual outputs of the EagerOperation.
+// the actual outputs of the EagerOperation, or of the kernel when it is run
+// directly.
 class OpOutputs {
  public:
   explicit OpOutputs(const TfLiteIntArray* indexes) {
@@ -165,10 +167,24 @@ class OpOutputs {
     return &vector_;
   }
 
+  // Returns a given kernel output tensor and, optionally, removes it from the
+  // internal vector.
+  tensorflow::Tensor GetTensor(int i, bool remove) {
+    if (!remove) {
+      return tensors_[i];
+    }
+    tensorflow::Tensor tensor = std::move(tensors_[i]);
+    tensors_[i] = tensorflow::Tensor();
+    return tensor;
+  }
+
+  std::vector<tensorflow::Tensor>* GetTensors() { return &tensors_; }
+
  private:
   std::vector<int> outputs_;
   std::vector<bool> subgraph_outputs_;
   tensorflow::gtl::InlinedVector<tensorflow::TensorHandle*, 2> vector_;
+  std::vector<tensorflow::Tensor> tensors_;
 };
 
 // A single node within the larger 'op'. Note that this kernel executes many
@@ -200,6 +216,8 @@ class OpNode {
 
   tensorflow::EagerOperation* op() { return op_.get(); }
 
+  tensorflow::KernelAndDeviceOp* kernel() { return kernel_.get(); }
+
   tensorflow::Status InitializeNodeDef(const void* custom_initial_data,
                                        int custom_initial_data_size) {
     if (!custom_initial_data) {
@@ -255,6 +273,29 @@ class OpNode {
     return tensorflow::Status::OK();
   }
 
+  // Instantiates the kernel of the op on the host CPU, so that it can be run
+  // directly instead of being dispatched through EagerExecute, which selects
+  // a device, looks up the kernel cache and wraps every input and output in a
+  // TensorHandle on each invocation.
+  tensorflow::Status BuildKernel(tensorflow::EagerContext* eager_context) {
+    if (kernel_) {
+      return tensorflow::Status::OK();
+    }
+    tensorflow::Device* device = eager_context->HostCPU();
+    tensorflow::FunctionLibraryRuntime* flr = eager_context->func_lib(device);
+    auto* runner = (flr != nullptr && flr->runner() != nullptr)
+                       ? flr->runner()
+                       : eager_context->runner();
+    std::unique_ptr<tensorflow::KernelAndDeviceOp> kernel(
+        new tensorflow::KernelAndDeviceOp(
+            eager_context->GetRendezvous(), eager_context->LogMemory(), flr,
+            runner, eager_context->GetCollectiveExecutorHandle(), device));
+    TF_RETURN_IF_ERROR(kernel->Init(op_->MutableAttrs()->BuildNodeDef(),
+                                    /*graph_collector=*/nullptr));
+    kernel_ = std::move(kernel);
+    return tensorflow::Status::OK();
+  }
+
   void ClearEagerInputs() {
     for (tensorflow::TensorHandle* h : *op_->MutableInputs()) {
       if (h) h->Unref();
@@ -290,6 +331,67 @@ class OpNode {
     return tensorflow::Status::OK();
   }
 
+  tensorflow::Status BuildKernelInputs(const BufferMap* buffer_map) {
+    if (kernel_->kernel()->num_inputs() != inputs_.Size()) {
+      return tensorflow::errors::InvalidArgument(
+          "Expected ", kernel_->kernel()->num_inputs(), " inputs but got ",
+          inputs_.Size());
+    }
+    kernel_inputs_.resize(inputs_.Size());
+    for (int i = 0; i < inputs_.Size(); ++i) {
+      int input_index = inputs_.TfLiteIndex(i);
+      TensorSource s = inputs_.GetTensorSource(i);
+      if (!s.node) {
+        if (!buffer_map->HasTensor(input_index)) {
+          return tensorflow::errors::Internal(
+              "Cannot read from invalid tensor index ", input_index);
+        }
+        kernel_inputs_[i] = buffer_map->GetTensor(input_index);
+      } else {
+        // As with the handles above, taking a forwardable tensor out of the
+        // previous op's outputs lets TF reuse its buffer.
+        kernel_inputs_[i] = s.node->outputs_.GetTensor(
+            s.node_output_index, inputs_.IsForwardable(i));
+      }
+      if (kernel_inputs_[i].dtype() != kernel_->kernel()->input_type(i)) {
+        return tensorflow::errors::InvalidArgument(
+            "Expected input ", i, " of type ",
+            tensorflow::DataTypeString(kernel_->kernel()->input_type(i)),
+            " but got ", tensorflow::DataTypeString(kernel_inputs_[i].dtype()));
+      }
+    }
+    return tensorflow::Status::OK();
+  }
+
+  tensorflow::Status RunKernel() {
+    tensorflow::gtl::InlinedVector<tensorflow::TensorValue, 4> values;
+    values.reserve(kernel_inputs_.size());
+    for (tensorflow::Tensor& tensor : kernel_inputs_) {
+      values.emplace_back(&tensor);
+    }
+    tensorflow::EagerKernelArgs args(std::move(values));
+    tensorflow::Status status =
+        kernel_->Run(args, outputs_.GetTensors(),
+                     /*cancellation_manager=*/nullptr,
+                     /*remote_func_params=*/absl::nullopt);
+    kernel_inputs_.clear();
+    return status;
+  }
+
+  tensorflow::Status PersistKernelOutputs(BufferMap* buffer_map) {
+    auto* tensors = outputs_.GetTensors();
+    if (static_cast<int>(tensors->size()) != outputs_.Size()) {
+      return tensorflow::errors::Internal(
+          "Unexpected number of outputs from kernel");
+    }
+    for (int i = 0; i < outputs_.Size(); ++i) {
+      if (outputs_.IsSubgraphOutput(i)) {
+        buffer_map->SetFromTensorFlow(outputs_.TfLiteIndex(i), (*tensors)[i]);
+      }
+    }
+    return tensorflow::Status::OK();
+  }
+
   tensorflow::Status PersistEagerOutputs(BufferMap* buffer_map) {
     auto* handles = outputs_.GetTensorHandles();
     for (int i = 0; i < outputs_.Size(); ++i) {
@@ -318,6 +420,10 @@ class OpNode {
   OpOutputs outputs_;
 
   std::unique_ptr<tensorflow::EagerOperation> op_;
+  // The instantiated kernel of the op, when it is run directly, and the
+  // inputs of its current run.
+  std::unique_ptr<tensorflow::KernelAndDeviceOp> kernel_;
+  std::vector<tensorflow::Tensor> kernel_inputs_;
 };
 
 // Executes the TensorFlow op given by 'op_name', with the attributes specified
@@ -348,10 +454,25 @@ tensorflow::Status ExecuteFlexOp(TfLiteContext* context, BufferMap* buffer_map,
   return tensorflow::Status::OK();
 }
 
+// Runs the kernel instantiated for the op by OpNode::BuildKernel(). Inputs and
+// outputs are given as indices into the 'buffer_map'.
+tensorflow::Status ExecuteFlexKernel(TfLiteContext* context,
+                                     BufferMap* buffer_map, OpNode* node_data) {
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(node_data->BuildKernelInputs(buffer_map),
+                                  " (while executing '", node_data->name(),
+                                  "' via its kernel)");
+  TF_RETURN_WITH_CONTEXT_IF_ERROR(node_data->RunKernel(), " (while executing '",
+                                  node_data->name(), "' via its kernel)");
+  return node_data->PersistKernelOutputs(buffer_map);
+}
+
 // The larger 'op', which contains all the nodes in a supported subgraph.
 struct OpData {
   tensorflow::EagerContext* eager_context;
   BufferMap* buffer_map;
+  // Whether the kernels of all the nodes were instantiated in Prepare(), in
+  // which case they are run directly instead of through EagerExecute.
+  bool use_kernels = false;
   std::vector<std::unique_ptr<OpNode>> nodes;
   std::vector<int> subgraph_inputs;
   std::vector<int> subgraph_outputs;
@@ -440,7 +561,7 @@ void Free(TfLiteContext* context, void* buffer) {
 }
 
 TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
-  const auto* op_data = reinterpret_cast<OpData*>(node->user_data);
+  auto* op_data = reinterpret_cast<OpData*>(node->user_data);
   TF_LITE_ENSURE_MSG(
       context, op_data->eager_context != nullptr,
       "Failed to initialize eager context. This often happens when a CPU "
@@ -497,6 +618,17 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     }
   }
 
+  // Ops whose kernels can't be instantiated on the CPU ahead of time (for
+  // instance functions) keep the whole subgraph on the EagerExecute path.
+  if (!op_data->use_kernels) {
+    tensorflow::Status status;
+    for (auto& node_data : op_data->nodes) {
+      status = node_data->BuildKernel(op_data->eager_context);
+      if (!status.ok()) break;
+    }
+    op_data->use_kernels = status.ok();
+  }
+
   return kTfLiteOk;
 }
 
@@ -524,7 +656,10 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
         reinterpret_cast<Profiler*>(context->profiler),
         node_data->name().c_str(), node_data->index());
 
-    auto status = ExecuteFlexOp(context, buffer_map, node_data.get());
+    auto status =
+        op_data->use_kernels
+            ? ExecuteFlexKernel(context, buffer_map, node_data.get())
+            : ExecuteFlexOp(context, buffer_map, node_data.get());
     TF_LITE_ENSURE_OK(context, ConvertStatus(context, status));
   }
 
@@ -20,6 +20,8 @@ limitations under the License.
 #include <thread>  // NOLINT(build/c++11)
 #include <vector>
 
+#include <EGL/egl.h>
+#include "absl/container/flat_hash_map.h"
 #include "absl/memory/memory.h"
 #include "absl/types/span.h"
 #include "tensorflow/lite/builtin_ops.h"
@@ -74,6 +76,14 @@ class Delegate {
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
 
+  void BindGlBufferToTensor(GLuint buffer, int tensor_index) {
+    gl_buffers_[tensor_index] = buffer;
+  }
+  // User-owned GL buffers by the index of the tensor they are bound to.
+  const absl::flat_hash_map<int, GLuint>& gl_buffers() const {
+    return gl_buffers_;
+  }
+
  private:
   TfLiteDelegate delegate_ = {
       .data_ = reinterpret_cast<void*>(this),
@@ -85,13 +95,15 @@ class Delegate {
   };
 
   TfLiteGpuDelegateOptionsV2 options_;
+  absl::flat_hash_map<int, GLuint> gl_buffers_;
 };
 
 // Represent the execution of a subset of nodes on GPU.
 class DelegateKernel {
  public:
-  explicit DelegateKernel(const TfLiteGpuDelegateOptionsV2& options)
-      : options_(options) {}
+  DelegateKernel(const TfLiteGpuDelegateOptionsV2& options,
+                 const absl::flat_hash_map<int, GLuint>& gl_buffers)
+      : options_(options), gl_buffers_(gl_buffers) {}
 
   absl::Status Prepare(TfLiteContext* context,
                        const TfLiteDelegateParams* delegate_params) {
@@ -153,7 +165,22 @@ class DelegateKernel {
                                                   GetObjectDef(tensor_index)));
     }
 
-    return builder->Build(&runner_);
+    RETURN_IF_ERROR(builder->Build(&runner_));
+
+    // User-owned buffers don't change between invocations, so set them once.
+    input_cpu_memory_.resize(input_indices_.size());
+    for (int i = 0; i < input_indices_.size(); ++i) {
+      if (!IsBoundToGlBuffer(input_indices_[i])) continue;
+      RETURN_IF_ERROR(runner_->SetInputObject(
+          i, OpenGlBuffer(gl_buffers_.at(input_indices_[i]))));
+    }
+    output_cpu_memory_.resize(output_indices_.size());
+    for (int i = 0; i < output_indices_.size(); ++i) {
+      if (!IsBoundToGlBuffer(output_indices_[i])) continue;
+      RETURN_IF_ERROR(runner_->SetOutputObject(
+          i, OpenGlBuffer(gl_buffers_.at(output_indices_[i]))));
+    }
+    return absl::OkStatus();
   }
 
   absl::Status Invoke(TfLiteContext* context) {
@@ -172,28 +199,46 @@ class DelegateKernel {
   }
 
  private:
+  // Sets the CPU memory of the tensors that aren't bound to GL buffers, but
+  // only if it moved since the last invocation.
   absl::Status SetInputsAndOutputs(TfLiteContext* context) {
     for (int i = 0; i < input_indices_.size(); ++i) {
-      RETURN_IF_ERROR(runner_->SetInputObject(
-          i, GetTensorObject(input_indices_[i], context)));
+      if (IsBoundToGlBuffer(input_indices_[i])) continue;
+      const CpuMemory memory = GetCpuMemory(input_indices_[i], context);
+      if (IsSameCpuMemory(memory, input_cpu_memory_[i])) continue;
+      RETURN_IF_ERROR(runner_->SetInputObject(i, memory));
+      input_cpu_memory_[i] = memory;
     }
     for (int i = 0; i < output_indices_.size(); ++i) {
-      RETURN_IF_ERROR(runner_->SetOutputObject(
-          i, GetTensorObject(output_indices_[i], context)));
+      if (IsBoundToGlBuffer(output_indices_[i])) continue;
+      const CpuMemory memory = GetCpuMemory(output_indices_[i], context);
+      if (IsSameCpuMemory(memory, output_cpu_memory_[i])) continue;
+      RETURN_IF_ERROR(runner_->SetOutputObject(i, memory));
+      output_cpu_memory_[i] = memory;
     }
     return absl::OkStatus();
   }
 
+  bool IsBoundToGlBuffer(int index) const {
+    return gl_buffers_.find(index) != gl_buffers_.end();
+  }
+
+  static bool IsSameCpuMemory(const CpuMemory& a, const CpuMemory& b) {
+    return a.data == b.data && a.size_bytes == b.size_bytes;
+  }
+
   ObjectDef GetObjectDef(int index) const {
     ObjectDef default_object_def;
     default_object_def.data_type = DataType::FLOAT32;
     default_object_def.data_layout = DataLayout::BHWC;
-    default_object_def.object_type = ObjectType::CPU_MEMORY;
+    default_object_def.object_type = IsBoundToGlBuffer(index)
+                                         ? ObjectType::OPENGL_SSBO
+                                         : ObjectType::CPU_MEMORY;
     default_object_def.user_provided = true;
     return default_object_def;
   }
 
-  TensorObject GetTensorObject(int index, TfLiteContext* context) const {
+  CpuMemory GetCpuMemory(int index, TfLiteContext* context) const {
     auto& tensor = context->tensors[index];
     return MakeCpuMemory(absl::MakeSpan(tensor.data.raw, tensor.bytes));
   }
@@ -203,6 +248,11 @@ class DelegateKernel {
                                    bool* graph_is_destroyed) {
     *graph_is_destroyed = false;
     cl::InferenceEnvironmentOptions env_options;
+    if (!gl_buffers_.empty()) {
+      // Share the GL buffers with OpenCL through the current EGL context.
+      env_options.egl_display = eglGetCurrentDisplay();
+      env_options.egl_context = eglGetCurrentContext();
+    }
     cl::InferenceEnvironmentProperties properties;
     RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
                                                 &properties));
@@ -252,11 +302,15 @@ class DelegateKernel {
   // Shared across all DelegateKernel instances, passed by the Delegate
   // instance.
   const TfLiteGpuDelegateOptionsV2& options_;
+  const absl::flat_hash_map<int, GLuint> gl_buffers_;
   std::unique_ptr<cl::InferenceEnvironment> cl_environment_;
   std::unique_ptr<gl::InferenceEnvironment> gl_environment_;
   std::unique_ptr<InferenceRunner> runner_;
   std::vector<int64_t> input_indices_;
   std::vector<int64_t> output_indices_;
+  // CPU memory last set for each input and output, if not bound to a buffer.
+  std::vector<CpuMemory> input_cpu_memory_;
+  std::vector<CpuMemory> output_cpu_memory_;
   std::thread::id thread_id_prepare_;  // thread id used for Prapare()
   bool enforce_same_thread_ = false;   // flag to enforce same thread for Invoke
 };
@@ -278,8 +332,8 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
         auto* gpu_delegate = GetDelegate(params->delegate);
         // Everything below should happen in prepare function call, but TFLite
         // for whatever reason forbids that.
-        auto gpu_delegate_kernel =
-            absl::make_unique<DelegateKernel>(gpu_delegate->options());
+        auto gpu_delegate_kernel = absl::make_unique<DelegateKernel>(
+            gpu_delegate->options(), gpu_delegate->gl_buffers());
         const auto status = gpu_delegate_kernel->Prepare(context, params);
         if (!status.ok()) {
           context->ReportError(context, "TfLiteGpuDelegate Init: %s",
@@ -300,9 +354,8 @@ TfLiteStatus DelegatePrepare(TfLiteContext* context, TfLiteDelegate* delegate) {
               "TfLiteGpuDelegate Prepare: delegate is not initialized");
           return kTfLiteError;
         }
-        // TODO(akulik): tflite tensors are not allocated here either. It would
-        // be good to set inputs and outputs only once here instead of setting
-        // them every time in .invoke.
+        // Tflite tensors are not allocated here either, so .invoke sets the
+        // CPU memory of inputs and outputs whenever it has moved.
         return kTfLiteOk;
       },
       // .invoke
@@ -354,3 +407,12 @@ TfLiteDelegate* TfLiteGpuDelegateV2Create(
 void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate) {
   delete tflite::gpu::GetDelegate(delegate);
 }
+
+TfLiteStatus TfLiteGpuDelegateV2BindGlBufferToTensor(TfLiteDelegate* delegate,
+                                                     uint32_t gl_buffer,
+                                                     int tensor_index) {
+  auto* gpu_delegate = tflite::gpu::GetDelegate(delegate);
+  if (!gpu_delegate || tensor_index < 0) return kTfLiteError;
+  gpu_delegate->BindGlBufferToTensor(gl_buffer, tensor_index);
+  return kTfLiteOk;
+}
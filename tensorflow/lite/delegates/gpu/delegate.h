@@ -118,6 +118,19 @@ TFL_CAPI_EXPORT TfLiteDelegate* TfLiteGpuDelegateV2Create(
 // Destroys a delegate created with `TfLiteGpuDelegateV2Create` call.
 TFL_CAPI_EXPORT void TfLiteGpuDelegateV2Delete(TfLiteDelegate* delegate);
 
+// Binds a user-owned OpenGL shader storage buffer object to an input or an
+// output tensor, which the delegate then reads from or writes to directly
+// instead of the tensor's CPU memory, so that no copy through the CPU is
+// needed. The buffer holds the float32 tensor in the same BHWC layout as the
+// CPU tensor, must belong to the EGL context that is current when the graph
+// is modified, and must outlive the delegate. With bound buffers, OpenCL runs
+// with GL interoperability on that context, or OpenGL on the context itself.
+// The CPU memory of a bound tensor is neither read nor written.
+//
+// *** Must be called *before* `Interpreter::ModifyGraphWithDelegate`. ***
+TFL_CAPI_EXPORT TfLiteStatus TfLiteGpuDelegateV2BindGlBufferToTensor(
+    TfLiteDelegate* delegate, uint32_t gl_buffer, int tensor_index);
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
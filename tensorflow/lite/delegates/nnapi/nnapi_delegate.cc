@@ -4028,6 +4028,62 @@ std::unique_ptr<TfLiteIntArray, TfLiteIntArrayDeleter> BuildTfLiteIntArray(
   std::copy(data.begin(), data.end(), result->data);
   return result;
 }
+
+// Returns a rough estimate of the work done by a node: the number of
+// multiply-accumulates of convolutions and fully connected layers, and the
+// number of output elements of the other ops.
+int64_t EstimateNodeCost(TfLiteContext* context, int node_index) {
+  TfLiteNode* node;
+  TfLiteRegistration* registration;
+  if (context->GetNodeAndRegistration(context, node_index, &node,
+                                      &registration) != kTfLiteOk) {
+    return 0;
+  }
+  int64_t output_elements = 0;
+  for (int tensor_index : TfLiteIntArrayView(node->outputs)) {
+    if (tensor_index != kTfLiteOptionalTensor) {
+      output_elements += NumElements(&context->tensors[tensor_index]);
+    }
+  }
+  // The number of multiply-accumulates per output element is read from the
+  // weights, which are laid out as [out, ..., in] for all these ops, except
+  // for depthwise convolutions, which have one input channel per output.
+  int64_t macs_per_output = 1;
+  switch (registration->builtin_code) {
+    case kTfLiteBuiltinConv2d:
+    case kTfLiteBuiltinDepthwiseConv2d:
+    case kTfLiteBuiltinFullyConnected:
+    case kTfLiteBuiltinTransposeConv: {
+      const int weights_index = 1;
+      if (weights_index >= node->inputs->size ||
+          node->inputs->data[weights_index] == kTfLiteOptionalTensor) {
+        break;
+      }
+      const TfLiteIntArray* dims =
+          context->tensors[node->inputs->data[weights_index]].dims;
+      const int end_dim =
+          registration->builtin_code == kTfLiteBuiltinDepthwiseConv2d
+              ? dims->size - 1
+              : dims->size;
+      for (int i = 1; i < end_dim; ++i) {
+        macs_per_output *= dims->data[i];
+      }
+    } break;
+    default:
+      break;
+  }
+  return output_elements * std::max<int64_t>(macs_per_output, 1);
+}
+
+// Returns the sum of the estimated costs of the nodes of a partition.
+int64_t EstimatePartitionCost(TfLiteContext* context,
+                              const TfLiteDelegateParams& partition_params) {
+  int64_t cost = 0;
+  for (int node_index : TfLiteIntArrayView(partition_params.nodes_to_replace)) {
+    cost += EstimateNodeCost(context, node_index);
+  }
+  return cost;
+}
 }  // namespace
 
 // static
@@ -4083,7 +4139,7 @@ TfLiteStatus StatefulNnApiDelegate::GetNodesSupportedByAccelerator(
 
 // static
 TfLiteStatus StatefulNnApiDelegate::LimitDelegatedPartitions(
-    int max_partitions,
+    TfLiteContext* context, int max_partitions,
     std::vector<TfLiteDelegateParams> partition_params_array,
     std::vector<int>* nodes_to_delegate) {
   int num_partitions = partition_params_array.size();
@@ -4100,18 +4156,34 @@ TfLiteStatus StatefulNnApiDelegate::LimitDelegatedPartitions(
       });
 
   if (number_delegated_partitions > max_partitions) {
-    std::sort(partition_params_array.begin(), partition_params_array.end(),
-              [](const TfLiteDelegateParams& left,
-                 const TfLiteDelegateParams& right) -> bool {
-                // Reverse sort
-                return left.nodes_to_replace->size >
-                       right.nodes_to_replace->size;
-              });
+    // Keep the partitions doing the most work, as each delegated partition
+    // adds a CPU<->accelerator transition that only pays off when enough
+    // work runs on the accelerator. Ties are broken by the node count.
+    std::vector<std::pair<int64_t, const TfLiteDelegateParams*>>
+        partitions_by_cost;
+    partitions_by_cost.reserve(num_partitions);
+    for (const TfLiteDelegateParams& partition_params :
+         partition_params_array) {
+      partitions_by_cost.emplace_back(
+          EstimatePartitionCost(context, partition_params), &partition_params);
+    }
+    std::stable_sort(
+        partitions_by_cost.begin(), partitions_by_cost.end(),
+        [](const std::pair<int64_t, const TfLiteDelegateParams*>& left,
+           const std::pair<int64_t, const TfLiteDelegateParams*>& right) {
+          // Reverse sort
+          if (left.first != right.first) {
+            return left.first > right.first;
+          }
+          return left.second->nodes_to_replace->size >
+                 right.second->nodes_to_replace->size;
+        });
 
     nodes_to_delegate->clear();
 
     for (int i = 0; i < max_partitions; i++) {
-      const TfLiteDelegateParams& partition_params = partition_params_array[i];
+      const TfLiteDelegateParams& partition_params =
+          *partitions_by_cost[i].second;
 
       nodes_to_delegate->insert(nodes_to_delegate->end(),
                                 partition_params.nodes_to_replace->data,
@@ -4274,7 +4346,8 @@ TfLiteStatus StatefulNnApiDelegate::DoPrepare(TfLiteContext* context,
   }
 
   TF_LITE_ENSURE_STATUS(
-      LimitDelegatedPartitions(delegate_options.max_number_delegated_partitions,
+      LimitDelegatedPartitions(context,
+                               delegate_options.max_number_delegated_partitions,
                                std::vector<TfLiteDelegateParams>(
                                    params_array, params_array + num_partitions),
                                &nodes_to_delegate));
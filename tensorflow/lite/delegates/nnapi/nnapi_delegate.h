@@ -87,7 +87,9 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
     // number of partition greater than this parameter, only
     // <max_number_delegated_partitions> of them will be actually accelerated.
     // The selection is currently done sorting partitions in decreasing order
-    // of number of nodes and selecting them until the limit is reached.
+    // of estimated cost (multiply-accumulates for convolutions and fully
+    // connected layers, output elements for the other ops) and then of number
+    // of nodes, and selecting them until the limit is reached.
     int max_number_delegated_partitions = 3;
   };
 
@@ -247,8 +249,9 @@ class StatefulNnApiDelegate : public TfLiteDelegate {
   // called. It will be altered storing in the first element the count of
   // nodes to actually delegate and in the remainder of the array the indexes.
   // The params_array params might be altered during the functions execution.
+  // The partitions with the highest estimated cost are the ones kept.
   static TfLiteStatus LimitDelegatedPartitions(
-      int max_partitions,
+      TfLiteContext* context, int max_partitions,
       std::vector<TfLiteDelegateParams> partition_params_array,
       std::vector<int>* nodes_to_delegate);
 
@@ -0,0 +1,278 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "flatbuffers/flatbuffers.h"  // from @flatbuffers
+#include "tensorflow/lite/delegates/xnnpack/xnnpack_delegate.h"
+#include "tensorflow/lite/interpreter.h"
+#include "tensorflow/lite/kernels/register.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/version.h"
+
+namespace tflite {
+namespace xnnpack {
+
+namespace {
+
+class MeanTester {
+ public:
+  MeanTester() = default;
+  MeanTester(const MeanTester&) = delete;
+  MeanTester& operator=(const MeanTester&) = delete;
+
+  MeanTester& BatchSize(int32_t batch_size) {
+    EXPECT_GT(batch_size, 0);
+    batch_size_ = batch_size;
+    return *this;
+  }
+
+  int32_t BatchSize() const { return batch_size_; }
+
+  MeanTester& Channels(int32_t channels) {
+    EXPECT_GT(channels, 0);
+    channels_ = channels;
+    return *this;
+  }
+
+  int32_t Channels() const { return channels_; }
+
+  MeanTester& InputHeight(int32_t input_height) {
+    EXPECT_GT(input_height, 0);
+    input_height_ = input_height;
+    return *this;
+  }
+
+  int32_t InputHeight() const { return input_height_; }
+
+  MeanTester& InputWidth(int32_t input_width) {
+    EXPECT_GT(input_width, 0);
+    input_width_ = input_width;
+    return *this;
+  }
+
+  int32_t InputWidth() const { return input_width_; }
+
+  MeanTester& Axes(std::vector<int32_t> axes) {
+    axes_ = std::move(axes);
+    return *this;
+  }
+
+  const std::vector<int32_t>& Axes() const { return axes_; }
+
+  void Test(TfLiteDelegate* delegate) const {
+    std::random_device random_device;
+    auto rng = std::mt19937(random_device());
+    auto f32rng = std::bind(std::uniform_real_distribution<float>(), rng);
+
+    std::vector<char> buffer = CreateTfLiteModel();
+    const Model* model = GetModel(buffer.data());
+
+    std::unique_ptr<Interpreter> delegate_interpreter;
+    ASSERT_EQ(
+        InterpreterBuilder(model, ::tflite::ops::builtin::BuiltinOpResolver())(
+            &delegate_interpreter),
+        kTfLiteOk);
+    std::unique_ptr<Interpreter> default_interpreter;
+    ASSERT_EQ(
+        InterpreterBuilder(model, ::tflite::ops::builtin::BuiltinOpResolver())(
+            &default_interpreter),
+        kTfLiteOk);
+
+    ASSERT_TRUE(delegate_interpreter);
+    ASSERT_TRUE(default_interpreter);
+
+    ASSERT_EQ(delegate_interpreter->inputs().size(), 1);
+    ASSERT_EQ(default_interpreter->inputs().size(), 1);
+
+    ASSERT_EQ(delegate_interpreter->outputs().size(), 1);
+    ASSERT_EQ(default_interpreter->outputs().size(), 1);
+
+    ASSERT_EQ(delegate_interpreter->AllocateTensors(), kTfLiteOk);
+    ASSERT_EQ(default_interpreter->AllocateTensors(), kTfLiteOk);
+
+    ASSERT_EQ(delegate_interpreter->ModifyGraphWithDelegate(delegate),
+              kTfLiteOk);
+
+    const int32_t input_size =
+        BatchSize() * InputHeight() * InputWidth() * Channels();
+    float* default_input_data = default_interpreter->typed_tensor<float>(
+        default_interpreter->inputs()[0]);
+    std::generate(default_input_data, default_input_data + input_size,
+                  std::ref(f32rng));
+
+    float* xnnpack_input_data = delegate_interpreter->typed_tensor<float>(
+        delegate_interpreter->inputs()[0]);
+    std::copy(default_input_data, default_input_data + input_size,
+              xnnpack_input_data);
+
+    default_interpreter->Invoke();
+    delegate_interpreter->Invoke();
+
+    float* default_output_data = default_interpreter->typed_tensor<float>(
+        default_interpreter->outputs()[0]);
+    float* xnnpack_output_data = delegate_interpreter->typed_tensor<float>(
+        delegate_interpreter->outputs()[0]);
+
+    for (size_t i = 0; i < BatchSize() * Channels(); i++) {
+      ASSERT_NEAR(default_output_data[i], xnnpack_output_data[i],
+                  std::numeric_limits<float>::epsilon() *
+                      std::max(std::abs(default_output_data[i]) * 25.0f, 1.0f));
+    }
+  }
+
+ private:
+  std::vector<char> CreateTfLiteModel() const {
+    flatbuffers::FlatBufferBuilder builder;
+    flatbuffers::Offset<OperatorCode> operator_code =
+        CreateOperatorCode(builder, BuiltinOperator_MEAN, 0);
+
+    flatbuffers::Offset<ReducerOptions> reducer_options =
+        CreateReducerOptions(builder, /*keep_dims=*/true);
+
+    flatbuffers::Offset<Buffer> buffers[2] = {
+        CreateBuffer(builder, builder.CreateVector({})),
+        CreateBuffer(builder,
+                     builder.CreateVector(
+                         reinterpret_cast<const uint8_t*>(Axes().data()),
+                         sizeof(int32_t) * Axes().size())),
+    };
+
+    const int32_t input_shape[4] = {BatchSize(), InputHeight(), InputWidth(),
+                                    Channels()};
+    const int32_t output_shape[4] = {BatchSize(), 1, 1, Channels()};
+    const int32_t axes_shape[1] = {static_cast<int32_t>(Axes().size())};
+
+    flatbuffers::Offset<Tensor> tensors[3] = {
+        CreateTensor(builder, builder.CreateVector<int32_t>(input_shape, 4),
+                     TensorType_FLOAT32, /*buffer=*/0,
+                     builder.CreateString("X")),
+        CreateTensor(builder, builder.CreateVector<int32_t>(axes_shape, 1),
+                     TensorType_INT32, /*buffer=*/1,
+                     builder.CreateString("axes")),
+        CreateTensor(builder, builder.CreateVector<int32_t>(output_shape, 4),
+                     TensorType_FLOAT32, /*buffer=*/0,
+                     builder.CreateString("Y")),
+    };
+
+    const int32_t op_inputs[2] = {0, 1};
+    const int32_t op_outputs[1] = {2};
+
+    flatbuffers::Offset<Operator> op =
+        CreateOperator(builder, /*opcode_index=*/0,
+                       builder.CreateVector<int32_t>(op_inputs, 2),
+                       builder.CreateVector<int32_t>(op_outputs, 1),
+                       BuiltinOptions_ReducerOptions, reducer_options.Union());
+
+    int32_t subgraph_inputs[1] = {0};
+    int32_t subgraph_outputs[1] = {2};
+    flatbuffers::Offset<SubGraph> subgraph =
+        CreateSubGraph(builder, builder.CreateVector(tensors, 3),
+                       builder.CreateVector<int32_t>(subgraph_inputs, 1),
+                       builder.CreateVector<int32_t>(subgraph_outputs, 1),
+                       builder.CreateVector(&op, 1), /*name=*/0);
+
+    flatbuffers::Offset<flatbuffers::String> description =
+        builder.CreateString("Mean model");
+
+    flatbuffers::Offset<Model> model_buffer = CreateModel(
+        builder, TFLITE_SCHEMA_VERSION, builder.CreateVector(&operator_code, 1),
+        builder.CreateVector(&subgraph, 1), description,
+        builder.CreateVector(buffers, 2));
+
+    builder.Finish(model_buffer);
+
+    return std::vector<char>(builder.GetBufferPointer(),
+                             builder.GetBufferPointer() + builder.GetSize());
+  }
+
+  int32_t batch_size_ = 1;
+  int32_t channels_ = 1;
+  int32_t input_height_ = 2;
+  int32_t input_width_ = 2;
+  std::vector<int32_t> axes_ = {1, 2};
+};
+
+}  // namespace
+
+TEST(Mean, HeightAndWidth) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto input_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 25), std::ref(rng));
+  auto channel_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(1, 16), std::ref(rng));
+
+  MeanTester()
+      .InputHeight(input_rng())
+      .InputWidth(input_rng())
+      .Channels(channel_rng())
+      .Test(xnnpack_delegate.get());
+}
+
+TEST(Mean, NegativeAxes) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto input_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 25), std::ref(rng));
+  auto channel_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(1, 16), std::ref(rng));
+
+  MeanTester()
+      .InputHeight(input_rng())
+      .InputWidth(input_rng())
+      .Channels(channel_rng())
+      .Axes({-2, -3})
+      .Test(xnnpack_delegate.get());
+}
+
+TEST(Mean, MultiBatch) {
+  std::unique_ptr<TfLiteDelegate, decltype(&TfLiteXNNPackDelegateDelete)>
+      xnnpack_delegate(TfLiteXNNPackDelegateCreate(nullptr),
+                       TfLiteXNNPackDelegateDelete);
+
+  std::random_device random_device;
+  auto rng = std::mt19937(random_device());
+  auto batch_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 4), std::ref(rng));
+  auto input_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(2, 25), std::ref(rng));
+  auto channel_rng =
+      std::bind(std::uniform_int_distribution<int32_t>(1, 16), std::ref(rng));
+
+  MeanTester()
+      .BatchSize(batch_rng())
+      .InputHeight(input_rng())
+      .InputWidth(input_rng())
+      .Channels(channel_rng())
+      .Test(xnnpack_delegate.get());
+}
+
+}  // namespace xnnpack
+}  // namespace tflite
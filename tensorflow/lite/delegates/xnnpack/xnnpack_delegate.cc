@@ -119,7 +119,13 @@ class Subgraph {
         return nullptr;
       }
 
-      for (int k = 0; k < node->inputs->size; k++) {
+      // The axes of MEAN are read when the node is defined, and don't become
+      // an XNNPACK Value.
+      const int num_value_inputs =
+          registration->builtin_code == kTfLiteBuiltinMean
+              ? 1
+              : node->inputs->size;
+      for (int k = 0; k < num_value_inputs; k++) {
         const int t = node->inputs->data[k];
         tensors[t] = t;
       }
@@ -618,6 +624,13 @@ class Subgraph {
                                   context->tensors, pool_params,
                                   xnnpack_tensors);
       }
+      case kTfLiteBuiltinMean: {
+        const TfLiteReducerParams* reducer_params =
+            static_cast<const TfLiteReducerParams*>(node->builtin_data);
+
+        return VisitMeanNode(subgraph, logging_context, node_index, node,
+                             context->tensors, reducer_params, xnnpack_tensors);
+      }
       case kTfLiteBuiltinMul: {
         const TfLiteMulParams* mul_params =
             static_cast<const TfLiteMulParams*>(node->builtin_data);
@@ -1060,6 +1073,114 @@ class Subgraph {
     return kTfLiteOk;
   }
 
+  static TfLiteStatus VisitMeanNode(
+      xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
+      TfLiteNode* node, const TfLiteTensor* tensors,
+      const TfLiteReducerParams* reducer_params,
+      const std::vector<uint32_t>& xnnpack_tensors) {
+    TF_LITE_ENSURE_STATUS(
+        CheckNumInputsAndOutputs(logging_context, node, 2, 1, node_index));
+
+    const TfLiteTensor& input_tensor = tensors[node->inputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+        logging_context, input_tensor, node->inputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, input_tensor, 4,
+                                           node->inputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, input_tensor, node->inputs->data[0], node_index));
+
+    const TfLiteTensor& axes_tensor = tensors[node->inputs->data[1]];
+    TF_LITE_ENSURE_STATUS(CheckTensorStaticAllocation(
+        logging_context, axes_tensor, node->inputs->data[1], node_index));
+    if (axes_tensor.type != kTfLiteInt32) {
+      if (logging_context != nullptr) {
+        TF_LITE_KERNEL_LOG(
+            logging_context, "unsupported type %s in tensor #%d in node #%d",
+            TfLiteTypeGetName(axes_tensor.type), node->inputs->data[1],
+            node_index);
+      }
+      return kTfLiteError;
+    }
+
+    const TfLiteTensor& output_tensor = tensors[node->outputs->data[0]];
+    TF_LITE_ENSURE_STATUS(CheckTensorFloatType(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+    TF_LITE_ENSURE_STATUS(CheckTensorShape(logging_context, output_tensor, 4,
+                                           node->outputs->data[0]));
+    TF_LITE_ENSURE_STATUS(CheckTensorNonDynamicAllocation(
+        logging_context, output_tensor, node->outputs->data[0], node_index));
+
+    // Only the mean over the height and width dimensions, with the reduced
+    // dimensions kept, is supported. It is computed as an average pooling
+    // with the pooling window covering the whole input.
+    if (reducer_params == nullptr || !reducer_params->keep_dims) {
+      if (logging_context != nullptr) {
+        TF_LITE_KERNEL_LOG(logging_context,
+                           "unsupported MEAN node #%d without kept dimensions",
+                           node_index);
+      }
+      return kTfLiteError;
+    }
+    int num_axes = 1;
+    for (int i = 0; i < axes_tensor.dims->size; i++) {
+      num_axes *= axes_tensor.dims->data[i];
+    }
+    const int32_t* axes_data = axes_tensor.data.i32;
+    bool reduces_height = false;
+    bool reduces_width = false;
+    for (int i = 0; i < num_axes; i++) {
+      const int32_t axis = axes_data[i] < 0 ? axes_data[i] + 4 : axes_data[i];
+      if (axis == 1) {
+        reduces_height = true;
+      } else if (axis == 2) {
+        reduces_width = true;
+      } else {
+        if (logging_context != nullptr) {
+          TF_LITE_KERNEL_LOG(logging_context,
+                             "unsupported reduction axis %d in MEAN node #%d",
+                             static_cast<int>(axes_data[i]), node_index);
+        }
+        return kTfLiteError;
+      }
+    }
+    const int input_height = input_tensor.dims->data[1];
+    const int input_width = input_tensor.dims->data[2];
+    if (!reduces_height || !reduces_width ||
+        input_height * input_width == 1) {
+      if (logging_context != nullptr) {
+        TF_LITE_KERNEL_LOG(logging_context,
+                           "unsupported reduction axes in MEAN node #%d: "
+                           "expected a reduction over height and width",
+                           node_index);
+      }
+      return kTfLiteError;
+    }
+
+    if (subgraph != nullptr) {
+      const xnn_status status = xnn_define_average_pooling_2d(
+          subgraph,
+          /*input_padding_top=*/0,
+          /*input_padding_right=*/0,
+          /*input_padding_bottom=*/0,
+          /*input_padding_left=*/0,
+          /*pooling_height=*/static_cast<uint32_t>(input_height),
+          /*pooling_width=*/static_cast<uint32_t>(input_width),
+          /*stride_height=*/1,
+          /*stride_width=*/1,
+          /*output_min=*/-std::numeric_limits<float>::infinity(),
+          /*output_max=*/+std::numeric_limits<float>::infinity(),
+          /*input_id=*/xnnpack_tensors[node->inputs->data[0]],
+          /*output_id=*/xnnpack_tensors[node->outputs->data[0]], /*flags=*/0);
+      if (status != xnn_status_success) {
+        TF_LITE_KERNEL_LOG(logging_context, "failed to delegate MEAN node #%d",
+                           node_index);
+        return kTfLiteError;
+      }
+    }
+
+    return kTfLiteOk;
+  }
+
   static TfLiteStatus VisitMulNode(
       xnn_subgraph_t subgraph, TfLiteContext* logging_context, int node_index,
       TfLiteNode* node, const TfLiteTensor* tensors,
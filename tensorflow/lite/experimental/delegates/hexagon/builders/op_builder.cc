@@ -97,6 +97,14 @@ OpBuilder* GraphBuilder::AddConstNodeWithData(const int shape[], char* data,
   builders_.emplace_back(new OpBuilder(this, OP_Const));
   builders_.back()->SetConstNode();
   builders_.back()->SetNodeId(builders_.size());
+  if (signature_ != nullptr) {
+    const int node_id = builders_.size();
+    AddToSignature(&node_id, sizeof(node_id));
+    AddToSignature(shape, 4 * sizeof(shape[0]));
+    AddToSignature(&data_size, sizeof(data_size));
+    AddToSignature(data, data_size);
+    return builders_.back().get();
+  }
   int error = hexagon_nn_->hexagon_nn_append_const_node(
       graph_id_, builders_.size(), shape[0], shape[1], shape[2], shape[3],
       reinterpret_cast<const uint8_t*>(data), data_size);
@@ -116,6 +124,16 @@ OpBuilder* GraphBuilder::AddConstNodeWithData(int tensor_id,
   builders_.back()->SetNodeId(node_id);
   int batch_size, height_size, width_size, depth_size;
   GetDims(&batch_size, &height_size, &width_size, &depth_size, tensor.dims);
+  if (signature_ != nullptr) {
+    const int shape[] = {batch_size, height_size, width_size, depth_size};
+    const int data_size = tensor.bytes;
+    AddToSignature(&node_id, sizeof(node_id));
+    AddToSignature(shape, sizeof(shape));
+    AddToSignature(&data_size, sizeof(data_size));
+    AddToSignature(tensor.data.raw, data_size);
+    AddTensorWithID(tensor_id, node_id, 0);
+    return builders_.back().get();
+  }
   int error = hexagon_nn_->hexagon_nn_append_const_node(
       graph_id_, node_id, batch_size, height_size, width_size, depth_size,
       reinterpret_cast<const uint8_t*>(tensor.data.raw), tensor.bytes);
@@ -128,6 +146,36 @@ OpBuilder* GraphBuilder::AddConstNodeWithData(int tensor_id,
   return builders_.back().get();
 }
 
+void GraphBuilder::AddToSignature(const void* data, int size) {
+  // 64-bit FNV-1a.
+  constexpr uint64_t kPrime = 1099511628211ULL;
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  uint64_t hash = *signature_;
+  for (int i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * kPrime;
+  }
+  *signature_ = hash;
+}
+
+void GraphBuilder::AddNodeToSignature(const OpNode& op_node) {
+  const int header[] = {op_node.node_id, op_node.op_type,
+                        static_cast<int>(op_node.padding_type),
+                        static_cast<int>(op_node.inputs.size()),
+                        static_cast<int>(op_node.outputs.size())};
+  AddToSignature(header, sizeof(header));
+  for (const auto& input : op_node.inputs) {
+    const int ids[] = {static_cast<int>(input.src_id),
+                       static_cast<int>(input.output_idx)};
+    AddToSignature(ids, sizeof(ids));
+  }
+  for (const auto& output : op_node.outputs) {
+    const int sizes[] = {static_cast<int>(output.rank),
+                         static_cast<int>(output.elementsize)};
+    AddToSignature(sizes, sizeof(sizes));
+    AddToSignature(output.max_sizes, sizeof(output.max_sizes));
+  }
+}
+
 void delegates::hexagon::GraphBuilder::AddInputTensors(
     const TfLiteIntArray* input_tensors, TfLiteContext* context) {
   builders_.emplace_back(new OpBuilder(this, OP_INPUT));
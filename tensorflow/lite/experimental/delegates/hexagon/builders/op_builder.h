@@ -229,12 +229,21 @@ class GraphBuilder {
 
   void AddDebugNode() {}
 
+  // If set, nodes are hashed into "*signature" instead of being added to the
+  // Hexagon graph, so that graphs with the same nodes and constants can be
+  // found without building them.
+  void SetSignature(uint64_t* signature) { signature_ = signature; }
+
   void Build() {
     for (int i = 0; i < builders_.size(); ++i) {
       if (builders_[i]->IsConstNode()) {
         continue;
       }
       const OpNode* op_node = builders_[i]->Build();
+      if (signature_ != nullptr) {
+        AddNodeToSignature(*op_node);
+        continue;
+      }
       int error = hexagon_nn_->hexagon_nn_append_node(
           graph_id_, op_node->node_id, op_node->op_type, op_node->padding_type,
           op_node->inputs.data(), op_node->inputs.size(),
@@ -284,6 +293,10 @@ class GraphBuilder {
   }
 
  private:
+  // Hashes "size" bytes at "data" into "*signature_".
+  void AddToSignature(const void* data, int size);
+  void AddNodeToSignature(const OpNode& op_node);
+
   // Helper method to fetch dimensions.
   // TODO(karimnosseir): Move this method to shared place.
   void GetDims(int* batch_size, int* height_size, int* width_size,
@@ -302,6 +315,7 @@ class GraphBuilder {
   // Index in the vector is the tflite_tensor_index, the value
   // is the ID in the hexgon graph.
   std::vector<OpBuilder::TensorID> tensors_;
+  uint64_t* signature_ = nullptr;
 };
 
 }  // namespace hexagon
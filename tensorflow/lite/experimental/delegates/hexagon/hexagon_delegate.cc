@@ -206,4 +206,8 @@ void TfLiteHexagonInitWithPath(const char* lib_directory_path) {
   }
   tflite::HexagonDelegateKernel::InitState();
 }
+void TfLiteHexagonGetExecutionStats(TfLiteHexagonExecutionStats* stats) {
+  tflite::HexagonDelegateKernel::GetExecutionStats(stats);
+}
+
 void TfLiteHexagonTearDown() { tflite::HexagonDelegateKernel::Teardown(); }
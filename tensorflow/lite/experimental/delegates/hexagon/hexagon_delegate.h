@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXPERIMENTAL_DELEGATES_HEXAGON_HEXAGON_DELEGATE_H_
 #define TENSORFLOW_LITE_EXPERIMENTAL_DELEGATES_HEXAGON_HEXAGON_DELEGATE_H_
 
+#include <stdint.h>
+
 #include "tensorflow/lite/c/common.h"
 
 #ifdef SWIG
@@ -53,6 +55,17 @@ struct TFL_CAPI_EXPORT TfLiteHexagonDelegateOptions {
   bool print_graph_debug;
 };
 
+// Time spent by the Hexagon delegate kernels of all interpreters in the
+// process.
+// WARNING: Experimental and subject to change anytime.
+struct TFL_CAPI_EXPORT TfLiteHexagonExecutionStats {
+  int64_t num_invocations;
+  // Time spent waiting for the DSP to execute graphs, including the RPC.
+  int64_t dsp_time_us;
+  // Time spent on the host converting inputs and outputs.
+  int64_t host_time_us;
+};
+
 // Return a delegate that uses Hexagon SDK for ops execution.
 // Must outlive the interpreter.
 TfLiteDelegate* TFL_CAPI_EXPORT
@@ -71,6 +84,10 @@ void TFL_CAPI_EXPORT TfLiteHexagonInitWithPath(const char* lib_directory_path);
 // Assumes the environment setup is already done. Only initialize Hexagon.
 void TFL_CAPI_EXPORT TfLiteHexagonInit();
 
+// Sets "*stats" to the time spent by the Hexagon delegate kernels so far.
+void TFL_CAPI_EXPORT
+TfLiteHexagonGetExecutionStats(TfLiteHexagonExecutionStats* stats);
+
 // Clean up and switch off the DSP connection.
 // This should be called after all processing is done and delegate is deleted.
 void TFL_CAPI_EXPORT TfLiteHexagonTearDown();
@@ -14,6 +14,9 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/experimental/delegates/hexagon/hexagon_delegate_kernel.h"
 
+#include <atomic>
+#include <mutex>  // NOLINT(build/c++11)
+#include <unordered_map>
 #include <vector>
 
 #include "tensorflow/lite/builtin_ops.h"
@@ -25,11 +28,66 @@ limitations under the License.
 #include "tensorflow/lite/experimental/delegates/hexagon/utils.h"
 #include "tensorflow/lite/kernels/internal/optimized/optimized_ops.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/profiling/time.h"
 
 namespace tflite {
 
+// A Hexagon graph, which is torn down with the last kernel that uses it.
+struct HexagonGraph {
+  HexagonGraph(const HexagonNN* hexagon_nn, hexagon_nn_nn_id graph_id)
+      : hexagon_nn(hexagon_nn), graph_id(graph_id) {}
+  ~HexagonGraph() { hexagon_nn->hexagon_nn_teardown(graph_id); }
+
+  const HexagonNN* const hexagon_nn;
+  const hexagon_nn_nn_id graph_id;
+  // Serializes the preparation and executions of the graph. Kernels of
+  // different graphs run on the DSP concurrently.
+  std::mutex mu;
+  bool prepared = false;
+};
+
 namespace {
 
+// Initial value of graph signatures (the 64-bit FNV offset basis).
+constexpr uint64_t kSignatureSeed = 14695981039346656037ULL;
+
+// Time spent by all kernels, for TfLiteHexagonGetExecutionStats().
+std::atomic<int64_t> num_invocations(0);
+std::atomic<int64_t> dsp_time_us(0);
+std::atomic<int64_t> host_time_us(0);
+
+// The Hexagon graphs of the live kernels by their signature, so that the
+// kernels of identical subgraphs, e.g. of several interpreters of the same
+// model, build and prepare the graph on the DSP once.
+class HexagonGraphCache {
+ public:
+  static HexagonGraphCache* Get() {
+    static HexagonGraphCache* cache = new HexagonGraphCache;
+    return cache;
+  }
+
+  // Returns the graph with "signature", or nullptr if there is none.
+  std::shared_ptr<HexagonGraph> Find(uint64_t signature) {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = graphs_.find(signature);
+    if (it == graphs_.end()) return nullptr;
+    std::shared_ptr<HexagonGraph> graph = it->second.lock();
+    if (graph == nullptr) graphs_.erase(it);
+    return graph;
+  }
+
+  // Adds "graph" unless there already is a graph with "signature".
+  void Insert(uint64_t signature, const std::shared_ptr<HexagonGraph>& graph) {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::weak_ptr<HexagonGraph>& entry = graphs_[signature];
+    if (entry.expired()) entry = graph;
+  }
+
+ private:
+  std::mutex mu_;
+  std::unordered_map<uint64_t, std::weak_ptr<HexagonGraph>> graphs_;
+};
+
 // Used to convert int8 <-> uint8.
 constexpr int kSameScaleEffectiveMultiplier = 1 << 30;
 constexpr int kSameScaleEffectiveShift = 1;
@@ -97,6 +155,33 @@ TfLiteStatus HexagonDelegateKernel::Init(TfLiteContext* context,
     return kTfLiteError;
   }
 
+  error = hexagon_nn_->hexagon_nn_set_powersave_level(params_.powersave_level);
+  if (error != 0) {
+    context->ReportError(context, "Failed to set powersave level, error %d",
+                         error);
+    return kTfLiteError;
+  }
+
+  for (auto node_index : TfLiteIntArrayView(params->nodes_to_replace)) {
+    nodes_.push_back(node_index);
+  }
+
+  // Reuse the graph of an identical subgraph, unless this kernel prints
+  // information about its own graph.
+  const bool share_graph = params_.debug_level == 0 &&
+                           !params_.print_graph_profile &&
+                           !params_.print_graph_debug;
+  uint64_t signature = kSignatureSeed;
+  if (share_graph) {
+    TF_LITE_ENSURE_STATUS(BuildGraph(context, params->input_tensors,
+                                     params->output_tensors, &signature));
+    graph_ = HexagonGraphCache::Get()->Find(signature);
+    if (graph_ != nullptr) {
+      graph_id_ = graph_->graph_id;
+      return kTfLiteOk;
+    }
+  }
+
   // Initialize an empty graph.
   error = hexagon_nn_->hexagon_nn_init(&graph_id_);
   if (error != 0) {
@@ -104,6 +189,7 @@ TfLiteStatus HexagonDelegateKernel::Init(TfLiteContext* context,
     ReportError(context, state_, "failed to init");
     return kTfLiteError;
   }
+  graph_ = std::make_shared<HexagonGraph>(hexagon_nn_, graph_id_);
   error =
       hexagon_nn_->hexagon_nn_set_debug_level(graph_id_, params_.debug_level);
   if (error != 0) {
@@ -111,19 +197,12 @@ TfLiteStatus HexagonDelegateKernel::Init(TfLiteContext* context,
                          error);
     return kTfLiteError;
   }
-  error = hexagon_nn_->hexagon_nn_set_powersave_level(params_.powersave_level);
-  if (error != 0) {
-    context->ReportError(context, "Failed to set powersave level, error %d",
-                         error);
-    return kTfLiteError;
-  }
 
-  for (auto node_index : TfLiteIntArrayView(params->nodes_to_replace)) {
-    nodes_.push_back(node_index);
+  TF_LITE_ENSURE_STATUS(BuildGraph(context, params->input_tensors,
+                                   params->output_tensors, nullptr));
+  if (share_graph) {
+    HexagonGraphCache::Get()->Insert(signature, graph_);
   }
-
-  TF_LITE_ENSURE_STATUS(
-      BuildGraph(context, params->input_tensors, params->output_tensors));
   return kTfLiteOk;
 }
 
@@ -133,6 +212,7 @@ TfLiteStatus HexagonDelegateKernel::Invoke(TfLiteContext* context,
     context->ReportError(context, "Hexagon interface not available.");
     return kTfLiteError;
   }
+  const uint64_t start_us = profiling::time::NowMicros();
   // Allocate inputs.
   std::vector<hexagon_nn_tensordef> input_tensors;
   for (int input_idx = 0; input_idx < node->inputs->size; ++input_idx) {
@@ -199,14 +279,20 @@ TfLiteStatus HexagonDelegateKernel::Invoke(TfLiteContext* context,
     }
   }
 
-  if (params_.print_graph_profile) {
-    hexagon_nn_->hexagon_nn_reset_perfinfo(graph_id_, 0);
-  }
+  const uint64_t execute_start_us = profiling::time::NowMicros();
+  int error;
+  {
+    std::lock_guard<std::mutex> lock(graph_->mu);
+    if (params_.print_graph_profile) {
+      hexagon_nn_->hexagon_nn_reset_perfinfo(graph_id_, 0);
+    }
 
-  // Execute.
-  int error = hexagon_nn_->hexagon_nn_execute_new(
-      graph_id_, input_tensors.data(), input_tensors.size(),
-      output_tensors.data(), output_tensors.size());
+    // Execute.
+    error = hexagon_nn_->hexagon_nn_execute_new(
+        graph_id_, input_tensors.data(), input_tensors.size(),
+        output_tensors.data(), output_tensors.size());
+  }
+  const uint64_t execute_end_us = profiling::time::NowMicros();
   if (error != 0) {
     ReportError(context, HexagonKernelState::FAILED_TO_EXECUTE_GRAPH,
                 "Failed to execute graph.");
@@ -229,6 +315,11 @@ TfLiteStatus HexagonDelegateKernel::Invoke(TfLiteContext* context,
   if (params_.print_graph_profile) {
     PrintPerformanceData(reinterpret_cast<Profiler*>(context->profiler));
   }
+
+  const uint64_t end_us = profiling::time::NowMicros();
+  ++num_invocations;
+  dsp_time_us += execute_end_us - execute_start_us;
+  host_time_us += (execute_start_us - start_us) + (end_us - execute_end_us);
   return kTfLiteOk;
 }
 
@@ -238,11 +329,18 @@ TfLiteStatus HexagonDelegateKernel::Prepare(TfLiteContext* context,
     context->ReportError(context, "Hexagon interface not available. prepare");
     return kTfLiteError;
   }
-  int status = hexagon_nn_->hexagon_nn_prepare(graph_id_);
-  if (status != 0) {
-    state_ = HexagonKernelState::FAILED_TO_PREPARE_GRAPH;
-    ReportError(context, state_, "Failed to prepare graph.\n");
-    return kTfLiteError;
+  {
+    // A shared graph is prepared by the first of its kernels.
+    std::lock_guard<std::mutex> lock(graph_->mu);
+    if (!graph_->prepared) {
+      int status = hexagon_nn_->hexagon_nn_prepare(graph_id_);
+      if (status != 0) {
+        state_ = HexagonKernelState::FAILED_TO_PREPARE_GRAPH;
+        ReportError(context, state_, "Failed to prepare graph.\n");
+        return kTfLiteError;
+      }
+      graph_->prepared = true;
+    }
   }
 
   // Check input/output tensors.
@@ -304,9 +402,10 @@ TfLiteStatus HexagonDelegateKernel::Prepare(TfLiteContext* context,
 
 TfLiteStatus HexagonDelegateKernel::BuildGraph(
     TfLiteContext* context, const TfLiteIntArray* input_tensors,
-    const TfLiteIntArray* output_tensors) {
+    const TfLiteIntArray* output_tensors, uint64_t* signature) {
   builder_.reset(
       new delegates::hexagon::GraphBuilder(hexagon_nn_, context, graph_id_));
+  builder_->SetSignature(signature);
   // Add inputs to the graph.
   builder_->AddInputTensors(input_tensors, context);
 
@@ -331,11 +430,8 @@ TfLiteStatus HexagonDelegateKernel::BuildGraph(
   return kTfLiteOk;
 }
 
-HexagonDelegateKernel::~HexagonDelegateKernel() {
-  if (graph_id_ != -1) {
-    hexagon_nn_->hexagon_nn_teardown(graph_id_);
-  }
-}
+// `graph_` tears down the graph with its last kernel.
+HexagonDelegateKernel::~HexagonDelegateKernel() {}
 
 void HexagonDelegateKernel::PrintLog() {
   std::vector<unsigned char> buf(3000000);
@@ -401,6 +497,13 @@ void HexagonDelegateKernel::Teardown() {
   }
 }
 
+void HexagonDelegateKernel::GetExecutionStats(
+    TfLiteHexagonExecutionStats* stats) {
+  stats->num_invocations = num_invocations;
+  stats->dsp_time_us = dsp_time_us;
+  stats->host_time_us = host_time_us;
+}
+
 void HexagonDelegateKernel::InitState() {
   auto* hexagon_nn = HexagonNNImplementation();
   if (hexagon_nn != nullptr) {
@@ -35,6 +35,8 @@ limitations under the License.
 
 namespace tflite {
 
+struct HexagonGraph;
+
 // Represents an abstraction of a Hexagon NNLib graph with functionality to
 // initialize, prepare and invoke it based on the TFLite subgraph to be
 // delegated.
@@ -69,11 +71,16 @@ class HexagonDelegateKernel {
   // Teardown the environment initialized in InitState.
   static void Teardown();
 
+  // Sets "*stats" to the time spent by all kernels so far.
+  static void GetExecutionStats(TfLiteHexagonExecutionStats* stats);
+
  private:
-  // Builds the Hexagon graph based on delegated TFLite subgraph.
+  // Builds the Hexagon graph based on delegated TFLite subgraph. If
+  // "signature" is not null, the graph is only hashed into it.
   TfLiteStatus BuildGraph(TfLiteContext* context,
                           const TfLiteIntArray* input_tensors,
-                          const TfLiteIntArray* output_tensors);
+                          const TfLiteIntArray* output_tensors,
+                          uint64_t* signature);
 
   void ReportError(TfLiteContext* context, HexagonKernelState state,
                    const std::string& msg);
@@ -92,6 +99,9 @@ class HexagonDelegateKernel {
   const HexagonNN* hexagon_nn_ = nullptr;  // Not owned.
   std::unique_ptr<delegates::hexagon::GraphBuilder> builder_;
   hexagon_nn_nn_id graph_id_ = -1;
+  // Owns `graph_id_`, which is shared with the kernels of identical subgraphs,
+  // e.g. of other interpreters of the same model.
+  std::shared_ptr<HexagonGraph> graph_;
   // Indices of nodes in the delegated TfLite subgraph.
   std::vector<int> nodes_;
   ::TfLiteHexagonDelegateOptions params_;
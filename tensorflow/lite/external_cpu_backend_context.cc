@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/lite/external_cpu_backend_context.h"
 
+#include <algorithm>
+
 namespace tflite {
 namespace {
 
@@ -35,4 +37,23 @@ ExternalCpuBackendContext::ExternalCpuBackendContext()
   this->Refresh = RefreshExternalCpuBackendContext;
 }
 
+CpuBackendThreadBudget::CpuBackendThreadBudget(int max_num_threads)
+    : max_num_threads_(max_num_threads > 1 ? max_num_threads : 1),
+      num_threads_in_use_(0) {}
+
+int CpuBackendThreadBudget::Acquire(int num_threads) {
+  if (num_threads < 1) num_threads = 1;
+  int in_use = num_threads_in_use_.load(std::memory_order_relaxed);
+  int granted;
+  do {
+    granted = std::min(num_threads, std::max(max_num_threads_ - in_use, 1));
+  } while (!num_threads_in_use_.compare_exchange_weak(
+      in_use, in_use + granted, std::memory_order_relaxed));
+  return granted;
+}
+
+void CpuBackendThreadBudget::Release(int num_threads) {
+  num_threads_in_use_.fetch_sub(num_threads, std::memory_order_relaxed);
+}
+
 }  // namespace tflite
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 #define TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
 
+#include <atomic>
 #include <memory>
 #include <utility>
 
@@ -99,6 +100,44 @@ class ExternalCpuBackendContext : public TfLiteExternalContext {
       delete;
 };
 
+// A budget of threads shared by the cpu backend contexts of a set of
+// interpreters, typically all the interpreters of a process that run
+// concurrently. Each invocation of an interpreter that uses the budget takes
+// up to the number of threads set by 'SetNumThreads' from it, and gives them
+// back when it returns, so that the interpreters together don't use more
+// threads than there are cores:
+//
+//  CpuBackendThreadBudget budget(/*max_num_threads=*/num_cores);
+//  interpreter1->SetNumThreads(4);
+//  interpreter1->SetCpuBackendThreadBudget(&budget);
+//  interpreter2->SetNumThreads(4);
+//  interpreter2->SetCpuBackendThreadBudget(&budget);
+//
+// An invocation never waits for threads: when the budget is exhausted, it
+// runs on the calling thread only. Unlike a shared ExternalCpuBackendContext,
+// the interpreters may be invoked simultaneously.
+class CpuBackendThreadBudget {
+ public:
+  explicit CpuBackendThreadBudget(int max_num_threads);
+
+  int max_num_threads() const { return max_num_threads_; }
+
+  // Takes up to 'num_threads' threads from the budget, and returns how many
+  // were taken. The calling thread is one of them, and is taken even if the
+  // budget is exhausted, so at least 1 is returned.
+  int Acquire(int num_threads);
+
+  // Gives back 'num_threads' threads taken with 'Acquire'.
+  void Release(int num_threads);
+
+ private:
+  const int max_num_threads_;
+  std::atomic<int> num_threads_in_use_;
+
+  CpuBackendThreadBudget(const CpuBackendThreadBudget&) = delete;
+  CpuBackendThreadBudget& operator=(const CpuBackendThreadBudget&) = delete;
+};
+
 }  // namespace tflite
 
 #endif  // TENSORFLOW_LITE_EXTERNAL_CPU_BACKEND_CONTEXT_H_
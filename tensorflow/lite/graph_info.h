@@ -15,12 +15,26 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_GRAPH_INFO_H_
 #define TENSORFLOW_LITE_GRAPH_INFO_H_
 
+#include <cstdint>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/c/common.h"
 
 namespace tflite {
 
+// A layout of the non-persistent arena computed ahead of time. Each offset
+// must be valid for tensors that live from the node producing them, or the
+// first node for graph inputs, up to their last consumer, or to the end of the
+// graph for graph inputs, outputs and tensors nothing consumes.
+struct OfflineMemoryPlan {
+  // Arena offset of each tensor, or -1 for tensors placed by the online
+  // planner.
+  std::vector<int32_t> offsets;
+  // Size in bytes of each tensor when the plan was made.
+  std::vector<size_t> bytes;
+};
+
 // Basic information about an inference graph, where execution nodes
 // are connected via tensors.
 class GraphInfo {
@@ -53,6 +67,20 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the range [first, last] of the indices of the nodes that may run
+  // concurrently with the node at `index`, which contains `index`. Tensors
+  // used by any two of these nodes must not share memory. By default nodes
+  // run one at a time.
+  virtual std::pair<size_t, size_t> concurrent_nodes(size_t index) const {
+    return {index, index};
+  }
+
+  // Returns the offline-planned layout of the arena, or null if there is none
+  // or it may not match the current execution plan.
+  virtual const OfflineMemoryPlan* offline_memory_plan() const {
+    return nullptr;
+  }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/context_util.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/inter_op_thread_pool.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/memory_planner.h"
 #include "tensorflow/lite/minimal_logging.h"
@@ -71,6 +72,45 @@ TfLiteQuantization GetQuantizationFromLegacy(
   return quantization;
 }
 
+// Takes the threads of one invocation from a thread budget, and limits the cpu
+// backend context to them until it goes out of scope.
+class ScopedThreadBudgetGrant {
+ public:
+  ScopedThreadBudgetGrant(CpuBackendThreadBudget* budget,
+                          TfLiteExternalContext* cpu_backend_context,
+                          int num_threads)
+      : budget_(budget), num_threads_(num_threads) {
+    if (budget_ == nullptr) return;
+    if (cpu_backend_context != nullptr) {
+      backend_context_ = static_cast<ExternalCpuBackendContext*>(
+                             cpu_backend_context)
+                             ->internal_backend_context();
+    }
+    granted_ = budget_->Acquire(num_threads_ > 0 ? num_threads_ : 1);
+    // Until a kernel initializes the backend context, which is then set up
+    // with the full number of threads, there is nothing to limit.
+    if (backend_context_ != nullptr && granted_ < num_threads_) {
+      backend_context_->SetMaxNumThreads(granted_);
+    } else {
+      backend_context_ = nullptr;
+    }
+  }
+
+  ~ScopedThreadBudgetGrant() {
+    if (budget_ == nullptr) return;
+    if (backend_context_ != nullptr) {
+      backend_context_->SetMaxNumThreads(num_threads_);
+    }
+    budget_->Release(granted_);
+  }
+
+ private:
+  CpuBackendThreadBudget* const budget_;
+  const int num_threads_;
+  TfLiteInternalBackendContext* backend_context_ = nullptr;
+  int granted_ = 0;
+};
+
 }  // namespace
 
 Interpreter::Interpreter(ErrorReporter* error_reporter)
@@ -179,6 +219,7 @@ void Interpreter::AddSubgraphs(int subgraphs_to_add,
   for (int i = 0; i < subgraphs_to_add; ++i) {
     Subgraph* subgraph = new Subgraph(error_reporter_, external_contexts_,
                                       &subgraphs_, &resources_);
+    subgraph->SetInterOpThreadPool(inter_op_thread_pool_.get());
     subgraphs_.emplace_back(subgraph);
   }
 }
@@ -197,6 +238,15 @@ TfLiteStatus Interpreter::ResizeInputTensor(int tensor_index,
   return primary_subgraph().ResizeInputTensor(tensor_index, dims);
 }
 
+TfLiteStatus Interpreter::SetPreparedShapeCacheSize(int cache_size) {
+  if (cache_size < 0) {
+    context_->ReportError(context_, "cache_size should be >= 0.");
+    return kTfLiteError;
+  }
+  primary_subgraph().SetPreparedShapeCacheSize(cache_size);
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::ReleaseNonPersistentMemory() {
   // TODO(b/138790287): We could do this for all subgraphs whose tensors have
   // been allocated. However, AllocateTensors() relies on Control Flow ops to
@@ -205,6 +255,9 @@ TfLiteStatus Interpreter::ReleaseNonPersistentMemory() {
 }
 
 TfLiteStatus Interpreter::Invoke() {
+  ScopedThreadBudgetGrant thread_budget_grant(
+      cpu_backend_thread_budget_, external_contexts_[kTfLiteCpuBackendContext],
+      context_->recommended_num_threads);
   TF_LITE_ENSURE_STATUS(primary_subgraph().Invoke());
 
   if (!allow_buffer_handle_output_) {
@@ -286,6 +339,30 @@ void Interpreter::SetNumThreads(int num_threads) {
       c->Refresh(context_);
     }
   }
+  if (inter_op_thread_pool_ && num_threads != -1) {
+    inter_op_thread_pool_->SetMaxNumThreadsPerOp(num_threads);
+  }
+}
+
+TfLiteStatus Interpreter::SetNumInterOpThreads(int num_threads) {
+  if (num_threads < 1) {
+    context_->ReportError(context_, "num_threads should be >= 1.");
+    return kTfLiteError;
+  }
+
+  std::unique_ptr<InterOpThreadPool> thread_pool;
+  if (num_threads > 1) {
+    thread_pool.reset(new InterOpThreadPool(num_threads));
+  }
+  for (auto& subgraph : subgraphs_) {
+    subgraph->SetInterOpThreadPool(thread_pool.get());
+  }
+  inter_op_thread_pool_ = std::move(thread_pool);
+  return kTfLiteOk;
+}
+
+void Interpreter::SetCpuBackendThreadBudget(CpuBackendThreadBudget* budget) {
+  cpu_backend_thread_budget_ = budget;
 }
 
 void Interpreter::SetAllowFp16PrecisionForFp32(bool allow) {
@@ -319,6 +319,19 @@ class Interpreter {
   TfLiteStatus ResizeInputTensor(int tensor_index,
                                  const std::vector<int>& dims);
 
+  /// Set how many prepared states for previously seen input shapes are kept.
+  ///
+  /// With a non-zero `cache_size`, AllocateTensors() after ResizeInputTensor()
+  /// back to input shapes the graph was prepared for before restores the
+  /// tensor shapes, memory plan and kernel data of that state instead of
+  /// preparing all nodes again, which makes alternating between a few shapes
+  /// cheap. Each kept state holds its own persistent memory and kernel data.
+  /// The least recently used state is dropped when the cache is full. Graphs
+  /// with delegates, control flow ops or dynamic tensors are never cached.
+  /// The default of 0 disables the cache.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetPreparedShapeCacheSize(int cache_size);
+
   // This releases memory held by non-persistent tensors. It does NOT re-perform
   // memory planning.
   // AllocateTensors needs to be called before next invocation.
@@ -349,6 +362,29 @@ class Interpreter {
   /// available to itself.
   void SetNumThreads(int num_threads);
 
+  /// Set the number of threads used to run nodes that don't depend on each
+  /// other concurrently, counting the thread calling Invoke().
+  ///
+  /// The default of 1 runs nodes one at a time. Above that, AllocateTensors()
+  /// reorders the execution plan so that independent nodes are adjacent and
+  /// never share tensor memory, and Invoke() runs them on a pool of
+  /// `num_threads` threads. Delegated nodes, custom ops, control flow ops and
+  /// ops using variable tensors always run alone. Each op may still use up to
+  /// the number of threads set by SetNumThreads().
+  ///
+  /// NOTE: AllocateTensors() needs to be called before next invocation.
+  /// WARNING: This is an experimental API and subject to change.
+  TfLiteStatus SetNumInterOpThreads(int num_threads);
+
+  /// Set a budget of threads shared with other interpreters, from which each
+  /// invocation takes up to the number of threads set by SetNumThreads().
+  /// When other interpreters hold the threads of the budget, Invoke() runs
+  /// with fewer threads instead of waiting, down to the calling thread only.
+  /// The budget is not owned and must outlive the interpreter, or be unset by
+  /// passing nullptr, the default.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetCpuBackendThreadBudget(CpuBackendThreadBudget* budget);
+
   /// Allow float16 precision for FP32 calculation when possible.
   /// default: not allow.
   /// WARNING: This is an experimental API and subject to change.
@@ -543,6 +579,14 @@ class Interpreter {
   // nullptr if necessary.
   std::unique_ptr<ExternalCpuBackendContext> own_external_cpu_backend_context_;
 
+  // The budget of threads shared with other interpreters, or nullptr. Not
+  // owned.
+  CpuBackendThreadBudget* cpu_backend_thread_budget_ = nullptr;
+
+  // The threads that run independent nodes concurrently, or nullptr to run
+  // them one at a time. Shared by all subgraphs.
+  std::unique_ptr<InterOpThreadPool> inter_op_thread_pool_;
+
   // Subgraphs
   std::vector<std::unique_ptr<Subgraph>> subgraphs_;
 
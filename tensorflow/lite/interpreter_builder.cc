@@ -38,6 +38,15 @@ namespace tflite {
 
 namespace {
 
+// Name of the model metadata holding an offline-planned arena layout. Its
+// buffer is an int32 array of the form
+//   [version, subgraph_index, num_tensors, offset_0, ..., offset_{n-1}]
+// where offset_i is the arena offset in bytes of tensor i of the subgraph, or
+// -1 for tensors that are left to the online planner.
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+constexpr int kOfflineMemAllocVersion = 1;
+constexpr int kOfflineMemAllocHeaderSize = 3;
+
 // Ensure that ErrorReporter is non-null.
 ErrorReporter* ValidateErrorReporter(ErrorReporter* e) {
   return e ? e : DefaultErrorReporter();
@@ -513,6 +522,53 @@ TfLiteStatus InterpreterBuilder::ParseTensors(
   return status;
 }
 
+TfLiteStatus InterpreterBuilder::ParseOfflineMemoryPlan(int subgraph_index,
+                                                        Subgraph* subgraph) {
+  auto* metadata = model_->metadata();
+  if (metadata == nullptr) {
+    return kTfLiteOk;
+  }
+  for (int i = 0; i < metadata->size(); ++i) {
+    const auto* entry = metadata->Get(i);
+    if (entry->name() == nullptr ||
+        entry->name()->str() != kOfflineMemAllocMetadata) {
+      continue;
+    }
+    auto* buffers = model_->buffers();
+    if (entry->buffer() >= buffers->size() ||
+        buffers->Get(entry->buffer())->data() == nullptr) {
+      error_reporter_->Report("%s metadata has no buffer.\n",
+                              kOfflineMemAllocMetadata);
+      return kTfLiteError;
+    }
+    auto* data = buffers->Get(entry->buffer())->data();
+    const size_t num_values = data->size() / sizeof(int32_t);
+    // The buffer data is 16-byte aligned by the schema.
+    const int32_t* values = reinterpret_cast<const int32_t*>(data->data());
+    if (num_values < kOfflineMemAllocHeaderSize ||
+        values[0] != kOfflineMemAllocVersion) {
+      error_reporter_->Report("Unsupported %s metadata.\n",
+                              kOfflineMemAllocMetadata);
+      return kTfLiteError;
+    }
+    if (values[1] != subgraph_index) {
+      continue;
+    }
+    const int num_tensors = values[2];
+    if (num_tensors != subgraph->tensors_size() ||
+        num_values != kOfflineMemAllocHeaderSize + num_tensors) {
+      error_reporter_->Report(
+          "%s metadata has %d tensors, but subgraph %d has %d.\n",
+          kOfflineMemAllocMetadata, num_tensors, subgraph_index,
+          subgraph->tensors_size());
+      return kTfLiteError;
+    }
+    return subgraph->SetOfflineMemoryPlan(std::vector<int32_t>(
+        values + kOfflineMemAllocHeaderSize, values + num_values));
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus InterpreterBuilder::ApplyDelegates(Interpreter* interpreter,
                                                 int num_threads) {
   // First, apply XNNPACK delegate if applicable.
@@ -640,6 +696,10 @@ TfLiteStatus InterpreterBuilder::operator()(
       }
     }
     modified_subgraph->SetVariables(std::move(variables));
+
+    if (ParseOfflineMemoryPlan(subgraph_index, modified_subgraph) !=
+        kTfLiteOk)
+      return cleanup_and_error();
   }
 
   if (ApplyDelegates(interpreter->get(), num_threads) != kTfLiteOk)
@@ -680,6 +680,186 @@ TEST(BasicInterpreter, ReleaseNonPersistentMemory) {
   ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
 }
 
+TEST(BasicInterpreter, PreparedShapeCache) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1}), kTfLiteOk);
+
+  TfLiteQuantizationParams quantized;
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(0, kTfLiteFloat32, "in1",
+                                                     {3}, quantized),
+            kTfLiteOk);
+  ASSERT_EQ(interpreter.SetTensorParametersReadWrite(1, kTfLiteFloat32, "out0",
+                                                     {3}, quantized),
+            kTfLiteOk);
+
+  // Count the calls to init and prepare of the passthrough op.
+  static int num_inits;
+  static int num_prepares;
+  static TfLiteRegistration passthrough;
+  num_inits = 0;
+  num_prepares = 0;
+  passthrough = GetPassthroughOpRegistration();
+  TfLiteRegistration reg = passthrough;
+  reg.init = [](TfLiteContext* context, const char* buffer,
+                size_t length) -> void* {
+    ++num_inits;
+    return passthrough.init(context, buffer, length);
+  };
+  reg.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    ++num_prepares;
+    return passthrough.prepare(context, node);
+  };
+
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  EXPECT_EQ(interpreter.SetPreparedShapeCacheSize(-1), kTfLiteError);
+  ASSERT_EQ(interpreter.SetPreparedShapeCacheSize(1), kTfLiteOk);
+
+  auto invoke_and_check = [&interpreter](int size) {
+    ASSERT_EQ(interpreter.tensor(1)->dims->size, 1);
+    ASSERT_EQ(interpreter.tensor(1)->dims->data[0], size);
+    for (int i = 0; i < size; ++i) {
+      interpreter.typed_tensor<float>(0)[i] = size + i;
+    }
+    ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+    for (int i = 0; i < size; ++i) {
+      EXPECT_EQ(interpreter.typed_tensor<float>(1)[i], size + i);
+    }
+  };
+
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_inits, 1);
+  EXPECT_EQ(num_prepares, 1);
+  invoke_and_check(3);
+
+  // A new shape is prepared with new kernel data, while the state for {3} is
+  // kept.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {2}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_inits, 2);
+  EXPECT_EQ(num_prepares, 2);
+  invoke_and_check(2);
+
+  // Going back to {3} doesn't prepare the op again.
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {3}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_inits, 2);
+  EXPECT_EQ(num_prepares, 2);
+  invoke_and_check(3);
+
+  // With the cache full, the kernel data of the state for {2} is reused for
+  // {4}, so no tensors are added.
+  const size_t tensors_size = interpreter.tensors_size();
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {4}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_inits, 2);
+  EXPECT_EQ(num_prepares, 3);
+  EXPECT_EQ(interpreter.tensors_size(), tensors_size);
+  invoke_and_check(4);
+
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {3}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_prepares, 3);
+  invoke_and_check(3);
+
+  // Without the cache, every new shape is prepared again.
+  ASSERT_EQ(interpreter.SetPreparedShapeCacheSize(0), kTfLiteOk);
+  ASSERT_EQ(interpreter.ResizeInputTensor(0, {4}), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(num_prepares, 4);
+  invoke_and_check(4);
+}
+
+TEST(BasicInterpreter, InterOpParallelism) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(6), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({5}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {3}, quantized),
+              kTfLiteOk);
+  }
+
+  // Two independent branches of two nodes each, joined by a fifth node.
+  TfLiteRegistration reg = GetPassthroughOpRegistration();
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({1}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {3}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({3}, {4}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({2, 4}, {5}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+
+  EXPECT_EQ(interpreter.SetNumInterOpThreads(0), kTfLiteError);
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  // The nodes of each branch are interleaved, and tensors used at the same
+  // time don't share memory.
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 2, 1, 3, 4}));
+  EXPECT_NE(interpreter.tensor(1)->data.raw, interpreter.tensor(3)->data.raw);
+  EXPECT_NE(interpreter.tensor(2)->data.raw, interpreter.tensor(4)->data.raw);
+  // Each node adds two temporaries, so those of nodes 0 and 2 start at 6 and
+  // 10 respectively.
+  EXPECT_NE(interpreter.tensor(6)->data.raw, interpreter.tensor(10)->data.raw);
+
+  for (int i = 0; i < 3; ++i) {
+    interpreter.typed_tensor<float>(0)[i] = i + 1;
+  }
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(interpreter.typed_tensor<float>(5)[i], i + 1);
+  }
+
+  // Going back to a single thread keeps the reordered execution plan.
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(1), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 2, 1, 3, 4}));
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(interpreter.typed_tensor<float>(5)[2], 3);
+}
+
+TEST(BasicInterpreter, InterOpParallelismKeepsCustomOpsInOrder) {
+  Interpreter interpreter;
+  ASSERT_EQ(interpreter.AddTensors(3), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetInputs({0}), kTfLiteOk);
+  ASSERT_EQ(interpreter.SetOutputs({1, 2}), kTfLiteOk);
+  TfLiteQuantizationParams quantized;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(interpreter.SetTensorParametersReadWrite(i, kTfLiteFloat32, "",
+                                                       {3}, quantized),
+              kTfLiteOk);
+  }
+
+  TfLiteRegistration reg = GetPassthroughOpRegistration();
+  reg.builtin_code = BuiltinOperator_CUSTOM;
+  reg.custom_name = "Passthrough";
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {1}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({0}, {2}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+
+  ASSERT_EQ(interpreter.SetNumInterOpThreads(2), kTfLiteOk);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+  EXPECT_EQ(interpreter.execution_plan(), std::vector<int>({0, 1}));
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+}
+
 // Forcefully divides tensor allocation in three steps: one before invocation
 // and two more at invocation time. This happens because we use string tensors
 // and their sizes can't be determined until invocation time.
@@ -1105,6 +1285,79 @@ TEST_F(InterpreterTest, ExternalBackendContextClearsCachesOnDelete) {
   EXPECT_EQ(cpu_backend_context->num_calls, 1);
 }
 
+TEST(CpuBackendThreadBudget, AcquireAndRelease) {
+  CpuBackendThreadBudget budget(4);
+  EXPECT_EQ(budget.max_num_threads(), 4);
+  EXPECT_EQ(budget.Acquire(3), 3);
+  EXPECT_EQ(budget.Acquire(3), 1);
+  // The calling thread is always granted.
+  EXPECT_EQ(budget.Acquire(2), 1);
+  budget.Release(1);
+  budget.Release(1);
+  EXPECT_EQ(budget.Acquire(2), 1);
+  budget.Release(3);
+  EXPECT_EQ(budget.Acquire(4), 3);
+}
+
+// Records the number of threads the backend context is limited to.
+struct NumThreadsRecordingBackendContext : public TfLiteInternalBackendContext {
+  void ClearCaches() override {}
+  void SetMaxNumThreads(int num_threads) override {
+    max_num_threads = num_threads;
+  }
+  int max_num_threads = -1;
+};
+
+TEST(BasicInterpreter, CpuBackendThreadBudgetLimitsInvoke) {
+  // An op that records the number of threads of the backend context.
+  static int num_threads_in_invoke;
+  TfLiteRegistration reg = {nullptr, nullptr, nullptr, nullptr};
+  reg.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    auto* external_context = static_cast<ExternalCpuBackendContext*>(
+        context->GetExternalContext(context, kTfLiteCpuBackendContext));
+    num_threads_in_invoke =
+        static_cast<NumThreadsRecordingBackendContext*>(
+            external_context->internal_backend_context())
+            ->max_num_threads;
+    return kTfLiteOk;
+  };
+
+  ExternalCpuBackendContext external_cpu_context;
+  auto* backend_context = new NumThreadsRecordingBackendContext();
+  external_cpu_context.set_internal_backend_context(
+      std::unique_ptr<TfLiteInternalBackendContext>(backend_context));
+
+  // The interpreter must be deleted before the context it shares.
+  Interpreter interpreter;
+  ASSERT_EQ(
+      interpreter.AddNodeWithParameters({}, {}, nullptr, 0, nullptr, &reg),
+      kTfLiteOk);
+  interpreter.SetExternalContext(kTfLiteCpuBackendContext,
+                                 &external_cpu_context);
+  interpreter.SetNumThreads(4);
+  ASSERT_EQ(interpreter.AllocateTensors(), kTfLiteOk);
+
+  CpuBackendThreadBudget budget(3);
+  interpreter.SetCpuBackendThreadBudget(&budget);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(num_threads_in_invoke, 3);
+  EXPECT_EQ(backend_context->max_num_threads, 4);
+
+  // With threads of the budget held elsewhere, fewer are used.
+  ASSERT_EQ(budget.Acquire(2), 2);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(num_threads_in_invoke, 1);
+  budget.Release(2);
+
+  // The interpreter gave its threads back to the budget.
+  EXPECT_EQ(budget.Acquire(3), 3);
+  budget.Release(3);
+
+  interpreter.SetCpuBackendThreadBudget(nullptr);
+  ASSERT_EQ(interpreter.Invoke(), kTfLiteOk);
+  EXPECT_EQ(num_threads_in_invoke, 4);
+}
+
 // Test fixture that allows playing with execution plans. It creates a two
 // node graph that can be executed in either [0,1] order or [1,0] order.
 // The CopyOp records when it is invoked in the class member run_order_
@@ -1024,7 +1024,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           fw_scratch_buffer, scaling_factors, prod_scaling_factors,
           recovered_cell_weights, input_quantized, aux_input_quantized,
           fw_activation_state_quantized, fw_cell_state_quantized,
-          fw_activation_state, fw_cell_state, accum_scratch, fw_output,
+          fw_activation_state, fw_cell_state, accum_scratch,
+          /*packed_weights=*/nullptr, fw_output,
           CpuBackendContext::GetFromContext(context));
       TF_LITE_ENSURE_OK(context, fw_pass_status);
 
@@ -1048,7 +1049,8 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           bw_scratch_buffer, scaling_factors, prod_scaling_factors,
           recovered_cell_weights, input_quantized, aux_input_quantized,
           bw_activation_state_quantized, bw_cell_state_quantized,
-          bw_activation_state, bw_cell_state, accum_scratch, actual_bw_output,
+          bw_activation_state, bw_cell_state, accum_scratch,
+          /*packed_weights=*/nullptr, actual_bw_output,
           CpuBackendContext::GetFromContext(context));
       TF_LITE_ENSURE_OK(context, bw_pass_status);
       return kTfLiteOk;
@@ -42,13 +42,30 @@ namespace fully_connected {
 
 namespace {
 bool SupportedSparsityFormat(const TfLiteSparsity& sparsity) {
-  if (sparsity.dim_metadata[0].format == kTfLiteDimDense &&
+  if (sparsity.dim_metadata_size == 2 &&
+      sparsity.dim_metadata[0].format == kTfLiteDimDense &&
       sparsity.dim_metadata[1].format == kTfLiteDimSparseCSR) {
     return true;
   }
 
   return false;
 }
+
+// Returns true if the weights are compressed in 1x4 blocks along the input
+// depth, the format produced by the converter for block-sparse weights.
+bool IsSparsityFormat1x4(const TfLiteSparsity& sparsity) {
+  const int kBlockSize = 4;
+  if (sparsity.dim_metadata_size == 3 && sparsity.block_map != nullptr &&
+      sparsity.block_map->size == 1 && sparsity.block_map->data[0] == 1 &&
+      sparsity.dim_metadata[0].format == kTfLiteDimDense &&
+      sparsity.dim_metadata[1].format == kTfLiteDimSparseCSR &&
+      sparsity.dim_metadata[2].format == kTfLiteDimDense &&
+      sparsity.dim_metadata[2].dense_size == kBlockSize) {
+    return true;
+  }
+
+  return false;
+}
 }  // namespace
 
 // This file has four implementations of FullyConnected
@@ -608,23 +625,34 @@ TfLiteStatus EvalFloat(TfLiteContext* context, TfLiteNode* node,
         GetTensorShape(filter), GetTensorData<float>(filter),
         GetTensorShape(bias), GetTensorData<float>(bias),
         GetTensorShape(output), GetTensorData<float>(output));
-  } else if (kernel_type == kSparseOptimized) {
+  } else if (kernel_type == kSparseOptimized || filter->sparsity != nullptr) {
+    // Sparse weights are run as they are, rather than densified, whichever
+    // optimized kernel is registered.
     FullyConnectedParams op_params;
     op_params.float_activation_min = output_activation_min;
     op_params.float_activation_max = output_activation_max;
     TF_LITE_ENSURE(context, filter->sparsity != nullptr);
 
     const auto& sparsity = *filter->sparsity;
-    if (!SupportedSparsityFormat(sparsity)) {
+    if (IsSparsityFormat1x4(sparsity)) {
+      optimized_ops::FullyConnectedSparseWeight1x4(
+          sparsity, op_params, GetTensorShape(input),
+          GetTensorData<float>(input), GetTensorShape(filter),
+          GetTensorData<float>(filter), GetTensorShape(bias),
+          GetTensorData<float>(bias), GetTensorShape(output),
+          GetTensorData<float>(output));
+    } else if (SupportedSparsityFormat(sparsity)) {
+      optimized_ops::FullyConnectedSparseWeight(
+          sparsity, op_params, GetTensorShape(input),
+          GetTensorData<float>(input), GetTensorShape(filter),
+          GetTensorData<float>(filter), GetTensorShape(bias),
+          GetTensorData<float>(bias), GetTensorShape(output),
+          GetTensorData<float>(output));
+    } else {
       context->ReportError(context,
                            "Unsupported sparse fully-connected weight format.");
       return kTfLiteError;
     }
-    optimized_ops::FullyConnectedSparseWeight(
-        sparsity, op_params, GetTensorShape(input), GetTensorData<float>(input),
-        GetTensorShape(filter), GetTensorData<float>(filter),
-        GetTensorShape(bias), GetTensorData<float>(bias),
-        GetTensorShape(output), GetTensorData<float>(output));
   } else if (kernel_type == kLegacyPie) {
     return EvalPie(context, node, params, data, input, filter, bias, output);
   } else {
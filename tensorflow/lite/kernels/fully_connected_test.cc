@@ -360,6 +360,7 @@ const auto kKernelMapNoPie = new std::map<string, TfLiteRegistration*>({
 const auto kKernelMapSparse = new std::map<string, TfLiteRegistration*>({
     {"SparseReference", ops::builtin::Register_FULLY_CONNECTED_SPARSE_REF()},
     {"SparseOptimized", ops::builtin::Register_FULLY_CONNECTED_SPARSE_OPT()},
+    {"GenericOptimized", ops::builtin::Register_FULLY_CONNECTED_GENERIC_OPT()},
 });
 
 class QuantizedFullyConnectedOpTest : public SingleOpTest {
@@ -1072,7 +1073,8 @@ class SparseFullyConnectedOpModel : public SingleOpModel {
   SparseFullyConnectedOpModel(TfLiteRegistration* registration, int units,
                               int batches, const TensorData& input,
                               std::initializer_list<int> weights_shape,
-                              std::initializer_list<T> weights_data)
+                              std::initializer_list<T> weights_data,
+                              int weights_block_size = 0)
       : batches_(batches), units_(units) {
     int total_input_size = 1;
     for (size_t i = 0; i < input.shape.size(); ++i) {
@@ -1081,7 +1083,11 @@ class SparseFullyConnectedOpModel : public SingleOpModel {
     input_size_ = total_input_size / batches_;
 
     input_ = AddInput(input);
-    weights_ = AddConstSparseInput(input.type, weights_shape, weights_data);
+    weights_ = weights_block_size > 0
+                   ? AddConstBlockSparseInput(input.type, weights_shape,
+                                              weights_data, weights_block_size)
+                   : AddConstSparseInput(input.type, weights_shape,
+                                         weights_data);
 
     TensorData bias{input.type, {units_}};
     bias_ = AddInput(bias);
@@ -1167,6 +1173,30 @@ TEST_P(SparseFullyConnectedOpTest, SimpleTest2) {
   EXPECT_THAT(m.GetOutput(), ElementsAre(11, 9));
 }
 
+TEST_P(SparseFullyConnectedOpTest, Simple1x4Test) {
+  std::initializer_list<int> weight_shape = {3, 8};
+  std::initializer_list<float> weight_data = {
+      1, 2,  3, 4,  0, 0, 0, 0,  // u = 0
+      0, 0,  0, 0,  0, 0, 0, 0,  // u = 1
+      1, -1, 1, -1, 2, 2, 2, 2,  // u = 2
+  };
+  SparseFullyConnectedOpModel<float> m(
+      GetRegistration(), /*units=*/3, /*batches=*/2,
+      /*input=*/{TensorType_FLOAT32, {2, 8}}, weight_shape, weight_data,
+      /*weights_block_size=*/4);
+  m.SetBias({1, 2, 3});
+
+  m.SetInput({
+      1, 2, 3, 4, 5,  6,  7,  8,   // b = 0
+      1, 1, 1, 1, -1, -1, -1, -1,  // b = 1
+  });
+
+  m.Invoke();
+
+  EXPECT_THAT(m.GetOutputShape(), ElementsAre(2, 3));
+  EXPECT_THAT(m.GetOutput(), ElementsAre(31, 2, 53, 11, 2, 0));
+}
+
 // TODO(b/148391360): Add tests for unsupported sparsity format.
 // TEST_P(SparseFullyConnectedOpTest, TestUnsupportedSparsityFormat)
 
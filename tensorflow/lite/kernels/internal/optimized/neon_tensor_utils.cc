@@ -1955,6 +1955,31 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate(
   }
 }
 
+void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  const int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      // Each 1x4 block fills exactly one NEON vector.
+      float32x4_t acc_32x4 = vmovq_n_f32(0.0);
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        float32x4_t vector_f32x4 =
+            vld1q_f32(vector_in_batch + indices[i] * kBlockSize);
+        float32x4_t matrix_f32x4 = vld1q_f32(matrix_ptr);
+        acc_32x4 = vmlaq_f32(acc_32x4, matrix_f32x4, vector_f32x4);
+        matrix_ptr += kBlockSize;
+      }
+      result[batch * m_rows + row] += AccumulateNeonLane(acc_32x4);
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ matrix, const uint8_t* ledger, const int m_rows,
     const int m_cols, const int8_t* __restrict__ vectors,
@@ -342,6 +342,36 @@ void SseSparseMatrixBatchVectorMultiplyAccumulate(
   }  // for batch
 }
 
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result) {
+  const int kBlockSize = 4;
+  TFLITE_DCHECK_EQ(m_cols % kBlockSize, 0);
+
+  for (int batch = 0; batch < n_batch; batch++) {
+    const float* matrix_ptr = matrix;
+    const float* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; row++) {
+      // Each 1x4 block fills exactly one XMM register.
+      __m128 acc_f32x4 = _mm_setzero_ps();
+      for (int i = segments[row]; i < segments[row + 1]; i++) {
+        const __m128 vector_f32x4 =
+            _mm_loadu_ps(vector_in_batch + indices[i] * kBlockSize);
+        const __m128 matrix_f32x4 = _mm_loadu_ps(matrix_ptr);
+        acc_f32x4 =
+            _mm_add_ps(acc_f32x4, _mm_mul_ps(matrix_f32x4, vector_f32x4));
+        matrix_ptr += kBlockSize;
+      }
+      // Horizontally add the four lanes of the accumulator.
+      acc_f32x4 = _mm_add_ps(acc_f32x4, _mm_movehl_ps(acc_f32x4, acc_f32x4));
+      acc_f32x4 =
+          _mm_add_ss(acc_f32x4, _mm_shuffle_ps(acc_f32x4, acc_f32x4, 1));
+      result[batch * m_rows + row] += _mm_cvtss_f32(acc_f32x4);
+    }
+  }
+}
+
 }  // namespace tensor_utils
 }  // namespace tflite
 
@@ -26,6 +26,13 @@ namespace tensor_utils {
 
 #ifdef __SSSE3__
 
+// Multiply a float matrix with 1x4 blocks in block CSR format by a batch
+// vector, and accumulate the results in a batch-size vector.
+void SseSparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
 // Matrix multiplication for quantized values using symmetric quantization.
 void SseMatrixBatchVectorMultiplyAccumulate(
     const int8_t* __restrict__ matrix, const int m_rows, const int m_cols,
@@ -80,6 +80,21 @@ void SparseMatrixBatchVectorMultiplyAccumulate(
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
     float* __restrict__ result);
 
+// Same as the function above, but the matrix is stored in block compressed
+// sparse row format with block pattern 1x4, as described by a TfLiteSparsity
+// with a dense first dimension, a CSR second dimension and a dense block
+// dimension of size 4:
+//   1. A matrix array stores non-zero blocks of the matrix in row major.
+//   2. A segments array of m_rows + 1 elements, where the non-zero blocks of
+//      row r are those with indexes in [segments[r], segments[r + 1]).
+//   3. An indices array stores the column index of each non-zero block, in
+//      units of blocks.
+// This function assumes that m_cols is a multiple of 4.
+void SparseMatrixBatchVectorMultiplyAccumulate1x4(
+    const float* __restrict__ matrix, const int32_t* __restrict__ segments,
+    const int32_t* __restrict__ indices, int m_rows, int m_cols,
+    const float* __restrict__ vector, int n_batch, float* __restrict__ result);
+
 // Same as the function above, but for values quantized using symmetric
 // quantization (e.g. by calling SymmetricQuantizeFloats).
 // The passed scaling factors is a buffer of the quantization scaling factors
@@ -1486,6 +1486,42 @@ TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulateTest) {
               ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
 }
 
+TEST(uKernels, SparseMatrixBatchVectorMultiplyAccumulate1x4Test) {
+  const int kRow = 3;
+  const int kCol = 12;
+  const int kBatch = 2;
+  /* clang-format off */
+  float matrix[kRow * kCol] = {
+      1.1, 2.2, 3.3, 4.4, 0.0, 0.0, 0.0, 0.0, 9.9, -1.0, 0.0, 2.5,
+      0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
+      0.0, 0.0, 0.0, 0.0, -5.5, 6.6, -7.7, 8.8, 1.0, 2.0, 3.0, 4.0};
+
+  // 1x4 block CSR format of the above matrix.
+  float matrix_values[] = {
+      1.1, 2.2, 3.3, 4.4, 9.9, -1.0, 0.0, 2.5,  // 1st row
+      -5.5, 6.6, -7.7, 8.8, 1.0, 2.0, 3.0, 4.0  // 3rd row
+  };
+  int32_t segments[] = {0, 2, 2, 4};
+  int32_t indices[] = {0, 2, 1, 2};
+
+  float vector[kBatch * kCol] = {
+      1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0,
+      2.5, 0.0, -2.1, 0.0, 3.0, 0.0, -1.3, 0.0, 1.3, 0.5, -1.1, 0.2};
+  /* clang-format on */
+
+  std::vector<float> dense_output(kRow * kBatch, 0.0);
+  MatrixBatchVectorMultiplyAccumulate(matrix, kRow, kCol, vector, kBatch,
+                                      dense_output.data());
+
+  std::vector<float> sparse_output(kRow * kBatch, 0.0);
+  SparseMatrixBatchVectorMultiplyAccumulate1x4(matrix_values, segments,
+                                               indices, kRow, kCol, vector,
+                                               kBatch, sparse_output.data());
+
+  EXPECT_THAT(sparse_output,
+              ElementsAreArray(ArrayFloatNear(dense_output, 1e-4)));
+}
+
 #ifdef __ANDROID__
 TEST(uKernels,
      SparseMatrixBatchVectorMultiplyAccumulateSymmetricQuantizedTest) {
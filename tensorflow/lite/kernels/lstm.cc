@@ -55,6 +55,10 @@ struct OpData {
   // These fields are only used by full kernel.
   int scratch_tensor_index;
   lstm_eval::IntegerLstmParameter integer_lstm_param;
+
+  // Gate weights packed for the hybrid kernel. Empty unless the op is hybrid
+  // and its weights are constant.
+  lstm_eval::HybridLstmPackedWeights hybrid_packed_weights;
 };
 
 namespace full {
@@ -1247,6 +1251,22 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     node->temporaries = TfLiteIntArrayCreate(1);
   }
 
+  // Pack the gate weights so that the hybrid kernel computes all gates with
+  // one matrix multiplication. They are constant, so it suffices to do so once.
+  if (is_hybrid_op && op_data->hybrid_packed_weights.n_gates == 0) {
+    lstm_eval::PackHybridLstmWeights(
+        GetOptionalInputTensor(context, node, kInputToInputWeightsTensor),
+        GetInput(context, node, kInputToForgetWeightsTensor),
+        GetInput(context, node, kInputToCellWeightsTensor),
+        input_to_output_weights,
+        GetOptionalInputTensor(context, node, kRecurrentToInputWeightsTensor),
+        GetInput(context, node, kRecurrentToForgetWeightsTensor),
+        GetInput(context, node, kRecurrentToCellWeightsTensor),
+        recurrent_to_output_weights, &op_data->hybrid_packed_weights);
+  }
+  const int n_packed_gates =
+      is_hybrid_op ? op_data->hybrid_packed_weights.n_gates : 0;
+
   // Create a scratch buffer tensor for float case and hybrid case.
   // TODO(b/152066492): Create a is_float boolean and reorganize the temporary
   // buffer allocation logic.
@@ -1268,6 +1288,8 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
       // Reserving space for Input, Cell, Forget, Output gates
       scratch_buffer_size->data[1] = n_cell * 4;
     }
+    // Reserving space for the products of the packed gate weights.
+    scratch_buffer_size->data[1] += n_packed_gates * n_cell;
     TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                      scratch_buffer_size));
   }
@@ -1361,11 +1383,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TfLiteTensor* accum_scratch = GetTemporary(context, node, /*index=*/7);
     accum_scratch->type = kTfLiteInt32;
     accum_scratch->allocation_type = kTfLiteArenaRw;
-    int accum_scratch_dims[2] = {n_cell, n_batch};
+    const int n_accum_rows = n_cell * std::max(n_packed_gates, 1);
+    int accum_scratch_dims[2] = {n_accum_rows, n_batch};
     if (!TfLiteIntArrayEqualsArray(accum_scratch->dims, 2,
                                    accum_scratch_dims)) {
       TfLiteIntArray* accum_size = TfLiteIntArrayCreate(2);
-      accum_size->data[0] = n_cell;
+      accum_size->data[0] = n_accum_rows;
       accum_size->data[1] = n_batch;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, accum_scratch, accum_size));
@@ -1577,8 +1600,11 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
             input_quantized,
             /*aux_input_quantized=*/nullptr, activation_state_quantized,
             cell_state_quantized, activation_state, cell_state,
-            output_scratch_buffer, output,
-            CpuBackendContext::GetFromContext(context));
+            output_scratch_buffer,
+            op_data->hybrid_packed_weights.n_gates > 0
+                ? &op_data->hybrid_packed_weights
+                : nullptr,
+            output, CpuBackendContext::GetFromContext(context));
       } else {
         const int num_intermediate_tensors = node->intermediates->size;
         if (num_intermediate_tensors == 5) {
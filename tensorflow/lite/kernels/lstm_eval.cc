@@ -53,6 +53,32 @@ inline void MatrixBatchVectorMultiplyAccumulate(
 #endif
 }
 
+// Multiplies the weights of all gates, packed into one matrix of
+// 'n_gates * n_cell' rows, by a quantized batch vector, and accumulates the
+// products, scaled by the weights scale of each gate, to the gate scratches.
+inline void PackedGatesMatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ packed_weights, const float* weights_scales,
+    int n_gates, int n_cell, int n_cols, const int8_t* __restrict__ vectors,
+    const float* scaling_factors, int n_batch, float* packed_gate_scratch,
+    float* const* gate_scratch, int32_t* accum_scratch,
+    CpuBackendContext* context) {
+  const int n_rows = n_gates * n_cell;
+  std::fill_n(packed_gate_scratch, n_rows * n_batch, 0.0f);
+  MatrixBatchVectorMultiplyAccumulate(packed_weights, n_rows, n_cols, vectors,
+                                      scaling_factors, n_batch, accum_scratch,
+                                      packed_gate_scratch, context);
+  for (int b = 0; b < n_batch; ++b) {
+    for (int g = 0; g < n_gates; ++g) {
+      const float weights_scale = weights_scales[g];
+      const float* products = packed_gate_scratch + (b * n_gates + g) * n_cell;
+      float* scratch = gate_scratch[g] + b * n_cell;
+      for (int c = 0; c < n_cell; ++c) {
+        scratch[c] += weights_scale * products[c];
+      }
+    }
+  }
+}
+
 // Performs an LSTM batch inference step for input specified by input_ptr.
 // The LSTM cell is specified by the pointers to its weights (*_weights_ptr) and
 // biases (*_bias_ptr), and buffers (*_scratch), along with additional
@@ -417,12 +443,20 @@ inline void LstmStepFloat(
 //   cell_layer_norm_coefficients_ptr   - optional
 //   output_layer_norm_coefficients_ptr - optional
 //
+// Quantized weights of all gates, packed gate after gate in the order input
+// (unless CIFG), forget, cell, output. If given, they are used instead of the
+// input and recurrent weights above:
+//   packed_input_weights_ptr          - optional
+//   packed_recurrent_weights_ptr      - optional
+//
 // Temporary pre-allocated storage for quantized values:
 //   quantized_input_ptr (same size as input_ptr)
 //   quantized_output_state_ptr (same size as output_state_ptr)
 //   quantized_cell_state_ptr (same size as cell_state_ptr)
 // Temporary pre-allocated storage for recovered values:
 //   recovered_cell_weights (same size as cell_to_*_weights)
+// Temporary pre-allocated storage for the products of the packed weights:
+//   packed_gate_scratch (size 'n_batch * n_gates * n_cell')
 //
 // Outputs:
 //   output_state_ptr - size 'n_batch * n_output'
@@ -464,11 +498,13 @@ inline void LstmStepHybrid(
     const float* input_gate_bias_ptr, const float* forget_gate_bias_ptr,
     const float* cell_bias_ptr, const float* output_gate_bias_ptr,
     const int8_t* projection_weights_ptr, float projection_weights_scale,
-    const float* projection_bias_ptr, const TfLiteLSTMParams* params,
+    const float* projection_bias_ptr, const int8_t* packed_input_weights_ptr,
+    const int8_t* packed_recurrent_weights_ptr, const TfLiteLSTMParams* params,
     int n_batch, int n_cell, int n_input, int n_aux_input, int n_output,
     int output_batch_leading_dim, float* input_gate_scratch,
     float* forget_gate_scratch, float* cell_scratch, float* output_gate_scratch,
-    float* scaling_factors, float* product_scaling_factors,
+    float* packed_gate_scratch, float* scaling_factors,
+    float* product_scaling_factors,
     float* recovered_cell_weights, int8_t* quantized_input_ptr,
     int8_t* quantized_aux_input_ptr, int8_t* quantized_output_state_ptr,
     int8_t* quantized_cell_state_ptr, float* output_state_ptr,
@@ -503,6 +539,26 @@ inline void LstmStepHybrid(
                                           output_gate_scratch);
   }
 
+  // Gather the gates in the order of the packed weights.
+  int n_gates = 0;
+  float* gate_scratch[4];
+  float input_weights_scales[4];
+  float recurrent_weights_scales[4];
+  if (!use_cifg) {
+    gate_scratch[n_gates] = input_gate_scratch;
+    input_weights_scales[n_gates] = input_to_input_weights_scale;
+    recurrent_weights_scales[n_gates++] = recurrent_to_input_weights_scale;
+  }
+  gate_scratch[n_gates] = forget_gate_scratch;
+  input_weights_scales[n_gates] = input_to_forget_weights_scale;
+  recurrent_weights_scales[n_gates++] = recurrent_to_forget_weights_scale;
+  gate_scratch[n_gates] = cell_scratch;
+  input_weights_scales[n_gates] = input_to_cell_weights_scale;
+  recurrent_weights_scales[n_gates++] = recurrent_to_cell_weights_scale;
+  gate_scratch[n_gates] = output_gate_scratch;
+  input_weights_scales[n_gates] = input_to_output_weights_scale;
+  recurrent_weights_scales[n_gates++] = recurrent_to_output_weights_scale;
+
   // For each batch and cell: compute input_weight * input.
   // Skip if input is all zeros.
   if (!tensor_utils::IsZeroVector(input_ptr, n_batch * n_input)) {
@@ -513,43 +569,50 @@ inline void LstmStepHybrid(
           input_ptr + offset, n_input, quantized_input_ptr + offset,
           &unused_min, &unused_max, &scaling_factors[b]);
     }
-    if (!use_cifg) {
+    if (packed_input_weights_ptr != nullptr) {
+      PackedGatesMatrixBatchVectorMultiplyAccumulate(
+          packed_input_weights_ptr, input_weights_scales, n_gates, n_cell,
+          n_input, quantized_input_ptr, scaling_factors, n_batch,
+          packed_gate_scratch, gate_scratch, accum_scratch_ptr, context);
+    } else {
+      if (!use_cifg) {
+        for (int b = 0; b < n_batch; ++b) {
+          product_scaling_factors[b] =
+              scaling_factors[b] * input_to_input_weights_scale;
+        }
+        MatrixBatchVectorMultiplyAccumulate(
+            input_to_input_weights_ptr, n_cell, n_input, quantized_input_ptr,
+            product_scaling_factors, n_batch, accum_scratch_ptr,
+            input_gate_scratch, context);
+      }
+
       for (int b = 0; b < n_batch; ++b) {
         product_scaling_factors[b] =
-            scaling_factors[b] * input_to_input_weights_scale;
+            scaling_factors[b] * input_to_forget_weights_scale;
       }
       MatrixBatchVectorMultiplyAccumulate(
-          input_to_input_weights_ptr, n_cell, n_input, quantized_input_ptr,
+          input_to_forget_weights_ptr, n_cell, n_input, quantized_input_ptr,
           product_scaling_factors, n_batch, accum_scratch_ptr,
-          input_gate_scratch, context);
-    }
+          forget_gate_scratch, context);
 
-    for (int b = 0; b < n_batch; ++b) {
-      product_scaling_factors[b] =
-          scaling_factors[b] * input_to_forget_weights_scale;
-    }
-    MatrixBatchVectorMultiplyAccumulate(
-        input_to_forget_weights_ptr, n_cell, n_input, quantized_input_ptr,
-        product_scaling_factors, n_batch, accum_scratch_ptr,
-        forget_gate_scratch, context);
-
-    for (int b = 0; b < n_batch; ++b) {
-      product_scaling_factors[b] =
-          scaling_factors[b] * input_to_cell_weights_scale;
-    }
-    MatrixBatchVectorMultiplyAccumulate(
-        input_to_cell_weights_ptr, n_cell, n_input, quantized_input_ptr,
-        product_scaling_factors, n_batch, accum_scratch_ptr, cell_scratch,
-        context);
+      for (int b = 0; b < n_batch; ++b) {
+        product_scaling_factors[b] =
+            scaling_factors[b] * input_to_cell_weights_scale;
+      }
+      MatrixBatchVectorMultiplyAccumulate(
+          input_to_cell_weights_ptr, n_cell, n_input, quantized_input_ptr,
+          product_scaling_factors, n_batch, accum_scratch_ptr, cell_scratch,
+          context);
 
-    for (int b = 0; b < n_batch; ++b) {
-      product_scaling_factors[b] =
-          scaling_factors[b] * input_to_output_weights_scale;
+      for (int b = 0; b < n_batch; ++b) {
+        product_scaling_factors[b] =
+            scaling_factors[b] * input_to_output_weights_scale;
+      }
+      MatrixBatchVectorMultiplyAccumulate(
+          input_to_output_weights_ptr, n_cell, n_input, quantized_input_ptr,
+          product_scaling_factors, n_batch, accum_scratch_ptr,
+          output_gate_scratch, context);
     }
-    MatrixBatchVectorMultiplyAccumulate(
-        input_to_output_weights_ptr, n_cell, n_input, quantized_input_ptr,
-        product_scaling_factors, n_batch, accum_scratch_ptr,
-        output_gate_scratch, context);
   }
 
   // For each batch and cell: compute aux_input_weight * aux_input.
@@ -613,43 +676,51 @@ inline void LstmStepHybrid(
                                             &scaling_factors[b]);
     }
     // For each batch and cell: compute recurrent_weight * output_state.
-    if (!use_cifg) {
+    if (packed_recurrent_weights_ptr != nullptr) {
+      PackedGatesMatrixBatchVectorMultiplyAccumulate(
+          packed_recurrent_weights_ptr, recurrent_weights_scales, n_gates,
+          n_cell, n_output, quantized_output_state_ptr, scaling_factors,
+          n_batch, packed_gate_scratch, gate_scratch, accum_scratch_ptr,
+          context);
+    } else {
+      if (!use_cifg) {
+        for (int b = 0; b < n_batch; ++b) {
+          product_scaling_factors[b] =
+              scaling_factors[b] * recurrent_to_input_weights_scale;
+        }
+        MatrixBatchVectorMultiplyAccumulate(
+            recurrent_to_input_weights_ptr, n_cell, n_output,
+            quantized_output_state_ptr, product_scaling_factors, n_batch,
+            accum_scratch_ptr, input_gate_scratch, context);
+      }
+
       for (int b = 0; b < n_batch; ++b) {
         product_scaling_factors[b] =
-            scaling_factors[b] * recurrent_to_input_weights_scale;
+            scaling_factors[b] * recurrent_to_forget_weights_scale;
       }
       MatrixBatchVectorMultiplyAccumulate(
-          recurrent_to_input_weights_ptr, n_cell, n_output,
+          recurrent_to_forget_weights_ptr, n_cell, n_output,
           quantized_output_state_ptr, product_scaling_factors, n_batch,
-          accum_scratch_ptr, input_gate_scratch, context);
-    }
+          accum_scratch_ptr, forget_gate_scratch, context);
 
-    for (int b = 0; b < n_batch; ++b) {
-      product_scaling_factors[b] =
-          scaling_factors[b] * recurrent_to_forget_weights_scale;
-    }
-    MatrixBatchVectorMultiplyAccumulate(
-        recurrent_to_forget_weights_ptr, n_cell, n_output,
-        quantized_output_state_ptr, product_scaling_factors, n_batch,
-        accum_scratch_ptr, forget_gate_scratch, context);
-
-    for (int b = 0; b < n_batch; ++b) {
-      product_scaling_factors[b] =
-          scaling_factors[b] * recurrent_to_cell_weights_scale;
-    }
-    MatrixBatchVectorMultiplyAccumulate(
-        recurrent_to_cell_weights_ptr, n_cell, n_output,
-        quantized_output_state_ptr, product_scaling_factors, n_batch,
-        accum_scratch_ptr, cell_scratch, context);
+      for (int b = 0; b < n_batch; ++b) {
+        product_scaling_factors[b] =
+            scaling_factors[b] * recurrent_to_cell_weights_scale;
+      }
+      MatrixBatchVectorMultiplyAccumulate(
+          recurrent_to_cell_weights_ptr, n_cell, n_output,
+          quantized_output_state_ptr, product_scaling_factors, n_batch,
+          accum_scratch_ptr, cell_scratch, context);
 
-    for (int b = 0; b < n_batch; ++b) {
-      product_scaling_factors[b] =
-          scaling_factors[b] * recurrent_to_output_weights_scale;
+      for (int b = 0; b < n_batch; ++b) {
+        product_scaling_factors[b] =
+            scaling_factors[b] * recurrent_to_output_weights_scale;
+      }
+      MatrixBatchVectorMultiplyAccumulate(
+          recurrent_to_output_weights_ptr, n_cell, n_output,
+          quantized_output_state_ptr, product_scaling_factors, n_batch,
+          accum_scratch_ptr, output_gate_scratch, context);
     }
-    MatrixBatchVectorMultiplyAccumulate(
-        recurrent_to_output_weights_ptr, n_cell, n_output,
-        quantized_output_state_ptr, product_scaling_factors, n_batch,
-        accum_scratch_ptr, output_gate_scratch, context);
   }
 
   // For each batch and cell: update input gate.
@@ -1584,6 +1655,46 @@ TfLiteStatus EvalFloat(
 }
 // LINT.ThenChange(//tensorflow/lite/tools/optimize/calibration/builtin_logging_ops/lstm.cc)
 
+void PackHybridLstmWeights(const TfLiteTensor* input_to_input_weights,
+                           const TfLiteTensor* input_to_forget_weights,
+                           const TfLiteTensor* input_to_cell_weights,
+                           const TfLiteTensor* input_to_output_weights,
+                           const TfLiteTensor* recurrent_to_input_weights,
+                           const TfLiteTensor* recurrent_to_forget_weights,
+                           const TfLiteTensor* recurrent_to_cell_weights,
+                           const TfLiteTensor* recurrent_to_output_weights,
+                           HybridLstmPackedWeights* packed_weights) {
+  const TfLiteTensor* input_weights[] = {
+      input_to_input_weights, input_to_forget_weights, input_to_cell_weights,
+      input_to_output_weights};
+  const TfLiteTensor* recurrent_weights[] = {
+      recurrent_to_input_weights, recurrent_to_forget_weights,
+      recurrent_to_cell_weights, recurrent_to_output_weights};
+  packed_weights->n_gates = 0;
+  packed_weights->input_weights.clear();
+  packed_weights->recurrent_weights.clear();
+  for (int g = 0; g < 4; ++g) {
+    if (input_weights[g] == nullptr) continue;
+    if (input_weights[g]->allocation_type != kTfLiteMmapRo ||
+        recurrent_weights[g]->allocation_type != kTfLiteMmapRo) {
+      return;
+    }
+  }
+  for (int g = 0; g < 4; ++g) {
+    // The input gate is missing for CIFG.
+    if (input_weights[g] == nullptr) continue;
+    const int8_t* input_data = GetTensorData<int8_t>(input_weights[g]);
+    packed_weights->input_weights.insert(
+        packed_weights->input_weights.end(), input_data,
+        input_data + input_weights[g]->bytes);
+    const int8_t* recurrent_data = GetTensorData<int8_t>(recurrent_weights[g]);
+    packed_weights->recurrent_weights.insert(
+        packed_weights->recurrent_weights.end(), recurrent_data,
+        recurrent_data + recurrent_weights[g]->bytes);
+    ++packed_weights->n_gates;
+  }
+}
+
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -1615,7 +1726,8 @@ TfLiteStatus EvalHybrid(
     TfLiteTensor* aux_input_quantized, TfLiteTensor* output_state_quantized,
     TfLiteTensor* cell_state_quantized, TfLiteTensor* output_state,
     TfLiteTensor* cell_state, TfLiteTensor* output_scratch_buffer,
-    TfLiteTensor* output, CpuBackendContext* context) {
+    const HybridLstmPackedWeights* packed_weights, TfLiteTensor* output,
+    CpuBackendContext* context) {
   TF_LITE_ASSERT(input->dims->size >= 2 && input->dims->size <= 3);
   const int n_input = input->dims->data[input->dims->size - 1];
   int max_time, n_batch;
@@ -1652,6 +1764,16 @@ TfLiteStatus EvalHybrid(
     output_gate_scratch = scratch_buffer_ptr + 3 * n_cell * n_batch;
   }
 
+  const int8_t* packed_input_weights_ptr = nullptr;
+  const int8_t* packed_recurrent_weights_ptr = nullptr;
+  float* packed_gate_scratch = nullptr;
+  if (packed_weights != nullptr) {
+    packed_input_weights_ptr = packed_weights->input_weights.data();
+    packed_recurrent_weights_ptr = packed_weights->recurrent_weights.data();
+    packed_gate_scratch =
+        scratch_buffer_ptr + packed_weights->n_gates * n_cell * n_batch;
+  }
+
   const int output_batch_leading_dim =
       output->dims->data[output->dims->size - 1];
   if (time_major) {
@@ -1710,10 +1832,12 @@ TfLiteStatus EvalHybrid(
           GetTensorData<float>(output_gate_bias),
           GetTensorData<int8_t>(projection_weights),
           GetTensorScale(projection_weights),
-          GetTensorData<float>(projection_bias), params, n_batch, n_cell,
-          n_input, aux_input_size, n_output, output_batch_leading_dim,
+          GetTensorData<float>(projection_bias), packed_input_weights_ptr,
+          packed_recurrent_weights_ptr, params, n_batch, n_cell, n_input,
+          aux_input_size, n_output, output_batch_leading_dim,
           input_gate_scratch, forget_gate_scratch, cell_scratch,
-          output_gate_scratch, GetTensorData<float>(scaling_factors),
+          output_gate_scratch, packed_gate_scratch,
+          GetTensorData<float>(scaling_factors),
           GetTensorData<float>(prod_scaling_factors),
           GetTensorData<float>(recovered_cell_weights),
           GetTensorData<int8_t>(input_quantized),
@@ -1794,11 +1918,12 @@ TfLiteStatus EvalHybrid(
             GetTensorData<float>(output_gate_bias),
             GetTensorData<int8_t>(projection_weights),
             GetTensorScale(projection_weights),
-            GetTensorData<float>(projection_bias), params,
+            GetTensorData<float>(projection_bias), packed_input_weights_ptr,
+            packed_recurrent_weights_ptr, params,
             /*n_batch=*/1, n_cell, n_input, aux_input_size, n_output,
             output_batch_leading_dim, input_gate_scratch_ptr,
             forget_gate_scratch_ptr, cell_scratch_ptr, output_gate_scratch_ptr,
-            GetTensorData<float>(scaling_factors),
+            packed_gate_scratch, GetTensorData<float>(scaling_factors),
             GetTensorData<float>(prod_scaling_factors),
             GetTensorData<float>(recovered_cell_weights),
             GetTensorData<int8_t>(input_quantized),
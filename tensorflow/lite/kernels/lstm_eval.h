@@ -96,6 +96,28 @@ struct IntegerLstmParameter {
   int32_t intermediate_zp[12];
 };
 
+// Weights of the gates of a hybrid LSTM, packed gate after gate into one
+// matrix for the input and one for the recurrent weights, so that each step
+// computes all gates with one matrix multiplication per operand. The gates
+// are in the order input (unless CIFG), forget, cell, output.
+struct HybridLstmPackedWeights {
+  int n_gates = 0;
+  std::vector<int8_t> input_weights;      // size 'n_gates * n_cell * n_input'
+  std::vector<int8_t> recurrent_weights;  // size 'n_gates * n_cell * n_output'
+};
+
+// Packs the int8 gate weights into `packed_weights`, or leaves it empty
+// unless all of them are constant. The input gate weights are optional.
+void PackHybridLstmWeights(const TfLiteTensor* input_to_input_weights,
+                           const TfLiteTensor* input_to_forget_weights,
+                           const TfLiteTensor* input_to_cell_weights,
+                           const TfLiteTensor* input_to_output_weights,
+                           const TfLiteTensor* recurrent_to_input_weights,
+                           const TfLiteTensor* recurrent_to_forget_weights,
+                           const TfLiteTensor* recurrent_to_cell_weights,
+                           const TfLiteTensor* recurrent_to_output_weights,
+                           HybridLstmPackedWeights* packed_weights);
+
 TfLiteStatus EvalFloat(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -125,6 +147,10 @@ TfLiteStatus EvalFloat(
     TfLiteTensor* activation_state, TfLiteTensor* cell_state,
     TfLiteTensor* output);
 
+// If `packed_weights` is not null, the input and recurrent gates are computed
+// from the packed weights. The scratch buffer then needs room for another
+// 'n_batch * n_gates * n_cell' values after those of the gates, and the
+// output scratch buffer for 'n_batch * n_gates * n_cell' values.
 TfLiteStatus EvalHybrid(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
     const TfLiteTensor* input_to_forget_weights,
@@ -156,7 +182,8 @@ TfLiteStatus EvalHybrid(
     TfLiteTensor* aux_input_quantized, TfLiteTensor* output_state_quantized,
     TfLiteTensor* cell_state_quantized, TfLiteTensor* output_state,
     TfLiteTensor* cell_state, TfLiteTensor* output_scratch_buffer,
-    TfLiteTensor* output, CpuBackendContext* context);
+    const HybridLstmPackedWeights* packed_weights, TfLiteTensor* output,
+    CpuBackendContext* context);
 
 TfLiteStatus EvalInteger8x8_16(
     const TfLiteTensor* input, const TfLiteTensor* input_to_input_weights,
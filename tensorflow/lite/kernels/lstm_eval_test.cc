@@ -603,5 +603,44 @@ void TestOneFullyQuantizedLSTM() {
 TEST(TestOneFullyQuantizedLSTM, TestOneFullyQuantizedLSTM) {
   TestOneFullyQuantizedLSTM();
 }
+
+TfLiteTensor MakeHybridWeights(std::vector<int8_t>* data,
+                               TfLiteAllocationType allocation_type) {
+  TfLiteTensor tensor = {};
+  tensor.type = kTfLiteInt8;
+  tensor.allocation_type = allocation_type;
+  tensor.data.int8 = data->data();
+  tensor.bytes = data->size();
+  return tensor;
+}
+
+TEST(PackHybridLstmWeights, PacksConstantWeightsGateAfterGate) {
+  std::vector<int8_t> i2f = {1, 2}, i2c = {3, 4}, i2o = {5, 6};
+  std::vector<int8_t> r2f = {-1}, r2c = {-2}, r2o = {-3};
+  TfLiteTensor i2f_tensor = MakeHybridWeights(&i2f, kTfLiteMmapRo);
+  TfLiteTensor i2c_tensor = MakeHybridWeights(&i2c, kTfLiteMmapRo);
+  TfLiteTensor i2o_tensor = MakeHybridWeights(&i2o, kTfLiteMmapRo);
+  TfLiteTensor r2f_tensor = MakeHybridWeights(&r2f, kTfLiteMmapRo);
+  TfLiteTensor r2c_tensor = MakeHybridWeights(&r2c, kTfLiteMmapRo);
+  TfLiteTensor r2o_tensor = MakeHybridWeights(&r2o, kTfLiteMmapRo);
+
+  // CIFG, so there is no input gate.
+  ops::builtin::lstm_eval::HybridLstmPackedWeights packed;
+  ops::builtin::lstm_eval::PackHybridLstmWeights(
+      nullptr, &i2f_tensor, &i2c_tensor, &i2o_tensor, nullptr, &r2f_tensor,
+      &r2c_tensor, &r2o_tensor, &packed);
+  EXPECT_EQ(packed.n_gates, 3);
+  EXPECT_THAT(packed.input_weights, testing::ElementsAre(1, 2, 3, 4, 5, 6));
+  EXPECT_THAT(packed.recurrent_weights, testing::ElementsAre(-1, -2, -3));
+
+  // Weights that may change between invocations are not packed.
+  r2c_tensor.allocation_type = kTfLiteArenaRw;
+  ops::builtin::lstm_eval::PackHybridLstmWeights(
+      nullptr, &i2f_tensor, &i2c_tensor, &i2o_tensor, nullptr, &r2f_tensor,
+      &r2c_tensor, &r2o_tensor, &packed);
+  EXPECT_EQ(packed.n_gates, 0);
+  EXPECT_TRUE(packed.input_weights.empty());
+  EXPECT_TRUE(packed.recurrent_weights.empty());
+}
 }  // namespace
 }  // namespace tflite
@@ -197,6 +197,15 @@ class SingleOpModel {
     return AddSparseTensor(TensorData{type, shape}, data);
   }
 
+  // Same as above, but the compressed dimension is split into dense blocks of
+  // `block_size` elements, e.g. 4 for 1x4 blocks of a 2D tensor.
+  template <typename T>
+  int AddConstBlockSparseInput(TensorType type,
+                               std::initializer_list<int> shape,
+                               std::initializer_list<T> data, int block_size) {
+    return AddSparseTensor(TensorData{type, shape}, data, block_size);
+  }
+
   // Add a null input tensor (optional input) and return kTfLiteOptionalTensor.
   int AddNullInput();
 
@@ -606,23 +615,31 @@ class SingleOpModel {
   }
 
   template <typename T>
-  int AddSparseTensor(const TensorData& t, std::initializer_list<T> data) {
+  int AddSparseTensor(const TensorData& t, std::initializer_list<T> data,
+                      int block_size = 0) {
     int id = tensors_.size();
     const auto& shape = t.shape;
     const int dims_count = shape.size();
-    std::vector<TfLiteDimensionType> format(dims_count);
-    std::vector<int> traversal_order(dims_count);
+    std::vector<int> block_map;
+    std::vector<int> block_sizes;
+    if (block_size > 0) {
+      block_map.push_back(dims_count - 1);
+      block_sizes.push_back(block_size);
+    }
+    const int expanded_dims_count = dims_count + block_map.size();
+    std::vector<TfLiteDimensionType> format(expanded_dims_count);
+    std::vector<int> traversal_order(expanded_dims_count);
     std::vector<T> dense_data(data);
 
     // Compress only the last dimension and traverse in the original order.
-    for (int i = 0; i < dims_count; i++) {
+    for (int i = 0; i < expanded_dims_count; i++) {
       format[i] = kTfLiteDimDense;
       traversal_order[i] = i;
     }
     format[dims_count - 1] = kTfLiteDimSparseCSR;
 
     tflite::optimize::sparsity::FormatConverter<T> converter(
-        shape, traversal_order, format);
+        shape, traversal_order, format, block_sizes, block_map);
     converter.DenseToSparse(dense_data.data());
 
     const auto& dim_metadata = converter.GetDimMetadata();
@@ -630,30 +647,32 @@ class SingleOpModel {
 
     // Build sparsity parameter.
     std::vector<flatbuffers::Offset<DimensionMetadata>> fb_dim_metadata(
-        dims_count);
-    for (int i = 0; i < dims_count - 1; i++) {
+        expanded_dims_count);
+    for (int i = 0; i < expanded_dims_count; i++) {
       const int metadata_idx = 2 * i;
+      if (format[i] == kTfLiteDimDense) {
+        fb_dim_metadata[i] = CreateDimensionMetadata(
+            builder_, DimensionType_DENSE, dim_metadata[metadata_idx][0]);
+        continue;
+      }
+
+      // Parameters for the compressed dimension.
+      auto array_segments =
+          CreateInt32Vector(builder_,
+                            builder_.CreateVector(dim_metadata[metadata_idx]))
+              .Union();
+      auto array_indices =
+          CreateInt32Vector(
+              builder_, builder_.CreateVector(dim_metadata[metadata_idx + 1]))
+              .Union();
       fb_dim_metadata[i] = CreateDimensionMetadata(
-          builder_, DimensionType_DENSE, dim_metadata[metadata_idx][0]);
+          builder_, DimensionType_SPARSE_CSR, 0, SparseIndexVector_Int32Vector,
+          array_segments, SparseIndexVector_Int32Vector, array_indices);
     }
 
-    // Parameters for the last compressed dimension.
-    const int compressed_metadata_idx = 2 * (dims_count - 1);
-    auto array_segments =
-        CreateInt32Vector(builder_, builder_.CreateVector(
-                                        dim_metadata[compressed_metadata_idx]))
-            .Union();
-    auto array_indices =
-        CreateInt32Vector(
-            builder_,
-            builder_.CreateVector(dim_metadata[compressed_metadata_idx + 1]))
-            .Union();
-    fb_dim_metadata[dims_count - 1] = CreateDimensionMetadata(
-        builder_, DimensionType_SPARSE_CSR, 0, SparseIndexVector_Int32Vector,
-        array_segments, SparseIndexVector_Int32Vector, array_indices);
-
     flatbuffers::Offset<SparsityParameters> s_param = CreateSparsityParameters(
-        builder_, builder_.CreateVector(traversal_order), 0,
+        builder_, builder_.CreateVector(traversal_order),
+        block_map.empty() ? 0 : builder_.CreateVector(block_map),
         builder_.CreateVector(fb_dim_metadata));
 
     int buffer_id = 0;
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <cstddef>
 
 #include "tensorflow/lite/c/builtin_op_data.h"
@@ -33,6 +34,9 @@ struct OpData {
   bool is_layer_norm_lstm;
   // The scratch tensor index.
   int scratch_tensor_index;
+  // Gate weights packed for the hybrid kernel. Empty unless the op is hybrid
+  // and its weights are constant.
+  lstm_eval::HybridLstmPackedWeights hybrid_packed_weights;
 };
 
 // Input Tensors of size {max_time, n_batch, n_input}
@@ -387,6 +391,23 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
   }
   node->temporaries->data[0] = scratch_tensor_index;
 
+  // Pack the gate weights so that the hybrid kernel computes all gates with
+  // one matrix multiplication. They are constant, so it suffices to do so once.
+  const bool is_hybrid_op = IsHybridOp(input, input_to_output_weights);
+  if (is_hybrid_op && op_data->hybrid_packed_weights.n_gates == 0) {
+    lstm_eval::PackHybridLstmWeights(
+        GetOptionalInputTensor(context, node, kInputToInputWeightsTensor),
+        GetInput(context, node, kInputToForgetWeightsTensor),
+        GetInput(context, node, kInputToCellWeightsTensor),
+        input_to_output_weights,
+        GetOptionalInputTensor(context, node, kRecurrentToInputWeightsTensor),
+        GetInput(context, node, kRecurrentToForgetWeightsTensor),
+        GetInput(context, node, kRecurrentToCellWeightsTensor),
+        recurrent_to_output_weights, &op_data->hybrid_packed_weights);
+  }
+  const int n_packed_gates =
+      is_hybrid_op ? op_data->hybrid_packed_weights.n_gates : 0;
+
   // Create a scratch buffer tensor.
   TfLiteTensor* scratch_buffer = GetTemporary(context, node, kScratchBuffer);
   scratch_buffer->type = input->type;
@@ -404,10 +425,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     // Reserving space for Input, Cell, Forget, Output gates
     scratch_buffer_size->data[1] = n_cell * 4;
   }
+  // Reserving space for the products of the packed gate weights.
+  scratch_buffer_size->data[1] += n_packed_gates * n_cell;
   TF_LITE_ENSURE_OK(context, context->ResizeTensor(context, scratch_buffer,
                                                    scratch_buffer_size));
 
-  if (IsHybridOp(input, input_to_output_weights)) {
+  if (is_hybrid_op) {
     // Allocate temporary tensors to store quantized values of input,
     // activation_state and cell_state tensors.
     node->temporaries->data[kInputQuantized] =
@@ -506,11 +529,12 @@ TfLiteStatus Prepare(TfLiteContext* context, TfLiteNode* node) {
     TfLiteTensor* accum_scratch = GetTemporary(context, node, kAccumScratch);
     accum_scratch->type = kTfLiteInt32;
     accum_scratch->allocation_type = kTfLiteArenaRw;
-    int accum_scratch_dims[2] = {n_cell, n_batch};
+    const int n_accum_rows = n_cell * std::max(n_packed_gates, 1);
+    int accum_scratch_dims[2] = {n_accum_rows, n_batch};
     if (!TfLiteIntArrayEqualsArray(accum_scratch->dims, 2,
                                    accum_scratch_dims)) {
       TfLiteIntArray* accum_size = TfLiteIntArrayCreate(2);
-      accum_size->data[0] = n_cell;
+      accum_size->data[0] = n_accum_rows;
       accum_size->data[1] = n_batch;
       TF_LITE_ENSURE_OK(
           context, context->ResizeTensor(context, accum_scratch, accum_size));
@@ -654,6 +678,9 @@ TfLiteStatus Eval(TfLiteContext* context, TfLiteNode* node) {
           prod_scaling_factors, recovered_cell_weights, input_quantized,
           /*aux_input_quantized=*/nullptr, activation_state_quantized,
           cell_state_quantized, activation_state, cell_state, accum_scratch,
+          op_data->hybrid_packed_weights.n_gates > 0
+              ? &op_data->hybrid_packed_weights
+              : nullptr,
           output, CpuBackendContext::GetFromContext(context));
     }
     default:
@@ -72,6 +72,18 @@ GreedyMemoryPlanner::~GreedyMemoryPlanner() {
 TfLiteStatus GreedyMemoryPlanner::AddBuffer(
     tflite::ErrorReporter* error_reporter, int size, int first_time_used,
     int last_time_used) {
+  return AddBuffer(error_reporter, size, first_time_used, last_time_used,
+                   kOnlinePlannedBuffer);
+}
+
+TfLiteStatus GreedyMemoryPlanner::AddBuffer(
+    tflite::ErrorReporter* error_reporter, int size, int first_time_used,
+    int last_time_used, int offline_offset) {
+  if (offline_offset < kOnlinePlannedBuffer) {
+    TF_LITE_REPORT_ERROR(error_reporter, "Invalid offline offset %d",
+                         offline_offset);
+    return kTfLiteError;
+  }
   if (buffer_count_ >= max_buffer_count_) {
     TF_LITE_REPORT_ERROR(error_reporter, "Too many buffers (max is %d)",
                          max_buffer_count_);
@@ -81,6 +93,7 @@ TfLiteStatus GreedyMemoryPlanner::AddBuffer(
   current->size = size;
   current->first_time_used = first_time_used;
   current->last_time_used = last_time_used;
+  current->offline_offset = offline_offset;
   ++buffer_count_;
   need_to_calculate_offsets_ = true;
   return kTfLiteOk;
@@ -107,7 +120,10 @@ GreedyMemoryPlanner::NextSimultaneouslyActiveBuffer(
   ListEntry* result = nullptr;
   ListEntry* candidate_next_entry;
   if (start == nullptr) {
-    candidate_next_entry = &buffers_sorted_by_offset_[0];
+    if (next_free_entry_ == 0) {
+      return nullptr;
+    }
+    candidate_next_entry = &buffers_sorted_by_offset_[first_entry_index_];
   } else {
     if (start->next_entry_index == -1) {
       return nullptr;
@@ -135,35 +151,52 @@ void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
   }
   need_to_calculate_offsets_ = false;
 
-  // Start off by ordering the buffers in descending order of size.
-  // This helps find a more compact layout. Intuitively, you can think
-  // about putting the large buffers in place first, and then the
-  // smaller buffers can fit in the gaps, rather than fragmenting the
-  // gaps with small buffers at the beginning.
+  // Buffers with an offline-planned offset are placed first, in the order
+  // they were added, so that the online buffers can fill the gaps around
+  // them. The rest are ordered in descending order of size. This helps find a
+  // more compact layout. Intuitively, you can think about putting the large
+  // buffers in place first, and then the smaller buffers can fit in the gaps,
+  // rather than fragmenting the gaps with small buffers at the beginning.
+  int offline_buffer_count = 0;
   for (int i = 0; i < buffer_count_; ++i) {
-    buffer_sizes_sorted_by_size_[i] = requirements_[i].size;
-    buffer_ids_sorted_by_size_[i] = i;
     buffer_offsets_[i] = -1;
+    if (requirements_[i].offline_offset != kOnlinePlannedBuffer) {
+      buffer_sizes_sorted_by_size_[offline_buffer_count] =
+          requirements_[i].size;
+      buffer_ids_sorted_by_size_[offline_buffer_count] = i;
+      ++offline_buffer_count;
+    }
+  }
+  int online_buffer_index = offline_buffer_count;
+  for (int i = 0; i < buffer_count_; ++i) {
+    if (requirements_[i].offline_offset == kOnlinePlannedBuffer) {
+      buffer_sizes_sorted_by_size_[online_buffer_index] =
+          requirements_[i].size;
+      buffer_ids_sorted_by_size_[online_buffer_index] = i;
+      ++online_buffer_index;
+    }
   }
   // This sorting algorithm is naive, and may end up taking a very long time
   // with hundreds of buffers.
-  ReverseSortInPlace(buffer_sizes_sorted_by_size_, buffer_ids_sorted_by_size_,
-                     buffer_count_);
-
-  // Put the largest buffer at offset zero to start the process.
-  ListEntry* first_entry = &buffers_sorted_by_offset_[0];
-  first_entry->offset = 0;
-  first_entry->requirements_index = buffer_ids_sorted_by_size_[0];
-  first_entry->next_entry_index = -1;
-  next_free_entry_ = 1;
-  buffer_offsets_[buffer_ids_sorted_by_size_[0]] = 0;
-
-  // Work through the rest of the buffers to find a good gap to place each one.
-  for (int i = 1; i < buffer_count_; ++i) {
+  ReverseSortInPlace(&buffer_sizes_sorted_by_size_[offline_buffer_count],
+                     &buffer_ids_sorted_by_size_[offline_buffer_count],
+                     buffer_count_ - offline_buffer_count);
+
+  next_free_entry_ = 0;
+  first_entry_index_ = 0;
+
+  // Work through the buffers to find a good gap to place each one. Without
+  // offline-planned buffers the first, and largest, one ends up at offset
+  // zero.
+  for (int i = 0; i < buffer_count_; ++i) {
     // The id is the order the buffer was originally added by the client.
     const int buffer_id = buffer_ids_sorted_by_size_[i];
     // Look at what size and time range the buffer needs to be active.
     BufferRequirements* wanted_requirements = &requirements_[buffer_id];
+    if (i < offline_buffer_count) {
+      InsertEntrySortedByOffset(buffer_id, wanted_requirements->offline_offset);
+      continue;
+    }
     const int wanted_size = wanted_requirements->size;
     const int wanted_first_time_used = wanted_requirements->first_time_used;
     const int wanted_last_time_used = wanted_requirements->last_time_used;
@@ -208,36 +241,52 @@ void GreedyMemoryPlanner::CalculateOffsetsIfNeeded() {
     // At this point, we've either found a gap (possibly at the end of the
     // list) and want to place the buffer there, or there are no other active
     // buffers in this time range and so we can put it at offset zero.
-    // Record the buffer's offset in our plan.
-    buffer_offsets_[buffer_id] = candidate_offset;
-    // Add the newly-placed buffer to our offset-ordered list, so that
-    // subsequent passes can fit in their buffers around it.
-    ListEntry* new_entry = &buffers_sorted_by_offset_[next_free_entry_];
-    new_entry->offset = candidate_offset;
-    new_entry->requirements_index = buffer_id;
-    const int new_entry_index = next_free_entry_;
-    ++next_free_entry_;
-    ListEntry* current_entry = first_entry;
-    // Make sure that we insert the buffer at the correct place in the ordered
-    // list.
-    while (true) {
-      const int next_entry_index = current_entry->next_entry_index;
-      if (next_entry_index == -1) {
-        // We're at the end of the list, so just add the new entry here.
-        current_entry->next_entry_index = new_entry_index;
-        new_entry->next_entry_index = -1;
-        break;
-      }
-      ListEntry* next_entry = &buffers_sorted_by_offset_[next_entry_index];
-      if (next_entry->offset > candidate_offset) {
-        // We're at the right spot to do an insertion and retain the sorting
-        // order, so place the new entry here.
-        new_entry->next_entry_index = current_entry->next_entry_index;
-        current_entry->next_entry_index = new_entry_index;
-        break;
-      }
-      current_entry = next_entry;
+    // Record the buffer's offset in our plan, and add the newly-placed buffer
+    // to our offset-ordered list, so that subsequent passes can fit in their
+    // buffers around it.
+    InsertEntrySortedByOffset(buffer_id, candidate_offset);
+  }
+}
+
+void GreedyMemoryPlanner::InsertEntrySortedByOffset(int buffer_id,
+                                                    int offset) {
+  buffer_offsets_[buffer_id] = offset;
+  ListEntry* new_entry = &buffers_sorted_by_offset_[next_free_entry_];
+  new_entry->offset = offset;
+  new_entry->requirements_index = buffer_id;
+  const int new_entry_index = next_free_entry_;
+  ++next_free_entry_;
+  if (new_entry_index == 0) {
+    new_entry->next_entry_index = -1;
+    first_entry_index_ = new_entry_index;
+    return;
+  }
+  ListEntry* current_entry = &buffers_sorted_by_offset_[first_entry_index_];
+  if (current_entry->offset > offset) {
+    // Offline-planned buffers can be placed before the current head.
+    new_entry->next_entry_index = first_entry_index_;
+    first_entry_index_ = new_entry_index;
+    return;
+  }
+  // Make sure that we insert the buffer at the correct place in the ordered
+  // list.
+  while (true) {
+    const int next_entry_index = current_entry->next_entry_index;
+    if (next_entry_index == -1) {
+      // We're at the end of the list, so just add the new entry here.
+      current_entry->next_entry_index = new_entry_index;
+      new_entry->next_entry_index = -1;
+      break;
+    }
+    ListEntry* next_entry = &buffers_sorted_by_offset_[next_entry_index];
+    if (next_entry->offset > offset) {
+      // We're at the right spot to do an insertion and retain the sorting
+      // order, so place the new entry here.
+      new_entry->next_entry_index = current_entry->next_entry_index;
+      current_entry->next_entry_index = new_entry_index;
+      break;
     }
+    current_entry = next_entry;
   }
 }
 
@@ -246,7 +295,7 @@ size_t GreedyMemoryPlanner::GetMaximumMemorySize() {
   if (buffer_count_ == 0) {
     return 0;
   }
-  ListEntry* entry = &buffers_sorted_by_offset_[0];
+  ListEntry* entry = &buffers_sorted_by_offset_[first_entry_index_];
   size_t max_size = 0;
   while (entry) {
     BufferRequirements* requirements =
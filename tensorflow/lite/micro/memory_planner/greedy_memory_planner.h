@@ -29,8 +29,10 @@ namespace tflite {
 //  - When a function like GetOffsetForBuffer() is called, the
 //    CalculateOffsetsIfNeeded() method is invoked.
 //  - If an up to date plan is not already present, one will be calculated.
-//  - The buffers are sorted in descending order of size.
-//  - The largest buffer is placed at offset zero.
+//  - Buffers with an offline-planned offset are placed at that offset first.
+//  - The remaining buffers are sorted in descending order of size.
+//  - If no buffer was planned offline, the largest one is placed at offset
+//    zero.
 //  - The rest of the buffers are looped through in descending size order.
 //  - The other buffers that need to be in memory at the same time are found.
 //  - The first gap between simultaneously active buffers that the current
@@ -51,14 +53,27 @@ class GreedyMemoryPlanner : public MemoryPlanner {
   // this scratch memory, so you should enlarge it if you see an error when
   // calling AddBuffer(). The memory can be reused once you're done with the
   // planner, as long as you copy the calculated offsets to another location.
-  // Each buffer requires about 36 bytes of scratch.
+  // Each buffer requires about 40 bytes of scratch.
   GreedyMemoryPlanner(unsigned char* scratch_buffer, int scratch_buffer_size);
   ~GreedyMemoryPlanner() override;
 
+  // Offset passed to AddBuffer() for buffers that should be placed by the
+  // greedy algorithm.
+  static constexpr int kOnlinePlannedBuffer = -1;
+
   // Record details of a buffer we want to place.
   TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
                          int first_time_used, int last_time_used) override;
 
+  // Record details of a buffer we want to place at a fixed offset, usually
+  // one computed ahead of time by an offline planner. Passing
+  // kOnlinePlannedBuffer as `offline_offset` behaves like the overload above.
+  // The offline offsets are trusted, so a plan with overlapping buffers will
+  // produce an overlapping layout.
+  TfLiteStatus AddBuffer(ErrorReporter* error_reporter, int size,
+                         int first_time_used, int last_time_used,
+                         int offline_offset);
+
   // Returns the high-water mark of used memory. This is the minimum size of a
   // memory arena you'd need to allocate to hold these buffers.
   size_t GetMaximumMemorySize() override;
@@ -100,6 +115,9 @@ class GreedyMemoryPlanner : public MemoryPlanner {
   // If there isn't an up to date plan, calculate a new one.
   void CalculateOffsetsIfNeeded();
 
+  // Adds a buffer placed at `offset` to the offset-ordered list.
+  void InsertEntrySortedByOffset(int buffer_id, int offset);
+
   // How many buffers we can plan for, based on the arena size we're given in
   // the constructor.
   int max_buffer_count_;
@@ -112,6 +130,7 @@ class GreedyMemoryPlanner : public MemoryPlanner {
     int size;
     int first_time_used;
     int last_time_used;
+    int offline_offset;
   };
 
   // Working arrays used during the layout algorithm.
@@ -120,6 +139,8 @@ class GreedyMemoryPlanner : public MemoryPlanner {
   int* buffer_ids_sorted_by_size_;
   ListEntry* buffers_sorted_by_offset_;
   int next_free_entry_;
+  // Index in buffers_sorted_by_offset_ of the entry with the lowest offset.
+  int first_entry_index_;
 
   // Stores the outcome of the plan, the location of each buffer in the arena.
   int* buffer_offsets_;
@@ -254,6 +254,38 @@ TF_LITE_MICRO_TEST(TestOverlapCase) {
   TF_LITE_MICRO_EXPECT_EQ(120, planner.GetMaximumMemorySize());
 }
 
+TF_LITE_MICRO_TEST(TestGreedyOfflinePlanned) {
+  tflite::MicroErrorReporter micro_error_reporter;
+  tflite::ErrorReporter* error_reporter = &micro_error_reporter;
+
+  tflite::GreedyMemoryPlanner planner(g_scratch_buffer, kScratchBufferSize);
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(error_reporter, 100, 0, 1, 40));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(error_reporter, 40, 0, 1));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteOk,
+                          planner.AddBuffer(error_reporter, 60, 1, 2));
+  TF_LITE_MICRO_EXPECT_EQ(kTfLiteError,
+                          planner.AddBuffer(error_reporter, 10, 0, 1, -2));
+
+  int offset = -1;
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(error_reporter, 0, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(40, offset);
+
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(error_reporter, 1, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(0, offset);
+
+  TF_LITE_MICRO_EXPECT_EQ(
+      kTfLiteOk, planner.GetOffsetForBuffer(error_reporter, 2, &offset));
+  TF_LITE_MICRO_EXPECT_EQ(140, offset);
+
+  TF_LITE_MICRO_EXPECT_EQ(false, planner.DoAnyBuffersOverlap(error_reporter));
+
+  TF_LITE_MICRO_EXPECT_EQ(200, planner.GetMaximumMemorySize());
+}
+
 TF_LITE_MICRO_TEST(TestSmallScratch) {
   tflite::MicroErrorReporter micro_error_reporter;
   tflite::ErrorReporter* error_reporter = &micro_error_reporter;
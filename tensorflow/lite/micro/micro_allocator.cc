@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/lite/micro/micro_allocator.h"
 
 #include <cstddef>
+#include <cstring>
 
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
@@ -37,12 +38,31 @@ struct AllocationInfo {
   int last_used;
   bool needs_allocating;
   void** output_ptr;
+  // Arena offset computed by an offline planner, or
+  // GreedyMemoryPlanner::kOnlinePlannedBuffer.
+  int offline_offset;
 };
 
 // We align tensor buffers to 16-byte boundaries, since this is a common
 // requirement for SIMD extensions.
 constexpr int kBufferAlignment = 16;
 
+// Name of the model metadata holding an offline-planned arena layout. Its
+// buffer is an int32 array of the form
+//   [version, subgraph_index, num_tensors, offset_0, ..., offset_{n-1}]
+// where offset_i is the arena offset in bytes of tensor i of the subgraph, or
+// -1 for tensors that are left to the online planner.
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+constexpr int kOfflineMemAllocVersion = 1;
+constexpr int kOfflineMemAllocHeaderSize = 3;
+
+// Name of the model metadata holding the offline-planned arena offsets of the
+// scratch buffers requested by the kernels, in the order of the requests. It
+// has the same format, with an offset per scratch buffer instead of tensor.
+constexpr char kOfflineScratchAllocMetadata[] =
+    "OfflineScratchBufferAllocation";
+constexpr int kOfflineScratchAllocVersion = 1;
+
 // If building with GNU clib from GCC 4.8.x or lower, `max_align_t` is not a
 // member of `std`. If using a newer version of clib, we import `max_align_t`
 // into the local anonymous namespace to be able to use it like the global
@@ -112,11 +132,16 @@ class AllocationInfoBuilder {
     return Allocate();
   }
 
-  // Add allocaiton information for the tensors.
+  // Add allocaiton information for the tensors. `offline_offsets` holds the
+  // offline-planned offset of each tensor, and may be null.
   TfLiteStatus AddTensors(const SubGraph* subgraph,
+                          const int32_t* offline_offsets,
                           TfLiteTensor* runtime_tensors);
-  // Add allocation information for the scratch buffers.
-  TfLiteStatus AddScratchBuffers(internal::ScratchBufferHandle* buffer_handles);
+  // Add allocation information for the scratch buffers. `offline_offsets`
+  // holds the offline-planned offset of each buffer in the order of the
+  // requests, and may be null.
+  TfLiteStatus AddScratchBuffers(internal::ScratchBufferHandle* buffer_handles,
+                                 const int32_t* offline_offsets);
 
   // Returns a pointer to the built AllocationInfo array.
   const AllocationInfo* Finish() const { return info_; }
@@ -148,6 +173,7 @@ TfLiteStatus AllocationInfoBuilder::Allocate() {
 }
 
 TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
+                                               const int32_t* offline_offsets,
                                                TfLiteTensor* runtime_tensors) {
   // Set up allocation info for all tensors.
   for (size_t i = 0; i < tensor_count_; ++i) {
@@ -159,6 +185,9 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
     current->last_used = -1;
     current->needs_allocating = (runtime_tensors[i].data.raw == nullptr) &&
                                 (!subgraph->tensors()->Get(i)->is_variable());
+    current->offline_offset = offline_offsets
+                                  ? offline_offsets[i]
+                                  : GreedyMemoryPlanner::kOnlinePlannedBuffer;
   }
 
   for (size_t i = 0; i < subgraph->inputs()->size(); ++i) {
@@ -217,7 +246,8 @@ TfLiteStatus AllocationInfoBuilder::AddTensors(const SubGraph* subgraph,
 }
 
 TfLiteStatus AllocationInfoBuilder::AddScratchBuffers(
-    internal::ScratchBufferHandle* buffer_handles) {
+    internal::ScratchBufferHandle* buffer_handles,
+    const int32_t* offline_offsets) {
   // Set up allocation info for buffers.
   for (size_t i = tensor_count_; i < tensor_count_ + buffer_count_; ++i) {
     AllocationInfo* current = &info_[i];
@@ -228,11 +258,119 @@ TfLiteStatus AllocationInfoBuilder::AddScratchBuffers(
     current->first_created = handle->node_idx;
     current->last_used = handle->node_idx;
     current->needs_allocating = true;
+    // buffer_handles is in reverse order of the requests.
+    current->offline_offset =
+        offline_offsets
+            ? offline_offsets[buffer_count_ - 1 - (i - tensor_count_)]
+            : GreedyMemoryPlanner::kOnlinePlannedBuffer;
+  }
+  return kTfLiteOk;
+}
+
+// Returns in `offsets` and `num_offsets` the offsets stored in the model
+// metadata `name` for the first subgraph of `model`, or null if there are
+// none. The metadata has the format described at kOfflineMemAllocMetadata.
+TfLiteStatus GetOffsetsMetadata(ErrorReporter* error_reporter,
+                                const Model* model, const char* name,
+                                int32_t version, const int32_t** offsets,
+                                int* num_offsets) {
+  *offsets = nullptr;
+  *num_offsets = 0;
+  if (model->metadata() == nullptr) {
+    return kTfLiteOk;
+  }
+  for (size_t i = 0; i < model->metadata()->size(); ++i) {
+    const auto* metadata = model->metadata()->Get(i);
+    if (metadata->name() == nullptr ||
+        strcmp(metadata->name()->c_str(), name) != 0) {
+      continue;
+    }
+    if (model->buffers() == nullptr ||
+        metadata->buffer() >= model->buffers()->size()) {
+      TF_LITE_REPORT_ERROR(error_reporter, "%s metadata has no buffer", name);
+      return kTfLiteError;
+    }
+    const auto* buffer = model->buffers()->Get(metadata->buffer());
+    if (buffer->data() == nullptr) {
+      TF_LITE_REPORT_ERROR(error_reporter, "%s metadata has no buffer", name);
+      return kTfLiteError;
+    }
+    const size_t num_values = buffer->data()->size() / sizeof(int32_t);
+    // The buffer data is 16-byte aligned by the schema.
+    const int32_t* values =
+        reinterpret_cast<const int32_t*>(buffer->data()->data());
+    if (num_values < kOfflineMemAllocHeaderSize || values[0] != version) {
+      TF_LITE_REPORT_ERROR(error_reporter, "Unsupported %s metadata", name);
+      return kTfLiteError;
+    }
+    // Only the first subgraph is supported.
+    if (values[1] != 0) {
+      continue;
+    }
+    const int32_t count = values[2];
+    if (count < 0 || num_values != static_cast<size_t>(
+                                       kOfflineMemAllocHeaderSize + count)) {
+      TF_LITE_REPORT_ERROR(error_reporter,
+                           "%s metadata has %d values for %d offsets", name,
+                           num_values - kOfflineMemAllocHeaderSize, count);
+      return kTfLiteError;
+    }
+    const int32_t* result = &values[kOfflineMemAllocHeaderSize];
+    for (int32_t j = 0; j < count; ++j) {
+      if (result[j] != GreedyMemoryPlanner::kOnlinePlannedBuffer &&
+          (result[j] < 0 || result[j] % kBufferAlignment != 0)) {
+        TF_LITE_REPORT_ERROR(error_reporter, "Invalid %s offset %d at %d",
+                             name, result[j], j);
+        return kTfLiteError;
+      }
+    }
+    *offsets = result;
+    *num_offsets = count;
+    return kTfLiteOk;
   }
   return kTfLiteOk;
 }
 
-TfLiteStatus CreatePlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
+// Returns in `offline_planner_offsets` the offline-planned offsets of the
+// tensors of the first subgraph of `model`, or null if the model has no
+// offline plan.
+TfLiteStatus GetOfflinePlannedOffsets(ErrorReporter* error_reporter,
+                                      const Model* model,
+                                      const SubGraph* subgraph,
+                                      const int32_t** offline_planner_offsets) {
+  int num_tensors = 0;
+  TF_LITE_ENSURE_STATUS(GetOffsetsMetadata(
+      error_reporter, model, kOfflineMemAllocMetadata, kOfflineMemAllocVersion,
+      offline_planner_offsets, &num_tensors));
+  if (*offline_planner_offsets != nullptr &&
+      num_tensors != static_cast<int>(subgraph->tensors()->size())) {
+    TF_LITE_REPORT_ERROR(
+        error_reporter, "%s metadata has %d tensors, but the subgraph has %d",
+        kOfflineMemAllocMetadata, num_tensors, subgraph->tensors()->size());
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+// Returns in `offline_scratch_offsets` the offline-planned offsets of the
+// `scratch_buffer_count` scratch buffers requested by the kernels, or null if
+// the model has no offline plan for them. A plan made for a different number
+// of scratch buffers, e.g. with other kernel implementations, is ignored.
+TfLiteStatus GetOfflinePlannedScratchOffsets(
+    ErrorReporter* error_reporter, const Model* model,
+    size_t scratch_buffer_count, const int32_t** offline_scratch_offsets) {
+  int num_buffers = 0;
+  TF_LITE_ENSURE_STATUS(GetOffsetsMetadata(
+      error_reporter, model, kOfflineScratchAllocMetadata,
+      kOfflineScratchAllocVersion, offline_scratch_offsets, &num_buffers));
+  if (static_cast<size_t>(num_buffers) != scratch_buffer_count) {
+    *offline_scratch_offsets = nullptr;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus CreatePlan(ErrorReporter* error_reporter,
+                        GreedyMemoryPlanner* planner,
                         const AllocationInfo* allocation_info,
                         size_t allocation_info_size) {
   // Add the tensors to our allocation plan.
@@ -243,7 +381,8 @@ TfLiteStatus CreatePlan(ErrorReporter* error_reporter, MemoryPlanner* planner,
           AlignSizeUp(current->bytes, kBufferAlignment);
       TF_LITE_ENSURE_STATUS(
           planner->AddBuffer(error_reporter, aligned_bytes_required,
-                             current->first_created, current->last_used));
+                             current->first_created, current->last_used,
+                             current->offline_offset));
     }
   }
   return kTfLiteOk;
@@ -533,7 +672,8 @@ TfLiteStatus MicroAllocator::FinishTensorAllocation() {
   }
 
   // Create static memory plan
-  // 1. Calculate AllocationInfo to know the lifetime of each tensor/buffer.
+  // 1. Calculate AllocationInfo to know the lifetime of each tensor/buffer,
+  //    and the offline-planned offsets if the model has any.
   // 2. Add them into the planner (such as the GreedyMemoryPlanner).
   // 3. Static memory planning using the planner.
   // 4. Set tensor/buffer pointers based on the offsets from the previous step.
@@ -543,11 +683,21 @@ TfLiteStatus MicroAllocator::FinishTensorAllocation() {
     SimpleMemoryAllocator tmp_allocator =
         memory_allocator_->CreateChildAllocator();
 
+    const int32_t* offline_planner_offsets = nullptr;
+    TF_LITE_ENSURE_STATUS(GetOfflinePlannedOffsets(
+        error_reporter_, model_, subgraph_, &offline_planner_offsets));
+    const int32_t* offline_scratch_offsets = nullptr;
+    TF_LITE_ENSURE_STATUS(GetOfflinePlannedScratchOffsets(
+        error_reporter_, model_, scratch_buffer_count_,
+        &offline_scratch_offsets));
+
     AllocationInfoBuilder builder(error_reporter_, &tmp_allocator);
     TF_LITE_ENSURE_STATUS(
         builder.Init(tensors_->size(), scratch_buffer_count_));
-    TF_LITE_ENSURE_STATUS(builder.AddTensors(subgraph_, context_->tensors));
-    TF_LITE_ENSURE_STATUS(builder.AddScratchBuffers(scratch_buffer_handles_));
+    TF_LITE_ENSURE_STATUS(builder.AddTensors(subgraph_, offline_planner_offsets,
+                                             context_->tensors));
+    TF_LITE_ENSURE_STATUS(builder.AddScratchBuffers(scratch_buffer_handles_,
+                                                    offline_scratch_offsets));
     const AllocationInfo* allocation_info = builder.Finish();
 
     uint8_t* aligned_arena = memory_allocator_->GetBuffer();
@@ -643,6 +793,24 @@ TfLiteStatus MicroAllocator::RequestScratchBufferInArena(int node_id,
   return kTfLiteOk;
 }
 
+TfLiteStatus MicroAllocator::GetScratchBufferRequest(int buffer_idx,
+                                                     int* node_idx,
+                                                     size_t* bytes) const {
+  if (buffer_idx < 0 ||
+      static_cast<size_t>(buffer_idx) >= scratch_buffer_count_) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Buffer %d not found. %d buffers available.",
+                         buffer_idx, scratch_buffer_count_);
+    return kTfLiteError;
+  }
+  // scratch_buffer_handles_ is in reverse order.
+  const internal::ScratchBufferHandle& handle =
+      scratch_buffer_handles_[scratch_buffer_count_ - buffer_idx - 1];
+  *node_idx = handle.node_idx;
+  *bytes = handle.bytes;
+  return kTfLiteOk;
+}
+
 void* MicroAllocator::GetScratchBuffer(int buffer_idx) const {
   if (static_cast<size_t>(buffer_idx) >= scratch_buffer_count_) {
     TF_LITE_REPORT_ERROR(error_reporter_,
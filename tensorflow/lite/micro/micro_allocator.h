@@ -111,6 +111,14 @@ class MicroAllocator {
   // Returns the pointer to the planned scratch buffer.
   void* GetScratchBuffer(int buffer_idx) const;
 
+  // Returns the number of scratch buffers requested so far.
+  size_t scratch_buffer_count() const { return scratch_buffer_count_; }
+
+  // Returns the node and the size of the scratch buffer `buffer_idx`, e.g. to
+  // plan the arena offline along with the tensors.
+  TfLiteStatus GetScratchBufferRequest(int buffer_idx, int* node_idx,
+                                       size_t* bytes) const;
+
  private:
   TfLiteStatus Init();
 
@@ -241,6 +241,8 @@ TfLiteStatus MicroInterpreter::Invoke() {
     auto* registration = node_and_registrations_[i].registration;
 
     if (registration->invoke) {
+      ScopedOperatorProfile scoped_profile(
+          profiler_, OpNameFromRegistration(registration), i);
       TfLiteStatus invoke_status = registration->invoke(&context_, node);
       if (invoke_status == kTfLiteError) {
         TF_LITE_REPORT_ERROR(
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/error_reporter.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
+#include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
 #include "tensorflow/lite/micro/micro_allocator.h"
 #include "tensorflow/lite/schema/schema_generated.h"
@@ -134,6 +135,21 @@ class MicroInterpreter {
 
   size_t operators_size() const { return operators_->size(); }
 
+  // The scratch buffers requested by the kernels, valid after
+  // AllocateTensors(). They can be passed to the offline memory planner in
+  // tensorflow/lite/tools/optimize to plan them along with the tensors.
+  size_t scratch_buffers_size() const {
+    return allocator_.scratch_buffer_count();
+  }
+  TfLiteStatus GetScratchBufferRequest(int buffer_idx, int* node_idx,
+                                       size_t* bytes) const {
+    return allocator_.GetScratchBufferRequest(buffer_idx, node_idx, bytes);
+  }
+
+  // Sets the profiler that records the invocation of each operator, or
+  // disables profiling if null. The profiler must outlive the interpreter.
+  void set_profiler(Profiler* profiler) { profiler_ = profiler; }
+
   // For debugging only.
   const NodeAndRegistration node_and_registration(int node_index) const {
     return node_and_registrations_[node_index];
@@ -153,6 +169,7 @@ class MicroInterpreter {
   TfLiteContext context_ = {};
   MicroAllocator allocator_;
   bool tensors_allocated_;
+  Profiler* profiler_ = nullptr;
 
   TfLiteStatus initialization_status_;
   const flatbuffers::Vector<flatbuffers::Offset<Tensor>>* tensors_;
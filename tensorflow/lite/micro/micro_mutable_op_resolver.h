@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MICRO_MICRO_MUTABLE_OP_RESOLVER_H_
 #define TENSORFLOW_LITE_MICRO_MICRO_MUTABLE_OP_RESOLVER_H_
 
+#include <cstring>
+
 #include "tensorflow/lite/c/common.h"
 #include "tensorflow/lite/core/api/op_resolver.h"
 #include "tensorflow/lite/micro/compatibility.h"
@@ -31,42 +33,70 @@ namespace tflite {
 
 inline int MicroOpResolverAnyVersion() { return 0; }
 
+// Name of the variant of the registrations added without one, which are
+// usually the reference kernels.
+constexpr char kMicroOpReferenceVariant[] = "reference";
+
+// Returns whether the target supports a kernel variant, e.g. by checking for
+// the CPU extensions that it uses.
+typedef bool (*MicroOpVariantSupportedFn)();
+
+// Several registrations can be added for the same op and version, one per
+// kernel variant (such as CMSIS-NN, Helium or Xtensa HiFi kernels on top of
+// the reference ones). FindOp() returns the enabled variant with the highest
+// priority that the target supports, and the first one added among variants
+// of the same priority. Registrations added without a variant have priority 0.
+
 template <unsigned int tOpCount = TFLITE_REGISTRATIONS_MAX>
 class MicroOpResolver : public OpResolver {
  public:
   const TfLiteRegistration* FindOp(tflite::BuiltinOperator op,
                                    int version) const override {
+    const TfLiteRegistration* best = nullptr;
     for (unsigned int i = 0; i < registrations_len_; ++i) {
       const TfLiteRegistration& registration = registrations_[i];
       if ((registration.builtin_code == op) &&
           (registration.version == MicroOpResolverAnyVersion() ||
            registration.version == version)) {
-        return &registration;
+        best = PreferredVariant(best, i);
       }
     }
-    return nullptr;
+    return best;
   }
 
   const TfLiteRegistration* FindOp(const char* op, int version) const override {
+    const TfLiteRegistration* best = nullptr;
     for (unsigned int i = 0; i < registrations_len_; ++i) {
       const TfLiteRegistration& registration = registrations_[i];
       if ((registration.builtin_code == BuiltinOperator_CUSTOM) &&
           (strcmp(registration.custom_name, op) == 0) &&
           (registration.version == MicroOpResolverAnyVersion() ||
            registration.version == version)) {
-        return &registration;
+        best = PreferredVariant(best, i);
       }
     }
-    return nullptr;
+    return best;
   }
 
   void AddBuiltin(tflite::BuiltinOperator op, TfLiteRegistration* registration,
                   int version = 1) {
+    AddBuiltinVariant(op, registration, kMicroOpReferenceVariant,
+                      /*is_supported=*/nullptr, /*priority=*/0, version);
+  }
+
+  // Adds the kernel variant `variant` of a builtin op, which is used instead
+  // of the ones of lower priority if `is_supported` returns true, or is null.
+  // `variant` must outlive the resolver.
+  void AddBuiltinVariant(tflite::BuiltinOperator op,
+                         TfLiteRegistration* registration, const char* variant,
+                         MicroOpVariantSupportedFn is_supported, int priority,
+                         int version = 1) {
     if (registrations_len_ >= tOpCount) {
       // TODO(b/147748244) - Add error reporting hooks so we can report this!
       return;
     }
     TfLiteRegistration* new_registration = &registrations_[registrations_len_];
+    variants_[registrations_len_] = {variant, is_supported, priority, true};
     registrations_len_ += 1;
 
     *new_registration = *registration;
@@ -81,6 +111,16 @@ class MicroOpResolver : public OpResolver {
     }
   }
 
+  void AddBuiltinVariant(tflite::BuiltinOperator op,
+                         TfLiteRegistration* registration, const char* variant,
+                         MicroOpVariantSupportedFn is_supported, int priority,
+                         int min_version, int max_version) {
+    for (int version = min_version; version <= max_version; ++version) {
+      AddBuiltinVariant(op, registration, variant, is_supported, priority,
+                        version);
+    }
+  }
+
   void AddCustom(const char* name, TfLiteRegistration* registration,
                  int version = 1) {
     if (registrations_len_ >= tOpCount) {
@@ -88,6 +128,8 @@ class MicroOpResolver : public OpResolver {
       return;
     }
     TfLiteRegistration* new_registration = &registrations_[registrations_len_];
+    variants_[registrations_len_] = {kMicroOpReferenceVariant, nullptr, 0,
+                                     true};
     registrations_len_ += 1;
 
     *new_registration = *registration;
@@ -105,8 +147,53 @@ class MicroOpResolver : public OpResolver {
 
   unsigned int GetRegistrationLength() { return registrations_len_; }
 
+  // Enables or disables all the registrations of kernel variant `variant`,
+  // e.g. to compare the variants of an op on the device. The registrations of
+  // the ops that are already resolved are not affected.
+  void SetVariantEnabled(const char* variant, bool enabled) {
+    for (unsigned int i = 0; i < registrations_len_; ++i) {
+      if (strcmp(variants_[i].name, variant) == 0) {
+        variants_[i].enabled = enabled;
+      }
+    }
+  }
+
+  // Returns the kernel variant of a registration returned by FindOp(), or
+  // null if it doesn't belong to this resolver.
+  const char* GetVariantName(const TfLiteRegistration* registration) const {
+    if (registration < registrations_ ||
+        registration >= registrations_ + registrations_len_) {
+      return nullptr;
+    }
+    return variants_[registration - registrations_].name;
+  }
+
  private:
+  struct Variant {
+    const char* name;
+    MicroOpVariantSupportedFn is_supported;
+    int priority;
+    bool enabled;
+  };
+
+  // Returns the preferred one of `best` and registration `index`, which
+  // implement the same op.
+  const TfLiteRegistration* PreferredVariant(const TfLiteRegistration* best,
+                                             unsigned int index) const {
+    const Variant& variant = variants_[index];
+    if (!variant.enabled ||
+        (variant.is_supported != nullptr && !variant.is_supported())) {
+      return best;
+    }
+    if (best != nullptr &&
+        variants_[best - registrations_].priority >= variant.priority) {
+      return best;
+    }
+    return &registrations_[index];
+  }
+
   TfLiteRegistration registrations_[tOpCount];
+  Variant variants_[tOpCount];
   unsigned int registrations_len_ = 0;
 
   TF_LITE_REMOVE_VIRTUAL_DELETE
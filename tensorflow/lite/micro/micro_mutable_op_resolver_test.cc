@@ -35,6 +35,10 @@ TfLiteStatus MockPrepare(TfLiteContext* context, TfLiteNode* node) {
 TfLiteStatus MockInvoke(TfLiteContext* context, TfLiteNode* node) {
   return kTfLiteOk;
 }
+
+bool Supported() { return true; }
+
+bool Unsupported() { return false; }
 }  // namespace
 }  // namespace tflite
 
@@ -84,6 +88,39 @@ TF_LITE_MICRO_TEST(TestOperations) {
   TF_LITE_MICRO_EXPECT_EQ(nullptr, registration);
 }
 
+TF_LITE_MICRO_TEST(TestKernelVariants) {
+  using tflite::BuiltinOperator_CONV_2D;
+  using tflite::MicroOpResolver;
+  using tflite::OpResolver;
+
+  static TfLiteRegistration r = {tflite::MockInit, tflite::MockFree,
+                                 tflite::MockPrepare, tflite::MockInvoke};
+
+  MicroOpResolver<3> micro_op_resolver;
+  micro_op_resolver.AddBuiltin(BuiltinOperator_CONV_2D, &r);
+  micro_op_resolver.AddBuiltinVariant(BuiltinOperator_CONV_2D, &r,
+                                      "unsupported", tflite::Unsupported, 2);
+  micro_op_resolver.AddBuiltinVariant(BuiltinOperator_CONV_2D, &r,
+                                      "optimized", tflite::Supported, 1);
+  OpResolver* resolver = &micro_op_resolver;
+
+  // The supported variant of highest priority is preferred.
+  const TfLiteRegistration* registration =
+      resolver->FindOp(BuiltinOperator_CONV_2D, 1);
+  TF_LITE_MICRO_EXPECT_NE(nullptr, registration);
+  TF_LITE_MICRO_EXPECT_EQ(
+      0, strcmp("optimized", micro_op_resolver.GetVariantName(registration)));
+
+  micro_op_resolver.SetVariantEnabled("optimized", false);
+  registration = resolver->FindOp(BuiltinOperator_CONV_2D, 1);
+  TF_LITE_MICRO_EXPECT_NE(nullptr, registration);
+  TF_LITE_MICRO_EXPECT_EQ(0, strcmp(tflite::kMicroOpReferenceVariant,
+                                    micro_op_resolver.GetVariantName(
+                                        registration)));
+
+  TF_LITE_MICRO_EXPECT_EQ(nullptr, micro_op_resolver.GetVariantName(&r));
+}
+
 TF_LITE_MICRO_TEST(TestOpRegistrationOverflow) {
   using tflite::BuiltinOperator_CONV_2D;
   using tflite::BuiltinOperator_RELU;
@@ -0,0 +1,64 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_profiler.h"
+
+#include "tensorflow/lite/micro/micro_time.h"
+
+namespace tflite {
+
+uint32_t MicroProfiler::BeginEvent(const char* tag, EventType event_type,
+                                   uint32_t event_metadata,
+                                   uint32_t event_subgraph_index) {
+  if (num_events_ >= kMaxEvents) {
+    TF_LITE_REPORT_ERROR(error_reporter_,
+                         "Profiler is full, %s event is not recorded.", tag);
+    return kMaxEvents;
+  }
+  Event& event = events_[num_events_];
+  event.tag = tag;
+  event.metadata = event_metadata;
+  event.start_ticks = GetCurrentTimeTicks();
+  event.end_ticks = event.start_ticks;
+  return num_events_++;
+}
+
+void MicroProfiler::EndEvent(uint32_t event_handle) {
+  if (event_handle >= static_cast<uint32_t>(num_events_)) {
+    return;
+  }
+  events_[event_handle].end_ticks = GetCurrentTimeTicks();
+}
+
+int32_t MicroProfiler::GetTotalTicks() const {
+  int32_t total_ticks = 0;
+  for (int i = 0; i < num_events_; ++i) {
+    total_ticks += GetTicks(i);
+  }
+  return total_ticks;
+}
+
+void MicroProfiler::Log() const {
+  for (int i = 0; i < num_events_; ++i) {
+    TF_LITE_REPORT_ERROR(error_reporter_, "%s (%d) took %d ticks",
+                         events_[i].tag, static_cast<int>(events_[i].metadata),
+                         GetTicks(i));
+  }
+  TF_LITE_REPORT_ERROR(error_reporter_,
+                       "%d events took %d ticks (%d ticks per second)",
+                       num_events_, GetTotalTicks(), ticks_per_second());
+}
+
+}  // namespace tflite
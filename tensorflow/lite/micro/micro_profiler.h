@@ -0,0 +1,87 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_MICRO_MICRO_PROFILER_H_
+#define TENSORFLOW_LITE_MICRO_MICRO_PROFILER_H_
+
+#include <cstdint>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/micro/compatibility.h"
+
+namespace tflite {
+
+// Records the duration in ticks of the events of a MicroInterpreter, such as
+// the invocation of each operator, using the timer of micro_time.h. Set it
+// with MicroInterpreter::set_profiler(), and call Log() after Invoke(), e.g.
+// to compare the kernel variants of an op resolver on the device.
+class MicroProfiler : public Profiler {
+ public:
+  // Maximum number of events recorded between two calls to Reset().
+  static constexpr int kMaxEvents = 64;
+
+  explicit MicroProfiler(ErrorReporter* error_reporter)
+      : error_reporter_(error_reporter) {}
+  ~MicroProfiler() override = default;
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      uint32_t event_metadata,
+                      uint32_t event_subgraph_index) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  // Forgets the recorded events.
+  void Reset() { num_events_ = 0; }
+
+  int num_events() const { return num_events_; }
+
+  // Returns the tag of event `index`, which is the op name for operator
+  // events.
+  const char* GetTag(int index) const { return events_[index].tag; }
+
+  // Returns the metadata of event `index`, which is the node index for
+  // operator events.
+  uint32_t GetMetadata(int index) const { return events_[index].metadata; }
+
+  // Returns the duration in ticks of event `index`.
+  int32_t GetTicks(int index) const {
+    return events_[index].end_ticks - events_[index].start_ticks;
+  }
+
+  // Returns the total duration in ticks of the recorded events.
+  int32_t GetTotalTicks() const;
+
+  // Reports the duration of each recorded event, and their total.
+  void Log() const;
+
+ private:
+  struct Event {
+    const char* tag;
+    uint32_t metadata;
+    int32_t start_ticks;
+    int32_t end_ticks;
+  };
+
+  ErrorReporter* error_reporter_;
+  Event events_[kMaxEvents];
+  int num_events_ = 0;
+
+  TF_LITE_REMOVE_VIRTUAL_DELETE
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_MICRO_MICRO_PROFILER_H_
@@ -0,0 +1,57 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/micro/micro_profiler.h"
+
+#include <cstring>
+
+#include "tensorflow/lite/micro/micro_error_reporter.h"
+#include "tensorflow/lite/micro/testing/micro_test.h"
+
+TF_LITE_MICRO_TESTS_BEGIN
+
+TF_LITE_MICRO_TEST(TestRecordsEvents) {
+  tflite::MicroErrorReporter error_reporter;
+  tflite::MicroProfiler profiler(&error_reporter);
+  {
+    tflite::ScopedOperatorProfile conv(&profiler, "CONV_2D", 0);
+  }
+  {
+    tflite::ScopedOperatorProfile softmax(&profiler, "SOFTMAX", 1);
+  }
+
+  TF_LITE_MICRO_EXPECT_EQ(2, profiler.num_events());
+  TF_LITE_MICRO_EXPECT_EQ(0, strcmp("CONV_2D", profiler.GetTag(0)));
+  TF_LITE_MICRO_EXPECT_EQ(1, static_cast<int>(profiler.GetMetadata(1)));
+  TF_LITE_MICRO_EXPECT_GE(profiler.GetTicks(0), 0);
+  TF_LITE_MICRO_EXPECT_EQ(profiler.GetTicks(0) + profiler.GetTicks(1),
+                          profiler.GetTotalTicks());
+  profiler.Log();
+
+  profiler.Reset();
+  TF_LITE_MICRO_EXPECT_EQ(0, profiler.num_events());
+}
+
+TF_LITE_MICRO_TEST(TestIgnoresEventsWhenFull) {
+  tflite::MicroErrorReporter error_reporter;
+  tflite::MicroProfiler profiler(&error_reporter);
+  for (int i = 0; i < tflite::MicroProfiler::kMaxEvents + 1; ++i) {
+    tflite::ScopedOperatorProfile op(&profiler, "ADD", i);
+  }
+  TF_LITE_MICRO_EXPECT_EQ(tflite::MicroProfiler::kMaxEvents,
+                          profiler.num_events());
+}
+
+TF_LITE_MICRO_TESTS_END
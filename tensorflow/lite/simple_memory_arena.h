@@ -73,6 +73,15 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Schedule memory allocation for a tensor like Allocate(), but at a fixed
+  // `offset`, usually one computed by an offline memory planner. The caller is
+  // responsible for `offset` not overlapping any allocation whose usage
+  // interval intersects [first_node, last_node].
+  TfLiteStatus AllocateAt(TfLiteContext* context, size_t alignment,
+                          size_t offset, size_t size, int32_t tensor,
+                          int32_t first_node, int32_t last_node,
+                          ArenaAllocWithUsageInterval* new_alloc);
+
   TfLiteStatus Deallocate(TfLiteContext* context,
                           const ArenaAllocWithUsageInterval& alloc);
 
@@ -106,6 +115,10 @@ class SimpleMemoryArena {
   }
 
  private:
+  // Adds `alloc` to ordered_allocs_, keeping them sorted by offset, and
+  // updates the required buffer size.
+  void InsertAlloc(const ArenaAllocWithUsageInterval& alloc);
+
   bool committed_;
   size_t arena_alignment_;
   size_t high_water_mark_;
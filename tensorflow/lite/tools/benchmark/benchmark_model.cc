@@ -62,6 +62,26 @@ void BenchmarkLoggingListener::OnBenchmarkEnd(const BenchmarkResults& results) {
   TFLITE_LOG(INFO) << "Peak memory footprint (MB): init="
                    << init_mem_usage.max_rss_kb / 1024.0
                    << " overall=" << overall_mem_usage.max_rss_kb / 1024.0;
+
+  const ThroughputStats& throughput = results.throughput_stats();
+  if (throughput.num_instances == 0) return;
+  TFLITE_LOG(INFO) << "Throughput of " << throughput.num_instances
+                   << " instances ("
+                   << (throughput.request_rate > 0 ? "open loop"
+                                                   : "closed loop")
+                   << "): " << throughput.num_requests << " requests, "
+                   << throughput.queries_per_second << " QPS, "
+                   << "latency in us: p50=" << throughput.p50_latency_us
+                   << " p99=" << throughput.p99_latency_us
+                   << " p999=" << throughput.p999_latency_us;
+  if (!throughput.cpu_utilization.empty()) {
+    std::stringstream stream;
+    for (int i = 0; i < throughput.cpu_utilization.size(); ++i) {
+      stream << (i == 0 ? "" : " ") << "cpu" << i << "="
+             << throughput.cpu_utilization[i] * 100.0 << "%";
+    }
+    TFLITE_LOG(INFO) << "CPU utilization: " << stream.str();
+  }
 }
 
 std::vector<Flag> BenchmarkModel::GetFlags() {
@@ -207,7 +227,7 @@ TfLiteStatus BenchmarkModel::Run() {
 
   listeners_.OnBenchmarkEnd({model_size_mb, startup_latency_us, input_bytes,
                              warmup_time_us, inference_time_us, init_mem_usage,
-                             overall_mem_usage});
+                             overall_mem_usage, MayGetThroughputStats()});
   return status;
 }
 
@@ -38,6 +38,26 @@ enum RunType {
   REGULAR,
 };
 
+// Results of running several model instances concurrently, each request
+// being one inference on one of the instances.
+struct ThroughputStats {
+  // 0 if the benchmark didn't run in the throughput mode.
+  int num_instances = 0;
+  // Average number of requests per second that arrived, or 0 if each instance
+  // sent its next request as soon as its previous one completed.
+  double request_rate = 0.0;
+  int64_t num_requests = 0;
+  double queries_per_second = 0.0;
+  // Latency percentiles over all requests. These include the time a request
+  // waited for an instance to become free.
+  int64_t p50_latency_us = 0;
+  int64_t p99_latency_us = 0;
+  int64_t p999_latency_us = 0;
+  // Fraction of time each CPU core was busy while the requests ran, or empty
+  // if that isn't available on the platform.
+  std::vector<double> cpu_utilization;
+};
+
 class BenchmarkResults {
  public:
   BenchmarkResults(double model_size_mb, int64_t startup_latency_us,
@@ -45,14 +65,16 @@ class BenchmarkResults {
                    tensorflow::Stat<int64_t> warmup_time_us,
                    tensorflow::Stat<int64_t> inference_time_us,
                    const profiling::memory::MemoryUsage& init_mem_usage,
-                   const profiling::memory::MemoryUsage& overall_mem_usage)
+                   const profiling::memory::MemoryUsage& overall_mem_usage,
+                   const ThroughputStats& throughput_stats = ThroughputStats())
       : model_size_mb_(model_size_mb),
         startup_latency_us_(startup_latency_us),
         input_bytes_(input_bytes),
         warmup_time_us_(warmup_time_us),
         inference_time_us_(inference_time_us),
         init_mem_usage_(init_mem_usage),
-        overall_mem_usage_(overall_mem_usage) {}
+        overall_mem_usage_(overall_mem_usage),
+        throughput_stats_(throughput_stats) {}
 
   const double model_size_mb() const { return model_size_mb_; }
   tensorflow::Stat<int64_t> inference_time_us() const {
@@ -73,6 +95,7 @@ class BenchmarkResults {
   const profiling::memory::MemoryUsage& overall_mem_usage() const {
     return overall_mem_usage_;
   }
+  const ThroughputStats& throughput_stats() const { return throughput_stats_; }
 
  private:
   double model_size_mb_;
@@ -82,6 +105,7 @@ class BenchmarkResults {
   tensorflow::Stat<int64_t> inference_time_us_;
   profiling::memory::MemoryUsage init_mem_usage_;
   profiling::memory::MemoryUsage overall_mem_usage_;
+  ThroughputStats throughput_stats_;
 };
 
 class BenchmarkListener {
@@ -200,6 +224,8 @@ class BenchmarkModel {
 
   // Get the model file size if it's available.
   virtual int64_t MayGetModelFileSize() { return -1; }
+  // Get the stats of the last regular run if it ran in the throughput mode.
+  virtual ThroughputStats MayGetThroughputStats() { return ThroughputStats(); }
   virtual uint64_t ComputeInputBytes() = 0;
   virtual tensorflow::Stat<int64_t> Run(int min_num_times, float min_secs,
                                         float max_secs, RunType run_type,
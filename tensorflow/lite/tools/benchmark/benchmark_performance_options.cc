@@ -85,6 +85,12 @@ void MultiRunStatsRecorder::OnBenchmarkStart(const BenchmarkParams& params) {
     sstm << " (xnnpack)";
   }
 
+  // Handle cases run w/ multiple concurrent instances of the model.
+  if (params.HasParam("num_instances") &&
+      params.Get<int32_t>("num_instances") > 1) {
+    sstm << " x " << params.Get<int32_t>("num_instances") << " instances";
+  }
+
   current_run_name_ = sstm.str();
 }
 
@@ -104,6 +110,13 @@ void MultiRunStatsRecorder::OutputStats() {
     // Output the name of this run first.
     stream << std::setw(26) << run_stats.first << ": ";
     run_stats.second.inference_time_us().OutputToStream(&stream);
+    const ThroughputStats& throughput = run_stats.second.throughput_stats();
+    if (throughput.num_instances > 0) {
+      stream << " qps=" << throughput.queries_per_second
+             << " p50=" << throughput.p50_latency_us
+             << " p99=" << throughput.p99_latency_us
+             << " p999=" << throughput.p999_latency_us;
+    }
     // NOTE: As of 2019/11/07, the memory usage is collected in an
     // OS-process-wide way and this program performs multiple runs in a single
     // OS process, therefore, the memory usage information of each run becomes
@@ -150,7 +163,9 @@ std::vector<Flag> BenchmarkPerformanceOptions::GetFlags() {
           "A comma-separated list of TFLite performance options to benchmark. "
           "By default, all performance options are benchmarked. Note if it's "
           "set to 'none', then the tool simply benchmark the model against the "
-          "specified benchmark parameters."),
+          "specified benchmark parameters. The 'throughput' option, which "
+          "runs several instances of the model concurrently on CPU, is not "
+          "part of 'all'."),
       CreateFlag<float>("option_benchmark_run_delay", &params_,
                         "The delay between two consecutive runs of "
                         "benchmarking performance options in seconds."),
@@ -221,7 +236,7 @@ bool BenchmarkPerformanceOptions::ParsePerfOptions() {
 std::vector<std::string> BenchmarkPerformanceOptions::GetValidPerfOptions()
     const {
   std::vector<std::string> valid_options = {"all", "cpu", "gpu", "nnapi",
-                                            "none"};
+                                            "none", "throughput"};
 #if defined(TFLITE_ENABLE_HEXAGON)
   valid_options.emplace_back("dsp");
 #endif
@@ -247,6 +262,9 @@ void BenchmarkPerformanceOptions::ResetPerformanceOptions() {
   single_option_run_params_->Set<bool>("use_hexagon", false);
 #endif
   single_option_run_params_->Set<bool>("use_xnnpack", false);
+  if (single_option_run_params_->HasParam("num_instances")) {
+    single_option_run_params_->Set<int32_t>("num_instances", 1);
+  }
 }
 
 void BenchmarkPerformanceOptions::CreatePerformanceOptions() {
@@ -323,6 +341,27 @@ void BenchmarkPerformanceOptions::CreatePerformanceOptions() {
   }
 #endif
 
+  if (HasOption("throughput")) {
+    if (!single_option_run_params_->HasParam("num_instances")) {
+      TFLITE_LOG(WARN) << "The benchmark doesn't support running multiple "
+                          "instances, skipping the 'throughput' option.";
+    } else {
+      const std::vector<int> num_threads = {1, 2, 4};
+      // The single-instance runs are covered by the 'cpu' option.
+      const std::vector<int> num_instances = {2, 4};
+      for (const int thread_count : num_threads) {
+        for (const int instance_count : num_instances) {
+          BenchmarkParams params;
+          params.AddParam("num_threads",
+                          BenchmarkParam::Create<int32_t>(thread_count));
+          params.AddParam("num_instances",
+                          BenchmarkParam::Create<int32_t>(instance_count));
+          all_run_params_.emplace_back(std::move(params));
+        }
+      }
+    }
+  }
+
 #if defined(TFLITE_ENABLE_HEXAGON)
   if (benchmark_all || HasOption("dsp")) {
     BenchmarkParams params;
@@ -15,14 +15,18 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_tflite_model.h"
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <random>
+#include <sstream>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <unordered_set>
 #include <vector>
 
@@ -34,6 +38,7 @@ limitations under the License.
 #include "tensorflow/lite/op_resolver.h"
 #include "tensorflow/lite/profiling/platform_profiler.h"
 #include "tensorflow/lite/profiling/profile_summary_formatter.h"
+#include "tensorflow/lite/profiling/time.h"
 #include "tensorflow/lite/string_util.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 #include "tensorflow/lite/tools/benchmark/delegate_provider.h"
@@ -274,6 +279,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<int32_t>(0));
   default_params.AddParam("enable_platform_tracing",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("num_instances", BenchmarkParam::Create<int32_t>(1));
+  default_params.AddParam("request_rate", BenchmarkParam::Create<float>(0.0f));
 
   for (const auto& delegate_util : GetRegisteredDelegateProviders()) {
     delegate_util->AddParams(&default_params);
@@ -333,7 +340,20 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
                       "Max partitions to be delegated."),
       CreateFlag<bool>("enable_platform_tracing", &params_,
                        "enable platform-wide tracing, only meaningful when "
-                       "--enable_op_profiling is set to true.")};
+                       "--enable_op_profiling is set to true."),
+      CreateFlag<int32_t>(
+          "num_instances", &params_,
+          "number of interpreter instances of the model that run "
+          "concurrently, each on its own thread and with --num_threads "
+          "threads of its own. If it is greater than 1 or --request_rate is "
+          "set, the regular runs measure the throughput and latency "
+          "percentiles of all instances instead of the latency of one."),
+      CreateFlag<float>(
+          "request_rate", &params_,
+          "average number of requests per second that arrive at random "
+          "(Poisson) times across all instances, each served by the first "
+          "free instance. If 0, each instance sends its next request as soon "
+          "as its previous one completes.")};
 
   flags.insert(flags.end(), specific_flags.begin(), specific_flags.end());
 
@@ -378,6 +398,10 @@ void BenchmarkTfLiteModel::LogParams() {
                    << params_.Get<int32_t>("max_delegated_partitions") << "]";
   TFLITE_LOG(INFO) << "Enable platform-wide tracing: ["
                    << params_.Get<bool>("enable_platform_tracing") << "]";
+  TFLITE_LOG(INFO) << "Num instances: ["
+                   << params_.Get<int32_t>("num_instances") << "]";
+  TFLITE_LOG(INFO) << "Request rate (per second): ["
+                   << params_.Get<float>("request_rate") << "]";
 
   for (const auto& delegate_util : GetRegisteredDelegateProviders()) {
     delegate_util->LogParams(params_);
@@ -390,6 +414,14 @@ TfLiteStatus BenchmarkTfLiteModel::ValidateParams() {
         << "Please specify the name of your TF Lite input file with --graph";
     return kTfLiteError;
   }
+  if (params_.Get<int32_t>("num_instances") < 1) {
+    TFLITE_LOG(ERROR) << "--num_instances must be at least 1.";
+    return kTfLiteError;
+  }
+  if (params_.Get<float>("request_rate") < 0.0f) {
+    TFLITE_LOG(ERROR) << "--request_rate must not be negative.";
+    return kTfLiteError;
+  }
 
   return PopulateInputLayerInfo(
       params_.Get<std::string>("input_layer"),
@@ -414,6 +446,10 @@ int64_t BenchmarkTfLiteModel::MayGetModelFileSize() {
   return in_file.tellg();
 }
 
+ThroughputStats BenchmarkTfLiteModel::MayGetThroughputStats() {
+  return throughput_stats_;
+}
+
 BenchmarkTfLiteModel::InputTensorData BenchmarkTfLiteModel::LoadInputTensorData(
     const TfLiteTensor& t, const std::string& input_file_path) {
   std::ifstream value_file(input_file_path, std::ios::binary);
@@ -570,11 +606,16 @@ TfLiteStatus BenchmarkTfLiteModel::PrepareInputData() {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::ResetInputsAndOutputs() {
-  auto interpreter_inputs = interpreter_->inputs();
+  return CopyInputsToInterpreter(interpreter_.get());
+}
+
+TfLiteStatus BenchmarkTfLiteModel::CopyInputsToInterpreter(
+    Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
   // Set the values of the input tensors from inputs_data_.
   for (int j = 0; j < interpreter_inputs.size(); ++j) {
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type == kTfLiteString) {
       if (inputs_data_[j].data) {
         static_cast<DynamicBuffer*>(inputs_data_[j].data.get())
@@ -618,23 +659,79 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
   interpreter_->SetAllowFp16PrecisionForFp32(params_.Get<bool>("allow_fp16"));
 
   owned_delegates_.clear();
+  TF_LITE_ENSURE_STATUS(ApplyDelegates(interpreter_.get(), &owned_delegates_));
+
+  auto interpreter_inputs = interpreter_->inputs();
+
+  if (!inputs_.empty()) {
+    TFLITE_BENCHMARK_CHECK_EQ(inputs_.size(), interpreter_inputs.size())
+        << "Inputs mismatch: Model inputs #:" << inputs_.size()
+        << " expected: " << interpreter_inputs.size();
+  }
+
+  // Check if the tensor names match, and log a warning if it doesn't.
+  // TODO(ycling): Consider to make this an error again when the new converter
+  // create tensors with consistent naming.
+  for (int j = 0; j < inputs_.size(); ++j) {
+    const InputLayerInfo& input = inputs_[j];
+    int i = interpreter_inputs[j];
+    TfLiteTensor* t = interpreter_->tensor(i);
+    if (input.name != t->name) {
+      TFLITE_LOG(WARN) << "Tensor # " << i << " is named " << t->name
+                       << " but flags call it " << input.name;
+    }
+  }
+
+  TF_LITE_ENSURE_STATUS(ResizeAndAllocateTensors(interpreter_.get()));
+
+  ruy_profiling_listener_.reset(new RuyProfileListener());
+  AddListener(ruy_profiling_listener_.get());
+
+  // Create the other instances of the model for the throughput mode.
+  throughput_stats_ = ThroughputStats();
+  extra_instances_.clear();
+  const int32_t num_instances = params_.Get<int32_t>("num_instances");
+  for (int i = 1; i < num_instances; ++i) {
+    extra_instances_.emplace_back();
+    ModelInstance& instance = extra_instances_.back();
+    tflite::InterpreterBuilder(*model_, *resolver)(&instance.interpreter,
+                                                   num_threads);
+    if (!instance.interpreter) {
+      TFLITE_LOG(ERROR) << "Failed to construct interpreter instance #" << i;
+      return kTfLiteError;
+    }
+    instance.interpreter->UseNNAPI(params_.Get<bool>("use_legacy_nnapi"));
+    instance.interpreter->SetAllowFp16PrecisionForFp32(
+        params_.Get<bool>("allow_fp16"));
+    TF_LITE_ENSURE_STATUS(
+        ApplyDelegates(instance.interpreter.get(), &instance.delegates));
+    TF_LITE_ENSURE_STATUS(
+        ResizeAndAllocateTensors(instance.interpreter.get()));
+  }
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkTfLiteModel::ApplyDelegates(
+    Interpreter* interpreter,
+    std::vector<Interpreter::TfLiteDelegatePtr>* delegates) {
   for (const auto& delegate_provider : GetRegisteredDelegateProviders()) {
     auto delegate = delegate_provider->CreateTfLiteDelegate(params_);
     // It's possible that a delegate of certain type won't be created as
     // user-specified benchmark params tells not to.
     if (delegate == nullptr) continue;
-    if (interpreter_->ModifyGraphWithDelegate(delegate.get()) != kTfLiteOk) {
+    if (interpreter->ModifyGraphWithDelegate(delegate.get()) != kTfLiteOk) {
       TFLITE_LOG(ERROR) << "Failed to apply " << delegate_provider->GetName()
                         << " delegate.";
       return kTfLiteError;
     } else {
       bool fully_delegated = true;
-      if (interpreter_->execution_plan().size() != 1) {
+      if (interpreter->execution_plan().size() != 1) {
         fully_delegated = false;
       } else {
-        int first_node_id = interpreter_->execution_plan()[0];
+        int first_node_id = interpreter->execution_plan()[0];
         const TfLiteNode first_node =
-            interpreter_->node_and_registration(first_node_id)->first;
+            interpreter->node_and_registration(first_node_id)->first;
         if (delegate.get() != first_node.delegate) {
           fully_delegated = false;
         }
@@ -649,48 +746,29 @@ TfLiteStatus BenchmarkTfLiteModel::Init() {
                        << " delegate, and the model graph will be "
                        << delegate_status << " executed w/ the delegate.";
     }
-    owned_delegates_.emplace_back(std::move(delegate));
+    delegates->emplace_back(std::move(delegate));
   }
 
-  auto interpreter_inputs = interpreter_->inputs();
-
-  if (!inputs_.empty()) {
-    TFLITE_BENCHMARK_CHECK_EQ(inputs_.size(), interpreter_inputs.size())
-        << "Inputs mismatch: Model inputs #:" << inputs_.size()
-        << " expected: " << interpreter_inputs.size();
-  }
-
-  // Check if the tensor names match, and log a warning if it doesn't.
-  // TODO(ycling): Consider to make this an error again when the new converter
-  // create tensors with consistent naming.
-  for (int j = 0; j < inputs_.size(); ++j) {
-    const InputLayerInfo& input = inputs_[j];
-    int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
-    if (input.name != t->name) {
-      TFLITE_LOG(WARN) << "Tensor # " << i << " is named " << t->name
-                       << " but flags call it " << input.name;
-    }
-  }
+  return kTfLiteOk;
+}
 
+TfLiteStatus BenchmarkTfLiteModel::ResizeAndAllocateTensors(
+    Interpreter* interpreter) {
+  auto interpreter_inputs = interpreter->inputs();
   // Resize all non-string tensors.
   for (int j = 0; j < inputs_.size(); ++j) {
     const InputLayerInfo& input = inputs_[j];
     int i = interpreter_inputs[j];
-    TfLiteTensor* t = interpreter_->tensor(i);
+    TfLiteTensor* t = interpreter->tensor(i);
     if (t->type != kTfLiteString) {
-      interpreter_->ResizeInputTensor(i, input.shape);
+      interpreter->ResizeInputTensor(i, input.shape);
     }
   }
 
-  if (interpreter_->AllocateTensors() != kTfLiteOk) {
+  if (interpreter->AllocateTensors() != kTfLiteOk) {
     TFLITE_LOG(ERROR) << "Failed to allocate tensors!";
     return kTfLiteError;
   }
-
-  ruy_profiling_listener_.reset(new RuyProfileListener());
-  AddListener(ruy_profiling_listener_.get());
-
   return kTfLiteOk;
 }
 
@@ -730,5 +808,135 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() { return interpreter_->Invoke(); }
 
+bool BenchmarkTfLiteModel::IsThroughputMode() const {
+  return params_.Get<int32_t>("num_instances") > 1 ||
+         params_.Get<float>("request_rate") > 0.0f;
+}
+
+tensorflow::Stat<int64_t> BenchmarkTfLiteModel::Run(
+    int min_num_times, float min_secs, float max_secs, RunType run_type,
+    TfLiteStatus* invoke_status) {
+  if (run_type != REGULAR || !IsThroughputMode()) {
+    return BenchmarkModel::Run(min_num_times, min_secs, max_secs, run_type,
+                               invoke_status);
+  }
+  return RunThroughput(min_num_times, min_secs, max_secs, invoke_status);
+}
+
+tensorflow::Stat<int64_t> BenchmarkTfLiteModel::RunThroughput(
+    int min_num_times, float min_secs, float max_secs,
+    TfLiteStatus* invoke_status) {
+  std::vector<Interpreter*> interpreters = {interpreter_.get()};
+  for (auto& instance : extra_instances_) {
+    interpreters.push_back(instance.interpreter.get());
+  }
+  const int num_instances = interpreters.size();
+  const float request_rate = params_.Get<float>("request_rate");
+  TFLITE_LOG(INFO) << "Running " << num_instances
+                   << " instances concurrently for at least " << min_num_times
+                   << " requests and at least " << min_secs << " seconds but"
+                   << " terminate if exceeding " << max_secs << " seconds.";
+
+  // Each request reuses the inputs of its instance. Only 'interpreter_' took
+  // part in the warmup, so warm up the other instances here.
+  *invoke_status = kTfLiteOk;
+  for (int i = 0; i < num_instances; ++i) {
+    CopyInputsToInterpreter(interpreters[i]);
+    if (i > 0 && interpreters[i]->Invoke() != kTfLiteOk) {
+      *invoke_status = kTfLiteError;
+    }
+  }
+
+  throughput_stats_ = ThroughputStats();
+  std::mutex mu;
+  std::exponential_distribution<double> interarrival_secs(
+      request_rate > 0.0f ? request_rate : 1.0f);
+  int64_t num_sent = 0;
+  std::vector<std::vector<int64_t>> latencies_us(num_instances);
+  std::vector<TfLiteStatus> statuses(num_instances, kTfLiteOk);
+
+  std::vector<util::CpuTime> start_cpu_times;
+  const bool has_cpu_times = util::GetPerCoreCpuTimes(&start_cpu_times);
+  const int64_t start_us = profiling::time::NowMicros();
+  const int64_t min_finish_us = start_us + static_cast<int64_t>(min_secs * 1e6);
+  const int64_t max_finish_us = start_us + static_cast<int64_t>(max_secs * 1e6);
+  double next_arrival_us = start_us;
+
+  // Returns the time the next request arrives at, or -1 if no more requests
+  // should be sent. In the closed loop, a request arrives as soon as there is
+  // a free instance. In the open loop, requests arrive at random times
+  // regardless of how quickly they are served.
+  auto next_request_us = [&]() -> int64_t {
+    std::lock_guard<std::mutex> lock(mu);
+    const int64_t now_us = profiling::time::NowMicros();
+    const int64_t arrival_us =
+        request_rate > 0.0f ? static_cast<int64_t>(next_arrival_us) : now_us;
+    if ((num_sent >= min_num_times && arrival_us >= min_finish_us) ||
+        arrival_us > max_finish_us || now_us > max_finish_us) {
+      return -1;
+    }
+    ++num_sent;
+    if (request_rate > 0.0f) {
+      next_arrival_us += interarrival_secs(random_engine_) * 1e6;
+    }
+    return arrival_us;
+  };
+
+  auto serve_requests = [&](int i) {
+    for (int64_t arrival_us = next_request_us(); arrival_us >= 0;
+         arrival_us = next_request_us()) {
+      const int64_t now_us = profiling::time::NowMicros();
+      if (arrival_us > now_us) {
+        profiling::time::SleepForMicros(arrival_us - now_us);
+      }
+      const TfLiteStatus status = interpreters[i]->Invoke();
+      // Measure from the arrival so that time spent waiting for a free
+      // instance counts as latency.
+      latencies_us[i].push_back(profiling::time::NowMicros() - arrival_us);
+      if (status != kTfLiteOk) statuses[i] = status;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_instances; ++i) {
+    threads.emplace_back(serve_requests, i);
+  }
+  for (auto& thread : threads) thread.join();
+  const int64_t end_us = profiling::time::NowMicros();
+  std::vector<util::CpuTime> end_cpu_times;
+  if (has_cpu_times && util::GetPerCoreCpuTimes(&end_cpu_times)) {
+    throughput_stats_.cpu_utilization =
+        util::GetPerCoreCpuUtilization(start_cpu_times, end_cpu_times);
+  }
+
+  tensorflow::Stat<int64_t> run_stats;
+  std::vector<int64_t> all_latencies_us;
+  for (int i = 0; i < num_instances; ++i) {
+    for (int64_t latency_us : latencies_us[i]) {
+      run_stats.UpdateStat(latency_us);
+      all_latencies_us.push_back(latency_us);
+    }
+    if (statuses[i] != kTfLiteOk) *invoke_status = statuses[i];
+  }
+  std::sort(all_latencies_us.begin(), all_latencies_us.end());
+
+  throughput_stats_.num_instances = num_instances;
+  throughput_stats_.request_rate = request_rate;
+  throughput_stats_.num_requests = all_latencies_us.size();
+  throughput_stats_.queries_per_second =
+      end_us > start_us ? all_latencies_us.size() * 1e6 / (end_us - start_us)
+                        : 0.0;
+  throughput_stats_.p50_latency_us = util::GetPercentile(all_latencies_us, 50);
+  throughput_stats_.p99_latency_us = util::GetPercentile(all_latencies_us, 99);
+  throughput_stats_.p999_latency_us =
+      util::GetPercentile(all_latencies_us, 99.9);
+
+  std::stringstream stream;
+  run_stats.OutputToStream(&stream);
+  TFLITE_LOG(INFO) << stream.str() << std::endl;
+
+  return run_stats;
+}
+
 }  // namespace benchmark
 }  // namespace tflite
@@ -55,6 +55,8 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   explicit BenchmarkTfLiteModel(BenchmarkParams params = DefaultParams());
   ~BenchmarkTfLiteModel() override;
 
+  using BenchmarkModel::Run;
+
   std::vector<Flag> GetFlags() override;
   void LogParams() override;
   TfLiteStatus ValidateParams() override;
@@ -68,6 +70,13 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   TfLiteStatus ResetInputsAndOutputs() override;
 
   int64_t MayGetModelFileSize() override;
+  ThroughputStats MayGetThroughputStats() override;
+
+  // Runs all instances concurrently instead for regular runs in the
+  // throughput mode, i.e. if --num_instances > 1 or --request_rate is set.
+  tensorflow::Stat<int64_t> Run(int min_num_times, float min_secs,
+                                float max_secs, RunType run_type,
+                                TfLiteStatus* invoke_status) override;
 
   virtual TfLiteStatus LoadModel();
 
@@ -114,12 +123,40 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   InputTensorData LoadInputTensorData(const TfLiteTensor& t,
                                       const std::string& input_file_path);
 
+  // An instance of the model other than 'interpreter_' in the throughput
+  // mode. The delegates are declared first to outlive the interpreter.
+  struct ModelInstance {
+    std::vector<Interpreter::TfLiteDelegatePtr> delegates;
+    std::unique_ptr<tflite::Interpreter> interpreter;
+  };
+
+  // Creates the delegates requested by the params into 'delegates' and
+  // applies them to 'interpreter'.
+  TfLiteStatus ApplyDelegates(
+      Interpreter* interpreter,
+      std::vector<Interpreter::TfLiteDelegatePtr>* delegates);
+
+  // Resizes the inputs of 'interpreter' as given by 'inputs_' and allocates
+  // its tensors.
+  TfLiteStatus ResizeAndAllocateTensors(Interpreter* interpreter);
+
+  // Copies 'inputs_data_' into the input tensors of 'interpreter'.
+  TfLiteStatus CopyInputsToInterpreter(Interpreter* interpreter);
+
+  bool IsThroughputMode() const;
+
+  tensorflow::Stat<int64_t> RunThroughput(int min_num_times, float min_secs,
+                                          float max_secs,
+                                          TfLiteStatus* invoke_status);
+
   std::vector<InputLayerInfo> inputs_;
   std::vector<InputTensorData> inputs_data_;
   std::unique_ptr<BenchmarkListener> profiling_listener_ = nullptr;
   std::unique_ptr<BenchmarkListener> ruy_profiling_listener_ = nullptr;
   std::mt19937 random_engine_;
   std::vector<Interpreter::TfLiteDelegatePtr> owned_delegates_;
+  std::vector<ModelInstance> extra_instances_;
+  ThroughputStats throughput_stats_;
   // Always TFLITE_LOG the benchmark result.
   BenchmarkLoggingListener log_output_;
 };
@@ -15,6 +15,11 @@ limitations under the License.
 
 #include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+
 #include "tensorflow/lite/profiling/time.h"
 
 namespace tflite {
@@ -32,6 +37,55 @@ void SleepForSeconds(double sleep_seconds) {
       static_cast<uint64_t>(sleep_seconds * 1e6));
 }
 
+int64_t GetPercentile(const std::vector<int64_t>& sorted_values,
+                      double percentile) {
+  if (sorted_values.empty()) return 0;
+  // Guard against e.g. 99.9 / 100 * 1000 rounding up to slightly above 999.
+  const double rank =
+      std::ceil(percentile / 100.0 * sorted_values.size() - 1e-9);
+  const size_t index = rank < 1.0 ? 0 : static_cast<size_t>(rank) - 1;
+  return sorted_values[std::min(index, sorted_values.size() - 1)];
+}
+
+bool GetPerCoreCpuTimes(std::vector<CpuTime>* cpu_times) {
+  cpu_times->clear();
+  std::ifstream stat_file("/proc/stat");
+  if (!stat_file.good()) return false;
+  // Per-core lines look like "cpu0 user nice system idle iowait irq ...",
+  // after an aggregated "cpu ..." line.
+  for (std::string line; std::getline(stat_file, line);) {
+    if (line.compare(0, 3, "cpu") != 0) break;
+    if (line.size() < 4 || line[3] < '0' || line[3] > '9') continue;
+    std::istringstream fields(line);
+    std::string name;
+    fields >> name;
+    CpuTime cpu_time;
+    uint64_t ticks;
+    // Only the first 8 fields, up to steal, add up to the total: the guest
+    // time after them is already included in the user time.
+    for (int i = 0; i < 8 && fields >> ticks; ++i) {
+      cpu_time.total += ticks;
+      // Neither idle (3), iowait (4) nor steal (7) time counts as busy.
+      if (i != 3 && i != 4 && i != 7) cpu_time.busy += ticks;
+    }
+    cpu_times->push_back(cpu_time);
+  }
+  return !cpu_times->empty();
+}
+
+std::vector<double> GetPerCoreCpuUtilization(
+    const std::vector<CpuTime>& start, const std::vector<CpuTime>& end) {
+  std::vector<double> utilization;
+  if (start.size() != end.size()) return utilization;
+  for (size_t i = 0; i < start.size(); ++i) {
+    const uint64_t total = end[i].total - start[i].total;
+    utilization.push_back(
+        total == 0 ? 0.0
+                   : static_cast<double>(end[i].busy - start[i].busy) / total);
+  }
+  return utilization;
+}
+
 }  // namespace util
 }  // namespace benchmark
 }  // namespace tflite
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 #define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_UTILS_H_
 
+#include <cstdint>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -45,6 +46,27 @@ bool SplitAndParse(const std::string& str, char delim, std::vector<T>* values) {
   return true;
 }
 
+// Returns the nearest-rank 'percentile' (in [0, 100]) of 'sorted_values',
+// which must be sorted in increasing order, or 0 if it is empty.
+int64_t GetPercentile(const std::vector<int64_t>& sorted_values,
+                      double percentile);
+
+// Cumulative time a CPU core has spent busy and in total, in the unit of the
+// platform's clock ticks.
+struct CpuTime {
+  uint64_t busy = 0;
+  uint64_t total = 0;
+};
+
+// Reads the cumulative CPU time of each core. Returns false if this isn't
+// supported on the platform, e.g. anywhere /proc/stat is not available.
+bool GetPerCoreCpuTimes(std::vector<CpuTime>* cpu_times);
+
+// Returns the fraction of time each core was busy between the two readings,
+// or an empty vector if they don't cover the same cores.
+std::vector<double> GetPerCoreCpuUtilization(
+    const std::vector<CpuTime>& start, const std::vector<CpuTime>& end);
+
 }  // namespace util
 }  // namespace benchmark
 }  // namespace tflite
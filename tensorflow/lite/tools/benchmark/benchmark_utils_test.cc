@@ -75,6 +75,28 @@ TEST(BenchmarkHelpersTest, SplitAndParseInts) {
   EXPECT_EQ(2, results[1]);
 }
 
+TEST(BenchmarkHelpersTest, GetPercentile) {
+  std::vector<int64_t> values;
+  EXPECT_EQ(0, util::GetPercentile(values, 50));
+
+  for (int64_t i = 1; i <= 1000; ++i) values.push_back(i);
+  EXPECT_EQ(1, util::GetPercentile(values, 0));
+  EXPECT_EQ(500, util::GetPercentile(values, 50));
+  EXPECT_EQ(990, util::GetPercentile(values, 99));
+  EXPECT_EQ(999, util::GetPercentile(values, 99.9));
+  EXPECT_EQ(1000, util::GetPercentile(values, 100));
+}
+
+TEST(BenchmarkHelpersTest, GetPerCoreCpuUtilization) {
+  std::vector<util::CpuTime> start = {{10, 100}, {0, 100}};
+  std::vector<util::CpuTime> end = {{60, 200}, {0, 100}};
+  EXPECT_THAT(util::GetPerCoreCpuUtilization(start, end),
+              testing::ElementsAre(0.5, 0.0));
+
+  end.pop_back();
+  EXPECT_TRUE(util::GetPerCoreCpuUtilization(start, end).empty());
+}
+
 }  // namespace
 }  // namespace benchmark
 }  // namespace tflite
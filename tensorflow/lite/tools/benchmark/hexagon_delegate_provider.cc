@@ -91,6 +91,24 @@ TfLiteDelegatePtr HexagonDelegateProvider::CreateTfLiteDelegate(
       TFLITE_LOG(WARN)
           << "Could not create Hexagon delegate: platform may not support "
              "delegate or required libraries are missing";
+    } else {
+      // Reports how the time of the delegated graphs splits between the DSP
+      // and the host when the delegate is deleted at the end of the run.
+      static auto* const delete_delegate = delegate.get_deleter();
+      delegate = TfLiteDelegatePtr(
+          delegate.release(), [](TfLiteDelegate* hexagon_delegate) {
+            TfLiteHexagonExecutionStats stats;
+            TfLiteHexagonGetExecutionStats(&stats);
+            if (stats.num_invocations > 0) {
+              TFLITE_LOG(INFO)
+                  << "Hexagon graphs invoked " << stats.num_invocations
+                  << " times, average DSP time "
+                  << stats.dsp_time_us / stats.num_invocations
+                  << " us, host time "
+                  << stats.host_time_us / stats.num_invocations << " us";
+            }
+            delete_delegate(hexagon_delegate);
+          });
     }
   }
 #endif
@@ -0,0 +1,327 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/offline_memory_planner.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+
+#include "absl/memory/memory.h"
+#include "tensorflow/lite/c/common.h"
+#include "tensorflow/lite/core/api/flatbuffer_conversions.h"
+#include "tensorflow/lite/error_reporter.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace optimize {
+
+namespace {
+
+constexpr int32_t kOnlinePlannedTensor = -1;
+constexpr int kEndOfGraph = std::numeric_limits<int>::max();
+
+// Size and lifetime of a tensor to place in the arena. Lifetimes are
+// inclusive ranges of operator indices.
+struct TensorUsage {
+  int tensor;
+  size_t bytes;
+  int first_op;
+  int last_op;
+};
+
+size_t AlignTo(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+bool OverlapInTime(const TensorUsage& a, const TensorUsage& b) {
+  return a.first_op <= b.last_op && b.first_op <= a.last_op;
+}
+
+// Places `usages` in the given order, each in the smallest gap between the
+// already placed tensors that live at the same time, or after all of them.
+// Returns the size of the arena.
+size_t PlaceBestFit(const std::vector<TensorUsage>& usages,
+                    const std::vector<int>& order, size_t alignment,
+                    std::vector<size_t>* offsets) {
+  offsets->assign(usages.size(), 0);
+  // Indices of the placed usages, sorted by offset.
+  std::vector<int> placed;
+  size_t arena_size = 0;
+  for (int i : order) {
+    const TensorUsage& usage = usages[i];
+    size_t best_offset = std::numeric_limits<size_t>::max();
+    size_t best_gap = std::numeric_limits<size_t>::max();
+    size_t current_offset = 0;
+    for (int j : placed) {
+      if (!OverlapInTime(usage, usages[j])) continue;
+      const size_t gap_start = AlignTo(current_offset, alignment);
+      if (gap_start + usage.bytes <= (*offsets)[j] &&
+          (*offsets)[j] - gap_start < best_gap) {
+        best_offset = gap_start;
+        best_gap = (*offsets)[j] - gap_start;
+      }
+      current_offset =
+          std::max(current_offset, (*offsets)[j] + usages[j].bytes);
+    }
+    if (best_gap == std::numeric_limits<size_t>::max()) {
+      best_offset = AlignTo(current_offset, alignment);
+    }
+    (*offsets)[i] = best_offset;
+    arena_size = std::max(arena_size, best_offset + usage.bytes);
+    auto it = std::upper_bound(
+        placed.begin(), placed.end(), best_offset,
+        [offsets](size_t offset, int j) { return offset < (*offsets)[j]; });
+    placed.insert(it, i);
+  }
+  return arena_size;
+}
+
+// Returns the usages of the tensors of `subgraph` that need to be placed in
+// the arena.
+std::vector<TensorUsage> GetTensorUsages(const ModelT& model,
+                                         const SubGraphT& subgraph) {
+  const int num_tensors = subgraph.tensors.size();
+  std::vector<int> first_op(num_tensors, kEndOfGraph);
+  std::vector<int> last_op(num_tensors, -1);
+  std::vector<bool> is_consumed(num_tensors, false);
+  for (int i = 0; i < subgraph.operators.size(); ++i) {
+    const OperatorT& op = *subgraph.operators[i];
+    for (int tensor : op.outputs) {
+      if (tensor < 0) continue;
+      first_op[tensor] = std::min(first_op[tensor], i);
+    }
+    for (int tensor : op.inputs) {
+      if (tensor < 0) continue;
+      last_op[tensor] = std::max(last_op[tensor], i);
+      is_consumed[tensor] = true;
+    }
+  }
+  for (int tensor : subgraph.inputs) {
+    first_op[tensor] = 0;
+    last_op[tensor] = kEndOfGraph;
+  }
+  for (int tensor : subgraph.outputs) {
+    last_op[tensor] = kEndOfGraph;
+  }
+
+  std::vector<TensorUsage> usages;
+  for (int i = 0; i < num_tensors; ++i) {
+    const TensorT& tensor = *subgraph.tensors[i];
+    if (first_op[i] == kEndOfGraph || tensor.is_variable) continue;
+    if (tensor.buffer < model.buffers.size() &&
+        !model.buffers[tensor.buffer]->data.empty()) {
+      continue;
+    }
+    TfLiteType type;
+    size_t type_size;
+    if (ConvertTensorType(tensor.type, &type, DefaultErrorReporter()) !=
+            kTfLiteOk ||
+        GetSizeOfType(nullptr, type, &type_size) != kTfLiteOk) {
+      continue;
+    }
+    size_t bytes = type_size;
+    for (int dim : tensor.shape) {
+      bytes *= std::max(dim, 0);
+    }
+    if (bytes == 0) continue;
+    usages.push_back({i, bytes, first_op[i],
+                      is_consumed[i] ? last_op[i] : kEndOfGraph});
+  }
+  return usages;
+}
+
+// Stores `offsets` in the model metadata `name`, in the format described in
+// the header.
+void AddOffsetsMetadata(const char* name, int32_t version, int subgraph_index,
+                        const std::vector<int32_t>& offsets, ModelT* model) {
+  std::vector<int32_t> values = {version, subgraph_index,
+                                 static_cast<int32_t>(offsets.size())};
+  values.insert(values.end(), offsets.begin(), offsets.end());
+
+  auto buffer = absl::make_unique<BufferT>();
+  buffer->data.resize(values.size() * sizeof(int32_t));
+  memcpy(buffer->data.data(), values.data(), buffer->data.size());
+  auto entry = absl::make_unique<MetadataT>();
+  entry->name = name;
+  entry->buffer = model->buffers.size();
+  model->buffers.push_back(std::move(buffer));
+  model->metadata.push_back(std::move(entry));
+}
+
+std::unique_ptr<flatbuffers::FlatBufferBuilder> FinishModel(
+    const tflite::ModelT* model) {
+  std::unique_ptr<flatbuffers::FlatBufferBuilder> builder(
+      new flatbuffers::FlatBufferBuilder());
+  auto packed_model = tflite::Model::Pack(*builder, model);
+  tflite::FinishModelBuffer(*builder, packed_model);
+  return builder;
+}
+
+}  // namespace
+
+std::vector<int32_t> PlanSubgraphMemory(const ModelT& model,
+                                        int subgraph_index, int alignment) {
+  std::vector<int32_t> scratch_buffer_offsets;
+  return PlanSubgraphMemory(model, subgraph_index, alignment, {},
+                            &scratch_buffer_offsets);
+}
+
+std::vector<int32_t> PlanSubgraphMemory(
+    const ModelT& model, int subgraph_index, int alignment,
+    const std::vector<ScratchBufferRequest>& scratch_buffers,
+    std::vector<int32_t>* scratch_buffer_offsets) {
+  const SubGraphT& subgraph = *model.subgraphs[subgraph_index];
+  std::vector<TensorUsage> usages = GetTensorUsages(model, subgraph);
+  // Scratch buffer i is placed as tensor num_tensors + i.
+  const int num_tensors = subgraph.tensors.size();
+  for (int i = 0; i < scratch_buffers.size(); ++i) {
+    if (scratch_buffers[i].bytes == 0) continue;
+    usages.push_back({num_tensors + i, scratch_buffers[i].bytes,
+                      scratch_buffers[i].op, scratch_buffers[i].op});
+  }
+
+  // Orders in which tensors are placed. Large tensors first leave the small
+  // ones to fill the gaps, and long-lived ones first avoid fragmenting the
+  // arena with short-lived ones.
+  using Compare = std::function<bool(const TensorUsage&, const TensorUsage&)>;
+  auto lifetime = [](const TensorUsage& u) {
+    return static_cast<size_t>(std::min(u.last_op, kEndOfGraph - 1)) -
+           u.first_op + 1;
+  };
+  const std::vector<Compare> compares = {
+      [](const TensorUsage& a, const TensorUsage& b) {
+        return a.bytes > b.bytes;
+      },
+      [&lifetime](const TensorUsage& a, const TensorUsage& b) {
+        return lifetime(a) > lifetime(b);
+      },
+      [&lifetime](const TensorUsage& a, const TensorUsage& b) {
+        return a.bytes * lifetime(a) > b.bytes * lifetime(b);
+      },
+      [](const TensorUsage& a, const TensorUsage& b) {
+        if (a.first_op != b.first_op) return a.first_op < b.first_op;
+        return a.bytes > b.bytes;
+      },
+  };
+
+  std::vector<size_t> best_offsets;
+  size_t best_arena_size = std::numeric_limits<size_t>::max();
+  for (const Compare& compare : compares) {
+    std::vector<int> order(usages.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+      return compare(usages[a], usages[b]);
+    });
+    std::vector<size_t> offsets;
+    const size_t arena_size = PlaceBestFit(usages, order, alignment, &offsets);
+    if (arena_size < best_arena_size) {
+      best_arena_size = arena_size;
+      best_offsets = std::move(offsets);
+    }
+  }
+
+  std::vector<int32_t> result(num_tensors, kOnlinePlannedTensor);
+  scratch_buffer_offsets->assign(scratch_buffers.size(), kOnlinePlannedTensor);
+  for (int i = 0; i < usages.size(); ++i) {
+    // Buffers that end beyond the range of the offsets are left to the online
+    // planner.
+    if (best_offsets[i] + usages[i].bytes >
+        std::numeric_limits<int32_t>::max()) {
+      continue;
+    }
+    const int32_t offset = static_cast<int32_t>(best_offsets[i]);
+    if (usages[i].tensor < num_tensors) {
+      result[usages[i].tensor] = offset;
+    } else {
+      (*scratch_buffer_offsets)[usages[i].tensor - num_tensors] = offset;
+    }
+  }
+  return result;
+}
+
+TfLiteStatus PlanMemoryOffline(
+    ModelT* model, int alignment, ErrorReporter* error_reporter,
+    const std::vector<ScratchBufferRequest>& scratch_buffers) {
+  if (alignment <= 0) {
+    error_reporter->Report("Invalid alignment %d.", alignment);
+    return kTfLiteError;
+  }
+  if (!scratch_buffers.empty() && model->subgraphs.empty()) {
+    error_reporter->Report("Scratch buffers given for a model without any "
+                           "subgraph.");
+    return kTfLiteError;
+  }
+  // Drop the layouts of a previous run. Their buffers are emptied rather than
+  // removed, to keep the indices of the other buffers.
+  auto& metadata = model->metadata;
+  for (auto it = metadata.begin(); it != metadata.end();) {
+    if ((*it)->name == kOfflineMemAllocMetadata ||
+        (*it)->name == kOfflineScratchAllocMetadata) {
+      if ((*it)->buffer < model->buffers.size()) {
+        model->buffers[(*it)->buffer]->data.clear();
+      }
+      it = metadata.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  for (int subgraph_index = 0; subgraph_index < model->subgraphs.size();
+       ++subgraph_index) {
+    // Only TFLM requests scratch buffers, and it only runs the first
+    // subgraph.
+    const std::vector<ScratchBufferRequest> no_scratch_buffers;
+    std::vector<int32_t> scratch_buffer_offsets;
+    const std::vector<int32_t> offsets = PlanSubgraphMemory(
+        *model, subgraph_index, alignment,
+        subgraph_index == 0 ? scratch_buffers : no_scratch_buffers,
+        &scratch_buffer_offsets);
+    AddOffsetsMetadata(kOfflineMemAllocMetadata, kOfflineMemAllocVersion,
+                       subgraph_index, offsets, model);
+    if (!scratch_buffer_offsets.empty()) {
+      AddOffsetsMetadata(kOfflineScratchAllocMetadata,
+                         kOfflineScratchAllocVersion, subgraph_index,
+                         scratch_buffer_offsets, model);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus PlanMemoryOffline(
+    const string& input_file, const string& output_file, int alignment,
+    const std::vector<ScratchBufferRequest>& scratch_buffers) {
+  auto fb_model = FlatBufferModel::BuildFromFile(input_file.c_str());
+  if (!fb_model) {
+    return kTfLiteError;
+  }
+  auto model = absl::make_unique<ModelT>();
+  fb_model->GetModel()->UnPackTo(model.get(), nullptr);
+
+  TF_LITE_ENSURE_STATUS(PlanMemoryOffline(
+      model.get(), alignment, DefaultErrorReporter(), scratch_buffers));
+
+  auto builder = FinishModel(model.get());
+  std::ofstream stream(output_file, std::ios::binary | std::ios::out);
+  stream.write(reinterpret_cast<const char*>(builder->GetBufferPointer()),
+               builder->GetSize());
+  return stream.good() ? kTfLiteOk : kTfLiteError;
+}
+
+}  // namespace optimize
+}  // namespace tflite
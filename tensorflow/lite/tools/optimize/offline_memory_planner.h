@@ -0,0 +1,109 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_OPTIMIZE_OFFLINE_MEMORY_PLANNER_H_
+#define TENSORFLOW_LITE_TOOLS_OPTIMIZE_OFFLINE_MEMORY_PLANNER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/api/error_reporter.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace optimize {
+
+// Name of the model metadata holding the offline-planned arena layout of a
+// subgraph. Its buffer is an int32 array of the form
+//   [version, subgraph_index, num_tensors, offset_0, ..., offset_{n-1}]
+// where offset_i is the arena offset in bytes of tensor i of the subgraph, or
+// -1 for tensors that are left to the online planner.
+constexpr char kOfflineMemAllocMetadata[] = "OfflineMemoryAllocation";
+constexpr int32_t kOfflineMemAllocVersion = 1;
+
+// Name of the model metadata holding the offline-planned arena offsets of the
+// scratch buffers that the kernels of a subgraph request from the TFLM
+// allocator. Its buffer is an int32 array of the form
+//   [version, subgraph_index, num_buffers, offset_0, ..., offset_{n-1}]
+// where offset_i is the arena offset in bytes of the i-th requested scratch
+// buffer, or -1 for buffers that are left to the online planner.
+constexpr char kOfflineScratchAllocMetadata[] =
+    "OfflineScratchBufferAllocation";
+constexpr int32_t kOfflineScratchAllocVersion = 1;
+
+// A scratch buffer of `bytes` bytes that the kernel of operator `op` requests
+// with RequestScratchBufferInArena() in TFLM. It lives during that operator
+// only.
+struct ScratchBufferRequest {
+  int op;
+  size_t bytes;
+};
+
+// Computes the arena offsets of the tensors of subgraph `subgraph_index` of
+// `model`, in the format of the offsets of the metadata above, with every
+// offset a multiple of `alignment`.
+//
+// Tensors are assumed to live from the operator that produces them, or the
+// first one for graph inputs, up to their last consumer, or to the end of the
+// graph for graph inputs, outputs and tensors nothing consumes. This is
+// conservative for both the interpreter and TFLM. Constant and variable
+// tensors, tensors of types without a fixed size, and unused tensors are left
+// to the online planner.
+//
+// Tensors are placed in the smallest gap that fits them, in several orders,
+// and the layout with the smallest arena is kept.
+//
+// Note: This is a private API, subject to change.
+std::vector<int32_t> PlanSubgraphMemory(const ModelT& model,
+                                        int subgraph_index, int alignment);
+
+// Same as above, but also places `scratch_buffers`, which share the arena with
+// the tensors, and returns their offsets in `scratch_buffer_offsets` in the
+// same order.
+//
+// Note: This is a private API, subject to change.
+std::vector<int32_t> PlanSubgraphMemory(
+    const ModelT& model, int subgraph_index, int alignment,
+    const std::vector<ScratchBufferRequest>& scratch_buffers,
+    std::vector<int32_t>* scratch_buffer_offsets);
+
+// Plans the memory of all subgraphs of `model`, and stores the layouts in the
+// model metadata, replacing any previous ones. `alignment` needs to be a
+// multiple of the tensor alignment of the runtime, i.e. 64 bytes for the
+// interpreter and 16 bytes for TFLM.
+//
+// `scratch_buffers` are the scratch buffers requested by the kernels of the
+// first subgraph in TFLM, in the order of the requests, which can be listed
+// with MicroInterpreter::GetScratchBufferRequest(). If there are any, their
+// offsets are stored in the model metadata too.
+//
+// Note: This is a private API, subject to change.
+TfLiteStatus PlanMemoryOffline(
+    ModelT* model, int alignment, ErrorReporter* error_reporter,
+    const std::vector<ScratchBufferRequest>& scratch_buffers = {});
+
+// Same as above but reads the model from `input_file` and writes it to
+// `output_file`.
+//
+// Note: This is a private API, subject to change.
+TfLiteStatus PlanMemoryOffline(
+    const string& input_file, const string& output_file, int alignment,
+    const std::vector<ScratchBufferRequest>& scratch_buffers = {});
+
+}  // namespace optimize
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_OPTIMIZE_OFFLINE_MEMORY_PLANNER_H_
@@ -0,0 +1,72 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "tensorflow/lite/tools/optimize/offline_memory_planner.h"
+
+namespace {
+
+// Parses a list of TFLM scratch buffer requests of the form
+// "op:bytes,op:bytes,...".
+bool ParseScratchBuffers(
+    const char* str,
+    std::vector<tflite::optimize::ScratchBufferRequest>* scratch_buffers) {
+  while (*str != '\0') {
+    char* end;
+    const long op = strtol(str, &end, 10);
+    if (end == str || *end != ':' || op < 0) return false;
+    str = end + 1;
+    const long long bytes = strtoll(str, &end, 10);
+    if (end == str || (*end != ',' && *end != '\0') || bytes < 0) {
+      return false;
+    }
+    scratch_buffers->push_back(
+        {static_cast<int>(op), static_cast<size_t>(bytes)});
+    str = *end == ',' ? end + 1 : end;
+  }
+  return true;
+}
+
+}  // namespace
+
+// Plans the arena of a model offline, and stores the layout in its metadata.
+// The scratch buffers that the TFLM kernels request can be listed as
+// "op:bytes,..." to be planned along with the tensors.
+//
+// Note: This is a private API, subject to change.
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 5) {
+    printf(
+        "Wrong number of arguments. Example: offline_memory_planner_main "
+        "${input} ${output} [${alignment} [${scratch_buffers}]]");
+    return 1;
+  }
+
+  const int alignment = argc >= 4 ? atoi(argv[3]) : 64;
+  std::vector<tflite::optimize::ScratchBufferRequest> scratch_buffers;
+  if (argc == 5 && !ParseScratchBuffers(argv[4], &scratch_buffers)) {
+    printf("Invalid scratch buffers %s, expected op:bytes,...", argv[4]);
+    return 1;
+  }
+  if (tflite::optimize::PlanMemoryOffline(argv[1], argv[2], alignment,
+                                          scratch_buffers) != kTfLiteOk) {
+    printf("Failed to plan the memory of %s", argv[1]);
+    return 1;
+  }
+
+  return 0;
+}
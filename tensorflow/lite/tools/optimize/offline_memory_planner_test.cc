@@ -0,0 +1,161 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/optimize/offline_memory_planner.h"
+
+#include <cstring>
+#include <memory>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "absl/memory/memory.h"
+#include "tensorflow/lite/model.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace optimize {
+namespace {
+
+using ::testing::ElementsAre;
+
+std::unique_ptr<TensorT> CreateTensor(const std::vector<int>& shape,
+                                      int buffer) {
+  auto tensor = absl::make_unique<TensorT>();
+  tensor->shape = shape;
+  tensor->type = TensorType_FLOAT32;
+  tensor->buffer = buffer;
+  return tensor;
+}
+
+// Creates a model with an input, a constant, two FCs and an output:
+//   tensor_0 [16] -> FC(tensor_3) -> tensor_1 [32] -> FC -> tensor_2 [4]
+std::unique_ptr<ModelT> CreateModel() {
+  auto model = absl::make_unique<ModelT>();
+  auto subgraph = absl::make_unique<SubGraphT>();
+  auto fc_op_code = absl::make_unique<OperatorCodeT>();
+  fc_op_code->builtin_code = BuiltinOperator_FULLY_CONNECTED;
+  fc_op_code->version = 1;
+  model->operator_codes.push_back(std::move(fc_op_code));
+
+  auto fc_op_0 = absl::make_unique<OperatorT>();
+  fc_op_0->opcode_index = 0;
+  fc_op_0->inputs = {0, 3};
+  fc_op_0->outputs = {1};
+  auto fc_op_1 = absl::make_unique<OperatorT>();
+  fc_op_1->opcode_index = 0;
+  fc_op_1->inputs = {1};
+  fc_op_1->outputs = {2};
+  subgraph->operators.push_back(std::move(fc_op_0));
+  subgraph->operators.push_back(std::move(fc_op_1));
+  subgraph->inputs = {0};
+  subgraph->outputs = {2};
+
+  subgraph->tensors.push_back(CreateTensor({16}, 0));
+  subgraph->tensors.push_back(CreateTensor({32}, 0));
+  subgraph->tensors.push_back(CreateTensor({4}, 0));
+  subgraph->tensors.push_back(CreateTensor({32, 16}, 1));
+  model->subgraphs.push_back(std::move(subgraph));
+
+  model->buffers.push_back(absl::make_unique<BufferT>());
+  auto weights = absl::make_unique<BufferT>();
+  weights->data.resize(32 * 16 * sizeof(float));
+  model->buffers.push_back(std::move(weights));
+  return model;
+}
+
+std::vector<int32_t> GetMetadataValues(const ModelT& model, int index) {
+  const std::vector<uint8_t>& data =
+      model.buffers[model.metadata[index]->buffer]->data;
+  std::vector<int32_t> values(data.size() / sizeof(int32_t));
+  memcpy(values.data(), data.data(), values.size() * sizeof(int32_t));
+  return values;
+}
+
+TEST(OfflineMemoryPlannerTest, PlansNonConstantTensors) {
+  auto model = CreateModel();
+  // All three activations are alive while tensor_1 is, so they may not share
+  // memory. The constant is left to the online planner.
+  EXPECT_THAT(PlanSubgraphMemory(*model, 0, 64), ElementsAre(128, 0, 192, -1));
+}
+
+TEST(OfflineMemoryPlannerTest, ReusesMemoryOfDeadTensors) {
+  auto model = CreateModel();
+  // Make tensor_1 an intermediate of a three-op chain, so that it dies before
+  // the output of the last op is produced.
+  auto fc_op_2 = absl::make_unique<OperatorT>();
+  fc_op_2->opcode_index = 0;
+  fc_op_2->inputs = {2};
+  fc_op_2->outputs = {4};
+  model->subgraphs[0]->operators.push_back(std::move(fc_op_2));
+  model->subgraphs[0]->tensors.push_back(CreateTensor({32}, 0));
+  model->subgraphs[0]->outputs = {4};
+
+  const std::vector<int32_t> offsets = PlanSubgraphMemory(*model, 0, 64);
+  ASSERT_EQ(offsets.size(), 5);
+  EXPECT_EQ(offsets[4], offsets[1]);
+  EXPECT_NE(offsets[2], offsets[1]);
+  EXPECT_NE(offsets[2], offsets[0]);
+  EXPECT_EQ(offsets[3], -1);
+}
+
+TEST(OfflineMemoryPlannerTest, StoresPlanInMetadata) {
+  auto model = CreateModel();
+  ASSERT_EQ(PlanMemoryOffline(model.get(), 64, DefaultErrorReporter()),
+            kTfLiteOk);
+  ASSERT_EQ(model->metadata.size(), 1);
+  EXPECT_EQ(model->metadata[0]->name, kOfflineMemAllocMetadata);
+  EXPECT_THAT(GetMetadataValues(*model, 0),
+              ElementsAre(kOfflineMemAllocVersion, 0, 4, 128, 0, 192, -1));
+
+  // Planning again replaces the previous layout.
+  ASSERT_EQ(PlanMemoryOffline(model.get(), 16, DefaultErrorReporter()),
+            kTfLiteOk);
+  ASSERT_EQ(model->metadata.size(), 1);
+  EXPECT_THAT(GetMetadataValues(*model, 0),
+              ElementsAre(kOfflineMemAllocVersion, 0, 4, 128, 0, 192, -1));
+}
+
+TEST(OfflineMemoryPlannerTest, PlansScratchBuffers) {
+  auto model = CreateModel();
+  // The scratch buffer of the first FC dies before tensor_2 is produced, so
+  // they may share memory.
+  std::vector<int32_t> scratch_buffer_offsets;
+  EXPECT_THAT(PlanSubgraphMemory(*model, 0, 64, {{0, 64}},
+                                 &scratch_buffer_offsets),
+              ElementsAre(128, 0, 192, -1));
+  EXPECT_THAT(scratch_buffer_offsets, ElementsAre(192));
+
+  ASSERT_EQ(PlanMemoryOffline(model.get(), 64, DefaultErrorReporter(),
+                              {{0, 64}}),
+            kTfLiteOk);
+  ASSERT_EQ(model->metadata.size(), 2);
+  EXPECT_EQ(model->metadata[1]->name, kOfflineScratchAllocMetadata);
+  EXPECT_THAT(GetMetadataValues(*model, 1),
+              ElementsAre(kOfflineScratchAllocVersion, 0, 1, 192));
+
+  // Planning again without scratch buffers drops their previous layout.
+  ASSERT_EQ(PlanMemoryOffline(model.get(), 64, DefaultErrorReporter()),
+            kTfLiteOk);
+  ASSERT_EQ(model->metadata.size(), 1);
+  EXPECT_EQ(model->metadata[0]->name, kOfflineMemAllocMetadata);
+}
+
+}  // namespace
+}  // namespace optimize
+}  // namespace tflite
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -147,6 +147,14 @@ class OptimizationOptions(options.OptionsBase):
       "Whether to fuse map and filter transformations. If None, defaults to "
       "False.")
 
+  map_batch_prefetch_fusion = options.create_option(
+      name="map_batch_prefetch_fusion",
+      ty=bool,
+      docstring=
+      "Whether to fuse fused map and batch transformations with a following "
+      "prefetch, so that batches are prefetched in the buffer the map "
+      "invocations write into. If None, defaults to False.")
+
   map_fusion = options.create_option(
       name="map_fusion",
       ty=bool,
@@ -221,6 +229,7 @@ class OptimizationOptions(options.OptionsBase):
         "hoist_random_uniform",
         "map_and_batch_fusion",
         "map_and_filter_fusion",
+        "map_batch_prefetch_fusion",
         "map_parallelization",
         "map_fusion",
         "noop_elimination",
@@ -199,6 +199,26 @@ class MultiDeviceIteratorTest(test_base.DatasetTestBase,
         self.evaluate(elem_on_1)
         self.evaluate(elem_on_2)
 
+  @combinations.generate(skip_v2_test_combinations())
+  def testUnevenAutotune(self):
+    dataset = dataset_ops.Dataset.range(10)
+    multi_device_iterator = multi_device_iterator_ops.MultiDeviceIterator(
+        dataset, ["/cpu:1", "/cpu:2"], max_buffer_size=dataset_ops.AUTOTUNE)
+
+    config = config_pb2.ConfigProto(device_count={"CPU": 3})
+    with self.test_session(config=config):
+      self.evaluate(multi_device_iterator.initializer)
+      for i in range(0, 10, 2):
+        elem_on_1 = multi_device_iterator.get_next("/cpu:1")
+        self.assertEqual(i, self.evaluate(elem_on_1))
+      for i in range(0, 10, 2):
+        elem_on_2 = multi_device_iterator.get_next("/cpu:2")
+        self.assertEqual(i + 1, self.evaluate(elem_on_2))
+      with self.assertRaises(errors.OutOfRangeError):
+        elem_on_1, elem_on_2 = multi_device_iterator.get_next()
+        self.evaluate(elem_on_1)
+        self.evaluate(elem_on_2)
+
   @combinations.generate(skip_v2_test_combinations())
   def testMultipleInitializationsGraph(self):
     if context.executing_eagerly():
@@ -19,6 +19,7 @@ from __future__ import division
 from __future__ import print_function
 
 from tensorflow.python import pywrap_tfe
+from tensorflow.python.eager import context
 from tensorflow.python.util.tf_export import tf_export
 
 
@@ -62,4 +63,7 @@ def from_dlpack(dlcapsule):
   Returns:
     A Tensorflow eager tensor
   """
-  return pywrap_tfe.TFE_FromDlpackCapsule(dlcapsule)
+  ctx = context.context()
+  ctx.ensure_initialized()
+  return pywrap_tfe.TFE_FromDlpackCapsule(
+      dlcapsule, ctx._handle)  # pylint: disable=protected-access
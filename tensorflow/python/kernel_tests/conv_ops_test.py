@@ -2760,7 +2760,7 @@ class SeparableConv2DTest(test.TestCase):
 class DeepConv2DTest(test.TestCase):
 
   def _CompareFwdConv2D(self, tensor_in_sizes, filter_in_sizes, conv_strides,
-                        padding):
+                        padding, env_var="TF_USE_DEEP_CONV2D"):
     """Verifies that DeepConv2D and Conv2D produce the same values.
 
     Args:
@@ -2770,6 +2770,7 @@ class DeepConv2DTest(test.TestCase):
         [kernel_rows, kernel_cols, input_depth, output_depth].
       conv_strides: [row_stride, col_stride] for the convolution;
       padding: Padding type.
+      env_var: Environment variable that enables DeepConv2D.
     """
     x1 = np.random.rand(*tensor_in_sizes).astype(np.float32)
     x2 = np.random.rand(*filter_in_sizes).astype(np.float32)
@@ -2781,21 +2782,26 @@ class DeepConv2DTest(test.TestCase):
 
       conv = nn_ops.conv2d(t1, t2, strides=strides, padding=padding)
 
-      os.environ["TF_USE_DEEP_CONV2D"] = "0"
+      os.environ[env_var] = "0"
       values_expect = self.evaluate([conv])
 
-      os.environ["TF_USE_DEEP_CONV2D"] = "1"
+      os.environ[env_var] = "1"
       values_test = self.evaluate([conv])
+      # With autotuning, the second evaluation uses the cached choice.
+      values_cached = self.evaluate([conv])
 
       self.assertAllClose(values_expect, values_test, rtol=1e-5, atol=1e-5)
+      self.assertAllClose(values_expect, values_cached, rtol=1e-5, atol=1e-5)
 
-  def _RunTestCases(self, conv_strides, padding):
+  def _RunTestCases(self, conv_strides, padding,
+                    env_var="TF_USE_DEEP_CONV2D"):
     input_sizes = [[5, 5, 5, 1248], [3, 17, 17, 192], [2, 35, 35, 288],
                    [2, 6, 8, 517], [2, 7, 4, 81], [3, 11, 3, 77]]
     filter_sizes = [[3, 3, 1248, 128], [3, 3, 192, 192], [3, 3, 288, 384],
                     [3, 3, 517, 64], [3, 3, 81, 77], [3, 3, 77, 181]]
     for input_shape, filter_shape in zip(input_sizes, filter_sizes):
-      self._CompareFwdConv2D(input_shape, filter_shape, conv_strides, padding)
+      self._CompareFwdConv2D(input_shape, filter_shape, conv_strides, padding,
+                             env_var)
 
   def testConv2D3x3FilterStride1x1Valid(self):
     self._RunTestCases([1, 1], "VALID")
@@ -2803,6 +2809,9 @@ class DeepConv2DTest(test.TestCase):
   def testConv2D3x3FilterStride1x1Same(self):
     self._RunTestCases([1, 1], "SAME")
 
+  def testConv2D3x3FilterStride1x1Autotune(self):
+    self._RunTestCases([1, 1], "SAME", env_var="TF_USE_DEEP_CONV2D_AUTOTUNE")
+
 
 class Conv2DBenchmark(test.Benchmark):
 
@@ -23,6 +23,7 @@ from absl.testing import parameterized
 from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import gen_string_ops
 from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
@@ -82,6 +83,22 @@ class RegexFullMatchOpTest(test.TestCase):
       op_tensor = string_ops.regex_full_match(input_tensor, pattern_tensor)
       self.assertTrue(op_tensor.name.startswith("RegexFullMatch"), op.name)
 
+  @test_util.run_deprecated_v1
+  def testRegexFullMatchPatternChanges(self):
+    values = ["abaaba", "abcdabcde"]
+    with self.cached_session() as sess:
+      input_tensor = constant_op.constant(values, dtypes.string)
+      pattern = array_ops.placeholder(dtypes.string, shape=[])
+      matched = gen_string_ops.regex_full_match(input_tensor, pattern)
+      self.assertAllEqual([True, False],
+                          sess.run(matched, feed_dict={pattern: "a.*a"}))
+      self.assertAllEqual([False, True],
+                          sess.run(matched, feed_dict={pattern: "a.*e"}))
+      self.assertAllEqual([True, False],
+                          sess.run(matched, feed_dict={pattern: "a.*a"}))
+      with self.assertRaisesOpError("Invalid pattern"):
+        sess.run(matched, feed_dict={pattern: "A["})
+
   @test_util.run_deprecated_v1
   def testStaticRegexFullMatchDelegation(self):
     with self.cached_session():
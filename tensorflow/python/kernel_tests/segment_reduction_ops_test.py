@@ -548,6 +548,20 @@ class SparseSegmentReductionOpTest(SparseSegmentReductionHelper):
           # and may therefore vary dynamically.
           self.assertAllEqual(np_ans.shape[1:], tf_ans.shape[1:])
 
+  def testBfloat16SumOfLongSegment(self):
+    # Summing thousands of rows in bfloat16 itself would stall once the sum
+    # outgrows the precision of its mantissa.
+    n = 4096
+    np_x = np.full([n, 3], 0.1, dtype=np.float32)
+    tf_x = math_ops.cast(constant_op.constant(np_x), dtypes_lib.bfloat16)
+    indices = np.arange(n, dtype=np.int32)
+    segment_ids = np.zeros([n], dtype=np.int32)
+    with self.cached_session(use_gpu=False):
+      s = math_ops.sparse_segment_sum(
+          data=tf_x, indices=indices, segment_ids=segment_ids)
+      tf_ans = self.evaluate(math_ops.cast(s, dtypes_lib.float32))
+    self.assertAllClose(np.full([1, 3], 0.1 * n), tf_ans, rtol=1e-2)
+
   def testSegmentIdsHole(self):
     tf_x, np_x = self._input([10, 4], dtype=dtypes_lib.float32)
     ops_list = [(np.add, None, math_ops.sparse_segment_sum), (
@@ -91,6 +91,19 @@ class SparseReorderTest(test.TestCase):
         self.assertAllEqual(output_val.dense_shape,
                             expected_output_val.dense_shape)
 
+  def testLargeOutOfOrder(self):
+    shape = np.array([40, 300, 70000], dtype=np.int64)
+    linear = np.random.permutation(
+        np.unique(np.random.randint(0, np.prod(shape), size=200000)))
+    ind = np.stack(np.unravel_index(linear, shape), axis=1).astype(np.int64)
+    val = np.arange(len(linear)).astype(np.float32)
+    order = np.argsort(linear)
+    input_val = sparse_tensor.SparseTensorValue(ind, val, shape)
+    with self.session(use_gpu=False):
+      output_val = self.evaluate(sparse_ops.sparse_reorder(input_val))
+      self.assertAllEqual(output_val.indices, ind[order])
+      self.assertAllEqual(output_val.values, val[order])
+
   @test_util.run_deprecated_v1
   def testFeedOutOfOrder(self):
     expected_output_val = self._SparseTensorValue_5x6(np.arange(6))
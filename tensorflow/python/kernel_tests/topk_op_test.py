@@ -139,6 +139,17 @@ class TopKTest(test.TestCase):
     self._testLargeTopK(np.float32)
     self._testLargeTopK(np.float16)
 
+  def testTopKLongRows(self):
+    # Long rows are split into column blocks; ties must still resolve to the
+    # lowest indices.
+    b = 2
+    n = 300000
+    k = 100
+    inputs = np.random.randint(0, 1000, size=(b, n)).astype(np.int32)
+    indices = np.argsort(-inputs, axis=1, kind="stable")[:, :k]
+    values = -np.sort(-inputs, axis=1)[:, :k]
+    self._validateTopK(inputs, k, values, indices)
+
   def _testMediumTopK(self, dtype):
     b = 5
     n = 500
@@ -248,6 +259,24 @@ class TopKBenchmark(test.Benchmark):
                 "Throughput: %0.03g GB/s" % (name, r["wall_time"], throughput))
           sys.stdout.flush()
 
+  def benchmarkTopKLongRows(self):
+    for (m, n, k) in itertools.product([1, 4], [1000000, 10000000],
+                                       [1, 100, 1000]):
+      name = "long_rows_m_%d_n_%d_k_%d" % (m, n, k)
+      with ops.Graph().as_default():
+        with ops.device("/cpu:0"):
+          x = random_ops.random_uniform((m, n))
+          v = resource_variable_ops.ResourceVariable(x)
+          op = nn_ops.top_k(v, k)
+        with session.Session() as sess:
+          v.initializer.run()
+          r = self.run_op_benchmark(sess, op, min_iters=10, name=name)
+          gb_processed_input = m * n / 1.0e9
+          throughput = gb_processed_input / r["wall_time"]
+          print("Benchmark: %s \t wall_time: %0.03g s \t "
+                "Throughput: %0.03g GB/s" % (name, r["wall_time"], throughput))
+          sys.stdout.flush()
+
 
 if __name__ == "__main__":
   test.main()
@@ -105,6 +105,18 @@ class UniqueTest(test.TestCase):
     for i in range(len(x)):
       self.assertEqual(x[i], tf_y[tf_idx[i]])
 
+  def testLargeInt64(self):
+    # Large inputs are deduplicated in parallel; the unique values must still
+    # be in order of first occurrence.
+    x = np.random.randint(0, high=50000, size=1 << 20)
+    y, idx = array_ops.unique(x)
+    tf_y, tf_idx = self.evaluate([y, idx])
+
+    _, first, inverse = np.unique(x, return_index=True, return_inverse=True)
+    rank = np.argsort(np.argsort(first))
+    self.assertAllEqual(tf_y, x[np.sort(first)])
+    self.assertAllEqual(tf_idx, rank[inverse])
+
 
 class UniqueWithCountsTest(test.TestCase):
 
@@ -120,6 +132,19 @@ class UniqueWithCountsTest(test.TestCase):
     for value, count in zip(tf_y, tf_count):
       self.assertEqual(count, np.sum(x == value))
 
+  def testLargeInt64(self):
+    x = np.random.randint(0, high=50000, size=1 << 20)
+    y, idx, count = array_ops.unique_with_counts(x)
+    tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+
+    _, first, inverse, counts = np.unique(
+        x, return_index=True, return_inverse=True, return_counts=True)
+    order = np.argsort(first)
+    rank = np.argsort(order)
+    self.assertAllEqual(tf_y, x[first[order]])
+    self.assertAllEqual(tf_idx, rank[inverse])
+    self.assertAllEqual(tf_count, counts[order])
+
   def testInt32OutIdxInt64(self):
     x = np.random.randint(2, high=10, size=7000)
     y, idx, count = array_ops.unique_with_counts(x, out_idx=dtypes.int64)
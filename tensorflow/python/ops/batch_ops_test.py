@@ -323,6 +323,75 @@ class BatchOpsTest(test.TestCase):
       self.assertEqual(thread_results[0], [2])
       self.assertEqual(main_results[0], [3])
 
+  def testBatchFunctionOpWithLengthBuckets(self):
+    """Tests that batch_function pads sequences to their length bucket."""
+    if context.executing_eagerly():
+      return
+    with self.cached_session() as sess:
+
+      @function.Defun(dtypes.int32)
+      def computation(in_t):
+        return in_t + 1
+
+      inp = array_ops.placeholder(dtype=dtypes.int32, shape=[1, None])
+      result = gen_batch_ops.batch_function(
+          [inp],
+          num_batch_threads=1,
+          max_batch_size=10,
+          batch_timeout_micros=100000,
+          length_bucket_boundaries=[4],
+          Tout=[dtypes.int32],
+          f=computation,
+          captured_tensors=computation.captured_inputs)
+      thread_results = []
+
+      def worker():
+        thread_results.extend(sess.run([result], feed_dict={inp: [[1, 2]]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      main_results = sess.run([result], feed_dict={inp: [[1, 2, 3]]})
+      worker_thread.join()
+      self.assertAllEqual(thread_results[0], [[2, 3, 1, 1]])
+      self.assertAllEqual(main_results[0], [[2, 3, 4, 1]])
+
+      # Sequences longer than the last boundary are not padded further.
+      long_results = sess.run([result], feed_dict={inp: [[1, 2, 3, 4, 5]]})
+      self.assertAllEqual(long_results[0], [[2, 3, 4, 5, 6]])
+
+  def testBatchFunctionOpWithPaddingAndUnalignedRows(self):
+    """Tests batch_function outputs whose rows do not start aligned."""
+    if context.executing_eagerly():
+      return
+    with self.cached_session() as sess:
+
+      @function.Defun(dtypes.float32)
+      def computation(in_t):
+        return in_t * 2
+
+      inp = array_ops.placeholder(dtype=dtypes.float32, shape=[1, 3])
+      result = gen_batch_ops.batch_function(
+          [inp],
+          num_batch_threads=1,
+          max_batch_size=4,
+          allowed_batch_sizes=[4],
+          batch_timeout_micros=100000,
+          Tout=[dtypes.float32],
+          f=computation,
+          captured_tensors=computation.captured_inputs)
+      thread_results = []
+
+      def worker():
+        thread_results.extend(
+            sess.run([result], feed_dict={inp: [[1, 2, 3]]}))
+
+      worker_thread = threading.Thread(target=worker)
+      worker_thread.start()
+      main_results = sess.run([result], feed_dict={inp: [[4, 5, 6]]})
+      worker_thread.join()
+      self.assertAllEqual(thread_results[0], [[2, 4, 6]])
+      self.assertAllEqual(main_results[0], [[8, 10, 12]])
+
   def testBatchFunctionOpWithInputError(self):
     """Tests that batch_function op works with error in the inputs."""
     if context.executing_eagerly():
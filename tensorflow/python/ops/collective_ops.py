@@ -21,7 +21,8 @@ from tensorflow.python.ops import gen_collective_ops
 
 
 def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
-               subdiv_offsets=(0,), communication_hint='auto'):
+               subdiv_offsets=(0,), communication_hint='auto',
+               communication_dtype=''):
   """Reduces tensors collectively, across devices.
 
   Args:
@@ -40,6 +41,9 @@ def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
     communication_hint: preferred collective communication.  The implementation
       may fall back to another mechanism.  Options include `auto`, `ring`, and
       `nccl`.
+    communication_dtype: if `'float16'` or `'bfloat16'`, a float32 `t` is
+      reduced in that precision on the CPU, carrying the rounding error over
+      to the next reduction with the same `instance_key`.
 
   Returns:
     An Op implementing the distributed reduction.
@@ -57,7 +61,8 @@ def all_reduce(t, group_size, group_key, instance_key, merge_op, final_op,
       merge_op=merge_op,
       final_op=final_op,
       subdiv_offsets=subdiv_offsets,
-      communication_hint=communication_hint.lower())
+      communication_hint=communication_hint.lower(),
+      communication_dtype=communication_dtype)
 
 
 def all_gather(t, group_size, group_key, instance_key,
@@ -421,6 +421,15 @@ _RAGGED_REDUCE_ANY_EXAMPLE = """
 """
 
 
+# The `unsorted_segment_op`s that the RaggedReduceRows kernel can replace when
+# reducing the rows of a RaggedTensor, and the matching `reduction` attr.
+_RAGGED_REDUCE_ROWS_REDUCTIONS = {
+    math_ops.unsorted_segment_sum: 'sum',
+    math_ops.unsorted_segment_max: 'max',
+    math_ops.unsorted_segment_min: 'min',
+}
+
+
 def ragged_reduce_aggregate(reduce_op,
                             unsorted_segment_op,
                             rt_input,
@@ -531,6 +540,14 @@ def ragged_reduce_aggregate(reduce_op,
                                        segment_ids, num_segments, separator)
     elif axis == 1:
       # out[i_0, i_1, i_2, ..., i_N] = sum_{j} rt_input[i_0, j, i_2, ..., i_N]
+      reduction = _RAGGED_REDUCE_ROWS_REDUCTIONS.get(unsorted_segment_op)
+      if (reduction is not None and separator is None and
+          not ragged_tensor.is_ragged(rt_input.values) and
+          (rt_input.dtype.is_floating or rt_input.dtype.is_integer)):
+        # Reduce each row directly from row_splits, without building segment
+        # ids for every value.
+        return gen_ragged_math_ops.ragged_reduce_rows(
+            rt_input.values, rt_input.row_splits, reduction)
       num_segments = array_ops.shape(rt_input.row_splits)[0] - 1
       segment_ids = segment_id_ops.row_splits_to_segment_ids(
           rt_input.row_splits)
@@ -545,6 +562,26 @@ def ragged_reduce_aggregate(reduce_op,
                                   separator))
 
 
+@ops.RegisterGradient('RaggedReduceRows')
+def _ragged_reduce_rows_grad(op, grad):
+  """Gradient for RaggedReduceRows op."""
+  values, row_splits = op.inputs
+  segment_ids = segment_id_ops.row_splits_to_segment_ids(row_splits)
+  if op.get_attr('reduction') == b'sum':
+    return [array_ops.gather(grad, segment_ids), None]
+  # For max and min, the gradient of each row is divided evenly among the
+  # values that were selected for that row.
+  is_selected = math_ops.equal(values,
+                               array_ops.gather(op.outputs[0], segment_ids))
+  num_selected = math_ops.unsorted_segment_sum(
+      math_ops.cast(is_selected, grad.dtype), segment_ids,
+      array_ops.shape(row_splits)[0] - 1)
+  weighted_grads = math_ops.div_no_nan(grad, num_selected)
+  gathered_grads = array_ops.gather(weighted_grads, segment_ids)
+  zeros = array_ops.zeros_like(gathered_grads)
+  return [array_ops.where_v2(is_selected, gathered_grads, zeros), None]
+
+
 def reduce_sum(input_tensor, axis=None, keepdims=None, name=None):
   """For docs, see: _RAGGED_REDUCE_DOCSTRING."""
 
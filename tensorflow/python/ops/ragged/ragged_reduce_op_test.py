@@ -26,8 +26,10 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import math_ops
 from tensorflow.python.ops.ragged import ragged_factory_ops
 from tensorflow.python.ops.ragged import ragged_math_ops
+from tensorflow.python.ops.ragged import ragged_tensor
 from tensorflow.python.platform import googletest
 
 _MAX_INT32 = dtypes.int32.max
@@ -328,6 +330,18 @@ class RaggedReduceOpsTest(test_util.TensorFlowTestCase,
     reduced = ragged_math_ops.reduce_sum(rt, axis=2)
     self.assertEqual(reduced.shape.as_list(), [1, None, 2])
 
+  def testReduceRowsGradient(self):
+    values = constant_op.constant([1.0, 3.0, 3.0, 2.0, 5.0])
+    with backprop.GradientTape() as tape:
+      tape.watch(values)
+      rt = ragged_tensor.RaggedTensor.from_row_splits(values, [0, 3, 3, 5])
+      total = ragged_math_ops.reduce_sum(rt, axis=1)
+      largest = ragged_math_ops.reduce_max(rt, axis=1)
+      loss = math_ops.reduce_sum(total) + math_ops.reduce_sum(largest)
+    # The maximum of the first row is shared by two values.
+    self.assertAllEqual(
+        tape.gradient(loss, values), [1.0, 1.5, 1.5, 1.0, 2.0])
+
   def assertEqualWithNan(self, actual, expected):
     """Like assertEqual, but NaN==NaN."""
     self.assertTrue(
@@ -21,6 +21,8 @@ import six
 
 from tensorflow.core.framework import node_def_pb2
 from tensorflow.python.framework import device as pydev
+from tensorflow.python.framework import dtypes
+from tensorflow.python.framework import tensor_shape
 from tensorflow.python.platform import tf_logging as logging
 from tensorflow.python.training import server_lib
 from tensorflow.python.util.tf_export import tf_export
@@ -68,6 +70,75 @@ class _RoundRobinStrategy(object):
     return task
 
 
+def byte_size_load_fn(op):
+  """Load function that computes the byte size of a variable `Operation`.
+
+  The size is computed from the `shape` and `dtype` attributes of the op, e.g.
+  of a `VariableV2` or `VarHandleOp`, so that it is known before the variable
+  is initialized.
+
+  Args:
+    op: An `Operation` or `NodeDef` to be placed on ps.
+
+  Returns:
+    The number of bytes of the variable, or 0 if its shape is not fully defined
+    or the op has no `shape` and `dtype` attributes.
+  """
+  node_def = op if isinstance(op, node_def_pb2.NodeDef) else op.node_def
+  if "shape" not in node_def.attr or "dtype" not in node_def.attr:
+    return 0
+  shape = tensor_shape.TensorShape(node_def.attr["shape"].shape)
+  if not shape.is_fully_defined():
+    return 0
+  dtype = dtypes.as_dtype(node_def.attr["dtype"].type)
+  return shape.num_elements() * dtype.size
+
+
+class GreedyLoadBalancingStrategy(object):
+  """Returns the least-loaded ps task for placement.
+
+  Each `Operation` is placed on the ps task with the least total load so far,
+  as computed by `load_fn`. With `byte_size_load_fn`, the variables are
+  balanced by size, so that no ps task holds or serves much more than the
+  others. To also balance by access frequency, weigh the size by the observed
+  access rate of each variable, e.g.
+
+  ```python
+  def load_fn(op):
+    return byte_size_load_fn(op) * access_rates.get(op.name, 1.0)
+  ```
+
+  The placement is greedy in the order in which the ops are created, so it is
+  most balanced when the largest variables are created first.
+  """
+
+  def __init__(self, num_tasks, load_fn=byte_size_load_fn):
+    """Create a new `GreedyLoadBalancingStrategy`.
+
+    Args:
+      num_tasks: Number of ps tasks to balance among.
+      load_fn: A callable that takes an `Operation` and returns a numeric load
+        value for that op.
+    """
+    self._num_tasks = num_tasks
+    self._load_fn = load_fn
+    self._ps_loads = [0] * num_tasks
+
+  def __call__(self, op):
+    """Choose a ps task index for the given `Operation`.
+
+    Args:
+      op: An `Operation` to be placed on ps.
+
+    Returns:
+      The index of the ps task with the least load, in the range
+      `[0, num_tasks)`. Ties go to the lowest index.
+    """
+    task = min(range(self._num_tasks), key=self._ps_loads.__getitem__)
+    self._ps_loads[task] += self._load_fn(op)
+    return task
+
+
 class _ReplicaDeviceChooser(object):
   """Class to choose devices for Ops in a replicated training setup.
 
@@ -154,8 +225,8 @@ def replica_device_setter(ps_tasks=0,
 
   By default, only Variable ops are placed on ps tasks, and the placement
   strategy is round-robin over all ps tasks. A custom `ps_strategy` may be used
-  to do more intelligent placement, such as
-  `tf.contrib.training.GreedyLoadBalancingStrategy`.
+  to do more intelligent placement, such as a `GreedyLoadBalancingStrategy`
+  from this module that balances the ps tasks by variable byte size.
 
   For example,
 
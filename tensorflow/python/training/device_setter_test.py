@@ -18,8 +18,10 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
+from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import variables
 from tensorflow.python.platform import test
@@ -186,6 +188,32 @@ class DeviceSetterTest(test.TestCase):
       self.assertDeviceEqual("/job:moon/task:1/cpu:0", w.initializer.device)
       self.assertDeviceEqual("/job:sun", a.device)
 
+  @test_util.run_deprecated_v1
+  def testByteSizeLoadFn(self):
+    with ops.Graph().as_default():
+      v = variables.Variable(array_ops.zeros([3, 4]))
+      r = resource_variable_ops.ResourceVariable(
+          array_ops.zeros([5], dtype=dtypes.float64))
+      self.assertEqual(48, device_setter.byte_size_load_fn(v.op))
+      self.assertEqual(40, device_setter.byte_size_load_fn(r.op))
+      self.assertEqual(0, device_setter.byte_size_load_fn(v.initializer))
+
+  @test_util.run_deprecated_v1
+  def testGreedyLoadBalancingStrategy(self):
+    strategy = device_setter.GreedyLoadBalancingStrategy(
+        2, device_setter.byte_size_load_fn)
+    with ops.device(
+        device_setter.replica_device_setter(
+            cluster=self._cluster_spec, ps_strategy=strategy)):
+      u = variables.Variable(array_ops.zeros([100]))
+      v = variables.Variable(array_ops.zeros([10]))
+      w = variables.Variable(array_ops.zeros([10]))
+      x = variables.Variable(array_ops.zeros([100]))
+      self.assertDeviceEqual("/job:ps/task:0", u.device)
+      self.assertDeviceEqual("/job:ps/task:1", v.device)
+      self.assertDeviceEqual("/job:ps/task:1", w.device)
+      self.assertDeviceEqual("/job:ps/task:1", x.device)
+
 
 if __name__ == "__main__":
   test.main()
@@ -255,6 +255,70 @@ class TrainingOpsTest(TensorFlowTestCase):
       indices = np.array([0, 2]).astype(index_type)
       self._testTypesForSparseFtrl(x, y, z, lr, grad, indices)
 
+  @test_util.run_v1_only("b/120545219")
+  def testResourceSparseApplyAdagradWithRowLocking(self):
+    for inner_dim in [1, 10]:
+      x = np.arange(3 * inner_dim).reshape(3, inner_dim).astype(np.float32)
+      y = np.arange(1, 3 * inner_dim + 1).reshape(3, inner_dim).astype(
+          np.float32)
+      lr = np.array(2.0).astype(np.float32)
+      grad = np.arange(2 * inner_dim).reshape(2, inner_dim).astype(np.float32)
+      indices = np.array([0, 2]).astype(np.int64)
+      with self.session(use_gpu=False):
+        var = resource_variable_ops.ResourceVariable(x)
+        accum = resource_variable_ops.ResourceVariable(y)
+        self.evaluate(variables.global_variables_initializer())
+        self.evaluate(
+            training_ops.resource_sparse_apply_adagrad(
+                var.handle,
+                accum.handle,
+                lr,
+                grad,
+                constant_op.constant(indices),
+                use_locking=True,
+                use_row_locking=True))
+
+        for (i, index) in enumerate(indices):
+          self.assertAllCloseAccordingToType(
+              x[index] - lr * grad[i] * (y[index] + grad[i] * grad[i])**(-0.5),
+              self.evaluate(var)[index])
+          self.assertAllCloseAccordingToType(y[index] + grad[i] * grad[i],
+                                             self.evaluate(accum)[index])
+        self.assertAllCloseAccordingToType(x[1], self.evaluate(var)[1])
+
+  @test_util.run_v1_only("b/120545219")
+  def testResourceSparseApplyFtrlWithRowLocking(self):
+    x = np.zeros((3, 4)).astype(np.float32)
+    y = np.full((3, 4), 4.0).astype(np.float32)
+    z = np.zeros((3, 4)).astype(np.float32)
+    lr = np.array(2.0).astype(np.float32)
+    grad = np.arange(1, 9).reshape(2, 4).astype(np.float32)
+    indices = np.array([0, 2]).astype(np.int32)
+    with self.session(use_gpu=False):
+      var = resource_variable_ops.ResourceVariable(x)
+      accum = resource_variable_ops.ResourceVariable(y)
+      linear = resource_variable_ops.ResourceVariable(z)
+      self.evaluate(variables.global_variables_initializer())
+      self.evaluate(
+          training_ops.resource_sparse_apply_ftrl(
+              var.handle,
+              accum.handle,
+              linear.handle,
+              grad,
+              constant_op.constant(indices),
+              lr,
+              0.0,
+              0.0,
+              -0.5,
+              use_row_locking=True))
+
+      for (i, index) in enumerate(indices):
+        self.assertAllCloseAccordingToType(
+            -lr * grad[i] * (y[index] + grad[i] * grad[i])**(-0.5),
+            self.evaluate(var)[index])
+        self.assertAllCloseAccordingToType(y[index] + grad[i] * grad[i],
+                                           self.evaluate(accum)[index])
+
   @test_util.run_v1_only("b/120545219")
   def testApplyAdam(self):
     for dtype, use_gpu in itertools.product(
@@ -817,6 +817,144 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   }
 }
 
+/* static */ port::StatusOr<uint64> GpuDriver::GetMinAllocationGranularity(
+    GpuContext* context) {
+#if CUDA_VERSION >= 10020
+  ScopedActivateContext activation(context);
+  CUdevice device;
+  RETURN_IF_CUDA_RES_ERROR(cuCtxGetDevice(&device),
+                           "Failed to get the device of a context");
+  CUmemAllocationProp props = {};
+  props.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+  props.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  props.location.id = device;
+  size_t granularity = 0;
+  RETURN_IF_CUDA_RES_ERROR(
+      cuMemGetAllocationGranularity(&granularity, &props,
+                                    CU_MEM_ALLOC_GRANULARITY_MINIMUM),
+      "Failed to get the memory allocation granularity");
+  return granularity;
+#else
+  return port::UnimplementedError("Virtual memory management requires CUDA "
+                                  "10.2");
+#endif  // CUDA_VERSION >= 10020
+}
+
+/* static */ port::StatusOr<CUdeviceptr> GpuDriver::ReserveVirtualMemory(
+    GpuContext* context, uint64 bytes) {
+#if CUDA_VERSION >= 10020
+  ScopedActivateContext activation(context);
+  CUdeviceptr base = 0;
+  RETURN_IF_CUDA_RES_ERROR(
+      cuMemAddressReserve(&base, bytes, /*alignment=*/0, /*addr=*/0,
+                          /*flags=*/0),
+      "Failed to reserve ", bytes, " bytes of device addresses");
+  VLOG(2) << "reserved " << bytes << " bytes of device addresses at "
+          << absl::bit_cast<void*>(base) << " for context "
+          << context->context();
+  return base;
+#else
+  return port::UnimplementedError("Virtual memory management requires CUDA "
+                                  "10.2");
+#endif  // CUDA_VERSION >= 10020
+}
+
+/* static */ void GpuDriver::FreeVirtualMemory(GpuContext* context,
+                                               CUdeviceptr base,
+                                               uint64 bytes) {
+#if CUDA_VERSION >= 10020
+  ScopedActivateContext activation(context);
+  CUresult res = cuMemAddressFree(base, bytes);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to free device addresses at "
+               << absl::bit_cast<void*>(base) << "; result: " << ToString(res);
+  }
+#else
+  LOG(ERROR) << "Virtual memory management requires CUDA 10.2";
+#endif  // CUDA_VERSION >= 10020
+}
+
+/* static */ port::StatusOr<GpuDriver::GenericMemoryHandle>
+GpuDriver::CreateMemoryHandle(GpuContext* context, uint64 bytes) {
+#if CUDA_VERSION >= 10020
+  ScopedActivateContext activation(context);
+  CUdevice device;
+  RETURN_IF_CUDA_RES_ERROR(cuCtxGetDevice(&device),
+                           "Failed to get the device of a context");
+  CUmemAllocationProp props = {};
+  props.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+  props.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  props.location.id = device;
+  CUmemGenericAllocationHandle handle;
+  RETURN_IF_CUDA_RES_ERROR(cuMemCreate(&handle, bytes, &props, /*flags=*/0),
+                           "Failed to allocate ", bytes,
+                           " bytes of physical device memory");
+  GenericMemoryHandle result;
+  result.handle = handle;
+  result.bytes = bytes;
+  return result;
+#else
+  return port::UnimplementedError("Virtual memory management requires CUDA "
+                                  "10.2");
+#endif  // CUDA_VERSION >= 10020
+}
+
+/* static */ void GpuDriver::ReleaseMemoryHandle(GpuContext* context,
+                                                 GenericMemoryHandle handle) {
+#if CUDA_VERSION >= 10020
+  ScopedActivateContext activation(context);
+  CUresult res = cuMemRelease(handle.handle);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to release " << handle.bytes
+               << " bytes of physical device memory; result: "
+               << ToString(res);
+  }
+#else
+  LOG(ERROR) << "Virtual memory management requires CUDA 10.2";
+#endif  // CUDA_VERSION >= 10020
+}
+
+/* static */ port::Status GpuDriver::MapMemory(
+    GpuContext* context, CUdeviceptr va, const GenericMemoryHandle& handle) {
+#if CUDA_VERSION >= 10020
+  ScopedActivateContext activation(context);
+  CUdevice device;
+  RETURN_IF_CUDA_RES_ERROR(cuCtxGetDevice(&device),
+                           "Failed to get the device of a context");
+  RETURN_IF_CUDA_RES_ERROR(
+      cuMemMap(va, handle.bytes, /*offset=*/0, handle.handle, /*flags=*/0),
+      "Failed to map ", handle.bytes, " bytes of device memory");
+  CUmemAccessDesc access = {};
+  access.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  access.location.id = device;
+  access.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+  CUresult res = cuMemSetAccess(va, handle.bytes, &access, /*count=*/1);
+  if (res != CUDA_SUCCESS) {
+    cuMemUnmap(va, handle.bytes);
+    return port::InternalError(
+        absl::StrCat("Failed to set access to device memory: ", ToString(res)));
+  }
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("Virtual memory management requires CUDA "
+                                  "10.2");
+#endif  // CUDA_VERSION >= 10020
+}
+
+/* static */ void GpuDriver::UnmapMemory(GpuContext* context, CUdeviceptr va,
+                                         uint64 bytes) {
+#if CUDA_VERSION >= 10020
+  ScopedActivateContext activation(context);
+  CUresult res = cuMemUnmap(va, bytes);
+  if (res != CUDA_SUCCESS) {
+    LOG(ERROR) << "failed to unmap " << bytes << " bytes of device memory at "
+               << absl::bit_cast<void*>(va) << "; result: " << ToString(res);
+  }
+#else
+  LOG(ERROR) << "Virtual memory management requires CUDA 10.2";
+#endif  // CUDA_VERSION >= 10020
+}
+
 /* static */ void* GpuDriver::HostAllocate(GpuContext* context, uint64 bytes) {
   ScopedActivateContext activation(context);
   void* host_mem = nullptr;
@@ -954,6 +1092,91 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return port::Status::OK();
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(GpuContext* context,
+                                                        CUstream stream) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+#if CUDA_VERSION >= 10010
+  // Other threads keep using the device while a stream captures, so don't
+  // fail their unsafe calls.
+  RETURN_IF_CUDA_RES_ERROR(
+      cuStreamBeginCapture(stream, CU_STREAM_CAPTURE_MODE_RELAXED),
+      "Failed to begin stream capture");
+#else
+  RETURN_IF_CUDA_RES_ERROR(cuStreamBeginCapture(stream),
+                           "Failed to begin stream capture");
+#endif  // CUDA_VERSION >= 10010
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("Stream capture requires CUDA 10");
+#endif  // CUDA_VERSION >= 10000
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      CUstream stream,
+                                                      CUgraph* graph) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuStreamEndCapture(stream, graph),
+                           "Failed to end stream capture");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("Stream capture requires CUDA 10");
+#endif  // CUDA_VERSION >= 10000
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(GpuContext* context,
+                                                      CUgraph graph,
+                                                      CUgraphExec* exec) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(
+      cuGraphInstantiate(exec, graph, /*phErrorNode=*/nullptr,
+                         /*logBuffer=*/nullptr, /*bufferSize=*/0),
+      "Failed to instantiate CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10");
+#endif  // CUDA_VERSION >= 10000
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 CUgraphExec exec,
+                                                 CUstream stream) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphLaunch(exec, stream),
+                           "Failed to launch CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10");
+#endif  // CUDA_VERSION >= 10000
+}
+
+/* static */ port::Status GpuDriver::DestroyGraph(GpuContext* context,
+                                                  CUgraph graph) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphDestroy(graph),
+                           "Failed to destroy CUDA graph");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10");
+#endif  // CUDA_VERSION >= 10000
+}
+
+/* static */ port::Status GpuDriver::DestroyGraphExec(GpuContext* context,
+                                                      CUgraphExec exec) {
+#if CUDA_VERSION >= 10000
+  ScopedActivateContext activated{context};
+  RETURN_IF_CUDA_RES_ERROR(cuGraphExecDestroy(exec),
+                           "Failed to destroy CUDA graph exec");
+  return port::Status::OK();
+#else
+  return port::UnimplementedError("CUDA graphs require CUDA 10");
+#endif  // CUDA_VERSION >= 10000
+}
+
 /* static */ bool GpuDriver::IsStreamIdle(GpuContext* context,
                                           CUstream stream) {
   ScopedActivateContext activated{context};
@@ -117,6 +117,52 @@ class GpuDriver {
   // (supported on CUDA only)
   static void UnifiedMemoryDeallocate(GpuContext* context, void* location);
 
+  // -- Virtual memory management.
+  //
+  // Physical memory is allocated separately from device addresses, and mapped
+  // into (and out of) a range of addresses reserved up front, so that a buffer
+  // can grow or shrink in place. Requires CUDA 10.2; unimplemented on ROCm.
+  // https://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__VA.html
+
+  // Physical memory allocated by CreateMemoryHandle.
+  struct GenericMemoryHandle {
+    uint64 handle = 0;
+    uint64 bytes = 0;
+  };
+
+  // Returns the granularity of physical memory on the device of context, via
+  // cuMemGetAllocationGranularity. The sizes of physical allocations, and the
+  // addresses they are mapped at, must be multiples of it.
+  static port::StatusOr<uint64> GetMinAllocationGranularity(
+      GpuContext* context);
+
+  // Reserves bytes of device addresses, with nothing mapped at them, via
+  // cuMemAddressReserve.
+  static port::StatusOr<GpuDevicePtr> ReserveVirtualMemory(GpuContext* context,
+                                                           uint64 bytes);
+
+  // Frees the addresses reserved at base, via cuMemAddressFree. Nothing may be
+  // mapped at them anymore.
+  static void FreeVirtualMemory(GpuContext* context, GpuDevicePtr base,
+                                uint64 bytes);
+
+  // Allocates bytes of physical memory on the device of context, via
+  // cuMemCreate.
+  static port::StatusOr<GenericMemoryHandle> CreateMemoryHandle(
+      GpuContext* context, uint64 bytes);
+
+  // Frees physical memory once it is no longer mapped, via cuMemRelease.
+  static void ReleaseMemoryHandle(GpuContext* context,
+                                  GenericMemoryHandle handle);
+
+  // Maps the physical memory of handle at va and makes it readable and
+  // writable by the device of context, via cuMemMap and cuMemSetAccess.
+  static port::Status MapMemory(GpuContext* context, GpuDevicePtr va,
+                                const GenericMemoryHandle& handle);
+
+  // Unmaps the bytes of physical memory mapped at va, via cuMemUnmap.
+  static void UnmapMemory(GpuContext* context, GpuDevicePtr va, uint64 bytes);
+
   // Allocates page-locked and CUDA-registered memory on the host via
   // cuMemAllocHost.
   // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__MEM.html#group__CUDA__MEM_1gdd8311286d2c2691605362c689bc64e0
@@ -334,6 +380,38 @@ class GpuDriver {
   static port::Status SynchronizeStream(GpuContext* context,
                                         GpuStreamHandle stream);
 
+  // -- Stream capture.
+  //
+  // While a stream is capturing, the work enqueued on it is recorded into a
+  // graph rather than run. An instantiated graph then runs all of that work
+  // with one launch. Requires CUDA 10; unimplemented on ROCm.
+  // http://docs.nvidia.com/cuda/cuda-driver-api/group__CUDA__GRAPH.html
+
+  // Starts capturing the work enqueued on stream, via cuStreamBeginCapture.
+  static port::Status StreamBeginCapture(GpuContext* context,
+                                         GpuStreamHandle stream);
+
+  // Stops capturing on stream and returns the captured work in *graph, via
+  // cuStreamEndCapture.
+  static port::Status StreamEndCapture(GpuContext* context,
+                                       GpuStreamHandle stream,
+                                       GpuGraphHandle* graph);
+
+  // Makes graph launchable, via cuGraphInstantiate. graph can be destroyed
+  // afterwards.
+  static port::Status GraphInstantiate(GpuContext* context,
+                                       GpuGraphHandle graph,
+                                       GpuGraphExecHandle* exec);
+
+  // Enqueues the work of exec on stream, via cuGraphLaunch.
+  static port::Status GraphLaunch(GpuContext* context, GpuGraphExecHandle exec,
+                                  GpuStreamHandle stream);
+
+  // Destroy graph or exec, via cuGraphDestroy and cuGraphExecDestroy.
+  static port::Status DestroyGraph(GpuContext* context, GpuGraphHandle graph);
+  static port::Status DestroyGraphExec(GpuContext* context,
+                                       GpuGraphExecHandle exec);
+
   // Blocks the calling thread until the operations associated with the context
   // have been completed, via cuCtxSynchronize.
   //
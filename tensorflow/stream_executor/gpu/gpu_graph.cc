@@ -0,0 +1,71 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/stream_executor/gpu/gpu_graph.h"
+
+#include "tensorflow/stream_executor/gpu/gpu_driver.h"
+#include "tensorflow/stream_executor/gpu/gpu_executor.h"
+#include "tensorflow/stream_executor/gpu/gpu_stream.h"
+#include "tensorflow/stream_executor/lib/status_macros.h"
+#include "tensorflow/stream_executor/platform/logging.h"
+
+namespace stream_executor {
+namespace gpu {
+
+/* static */ port::StatusOr<std::unique_ptr<GpuGraph>> GpuGraph::Capture(
+    Stream* stream, const std::function<port::Status()>& enqueue) {
+  GpuExecutor* parent = AsGpuStream(stream)->parent();
+  GpuContext* context = parent->gpu_context();
+  GpuStreamHandle gpu_stream = AsGpuStreamValue(stream);
+  SE_RETURN_IF_ERROR(GpuDriver::StreamBeginCapture(context, gpu_stream));
+  port::Status enqueue_status = enqueue();
+  // End the capture even if enqueue failed, so the stream is usable again.
+  GpuGraphHandle graph = nullptr;
+  port::Status status =
+      GpuDriver::StreamEndCapture(context, gpu_stream, &graph);
+  if (enqueue_status.ok() && !stream->ok()) {
+    enqueue_status = port::InternalError("Stream failed while capturing");
+  }
+  if (status.ok() && !enqueue_status.ok()) status = enqueue_status;
+  GpuGraphExecHandle exec = nullptr;
+  if (status.ok()) {
+    status = GpuDriver::GraphInstantiate(context, graph, &exec);
+  }
+  if (graph != nullptr) {
+    // The instantiated graph does not refer to the captured one.
+    port::Status destroy_status = GpuDriver::DestroyGraph(context, graph);
+    if (!destroy_status.ok()) {
+      LOG(ERROR) << destroy_status;
+    }
+  }
+  SE_RETURN_IF_ERROR(status);
+  return std::unique_ptr<GpuGraph>(new GpuGraph(parent, exec));
+}
+
+GpuGraph::~GpuGraph() {
+  port::Status status =
+      GpuDriver::DestroyGraphExec(parent_->gpu_context(), exec_);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+}
+
+port::Status GpuGraph::Launch(Stream* stream) {
+  return GpuDriver::GraphLaunch(parent_->gpu_context(), exec_,
+                                AsGpuStreamValue(stream));
+}
+
+}  // namespace gpu
+}  // namespace stream_executor
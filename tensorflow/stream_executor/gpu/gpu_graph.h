@@ -0,0 +1,68 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_GRAPH_H_
+#define TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_GRAPH_H_
+
+#include <functional>
+#include <memory>
+
+#include "tensorflow/stream_executor/gpu/gpu_types.h"
+#include "tensorflow/stream_executor/lib/status.h"
+#include "tensorflow/stream_executor/lib/statusor.h"
+#include "tensorflow/stream_executor/platform/port.h"
+#include "tensorflow/stream_executor/stream.h"
+
+namespace stream_executor {
+namespace gpu {
+
+class GpuExecutor;
+
+// GPU work captured from a stream once, which can then be enqueued again as
+// a whole for the cost of a single launch (a CUDA graph).
+//
+// The captured work reads and writes the same device buffers on every
+// launch, so it can only be replayed while the buffers it was captured with
+// are still allocated and hold the inputs the caller wants to use.
+class GpuGraph {
+ public:
+  // Calls `enqueue` with `stream` capturing, and returns the work it
+  // enqueued on `stream`. None of that work runs until Launch is called.
+  // `enqueue` must not synchronize with the stream, nor allocate or free
+  // device memory synchronously. If it or the capture fails, the work is
+  // dropped and the stream stops capturing.
+  static port::StatusOr<std::unique_ptr<GpuGraph>> Capture(
+      Stream* stream, const std::function<port::Status()>& enqueue);
+
+  ~GpuGraph();
+
+  // Enqueues the captured work on `stream`, which must belong to the same
+  // executor as the stream it was captured from.
+  port::Status Launch(Stream* stream);
+
+ private:
+  GpuGraph(GpuExecutor* parent, GpuGraphExecHandle exec)
+      : parent_(parent), exec_(exec) {}
+
+  GpuExecutor* const parent_;
+  const GpuGraphExecHandle exec_;
+
+  SE_DISALLOW_COPY_AND_ASSIGN(GpuGraph);
+};
+
+}  // namespace gpu
+}  // namespace stream_executor
+
+#endif  // TENSORFLOW_STREAM_EXECUTOR_GPU_GPU_GRAPH_H_
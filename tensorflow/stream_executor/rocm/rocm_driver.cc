@@ -637,6 +637,46 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
       << "Feature not supported on ROCm platform (UnifiedMemoryDeallocate)";
 }
 
+/* static */ port::StatusOr<uint64> GpuDriver::GetMinAllocationGranularity(
+    GpuContext* context) {
+  return port::UnimplementedError(
+      "Virtual memory management is not supported on ROCm");
+}
+
+/* static */ port::StatusOr<hipDeviceptr_t> GpuDriver::ReserveVirtualMemory(
+    GpuContext* context, uint64 bytes) {
+  return port::UnimplementedError(
+      "Virtual memory management is not supported on ROCm");
+}
+
+/* static */ void GpuDriver::FreeVirtualMemory(GpuContext* context,
+                                               hipDeviceptr_t base,
+                                               uint64 bytes) {
+  LOG(ERROR) << "Feature not supported on ROCm platform (FreeVirtualMemory)";
+}
+
+/* static */ port::StatusOr<GpuDriver::GenericMemoryHandle>
+GpuDriver::CreateMemoryHandle(GpuContext* context, uint64 bytes) {
+  return port::UnimplementedError(
+      "Virtual memory management is not supported on ROCm");
+}
+
+/* static */ void GpuDriver::ReleaseMemoryHandle(GpuContext* context,
+                                                 GenericMemoryHandle handle) {
+  LOG(ERROR) << "Feature not supported on ROCm platform (ReleaseMemoryHandle)";
+}
+
+/* static */ port::Status GpuDriver::MapMemory(
+    GpuContext* context, hipDeviceptr_t va, const GenericMemoryHandle& handle) {
+  return port::UnimplementedError(
+      "Virtual memory management is not supported on ROCm");
+}
+
+/* static */ void GpuDriver::UnmapMemory(GpuContext* context,
+                                         hipDeviceptr_t va, uint64 bytes) {
+  LOG(ERROR) << "Feature not supported on ROCm platform (UnmapMemory)";
+}
+
 /* static */ void* GpuDriver::HostAllocate(GpuContext* context, uint64 bytes) {
   ScopedActivateContext activation{context};
   void* host_mem = nullptr;
@@ -809,6 +849,38 @@ GpuDriver::ContextGetSharedMemConfig(GpuContext* context) {
   return port::Status::OK();
 }
 
+/* static */ port::Status GpuDriver::StreamBeginCapture(
+    GpuContext* context, GpuStreamHandle stream) {
+  return port::UnimplementedError("Stream capture is not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::StreamEndCapture(GpuContext* context,
+                                                      GpuStreamHandle stream,
+                                                      GpuGraphHandle* graph) {
+  return port::UnimplementedError("Stream capture is not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::GraphInstantiate(
+    GpuContext* context, GpuGraphHandle graph, GpuGraphExecHandle* exec) {
+  return port::UnimplementedError("Stream capture is not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::GraphLaunch(GpuContext* context,
+                                                 GpuGraphExecHandle exec,
+                                                 GpuStreamHandle stream) {
+  return port::UnimplementedError("Stream capture is not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::DestroyGraph(GpuContext* context,
+                                                  GpuGraphHandle graph) {
+  return port::UnimplementedError("Stream capture is not supported on ROCm");
+}
+
+/* static */ port::Status GpuDriver::DestroyGraphExec(
+    GpuContext* context, GpuGraphExecHandle exec) {
+  return port::UnimplementedError("Stream capture is not supported on ROCm");
+}
+
 /* static */ bool GpuDriver::IsStreamIdle(GpuContext* context,
                                           GpuStreamHandle stream) {
   ScopedActivateContext activated{context};
@@ -0,0 +1,100 @@
+/* Copyright 2020 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Builds a lookup table file for the MappedHashTable op from a vocabulary
+// file with one entry per line. By default each line is mapped to its line
+// number, like a table initialized with
+// TextFileIndex::WHOLE_LINE -> TextFileIndex::LINE_NUMBER; with --invert each
+// line number is mapped to its line instead. To use it, run something like:
+//
+// bazel build tensorflow/tools/lookup_table:build_mapped_lookup_table
+// bazel-bin/tensorflow/tools/lookup_table/build_mapped_lookup_table \
+//   --vocab_file=vocab.txt --output=vocab.table
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/kernels/mapped_lookup_table.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace {
+
+Status BuildMappedLookupTable(const string& vocab_file, const string& output,
+                              bool invert) {
+  Env* env = Env::Default();
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(vocab_file, &file));
+  io::InputBuffer input(file.get(), 1 << 20);
+  std::vector<tstring> lines;
+  tstring line;
+  Status s;
+  while ((s = input.ReadLine(&line)).ok()) {
+    lines.push_back(line);
+  }
+  if (!errors::IsOutOfRange(s)) return s;
+
+  const int64 size = lines.size();
+  Tensor strings(DT_STRING, TensorShape({size}));
+  Tensor indices(DT_INT64, TensorShape({size}));
+  for (int64 i = 0; i < size; ++i) {
+    strings.flat<tstring>()(i) = std::move(lines[i]);
+    indices.flat<int64>()(i) = i;
+  }
+  if (invert) {
+    return lookup::WriteMappedLookupTable(env, output, indices, strings);
+  }
+  return lookup::WriteMappedLookupTable(env, output, strings, indices);
+}
+
+int ParseFlagsAndBuildTable(int argc, char* argv[]) {
+  string vocab_file;
+  string output;
+  bool invert = false;
+  std::vector<Flag> flag_list = {
+      Flag("vocab_file", &vocab_file, "text file with one entry per line"),
+      Flag("output", &output, "lookup table file to write"),
+      Flag("invert", &invert,
+           "map line numbers to lines instead of lines to line numbers"),
+  };
+  string usage = Flags::Usage(argv[0], flag_list);
+  const bool parse_result = Flags::Parse(&argc, argv, flag_list);
+  // We need to call this to set up global state for TensorFlow.
+  port::InitMain(usage.c_str(), &argc, &argv);
+  if (!parse_result || argc > 1 || vocab_file.empty() || output.empty()) {
+    LOG(ERROR) << usage;
+    return -1;
+  }
+
+  const Status status = BuildMappedLookupTable(vocab_file, output, invert);
+  if (!status.ok()) {
+    LOG(ERROR) << "Building lookup table '" << output << "' failed with "
+               << status.error_message();
+    return -1;
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace tensorflow
+
+int main(int argc, char* argv[]) {
+  return tensorflow::ParseFlagsAndBuildTable(argc, argv);
+}